@@ -58,6 +58,8 @@
 
 # ifdef __cplusplus
 extern "C" {
+# else
+#  include <stdbool.h>
 # endif
 
 /** \defgroup libvlc_core LibVLC core
@@ -241,6 +243,22 @@ LIBVLC_API
 void libvlc_set_app_id( libvlc_instance_t *p_instance, const char *id,
                         const char *version, const char *icon );
 
+/**
+ * Retrieves the memory used by the data waiting to be decoded.
+ *
+ * This is meant to monitor the buffering against the "dec-memory-limit" and
+ * "dec-memory-process-limit" options.
+ *
+ * \param p_instance LibVLC instance
+ * \param process whether to count all the instances of the process, rather
+ * than only the given instance
+ * \return the size in bytes of the data queued to the decoders
+ * \version LibVLC 4.0.0 or later.
+ */
+LIBVLC_API
+size_t libvlc_get_decoder_buffer_usage( libvlc_instance_t *p_instance,
+                                        bool process );
+
 /**
  * Retrieve libvlc version.
  *
@@ -550,6 +568,73 @@ static inline int64_t libvlc_delay(int64_t pts)
 
 /** @} */
 
+/** \defgroup libvlc_sout_stats LibVLC stream output statistics
+ * These functions report the activity of each stream output element
+ * (stream output modules, multiplexers and access outputs).
+ * @{
+ */
+
+/**
+ * Type of a stream output element.
+ */
+typedef enum libvlc_sout_stats_type_t
+{
+    libvlc_sout_stats_stream,
+    libvlc_sout_stats_mux,
+    libvlc_sout_stats_access,
+} libvlc_sout_stats_type_t;
+
+/**
+ * Statistics of a stream output element.
+ *
+ * Latencies only account for the time spent within the element itself, not
+ * within the elements it passes data to.
+ */
+typedef struct libvlc_sout_stats_t
+{
+    unsigned        i_id; /**< unique element identifier */
+    unsigned        i_owner; /**< identifier of the owner element, or 0 */
+    unsigned        i_next; /**< identifier of the next element, or 0 */
+    libvlc_sout_stats_type_t i_type;
+    char            psz_name[32]; /**< module name */
+
+    uint64_t        i_blocks; /**< blocks received */
+    uint64_t        i_bytes; /**< bytes received */
+    uint64_t        i_byte_rate; /**< recent bytes per second */
+    uint64_t        i_late; /**< blocks processed slower than real-time */
+    uint64_t        i_dropped; /**< blocks rejected with an error */
+
+    unsigned        i_in_flight; /**< blocks being or waiting to be processed */
+    unsigned        i_queued; /**< blocks queued within the element */
+    uint64_t        i_queued_bytes; /**< bytes queued within the element */
+
+    int64_t         i_latency; /**< total processing time (microseconds) */
+    int64_t         i_latency_max; /**< longest time for a block (microseconds) */
+} libvlc_sout_stats_t;
+
+/**
+ * Get the statistics of all the stream output elements of an instance.
+ *
+ * \param p_instance libvlc instance
+ * \param pp_stats address to store an allocated array of statistics [OUT]
+ *
+ * \return the number of elements in the array (possibly 0), or -1 on error
+ * \note the array must be freed with libvlc_sout_stats_release()
+ */
+LIBVLC_API
+int libvlc_sout_stats_get( libvlc_instance_t *p_instance,
+                           libvlc_sout_stats_t **pp_stats );
+
+/**
+ * Release an array of statistics from libvlc_sout_stats_get().
+ *
+ * \param p_stats the array to release (can be NULL)
+ */
+LIBVLC_API
+void libvlc_sout_stats_release( libvlc_sout_stats_t *p_stats );
+
+/** @} */
+
 # ifdef __cplusplus
 }
 # endif
@@ -168,6 +168,11 @@ typedef enum libvlc_media_parse_flag_t
      * when the input is asking for credentials.
      */
     libvlc_media_do_interact    = 0x08,
+    /**
+     * Only read the tags of local files when possible, which is much faster
+     * than a full parsing. The duration and the tracks are not retrieved.
+     */
+    libvlc_media_parse_meta_only = 0x10,
 } libvlc_media_parse_flag_t;
 
 /**
@@ -499,6 +499,204 @@ void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
                                         libvlc_video_format_cb setup,
                                         libvlc_video_cleanup_cb cleanup );
 
+/**
+ * Opaque type of a decoded video frame.
+ *
+ * \see libvlc_video_set_frame_callback()
+ */
+typedef struct libvlc_video_frame_t libvlc_video_frame_t;
+
+/**
+ * Callback prototype to receive a decoded video frame.
+ *
+ * It is invoked when the frame needs to be shown, as determined by the media
+ * playback clock.
+ *
+ * \param opaque private pointer as passed to
+ *               libvlc_video_set_frame_callback() [IN]
+ * \param frame the frame, to release with libvlc_video_frame_release()
+ *              (possibly later, from any thread) [IN]
+ */
+typedef void (*libvlc_video_frame_cb)(void *opaque,
+                                      libvlc_video_frame_t *frame);
+
+/**
+ * Set a callback to receive the decoded video frames without copy.
+ *
+ * Unlike libvlc_video_set_callbacks(), LibVLC does not copy the frames into
+ * application buffers: the application receives a reference to the frame
+ * buffers VLC decoded or converted into, and releases it when it has
+ * consumed it.
+ *
+ * By default, the frames are delivered in the decoder chroma and dimensions.
+ * Use libvlc_video_set_format_callbacks() to request a specific chroma or
+ * size (the pitches and lines returned by the setup callback are ignored):
+ * the frames are then converted, but still never copied once more.
+ *
+ * \warning The frames come from a picture pool of limited size, shared with
+ * the decoder: keeping more than a few frames at the same time stalls the
+ * decoding until some of them are released.
+ *
+ * This is mutually exclusive with libvlc_video_set_callbacks().
+ *
+ * \param mp the media player
+ * \param frame_cb callback to receive the frames (must not be NULL)
+ * \param opaque private pointer for the callback (as first parameter)
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_video_set_frame_callback( libvlc_media_player_t *mp,
+                                      libvlc_video_frame_cb frame_cb,
+                                      void *opaque );
+
+/**
+ * Retain a video frame, increasing its reference count.
+ *
+ * \param frame the frame
+ * \return frame
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+libvlc_video_frame_t *libvlc_video_frame_retain( libvlc_video_frame_t *frame );
+
+/**
+ * Release a video frame, decreasing its reference count.
+ *
+ * The frame buffers return to the decoder once the last reference is
+ * released.
+ *
+ * \param frame the frame
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_video_frame_release( libvlc_video_frame_t *frame );
+
+/**
+ * Get the format of a video frame.
+ *
+ * \param frame the frame
+ * \param chroma four-characters string identifying the chroma, including
+ *               the terminating nul character [OUT]
+ * \param width visible width of the frame, in pixels [OUT]
+ * \param height visible height of the frame, in pixels [OUT]
+ * \return the number of pixel planes
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+unsigned libvlc_video_frame_get_format( const libvlc_video_frame_t *frame,
+                                        char chroma[5], unsigned *width,
+                                        unsigned *height );
+
+/**
+ * Get a pixel plane of a video frame.
+ *
+ * The returned address points to the first visible pixel of the plane. The
+ * buffer is valid until the frame is released.
+ *
+ * \param frame the frame
+ * \param plane index of the plane, lower than the count returned by
+ *              libvlc_video_frame_get_format()
+ * \param pitch length of a line, in bytes [OUT]
+ * \param lines number of visible lines [OUT]
+ * \return start address of the plane
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+const void *libvlc_video_frame_get_plane( const libvlc_video_frame_t *frame,
+                                          unsigned plane, unsigned *pitch,
+                                          unsigned *lines );
+
+/**
+ * Opaque type of a media decoder.
+ *
+ * A media decoder decodes a media as fast as possible, without any clock,
+ * audio output nor video output, for analysis purposes.
+ *
+ * \see libvlc_media_decoder_new()
+ */
+typedef struct libvlc_media_decoder_t libvlc_media_decoder_t;
+
+/**
+ * Callback prototype for the pictures of a media decoder.
+ *
+ * It is invoked from the video decoding thread, for every decoded picture,
+ * in the decoder chroma and dimensions.
+ *
+ * \param opaque private pointer as passed to libvlc_media_decoder_new() [IN]
+ * \param frame the picture, to release with libvlc_video_frame_release()
+ *              (possibly later, from any thread) [IN]
+ * \param pts time stamp of the picture in the media (in microseconds)
+ */
+typedef void (*libvlc_media_decoder_video_cb)(void *opaque,
+                                              libvlc_video_frame_t *frame,
+                                              int64_t pts);
+
+/**
+ * Callback prototype for the audio samples of a media decoder.
+ *
+ * It is invoked from the audio decoding thread, for every decoded block, in
+ * the decoder format. The samples are interleaved.
+ *
+ * \param opaque private pointer as passed to libvlc_media_decoder_new() [IN]
+ * \param samples audio samples, only valid during the call [IN]
+ * \param count number of samples per channel
+ * \param pts time stamp of the first sample in the media (in microseconds)
+ * \param format four-characters string identifying the sample format [IN]
+ * \param rate sample rate (expressed in Hz)
+ * \param channels channels count
+ */
+typedef void (*libvlc_media_decoder_audio_cb)(void *opaque,
+                                              const void *samples,
+                                              unsigned count, int64_t pts,
+                                              const char *format,
+                                              unsigned rate,
+                                              unsigned channels);
+
+/**
+ * Callback prototype for the end of a media decoder.
+ *
+ * It is invoked once, after all the pictures and audio samples were
+ * delivered or on error.
+ *
+ * \param opaque private pointer as passed to libvlc_media_decoder_new() [IN]
+ */
+typedef void (*libvlc_media_decoder_ended_cb)(void *opaque);
+
+/**
+ * Start decoding a media as fast as possible.
+ *
+ * The media is demuxed without regard to its clock, and its audio and video
+ * tracks are decoded in parallel, each by its own thread(s). The callbacks
+ * provide the backpressure: the longer they take, the slower the decoding
+ * goes, without any data being dropped. Subtitles are not decoded.
+ *
+ * \param md the media to decode
+ * \param video callback for the decoded pictures (or NULL to skip video)
+ * \param audio callback for the decoded audio (or NULL to skip audio)
+ * \param ended callback for the end of the decoding (or NULL)
+ * \param opaque private pointer for the callbacks (as first parameter)
+ * \return a media decoder, or NULL on error
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API libvlc_media_decoder_t *
+libvlc_media_decoder_new( libvlc_media_t *md,
+                          libvlc_media_decoder_video_cb video,
+                          libvlc_media_decoder_audio_cb audio,
+                          libvlc_media_decoder_ended_cb ended,
+                          void *opaque );
+
+/**
+ * Stop and release a media decoder.
+ *
+ * No callbacks are invoked once this function returns. The pictures that
+ * were not released yet stay valid.
+ *
+ * \param dec the media decoder
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_media_decoder_release( libvlc_media_decoder_t *dec );
+
 
 typedef struct libvlc_video_setup_device_cfg_t
 {
@@ -1122,6 +1320,72 @@ LIBVLC_API
 void libvlc_audio_set_format( libvlc_media_player_t *mp, const char *format,
                               unsigned rate, unsigned channels );
 
+/**
+ * Callback prototype for audio chunks availability.
+ *
+ * LibVLC invokes this callback, from the audio output thread and without
+ * holding any lock, whenever a new chunk is available for reading with
+ * libvlc_audio_read_chunk(). It should only wake the reading thread up.
+ *
+ * \param opaque private pointer as passed to
+ *               libvlc_audio_set_chunk_buffer() [IN]
+ */
+typedef void (*libvlc_audio_chunk_cb)(void *opaque);
+
+/**
+ * Sets a ring buffer of planar float chunks for decoded audio.
+ *
+ * Instead of calling back the application for every decoded block, LibVLC
+ * converts the samples to single precision floats, splits them per channel
+ * and packs them into chunks of a fixed number of samples. The application
+ * reads the chunks at its own cadence with libvlc_audio_read_chunk().
+ *
+ * The ring buffer is single producer/single consumer, and never blocks the
+ * audio output: if the application does not read fast enough and all the
+ * chunks are filled, the new samples are dropped until a chunk is read.
+ * Flushing discards the partially filled chunk, while draining (at the end of
+ * the stream) makes it available as a shorter chunk.
+ *
+ * This is mutually exclusive with libvlc_audio_set_callbacks() and
+ * libvlc_audio_set_format_callbacks(), and can only be called once for a
+ * given media player.
+ *
+ * \param mp the media player
+ * \param rate sample rate (expressed in Hz)
+ * \param channels channels count
+ * \param samples number of samples per channel in a chunk
+ * \param count number of chunks in the ring buffer
+ * \param notify callback invoked when a chunk is available (or NULL)
+ * \param opaque private pointer for the notify callback
+ * \return 0 on success, -1 on error
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+int libvlc_audio_set_chunk_buffer( libvlc_media_player_t *mp,
+                                   unsigned rate, unsigned channels,
+                                   unsigned samples, unsigned count,
+                                   libvlc_audio_chunk_cb notify,
+                                   void *opaque );
+
+/**
+ * Reads the oldest available audio chunk.
+ *
+ * This function does not block, and can be called from any single thread
+ * (but not from several threads concurrently).
+ *
+ * \param mp the media player
+ * \param planes table of channels count buffers, to receive the
+ *               samples per channel of the chunk [OUT]
+ * \param pts expected play time stamp of the first sample of the chunk
+ *            (see libvlc_delay()) [OUT]
+ * \return the number of samples per channel of the chunk,
+ *         0 if no chunk is available
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+unsigned libvlc_audio_read_chunk( libvlc_media_player_t *mp,
+                                  float *const *planes, int64_t *pts );
+
 /** \bug This might go away ... to be replaced by a broader system */
 
 /**
@@ -1317,6 +1581,40 @@ LIBVLC_API bool libvlc_media_player_program_scrambled( libvlc_media_player_t *p_
  */
 LIBVLC_API void libvlc_media_player_next_frame( libvlc_media_player_t *p_mi );
 
+#define LIBVLC_FRAME_PACING_BUCKETS 8
+
+/**
+ * Video frame pacing histograms
+ *
+ * Each histogram counts the video pictures whose delay (in milliseconds) is
+ * below 1, 2, 4, 8... and the last bucket counts the rest.
+ */
+typedef struct libvlc_frame_pacing_t
+{
+    /** lateness of the decoded pictures, when dequeued by the video output */
+    uint64_t decode_late[LIBVLC_FRAME_PACING_BUCKETS];
+    /** deinterlacing and post-processing time */
+    uint64_t filter_time[LIBVLC_FRAME_PACING_BUCKETS];
+    /** rendering time (video filters, subpictures and display preparation) */
+    uint64_t render_time[LIBVLC_FRAME_PACING_BUCKETS];
+    /** lateness of the displayed pictures (missed vertical syncs) */
+    uint64_t display_late[LIBVLC_FRAME_PACING_BUCKETS];
+} libvlc_frame_pacing_t;
+
+/**
+ * Get the video frame pacing histograms of the current media
+ *
+ * The histograms accumulate since the media was started.
+ *
+ * \param p_mi the media player
+ * \param pacing the histograms [OUT]
+ * \return 0 on success, -1 if there is no media
+ *
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API int libvlc_media_player_get_frame_pacing( libvlc_media_player_t *p_mi,
+                                                     libvlc_frame_pacing_t *pacing );
+
 /**
  * Navigate through DVD Menu
  *
@@ -395,6 +395,53 @@ static inline void aout_PauseDefault(audio_output_t *aout, bool paused,
     (void) date;
 }
 
+/**
+ * \defgroup aout_pull Callback-driven audio output
+ *
+ * Helpers for audio outputs whose device pulls samples from a realtime
+ * callback. The core queues the samples in a lock-free ring, and implements
+ * the time_get(), play(), pause() and flush() callbacks on top of it.
+ * @{
+ */
+
+/**
+ * Switches the audio output to pull mode.
+ *
+ * This is to be called from the start() callback, before the device starts
+ * rendering. It sets the time_get(), play(), pause(), flush() and drain()
+ * callbacks, replacing any value from the module.
+ *
+ * \param fmt output sample format (must be linear)
+ * \param buffer duration of samples queued for the device at most
+ * \param latency device latency until the first aout_PullRender() call
+ * \return VLC_SUCCESS, or an error code if the format is not supported
+ */
+VLC_API int aout_PullStart(audio_output_t *, const audio_sample_format_t *fmt,
+                           vlc_tick_t buffer, vlc_tick_t latency);
+
+/**
+ * Leaves pull mode.
+ *
+ * This is to be called from the stop() callback, after the device stopped
+ * rendering.
+ */
+VLC_API void aout_PullStop(audio_output_t *);
+
+/**
+ * Renders samples from the realtime callback of the device.
+ *
+ * This never blocks, locks nor allocates. Missing samples (underrun, pause)
+ * are replaced with silence.
+ *
+ * \param buf interleaved samples buffer to fill [OUT]
+ * \param frames number of frames to render
+ * \param latency delay until the first frame of the buffer will be heard
+ */
+VLC_API void aout_PullRender(audio_output_t *, void *buf, size_t frames,
+                             vlc_tick_t latency);
+
+/** @} */
+
 #define AOUT_RESTART_FILTERS        0x1
 #define AOUT_RESTART_OUTPUT         (AOUT_RESTART_FILTERS|0x2)
 #define AOUT_RESTART_STEREOMODE     (AOUT_RESTART_OUTPUT|0x4)
@@ -588,6 +635,41 @@ VLC_API void     aout_FiltersChangeViewpoint(aout_filters_t *, const vlc_viewpoi
 
 VLC_API vout_thread_t *aout_filter_GetVout(filter_t *, const video_format_t *);
 
+/**
+ * Gets the output buffer of an audio filter.
+ *
+ * If the output fits in the input buffer, the input buffer is returned with
+ * its size adjusted, and the filter shall process it in place: frames are
+ * processed in order, and each input frame is read entirely before the
+ * matching output frame is written. This saves one allocation and one copy
+ * per filter for conversions that do not grow the data (e.g. downmixing).
+ *
+ * Otherwise, a new buffer with the timestamps of the input is allocated, and
+ * the caller remains responsible for releasing the input buffer.
+ *
+ * \param in input buffer
+ * \param size output size in bytes
+ * \return the output buffer, possibly in, or NULL on allocation error
+ */
+static inline block_t *aout_filter_GetBuffer(block_t *in, size_t size)
+{
+    if (size <= in->i_buffer)
+    {
+        in->i_buffer = size;
+        return in;
+    }
+
+    block_t *out = block_Alloc(size);
+    if (likely(out != NULL))
+    {
+        out->i_nb_samples = in->i_nb_samples;
+        out->i_dts = in->i_dts;
+        out->i_pts = in->i_pts;
+        out->i_length = in->i_length;
+    }
+    return out;
+}
+
 /** @} */
 
 /**
@@ -47,6 +47,14 @@ struct audio_volume
 
     vlc_fourcc_t format; /**< Audio samples format */
     void (*amplify)(audio_volume_t *, block_t *, float); /**< Amplifier */
+    /**
+     * Amplifier with a gain change (optional)
+     *
+     * The gain goes linearly from the first value (excluded) to the second
+     * one (reached at the last sample) over the buffer, so that volume
+     * changes do not click.
+     */
+    void (*amplify_ramp)(audio_volume_t *, block_t *, float, float);
 };
 
 /** @} */
@@ -86,6 +86,10 @@
 #define block_Release vlc_frame_Release
 #define block_CopyProperties vlc_frame_CopyProperties
 #define block_Duplicate vlc_frame_Duplicate
+#define block_Shared vlc_frame_Shared
+#define block_Clone vlc_frame_Clone
+#define block_IsShared vlc_frame_IsShared
+#define block_MakeWritable vlc_frame_MakeWritable
 #define block_heap_Alloc vlc_frame_heap_Alloc
 #define block_mmap_Alloc vlc_frame_mmap_Alloc
 #define block_shm_Alloc vlc_frame_shm_Alloc
@@ -66,6 +66,9 @@ struct decoder_owner_callbacks
             /* Display rate
              * cf. decoder_GetDisplayRate */
             float       (*get_display_rate)( decoder_t * );
+            /* Hurry level
+             * cf. decoder_GetHurryLevel */
+            unsigned    (*get_hurry_level)( decoder_t * );
         } video;
         struct
         {
@@ -90,6 +93,10 @@ struct decoder_owner_callbacks
     int (*get_attachments)( decoder_t *p_dec,
                             input_attachment_t ***ppp_attachment,
                             int *pi_attachment );
+
+    /* Decoding threads budget
+     * cf. decoder_GetThreadBudget */
+    unsigned (*get_thread_budget)( decoder_t *, unsigned max );
 };
 
 /*
@@ -178,6 +185,20 @@ struct decoder_t
         vlc_frame_t *   ( * pf_packetize )( decoder_t *, vlc_frame_t  **ppframe );
     };
 
+    /* This function is optional and only used by decoders. If set, it may be
+     * called instead of pf_decode() with a chain of packetized blocks (linked
+     * through p_next), so as to decode several blocks at a lower cost per
+     * block. The blocks have to be processed exactly as if pf_decode() had been
+     * called for each of them in turn.
+     *
+     * The module implementation will own the whole chain. pf_decode() is still
+     * used for draining and for single blocks.
+     *
+     * Return values are the same as pf_decode(), except that VLCDEC_RELOAD is
+     * not allowed: a module that may request a reload should not set it.
+     */
+    int                 ( * pf_decode_batch ) ( decoder_t *, vlc_frame_t *chain );
+
     /* */
     void                ( * pf_flush ) ( decoder_t * );
 
@@ -531,6 +552,29 @@ static inline int decoder_GetInputAttachments( decoder_t *dec,
     return dec->cbs->get_attachments( dec, ppp_attachment, pi_attachment );
 }
 
+/**
+ * This function returns how many threads the decoder module may use.
+ *
+ * Decoders that size their own thread pool should call it once they know how
+ * many threads they would use at most, and then use no more than the returned
+ * number of threads. The owner shares a budget between all the decoders
+ * running at the same time. Calling it again (e.g. when restarting the codec)
+ * replaces the previous request.
+ *
+ * \param max the number of threads the decoder would use on its own
+ * \return the number of threads to use, between 1 and max (or max if the
+ * owner does not enforce any budget)
+ */
+static inline unsigned decoder_GetThreadBudget( decoder_t *dec, unsigned max )
+{
+    vlc_assert( dec->cbs != NULL );
+
+    if( max <= 1 || dec->cbs->get_thread_budget == NULL )
+        return max;
+
+    return dec->cbs->get_thread_budget( dec, max );
+}
+
 /**
  * This function converts a decoder timestamp into a display date comparable
  * to vlc_tick_now().
@@ -564,6 +608,38 @@ static inline float decoder_GetDisplayRate( decoder_t *dec )
     return dec->cbs->video.get_display_rate( dec );
 }
 
+/**
+ * Decoding shortcuts suggested to a video decoder that cannot keep up.
+ *
+ * Each level includes the shortcuts of the lower levels.
+ */
+enum decoder_hurry_level
+{
+    DECODER_HURRY_NONE, /**< decode everything */
+    DECODER_HURRY_LOOP_FILTER, /**< skip the in-loop deblocking */
+    DECODER_HURRY_NONREF, /**< skip the non-reference pictures */
+    DECODER_HURRY_BIDIR, /**< skip all bidirectional pictures */
+};
+
+/**
+ * This function returns how much the decoder should hurry.
+ *
+ * The owner raises the level step by step while the video output drops or
+ * displays pictures late, and lowers it back once the output keeps up.
+ *
+ * \return a decoder_hurry_level value
+ */
+VLC_USED
+static inline unsigned decoder_GetHurryLevel( decoder_t *dec )
+{
+    vlc_assert( dec->fmt_in.i_cat == VIDEO_ES && dec->cbs != NULL );
+
+    if( !dec->cbs->video.get_hurry_level )
+        return DECODER_HURRY_NONE;
+
+    return dec->cbs->video.get_hurry_level( dec );
+}
+
 /** @} */
 
 /**
@@ -662,5 +738,36 @@ vlc_decoder_device_Hold(vlc_decoder_device *device);
 VLC_API void
 vlc_decoder_device_Release(vlc_decoder_device *device);
 
+/**
+ * Keep unused hardware surfaces for a later decoder
+ *
+ * Instead of freeing the surfaces it no longer uses, a decoder can leave them
+ * to the next decoder of the same device needing the same ones, e.g. after a
+ * restart or a channel change. The device takes ownership of the surfaces and
+ * releases them if they are not taken back soon enough, or at the latest
+ * before it is closed.
+ *
+ * \param key description of the surfaces (format, size, count...), compared
+ *            byte for byte with the keys of vlc_decoder_device_TakeSurfaces()
+ * \param key_size size of the key in bytes
+ * \param surfaces opaque surfaces data
+ * \param release function to free the surfaces
+ */
+VLC_API void
+vlc_decoder_device_PutSurfaces(vlc_decoder_device *device,
+                               const void *key, size_t key_size,
+                               void *surfaces, void (*release)(void *));
+
+/**
+ * Take back hardware surfaces kept by the device
+ *
+ * \see vlc_decoder_device_PutSurfaces()
+ *
+ * \return surfaces matching the key, now owned by the caller, or NULL
+ */
+VLC_API void *
+vlc_decoder_device_TakeSurfaces(vlc_decoder_device *device,
+                                const void *key, size_t key_size);
+
 /** @} */
 #endif /* _VLC_CODEC_H */
@@ -47,6 +47,7 @@ unsigned vlc_CPU_raw(void);
 #  define VLC_CPU_SSE4_1 0x00000400
 #  define VLC_CPU_AVX    0x00002000
 #  define VLC_CPU_AVX2   0x00004000
+#  define VLC_CPU_AVX512 0x00008000 /* AVX-512 F and BW */
 
 # if defined (__SSE__)
 #  define VLC_SSE
@@ -92,6 +93,12 @@ unsigned vlc_CPU_raw(void);
 #  define vlc_CPU_AVX2() ((vlc_CPU() & VLC_CPU_AVX2) != 0)
 # endif
 
+# if defined (__AVX512F__) && defined (__AVX512BW__)
+#  define vlc_CPU_AVX512() (1)
+# else
+#  define vlc_CPU_AVX512() ((vlc_CPU() & VLC_CPU_AVX512) != 0)
+# endif
+
 # elif defined (__ppc__) || defined (__ppc64__) || defined (__powerpc__)
 #  define HAVE_FPU 1
 #  define VLC_CPU_ALTIVEC 2
@@ -214,6 +221,60 @@ static inline void vlc_CPU_functions_init_once(const char *name,
 }
 # endif
 
+/**
+ * \defgroup cpu_topology CPU topology
+ * \ingroup cpu
+ * @{
+ */
+
+/**
+ * Processor topology.
+ */
+struct vlc_cpu_topology
+{
+    unsigned cpus; /**< Online logical processors */
+    unsigned cores; /**< Physical cores (excluding SMT siblings) */
+    unsigned nodes; /**< NUMA nodes */
+};
+
+/**
+ * Queries the processor topology.
+ *
+ * If the platform does not expose the topology, each logical processor is
+ * reported as a core of its own, within a single NUMA node.
+ */
+VLC_API void vlc_CPU_GetTopology(struct vlc_cpu_topology *topo);
+
+/**
+ * Gets the NUMA node of a logical processor.
+ *
+ * \param cpu logical processor index
+ * \return the NUMA node index, or -1 if the processor is not online
+ */
+VLC_API int vlc_CPU_GetNode(unsigned cpu) VLC_USED;
+
+/**
+ * Applies the processor affinity policy of a thread class.
+ *
+ * This sets the processor affinity of the calling thread according to the
+ * "<thread_class>-affinity" variable inherited from the given object.
+ * The policy is a comma-separated list of processor indices or ranges (e.g.
+ * "0-3,8"), and/or of NUMA nodes (e.g. "node:1"). An empty policy leaves the
+ * affinity unchanged.
+ *
+ * Threads should call this at the start of their entry function, so that
+ * the memory they touch first (e.g. picture or block pools) is allocated
+ * on their node by the operating system.
+ *
+ * \param obj object to inherit the policy from
+ * \param thread_class thread class name, e.g. "decoder"
+ * \retval 0 the policy was applied or is empty
+ * \retval -1 the policy is invalid or could not be applied
+ */
+VLC_API int vlc_CPU_PinThread(vlc_object_t *obj, const char *thread_class);
+
+/** @} */
+
 #define set_cpu_funcs(name, activate, priority) \
     set_callback(VLC_CHECKED_TYPE(void (*)(void *), activate)) \
     set_capability(name, priority)
@@ -47,6 +47,15 @@ VLC_API void vlc_input_decoder_Drain( vlc_input_decoder_t * );
 VLC_API void vlc_input_decoder_Flush( vlc_input_decoder_t * );
 VLC_API int  vlc_input_decoder_SetSpuHighlight( vlc_input_decoder_t *, const vlc_spu_highlight_t * );
 
+/**
+ * Returns the memory used by the data waiting to be decoded.
+ *
+ * \param process whether to count the decoders of all the instances of the
+ * process, rather than only those of the given instance
+ * \return the size in bytes of the data queued to the decoders
+ */
+VLC_API size_t vlc_input_decoder_GetBufferUsage( libvlc_int_t *, bool process );
+
 /**
  * It creates an empty input resource handler.
  *
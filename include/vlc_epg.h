@@ -72,6 +72,9 @@ VLC_API vlc_epg_event_t * vlc_epg_event_New(uint16_t i_id,
 
 /**
  * Releases a vlc_epg_event_t*.
+ *
+ * The event is only freed once no table duplicated by vlc_epg_Duplicate()
+ * shares it anymore.
  */
 VLC_API void vlc_epg_event_Delete(vlc_epg_event_t *p_event);
 
@@ -110,8 +113,10 @@ VLC_API bool vlc_epg_AddEvent(vlc_epg_t *p_epg, vlc_epg_event_t *p_evt);
 VLC_API void vlc_epg_SetCurrent(vlc_epg_t *p_epg, int64_t i_start);
 
 /**
- * Returns a duplicated \p p_src and its associated events.
+ * Returns a duplicated \p p_src, sharing its associated events.
  *
+ * The events of a table must not be modified once it has been duplicated,
+ * vlc_epg_event_Duplicate() returns a copy that can be.
  */
 VLC_API vlc_epg_t * vlc_epg_Duplicate(const vlc_epg_t *p_src);
 
@@ -31,6 +31,20 @@ extern "C" {
 /** Executor type (opaque) */
 typedef struct vlc_executor vlc_executor_t;
 
+/**
+ * Runnable priorities.
+ *
+ * Pending runnables of higher priority are always started before pending
+ * runnables of lower priority. Runnables of the same priority are started in
+ * submission order.
+ */
+enum vlc_runnable_priority
+{
+    VLC_RUNNABLE_PRIORITY_LOW = -1, /**< background tasks */
+    VLC_RUNNABLE_PRIORITY_NORMAL = 0, /**< default */
+    VLC_RUNNABLE_PRIORITY_HIGH = 1, /**< latency-sensitive tasks */
+};
+
 /**
  * A Runnable encapsulates a task to be run from an executor thread.
  */
@@ -58,6 +72,13 @@ struct vlc_runnable {
      */
     void *userdata;
 
+    /**
+     * Scheduling priority (@ref VLC_RUNNABLE_PRIORITY_NORMAL if zeroed).
+     *
+     * It is read when the runnable is submitted.
+     */
+    enum vlc_runnable_priority priority;
+
     /* Private data used by the vlc_executor_t (do not touch) */
     struct vlc_list node;
 };
@@ -172,6 +172,34 @@ VLC_API vlc_frame_t *vlc_frame_Init(vlc_frame_t *frame,
  */
 VLC_API vlc_frame_t *vlc_frame_Alloc(size_t size) VLC_USED VLC_MALLOC;
 
+/**
+ * Frame allocator statistics for one size class.
+ *
+ * Small frames allocated by vlc_frame_Alloc() are recycled through per-thread
+ * and process-wide caches instead of going through the heap every time.
+ */
+struct vlc_frame_pool_stats
+{
+    size_t size; /**< Allocation size of the class, including overhead */
+    uint64_t hits; /**< Allocations recycled from a cache */
+    uint64_t misses; /**< Allocations from the heap */
+    uint64_t drops; /**< Releases to the heap, as the caches were full */
+    size_t cached; /**< Frames currently held by the process-wide cache */
+};
+
+/**
+ * Gets frame allocator statistics.
+ *
+ * Counters from the per-thread caches are only accounted for periodically,
+ * so the values are approximate.
+ *
+ * @param stats table to fill with the statistics of each size class
+ * @param count number of entries in the table
+ * @return the total number of size classes (possibly more than @c count)
+ */
+VLC_API size_t vlc_frame_pool_GetStats(struct vlc_frame_pool_stats *stats,
+                                       size_t count);
+
 VLC_API vlc_frame_t *vlc_frame_TryRealloc(vlc_frame_t *, ssize_t pre, size_t body) VLC_USED;
 
 /**
@@ -270,6 +298,49 @@ static inline vlc_frame_t *vlc_frame_Duplicate( const vlc_frame_t *frame )
     return p_dup;
 }
 
+/**
+ * Turns a frame into a shared frame.
+ *
+ * The payload of a shared frame can be referenced by several frames at once
+ * with vlc_frame_Clone(), without copying. Each reference has its own
+ * properties and payload bounds, but the payload itself is read-only: any
+ * code modifying a frame payload in place must first call
+ * vlc_frame_MakeWritable(). vlc_frame_TryRealloc() copies the payload as
+ * needed.
+ *
+ * @param frame frame to share (will be consumed)
+ * @return the shared frame, or @c frame itself if it is already shared or
+ * on memory error (this function cannot fail)
+ */
+VLC_API vlc_frame_t *vlc_frame_Shared(vlc_frame_t *frame) VLC_USED;
+
+/**
+ * Creates another reference to a frame.
+ *
+ * The payload of a shared frame is referenced without copying.
+ * Other frames are duplicated as with vlc_frame_Duplicate().
+ *
+ * @return the new reference on success, NULL on error.
+ */
+VLC_API vlc_frame_t *vlc_frame_Clone(const vlc_frame_t *frame) VLC_USED;
+
+/**
+ * Checks whether the payload of a frame is referenced by other frames.
+ */
+VLC_API bool vlc_frame_IsShared(const vlc_frame_t *frame) VLC_USED;
+
+/**
+ * Makes the payload of a frame writable.
+ *
+ * If the payload is referenced by other frames, it is copied into a new
+ * frame, and the reference is released.
+ *
+ * @param frame frame to write into (will be consumed)
+ * @return a frame with a writable payload, or NULL on memory error (in that
+ * case, @c frame is released)
+ */
+VLC_API vlc_frame_t *vlc_frame_MakeWritable(vlc_frame_t *frame) VLC_USED;
+
 /**
  * Wraps heap in a frame.
  *
@@ -93,4 +93,62 @@ VLC_API bool vlc_http_cookies_store( vlc_http_cookie_jar_t *jar,
 VLC_API char *vlc_http_cookies_fetch( vlc_http_cookie_jar_t *jar, bool secure,
                                       const char *host, const char *path );
 
+/* Idle connections */
+
+typedef struct vlc_http_pool vlc_http_pool_t;
+
+/**
+ * Creates a pool of idle HTTP connections.
+ *
+ * The pool lets HTTP clients hand over their persistent (keep-alive)
+ * connections when they are done, so that the next client for the same
+ * server can skip the TCP and TLS handshakes.
+ *
+ * @param obj parent object, also used to create the TLS credentials
+ */
+VLC_API vlc_http_pool_t *vlc_http_pool_new( vlc_object_t *obj ) VLC_USED;
+
+/**
+ * Destroys a pool, releasing all the idle connections left in it.
+ */
+VLC_API void vlc_http_pool_destroy( vlc_http_pool_t *pool );
+
+/**
+ * Hands an idle connection over to the pool.
+ *
+ * The pool takes ownership of the connection. It is released with the
+ * supplied callback if it expires or cannot be kept.
+ *
+ * @param pool connections pool
+ * @param key identifier of the server and protocol of the connection
+ * @param conn opaque connection
+ * @param release callback to release the connection
+ */
+VLC_API void vlc_http_pool_put( vlc_http_pool_t *pool, const char *key,
+                                void *conn, void (*release)(void *) );
+
+/**
+ * Takes an idle connection from the pool.
+ *
+ * The caller takes ownership of the connection. The connection may have been
+ * closed by the server meanwhile, so the first request sent through it must
+ * be idempotent.
+ *
+ * @return the most recently used connection matching the key, or NULL
+ */
+VLC_API void *vlc_http_pool_get( vlc_http_pool_t *pool,
+                                 const char *key ) VLC_USED;
+
+/**
+ * Returns the TLS client credentials of the pool.
+ *
+ * Connections in the pool outlive the clients that established them. TLS
+ * sessions must therefore use the credentials of the pool. They are loaded
+ * on first use.
+ *
+ * @return TLS credentials (owned by the pool), or NULL on error
+ */
+VLC_API struct vlc_tls_client *vlc_http_pool_get_tls( vlc_http_pool_t *pool )
+VLC_USED;
+
 #endif /* VLC_HTTP_H */
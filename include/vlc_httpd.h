@@ -117,6 +117,20 @@ VLC_API void httpd_UrlDelete( httpd_url_t * );
 VLC_API char* httpd_ClientIP( const httpd_client_t *cl, char *, int * );
 VLC_API char* httpd_ServerIP( const httpd_client_t *cl, char *, int * );
 
+/**
+ * Defers the answer to a query, from a URL callback.
+ *
+ * The callback should return VLC_SUCCESS without filling the answer. It is
+ * invoked again for the same query after httpd_HostWakeUp() is called, or
+ * once the timeout elapsed.
+ *
+ * @return false if the timeout has elapsed, in which case the callback must
+ * answer now
+ */
+VLC_API bool httpd_ClientDefer( httpd_client_t *, vlc_tick_t timeout );
+/* invoke the callbacks of the deferred queries again */
+VLC_API void httpd_HostWakeUp( httpd_host_t * );
+
 /* High level */
 
 typedef struct httpd_file_t     httpd_file_t;
@@ -64,6 +64,8 @@ VLC_API image_handler_t * image_HandlerCreate( vlc_object_t * ) VLC_USED;
 #define image_HandlerCreate( a ) image_HandlerCreate( VLC_OBJECT(a) )
 VLC_API void image_HandlerDelete( image_handler_t * );
 
+/* The size set in the output format, if any, is passed to the decoder,
+ * which may then decode at a reduced scale. */
 #define image_Read( a, b, c, d ) a->pf_read( a, b, c, d )
 #define image_ReadUrl( a, b, c ) a->pf_read_url( a, b, c )
 #define image_Write( a, b, c, d ) a->pf_write( a, b, c, d )
@@ -284,6 +284,35 @@ VLC_API void input_item_SetMeta( input_item_t *, vlc_meta_type_t meta_type, cons
 VLC_API bool input_item_MetaMatch( input_item_t *p_i, vlc_meta_type_t meta_type, const char *psz );
 VLC_API char * input_item_GetMeta( input_item_t *p_i, vlc_meta_type_t meta_type ) VLC_USED;
 VLC_API const char *input_item_GetMetaLocked(input_item_t *, vlc_meta_type_t meta_type);
+
+/**
+ * Immutable copy of the meta data of an input item.
+ */
+typedef struct input_item_meta_snapshot input_item_meta_snapshot_t;
+
+/**
+ * Gets the current meta data of an input item.
+ *
+ * The snapshot is shared by all the readers until the meta data changes, so
+ * it is usually obtained without locking the item nor copying anything. It
+ * does not see the later changes of the item.
+ *
+ * \return a snapshot to release with input_item_meta_snapshot_Release(),
+ * or NULL on memory error
+ */
+VLC_API input_item_meta_snapshot_t *
+input_item_HoldMetaSnapshot(input_item_t *) VLC_USED;
+
+VLC_API void input_item_meta_snapshot_Release(input_item_meta_snapshot_t *);
+
+/**
+ * Gets a meta data value from a snapshot.
+ *
+ * \return the value, valid as long as the snapshot is held, or NULL
+ */
+VLC_API const char *
+input_item_meta_snapshot_Get(const input_item_meta_snapshot_t *,
+                             vlc_meta_type_t meta_type);
 VLC_API char * input_item_GetName( input_item_t * p_i ) VLC_USED;
 VLC_API char * input_item_GetTitleFbName( input_item_t * p_i ) VLC_USED;
 VLC_API char * input_item_GetURI( input_item_t * p_i ) VLC_USED;
@@ -482,6 +511,9 @@ typedef enum input_item_meta_request_option_t
     META_REQUEST_OPTION_FETCH_NETWORK = 0x08,
     META_REQUEST_OPTION_FETCH_ANY     = 0x0C,
     META_REQUEST_OPTION_DO_INTERACT   = 0x10,
+    /* only read the tags of local files if possible, without opening them
+     * (the duration and the tracks are not known) */
+    META_REQUEST_OPTION_META_ONLY     = 0x20,
 } input_item_meta_request_option_t;
 
 /* status of the on_preparse_ended() callback */
@@ -516,6 +548,9 @@ VLC_API void libvlc_MetadataCancel( libvlc_int_t *, void * );
 /******************
  * Input stats
  ******************/
+#define INPUT_STATS_CLOCK_BUCKETS 8
+#define INPUT_STATS_PACING_BUCKETS 8
+
 struct input_stats_t
 {
     /* Input */
@@ -542,6 +577,24 @@ struct input_stats_t
     /* Aout */
     int64_t i_played_abuffers;
     int64_t i_lost_abuffers;
+
+    /* Clock recovery, on live inputs
+     * The histograms count the clock references whose jitter (in ms) or
+     * estimated drift (in ppm, absolute) is below 1, 2, 4... and the last
+     * bucket counts the rest. */
+    float f_clock_drift; /**< current drift estimate (ppm) */
+    int64_t i_clock_jitter[INPUT_STATS_CLOCK_BUCKETS];
+    int64_t i_clock_drift[INPUT_STATS_CLOCK_BUCKETS];
+    /** expected delay from the reception to the rendering (us) */
+    int64_t i_latency;
+
+    /* Video frame pacing
+     * The histograms count the pictures whose delay (in ms) is below 1, 2,
+     * 4... and the last bucket counts the rest. */
+    int64_t i_decode_late[INPUT_STATS_PACING_BUCKETS]; /**< dequeued after their date */
+    int64_t i_filter_time[INPUT_STATS_PACING_BUCKETS]; /**< static filtering */
+    int64_t i_render_time[INPUT_STATS_PACING_BUCKETS]; /**< rendering and preparation */
+    int64_t i_display_late[INPUT_STATS_PACING_BUCKETS]; /**< displayed after their date */
 };
 
 /**
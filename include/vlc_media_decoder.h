@@ -0,0 +1,87 @@
+/*****************************************************************************
+ * vlc_media_decoder.h: Decoding a media without playback
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_MEDIA_DECODER_H
+#define VLC_MEDIA_DECODER_H
+
+#include <vlc_common.h>
+
+/**
+ * \defgroup media_decoder Media decoder
+ * \ingroup input
+ * Decoding of a media as fast as possible, without clock nor outputs
+ * @{
+ */
+
+typedef struct vlc_media_decoder_t vlc_media_decoder_t;
+
+struct vlc_media_decoder_cbs
+{
+    /**
+     * Called from the video decoder thread for every decoded picture
+     *
+     * The picture is only valid during the call, hold it to keep it.
+     * Returning late slows the decoding down, and eventually the demuxing.
+     * NULL to not decode the video.
+     */
+    void (*on_picture)(picture_t *pic, void *userdata);
+    /**
+     * Called from the audio decoder thread for every decoded block
+     *
+     * The samples are in the decoder output format, interleaved.
+     * NULL to not decode the audio.
+     */
+    void (*on_audio)(const audio_format_t *fmt, block_t *block,
+                     void *userdata);
+    /**
+     * Called once, after the last picture and block, at the end of the media
+     * or on error
+     */
+    void (*on_ended)(void *userdata);
+};
+
+/**
+ * Start decoding a media.
+ *
+ * The demuxer and one decoder thread per elementary stream run without
+ * waiting for any clock: video and audio are decoded in parallel, only
+ * paced by the callbacks. The subtitles are not decoded.
+ *
+ * \param parent parent object
+ * \param item media to decode
+ * \param cbs callbacks (must stay valid until vlc_media_decoder_Delete())
+ * \param userdata opaque pointer for the callbacks
+ * \return a media decoder, or NULL on error
+ */
+VLC_API vlc_media_decoder_t *
+vlc_media_decoder_New(vlc_object_t *parent, input_item_t *item,
+                      const struct vlc_media_decoder_cbs *cbs,
+                      void *userdata) VLC_USED;
+
+/**
+ * Stop decoding and release a media decoder.
+ *
+ * No callbacks are called once this function returns.
+ */
+VLC_API void vlc_media_decoder_Delete(vlc_media_decoder_t *dec);
+
+/** @} */
+
+#endif
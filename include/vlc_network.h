@@ -289,9 +289,25 @@ static inline int vlc_setsockopt(int s, int level, int name,
 VLC_API int vlc_getnameinfo( const struct sockaddr *, int, char *, int, int *, int );
 VLC_API int vlc_getaddrinfo (const char *, unsigned,
                              const struct addrinfo *, struct addrinfo **);
+
+/**
+ * Resolves a host name to a list of socket addresses (like getaddrinfo()).
+ *
+ * Unlike vlc_getaddrinfo(), the look-up can be interrupted (see
+ * vlc_interrupt_kill()), and recent results are cached for the process.
+ *
+ * @return 0 on success, a getaddrinfo() error otherwise.
+ * On success, the result must be freed with vlc_freeaddrinfo(), not
+ * freeaddrinfo().
+ */
 VLC_API int vlc_getaddrinfo_i11e(const char *, unsigned,
                                  const struct addrinfo *, struct addrinfo **);
 
+/**
+ * Frees a list of socket addresses from vlc_getaddrinfo_i11e().
+ */
+VLC_API void vlc_freeaddrinfo(struct addrinfo *);
+
 static inline bool
 net_SockAddrIsMulticast (const struct sockaddr *addr, socklen_t len)
 {
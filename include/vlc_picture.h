@@ -413,6 +413,27 @@ VLC_API void picture_Copy( picture_t *p_dst, const picture_t *p_src );
  */
 VLC_API picture_t *picture_Clone(picture_t *pic);
 
+/**
+ * Creates a view of a region of a picture
+ *
+ * The view points to the planes of the picture, offset to the top left corner
+ * of the region, with the same pitches: no pixels are copied. The picture is
+ * held until the view is released.
+ *
+ * This is only possible for pictures whose planes are in CPU memory. The
+ * offsets should be multiples of the chroma subsampling factors.
+ *
+ * \param pic picture to view
+ * \param fmt format of the view, of the same chroma, whose dimensions are
+ * those of the region
+ * \param x horizontal offset of the region in pic (in luma pixels)
+ * \param y vertical offset of the region in pic (in luma lines)
+ * \return a new picture on success, NULL on error or if the picture cannot
+ * be viewed
+ */
+VLC_API picture_t *picture_NewView(picture_t *pic, const video_format_t *fmt,
+                                   unsigned x, unsigned y) VLC_USED;
+
 /**
  * Attach an ancillary to the picture
  *
@@ -474,6 +495,18 @@ VLC_API int picture_Export( vlc_object_t *p_obj, block_t **pp_image, video_forma
                             picture_t *p_picture, vlc_fourcc_t i_format, int i_override_width,
                             int i_override_height, bool b_crop );
 
+/**
+ * Export a picture with an existing image handler.
+ *
+ * Same as picture_Export(), but the encoder and the converter of the handler
+ * are kept between calls, which avoids loading them again for every picture
+ * of a series exported with the same format and size.
+ */
+VLC_API int picture_ExportWithHandler( image_handler_t *p_image, block_t **pp_image,
+                                       video_format_t *p_fmt, picture_t *p_picture,
+                                       vlc_fourcc_t i_format, int i_override_width,
+                                       int i_override_height, bool b_crop );
+
 /**
  * This function will setup all fields of a picture_t without allocating any
  * memory.
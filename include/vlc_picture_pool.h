@@ -135,6 +135,45 @@ VLC_USED;
  */
 unsigned picture_pool_GetSize(const picture_pool_t *);
 
+/**
+ * Picture pool cache handle
+ *
+ * A cache keeps the pools of the recently used video formats, so that going
+ * back to a previous format does not allocate all the pictures again.
+ * The cache itself is not thread-safe.
+ */
+typedef struct picture_pool_cache_t picture_pool_cache_t;
+
+/**
+ * Creates a cache for up to size pools.
+ */
+VLC_API picture_pool_cache_t *picture_pool_cache_New(unsigned size) VLC_USED;
+
+/**
+ * Releases a cache and the pools it holds.
+ */
+VLC_API void picture_pool_cache_Delete(picture_pool_cache_t *);
+
+/**
+ * Takes a pool for the given format out of the cache.
+ *
+ * @param fmt video format of the pool pictures
+ * @param count number of pictures of the pool
+ *
+ * @return a pool (no longer canceled), or NULL if none matches
+ */
+VLC_API picture_pool_t *picture_pool_cache_Get(picture_pool_cache_t *,
+                                               const video_format_t *fmt,
+                                               unsigned count) VLC_USED;
+
+/**
+ * Gives a pool to the cache, instead of releasing it.
+ *
+ * The least recently used pool is released if the cache is full.
+ */
+VLC_API void picture_pool_cache_Put(picture_pool_cache_t *,
+                                    picture_pool_t *);
+
 
 #endif /* VLC_PICTURE_POOL_H */
 
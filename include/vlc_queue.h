@@ -254,5 +254,105 @@ static inline void *vlc_queue_DequeueKillable(vlc_queue_t *q,
 
 /** @} */
 
+/**
+ * @defgroup queue_ring Bounded lock-free queues
+ * Fixed-capacity thread-safe queues (ring buffers).
+ *
+ * Unlike @ref vlc_queue_t, a ring queue does not take any lock to enqueue or
+ * dequeue an entry, and it only issues a system call when a thread actually
+ * needs to be woken up. This suits hot paths with one consumer thread, such
+ * as a per-elementary stream output thread.
+ *
+ * Only one thread can dequeue from a given ring at a time.
+ * Only one thread can enqueue at a time, unless the ring was created with
+ * @ref VLC_RING_MULTI_PRODUCER.
+ * @{
+ */
+
+/**
+ * Opaque type for a bounded lock-free queue.
+ */
+typedef struct vlc_ring vlc_ring_t;
+
+/**
+ * Allows concurrent producers on a ring queue.
+ */
+#define VLC_RING_MULTI_PRODUCER 0x1
+
+/**
+ * Creates a ring queue.
+ *
+ * @param capacity maximum number of entries (rounded up to a power of two)
+ * @param flags zero or @ref VLC_RING_MULTI_PRODUCER
+ * @return a ring queue, or NULL on memory error
+ */
+VLC_API vlc_ring_t *vlc_ring_New(size_t capacity, unsigned flags) VLC_USED;
+
+/**
+ * Destroys a ring queue.
+ *
+ * The ring must be empty, or the remaining entries will be leaked.
+ * No threads may be using the ring anymore.
+ */
+VLC_API void vlc_ring_Delete(vlc_ring_t *);
+
+/**
+ * Queues an entry if there is space left.
+ *
+ * @param entry non-NULL entry to queue
+ * @retval true the entry was queued
+ * @retval false the ring is full, the entry was not queued
+ */
+VLC_API bool vlc_ring_TryEnqueue(vlc_ring_t *, void *entry) VLC_USED;
+
+/**
+ * Queues an entry.
+ *
+ * If the ring is full, this function waits until there is space left.
+ *
+ * @note This function is a cancellation point if it needs to wait.
+ * @param entry non-NULL entry to queue
+ * @retval 0 the entry was queued
+ * @retval -1 the ring was ended (see vlc_ring_Kill()), the entry was not
+ *            queued
+ */
+VLC_API int vlc_ring_Enqueue(vlc_ring_t *, void *entry);
+
+/**
+ * Dequeues the oldest entry if any.
+ *
+ * @return the oldest entry, or NULL if the ring is empty
+ */
+VLC_API void *vlc_ring_TryDequeue(vlc_ring_t *) VLC_USED;
+
+/**
+ * Dequeues the oldest entry.
+ *
+ * If the ring is empty, this function waits until an entry is queued or until
+ * the ring is ended.
+ *
+ * @note This function is a cancellation point if it needs to wait.
+ * @return the oldest entry, or NULL if the ring is empty and has been ended
+ */
+VLC_API void *vlc_ring_Dequeue(vlc_ring_t *) VLC_USED;
+
+/**
+ * Marks a ring queue ended.
+ *
+ * This wakes up every thread waiting within vlc_ring_Dequeue() or
+ * vlc_ring_Enqueue(). Entries already queued can still be dequeued.
+ */
+VLC_API void vlc_ring_Kill(vlc_ring_t *);
+
+/**
+ * Gets the approximate number of queued entries.
+ *
+ * The value may be stale by the time it is returned if other threads are
+ * concurrently using the ring.
+ */
+VLC_API size_t vlc_ring_GetCount(const vlc_ring_t *) VLC_USED;
+
+/** @} */
+
 /** @} */
 #endif
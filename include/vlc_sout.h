@@ -223,6 +223,58 @@ static inline bool sout_StreamIsSynchronous(sout_stream_t *s)
     return b;
 }
 
+/****************************************************************************
+ * Statistics
+ ****************************************************************************/
+
+enum sout_stats_type_e
+{
+    SOUT_STATS_STREAM, /**< stream output element (filter or output) */
+    SOUT_STATS_MUX, /**< multiplexer */
+    SOUT_STATS_ACCESS, /**< access output */
+};
+
+/**
+ * Counters of one stream output element.
+ *
+ * Elements are identified by a number unique within the process; the owner
+ * is the closest parent element (e.g. the stream output creating a mux).
+ */
+typedef struct
+{
+    unsigned    i_id;
+    unsigned    i_owner; /**< owner element identifier, or 0 if none */
+    unsigned    i_next; /**< next element in the chain, or 0 if none */
+    int         i_type; /**< sout_stats_type_e */
+    char        psz_name[32]; /**< module name */
+
+    uint64_t    i_blocks; /**< blocks received */
+    uint64_t    i_bytes; /**< bytes received */
+    uint64_t    i_late; /**< blocks processed slower than their length */
+    uint64_t    i_dropped; /**< blocks rejected with an error */
+    uint64_t    i_rate; /**< bytes per second, over the last sample */
+
+    unsigned    i_in_flight; /**< blocks being or waiting to be processed */
+    unsigned    i_queued; /**< blocks queued by the element */
+    size_t      i_queued_bytes;
+
+    vlc_tick_t  i_latency; /**< total time spent within the element */
+    vlc_tick_t  i_latency_max; /**< longest time spent for one block */
+} sout_stats_t;
+
+/**
+ * Takes a snapshot of the statistics of the stream output elements of the
+ * LibVLC instance of an object.
+ *
+ * The time spent within an element excludes the time spent within the
+ * elements it forwards data to.
+ *
+ * @param pp_stats pointer to an array to be freed with free() [OUT]
+ * @return the number of elements in the array, or -1 on error
+ */
+VLC_API ssize_t sout_GetStats( vlc_object_t *, sout_stats_t **pp_stats ) VLC_USED;
+#define sout_GetStats(o, pp) sout_GetStats(VLC_OBJECT(o), pp)
+
 /****************************************************************************
  * Encoder
  ****************************************************************************/
@@ -92,6 +92,11 @@ struct stream_t
      * for buffers. In such case, this callback should be provided instead of
      * \ref stream_t.pf_read; otherwise, this should be NULL.
      *
+     * Stream filters that pass their source data through unmodified should
+     * provide this callback if their source does, so that blocks get handed
+     * over from the access to the demuxer without any copy. Filters that
+     * transform the data should provide \ref stream_t.pf_read instead.
+     *
      * \param eof storage space for end-of-stream flag [OUT]
      * (*eof is always false when invoking pf_block(); pf_block() should set
      *  *eof to true if it detects the end of the stream)
@@ -160,6 +165,7 @@ enum stream_query_e
     STREAM_GET_SIGNAL,      /**< arg1=double *pf_quality, arg2=double *pf_strength   res=can fail */
     STREAM_GET_TAGS,        /**< arg1=const block_t ** res=can fail */
     STREAM_GET_TYPE,        /**< arg1=int*             res=can fail */
+    STREAM_GET_VALIDATOR,   /**< arg1= char ** (identifies the content version, e.g. an HTTP entity tag) res=can fail */
 
     STREAM_SET_PAUSE_STATE = 0x200, /**< arg1= bool        res=can fail */
     STREAM_SET_TITLE,       /**< arg1= int          res=can fail */
@@ -171,6 +177,20 @@ enum stream_query_e
     STREAM_SET_PRIVATE_ID_STATE = 0x1000, /* arg1= int i_private_data, bool b_selected    res=can fail */
     STREAM_SET_PRIVATE_ID_CA,             /* arg1= void * */
     STREAM_GET_PRIVATE_ID_STATE,          /* arg1=int i_private_data arg2=bool *          res=can fail */
+    STREAM_GET_PRIVATE_CACHE_STATS,       /* arg1=struct vlc_stream_cache_stats *         res=can fail */
+};
+
+/**
+ * Statistics of a caching stream filter (see STREAM_GET_PRIVATE_CACHE_STATS)
+ */
+struct vlc_stream_cache_stats
+{
+    uint64_t hits; /**< Reads served without waiting for upstream */
+    uint64_t misses; /**< Reads that waited for upstream */
+    uint64_t range_hits; /**< Reads served from a cached range */
+    uint64_t seeks; /**< Upstream seeks */
+    uint64_t bandwidth; /**< Measured upstream bandwidth (bytes/second) */
+    size_t readahead; /**< Current readahead (bytes) */
 };
 
 /**
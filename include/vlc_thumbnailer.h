@@ -86,6 +86,33 @@ vlc_thumbnailer_RequestByTime( vlc_thumbnailer_t *thumbnailer,
                                enum vlc_thumbnailer_seek_speed speed,
                                input_item_t *input_item, vlc_tick_t timeout,
                                vlc_thumbnailer_cb cb, void* user_data );
+/**
+ * \brief vlc_thumbnailer_RequestByTimes Requests thumbnails at several times
+ * \param thumbnailer A thumbnailer object
+ * \param times The times at which the thumbnails should be taken
+ * \param count The number of times, must not be 0
+ * \param speed The seeking speed \sa{enum vlc_thumbnailer_seek_speed}
+ * \param input_item The input item to generate the thumbnails for
+ * \param timeout A timeout value for each thumbnail, or VLC_TICK_INVALID to
+ * disable timeout
+ * \param cb A user callback to be called for each thumbnail (success & error)
+ * \param user_data An opaque value, provided as pf_cb's first parameter
+ * \return An opaque request object, or NULL in case of failure
+ *
+ * The media is opened only once, which is much faster than several requests
+ * to generate a series of thumbnails (seek bar previews for instance).
+ *
+ * If this function returns a valid request object, the callback is guaranteed
+ * to be called exactly count times, in the order of the times, even in case
+ * of later failure. The request completes with the last call.
+ * \see vlc_thumbnailer_RequestByTime
+ */
+VLC_API vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestByTimes( vlc_thumbnailer_t *thumbnailer,
+                                const vlc_tick_t *times, size_t count,
+                                enum vlc_thumbnailer_seek_speed speed,
+                                input_item_t *input_item, vlc_tick_t timeout,
+                                vlc_thumbnailer_cb cb, void* user_data );
 /**
  * \brief vlc_thumbnailer_RequestByTime Requests a thumbnailer at a given time
  * \param thumbnailer A thumbnailer object
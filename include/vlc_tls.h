@@ -200,6 +200,42 @@ VLC_API vlc_tls_t *vlc_tls_ClientSessionCreate(vlc_tls_client_t *creds,
                                                const char *const *alpn,
                                                char **alp);
 
+/**
+ * Stores TLS session resumption data.
+ *
+ * TLS client plugins call this function once a session is established, so
+ * that later sessions to the same server can be resumed with an abbreviated
+ * handshake rather than a full one. The data is kept in memory for the
+ * lifetime of the LibVLC instance, and shared by all the client credentials
+ * of the same plugin.
+ *
+ * @param crd client credentials that established the session
+ * @param host server host name
+ * @param service server service (port) name, or NULL
+ * @param data opaque resumption data (session ticket or identifier)
+ * @param length byte length of the resumption data
+ * @param once true if the data can be used for a single session only
+ *             (TLS 1.3 tickets), false if it replaces any previous data
+ */
+VLC_API void vlc_tls_SessionSave(vlc_tls_client_t *crd, const char *host,
+                                 const char *service, const void *data,
+                                 size_t length, bool once);
+
+/**
+ * Looks up TLS session resumption data.
+ *
+ * @param crd client credentials to establish the new session with
+ * @param host server host name
+ * @param service server service (port) name, or NULL
+ * @param length storage space for the byte length of the data [OUT]
+ *
+ * @return a heap-allocated copy of the resumption data (use free()),
+ * or NULL if none is available.
+ */
+VLC_API void *vlc_tls_SessionLoad(vlc_tls_client_t *crd, const char *host,
+                                  const char *service,
+                                  size_t *length) VLC_USED;
+
 /**
  * @}
  * \defgroup tls_server TLS server
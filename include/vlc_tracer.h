@@ -179,6 +179,37 @@ static inline void vlc_tracer_TracePCR( struct vlc_tracer *tracer, const char *t
                      VLC_TRACE("pcr", NS_FROM_VLC_TICK(pcr)), VLC_TRACE_END);
 }
 
+/**
+ * Trace the beginning of a span.
+ *
+ * Each call must be paired with a vlc_tracer_TraceSpanEnd() call with the
+ * same parameters, from the same thread. Spans can be nested.
+ */
+static inline void vlc_tracer_TraceSpanBegin(struct vlc_tracer *tracer,
+                                             const char *type, const char *id)
+{
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", type), VLC_TRACE("id", id),
+                     VLC_TRACE("span", "begin"), VLC_TRACE_END);
+}
+
+/**
+ * Trace the end of a span.
+ */
+static inline void vlc_tracer_TraceSpanEnd(struct vlc_tracer *tracer,
+                                           const char *type, const char *id)
+{
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", type), VLC_TRACE("id", id),
+                     VLC_TRACE("span", "end"), VLC_TRACE_END);
+}
+
+static inline void vlc_tracer_TraceLate(struct vlc_tracer *tracer, const char *type,
+                                const char *id, vlc_tick_t pts, vlc_tick_t late)
+{
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", type), VLC_TRACE("id", id),
+                     VLC_TRACE("pts", NS_FROM_VLC_TICK(pts)),
+                     VLC_TRACE("late", NS_FROM_VLC_TICK(late)), VLC_TRACE_END);
+}
+
 /**
  * @}
  */
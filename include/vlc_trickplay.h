@@ -0,0 +1,77 @@
+/*****************************************************************************
+ * vlc_trickplay.h: Trickplay previews generation API
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_TRICKPLAY_H
+#define VLC_TRICKPLAY_H
+
+#include <vlc_common.h>
+
+/**
+ * \defgroup trickplay Trickplay previews
+ * \ingroup input
+ * Generation of the scrub bar previews of a media
+ * @{
+ */
+
+enum vlc_trickplay_format
+{
+    /** Sprite sheets of columns x rows thumbnails, with a WebVTT index
+     * ("<prefix>-<n>.<ext>" and "<prefix>.vtt") */
+    VLC_TRICKPLAY_SPRITES,
+    /** Roku BIF archive of JPEG thumbnails ("<prefix>.bif") */
+    VLC_TRICKPLAY_BIF,
+};
+
+struct vlc_trickplay_cfg
+{
+    enum vlc_trickplay_format format;
+    vlc_tick_t interval; /**< time between two thumbnails */
+    unsigned width; /**< width of a thumbnail */
+    unsigned height; /**< height of a thumbnail */
+    unsigned columns; /**< thumbnails per row of a sprite sheet */
+    unsigned rows; /**< thumbnails per column of a sprite sheet */
+    vlc_fourcc_t codec; /**< sprite sheets codec, VLC_CODEC_JPEG by default */
+    vlc_tick_t timeout; /**< per thumbnail, VLC_TICK_INVALID for no timeout */
+};
+
+/**
+ * Generate the trickplay previews of a media.
+ *
+ * The media is opened once, and the thumbnails are taken on the keyframes
+ * closest to every interval. The thumbnails are scaled and encoded by
+ * several threads, while the media is still being decoded.
+ *
+ * The duration of the item must be known (the item must be preparsed).
+ * The thumbnails that could not be taken are left blank in the sprite sheets,
+ * and are missing from the BIF archive.
+ *
+ * \param obj parent object
+ * \param item media to generate the previews of
+ * \param cfg previews configuration
+ * \param prefix path prefix of the generated files
+ * \return VLC_SUCCESS or an error code
+ */
+VLC_API int vlc_trickplay_Generate(vlc_object_t *obj, input_item_t *item,
+                                   const struct vlc_trickplay_cfg *cfg,
+                                   const char *prefix);
+
+/** @} */
+
+#endif
@@ -197,6 +197,11 @@ struct vout_display_owner_t {
      * from multiple threads.
      */
     void (*viewpoint_moved)(void *sys, const vlc_viewpoint_t *vp);
+
+    /* Presentation feedback: a picture reached the screen at the given
+     * system date, and the display refreshes every period (or 0 if unknown).
+     */
+    void (*vsync)(void *sys, vlc_tick_t date, vlc_tick_t period);
 };
 
 /**
@@ -433,6 +438,27 @@ static inline void vout_display_SendEventViewpointMoved(vout_display_t *vd,
         vd->owner.viewpoint_moved(vd->owner.sys, vp);
 }
 
+/**
+ * Reports when the display actually presented a picture.
+ *
+ * Display modules that can tell when their pictures reach the screen
+ * (page-flip completion, presentation feedback, swap chain statistics...)
+ * should call this from the display callback or from their event thread.
+ * The video output then aligns the display dates of the next pictures on the
+ * refresh of the display.
+ *
+ * \param vd display that presented a picture
+ * \param date system date (as per vlc_tick_now()) of the presentation
+ * \param period refresh period of the display, or 0 if unknown
+ */
+static inline void vout_display_SendEventVsync(vout_display_t *vd,
+                                               vlc_tick_t date,
+                                               vlc_tick_t period)
+{
+    if (vd->owner.vsync)
+        vd->owner.vsync(vd->owner.sys, date, period);
+}
+
 /**
  * Helper function that applies the necessary transforms to the mouse position
  * and then calls vout_display_SendEventMouseMoved.
@@ -26,7 +26,9 @@
 #endif
 
 #include <assert.h>
+#include <limits.h>
 #include <math.h>
+#include <stdatomic.h>
 
 #include <vlc/libvlc.h>
 #include <vlc/libvlc_renderer_discoverer.h>
@@ -549,3 +551,211 @@ float libvlc_audio_equalizer_get_amp_at_index( libvlc_equalizer_t *p_equalizer,
 
     return p_equalizer->f_amp[ u_band ];
 }
+
+/*****************************************************************************
+ * Planar float chunks ring buffer
+ *****************************************************************************/
+struct libvlc_audio_chunks
+{
+    unsigned rate;
+    unsigned channels;
+    unsigned samples; /* per channel, in a chunk */
+    unsigned count;
+    libvlc_audio_chunk_cb notify;
+    void *opaque;
+
+    /* Producer (audio output thread) state */
+    unsigned fill;
+
+    /* Chunks written and read so far, modulo UINT_MAX + 1 */
+    atomic_uint write;
+    atomic_uint read;
+
+    struct
+    {
+        unsigned samples;
+        int64_t pts;
+    } *info;
+    float *data;
+};
+
+static float *ChunkPlanes( struct libvlc_audio_chunks *c, unsigned idx )
+{
+    return c->data + (size_t)idx * c->channels * c->samples;
+}
+
+static void ChunkCommit( struct libvlc_audio_chunks *c, unsigned w )
+{
+    c->info[w % c->count].samples = c->fill;
+    c->fill = 0;
+    atomic_store_explicit( &c->write, w + 1, memory_order_release );
+
+    if( c->notify != NULL )
+        c->notify( c->opaque );
+}
+
+static int ChunksSetup( void **opaque, char *format, unsigned *rate,
+                        unsigned *channels )
+{
+    struct libvlc_audio_chunks *c = *opaque;
+
+    memcpy( format, "FL32", 4 );
+    *rate = c->rate;
+    *channels = c->channels;
+    c->fill = 0;
+    return 0;
+}
+
+static void ChunksPlay( void *opaque, const void *samples, unsigned count,
+                        int64_t pts )
+{
+    struct libvlc_audio_chunks *c = opaque;
+    const float *in = samples;
+
+    while( count > 0 )
+    {
+        unsigned w = atomic_load_explicit( &c->write, memory_order_relaxed );
+        unsigned r = atomic_load_explicit( &c->read, memory_order_acquire );
+
+        if( w - r >= c->count )
+        {   /* Overrun: drop the samples rather than block the output */
+            c->fill = 0;
+            return;
+        }
+
+        unsigned idx = w % c->count;
+        float *planes = ChunkPlanes( c, idx );
+        unsigned n = __MIN( count, c->samples - c->fill );
+
+        if( c->fill == 0 )
+            c->info[idx].pts = pts;
+
+        for( unsigned ch = 0; ch < c->channels; ch++ )
+        {
+            float *out = planes + (size_t)ch * c->samples + c->fill;
+
+            for( unsigned i = 0; i < n; i++ )
+                out[i] = in[i * c->channels + ch];
+        }
+
+        c->fill += n;
+        in += (size_t)n * c->channels;
+        count -= n;
+        pts += US_FROM_VLC_TICK( vlc_tick_from_samples( n, c->rate ) );
+
+        if( c->fill == c->samples )
+            ChunkCommit( c, w );
+    }
+}
+
+static void ChunksFlush( void *opaque )
+{
+    struct libvlc_audio_chunks *c = opaque;
+
+    c->fill = 0;
+}
+
+static void ChunksDrain( void *opaque )
+{
+    struct libvlc_audio_chunks *c = opaque;
+
+    if( c->fill > 0 )
+        ChunkCommit( c, atomic_load_explicit( &c->write,
+                                              memory_order_relaxed ) );
+}
+
+int libvlc_audio_set_chunk_buffer( libvlc_media_player_t *mp,
+                                   unsigned rate, unsigned channels,
+                                   unsigned samples, unsigned count,
+                                   libvlc_audio_chunk_cb notify,
+                                   void *opaque )
+{
+    size_t floats;
+
+    if( mp->audio_chunks != NULL )
+    {
+        libvlc_printerr( "Audio chunk buffer already set" );
+        return -1;
+    }
+    if( rate == 0 || channels == 0 || samples == 0
+     || count == 0 || count > UINT_MAX / 2
+     || mul_overflow( (size_t)channels * samples, count, &floats ) )
+    {
+        libvlc_printerr( "Invalid audio chunk buffer parameters" );
+        return -1;
+    }
+
+    struct libvlc_audio_chunks *c = malloc( sizeof (*c) );
+    if( unlikely(c == NULL) )
+        return -1;
+
+    c->info = vlc_alloc( count, sizeof (*c->info) );
+    c->data = vlc_alloc( floats, sizeof (*c->data) );
+    if( unlikely(c->info == NULL || c->data == NULL) )
+    {
+        free( c->data );
+        free( c->info );
+        free( c );
+        return -1;
+    }
+
+    c->rate = rate;
+    c->channels = channels;
+    c->samples = samples;
+    c->count = count;
+    c->notify = notify;
+    c->opaque = opaque;
+    c->fill = 0;
+    atomic_init( &c->write, 0 );
+    atomic_init( &c->read, 0 );
+    mp->audio_chunks = c;
+
+    var_SetAddress( mp, "amem-setup", ChunksSetup );
+    var_SetAddress( mp, "amem-cleanup", NULL );
+    var_SetAddress( mp, "amem-play", ChunksPlay );
+    var_SetAddress( mp, "amem-pause", NULL );
+    var_SetAddress( mp, "amem-resume", NULL );
+    var_SetAddress( mp, "amem-flush", ChunksFlush );
+    var_SetAddress( mp, "amem-drain", ChunksDrain );
+    var_SetAddress( mp, "amem-data", c );
+    var_SetString( mp, "aout", "amem,none" );
+
+    vlc_player_aout_Reset( mp->player );
+    return 0;
+}
+
+unsigned libvlc_audio_read_chunk( libvlc_media_player_t *mp,
+                                  float *const *planes, int64_t *pts )
+{
+    struct libvlc_audio_chunks *c = mp->audio_chunks;
+
+    if( c == NULL )
+        return 0;
+
+    unsigned r = atomic_load_explicit( &c->read, memory_order_relaxed );
+
+    if( r == atomic_load_explicit( &c->write, memory_order_acquire ) )
+        return 0;
+
+    unsigned idx = r % c->count;
+    const float *in = ChunkPlanes( c, idx );
+    unsigned n = c->info[idx].samples;
+
+    for( unsigned ch = 0; ch < c->channels; ch++ )
+        memcpy( planes[ch], in + (size_t)ch * c->samples,
+                n * sizeof (float) );
+    *pts = c->info[idx].pts;
+
+    atomic_store_explicit( &c->read, r + 1, memory_order_release );
+    return n;
+}
+
+void libvlc_audio_chunks_destroy( struct libvlc_audio_chunks *c )
+{
+    if( c == NULL )
+        return;
+
+    free( c->data );
+    free( c->info );
+    free( c );
+}
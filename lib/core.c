@@ -29,6 +29,8 @@
 #include <vlc/vlc.h>
 
 #include <vlc_interface.h>
+#include <vlc_sout.h>
+#include <vlc_decoder.h>
 
 #include <stdarg.h>
 #include <limits.h>
@@ -121,6 +123,13 @@ void libvlc_set_app_id(libvlc_instance_t *p_i, const char *id,
     var_SetString(p_libvlc, "app-icon-name", icon ? icon : "");
 }
 
+size_t libvlc_get_decoder_buffer_usage( libvlc_instance_t *p_instance,
+                                        bool process )
+{
+    return vlc_input_decoder_GetBufferUsage( p_instance->p_libvlc_int,
+                                             process );
+}
+
 const char * libvlc_get_version(void)
 {
     return VERSION_MESSAGE;
@@ -217,6 +226,68 @@ libvlc_module_description_t *libvlc_video_filter_list_get( libvlc_instance_t *p_
     return module_description_list_get( p_instance, "video filter" );
 }
 
+int libvlc_sout_stats_get( libvlc_instance_t *p_instance,
+                           libvlc_sout_stats_t **pp_stats )
+{
+    sout_stats_t *p_tab;
+    ssize_t i_count = sout_GetStats( p_instance->p_libvlc_int, &p_tab );
+
+    *pp_stats = NULL;
+    if( i_count <= 0 )
+        return i_count;
+
+    libvlc_sout_stats_t *p_stats = malloc( i_count * sizeof( *p_stats ) );
+    if( unlikely(p_stats == NULL) )
+    {
+        free( p_tab );
+        return -1;
+    }
+
+    for( ssize_t i = 0; i < i_count; i++ )
+    {
+        const sout_stats_t *src = &p_tab[i];
+        libvlc_sout_stats_t *dst = &p_stats[i];
+
+        static_assert( sizeof( dst->psz_name ) == sizeof( src->psz_name ),
+                       "Mismatched name sizes" );
+        dst->i_id = src->i_id;
+        dst->i_owner = src->i_owner;
+        dst->i_next = src->i_next;
+        switch( src->i_type )
+        {
+            case SOUT_STATS_MUX:
+                dst->i_type = libvlc_sout_stats_mux;
+                break;
+            case SOUT_STATS_ACCESS:
+                dst->i_type = libvlc_sout_stats_access;
+                break;
+            default:
+                dst->i_type = libvlc_sout_stats_stream;
+                break;
+        }
+        memcpy( dst->psz_name, src->psz_name, sizeof( dst->psz_name ) );
+        dst->i_blocks = src->i_blocks;
+        dst->i_bytes = src->i_bytes;
+        dst->i_byte_rate = src->i_rate;
+        dst->i_late = src->i_late;
+        dst->i_dropped = src->i_dropped;
+        dst->i_in_flight = src->i_in_flight;
+        dst->i_queued = src->i_queued;
+        dst->i_queued_bytes = src->i_queued_bytes;
+        dst->i_latency = US_FROM_VLC_TICK( src->i_latency );
+        dst->i_latency_max = US_FROM_VLC_TICK( src->i_latency_max );
+    }
+    free( p_tab );
+
+    *pp_stats = p_stats;
+    return i_count;
+}
+
+void libvlc_sout_stats_release( libvlc_sout_stats_t *p_stats )
+{
+    free( p_stats );
+}
+
 int64_t libvlc_clock(void)
 {
     return US_FROM_VLC_TICK(vlc_tick_now());
@@ -897,6 +897,8 @@ static int media_parse(libvlc_media_t *media, bool b_async,
             parse_scope |= META_REQUEST_OPTION_FETCH_NETWORK;
         if (parse_flag & libvlc_media_do_interact)
             parse_scope |= META_REQUEST_OPTION_DO_INTERACT;
+        if (parse_flag & libvlc_media_parse_meta_only)
+            parse_scope |= META_REQUEST_OPTION_META_ONLY;
 
         ret = libvlc_MetadataRequest(libvlc, item, parse_scope,
                                      &input_preparser_callbacks, media,
@@ -1126,6 +1128,20 @@ static void media_on_thumbnail_ready( void* data, picture_t* thumbnail )
         libvlc_picture_release( pic );
 }
 
+// The thumbnailer is only created on first use
+static vlc_thumbnailer_t *media_get_thumbnailer( libvlc_int_t *p_libvlc )
+{
+    libvlc_priv_t *p_priv = libvlc_priv( p_libvlc );
+    vlc_thumbnailer_t *thumbnailer;
+
+    vlc_mutex_lock( &p_priv->lock );
+    if( p_priv->p_thumbnailer == NULL )
+        p_priv->p_thumbnailer = vlc_thumbnailer_Create( VLC_OBJECT( p_libvlc ) );
+    thumbnailer = p_priv->p_thumbnailer;
+    vlc_mutex_unlock( &p_priv->lock );
+    return thumbnailer;
+}
+
 // Start an asynchronous thumbnail generation
 libvlc_media_thumbnail_request_t*
 libvlc_media_thumbnail_request_by_time( libvlc_media_t *md, libvlc_time_t time,
@@ -1135,8 +1151,9 @@ libvlc_media_thumbnail_request_by_time( libvlc_media_t *md, libvlc_time_t time,
                                         libvlc_time_t timeout )
 {
     assert( md );
-    libvlc_priv_t *p_priv = libvlc_priv(md->p_libvlc_instance->p_libvlc_int);
-    if( unlikely( p_priv->p_thumbnailer == NULL ) )
+    vlc_thumbnailer_t *thumbnailer =
+        media_get_thumbnailer( md->p_libvlc_instance->p_libvlc_int );
+    if( unlikely( thumbnailer == NULL ) )
         return NULL;
     libvlc_media_thumbnail_request_t *req = malloc( sizeof( *req ) );
     if ( unlikely( req == NULL ) )
@@ -1148,7 +1165,7 @@ libvlc_media_thumbnail_request_by_time( libvlc_media_t *md, libvlc_time_t time,
     req->type = picture_type;
     req->crop = crop;
     libvlc_media_retain( md );
-    req->req = vlc_thumbnailer_RequestByTime( p_priv->p_thumbnailer,
+    req->req = vlc_thumbnailer_RequestByTime( thumbnailer,
         VLC_TICK_FROM_MS( time ),
         speed == libvlc_media_thumbnail_seek_fast ?
             VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
@@ -1173,8 +1190,9 @@ libvlc_media_thumbnail_request_by_pos( libvlc_media_t *md, float pos,
                                        libvlc_time_t timeout )
 {
     assert( md );
-    libvlc_priv_t *priv = libvlc_priv(md->p_libvlc_instance->p_libvlc_int);
-    if( unlikely( priv->p_thumbnailer == NULL ) )
+    vlc_thumbnailer_t *thumbnailer =
+        media_get_thumbnailer( md->p_libvlc_instance->p_libvlc_int );
+    if( unlikely( thumbnailer == NULL ) )
         return NULL;
     libvlc_media_thumbnail_request_t *req = malloc( sizeof( *req ) );
     if ( unlikely( req == NULL ) )
@@ -1186,7 +1204,7 @@ libvlc_media_thumbnail_request_by_pos( libvlc_media_t *md, float pos,
     req->crop = crop;
     req->type = picture_type;
     libvlc_media_retain( md );
-    req->req = vlc_thumbnailer_RequestByPos( priv->p_thumbnailer, pos,
+    req->req = vlc_thumbnailer_RequestByPos( thumbnailer, pos,
         speed == libvlc_media_thumbnail_seek_fast ?
             VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
         md->p_input_item,
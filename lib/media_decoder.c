@@ -0,0 +1,132 @@
+/*****************************************************************************
+ * media_decoder.c: libvlc decoding without playback
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc/libvlc.h>
+#include <vlc/libvlc_renderer_discoverer.h>
+#include <vlc/libvlc_picture.h>
+#include <vlc/libvlc_media.h>
+#include <vlc/libvlc_media_player.h>
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+#include <vlc_media_decoder.h>
+
+#include "libvlc_internal.h"
+#include "media_internal.h"
+
+struct libvlc_media_decoder_t
+{
+    libvlc_media_t *md;
+    vlc_media_decoder_t *dec;
+    struct vlc_media_decoder_cbs cbs;
+
+    libvlc_media_decoder_video_cb video;
+    libvlc_media_decoder_audio_cb audio;
+    libvlc_media_decoder_ended_cb ended;
+    void *opaque;
+};
+
+static int64_t media_time( vlc_tick_t ts )
+{
+    return ts != VLC_TICK_INVALID ? US_FROM_VLC_TICK( ts - VLC_TICK_0 ) : -1;
+}
+
+static void on_picture( picture_t *pic, void *userdata )
+{
+    libvlc_media_decoder_t *p_dec = userdata;
+
+    /* The frames are plain pictures, see libvlc_video_frame_release() */
+    p_dec->video( p_dec->opaque, (libvlc_video_frame_t *)picture_Hold( pic ),
+                  media_time( pic->date ) );
+}
+
+static void on_audio( const audio_format_t *fmt, block_t *block,
+                      void *userdata )
+{
+    libvlc_media_decoder_t *p_dec = userdata;
+    char format[5];
+
+    vlc_fourcc_to_char( fmt->i_format, format );
+    format[4] = '\0';
+    p_dec->audio( p_dec->opaque, block->p_buffer, block->i_nb_samples,
+                  media_time( block->i_pts ), format, fmt->i_rate,
+                  fmt->i_channels );
+}
+
+static void on_ended( void *userdata )
+{
+    libvlc_media_decoder_t *p_dec = userdata;
+
+    if( p_dec->ended != NULL )
+        p_dec->ended( p_dec->opaque );
+}
+
+libvlc_media_decoder_t *
+libvlc_media_decoder_new( libvlc_media_t *md,
+                          libvlc_media_decoder_video_cb video,
+                          libvlc_media_decoder_audio_cb audio,
+                          libvlc_media_decoder_ended_cb ended,
+                          void *opaque )
+{
+    assert( md );
+
+    libvlc_media_decoder_t *p_dec = malloc( sizeof( *p_dec ) );
+    if( unlikely( p_dec == NULL ) )
+    {
+        libvlc_printerr( "Not enough memory" );
+        return NULL;
+    }
+
+    /* The tracks without callback are not decoded */
+    p_dec->cbs.on_picture = video != NULL ? on_picture : NULL;
+    p_dec->cbs.on_audio = audio != NULL ? on_audio : NULL;
+    p_dec->cbs.on_ended = on_ended;
+    p_dec->md = md;
+    p_dec->video = video;
+    p_dec->audio = audio;
+    p_dec->ended = ended;
+    p_dec->opaque = opaque;
+    libvlc_media_retain( md );
+
+    p_dec->dec = vlc_media_decoder_New(
+        VLC_OBJECT( md->p_libvlc_instance->p_libvlc_int ), md->p_input_item,
+        &p_dec->cbs, p_dec );
+    if( p_dec->dec == NULL )
+    {
+        libvlc_printerr( "Cannot decode the media" );
+        libvlc_media_release( md );
+        free( p_dec );
+        return NULL;
+    }
+    return p_dec;
+}
+
+void libvlc_media_decoder_release( libvlc_media_decoder_t *p_dec )
+{
+    vlc_media_decoder_Delete( p_dec->dec );
+    libvlc_media_release( p_dec->md );
+    free( p_dec );
+}
@@ -603,6 +603,7 @@ libvlc_media_player_new( libvlc_instance_t *instance )
     var_Create (mp, "vmem-data", VLC_VAR_ADDRESS);
     var_Create (mp, "vmem-setup", VLC_VAR_ADDRESS);
     var_Create (mp, "vmem-cleanup", VLC_VAR_ADDRESS);
+    var_Create (mp, "vmem-frame", VLC_VAR_ADDRESS);
     var_Create (mp, "vmem-chroma", VLC_VAR_STRING | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-width", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-height", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
@@ -710,6 +711,7 @@ libvlc_media_player_new( libvlc_instance_t *instance )
     var_Create (mp, "equalizer-bands", VLC_VAR_STRING);
 
     mp->p_md = NULL;
+    mp->audio_chunks = NULL;
     mp->p_libvlc_instance = instance;
     /* use a reentrant lock to allow calling libvlc functions from callbacks */
     mp->player = vlc_player_New(VLC_OBJECT(mp), VLC_PLAYER_LOCK_REENTRANT,
@@ -807,6 +809,7 @@ static void libvlc_media_player_destroy( libvlc_media_player_t *p_mi )
     vlc_player_Unlock(p_mi->player);
 
     vlc_player_Delete(p_mi->player);
+    libvlc_audio_chunks_destroy(p_mi->audio_chunks);
 
     if (p_mi->p_md)
         media_detach_preparsed_event(p_mi->p_md);
@@ -998,6 +1001,7 @@ void libvlc_video_set_callbacks( libvlc_media_player_t *mp,
     void *opaque )
 {
     var_SetAddress( mp, "vmem-lock", lock_cb );
+    var_SetAddress( mp, "vmem-frame", NULL );
     var_SetAddress( mp, "vmem-unlock", unlock_cb );
     var_SetAddress( mp, "vmem-display", display_cb );
     var_SetAddress( mp, "vmem-data", opaque );
@@ -1006,6 +1010,19 @@ void libvlc_video_set_callbacks( libvlc_media_player_t *mp,
     var_SetString( mp, "window", "dummy" );
 }
 
+void libvlc_video_set_frame_callback( libvlc_media_player_t *mp,
+                                      libvlc_video_frame_cb frame_cb,
+                                      void *opaque )
+{
+    /* the frame prototype matches the vmem one: the frame is the picture */
+    var_SetAddress( mp, "vmem-lock", NULL );
+    var_SetAddress( mp, "vmem-frame", frame_cb );
+    var_SetAddress( mp, "vmem-data", opaque );
+    var_SetString( mp, "dec-dev", "none" );
+    var_SetString( mp, "vout", "vmem" );
+    var_SetString( mp, "window", "dummy" );
+}
+
 void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
                                         libvlc_video_format_cb setup,
                                         libvlc_video_cleanup_cb cleanup )
@@ -1733,6 +1750,34 @@ void libvlc_media_player_next_frame( libvlc_media_player_t *p_mi )
     vlc_player_Unlock(player);
 }
 
+int libvlc_media_player_get_frame_pacing( libvlc_media_player_t *p_mi,
+                                          libvlc_frame_pacing_t *pacing )
+{
+    static_assert(LIBVLC_FRAME_PACING_BUCKETS == INPUT_STATS_PACING_BUCKETS,
+                  "pacing buckets mismatch");
+
+    vlc_player_t *player = p_mi->player;
+    vlc_player_Lock(player);
+
+    const struct input_stats_t *stats = vlc_player_GetStatistics(player);
+    if (stats == NULL)
+    {
+        vlc_player_Unlock(player);
+        return -1;
+    }
+
+    for (unsigned i = 0; i < LIBVLC_FRAME_PACING_BUCKETS; i++)
+    {
+        pacing->decode_late[i] = stats->i_decode_late[i];
+        pacing->filter_time[i] = stats->i_filter_time[i];
+        pacing->render_time[i] = stats->i_render_time[i];
+        pacing->display_late[i] = stats->i_display_late[i];
+    }
+
+    vlc_player_Unlock(player);
+    return 0;
+}
+
 /**
  * Private lookup table to get subpicture alignment flag values corresponding
  * to a libvlc_position_t enumerated value.
@@ -49,8 +49,11 @@ struct libvlc_media_player_t
     struct libvlc_instance_t * p_libvlc_instance; /* Parent instance */
     libvlc_media_t * p_md; /* current media descriptor */
     libvlc_event_manager_t event_manager;
+    struct libvlc_audio_chunks *audio_chunks;
 };
 
+void libvlc_audio_chunks_destroy( struct libvlc_audio_chunks * );
+
 libvlc_track_description_t * libvlc_get_track_description(
         libvlc_media_player_t *p_mi,
         enum es_format_category_e cat );
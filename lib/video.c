@@ -37,6 +37,7 @@
 #include <vlc_common.h>
 #include <vlc_modules.h>
 #include <vlc_vout.h>
+#include <vlc_picture.h>
 #include <vlc_url.h>
 
 #include "libvlc_internal.h"
@@ -155,6 +156,57 @@ libvlc_video_take_snapshot( libvlc_media_player_t *p_mi, unsigned num,
     return 0;
 }
 
+/* The frames handed out by the vmem frame callback are plain pictures */
+libvlc_video_frame_t *libvlc_video_frame_retain( libvlc_video_frame_t *frame )
+{
+    picture_Hold( (picture_t *)frame );
+    return frame;
+}
+
+void libvlc_video_frame_release( libvlc_video_frame_t *frame )
+{
+    picture_Release( (picture_t *)frame );
+}
+
+unsigned libvlc_video_frame_get_format( const libvlc_video_frame_t *frame,
+                                        char chroma[5], unsigned *width,
+                                        unsigned *height )
+{
+    const picture_t *pic = (const picture_t *)frame;
+
+    vlc_fourcc_to_char( pic->format.i_chroma, chroma );
+    chroma[4] = '\0';
+    *width = pic->format.i_visible_width;
+    *height = pic->format.i_visible_height;
+    return pic->i_planes;
+}
+
+const void *libvlc_video_frame_get_plane( const libvlc_video_frame_t *frame,
+                                          unsigned plane, unsigned *pitch,
+                                          unsigned *lines )
+{
+    const picture_t *pic = (const picture_t *)frame;
+    const video_format_t *fmt = &pic->format;
+
+    if( plane >= (unsigned)pic->i_planes )
+        return NULL;
+
+    const plane_t *p = &pic->p[plane];
+    size_t x = 0, y = 0;
+
+    /* Scale the visible area offsets to the plane subsampling */
+    if( fmt->i_visible_width > 0 )
+        x = (size_t)fmt->i_x_offset * p->i_visible_pitch
+            / fmt->i_visible_width;
+    if( fmt->i_visible_height > 0 )
+        y = (size_t)fmt->i_y_offset * p->i_visible_lines
+            / fmt->i_visible_height;
+
+    *pitch = p->i_pitch;
+    *lines = p->i_visible_lines;
+    return p->p_pixels + y * p->i_pitch + x;
+}
+
 int libvlc_video_get_size( libvlc_media_player_t *p_mi, unsigned ignored,
                            unsigned *restrict px, unsigned *restrict py )
 {
@@ -550,6 +602,7 @@ void libvlc_video_set_deinterlace( libvlc_media_player_t *p_mi, int deinterlace,
      && strcmp (psz_mode, "discard")  && strcmp (psz_mode, "linear")
      && strcmp (psz_mode, "mean")     && strcmp (psz_mode, "x")
      && strcmp (psz_mode, "yadif")    && strcmp (psz_mode, "yadif2x")
+     && strcmp (psz_mode, "bwdif")    && strcmp (psz_mode, "bwdif2x")
      && strcmp (psz_mode, "phosphor") && strcmp (psz_mode, "ivtc")
      && strcmp (psz_mode, "auto"))
         return;
@@ -53,6 +53,7 @@
 
 #include "../demux/mpeg/timestamps.h"
 #include "../demux/timestamps_filter.h"
+#include "disc_readahead.h"
 
 #include <libbluray/bluray.h>
 #include <libbluray/bluray-version.h>
@@ -233,6 +234,10 @@ static const char *const ppsz_region_code_text[] = {
 #define BD_CLUSTER_SIZE 6144
 #define BD_READ_SIZE    (10 * BD_CLUSTER_SIZE)
 
+/* Disc image read-ahead */
+#define BD_READAHEAD_SIZE   (128 * BD_CLUSTER_SIZE)
+#define BD_READAHEAD_COUNT  4
+
 /* Callbacks */
 static int  blurayOpen (vlc_object_t *);
 static void blurayClose(vlc_object_t *);
@@ -353,6 +358,7 @@ typedef struct
 
     /* stream input */
     vlc_mutex_t         read_block_lock;
+    disc_readahead_t    *p_readahead;
 
     /* Used to store bluray disc path */
     char                *psz_bd_path;
@@ -708,7 +714,16 @@ static int blurayReadBlock(void *object, void *buf, int lba, int num_blocks)
 
     vlc_mutex_lock(&p_sys->read_block_lock);
 
-    if (vlc_stream_Seek( p_demux->s, lba * INT64_C(2048) ) == VLC_SUCCESS) {
+    if (p_sys->p_readahead) {
+        ssize_t got = disc_readahead_Read(p_sys->p_readahead,
+                                          lba * INT64_C(2048), buf,
+                                          (size_t)2048 * num_blocks);
+        if (got < 0) {
+            msg_Err(p_demux, "read from lba %d failed", lba);
+        } else {
+            result = got / 2048;
+        }
+    } else if (vlc_stream_Seek( p_demux->s, lba * INT64_C(2048) ) == VLC_SUCCESS) {
         size_t  req = (size_t)2048 * num_blocks;
         ssize_t got;
 
@@ -882,6 +897,11 @@ static int blurayOpen(vlc_object_t *object)
     if (p_demux->s) {
         i_init_pos = vlc_stream_Tell(p_demux->s);
 
+        /* read the image ahead of libbluray, so that it never waits for
+         * the drive during sequential playback */
+        p_sys->p_readahead = disc_readahead_New(p_demux->s, BD_READAHEAD_SIZE,
+                                                BD_READAHEAD_COUNT);
+
         p_sys->bluray = bd_init();
         if (!bd_open_stream(p_sys->bluray, p_demux, blurayReadBlock)) {
             bd_close(p_sys->bluray);
@@ -1094,6 +1114,9 @@ static void blurayClose(vlc_object_t *object)
         bd_close(p_sys->bluray);
     }
 
+    if (p_sys->p_readahead)
+        disc_readahead_Delete(p_sys->p_readahead);
+
     vlc_mutex_lock(&p_sys->bdj.lock);
     for(int i = 0; i < MAX_OVERLAY; i++)
         blurayCloseOverlay(p_demux, i);
@@ -1989,8 +2012,10 @@ static void blurayOverlayProc(void *ptr, const BD_OVERLAY *const overlay)
         return;
     }
 
-    if(overlay->plane >= MAX_OVERLAY)
+    if(overlay->plane >= MAX_OVERLAY) {
+        vlc_mutex_unlock(&p_sys->bdj.lock);
         return;
+    }
 
     switch (overlay->cmd) {
     case BD_OVERLAY_INIT:
@@ -37,6 +37,7 @@
 # include <winsock2.h>
 #else
 # include <netinet/in.h>
+# include <sys/mman.h>
 #endif
 
 #include "vlc_decklink.h"
@@ -50,6 +51,7 @@
 #endif
 
 #include "sdi.h"
+#include "../stream_out/sdi/V210.hpp"
 
 #include <atomic>
 
@@ -141,12 +143,24 @@ static int Control(demux_t *, int, va_list);
 namespace {
 
 class DeckLinkCaptureDelegate;
+class DeckLinkFrameAllocator;
+
+/* Frames are queued by the driver callback and processed by the worker */
+struct capture_frame
+{
+    struct capture_frame *next;
+    IDeckLinkVideoInputFrame *video;
+    IDeckLinkAudioInputPacket *audio;
+};
+
+#define CAPTURE_QUEUE_MAX 8
 
 struct demux_sys_t
 {
     IDeckLink *card;
     IDeckLinkInput *input;
     DeckLinkCaptureDelegate *delegate;
+    DeckLinkFrameAllocator *allocator;
 
     /* We need to hold onto the IDeckLinkConfiguration object, or our settings will not apply.
        See section 2.4.15 of the Blackmagic DeckLink SDK documentation. */
@@ -172,6 +186,17 @@ struct demux_sys_t
     int audio_streams;
 
     bool tenbits;
+    vlc_slices_t *slices; /* v210 unpacking threads */
+
+    vlc_thread_t thread;
+    bool has_thread;
+    vlc_mutex_t es_lock; /* held by the worker while processing a frame */
+    vlc_mutex_t queue_lock;
+    vlc_cond_t queue_wait;
+    struct capture_frame *queue_first; /* protected by <queue_lock> */
+    struct capture_frame **queue_lastp; /* protected by <queue_lock> */
+    unsigned queue_count; /* protected by <queue_lock> */
+    bool queue_dead; /* protected by <queue_lock> */
 };
 
 } // namespace
@@ -246,6 +271,167 @@ static es_format_t GetModeSettings(demux_t *demux, IDeckLinkDisplayMode *m,
 }
 namespace {
 
+/* Capture buffers are recycled and locked in memory, so that the driver
+ * does not run out of frames while these are held downstream. */
+class DeckLinkFrameAllocator : public IDeckLinkMemoryAllocator
+{
+public:
+    DeckLinkFrameAllocator() : size_(0), lockable_(true), free_(NULL)
+    {
+        m_ref_.store(1);
+        vlc_mutex_init(&lock_);
+    }
+    virtual ~DeckLinkFrameAllocator()
+    {
+        Decommit();
+    }
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, LPVOID *) override { return E_NOINTERFACE; }
+
+    ULONG STDMETHODCALLTYPE AddRef(void) override
+    {
+        return m_ref_.fetch_add(1) + 1;
+    }
+
+    ULONG STDMETHODCALLTYPE Release(void) override
+    {
+        uintptr_t new_ref = m_ref_.fetch_sub(1) - 1;
+        if (new_ref == 0)
+            delete this;
+        return new_ref;
+    }
+
+    HRESULT STDMETHODCALLTYPE AllocateBuffer(uint32_t size, void **buffer) override
+    {
+        vlc_mutex_lock(&lock_);
+        if (size != size_) {
+            FreeList();
+            size_ = size;
+        }
+        struct buffer *buf = free_;
+        if (buf != NULL)
+            free_ = buf->next;
+        vlc_mutex_unlock(&lock_);
+
+        if (buf == NULL) {
+            size_t total = (BUFFER_HEADER + size + 63) & ~(size_t)63;
+
+            buf = static_cast<struct buffer *>(aligned_alloc(64, total));
+            if (unlikely(buf == NULL))
+                return E_OUTOFMEMORY;
+            buf->size = size;
+            buf->total = total;
+#ifndef _WIN32
+            if (lockable_ && mlock(buf, total))
+                lockable_ = false; /* over RLIMIT_MEMLOCK, stay pageable */
+            buf->locked = lockable_;
+#endif
+        }
+        *buffer = reinterpret_cast<uint8_t *>(buf) + BUFFER_HEADER;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE ReleaseBuffer(void *buffer) override
+    {
+        struct buffer *buf = reinterpret_cast<struct buffer *>(
+            static_cast<uint8_t *>(buffer) - BUFFER_HEADER);
+
+        vlc_mutex_lock(&lock_);
+        if (buf->size == size_) {
+            buf->next = free_;
+            free_ = buf;
+            buf = NULL;
+        }
+        vlc_mutex_unlock(&lock_);
+
+        if (buf != NULL)
+            Free(buf);
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Commit(void) override
+    {
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Decommit(void) override
+    {
+        vlc_mutex_lock(&lock_);
+        FreeList();
+        vlc_mutex_unlock(&lock_);
+        return S_OK;
+    }
+
+private:
+    struct buffer
+    {
+        struct buffer *next;
+        size_t size;
+        size_t total;
+        bool locked;
+    };
+    /* keeps the pixels 64-byte aligned after the header */
+    static const size_t BUFFER_HEADER = 64;
+    static_assert(sizeof (struct buffer) <= BUFFER_HEADER, "header too large");
+
+    static void Free(struct buffer *buf)
+    {
+#ifndef _WIN32
+        if (buf->locked)
+            munlock(buf, buf->total);
+#endif
+        aligned_free(buf);
+    }
+
+    void FreeList()
+    {
+        while (free_ != NULL) {
+            struct buffer *buf = free_;
+
+            free_ = buf->next;
+            Free(buf);
+        }
+    }
+
+    std::atomic_uint m_ref_;
+    vlc_mutex_t lock_;
+    uint32_t size_; /* protected by <lock_> */
+    std::atomic_bool lockable_;
+    struct buffer *free_; /* protected by <lock_> */
+};
+
+/* Blocks pointing straight into the captured DeckLink frames */
+struct decklink_block
+{
+    block_t self;
+    IUnknown *frame;
+};
+
+static void decklink_block_Release(block_t *block)
+{
+    struct decklink_block *b = container_of(block, struct decklink_block, self);
+
+    b->frame->Release();
+    free(b);
+}
+
+static const struct vlc_block_callbacks decklink_block_cbs =
+{
+    decklink_block_Release,
+};
+
+static block_t *WrapFrame(IUnknown *frame, void *data, size_t size)
+{
+    struct decklink_block *b =
+        static_cast<struct decklink_block *>(malloc(sizeof (*b)));
+    if (unlikely(b == NULL))
+        return NULL;
+
+    frame->AddRef();
+    b->frame = frame;
+    return block_Init(&b->self, &decklink_block_cbs, data, size);
+}
+
 class DeckLinkCaptureDelegate : public IDeckLinkInputCallback
 {
 public:
@@ -308,9 +494,11 @@ public:
                 return S_OK;
         }
 
+        vlc_mutex_lock(&sys->es_lock);
         es_out_Del(demux_->out, sys->video_es);
         sys->video_fmt = GetModeSettings(demux_, mode, flags);
         sys->video_es = es_out_Add(demux_->out, &sys->video_fmt);
+        vlc_mutex_unlock(&sys->es_lock);
 
         sys->input->PauseStreams();
         sys->input->EnableVideoInput( mode->GetDisplayMode(), fmt, bmdVideoInputEnableFormatDetection );
@@ -331,7 +519,7 @@ private:
 
 } // namespace
 
-HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame* videoFrame, IDeckLinkAudioInputPacket* audioFrame)
+static void ProcessFrame(demux_t *demux_, IDeckLinkVideoInputFrame* videoFrame, IDeckLinkAudioInputPacket* audioFrame)
 {
     demux_sys_t *sys = static_cast<demux_sys_t *>(demux_->p_sys);
 
@@ -339,7 +527,7 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
         if (videoFrame->GetFlags() & bmdFrameHasNoInputSource) {
             msg_Warn(demux_, "No input signal detected (%ldx%ld)",
                      videoFrame->GetWidth(), videoFrame->GetHeight());
-            return S_OK;
+            return;
         }
 
         const int width = videoFrame->GetWidth();
@@ -356,20 +544,26 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
                 bpp = 2;
                 break;
         };
-        block_t *video_frame = block_Alloc(width * height * bpp);
-        if (!video_frame)
-            return S_OK;
-
         const uint32_t *frame_bytes;
         videoFrame->GetBytes((void**)&frame_bytes);
 
+        block_t *video_frame;
+        if (sys->video_fmt.i_codec != VLC_CODEC_I422_10L && stride == width * bpp)
+            video_frame = WrapFrame(videoFrame, (void *)frame_bytes,
+                                    stride * height);
+        else
+            video_frame = block_Alloc(width * height * bpp);
+        if (!video_frame)
+            return;
+
         BMDTimeValue stream_time, frame_duration;
         videoFrame->GetStreamTime(&stream_time, &frame_duration, CLOCK_FREQ);
         video_frame->i_flags = BLOCK_FLAG_TYPE_I | sys->dominance_flags;
         video_frame->i_pts = video_frame->i_dts = VLC_TICK_0 + stream_time;
 
         if (sys->video_fmt.i_codec == VLC_CODEC_I422_10L) {
-            v210_convert((uint16_t*)video_frame->p_buffer, frame_bytes, width, height);
+            sdi::V210::Unpack((uint16_t*)video_frame->p_buffer, frame_bytes,
+                              width, height, sys->slices);
             IDeckLinkVideoFrameAncillary *vanc;
             if (videoFrame->GetAncillaryData(&vanc) == S_OK) {
                 for (int i = 1; i < 21; i++) {
@@ -377,7 +571,7 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
                     if (vanc->GetBufferForVerticalBlankingLine(i, (void**)&buf) != S_OK)
                         break;
                     uint16_t dec[width * 2];
-                    v210_convert(&dec[0], buf, width, 1);
+                    sdi::V210::Unpack(&dec[0], buf, width, 1);
                     block_t *cc = vanc_to_cc(demux_, dec, width * 2);
                     if (!cc)
                         continue;
@@ -401,14 +595,12 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
                 }
                 vanc->Release();
             }
-        } else if (sys->video_fmt.i_codec == VLC_CODEC_UYVY) {
+        } else if (video_frame->p_buffer != (const uint8_t *)frame_bytes) {
             for (int y = 0; y < height; ++y) {
                 const uint8_t *src = (const uint8_t *)frame_bytes + stride * y;
-                uint8_t *dst = video_frame->p_buffer + width * 2 * y;
-                memcpy(dst, src, width * 2);
+                uint8_t *dst = video_frame->p_buffer + width * bpp * y;
+                memcpy(dst, src, width * bpp);
             }
-        } else {
-                memcpy(video_frame->p_buffer, frame_bytes, width * height * bpp);
         }
 
         vlc_mutex_lock(&sys->pts_lock);
@@ -451,10 +643,9 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
         }
         else
         {
-            block_t *audio_frame = block_Alloc(bytes);
+            block_t *audio_frame = WrapFrame(audioFrame, frame_bytes, bytes);
             if (!audio_frame)
-                return S_OK;
-            memcpy(audio_frame->p_buffer, frame_bytes, bytes);
+                return;
             audio_frame->i_pts = audio_frame->i_dts = VLC_TICK_0 + packet_time;
             es_out_Send(demux_->out, sys->audio_es[0], audio_frame);
         }
@@ -466,10 +657,79 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
 
         es_out_SetPCR(demux_->out, VLC_TICK_0 + packet_time);
     }
+}
+
+/* Runs in the driver thread: only queue the frame for the worker */
+HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame* videoFrame, IDeckLinkAudioInputPacket* audioFrame)
+{
+    demux_sys_t *sys = static_cast<demux_sys_t *>(demux_->p_sys);
+
+    if (!videoFrame && !audioFrame)
+        return S_OK;
+
+    struct capture_frame *f =
+        static_cast<struct capture_frame *>(malloc(sizeof (*f)));
+    if (unlikely(f == NULL))
+        return S_OK;
+
+    f->next = NULL;
+    f->video = videoFrame;
+    f->audio = audioFrame;
+
+    vlc_mutex_lock(&sys->queue_lock);
+    if (sys->queue_count >= CAPTURE_QUEUE_MAX) {
+        vlc_mutex_unlock(&sys->queue_lock);
+        msg_Warn(demux_, "Capture queue overflow, dropping frame");
+        free(f);
+        return S_OK;
+    }
+    if (videoFrame)
+        videoFrame->AddRef();
+    if (audioFrame)
+        audioFrame->AddRef();
+    *sys->queue_lastp = f;
+    sys->queue_lastp = &f->next;
+    sys->queue_count++;
+    vlc_cond_signal(&sys->queue_wait);
+    vlc_mutex_unlock(&sys->queue_lock);
 
     return S_OK;
 }
 
+static void *CaptureThread(void *data)
+{
+    demux_t *demux = static_cast<demux_t *>(data);
+    demux_sys_t *sys = static_cast<demux_sys_t *>(demux->p_sys);
+
+    vlc_mutex_lock(&sys->queue_lock);
+    for (;;) {
+        while (sys->queue_first == NULL && !sys->queue_dead)
+            vlc_cond_wait(&sys->queue_wait, &sys->queue_lock);
+        if (sys->queue_first == NULL)
+            break;
+
+        struct capture_frame *f = sys->queue_first;
+        sys->queue_first = f->next;
+        if (sys->queue_first == NULL)
+            sys->queue_lastp = &sys->queue_first;
+        sys->queue_count--;
+        vlc_mutex_unlock(&sys->queue_lock);
+
+        vlc_mutex_lock(&sys->es_lock);
+        ProcessFrame(demux, f->video, f->audio);
+        vlc_mutex_unlock(&sys->es_lock);
+        if (f->video)
+            f->video->Release();
+        if (f->audio)
+            f->audio->Release();
+        free(f);
+
+        vlc_mutex_lock(&sys->queue_lock);
+    }
+    vlc_mutex_unlock(&sys->queue_lock);
+    return NULL;
+}
+
 
 static int GetAudioConn(demux_t *demux)
 {
@@ -558,6 +818,11 @@ static int Open(vlc_object_t *p_this)
         return VLC_ENOMEM;
 
     vlc_mutex_init(&sys->pts_lock);
+    vlc_mutex_init(&sys->es_lock);
+    vlc_mutex_init(&sys->queue_lock);
+    vlc_cond_init(&sys->queue_wait);
+    sys->queue_lastp = &sys->queue_first;
+    sys->slices = vlc_slices_New(0);
 
     sys->tenbits = var_InheritBool(p_this, "decklink-tenbits");
 
@@ -706,6 +971,12 @@ static int Open(vlc_object_t *p_this)
         goto finish;
     }
 
+    /* Keep the captured frames in our own buffers, so they can be sent
+     * downstream without copies. */
+    sys->allocator = new DeckLinkFrameAllocator();
+    if (sys->input->SetVideoInputFrameMemoryAllocator(sys->allocator) != S_OK)
+        msg_Warn(demux, "Failed to set the capture memory allocator");
+
     if (sys->input->EnableVideoInput(u.id, fmt, flags) != S_OK) {
         msg_Err(demux, "Failed to enable video input");
         goto finish;
@@ -744,6 +1015,12 @@ static int Open(vlc_object_t *p_this)
     sys->delegate = new DeckLinkCaptureDelegate(demux);
     sys->input->SetCallback(sys->delegate);
 
+    if (vlc_clone(&sys->thread, CaptureThread, demux, VLC_THREAD_PRIORITY_INPUT)) {
+        msg_Err(demux, "Failed to start the capture thread");
+        goto finish;
+    }
+    sys->has_thread = true;
+
     if (sys->input->StartStreams() != S_OK) {
         msg_Err(demux, "Could not start streaming from SDI card. This could be caused "
                           "by invalid video mode or flags, access denied, or card already in use.");
@@ -794,17 +1071,32 @@ static void Close(vlc_object_t *p_this)
     if (sys->config)
         sys->config->Release();
 
-    if (sys->input) {
+    if (sys->input)
         sys->input->StopStreams();
-        sys->input->Release();
+
+    if (sys->has_thread) {
+        vlc_mutex_lock(&sys->queue_lock);
+        sys->queue_dead = true;
+        vlc_cond_signal(&sys->queue_wait);
+        vlc_mutex_unlock(&sys->queue_lock);
+        vlc_join(sys->thread, NULL);
     }
 
+    if (sys->input)
+        sys->input->Release();
+
+    if (sys->allocator)
+        sys->allocator->Release();
+
     if (sys->card)
         sys->card->Release();
 
     if (sys->delegate)
         sys->delegate->Release();
 
+    if (sys->slices)
+        vlc_slices_Delete(sys->slices);
+
     free(sys);
 }
 
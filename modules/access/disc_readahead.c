@@ -0,0 +1,279 @@
+/*****************************************************************************
+ * disc_readahead.c: asynchronous read-ahead for disc images
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_stream.h>
+
+#include "disc_readahead.h"
+
+enum chunk_state
+{
+    CHUNK_EMPTY,
+    CHUNK_LOADING,
+    CHUNK_READY,
+};
+
+struct disc_chunk
+{
+    enum chunk_state state;
+    unsigned gen;
+    uint64_t pos;
+    ssize_t len; /* -1 on error */
+    uint8_t *buf;
+};
+
+struct disc_readahead
+{
+    stream_t *s;
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /* for the thread */
+    vlc_cond_t ready; /* for the readers */
+
+    uint64_t next; /* position of the next chunk to read */
+    unsigned gen; /* incremented when the position jumps */
+    bool eof;
+    bool dead;
+
+    size_t chunk_size;
+    unsigned count;
+    struct disc_chunk chunks[];
+};
+
+static struct disc_chunk *FindEmpty(disc_readahead_t *ra)
+{
+    for (unsigned i = 0; i < ra->count; i++)
+        if (ra->chunks[i].state == CHUNK_EMPTY)
+            return &ra->chunks[i];
+    return NULL;
+}
+
+static struct disc_chunk *Find(disc_readahead_t *ra, uint64_t pos)
+{
+    for (unsigned i = 0; i < ra->count; i++)
+    {
+        struct disc_chunk *c = &ra->chunks[i];
+
+        if (c->state != CHUNK_EMPTY && c->gen == ra->gen
+         && c->pos <= pos && pos - c->pos < ra->chunk_size)
+            return c;
+    }
+    return NULL;
+}
+
+/* Drops the chunks that will not be read anymore */
+static void Release(disc_readahead_t *ra, uint64_t pos)
+{
+    for (unsigned i = 0; i < ra->count; i++)
+    {
+        struct disc_chunk *c = &ra->chunks[i];
+
+        if (c->state == CHUNK_READY && c->pos + ra->chunk_size <= pos)
+        {
+            c->state = CHUNK_EMPTY;
+            vlc_cond_signal(&ra->wait);
+        }
+    }
+}
+
+static void Restart(disc_readahead_t *ra, uint64_t pos)
+{
+    /* chunks being loaded are dropped by the thread */
+    for (unsigned i = 0; i < ra->count; i++)
+        if (ra->chunks[i].state == CHUNK_READY)
+            ra->chunks[i].state = CHUNK_EMPTY;
+
+    ra->gen++;
+    ra->next = pos;
+    ra->eof = false;
+    vlc_cond_signal(&ra->wait);
+}
+
+static void *Thread(void *data)
+{
+    disc_readahead_t *ra = data;
+
+    vlc_mutex_lock(&ra->lock);
+    for (;;)
+    {
+        struct disc_chunk *c = NULL;
+
+        while (!ra->dead && (ra->eof || (c = FindEmpty(ra)) == NULL))
+            vlc_cond_wait(&ra->wait, &ra->lock);
+        if (ra->dead)
+            break;
+
+        const uint64_t pos = ra->next;
+
+        c->state = CHUNK_LOADING;
+        c->gen = ra->gen;
+        c->pos = pos;
+        ra->next += ra->chunk_size;
+        vlc_mutex_unlock(&ra->lock);
+
+        ssize_t len = -1;
+
+        if (vlc_stream_Tell(ra->s) == pos
+         || vlc_stream_Seek(ra->s, pos) == VLC_SUCCESS)
+            len = vlc_stream_Read(ra->s, c->buf, ra->chunk_size);
+
+        vlc_mutex_lock(&ra->lock);
+        if (c->gen != ra->gen)
+            c->state = CHUNK_EMPTY; /* outdated, a reader jumped elsewhere */
+        else
+        {
+            c->state = CHUNK_READY;
+            c->len = len;
+            if (len < (ssize_t)ra->chunk_size)
+                ra->eof = true; /* or error: wait until the next jump */
+        }
+        vlc_cond_broadcast(&ra->ready);
+    }
+    vlc_mutex_unlock(&ra->lock);
+    return NULL;
+}
+
+ssize_t disc_readahead_Read(disc_readahead_t *ra, uint64_t pos, void *buf,
+                            size_t size)
+{
+    uint8_t *p = buf;
+    size_t done = 0;
+    ssize_t ret;
+
+    vlc_mutex_lock(&ra->lock);
+    Release(ra, pos);
+
+    while (done < size)
+    {
+        struct disc_chunk *c = Find(ra, pos);
+
+        if (c == NULL)
+        {
+            /* not read ahead, restart from here unless already requested */
+            if (ra->next != pos || ra->eof)
+                Restart(ra, pos);
+            vlc_cond_wait(&ra->ready, &ra->lock);
+            continue;
+        }
+
+        if (c->state == CHUNK_LOADING)
+        {
+            vlc_cond_wait(&ra->ready, &ra->lock);
+            continue;
+        }
+
+        if (c->len < 0)
+        {
+            c->state = CHUNK_EMPTY;
+            Restart(ra, pos); /* try again on the next call */
+            if (done == 0)
+            {
+                vlc_mutex_unlock(&ra->lock);
+                return -1;
+            }
+            break;
+        }
+
+        const size_t offset = pos - c->pos;
+
+        if (offset >= (size_t)c->len)
+            break; /* end of stream */
+
+        size_t copy = __MIN((size_t)c->len - offset, size - done);
+
+        memcpy(p + done, c->buf + offset, copy);
+        done += copy;
+        pos += copy;
+
+        if (pos - c->pos >= ra->chunk_size)
+        {
+            c->state = CHUNK_EMPTY;
+            vlc_cond_signal(&ra->wait);
+        }
+    }
+
+    ret = done;
+    vlc_mutex_unlock(&ra->lock);
+    return ret;
+}
+
+disc_readahead_t *disc_readahead_New(stream_t *s, size_t chunk,
+                                     unsigned count)
+{
+    disc_readahead_t *ra = malloc(sizeof (*ra) + count * sizeof (ra->chunks[0]));
+    if (unlikely(ra == NULL))
+        return NULL;
+
+    ra->s = s;
+    ra->next = vlc_stream_Tell(s);
+    ra->gen = 0;
+    ra->eof = false;
+    ra->dead = false;
+    ra->chunk_size = chunk;
+    ra->count = count;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        struct disc_chunk *c = &ra->chunks[i];
+
+        c->state = CHUNK_EMPTY;
+        c->buf = malloc(chunk);
+        if (unlikely(c->buf == NULL))
+        {
+            while (i > 0)
+                free(ra->chunks[--i].buf);
+            free(ra);
+            return NULL;
+        }
+    }
+
+    vlc_mutex_init(&ra->lock);
+    vlc_cond_init(&ra->wait);
+    vlc_cond_init(&ra->ready);
+
+    if (vlc_clone(&ra->thread, Thread, ra, VLC_THREAD_PRIORITY_INPUT))
+    {
+        for (unsigned i = 0; i < count; i++)
+            free(ra->chunks[i].buf);
+        free(ra);
+        return NULL;
+    }
+    return ra;
+}
+
+void disc_readahead_Delete(disc_readahead_t *ra)
+{
+    vlc_mutex_lock(&ra->lock);
+    ra->dead = true;
+    vlc_cond_signal(&ra->wait);
+    vlc_mutex_unlock(&ra->lock);
+    vlc_join(ra->thread, NULL);
+
+    for (unsigned i = 0; i < ra->count; i++)
+        free(ra->chunks[i].buf);
+    free(ra);
+}
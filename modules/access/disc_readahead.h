@@ -0,0 +1,59 @@
+/*****************************************************************************
+ * disc_readahead.h: asynchronous read-ahead for disc images
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_DISC_READAHEAD_H
+#define VLC_DISC_READAHEAD_H
+
+/**
+ * Reads a disc image stream ahead of the navigation library, from a
+ * separate thread.
+ *
+ * The stream is read in chunks starting from the position following the
+ * last read, so that sequential playback never waits for the drive. Reading
+ * from anywhere else (e.g. a menu or title jump) restarts the read-ahead
+ * from the new position.
+ *
+ * Once created, the stream must only be accessed through
+ * disc_readahead_Read() until disc_readahead_Delete() is called.
+ */
+typedef struct disc_readahead disc_readahead_t;
+
+/**
+ * Starts reading ahead.
+ *
+ * \param s stream to read from
+ * \param chunk size of each read from the stream
+ * \param count number of chunks read in advance
+ */
+disc_readahead_t *disc_readahead_New(stream_t *s, size_t chunk,
+                                     unsigned count);
+
+void disc_readahead_Delete(disc_readahead_t *);
+
+/**
+ * Reads data at a given position.
+ *
+ * \return the number of bytes read, shorter at the end of the stream,
+ * or -1 on error
+ */
+ssize_t disc_readahead_Read(disc_readahead_t *, uint64_t pos, void *buf,
+                            size_t size);
+
+#endif
@@ -47,6 +47,10 @@
 #define BUDGET_LONGTEXT N_( \
     "Only useful programs are normally demultiplexed from the transponder. " \
     "This option will disable demultiplexing and receive all programs.")
+#define SHARE_TEXT N_("Share the tuner")
+#define SHARE_LONGTEXT N_( \
+    "Let other inputs of the same process receive from the tuner, " \
+    "as long as they tune to the same transponder.")
 
 #define NAME_TEXT N_("Network name")
 #define NAME_LONGTEXT N_("Unique network name in the System Tuning Spaces")
@@ -262,6 +266,7 @@ vlc_module_begin ()
         change_integer_range (0, 255)
         change_safe ()
     add_bool ("dvb-budget-mode", false, BUDGET_TEXT, BUDGET_LONGTEXT)
+    add_bool ("dvb-share", false, SHARE_TEXT, SHARE_LONGTEXT)
 #endif
 #ifdef _WIN32
     add_integer ("dvb-adapter", -1, ADAPTER_TEXT, ADAPTER_LONGTEXT)
@@ -27,6 +27,7 @@
 #include <vlc_common.h>
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
+#include <vlc_list.h>
 
 #include <errno.h>
 #include <assert.h>
@@ -141,23 +142,71 @@ static int dvb_parse_fec (uint32_t fec)
 }
 
 
+#define MAX_PIDS 256
+#define MAX_PROPS 64
+/* Pseudo-property for the DiSEqC switch, compared but never set */
+#define DVB_PROP_DISEQC UINT32_MAX
+
+/**
+ * Tuning parameters, as set by an input. Inputs can share a tuner only if
+ * they asked for exactly the same parameters.
+ */
+typedef struct
+{
+    size_t count; /**< Number of properties, or SIZE_MAX on overflow */
+    struct
+    {
+        uint32_t cmd;
+        uint32_t data;
+    } props[MAX_PROPS];
+} dvb_tuning_t;
+
+/**
+ * Frontend and conditional access of one adapter device.
+ *
+ * In shared mode, one tuner feeds all the inputs of the process asking for
+ * the same adapter, device and tuning. Each input reads its own subset of
+ * PIDs from its own demultiplexer handle, so that the kernel fans the
+ * transport stream out.
+ */
+typedef struct
+{
+    struct vlc_list node;
+    vlc_object_t *obj; /**< Owns the messages of the CAM */
+    uint8_t adapter;
+    uint8_t device;
+    bool shared;
+    unsigned refs; /**< Open inputs, protected by dvb_tuners_lock */
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    int frontend;
+    cam_t *cam;
+    const dvb_device_t *writer; /**< Input configuring the frontend */
+    unsigned users; /**< Inputs receiving the current tuning */
+    dvb_tuning_t tuning; /**< Current tuning */
+} dvb_tuner_t;
+
+static vlc_mutex_t dvb_tuners_lock = VLC_STATIC_MUTEX;
+static struct vlc_list dvb_tuners = VLC_LIST_INITIALIZER(&dvb_tuners);
+
 struct dvb_device
 {
     vlc_object_t *obj;
+    dvb_tuner_t *tuner;
     int dir;
     int demux;
     int frontend;
-#ifndef USE_DMX
-# define MAX_PIDS 256
     struct
     {
         int fd;
         uint16_t pid;
     } pids[MAX_PIDS];
-#endif
-    cam_t *cam;
     uint8_t device;
     bool budget;
+    bool tap; /**< Read from the demultiplexer rather than the DVR */
+    bool tuned; /**< Counted in the tuner users */
+    dvb_tuning_t tuning; /**< Requested tuning */
     //size_t buffer_size;
 };
 
@@ -179,6 +228,91 @@ static int dvb_open_node (dvb_device_t *d, const char *type, int flags)
     return vlc_openat (d->dir, path, flags | O_NONBLOCK);
 }
 
+static void dvb_tuner_release (dvb_tuner_t *t)
+{
+    vlc_mutex_lock (&dvb_tuners_lock);
+    bool last = --t->refs == 0;
+    if (last && t->shared)
+        vlc_list_remove (&t->node);
+    vlc_mutex_unlock (&dvb_tuners_lock);
+
+    if (!last)
+        return;
+
+    if (t->cam != NULL)
+        en50221_End (t->cam);
+    if (t->frontend != -1)
+        vlc_close (t->frontend);
+    if (t->shared)
+        vlc_object_delete (t->obj);
+    free (t);
+}
+
+/**
+ * Gets the tuner of the device, shared with other inputs if requested.
+ */
+static dvb_tuner_t *dvb_tuner_get (dvb_device_t *d, uint8_t adapter,
+                                   bool shared)
+{
+    dvb_tuner_t *t;
+
+    vlc_mutex_lock (&dvb_tuners_lock);
+    if (shared)
+        vlc_list_foreach (t, &dvb_tuners, node)
+            if (t->adapter == adapter && t->device == d->device)
+            {
+                t->refs++;
+                msg_Dbg (d->obj, "sharing adapter %"PRIu8" device %"PRIu8
+                         " with %u other input(s)", adapter, d->device,
+                         t->refs - 1);
+                goto out;
+            }
+
+    t = malloc (sizeof (*t));
+    if (unlikely(t == NULL))
+        goto out;
+
+    /* A shared tuner can outlive the input that opened it */
+    t->obj = shared ? vlc_object_create (vlc_object_instance (d->obj),
+                                         sizeof (*t->obj))
+                    : d->obj;
+    if (unlikely(t->obj == NULL))
+    {
+        free (t);
+        t = NULL;
+        goto out;
+    }
+
+    t->adapter = adapter;
+    t->device = d->device;
+    t->shared = shared;
+    t->refs = 1;
+    vlc_mutex_init (&t->lock);
+    vlc_cond_init (&t->wait);
+    t->frontend = -1;
+    t->cam = NULL;
+    t->writer = NULL;
+    t->users = 0;
+    t->tuning.count = 0;
+
+    int ca = dvb_open_node (d, "ca", O_RDWR);
+    if (ca != -1)
+    {
+        t->cam = en50221_Init (t->obj, ca);
+        if (t->cam == NULL)
+            vlc_close (ca);
+    }
+    else
+        msg_Dbg (d->obj, "conditional access module not available: %s",
+                 vlc_strerror_c(errno));
+
+    if (shared)
+        vlc_list_append (&t->node, &dvb_tuners);
+out:
+    vlc_mutex_unlock (&dvb_tuners_lock);
+    return t;
+}
+
 /**
  * Opens the DVB tuner
  */
@@ -202,12 +336,28 @@ dvb_device_t *dvb_open (vlc_object_t *obj)
         return NULL;
     }
     d->frontend = -1;
-    d->cam = NULL;
     d->budget = var_InheritBool (obj, "dvb-budget-mode");
+    d->tuned = false;
+    d->tuning.count = 0;
+    for (size_t i = 0; i < MAX_PIDS; i++)
+    {
+        d->pids[i].fd = -1;
+        d->pids[i].pid = UINT16_MAX;
+    }
 
-#ifndef USE_DMX
-    if (d->budget)
+    /* The DVR device has a single reader: sharing requires PID filtering
+     * on separate demultiplexer handles. */
+    bool shared = var_InheritBool (obj, "dvb-share");
+#ifndef DMX_ADD_PID
+    if (shared && !d->budget)
+    {
+        msg_Warn (obj, "tuner sharing not compiled-in");
+        shared = false;
+    }
 #endif
+    d->tap = d->budget || shared;
+
+    if (d->tap)
     {
        d->demux = dvb_open_node (d, "demux", O_RDONLY);
        if (d->demux == -1)
@@ -236,14 +386,14 @@ dvb_device_t *dvb_open (vlc_object_t *obj)
         {
             msg_Err (obj, "cannot setup TS demultiplexer: %s",
                      vlc_strerror_c(errno));
-            goto error;
+            vlc_close (d->demux);
+            vlc_close (d->dir);
+            free (d);
+            return NULL;
         }
-#ifndef USE_DMX
     }
     else
     {
-        for (size_t i = 0; i < MAX_PIDS; i++)
-            d->pids[i].pid = d->pids[i].fd = -1;
         d->demux = dvb_open_node (d, "dvr", O_RDONLY);
         if (d->demux == -1)
         {
@@ -252,40 +402,38 @@ dvb_device_t *dvb_open (vlc_object_t *obj)
             free (d);
             return NULL;
         }
-#endif
     }
 
-    int ca = dvb_open_node (d, "ca", O_RDWR);
-    if (ca != -1)
+    d->tuner = dvb_tuner_get (d, adapter, shared);
+    if (d->tuner == NULL)
     {
-        d->cam = en50221_Init (obj, ca);
-        if (d->cam == NULL)
-            vlc_close (ca);
+        vlc_close (d->demux);
+        vlc_close (d->dir);
+        free (d);
+        return NULL;
     }
-    else
-        msg_Dbg (obj, "conditional access module not available: %s",
-                 vlc_strerror_c(errno));
     return d;
-
-error:
-    dvb_close (d);
-    return NULL;
 }
 
 void dvb_close (dvb_device_t *d)
 {
-#ifndef USE_DMX
-    if (!d->budget)
+    dvb_tuner_t *t = d->tuner;
+
+    for (size_t i = 0; i < MAX_PIDS; i++)
+        if (d->pids[i].fd != -1)
+            vlc_close (d->pids[i].fd);
+
+    vlc_mutex_lock (&t->lock);
+    if (t->writer == d)
     {
-        for (size_t i = 0; i < MAX_PIDS; i++)
-            if (d->pids[i].fd != -1)
-                vlc_close (d->pids[i].fd);
+        t->writer = NULL;
+        vlc_cond_broadcast (&t->wait);
     }
-#endif
-    if (d->cam != NULL)
-        en50221_End (d->cam);
-    if (d->frontend != -1)
-        vlc_close (d->frontend);
+    if (d->tuned)
+        t->users--;
+    vlc_mutex_unlock (&t->lock);
+
+    dvb_tuner_release (t);
     vlc_close (d->demux);
     vlc_close (d->dir);
     free (d);
@@ -317,8 +465,14 @@ ssize_t dvb_read (dvb_device_t *d, void *buf, size_t len, int ms)
     struct pollfd ufd[2];
     int n;
 
-    if (d->cam != NULL)
-        en50221_Poll (d->cam);
+    dvb_tuner_t *t = d->tuner;
+
+    if (t->cam != NULL)
+    {
+        vlc_mutex_lock (&t->lock);
+        en50221_Poll (t->cam);
+        vlc_mutex_unlock (&t->lock);
+    }
 
     ufd[0].fd = d->demux;
     ufd[0].events = POLLIN;
@@ -344,6 +498,8 @@ ssize_t dvb_read (dvb_device_t *d, void *buf, size_t len, int ms)
 
         if (ioctl (d->frontend, FE_GET_EVENT, &ev) < 0)
         {
+            if (errno == EAGAIN) /* dequeued by another input */
+                return -1;
             if (errno == EOVERFLOW)
             {
                 msg_Err (d->obj, "cannot dequeue events fast enough!");
@@ -380,17 +536,25 @@ int dvb_add_pid (dvb_device_t *d, uint16_t pid)
 {
     if (d->budget)
         return 0;
-#ifdef USE_DMX
-    if (pid == 0 || ioctl (d->demux, DMX_ADD_PID, &pid) >= 0)
-        return 0;
-#else
+
     for (size_t i = 0; i < MAX_PIDS; i++)
     {
         if (d->pids[i].pid == pid)
             return 0;
-        if (d->pids[i].fd != -1)
+        if (d->pids[i].pid != UINT16_MAX)
             continue;
 
+        if (d->tap)
+        {
+#ifdef DMX_ADD_PID
+            /* The PAT is the initial filter of the demultiplexer */
+            if (pid != 0 && ioctl (d->demux, DMX_ADD_PID, &pid) < 0)
+                goto error;
+#endif
+            d->pids[i].pid = pid;
+            return 0;
+        }
+
         int fd = dvb_open_node (d, "demux", O_RDONLY);
         if (fd == -1)
             goto error;
@@ -415,7 +579,6 @@ int dvb_add_pid (dvb_device_t *d, uint16_t pid)
     }
     errno = EMFILE;
 error:
-#endif
     msg_Err (d->obj, "cannot add PID 0x%04"PRIu16": %s", pid,
              vlc_strerror_c(errno));
     return -1;
@@ -425,20 +588,22 @@ void dvb_remove_pid (dvb_device_t *d, uint16_t pid)
 {
     if (d->budget)
         return;
-#ifdef USE_DMX
-    if (pid != 0)
-        ioctl (d->demux, DMX_REMOVE_PID, &pid);
-#else
+
     for (size_t i = 0; i < MAX_PIDS; i++)
     {
         if (d->pids[i].pid == pid)
         {
-            vlc_close (d->pids[i].fd);
-            d->pids[i].pid = d->pids[i].fd = -1;
+#ifdef DMX_ADD_PID
+            if (d->tap && pid != 0)
+                ioctl (d->demux, DMX_REMOVE_PID, &pid);
+#endif
+            if (d->pids[i].fd != -1)
+                vlc_close (d->pids[i].fd);
+            d->pids[i].fd = -1;
+            d->pids[i].pid = UINT16_MAX;
             return;
         }
     }
-#endif
 }
 
 bool dvb_get_pid_state (const dvb_device_t *d, uint16_t pid)
@@ -456,17 +621,22 @@ bool dvb_get_pid_state (const dvb_device_t *d, uint16_t pid)
 /** Finds a frontend of the correct type */
 static int dvb_open_frontend (dvb_device_t *d)
 {
+    dvb_tuner_t *t = d->tuner;
+
     if (d->frontend != -1)
         return 0;
-    int fd = dvb_open_node (d, "frontend", O_RDWR);
-    if (fd == -1)
+
+    vlc_mutex_lock (&t->lock);
+    if (t->frontend == -1)
     {
-        msg_Err (d->obj, "cannot access frontend: %s", vlc_strerror_c(errno));
-        return -1;
+        t->frontend = dvb_open_node (d, "frontend", O_RDWR);
+        if (t->frontend == -1)
+            msg_Err (d->obj, "cannot access frontend: %s",
+                     vlc_strerror_c(errno));
     }
-
-    d->frontend = fd;
-    return 0;
+    d->frontend = t->frontend;
+    vlc_mutex_unlock (&t->lock);
+    return (d->frontend != -1) ? 0 : -1;
 }
 #define dvb_find_frontend(d, sys) (dvb_open_frontend(d))
 
@@ -634,14 +804,52 @@ float dvb_get_snr (dvb_device_t *d)
 
 bool dvb_set_ca_pmt (dvb_device_t *d, en50221_capmt_info_t *p_capmtinfo)
 {
-    if (d->cam != NULL)
+    dvb_tuner_t *t = d->tuner;
+
+    if (t->cam != NULL)
     {
-        en50221_SetCAPMT (d->cam, p_capmtinfo);
+        /* The CAM descrambles the programs of all the inputs */
+        vlc_mutex_lock (&t->lock);
+        en50221_SetCAPMT (t->cam, p_capmtinfo);
+        vlc_mutex_unlock (&t->lock);
         return true;
     }
     return false;
 }
 
+static void dvb_record_prop (dvb_device_t *d, uint32_t cmd, uint32_t data)
+{
+    dvb_tuning_t *tuning = &d->tuning;
+
+    if (tuning->count >= MAX_PROPS)
+    {
+        tuning->count = SIZE_MAX; /* cannot be compared */
+        return;
+    }
+    tuning->props[tuning->count].cmd = cmd;
+    tuning->props[tuning->count].data = data;
+    tuning->count++;
+}
+
+/**
+ * Checks whether the input may configure the frontend. Only one input does
+ * so at a time, and only while no other input receives from the frontend.
+ * Otherwise, the parameters are only recorded, to be compared with the
+ * current tuning.
+ */
+static bool dvb_claim_frontend (dvb_device_t *d)
+{
+    dvb_tuner_t *t = d->tuner;
+    bool ok;
+
+    vlc_mutex_lock (&t->lock);
+    if (t->writer == NULL && t->users == (d->tuned ? 1 : 0))
+        t->writer = d;
+    ok = t->writer == d;
+    vlc_mutex_unlock (&t->lock);
+    return ok;
+}
+
 static int dvb_vset_props (dvb_device_t *d, size_t n, va_list ap)
 {
     assert (n <= DTV_IOCTL_MAX_MSGS);
@@ -657,10 +865,15 @@ static int dvb_vset_props (dvb_device_t *d, size_t n, va_list ap)
         prop->u.data = va_arg (ap, uint32_t);
         msg_Dbg (d->obj, "setting property %2"PRIu32" to %"PRIu32,
                  prop->cmd, prop->u.data);
+        if (prop->cmd != DTV_TUNE)
+            dvb_record_prop (d, prop->cmd, prop->u.data);
         prop++;
         n--;
     }
 
+    if (!dvb_claim_frontend (d))
+        return 0; /* checked by dvb_tune() */
+
     if (ioctl (d->frontend, FE_SET_PROPERTY, &props) < 0)
     {
         msg_Err (d->obj, "cannot set frontend tuning parameters: %s",
@@ -697,9 +910,71 @@ int dvb_set_inversion (dvb_device_t *d, int v)
     return dvb_set_prop (d, DTV_INVERSION, v);
 }
 
+static bool dvb_tuning_equal (const dvb_tuning_t *a, const dvb_tuning_t *b)
+{
+    if (a->count == SIZE_MAX || a->count != b->count)
+        return false;
+
+    for (size_t i = 0; i < a->count; i++)
+        if (a->props[i].cmd != b->props[i].cmd
+         || a->props[i].data != b->props[i].data)
+            return false;
+    return true;
+}
+
 int dvb_tune (dvb_device_t *d)
 {
-    return dvb_set_prop (d, DTV_TUNE, 0 /* dummy */);
+    dvb_tuner_t *t = d->tuner;
+    int ret = 0;
+
+    if (dvb_claim_frontend (d))
+    {
+        ret = dvb_set_prop (d, DTV_TUNE, 0 /* dummy */);
+
+        vlc_mutex_lock (&t->lock);
+        if (ret == 0)
+        {
+            t->tuning = d->tuning;
+            if (!d->tuned)
+                t->users++;
+            d->tuned = true;
+        }
+        t->writer = NULL;
+        vlc_cond_broadcast (&t->wait);
+        vlc_mutex_unlock (&t->lock);
+        d->tuning.count = 0;
+        return ret;
+    }
+
+    /* Another input uses the frontend: join it if tuned the same way */
+    vlc_mutex_lock (&t->lock);
+    while (t->writer != NULL)
+        vlc_cond_wait (&t->wait, &t->lock);
+
+    if (!d->tuned)
+    {
+        if (t->users > 0 && dvb_tuning_equal (&d->tuning, &t->tuning))
+        {
+            msg_Dbg (d->obj, "sharing tuned frontend with %u other input(s)",
+                     t->users);
+            t->users++;
+            d->tuned = true;
+        }
+        else
+        {
+            msg_Err (d->obj, "frontend in use with other tuning parameters");
+            ret = -1;
+        }
+    }
+    else
+    {
+        msg_Err (d->obj, "cannot retune frontend shared with %u input(s)",
+                 t->users - 1);
+        ret = -1;
+    }
+    vlc_mutex_unlock (&t->lock);
+    d->tuning.count = 0;
+    return ret;
 }
 
 int dvb_fill_device_caps(dvb_device_t *d, dvb_device_caps_t *caps)
@@ -758,10 +1033,12 @@ int dvb_set_sec (dvb_device_t *d, uint64_t freq_Hz, char pol,
                  uint32_t lowf, uint32_t highf, uint32_t switchf)
 {
     uint32_t freq = freq_Hz / 1000;
+    bool writer = dvb_claim_frontend (d);
 
     /* Always try to configure high voltage, but only warn on enable failure */
     int val = var_InheritBool (d->obj, "dvb-high-voltage");
-    if (ioctl (d->frontend, FE_ENABLE_HIGH_LNB_VOLTAGE, &val) < 0 && val)
+    if (writer && ioctl (d->frontend, FE_ENABLE_HIGH_LNB_VOLTAGE, &val) < 0
+     && val)
         msg_Err (d->obj, "cannot enable high LNB voltage: %s",
                  vlc_strerror_c(errno));
 
@@ -818,7 +1095,10 @@ known:
         return -1;
 
     unsigned satno = var_InheritInteger (d->obj, "dvb-satno");
-    if (satno > 0)
+    unsigned uncommitted = var_InheritInteger (d->obj, "dvb-uncommitted");
+
+    dvb_record_prop (d, DVB_PROP_DISEQC, (satno << 8) | uncommitted);
+    if (satno > 0 && writer)
     {
 #undef vlc_tick_sleep /* we know what we are doing! */
 
@@ -843,7 +1123,6 @@ known:
         cmd.msg_len = 4; /* length */
 
         vlc_tick_sleep (VLC_TICK_FROM_MS(15)); /* wait 15 ms before DiSEqC command */
-        unsigned uncommitted = var_InheritInteger (d->obj, "dvb-uncommitted");
         if (uncommitted > 0)
         {
           uncommitted = (uncommitted - 1) & 3;
@@ -62,6 +62,7 @@ dvdnav_status_t dvdnav_jump_to_sector_by_time(dvdnav_t *, uint64_t, int32_t);
 #include "../demux/timestamps_filter.h"
 
 #include "disc_helper.h"
+#include "disc_readahead.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -110,6 +111,17 @@ vlc_module_end ()
 
 #define BLOCK_FLAG_CELL_DISCONTINUITY (BLOCK_FLAG_PRIVATE_SHIFT << 1)
 
+/* Disc image read-ahead, when not reading from a device */
+#define DVD_READAHEAD_SIZE  (256 * DVD_VIDEO_LB_LEN)
+#define DVD_READAHEAD_COUNT 4
+
+typedef struct
+{
+    stream_t         *s;
+    disc_readahead_t *p_readahead;
+    uint64_t          i_pos;
+} stream_cb_sys_t;
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -121,6 +133,7 @@ typedef struct
     /* */
     bool        b_reset_pcr;
     bool        b_readahead;
+    stream_cb_sys_t *p_stream;
 
     struct
     {
@@ -487,14 +500,36 @@ static int StreamProbeDVD( stream_t *s )
 /*****************************************************************************
  * dvdnav stream callbacks
  *****************************************************************************/
-static int stream_cb_seek( void *demux, uint64_t pos )
+static int stream_cb_seek( void *opaque, uint64_t pos )
+{
+    stream_cb_sys_t *p_stream = opaque;
+
+    if( p_stream->p_readahead == NULL )
+        return vlc_stream_Seek( p_stream->s, pos );
+
+    p_stream->i_pos = pos;
+    return VLC_SUCCESS;
+}
+
+static int stream_cb_read( void *opaque, void* buffer, int size )
 {
-    return vlc_stream_Seek( ((demux_t *)demux)->s, pos );
+    stream_cb_sys_t *p_stream = opaque;
+
+    if( p_stream->p_readahead == NULL )
+        return vlc_stream_Read( p_stream->s, buffer, size );
+
+    ssize_t i_ret = disc_readahead_Read( p_stream->p_readahead,
+                                         p_stream->i_pos, buffer, size );
+    if( i_ret > 0 )
+        p_stream->i_pos += i_ret;
+    return i_ret;
 }
 
-static int stream_cb_read( void *demux, void* buffer, int size )
+static void stream_cb_sys_Delete( stream_cb_sys_t *p_stream )
 {
-    return vlc_stream_Read( ((demux_t *)demux)->s, buffer, size );
+    if( p_stream->p_readahead )
+        disc_readahead_Delete( p_stream->p_readahead );
+    free( p_stream );
 }
 
 /*****************************************************************************
@@ -527,24 +562,41 @@ static int DemuxOpen ( vlc_object_t *p_this )
         .pf_readv = NULL,
     };
 
+    stream_cb_sys_t *p_stream = malloc( sizeof( *p_stream ) );
+    if( unlikely(p_stream == NULL) )
+        return VLC_ENOMEM;
+
+    /* Read the image ahead of libdvdnav (its own cache is synchronous) */
+    p_stream->s = p_demux->s;
+    p_stream->i_pos = vlc_stream_Tell( p_demux->s );
+    p_stream->p_readahead = disc_readahead_New( p_demux->s,
+                                                DVD_READAHEAD_SIZE,
+                                                DVD_READAHEAD_COUNT );
+
     /* Open dvdnav with stream callbacks */
 #if DVDNAV_VERSION >= 60100
     dvdnav_logger_cb cbs;
     cbs.pf_log = DvdNavLog;
-    if( dvdnav_open_stream2( &p_dvdnav, p_demux,
+    if( dvdnav_open_stream2( &p_dvdnav, p_stream,
                              &cbs, &stream_cb ) != DVDNAV_STATUS_OK )
 #else
-    if( dvdnav_open_stream( &p_dvdnav, p_demux,
+    if( dvdnav_open_stream( &p_dvdnav, p_stream,
                             &stream_cb ) != DVDNAV_STATUS_OK )
 #endif
     {
         msg_Warn( p_demux, "cannot open DVD with open_stream" );
+        stream_cb_sys_Delete( p_stream );
         return VLC_EGENERIC;
     }
 
     int i_ret = CommonOpen( p_this, p_dvdnav, false );
     if( i_ret != VLC_SUCCESS )
+    {
         dvdnav_close( p_dvdnav );
+        stream_cb_sys_Delete( p_stream );
+    }
+    else
+        ((demux_sys_t *)p_demux->p_sys)->p_stream = p_stream;
     return i_ret;
 }
 
@@ -578,6 +630,8 @@ static void Close( vlc_object_t *p_this )
     timestamps_filter_es_out_Delete( p_sys->p_tf_out );
 
     dvdnav_close( p_sys->dvdnav );
+    if( p_sys->p_stream )
+        stream_cb_sys_Delete( p_sys->p_stream );
     free( p_sys );
 }
 
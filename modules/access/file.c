@@ -52,6 +52,10 @@
 #   include <unistd.h>
 #endif
 #include <dirent.h>
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#   include <stdatomic.h>
+#endif
 
 #include <vlc_common.h>
 #include "fs.h"
@@ -63,11 +67,40 @@
 #include <vlc_url.h>
 #include <vlc_interrupt.h>
 
+#ifdef HAVE_MMAP
+/* Size of the mapped window, aligned on its own size within the file */
+# define FILE_MAP_WINDOW ((sizeof (void *) >= 8) ? (64 << 20) : (8 << 20))
+/* Maximum size of a block (view) within the window */
+# define FILE_MAP_BLOCK  (1 << 20)
+/* Number of contiguous blocks after a seek to assume sequential access */
+# define FILE_MAP_SEQUENTIAL 4
+
+struct file_map
+{
+    atomic_uint refs;
+    uint64_t offset; /**< File offset of the mapping */
+    size_t length;
+    void *addr;
+};
+
+struct file_view
+{
+    block_t block;
+    struct file_map *map;
+};
+#endif
+
 typedef struct
 {
     int fd;
 
     bool b_pace_control;
+#ifdef HAVE_MMAP
+    struct file_map *map; /**< Current window (or NULL) */
+    uint64_t offset; /**< Current read offset */
+    uint64_t size; /**< File size, as of last check */
+    unsigned contiguous; /**< Blocks read since last seek */
+#endif
 } access_sys_t;
 
 #if !defined (_WIN32) && !defined (__OS2__)
@@ -129,6 +162,11 @@ static bool IsRemote (const char *path)
 static ssize_t Read (stream_t *, void *, size_t);
 static int FileSeek (stream_t *, uint64_t);
 static int FileControl (stream_t *, int, va_list);
+#ifdef HAVE_MMAP
+static block_t *MapBlock (stream_t *, bool *);
+static int MapSeek (stream_t *, uint64_t);
+static void MapRelease (struct file_map *);
+#endif
 
 /*****************************************************************************
  * FileOpen: open the file
@@ -213,6 +251,9 @@ int FileOpen( vlc_object_t *p_this )
     p_access->pf_control = FileControl;
     p_access->p_sys = p_sys;
     p_sys->fd = fd;
+#ifdef HAVE_MMAP
+    p_sys->map = NULL;
+#endif
 
     if (S_ISREG (st.st_mode) || S_ISBLK (st.st_mode))
     {
@@ -231,6 +272,22 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_MMAP
+        /* Blocks are views into a mapping of the file, rather than copies.
+         * Remote file systems are excluded, as I/O errors would be fatal. */
+        if (S_ISREG (st.st_mode)
+         && var_InheritBool (p_access, "file-mmap")
+         && !IsRemote(fd, p_access->psz_filepath))
+        {
+            msg_Dbg (p_access, "using memory mapped I/O");
+            p_access->pf_read = NULL;
+            p_access->pf_block = MapBlock;
+            p_access->pf_seek = MapSeek;
+            p_sys->offset = 0;
+            p_sys->size = st.st_size;
+            p_sys->contiguous = 0;
+        }
 #endif
     }
     else
@@ -253,7 +310,7 @@ void FileClose (vlc_object_t * p_this)
 {
     stream_t     *p_access = (stream_t*)p_this;
 
-    if (p_access->pf_read == NULL)
+    if (p_access->pf_readdir != NULL)
     {
         DirClose (p_this);
         return;
@@ -261,6 +318,11 @@ void FileClose (vlc_object_t * p_this)
 
     access_sys_t *p_sys = p_access->p_sys;
 
+#ifdef HAVE_MMAP
+    /* Blocks still in use keep their own reference to the mapping */
+    if (p_sys->map != NULL)
+        MapRelease (p_sys->map);
+#endif
     vlc_close (p_sys->fd);
 }
 
@@ -287,6 +349,131 @@ static ssize_t Read (stream_t *p_access, void *p_buffer, size_t i_len)
     return val;
 }
 
+#ifdef HAVE_MMAP
+static void MapRelease (struct file_map *map)
+{
+    if (atomic_fetch_sub_explicit (&map->refs, 1, memory_order_acq_rel) == 1)
+    {
+        munmap (map->addr, map->length);
+        free (map);
+    }
+}
+
+static void MapViewRelease (block_t *block)
+{
+    struct file_view *view = container_of(block, struct file_view, block);
+
+    MapRelease (view->map);
+    free (view);
+}
+
+static const struct vlc_block_callbacks map_view_cbs =
+{
+    MapViewRelease,
+};
+
+/**
+ * Maps the window of the file containing the current read offset.
+ */
+static struct file_map *MapWindow (stream_t *p_access)
+{
+    access_sys_t *sys = p_access->p_sys;
+    struct file_map *map = malloc (sizeof (*map));
+    if (unlikely(map == NULL))
+        return NULL;
+
+    map->offset = sys->offset & ~(uint64_t)(FILE_MAP_WINDOW - 1);
+    map->length = __MIN(sys->size - map->offset, FILE_MAP_WINDOW);
+    /* Private writable mapping: consumers may modify blocks in place. */
+    map->addr = mmap (NULL, map->length, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                      sys->fd, map->offset);
+    if (map->addr == MAP_FAILED)
+    {
+        msg_Err (p_access, "cannot map file: %s", vlc_strerror_c(errno));
+        free (map);
+        return NULL;
+    }
+    atomic_init (&map->refs, 1);
+
+    /* Let the kernel read ahead aggressively, unless the demuxer seeks. */
+    madvise (map->addr, map->length,
+             (sys->contiguous >= FILE_MAP_SEQUENTIAL) ? MADV_SEQUENTIAL
+                                                      : MADV_RANDOM);
+    return map;
+}
+
+static block_t *MapBlock (stream_t *p_access, bool *restrict eof)
+{
+    access_sys_t *sys = p_access->p_sys;
+
+    if (sys->offset >= sys->size)
+    {   /* The file may have grown since it was opened */
+        struct stat st;
+
+        if (fstat (sys->fd, &st) == 0)
+            sys->size = st.st_size;
+        if (sys->offset >= sys->size)
+        {
+            *eof = true;
+            return NULL;
+        }
+    }
+
+    struct file_map *map = sys->map;
+
+    if (map == NULL || sys->offset < map->offset
+     || sys->offset - map->offset >= map->length)
+    {
+        if (map != NULL)
+            MapRelease (map);
+        map = sys->map = MapWindow (p_access);
+        if (map == NULL)
+        {
+            *eof = true;
+            return NULL;
+        }
+    }
+
+    struct file_view *view = malloc (sizeof (*view));
+    if (unlikely(view == NULL))
+        return NULL;
+
+    size_t pos = sys->offset - map->offset;
+    size_t len = __MIN(map->length - pos, FILE_MAP_BLOCK);
+
+    /* The view must not be grown in place by vlc_frame_TryRealloc(), as that
+     * would overwrite the following data. */
+    block_Init (&view->block, &map_view_cbs, (char *)map->addr + pos, len);
+    view->map = map;
+    atomic_fetch_add_explicit (&map->refs, 1, memory_order_relaxed);
+
+    sys->offset += len;
+
+    if (++sys->contiguous == FILE_MAP_SEQUENTIAL)
+        madvise (map->addr, map->length, MADV_SEQUENTIAL);
+    else if (sys->contiguous < FILE_MAP_SEQUENTIAL
+          && sys->offset - map->offset < map->length)
+    {   /* Random access: only prefetch the next block */
+        long page_mask = sysconf (_SC_PAGESIZE) - 1;
+        size_t next = (pos + len) & ~page_mask;
+        size_t ahead = __MIN(map->length - next, FILE_MAP_BLOCK);
+
+        madvise ((char *)map->addr + next, ahead, MADV_WILLNEED);
+    }
+    return &view->block;
+}
+
+static int MapSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *sys = p_access->p_sys;
+
+    if (i_pos != sys->offset)
+        sys->contiguous = 0;
+    sys->offset = i_pos;
+    return VLC_SUCCESS;
+}
+#endif
+
 /*****************************************************************************
  * Seek: seek to a specific location in a file
  *****************************************************************************/
@@ -38,6 +38,11 @@ vlc_module_begin ()
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
 
+    add_bool( "file-mmap", false, N_("Memory mapped I/O"),
+              N_("Read local files through memory mappings rather than "
+                 "copying their data. Files must not be truncated while "
+                 "they are being read.") )
+
     add_submodule()
     set_section( N_("Directory" ), NULL )
     set_capability( "access", 55 )
@@ -104,6 +104,15 @@ static int FileControl(stream_t *access, int query, va_list args)
             *va_arg(args, char **) = vlc_http_file_get_type(sys->resource);
             break;
 
+        case STREAM_GET_VALIDATOR:
+        {
+            char *validator = vlc_http_file_get_validator(sys->resource);
+            if (validator == NULL)
+                return VLC_EGENERIC;
+            *va_arg(args, char **) = validator;
+            break;
+        }
+
         case STREAM_SET_PAUSE_STATE:
             break;
 
@@ -174,7 +183,8 @@ static int Open(vlc_object_t *obj)
     vlc_UrlParse(&crd_url, access->psz_url);
     vlc_credential_init(&crd, &crd_url);
 
-    sys->manager = vlc_http_mgr_create(obj, jar);
+    sys->manager = vlc_http_mgr_create(obj, jar,
+                                       var_InheritAddress(obj, "http-pool"));
     if (sys->manager == NULL)
         goto error;
 
@@ -190,6 +200,10 @@ static int Open(vlc_object_t *obj)
     if (sys->resource == NULL)
         goto error;
 
+    if (!live)
+        vlc_http_file_set_parallel(sys->resource,
+                                   var_InheritInteger(obj, "http-parallel"));
+
     if (vlc_credential_get(&crd, obj, NULL, NULL, NULL, NULL))
         vlc_http_res_set_login(sys->resource,
                                crd.psz_username, crd.psz_password);
@@ -293,6 +307,12 @@ vlc_module_begin()
         change_volatile()
     add_bool("http-forward-cookies", true, N_("Cookies forwarding"),
              N_("Forward cookies across HTTP redirections."))
+    add_integer_with_range("http-parallel", 0, 0, 16,
+                           N_("Parallel range requests"),
+                           N_("Fetch a file with this many concurrent requests "
+                              "for consecutive byte ranges. This can speed up "
+                              "downloads over high-latency links. "
+                              "Zero disables this."))
     add_string("http-referrer", NULL, N_("Referrer"),
                N_("Provide the referral URL, i.e. HTTP \"Referer\" (sic)."))
         change_safe()
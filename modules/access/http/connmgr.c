@@ -27,6 +27,7 @@
 #include <vlc_network.h>
 #include <vlc_tls.h>
 #include <vlc_url.h>
+#include <vlc_http.h>
 #include "transport.h"
 #include "conn.h"
 #include "connmgr.h"
@@ -102,14 +103,58 @@ struct vlc_http_mgr
     vlc_object_t *obj;
     vlc_tls_client_t *creds;
     struct vlc_http_cookie_jar_t *jar;
+    vlc_http_pool_t *pool;
+    vlc_mutex_t lock;
     struct vlc_http_conn *conn;
+    char *key; /**< Server of the connection, for the idle pool */
+    bool multiplexed;
 };
 
+static char *vlc_http_mgr_key(bool https, bool h2, const char *host,
+                              unsigned port)
+{
+    char *key;
+
+    if (port == 0)
+        port = https ? 443 : 80;
+    if (asprintf(&key, "%s %s %u", https ? (h2 ? "h2" : "https") : "http",
+                 host, port) < 0)
+        key = NULL;
+    return key;
+}
+
+static void vlc_http_mgr_release_idle(void *conn)
+{
+    vlc_http_conn_release(conn);
+}
+
 static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
-                                               const char *host, unsigned port)
+                                               bool https, const char *host,
+                                               unsigned port)
 {
-    (void) host; (void) port;
-    return mgr->conn;
+    if (mgr->conn != NULL || mgr->pool == NULL)
+        return mgr->conn;
+
+    /* Take over an idle connection left by another manager, preferably a
+     * multiplexed one. */
+    for (int h2 = https; h2 >= 0; h2--)
+    {
+        char *key = vlc_http_mgr_key(https, h2, host, port);
+        if (unlikely(key == NULL))
+            break;
+
+        struct vlc_http_conn *conn = vlc_http_pool_get(mgr->pool, key);
+        if (conn != NULL)
+        {
+            vlc_http_dbg(mgr->logger, "reusing idle connection (%s)", key);
+            mgr->conn = conn;
+            mgr->key = key;
+            mgr->multiplexed = h2;
+            return conn;
+        }
+        free(key);
+    }
+    return NULL;
 }
 
 static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
@@ -117,17 +162,20 @@ static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
 {
     assert(mgr->conn == conn);
     mgr->conn = NULL;
+    free(mgr->key);
+    mgr->key = NULL;
+    mgr->multiplexed = false;
 
     vlc_http_conn_release(conn);
 }
 
 static
-struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
+struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr, bool https,
                                         const char *host, unsigned port,
                                         const struct vlc_http_msg *req,
                                         bool payload)
 {
-    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
+    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, https, host, port);
     if (conn == NULL)
         return NULL;
 
@@ -156,7 +204,10 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
 
     if (mgr->creds == NULL)
     {   /* First TLS connection: load x509 credentials */
-        mgr->creds = vlc_tls_ClientCreate(mgr->obj);
+        if (mgr->pool != NULL)
+            mgr->creds = vlc_http_pool_get_tls(mgr->pool);
+        else
+            mgr->creds = vlc_tls_ClientCreate(mgr->obj);
         if (mgr->creds == NULL)
             return NULL;
     }
@@ -167,8 +218,8 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
          * the nonidempotent request was processed if the connection fails
          * before the response is received.
          */
-        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req,
-                                                       payload);
+        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, true, host, port,
+                                                       req, payload);
         if (resp != NULL)
             return resp; /* existing connection reused */
     }
@@ -210,7 +261,9 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         vlc_http_mgr_release(mgr, mgr->conn);
 
     mgr->conn = conn;
-    return vlc_http_mgr_reuse(mgr, host, port, req, payload);
+    mgr->key = vlc_http_mgr_key(true, http2, host, port);
+    mgr->multiplexed = http2;
+    return vlc_http_mgr_reuse(mgr, true, host, port, req, payload);
 }
 
 static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
@@ -223,8 +276,8 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
 
     if (idempotent)
     {
-        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req,
-                                                       payload);
+        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, false, host, port,
+                                                       req, payload);
         if (resp != NULL)
             return resp;
     }
@@ -267,6 +320,7 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         vlc_http_mgr_release(mgr, mgr->conn);
 
     mgr->conn = conn;
+    mgr->key = vlc_http_mgr_key(false, false, host, port);
     return resp;
 }
 
@@ -278,8 +332,20 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
     if (port && vlc_http_port_blocked(port))
         return NULL;
 
-    return (https ? vlc_https_request : vlc_http_request)(mgr, host, port, m,
-                                                          idempotent, payload);
+    vlc_mutex_lock(&mgr->lock);
+    struct vlc_http_msg *resp =
+        (https ? vlc_https_request : vlc_http_request)(mgr, host, port, m,
+                                                       idempotent, payload);
+    vlc_mutex_unlock(&mgr->lock);
+    return resp;
+}
+
+bool vlc_http_mgr_is_multiplexed(struct vlc_http_mgr *mgr)
+{
+    vlc_mutex_lock(&mgr->lock);
+    bool multiplexed = mgr->multiplexed;
+    vlc_mutex_unlock(&mgr->lock);
+    return multiplexed;
 }
 
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
@@ -288,25 +354,42 @@ struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
 }
 
 struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
-                                         struct vlc_http_cookie_jar_t *jar)
+                                         struct vlc_http_cookie_jar_t *jar,
+                                         vlc_http_pool_t *pool)
 {
     struct vlc_http_mgr *mgr = malloc(sizeof (*mgr));
     if (unlikely(mgr == NULL))
         return NULL;
 
-    mgr->logger = obj->logger;
+    /* Pooled connections outlive the object: log through the instance */
+    mgr->logger = (pool != NULL) ? vlc_object_instance(obj)->obj.logger
+                                 : obj->logger;
     mgr->obj = obj;
     mgr->creds = NULL;
     mgr->jar = jar;
+    mgr->pool = pool;
+    vlc_mutex_init(&mgr->lock);
     mgr->conn = NULL;
+    mgr->key = NULL;
+    mgr->multiplexed = false;
     return mgr;
 }
 
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
 {
     if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
-    if (mgr->creds != NULL)
+    {
+        if (mgr->pool != NULL && mgr->key != NULL)
+        {   /* Keep the connection alive for the next manager */
+            vlc_http_pool_put(mgr->pool, mgr->key, mgr->conn,
+                              vlc_http_mgr_release_idle);
+            mgr->conn = NULL;
+            free(mgr->key);
+        }
+        else
+            vlc_http_mgr_release(mgr, mgr->conn);
+    }
+    if (mgr->creds != NULL && mgr->pool == NULL)
         vlc_tls_ClientDelete(mgr->creds);
     free(mgr);
 }
@@ -32,6 +32,7 @@
 struct vlc_http_mgr;
 struct vlc_http_msg;
 struct vlc_http_cookie_jar_t;
+struct vlc_http_pool;
 
 /**
  * Sends an HTTP request
@@ -57,6 +58,17 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
 
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
 
+/**
+ * Tells whether requests can be multiplexed
+ *
+ * Concurrent requests through the same connection manager are serialized
+ * until they get their initial response. They then share the connection if
+ * it is an HTTP/2 one. Otherwise, each opens a new connection.
+ *
+ * @return true if the current connection is an HTTP/2 one
+ */
+bool vlc_http_mgr_is_multiplexed(struct vlc_http_mgr *mgr);
+
 /**
  * Creates an HTTP connection manager
  *
@@ -64,9 +76,12 @@ struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
  *
  * @param obj parent VLC object
  * @param jar HTTP cookies jar (NULL to disable cookies)
+ * @param pool pool of idle connections to reuse and leave the connection to
+ *             on destruction (NULL to disable)
  */
 struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
-                                         struct vlc_http_cookie_jar_t *jar);
+                                         struct vlc_http_cookie_jar_t *jar,
+                                         struct vlc_http_pool *pool);
 
 /**
  * Destroys an HTTP connection manager
@@ -32,6 +32,7 @@
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_interrupt.h>
 #include <vlc_strings.h>
 #include "message.h"
 #include "resource.h"
@@ -39,22 +40,22 @@
 
 #pragma GCC visibility push(default)
 
+struct vlc_http_fetch;
+
 struct vlc_http_file
 {
     struct vlc_http_resource resource;
     uintmax_t offset;
+    unsigned parallel; /**< Maximum parallel range requests */
+    struct vlc_http_fetch *fetch; /**< Parallel range fetcher (or NULL) */
 };
 
-static int vlc_http_file_req(const struct vlc_http_resource *res,
-                             struct vlc_http_msg *req, void *opaque)
+static void vlc_http_file_validator(const struct vlc_http_resource *res,
+                                    struct vlc_http_msg *req)
 {
-    struct vlc_http_file *file = (struct vlc_http_file *)res;
-    const uintmax_t *offset = opaque;
-
-    if (file->resource.response != NULL)
+    if (res->response != NULL)
     {
-        const char *str = vlc_http_msg_get_header(file->resource.response,
-                                                  "ETag");
+        const char *str = vlc_http_msg_get_header(res->response, "ETag");
         if (str != NULL)
         {
             if (!memcmp(str, "W/", 2))
@@ -63,11 +64,19 @@ static int vlc_http_file_req(const struct vlc_http_resource *res,
         }
         else
         {
-            time_t mtime = vlc_http_msg_get_mtime(file->resource.response);
+            time_t mtime = vlc_http_msg_get_mtime(res->response);
             if (mtime != -1)
                 vlc_http_msg_add_time(req, "If-Unmodified-Since", &mtime);
         }
     }
+}
+
+static int vlc_http_file_req(const struct vlc_http_resource *res,
+                             struct vlc_http_msg *req, void *opaque)
+{
+    const uintmax_t *offset = opaque;
+
+    vlc_http_file_validator(res, req);
 
     if (vlc_http_msg_add_header(req, "Range", "bytes=%" PRIuMAX "-", *offset)
      && *offset != 0)
@@ -104,10 +113,375 @@ fail:
     return -1;
 }
 
+static int vlc_http_chunk_req(const struct vlc_http_resource *res,
+                              struct vlc_http_msg *req, void *opaque)
+{
+    const uintmax_t *range = opaque;
+
+    vlc_http_file_validator(res, req);
+
+    return vlc_http_msg_add_header(req, "Range", "bytes=%" PRIuMAX "-%" PRIuMAX,
+                                   range[0], range[1]);
+}
+
+static const struct vlc_http_resource_cbs vlc_http_chunk_callbacks =
+{
+    vlc_http_chunk_req,
+    vlc_http_file_resp, /* range[0] is the start offset */
+    NULL,
+};
+
+/*** Parallel range fetcher ***/
+
+#define VLC_HTTP_CHUNK_SIZE (1u << 21)
+#define VLC_HTTP_FETCH_MAX 16
+
+/** Consecutive byte range of the file */
+struct vlc_http_chunk
+{
+    uintmax_t index; /**< Range number, or UINTMAX_MAX if none */
+    block_t *head; /**< Received data */
+    block_t **tailp;
+    size_t length; /**< Received bytes count */
+    bool busy; /**< Being fetched by a worker */
+};
+
+struct vlc_http_fetch_worker
+{
+    struct vlc_http_fetch *fetch;
+    vlc_interrupt_t *interrupt;
+    vlc_thread_t thread;
+};
+
+/**
+ * Fetches the ranges ahead of the read position, each worker thread with its
+ * own request. The slots form a ring indexed by range number: the range
+ * before the read position is kept for short backward seeks, and the others
+ * are fetched in advance.
+ */
+struct vlc_http_fetch
+{
+    const struct vlc_http_resource *res;
+    uintmax_t size; /**< File size */
+    uintmax_t cur; /**< Range at the read position */
+    unsigned workers;
+    unsigned slots;
+    bool stop;
+    bool interrupted;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait_data; /**< Signaled on data reception */
+    vlc_cond_t wait_work; /**< Signaled when ranges may be fetched */
+    struct vlc_http_fetch_worker worker[VLC_HTTP_FETCH_MAX];
+    struct vlc_http_chunk chunk[2 * VLC_HTTP_FETCH_MAX];
+};
+
+static size_t vlc_http_chunk_length(const struct vlc_http_fetch *fetch,
+                                    uintmax_t index)
+{
+    uintmax_t left = fetch->size - index * VLC_HTTP_CHUNK_SIZE;
+
+    return (left < VLC_HTTP_CHUNK_SIZE) ? left : VLC_HTTP_CHUNK_SIZE;
+}
+
+static void vlc_http_chunk_reset(struct vlc_http_chunk *c, uintmax_t index)
+{
+    block_ChainRelease(c->head);
+    c->index = index;
+    c->head = NULL;
+    c->tailp = &c->head;
+    c->length = 0;
+}
+
+static bool vlc_http_fetch_in_window(const struct vlc_http_fetch *fetch,
+                                     uintmax_t index)
+{
+    return index + 1 >= fetch->cur && index < fetch->cur + fetch->slots - 1;
+}
+
+/** Picks the earliest range of the window that is not fetched yet. */
+static struct vlc_http_chunk *vlc_http_fetch_next(struct vlc_http_fetch *fetch)
+{
+    for (uintmax_t index = fetch->cur;
+         index < fetch->cur + fetch->slots - 1
+      && index * VLC_HTTP_CHUNK_SIZE < fetch->size;
+         index++)
+    {
+        struct vlc_http_chunk *c = &fetch->chunk[index % fetch->slots];
+
+        if (c->index == index || c->busy)
+            continue;
+
+        vlc_http_chunk_reset(c, index);
+        c->busy = true;
+        return c;
+    }
+    return NULL;
+}
+
+static void vlc_http_fetch_chunk(struct vlc_http_fetch *fetch,
+                                 struct vlc_http_chunk *c, uintmax_t index)
+{
+    const size_t length = vlc_http_chunk_length(fetch, index);
+    uintmax_t range[2];
+
+    range[0] = index * VLC_HTTP_CHUNK_SIZE;
+    range[1] = range[0] + length - 1;
+
+    /* Only the request callbacks differ. The reading thread leaves the
+     * resource alone while the fetcher exists. */
+    struct vlc_http_resource res = *fetch->res;
+
+    res.cbs = &vlc_http_chunk_callbacks;
+
+    struct vlc_http_msg *resp = vlc_http_res_open(&res, range);
+    if (resp == NULL)
+        return;
+
+    if (vlc_http_msg_get_status(resp) == 206)
+    {
+        block_t *block;
+        bool more = true;
+
+        while (more && (block = vlc_http_msg_read(resp)) != NULL
+            && block != vlc_http_error)
+        {
+            vlc_mutex_lock(&fetch->lock);
+            if (likely(c->index == index))
+            {
+                if (block->i_buffer > length - c->length)
+                    block->i_buffer = length - c->length;
+
+                c->length += block->i_buffer;
+                more = c->length < length;
+                block_ChainLastAppend(&c->tailp, block);
+                vlc_cond_broadcast(&fetch->wait_data);
+            }
+            else
+            {   /* Range went out of the window */
+                block_Release(block);
+                more = false;
+            }
+            vlc_mutex_unlock(&fetch->lock);
+        }
+    }
+    vlc_http_msg_destroy(resp);
+}
+
+static void *vlc_http_fetch_thread(void *data)
+{
+    struct vlc_http_fetch_worker *worker = data;
+    struct vlc_http_fetch *fetch = worker->fetch;
+
+    vlc_interrupt_set(worker->interrupt);
+
+    vlc_mutex_lock(&fetch->lock);
+    while (!fetch->stop)
+    {
+        struct vlc_http_chunk *c = vlc_http_fetch_next(fetch);
+
+        if (c == NULL)
+        {
+            vlc_cond_wait(&fetch->wait_work, &fetch->lock);
+            continue;
+        }
+
+        uintmax_t index = c->index;
+
+        vlc_mutex_unlock(&fetch->lock);
+        vlc_http_fetch_chunk(fetch, c, index);
+        vlc_mutex_lock(&fetch->lock);
+
+        /* The range is complete, failed or abandoned */
+        c->busy = false;
+        vlc_cond_broadcast(&fetch->wait_data);
+        vlc_cond_broadcast(&fetch->wait_work);
+    }
+    vlc_mutex_unlock(&fetch->lock);
+    return NULL;
+}
+
+static void vlc_http_fetch_destroy(struct vlc_http_fetch *fetch)
+{
+    vlc_mutex_lock(&fetch->lock);
+    fetch->stop = true;
+    vlc_cond_broadcast(&fetch->wait_work);
+    vlc_mutex_unlock(&fetch->lock);
+
+    for (unsigned i = 0; i < fetch->workers; i++)
+        vlc_interrupt_kill(fetch->worker[i].interrupt);
+
+    for (unsigned i = 0; i < fetch->workers; i++)
+    {
+        vlc_join(fetch->worker[i].thread, NULL);
+        vlc_interrupt_destroy(fetch->worker[i].interrupt);
+    }
+
+    for (unsigned i = 0; i < fetch->slots; i++)
+        block_ChainRelease(fetch->chunk[i].head);
+    free(fetch);
+}
+
+static struct vlc_http_fetch *
+vlc_http_fetch_create(const struct vlc_http_resource *res, unsigned workers,
+                      uintmax_t size, uintmax_t offset)
+{
+    struct vlc_http_fetch *fetch = malloc(sizeof (*fetch));
+    if (unlikely(fetch == NULL))
+        return NULL;
+
+    if (workers > VLC_HTTP_FETCH_MAX)
+        workers = VLC_HTTP_FETCH_MAX;
+
+    fetch->res = res;
+    fetch->size = size;
+    fetch->cur = offset / VLC_HTTP_CHUNK_SIZE;
+    fetch->workers = 0;
+    fetch->slots = 2 * workers;
+    fetch->stop = false;
+    fetch->interrupted = false;
+    vlc_mutex_init(&fetch->lock);
+    vlc_cond_init(&fetch->wait_data);
+    vlc_cond_init(&fetch->wait_work);
+
+    for (unsigned i = 0; i < fetch->slots; i++)
+    {
+        fetch->chunk[i].head = NULL;
+        vlc_http_chunk_reset(&fetch->chunk[i], UINTMAX_MAX);
+        fetch->chunk[i].busy = false;
+    }
+
+    while (fetch->workers < workers)
+    {
+        struct vlc_http_fetch_worker *worker = fetch->worker + fetch->workers;
+
+        worker->fetch = fetch;
+        worker->interrupt = vlc_interrupt_create();
+        if (unlikely(worker->interrupt == NULL))
+            break;
+
+        if (vlc_clone(&worker->thread, vlc_http_fetch_thread, worker,
+                      VLC_THREAD_PRIORITY_INPUT))
+        {
+            vlc_interrupt_destroy(worker->interrupt);
+            break;
+        }
+        fetch->workers++;
+    }
+
+    if (fetch->workers < 2)
+    {
+        vlc_http_fetch_destroy(fetch);
+        return NULL;
+    }
+    return fetch;
+}
+
+/** Moves the window to the given read position. */
+static void vlc_http_fetch_move(struct vlc_http_fetch *fetch, uintmax_t offset)
+{
+    uintmax_t cur = offset / VLC_HTTP_CHUNK_SIZE;
+
+    if (cur == fetch->cur)
+        return;
+
+    fetch->cur = cur;
+
+    /* Abandon the transfers that are no longer useful */
+    for (unsigned i = 0; i < fetch->slots; i++)
+    {
+        struct vlc_http_chunk *c = &fetch->chunk[i];
+
+        if (c->busy && !vlc_http_fetch_in_window(fetch, c->index))
+            vlc_http_chunk_reset(c, UINTMAX_MAX);
+    }
+    vlc_cond_broadcast(&fetch->wait_work);
+}
+
+static void vlc_http_fetch_wake_up(void *data)
+{
+    struct vlc_http_fetch *fetch = data;
+
+    vlc_mutex_lock(&fetch->lock);
+    fetch->interrupted = true;
+    vlc_cond_broadcast(&fetch->wait_data);
+    vlc_mutex_unlock(&fetch->lock);
+}
+
+/**
+ * Reads data at the given offset from the fetched ranges.
+ *
+ * \return a data block, NULL on end of file or interruption,
+ *         or vlc_http_error if the range could not be fetched
+ */
+static block_t *vlc_http_fetch_read(struct vlc_http_fetch *fetch,
+                                    uintmax_t offset)
+{
+    if (offset >= fetch->size)
+        return NULL;
+
+    const uintmax_t index = offset / VLC_HTTP_CHUNK_SIZE;
+    size_t pos = offset % VLC_HTTP_CHUNK_SIZE;
+    struct vlc_http_chunk *c = &fetch->chunk[index % fetch->slots];
+    block_t *block = NULL;
+
+    fetch->interrupted = false;
+    vlc_interrupt_register(vlc_http_fetch_wake_up, fetch);
+    vlc_mutex_lock(&fetch->lock);
+    vlc_http_fetch_move(fetch, offset);
+
+    while ((c->index != index || (c->length <= pos && c->busy))
+        && !fetch->interrupted)
+        vlc_cond_wait(&fetch->wait_data, &fetch->lock);
+
+    if (c->index == index && c->length > pos)
+    {   /* Copy everything received from the offset onward */
+        block = block_Alloc(c->length - pos);
+        if (likely(block != NULL))
+        {
+            uint8_t *p = block->p_buffer;
+            const block_t *b = c->head;
+
+            while (pos >= b->i_buffer)
+            {
+                pos -= b->i_buffer;
+                b = b->p_next;
+            }
+
+            for (; b != NULL; b = b->p_next)
+            {
+                memcpy(p, b->p_buffer + pos, b->i_buffer - pos);
+                p += b->i_buffer - pos;
+                pos = 0;
+            }
+        }
+        else
+            block = vlc_http_error;
+    }
+    else if (!fetch->interrupted)
+        block = vlc_http_error; /* range transfer failed */
+
+    vlc_mutex_unlock(&fetch->lock);
+    vlc_interrupt_unregister();
+    return block;
+}
+
+static void vlc_http_file_destroy_fetch(struct vlc_http_resource *res)
+{
+    struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    if (file->fetch != NULL)
+    {
+        vlc_http_fetch_destroy(file->fetch);
+        file->fetch = NULL;
+    }
+}
+
 static const struct vlc_http_resource_cbs vlc_http_file_callbacks =
 {
     vlc_http_file_req,
     vlc_http_file_resp,
+    vlc_http_file_destroy_fetch,
 };
 
 struct vlc_http_resource *vlc_http_file_create(struct vlc_http_mgr *mgr,
@@ -126,9 +500,19 @@ struct vlc_http_resource *vlc_http_file_create(struct vlc_http_mgr *mgr,
     }
 
     file->offset = 0;
+    file->parallel = 0;
+    file->fetch = NULL;
     return &file->resource;
 }
 
+void vlc_http_file_set_parallel(struct vlc_http_resource *res, unsigned count)
+{
+    struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    assert(file->fetch == NULL);
+    file->parallel = count;
+}
+
 static uintmax_t vlc_http_msg_get_file_size(const struct vlc_http_msg *resp)
 {
     int status = vlc_http_msg_get_status(resp);
@@ -193,6 +577,32 @@ uintmax_t vlc_http_file_get_size(struct vlc_http_resource *res)
     return vlc_http_msg_get_size(res->response);
 }
 
+char *vlc_http_file_get_validator(struct vlc_http_resource *res)
+{
+    int status = vlc_http_res_get_status(res);
+    if (status < 0 || status >= 300)
+        return NULL;
+
+    const char *str = vlc_http_msg_get_header(res->response, "ETag");
+    char *ret;
+
+    if (str != NULL)
+    {   /* Weak entity tags do not guarantee byte-for-byte equality */
+        if (!strncmp(str, "W/", 2))
+            return NULL;
+        if (asprintf(&ret, "etag:%s", str) < 0)
+            ret = NULL;
+        return ret;
+    }
+
+    time_t mtime = vlc_http_msg_get_mtime(res->response);
+    if (mtime == -1)
+        return NULL;
+    if (asprintf(&ret, "mtime:%jd", (intmax_t)mtime) < 0)
+        ret = NULL;
+    return ret;
+}
+
 bool vlc_http_file_can_seek(struct vlc_http_resource *res)
 {   /* See IETF RFC7233 */
     int status = vlc_http_res_get_status(res);
@@ -203,12 +613,18 @@ bool vlc_http_file_can_seek(struct vlc_http_resource *res)
 
 int vlc_http_file_seek(struct vlc_http_resource *res, uintmax_t offset)
 {
+    struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    if (file->fetch != NULL)
+    {   /* Ranges are requested by the fetcher as needed */
+        file->offset = offset;
+        return 0;
+    }
+
     struct vlc_http_msg *resp = vlc_http_res_open(res, &offset);
     if (resp == NULL)
         return -1;
 
-    struct vlc_http_file *file = (struct vlc_http_file *)res;
-
     int status = vlc_http_msg_get_status(resp);
     if (res->response != NULL)
     {   /* Accept the new and ditch the old one if:
@@ -229,9 +645,56 @@ int vlc_http_file_seek(struct vlc_http_resource *res, uintmax_t offset)
     return 0;
 }
 
+static void vlc_http_file_start_fetch(struct vlc_http_file *file)
+{
+    struct vlc_http_resource *res = &file->resource;
+    int status = vlc_http_res_get_status(res);
+
+    if (status >= 200 && status < 300 && vlc_http_msg_can_seek(res->response))
+    {
+        uintmax_t size = vlc_http_file_get_size(res);
+
+        /* Not worth it if everything fits a single range */
+        if (size != (uintmax_t)-1 && size > file->offset
+         && size - file->offset > VLC_HTTP_CHUNK_SIZE)
+            file->fetch = vlc_http_fetch_create(res, file->parallel, size,
+                                                file->offset);
+    }
+
+    if (file->fetch != NULL)
+        /* The fetcher requests the data again, range by range */
+        vlc_http_msg_close_payload(res->response);
+    else
+        file->parallel = 0;
+}
+
 block_t *vlc_http_file_read(struct vlc_http_resource *res)
 {
     struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    if (file->parallel > 1 && file->fetch == NULL)
+        vlc_http_file_start_fetch(file);
+
+    if (file->fetch != NULL)
+    {
+        block_t *block = vlc_http_fetch_read(file->fetch, file->offset);
+
+        if (block != vlc_http_error)
+        {
+            if (block != NULL)
+                file->offset += block->i_buffer;
+            return block;
+        }
+
+        /* Fall back to a single request from the current offset */
+        vlc_http_fetch_destroy(file->fetch);
+        file->fetch = NULL;
+        file->parallel = 0;
+
+        if (vlc_http_file_seek(res, file->offset))
+            return NULL;
+    }
+
     block_t *block = vlc_http_res_read(res);
 
     if (block == vlc_http_error)
@@ -45,6 +45,18 @@ struct vlc_http_resource *vlc_http_file_create(struct vlc_http_mgr *mgr,
                                                const char *url, const char *ua,
                                                const char *ref);
 
+/**
+ * Enables parallel range requests.
+ *
+ * Even if a single request cannot fill the link, e.g. due to high latency,
+ * several requests for consecutive byte ranges ahead of the read offset can.
+ * This only takes effect for files of known size supporting seeking.
+ * Ranges already fetched also serve short seeks without new requests.
+ *
+ * @param count maximum number of concurrent requests (0 or 1 to disable)
+ */
+void vlc_http_file_set_parallel(struct vlc_http_resource *, unsigned count);
+
 /**
  * Gets file size.
  *
@@ -78,6 +90,16 @@ int vlc_http_file_seek(struct vlc_http_resource *, uintmax_t offset);
  */
 block_t *vlc_http_file_read(struct vlc_http_resource *);
 
+/**
+ * Gets a validator.
+ *
+ * Derives a string from the strong entity tag, or else from the
+ * last modification time, that changes whenever the file content changes.
+ *
+ * @return a heap-allocated string, or NULL if no suitable validator exists
+ */
+char *vlc_http_file_get_validator(struct vlc_http_resource *);
+
 #define vlc_http_file_get_status vlc_http_res_get_status
 #define vlc_http_file_get_redirect vlc_http_res_get_redirect
 #define vlc_http_file_get_type vlc_http_res_get_type
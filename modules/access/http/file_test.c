@@ -26,10 +26,14 @@
 
 #include <assert.h>
 #include <inttypes.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <vlc_common.h>
+#include <vlc_block.h>
 #include <vlc_http.h>
 #include "resource.h"
 #include "file.h"
@@ -48,9 +52,34 @@ static uintmax_t offset = 0;
 static bool secure = true;
 static bool etags = false;
 static int lang = -1;
+static bool ranges = false;
+static atomic_uint range_requests;
+
+#define RANGES_SIZE 11234567
 
 static vlc_http_cookie_jar_t *jar;
 
+static uint8_t range_byte(uintmax_t offset)
+{
+    return offset + offset / 251;
+}
+
+static uintmax_t range_check(struct vlc_http_resource *f, uintmax_t offset,
+                             unsigned count)
+{
+    block_t *block;
+
+    while (count-- > 0 && (block = vlc_http_file_read(f)) != NULL)
+    {
+        assert(block->i_buffer > 0);
+        for (size_t i = 0; i < block->i_buffer; i++)
+            assert(block->p_buffer[i] == range_byte(offset + i));
+        offset += block->i_buffer;
+        block_Release(block);
+    }
+    return offset;
+}
+
 int main(void)
 {
     struct vlc_http_resource *f;
@@ -270,6 +299,31 @@ int main(void)
     assert(f != NULL);
     vlc_http_file_destroy(f);
 
+    /* Parallel range requests */
+    ranges = true;
+    f = vlc_http_file_create(NULL, url, ua, NULL);
+    assert(f != NULL);
+    vlc_http_file_set_parallel(f, 3);
+    assert(vlc_http_file_can_seek(f));
+    assert(vlc_http_file_get_size(f) == RANGES_SIZE);
+    assert(range_check(f, 0, UINT_MAX) == RANGES_SIZE);
+    assert(vlc_http_file_read(f) == NULL);
+    assert(atomic_load(&range_requests) > 2);
+
+    /* Backward, forward and out of file seeks */
+    assert(vlc_http_file_seek(f, RANGES_SIZE - 3000000) == 0);
+    assert(range_check(f, RANGES_SIZE - 3000000, UINT_MAX) == RANGES_SIZE);
+    assert(vlc_http_file_seek(f, 1234) == 0);
+    assert(range_check(f, 1234, 10) > 1234);
+    assert(vlc_http_file_seek(f, 7654321) == 0);
+    assert(range_check(f, 7654321, 30) > 7654321);
+    assert(vlc_http_file_seek(f, RANGES_SIZE + 1) == 0);
+    assert(vlc_http_file_read(f) == NULL);
+    assert(vlc_http_file_seek(f, 42) == 0);
+    assert(range_check(f, 42, 3) > 42);
+    vlc_http_file_destroy(f);
+    ranges = false;
+
     vlc_http_cookies_destroy(jar);
     return 0;
 }
@@ -278,10 +332,11 @@ int main(void)
 #include "h2frame.h"
 
 struct vlc_h2_frame *
-vlc_h2_frame_headers(uint_fast32_t id, uint_fast32_t mtu, bool eos,
-                     unsigned count, const char *const tab[][2])
+vlc_h2_frame_headers(struct hpack_encoder *enc, uint_fast32_t id,
+                     uint_fast32_t mtu, bool eos, unsigned count,
+                     const char *const tab[][2])
 {
-    (void) id; (void) mtu; (void) count, (void) tab;
+    (void) enc; (void) id; (void) mtu; (void) count, (void) tab;
     assert(!eos);
     return NULL;
 }
@@ -334,6 +389,90 @@ static const struct vlc_http_stream_cbs stream_callbacks =
 
 static struct vlc_http_stream stream = { &stream_callbacks };
 
+struct range_stream
+{
+    struct vlc_http_stream stream;
+    uintmax_t start;
+    uintmax_t end;
+};
+
+static struct vlc_http_msg *range_read_headers(struct vlc_http_stream *s)
+{
+    struct range_stream *rs = container_of(s, struct range_stream, stream);
+    struct vlc_http_msg *m;
+    char *answer;
+
+    assert(rs->end < RANGES_SIZE);
+    if (asprintf(&answer, "HTTP/1.1 206 Partial Content\r\n"
+                 "Content-Range: bytes %ju-%ju/%u\r\n"
+                 "ETag: \"foobar42\"\r\n"
+                 "\r\n", rs->start, rs->end, RANGES_SIZE) < 0)
+        abort();
+
+    m = vlc_http_msg_headers(answer);
+    assert(m != NULL);
+    free(answer);
+    vlc_http_msg_attach(m, s);
+    return m;
+}
+
+static block_t *range_read(struct vlc_http_stream *s)
+{
+    struct range_stream *rs = container_of(s, struct range_stream, stream);
+
+    if (rs->start > rs->end)
+        return NULL;
+
+    size_t len = 1000 + (rs->start % 1500);
+    if (len > rs->end - rs->start + 1)
+        len = rs->end - rs->start + 1;
+
+    block_t *block = block_Alloc(len);
+    assert(block != NULL);
+
+    for (size_t i = 0; i < len; i++)
+        block->p_buffer[i] = range_byte(rs->start + i);
+    rs->start += len;
+    return block;
+}
+
+static void range_close(struct vlc_http_stream *s, bool abort)
+{
+    (void) abort;
+    free(container_of(s, struct range_stream, stream));
+}
+
+static const struct vlc_http_stream_cbs range_callbacks =
+{
+    range_read_headers,
+    NULL,
+    range_read,
+    range_close,
+};
+
+static struct vlc_http_msg *range_request(const struct vlc_http_msg *req)
+{
+    struct range_stream *rs = malloc(sizeof (*rs));
+    const char *str;
+
+    assert(rs != NULL);
+    atomic_fetch_add(&range_requests, 1);
+    rs->stream.cbs = &range_callbacks;
+    rs->end = RANGES_SIZE - 1;
+
+    str = vlc_http_msg_get_header(req, "Range");
+    assert(str != NULL);
+    int n = sscanf(str, "bytes=%ju-%ju", &rs->start, &rs->end);
+    assert(n >= 1);
+    assert(rs->start <= rs->end);
+
+    str = vlc_http_msg_get_header(req, "If-Match");
+    if (rs->start != 0)
+        assert(str != NULL && !strcmp(str, "\"foobar42\""));
+
+    return vlc_http_msg_get_initial(&rs->stream);
+}
+
 struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
                                           const char *host, unsigned port,
                                           const struct vlc_http_msg *req,
@@ -342,6 +481,9 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
     const char *str;
     char *end;
 
+    if (ranges)
+        return range_request(req);
+
     assert(https == secure);
     assert(mgr == NULL);
     assert(!strcmp(host, "www.example.com"));
@@ -412,7 +412,7 @@ struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
             else
                 vlc_http_conn_release(conn);
 
-            freeaddrinfo(res);
+            vlc_freeaddrinfo(res);
             return stream;
         }
 
@@ -423,6 +423,6 @@ struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
     }
 
     /* All address info failed. */
-    freeaddrinfo(res);
+    vlc_freeaddrinfo(res);
     return NULL;
 }
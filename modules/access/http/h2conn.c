@@ -39,12 +39,16 @@
 
 #include "h2frame.h"
 #include "h2output.h"
+#include "hpack.h"
 #include "conn.h"
 #include "message.h"
 
 #define CO(c) ((c)->opaque)
 #define SO(s) CO((s)->conn)
 
+/* Upper bound for the per-stream receive window growth */
+#define VLC_H2_MAX_RECV_WINDOW (16u << 20)
+
 /** HTTP/2 connection */
 struct vlc_h2_conn
 {
@@ -55,6 +59,7 @@ struct vlc_h2_conn
     struct vlc_h2_stream *streams; /**< List of open streams */
     uint32_t next_id; /**< Next free stream identifier */
     bool released; /**< Connection released by owner */
+    struct hpack_encoder *encoder; /**< Sent headers compression state */
 
     uint32_t max_send_frame; /**< Maximum sent frame size */
     uint32_t init_send_cwnd; /**< Initial send congestion window */
@@ -82,6 +87,7 @@ struct vlc_h2_stream
     struct vlc_http_msg *recv_hdr; /**< Latest received headers (or NULL) */
 
     size_t recv_cwnd; /**< Free space in receive congestion window */
+    uint32_t recv_window; /**< Receive congestion window size */
     struct vlc_h2_frame *recv_head; /**< Earliest pending received buffer */
     struct vlc_h2_frame **recv_tailp; /**< Tail of receive queue */
     vlc_cond_t recv_wait;
@@ -379,10 +385,14 @@ static block_t *vlc_h2_stream_read(struct vlc_http_stream *stream)
         container_of(stream, struct vlc_h2_stream, stream);
     struct vlc_h2_conn *conn = s->conn;
     struct vlc_h2_frame *f;
+    bool starved = false;
 
     vlc_h2_stream_lock(s);
     while ((f = s->recv_head) == NULL && !s->recv_end && !s->interrupted)
+    {
         vlc_cond_wait(&s->recv_wait, &conn->lock);
+        starved = true;
+    }
 
     if (f == NULL)
     {
@@ -410,9 +420,15 @@ static block_t *vlc_h2_stream_read(struct vlc_http_stream *stream)
     assert(s->recv_cwnd >= len);
     s->recv_cwnd -= len;
 
+    /* If the reader had to wait while most of the window was in flight, the
+     * peer was probably stalled by flow control: widen the window. */
+    if (starved && s->recv_cwnd < s->recv_window / 2
+     && s->recv_window < VLC_H2_MAX_RECV_WINDOW)
+        s->recv_window *= 2;
+
     /* Credit the receive window if missing credit exceeds 50%. */
-    uint_fast32_t credit = VLC_H2_INIT_WINDOW - s->recv_cwnd;
-    if (credit >= (VLC_H2_INIT_WINDOW / 2)
+    uint_fast32_t credit = s->recv_window - s->recv_cwnd;
+    if (credit >= (s->recv_window / 2)
      && !vlc_h2_conn_queue(conn, vlc_h2_frame_window_update(s->id, credit)))
         s->recv_cwnd += credit;
 
@@ -517,6 +533,7 @@ static struct vlc_http_stream *vlc_h2_stream_open(struct vlc_http_conn *c,
     s->recv_err = 0;
     s->recv_hdr = NULL;
     s->recv_cwnd = VLC_H2_INIT_WINDOW;
+    s->recv_window = VLC_H2_INIT_WINDOW;
     s->recv_head = NULL;
     s->recv_tailp = &s->recv_head;
     vlc_cond_init(&s->recv_wait);
@@ -535,7 +552,8 @@ static struct vlc_http_stream *vlc_h2_stream_open(struct vlc_http_conn *c,
     s->id = conn->next_id;
     conn->next_id += 2;
 
-    struct vlc_h2_frame *f = vlc_http_msg_h2_frame(msg, s->id, !has_data);
+    struct vlc_h2_frame *f = vlc_http_msg_h2_frame(msg, conn->encoder, s->id,
+                                                   !has_data);
     if (f == NULL)
         goto error;
 
@@ -582,6 +600,9 @@ static void vlc_h2_setting(void *ctx, uint_fast16_t id, uint_fast32_t value)
 
     switch (id)
     {
+        case VLC_H2_SETTING_HEADER_TABLE_SIZE:
+            hpack_encode_resize(conn->encoder, value);
+            break;
         case VLC_H2_SETTING_INITIAL_WINDOW_SIZE:
             vlc_h2_initial_window_update(conn, value);
             break;
@@ -840,6 +861,7 @@ static void vlc_h2_conn_destroy(struct vlc_h2_conn *conn)
     vlc_tls_Shutdown(conn->conn.tls, true);
 
     vlc_tls_Close(conn->conn.tls);
+    hpack_encode_destroy(conn->encoder);
     free(conn);
 }
 
@@ -874,6 +896,7 @@ struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *tls)
     conn->conn.cbs = &vlc_h2_conn_callbacks;
     conn->conn.tls = tls;
     conn->out = vlc_h2_output_create(tls, true);
+    conn->encoder = hpack_encode_init(VLC_H2_DEFAULT_MAX_HEADER_TABLE);
     conn->opaque = ctx;
     conn->streams = NULL;
     conn->next_id = 1; /* TODO: server side */
@@ -882,7 +905,7 @@ struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *tls)
     conn->init_send_cwnd = VLC_H2_DEFAULT_INIT_WINDOW;
     conn->send_cwnd = VLC_H2_DEFAULT_INIT_WINDOW;
 
-    if (unlikely(conn->out == NULL))
+    if (unlikely(conn->out == NULL || conn->encoder == NULL))
         goto error;
 
     vlc_mutex_init(&conn->lock);
@@ -891,12 +914,13 @@ struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *tls)
     if (vlc_h2_conn_queue(conn, vlc_h2_frame_settings())
      || vlc_clone(&conn->thread, vlc_h2_recv_thread, conn,
                   VLC_THREAD_PRIORITY_INPUT))
-    {
-        vlc_h2_output_destroy(conn->out);
         goto error;
-    }
     return &conn->conn;
 error:
+    if (conn->out != NULL)
+        vlc_h2_output_destroy(conn->out);
+    if (conn->encoder != NULL)
+        hpack_encode_destroy(conn->encoder);
     free(conn);
     return NULL;
 }
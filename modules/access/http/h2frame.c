@@ -152,33 +152,37 @@ enum {
 };
 
 struct vlc_h2_frame *
-vlc_h2_frame_headers(uint_fast32_t stream_id, uint_fast32_t mtu, bool eos,
-                     unsigned count, const char *const headers[][2])
+vlc_h2_frame_headers(struct hpack_encoder *enc, uint_fast32_t stream_id,
+                     uint_fast32_t mtu, bool eos, unsigned count,
+                     const char *const headers[][2])
 {
     struct vlc_h2_frame *f;
     uint8_t flags = eos ? VLC_H2_HEADERS_END_STREAM : 0;
 
-    size_t len = hpack_encode(NULL, 0, headers, count);
+    /* Indexing can only shorten the block, except for a table size update.
+     * The encoder state changes when encoding, so encode exactly once. */
+    size_t len = hpack_encode(NULL, NULL, 0, headers, count);
+    if (enc != NULL)
+        len += HPACK_ENCODE_MAX_UPDATE;
+
+    uint8_t *payload = malloc(len);
+    if (unlikely(payload == NULL))
+        return NULL;
+
+    len = hpack_encode(enc, payload, len, headers, count);
 
     if (likely(len <= mtu))
-    {   /* Most common case: single frame - with zero copy */
+    {   /* Most common case: single frame */
         flags |= VLC_H2_HEADERS_END_HEADERS;
 
         f = vlc_h2_frame_alloc(VLC_H2_FRAME_HEADERS, flags, stream_id, len);
-        if (unlikely(f == NULL))
-            return NULL;
-
-        hpack_encode(vlc_h2_frame_payload(f), len, headers, count);
+        if (likely(f != NULL))
+            memcpy(vlc_h2_frame_payload(f), payload, len);
+        free(payload);
         return f;
     }
 
     /* Edge case: HEADERS frame then CONTINUATION frame(s) */
-    uint8_t *payload = malloc(len);
-    if (unlikely(payload == NULL))
-        return NULL;
-
-    hpack_encode(payload, len, headers, count);
-
     struct vlc_h2_frame **pp = &f, *n;
     const uint8_t *offset = payload;
     uint_fast8_t type = VLC_H2_FRAME_HEADERS;
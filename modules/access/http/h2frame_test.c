@@ -272,7 +272,8 @@ static struct vlc_h2_frame *localize(struct vlc_h2_frame *f)
 static struct vlc_h2_frame *response(bool eos)
 {
     /* Use ridiculously small MTU to test headers fragmentation */
-    return vlc_h2_frame_headers(STREAM_ID, 16, eos, resp_hdrc, resp_hdrv);
+    return vlc_h2_frame_headers(NULL, STREAM_ID, 16, eos, resp_hdrc,
+                                resp_hdrv);
 }
 
 static struct vlc_h2_frame *data(bool eos)
@@ -461,7 +462,7 @@ int main(void)
 
     ret = test_seq(CTX, rst_stream(),
                         vlc_h2_frame_window_update(0, 0x1000),
-                        vlc_h2_frame_headers(STREAM_ID + 2,
+                        vlc_h2_frame_headers(NULL, STREAM_ID + 2,
                                              VLC_H2_DEFAULT_MAX_FRAME, true,
                                              resp_hdrc, resp_hdrv),
                         NULL);
@@ -61,12 +61,197 @@ static const char hpack_values[][14] =
     "206", "304", "400", "404", "500", "", "gzip, deflate"
 };
 
+static_assert(sizeof (hpack_names) / sizeof (hpack_names[0])
+              == HPACK_STATIC_ENTRIES, "Wrong static table size");
+
+/**
+ * Looks a header up in the static table.
+ * @param exact set if the value matches too
+ * @return the (1-based) index, or 0 if the name is not found
+ */
+unsigned hpack_static_find(const char *name, const char *value,
+                           bool *restrict exact)
+{
+    unsigned found = 0;
+
+    for (unsigned i = 0; i < HPACK_STATIC_ENTRIES; i++)
+    {
+        if (strcasecmp(hpack_names[i], name))
+            continue;
+
+        if (i < sizeof (hpack_values) / sizeof (hpack_values[0])
+         && hpack_values[i][0] != '\0' && !strcmp(hpack_values[i], value))
+        {
+            *exact = true;
+            return i + 1;
+        }
+        if (found == 0)
+            found = i + 1;
+    }
+
+    *exact = false;
+    return found;
+}
+
+/*
+ * The dynamic table entries are stored contiguously as pairs of
+ * nul-terminated strings, oldest first. Evicting advances the start offset,
+ * and the live entries are moved back to the beginning of the buffer only
+ * when appending reaches its end. The buffer is allocated at twice the
+ * maximum size, so that moves are amortized.
+ */
+void hpack_table_init(struct hpack_table *t, size_t max_size)
+{
+    t->buf = NULL;
+    t->buf_start = t->buf_end = t->buf_size = 0;
+    t->offsets = NULL;
+    t->first = t->count = t->offsets_size = 0;
+    t->size = 0;
+    t->max_size = max_size;
+}
+
+void hpack_table_clean(struct hpack_table *t)
+{
+    free(t->offsets);
+    free(t->buf);
+}
+
+/**
+ * Gets a dynamic table entry.
+ * @param idx entry index, zero being the newest entry
+ * @return the entry name, followed by the value
+ */
+const char *hpack_table_get(const struct hpack_table *t, size_t idx)
+{
+    assert(idx < t->count);
+    return t->buf + t->offsets[t->first + t->count - (idx + 1)];
+}
+
+static size_t hpack_entry_size(const char *entry)
+{
+    size_t namelen = strlen(entry);
+
+    return 32 + namelen + strlen(entry + namelen + 1);
+}
+
+static void hpack_table_evict(struct hpack_table *t, size_t max_size)
+{
+    while (t->size > max_size)
+    {
+        assert(t->count > 0);
+
+        size_t entry_size = hpack_entry_size(t->buf + t->offsets[t->first]);
+
+        assert(t->size >= entry_size);
+        t->size -= entry_size;
+        t->first++;
+        t->count--;
+    }
+
+    if (t->count > 0)
+        t->buf_start = t->offsets[t->first];
+    else
+        t->buf_start = t->buf_end = t->first = 0;
+}
+
+/**
+ * Changes the maximum size of the dynamic table, evicting entries as needed.
+ */
+void hpack_table_resize(struct hpack_table *t, size_t max_size)
+{
+    t->max_size = max_size;
+    hpack_table_evict(t, max_size);
+}
+
+/**
+ * Makes room for len more bytes and one more entry.
+ */
+static int hpack_table_reserve(struct hpack_table *t, size_t len)
+{
+    if (t->buf_end + len > t->buf_size)
+    {
+        size_t live = t->buf_end - t->buf_start;
+
+        if (live + len > t->buf_size)
+        {
+            size_t size = 2 * t->max_size;
+            if (size < live + len)
+                size = live + len;
+
+            char *buf = malloc(size);
+            if (buf == NULL)
+                return -1;
+            if (live > 0)
+                memcpy(buf, t->buf + t->buf_start, live);
+            free(t->buf);
+            t->buf = buf;
+            t->buf_size = size;
+        }
+        else
+            memmove(t->buf, t->buf + t->buf_start, live);
+
+        for (size_t i = 0; i < t->count; i++)
+            t->offsets[t->first + i] -= t->buf_start;
+        t->buf_start = 0;
+        t->buf_end = live;
+    }
+
+    if (t->first + t->count >= t->offsets_size)
+    {
+        if (t->count < t->offsets_size / 2)
+            memmove(t->offsets, t->offsets + t->first,
+                    t->count * sizeof (*t->offsets));
+        else
+        {
+            size_t n = t->offsets_size ? 2 * t->offsets_size : 16;
+            size_t *tab = malloc(n * sizeof (*tab));
+            if (tab == NULL)
+                return -1;
+            if (t->count > 0)
+                memcpy(tab, t->offsets + t->first,
+                       t->count * sizeof (*tab));
+            free(t->offsets);
+            t->offsets = tab;
+            t->offsets_size = n;
+        }
+        t->first = 0;
+    }
+    return 0;
+}
+
+/**
+ * Inserts a new (newest) entry into the dynamic table.
+ */
+int hpack_table_append(struct hpack_table *t, const char *name,
+                       const char *value)
+{
+    size_t namelen = strlen(name), valuelen = strlen(value);
+    size_t entry_size = 32 + namelen + valuelen;
+
+    if (entry_size > t->max_size)
+    {   /* Too large entry: the table is emptied */
+        hpack_table_evict(t, 0);
+        return 0;
+    }
+
+    hpack_table_evict(t, t->max_size - entry_size);
+
+    if (hpack_table_reserve(t, namelen + valuelen + 2))
+        return -1;
+
+    char *entry = t->buf + t->buf_end;
+
+    memcpy(entry, name, namelen + 1);
+    memcpy(entry + namelen + 1, value, valuelen + 1);
+    t->offsets[t->first + t->count++] = t->buf_end;
+    t->buf_end += namelen + valuelen + 2;
+    t->size += entry_size;
+    return 0;
+}
+
 struct hpack_decoder
 {
-    char **table;
-    size_t entries;
-    size_t size;
-    size_t max_size;
+    struct hpack_table table;
 };
 
 struct hpack_decoder *hpack_decode_init(size_t header_table_size)
@@ -75,18 +260,13 @@ struct hpack_decoder *hpack_decode_init(size_t header_table_size)
     if (dec == NULL)
         return NULL;
 
-    dec->table = NULL;
-    dec->entries = 0;
-    dec->size = 0;
-    dec->max_size = header_table_size;
+    hpack_table_init(&dec->table, header_table_size);
     return dec;
 }
 
 void hpack_decode_destroy(struct hpack_decoder *dec)
 {
-    for (unsigned i = 0; i < dec->entries; i++)
-        free(dec->table[i]);
-    free(dec->table);
+    hpack_table_clean(&dec->table);
     free(dec);
 }
 
@@ -334,15 +514,12 @@ static char *hpack_lookup_name(const struct hpack_decoder *dec,
     }
 
     idx--;
-    if (idx < sizeof (hpack_names) / sizeof (hpack_names[0]))
+    if (idx < HPACK_STATIC_ENTRIES)
         return strdup(hpack_names[idx]);
 
-    idx -= sizeof (hpack_names) / sizeof (hpack_names[0]);
-    if (idx < dec->entries)
-    {
-        const char *entry = dec->table[dec->entries - (idx + 1)];
-        return strdup(entry);
-    }
+    idx -= HPACK_STATIC_ENTRIES;
+    if (idx < dec->table.count)
+        return strdup(hpack_table_get(&dec->table, idx));
 
     errno = EINVAL;
     return NULL;
@@ -360,13 +537,13 @@ static char *hpack_lookup_value(const struct hpack_decoder *dec,
     idx--;
     if (idx < sizeof (hpack_values) / sizeof (hpack_values[0]))
         return strdup(hpack_values[idx]);
-    if (idx < sizeof (hpack_names) / sizeof (hpack_names[0]))
+    if (idx < HPACK_STATIC_ENTRIES)
         return strdup("");
 
-    idx -= sizeof (hpack_names) / sizeof (hpack_names[0]);
-    if (idx < dec->entries)
+    idx -= HPACK_STATIC_ENTRIES;
+    if (idx < dec->table.count)
     {
-        const char *entry = dec->table[dec->entries - (idx + 1)];
+        const char *entry = hpack_table_get(&dec->table, idx);
         return strdup(entry + strlen(entry) + 1);
     }
 
@@ -374,61 +551,6 @@ static char *hpack_lookup_value(const struct hpack_decoder *dec,
     return NULL;
 }
 
-static void hpack_decode_evict(struct hpack_decoder *dec)
-{
-    /* Eviction: count how many entries to evict */
-    size_t evicted = 0;
-    while (dec->size > dec->max_size)
-    {
-        assert(evicted < dec->entries);
-
-        size_t namelen = strlen(dec->table[evicted]);
-        size_t valuelen = strlen(dec->table[evicted] + namelen + 1);
-
-        assert(dec->size >= 32 + namelen + valuelen);
-        dec->size -= 32 + namelen + valuelen;
-        evicted++;
-    }
-
-    /* Eviction: remove oldest entries */
-    if (evicted > 0)
-    {
-        for (size_t i = 0; i < evicted; i++)
-            free(dec->table[i]);
-
-        dec->entries -= evicted;
-        memmove(dec->table, dec->table + evicted,
-                sizeof (dec->table[0]) * dec->entries);
-    }
-}
-
-static int hpack_append_hdr(struct hpack_decoder *dec,
-                            const char *name, const char *value)
-{
-    size_t namelen = strlen(name), valuelen = strlen(value);
-    char *entry = malloc(namelen + valuelen + 2);
-    if (entry == NULL)
-        return -1;
-    memcpy(entry, name, namelen + 1);
-    memcpy(entry + namelen + 1, value, valuelen + 1);
-
-    char **newtab = realloc(dec->table,
-                            sizeof (dec->table[0]) * (dec->entries + 1));
-    if (newtab == NULL)
-    {
-        free(entry);
-        return -1;
-    }
-
-    dec->table = newtab;
-    dec->table[dec->entries] = entry;
-    dec->entries++;
-    dec->size += 32 + namelen + valuelen;
-
-    hpack_decode_evict(dec);
-    return 0;
-}
-
 static int hpack_decode_hdr_indexed(struct hpack_decoder *dec,
                                     const uint8_t **restrict datap,
                                     size_t *restrict lengthp,
@@ -481,7 +603,7 @@ static int hpack_decode_hdr_index(struct hpack_decoder *dec,
         return -1;
     }
 
-    if (hpack_append_hdr(dec, name, value))
+    if (hpack_table_append(&dec->table, name, value))
     {
         free(value);
         free(name);
@@ -534,15 +656,14 @@ static int hpack_decode_tbl_update(struct hpack_decoder *dec,
     if (max < 0)
         return -1;
 
-    if ((size_t)max > dec->max_size)
+    if ((size_t)max > dec->table.max_size)
     {   /* Increasing the maximum is not permitted per the specification */
         errno = EINVAL;
         return -1;
     }
 
     *value = *name = NULL;
-    dec->max_size = max;
-    hpack_decode_evict(dec);
+    hpack_table_resize(&dec->table, max);
     return 0;
 }
 
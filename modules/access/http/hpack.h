@@ -25,6 +25,35 @@
  * @{
  */
 
+/** Number of entries in the HPACK static table */
+#define HPACK_STATIC_ENTRIES 61
+
+/**
+ * HPACK dynamic table, as maintained by both the decoder and the encoder.
+ */
+struct hpack_table
+{
+    char *buf; /**< Entries, as name then value nul-terminated strings */
+    size_t buf_start; /**< Offset of the oldest entry */
+    size_t buf_end; /**< Offset after the newest entry */
+    size_t buf_size; /**< Allocated bytes */
+    size_t *offsets; /**< Offsets of the entries, oldest first */
+    size_t first; /**< Index of the oldest entry offset */
+    size_t count; /**< Number of entries */
+    size_t offsets_size; /**< Allocated offsets */
+    size_t size; /**< Table size, including the 32-bytes entry overhead */
+    size_t max_size; /**< Maximum table size */
+};
+
+void hpack_table_init(struct hpack_table *, size_t max_size);
+void hpack_table_clean(struct hpack_table *);
+const char *hpack_table_get(const struct hpack_table *, size_t idx);
+void hpack_table_resize(struct hpack_table *, size_t max_size);
+int hpack_table_append(struct hpack_table *, const char *name,
+                       const char *value);
+unsigned hpack_static_find(const char *name, const char *value,
+                           bool *restrict exact);
+
 struct hpack_decoder;
 
 struct hpack_decoder *hpack_decode_init(size_t header_table_size);
@@ -33,9 +62,19 @@ void hpack_decode_destroy(struct hpack_decoder *);
 int hpack_decode(struct hpack_decoder *dec, const uint8_t *data,
                  size_t length, char *headers[][2], unsigned max);
 
+struct hpack_encoder;
+
+/** Maximum size of a table size update at the start of a block */
+#define HPACK_ENCODE_MAX_UPDATE 6
+
+struct hpack_encoder *hpack_encode_init(size_t header_table_size);
+void hpack_encode_destroy(struct hpack_encoder *);
+void hpack_encode_resize(struct hpack_encoder *, size_t header_table_size);
+
 size_t hpack_encode_hdr_neverindex(uint8_t *restrict buf, size_t size,
                                    const char *name, const char *value);
-size_t hpack_encode(uint8_t *restrict buf, size_t size,
-                    const char *const headers[][2], unsigned count);
+size_t hpack_encode(struct hpack_encoder *enc, uint8_t *restrict buf,
+                    size_t size, const char *const headers[][2],
+                    unsigned count);
 
 /** @} */
@@ -27,21 +27,63 @@
 #endif
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "hpack.h"
 
 /*
- * This is currently the simplest possible HPACK compressor: it does not
- * compress anything and is stateless.
+ * This is a simple HPACK compressor. It refers to the static table for
+ * header names and values. If it has a state, it also inserts the headers
+ * that tend to repeat from one request to the next (host, user agent...) in
+ * the dynamic table, so that subsequent requests refer to those.
  * TODO:
- *  - use static Huffman compression when useful,
- *  - use header names and values from the static HPACK table,
- *  - become stateful and let the caller specify the indexed flag,
- *  - let caller specify the never-indexed flag.
+ *  - use static Huffman compression when useful.
  */
 
+struct hpack_encoder
+{
+    struct hpack_table table;
+    size_t max_size; /**< Table size limit from the decoder */
+    bool update; /**< Whether a table size update must be signaled */
+};
+
+struct hpack_encoder *hpack_encode_init(size_t header_table_size)
+{
+    struct hpack_encoder *enc = malloc(sizeof (*enc));
+    if (enc == NULL)
+        return NULL;
+
+    hpack_table_init(&enc->table, header_table_size);
+    enc->max_size = header_table_size;
+    enc->update = false;
+    return enc;
+}
+
+void hpack_encode_destroy(struct hpack_encoder *enc)
+{
+    hpack_table_clean(&enc->table);
+    free(enc);
+}
+
+/**
+ * Applies the maximum table size setting of the decoder.
+ */
+void hpack_encode_resize(struct hpack_encoder *enc, size_t header_table_size)
+{
+    /* Never use more than the initial size, even if the decoder allows */
+    if (header_table_size > enc->max_size)
+        header_table_size = enc->max_size;
+
+    if (header_table_size != enc->table.max_size)
+    {
+        hpack_table_resize(&enc->table, header_table_size);
+        enc->update = true;
+    }
+}
+
 static size_t hpack_encode_int(uint8_t *restrict buf, size_t size,
                                uintmax_t value, unsigned n)
 {
@@ -151,15 +193,170 @@ size_t hpack_encode_hdr_neverindex(uint8_t *restrict buf, size_t size,
     return ret;
 }
 
-size_t hpack_encode(uint8_t *restrict buf, size_t size,
-                    const char *const headers[][2], unsigned count)
+/** Headers that must never be indexed */
+static bool hpack_is_sensitive(const char *name)
+{
+    static const char names[][20] = {
+        "authorization", "cookie", "proxy-authorization", "set-cookie",
+    };
+
+    for (size_t i = 0; i < sizeof (names) / sizeof (names[0]); i++)
+        if (!strcasecmp(name, names[i]))
+            return true;
+    return false;
+}
+
+/** Headers that are not worth indexing, as they change every time */
+static bool hpack_is_volatile(const char *name)
+{
+    static const char names[][20] = {
+        ":path", "content-length", "content-range", "date", "if-match",
+        "if-modified-since", "if-none-match", "if-range", "range",
+    };
+
+    for (size_t i = 0; i < sizeof (names) / sizeof (names[0]); i++)
+        if (!strcasecmp(name, names[i]))
+            return true;
+    return false;
+}
+
+/**
+ * Looks a header up in the static and dynamic tables.
+ * @return the index of the header, or of its name only, or 0 if not found
+ */
+static unsigned hpack_find(const struct hpack_encoder *enc, const char *name,
+                           const char *value, bool *restrict exact)
+{
+    unsigned idx = hpack_static_find(name, value, exact);
+
+    if (*exact || enc == NULL)
+        return idx;
+
+    for (size_t i = 0; i < enc->table.count; i++)
+    {
+        const char *entry = hpack_table_get(&enc->table, i);
+
+        if (strcasecmp(entry, name))
+            continue;
+        if (!strcmp(entry + strlen(entry) + 1, value))
+        {
+            *exact = true;
+            return HPACK_STATIC_ENTRIES + 1 + i;
+        }
+        if (idx == 0)
+            idx = HPACK_STATIC_ENTRIES + 1 + i;
+    }
+    return idx;
+}
+
+static size_t hpack_encode_hdr(struct hpack_encoder *enc,
+                               uint8_t *restrict buf, size_t size,
+                               const char *name, const char *value)
+{
+    bool exact;
+    unsigned idx = hpack_find(enc, name, value, &exact);
+
+    if (exact)
+    {   /* Indexed header field */
+        if (size > 0)
+            *buf = 0x80;
+        return hpack_encode_int(buf, size, idx, 7);
+    }
+
+    uint8_t prefix;
+    unsigned n;
+    bool indexed = false;
+
+    if (hpack_is_sensitive(name))
+    {
+        if (idx == 0)
+            return hpack_encode_hdr_neverindex(buf, size, name, value);
+        prefix = 0x10, n = 4;
+    }
+    else if (enc != NULL && !hpack_is_volatile(name))
+        prefix = 0x40, n = 6, indexed = true;
+    else
+        prefix = 0x00, n = 4;
+
+    size_t ret, val;
+
+    if (size > 0)
+        *buf = prefix;
+
+    if (idx != 0)
+        ret = hpack_encode_int(buf, size, idx, n);
+    else
+    {   /* Literal name */
+        ret = 1;
+        val = hpack_encode_str_raw_lower((size > 1) ? buf + 1 : NULL,
+                                         (size > 1) ? size - 1 : 0, name);
+        ret += val;
+    }
+
+    if (size >= ret)
+        val = hpack_encode_str_raw(buf + ret, size - ret, value);
+    else
+        val = hpack_encode_str_raw(NULL, 0, value);
+    ret += val;
+
+    if (indexed)
+    {
+        char *lname = strdup(name);
+
+        if (lname != NULL)
+        {
+            for (char *p = lname; *p; p++)
+                if (*p >= 'A' && *p <= 'Z')
+                    *p += 'a' - 'A';
+            /* On failure, the decoder table would diverge: empty both */
+            if (hpack_table_append(&enc->table, lname, value))
+                hpack_table_resize(&enc->table, 0);
+            free(lname);
+        }
+        else
+            hpack_table_resize(&enc->table, 0);
+    }
+    return ret;
+}
+
+/**
+ * Encodes a header block.
+ *
+ * Without encoder state, the result does not depend on the buffer size, so
+ * that the function can be called once to compute the length.
+ * With an encoder state, the state is updated, and the function must be
+ * called exactly once for each block, in the order the blocks are sent.
+ * The length is then at most the stateless length plus
+ * \ref HPACK_ENCODE_MAX_UPDATE bytes.
+ */
+size_t hpack_encode(struct hpack_encoder *enc, uint8_t *restrict buf,
+                    size_t size, const char *const headers[][2],
+                    unsigned count)
 {
     size_t ret = 0;
 
+    if (enc != NULL && enc->update)
+    {   /* Dynamic table size update */
+        if (size > 0)
+            *buf = 0x20;
+
+        size_t val = hpack_encode_int(buf, size, enc->table.max_size, 5);
+        if (size >= val)
+        {
+            buf += val;
+            size -= val;
+        }
+        else
+            size = 0;
+
+        ret += val;
+        enc->update = false;
+    }
+
     while (count > 0)
     {
-        size_t val = hpack_encode_hdr_neverindex(buf, size, headers[0][0],
-                                                 headers[0][1]);
+        size_t val = hpack_encode_hdr(enc, buf, size, headers[0][0],
+                                      headers[0][1]);
         if (size >= val)
         {
             buf += val;
@@ -228,13 +425,13 @@ static void test_block(const char *name, ...)
 
     uint8_t buf[1024];
 
-    size_t length = hpack_encode(NULL, 0, headers, count);
+    size_t length = hpack_encode(NULL, NULL, 0, headers, count);
 
     for (size_t i = 0; i < sizeof (buf); i++)
-        assert(hpack_encode(buf, i, headers, count) == length);
+        assert(hpack_encode(NULL, buf, i, headers, count) == length);
 
     memset(buf, 0xAA, sizeof (buf));
-    assert(hpack_encode(buf, length, headers, count) == length);
+    assert(hpack_encode(NULL, buf, length, headers, count) == length);
 
     char *eheaders[16][2];
 
@@ -287,10 +484,59 @@ static void test_resps(void)
                NULL);
 }
 
+static void test_stateful(void)
+{
+    const char *const headers[][2] = {
+        { ":method", "GET" }, { ":scheme", "https" },
+        { ":authority", "www.example.com" }, { ":path", "/index.html" },
+        { "User-Agent", "VLC media player" }, { "Range", "bytes=0-" },
+        { "Cookie", "secret" },
+    };
+    const unsigned count = sizeof (headers) / sizeof (headers[0]);
+    struct hpack_encoder *enc = hpack_encode_init(4096);
+    struct hpack_decoder *dec = hpack_decode_init(4096);
+    size_t stateless = hpack_encode(NULL, NULL, 0, headers, count);
+    size_t prev = stateless;
+
+    assert(enc != NULL && dec != NULL);
+
+    for (unsigned i = 0; i < 4; i++)
+    {
+        uint8_t buf[1024];
+        char *eheaders[16][2];
+
+        if (i == 2)
+            hpack_encode_resize(enc, 0); /* must signal the update */
+
+        size_t length = hpack_encode(enc, buf, sizeof (buf), headers, count);
+        printf(" stateful block %u: %zu bytes (stateless %zu)\n", i, length,
+               stateless);
+        assert(length <= stateless + HPACK_ENCODE_MAX_UPDATE);
+        if (i == 1)
+            assert(length < prev); /* repeated headers are indexed */
+        prev = length;
+
+        int ecount = hpack_decode(dec, buf, length, eheaders, 16);
+        assert((unsigned)ecount == count);
+
+        for (unsigned j = 0; j < count; j++)
+        {
+            assert(!strcasecmp(eheaders[j][0], headers[j][0]));
+            assert(!strcmp(eheaders[j][1], headers[j][1]));
+            free(eheaders[j][1]);
+            free(eheaders[j][0]);
+        }
+    }
+
+    hpack_decode_destroy(dec);
+    hpack_encode_destroy(enc);
+}
+
 int main(void)
 {
     test_integers();
     test_reqs();
     test_resps();
+    test_stateful();
 }
 #endif /* TEST */
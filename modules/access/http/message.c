@@ -296,6 +296,15 @@ block_t *vlc_http_msg_read(struct vlc_http_msg *m)
     return vlc_http_stream_read(m->payload);
 }
 
+void vlc_http_msg_close_payload(struct vlc_http_msg *m)
+{
+    if (m->payload != NULL)
+    {
+        vlc_http_stream_close(m->payload, false);
+        m->payload = NULL;
+    }
+}
+
 int vlc_http_msg_write(struct vlc_http_msg *m, block_t *block, bool eos)
 {
     if (m->payload == NULL)
@@ -423,6 +432,7 @@ error:
 }
 
 struct vlc_h2_frame *vlc_http_msg_h2_frame(const struct vlc_http_msg *m,
+                                           struct hpack_encoder *enc,
                                            uint_fast32_t stream_id, bool eos)
 {
     for (unsigned j = 0; j < m->count; j++)
@@ -478,7 +488,7 @@ struct vlc_h2_frame *vlc_http_msg_h2_frame(const struct vlc_http_msg *m,
         i += m->count;
     }
 
-    f = vlc_h2_frame_headers(stream_id, VLC_H2_DEFAULT_MAX_FRAME, eos,
+    f = vlc_h2_frame_headers(enc, stream_id, VLC_H2_DEFAULT_MAX_FRAME, eos,
                              i, headers);
     free(headers);
     return f;
@@ -297,6 +297,14 @@ struct vlc_http_msg *vlc_http_msg_get_final(struct vlc_http_msg *) VLC_USED;
  */
 block_t *vlc_http_msg_read(struct vlc_http_msg *) VLC_USED;
 
+/**
+ * Discards HTTP data.
+ *
+ * Closes the stream carrying the payload of an HTTP message, if any, without
+ * reading the rest of the data. The message headers remain available.
+ */
+void vlc_http_msg_close_payload(struct vlc_http_msg *);
+
 /**
  * Sends HTTP data.
  *
@@ -454,11 +462,15 @@ char *vlc_http_msg_format(const struct vlc_http_msg *m, size_t *restrict lenp,
 struct vlc_http_msg *vlc_http_msg_headers(const char *msg) VLC_USED;
 
 struct vlc_h2_frame;
+struct hpack_encoder;
 
 /**
  * Formats an HTTP 2.0 HEADER frame.
+ *
+ * \param enc HPACK encoder of the connection (or NULL for no indexing)
  */
 struct vlc_h2_frame *vlc_http_msg_h2_frame(const struct vlc_http_msg *m,
+                                           struct hpack_encoder *enc,
                                            uint_fast32_t stream_id, bool eos);
 
 /**
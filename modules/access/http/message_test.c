@@ -131,7 +131,7 @@ static void check_msg(struct vlc_http_msg *in,
         vlc_http_msg_destroy(out);
     }
 
-    out = (struct vlc_http_msg *)vlc_http_msg_h2_frame(in, 1, true);
+    out = (struct vlc_http_msg *)vlc_http_msg_h2_frame(in, NULL, 1, true);
     assert(out != NULL);
     cb(out);
     assert(vlc_http_msg_read(out) == NULL);
@@ -345,11 +345,13 @@ int main(void)
 
 /* Callback for vlc_http_msg_h2_frame */
 struct vlc_h2_frame *
-vlc_h2_frame_headers(uint_fast32_t id, uint_fast32_t mtu, bool eos,
-                     unsigned count, const char *const tab[][2])
+vlc_h2_frame_headers(struct hpack_encoder *enc, uint_fast32_t id,
+                     uint_fast32_t mtu, bool eos, unsigned count,
+                     const char *const tab[][2])
 {
     struct vlc_http_msg *m;
 
+    assert(enc == NULL);
     assert(id == 1);
     assert(mtu == VLC_H2_DEFAULT_MAX_FRAME);
     assert(eos);
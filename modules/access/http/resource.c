@@ -161,6 +161,8 @@ static void vlc_http_res_deinit(struct vlc_http_resource *res)
 
 void vlc_http_res_destroy(struct vlc_http_resource *res)
 {
+    if (res->cbs->destroy != NULL)
+        res->cbs->destroy(res);
     vlc_http_res_deinit(res);
     free(res);
 }
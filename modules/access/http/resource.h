@@ -38,6 +38,7 @@ struct vlc_http_resource_cbs
                           struct vlc_http_msg *, void *);
     int (*response_validate)(const struct vlc_http_resource *,
                              const struct vlc_http_msg *, void *);
+    void (*destroy)(struct vlc_http_resource *); /**< Optional */
 };
 
 struct vlc_http_resource
@@ -63,6 +63,21 @@ vlc_module_begin()
     set_callbacks(Open, Close)
 vlc_module_end()
 
+/* Maximum number of outstanding READ requests, enough to cover the
+ * bandwidth-delay product of a 30 ms WAN link at 250 MB/s */
+#define NFS_READAHEAD_MAX 32
+
+struct vlc_nfs_read
+{
+    stream_t *              p_access;
+    uint64_t                i_offset;
+    size_t                  i_size; /* requested bytes */
+    size_t                  i_len; /* received bytes */
+    size_t                  i_pos; /* bytes already returned */
+    uint8_t *               p_buf;
+    bool                    b_done;
+};
+
 typedef struct
 {
     struct rpc_context *    p_mount; /* used to to get exports mount point */
@@ -78,21 +93,20 @@ typedef struct
     bool                    b_error;
     bool                    b_auto_guid;
 
+    /* Ring of pipelined READ requests, from the current position */
+    struct vlc_nfs_read     reads[NFS_READAHEAD_MAX];
+    unsigned                i_read_head;
+    unsigned                i_read_count;
+    unsigned                i_read_depth; /* current readahead window */
+    size_t                  i_read_size; /* size of each READ request */
+    uint64_t                i_read_offset; /* offset of the next request */
+
     union {
         struct
         {
             char **         ppsz_names;
             int             i_count;
         } exports;
-        struct
-        {
-            uint8_t *p_buf;
-            size_t i_len;
-        } read;
-        struct
-        {
-            bool b_done;
-        } seek;
     } res;
 } access_sys_t;
 
@@ -177,91 +191,172 @@ nfs_read_cb(int i_status, struct nfs_context *p_nfs, void *p_data,
             void *p_private_data)
 {
     VLC_UNUSED(p_nfs);
-    stream_t *p_access = p_private_data;
+    struct vlc_nfs_read *p_rd = p_private_data;
+    stream_t *p_access = p_rd->p_access;
     access_sys_t *p_sys = p_access->p_sys;
     assert(p_sys->p_nfs == p_nfs);
     if (NFS_CHECK_STATUS(p_access, i_status, p_data))
         return;
 
-    if (i_status == 0)
-        p_sys->b_eof = true;
-    else
-    {
-        p_sys->res.read.i_len = i_status;
-        memcpy(p_sys->res.read.p_buf, p_data, i_status);
-    }
+    assert((size_t) i_status <= p_rd->i_size);
+    memcpy(p_rd->p_buf, p_data, i_status);
+    p_rd->i_len = i_status;
+    p_rd->b_done = true;
 }
 
 static bool
-nfs_read_finished_cb(stream_t *p_access)
+nfs_read_head_finished_cb(stream_t *p_access)
 {
     access_sys_t *p_sys = p_access->p_sys;
-    return p_sys->res.read.i_len > 0 || p_sys->b_eof;
+    return p_sys->reads[p_sys->i_read_head].b_done;
 }
 
-static ssize_t
-FileRead(stream_t *p_access, void *p_buf, size_t i_len)
+/* Queues READ requests up to the readahead window */
+static void
+FileReadAhead(stream_t *p_access)
 {
     access_sys_t *p_sys = p_access->p_sys;
 
-    if (p_sys->b_eof)
-        return 0;
-
-    p_sys->res.read.i_len = 0;
-    p_sys->res.read.p_buf = p_buf;
-    if (nfs_read_async(p_sys->p_nfs, p_sys->p_nfsfh, i_len, nfs_read_cb,
-                       p_access) < 0)
+    while (p_sys->i_read_count < p_sys->i_read_depth)
     {
-        msg_Err(p_access, "nfs_read_async failed");
-        return 0;
-    }
+        /* Only the first request may go past the end of the file, in case
+         * the file grew since it was opened. */
+        if (p_sys->i_read_count > 0
+         && p_sys->i_read_offset >= p_sys->stat.nfs_size)
+            break;
 
-    if (vlc_nfs_mainloop(p_access, nfs_read_finished_cb) < 0)
-        return 0;
+        struct vlc_nfs_read *p_rd = &p_sys->reads[(p_sys->i_read_head
+                                    + p_sys->i_read_count) % NFS_READAHEAD_MAX];
 
-    return p_sys->res.read.i_len;
+        if (p_rd->p_buf == NULL)
+        {
+            p_rd->p_buf = malloc(p_sys->i_read_size);
+            if (unlikely(p_rd->p_buf == NULL))
+                break;
+        }
+
+        p_rd->p_access = p_access;
+        p_rd->i_offset = p_sys->i_read_offset;
+        p_rd->i_size = p_sys->i_read_size;
+        p_rd->i_len = p_rd->i_pos = 0;
+        p_rd->b_done = false;
+
+        if (nfs_pread_async(p_sys->p_nfs, p_sys->p_nfsfh, p_rd->i_offset,
+                            p_rd->i_size, nfs_read_cb, p_rd) < 0)
+        {
+            msg_Err(p_access, "nfs_pread_async failed");
+            if (p_sys->i_read_count == 0)
+                p_sys->b_error = true;
+            break;
+        }
+
+        p_sys->i_read_offset += p_rd->i_size;
+        p_sys->i_read_count++;
+    }
 }
 
-static void
-nfs_seek_cb(int i_status, struct nfs_context *p_nfs, void *p_data,
-            void *p_private_data)
+/* Waits for the oldest READ request and drops it */
+static int
+FileReadPop(stream_t *p_access)
 {
-    VLC_UNUSED(p_nfs);
-    stream_t *p_access = p_private_data;
     access_sys_t *p_sys = p_access->p_sys;
-    assert(p_sys->p_nfs == p_nfs);
-    (void) p_data;
-    if (NFS_CHECK_STATUS(p_access, i_status, p_data))
-        return;
 
-    p_sys->res.seek.b_done = true;
+    assert(p_sys->i_read_count > 0);
+    if (vlc_nfs_mainloop(p_access, nfs_read_head_finished_cb) < 0)
+        return -1;
+
+    p_sys->i_read_head = (p_sys->i_read_head + 1) % NFS_READAHEAD_MAX;
+    p_sys->i_read_count--;
+    return 0;
 }
 
-static bool
-nfs_seek_finished_cb(stream_t *p_access)
+static int
+FileReadFlush(stream_t *p_access)
 {
     access_sys_t *p_sys = p_access->p_sys;
-    return p_sys->res.seek.b_done;
+
+    while (p_sys->i_read_count > 0)
+        if (FileReadPop(p_access) < 0)
+            return -1;
+    return 0;
 }
 
-static int
-FileSeek(stream_t *p_access, uint64_t i_pos)
+static ssize_t
+FileRead(stream_t *p_access, void *p_buf, size_t i_len)
 {
     access_sys_t *p_sys = p_access->p_sys;
 
-    p_sys->res.seek.b_done = false;
-    if (nfs_lseek_async(p_sys->p_nfs, p_sys->p_nfsfh, i_pos, SEEK_SET,
-                        nfs_seek_cb, p_access) < 0)
+    for (;;)
     {
-        msg_Err(p_access, "nfs_seek_async failed");
-        return VLC_EGENERIC;
+        if (p_sys->b_eof || p_sys->b_error)
+            return 0;
+
+        FileReadAhead(p_access);
+        if (p_sys->i_read_count == 0)
+            return 0;
+
+        struct vlc_nfs_read *p_rd = &p_sys->reads[p_sys->i_read_head];
+
+        if (!p_rd->b_done)
+        {
+            /* The requests in flight do not cover the round trip time:
+             * widen the window. */
+            if (p_sys->i_read_depth < NFS_READAHEAD_MAX)
+                p_sys->i_read_depth++;
+            if (vlc_nfs_mainloop(p_access, nfs_read_head_finished_cb) < 0)
+                return 0;
+        }
+
+        if (p_rd->i_pos < p_rd->i_len)
+        {
+            if (i_len > p_rd->i_len - p_rd->i_pos)
+                i_len = p_rd->i_len - p_rd->i_pos;
+            memcpy(p_buf, p_rd->p_buf + p_rd->i_pos, i_len);
+            p_rd->i_pos += i_len;
+            if (p_rd->i_pos == p_rd->i_size)
+                FileReadPop(p_access);
+            return i_len;
+        }
+
+        /* End of file, or short read: the following requests do not start
+         * where the data ended. */
+        uint64_t i_next = p_rd->i_offset + p_rd->i_pos;
+        bool b_eof = p_rd->i_len == 0 && p_rd->i_pos == 0;
+
+        if (FileReadFlush(p_access) < 0)
+            return 0;
+        p_sys->i_read_offset = i_next;
+        p_sys->b_eof = b_eof;
     }
+}
+
+static int
+FileSeek(stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *p_sys = p_access->p_sys;
 
-    if (vlc_nfs_mainloop(p_access, nfs_seek_finished_cb) < 0)
+    if (p_sys->b_error)
         return VLC_EGENERIC;
 
     p_sys->b_eof = false;
 
+    /* Keep the requests from the new position, if any */
+    while (p_sys->i_read_count > 0)
+    {
+        struct vlc_nfs_read *p_rd = &p_sys->reads[p_sys->i_read_head];
+
+        if (i_pos >= p_rd->i_offset && i_pos - p_rd->i_offset < p_rd->i_size)
+        {
+            p_rd->i_pos = i_pos - p_rd->i_offset;
+            return VLC_SUCCESS;
+        }
+
+        if ((i_pos < p_rd->i_offset ? FileReadFlush(p_access)
+                                    : FileReadPop(p_access)) < 0)
+            return VLC_EGENERIC;
+    }
+
+    p_sys->i_read_offset = i_pos;
     return VLC_SUCCESS;
 }
 
@@ -699,6 +794,12 @@ Open(vlc_object_t *p_obj)
 
         if (p_sys->p_nfsfh != NULL)
         {
+            /* Limit the request size for latency: throughput comes from the
+             * pipelined requests. */
+            p_sys->i_read_size = nfs_get_readmax(p_sys->p_nfs);
+            if (p_sys->i_read_size == 0 || p_sys->i_read_size > 262144)
+                p_sys->i_read_size = 262144;
+            p_sys->i_read_depth = 2;
             p_access->pf_read = FileRead;
             p_access->pf_seek = FileSeek;
             p_access->pf_control = FileControl;
@@ -780,4 +881,8 @@ Close(vlc_object_t *p_obj)
 
     free(p_sys->psz_url_decoded);
     free(p_sys->psz_url_decoded_slash);
+
+    /* after the context, which completes or cancels the pending reads */
+    for (unsigned i = 0; i < NFS_READAHEAD_MAX; i++)
+        free(p_sys->reads[i].p_buf);
 }
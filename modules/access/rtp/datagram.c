@@ -24,9 +24,14 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #ifdef HAVE_POLL_H
 #include <poll.h>
 #endif
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_network.h>
@@ -36,10 +41,24 @@
 #define MSG_TRUNC 0
 #endif
 
+#if defined(UDP_GRO) && defined(SCM_TIMESTAMPNS)
+# define HAVE_GRO 1
+/* Largest coalesced payload returned by the kernel */
+# define GRO_MRU 65536
+#endif
+
 struct vlc_dgram_sock
 {
     int fd;
     struct vlc_dtls s;
+#ifdef HAVE_GRO
+    /* Coalesced datagrams not returned yet, if GRO is enabled */
+    unsigned char *gro_buf;
+    const unsigned char *gro_offset;
+    size_t gro_length;
+    size_t gro_segment;
+    vlc_tick_t gro_date;
+#endif
 };
 
 static void vlc_datagram_Close(struct vlc_dtls *dgs)
@@ -61,18 +80,158 @@ static int vlc_datagram_GetPollFD(struct vlc_dtls *dgs, short *restrict ev)
     return container_of(dgs, struct vlc_dgram_sock, s)->fd;
 }
 
+#ifdef SCM_TIMESTAMPNS
+/**
+ * Converts a kernel reception timestamp (real-time clock) to the VLC clock.
+ */
+static vlc_tick_t vlc_datagram_GetDate(const struct timespec *ts)
+{
+    struct timespec now;
+
+    if (clock_gettime(CLOCK_REALTIME, &now))
+        return VLC_TICK_INVALID;
+
+    vlc_tick_t age = vlc_tick_from_timespec(&now)
+                     - vlc_tick_from_timespec(ts);
+    if (age < 0)
+        age = 0; /* clock stepped back */
+    return vlc_tick_now() - age;
+}
+
+#define CMSG_DATE_SPACE CMSG_SPACE(sizeof (struct timespec))
+#else
+#define CMSG_DATE_SPACE 1
+#endif
+
+/**
+ * Parses the ancillary data of a received datagram.
+ */
+static void vlc_datagram_ParseCmsg(struct msghdr *msg, vlc_tick_t *date,
+                                   size_t *segment)
+{
+    *date = VLC_TICK_INVALID;
+#ifdef SCM_TIMESTAMPNS
+    if (msg->msg_controllen == 0)
+        return;
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET
+         && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof (ts));
+            *date = vlc_datagram_GetDate(&ts);
+        }
+# ifdef HAVE_GRO
+        if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int size;
+
+            memcpy(&size, CMSG_DATA(cmsg), sizeof (size));
+            if (size > 0)
+                *segment = size;
+        }
+# endif
+    }
+#else
+    (void) msg;
+#endif
+    (void) segment;
+}
+
+#ifdef HAVE_GRO
+/**
+ * Returns the next datagram from the coalesced buffer, refilling it with
+ * a single system call when it is empty.
+ */
+static ssize_t vlc_datagram_RecvGRO(struct vlc_dgram_sock *s,
+                                    struct iovec *iov, unsigned iovlen,
+                                    bool *truncated, vlc_tick_t *date)
+{
+    if (s->gro_length == 0) {
+        union {
+            struct cmsghdr hdr;
+            char buf[CMSG_DATE_SPACE + CMSG_SPACE(sizeof (int))];
+        } cmsg;
+        struct iovec biov = { .iov_base = s->gro_buf, .iov_len = GRO_MRU };
+        struct msghdr msg = {
+            .msg_iov = &biov,
+            .msg_iovlen = 1,
+            .msg_control = &cmsg,
+            .msg_controllen = sizeof (cmsg),
+        };
+        ssize_t ret = recvmsg(s->fd, &msg, 0);
+
+        if (ret <= 0) {
+            if (ret == 0) {
+                *truncated = false;
+                *date = VLC_TICK_INVALID;
+            }
+            return ret; /* error or empty datagram */
+        }
+
+        s->gro_offset = s->gro_buf;
+        s->gro_length = ret;
+        s->gro_segment = ret; /* one datagram, unless coalesced */
+        vlc_datagram_ParseCmsg(&msg, &s->gro_date, &s->gro_segment);
+    }
+
+    /* All segments have the same size, except the last one */
+    size_t left = __MIN(s->gro_segment, s->gro_length);
+    ssize_t ret = 0;
+
+    s->gro_length -= left;
+    *truncated = false;
+    *date = s->gro_date;
+
+    for (unsigned i = 0; i < iovlen && left > 0; i++) {
+        size_t len = __MIN(iov[i].iov_len, left);
+
+        memcpy(iov[i].iov_base, s->gro_offset, len);
+        s->gro_offset += len;
+        left -= len;
+        ret += len;
+    }
+
+    if (left > 0) {
+        s->gro_offset += left;
+        *truncated = true;
+    }
+    return ret;
+}
+#endif
+
 static ssize_t vlc_datagram_Recv(struct vlc_dtls *dgs, struct iovec *iov,
-                                 unsigned iovlen, bool *truncated)
+                                 unsigned iovlen, bool *truncated,
+                                 vlc_tick_t *restrict date)
 {
+    struct vlc_dgram_sock *s = container_of(dgs, struct vlc_dgram_sock, s);
+#ifdef HAVE_GRO
+    if (s->gro_buf != NULL)
+        return vlc_datagram_RecvGRO(s, iov, iovlen, truncated, date);
+#endif
+#ifdef SCM_TIMESTAMPNS
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_DATE_SPACE];
+    } cmsg;
+#endif
     struct msghdr msg = {
         .msg_iov = iov,
         .msg_iovlen = iovlen,
+#ifdef SCM_TIMESTAMPNS
+        .msg_control = &cmsg,
+        .msg_controllen = sizeof (cmsg),
+#endif
     };
-    int fd = container_of(dgs, struct vlc_dgram_sock, s)->fd;
-    ssize_t ret = recvmsg(fd, &msg, 0);
+    ssize_t ret = recvmsg(s->fd, &msg, 0);
+
+    if (ret >= 0) {
+        size_t segment;
 
-    if (ret >= 0)
         *truncated = (msg.msg_flags & MSG_TRUNC) != 0;
+        vlc_datagram_ParseCmsg(&msg, date, &segment);
+    }
 
     return ret;
 }
@@ -96,6 +255,27 @@ static const struct vlc_dtls_operations vlc_datagram_ops = {
     vlc_datagram_Send,
 };
 
+/**
+ * Requests reception timestamps and, if possible, coalesced datagrams, so
+ * that a burst of packets is received with a single system call.
+ */
+static void vlc_datagram_Setup(struct vlc_dgram_sock *s)
+{
+#ifdef SCM_TIMESTAMPNS
+    setsockopt(s->fd, SOL_SOCKET, SO_TIMESTAMPNS, &(int){ 1 }, sizeof (int));
+#endif
+#ifdef HAVE_GRO
+    s->gro_buf = malloc(GRO_MRU);
+    s->gro_length = 0;
+
+    if (s->gro_buf != NULL
+     && setsockopt(s->fd, IPPROTO_UDP, UDP_GRO, &(int){ 1 }, sizeof (int))) {
+        free(s->gro_buf);
+        s->gro_buf = NULL;
+    }
+#endif
+}
+
 struct vlc_dtls *vlc_datagram_CreateFD(int fd)
 {
     struct vlc_dgram_sock *s = malloc(sizeof (*s));
@@ -103,15 +283,17 @@ struct vlc_dtls *vlc_datagram_CreateFD(int fd)
     if (likely(s != NULL)) {
         s->fd = fd;
         s->s.ops = &vlc_datagram_ops;
+        vlc_datagram_Setup(s);
     }
 
     return &s->s;
 }
 
 static ssize_t vlc_dccp_Recv(struct vlc_dtls *dgs, struct iovec *iov,
-                             unsigned iovlen, bool *truncated)
+                             unsigned iovlen, bool *truncated,
+                             vlc_tick_t *restrict date)
 {
-    ssize_t ret = vlc_datagram_Recv(dgs, iov, iovlen, truncated);
+    ssize_t ret = vlc_datagram_Recv(dgs, iov, iovlen, truncated, date);
 
     if (unlikely(ret == 0)) {
         int fd = container_of(dgs, struct vlc_dgram_sock, s)->fd;
@@ -154,6 +336,9 @@ struct vlc_dtls *vlc_dccp_CreateFD(int fd)
     if (likely(s != NULL)) {
         s->fd = fd;
         s->s.ops = &vlc_dccp_ops;
+#ifdef HAVE_GRO
+        s->gro_buf = NULL;
+#endif
     }
 
     return &s->s;
@@ -0,0 +1,244 @@
+/**
+ * @file fec.c
+ * @brief SMPTE 2022-1 forward error correction
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ ****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+
+#include "rtp.h"
+
+/* SMPTE 2022-1 limits the matrix to L x D <= 100 packets. The history must
+ * also cover the delay of the column FEC packets, up to another matrix. */
+#define FEC_HISTORY 256 /* media packets, power of two */
+#define FEC_MAX_SPAN 100
+#define FEC_PACKETS 64
+
+#define FEC_HEADER_SIZE 16
+
+/** State for the FEC of an RTP session */
+struct rtp_fec
+{
+    block_t *history[FEC_HISTORY]; /**< Copies of the media packets */
+    block_t *fec[FEC_PACKETS]; /**< Received FEC packets */
+    unsigned fec_next; /**< Oldest FEC packet, replaced next */
+    unsigned span; /**< Matrix size in packets */
+};
+
+rtp_fec_t *rtp_fec_create(void)
+{
+    return calloc(1, sizeof (struct rtp_fec));
+}
+
+void rtp_fec_destroy(rtp_fec_t *fec)
+{
+    for (unsigned i = 0; i < FEC_HISTORY; i++)
+        if (fec->history[i] != NULL)
+            block_Release(fec->history[i]);
+    for (unsigned i = 0; i < FEC_PACKETS; i++)
+        if (fec->fec[i] != NULL)
+            block_Release(fec->fec[i]);
+    free(fec);
+}
+
+static inline uint16_t fec_seq(const block_t *block)
+{
+    return GetWBE(block->p_buffer + 2);
+}
+
+static void rtp_fec_store(rtp_fec_t *fec, block_t *block)
+{
+    block_t **slot = &fec->history[fec_seq(block) % FEC_HISTORY];
+
+    if (*slot != NULL)
+        block_Release(*slot);
+    *slot = block;
+}
+
+/**
+ * Keeps a copy of a received media packet, including its RTP header and
+ * padding, for later recovery of the packets protected with it.
+ */
+void rtp_fec_record(rtp_fec_t *fec, const block_t *block)
+{
+    block_t *copy = block_Duplicate(block);
+
+    if (likely(copy != NULL))
+        rtp_fec_store(fec, copy);
+}
+
+static const block_t *rtp_fec_lookup(const rtp_fec_t *fec, uint16_t seq)
+{
+    const block_t *block = fec->history[seq % FEC_HISTORY];
+
+    return (block != NULL && fec_seq(block) == seq) ? block : NULL;
+}
+
+/**
+ * Queues a packet received on one of the FEC streams (column or row).
+ */
+void rtp_fec_queue(demux_t *demux, rtp_fec_t *fec, block_t *block)
+{
+    const uint8_t *p = block->p_buffer;
+
+    /* No CSRC nor extension are allowed in FEC packets */
+    if (block->i_buffer < 12 + FEC_HEADER_SIZE || (p[0] >> 6) != 2
+     || (p[0] & 0x1F) != 0)
+        goto drop;
+
+    p += 12;
+
+    const unsigned offset = p[13], na = p[14];
+
+    if (!(p[4] & 0x80) /* E bit */ || (p[12] & 0x80) /* X bit */
+     || ((p[12] >> 3) & 7) != 0 /* XOR */ || offset == 0 || na == 0
+     || offset * (na - 1) >= FEC_MAX_SPAN) {
+        msg_Dbg(demux, "unsupported FEC packet");
+        goto drop;
+    }
+
+    if (fec->span < offset * na) {
+        fec->span = offset * na;
+        msg_Dbg(demux, "FEC matrix spans %u packets", fec->span);
+    }
+
+    if (fec->fec[fec->fec_next] != NULL)
+        block_Release(fec->fec[fec->fec_next]);
+    fec->fec[fec->fec_next] = block;
+    fec->fec_next = (fec->fec_next + 1) % FEC_PACKETS;
+    return;
+drop:
+    block_Release(block);
+}
+
+/**
+ * Number of media packets protected by a column of FEC, i.e. how many
+ * packets to wait for before giving up on a lost one.
+ */
+unsigned rtp_fec_span(const rtp_fec_t *fec)
+{
+    return fec->span;
+}
+
+/**
+ * Rebuilds a packet from an FEC packet and the other packets it protects.
+ */
+static block_t *rtp_fec_rebuild(rtp_fec_t *fec, const block_t *fb,
+                                uint16_t missing)
+{
+    const uint8_t *fh = fb->p_buffer + 12;
+    const uint16_t base = GetWBE(fh);
+    const unsigned offset = fh[13], na = fh[14];
+    const size_t maxlen = fb->i_buffer - 12 - FEC_HEADER_SIZE;
+
+    uint16_t delta = missing - base;
+    if (delta % offset != 0 || delta / offset >= na)
+        return NULL; /* not protected by this FEC packet */
+
+    /* All the other protected packets are needed */
+    for (unsigned k = 0; k < na; k++) {
+        uint16_t seq = base + k * offset;
+
+        if (seq != missing && rtp_fec_lookup(fec, seq) == NULL)
+            return NULL;
+    }
+
+    uint8_t flags = fb->p_buffer[0], pt = fh[4], mbit = fb->p_buffer[1];
+    uint16_t len = GetWBE(fh + 2);
+    uint32_t ts = GetDWBE(fh + 8);
+    const block_t *ref = NULL;
+
+    for (unsigned k = 0; k < na; k++) {
+        uint16_t seq = base + k * offset;
+        const block_t *media = rtp_fec_lookup(fec, seq);
+
+        if (seq == missing)
+            continue;
+        if (media->i_buffer < 12 || media->i_buffer - 12 > maxlen)
+            return NULL;
+
+        flags ^= media->p_buffer[0];
+        mbit ^= media->p_buffer[1];
+        pt ^= media->p_buffer[1];
+        len ^= media->i_buffer - 12;
+        ts ^= GetDWBE(media->p_buffer + 4);
+        ref = media;
+    }
+
+    if (ref == NULL || len > maxlen)
+        return NULL;
+
+    block_t *block = block_Alloc(12 + maxlen);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    uint8_t *p = block->p_buffer;
+
+    memcpy(p + 12, fh + FEC_HEADER_SIZE, maxlen);
+    for (unsigned k = 0; k < na; k++) {
+        uint16_t seq = base + k * offset;
+        const block_t *media = rtp_fec_lookup(fec, seq);
+
+        if (seq == missing)
+            continue;
+        for (size_t i = 12; i < media->i_buffer; i++)
+            p[i] ^= media->p_buffer[i];
+    }
+
+    /* Version 2; padding, extension and CSRC count recovered */
+    p[0] = 0x80 | (flags & 0x3F);
+    p[1] = (mbit & 0x80) | (pt & 0x7F);
+    SetWBE(p + 2, missing);
+    SetDWBE(p + 4, ts);
+    memcpy(p + 8, ref->p_buffer + 8, 4); /* SSRC */
+    block->i_buffer = 12 + len;
+    return block;
+}
+
+/**
+ * Tries to recover a lost media packet.
+ *
+ * @return the rebuilt RTP packet, or NULL if it cannot be recovered (yet)
+ */
+block_t *rtp_fec_recover(rtp_fec_t *fec, uint16_t missing)
+{
+    for (unsigned i = 0; i < FEC_PACKETS; i++) {
+        if (fec->fec[i] == NULL)
+            continue;
+
+        block_t *block = rtp_fec_rebuild(fec, fec->fec[i], missing);
+        if (block != NULL) {
+            /* It can help recovering another packet */
+            block_t *copy = block_Duplicate(block);
+            if (likely(copy != NULL))
+                rtp_fec_store(fec, copy);
+            return block;
+        }
+    }
+    return NULL;
+}
@@ -47,6 +47,8 @@
 #endif
 
 #define DEFAULT_MRU (1500u - (20 + 8))
+/* Packets received in a row before checking the jitter buffer */
+#define RTP_MAX_BATCH 64
 
 /**
  * Processes a packet received from the RTP socket.
@@ -80,6 +82,16 @@ drop:
     block_Release (block);
 }
 
+/**
+ * Processes a packet received from one of the FEC sockets.
+ */
+static void rtp_fec_process (demux_t *demux, block_t *block)
+{
+    demux_sys_t *sys = demux->p_sys;
+
+    rtp_fec_queue (demux, sys->fec, block);
+}
+
 static int rtp_timeout (vlc_tick_t deadline)
 {
     if (deadline == VLC_TICK_INVALID)
@@ -95,6 +107,46 @@ static int rtp_timeout (vlc_tick_t deadline)
     return t;
 }
 
+/**
+ * Receives and processes one packet from a socket.
+ *
+ * \return 0 on success, EAGAIN if no packets are pending, or an error number
+ */
+static int rtp_dgram_recv (demux_t *demux, struct vlc_dtls *sock,
+                           void (*process) (demux_t *, block_t *))
+{
+    block_t *block = block_Alloc(DEFAULT_MRU);
+    if (unlikely(block == NULL))
+        return ENOMEM;
+
+    bool truncated;
+    vlc_tick_t date;
+    ssize_t len = vlc_dtls_Recv(sock, block->p_buffer, block->i_buffer,
+                                &truncated, &date);
+    if (len < 0)
+    {
+        int err = errno;
+
+        block_Release (block);
+        if (err == EAGAIN)
+            return EAGAIN;
+        if (err != EPIPE)
+            msg_Warn (demux, "RTP network error: %s", vlc_strerror_c(err));
+        return err;
+    }
+
+    if (truncated) {
+        msg_Err(demux, "packet truncated (MRU was %zu)", block->i_buffer);
+        block->i_flags |= BLOCK_FLAG_CORRUPTED;
+    }
+    else
+        block->i_buffer = len;
+
+    block->i_pts = date; /* reception time, if known */
+    process (demux, block);
+    return 0;
+}
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -103,16 +155,25 @@ void *rtp_dgram_thread (void *opaque)
     demux_t *demux = opaque;
     demux_sys_t *sys = demux->p_sys;
     vlc_tick_t deadline = VLC_TICK_INVALID;
-    struct vlc_dtls *rtp_sock = sys->rtp_sock;
+    struct vlc_dtls *socks[1 + ARRAY_SIZE(sys->fec_sock)];
+    unsigned nfds = 0;
+
+    socks[nfds++] = sys->rtp_sock;
+    for (size_t i = 0; i < ARRAY_SIZE(sys->fec_sock); i++)
+        if (sys->fec_sock[i] != NULL)
+            socks[nfds++] = sys->fec_sock[i];
 
     for (;;)
     {
-        struct pollfd ufd[1];
+        struct pollfd ufd[ARRAY_SIZE(socks)];
 
-        ufd[0].events = POLLIN;
-        ufd[0].fd = vlc_dtls_GetPollFD(rtp_sock, &ufd[0].events);
+        for (unsigned i = 0; i < nfds; i++)
+        {
+            ufd[i].events = POLLIN;
+            ufd[i].fd = vlc_dtls_GetPollFD(socks[i], &ufd[i].events);
+        }
 
-        int n = poll (ufd, 1, rtp_timeout (deadline));
+        int n = poll (ufd, nfds, rtp_timeout (deadline));
         if (n == -1)
             continue;
 
@@ -120,35 +181,27 @@ void *rtp_dgram_thread (void *opaque)
         if (n == 0)
             goto dequeue;
 
-        if (ufd[0].revents)
-        {
-            block_t *block = block_Alloc(DEFAULT_MRU);
-            if (unlikely(block == NULL))
-                break; /* we are totallly screwed */
-
-            bool truncated;
-            ssize_t len = vlc_dtls_Recv(rtp_sock, block->p_buffer,
-                                       block->i_buffer, &truncated);
-            if (len >= 0) {
-                if (truncated) {
-                    msg_Err(demux, "packet truncated (MRU was %zu)",
-                            block->i_buffer);
-                    block->i_flags |= BLOCK_FLAG_CORRUPTED;
-                }
-                else
-                    block->i_buffer = len;
-
-                rtp_process (demux, block);
-            }
-            else
+        /* FEC packets first, as they may help with the media packets */
+        for (unsigned i = nfds - 1; i > 0; i--)
+            if (ufd[i].revents)
             {
-                if (errno == EPIPE)
-                    break; /* connection terminated */
-                msg_Warn (demux, "RTP network error: %s",
-                          vlc_strerror_c(errno));
-                block_Release (block);
+                int err = 0;
+
+                for (unsigned j = 0; j < RTP_MAX_BATCH && err == 0; j++)
+                    err = rtp_dgram_recv (demux, socks[i], rtp_fec_process);
+                n--;
             }
 
+        if (ufd[0].revents)
+        {
+            int err = 0;
+
+            /* Drain the socket before going back to poll() */
+            for (unsigned i = 0; i < RTP_MAX_BATCH && err == 0; i++)
+                err = rtp_dgram_recv (demux, socks[0], rtp_process);
+
+            if (err == EPIPE || err == ENOMEM)
+                break; /* connection terminated or totally screwed */
             n--;
         }
 
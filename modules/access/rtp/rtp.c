@@ -265,6 +265,49 @@ static int Control (demux_t *demux, int query, va_list args)
 /**
  * Releases resources
  */
+static void CloseFEC(demux_sys_t *sys)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(sys->fec_sock); i++)
+        if (sys->fec_sock[i] != NULL)
+            vlc_dtls_Close(sys->fec_sock[i]);
+}
+
+/**
+ * Opens the SMPTE 2022-1 FEC sockets: column FEC on the RTP port plus 2,
+ * row FEC on the RTP port plus 4.
+ */
+static int OpenFEC(vlc_object_t *obj, demux_sys_t *sys, const char *dhost,
+                   int dport, const char *shost, int tp)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(sys->fec_sock); i++) {
+        int fd = net_OpenDgram(obj, dhost, dport + 2 * (i + 1), shost, 0, tp);
+
+        if (fd == -1) {
+            if (i > 0)
+                break; /* row FEC is optional */
+            goto error;
+        }
+
+        sys->fec_sock[i] = vlc_datagram_CreateFD(fd);
+        if (unlikely(sys->fec_sock[i] == NULL)) {
+            net_Close(fd);
+            goto error;
+        }
+    }
+
+    sys->fec = rtp_fec_create();
+    if (unlikely(sys->fec == NULL))
+        goto error;
+
+    msg_Dbg(obj, "receiving FEC on ports %d and %d", dport + 2, dport + 4);
+    return VLC_SUCCESS;
+error:
+    msg_Warn(obj, "cannot receive FEC");
+    CloseFEC(sys);
+    sys->fec_sock[0] = sys->fec_sock[1] = NULL;
+    return VLC_EGENERIC;
+}
+
 static void Close (vlc_object_t *obj)
 {
     demux_t *demux = (demux_t *)obj;
@@ -277,6 +320,9 @@ static void Close (vlc_object_t *obj)
         srtp_destroy (p_sys->srtp);
 #endif
     rtp_session_destroy (demux, p_sys->session);
+    if (p_sys->fec != NULL)
+        rtp_fec_destroy(p_sys->fec);
+    CloseFEC(p_sys);
     if (p_sys->rtcp_sock != NULL)
         vlc_dtls_Close(p_sys->rtcp_sock);
     vlc_dtls_Close(p_sys->rtp_sock);
@@ -311,6 +357,8 @@ static int OpenSDP(vlc_object_t *obj)
 
     sys->rtp_sock = NULL;
     sys->rtcp_sock = NULL;
+    sys->fec_sock[0] = sys->fec_sock[1] = NULL;
+    sys->fec = NULL;
     sys->session = NULL;
 #ifdef HAVE_SRTP
     sys->srtp = NULL;
@@ -516,6 +564,9 @@ static int OpenURL(vlc_object_t *obj)
     int fd = -1, rtcp_fd = -1;
     bool co = false;
 
+    p_sys->fec_sock[0] = p_sys->fec_sock[1] = NULL;
+    p_sys->fec = NULL;
+
     switch (tp)
     {
         case IPPROTO_UDP:
@@ -525,6 +576,8 @@ static int OpenURL(vlc_object_t *obj)
                 break;
             if (rtcp_dport > 0) /* XXX: source port is unknown */
                 rtcp_fd = net_OpenDgram (obj, dhost, rtcp_dport, shost, 0, tp);
+            if (var_InheritBool (obj, "rtp-fec"))
+                OpenFEC (obj, p_sys, dhost, dport, shost, tp);
             break;
 
          case IPPROTO_DCCP:
@@ -553,7 +606,7 @@ static int OpenURL(vlc_object_t *obj)
     if (p_sys->rtp_sock == NULL) {
         if (rtcp_fd != -1)
             net_Close(rtcp_fd);
-        return VLC_EGENERIC;
+        goto error_fec;
     }
     net_SetCSCov (fd, -1, 12);
 
@@ -589,9 +642,17 @@ static int OpenURL(vlc_object_t *obj)
     char *key = var_CreateGetNonEmptyString (demux, "srtp-key");
     if (key)
     {
+        char *cipher = var_InheritString (demux, "srtp-cipher");
+        bool gcm = cipher != NULL && !strcmp (cipher, "AEAD_AES_128_GCM");
+        free (cipher);
+
         vlc_gcrypt_init ();
-        p_sys->srtp = srtp_create (SRTP_ENCR_AES_CM, SRTP_AUTH_HMAC_SHA1, 10,
-                                   SRTP_PRF_AES_CM, SRTP_RCC_MODE1);
+        if (gcm)
+            p_sys->srtp = srtp_create (SRTP_ENCR_AES_GCM, SRTP_AUTH_NULL, 16,
+                                       SRTP_PRF_AES_CM, 0);
+        else
+            p_sys->srtp = srtp_create (SRTP_ENCR_AES_CM, SRTP_AUTH_HMAC_SHA1,
+                                       10, SRTP_PRF_AES_CM, SRTP_RCC_MODE1);
         if (p_sys->srtp == NULL)
         {
             free (key);
@@ -626,6 +687,10 @@ error:
     if (p_sys->rtcp_sock != NULL)
         vlc_dtls_Close(p_sys->rtcp_sock);
     vlc_dtls_Close(p_sys->rtp_sock);
+error_fec:
+    if (p_sys->fec != NULL)
+        rtp_fec_destroy(p_sys->fec);
+    CloseFEC(p_sys);
     return VLC_EGENERIC;
 }
 
@@ -643,7 +708,24 @@ error:
 #define SRTP_SALT_TEXT N_("SRTP salt (hexadecimal)")
 #define SRTP_SALT_LONGTEXT N_( \
     "Secure RTP requires a (non-secret) master salt value. " \
-    "This must be a 28-character-long hexadecimal string.")
+    "This must be a 28-character-long hexadecimal string " \
+    "(24 characters with AES-GCM).")
+
+#define SRTP_CIPHER_TEXT N_("SRTP crypto-suite")
+#define SRTP_CIPHER_LONGTEXT N_( \
+    "Secure RTP crypto-suite. AES-GCM decrypts and authenticates " \
+    "in a single pass.")
+
+#ifdef HAVE_SRTP
+static const char *const srtp_ciphers[] = {
+    "AES_CM_128_HMAC_SHA1_80", "AEAD_AES_128_GCM",
+};
+#endif
+
+#define RTP_FEC_TEXT N_("Forward error correction")
+#define RTP_FEC_LONGTEXT N_( \
+    "Recover lost packets with SMPTE 2022-1 FEC, received on the RTP port " \
+    "plus 2 (columns) and plus 4 (rows).")
 
 #define RTP_MAX_SRC_TEXT N_("Maximum RTP sources")
 #define RTP_MAX_SRC_LONGTEXT N_( \
@@ -688,7 +770,13 @@ vlc_module_begin()
     add_string("srtp-salt", "",
                SRTP_SALT_TEXT, SRTP_SALT_LONGTEXT)
         change_safe()
+    add_string("srtp-cipher", srtp_ciphers[0],
+               SRTP_CIPHER_TEXT, SRTP_CIPHER_LONGTEXT)
+        change_string_list(srtp_ciphers, srtp_ciphers)
+        change_safe()
 #endif
+    add_bool("rtp-fec", false, RTP_FEC_TEXT, RTP_FEC_LONGTEXT)
+        change_safe()
     add_integer("rtp-max-src", 1, RTP_MAX_SRC_TEXT,
                 RTP_MAX_SRC_LONGTEXT)
         change_integer_range (1, 255)
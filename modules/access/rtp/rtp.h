@@ -370,6 +370,22 @@ int vlc_rtp_add_media_types(vlc_object_t *obj, rtp_session_t *ses,
 
 void *rtp_dgram_thread (void *data);
 
+/** @} */
+
+/**
+ * \defgroup rtp_fec RTP forward error correction
+ * SMPTE 2022-1 column and row FEC, received on separate sockets.
+ * @{
+ */
+typedef struct rtp_fec rtp_fec_t;
+
+rtp_fec_t *rtp_fec_create(void);
+void rtp_fec_destroy(rtp_fec_t *);
+void rtp_fec_record(rtp_fec_t *, const block_t *);
+void rtp_fec_queue(demux_t *, rtp_fec_t *, block_t *);
+unsigned rtp_fec_span(const rtp_fec_t *);
+block_t *rtp_fec_recover(rtp_fec_t *, uint16_t seq);
+
 /** @} */
 /** @} */
 
@@ -383,6 +399,8 @@ typedef struct
 #endif
     struct vlc_dtls *rtp_sock;
     struct vlc_dtls *rtcp_sock;
+    struct vlc_dtls *fec_sock[2]; /**< Column and row FEC, or NULL */
+    rtp_fec_t    *fec;
     vlc_thread_t  thread;
 
     vlc_tick_t    timeout;
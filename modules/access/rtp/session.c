@@ -25,6 +25,7 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -33,6 +34,9 @@
 
 #include "rtp.h"
 
+/* Longest wait for re-ordered packets */
+#define RTP_MAX_REORDER VLC_TICK_FROM_MS(500)
+
 typedef struct rtp_source_t rtp_source_t;
 
 /** State for a RTP session: */
@@ -122,6 +126,17 @@ struct rtp_source_t
 
     uint16_t last_seq; /* sequence of the next dequeued packet */
     block_t *blocks; /* re-ordered blocks queue */
+    vlc_tick_t interval; /* average packet inter-arrival time */
+    vlc_tick_t reorder; /* decaying maximum of the re-ordering delay */
+
+    struct {
+        uint64_t received;
+        uint64_t lost;
+        uint64_t recovered;
+        uint64_t reordered;
+        uint64_t duplicates;
+        uint64_t late;
+    } stats;
     struct {
         struct vlc_rtp_pt *instance; /* Per-source current payload format */
         void *opaque; /* Per-source payload format private data */
@@ -148,6 +163,9 @@ rtp_source_create (demux_t *demux, const rtp_session_t *session,
     source->max_seq = source->bad_seq = init_seq;
     source->last_seq = init_seq - 1;
     source->blocks = NULL;
+    source->interval = 0;
+    source->reorder = 0;
+    memset(&source->stats, 0, sizeof (source->stats));
     source->pt.instance = NULL;
     msg_Dbg (demux, "added RTP source (%08x)", ssrc);
     return source;
@@ -160,6 +178,11 @@ rtp_source_create (demux_t *demux, const rtp_session_t *session,
 static void rtp_source_destroy(demux_t *demux, rtp_source_t *source)
 {
     msg_Dbg (demux, "removing RTP source (%08x)", source->ssrc);
+    msg_Dbg (demux, "%"PRIu64" packet(s) received, %"PRIu64" lost, "
+             "%"PRIu64" recovered, %"PRIu64" re-ordered, %"PRIu64" duplicate(s), "
+             "%"PRIu64" late", source->stats.received, source->stats.lost,
+             source->stats.recovered, source->stats.reordered,
+             source->stats.duplicates, source->stats.late);
     if (source->pt.instance != NULL)
         vlc_rtp_pt_end(source->pt.instance, source->pt.opaque);
     block_ChainRelease (source->blocks);
@@ -193,6 +216,47 @@ static struct vlc_rtp_pt *rtp_find_ptype(const rtp_session_t *session,
     return NULL;
 }
 
+/**
+ * Queues a block in sequence order,
+ * hence there is a single queue for all payload types.
+ * @return false if the block is a duplicate
+ */
+static bool rtp_source_insert (rtp_source_t *src, block_t *block)
+{
+    const uint16_t seq = rtp_seq (block);
+    block_t **pp = &src->blocks;
+
+    for (block_t *prev = *pp; prev != NULL; prev = *pp)
+    {
+        int16_t delta_seq = seq - rtp_seq (prev);
+        if (delta_seq < 0)
+            break;
+        if (delta_seq == 0)
+            return false;
+        pp = &prev->p_next;
+    }
+    block->p_next = *pp;
+    *pp = block;
+    return true;
+}
+
+/**
+ * Removes the padding of an RTP packet.
+ * @return false if the padding is invalid
+ */
+static bool rtp_strip_padding (block_t *block)
+{
+    if (block->p_buffer[0] & 0x20)
+    {
+        uint8_t padding = block->p_buffer[block->i_buffer - 1];
+        if ((padding == 0) || (block->i_buffer < (12u + padding)))
+            return false; /* illegal value */
+
+        block->i_buffer -= padding;
+    }
+    return true;
+}
+
 /**
  * Receives an RTP packet and queues it. Not a cancellation point.
  *
@@ -211,17 +275,17 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
     if ((block->p_buffer[0] >> 6 ) != 2) /* RTP version number */
         goto drop;
 
-    /* Remove padding if present */
-    if (block->p_buffer[0] & 0x20)
-    {
-        uint8_t padding = block->p_buffer[block->i_buffer - 1];
-        if ((padding == 0) || (block->i_buffer < (12u + padding)))
-            goto drop; /* illegal value */
+    /* FEC protects the packet as sent, including the padding */
+    if (p_sys->fec != NULL)
+        rtp_fec_record (p_sys->fec, block);
 
-        block->i_buffer -= padding;
-    }
+    /* Remove padding if present */
+    if (!rtp_strip_padding (block))
+        goto drop;
 
-    vlc_tick_t     now = vlc_tick_now ();
+    /* Reception time, from the kernel if the socket reported it */
+    vlc_tick_t     now = (block->i_pts != VLC_TICK_INVALID)
+                       ? block->i_pts : vlc_tick_now ();
     rtp_source_t  *src  = NULL;
     const uint16_t seq  = rtp_seq (block);
     const uint32_t ssrc = GetDWBE (block->p_buffer + 8);
@@ -283,7 +347,9 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
             if (d < 0) d = -d;
             src->jitter += ((d - src->jitter) + 8) >> 4;
         }
+        src->interval += ((now - src->last_rx) - src->interval) / 16;
     }
+    src->stats.received++;
     src->last_rx = now;
     block->i_pts = now; /* store reception time until dequeued */
     src->last_ts = rtp_timestamp (block);
@@ -319,23 +385,25 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
     if (delta_seq.s >= 0)
         src->max_seq = seq + 1;
 
-    /* Queues the block in sequence order,
-     * hence there is a single queue for all payload types. */
-    block_t **pp = &src->blocks;
-    for (block_t *prev = *pp; prev != NULL; prev = *pp)
+    if (!rtp_source_insert (src, block))
     {
-        delta_seq.u = seq - rtp_seq (prev);
-        if (delta_seq.s < 0)
-            break;
-        if (delta_seq.s == 0)
-        {
-            msg_Dbg (demux, "duplicate packet (sequence: %"PRIu16")", seq);
-            goto drop; /* duplicate */
-        }
-        pp = &prev->p_next;
+        msg_Dbg (demux, "duplicate packet (sequence: %"PRIu16")", seq);
+        src->stats.duplicates++;
+        goto drop; /* duplicate */
     }
-    block->p_next = *pp;
-    *pp = block;
+
+    if (block->p_next != NULL)
+    {   /* Overtaken by the next packet: adapt the re-ordering delay */
+        vlc_tick_t delay = now - block->p_next->i_pts;
+
+        src->stats.reordered++;
+        if (delay > RTP_MAX_REORDER)
+            delay = RTP_MAX_REORDER;
+        if (src->reorder < delay)
+            src->reorder = delay;
+    }
+    else
+        src->reorder -= src->reorder / 256;
 
     /*rtp_decode (demux, session, src);*/
     return;
@@ -347,6 +415,38 @@ drop:
 
 static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
 
+/**
+ * Rebuilds the next missing packet of a source with FEC, if possible.
+ *
+ * @param next first received packet after the missing one(s)
+ * @return true if the packet was recovered and queued
+ */
+static bool rtp_recover (demux_t *demux, rtp_source_t *src,
+                         const block_t *next)
+{
+    demux_sys_t *p_sys = demux->p_sys;
+    block_t *block = rtp_fec_recover (p_sys->fec, src->last_seq + 1);
+
+    if (block == NULL)
+        return false;
+
+    if (GetDWBE (block->p_buffer + 8) != src->ssrc
+     || !rtp_strip_padding (block))
+        goto drop;
+
+    block->i_pts = next->i_pts;
+    if (!rtp_source_insert (src, block))
+        goto drop;
+
+    msg_Dbg (demux, "recovered packet (sequence: %"PRIu16")",
+             rtp_seq (block));
+    src->stats.recovered++;
+    return true;
+drop:
+    block_Release (block);
+    return false;
+}
+
 /**
  * Dequeues RTP packets and pass them to decoder. Not cancellation-safe(?).
  * A packet is decoded if it is the next in sequence order, or if we have
@@ -362,6 +462,7 @@ static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
 bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
                   vlc_tick_t *restrict deadlinep)
 {
+    demux_sys_t *p_sys = demux->p_sys;
     vlc_tick_t now = vlc_tick_now ();
     bool pending = false;
 
@@ -396,6 +497,9 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
                 continue;
             }
 
+            if (p_sys->fec != NULL && rtp_recover (demux, src, block))
+                continue;
+
             /* Wait for 3 times the inter-arrival delay variance (about 99.7%
              * match for random gaussian jitter).
              */
@@ -410,6 +514,15 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
             if (deadline < VLC_TICK_FROM_MS(25))
                 deadline = VLC_TICK_FROM_MS(25);
 
+            /* Also wait as long as packets were recently re-ordered */
+            if (deadline < src->reorder)
+                deadline = src->reorder;
+
+            /* With FEC, the packets needed to rebuild the missing one can
+             * come as late as one whole matrix after it. */
+            if (p_sys->fec != NULL)
+                deadline += rtp_fec_span (p_sys->fec) * src->interval;
+
             /* Additionally, we implicitly wait for the packetization time
              * multiplied by the number of missing packets. block is the first
              * non-missing packet (lowest sequence number). We have no better
@@ -450,9 +563,11 @@ rtp_decode (demux_t *demux, const rtp_session_t *session, rtp_source_t *src)
         {   /* Trash too late packets (and PIM Assert duplicates) */
             msg_Dbg (demux, "ignoring late packet (sequence: %"PRIu16")",
                       rtp_seq (block));
+            src->stats.late++;
             goto drop;
         }
         msg_Warn (demux, "%"PRIu16" packet(s) lost", delta_seq);
+        src->stats.lost += delta_seq;
         block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
     }
     src->last_seq = rtp_seq (block);
@@ -66,6 +66,7 @@ struct srtp_session_t
     uint16_t rtp_seq;
     uint16_t rtp_rcc;
     uint8_t  tag_len;
+    bool     aead;
 };
 
 enum
@@ -105,9 +106,9 @@ void srtp_destroy (srtp_session_t *s)
 }
 
 
-static int proto_create (srtp_proto_t *p, int gcipher, int gmd)
+static int proto_create (srtp_proto_t *p, int gcipher, int gmode, int gmd)
 {
-    if (gcry_cipher_open (&p->cipher, gcipher, GCRY_CIPHER_MODE_CTR, 0) == 0)
+    if (gcry_cipher_open (&p->cipher, gcipher, gmode, 0) == 0)
     {
         if (gcry_md_open (&p->mac, gmd, GCRY_MD_FLAG_HMAC) == 0)
             return 0;
@@ -128,6 +129,9 @@ static int proto_create (srtp_proto_t *p, int gcipher, int gmd)
  * @param tag_len authentication tag byte length (NOT including RCC)
  * @param flags OR'ed optional flags.
  *
+ * AES-GCM (RFC 7714) encrypts and authenticates in a single pass. It requires
+ * SRTP_AUTH_NULL, a tag length of 8, 12 or 16 bytes, and no flags.
+ *
  * @return NULL in case of error
  */
 srtp_session_t *
@@ -136,7 +140,7 @@ srtp_create (int encr, int auth, unsigned tag_len, int prf, unsigned flags)
     if ((flags & ~SRTP_FLAGS_MASK))
         return NULL;
 
-    int cipher, md;
+    int cipher, mode = GCRY_CIPHER_MODE_CTR, md;
     switch (encr)
     {
         case SRTP_ENCR_NULL:
@@ -147,6 +151,14 @@ srtp_create (int encr, int auth, unsigned tag_len, int prf, unsigned flags)
             cipher = GCRY_CIPHER_AES;
             break;
 
+        case SRTP_ENCR_AES_GCM:
+            if (auth != SRTP_AUTH_NULL || flags != 0
+             || (tag_len != 8 && tag_len != 12 && tag_len != 16))
+                return NULL;
+            cipher = GCRY_CIPHER_AES;
+            mode = GCRY_CIPHER_MODE_GCM;
+            break;
+
         default:
             return NULL;
     }
@@ -165,7 +177,7 @@ srtp_create (int encr, int auth, unsigned tag_len, int prf, unsigned flags)
             return NULL;
     }
 
-    if (tag_len > gcry_md_get_algo_dlen (md))
+    if (mode != GCRY_CIPHER_MODE_GCM && tag_len > gcry_md_get_algo_dlen (md))
         return NULL;
 
     if (prf != SRTP_PRF_AES_CM)
@@ -178,6 +190,7 @@ srtp_create (int encr, int auth, unsigned tag_len, int prf, unsigned flags)
     memset (s, 0, sizeof (*s));
     s->flags = flags;
     s->tag_len = tag_len;
+    s->aead = mode == GCRY_CIPHER_MODE_GCM;
     s->rtp_rcc = 1; /* Default RCC rate */
     if (rcc_mode (s))
     {
@@ -185,9 +198,9 @@ srtp_create (int encr, int auth, unsigned tag_len, int prf, unsigned flags)
             goto error;
     }
 
-    if (proto_create (&s->rtp, cipher, md) == 0)
+    if (proto_create (&s->rtp, cipher, mode, md) == 0)
     {
-        if (proto_create (&s->rtcp, cipher, md) == 0)
+        if (proto_create (&s->rtcp, cipher, mode, md) == 0)
             return s;
         proto_destroy (&s->rtp);
     }
@@ -205,26 +218,12 @@ error:
 static int
 do_ctr_crypt (gcry_cipher_hd_t hd, const void *ctr, uint8_t *data, size_t len)
 {
-    const size_t ctrlen = 16;
-    div_t d = div (len, ctrlen);
-
-    if (gcry_cipher_setctr (hd, ctr, ctrlen)
-     || gcry_cipher_encrypt (hd, data, d.quot * ctrlen, NULL, 0))
+    /* libgcrypt handles the truncated last block in CTR mode, and uses
+     * AES-NI or ARMv8 crypto extensions when the CPU has them. */
+    if (gcry_cipher_setctr (hd, ctr, 16)
+     || gcry_cipher_encrypt (hd, data, len, NULL, 0))
         return -1;
 
-    if (d.rem)
-    {
-        /* Truncated last block */
-        uint8_t dummy[ctrlen];
-        data += d.quot * ctrlen;
-        memcpy (dummy, data, d.rem);
-        memset (dummy + d.rem, 0, ctrlen - d.rem);
-
-        if (gcry_cipher_encrypt (hd, dummy, ctrlen, data, ctrlen))
-            return -1;
-        memcpy (data, dummy, d.rem);
-    }
-
     return 0;
 }
 
@@ -268,8 +267,18 @@ srtp_setkey (srtp_session_t *s, const void *key, size_t keylen,
 {
     /* SRTP/SRTCP cipher/salt/MAC keys derivation */
     gcry_cipher_hd_t prf;
-    uint8_t r[6], keybuf[20];
+    uint8_t r[6], keybuf[20], saltbuf[14];
 
+    if (s->aead)
+    {
+        /* RFC 7714: 12-bytes master salt, padded for the AES-CM PRF */
+        if (saltlen != 12)
+            return EINVAL;
+        memcpy (saltbuf, salt, 12);
+        memset (saltbuf + 12, 0, 2);
+        salt = saltbuf;
+    }
+    else
     if (saltlen != 14)
         return EINVAL;
 
@@ -293,6 +302,23 @@ srtp_setkey (srtp_session_t *s, const void *key, size_t keylen,
     else
 #endif
         memset (r, 0, sizeof (r));
+
+    if (s->aead)
+    {
+        /* No authentication keys: GCM derives its own from the cipher key */
+        uint8_t ri[4];
+        memcpy (ri, &(uint32_t){ htonl (s->rtcp_index) }, 4);
+
+        bool err = do_derive (prf, salt, r, 6, SRTP_CRYPT, keybuf, 16)
+                || gcry_cipher_setkey (s->rtp.cipher, keybuf, 16)
+                || do_derive (prf, salt, r, 6, SRTP_SALT, s->rtp.salt, 12)
+                || do_derive (prf, salt, ri, 4, SRTCP_CRYPT, keybuf, 16)
+                || gcry_cipher_setkey (s->rtcp.cipher, keybuf, 16)
+                || do_derive (prf, salt, ri, 4, SRTCP_SALT, s->rtcp.salt, 12);
+        gcry_cipher_close (prf);
+        return err ? -1 : 0;
+    }
+
     if (do_derive (prf, salt, r, 6, SRTP_CRYPT, keybuf, 16)
      || gcry_cipher_setkey (s->rtp.cipher, keybuf, 16)
      || do_derive (prf, salt, r, 6, SRTP_AUTH, keybuf, 20)
@@ -447,27 +473,20 @@ rtp_digest (gcry_md_hd_t md, const uint8_t *data, size_t len,
 
 
 /**
- * Encrypts/decrypts a RTP packet and updates SRTP context
- * (CTR block cypher mode of operation has identical encryption and
- * decryption function).
- *
- * @param buf RTP packet to be en-/decrypted
- * @param len RTP packet length
+ * Computes the offset of the RTP payload, i.e. the length of the RTP header
+ * including the CSRC list and the header extension.
  *
- * @return 0 on success, in case of error:
- *  EINVAL  malformatted RTP packet
- *  EACCES  replayed packet or out-of-window or sync lost
+ * @return the offset, or 0 if the RTP packet is malformatted
  */
-static int srtp_crypt (srtp_session_t *s, uint8_t *buf, size_t len)
+static size_t rtp_header_len (const uint8_t *buf, size_t len)
 {
-    assert (s != NULL);
     assert (len >= 12u);
 
     if ((buf[0] >> 6) != 2)
-        return EINVAL;
+        return 0;
 
     /* Computes encryption offset */
-    uint16_t offset = 12;
+    size_t offset = 12;
     offset += (buf[0] & 0xf) * 4; // skips CSRC
 
     if (buf[0] & 0x10)
@@ -476,37 +495,77 @@ static int srtp_crypt (srtp_session_t *s, uint8_t *buf, size_t len)
 
         offset += 4;
         if (len < offset)
-            return EINVAL;
+            return 0;
 
         memcpy (&extlen, buf + offset - 2, 2);
         offset += htons (extlen); // skips RTP extension header
     }
 
     if (len < offset)
-        return EINVAL;
+        return 0;
+    return offset;
+}
 
-    /* Determines RTP 48-bits counter and SSRC */
-    uint16_t seq = rtp_seq (buf);
-    uint32_t roc = srtp_compute_roc (s, seq), ssrc;
-    memcpy (&ssrc, buf + 8, 4);
 
-    /* Updates ROC and sequence (it's safe now) */
+/** Checks that a RTP sequence is neither replayed nor out of window */
+static int srtp_check_seq (const srtp_session_t *s, uint16_t seq)
+{
+    int16_t diff = seq - s->rtp_seq;
+    if (diff > 0)
+        return 0; /* Sequence in the future, good */
+
+    /* Sequence in the past/present, bad */
+    int back = -diff;
+    if ((back >= 64) || ((s->rtp.window >> back) & 1))
+        return EACCES; /* Replay attack */
+    return 0;
+}
+
+
+/** Records a RTP sequence and updates ROC (the sequence must be checked) */
+static void srtp_update_seq (srtp_session_t *s, uint16_t seq, uint32_t roc)
+{
     int16_t diff = seq - s->rtp_seq;
     if (diff > 0)
     {
-        /* Sequence in the future, good */
-        s->rtp.window = s->rtp.window << diff;
+        s->rtp.window = (diff < 64) ? (s->rtp.window << diff) : 0;
         s->rtp.window |= UINT64_C(1);
         s->rtp_seq = seq, s->rtp_roc = roc;
     }
     else
-    {
-        /* Sequence in the past/present, bad */
-        diff = -diff;
-        if ((diff >= 64) || ((s->rtp.window >> diff) & 1))
-            return EACCES; /* Replay attack */
-        s->rtp.window |= UINT64_C(1) << diff;
-    }
+        s->rtp.window |= UINT64_C(1) << -diff;
+}
+
+
+/**
+ * Encrypts/decrypts a RTP packet and updates SRTP context
+ * (CTR block cypher mode of operation has identical encryption and
+ * decryption function).
+ *
+ * @param buf RTP packet to be en-/decrypted
+ * @param len RTP packet length
+ *
+ * @return 0 on success, in case of error:
+ *  EINVAL  malformatted RTP packet
+ *  EACCES  replayed packet or out-of-window or sync lost
+ */
+static int srtp_crypt (srtp_session_t *s, uint8_t *buf, size_t len)
+{
+    assert (s != NULL);
+
+    size_t offset = rtp_header_len (buf, len);
+    if (offset == 0)
+        return EINVAL;
+
+    /* Determines RTP 48-bits counter and SSRC */
+    uint16_t seq = rtp_seq (buf);
+    uint32_t roc = srtp_compute_roc (s, seq), ssrc;
+    memcpy (&ssrc, buf + 8, 4);
+
+    /* Updates ROC and sequence (it's safe now) */
+    if (srtp_check_seq (s, seq))
+        return EACCES;
+    srtp_update_seq (s, seq, roc);
 
     /* Encrypt/Decrypt */
     if (s->flags & SRTP_UNENCRYPTED)
@@ -520,6 +579,101 @@ static int srtp_crypt (srtp_session_t *s, uint8_t *buf, size_t len)
 }
 
 
+/**
+ * Sets up AES-GCM for one packet: IV = salt XOR (0 | SSRC | hi | lo),
+ * then authenticates the additional data (RFC 7714 sections 8.1 and 9.1).
+ */
+static int
+gcm_start (gcry_cipher_hd_t hd, const uint32_t *salt, const uint8_t *ssrc,
+           uint32_t hi, uint16_t lo, const void *aad, size_t aadlen)
+{
+    uint8_t iv[12];
+
+    memcpy (iv, salt, 12);
+    for (unsigned i = 0; i < 4; i++)
+        iv[2 + i] ^= ssrc[i];
+    iv[6] ^= hi >> 24;
+    iv[7] ^= hi >> 16;
+    iv[8] ^= hi >> 8;
+    iv[9] ^= hi;
+    iv[10] ^= lo >> 8;
+    iv[11] ^= lo;
+
+    if (gcry_cipher_reset (hd)
+     || gcry_cipher_setiv (hd, iv, sizeof (iv))
+     || gcry_cipher_authenticate (hd, aad, aadlen))
+        return -1;
+    return 0;
+}
+
+
+/** AES-GCM (RFC 7714) counterpart of srtp_send() */
+static int
+srtp_send_gcm (srtp_session_t *s, uint8_t *buf, size_t *lenp, size_t bufsize)
+{
+    size_t len = *lenp;
+    uint8_t tag[16];
+
+    *lenp = len + s->tag_len;
+    if (bufsize < *lenp)
+        return ENOSPC;
+
+    size_t offset = rtp_header_len (buf, len);
+    if (offset == 0)
+        return EINVAL;
+
+    uint16_t seq = rtp_seq (buf);
+    uint32_t roc = srtp_compute_roc (s, seq);
+
+    if (srtp_check_seq (s, seq))
+        return EACCES;
+    srtp_update_seq (s, seq, roc);
+
+    /* Encryption and authentication in one pass */
+    if (gcm_start (s->rtp.cipher, s->rtp.salt, buf + 8, roc, seq, buf, offset)
+     || gcry_cipher_encrypt (s->rtp.cipher, buf + offset, len - offset,
+                             NULL, 0)
+     || gcry_cipher_gettag (s->rtp.cipher, tag, sizeof (tag)))
+        return EINVAL;
+
+    memcpy (buf + len, tag, s->tag_len);
+    return 0;
+}
+
+
+/** AES-GCM (RFC 7714) counterpart of srtp_recv() */
+static int srtp_recv_gcm (srtp_session_t *s, uint8_t *buf, size_t *lenp)
+{
+    size_t len = *lenp;
+
+    if (len < 12u + s->tag_len)
+        return EINVAL;
+    len -= s->tag_len;
+
+    size_t offset = rtp_header_len (buf, len);
+    if (offset == 0)
+        return EINVAL;
+
+    uint16_t seq = rtp_seq (buf);
+    uint32_t roc = srtp_compute_roc (s, seq);
+
+    if (srtp_check_seq (s, seq))
+        return EACCES;
+
+    if (gcm_start (s->rtp.cipher, s->rtp.salt, buf + 8, roc, seq, buf, offset)
+     || gcry_cipher_decrypt (s->rtp.cipher, buf + offset, len - offset,
+                             NULL, 0))
+        return EINVAL;
+    if (gcry_cipher_checktag (s->rtp.cipher, buf + len, s->tag_len))
+        return EACCES;
+
+    /* Only authenticated packets update the replay window */
+    srtp_update_seq (s, seq, roc);
+    *lenp = len;
+    return 0;
+}
+
+
 /**
  * Turns a RTP packet into a SRTP packet: encrypt it, then computes
  * the authentication tag and appends it.
@@ -547,6 +701,9 @@ srtp_send (srtp_session_t *s, uint8_t *buf, size_t *lenp, size_t bufsize)
     if (len < 12u)
         return EINVAL;
 
+    if (s->aead)
+        return srtp_send_gcm (s, buf, lenp, bufsize);
+
     if (!(s->flags & SRTP_UNAUTHENTICATED))
     {
         tag_len = s->tag_len;
@@ -626,6 +783,9 @@ srtp_recv (srtp_session_t *s, uint8_t *buf, size_t *lenp)
     if (len < 12u)
         return EINVAL;
 
+    if (s->aead)
+        return srtp_recv_gcm (s, buf, lenp);
+
     if (!(s->flags & SRTP_UNAUTHENTICATED))
     {
         size_t tag_len = s->tag_len, roc_len = 0;
@@ -764,6 +924,41 @@ static int srtcp_crypt (srtp_session_t *s, uint8_t *buf, size_t len)
 }
 
 
+/**
+ * AES-GCM (RFC 7714) counterpart of srtcp_send(): the tag follows the
+ * ciphertext, and the SRTCP index comes last.
+ */
+static int
+srtcp_send_gcm (srtp_session_t *s, uint8_t *buf, size_t *lenp, size_t bufsize)
+{
+    size_t len = *lenp;
+    uint8_t tag[16], aad[12];
+
+    if ((len < 8) || ((buf[0] >> 6) != 2))
+        return EINVAL;
+    if (bufsize < (len + s->tag_len + 4))
+        return ENOSPC;
+
+    uint32_t index = ++s->rtcp_index;
+    if (index >> 31)
+        s->rtcp_index = index = 0; /* 31-bit wrap */
+
+    memcpy (aad, buf, 8);
+    memcpy (aad + 8, &(uint32_t){ htonl (index | 0x80000000) }, 4);
+
+    if (gcm_start (s->rtcp.cipher, s->rtcp.salt, buf + 4, index >> 16,
+                   index & 0xffff, aad, sizeof (aad))
+     || gcry_cipher_encrypt (s->rtcp.cipher, buf + 8, len - 8, NULL, 0)
+     || gcry_cipher_gettag (s->rtcp.cipher, tag, sizeof (tag)))
+        return EINVAL;
+
+    memcpy (buf + len, tag, s->tag_len);
+    memcpy (buf + len + s->tag_len, aad + 8, 4);
+    *lenp = len + s->tag_len + 4;
+    return 0;
+}
+
+
 /**
  * Turns a RTCP packet into a SRTCP packet: encrypt it, then computes
  * the authentication tag and appends it.
@@ -781,6 +976,10 @@ int
 srtcp_send (srtp_session_t *s, uint8_t *buf, size_t *lenp, size_t bufsize)
 {
     size_t len = *lenp;
+
+    if (s->aead)
+        return srtcp_send_gcm (s, buf, lenp, bufsize);
+
     if (bufsize < (len + 4 + s->tag_len))
         return ENOSPC;
 
@@ -805,6 +1004,53 @@ srtcp_send (srtp_session_t *s, uint8_t *buf, size_t *lenp, size_t bufsize)
 }
 
 
+/** AES-GCM (RFC 7714) counterpart of srtcp_recv() */
+static int srtcp_recv_gcm (srtp_session_t *s, uint8_t *buf, size_t *lenp)
+{
+    size_t len = *lenp;
+    uint8_t aad[12];
+
+    if ((len < (8u + s->tag_len + 4)) || ((buf[0] >> 6) != 2))
+        return EINVAL;
+    len -= s->tag_len + 4;
+
+    uint32_t index;
+    memcpy (&index, buf + len + s->tag_len, 4);
+    index = ntohl (index);
+    if ((index >> 31) == 0)
+        return EINVAL; // E-bit mismatch
+    index &= ~(1u << 31);
+
+    /* Checks the SRTCP index against the replay window */
+    int32_t diff = index - s->rtcp_index;
+    if ((diff <= 0)
+     && ((-diff >= 64) || ((s->rtcp.window >> -diff) & 1)))
+        return EACCES;
+
+    memcpy (aad, buf, 8);
+    memcpy (aad + 8, buf + len + s->tag_len, 4);
+
+    if (gcm_start (s->rtcp.cipher, s->rtcp.salt, buf + 4, index >> 16,
+                   index & 0xffff, aad, sizeof (aad))
+     || gcry_cipher_decrypt (s->rtcp.cipher, buf + 8, len - 8, NULL, 0))
+        return EINVAL;
+    if (gcry_cipher_checktag (s->rtcp.cipher, buf + len, s->tag_len))
+        return EACCES;
+
+    if (diff > 0)
+    {
+        s->rtcp.window = (diff < 64) ? (s->rtcp.window << diff) : 0;
+        s->rtcp.window |= UINT64_C(1);
+        s->rtcp_index = index;
+    }
+    else
+        s->rtcp.window |= UINT64_C(1) << -diff;
+
+    *lenp = len;
+    return 0;
+}
+
+
 /**
  * Turns a SRTCP packet into a RTCP packet: authenticates the packet,
  * then decrypts it.
@@ -822,6 +1068,9 @@ srtcp_recv (srtp_session_t *s, uint8_t *buf, size_t *lenp)
 {
     size_t len = *lenp;
 
+    if (s->aead)
+        return srtcp_recv_gcm (s, buf, lenp);
+
     if (len < (4u + s->tag_len))
         return EINVAL;
     len -= s->tag_len;
@@ -835,3 +1084,55 @@ srtcp_recv (srtp_session_t *s, uint8_t *buf, size_t *lenp)
     return srtp_crypt (s, buf, len);
 }
 
+
+/**
+ * Turns many RTP packets into SRTP packets, as srtp_send() does.
+ * The packets need not be consecutive but are processed in order.
+ *
+ * @param pkts packets; on return, the error member of each is set to 0 or
+ *             to the srtp_send() error code, and len to the SRTP length
+ * @param count number of packets
+ *
+ * @return the number of successfully protected packets
+ */
+unsigned
+srtp_send_batch (srtp_session_t *s, srtp_packet_t *pkts, unsigned count)
+{
+    unsigned done = 0;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        srtp_packet_t *pkt = pkts + i;
+
+        pkt->error = srtp_send (s, pkt->buf, &pkt->len, pkt->size);
+        if (pkt->error == 0)
+            done++;
+    }
+    return done;
+}
+
+
+/**
+ * Turns many SRTP packets into RTP packets, as srtp_recv() does.
+ *
+ * @param pkts packets; on return, the error member of each is set to 0 or
+ *             to the srtp_recv() error code, and len to the RTP length
+ * @param count number of packets
+ *
+ * @return the number of successfully authenticated packets
+ */
+unsigned
+srtp_recv_batch (srtp_session_t *s, srtp_packet_t *pkts, unsigned count)
+{
+    unsigned done = 0;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        srtp_packet_t *pkt = pkts + i;
+
+        pkt->error = srtp_recv (s, pkt->buf, &pkt->len);
+        if (pkt->error == 0)
+            done++;
+    }
+    return done;
+}
@@ -41,6 +41,7 @@ enum
     SRTP_ENCR_NULL=0,   //< no encryption
     SRTP_ENCR_AES_CM=1, //< AES counter mode
     SRTP_ENCR_AES_F8=2, //< AES F8 mode (not implemented)
+    SRTP_ENCR_AES_GCM=6, //< AES Galois/counter mode (RFC 7714)
 };
 
 /** SRTP authenticaton algorithms; same values as MIKEY */
@@ -75,6 +76,20 @@ int srtp_recv (srtp_session_t *s, uint8_t *buf, size_t *lenp);
 int srtcp_send (srtp_session_t *s, uint8_t *buf, size_t *lenp, size_t maxsiz);
 int srtcp_recv (srtp_session_t *s, uint8_t *buf, size_t *lenp);
 
+/** Packet of a batch */
+typedef struct srtp_packet_t
+{
+    uint8_t *buf;  //< packet data
+    size_t   len;  //< packet length (updated on success)
+    size_t   size; //< buffer size (only used for sending)
+    int      error; //< set to 0 or the error of srtp_send()/srtp_recv()
+} srtp_packet_t;
+
+unsigned srtp_send_batch (srtp_session_t *s, srtp_packet_t *pkts,
+                          unsigned count);
+unsigned srtp_recv_batch (srtp_session_t *s, srtp_packet_t *pkts,
+                          unsigned count);
+
 # ifdef __cplusplus
 }
 # endif
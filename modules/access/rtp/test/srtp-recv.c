@@ -33,6 +33,157 @@
 #include <assert.h>
 
 
+static void test_gcm (void)
+{
+    static const char key[] = "123456789ABCDEF0" "123456789ABCDEF0";
+    static const char salt[] = "1234567890" "1234567890" "1234";
+    srtp_session_t *sd, *se;
+    int val;
+
+    /* GCM authenticates by itself, and only with RFC 7714 tag lengths */
+    se = srtp_create (SRTP_ENCR_AES_GCM, SRTP_AUTH_HMAC_SHA1, 16,
+                      SRTP_PRF_AES_CM, 0);
+    assert (se == NULL);
+    se = srtp_create (SRTP_ENCR_AES_GCM, SRTP_AUTH_NULL, 10,
+                      SRTP_PRF_AES_CM, 0);
+    assert (se == NULL);
+    se = srtp_create (SRTP_ENCR_AES_GCM, SRTP_AUTH_NULL, 16,
+                      SRTP_PRF_AES_CM, SRTP_RCC_MODE1);
+    assert (se == NULL);
+
+    se = srtp_create (SRTP_ENCR_AES_GCM, SRTP_AUTH_NULL, 16,
+                      SRTP_PRF_AES_CM, 0);
+    assert (se != NULL);
+    sd = srtp_create (SRTP_ENCR_AES_GCM, SRTP_AUTH_NULL, 16,
+                      SRTP_PRF_AES_CM, 0);
+    assert (sd != NULL);
+
+    /* 96-bits master salt */
+    val = srtp_setkeystring (se, key, "1234567890" "1234567890" "12345678");
+    assert (val == EINVAL);
+    val = srtp_setkeystring (se, key, salt);
+    assert (val == 0);
+    val = srtp_setkeystring (sd, key, salt);
+    assert (val == 0);
+
+    uint8_t buf[1500], buf2[1500];
+    size_t len;
+
+    /* Too small buffer */
+    memset (buf, 0, sizeof (buf));
+    buf[0] = 0x80;
+    buf[3] = 1;
+    len = 0x10c;
+    val = srtp_send (se, buf, &len, 0x10c);
+    assert (val == ENOSPC);
+    assert (len == 0x11c);
+
+    /* OK (seq=1) */
+    for (unsigned i = 0; i < 256; i++)
+        buf[i + 12] = i;
+    len = 0x10c;
+    val = srtp_send (se, buf, &len, sizeof (buf));
+    assert (val == 0);
+    assert (len == 0x11c);
+    assert (buf[12] != 0 || buf[13] != 1); // encrypted
+
+    memcpy (buf2, buf, len);
+    val = srtp_recv (sd, buf2, &len);
+    assert (val == 0);
+    assert (len == 0x10c);
+    for (unsigned i = 0; i < 256; i++)
+        assert (buf2[i + 12] == i);
+
+    /* Replay attack (seq=1) */
+    len = 0x11c;
+    memcpy (buf2, buf, len);
+    val = srtp_recv (sd, buf2, &len);
+    assert (val == EACCES);
+
+    /* Tampered header and payload (seq=2) */
+    buf[3] = 2;
+    for (unsigned i = 0; i < 256; i++)
+        buf[i + 12] = i;
+    len = 0x10c;
+    val = srtp_send (se, buf, &len, sizeof (buf));
+    assert (val == 0);
+
+    memcpy (buf2, buf, len);
+    buf2[1] ^= 1;
+    val = srtp_recv (sd, buf2, &len);
+    assert (val == EACCES);
+
+    len = 0x11c;
+    memcpy (buf2, buf, len);
+    buf2[100] ^= 1;
+    val = srtp_recv (sd, buf2, &len);
+    assert (val == EACCES);
+
+    /* Rejected packets did not update the window */
+    len = 0x11c;
+    val = srtp_recv (sd, buf, &len);
+    assert (val == 0);
+    assert (len == 0x10c);
+
+    /* Batches (seq=3 to 6) */
+    srtp_packet_t pkts[4];
+    uint8_t bufs[4][64];
+
+    for (unsigned i = 0; i < 4; i++)
+    {
+        memset (bufs[i], i, sizeof (bufs[i]));
+        bufs[i][0] = 0x80;
+        bufs[i][2] = 0;
+        bufs[i][3] = 3 + i;
+        pkts[i].buf = bufs[i];
+        pkts[i].len = 32;
+        pkts[i].size = sizeof (bufs[i]);
+    }
+    pkts[2].size = 32; /* too small */
+
+    val = srtp_send_batch (se, pkts, 4);
+    assert (val == 3);
+    assert (pkts[2].error == ENOSPC);
+    pkts[2].size = sizeof (bufs[2]);
+    pkts[2].len = 32;
+    val = srtp_send_batch (se, pkts + 2, 1);
+    assert (val == 1);
+
+    bufs[1][40] ^= 0xff;
+    val = srtp_recv_batch (sd, pkts, 4);
+    assert (val == 3);
+    assert (pkts[0].error == 0 && pkts[0].len == 32);
+    assert (pkts[1].error == EACCES);
+    assert (pkts[3].error == 0 && bufs[3][31] == 3);
+
+    /* SRTCP */
+    memset (buf, 0, 28);
+    buf[0] = 0x80;
+    buf[1] = 200;
+    buf[3] = 6;
+    for (unsigned i = 8; i < 28; i++)
+        buf[i] = i;
+    len = 28;
+    val = srtcp_send (se, buf, &len, sizeof (buf));
+    assert (val == 0);
+    assert (len == 28 + 16 + 4);
+
+    memcpy (buf2, buf, len);
+    val = srtcp_recv (sd, buf2, &len);
+    assert (val == 0);
+    assert (len == 28);
+    for (unsigned i = 8; i < 28; i++)
+        assert (buf2[i] == i);
+
+    len = 28 + 16 + 4;
+    memcpy (buf2, buf, len);
+    val = srtcp_recv (sd, buf2, &len);
+    assert (val == EACCES); /* replayed */
+
+    srtp_destroy (se);
+    srtp_destroy (sd);
+}
+
 int main (void)
 {
     static const char key[] =
@@ -168,5 +319,7 @@ int main (void)
 
     srtp_destroy (se);
     srtp_destroy (sd);
+
+    test_gcm ();
     return 0;
 }
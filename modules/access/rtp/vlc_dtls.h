@@ -35,7 +35,7 @@ struct vlc_dtls_operations {
 
     int (*get_fd)(struct vlc_dtls *, short *events);
     ssize_t (*readv)(struct vlc_dtls *, struct iovec *iov, unsigned len,
-                     bool *restrict truncated);
+                     bool *restrict truncated, vlc_tick_t *restrict date);
     ssize_t (*writev)(struct vlc_dtls *, const struct iovec *iov, unsigned len);
 };
 
@@ -49,12 +49,19 @@ static inline int vlc_dtls_GetPollFD(struct vlc_dtls *dgs, short *restrict ev)
     return dgs->ops->get_fd(dgs, ev);
 }
 
+/**
+ * Receives one datagram.
+ *
+ * \param date storage for the reception time, or VLC_TICK_INVALID if the
+ *             socket does not report it
+ */
 static inline ssize_t vlc_dtls_Recv(struct vlc_dtls *dgs, void *buf, size_t len,
-                                   bool *restrict truncated)
+                                   bool *restrict truncated,
+                                   vlc_tick_t *restrict date)
 {
     struct iovec iov = { .iov_base = buf, .iov_len = len };
 
-    return dgs->ops->readv(dgs, &iov, 1, truncated);
+    return dgs->ops->readv(dgs, &iov, 1, truncated, date);
 }
 
 static inline ssize_t vlc_dtls_Send(struct vlc_dtls *dgs, const void *buf,
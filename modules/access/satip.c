@@ -40,6 +40,8 @@
 #include <vlc_rand.h>
 #include <vlc_url.h>
 #include <vlc_interrupt.h>
+#include <vlc_list.h>
+#include <vlc_memstream.h>
 
 #ifdef HAVE_POLL_H
 #include <poll.h>
@@ -54,6 +56,9 @@
 #define VLEN 100
 #define KEEPALIVE_INTERVAL 60
 #define KEEPALIVE_MARGIN 5
+#define TS_PACKET_SIZE 188
+#define TS_PIDS 8192
+
 
 static int satip_open(vlc_object_t *);
 static void satip_close(vlc_object_t *);
@@ -63,6 +68,11 @@ static void satip_close(vlc_object_t *);
 
 #define SATIP_HOST_TEXT N_("Host")
 
+#define SHARE_TEXT N_("Share sessions")
+#define SHARE_LONGTEXT N_("Receive through a single RTSP session for all " \
+    "the inputs of the process tuned to the same transponder. Each input " \
+    "only receives its own PIDs.")
+
 vlc_module_begin()
     set_shortname("satip")
     set_description( N_("SAT>IP Receiver Plugin") )
@@ -73,6 +83,7 @@ vlc_module_begin()
     add_bool("satip-multicast", false, MULTICAST_TEXT, MULTICAST_LONGTEXT)
     add_string("satip-host", "", SATIP_HOST_TEXT, NULL)
     change_safe()
+    add_bool("satip-share", false, SHARE_TEXT, SHARE_LONGTEXT)
     add_shortcut("rtsp", "satip")
 vlc_module_end()
 
@@ -89,8 +100,19 @@ enum rtsp_result {
 };
 
 #define UDP_ADDRESS_LEN 16
+
+/**
+ * RTSP session with a SAT>IP server, i.e. one (remote) tuner. In shared
+ * mode, the session feeds all the inputs tuned to the same transponder, and
+ * requests the union of their PIDs.
+ */
 typedef struct
 {
+    struct vlc_list node;
+    vlc_object_t *obj;
+    char *key; /**< Tuning without PIDs, NULL if not shared */
+    unsigned refs; /**< Protected by satip_sessions_lock */
+
     char *content_base;
     char *control;
     char session_id[64];
@@ -106,16 +128,37 @@ typedef struct
 
     enum rtsp_state state;
     int cseq;
+    vlc_mutex_t rtsp_lock; /**< Serializes requests on the TCP socket */
 
-    vlc_queue_t queue;
     vlc_thread_t thread;
     uint16_t last_seq_nr;
 
+    vlc_mutex_t lock;
+    struct vlc_list inputs; /**< Protected by lock */
+    bool dead; /**< No more data, protected by lock */
+    unsigned all_refs; /**< Inputs receiving all PIDs */
+    uint16_t pid_refs[TS_PIDS];
+    char *pids; /**< Currently requested PIDs */
+} satip_session_t;
+
+typedef struct
+{
+    satip_session_t *session;
+    struct vlc_list node;
+
+    vlc_queue_t queue;
     bool woken;
+
+    bool all; /**< Receives all PIDs */
+    uint8_t pids[TS_PIDS / 8];
 } access_sys_t;
 
+static vlc_mutex_t satip_sessions_lock = VLC_STATIC_MUTEX;
+static struct vlc_list satip_sessions =
+    VLC_LIST_INITIALIZER(&satip_sessions);
+
 VLC_FORMAT(3, 4)
-static void net_Printf(stream_t *access, int fd, const char *fmt, ...)
+static void net_Printf(vlc_object_t *obj, int fd, const char *fmt, ...)
 {
     va_list ap;
     char *str;
@@ -126,7 +169,7 @@ static void net_Printf(stream_t *access, int fd, const char *fmt, ...)
     va_end(ap);
 
     if (val >= 0) {
-        net_Write(access, fd, str, val);
+        net_Write(obj, fd, str, val);
         free(str);
     }
 }
@@ -162,8 +205,7 @@ static int parse_port(char *str, uint16_t *port)
     return 0;
 }
 
-static int parse_transport(stream_t *access, char *request_line) {
-    access_sys_t *sys = access->p_sys;
+static int parse_transport(satip_session_t *s, char *request_line) {
     char *state;
     char *tok;
     int err;
@@ -178,7 +220,7 @@ static int parse_transport(stream_t *access, char *request_line) {
 
     while ((tok = strtok_r(NULL, ";", &state)) != NULL) {
         if (strncmp(tok, "destination=", 12) == 0) {
-            memcpy(sys->udp_address, tok + 12, __MIN(strlen(tok + 12), UDP_ADDRESS_LEN - 1));
+            memcpy(s->udp_address, tok + 12, __MIN(strlen(tok + 12), UDP_ADDRESS_LEN - 1));
         } else if (strncmp(tok, "port=", 5) == 0) {
             char port[6];
             char *end;
@@ -187,7 +229,7 @@ static int parse_transport(stream_t *access, char *request_line) {
             memcpy(port, tok + 5, __MIN(strlen(tok + 5), 5));
             if ((end = strstr(port, "-")) != NULL)
                 *end = '\0';
-            err = parse_port(port, &sys->udp_port);
+            err = parse_port(port, &s->udp_port);
             if (err)
                 return err;
         }
@@ -275,8 +317,7 @@ error:
 }
 
 #define skip_whitespace(x) while(*x == ' ') x++
-static enum rtsp_result rtsp_handle(stream_t *access, bool *interrupted) {
-    access_sys_t *sys = access->p_sys;
+static enum rtsp_result rtsp_handle(satip_session_t *s, bool *interrupted) {
     uint8_t buffer[512];
     int rtsp_result = 0;
     bool have_header = false;
@@ -286,20 +327,19 @@ static enum rtsp_result rtsp_handle(stream_t *access, bool *interrupted) {
 
     /* Parse header */
     while (!have_header) {
-        in = net_readln_timeout((vlc_object_t*)access, sys->tcp_sock, 5000,
-                interrupted);
+        in = net_readln_timeout(s->obj, s->tcp_sock, 5000, interrupted);
         if (in == NULL)
             break;
 
         if (strncmp(in, "RTSP/1.0 ", 9) == 0) {
             rtsp_result = atoi(in + 9);
         } else if (strncmp(in, "Content-Base:", 13) == 0) {
-            free(sys->content_base);
+            free(s->content_base);
 
             val = in + 13;
             skip_whitespace(val);
 
-            sys->content_base = strdup(val);
+            s->content_base = strdup(val);
         } else if (strncmp(in, "Content-Length:", 15) == 0) {
             val = in + 16;
             skip_whitespace(val);
@@ -309,12 +349,12 @@ static enum rtsp_result rtsp_handle(stream_t *access, bool *interrupted) {
             val = in + 8;
             skip_whitespace(val);
 
-            parse_session(val, sys->session_id, 64, &sys->keepalive_interval);
+            parse_session(val, s->session_id, 64, &s->keepalive_interval);
         } else if (strncmp("Transport:", in, 10) == 0) {
             val = in + 10;
             skip_whitespace(val);
 
-            if (parse_transport(access, val) != 0) {
+            if (parse_transport(s, val) != 0) {
                 rtsp_result = VLC_EGENERIC;
                 break;
             }
@@ -322,7 +362,7 @@ static enum rtsp_result rtsp_handle(stream_t *access, bool *interrupted) {
             val = in + 17;
             skip_whitespace(val);
 
-            sys->stream_id = atoi(val);
+            s->stream_id = atoi(val);
         } else if (in[0] == '\0') {
             have_header = true;
         }
@@ -332,12 +372,17 @@ static enum rtsp_result rtsp_handle(stream_t *access, bool *interrupted) {
 
     /* Discard further content */
     while (content_length > 0 &&
-            (read = net_Read(access, sys->tcp_sock, buffer, __MIN(sizeof(buffer), content_length))))
+            (read = net_Read(s->obj, s->tcp_sock, buffer, __MIN(sizeof(buffer), content_length))))
         content_length -= read;
 
     return rtsp_result;
 }
 
+static void satip_unlock(void *data)
+{
+    vlc_mutex_unlock(data);
+}
+
 #ifdef HAVE_RECVMMSG
 static void satip_cleanup_blocks(void *data)
 {
@@ -349,37 +394,34 @@ static void satip_cleanup_blocks(void *data)
 }
 #endif
 
-static int check_rtp_seq(stream_t *access, block_t *block)
+static int check_rtp_seq(satip_session_t *s, block_t *block)
 {
-    access_sys_t *sys = access->p_sys;
     uint16_t seq_nr = block->p_buffer[2] << 8 | block->p_buffer[3];
 
-    if (seq_nr == sys->last_seq_nr) {
-        msg_Warn(access, "Received duplicate packet (seq_nr=%"PRIu16")", seq_nr);
+    if (seq_nr == s->last_seq_nr) {
+        msg_Warn(s->obj, "Received duplicate packet (seq_nr=%"PRIu16")", seq_nr);
         return VLC_EGENERIC;
-    } else if (seq_nr < (uint16_t)(sys->last_seq_nr + 1)) {
-        msg_Warn(access, "Received out of order packet (seq_nr=%"PRIu16" < %"PRIu16")",
-                seq_nr, sys->last_seq_nr);
+    } else if (seq_nr < (uint16_t)(s->last_seq_nr + 1)) {
+        msg_Warn(s->obj, "Received out of order packet (seq_nr=%"PRIu16" < %"PRIu16")",
+                seq_nr, s->last_seq_nr);
         return VLC_EGENERIC;
-    } else if (++sys->last_seq_nr > 1 && seq_nr > sys->last_seq_nr) {
-        msg_Warn(access, "Gap in seq_nr (%"PRIu16" > %"PRIu16"), probably lost a packet",
-                seq_nr, sys->last_seq_nr);
+    } else if (++s->last_seq_nr > 1 && seq_nr > s->last_seq_nr) {
+        msg_Warn(s->obj, "Gap in seq_nr (%"PRIu16" > %"PRIu16"), probably lost a packet",
+                seq_nr, s->last_seq_nr);
     }
 
-    sys->last_seq_nr = seq_nr;
+    s->last_seq_nr = seq_nr;
     return 0;
 }
 
-static void satip_teardown(void *data) {
-    stream_t *access = data;
-    access_sys_t *sys = access->p_sys;
+static void satip_teardown(satip_session_t *s) {
     int ret;
 
-    if (sys->tcp_sock > 0) {
-        if (sys->session_id[0] > 0) {
+    if (s->tcp_sock > 0) {
+        if (s->session_id[0] > 0) {
             char discard_buf[32];
             struct pollfd pfd = {
-                .fd = sys->tcp_sock,
+                .fd = s->tcp_sock,
                 .events = POLLOUT,
             };
             char *msg;
@@ -387,29 +429,29 @@ static void satip_teardown(void *data) {
             int len = asprintf(&msg, "TEARDOWN %s RTSP/1.0\r\n"
                     "CSeq: %d\r\n"
                     "Session: %s\r\n\r\n",
-                    sys->control, sys->cseq++, sys->session_id);
+                    s->control, s->cseq++, s->session_id);
             if (len < 0)
                 return;
 
             /* make socket non-blocking, to avoid blocking when output buffer
              * has not enough space */
 #ifndef _WIN32
-            fcntl(sys->tcp_sock, F_SETFL, fcntl(sys->tcp_sock, F_GETFL) | O_NONBLOCK);
+            fcntl(s->tcp_sock, F_SETFL, fcntl(s->tcp_sock, F_GETFL) | O_NONBLOCK);
 #else
-            ioctlsocket(sys->tcp_sock, FIONBIO, &(unsigned long){ 1 });
+            ioctlsocket(s->tcp_sock, FIONBIO, &(unsigned long){ 1 });
 #endif
 
             for (int sent = 0; sent < len;) {
                 ret = poll(&pfd, 1, 5000);
                 if (ret == 0) {
-                    msg_Err(access, "Timed out sending RTSP teardown\n");
+                    msg_Err(s->obj, "Timed out sending RTSP teardown\n");
                     free(msg);
                     return;
                 }
 
-                ret = vlc_send(sys->tcp_sock, msg + sent, len, 0);
+                ret = vlc_send(s->tcp_sock, msg + sent, len, 0);
                 if (ret < 0) {
-                    msg_Err(access, "Failed to send RTSP teardown: %d\n", ret);
+                    msg_Err(s->obj, "Failed to send RTSP teardown: %d\n", ret);
                     free(msg);
                     return;
                 }
@@ -417,14 +459,14 @@ static void satip_teardown(void *data) {
             }
             free(msg);
 
-            if (rtsp_handle(access, NULL) != RTSP_RESULT_OK) {
-                msg_Err(access, "Failed to teardown RTSP session");
+            if (rtsp_handle(s, NULL) != RTSP_RESULT_OK) {
+                msg_Err(s->obj, "Failed to teardown RTSP session");
                 return;
             }
 
             /* Some SATIP servers send a few empty extra bytes after TEARDOWN.
              * Try to read them, to avoid a TCP socket reset */
-            while (recv(sys->tcp_sock, discard_buf, sizeof(discard_buf), 0) > 0);
+            while (recv(s->tcp_sock, discard_buf, sizeof(discard_buf), 0) > 0);
 
             /* Extra sleep for compatibility with some satip servers, that
              * can't handle new sessions right after teardown */
@@ -433,14 +475,70 @@ static void satip_teardown(void *data) {
     }
 }
 
+/* Keeps only the TS packets of the PIDs of the input */
+static block_t *satip_filter(const access_sys_t *sys, block_t *block)
+{
+    uint8_t *in = block->p_buffer, *out = block->p_buffer;
+
+    for (size_t n = block->i_buffer / TS_PACKET_SIZE; n > 0; n--) {
+        uint16_t pid = ((in[1] & 0x1f) << 8) | in[2];
+
+        if (in[0] == 0x47 && (sys->pids[pid / 8] & (1 << (pid % 8)))) {
+            if (out != in)
+                memmove(out, in, TS_PACKET_SIZE);
+            out += TS_PACKET_SIZE;
+        }
+        in += TS_PACKET_SIZE;
+    }
+
+    block->i_buffer = out - block->p_buffer;
+    if (block->i_buffer == 0) {
+        block_Release(block);
+        block = NULL;
+    }
+    return block;
+}
+
+static void satip_deliver(satip_session_t *s, access_sys_t *sys,
+                          block_t *block)
+{
+    /* The server only sends the PIDs of the input if it is alone */
+    if (s->key != NULL && !sys->all)
+        block = satip_filter(sys, block);
+    if (block != NULL)
+        vlc_queue_Enqueue(&sys->queue, block);
+}
+
+/* Fans a received RTP payload out to the inputs */
+static void satip_dispatch(satip_session_t *s, block_t *block)
+{
+    access_sys_t *sys, *last = NULL;
+
+    vlc_mutex_lock(&s->lock);
+    vlc_list_foreach(sys, &s->inputs, node) {
+        if (last != NULL) {
+            block_t *dup = block_Duplicate(block);
+
+            if (likely(dup != NULL))
+                satip_deliver(s, last, dup);
+        }
+        last = sys;
+    }
+
+    if (last != NULL)
+        satip_deliver(s, last, block);
+    else
+        block_Release(block);
+    vlc_mutex_unlock(&s->lock);
+}
+
 #define RECV_TIMEOUT VLC_TICK_FROM_SEC(2)
 static void *satip_thread(void *data) {
-    stream_t *access = data;
-    access_sys_t *sys = access->p_sys;
-    int sock = sys->udp_sock;
+    satip_session_t *s = data;
+    int sock = s->udp_sock;
     vlc_tick_t last_recv = vlc_tick_now();
     ssize_t len;
-    vlc_tick_t next_keepalive = vlc_tick_now() + vlc_tick_from_sec(sys->keepalive_interval);
+    vlc_tick_t next_keepalive = vlc_tick_now() + vlc_tick_from_sec(s->keepalive_interval);
 #ifdef HAVE_RECVMMSG
     struct mmsghdr msgs[VLEN];
     struct iovec iovecs[VLEN];
@@ -486,12 +584,12 @@ static void *satip_thread(void *data) {
             block_t *block = input_blocks[i];
 
             len = msgs[i].msg_len;
-            if (check_rtp_seq(access, block))
+            if (check_rtp_seq(s, block))
                 continue;
 
             block->p_buffer += RTP_HEADER_SIZE;
             block->i_buffer = len - RTP_HEADER_SIZE;
-            vlc_queue_Enqueue(&sys->queue, block);
+            satip_dispatch(s, block);
             input_blocks[i] = NULL;
         }
 #else
@@ -500,7 +598,7 @@ static void *satip_thread(void *data) {
 
         block_t *block = block_Alloc(RTSP_RECEIVE_BUFFER);
         if (block == NULL) {
-            msg_Err(access, "Failed to allocate memory for input buffer");
+            msg_Err(s->obj, "Failed to allocate memory for input buffer");
             break;
         }
 
@@ -513,34 +611,45 @@ static void *satip_thread(void *data) {
             continue;
         }
 
-        if (check_rtp_seq(access, block)) {
+        if (check_rtp_seq(s, block)) {
             block_Release(block);
             continue;
         }
         last_recv = vlc_tick_now();
         block->p_buffer += RTP_HEADER_SIZE;
         block->i_buffer = len - RTP_HEADER_SIZE;
-        vlc_queue_Enqueue(&sys->queue, block);
+        satip_dispatch(s, block);
 #endif
 
-        if (sys->keepalive_interval > 0 && vlc_tick_now() > next_keepalive) {
-            net_Printf(access, sys->tcp_sock,
+        if (s->keepalive_interval > 0 && vlc_tick_now() > next_keepalive) {
+            vlc_mutex_lock(&s->rtsp_lock);
+            vlc_cleanup_push(satip_unlock, &s->rtsp_lock);
+            net_Printf(s->obj, s->tcp_sock,
                     "OPTIONS %s RTSP/1.0\r\n"
                     "CSeq: %d\r\n"
                     "Session: %s\r\n\r\n",
-                    sys->control, sys->cseq++, sys->session_id);
-            if (rtsp_handle(access, NULL) != RTSP_RESULT_OK)
-                msg_Warn(access, "Failed to keepalive RTSP session");
+                    s->control, s->cseq++, s->session_id);
+            if (rtsp_handle(s, NULL) != RTSP_RESULT_OK)
+                msg_Warn(s->obj, "Failed to keepalive RTSP session");
+            vlc_cleanup_pop();
+            vlc_mutex_unlock(&s->rtsp_lock);
 
-            next_keepalive = vlc_tick_now() + vlc_tick_from_sec(sys->keepalive_interval);
+            next_keepalive = vlc_tick_now() + vlc_tick_from_sec(s->keepalive_interval);
         }
     }
 
 #ifdef HAVE_RECVMMSG
     satip_cleanup_blocks(input_blocks);
 #endif
-    msg_Dbg(access, "timed out waiting for data...");
-    vlc_queue_Kill(&sys->queue, &sys->woken);
+    msg_Dbg(s->obj, "timed out waiting for data...");
+
+    access_sys_t *sys;
+
+    vlc_mutex_lock(&s->lock);
+    s->dead = true;
+    vlc_list_foreach(sys, &s->inputs, node)
+        vlc_queue_Kill(&sys->queue, &sys->woken);
+    vlc_mutex_unlock(&s->lock);
     return NULL;
 }
 
@@ -581,112 +690,313 @@ static int satip_control(stream_t *access, int i_query, va_list args) {
 /* Bind two adjacent free ports, of which the first one is even (for RTP data)
  * and the second is odd (RTCP). This is a requirement of the satip
  * specification */
-static int satip_bind_ports(stream_t *access)
+static int satip_bind_ports(satip_session_t *s)
 {
-    access_sys_t *sys = access->p_sys;
     uint8_t rnd;
 
     vlc_rand_bytes(&rnd, 1);
-    sys->udp_port = 9000 + (rnd * 2); /* randomly chosen, even start point */
-    while (sys->udp_sock < 0) {
-        sys->udp_sock = net_OpenDgram(access, "0.0.0.0", sys->udp_port, NULL,
+    s->udp_port = 9000 + (rnd * 2); /* randomly chosen, even start point */
+    while (s->udp_sock < 0) {
+        s->udp_sock = net_OpenDgram(s->obj, "0.0.0.0", s->udp_port, NULL,
                 0, IPPROTO_UDP);
-        if (sys->udp_sock < 0) {
-            if (sys->udp_port == 65534)
+        if (s->udp_sock < 0) {
+            if (s->udp_port == 65534)
                 break;
 
-            sys->udp_port += 2;
+            s->udp_port += 2;
             continue;
         }
 
-        sys->rtcp_sock = net_OpenDgram(access, "0.0.0.0", sys->udp_port + 1, NULL,
+        s->rtcp_sock = net_OpenDgram(s->obj, "0.0.0.0", s->udp_port + 1, NULL,
                 0, IPPROTO_UDP);
-        if (sys->rtcp_sock < 0) {
-            close(sys->udp_sock);
-            sys->udp_port += 2;
+        if (s->rtcp_sock < 0) {
+            close(s->udp_sock);
+            s->udp_port += 2;
             continue;
         }
     }
 
-    if (sys->udp_sock < 0) {
-        msg_Err(access, "Could not open two adjacent ports for RTP and RTCP data");
+    if (s->udp_sock < 0) {
+        msg_Err(s->obj, "Could not open two adjacent ports for RTP and RTCP data");
         return VLC_EGENERIC;
     }
 
     return 0;
 }
 
-static int satip_open(vlc_object_t *obj)
+/**
+ * Finds the "pids" parameter of a (lower case) URL.
+ *
+ * @return a pointer to the value, or NULL if absent
+ */
+static char *satip_find_pids(char *url)
 {
-    stream_t *access = (stream_t *)obj;
-    access_sys_t *sys;
-    vlc_url_t url;
+    char *query = strchr(url, '?');
 
-    bool multicast = var_InheritBool(access, "satip-multicast");
+    for (char *p = query; p != NULL; p = strchr(p + 1, '&'))
+        if (strncmp(p + 1, "pids=", 5) == 0)
+            return p + 6;
+    return NULL;
+}
 
-    access->p_sys = sys = vlc_obj_calloc(obj, 1, sizeof(*sys));
-    if (sys == NULL)
-        return VLC_ENOMEM;
+/* Parses the PIDs the input asks for */
+static void satip_parse_pids(access_sys_t *sys, char *url)
+{
+    const char *pids = satip_find_pids(url);
 
-    msg_Dbg(access, "try to open '%s'", access->psz_url);
+    /* Without PIDs, assume the server default */
+    if (pids == NULL || strncmp(pids, "all", 3) == 0) {
+        sys->all = true;
+        return;
+    }
 
-    char *psz_host = var_InheritString(access, "satip-host");
+    while (*pids != '\0' && *pids != '&') {
+        char *end;
+        unsigned long pid = strtoul(pids, &end, 10);
 
-    sys->udp_sock = -1;
-    sys->rtcp_sock = -1;
-    sys->tcp_sock = -1;
+        if (end == pids)
+            break;
+        if (pid < TS_PIDS)
+            sys->pids[pid / 8] |= 1 << (pid % 8);
+        pids = end;
+        if (*pids == ',')
+            pids++;
+    }
+}
 
-    /* convert url to lowercase, some famous m3u playlists for satip contain
-     * uppercase parameters while most (all?) satip servers do only understand
-     * parameters matching lowercase spelling as defined in the specification
-     * */
-    char *psz_lower_url = strdup(access->psz_url);
-    if (psz_lower_url == NULL)
-    {
-        free( psz_host );
+/* Removes the PIDs from a URL, leaving the tuning parameters */
+static void satip_strip_pids(char *url)
+{
+    char *pids = satip_find_pids(url);
+
+    if (pids == NULL)
+        return;
+
+    char *end = strchr(pids, '&');
+    pids -= 5; /* "pids=" */
+    if (end != NULL)
+        memmove(pids, end + 1, strlen(end + 1) + 1);
+    else
+        pids[-1] = '\0'; /* also remove the separator */
+}
+
+/* Formats the union of the PIDs of all the inputs */
+static char *satip_format_pids(satip_session_t *s)
+{
+    struct vlc_memstream ms;
+
+    if (vlc_memstream_open(&ms))
+        return NULL;
+
+    if (s->all_refs > 0)
+        vlc_memstream_puts(&ms, "all");
+    else {
+        const char *sep = "";
+
+        for (unsigned pid = 0; pid < TS_PIDS; pid++)
+            if (s->pid_refs[pid] > 0) {
+                vlc_memstream_printf(&ms, "%s%u", sep, pid);
+                sep = ",";
+            }
+        if (sep[0] == '\0')
+            vlc_memstream_puts(&ms, "none");
+    }
+
+    return vlc_memstream_close(&ms) ? NULL : ms.ptr;
+}
+
+static void satip_count_pids(satip_session_t *s, const access_sys_t *sys,
+                             int delta)
+{
+    if (sys->all) {
+        s->all_refs += delta;
+        return;
+    }
+
+    for (unsigned pid = 0; pid < TS_PIDS; pid++)
+        if (sys->pids[pid / 8] & (1 << (pid % 8)))
+            s->pid_refs[pid] += delta;
+}
+
+/**
+ * Requests the PIDs of all the inputs from the server, if they changed.
+ */
+static int satip_update_pids(satip_session_t *s, bool send)
+{
+    vlc_mutex_lock(&s->lock);
+    char *pids = satip_format_pids(s);
+    vlc_mutex_unlock(&s->lock);
+
+    if (unlikely(pids == NULL))
         return VLC_ENOMEM;
+
+    int ret = 0;
+
+    vlc_mutex_lock(&s->rtsp_lock);
+    if (s->pids != NULL && strcmp(s->pids, pids) == 0) {
+        free(pids);
+        pids = NULL;
+    } else if (send) {
+        msg_Dbg(s->obj, "requesting PIDs %s", pids);
+        net_Printf(s->obj, s->tcp_sock,
+                "PLAY %s?pids=%s RTSP/1.0\r\n"
+                "CSeq: %d\r\n"
+                "Session: %s\r\n\r\n",
+                s->control, pids, s->cseq++, s->session_id);
+
+        if (rtsp_handle(s, NULL) != RTSP_RESULT_OK) {
+            msg_Err(s->obj, "Failed to change RTSP session PIDs");
+            ret = VLC_EGENERIC;
+        }
     }
 
-    for (unsigned i = 0; i < strlen(psz_lower_url); i++)
-        psz_lower_url[i] = tolower(psz_lower_url[i]);
+    if (pids != NULL) {
+        free(s->pids);
+        s->pids = pids;
+    }
+    vlc_mutex_unlock(&s->rtsp_lock);
+    return ret;
+}
 
-    vlc_UrlParse(&url, psz_lower_url);
-    if (url.i_port <= 0)
-        url.i_port = RTSP_DEFAULT_PORT;
-    if (psz_host == NULL && url.psz_host )
-        psz_host = strdup(url.psz_host);
-    if (psz_host == NULL )
-        goto error;
+static void satip_attach(satip_session_t *s, access_sys_t *sys)
+{
+    sys->session = s;
+
+    vlc_mutex_lock(&s->lock);
+    vlc_list_append(&sys->node, &s->inputs);
+    satip_count_pids(s, sys, +1);
+    if (s->dead)
+        vlc_queue_Kill(&sys->queue, &sys->woken);
+    vlc_mutex_unlock(&s->lock);
+}
 
-    if (url.psz_host == NULL || url.psz_host[0] == '\0')
-    {
-        msg_Dbg(access, "malformed URL: %s", psz_lower_url);
-        goto error;
+static void satip_detach(satip_session_t *s, access_sys_t *sys)
+{
+    vlc_mutex_lock(&s->lock);
+    vlc_list_remove(&sys->node);
+    satip_count_pids(s, sys, -1);
+    vlc_mutex_unlock(&s->lock);
+}
+
+static void satip_session_destroy(satip_session_t *s)
+{
+    satip_teardown(s);
+
+    if (s->udp_sock >= 0)
+        net_Close(s->udp_sock);
+    if (s->rtcp_sock >= 0)
+        net_Close(s->rtcp_sock);
+    if (s->tcp_sock >= 0)
+        net_Close(s->tcp_sock);
+
+    free(s->content_base);
+    free(s->control);
+    free(s->pids);
+    if (s->key != NULL) {
+        free(s->key);
+        vlc_object_delete(s->obj);
     }
+    free(s);
+}
+
+static void satip_session_release(satip_session_t *s)
+{
+    vlc_mutex_lock(&satip_sessions_lock);
+    bool last = --s->refs == 0;
+    if (last && s->key != NULL)
+        vlc_list_remove(&s->node);
+    vlc_mutex_unlock(&satip_sessions_lock);
+
+    if (!last)
+        return;
+
+    vlc_cancel(s->thread);
+    vlc_join(s->thread, NULL);
+    satip_session_destroy(s);
+}
+
+/* Finds a running session tuned as requested */
+static satip_session_t *satip_session_find(const char *key)
+{
+    satip_session_t *s;
+
+    vlc_mutex_lock(&satip_sessions_lock);
+    vlc_list_foreach(s, &satip_sessions, node) {
+        vlc_mutex_lock(&s->lock);
+        bool dead = s->dead;
+        vlc_mutex_unlock(&s->lock);
+
+        if (!dead && strcmp(s->key, key) == 0) {
+            s->refs++;
+            vlc_mutex_unlock(&satip_sessions_lock);
+            return s;
+        }
+    }
+    vlc_mutex_unlock(&satip_sessions_lock);
+    return NULL;
+}
+
+/**
+ * Sets an RTSP session up for the input. With a key, the session can be
+ * shared with later inputs and has its own object, as it may outlive the
+ * input.
+ */
+static satip_session_t *satip_session_open(stream_t *access,
+                                           access_sys_t *sys,
+                                           vlc_url_t *url,
+                                           const char *psz_host,
+                                           char *key)
+{
+    bool multicast = var_InheritBool(access, "satip-multicast");
+    satip_session_t *s = calloc(1, sizeof(*s));
+
+    if (unlikely(s == NULL)) {
+        free(key);
+        return NULL;
+    }
+
+    s->obj = VLC_OBJECT(access);
+    if (key != NULL) {
+        s->obj = vlc_object_create(vlc_object_instance(access),
+                                   sizeof(*s->obj));
+        if (unlikely(s->obj == NULL)) {
+            free(key);
+            free(s);
+            return NULL;
+        }
+    }
+    s->key = key;
+    s->refs = 1;
+    s->udp_sock = -1;
+    s->rtcp_sock = -1;
+    s->tcp_sock = -1;
+    vlc_mutex_init(&s->rtsp_lock);
+    vlc_mutex_init(&s->lock);
+    vlc_list_init(&s->inputs);
 
     msg_Dbg(access, "connect to host '%s'", psz_host);
-    sys->tcp_sock = net_Connect(access, psz_host, url.i_port, SOCK_STREAM, 0);
-    if (sys->tcp_sock < 0) {
+    s->tcp_sock = net_Connect(access, psz_host, url->i_port, SOCK_STREAM, 0);
+    if (s->tcp_sock < 0) {
         msg_Err(access, "Failed to connect to RTSP server %s:%d",
-                psz_host, url.i_port);
+                psz_host, url->i_port);
         goto error;
     }
-    setsockopt (sys->tcp_sock, SOL_SOCKET, SO_KEEPALIVE, &(int){ 1 }, sizeof (int));
+    setsockopt (s->tcp_sock, SOL_SOCKET, SO_KEEPALIVE, &(int){ 1 }, sizeof (int));
 
-    if (asprintf(&sys->content_base, "rtsp://%s:%d/", psz_host,
-             url.i_port) < 0) {
-        sys->content_base = NULL;
+    if (asprintf(&s->content_base, "rtsp://%s:%d/", psz_host,
+             url->i_port) < 0) {
+        s->content_base = NULL;
         goto error;
     }
 
-    sys->last_seq_nr = 0;
-    sys->keepalive_interval = (KEEPALIVE_INTERVAL - KEEPALIVE_MARGIN);
+    s->last_seq_nr = 0;
+    s->keepalive_interval = (KEEPALIVE_INTERVAL - KEEPALIVE_MARGIN);
 
-    vlc_url_t setup_url = url;
+    vlc_url_t setup_url = *url;
 
     // substitute "sat.ip" if present with an the host IP that was fetched during device discovery
     if( !strncasecmp( setup_url.psz_host, "sat.ip", 6 ) ) {
-        setup_url.psz_host = psz_host;
+        setup_url.psz_host = (char *)psz_host;
     }
 
     // reverse the satip protocol trick, as SAT>IP believes to be RTSP
@@ -701,34 +1011,34 @@ static int satip_open(vlc_object_t *obj)
         goto error;
 
     if (multicast) {
-        net_Printf(access, sys->tcp_sock,
+        net_Printf(s->obj, s->tcp_sock,
                 "SETUP %s RTSP/1.0\r\n"
                 "CSeq: %d\r\n"
                 "Transport: RTP/AVP;multicast\r\n\r\n",
-                psz_setup_url, sys->cseq++);
+                psz_setup_url, s->cseq++);
     } else {
         /* open UDP socket to acquire a free port to use */
-        if (satip_bind_ports(access)) {
+        if (satip_bind_ports(s)) {
             free(psz_setup_url);
             goto error;
         }
 
-        net_Printf(access, sys->tcp_sock,
+        net_Printf(s->obj, s->tcp_sock,
                 "SETUP %s RTSP/1.0\r\n"
                 "CSeq: %d\r\n"
                 "Transport: RTP/AVP;unicast;client_port=%d-%d\r\n\r\n",
-                psz_setup_url, sys->cseq++, sys->udp_port, sys->udp_port + 1);
+                psz_setup_url, s->cseq++, s->udp_port, s->udp_port + 1);
     }
     free(psz_setup_url);
 
     bool interrupted = false;
-    if (rtsp_handle(access, &interrupted) != RTSP_RESULT_OK) {
+    if (rtsp_handle(s, &interrupted) != RTSP_RESULT_OK) {
         msg_Err(access, "Failed to setup RTSP session");
         goto error;
     }
 
-    if (asprintf(&sys->control, "%sstream=%d", sys->content_base, sys->stream_id) < 0) {
-        sys->control = NULL;
+    if (asprintf(&s->control, "%sstream=%d", s->content_base, s->stream_id) < 0) {
+        s->control = NULL;
         goto error;
     }
 
@@ -744,60 +1054,145 @@ static int satip_open(vlc_object_t *obj)
 
     /* Open UDP socket for reading if not done */
     if (multicast) {
-        sys->udp_sock = net_OpenDgram(access, sys->udp_address, sys->udp_port, "", sys->udp_port, IPPROTO_UDP);
-        if (sys->udp_sock < 0) {
+        s->udp_sock = net_OpenDgram(access, s->udp_address, s->udp_port, "", s->udp_port, IPPROTO_UDP);
+        if (s->udp_sock < 0) {
             msg_Err(access, "Failed to open UDP socket for listening.");
             goto error;
         }
 
-        sys->rtcp_sock = net_OpenDgram(access, sys->udp_address, sys->udp_port + 1, "", sys->udp_port + 1, IPPROTO_UDP);
-        if (sys->rtcp_sock < 0) {
+        s->rtcp_sock = net_OpenDgram(access, s->udp_address, s->udp_port + 1, "", s->udp_port + 1, IPPROTO_UDP);
+        if (s->rtcp_sock < 0) {
             msg_Err(access, "Failed to open RTCP socket for listening.");
             goto error;
         }
     }
 
-    net_Printf(access, sys->tcp_sock,
+    net_Printf(s->obj, s->tcp_sock,
             "PLAY %s RTSP/1.0\r\n"
             "CSeq: %d\r\n"
             "Session: %s\r\n\r\n",
-            sys->control, sys->cseq++, sys->session_id);
+            s->control, s->cseq++, s->session_id);
 
-    if (rtsp_handle(access, NULL) != RTSP_RESULT_OK) {
+    if (rtsp_handle(s, NULL) != RTSP_RESULT_OK) {
         msg_Err(access, "Failed to play RTSP session");
         goto error;
     }
 
-    vlc_queue_Init(&sys->queue, offsetof (block_t, p_next));
+    /* The SETUP request had the PIDs of this input */
+    satip_attach(s, sys);
+    satip_update_pids(s, false);
 
-    if (vlc_clone(&sys->thread, satip_thread, access, VLC_THREAD_PRIORITY_INPUT)) {
+    if (vlc_clone(&s->thread, satip_thread, s, VLC_THREAD_PRIORITY_INPUT)) {
         msg_Err(access, "Failed to create worker thread.");
+        satip_detach(s, sys);
         goto error;
     }
 
+    if (key != NULL) {
+        vlc_mutex_lock(&satip_sessions_lock);
+        vlc_list_append(&s->node, &satip_sessions);
+        vlc_mutex_unlock(&satip_sessions_lock);
+    }
+    return s;
+
+error:
+    satip_session_destroy(s);
+    return NULL;
+}
+
+static int satip_open(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+    access_sys_t *sys;
+    vlc_url_t url;
+
+    access->p_sys = sys = vlc_obj_calloc(obj, 1, sizeof(*sys));
+    if (sys == NULL)
+        return VLC_ENOMEM;
+
+    msg_Dbg(access, "try to open '%s'", access->psz_url);
+
+    char *psz_host = var_InheritString(access, "satip-host");
+
+    /* convert url to lowercase, some famous m3u playlists for satip contain
+     * uppercase parameters while most (all?) satip servers do only understand
+     * parameters matching lowercase spelling as defined in the specification
+     * */
+    char *psz_lower_url = strdup(access->psz_url);
+    if (psz_lower_url == NULL)
+    {
+        free( psz_host );
+        return VLC_ENOMEM;
+    }
+
+    for (unsigned i = 0; i < strlen(psz_lower_url); i++)
+        psz_lower_url[i] = tolower(psz_lower_url[i]);
+
+    satip_parse_pids(sys, psz_lower_url);
+    vlc_queue_Init(&sys->queue, offsetof (block_t, p_next));
+
+    vlc_UrlParse(&url, psz_lower_url);
+    if (url.i_port <= 0)
+        url.i_port = RTSP_DEFAULT_PORT;
+    if (psz_host == NULL && url.psz_host )
+        psz_host = strdup(url.psz_host);
+    if (psz_host == NULL )
+        goto error;
+
+    if (url.psz_host == NULL || url.psz_host[0] == '\0')
+    {
+        msg_Dbg(access, "malformed URL: %s", psz_lower_url);
+        goto error;
+    }
+
+    satip_session_t *s = NULL;
+    char *key = NULL;
+
+    if (var_InheritBool(access, "satip-share")) {
+        char *tuning = strdup(psz_lower_url);
+
+        if (unlikely(tuning == NULL))
+            goto error;
+        satip_strip_pids(tuning);
+
+        int val = asprintf(&key, "%s %d %d %s", psz_host, url.i_port,
+                           var_InheritBool(access, "satip-multicast"),
+                           tuning);
+        free(tuning);
+        if (val < 0)
+            goto error;
+
+        s = satip_session_find(key);
+        if (s != NULL) {
+            free(key);
+            msg_Dbg(access, "sharing RTSP session %s", s->session_id);
+            satip_attach(s, sys);
+            if (satip_update_pids(s, true)) {
+                satip_detach(s, sys);
+                satip_session_release(s);
+                goto error;
+            }
+        }
+    }
+
+    if (s == NULL) {
+        s = satip_session_open(access, sys, &url, psz_host, key);
+        if (s == NULL)
+            goto error;
+    }
+
     access->pf_control = satip_control;
     access->pf_block = satip_block;
 
     free(psz_host);
     free(psz_lower_url);
+    vlc_UrlClean(&url);
     return VLC_SUCCESS;
 
 error:
     free(psz_host);
     free(psz_lower_url);
     vlc_UrlClean(&url);
-
-    satip_teardown(access);
-
-    if (sys->udp_sock >= 0)
-        net_Close(sys->udp_sock);
-    if (sys->rtcp_sock >= 0)
-        net_Close(sys->rtcp_sock);
-    if (sys->tcp_sock >= 0)
-        net_Close(sys->tcp_sock);
-
-    free(sys->content_base);
-    free(sys->control);
     return VLC_EGENERIC;
 }
 
@@ -805,16 +1200,17 @@ static void satip_close(vlc_object_t *obj)
 {
     stream_t *access = (stream_t *)obj;
     access_sys_t *sys = access->p_sys;
+    satip_session_t *s = sys->session;
+
+    satip_detach(s, sys);
 
-    vlc_cancel(sys->thread);
-    vlc_join(sys->thread, NULL);
+    vlc_mutex_lock(&satip_sessions_lock);
+    bool last = s->refs == 1;
+    vlc_mutex_unlock(&satip_sessions_lock);
 
-    satip_teardown(access);
+    if (!last)
+        satip_update_pids(s, true);
+    satip_session_release(s);
 
     block_ChainRelease(vlc_queue_DequeueAll(&sys->queue));
-    net_Close(sys->udp_sock);
-    net_Close(sys->rtcp_sock);
-    net_Close(sys->tcp_sock);
-    free(sys->content_base);
-    free(sys->control);
 }
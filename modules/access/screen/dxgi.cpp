@@ -74,6 +74,33 @@ static block_t *screen_Capture(demux_t *p_demux)
     if( unlikely(d3d11_block == nullptr) )
         return nullptr;
 
+    DXGI_OUTDUPL_FRAME_INFO frameInfo;
+    HRESULT hr;
+    hr = p_data->duplication->AcquireNextFrame(0, &frameInfo, &resource);
+    if (hr == DXGI_ERROR_WAIT_TIMEOUT)
+    {
+        /* the desktop did not change since the last frame */
+        delete d3d11_block;
+        return nullptr;
+    }
+    if (FAILED(hr))
+    {
+        msg_Err(p_demux, "Failed to capture a frame. (hr=0x%lX)", hr);
+        delete d3d11_block;
+        return nullptr;
+    }
+#if defined(SCREEN_SUBSCREEN) && !defined(VLC_WINSTORE_APP)
+    if (frameInfo.LastPresentTime.QuadPart == 0 && !p_sys->b_follow_mouse)
+#else
+    if (frameInfo.LastPresentTime.QuadPart == 0)
+#endif
+    {
+        /* only the pointer moved, which is not captured */
+        p_data->duplication->ReleaseFrame();
+        delete d3d11_block;
+        return nullptr;
+    }
+
     d3d11_decoder_device_t *d3d_dev = GetD3D11OpaqueContext(p_data->vctx);
 
     static const struct vlc_frame_callbacks cbs = {
@@ -90,15 +117,6 @@ static block_t *screen_Capture(demux_t *p_demux)
         goto error;
     }
 
-    DXGI_OUTDUPL_FRAME_INFO frameInfo;
-    HRESULT hr;
-    hr = p_data->duplication->AcquireNextFrame(1000, &frameInfo, &resource);
-    if (FAILED(hr))
-    {
-        msg_Err(p_demux, "Failed to capture a frame. (hr=0x%lX)", hr);
-        goto error;
-    }
-
 #if defined(SCREEN_SUBSCREEN) && !defined(VLC_WINSTORE_APP)
     if( p_sys->b_follow_mouse )
     {
@@ -145,6 +163,7 @@ static block_t *screen_Capture(demux_t *p_demux)
 
     return &d3d11_block->self;
 error:
+    p_data->duplication->ReleaseFrame();
     if (d3d11_block->d3d11_pic)
         picture_Release(d3d11_block->d3d11_pic);
     delete d3d11_block;
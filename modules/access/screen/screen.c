@@ -282,6 +282,8 @@ static int Demux( demux_t *p_demux )
     p_block = p_sys->ops->capture( p_demux );
     if( !p_block )
     {
+        /* nothing (new) to capture: only keep the clock running */
+        es_out_SetPCR( p_demux->out, p_sys->i_next_date );
         p_sys->i_next_date += p_sys->i_incr;
         return 1;
     }
@@ -28,6 +28,9 @@
 #include <errno.h>
 #include <xcb/xcb.h>
 #include <xcb/composite.h>
+#ifdef HAVE_XCB_DAMAGE
+# include <xcb/damage.h>
+#endif
 #ifdef HAVE_SYS_SHM_H
 # include <sys/shm.h>
 # include <xcb/shm.h>
@@ -110,6 +113,11 @@ typedef struct
     xcb_pixmap_t      pixmap; /**< Pixmap for composited capture */
 #ifdef HAVE_SYS_SHM_H
     xcb_shm_seg_t     segment; /**< SHM segment XID */
+#endif
+#ifdef HAVE_XCB_DAMAGE
+    xcb_damage_damage_t damage; /**< Damage object XID, or 0 */
+    uint8_t           damage_event; /**< Damage notify event type */
+    bool              dirty; /**< Whether the content changed */
 #endif
     int16_t           x, y; /**< Requested capture top-left coordinates */
     uint16_t          w, h; /**< Requested capture pixel dimensions */
@@ -117,6 +125,7 @@ typedef struct
     bool              shm; /**< Whether to use MIT-SHM */
     bool              follow_mouse;
     uint16_t          cur_w, cur_h; /**< Actual capture pixel dimensions */
+    int               cur_x, cur_y; /**< Actual capture coordinates */
     /* Timer does not use this, only input thread: */
     vlc_timer_t       timer;
 } demux_sys_t;
@@ -137,6 +146,60 @@ static bool CheckSHM (xcb_connection_t *conn)
 #endif
 }
 
+#ifdef HAVE_XCB_DAMAGE
+/** Tracks content changes of the captured window with X DAMAGE */
+static void InitDamage (vlc_object_t *obj, demux_sys_t *sys)
+{
+    xcb_connection_t *conn = sys->conn;
+    const xcb_query_extension_reply_t *ext =
+        xcb_get_extension_data (conn, &xcb_damage_id);
+
+    sys->damage = 0;
+    sys->dirty = true;
+    if (ext == NULL || !ext->present)
+        return;
+
+    xcb_damage_query_version_reply_t *r =
+        xcb_damage_query_version_reply (conn,
+            xcb_damage_query_version (conn, 1, 1), NULL);
+    if (r == NULL)
+        return;
+    msg_Dbg (obj, "using DAMAGE extension v%"PRIu32".%"PRIu32,
+             r->major_version, r->minor_version);
+    free (r);
+
+    sys->damage = xcb_generate_id (conn);
+    sys->damage_event = ext->first_event + XCB_DAMAGE_NOTIFY;
+    xcb_damage_create (conn, sys->damage, sys->window,
+                       XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
+}
+
+/** Checks for and acknowledges content changes since the last capture */
+static bool CheckDamage (demux_sys_t *sys)
+{
+    xcb_connection_t *conn = sys->conn;
+    xcb_generic_event_t *ev;
+
+    if (sys->damage == 0)
+        return true;
+
+    while ((ev = xcb_poll_for_event (conn)) != NULL)
+    {
+        if ((ev->response_type & 0x7f) == sys->damage_event)
+            sys->dirty = true;
+        free (ev);
+    }
+
+    if (!sys->dirty)
+        return false;
+
+    /* Reset before capturing, so that later changes are reported again */
+    sys->dirty = false;
+    xcb_damage_subtract (conn, sys->damage, XCB_NONE, XCB_NONE);
+    return true;
+}
+#endif
+
 /**
  * Probes and initializes.
  */
@@ -246,6 +309,11 @@ static int Open (vlc_object_t *obj)
 
     p_sys->cur_w = 0;
     p_sys->cur_h = 0;
+    p_sys->cur_x = 0;
+    p_sys->cur_y = 0;
+#ifdef HAVE_XCB_DAMAGE
+    InitDamage (obj, p_sys);
+#endif
     p_sys->bpp = 0;
     p_sys->es = NULL;
     if (vlc_timer_create (&p_sys->timer, Demux, demux))
@@ -428,6 +496,9 @@ discard:
             sys->cur_h = h;
             sys->bpp /= 8; /* bits -> bytes */
         }
+#ifdef HAVE_XCB_DAMAGE
+        sys->dirty = true;
+#endif
     }
 
     /* Capture screen */
@@ -435,6 +506,19 @@ discard:
         (sys->window != geo->root) ? sys->pixmap : sys->window;
     free (geo);
 
+#ifdef HAVE_XCB_DAMAGE
+    if (x != sys->cur_x || y != sys->cur_y)
+        sys->dirty = true;
+    if (!CheckDamage (sys))
+    {   /* Unchanged content: skip the frame but keep the clock running */
+        if (sys->es != NULL)
+            es_out_SetPCR (demux->out, vlc_tick_now ());
+        return;
+    }
+#endif
+    sys->cur_x = x;
+    sys->cur_y = y;
+
     block_t *block = NULL;
 #ifdef HAVE_SYS_SHM_H
     if (sys->shm)
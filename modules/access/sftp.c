@@ -42,6 +42,8 @@
 #include <libssh2.h>
 #include <libssh2_sftp.h>
 
+#include "cache.h"
+
 
 /*****************************************************************************
  * Module descriptor
@@ -75,6 +77,8 @@ vlc_module_begin ()
     set_callbacks( Open, Close )
 vlc_module_end ()
 
+VLC_ACCESS_CACHE_REGISTER(sftp_cache);
+
 
 /*****************************************************************************
  * Local prototypes
@@ -85,6 +89,18 @@ static int      Control( stream_t *, int, va_list );
 
 static int DirRead( stream_t *, input_item_node_t * );
 
+/* libssh2 keeps as many READ requests in flight as fit in the buffer given
+ * to libssh2_sftp_read(), so read ahead for the wire latency. */
+#define SFTP_READ_AHEAD (2 << 20)
+
+/* Authenticated session, kept in the cache between accesses */
+struct sftp_conn
+{
+    int i_socket;
+    LIBSSH2_SESSION* ssh_session;
+    LIBSSH2_SFTP* sftp_session;
+};
+
 typedef struct
 {
     int i_socket;
@@ -93,8 +109,87 @@ typedef struct
     LIBSSH2_SFTP_HANDLE* file;
     uint64_t filesize;
     char *psz_base_url;
+    struct vlc_access_cache_entry *cache_entry;
+    bool b_error; /* the session cannot be reused */
+
+    uint8_t *p_buf; /* read ahead data */
+    size_t i_buf_pos, i_buf_len;
 } access_sys_t;
 
+static void SFtpConnFree( void *context )
+{
+    struct sftp_conn *conn = context;
+
+    if( conn->sftp_session )
+        libssh2_sftp_shutdown( conn->sftp_session );
+    if( conn->ssh_session )
+        libssh2_session_free( conn->ssh_session );
+    if( conn->i_socket >= 0 )
+        net_Close( conn->i_socket );
+    free( conn );
+}
+
+static char *SFtpCacheUrl( const char *psz_host, int i_port )
+{
+    char *psz_url;
+
+    if( asprintf( &psz_url, "sftp://%s:%d", psz_host, i_port ) == -1 )
+        return NULL;
+    return psz_url;
+}
+
+/* Takes a cached session to the same server for the same user, if any */
+static bool SFtpCacheGet( stream_t *p_access, const char *psz_host, int i_port,
+                          const char *psz_username )
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    char *psz_url = SFtpCacheUrl( psz_host, i_port );
+
+    if( psz_url == NULL || psz_username == NULL )
+    {
+        free( psz_url );
+        return false;
+    }
+
+    p_sys->cache_entry = vlc_access_cache_GetEntry( &sftp_cache, psz_url,
+                                                    psz_username );
+    free( psz_url );
+    if( p_sys->cache_entry == NULL )
+        return false;
+
+    struct sftp_conn *conn = p_sys->cache_entry->context;
+
+    p_sys->i_socket = conn->i_socket;
+    p_sys->ssh_session = conn->ssh_session;
+    p_sys->sftp_session = conn->sftp_session;
+    conn->i_socket = -1;
+    conn->ssh_session = NULL;
+    conn->sftp_session = NULL;
+    msg_Dbg( p_access, "re-using old ssh session" );
+    return true;
+}
+
+static void SFtpCacheNew( stream_t *p_access, const char *psz_host, int i_port,
+                          const char *psz_username )
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    struct sftp_conn *conn = malloc( sizeof( *conn ) );
+    char *psz_url = SFtpCacheUrl( psz_host, i_port );
+
+    if( conn != NULL && psz_url != NULL )
+    {
+        conn->i_socket = -1;
+        conn->ssh_session = NULL;
+        conn->sftp_session = NULL;
+        p_sys->cache_entry = vlc_access_cache_entry_New( conn, psz_url,
+                                                         psz_username,
+                                                         SFtpConnFree );
+    }
+    if( p_sys->cache_entry == NULL )
+        free( conn );
+    free( psz_url );
+}
+
 static int AuthKeyAgent( stream_t *p_access, const char *psz_username )
 {
     access_sys_t* p_sys = p_access->p_sys;
@@ -314,6 +409,16 @@ static int Open( vlc_object_t* p_this )
     else
         i_port = url.i_port;
 
+    /* Skip the handshake and authentication with a cached session */
+    char *psz_cache_user = url.psz_username != NULL
+                         ? strdup( url.psz_username )
+                         : var_InheritString( p_access, "sftp-user" );
+    bool b_cached = SFtpCacheGet( p_access, url.psz_host, i_port,
+                                  psz_cache_user );
+    free( psz_cache_user );
+    if( b_cached )
+        goto session_ready;
+
     /* Create the ssh connection and wait until the server answer */
     if( SSHSessionInit( p_access, url.psz_host, i_port ) != VLC_SUCCESS )
         goto error;
@@ -474,6 +579,11 @@ static int Open( vlc_object_t* p_this )
         goto error;
     }
 
+    SFtpCacheNew( p_access, url.psz_host, i_port, psz_session_username );
+
+session_ready:
+    ;
+
     /* No path, default to user Home */
     char *base_url_tmp;
     if( !psz_path )
@@ -576,10 +686,30 @@ static void Close( vlc_object_t* p_this )
 
     if( p_sys->file )
         libssh2_sftp_close_handle( p_sys->file );
+
+    if( p_sys->cache_entry != NULL )
+    {
+        struct sftp_conn *conn = p_sys->cache_entry->context;
+
+        /* Hand the session over to the cache for the next access */
+        conn->i_socket = p_sys->i_socket;
+        conn->ssh_session = p_sys->ssh_session;
+        conn->sftp_session = p_sys->sftp_session;
+        p_sys->i_socket = -1;
+        p_sys->ssh_session = NULL;
+        p_sys->sftp_session = NULL;
+
+        if( p_sys->b_error || conn->sftp_session == NULL )
+            vlc_access_cache_entry_Delete( p_sys->cache_entry );
+        else
+            vlc_access_cache_AddEntry( &sftp_cache, p_sys->cache_entry );
+    }
+
     if( p_sys->sftp_session )
         libssh2_sftp_shutdown( p_sys->sftp_session );
     SSHSessionDestroy( p_access );
 
+    free( p_sys->p_buf );
     free( p_sys->psz_base_url );
 }
 
@@ -588,14 +718,45 @@ static ssize_t Read( stream_t *p_access, void *buf, size_t len )
 {
     access_sys_t *p_sys = p_access->p_sys;
 
-    ssize_t val = libssh2_sftp_read(  p_sys->file, buf, len );
-    if( val < 0 )
+    if( p_sys->i_buf_pos == p_sys->i_buf_len )
     {
-        msg_Err( p_access, "read failed" );
-        return 0;
+        /* Large reads go straight to the caller buffer */
+        if( len >= SFTP_READ_AHEAD )
+        {
+            ssize_t val = libssh2_sftp_read( p_sys->file, buf, len );
+            if( val < 0 )
+            {
+                msg_Err( p_access, "read failed" );
+                p_sys->b_error = true;
+                return 0;
+            }
+            return val;
+        }
+
+        if( p_sys->p_buf == NULL )
+        {
+            p_sys->p_buf = malloc( SFTP_READ_AHEAD );
+            if( unlikely(p_sys->p_buf == NULL) )
+                return 0;
+        }
+
+        ssize_t val = libssh2_sftp_read( p_sys->file, (char *)p_sys->p_buf,
+                                         SFTP_READ_AHEAD );
+        if( val < 0 )
+        {
+            msg_Err( p_access, "read failed" );
+            p_sys->b_error = true;
+            return 0;
+        }
+        p_sys->i_buf_pos = 0;
+        p_sys->i_buf_len = val;
     }
 
-    return val;
+    if( len > p_sys->i_buf_len - p_sys->i_buf_pos )
+        len = p_sys->i_buf_len - p_sys->i_buf_pos;
+    memcpy( buf, p_sys->p_buf + p_sys->i_buf_pos, len );
+    p_sys->i_buf_pos += len;
+    return len;
 }
 
 
@@ -603,7 +764,8 @@ static int Seek( stream_t* p_access, uint64_t i_pos )
 {
     access_sys_t *sys = p_access->p_sys;
 
-    libssh2_sftp_seek( sys->file, i_pos );
+    sys->i_buf_pos = sys->i_buf_len = 0;
+    libssh2_sftp_seek64( sys->file, i_pos );
     return VLC_SUCCESS;
 }
 
@@ -104,21 +104,9 @@ vlc_module_end()
 
 VLC_ACCESS_CACHE_REGISTER(smb2_cache);
 
-struct access_sys
-{
-    struct smb2_context *   smb2;
-    struct smb2fh *         smb2fh;
-    struct smb2dir *        smb2dir;
-    struct srvsvc_netshareenumall_rep *share_enum;
-    uint64_t                smb2_size;
-    vlc_url_t               encoded_url;
-    bool                    eof;
-    bool                    smb2_connected;
-
-    int                     error_status;
-
-    struct vlc_access_cache_entry *cache_entry;
-};
+/* Maximum number of outstanding READ requests, enough to cover the
+ * bandwidth-delay product of a 30 ms WAN link at 250 MB/s */
+#define SMB2_READAHEAD_MAX 32
 
 struct vlc_smb2_op
 {
@@ -138,6 +126,39 @@ struct vlc_smb2_op
     } res;
 };
 
+struct vlc_smb2_read
+{
+    struct vlc_smb2_op      op;
+    uint64_t                offset;
+    size_t                  size; /**< requested bytes */
+    size_t                  pos; /**< bytes already returned */
+    uint8_t *               buf;
+};
+
+struct access_sys
+{
+    struct smb2_context *   smb2;
+    struct smb2fh *         smb2fh;
+    struct smb2dir *        smb2dir;
+    struct srvsvc_netshareenumall_rep *share_enum;
+    uint64_t                smb2_size;
+    vlc_url_t               encoded_url;
+    bool                    eof;
+    bool                    smb2_connected;
+
+    int                     error_status;
+
+    /* Ring of pipelined READ requests, from the current position */
+    struct vlc_smb2_read    reads[SMB2_READAHEAD_MAX];
+    unsigned                read_head;
+    unsigned                read_count;
+    unsigned                read_depth; /**< current readahead window */
+    size_t                  read_size; /**< size of each READ request */
+    uint64_t                read_offset; /**< offset of the next request */
+
+    struct vlc_access_cache_entry *cache_entry;
+};
+
 #define VLC_SMB2_OP(access, smb2_) { \
     .log = access ? vlc_object_logger(access) : NULL, \
     .smb2 = smb2_, \
@@ -299,40 +320,134 @@ smb2_read_cb(struct smb2_context *smb2, int status, void *data,
     op->res.read.len = status;
 }
 
-static ssize_t
-FileRead(stream_t *access, void *buf, size_t len)
+/* Queues READ requests up to the readahead window */
+static void
+FileReadAhead(stream_t *access)
 {
     struct access_sys *sys = access->p_sys;
 
-    if (sys->eof || sys->error_status != 0)
-        return 0;
+    while (sys->read_count < sys->read_depth)
+    {
+        /* Only the first request may go past the end of the file, in case
+         * the file grew since it was opened. */
+        if (sys->read_count > 0 && sys->read_offset >= sys->smb2_size)
+            break;
 
-    /* Limit the read size since smb2_read_async() will complete only after
-     * reading the whole requested data and not when whatever data is available
-     * (high read size means a faster I/O but a higher latency). */
-    if (len > 262144)
-        len = 262144;
+        struct vlc_smb2_read *rd = &sys->reads[(sys->read_head
+                                   + sys->read_count) % SMB2_READAHEAD_MAX];
 
-    struct vlc_smb2_op op = VLC_SMB2_OP(access, sys->smb2);
-    op.res.read.len = 0;
+        if (rd->buf == NULL)
+        {
+            rd->buf = malloc(sys->read_size);
+            if (unlikely(rd->buf == NULL))
+                break;
+        }
 
-    if (smb2_read_async(sys->smb2, sys->smb2fh, buf, len,
-                        smb2_read_cb, &op) < 0)
-    {
-        VLC_SMB2_SET_ERROR(&op, "smb2_read_async", 1);
-        return 0;
+        rd->op = (struct vlc_smb2_op) VLC_SMB2_OP(access, sys->smb2);
+        rd->op.res.read.len = 0;
+        rd->offset = sys->read_offset;
+        rd->size = sys->read_size;
+        rd->pos = 0;
+
+        if (smb2_pread_async(sys->smb2, sys->smb2fh, rd->buf, rd->size,
+                             rd->offset, smb2_read_cb, &rd->op) < 0)
+        {
+            VLC_SMB2_SET_ERROR(&rd->op, "smb2_pread_async", 1);
+            if (sys->read_count == 0)
+                sys->error_status = rd->op.error_status;
+            break;
+        }
+
+        sys->read_offset += rd->size;
+        sys->read_count++;
     }
+}
+
+/* Waits for the oldest READ request and drops it */
+static int
+FileReadPop(stream_t *access, bool teardown)
+{
+    struct access_sys *sys = access->p_sys;
+    struct vlc_smb2_read *rd = &sys->reads[sys->read_head];
+
+    assert(sys->read_count > 0);
+    if (!rd->op.res_done && rd->op.error_status == 0)
+        vlc_smb2_mainloop(&rd->op, teardown);
+
+    sys->read_head = (sys->read_head + 1) % SMB2_READAHEAD_MAX;
+    sys->read_count--;
+    return rd->op.res_done ? 0 : -1;
+}
+
+static int
+FileReadFlush(stream_t *access, bool teardown)
+{
+    struct access_sys *sys = access->p_sys;
+    int ret = 0;
+
+    while (sys->read_count > 0)
+        if (FileReadPop(access, teardown) != 0)
+            ret = -1;
+    return ret;
+}
+
+static ssize_t
+FileRead(stream_t *access, void *buf, size_t len)
+{
+    struct access_sys *sys = access->p_sys;
 
-    if (vlc_smb2_mainloop(&op, false) < 0)
+    for (;;)
     {
-        sys->error_status = op.error_status;
-        return 0;
-    }
+        if (sys->eof || sys->error_status != 0)
+            return 0;
+
+        FileReadAhead(access);
+        if (sys->read_count == 0)
+            return 0;
+
+        struct vlc_smb2_read *rd = &sys->reads[sys->read_head];
 
-    if (op.res.read.len == 0)
-        sys->eof = true;
+        if (!rd->op.res_done && rd->op.error_status == 0)
+        {
+            /* The requests in flight do not cover the round trip time:
+             * widen the window. */
+            if (sys->read_depth < SMB2_READAHEAD_MAX)
+                sys->read_depth++;
+            vlc_smb2_mainloop(&rd->op, false);
+        }
 
-    return op.res.read.len;
+        if (rd->op.error_status != 0)
+        {
+            sys->error_status = rd->op.error_status;
+            return 0;
+        }
+
+        size_t got = rd->op.res.read.len;
+
+        if (rd->pos < got)
+        {
+            if (len > got - rd->pos)
+                len = got - rd->pos;
+            memcpy(buf, rd->buf + rd->pos, len);
+            rd->pos += len;
+            if (rd->pos == rd->size)
+                FileReadPop(access, false);
+            return len;
+        }
+
+        /* End of file, or short read: the following requests do not start
+         * where the data ended. */
+        uint64_t next = rd->offset + rd->pos;
+        bool eof = got == 0 && rd->pos == 0;
+
+        if (FileReadFlush(access, false) != 0)
+        {
+            sys->error_status = -EIO;
+            return 0;
+        }
+        sys->read_offset = next;
+        sys->eof = eof;
+    }
 }
 
 static int
@@ -343,17 +458,33 @@ FileSeek(stream_t *access, uint64_t i_pos)
     if (sys->error_status != 0)
         return VLC_EGENERIC;
 
-    struct vlc_smb2_op op = VLC_SMB2_OP(access, sys->smb2);
+    sys->eof = false;
 
-    if (smb2_lseek(op.smb2, sys->smb2fh, i_pos, SEEK_SET, NULL) < 0)
+    /* Keep the requests from the new position, if any */
+    while (sys->read_count > 0)
     {
-        VLC_SMB2_SET_ERROR(&op, "smb2_seek_async", 1);
-        sys->error_status = op.error_status;
-        return VLC_EGENERIC;
+        struct vlc_smb2_read *rd = &sys->reads[sys->read_head];
+
+        if (i_pos >= rd->offset && i_pos - rd->offset < rd->size)
+        {
+            rd->pos = i_pos - rd->offset;
+            return VLC_SUCCESS;
+        }
+
+        if (i_pos < rd->offset)
+        {
+            if (FileReadFlush(access, false) != 0)
+                goto error;
+        }
+        else if (FileReadPop(access, false) != 0)
+            goto error;
     }
-    sys->eof = false;
 
+    sys->read_offset = i_pos;
     return VLC_SUCCESS;
+error:
+    sys->error_status = -EIO;
+    return VLC_EGENERIC;
 }
 
 static int
@@ -788,7 +919,7 @@ vlc_smb2_resolve(stream_t *access, const char *host, unsigned port)
     struct addrinfo *info = NULL;
     if (vlc_getaddrinfo_i11e(host, port, NULL, &info) == 0)
     {
-        freeaddrinfo(info);
+        vlc_freeaddrinfo(info);
         /* Let smb2 resolve it */
         return NULL;
     }
@@ -901,6 +1032,13 @@ Open(vlc_object_t *p_obj)
 
     if (sys->smb2fh != NULL)
     {
+        sys->read_size = smb2_get_max_read_size(sys->smb2);
+        /* Limit the request size since a READ completes only after reading
+         * the whole requested data (high read size means a faster I/O but a
+         * higher latency). Throughput comes from the pipelined requests. */
+        if (sys->read_size == 0 || sys->read_size > 262144)
+            sys->read_size = 262144;
+        sys->read_depth = 2;
         access->pf_read = FileRead;
         access->pf_seek = FileSeek;
         access->pf_control = FileControl;
@@ -941,9 +1079,16 @@ Close(vlc_object_t *p_obj)
 {
     stream_t *access = (stream_t *)p_obj;
     struct access_sys *sys = access->p_sys;
+    bool reusable = true;
 
     if (sys->smb2fh != NULL)
+    {
+        /* Pending READ requests point to our buffers: a session that could
+         * not complete them must not be reused. */
+        if (FileReadFlush(access, true) != 0)
+            reusable = false;
         vlc_smb2_close_fh(access, sys->smb2, sys->smb2fh);
+    }
     else if (sys->smb2dir != NULL)
         smb2_closedir(sys->smb2, sys->smb2dir);
     else if (sys->share_enum != NULL)
@@ -953,7 +1098,13 @@ Close(vlc_object_t *p_obj)
 
     assert(sys->smb2_connected);
 
-    vlc_access_cache_AddEntry(&smb2_cache, sys->cache_entry);
+    if (reusable)
+        vlc_access_cache_AddEntry(&smb2_cache, sys->cache_entry);
+    else
+        vlc_access_cache_entry_Delete(sys->cache_entry);
+
+    for (unsigned i = 0; i < SMB2_READAHEAD_MAX; i++)
+        free(sys->reads[i].buf);
 
     vlc_UrlClean(&sys->encoded_url);
 }
@@ -30,38 +30,314 @@
 
 #include <vlc_network.h>
 #include <vlc_url.h>
+#include <vlc_list.h>
+#include <vlc_block.h>
 
+#include <assert.h>
 
 
+
+/* Receive buffers large enough for the maximum number of chunks */
+#define SRT_POOL_BUFSIZE (SRT_MAX_CHUNKS_TRYREAD * SRT_LIVE_MAX_PLSIZE)
+#define SRT_POOL_MAX 4
+/* How often the shared poller checks that it was not stopped */
+#define SRT_POLLER_TIMEOUT_MS 100
+#define SRT_POLLER_EVENTS 64
+#define SRT_RECONNECT_DELAY VLC_TICK_FROM_SEC(1)
+
+#if SRT_VERSION_VALUE >= 0x010500
+# define SRT_HAVE_GROUPS 1
+# define SRT_MAX_LINKS 8
+#endif
+
+/** Recycled receive buffers, shared by the access and its blocks */
+struct srt_pool
+{
+    vlc_mutex_t lock;
+    unsigned refs; /**< Owner plus one per outstanding block */
+    unsigned count;
+    struct srt_block *free; /**< Recycled blocks */
+};
+
+struct srt_block
+{
+    block_t block;
+    struct srt_pool *pool;
+    struct srt_block *next;
+    uint8_t data[SRT_POOL_BUFSIZE];
+};
+
 typedef struct
 {
-    SRTSOCKET   sock;
-    int         i_poll_id;
+    SRTSOCKET   sock; /* socket or group, written with srt_poller_lock */
     vlc_mutex_t lock;
+    vlc_cond_t  wait;
     bool        b_interrupted;
+    bool        b_ready; /* data or state change pending */
     char       *psz_host;
     int         i_port;
     int         i_chunks; /* Number of chunks to allocate in the next read */
+    struct srt_pool *pool;
+    struct vlc_list node; /* in the shared poller */
+#ifdef SRT_HAVE_GROUPS
+    int         i_group_type; /* -1 without socket group */
+    unsigned    i_links;
+    struct
+    {
+        char *psz_host;
+        int   i_port;
+        SRT_SOCKGROUPCONFIG config;
+        bool  b_resolved;
+    } links[SRT_MAX_LINKS];
+    vlc_tick_t  group_check;
+#endif
 } stream_sys_t;
 
+/**
+ * All SRT inputs of the process share one epoll set and one thread waiting
+ * on it, rather than each input waiting on its own set. Sockets are
+ * edge-triggered: the poller only flags the input, which then reads until
+ * the library has no more data.
+ */
+struct srt_poller
+{
+    int eid;
+    unsigned refs;
+    bool stop;
+    vlc_thread_t thread;
+    struct vlc_list inputs;
+};
 
+static vlc_mutex_t srt_poller_lock = VLC_STATIC_MUTEX;
+static struct srt_poller *srt_poller; /* protected by srt_poller_lock */
 
-static void srt_wait_interrupted(void *p_data)
+static void srt_pool_release( struct srt_pool *pool )
 {
-    stream_t *p_stream = p_data;
-    stream_sys_t *p_sys = p_stream->p_sys;
+    vlc_mutex_lock( &pool->lock );
+    bool last = --pool->refs == 0;
+    vlc_mutex_unlock( &pool->lock );
+
+    if ( !last )
+        return;
+
+    while ( pool->free != NULL )
+    {
+        struct srt_block *sb = pool->free;
+
+        pool->free = sb->next;
+        free( sb );
+    }
+    free( pool );
+}
+
+static void srt_block_release( block_t *block )
+{
+    struct srt_block *sb = container_of( block, struct srt_block, block );
+    struct srt_pool *pool = sb->pool;
+
+    vlc_mutex_lock( &pool->lock );
+    if ( pool->count < SRT_POOL_MAX && pool->refs > 1 )
+    {
+        sb->next = pool->free;
+        pool->free = sb;
+        pool->count++;
+        sb = NULL;
+    }
+    vlc_mutex_unlock( &pool->lock );
+
+    free( sb );
+    srt_pool_release( pool );
+}
+
+static const struct vlc_block_callbacks srt_block_cbs =
+{
+    srt_block_release,
+};
+
+static block_t *srt_pool_get( struct srt_pool *pool, size_t size )
+{
+    assert( size <= SRT_POOL_BUFSIZE );
+
+    vlc_mutex_lock( &pool->lock );
+    struct srt_block *sb = pool->free;
+    if ( sb != NULL )
+    {
+        pool->free = sb->next;
+        pool->count--;
+    }
+    pool->refs++;
+    vlc_mutex_unlock( &pool->lock );
+
+    if ( sb == NULL )
+    {
+        sb = malloc( sizeof( *sb ) );
+        if ( unlikely( sb == NULL ) )
+        {
+            srt_pool_release( pool );
+            return NULL;
+        }
+        sb->pool = pool;
+    }
+    return block_Init( &sb->block, &srt_block_cbs, sb->data, size );
+}
+
+static struct srt_pool *srt_pool_create( void )
+{
+    struct srt_pool *pool = malloc( sizeof( *pool ) );
+
+    if ( likely( pool != NULL ) )
+    {
+        vlc_mutex_init( &pool->lock );
+        pool->refs = 1;
+        pool->count = 0;
+        pool->free = NULL;
+    }
+    return pool;
+}
 
+/* Must be called with srt_poller_lock held. */
+static void srt_wake_up( stream_sys_t *p_sys )
+{
     vlc_mutex_lock( &p_sys->lock );
-    if ( p_sys->i_poll_id >= 0 &&  p_sys->sock != SRT_INVALID_SOCK )
+    p_sys->b_ready = true;
+    vlc_cond_signal( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+static void *srt_poller_thread( void *data )
+{
+    struct srt_poller *poller = data;
+    SRT_EPOLL_EVENT events[SRT_POLLER_EVENTS];
+
+    for (;;)
+    {
+        int n = srt_epoll_uwait( poller->eid, events, SRT_POLLER_EVENTS,
+                                 SRT_POLLER_TIMEOUT_MS );
+
+        vlc_mutex_lock( &srt_poller_lock );
+        if ( poller->stop )
+        {
+            vlc_mutex_unlock( &srt_poller_lock );
+            break;
+        }
+
+        for ( int i = 0; i < n; i++ )
+        {
+            stream_sys_t *p_sys;
+
+            vlc_list_foreach( p_sys, &poller->inputs, node )
+                if ( p_sys->sock == events[i].fd )
+                {
+                    srt_wake_up( p_sys );
+                    break;
+                }
+        }
+        vlc_mutex_unlock( &srt_poller_lock );
+
+        if ( n < 0 ) /* should not happen with SRT_EPOLL_ENABLE_EMPTY */
+            vlc_tick_sleep( VLC_TICK_FROM_MS( SRT_POLLER_TIMEOUT_MS ) );
+    }
+    return NULL;
+}
+
+static struct srt_poller *srt_poller_get( stream_t *p_stream )
+{
+    stream_sys_t *p_sys = p_stream->p_sys;
+    struct srt_poller *poller;
+
+    vlc_mutex_lock( &srt_poller_lock );
+    poller = srt_poller;
+    if ( poller == NULL )
+    {
+        poller = malloc( sizeof( *poller ) );
+        if ( unlikely( poller == NULL ) )
+            goto out;
+
+        poller->eid = srt_epoll_create();
+        if ( poller->eid == -1 )
+        {
+            msg_Err( p_stream, "Failed to create poll id for SRT socket." );
+            free( poller );
+            poller = NULL;
+            goto out;
+        }
+
+        /* Wait for the timeout instead of failing when no sockets */
+        srt_epoll_set( poller->eid, SRT_EPOLL_ENABLE_EMPTY );
+        poller->refs = 0;
+        poller->stop = false;
+        vlc_list_init( &poller->inputs );
+
+        if ( vlc_clone( &poller->thread, srt_poller_thread, poller,
+                        VLC_THREAD_PRIORITY_INPUT ) )
+        {
+            srt_epoll_release( poller->eid );
+            free( poller );
+            poller = NULL;
+            goto out;
+        }
+        srt_poller = poller;
+    }
+
+    poller->refs++;
+    vlc_list_append( &p_sys->node, &poller->inputs );
+out:
+    vlc_mutex_unlock( &srt_poller_lock );
+    return poller;
+}
+
+static void srt_poller_release( stream_sys_t *p_sys )
+{
+    struct srt_poller *poller;
+
+    vlc_mutex_lock( &srt_poller_lock );
+    poller = srt_poller;
+    assert( poller != NULL );
+    vlc_list_remove( &p_sys->node );
+
+    if ( --poller->refs > 0 )
     {
-        p_sys->b_interrupted = true;
+        vlc_mutex_unlock( &srt_poller_lock );
+        return;
+    }
 
-        msg_Dbg( p_stream, "Waking up srt_epoll_wait");
+    srt_poller = NULL;
+    poller->stop = true;
+    vlc_mutex_unlock( &srt_poller_lock );
 
-        /* Removing all socket descriptors from the monitoring list
-         * wakes up SRT's threads. We only have one to remove. */
-        srt_epoll_remove_usock( p_sys->i_poll_id, p_sys->sock );
+    vlc_join( poller->thread, NULL );
+    srt_epoll_release( poller->eid );
+    free( poller );
+}
+
+/**
+ * Replaces the socket (or group) of the input, closing the previous one.
+ */
+static void srt_set_socket( stream_sys_t *p_sys, SRTSOCKET sock )
+{
+    vlc_mutex_lock( &srt_poller_lock );
+    if ( p_sys->sock != SRT_INVALID_SOCK )
+    {
+        srt_epoll_remove_usock( srt_poller->eid, p_sys->sock );
+        srt_close( p_sys->sock );
     }
+
+    p_sys->sock = sock;
+
+    if ( sock != SRT_INVALID_SOCK )
+        srt_epoll_add_usock( srt_poller->eid, sock,
+            &(int) { SRT_EPOLL_ERR | SRT_EPOLL_IN | SRT_EPOLL_ET } );
+    vlc_mutex_unlock( &srt_poller_lock );
+}
+
+static void srt_wait_interrupted(void *p_data)
+{
+    stream_t *p_stream = p_data;
+    stream_sys_t *p_sys = p_stream->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    p_sys->b_interrupted = true;
+    vlc_cond_signal( &p_sys->wait );
     vlc_mutex_unlock( &p_sys->lock );
 }
 
@@ -89,6 +365,102 @@ static int Control(stream_t *p_stream, int i_query, va_list args)
     return i_ret;
 }
 
+#ifdef SRT_HAVE_GROUPS
+static bool srt_same_addr( const struct sockaddr *a, const struct sockaddr *b )
+{
+    if ( a->sa_family != b->sa_family )
+        return false;
+
+    switch ( a->sa_family )
+    {
+        case AF_INET:
+        {
+            const struct sockaddr_in *a4 = (const struct sockaddr_in *)a;
+            const struct sockaddr_in *b4 = (const struct sockaddr_in *)b;
+
+            return a4->sin_port == b4->sin_port
+                && a4->sin_addr.s_addr == b4->sin_addr.s_addr;
+        }
+        case AF_INET6:
+        {
+            const struct sockaddr_in6 *a6 = (const struct sockaddr_in6 *)a;
+            const struct sockaddr_in6 *b6 = (const struct sockaddr_in6 *)b;
+
+            return a6->sin6_port == b6->sin6_port
+                && !memcmp( &a6->sin6_addr, &b6->sin6_addr,
+                            sizeof( a6->sin6_addr ) );
+        }
+    }
+    return false;
+}
+
+/** Connects one link of the socket group, resolving it if needed. */
+static void srt_group_connect( stream_t *p_stream, unsigned i )
+{
+    stream_sys_t *p_sys = p_stream->p_sys;
+
+    if ( !p_sys->links[i].b_resolved )
+    {
+        struct addrinfo hints = {
+            .ai_socktype = SOCK_DGRAM,
+        }, *res;
+
+        int stat = vlc_getaddrinfo( p_sys->links[i].psz_host,
+                                    p_sys->links[i].i_port, &hints, &res );
+        if ( stat )
+        {
+            msg_Err( p_stream, "Cannot resolve [%s]:%d (reason: %s)",
+                     p_sys->links[i].psz_host, p_sys->links[i].i_port,
+                     gai_strerror( stat ) );
+            return;
+        }
+
+        p_sys->links[i].config = srt_prepare_endpoint( NULL, res->ai_addr,
+                                                       res->ai_addrlen );
+        p_sys->links[i].b_resolved = true;
+        freeaddrinfo( res );
+    }
+
+    msg_Dbg( p_stream, "Schedule SRT group link connect (%s, port: %d).",
+             p_sys->links[i].psz_host, p_sys->links[i].i_port );
+
+    if ( srt_connect_group( p_sys->sock, &p_sys->links[i].config,
+                            1 ) == SRT_ERROR )
+        msg_Warn( p_stream, "Failed to connect group link %s (reason: %s)",
+                  p_sys->links[i].psz_host, srt_getlasterror_str() );
+}
+
+/**
+ * Reconnects the links that dropped out of the group. The other links keep
+ * the stream going meanwhile: this is what makes failover seamless.
+ */
+static void srt_group_refresh( stream_t *p_stream )
+{
+    stream_sys_t *p_sys = p_stream->p_sys;
+    SRT_SOCKGROUPDATA members[2 * SRT_MAX_LINKS];
+    size_t count = ARRAY_SIZE( members );
+
+    if ( srt_group_data( p_sys->sock, members, &count ) == SRT_ERROR )
+        return;
+
+    for ( unsigned i = 0; i < p_sys->i_links; i++ )
+    {
+        bool alive = false;
+
+        if ( p_sys->links[i].b_resolved )
+            for ( size_t j = 0; j < count && !alive; j++ )
+                alive = members[j].sockstate < SRTS_BROKEN
+                     && srt_same_addr(
+                            (const struct sockaddr *)&members[j].peeraddr,
+                            (const struct sockaddr *)
+                                &p_sys->links[i].config.peeraddr );
+
+        if ( !alive )
+            srt_group_connect( p_stream, i );
+    }
+}
+#endif
+
 static bool srt_schedule_reconnect(stream_t *p_stream)
 {
     vlc_object_t *strm_obj = (vlc_object_t *) p_stream;
@@ -105,33 +477,50 @@ static bool srt_schedule_reconnect(stream_t *p_stream)
     }, *res = NULL;
 
     stream_sys_t *p_sys = p_stream->p_sys;
+    SRTSOCKET sock;
     bool failed = false;
 
-    stat = vlc_getaddrinfo( p_sys->psz_host, p_sys->i_port, &hints, &res );
-    if ( stat )
+    /* Always start with a fresh socket */
+    srt_set_socket( p_sys, SRT_INVALID_SOCK );
+
+#ifdef SRT_HAVE_GROUPS
+    if ( p_sys->i_group_type >= 0 )
     {
-        msg_Err( p_stream, "Cannot resolve [%s]:%d (reason: %s)",
-                 p_sys->psz_host,
-                 p_sys->i_port,
-                 gai_strerror( stat ) );
+        for ( unsigned i = 0; i < p_sys->i_links; i++ )
+            p_sys->links[i].b_resolved = false;
 
-        failed = true;
-        goto out;
+        sock = srt_create_group( p_sys->i_group_type );
+        if ( sock == SRT_INVALID_SOCK )
+        {
+            msg_Err( p_stream, "Failed to create socket group (reason: %s)",
+                     srt_getlasterror_str() );
+            failed = true;
+            goto out;
+        }
     }
-
-    /* Always start with a fresh socket */
-    if (p_sys->sock != SRT_INVALID_SOCK)
+    else
+#endif
     {
-        srt_epoll_remove_usock( p_sys->i_poll_id, p_sys->sock );
-        srt_close( p_sys->sock );
-    }
+        stat = vlc_getaddrinfo( p_sys->psz_host, p_sys->i_port, &hints,
+                                &res );
+        if ( stat )
+        {
+            msg_Err( p_stream, "Cannot resolve [%s]:%d (reason: %s)",
+                     p_sys->psz_host,
+                     p_sys->i_port,
+                     gai_strerror( stat ) );
 
-    p_sys->sock = srt_socket( res->ai_family, SOCK_DGRAM, 0 );
-    if ( p_sys->sock == SRT_INVALID_SOCK )
-    {
-        msg_Err( p_stream, "Failed to open socket." );
-        failed = true;
-        goto out;
+            failed = true;
+            goto out;
+        }
+
+        sock = srt_socket( res->ai_family, SOCK_DGRAM, 0 );
+        if ( sock == SRT_INVALID_SOCK )
+        {
+            msg_Err( p_stream, "Failed to open socket." );
+            failed = true;
+            goto out;
+        }
     }
 
     if (p_stream->psz_url) {
@@ -153,52 +542,62 @@ static bool srt_schedule_reconnect(stream_t *p_stream)
     }
 
     /* Make SRT non-blocking */
-    srt_setsockopt( p_sys->sock, 0, SRTO_SNDSYN,
+    srt_setsockopt( sock, 0, SRTO_SNDSYN,
         &(bool) { false }, sizeof( bool ) );
-    srt_setsockopt( p_sys->sock, 0, SRTO_RCVSYN,
+    srt_setsockopt( sock, 0, SRTO_RCVSYN,
         &(bool) { false }, sizeof( bool ) );
 
     /* Make sure TSBPD mode is enable (SRT mode) */
-    srt_setsockopt( p_sys->sock, 0, SRTO_TSBPDMODE,
+    srt_setsockopt( sock, 0, SRTO_TSBPDMODE,
         &(int) { 1 }, sizeof( int ) );
 
     /* This is an access module so it is always a receiver */
-    srt_setsockopt( p_sys->sock, 0, SRTO_SENDER,
+    srt_setsockopt( sock, 0, SRTO_SENDER,
         &(int) { 0 }, sizeof( int ) );
 
     /* Set latency */
-    srt_set_socket_option( strm_obj, SRT_PARAM_LATENCY, p_sys->sock,
+    srt_set_socket_option( strm_obj, SRT_PARAM_LATENCY, sock,
             SRTO_LATENCY, &i_latency, sizeof(i_latency) );
 
     /* set passphrase */
     if (psz_passphrase != NULL && psz_passphrase[0] != '\0') {
         int i_key_length = var_InheritInteger( p_stream, SRT_PARAM_KEY_LENGTH );
 
-        srt_set_socket_option( strm_obj, SRT_PARAM_KEY_LENGTH, p_sys->sock,
+        srt_set_socket_option( strm_obj, SRT_PARAM_KEY_LENGTH, sock,
                 SRTO_PBKEYLEN, &i_key_length, sizeof(i_key_length) );
 
-        srt_set_socket_option( strm_obj, SRT_PARAM_PASSPHRASE, p_sys->sock,
+        srt_set_socket_option( strm_obj, SRT_PARAM_PASSPHRASE, sock,
                 SRTO_PASSPHRASE, psz_passphrase, strlen(psz_passphrase) );
     }
 
     /* set stream id */
     if (psz_streamid != NULL && psz_streamid[0] != '\0') {
-        srt_set_socket_option( strm_obj, SRT_PARAM_STREAMID, p_sys->sock,
+        srt_set_socket_option( strm_obj, SRT_PARAM_STREAMID, sock,
                 SRTO_STREAMID, psz_streamid, strlen(psz_streamid) );
     }
 
-    srt_epoll_add_usock( p_sys->i_poll_id, p_sys->sock,
-        &(int) { SRT_EPOLL_ERR | SRT_EPOLL_IN });
+    srt_set_socket( p_sys, sock );
 
-    /* Schedule a connect */
-    msg_Dbg( p_stream, "Schedule SRT connect (dest address: %s, port: %d).",
-        p_sys->psz_host, p_sys->i_port);
-
-    stat = srt_connect( p_sys->sock, res->ai_addr, res->ai_addrlen );
-    if (stat == SRT_ERROR) {
-        msg_Err( p_stream, "Failed to connect to server (reason: %s)",
-                srt_getlasterror_str() );
-        failed = true;
+#ifdef SRT_HAVE_GROUPS
+    if ( p_sys->i_group_type >= 0 )
+    {
+        for ( unsigned i = 0; i < p_sys->i_links; i++ )
+            srt_group_connect( p_stream, i );
+        p_sys->group_check = vlc_tick_now() + SRT_RECONNECT_DELAY;
+    }
+    else
+#endif
+    {
+        /* Schedule a connect */
+        msg_Dbg( p_stream, "Schedule SRT connect (dest address: %s, port: %d).",
+            p_sys->psz_host, p_sys->i_port);
+
+        stat = srt_connect( sock, res->ai_addr, res->ai_addrlen );
+        if (stat == SRT_ERROR) {
+            msg_Err( p_stream, "Failed to connect to server (reason: %s)",
+                    srt_getlasterror_str() );
+            failed = true;
+        }
     }
 
     /* Reset the number of chunks to allocate as the bitrate of
@@ -207,61 +606,182 @@ static bool srt_schedule_reconnect(stream_t *p_stream)
     p_sys->i_chunks = SRT_MIN_CHUNKS_TRYREAD;
 
 out:
-    if (failed && p_sys->sock != SRT_INVALID_SOCK)
-    {
-        srt_epoll_remove_usock( p_sys->i_poll_id, p_sys->sock );
-        srt_close(p_sys->sock);
-        p_sys->sock = SRT_INVALID_SOCK;
-    }
+    if (failed)
+        srt_set_socket( p_sys, SRT_INVALID_SOCK );
 
     if (passphrase_needs_free)
         free( psz_passphrase );
     if (streamid_needs_free)
 	free( psz_streamid );
-    freeaddrinfo( res );
+    if (res != NULL)
+        freeaddrinfo( res );
     free( url );
 
     return !failed;
 }
 
-static block_t *BlockSRT(stream_t *p_stream, bool *restrict eof)
+/**
+ * Waits until the poller flags the socket, or the deadline.
+ *
+ * @return false if interrupted or timed out
+ */
+static bool srt_wait( stream_sys_t *p_sys, vlc_tick_t deadline )
 {
-    stream_sys_t *p_sys = p_stream->p_sys;
-    int i_poll_timeout = var_InheritInteger( p_stream, SRT_PARAM_POLL_TIMEOUT );
-    /* SRT doesn't have a concept of EOF for live streams. */
-    VLC_UNUSED(eof);
+    bool ready;
 
-    if ( vlc_killed() )
+    vlc_mutex_lock( &p_sys->lock );
+    while ( !p_sys->b_ready && !p_sys->b_interrupted )
     {
-        /* We are told to stop. Stop. */
-        return NULL;
+        if ( deadline == VLC_TICK_INVALID )
+            vlc_cond_wait( &p_sys->wait, &p_sys->lock );
+        else if ( vlc_cond_timedwait( &p_sys->wait, &p_sys->lock, deadline ) )
+            break;
     }
+    ready = p_sys->b_ready && !p_sys->b_interrupted;
+    /* Clear before reading, not to miss an edge during the read */
+    p_sys->b_ready = false;
+    vlc_mutex_unlock( &p_sys->lock );
+    return ready;
+}
+
+static bool srt_interrupted( stream_sys_t *p_sys )
+{
+    vlc_mutex_lock( &p_sys->lock );
+    bool interrupted = p_sys->b_interrupted;
+    vlc_mutex_unlock( &p_sys->lock );
+    return interrupted;
+}
+
+static block_t *srt_read( stream_t *p_stream )
+{
+    stream_sys_t *p_sys = p_stream->p_sys;
 
     if ( p_sys->i_chunks == 0 )
         p_sys->i_chunks = SRT_MIN_CHUNKS_TRYREAD;
 
     const size_t i_chunk_size = SRT_LIVE_MAX_PLSIZE;
     const size_t bufsize = i_chunk_size * p_sys->i_chunks;
-    block_t *pkt = block_Alloc( bufsize );
+    block_t *pkt = srt_pool_get( p_sys->pool, bufsize );
     if ( unlikely( pkt == NULL ) )
     {
         return NULL;
     }
 
+    /* Try to get as much data as possible out of the lib, if there
+     * is still some left, increase the number of chunks to read so that
+     * it will read faster on the next iteration. This way the buffer will
+     * grow until it reads fast enough to keep the library empty after
+     * each iteration.
+     */
+    pkt->i_buffer = 0;
+    while ( ( bufsize - pkt->i_buffer ) >= i_chunk_size )
+    {
+        int stat = srt_recvmsg( p_sys->sock,
+            (char *)( pkt->p_buffer + pkt->i_buffer ),
+            bufsize - pkt->i_buffer );
+        if ( stat <= 0 )
+        {
+            break;
+        }
+        pkt->i_buffer += (size_t)stat;
+    }
+
+    /* Gradually adjust number of chunks we read at a time
+    * up to a predefined maximum. The actual number we might
+    * settle on depends on stream's bit rate.
+    */
+    size_t rem = bufsize - pkt->i_buffer;
+    if ( rem < i_chunk_size )
+    {
+        if ( p_sys->i_chunks < SRT_MAX_CHUNKS_TRYREAD )
+        {
+            p_sys->i_chunks++;
+        }
+
+        /* The library was not drained: there will be no new edge. */
+        vlc_mutex_lock( &p_sys->lock );
+        p_sys->b_ready = true;
+        vlc_mutex_unlock( &p_sys->lock );
+    }
+
+    if (pkt->i_buffer == 0) {
+      block_Release(pkt);
+      pkt = NULL;
+    }
+    return pkt;
+}
+
+static block_t *BlockSRT(stream_t *p_stream, bool *restrict eof)
+{
+    stream_sys_t *p_sys = p_stream->p_sys;
+    int i_poll_timeout = var_InheritInteger( p_stream, SRT_PARAM_POLL_TIMEOUT );
+    vlc_tick_t deadline = VLC_TICK_INVALID;
+    block_t *pkt = NULL;
+    /* SRT doesn't have a concept of EOF for live streams. */
+    VLC_UNUSED(eof);
+
+    if ( vlc_killed() )
+    {
+        /* We are told to stop. Stop. */
+        return NULL;
+    }
+
+    if ( i_poll_timeout >= 0 )
+        deadline = vlc_tick_now() + VLC_TICK_FROM_MS( i_poll_timeout );
+
     vlc_interrupt_register( srt_wait_interrupted, p_stream);
 
-    SRTSOCKET ready[1];
-    int readycnt = 1;
-    while ( srt_epoll_wait( p_sys->i_poll_id,
-        ready, &readycnt, 0, 0,
-        i_poll_timeout, NULL, 0, NULL, 0 ) >= 0)
+    while ( pkt == NULL )
     {
-        if ( readycnt < 0  || ready[0] != p_sys->sock )
+        if ( p_sys->sock == SRT_INVALID_SOCK )
+        {   /* Previous connection attempt failed: retry later */
+            vlc_tick_t retry = vlc_tick_now() + SRT_RECONNECT_DELAY;
+
+            if ( deadline != VLC_TICK_INVALID && deadline < retry )
+                retry = deadline;
+            if ( srt_wait( p_sys, retry ) )
+                continue;
+
+            if ( srt_interrupted( p_sys ) || retry == deadline )
+                break;
+
+            if ( !srt_schedule_reconnect( p_stream ) )
+                msg_Err( p_stream, "Failed to schedule connect" );
+            continue;
+        }
+
+#ifdef SRT_HAVE_GROUPS
+        if ( p_sys->i_group_type >= 0 )
         {
-            /* should never happen, force recovery */
-            srt_close(p_sys->sock);
-            p_sys->sock = SRT_INVALID_SOCK;
+            /* A group does not break as a whole: revive its links */
+            vlc_tick_t now = vlc_tick_now();
+
+            if ( now >= p_sys->group_check )
+            {
+                srt_group_refresh( p_stream );
+                p_sys->group_check = now + SRT_RECONNECT_DELAY;
+            }
+
+            vlc_tick_t wake = p_sys->group_check;
+            if ( deadline != VLC_TICK_INVALID && deadline < wake )
+                wake = deadline;
+            if ( !srt_wait( p_sys, wake ) )
+            {
+                if ( srt_interrupted( p_sys ) || wake == deadline )
+                    break;
+                continue;
+            }
+
+            pkt = srt_read( p_stream );
+            continue;
         }
+#endif
+
+        /* if the wait fails for any reason at all,
+         * including a timeout, we skip the turn.
+         */
+        if ( !srt_wait( p_sys, deadline ) )
+            break;
 
         switch( srt_getsockstate( p_sys->sock ) )
         {
@@ -280,73 +800,91 @@ static block_t *BlockSRT(stream_t *p_stream, bool *restrict eof)
                 continue;
         }
 
-        /* Try to get as much data as possible out of the lib, if there
-         * is still some left, increase the number of chunks to read so that
-         * it will read faster on the next iteration. This way the buffer will
-         * grow until it reads fast enough to keep the library empty after
-         * each iteration.
-         */
-        pkt->i_buffer = 0;
-        while ( ( bufsize - pkt->i_buffer ) >= i_chunk_size )
-        {
-            int stat = srt_recvmsg( p_sys->sock,
-                (char *)( pkt->p_buffer + pkt->i_buffer ),
-                bufsize - pkt->i_buffer );
-            if ( stat <= 0 )
-            {
-                break;
-            }
-            pkt->i_buffer += (size_t)stat;
-        }
+        pkt = srt_read( p_stream );
+    }
 
-#if 0
-        msg_Dbg ( p_stream, "Read %zu bytes out of a max of %zu"
-            " (%d chunks of %zu bytes)", pkt->i_buffer,
-            p_sys->i_chunks * i_chunk_size, p_sys->i_chunks,
-                i_chunk_size );
-#endif
+    vlc_interrupt_unregister();
 
-        /* Gradually adjust number of chunks we read at a time
-        * up to a predefined maximum. The actual number we might
-        * settle on depends on stream's bit rate.
-        */
-        size_t rem = bufsize - pkt->i_buffer;
-        if ( rem < i_chunk_size )
-        {
-            if ( p_sys->i_chunks < SRT_MAX_CHUNKS_TRYREAD )
-            {
-                p_sys->i_chunks++;
-            }
-        }
+    vlc_mutex_lock( &p_sys->lock );
+    p_sys->b_interrupted = false;
+    vlc_mutex_unlock( &p_sys->lock );
 
-        goto out;
-    }
+    return pkt;
+}
 
-    /* if the poll reports errors for any reason at all,
-     * including a timeout, we skip the turn.
-     */
-    pkt->i_buffer = 0;
+#ifdef SRT_HAVE_GROUPS
+static int srt_parse_group( stream_t *p_stream )
+{
+    stream_sys_t *p_sys = p_stream->p_sys;
+    char *psz_type = var_InheritString( p_stream, SRT_PARAM_GROUP );
 
-out:
-    if (pkt->i_buffer == 0) {
-      block_Release(pkt);
-      pkt = NULL;
+    p_sys->i_group_type = -1;
+    p_sys->links[0].psz_host = p_sys->psz_host;
+    p_sys->links[0].i_port = p_sys->i_port;
+    p_sys->i_links = 1;
+
+    if ( psz_type == NULL || psz_type[0] == '\0' )
+    {
+        free( psz_type );
+        return VLC_SUCCESS;
     }
 
-    vlc_interrupt_unregister();
+    if ( !strcmp( psz_type, "broadcast" ) )
+        p_sys->i_group_type = SRT_GTYPE_BROADCAST;
+    else if ( !strcmp( psz_type, "backup" ) )
+        p_sys->i_group_type = SRT_GTYPE_BACKUP;
+    else
+    {
+        msg_Err( p_stream, "Unknown SRT socket group type %s", psz_type );
+        free( psz_type );
+        return VLC_EGENERIC;
+    }
+    free( psz_type );
 
-    /* Re-add the socket to the poll if we were interrupted */
-    vlc_mutex_lock( &p_sys->lock );
-    if ( p_sys->b_interrupted )
+    char *psz_links = var_InheritString( p_stream, SRT_PARAM_GROUP_LINKS );
+    char *saveptr;
+
+    for ( char *psz_link = strtok_r( psz_links, ",", &saveptr );
+          psz_link != NULL; psz_link = strtok_r( NULL, ",", &saveptr ) )
     {
-        srt_epoll_add_usock( p_sys->i_poll_id, p_sys->sock,
-            &(int) { SRT_EPOLL_ERR | SRT_EPOLL_IN } );
-        p_sys->b_interrupted = false;
+        vlc_url_t url;
+
+        if ( p_sys->i_links >= SRT_MAX_LINKS )
+        {
+            msg_Warn( p_stream, "Too many SRT group links" );
+            break;
+        }
+
+        /* host:port, with brackets for IPv6 literals */
+        char *psz_url;
+        if ( asprintf( &psz_url, "srt://%s", psz_link ) == -1 )
+            break;
+
+        if ( vlc_UrlParse( &url, psz_url ) == 0 && url.psz_host != NULL )
+        {
+            unsigned i = p_sys->i_links++;
+
+            p_sys->links[i].psz_host = vlc_obj_strdup( VLC_OBJECT(p_stream),
+                                                       url.psz_host );
+            p_sys->links[i].i_port = url.i_port ? (int)url.i_port
+                                                : p_sys->i_port;
+            if ( unlikely( p_sys->links[i].psz_host == NULL ) )
+                p_sys->i_links--;
+        }
+        else
+            msg_Warn( p_stream, "Invalid SRT group link %s", psz_link );
+
+        vlc_UrlClean( &url );
+        free( psz_url );
     }
-    vlc_mutex_unlock( &p_sys->lock );
+    free( psz_links );
 
-    return pkt;
+    msg_Dbg( p_stream, "SRT %s group with %u links",
+             p_sys->i_group_type == SRT_GTYPE_BACKUP ? "backup" : "broadcast",
+             p_sys->i_links );
+    return VLC_SUCCESS;
 }
+#endif
 
 static int Open(vlc_object_t *p_this)
 {
@@ -361,6 +899,8 @@ static int Open(vlc_object_t *p_this)
     srt_startup();
 
     vlc_mutex_init( &p_sys->lock );
+    vlc_cond_init( &p_sys->wait );
+    p_sys->sock = SRT_INVALID_SOCK;
 
     p_stream->p_sys = p_sys;
 
@@ -376,18 +916,27 @@ static int Open(vlc_object_t *p_this)
 
     vlc_UrlClean( &parsed_url );
 
-    p_sys->i_poll_id = srt_epoll_create();
-    if ( p_sys->i_poll_id == -1 )
+#ifdef SRT_HAVE_GROUPS
+    if ( srt_parse_group( p_stream ) )
+        goto failed;
+#endif
+
+    p_sys->pool = srt_pool_create();
+    if ( unlikely( p_sys->pool == NULL ) )
+        goto failed;
+
+    if ( srt_poller_get( p_stream ) == NULL )
     {
-        msg_Err( p_stream, "Failed to create poll id for SRT socket." );
+        srt_pool_release( p_sys->pool );
         goto failed;
     }
-    p_sys->sock = SRT_INVALID_SOCK;
 
     if ( !srt_schedule_reconnect( p_stream ) )
     {
         msg_Err( p_stream, "Failed to schedule connect");
 
+        srt_poller_release( p_sys );
+        srt_pool_release( p_sys->pool );
         goto failed;
     }
 
@@ -397,8 +946,6 @@ static int Open(vlc_object_t *p_this)
     return VLC_SUCCESS;
 
 failed:
-    if ( p_sys->sock != SRT_INVALID_SOCK ) srt_close( p_sys->sock );
-    if ( p_sys->i_poll_id != -1 ) srt_epoll_release( p_sys->i_poll_id );
     srt_cleanup();
 
     return VLC_EGENERIC;
@@ -409,13 +956,18 @@ static void Close(vlc_object_t *p_this)
     stream_t     *p_stream = (stream_t*)p_this;
     stream_sys_t *p_sys = p_stream->p_sys;
 
-    srt_epoll_remove_usock( p_sys->i_poll_id, p_sys->sock );
-    srt_close( p_sys->sock );
-    srt_epoll_release( p_sys->i_poll_id );
+    srt_set_socket( p_sys, SRT_INVALID_SOCK );
+    srt_poller_release( p_sys );
+    srt_pool_release( p_sys->pool );
 
     srt_cleanup();
 }
 
+static const char *const srt_group_types[] = { "", "broadcast", "backup" };
+static const char *const srt_group_type_names[] = {
+    N_( "None" ), N_( "Broadcast" ), N_( "Main/backup" ),
+};
+
 /* Module descriptor */
 vlc_module_begin ()
     set_shortname( N_( "SRT" ) )
@@ -437,6 +989,15 @@ vlc_module_begin ()
     add_string(SRT_PARAM_STREAMID, "",
             N_(" SRT Stream ID"), NULL)
     change_safe()
+    add_string( SRT_PARAM_GROUP, "", N_( "SRT socket group" ),
+            N_( "Receive through a group of SRT connections (requires "
+                "libsrt with bonding): \"broadcast\" receives the same "
+                "stream over all links, \"backup\" switches to another "
+                "link when the active one fails." ) )
+    change_string_list( srt_group_types, srt_group_type_names )
+    add_string( SRT_PARAM_GROUP_LINKS, "", N_( "SRT group links" ),
+            N_( "Comma-separated host:port of the other group members, "
+                "in addition to the source address." ) )
 
     set_capability("access", 0)
     add_shortcut("srt")
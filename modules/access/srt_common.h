@@ -40,6 +40,8 @@
 #define SRT_PARAM_POLL_TIMEOUT                "poll-timeout"
 #define SRT_PARAM_KEY_LENGTH                  "key-length"
 #define SRT_PARAM_STREAMID                    "streamid"
+#define SRT_PARAM_GROUP                       "srt-group"
+#define SRT_PARAM_GROUP_LINKS                 "srt-group-links"
 
 
 #define SRT_DEFAULT_BANDWIDTH_OVERHEAD_LIMIT 25
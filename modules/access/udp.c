@@ -35,6 +35,8 @@
 # include "config.h"
 #endif
 
+#include <errno.h>
+
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_access.h>
@@ -47,6 +49,13 @@
 #ifdef HAVE_SYS_UIO_H
 # include <sys/uio.h>
 #endif
+#ifdef __linux__
+# include <netinet/in.h>
+# include <netinet/udp.h>
+#endif
+#ifdef HAVE_LINUX_IO_URING
+# include "udp_uring.h"
+#endif
 
 /* Buffer can be max theoretical datagram content minus anticipated MTU.
  * IPv6 headers are larger than IPv4, ignore IPv6 jumbograms.
@@ -56,6 +65,10 @@
 typedef struct {
     int fd;
     int timeout;
+#ifdef HAVE_LINUX_IO_URING
+    uring_recv_t *uring;
+    block_t *pending; /* received through io_uring before falling back */
+#endif
 
     size_t length;
     char *offset;
@@ -83,20 +96,29 @@ static int Control(stream_t *access, int query, va_list args)
     return VLC_SUCCESS;
 }
 
-static ssize_t Read(stream_t *access, void *buf, size_t len)
+/**
+ * Lets the kernel coalesce consecutive datagrams from the same source.
+ * The access is a byte stream, so boundaries do not matter, and one system
+ * call then returns up to 64 KiB (the overflow goes to the internal buffer).
+ */
+static void EnableGRO(stream_t *access, int fd)
 {
-    access_sys_t *sys = access->p_sys;
-
-    if (sys->length > 0) {
-        if (len > sys->length)
-            len = sys->length;
-
-        memcpy(buf, sys->offset, len);
-        sys->offset += len;
-        sys->length -= len;
-        return len;
-    }
+#ifdef UDP_GRO
+    if (setsockopt(fd, IPPROTO_UDP, UDP_GRO, &(int){ 1 }, sizeof (int)) == 0)
+        msg_Dbg(access, "receiving coalesced datagrams");
+#else
+    VLC_UNUSED(access); VLC_UNUSED(fd);
+#endif
+}
 
+/**
+ * Waits for data on the socket (interruptible).
+ *
+ * \return 1 if data is ready, 0 on time-out, -1 if interrupted
+ */
+static int Wait(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
     struct pollfd ufd[1];
 
     ufd[0].fd = sys->fd;
@@ -109,6 +131,26 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
         case -1:
             return -1;
     }
+    return 1;
+}
+
+static ssize_t Read(stream_t *access, void *buf, size_t len)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->length > 0) {
+        if (len > sys->length)
+            len = sys->length;
+
+        memcpy(buf, sys->offset, len);
+        sys->offset += len;
+        sys->length -= len;
+        return len;
+    }
+
+    int val = Wait(access);
+    if (val <= 0)
+        return val;
 
     struct iovec iov[] = {
         { .iov_base = buf,      .iov_len = len, },
@@ -118,20 +160,68 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
         .msg_iov = iov,
         .msg_iovlen = ARRAY_SIZE(iov),
     };
-    ssize_t val = recvmsg(sys->fd, &msg, 0);
+    ssize_t len_read = recvmsg(sys->fd, &msg, 0);
 
-    if (val <= 0) /* empty (0 bytes) payload does *not* mean EOF here */
+    if (len_read <= 0) /* empty (0 bytes) payload does *not* mean EOF here */
         return -1;
 
-    if (unlikely((size_t)val > len)) {
+    if (unlikely((size_t)len_read > len)) {
         sys->offset = sys->buf;
-        sys->length = val - len;
-        val = len;
+        sys->length = len_read - len;
+        len_read = len;
     }
 
-    return val;
+    return len_read;
 }
 
+#ifdef HAVE_LINUX_IO_URING
+static block_t *BlockUring(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->uring != NULL) {
+        errno = 0;
+        block_t *block = UringRecvBlock(sys->uring, eof);
+
+        if (block != NULL || (errno != EMSGSIZE && errno != EOPNOTSUPP))
+            return block;
+
+        msg_Dbg(access, "falling back to plain receive");
+        sys->pending = UringRecvClose(sys->uring);
+        sys->uring = NULL;
+        EnableGRO(access, sys->fd);
+    }
+
+    /* Deliver what was already received first */
+    if (sys->pending != NULL) {
+        block_t *block = sys->pending;
+
+        sys->pending = block->p_next;
+        block->p_next = NULL;
+        return block;
+    }
+
+    switch (Wait(access)) {
+        case 0:
+            *eof = true;
+            /* fall through */
+        case -1:
+            return NULL;
+    }
+
+    /* The datagram is received in the internal buffer, and then copied to a
+     * block of its actual size, rather than pinning a 64 KiB block each. */
+    ssize_t val = recv(sys->fd, sys->buf, MRU, 0);
+    if (val <= 0)
+        return NULL;
+
+    block_t *block = block_Alloc(val);
+    if (likely(block != NULL))
+        memcpy(block->p_buffer, sys->buf, val);
+    return block;
+}
+#endif
+
 /*****************************************************************************
  * Open: open the socket
  *****************************************************************************/
@@ -217,6 +307,22 @@ static int Open( vlc_object_t *p_this )
     if( sys->timeout > 0)
         sys->timeout *= 1000;
 
+#ifdef HAVE_LINUX_IO_URING
+    /* The shared ring cannot time out individual sockets */
+    sys->uring = NULL;
+    sys->pending = NULL;
+    if( sys->timeout < 0 )
+        sys->uring = UringRecvOpen( p_this, sys->fd );
+    if( sys->uring != NULL )
+    {
+        msg_Dbg( p_access, "receiving with io_uring" );
+        p_access->pf_read = NULL;
+        p_access->pf_block = BlockUring;
+    }
+    else
+#endif
+        EnableGRO( p_access, sys->fd );
+
     return VLC_SUCCESS;
 }
 
@@ -228,6 +334,11 @@ static void Close( vlc_object_t *p_this )
     stream_t     *p_access = (stream_t*)p_this;
     access_sys_t *sys = p_access->p_sys;
 
+#ifdef HAVE_LINUX_IO_URING
+    if( sys->uring != NULL )
+        block_ChainRelease( UringRecvClose( sys->uring ) );
+    block_ChainRelease( sys->pending );
+#endif
     net_Close( sys->fd );
 }
 
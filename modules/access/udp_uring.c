@@ -0,0 +1,671 @@
+/*****************************************************************************
+ * udp_uring.c: io_uring UDP receiver
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * All UDP inputs of the process share a single io_uring instance and a single
+ * completion thread. Each socket has one multi-shot receive request pending,
+ * and its own ring of provided buffers: the kernel picks a buffer for each
+ * datagram, and the datagram is handed over as a block wrapping that buffer.
+ * The buffer goes back to the kernel when the block is released. Thus
+ * receiving does not take any system call, nor any copy, in steady state.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_interrupt.h>
+
+#include "udp_uring.h"
+
+#define URING_SQ_ENTRIES  64      /* submissions are flushed immediately */
+#define URING_CQ_ENTRIES  4096    /* completions of all sockets */
+#define URING_MAX_GROUPS  1024    /* sockets per process */
+#define URING_BUFFERS     512     /* per socket, power of two */
+#define URING_BUFFER_SIZE 2048    /* fits any datagram with an Ethernet MTU */
+
+/* Once fewer buffers than this are left to the kernel, datagrams are copied
+ * instead, so that a slow consumer cannot starve the socket. */
+#define URING_LOW_BUFFERS (URING_BUFFERS / 4)
+
+#define URING_QUIT   UINT64_C(0) /* user data of the NOP stopping the thread */
+#define URING_CANCEL UINT64_C(1) /* tag of cancellation requests */
+
+struct uring
+{
+    int fd;
+    unsigned users;
+    vlc_thread_t thread;
+
+    void *rings;
+    size_t rings_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    atomic_uint *sq_head;
+    atomic_uint *sq_tail;
+    unsigned *sq_array;
+    unsigned sq_entries;
+    unsigned sq_mask;
+
+    atomic_uint *cq_head;
+    atomic_uint *cq_tail;
+    struct io_uring_cqe *cqes;
+    unsigned cq_mask;
+
+    uint64_t groups[URING_MAX_GROUPS / 64]; /**< Buffer group IDs in use */
+};
+
+struct uring_recv
+{
+    vlc_object_t *obj;
+    struct uring *ring;
+    int fd;
+    uint16_t bgid;
+    atomic_uint refs; /**< Owner plus one per outstanding block */
+    uint8_t *buffers;
+    struct io_uring_buf_ring *br;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    uint16_t br_tail;
+    unsigned avail; /**< Buffers owned by the kernel */
+    bool armed; /**< Multi-shot receive pending */
+    bool closing;
+    bool error;
+    bool received; /**< At least one datagram was received */
+    int fallback; /**< Reason to use plain system calls (errno), or 0 */
+    block_t *queue;
+    block_t **queue_last;
+    vlc_sem_t ready;
+};
+
+struct uring_block
+{
+    block_t block;
+    uring_recv_t *recv;
+    uint16_t bid;
+};
+
+static vlc_mutex_t uring_lock = VLC_STATIC_MUTEX;
+static struct uring *uring; /* protected by uring_lock */
+
+static int io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int io_uring_enter(int fd, unsigned submit, unsigned wait,
+                          unsigned flags)
+{
+    return syscall(__NR_io_uring_enter, fd, submit, wait, flags, NULL, 0);
+}
+
+static int io_uring_register(int fd, unsigned opcode, void *arg,
+                             unsigned count)
+{
+    return syscall(__NR_io_uring_register, fd, opcode, arg, count);
+}
+
+/* Must be called with uring_lock held. */
+static int UringSubmit(struct uring *ring, const struct io_uring_sqe *sqe)
+{
+    unsigned tail = atomic_load_explicit(ring->sq_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(ring->sq_head, memory_order_acquire);
+
+    if (tail - head >= ring->sq_entries)
+    {
+        errno = EBUSY;
+        return -1;
+    }
+
+    unsigned index = tail & ring->sq_mask;
+
+    ring->sqes[index] = *sqe;
+    ring->sq_array[index] = index;
+    atomic_store_explicit(ring->sq_tail, tail + 1, memory_order_release);
+
+    int val;
+    do
+        val = io_uring_enter(ring->fd, tail + 1 - head, 0, 0);
+    while (val < 0 && errno == EINTR);
+
+    return (val < 0) ? -1 : 0;
+}
+
+static void UringRecvComplete(uring_recv_t *, int res, unsigned flags);
+
+static void *UringThread(void *data)
+{
+    struct uring *ring = data;
+
+    for (;;)
+    {
+        unsigned head = atomic_load_explicit(ring->cq_head,
+                                             memory_order_relaxed);
+        unsigned tail = atomic_load_explicit(ring->cq_tail,
+                                             memory_order_acquire);
+
+        if (head == tail)
+        {
+            io_uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS);
+            continue;
+        }
+
+        bool quit = false;
+
+        for (; head != tail; head++)
+        {
+            const struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+
+            if (cqe->user_data == URING_QUIT)
+                quit = true;
+            else if (!(cqe->user_data & URING_CANCEL))
+                UringRecvComplete((uring_recv_t *)(uintptr_t)cqe->user_data,
+                                  cqe->res, cqe->flags);
+        }
+
+        atomic_store_explicit(ring->cq_head, head, memory_order_release);
+        if (quit)
+            break;
+    }
+    return NULL;
+}
+
+static void UringDestroy(struct uring *ring)
+{
+    munmap(ring->sqes, ring->sqes_size);
+    munmap(ring->rings, ring->rings_size);
+    close(ring->fd);
+    free(ring);
+}
+
+static struct uring *UringCreate(vlc_object_t *obj)
+{
+    struct uring *ring = calloc(1, sizeof (*ring));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    struct io_uring_params p = {
+        .flags = IORING_SETUP_CQSIZE,
+        .cq_entries = URING_CQ_ENTRIES,
+    };
+
+    ring->fd = io_uring_setup(URING_SQ_ENTRIES, &p);
+    if (ring->fd < 0)
+    {
+        msg_Dbg(obj, "io_uring not available: %s", vlc_strerror_c(errno));
+        free(ring);
+        return NULL;
+    }
+
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP))
+    {
+        msg_Dbg(obj, "io_uring too old");
+        close(ring->fd);
+        free(ring);
+        return NULL;
+    }
+
+    size_t sq_size = p.sq_off.array + p.sq_entries * sizeof (unsigned);
+    size_t cq_size = p.cq_off.cqes
+                   + p.cq_entries * sizeof (struct io_uring_cqe);
+
+    ring->rings_size = (sq_size > cq_size) ? sq_size : cq_size;
+    ring->rings = mmap(NULL, ring->rings_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring->fd,
+                       IORING_OFF_SQ_RING);
+    if (ring->rings == MAP_FAILED)
+    {
+        close(ring->fd);
+        free(ring);
+        return NULL;
+    }
+
+    ring->sqes_size = p.sq_entries * sizeof (struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        munmap(ring->rings, ring->rings_size);
+        close(ring->fd);
+        free(ring);
+        return NULL;
+    }
+
+    char *base = ring->rings;
+
+    ring->sq_head = (atomic_uint *)(base + p.sq_off.head);
+    ring->sq_tail = (atomic_uint *)(base + p.sq_off.tail);
+    ring->sq_array = (unsigned *)(base + p.sq_off.array);
+    ring->sq_mask = *(unsigned *)(base + p.sq_off.ring_mask);
+    ring->sq_entries = p.sq_entries;
+    ring->cq_head = (atomic_uint *)(base + p.cq_off.head);
+    ring->cq_tail = (atomic_uint *)(base + p.cq_off.tail);
+    ring->cqes = (struct io_uring_cqe *)(base + p.cq_off.cqes);
+    ring->cq_mask = *(unsigned *)(base + p.cq_off.ring_mask);
+
+    if (vlc_clone(&ring->thread, UringThread, ring,
+                  VLC_THREAD_PRIORITY_INPUT))
+    {
+        UringDestroy(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+static struct uring *UringHold(vlc_object_t *obj)
+{
+    vlc_mutex_lock(&uring_lock);
+    if (uring == NULL)
+        uring = UringCreate(obj);
+    if (uring != NULL)
+        uring->users++;
+    vlc_mutex_unlock(&uring_lock);
+    return uring;
+}
+
+static void UringRelease(struct uring *ring)
+{
+    vlc_mutex_lock(&uring_lock);
+    assert(ring == uring);
+    if (--ring->users > 0)
+    {
+        vlc_mutex_unlock(&uring_lock);
+        return;
+    }
+
+    const struct io_uring_sqe sqe = {
+        .opcode = IORING_OP_NOP,
+        .user_data = URING_QUIT,
+    };
+
+    if (UringSubmit(ring, &sqe))
+        /* Cannot stop the thread: keep the ring for the next user. */
+        ring->users++;
+    else
+    {
+        vlc_join(ring->thread, NULL);
+        UringDestroy(ring);
+        uring = NULL;
+    }
+    vlc_mutex_unlock(&uring_lock);
+}
+
+/* Must be called with uring_lock held. */
+static int UringGroupAlloc(struct uring *ring)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(ring->groups); i++)
+        if (~ring->groups[i])
+        {
+            unsigned bit = __builtin_ctzll(~ring->groups[i]);
+
+            ring->groups[i] |= UINT64_C(1) << bit;
+            return i * 64 + bit;
+        }
+    return -1;
+}
+
+/* Must be called with uring_lock held. */
+static void UringGroupFree(struct uring *ring, unsigned bgid)
+{
+    ring->groups[bgid / 64] &= ~(UINT64_C(1) << (bgid % 64));
+}
+
+/*** Receiver ***/
+
+/* Gives a buffer back to the kernel. Must be called with r->lock held. */
+static void UringRecvRecycle(uring_recv_t *r, uint16_t bid)
+{
+    struct io_uring_buf *buf = &r->br->bufs[r->br_tail & (URING_BUFFERS - 1)];
+
+    buf->addr = (uintptr_t)(r->buffers + bid * URING_BUFFER_SIZE);
+    buf->len = URING_BUFFER_SIZE;
+    buf->bid = bid;
+    r->br_tail++;
+    atomic_store_explicit((_Atomic uint16_t *)&r->br->tail, r->br_tail,
+                          memory_order_release);
+    r->avail++;
+}
+
+/* Must be called with r->lock held. */
+static int UringRecvArm(uring_recv_t *r)
+{
+    const struct io_uring_sqe sqe = {
+        .opcode = IORING_OP_RECV,
+        .flags = IOSQE_BUFFER_SELECT,
+        .ioprio = IORING_RECV_MULTISHOT,
+        .fd = r->fd,
+        .buf_group = r->bgid,
+        .user_data = (uintptr_t)r,
+    };
+
+    assert(!r->armed);
+    vlc_mutex_lock(&uring_lock);
+    int val = UringSubmit(r->ring, &sqe);
+    vlc_mutex_unlock(&uring_lock);
+
+    if (val == 0)
+        r->armed = true;
+    return val;
+}
+
+/* Must be called with r->lock held. */
+static int UringRecvCancel(uring_recv_t *r)
+{
+    const struct io_uring_sqe sqe = {
+        .opcode = IORING_OP_ASYNC_CANCEL,
+        .addr = (uintptr_t)r,
+        .user_data = (uintptr_t)r | URING_CANCEL,
+    };
+
+    vlc_mutex_lock(&uring_lock);
+    int val = UringSubmit(r->ring, &sqe);
+    vlc_mutex_unlock(&uring_lock);
+    return val;
+}
+
+static void UringRecvRelease(uring_recv_t *r)
+{
+    if (atomic_fetch_sub_explicit(&r->refs, 1, memory_order_acq_rel) != 1)
+        return;
+
+    struct io_uring_buf_reg reg = { .bgid = r->bgid };
+    struct uring *ring = r->ring;
+
+    io_uring_register(ring->fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+    munmap(r->br, URING_BUFFERS * sizeof (struct io_uring_buf));
+    free(r->buffers);
+
+    vlc_mutex_lock(&uring_lock);
+    UringGroupFree(ring, r->bgid);
+    vlc_mutex_unlock(&uring_lock);
+    UringRelease(ring);
+    free(r);
+}
+
+static void UringBlockRelease(block_t *block)
+{
+    struct uring_block *ub = container_of(block, struct uring_block, block);
+    uring_recv_t *r = ub->recv;
+
+    vlc_mutex_lock(&r->lock);
+    UringRecvRecycle(r, ub->bid);
+    if (!r->armed && !r->closing && !r->error)
+        UringRecvArm(r);
+    vlc_mutex_unlock(&r->lock);
+
+    free(ub);
+    UringRecvRelease(r);
+}
+
+static const struct vlc_block_callbacks uring_block_cbs =
+{
+    UringBlockRelease,
+};
+
+/* Wraps or copies a received buffer. Must be called with r->lock held. */
+static block_t *UringRecvBuffer(uring_recv_t *r, uint16_t bid, size_t len)
+{
+    uint8_t *data = r->buffers + bid * URING_BUFFER_SIZE;
+    block_t *block = NULL;
+
+    if (r->avail >= URING_LOW_BUFFERS)
+    {
+        struct uring_block *ub = malloc(sizeof (*ub));
+        if (likely(ub != NULL))
+        {
+            ub->recv = r;
+            ub->bid = bid;
+            block = block_Init(&ub->block, &uring_block_cbs, data, len);
+            atomic_fetch_add_explicit(&r->refs, 1, memory_order_relaxed);
+            return block;
+        }
+    }
+
+    block = block_Alloc(len);
+    if (likely(block != NULL))
+        memcpy(block->p_buffer, data, len);
+    UringRecvRecycle(r, bid);
+    return block;
+}
+
+/* Called from the completion thread. */
+static void UringRecvComplete(uring_recv_t *r, int res, unsigned flags)
+{
+    block_t *block = NULL;
+    bool wake = false;
+
+    vlc_mutex_lock(&r->lock);
+    if (flags & IORING_CQE_F_BUFFER)
+    {
+        uint16_t bid = flags >> IORING_CQE_BUFFER_SHIFT;
+
+        assert(r->avail > 0);
+        r->avail--;
+        /* Datagrams received while closing are handed over by
+         * UringRecvClose(), so that none is lost on fallback. */
+        if (res >= 0)
+            block = UringRecvBuffer(r, bid, res);
+        else
+            UringRecvRecycle(r, bid);
+        r->received = true;
+
+        if (res >= URING_BUFFER_SIZE && r->fallback == 0)
+        {   /* The datagram was possibly larger than the buffer. */
+            msg_Warn(r->obj, "datagrams too large for io_uring buffers");
+            r->fallback = EMSGSIZE;
+            wake = true;
+        }
+    }
+
+    if (!(flags & IORING_CQE_F_MORE))
+    {   /* The multi-shot request has terminated. */
+        r->armed = false;
+
+        if (r->closing)
+            vlc_cond_signal(&r->wait);
+        else if (!r->received && (res == -EINVAL || res == -EOPNOTSUPP))
+        {   /* Multi-shot receive or provided buffer rings not supported */
+            msg_Dbg(r->obj, "io_uring receive not supported: %s",
+                    vlc_strerror_c(-res));
+            r->fallback = EOPNOTSUPP;
+            wake = true;
+        }
+        else if (res < 0 && res != -ENOBUFS && res != -ECANCELED)
+        {
+            msg_Err(r->obj, "receive error: %s", vlc_strerror_c(-res));
+            r->error = true;
+            wake = true;
+        }
+        else if (r->avail > 0 && UringRecvArm(r))
+        {
+            msg_Err(r->obj, "cannot resubmit receive: %s",
+                    vlc_strerror_c(errno));
+            r->error = true;
+            wake = true;
+        }
+        /* Otherwise, the next released block will resubmit. */
+    }
+
+    if (block != NULL)
+    {
+        *r->queue_last = block;
+        r->queue_last = &block->p_next;
+        wake = true;
+    }
+
+    /* The receiver may be freed as soon as the lock is released, if it is
+     * being closed: do not touch it afterwards. */
+    if (wake)
+        vlc_sem_post(&r->ready);
+    vlc_mutex_unlock(&r->lock);
+}
+
+uring_recv_t *UringRecvOpen(vlc_object_t *obj, int fd)
+{
+    uring_recv_t *r = malloc(sizeof (*r));
+    if (unlikely(r == NULL))
+        return NULL;
+
+    r->buffers = malloc(URING_BUFFERS * URING_BUFFER_SIZE);
+    if (unlikely(r->buffers == NULL))
+        goto error;
+
+    r->br = mmap(NULL, URING_BUFFERS * sizeof (struct io_uring_buf),
+                 PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (r->br == MAP_FAILED)
+        goto error;
+
+    r->ring = UringHold(obj);
+    if (r->ring == NULL)
+        goto error_br;
+
+    vlc_mutex_lock(&uring_lock);
+    int bgid = UringGroupAlloc(r->ring);
+    vlc_mutex_unlock(&uring_lock);
+    if (bgid < 0)
+        goto error_ring;
+
+    struct io_uring_buf_reg reg = {
+        .ring_addr = (uintptr_t)r->br,
+        .ring_entries = URING_BUFFERS,
+        .bgid = bgid,
+    };
+
+    if (io_uring_register(r->ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1))
+    {
+        msg_Dbg(obj, "cannot register buffers: %s", vlc_strerror_c(errno));
+        vlc_mutex_lock(&uring_lock);
+        UringGroupFree(r->ring, bgid);
+        vlc_mutex_unlock(&uring_lock);
+        goto error_ring;
+    }
+
+    r->obj = obj;
+    r->fd = fd;
+    r->bgid = bgid;
+    atomic_init(&r->refs, 1);
+    vlc_mutex_init(&r->lock);
+    vlc_cond_init(&r->wait);
+    r->br_tail = 0;
+    r->avail = 0;
+    r->armed = false;
+    r->closing = false;
+    r->error = false;
+    r->received = false;
+    r->fallback = 0;
+    r->queue = NULL;
+    r->queue_last = &r->queue;
+    vlc_sem_init(&r->ready, 0);
+
+    vlc_mutex_lock(&r->lock);
+    for (unsigned i = 0; i < URING_BUFFERS; i++)
+        UringRecvRecycle(r, i);
+
+    if (UringRecvArm(r))
+    {
+        vlc_mutex_unlock(&r->lock);
+        msg_Dbg(obj, "cannot submit receive: %s", vlc_strerror_c(errno));
+        UringRecvRelease(r);
+        return NULL;
+    }
+    vlc_mutex_unlock(&r->lock);
+    return r;
+
+error_ring:
+    UringRelease(r->ring);
+error_br:
+    munmap(r->br, URING_BUFFERS * sizeof (struct io_uring_buf));
+error:
+    free(r->buffers);
+    free(r);
+    return NULL;
+}
+
+block_t *UringRecvBlock(uring_recv_t *r, bool *restrict eof)
+{
+    if (vlc_sem_wait_i11e(&r->ready))
+        return NULL;
+
+    vlc_mutex_lock(&r->lock);
+    block_t *block = r->queue;
+
+    if (r->fallback != 0)
+    {
+        block = NULL;
+        errno = r->fallback;
+        vlc_sem_post(&r->ready); /* keep reporting the error */
+    }
+    else if (block != NULL)
+    {
+        r->queue = block->p_next;
+        if (r->queue == NULL)
+            r->queue_last = &r->queue;
+        block->p_next = NULL;
+    }
+    else
+    {
+        assert(r->error);
+        *eof = true;
+        vlc_sem_post(&r->ready); /* keep reporting the error */
+    }
+    vlc_mutex_unlock(&r->lock);
+    return block;
+}
+
+block_t *UringRecvClose(uring_recv_t *r)
+{
+    bool cancelled = false;
+
+    vlc_mutex_lock(&r->lock);
+    r->closing = true;
+    while (r->armed)
+    {
+        if (!cancelled)
+            cancelled = UringRecvCancel(r) == 0;
+        if (cancelled)
+            vlc_cond_wait(&r->wait, &r->lock);
+        else
+            vlc_cond_timedwait(&r->wait, &r->lock,
+                               vlc_tick_now() + VLC_TICK_FROM_MS(10));
+    }
+
+    block_t *queue = r->queue;
+
+    r->queue = NULL;
+    r->queue_last = &r->queue;
+    vlc_mutex_unlock(&r->lock);
+
+    UringRecvRelease(r);
+    return queue;
+}
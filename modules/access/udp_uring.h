@@ -0,0 +1,47 @@
+/*****************************************************************************
+ * udp_uring.h: io_uring UDP receiver common header
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+typedef struct uring_recv uring_recv_t;
+
+/**
+ * Starts receiving datagrams from a socket through the process-wide ring.
+ *
+ * \return a receiver, or NULL if io_uring is not usable (the caller should
+ * then fall back to plain system calls)
+ */
+uring_recv_t *UringRecvOpen(vlc_object_t *, int fd);
+
+/**
+ * Waits for the next datagram (interruptible).
+ *
+ * \return a block of the datagram, or NULL if interrupted or on error
+ * (errno is EMSGSIZE if the datagrams are too large for the ring buffers,
+ * or EOPNOTSUPP if the kernel does not support multi-shot receive: the
+ * caller should then close the receiver and use plain system calls)
+ */
+block_t *UringRecvBlock(uring_recv_t *, bool *restrict eof);
+
+/**
+ * Stops receiving.
+ *
+ * \return the chain of the datagrams received but not read yet (or NULL),
+ * in order
+ */
+block_t *UringRecvClose(uring_recv_t *);
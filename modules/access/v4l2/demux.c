@@ -138,7 +138,8 @@ static void *UserPtrThread(void *data)
         }
 
         assert(block->p_buffer == (void *)buf.m.userptr);
-        block->i_buffer = buf.length;
+        /* Compressed frames are much smaller than the buffer */
+        block->i_buffer = buf.bytesused;
         block->i_pts = block->i_dts = GetBufferPTS(&buf);
         block->i_flags |= sys->block_flags;
         es_out_SetPCR(demux->out, block->i_pts);
@@ -315,7 +316,16 @@ static int InitVideo (demux_t *demux, int fd, uint32_t caps)
     void *(*entry) (void *);
     if (caps & V4L2_CAP_STREAMING)
     {
-        if (StartUserPtr(VLC_OBJECT(demux), fd) == 0)
+        /* Prefer the recycled memory-mapped buffers: user buffers need to be
+         * mapped, and so zeroed by the kernel, for every frame. */
+        sys->pool = StartMmap(VLC_OBJECT(demux), fd, 16);
+        if (sys->pool != NULL)
+        {
+            entry = MmapThread;
+            msg_Dbg(demux, "streaming with %zu memory-mapped buffers",
+                    sys->pool->count);
+        }
+        else if (StartUserPtr(VLC_OBJECT(demux), fd) == 0)
         {
             /* In principles, mmap() will pad the length to a multiple of the
              * page size, so there is no need to care. Nevertheless with the
@@ -328,15 +338,8 @@ static int InitVideo (demux_t *demux, int fd, uint32_t caps)
             msg_Dbg (demux, "streaming with %"PRIu32"-bytes user buffers",
                      sys->blocksize);
         }
-        else /* fall back to memory map */
-        {
-            sys->pool = StartMmap(VLC_OBJECT(demux), fd, 16);
-            if (sys->pool == NULL)
-                return -1;
-            entry = MmapThread;
-            msg_Dbg(demux, "streaming with %zu memory-mapped buffers",
-                    sys->pool->count);
-        }
+        else
+            return -1;
     }
     else if (caps & V4L2_CAP_READWRITE)
     {
@@ -77,7 +77,7 @@ static int Open(vlc_object_t *obj)
     if (unlikely(sys == NULL))
         return VLC_ENOMEM;
 
-    sys->manager = vlc_http_mgr_create(obj, NULL);
+    sys->manager = vlc_http_mgr_create(obj, NULL, NULL);
     if (sys->manager == NULL)
         return VLC_ENOMEM;
 
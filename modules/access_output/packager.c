@@ -0,0 +1,1099 @@
+/*****************************************************************************
+ * packager.c: in-memory HLS and DASH packager
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_sout.h>
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_httpd.h>
+#include <vlc_memstream.h>
+#include <vlc_vector.h>
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+static int  Open ( vlc_object_t * );
+static void Close( vlc_object_t * );
+
+#define SOUT_CFG_PREFIX "sout-packager-"
+
+#define SEGLEN_TEXT N_("Segment length")
+#define SEGLEN_LONGTEXT N_("Target length of the segments, in seconds.")
+
+#define PARTLEN_TEXT N_("Part length")
+#define PARTLEN_LONGTEXT N_("Target length of the partial segments, in " \
+    "milliseconds. With fragmented MP4, the parts are the fragments of " \
+    "the muxer.")
+
+#define NUMSEGS_TEXT N_("Number of segments")
+#define NUMSEGS_LONGTEXT N_("Number of complete segments to keep in " \
+    "memory and to list in the manifests.")
+
+#define SPLITANYWHERE_TEXT N_("Split segments anywhere")
+#define SPLITANYWHERE_LONGTEXT N_("Don't require a keyframe before splitting "\
+                                "a segment. Needed for audio only.")
+
+#define DIR_TEXT N_("Output directory")
+#define DIR_LONGTEXT N_("Also write the complete segments and a playlist " \
+    "without partial segments to this directory.")
+
+vlc_module_begin ()
+    set_description( N_("HLS and DASH packager output") )
+    set_shortname( N_("Packager") )
+    add_shortcut( "packager", "llhls" )
+    set_capability( "sout access", 0 )
+    set_subcategory( SUBCAT_SOUT_ACO )
+    add_integer( SOUT_CFG_PREFIX "seglen", 4, SEGLEN_TEXT, SEGLEN_LONGTEXT )
+        change_integer_range( 1, 60 )
+    add_integer( SOUT_CFG_PREFIX "partlen", 1000,
+                 PARTLEN_TEXT, PARTLEN_LONGTEXT )
+        change_integer_range( 100, 10000 )
+    add_integer( SOUT_CFG_PREFIX "numsegs", 6, NUMSEGS_TEXT, NUMSEGS_LONGTEXT )
+        change_integer_range( 2, 1000 )
+    add_bool( SOUT_CFG_PREFIX "splitanywhere", false,
+              SPLITANYWHERE_TEXT, SPLITANYWHERE_LONGTEXT )
+    add_directory( SOUT_CFG_PREFIX "dir", NULL, DIR_TEXT, DIR_LONGTEXT )
+    set_callbacks( Open, Close )
+vlc_module_end ()
+
+
+/*****************************************************************************
+ * Exported prototypes
+ *****************************************************************************/
+static const char *const ppsz_sout_options[] = {
+    "seglen", "partlen", "numsegs", "splitanywhere", "dir", NULL
+};
+
+static ssize_t Write( sout_access_out_t *, block_t * );
+static int Control( sout_access_out_t *, int, va_list );
+
+enum
+{
+    FORMAT_UNKNOWN,
+    FORMAT_TS,
+    FORMAT_CMAF, /* fragmented MP4 */
+};
+
+struct packager_part
+{
+    block_t *data;
+    vlc_tick_t duration;
+    bool independent; /**< Starts with a keyframe */
+};
+
+struct packager_segment
+{
+    uint32_t number; /**< Media sequence number */
+    vlc_tick_t start; /**< Since the first segment */
+    vlc_tick_t duration;
+    size_t size;
+    bool complete;
+    struct VLC_VECTOR(struct packager_part) parts;
+};
+
+typedef struct
+{
+    httpd_host_t *host;
+    httpd_url_t  *url_m3u8;
+    httpd_url_t  *url_mpd;
+    httpd_url_t  *url_init;
+    httpd_url_t  *url_seg;
+    httpd_url_t  *url_part;
+
+    /* shared with the HTTP callbacks, and only modified by the writer */
+    vlc_mutex_t lock;
+    struct VLC_VECTOR(struct packager_segment *) segments; /**< Oldest first,
+        the last one is being filled */
+    block_t *init; /**< Initialization segment (fragmented MP4) */
+    int format;
+    vlc_tick_t seg_target;
+    vlc_tick_t part_target;
+    time_t   start_time; /**< Wall clock time of the first segment */
+
+    /* part being gathered */
+    block_t  *part;
+    block_t **part_last;
+    vlc_tick_t part_start;
+    vlc_tick_t part_stop;
+    vlc_tick_t part_length;
+    bool       part_independent;
+
+    vlc_tick_t seglen;
+    vlc_tick_t partlen;
+    unsigned   numsegs;
+    bool       b_splitanywhere;
+    char      *dir;
+} sout_access_out_sys_t;
+
+static struct packager_segment *NewSegment( uint32_t number, vlc_tick_t start )
+{
+    struct packager_segment *seg = malloc( sizeof( *seg ) );
+    if( unlikely(seg == NULL) )
+        return NULL;
+
+    seg->number = number;
+    seg->start = start;
+    seg->duration = 0;
+    seg->size = 0;
+    seg->complete = false;
+    vlc_vector_init( &seg->parts );
+    return seg;
+}
+
+static void DeleteSegment( struct packager_segment *seg )
+{
+    for( size_t i = 0; i < seg->parts.size; i++ )
+        block_Release( seg->parts.data[i].data );
+    vlc_vector_destroy( &seg->parts );
+    free( seg );
+}
+
+static const char *Extension( const sout_access_out_sys_t *p_sys )
+{
+    return (p_sys->format == FORMAT_CMAF) ? "m4s" : "ts";
+}
+
+/* Formats a duration in seconds, regardless of the locale */
+static const char *FormatSeconds( char *buf, vlc_tick_t duration )
+{
+    unsigned long long ms = MS_FROM_VLC_TICK( duration );
+
+    sprintf( buf, "%llu.%03llu", ms / 1000, ms % 1000 );
+    return buf;
+}
+
+static uint8_t *Concat( const struct packager_segment *seg, size_t *len )
+{
+    uint8_t *buf = malloc( seg->size ? seg->size : 1 ), *p = buf;
+
+    if( unlikely(buf == NULL) )
+        return NULL;
+
+    for( size_t i = 0; i < seg->parts.size; i++ )
+    {
+        const block_t *data = seg->parts.data[i].data;
+
+        memcpy( p, data->p_buffer, data->i_buffer );
+        p += data->i_buffer;
+    }
+    *len = seg->size;
+    return buf;
+}
+
+static struct packager_segment *FindSegment( sout_access_out_sys_t *p_sys,
+                                             unsigned long number )
+{
+    uint32_t first = p_sys->segments.data[0]->number;
+
+    if( number < first || number - first >= p_sys->segments.size )
+        return NULL;
+    return p_sys->segments.data[number - first];
+}
+
+/*****************************************************************************
+ * Manifests
+ *****************************************************************************/
+static char *Playlist( sout_access_out_sys_t *p_sys, bool b_low_latency )
+{
+    struct vlc_memstream ms;
+    const char *ext = Extension( p_sys );
+    char buf[32];
+
+    if( vlc_memstream_open( &ms ) )
+        return NULL;
+
+    /* Parts are listed for the last segments only (RFC 8216bis 6.2.2) */
+    size_t first_part = p_sys->segments.size > 3 ? p_sys->segments.size - 3 : 0;
+
+    vlc_memstream_printf( &ms, "#EXTM3U\n#EXT-X-VERSION:6\n"
+                          "#EXT-X-TARGETDURATION:%"PRId64"\n",
+                          SEC_FROM_VLC_TICK( p_sys->seg_target
+                                             + VLC_TICK_FROM_SEC(1) - 1 ) );
+    if( b_low_latency )
+    {
+        vlc_memstream_printf( &ms, "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,"
+                              "PART-HOLD-BACK=%s\n",
+                              FormatSeconds( buf, 3 * p_sys->part_target ) );
+        vlc_memstream_printf( &ms, "#EXT-X-PART-INF:PART-TARGET=%s\n",
+                              FormatSeconds( buf, p_sys->part_target ) );
+    }
+    vlc_memstream_printf( &ms, "#EXT-X-MEDIA-SEQUENCE:%"PRIu32"\n",
+                          p_sys->segments.data[0]->number );
+    if( p_sys->format == FORMAT_CMAF )
+        vlc_memstream_puts( &ms, "#EXT-X-MAP:URI=\"init.mp4\"\n" );
+
+    for( size_t i = 0; i < p_sys->segments.size; i++ )
+    {
+        const struct packager_segment *seg = p_sys->segments.data[i];
+
+        if( b_low_latency && i >= first_part )
+            for( size_t j = 0; j < seg->parts.size; j++ )
+            {
+                const struct packager_part *part = &seg->parts.data[j];
+
+                vlc_memstream_printf( &ms, "#EXT-X-PART:DURATION=%s,"
+                                      "URI=\"part?n=%"PRIu32".%zu\"%s\n",
+                                      FormatSeconds( buf, part->duration ),
+                                      seg->number, j,
+                                      part->independent ? ",INDEPENDENT=YES"
+                                                        : "" );
+            }
+
+        if( !seg->complete )
+            continue;
+
+        vlc_memstream_printf( &ms, "#EXTINF:%s,\n",
+                              FormatSeconds( buf, seg->duration ) );
+        if( b_low_latency )
+            vlc_memstream_printf( &ms, "segment?n=%"PRIu32"\n",
+                                  seg->number );
+        else
+            vlc_memstream_printf( &ms, "seg-%"PRIu32".%s\n",
+                                  seg->number, ext );
+    }
+
+    if( b_low_latency )
+    {
+        const struct packager_segment *cur = p_sys->segments.data[
+                                                p_sys->segments.size - 1];
+
+        vlc_memstream_printf( &ms, "#EXT-X-PRELOAD-HINT:TYPE=PART,"
+                              "URI=\"part?n=%"PRIu32".%zu\"\n",
+                              cur->number, cur->parts.size );
+    }
+
+    if( vlc_memstream_close( &ms ) )
+        return NULL;
+    return ms.ptr;
+}
+
+static void FormatTime( char *buf, size_t len, time_t t )
+{
+    struct tm tm;
+
+    gmtime_r( &t, &tm );
+    strftime( buf, len, "%Y-%m-%dT%H:%M:%SZ", &tm );
+}
+
+static char *Manifest( sout_access_out_sys_t *p_sys )
+{
+    struct vlc_memstream ms;
+    char start[32], now[32], update[32], depth[32], buf[32];
+    vlc_tick_t duration = 0;
+    size_t size = 0;
+
+    for( size_t i = 0; i < p_sys->segments.size; i++ )
+    {
+        const struct packager_segment *seg = p_sys->segments.data[i];
+
+        if( seg->complete )
+        {
+            duration += seg->duration;
+            size += seg->size;
+        }
+    }
+
+    if( vlc_memstream_open( &ms ) )
+        return NULL;
+
+    FormatTime( start, sizeof( start ), p_sys->start_time );
+    FormatTime( now, sizeof( now ), time( NULL ) );
+    vlc_memstream_printf( &ms,
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"dynamic\""
+        " profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+        " availabilityStartTime=\"%s\" publishTime=\"%s\""
+        " minimumUpdatePeriod=\"PT%sS\" minBufferTime=\"PT%sS\""
+        " timeShiftBufferDepth=\"PT%sS\">\n"
+        " <Period id=\"0\" start=\"PT0S\">\n"
+        "  <AdaptationSet mimeType=\"video/mp4\" segmentAlignment=\"true\">\n"
+        "   <Representation id=\"0\" bandwidth=\"%"PRId64"\">\n"
+        "    <SegmentTemplate timescale=\"1000\" initialization=\"init.mp4\""
+        " media=\"segment?n=$Number$\" startNumber=\"%"PRIu32"\">\n"
+        "     <SegmentTimeline>\n",
+        start, now, FormatSeconds( update, p_sys->seg_target ),
+        FormatSeconds( buf, p_sys->seg_target ),
+        FormatSeconds( depth, duration ),
+        duration > 0 ? (int64_t)size * 8 * CLOCK_FREQ / duration : 0,
+        p_sys->segments.data[0]->number );
+
+    for( size_t i = 0; i < p_sys->segments.size; i++ )
+    {
+        const struct packager_segment *seg = p_sys->segments.data[i];
+
+        if( seg->complete )
+            vlc_memstream_printf( &ms, "      <S t=\"%"PRId64"\" d=\"%"PRId64
+                                  "\"/>\n", MS_FROM_VLC_TICK( seg->start ),
+                                  MS_FROM_VLC_TICK( seg->duration ) );
+    }
+
+    vlc_memstream_puts( &ms, "     </SegmentTimeline>\n"
+                             "    </SegmentTemplate>\n"
+                             "   </Representation>\n"
+                             "  </AdaptationSet>\n"
+                             " </Period>\n"
+                             "</MPD>\n" );
+
+    if( vlc_memstream_close( &ms ) )
+        return NULL;
+    return ms.ptr;
+}
+
+/*****************************************************************************
+ * HTTP callbacks
+ *****************************************************************************/
+static bool GetArg( const uint8_t *args, const char *name, const char *fmt,
+                    unsigned long *a, unsigned long *b )
+{
+    size_t len = strlen( name );
+
+    for( const char *p = (const char *)args; p != NULL && *p; )
+    {
+        if( !strncmp( p, name, len ) && p[len] == '=' )
+            return sscanf( p + len + 1, fmt, a, b ) >= 1;
+
+        p = strchr( p, '&' );
+        if( p != NULL )
+            p++;
+    }
+    return false;
+}
+
+static void Answer( httpd_message_t *answer, const httpd_message_t *query,
+                    int status, const char *type, const char *cache,
+                    void *body, size_t len )
+{
+    answer->i_proto  = HTTPD_PROTO_HTTP;
+    answer->i_version= 1;
+    answer->i_type   = HTTPD_MSG_ANSWER;
+    answer->i_status = status;
+
+    if( query->i_type == HTTPD_MSG_HEAD )
+        free( body );
+    else
+    {
+        answer->p_body = body;
+        answer->i_body = len;
+    }
+
+    if( type != NULL )
+        httpd_MsgAdd( answer, "Content-Type", "%s", type );
+    httpd_MsgAdd( answer, "Cache-Control", "%s", cache );
+    /* for web players */
+    httpd_MsgAdd( answer, "Access-Control-Allow-Origin", "*" );
+
+    const char *conn = httpd_MsgGet( query, "Connection" );
+    if( conn != NULL && strcasestr( conn, "close" ) != NULL )
+        httpd_MsgAdd( answer, "Connection", "close" );
+    httpd_MsgAdd( answer, "Content-Length", "%zu", len );
+}
+
+static int PlaylistCallback( httpd_callback_sys_t *data, httpd_client_t *cl,
+                             httpd_message_t *answer,
+                             const httpd_message_t *query )
+{
+    sout_access_out_t *p_access = (sout_access_out_t *)data;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    unsigned long msn, part;
+    int status = 200;
+
+    if( answer == NULL || query == NULL )
+        return VLC_SUCCESS;
+
+    bool b_msn = GetArg( query->psz_args, "_HLS_msn", "%lu", &msn, NULL );
+    bool b_part = GetArg( query->psz_args, "_HLS_part", "%lu", &part, NULL );
+
+    vlc_mutex_lock( &p_sys->lock );
+
+    const struct packager_segment *cur = p_sys->segments.data[
+                                            p_sys->segments.size - 1];
+
+    /* Blocking playlist reload */
+    if( b_msn && msn > cur->number + 2 )
+        status = 400;
+    else if( b_msn && !(msn < cur->number
+                     || (b_part && msn == cur->number
+                                && part < cur->parts.size)) )
+    {
+        if( httpd_ClientDefer( cl, 3 * p_sys->seg_target ) )
+        {
+            vlc_mutex_unlock( &p_sys->lock );
+            return VLC_SUCCESS;
+        }
+        status = 503;
+    }
+
+    char *body = (status == 200) ? Playlist( p_sys, true ) : NULL;
+    vlc_mutex_unlock( &p_sys->lock );
+
+    if( status == 200 && body == NULL )
+        status = 500;
+
+    Answer( answer, query, status, "application/vnd.apple.mpegurl",
+            "no-cache", body, body ? strlen( body ) : 0 );
+    return VLC_SUCCESS;
+}
+
+static int ManifestCallback( httpd_callback_sys_t *data, httpd_client_t *cl,
+                             httpd_message_t *answer,
+                             const httpd_message_t *query )
+{
+    sout_access_out_t *p_access = (sout_access_out_t *)data;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    char *body = NULL;
+
+    (void) cl;
+    if( answer == NULL || query == NULL )
+        return VLC_SUCCESS;
+
+    vlc_mutex_lock( &p_sys->lock );
+    /* MPEG-TS segments are not supported by the DASH live profile */
+    if( p_sys->format == FORMAT_CMAF )
+        body = Manifest( p_sys );
+    vlc_mutex_unlock( &p_sys->lock );
+
+    Answer( answer, query, body ? 200 : 404, "application/dash+xml",
+            "no-cache", body, body ? strlen( body ) : 0 );
+    return VLC_SUCCESS;
+}
+
+static int InitCallback( httpd_callback_sys_t *data, httpd_client_t *cl,
+                         httpd_message_t *answer,
+                         const httpd_message_t *query )
+{
+    sout_access_out_t *p_access = (sout_access_out_t *)data;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    uint8_t *body = NULL;
+    size_t len = 0;
+
+    (void) cl;
+    if( answer == NULL || query == NULL )
+        return VLC_SUCCESS;
+
+    vlc_mutex_lock( &p_sys->lock );
+    if( p_sys->init != NULL )
+    {
+        len = p_sys->init->i_buffer;
+        body = malloc( len );
+        if( likely(body != NULL) )
+            memcpy( body, p_sys->init->p_buffer, len );
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+
+    Answer( answer, query, body ? 200 : 404, "video/mp4", "max-age=60",
+            body, body ? len : 0 );
+    return VLC_SUCCESS;
+}
+
+static int SegmentCallback( httpd_callback_sys_t *data, httpd_client_t *cl,
+                            httpd_message_t *answer,
+                            const httpd_message_t *query )
+{
+    sout_access_out_t *p_access = (sout_access_out_t *)data;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    unsigned long number;
+    uint8_t *body = NULL;
+    size_t len = 0;
+
+    (void) cl;
+    if( answer == NULL || query == NULL )
+        return VLC_SUCCESS;
+
+    vlc_mutex_lock( &p_sys->lock );
+    if( GetArg( query->psz_args, "n", "%lu", &number, NULL ) )
+    {
+        const struct packager_segment *seg = FindSegment( p_sys, number );
+
+        if( seg != NULL && seg->complete )
+            body = Concat( seg, &len );
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+
+    Answer( answer, query, body ? 200 : 404,
+            p_sys->format == FORMAT_CMAF ? "video/mp4" : "video/mp2t",
+            "max-age=60", body, len );
+    return VLC_SUCCESS;
+}
+
+static int PartCallback( httpd_callback_sys_t *data, httpd_client_t *cl,
+                         httpd_message_t *answer,
+                         const httpd_message_t *query )
+{
+    sout_access_out_t *p_access = (sout_access_out_t *)data;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    unsigned long number, index;
+    uint8_t *body = NULL;
+    size_t len = 0;
+
+    if( answer == NULL || query == NULL )
+        return VLC_SUCCESS;
+
+    vlc_mutex_lock( &p_sys->lock );
+    if( GetArg( query->psz_args, "n", "%lu.%lu", &number, &index ) )
+    {
+        const struct packager_segment *cur = p_sys->segments.data[
+                                                p_sys->segments.size - 1];
+        const struct packager_segment *seg = FindSegment( p_sys, number );
+
+        if( seg != NULL && index < seg->parts.size )
+        {
+            const block_t *part = seg->parts.data[index].data;
+
+            len = part->i_buffer;
+            body = malloc( len );
+            if( likely(body != NULL) )
+                memcpy( body, part->p_buffer, len );
+        }
+        else
+        /* The part announced by the preload hint is answered once ready.
+         * If the segment ends instead, the hint is not found. */
+        if( ((seg == cur && index == cur->parts.size)
+          || (number == cur->number + 1 && index == 0))
+         && httpd_ClientDefer( cl, 3 * p_sys->part_target ) )
+        {
+            vlc_mutex_unlock( &p_sys->lock );
+            return VLC_SUCCESS;
+        }
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+
+    Answer( answer, query, body ? 200 : 404,
+            p_sys->format == FORMAT_CMAF ? "video/mp4" : "video/mp2t",
+            "max-age=60", body, body ? len : 0 );
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Optional disk output
+ *****************************************************************************/
+static void WriteFile( sout_access_out_t *p_access, const char *name,
+                       const void *data, size_t len )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    char *path, *tmp;
+
+    if( asprintf( &path, "%s"DIR_SEP"%s", p_sys->dir, name ) < 0 )
+        return;
+    if( asprintf( &tmp, "%s.tmp", path ) < 0 )
+    {
+        free( path );
+        return;
+    }
+
+    /* Readers never see partially written files */
+    FILE *stream = vlc_fopen( tmp, "wb" );
+    if( stream == NULL )
+    {
+        msg_Err( p_access, "cannot create %s: %s", tmp,
+                 vlc_strerror_c(errno) );
+        goto out;
+    }
+
+    bool ok = fwrite( data, 1, len, stream ) == len;
+    if( fclose( stream ) )
+        ok = false;
+    if( !ok || vlc_rename( tmp, path ) )
+    {
+        msg_Err( p_access, "cannot write %s: %s", path,
+                 vlc_strerror_c(errno) );
+        vlc_unlink( tmp );
+    }
+out:
+    free( tmp );
+    free( path );
+}
+
+static void WriteSegment( sout_access_out_t *p_access,
+                          const struct packager_segment *seg )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    char name[32];
+    size_t len;
+
+    /* Only the writer thread modifies the segments: no locking needed */
+    uint8_t *data = Concat( seg, &len );
+    if( unlikely(data == NULL) )
+        return;
+
+    snprintf( name, sizeof( name ), "seg-%"PRIu32".%s", seg->number,
+              Extension( p_sys ) );
+    WriteFile( p_access, name, data, len );
+    free( data );
+
+    char *playlist = Playlist( p_sys, false );
+    if( likely(playlist != NULL) )
+    {
+        WriteFile( p_access, "index.m3u8", playlist, strlen( playlist ) );
+        free( playlist );
+    }
+}
+
+static void RemoveSegment( sout_access_out_t *p_access,
+                           const struct packager_segment *seg )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    char *path;
+
+    if( asprintf( &path, "%s"DIR_SEP"seg-%"PRIu32".%s", p_sys->dir,
+                  seg->number, Extension( p_sys ) ) >= 0 )
+    {
+        vlc_unlink( path );
+        free( path );
+    }
+}
+
+/*****************************************************************************
+ * Segmenter
+ *****************************************************************************/
+
+/* Whether a fragment starts with a sync sample on all its tracks */
+static bool MoofIsIndependent( const block_t *moof )
+{
+    const uint8_t *p = moof->p_buffer, *end = p + moof->i_buffer;
+
+    if( moof->i_buffer < 8 || memcmp( p + 4, "moof", 4 ) )
+        return false;
+
+    for( p += 8; end - p >= 8; )
+    {
+        uint32_t size = GetDWBE( p );
+        if( size < 8 || size > (size_t)(end - p) )
+            break;
+
+        if( !memcmp( p + 4, "traf", 4 ) )
+        {
+            const uint8_t *q = p + 8, *qend = p + size;
+
+            while( qend - q >= 8 )
+            {
+                uint32_t bsize = GetDWBE( q );
+                if( bsize < 8 || bsize > (size_t)(qend - q) )
+                    break;
+
+                if( !memcmp( q + 4, "trun", 4 ) && bsize >= 16 )
+                {
+                    uint32_t flags = GetDWBE( q + 8 ) & 0xFFFFFF;
+                    /* first-sample-flags-present */
+                    const uint8_t *f = q + 16 + ((flags & 0x001) ? 4 : 0);
+
+                    if( (flags & 0x004) && f + 4 <= q + bsize
+                     && (GetDWBE( f ) & 0x10000) /* non-sync sample */ )
+                        return false;
+                }
+                q += bsize;
+            }
+        }
+        p += size;
+    }
+    return true;
+}
+
+static vlc_tick_t PartDuration( const sout_access_out_sys_t *p_sys )
+{
+    /* Several tracks overlap in time: prefer timestamps to lengths */
+    if( p_sys->part_start != VLC_TICK_INVALID )
+        return p_sys->part_stop - p_sys->part_start;
+    return p_sys->part_length;
+}
+
+static void FinishPart( sout_access_out_t *p_access )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    struct packager_part part = {
+        .duration = PartDuration( p_sys ),
+        .independent = p_sys->part_independent,
+    };
+
+    part.data = block_ChainGather( p_sys->part );
+    p_sys->part = NULL;
+    p_sys->part_last = &p_sys->part;
+    p_sys->part_start = p_sys->part_stop = VLC_TICK_INVALID;
+    p_sys->part_length = 0;
+    if( part.data == NULL )
+        return;
+
+    vlc_mutex_lock( &p_sys->lock );
+    struct packager_segment *seg = p_sys->segments.data[
+                                       p_sys->segments.size - 1];
+
+    if( !vlc_vector_push( &seg->parts, part ) )
+    {
+        vlc_mutex_unlock( &p_sys->lock );
+        block_Release( part.data );
+        return;
+    }
+    seg->duration += part.duration;
+    seg->size += part.data->i_buffer;
+    if( p_sys->part_target < part.duration )
+        p_sys->part_target = part.duration;
+    vlc_mutex_unlock( &p_sys->lock );
+
+    httpd_HostWakeUp( p_sys->host );
+}
+
+static void FinishSegment( sout_access_out_t *p_access )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    struct packager_segment *seg = p_sys->segments.data[
+                                       p_sys->segments.size - 1];
+    struct packager_segment *stale = NULL;
+
+    if( seg->parts.size == 0 )
+        return;
+
+    struct packager_segment *next = NewSegment( seg->number + 1,
+                                                seg->start + seg->duration );
+    if( unlikely(next == NULL) )
+        return; /* keep on filling the current segment */
+
+    vlc_mutex_lock( &p_sys->lock );
+    if( !vlc_vector_push( &p_sys->segments, next ) )
+    {
+        vlc_mutex_unlock( &p_sys->lock );
+        DeleteSegment( next );
+        return;
+    }
+    seg->complete = true;
+    if( p_sys->seg_target < seg->duration )
+        p_sys->seg_target = seg->duration;
+    if( p_sys->segments.size > p_sys->numsegs + 1 )
+    {
+        stale = p_sys->segments.data[0];
+        vlc_vector_remove( &p_sys->segments, 0 );
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+
+    httpd_HostWakeUp( p_sys->host );
+
+    msg_Dbg( p_access, "segment %"PRIu32" complete (%zu parts, %zu bytes)",
+             seg->number, seg->parts.size, seg->size );
+
+    if( p_sys->dir != NULL )
+        WriteSegment( p_access, seg );
+    if( stale != NULL )
+    {
+        if( p_sys->dir != NULL )
+            RemoveSegment( p_access, stale );
+        DeleteSegment( stale );
+    }
+}
+
+/* Starts a new part, and a new segment if it is long enough */
+static void Cut( sout_access_out_t *p_access, bool b_independent,
+                 bool b_force )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    if( p_sys->part != NULL )
+    {
+        const struct packager_segment *seg = p_sys->segments.data[
+                                                 p_sys->segments.size - 1];
+
+        FinishPart( p_access );
+        if( b_force || ((b_independent || p_sys->b_splitanywhere)
+                        && seg->duration >= p_sys->seglen) )
+            FinishSegment( p_access );
+    }
+    p_sys->part_independent = b_independent;
+}
+
+static void SetInit( sout_access_out_t *p_access, block_t *init )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    /* A new initialization segment needs a new media segment */
+    Cut( p_access, true, true );
+
+    vlc_mutex_lock( &p_sys->lock );
+    block_t *old = p_sys->init;
+    p_sys->init = init;
+    vlc_mutex_unlock( &p_sys->lock );
+
+    if( old != NULL )
+        block_Release( old );
+    if( p_sys->dir != NULL )
+        WriteFile( p_access, "init.mp4", init->p_buffer, init->i_buffer );
+}
+
+static void Push( sout_access_out_t *p_access, block_t *block )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    if( p_sys->format == FORMAT_UNKNOWN )
+    {
+        int format = FORMAT_TS;
+
+        if( (block->i_flags & BLOCK_FLAG_HEADER) && block->i_buffer >= 8
+         && !memcmp( block->p_buffer + 4, "ftyp", 4 ) )
+            format = FORMAT_CMAF;
+
+        vlc_mutex_lock( &p_sys->lock );
+        p_sys->format = format;
+        p_sys->start_time = time( NULL );
+        vlc_mutex_unlock( &p_sys->lock );
+        msg_Dbg( p_access, "packaging %s segments",
+                 format == FORMAT_CMAF ? "CMAF" : "MPEG-TS" );
+    }
+
+    if( p_sys->format == FORMAT_CMAF )
+    {
+        /* The MP4 muxer sends ftyp and moov as one header block, and flags
+         * the moof box starting each fragment for HTTP streaming. */
+        if( block->i_flags & BLOCK_FLAG_HEADER )
+        {
+            SetInit( p_access, block );
+            return;
+        }
+        if( block->i_flags & BLOCK_FLAG_TYPE_I )
+            Cut( p_access, MoofIsIndependent( block ), false );
+    }
+    else
+    {
+        /* The TS muxer flags the PAT/PMT preceding keyframes */
+        if( block->i_flags & BLOCK_FLAG_HEADER )
+            Cut( p_access, true, false );
+        else if( PartDuration( p_sys ) >= p_sys->partlen )
+            Cut( p_access, false, false );
+    }
+
+    if( block->i_dts != VLC_TICK_INVALID )
+    {
+        if( p_sys->part_start == VLC_TICK_INVALID )
+            p_sys->part_start = p_sys->part_stop = block->i_dts;
+        if( p_sys->part_stop < block->i_dts + block->i_length )
+            p_sys->part_stop = block->i_dts + block->i_length;
+    }
+    p_sys->part_length += block->i_length;
+    block_ChainLastAppend( &p_sys->part_last, block );
+}
+
+/*****************************************************************************
+ * Open: start the HTTP server
+ *****************************************************************************/
+static httpd_url_t *AddUrl( sout_access_out_t *p_access, const char *path,
+                            const char *name, httpd_callback_t cb )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    size_t len = strlen( path );
+    char *psz_url;
+
+    if( len > 0 && path[len - 1] == '/' )
+        len--;
+    if( asprintf( &psz_url, "%.*s/%s", (int)len, path, name ) < 0 )
+        return NULL;
+
+    httpd_url_t *url = httpd_UrlNew( p_sys->host, psz_url, NULL, NULL );
+    if( url == NULL )
+        msg_Err( p_access, "cannot add URL %s", psz_url );
+    else
+    {
+        httpd_UrlCatch( url, HTTPD_MSG_GET, cb, (void *)p_access );
+        httpd_UrlCatch( url, HTTPD_MSG_HEAD, cb, (void *)p_access );
+    }
+    free( psz_url );
+    return url;
+}
+
+static void DeleteUrls( sout_access_out_sys_t *p_sys )
+{
+    httpd_url_t *urls[] = {
+        p_sys->url_m3u8, p_sys->url_mpd, p_sys->url_init,
+        p_sys->url_seg, p_sys->url_part,
+    };
+
+    for( size_t i = 0; i < ARRAY_SIZE(urls); i++ )
+        if( urls[i] != NULL )
+            httpd_UrlDelete( urls[i] );
+}
+
+static int Open( vlc_object_t *p_this )
+{
+    sout_access_out_t     *p_access = (sout_access_out_t*)p_this;
+    sout_access_out_sys_t *p_sys;
+
+    config_ChainParse( p_access, SOUT_CFG_PREFIX, ppsz_sout_options,
+                       p_access->p_cfg );
+
+    const char *path = p_access->psz_path;
+    path += strcspn( path, "/" );
+    if( path > p_access->psz_path )
+    {
+        const char *port = strrchr( p_access->psz_path, ':' );
+        if( port != NULL && strchr( port, ']' ) != NULL )
+            port = NULL; /* IPv6 numeral */
+        if( port != p_access->psz_path )
+        {
+            int len = (port ? port : path) - p_access->psz_path;
+            char host[len + 1];
+
+            strncpy( host, p_access->psz_path, len );
+            host[len] = '\0';
+            var_Create( p_access, "http-host", VLC_VAR_STRING );
+            var_SetString( p_access, "http-host", host );
+        }
+        if( port != NULL )
+        {
+            int bind_port = atoi( port + 1 );
+            if( bind_port > 0 )
+            {
+                var_Create( p_access, "http-port", VLC_VAR_INTEGER );
+                var_SetInteger( p_access, "http-port", bind_port );
+            }
+        }
+    }
+
+    if( unlikely( !( p_sys = calloc( 1, sizeof( *p_sys ) ) ) ) )
+        return VLC_ENOMEM;
+    p_access->p_sys = p_sys;
+
+    p_sys->seglen = vlc_tick_from_sec(
+        var_GetInteger( p_access, SOUT_CFG_PREFIX "seglen" ) );
+    p_sys->partlen = VLC_TICK_FROM_MS(
+        var_GetInteger( p_access, SOUT_CFG_PREFIX "partlen" ) );
+    p_sys->numsegs = var_GetInteger( p_access, SOUT_CFG_PREFIX "numsegs" );
+    p_sys->b_splitanywhere = var_GetBool( p_access,
+                                          SOUT_CFG_PREFIX "splitanywhere" );
+    p_sys->dir = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "dir" );
+    p_sys->seg_target = p_sys->seglen;
+    p_sys->part_target = p_sys->partlen;
+    p_sys->format = FORMAT_UNKNOWN;
+    p_sys->start_time = time( NULL );
+
+    p_sys->part = NULL;
+    p_sys->part_last = &p_sys->part;
+    p_sys->part_start = p_sys->part_stop = VLC_TICK_INVALID;
+
+    vlc_mutex_init( &p_sys->lock );
+    vlc_vector_init( &p_sys->segments );
+
+    struct packager_segment *seg = NewSegment( 0, 0 );
+    if( unlikely(seg == NULL) || !vlc_vector_push( &p_sys->segments, seg ) )
+    {
+        free( seg );
+        goto error;
+    }
+
+    p_sys->host = vlc_http_HostNew( VLC_OBJECT(p_access) );
+    if( p_sys->host == NULL )
+    {
+        msg_Err( p_access, "cannot start HTTP server" );
+        goto error;
+    }
+
+    p_sys->url_m3u8 = AddUrl( p_access, path, "index.m3u8", PlaylistCallback );
+    p_sys->url_mpd  = AddUrl( p_access, path, "manifest.mpd",
+                              ManifestCallback );
+    p_sys->url_init = AddUrl( p_access, path, "init.mp4", InitCallback );
+    p_sys->url_seg  = AddUrl( p_access, path, "segment", SegmentCallback );
+    p_sys->url_part = AddUrl( p_access, path, "part", PartCallback );
+    if( p_sys->url_m3u8 == NULL || p_sys->url_mpd == NULL
+     || p_sys->url_init == NULL || p_sys->url_seg == NULL
+     || p_sys->url_part == NULL )
+    {
+        DeleteUrls( p_sys );
+        httpd_HostDelete( p_sys->host );
+        goto error;
+    }
+
+    p_access->pf_write   = Write;
+    p_access->pf_control = Control;
+    return VLC_SUCCESS;
+
+error:
+    if( p_sys->segments.size > 0 )
+        DeleteSegment( p_sys->segments.data[0] );
+    vlc_vector_destroy( &p_sys->segments );
+    free( p_sys->dir );
+    free( p_sys );
+    return VLC_EGENERIC;
+}
+
+/*****************************************************************************
+ * Close: stop the HTTP server
+ *****************************************************************************/
+static void Close( vlc_object_t * p_this )
+{
+    sout_access_out_t     *p_access = (sout_access_out_t*)p_this;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    struct packager_segment *seg;
+
+    DeleteUrls( p_sys );
+    httpd_HostDelete( p_sys->host );
+
+    vlc_vector_foreach( seg, &p_sys->segments )
+        DeleteSegment( seg );
+    vlc_vector_destroy( &p_sys->segments );
+
+    block_ChainRelease( p_sys->part );
+    if( p_sys->init != NULL )
+        block_Release( p_sys->init );
+    free( p_sys->dir );
+    free( p_sys );
+}
+
+static int Control( sout_access_out_t *p_access, int i_query, va_list args )
+{
+    (void)p_access;
+
+    switch( i_query )
+    {
+        case ACCESS_OUT_CONTROLS_PACE:
+            *va_arg( args, bool * ) = false;
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Write:
+ *****************************************************************************/
+static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
+{
+    size_t i_write = 0;
+
+    while( p_buffer != NULL )
+    {
+        block_t *p_next = p_buffer->p_next;
+
+        p_buffer->p_next = NULL;
+        i_write += p_buffer->i_buffer;
+        Push( p_access, p_buffer );
+        p_buffer = p_next;
+    }
+    return i_write;
+}
@@ -370,7 +370,9 @@ static block_t *Filter( filter_t *p_filter, block_t *p_block )
       p_filter->fmt_out.audio.i_bitspersample *
         p_filter->fmt_out.audio.i_channels / 8;
 
-    block_t *p_out = block_Alloc( i_out_size );
+    /* All conversions downmix: each output frame is smaller than the input
+     * frame it is computed from, so the input buffer is reused. */
+    block_t *p_out = aout_filter_GetBuffer( p_block, i_out_size );
     if( !p_out )
     {
         msg_Warn( p_filter, "can't get output buffer" );
@@ -378,19 +380,10 @@ static block_t *Filter( filter_t *p_filter, block_t *p_block )
         return NULL;
     }
 
-    p_out->i_nb_samples = p_block->i_nb_samples;
-    p_out->i_dts = p_block->i_dts;
-    p_out->i_pts = p_block->i_pts;
-    p_out->i_length = p_block->i_length;
-
-    int i_input_nb = aout_FormatNbChannels( &p_filter->fmt_in.audio );
-    int i_output_nb = aout_FormatNbChannels( &p_filter->fmt_out.audio );
-    p_out->i_nb_samples = p_block->i_nb_samples;
-    p_out->i_buffer = p_block->i_buffer * i_output_nb / i_input_nb;
-
     work( p_filter, p_block, p_out );
 
-    block_Release( p_block );
+    if( p_out != p_block )
+        block_Release( p_block );
 
     return p_out;
 }
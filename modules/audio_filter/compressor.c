@@ -38,6 +38,8 @@
 #include <vlc_aout.h>
 #include <vlc_filter.h>
 
+#include "planar.h"
+
 /*****************************************************************************
 * Local prototypes.
 *****************************************************************************/
@@ -596,7 +598,10 @@ static float RmsEnvProcess( rms_env * p_r, const float f_x )
     p_r->pf_buf[p_r->i_pos] = f_x;
 
     /* Go to the next position for the next RMS calculation */
-    p_r->i_pos = ( p_r->i_pos + 1 ) % ( p_r->i_count );
+    if( ++p_r->i_pos == p_r->i_count )
+    {
+        p_r->i_pos = 0;
+    }
 
     /* Return the RMS value */
     return sqrt( p_r->f_sum / p_r->i_count );
@@ -608,21 +613,27 @@ static float RmsEnvProcess( rms_env * p_r, const float f_x )
 static void BufferProcess( float * pf_buf, int i_channels, float f_gain,
                            float f_mug, lookahead * p_la )
 {
-    /* Loop through every channel */
-    for( int i_chan = 0; i_chan < i_channels; i_chan++ )
+    float *pf_vals = p_la->p_buf[p_la->i_pos].pf_vals;
+
+    /* Loop through the channels, several at a time (see planar.h) */
+    for( int i_chan = 0; i_chan < i_channels; i_chan += AFV_LANES )
     {
-        float f_x = pf_buf[i_chan]; /* Current buffer value */
+        unsigned n = __MIN( (unsigned)( i_channels - i_chan ), AFV_LANES );
+        afv_t x = afv_Load( pf_buf + i_chan, n ); /* Current buffer values */
 
-        /* Output the compressed delayed buffer value */
-        pf_buf[i_chan] = p_la->p_buf[p_la->i_pos].pf_vals[i_chan]
-                       * f_gain * f_mug;
+        /* Output the compressed delayed buffer values */
+        afv_Store( pf_buf + i_chan,
+                   afv_Load( pf_vals + i_chan, n ) * f_gain * f_mug, n );
 
-        /* Update the delayed buffer value */
-        p_la->p_buf[p_la->i_pos].pf_vals[i_chan] = f_x;
+        /* Update the delayed buffer values */
+        afv_Store( pf_vals + i_chan, x, n );
     }
 
     /* Go to the next delayed buffer value for the next run */
-    p_la->i_pos = ( p_la->i_pos + 1 ) % ( p_la->i_count );
+    if( ++p_la->i_pos == p_la->i_count )
+    {
+        p_la->i_pos = 0;
+    }
 }
 
 /*****************************************************************************
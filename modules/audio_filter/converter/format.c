@@ -38,17 +38,31 @@
 #include <vlc_aout.h>
 #include <vlc_block.h>
 #include <vlc_filter.h>
+#include <vlc_cpu.h>
+
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+# include <arm_neon.h>
+#endif
 
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
 static int  Open(vlc_object_t *);
 
+#define DITHER_TEXT N_("Dither to 16 bits")
+#define DITHER_LONGTEXT N_("Add triangular noise of one least significant " \
+    "bit when converting floating point samples to 16 bits integers, " \
+    "instead of plain rounding.")
+
 vlc_module_begin()
     set_description(N_("Audio filter for PCM format conversion"))
     set_subcategory(SUBCAT_AUDIO_AFILTER)
     set_capability("audio converter", 1)
     set_callback(Open)
+    add_bool("audio-format-dither", false, DITHER_TEXT, DITHER_LONGTEXT)
 vlc_module_end()
 
 /*****************************************************************************
@@ -57,6 +71,14 @@ vlc_module_end()
 
 typedef block_t *(*cvt_t)(filter_t *, block_t *);
 static const struct vlc_filter_operations *FindConversion(vlc_fourcc_t src, vlc_fourcc_t dst);
+static const struct vlc_filter_operations dither_ops[2];
+
+#define DITHER_LANES 4
+
+typedef struct
+{
+    uint32_t seed[DITHER_LANES];
+} filter_sys_t;
 
 static int Open(vlc_object_t *object)
 {
@@ -74,6 +96,20 @@ static int Open(vlc_object_t *object)
     if (filter_ops == NULL)
         return VLC_EGENERIC;
 
+    if (dst->i_codec == VLC_CODEC_S16N
+     && (src->i_codec == VLC_CODEC_FL32 || src->i_codec == VLC_CODEC_FL64)
+     && var_InheritBool(filter, "audio-format-dither"))
+    {
+        filter_sys_t *sys = malloc(sizeof (*sys));
+        if (unlikely(sys == NULL))
+            return VLC_ENOMEM;
+
+        for (unsigned i = 0; i < DITHER_LANES; i++)
+            sys->seed[i] = 0x9e3779b9 * (i + 1);
+        filter->p_sys = sys;
+        filter_ops = &dither_ops[src->i_codec == VLC_CODEC_FL64];
+    }
+
     filter->ops = filter_ops;
 
     msg_Dbg(filter, "%4.4s->%4.4s, bits per sample: %i->%i",
@@ -83,6 +119,320 @@ static int Open(vlc_object_t *object)
 }
 
 
+/*****************************************************************************
+ * SIMD kernels
+ *****************************************************************************
+ * They convert as many samples as they can in whole vectors, and return that
+ * count; the C loops below handle the rest. Each vector is loaded before
+ * being stored, so that narrowing conversions can still be done in place.
+ * The results are identical to the C versions.
+ *****************************************************************************/
+#ifdef CAN_COMPILE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static size_t S16toFl32_sse2(float *dst, const int16_t *src, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(1.f / 32768.f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    return i;
+}
+
+__attribute__ ((__target__ ("sse2")))
+static size_t Fl32toS16_sse2(int16_t *dst, const float *src, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(32768.f);
+    const __m128 max = _mm_set1_ps(32767.f), min = _mm_set1_ps(-32768.f);
+    size_t i = 0;
+
+    /* Rounds to nearest even, like the IEEE trick of the C version */
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+
+        a = _mm_max_ps(_mm_min_ps(a, max), min);
+        b = _mm_max_ps(_mm_min_ps(b, max), min);
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_packs_epi32(_mm_cvtps_epi32(a),
+                                         _mm_cvtps_epi32(b)));
+    }
+    return i;
+}
+
+__attribute__ ((__target__ ("sse2")))
+static size_t S32toFl32_sse2(float *dst, const int32_t *src, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(1.f / 2147483648.f);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    return i;
+}
+
+__attribute__ ((__target__ ("sse2")))
+static size_t Fl32toS32_sse2(int32_t *dst, const float *src, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(2147483648.f);
+    const __m128 min = _mm_set1_ps(-2147483648.f);
+    const __m128 half = _mm_set1_ps(.5f), mhalf = _mm_set1_ps(-.5f);
+    const __m128i max = _mm_set1_epi32(INT32_MAX);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 v = _mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), min);
+        /* Round half away from zero, like lroundf() */
+        __m128i t = _mm_cvttps_epi32(v);
+        __m128 frac = _mm_sub_ps(v, _mm_cvtepi32_ps(t));
+
+        t = _mm_sub_epi32(t, _mm_castps_si128(_mm_cmpge_ps(frac, half)));
+        t = _mm_add_epi32(t, _mm_castps_si128(_mm_cmple_ps(frac, mhalf)));
+        /* 2^31 and above convert to INT32_MIN */
+        __m128i over = _mm_castps_si128(_mm_cmpge_ps(v, scale));
+        t = _mm_or_si128(_mm_andnot_si128(over, t), _mm_and_si128(over, max));
+        _mm_storeu_si128((__m128i *)(dst + i), t);
+    }
+    return i;
+}
+#endif
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+static size_t S16toFl32_neon(float *dst, const int16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        int16x8_t v = vld1q_s16(src + i);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+
+        vst1q_f32(dst + i, vmulq_n_f32(lo, 1.f / 32768.f));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(hi, 1.f / 32768.f));
+    }
+    return i;
+}
+
+static size_t Fl32toS16_neon(int16_t *dst, const float *src, size_t n)
+{
+    const float32x4_t max = vdupq_n_f32(32767.f), min = vdupq_n_f32(-32768.f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        float32x4_t a = vmulq_n_f32(vld1q_f32(src + i), 32768.f);
+        float32x4_t b = vmulq_n_f32(vld1q_f32(src + i + 4), 32768.f);
+
+        a = vmaxq_f32(vminq_f32(a, max), min);
+        b = vmaxq_f32(vminq_f32(b, max), min);
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)),
+                                        vqmovn_s32(vcvtnq_s32_f32(b))));
+    }
+    return i;
+}
+
+static size_t S32toFl32_neon(float *dst, const int32_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src + i)),
+                                       1.f / 2147483648.f));
+    return i;
+}
+
+static size_t Fl32toS32_neon(int32_t *dst, const float *src, size_t n)
+{
+    size_t i = 0;
+
+    /* Rounds half away from zero and saturates, like the C version */
+    for (; i + 4 <= n; i += 4)
+        vst1q_s32(dst + i, vcvtaq_s32_f32(vmulq_n_f32(vld1q_f32(src + i),
+                                                      2147483648.f)));
+    return i;
+}
+#endif
+
+static size_t S16toFl32_simd(float *dst, const int16_t *src, size_t n)
+{
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        return S16toFl32_sse2(dst, src, n);
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        return S16toFl32_neon(dst, src, n);
+#endif
+    VLC_UNUSED(dst); VLC_UNUSED(src); VLC_UNUSED(n);
+    return 0;
+}
+
+static size_t Fl32toS16_simd(int16_t *dst, const float *src, size_t n)
+{
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        return Fl32toS16_sse2(dst, src, n);
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        return Fl32toS16_neon(dst, src, n);
+#endif
+    VLC_UNUSED(dst); VLC_UNUSED(src); VLC_UNUSED(n);
+    return 0;
+}
+
+static size_t S32toFl32_simd(float *dst, const int32_t *src, size_t n)
+{
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        return S32toFl32_sse2(dst, src, n);
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        return S32toFl32_neon(dst, src, n);
+#endif
+    VLC_UNUSED(dst); VLC_UNUSED(src); VLC_UNUSED(n);
+    return 0;
+}
+
+static size_t Fl32toS32_simd(int32_t *dst, const float *src, size_t n)
+{
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        return Fl32toS32_sse2(dst, src, n);
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        return Fl32toS32_neon(dst, src, n);
+#endif
+    VLC_UNUSED(dst); VLC_UNUSED(src); VLC_UNUSED(n);
+    return 0;
+}
+
+#ifdef CAN_COMPILE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static inline __m128 Dither_sse2(__m128i *seed)
+{
+    __m128i x = *seed;
+
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+    *seed = x;
+
+    __m128i sum = _mm_add_epi32(_mm_srai_epi32(_mm_slli_epi32(x, 16), 16),
+                                _mm_srai_epi32(x, 16));
+    return _mm_mul_ps(_mm_cvtepi32_ps(sum), _mm_set1_ps(1.f / 65536.f));
+}
+
+__attribute__ ((__target__ ("sse2")))
+static size_t Fl32toS16Dither_sse2(int16_t *dst, const float *src, size_t n,
+                                   uint32_t *seeds)
+{
+    const __m128 scale = _mm_set1_ps(32768.f);
+    const __m128 max = _mm_set1_ps(32767.f), min = _mm_set1_ps(-32768.f);
+    __m128i seed = _mm_loadu_si128((const __m128i *)seeds);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+
+        a = _mm_add_ps(a, Dither_sse2(&seed));
+        b = _mm_add_ps(b, Dither_sse2(&seed));
+        a = _mm_max_ps(_mm_min_ps(a, max), min);
+        b = _mm_max_ps(_mm_min_ps(b, max), min);
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_packs_epi32(_mm_cvtps_epi32(a),
+                                         _mm_cvtps_epi32(b)));
+    }
+    _mm_storeu_si128((__m128i *)seeds, seed);
+    return i;
+}
+#endif
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+static inline float32x4_t Dither_neon(uint32x4_t *seed)
+{
+    uint32x4_t x = *seed;
+
+    x = veorq_u32(x, vshlq_n_u32(x, 13));
+    x = veorq_u32(x, vshrq_n_u32(x, 17));
+    x = veorq_u32(x, vshlq_n_u32(x, 5));
+    *seed = x;
+
+    int32x4_t v = vreinterpretq_s32_u32(x);
+    int32x4_t sum = vaddq_s32(vshrq_n_s32(vshlq_n_s32(v, 16), 16),
+                              vshrq_n_s32(v, 16));
+    return vmulq_n_f32(vcvtq_f32_s32(sum), 1.f / 65536.f);
+}
+
+static size_t Fl32toS16Dither_neon(int16_t *dst, const float *src, size_t n,
+                                   uint32_t *seeds)
+{
+    const float32x4_t max = vdupq_n_f32(32767.f), min = vdupq_n_f32(-32768.f);
+    uint32x4_t seed = vld1q_u32(seeds);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        float32x4_t a = vmulq_n_f32(vld1q_f32(src + i), 32768.f);
+        float32x4_t b = vmulq_n_f32(vld1q_f32(src + i + 4), 32768.f);
+
+        a = vaddq_f32(a, Dither_neon(&seed));
+        b = vaddq_f32(b, Dither_neon(&seed));
+        a = vmaxq_f32(vminq_f32(a, max), min);
+        b = vmaxq_f32(vminq_f32(b, max), min);
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)),
+                                        vqmovn_s32(vcvtnq_s32_f32(b))));
+    }
+    vst1q_u32(seeds, seed);
+    return i;
+}
+#endif
+
+static size_t Fl32toS16Dither_simd(int16_t *dst, const float *src, size_t n,
+                                   uint32_t *seeds)
+{
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        return Fl32toS16Dither_sse2(dst, src, n, seeds);
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        return Fl32toS16Dither_neon(dst, src, n, seeds);
+#endif
+    VLC_UNUSED(dst); VLC_UNUSED(src); VLC_UNUSED(n); VLC_UNUSED(seeds);
+    return 0;
+}
+
+/* Triangular noise of +/-1 LSB: the sum of two uniform variables. Sample i
+ * uses the generator i % DITHER_LANES, as the SIMD version. */
+static inline float Dither(uint32_t *seed)
+{
+    uint32_t x = *seed;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return ((int16_t)x + (int16_t)(x >> 16)) * (1.f / 65536.f);
+}
+
 /*** from U8 ***/
 static block_t *U8toS16(filter_t *filter, block_t *bsrc)
 {
@@ -175,7 +525,10 @@ static block_t *S16toFl32(filter_t *filter, block_t *bsrc)
     block_CopyProperties(bdst, bsrc);
     int16_t *src = (int16_t *)bsrc->p_buffer;
     float   *dst = (float *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 2; i--;)
+    size_t done = S16toFl32_simd(dst, src, bsrc->i_buffer / 2);
+    src += done;
+    dst += done;
+    for (size_t i = bsrc->i_buffer / 2 - done; i--;)
 #if 0
         /* Slow version */
         *dst++ = (float)*src++ / 32768.f;
@@ -255,7 +608,10 @@ static block_t *Fl32toS16(filter_t *filter, block_t *b)
     VLC_UNUSED(filter);
     float   *src = (float *)b->p_buffer;
     int16_t *dst = (int16_t *)src;
-    for (int i = b->i_buffer / 4; i--;) {
+    size_t done = Fl32toS16_simd(dst, src, b->i_buffer / 4);
+    src += done;
+    dst += done;
+    for (size_t i = b->i_buffer / 4 - done; i--;) {
 #if 0
         /* Slow version. */
         if (*src >= 1.0) *dst = 32767;
@@ -278,11 +634,37 @@ static block_t *Fl32toS16(filter_t *filter, block_t *b)
     return b;
 }
 
+static block_t *Fl32toS16Dither(filter_t *filter, block_t *b)
+{
+    filter_sys_t *sys = filter->p_sys;
+    float   *src = (float *)b->p_buffer;
+    int16_t *dst = (int16_t *)src;
+    const size_t n = b->i_buffer / 4;
+    size_t i = Fl32toS16Dither_simd(dst, src, n, sys->seed);
+
+    for (src += i, dst += i; i < n; i++)
+    {
+        float s = *(src++) * 32768.f + Dither(&sys->seed[i % DITHER_LANES]);
+        if (s >= 32767.f)
+            *(dst++) = 32767;
+        else
+        if (s <= -32768.f)
+            *(dst++) = -32768;
+        else
+            *(dst++) = lrintf(s);
+    }
+    b->i_buffer /= 2;
+    return b;
+}
+
 static block_t *Fl32toS32(filter_t *filter, block_t *b)
 {
     float   *src = (float *)b->p_buffer;
     int32_t *dst = (int32_t *)src;
-    for (size_t i = b->i_buffer / 4; i--;)
+    size_t done = Fl32toS32_simd(dst, src, b->i_buffer / 4);
+    src += done;
+    dst += done;
+    for (size_t i = b->i_buffer / 4 - done; i--;)
     {
         float s = *(src++) * 2147483648.f;
         if (s >= 2147483647.f)
@@ -345,7 +727,10 @@ static block_t *S32toFl32(filter_t *filter, block_t *b)
     VLC_UNUSED(filter);
     int32_t *src = (int32_t*)b->p_buffer;
     float   *dst = (float *)src;
-    for (int i = b->i_buffer / 4; i--;)
+    size_t done = S32toFl32_simd(dst, src, b->i_buffer / 4);
+    src += done;
+    dst += done;
+    for (size_t i = b->i_buffer / 4 - done; i--;)
         *dst++ = (float)(*src++) / 2147483648.f;
     return b;
 }
@@ -408,6 +793,29 @@ static block_t *Fl64toS16(filter_t *filter, block_t *b)
     return b;
 }
 
+static block_t *Fl64toS16Dither(filter_t *filter, block_t *b)
+{
+    filter_sys_t *sys = filter->p_sys;
+    double  *src = (double *)b->p_buffer;
+    int16_t *dst = (int16_t *)src;
+    const size_t n = b->i_buffer / 8;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const double v = *(src++) * 32768.
+                       + Dither(&sys->seed[i % DITHER_LANES]);
+        if (v >= 32767.)
+            *(dst++) = 32767;
+        else
+        if (v <= -32768.)
+            *(dst++) = -32768;
+        else
+            *(dst++) = lrint(v);
+    }
+    b->i_buffer /= 4;
+    return b;
+}
+
 static block_t *Fl64toFl32(filter_t *filter, block_t *b)
 {
     double *src = (double *)b->p_buffer;
@@ -476,6 +884,16 @@ static const struct {
     { 0, 0, (struct vlc_filter_operations) { .filter_audio = NULL } }
 };
 
+static void CloseDither(filter_t *filter)
+{
+    free(filter->p_sys);
+}
+
+static const struct vlc_filter_operations dither_ops[2] = {
+    { .filter_audio = Fl32toS16Dither, .close = CloseDither },
+    { .filter_audio = Fl64toS16Dither, .close = CloseDither },
+};
+
 static const struct vlc_filter_operations *FindConversion(vlc_fourcc_t src, vlc_fourcc_t dst)
 {
     for (int i = 0; cvt_directs[i].convert.filter_audio; i++) {
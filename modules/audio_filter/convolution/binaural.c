@@ -0,0 +1,334 @@
+/*****************************************************************************
+ * binaural.c : first order Ambisonics to binaural renderer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_plugin.h>
+
+#include "conv.h"
+
+#define BLOCK_FRAMES 256
+
+/* Engine inputs: W, Y, Z, X (ACN order), then the head-locked stereo pair */
+#define AMB_CHANNELS 4
+#define NONDIEGETIC_L 4
+#define NONDIEGETIC_R 5
+
+static int Open( vlc_object_t * );
+
+#define HRIR_TEXT N_("Ambisonics HRIR file")
+#define HRIR_LONGTEXT N_("WAV file with the head-related impulse responses " \
+    "of the first order ACN/SN3D channels W, Y, Z and X for the left ear. " \
+    "The right ear is deduced by symmetry, unless the file has 8 channels, " \
+    "the last 4 being for the right ear. If empty, another renderer is used.")
+
+vlc_module_begin ()
+    set_shortname( N_("Binaural") )
+    set_description( N_("Ambisonics binaural renderer (convolution)") )
+    set_subcategory( SUBCAT_AUDIO_AFILTER )
+    set_capability( "audio renderer", 10 )
+    set_callback( Open )
+    add_shortcut( "binaural" )
+
+    add_loadfile( "binaural-hrir", NULL, HRIR_TEXT, HRIR_LONGTEXT )
+vlc_module_end ()
+
+typedef struct
+{
+    aconv_t *conv;
+    bool symmetric;
+    bool nondiegetic;
+
+    vlc_mutex_t lock;
+    float yaw, pitch, roll; /* protected by lock */
+
+    float rotation[3][3]; /* currently applied to (X, Y, Z) */
+} filter_sys_t;
+
+/**
+ * Computes the rotation of the sound field that compensates the head
+ * orientation, i.e. the inverse of Rz(yaw) Ry(-pitch) Rx(roll)
+ * (x to the front, y to the left, z up).
+ */
+static void GetRotation( float m[3][3], float yaw, float pitch, float roll )
+{
+    const float cy = cosf( yaw ), sy = sinf( yaw );
+    const float cp = cosf( pitch ), sp = sinf( pitch );
+    const float cr = cosf( roll ), sr = sinf( roll );
+
+    /* Transpose of the head orientation matrix */
+    m[0][0] = cy * cp;
+    m[1][0] = -cy * sp * sr - sy * cr;
+    m[2][0] = -cy * sp * cr + sy * sr;
+    m[0][1] = sy * cp;
+    m[1][1] = -sy * sp * sr + cy * cr;
+    m[2][1] = -sy * sp * cr - cy * sr;
+    m[0][2] = sp;
+    m[1][2] = cp * sr;
+    m[2][2] = cp * cr;
+}
+
+static block_t *Render( filter_t *filter, block_t *in )
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned channels = filter->fmt_in.audio.i_channels;
+    const size_t frames = in->i_nb_samples;
+
+    if( in->i_flags & BLOCK_FLAG_DISCONTINUITY )
+        aconv_Reset( sys->conv );
+
+    float target[3][3], step[3][3];
+
+    vlc_mutex_lock( &sys->lock );
+    GetRotation( target, sys->yaw, sys->pitch, sys->roll );
+    vlc_mutex_unlock( &sys->lock );
+
+    /* Interpolate the rotation over the block to avoid steps in the field */
+    for( unsigned i = 0; i < 3; i++ )
+        for( unsigned j = 0; j < 3; j++ )
+            step[i][j] = frames > 0
+                ? (target[i][j] - sys->rotation[i][j]) / frames : 0.f;
+
+    block_t *out = aout_filter_GetBuffer( in, frames * 2 * sizeof (float) );
+    if( unlikely(out == NULL) )
+    {
+        block_Release( in );
+        return NULL;
+    }
+
+    const float *src = (const float *)in->p_buffer;
+    float *dst = (float *)out->p_buffer;
+    float (*m)[3] = sys->rotation;
+
+    for( size_t done = 0; done < frames; )
+    {
+        unsigned n = aconv_Available( sys->conv );
+
+        if( n > frames - done )
+            n = frames - done;
+
+        float *w = aconv_Input( sys->conv, 0 );
+        float *y = aconv_Input( sys->conv, 1 );
+        float *z = aconv_Input( sys->conv, 2 );
+        float *x = aconv_Input( sys->conv, 3 );
+
+        for( unsigned i = 0; i < n; i++ )
+        {
+            const float *f = src + i * channels;
+            const float fx = f[3], fy = f[1], fz = f[2];
+
+            for( unsigned k = 0; k < 3; k++ )
+                for( unsigned l = 0; l < 3; l++ )
+                    m[k][l] += step[k][l];
+
+            w[i] = f[0];
+            x[i] = m[0][0] * fx + m[0][1] * fy + m[0][2] * fz;
+            y[i] = m[1][0] * fx + m[1][1] * fy + m[1][2] * fz;
+            z[i] = m[2][0] * fx + m[2][1] * fy + m[2][2] * fz;
+        }
+
+        if( sys->nondiegetic )
+        {
+            float *l = aconv_Input( sys->conv, NONDIEGETIC_L );
+            float *r = aconv_Input( sys->conv, NONDIEGETIC_R );
+
+            for( unsigned i = 0; i < n; i++ )
+            {
+                l[i] = src[i * channels + NONDIEGETIC_L];
+                r[i] = src[i * channels + NONDIEGETIC_R];
+            }
+        }
+
+        const float *o0 = aconv_Output( sys->conv, 0 );
+        const float *o1 = aconv_Output( sys->conv, 1 );
+
+        /* The output never overtakes the input: in place is safe */
+        if( sys->symmetric )
+            for( unsigned i = 0; i < n; i++ )
+            {
+                dst[2 * i]     = o0[i] + o1[i];
+                dst[2 * i + 1] = o0[i] - o1[i];
+            }
+        else
+            for( unsigned i = 0; i < n; i++ )
+            {
+                dst[2 * i]     = o0[i];
+                dst[2 * i + 1] = o1[i];
+            }
+
+        if( sys->nondiegetic )
+        {
+            const float *l = aconv_Delayed( sys->conv, NONDIEGETIC_L );
+            const float *r = aconv_Delayed( sys->conv, NONDIEGETIC_R );
+
+            for( unsigned i = 0; i < n; i++ )
+            {
+                dst[2 * i]     += l[i];
+                dst[2 * i + 1] += r[i];
+            }
+        }
+
+        aconv_Advance( sys->conv, n );
+        src += n * channels;
+        dst += n * 2;
+        done += n;
+    }
+
+    /* Do not accumulate rounding errors */
+    memcpy( sys->rotation, target, sizeof (target) );
+
+    if( out != in )
+        block_Release( in );
+    return out;
+}
+
+static void ChangeViewpoint( filter_t *filter, const vlc_viewpoint_t *vp )
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    /* Same conventions as the spatialaudio renderer */
+    vlc_mutex_lock( &sys->lock );
+    sys->yaw = -vp->yaw * (float)(M_PI / 180.);
+    sys->pitch = vp->pitch * (float)(M_PI / 180.);
+    sys->roll = vp->roll * (float)(M_PI / 180.);
+    vlc_mutex_unlock( &sys->lock );
+}
+
+static void Flush( filter_t *filter )
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    aconv_Reset( sys->conv );
+}
+
+static void Close( filter_t *filter )
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    aconv_Delete( sys->conv );
+    free( sys );
+}
+
+static int Open( vlc_object_t *obj )
+{
+    filter_t *filter = (filter_t *)obj;
+    const audio_format_t *infmt = &filter->fmt_in.audio;
+    const audio_format_t *outfmt = &filter->fmt_out.audio;
+
+    if( infmt->channel_type != AUDIO_CHANNEL_TYPE_AMBISONICS
+     || infmt->i_format != VLC_CODEC_FL32
+     || outfmt->i_format != VLC_CODEC_FL32
+     || infmt->i_rate != outfmt->i_rate )
+        return VLC_EGENERIC;
+
+    if( outfmt->i_channels != 2
+     || outfmt->i_chan_mode != AOUT_CHANMODE_BINAURAL )
+        return VLC_EGENERIC;
+
+    /* First order only, with or without head-locked stereo */
+    if( infmt->i_channels != AMB_CHANNELS
+     && infmt->i_channels != AMB_CHANNELS + 2 )
+        return VLC_EGENERIC;
+
+    char *path = var_InheritString( filter, "binaural-hrir" );
+    if( path == NULL )
+        return VLC_EGENERIC;
+
+    float *ir;
+    unsigned ir_channels;
+    size_t ir_frames;
+    int ret = aconv_LoadWav( obj, path, infmt->i_rate, &ir, &ir_channels,
+                             &ir_frames );
+    free( path );
+    if( ret != VLC_SUCCESS )
+        return ret;
+
+    if( ir_channels != AMB_CHANNELS && ir_channels != 2 * AMB_CHANNELS )
+    {
+        msg_Err( filter, "HRIR file must have 4 or 8 channels, not %u",
+                 ir_channels );
+        free( ir );
+        return VLC_EGENERIC;
+    }
+
+    filter_sys_t *sys = malloc( sizeof (*sys) );
+    if( unlikely(sys == NULL) )
+    {
+        free( ir );
+        return VLC_ENOMEM;
+    }
+
+    sys->symmetric = ir_channels == AMB_CHANNELS;
+    sys->nondiegetic = infmt->i_channels > AMB_CHANNELS;
+    sys->conv = aconv_New( BLOCK_FRAMES, infmt->i_channels, 2, true );
+    if( unlikely(sys->conv == NULL) )
+        goto error;
+
+    ret = VLC_SUCCESS;
+    if( sys->symmetric )
+    {
+        /* Left = even + odd, right = even - odd, with regard to the
+         * left-right axis: only Y (ACN 1) is odd at first order. */
+        for( unsigned c = 0; c < AMB_CHANNELS && ret == VLC_SUCCESS; c++ )
+            ret = aconv_SetFilter( sys->conv, c, c == 1, ir + c * ir_frames,
+                                   ir_frames, 1.f );
+    }
+    else
+    {
+        for( unsigned c = 0; c < 2 * AMB_CHANNELS && ret == VLC_SUCCESS; c++ )
+            ret = aconv_SetFilter( sys->conv, c % AMB_CHANNELS,
+                                   c / AMB_CHANNELS, ir + c * ir_frames,
+                                   ir_frames, 1.f );
+    }
+    if( ret != VLC_SUCCESS )
+        goto error;
+    free( ir );
+
+    vlc_mutex_init( &sys->lock );
+    sys->yaw = sys->pitch = sys->roll = 0.f;
+    GetRotation( sys->rotation, 0.f, 0.f, 0.f );
+
+    msg_Dbg( filter, "rendering %u channels with %zu frames HRIRs",
+             infmt->i_channels, ir_frames );
+
+    static const struct vlc_filter_operations filter_ops =
+    {
+        .filter_audio = Render, .flush = Flush,
+        .change_viewpoint = ChangeViewpoint, .close = Close,
+    };
+    filter->p_sys = sys;
+    filter->ops = &filter_ops;
+    return VLC_SUCCESS;
+
+error:
+    if( sys->conv != NULL )
+        aconv_Delete( sys->conv );
+    free( sys );
+    free( ir );
+    return VLC_ENOMEM;
+}
@@ -0,0 +1,725 @@
+/*****************************************************************************
+ * conv.c : uniformly partitioned FFT convolution
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_fs.h>
+
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
+#include "conv.h"
+#include "../../video_chroma/slices.h"
+
+/* Below this many complex multiply-adds per block, threads cost more than
+ * they save */
+#define MIN_THREADED_WORK 32768
+
+/* Longest accepted impulse response file data */
+#define MAX_WAV_SIZE (64 << 20)
+
+typedef void (*cmac_fn)(float *restrict yr, float *restrict yi,
+                        const float *xr, const float *xi,
+                        const float *hr, const float *hi, unsigned n);
+
+struct aconv_pair
+{
+    unsigned input;
+    unsigned output;
+    unsigned partitions;
+    float *spectra; /* partitions * (re[stride], im[stride]) */
+};
+
+struct aconv
+{
+    unsigned block;      /* partition size, B */
+    unsigned stride;     /* number of bins (B + 1), padded for SIMD */
+    unsigned inputs;
+    unsigned outputs;
+    unsigned partitions; /* length of the frequency-domain delay line */
+    unsigned pos;        /* frames exchanged in the current block */
+    unsigned fdl_pos;    /* slot of the newest input spectrum */
+    size_t work;         /* complex multiply-adds per block */
+
+    /* Complex FFT of size B */
+    float *cos_tab;
+    float *sin_tab;
+    unsigned *bitrev;
+    /* Real FFT of size 2B: exp(-i pi k / B) */
+    float *rcos;
+    float *rsin;
+
+    float *history;      /* inputs * (previous block, current block) */
+    float *fdl;          /* inputs * partitions * (re[stride], im[stride]) */
+    float *output;       /* outputs * B */
+    float *scratch;      /* lanes * (2B + 2 stride) */
+
+    struct aconv_pair *pairs;
+    unsigned pair_count;
+
+    vlc_slices_t *slices;
+    cmac_fn cmac;
+};
+
+/*****************************************************************************
+ * Spectrum multiply-accumulate: Y += X * H
+ *****************************************************************************/
+static void cmac_c(float *restrict yr, float *restrict yi,
+                   const float *xr, const float *xi,
+                   const float *hr, const float *hi, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++)
+    {
+        yr[i] += xr[i] * hr[i] - xi[i] * hi[i];
+        yi[i] += xr[i] * hi[i] + xi[i] * hr[i];
+    }
+}
+
+#ifdef CAN_COMPILE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static void cmac_sse2(float *restrict yr, float *restrict yi,
+                      const float *xr, const float *xi,
+                      const float *hr, const float *hi, unsigned n)
+{
+    for (unsigned i = 0; i < n; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(xr + i), b = _mm_loadu_ps(xi + i);
+        __m128 c = _mm_loadu_ps(hr + i), d = _mm_loadu_ps(hi + i);
+        __m128 r = _mm_sub_ps(_mm_mul_ps(a, c), _mm_mul_ps(b, d));
+        __m128 j = _mm_add_ps(_mm_mul_ps(a, d), _mm_mul_ps(b, c));
+
+        _mm_storeu_ps(yr + i, _mm_add_ps(_mm_loadu_ps(yr + i), r));
+        _mm_storeu_ps(yi + i, _mm_add_ps(_mm_loadu_ps(yi + i), j));
+    }
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__ ((__target__ ("avx2")))
+static void cmac_avx2(float *restrict yr, float *restrict yi,
+                      const float *xr, const float *xi,
+                      const float *hr, const float *hi, unsigned n)
+{
+    for (unsigned i = 0; i < n; i += 8)
+    {
+        __m256 a = _mm256_loadu_ps(xr + i), b = _mm256_loadu_ps(xi + i);
+        __m256 c = _mm256_loadu_ps(hr + i), d = _mm256_loadu_ps(hi + i);
+        __m256 r = _mm256_sub_ps(_mm256_mul_ps(a, c), _mm256_mul_ps(b, d));
+        __m256 j = _mm256_add_ps(_mm256_mul_ps(a, d), _mm256_mul_ps(b, c));
+
+        _mm256_storeu_ps(yr + i, _mm256_add_ps(_mm256_loadu_ps(yr + i), r));
+        _mm256_storeu_ps(yi + i, _mm256_add_ps(_mm256_loadu_ps(yi + i), j));
+    }
+}
+#endif
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+static void cmac_neon(float *restrict yr, float *restrict yi,
+                      const float *xr, const float *xi,
+                      const float *hr, const float *hi, unsigned n)
+{
+    for (unsigned i = 0; i < n; i += 4)
+    {
+        float32x4_t a = vld1q_f32(xr + i), b = vld1q_f32(xi + i);
+        float32x4_t c = vld1q_f32(hr + i), d = vld1q_f32(hi + i);
+        float32x4_t r = vfmsq_f32(vfmaq_f32(vld1q_f32(yr + i), a, c), b, d);
+        float32x4_t j = vfmaq_f32(vfmaq_f32(vld1q_f32(yi + i), a, d), b, c);
+
+        vst1q_f32(yr + i, r);
+        vst1q_f32(yi + i, j);
+    }
+}
+#endif
+
+/*****************************************************************************
+ * FFT
+ *****************************************************************************/
+
+/** In-place complex FFT of size B, unnormalised, on interleaved samples. */
+static void FFT(const aconv_t *c, float *z, bool inverse)
+{
+    const unsigned m = c->block;
+
+    for (unsigned i = 0; i < m; i++)
+    {
+        unsigned j = c->bitrev[i];
+        if (j > i)
+        {
+            float r = z[2 * i], im = z[2 * i + 1];
+            z[2 * i] = z[2 * j];
+            z[2 * i + 1] = z[2 * j + 1];
+            z[2 * j] = r;
+            z[2 * j + 1] = im;
+        }
+    }
+
+    const float sign = inverse ? 1.f : -1.f;
+
+    for (unsigned len = 2; len <= m; len *= 2)
+    {
+        const unsigned half = len / 2, step = m / len;
+
+        for (unsigned i = 0; i < m; i += len)
+            for (unsigned k = 0; k < half; k++)
+            {
+                const float wr = c->cos_tab[k * step];
+                const float wi = sign * c->sin_tab[k * step];
+                float *a = z + 2 * (i + k), *b = a + 2 * half;
+                float tr = b[0] * wr - b[1] * wi;
+                float ti = b[0] * wi + b[1] * wr;
+
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+    }
+}
+
+/**
+ * Real FFT of size 2B.
+ *
+ * \param x 2B real samples
+ * \param z scratch area of 2B floats
+ * \param re, im B + 1 bins (padded with zeros to the stride)
+ */
+static void RealFFT(const aconv_t *c, const float *x, float *z,
+                    float *re, float *im)
+{
+    const unsigned m = c->block;
+
+    /* Even samples as the real part, odd samples as the imaginary part */
+    memcpy(z, x, 2 * m * sizeof (*z));
+    FFT(c, z, false);
+
+    for (unsigned k = 0; k <= m; k++)
+    {
+        const unsigned a = k % m, b = (m - k) % m;
+        const float zr = z[2 * a], zi = z[2 * a + 1];
+        const float cr = z[2 * b], ci = -z[2 * b + 1];
+        /* Spectra of the even and odd samples */
+        const float er = .5f * (zr + cr), ei = .5f * (zi + ci);
+        const float odr = .5f * (zi - ci), oi = -.5f * (zr - cr);
+        const float wr = c->rcos[k], wi = -c->rsin[k];
+
+        re[k] = er + odr * wr - oi * wi;
+        im[k] = ei + odr * wi + oi * wr;
+    }
+    for (unsigned k = m + 1; k < c->stride; k++)
+        re[k] = im[k] = 0.f;
+}
+
+/**
+ * Inverse real FFT of size 2B, unnormalised.
+ *
+ * \param z 2B output samples
+ */
+static void RealIFFT(const aconv_t *c, const float *re, const float *im,
+                     float *z)
+{
+    const unsigned m = c->block;
+
+    for (unsigned k = 0; k < m; k++)
+    {
+        const float xr = re[k], xi = im[k];
+        const float cr = re[m - k], ci = -im[m - k];
+        const float er = .5f * (xr + cr), ei = .5f * (xi + ci);
+        const float dr = .5f * (xr - cr), di = .5f * (xi - ci);
+        const float odr = dr * c->rcos[k] - di * c->rsin[k];
+        const float oi = dr * c->rsin[k] + di * c->rcos[k];
+
+        z[2 * k] = er - oi;
+        z[2 * k + 1] = ei + odr;
+    }
+    FFT(c, z, true);
+}
+
+/*****************************************************************************
+ * Engine
+ *****************************************************************************/
+static float *Lane(const aconv_t *c, unsigned lane)
+{
+    return c->scratch + (size_t)lane * (2 * c->block + 2 * c->stride);
+}
+
+static float *Slot(const aconv_t *c, unsigned input, unsigned slot)
+{
+    return c->fdl + ((size_t)input * c->partitions + slot) * 2 * c->stride;
+}
+
+aconv_t *aconv_New(unsigned block, unsigned inputs, unsigned outputs,
+                   bool threads)
+{
+    assert(block >= 16 && (block & (block - 1)) == 0);
+    assert(inputs > 0 && outputs > 0);
+
+    aconv_t *c = calloc(1, sizeof (*c));
+    if (unlikely(c == NULL))
+        return NULL;
+
+    const unsigned lanes = __MAX(inputs, outputs);
+
+    c->block = block;
+    c->stride = (block + 1 + 7) & ~7u;
+    c->inputs = inputs;
+    c->outputs = outputs;
+    c->partitions = 1;
+    c->cos_tab = malloc(block / 2 * sizeof (float));
+    c->sin_tab = malloc(block / 2 * sizeof (float));
+    c->bitrev = malloc(block * sizeof (unsigned));
+    c->rcos = malloc((block + 1) * sizeof (float));
+    c->rsin = malloc((block + 1) * sizeof (float));
+    c->history = calloc((size_t)inputs * 2 * block, sizeof (float));
+    c->fdl = calloc((size_t)inputs * 2 * c->stride, sizeof (float));
+    c->output = calloc((size_t)outputs * block, sizeof (float));
+    c->scratch = malloc((size_t)lanes * (2 * block + 2 * c->stride)
+                        * sizeof (float));
+    if (unlikely(c->cos_tab == NULL || c->sin_tab == NULL
+              || c->bitrev == NULL || c->rcos == NULL || c->rsin == NULL
+              || c->history == NULL || c->fdl == NULL || c->output == NULL
+              || c->scratch == NULL))
+    {
+        aconv_Delete(c);
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < block / 2; i++)
+    {
+        c->cos_tab[i] = cos(2. * M_PI * i / block);
+        c->sin_tab[i] = sin(2. * M_PI * i / block);
+    }
+    for (unsigned i = 0; i <= block; i++)
+    {
+        c->rcos[i] = cos(M_PI * i / block);
+        c->rsin[i] = sin(M_PI * i / block);
+    }
+    for (unsigned i = 0, bits = vlc_ctz(block); i < block; i++)
+    {
+        unsigned r = 0;
+        for (unsigned b = 0; b < bits; b++)
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        c->bitrev[i] = r;
+    }
+
+    if (threads)
+        c->slices = vlc_slices_New(0);
+
+    c->cmac = cmac_c;
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        c->cmac = cmac_avx2;
+    else
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        c->cmac = cmac_sse2;
+    else
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        c->cmac = cmac_neon;
+    else
+#endif
+        (void) 0;
+
+    return c;
+}
+
+void aconv_Delete(aconv_t *c)
+{
+    if (c->slices != NULL)
+        vlc_slices_Delete(c->slices);
+    for (unsigned i = 0; i < c->pair_count; i++)
+        free(c->pairs[i].spectra);
+    free(c->pairs);
+    free(c->scratch);
+    free(c->output);
+    free(c->fdl);
+    free(c->history);
+    free(c->rsin);
+    free(c->rcos);
+    free(c->bitrev);
+    free(c->sin_tab);
+    free(c->cos_tab);
+    free(c);
+}
+
+int aconv_SetFilter(aconv_t *c, unsigned input, unsigned output,
+                    const float *ir, size_t length, float gain)
+{
+    assert(input < c->inputs && output < c->outputs);
+
+    const unsigned b = c->block;
+    size_t partitions = (length + b - 1) / b;
+    if (partitions == 0)
+        partitions = 1;
+    if (partitions > UINT_MAX / 2 / c->stride)
+        return VLC_ENOMEM;
+
+    struct aconv_pair *pair = NULL;
+    for (unsigned i = 0; i < c->pair_count; i++)
+        if (c->pairs[i].input == input && c->pairs[i].output == output)
+            pair = &c->pairs[i];
+
+    if (pair == NULL)
+    {
+        pair = realloc(c->pairs, (c->pair_count + 1) * sizeof (*pair));
+        if (unlikely(pair == NULL))
+            return VLC_ENOMEM;
+        c->pairs = pair;
+        pair += c->pair_count;
+        pair->input = input;
+        pair->output = output;
+        pair->partitions = 0;
+        pair->spectra = NULL;
+    }
+
+    float *spectra = malloc(partitions * 2 * c->stride * sizeof (float));
+    if (unlikely(spectra == NULL))
+        return VLC_ENOMEM;
+
+    if (partitions > c->partitions)
+    {
+        float *fdl = calloc((size_t)c->inputs * partitions * 2 * c->stride,
+                            sizeof (float));
+        if (unlikely(fdl == NULL))
+        {
+            free(spectra);
+            return VLC_ENOMEM;
+        }
+        free(c->fdl);
+        c->fdl = fdl;
+        c->partitions = partitions;
+    }
+
+    if (pair == c->pairs + c->pair_count)
+        c->pair_count++;
+    else
+        c->work -= (size_t)pair->partitions * c->stride;
+    c->work += partitions * c->stride;
+
+    /* The normalisation of the inverse FFT is folded into the filter */
+    float *time = Lane(c, 0), *z = time + 2 * b;
+    gain /= b;
+    for (size_t p = 0; p < partitions; p++)
+    {
+        size_t n = __MIN(b, length - __MIN(length, p * b));
+
+        for (size_t i = 0; i < n; i++)
+            time[i] = ir[p * b + i] * gain;
+        for (size_t i = n; i < 2 * b; i++)
+            time[i] = 0.f;
+
+        float *re = spectra + p * 2 * c->stride;
+        RealFFT(c, time, z, re, re + c->stride);
+    }
+    free(pair->spectra);
+    pair->spectra = spectra;
+    pair->partitions = partitions;
+
+    aconv_Reset(c);
+    return VLC_SUCCESS;
+}
+
+void aconv_Reset(aconv_t *c)
+{
+    memset(c->history, 0, (size_t)c->inputs * 2 * c->block * sizeof (float));
+    memset(c->fdl, 0, (size_t)c->inputs * c->partitions * 2 * c->stride
+                      * sizeof (float));
+    memset(c->output, 0, (size_t)c->outputs * c->block * sizeof (float));
+    c->pos = 0;
+    c->fdl_pos = 0;
+}
+
+static void TransformInputs(void *opaque, unsigned index, unsigned count)
+{
+    aconv_t *c = opaque;
+    unsigned start, end;
+
+    vlc_slice_Lines(c->inputs, 1, index, count, &start, &end);
+    for (unsigned i = start; i < end; i++)
+    {
+        bool used = false;
+        for (unsigned j = 0; j < c->pair_count && !used; j++)
+            used = c->pairs[j].input == i;
+        if (!used)
+            continue; /* only delayed, e.g. a bypassed channel */
+
+        float *re = Slot(c, i, c->fdl_pos);
+
+        RealFFT(c, c->history + (size_t)i * 2 * c->block, Lane(c, i),
+                re, re + c->stride);
+    }
+}
+
+static void ComputeOutputs(void *opaque, unsigned index, unsigned count)
+{
+    aconv_t *c = opaque;
+    const unsigned b = c->block, stride = c->stride;
+    unsigned start, end;
+
+    vlc_slice_Lines(c->outputs, 1, index, count, &start, &end);
+    for (unsigned o = start; o < end; o++)
+    {
+        float *z = Lane(c, o), *yr = z + 2 * b, *yi = yr + stride;
+
+        memset(yr, 0, 2 * stride * sizeof (float));
+        for (unsigned i = 0; i < c->pair_count; i++)
+        {
+            const struct aconv_pair *pair = &c->pairs[i];
+
+            if (pair->output != o)
+                continue;
+
+            for (unsigned p = 0; p < pair->partitions; p++)
+            {
+                unsigned slot = (c->fdl_pos + c->partitions - p) % c->partitions;
+                const float *xr = Slot(c, pair->input, slot);
+                const float *hr = pair->spectra + p * 2 * stride;
+
+                c->cmac(yr, yi, xr, xr + stride, hr, hr + stride, stride);
+            }
+        }
+
+        /* Overlap-save: only the second half is valid */
+        RealIFFT(c, yr, yi, z);
+        memcpy(c->output + (size_t)o * b, z + b, b * sizeof (float));
+    }
+}
+
+static void ProcessBlock(aconv_t *c)
+{
+    const unsigned b = c->block;
+    unsigned in = 1, out = 1;
+
+    if (c->work >= MIN_THREADED_WORK)
+    {
+        in = vlc_slices_Count(c->slices, c->inputs, 1);
+        out = vlc_slices_Count(c->slices, c->outputs, 1);
+    }
+
+    c->fdl_pos = (c->fdl_pos + 1) % c->partitions;
+    vlc_slices_Run(c->slices, in, TransformInputs, c);
+    vlc_slices_Run(c->slices, out, ComputeOutputs, c);
+
+    for (unsigned i = 0; i < c->inputs; i++)
+    {
+        float *h = c->history + (size_t)i * 2 * b;
+        memcpy(h, h + b, b * sizeof (float));
+    }
+}
+
+unsigned aconv_Available(const aconv_t *c)
+{
+    return c->block - c->pos;
+}
+
+float *aconv_Input(aconv_t *c, unsigned input)
+{
+    assert(input < c->inputs);
+    return c->history + (size_t)input * 2 * c->block + c->block + c->pos;
+}
+
+const float *aconv_Delayed(const aconv_t *c, unsigned input)
+{
+    assert(input < c->inputs);
+    return c->history + (size_t)input * 2 * c->block + c->pos;
+}
+
+const float *aconv_Output(const aconv_t *c, unsigned output)
+{
+    assert(output < c->outputs);
+    return c->output + (size_t)output * c->block + c->pos;
+}
+
+void aconv_Advance(aconv_t *c, unsigned frames)
+{
+    assert(frames <= aconv_Available(c));
+
+    c->pos += frames;
+    if (c->pos == c->block)
+    {
+        ProcessBlock(c);
+        c->pos = 0;
+    }
+}
+
+/*****************************************************************************
+ * Impulse response files
+ *****************************************************************************/
+static float ReadSample(const uint8_t *p, unsigned tag, unsigned bits)
+{
+    if (tag == 3)
+    {
+        if (bits == 64)
+        {
+            union { uint64_t u; double d; } v = { .u = GetQWLE(p) };
+            return v.d;
+        }
+        union { uint32_t u; float f; } v = { .u = GetDWLE(p) };
+        return v.f;
+    }
+
+    switch (bits)
+    {
+        case 8:
+            return (p[0] - 128) / 128.f;
+        case 16:
+            return (int16_t)GetWLE(p) / 32768.f;
+        case 24:
+            return (int32_t)((uint32_t)GetWLE(p) << 8 | (uint32_t)p[2] << 24)
+                   / 2147483648.f;
+        default:
+            return (int32_t)GetDWLE(p) / 2147483648.f;
+    }
+}
+
+int aconv_LoadWav(vlc_object_t *obj, const char *path, unsigned rate,
+                  float **pdata, unsigned *pchannels, size_t *pframes)
+{
+    FILE *file = vlc_fopen(path, "rb");
+    if (file == NULL)
+    {
+        msg_Err(obj, "cannot open %s: %s", path, vlc_strerror_c(errno));
+        return VLC_EGENERIC;
+    }
+
+    uint8_t hdr[40];
+    uint8_t *data = NULL;
+    uint32_t size = 0;
+    unsigned tag = 0, channels = 0, file_rate = 0, align = 0, bits = 0;
+
+    if (fread(hdr, 1, 12, file) != 12 || memcmp(hdr, "RIFF", 4)
+     || memcmp(hdr + 8, "WAVE", 4))
+        goto error;
+
+    while (data == NULL)
+    {
+        if (fread(hdr, 1, 8, file) != 8)
+            goto error;
+        size = GetDWLE(hdr + 4);
+
+        if (!memcmp(hdr, "fmt ", 4))
+        {
+            if (size < 16 || size > sizeof (hdr)
+             || fread(hdr, 1, size, file) != size)
+                goto error;
+            tag = GetWLE(hdr);
+            channels = GetWLE(hdr + 2);
+            file_rate = GetDWLE(hdr + 4);
+            align = GetWLE(hdr + 12);
+            bits = GetWLE(hdr + 14);
+            if (tag == 0xFFFE && size >= 26) /* WAVE_FORMAT_EXTENSIBLE */
+                tag = GetWLE(hdr + 24);
+            if (size & 1)
+                fseek(file, 1, SEEK_CUR);
+        }
+        else if (!memcmp(hdr, "data", 4))
+        {
+            if (channels == 0 || size > MAX_WAV_SIZE)
+                goto error;
+            data = malloc(size);
+            if (unlikely(data == NULL))
+                goto error;
+            size = fread(data, 1, size, file);
+        }
+        else if (fseek(file, size + (size & 1), SEEK_CUR))
+            goto error;
+    }
+    fclose(file);
+    file = NULL;
+
+    if ((tag != 1 && tag != 3) || file_rate == 0
+     || (tag == 1 && bits != 8 && bits != 16 && bits != 24 && bits != 32)
+     || (tag == 3 && bits != 32 && bits != 64)
+     || align != channels * (bits / 8))
+    {
+        msg_Err(obj, "unsupported WAV format in %s", path);
+        free(data);
+        return VLC_EGENERIC;
+    }
+
+    const size_t in_frames = size / align;
+    /* Linear resampling: impulse responses have little energy near the
+     * Nyquist frequency. The gain keeps the energy per second. */
+    const double ratio = (double)file_rate / rate;
+    const size_t frames = in_frames > 0 ? (size_t)((in_frames - 1) / ratio) + 1
+                                        : 0;
+    const float gain = file_rate != rate ? ratio : 1.f;
+
+    if (frames == 0 || frames > MAX_WAV_SIZE / sizeof (float) / channels)
+    {
+        free(data);
+        return VLC_EGENERIC;
+    }
+
+    float *out = malloc(frames * channels * sizeof (float));
+    if (unlikely(out == NULL))
+    {
+        free(data);
+        return VLC_ENOMEM;
+    }
+
+    for (size_t i = 0; i < frames; i++)
+    {
+        double t = i * ratio;
+        size_t n = t;
+        float frac = t - n;
+        size_t n1 = __MIN(n + 1, in_frames - 1);
+
+        for (unsigned ch = 0; ch < channels; ch++)
+        {
+            float a = ReadSample(data + n * align + ch * bits / 8, tag, bits);
+            float b = ReadSample(data + n1 * align + ch * bits / 8, tag, bits);
+            out[ch * frames + i] = (a + (b - a) * frac) * gain;
+        }
+    }
+    free(data);
+
+    msg_Dbg(obj, "loaded %s: %u channels, %zu frames at %u Hz", path,
+            channels, frames, rate);
+    *pdata = out;
+    *pchannels = channels;
+    *pframes = frames;
+    return VLC_SUCCESS;
+
+error:
+    msg_Err(obj, "invalid WAV file %s", path);
+    free(data);
+    if (file != NULL)
+        fclose(file);
+    return VLC_EGENERIC;
+}
@@ -0,0 +1,104 @@
+/*****************************************************************************
+ * conv.h : uniformly partitioned FFT convolution
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_AUDIO_CONV_H
+#define VLC_AUDIO_CONV_H 1
+
+/**
+ * Convolution engine.
+ *
+ * The engine convolves a set of planar input channels with impulse responses
+ * and sums the results into a set of planar output channels. Each (input,
+ * output) pair has its own, optional, impulse response.
+ *
+ * Impulse responses are split in partitions of one block, and convolved in
+ * the frequency domain (overlap-save), so that the cost per sample grows
+ * with the number of partitions rather than with the length of the response.
+ * The output is delayed by exactly one block.
+ */
+typedef struct aconv aconv_t;
+
+/**
+ * Creates a convolution engine.
+ *
+ * \param block partition size in frames (a power of two, at least 16)
+ * \param inputs number of input channels
+ * \param outputs number of output channels
+ * \param threads whether outputs may be computed on several threads
+ */
+aconv_t *aconv_New(unsigned block, unsigned inputs, unsigned outputs,
+                   bool threads);
+void aconv_Delete(aconv_t *);
+
+/**
+ * Sets the impulse response of an (input, output) pair.
+ *
+ * This must be done before any processing.
+ *
+ * \param gain scale factor applied to the response
+ */
+int aconv_SetFilter(aconv_t *, unsigned input, unsigned output,
+                    const float *ir, size_t length, float gain);
+
+/**
+ * Forgets the past input (e.g. after a discontinuity).
+ */
+void aconv_Reset(aconv_t *);
+
+/**
+ * Returns the number of frames that can be exchanged before the next block
+ * is processed.
+ */
+unsigned aconv_Available(const aconv_t *);
+
+/**
+ * Returns where to write the next input frames of a channel.
+ */
+float *aconv_Input(aconv_t *, unsigned input);
+
+/**
+ * Returns the input frames of a channel delayed by one block, i.e. aligned
+ * with aconv_Output() (e.g. for dry/wet mixing).
+ */
+const float *aconv_Delayed(const aconv_t *, unsigned input);
+
+/**
+ * Returns the next output frames of a channel.
+ */
+const float *aconv_Output(const aconv_t *, unsigned output);
+
+/**
+ * Consumes frames after up to aconv_Available() input frames were written
+ * and output frames were read, processing a block if it is complete.
+ */
+void aconv_Advance(aconv_t *, unsigned frames);
+
+/**
+ * Loads an impulse response from a WAV file.
+ *
+ * The response is resampled to the given rate if needed.
+ *
+ * \param data [OUT] planar samples (channels * frames), to be freed
+ * \return VLC_SUCCESS or an error code
+ */
+int aconv_LoadWav(vlc_object_t *, const char *path, unsigned rate,
+                  float **data, unsigned *channels, size_t *frames);
+
+#endif
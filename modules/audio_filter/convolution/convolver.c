@@ -0,0 +1,187 @@
+/*****************************************************************************
+ * convolver.c : impulse response (convolution) reverb
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_plugin.h>
+
+#include "conv.h"
+
+#define BLOCK_FRAMES 256
+
+static int  Open( vlc_object_t * );
+
+#define IR_TEXT N_("Impulse response")
+#define IR_LONGTEXT N_("WAV file containing the impulse response of the " \
+    "room to simulate. Each input channel uses one channel of the file, " \
+    "cycling when the file has fewer channels.")
+#define MIX_TEXT N_("Wet mix")
+#define MIX_LONGTEXT N_("Proportion of the convolved signal in the output.")
+
+vlc_module_begin ()
+    set_shortname( N_("Convolver") )
+    set_description( N_("Impulse response reverb") )
+    set_subcategory( SUBCAT_AUDIO_AFILTER )
+    set_capability( "audio filter", 0 )
+    set_callback( Open )
+    add_shortcut( "convolver" )
+
+    add_loadfile( "convolver-ir", NULL, IR_TEXT, IR_LONGTEXT )
+    add_float_with_range( "convolver-mix", 0.5, 0.0, 1.0,
+                          MIX_TEXT, MIX_LONGTEXT )
+vlc_module_end ()
+
+typedef struct
+{
+    aconv_t *conv;
+    float mix;
+} filter_sys_t;
+
+static block_t *Filter( filter_t *filter, block_t *block )
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned channels = filter->fmt_in.audio.i_channels;
+    const float dry = 1.f - sys->mix, wet = sys->mix;
+    float *buf = (float *)block->p_buffer;
+
+    if( block->i_flags & BLOCK_FLAG_DISCONTINUITY )
+        aconv_Reset( sys->conv );
+
+    for( size_t done = 0; done < block->i_nb_samples; )
+    {
+        unsigned n = aconv_Available( sys->conv );
+
+        if( n > block->i_nb_samples - done )
+            n = block->i_nb_samples - done;
+
+        /* Output frames are read back at the same position: in place */
+        for( unsigned c = 0; c < channels; c++ )
+        {
+            float *in = aconv_Input( sys->conv, c );
+            const float *src = buf + c;
+
+            for( unsigned i = 0; i < n; i++ )
+                in[i] = src[i * channels];
+        }
+
+        for( unsigned c = 0; c < channels; c++ )
+        {
+            const float *delayed = aconv_Delayed( sys->conv, c );
+            const float *out = aconv_Output( sys->conv, c );
+            float *dst = buf + c;
+
+            for( unsigned i = 0; i < n; i++ )
+                dst[i * channels] = dry * delayed[i] + wet * out[i];
+        }
+
+        aconv_Advance( sys->conv, n );
+        buf += n * channels;
+        done += n;
+    }
+    return block;
+}
+
+static void Flush( filter_t *filter )
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    aconv_Reset( sys->conv );
+}
+
+static void Close( filter_t *filter )
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    aconv_Delete( sys->conv );
+    free( sys );
+}
+
+static int Open( vlc_object_t *obj )
+{
+    filter_t *filter = (filter_t *)obj;
+    audio_format_t *fmt = &filter->fmt_in.audio;
+
+    char *path = var_InheritString( filter, "convolver-ir" );
+    if( path == NULL )
+    {
+        msg_Err( filter, "no impulse response file specified" );
+        return VLC_EGENERIC;
+    }
+
+    fmt->i_format = VLC_CODEC_FL32;
+    aout_FormatPrepare( fmt );
+    filter->fmt_out.audio = *fmt;
+
+    float *ir;
+    unsigned ir_channels;
+    size_t ir_frames;
+    int ret = aconv_LoadWav( obj, path, fmt->i_rate, &ir, &ir_channels,
+                             &ir_frames );
+    free( path );
+    if( ret != VLC_SUCCESS )
+        return ret;
+
+    filter_sys_t *sys = malloc( sizeof (*sys) );
+    if( unlikely(sys == NULL) )
+    {
+        free( ir );
+        return VLC_ENOMEM;
+    }
+
+    sys->mix = var_InheritFloat( filter, "convolver-mix" );
+    sys->conv = aconv_New( BLOCK_FRAMES, fmt->i_channels, fmt->i_channels,
+                           true );
+    if( unlikely(sys->conv == NULL) )
+        goto error;
+
+    for( unsigned c = 0; c < fmt->i_channels; c++ )
+    {
+        const float *h = ir + (c % ir_channels) * ir_frames;
+
+        if( aconv_SetFilter( sys->conv, c, c, h, ir_frames, 1.f ) )
+            goto error;
+    }
+    free( ir );
+
+    msg_Dbg( filter, "convolving %u channel(s) with %zu frames response",
+             fmt->i_channels, ir_frames );
+
+    static const struct vlc_filter_operations filter_ops =
+    {
+        .filter_audio = Filter, .flush = Flush, .close = Close,
+    };
+    filter->p_sys = sys;
+    filter->ops = &filter_ops;
+    return VLC_SUCCESS;
+
+error:
+    if( sys->conv != NULL )
+        aconv_Delete( sys->conv );
+    free( sys );
+    free( ir );
+    return VLC_ENOMEM;
+}
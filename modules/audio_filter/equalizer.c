@@ -28,6 +28,7 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
 #include <math.h>
 
 #include <vlc_common.h>
@@ -38,9 +39,9 @@
 #include <vlc_filter.h>
 
 #include "equalizer_presets.h"
+#include "planar.h"
 
 /* TODO:
- *  - optimize a bit (you can hardly do slower ;)
  *  - add tables for more bands (15 and 32 would be cool), maybe with auto coeffs
  *    computation (not too hard once the Q is found).
  *  - support for external preset
@@ -99,6 +100,8 @@ vlc_module_end ()
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
+#define EQZ_CHANNELS_MAX 32
+
 typedef struct
 {
     /* Filter static config */
@@ -112,13 +115,13 @@ typedef struct
     float f_gamp;   /* Global preamp */
     bool b_2eqz;
 
-    /* Filter state */
-    float x[32][2];
-    float y[32][128][2];
+    /* Filter state, planar (see planar.h) */
+    float x[2][EQZ_CHANNELS_MAX];
+    float y[EQZ_BANDS_MAX][2][EQZ_CHANNELS_MAX];
 
     /* Second filter state */
-    float x2[32][2];
-    float y2[32][128][2];
+    float x2[2][EQZ_CHANNELS_MAX];
+    float y2[EQZ_BANDS_MAX][2][EQZ_CHANNELS_MAX];
 
     vlc_mutex_t lock;
 } filter_sys_t;
@@ -280,7 +283,7 @@ static int EqzInit( filter_t *p_filter, int i_rate )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
     eqz_config_t cfg;
-    int i, ch;
+    int i;
     vlc_value_t val1, val2, val3;
     vlc_object_t *p_aout = vlc_object_parent(p_filter);
     int i_ret = VLC_ENOMEM;
@@ -316,21 +319,10 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     }
 
     /* Filter state */
-    for( ch = 0; ch < 32; ch++ )
-    {
-        p_sys->x[ch][0]  =
-        p_sys->x[ch][1]  =
-        p_sys->x2[ch][0] =
-        p_sys->x2[ch][1] = 0.0f;
-
-        for( i = 0; i < p_sys->i_band; i++ )
-        {
-            p_sys->y[ch][i][0]  =
-            p_sys->y[ch][i][1]  =
-            p_sys->y2[ch][i][0] =
-            p_sys->y2[ch][i][1] = 0.0f;
-        }
-    }
+    memset( p_sys->x, 0, sizeof (p_sys->x) );
+    memset( p_sys->y, 0, sizeof (p_sys->y) );
+    memset( p_sys->x2, 0, sizeof (p_sys->x2) );
+    memset( p_sys->y2, 0, sizeof (p_sys->y2) );
 
     var_Create( p_aout, "equalizer-bands", VLC_VAR_STRING | VLC_VAR_DOINHERIT );
     var_Create( p_aout, "equalizer-preset", VLC_VAR_STRING | VLC_VAR_DOINHERIT );
@@ -385,66 +377,102 @@ error:
     return i_ret;
 }
 
-static void EqzFilter( filter_t *p_filter, float *out, float *in,
-                       int i_samples, int i_channels )
+/* Filters n (at most AFV_LANES) channels starting at ch */
+static void EqzFilterLanes( filter_sys_t *p_sys, float *out, const float *in,
+                            int i_samples, int i_channels, int ch, unsigned n )
 {
-    filter_sys_t *p_sys = p_filter->p_sys;
-    int i, ch, j;
+    const int i_band = p_sys->i_band;
+    const float f_gamp = p_sys->f_gamp;
+    afv_t x[2], y[EQZ_BANDS_MAX][2];
+    afv_t x2[2], y2[EQZ_BANDS_MAX][2];
 
-    vlc_mutex_lock( &p_sys->lock );
-    for( i = 0; i < i_samples; i++ )
+    for( int k = 0; k < 2; k++ )
     {
-        for( ch = 0; ch < i_channels; ch++ )
+        x[k]  = afv_Load( &p_sys->x[k][ch], AFV_LANES );
+        x2[k] = afv_Load( &p_sys->x2[k][ch], AFV_LANES );
+        for( int j = 0; j < i_band; j++ )
         {
-            const float x = in[ch];
-            float o = 0.0f;
+            y[j][k]  = afv_Load( &p_sys->y[j][k][ch], AFV_LANES );
+            y2[j][k] = afv_Load( &p_sys->y2[j][k][ch], AFV_LANES );
+        }
+    }
 
-            for( j = 0; j < p_sys->i_band; j++ )
-            {
-                float y = p_sys->f_alpha[j] * ( x - p_sys->x[ch][1] ) +
-                          p_sys->f_gamma[j] * p_sys->y[ch][j][0] -
-                          p_sys->f_beta[j]  * p_sys->y[ch][j][1];
+    for( int i = 0; i < i_samples; i++ )
+    {
+        const afv_t in1 = afv_Load( in, n );
+        afv_t o = { 0 };
 
-                p_sys->y[ch][j][1] = p_sys->y[ch][j][0];
-                p_sys->y[ch][j][0] = y;
+        for( int j = 0; j < i_band; j++ )
+        {
+            afv_t v = p_sys->f_alpha[j] * ( in1 - x[1] ) +
+                      p_sys->f_gamma[j] * y[j][0] -
+                      p_sys->f_beta[j]  * y[j][1];
 
-                o += y * p_sys->f_amp[j];
-            }
-            p_sys->x[ch][1] = p_sys->x[ch][0];
-            p_sys->x[ch][0] = x;
+            y[j][1] = y[j][0];
+            y[j][0] = v;
 
-            /* Second filter */
-            if( p_sys->b_2eqz )
-            {
-                const float x2 = EQZ_IN_FACTOR * x + o;
-                o = 0.0f;
-                for( j = 0; j < p_sys->i_band; j++ )
-                {
-                    float y = p_sys->f_alpha[j] * ( x2 - p_sys->x2[ch][1] ) +
-                              p_sys->f_gamma[j] * p_sys->y2[ch][j][0] -
-                              p_sys->f_beta[j]  * p_sys->y2[ch][j][1];
-
-                    p_sys->y2[ch][j][1] = p_sys->y2[ch][j][0];
-                    p_sys->y2[ch][j][0] = y;
-
-                    o += y * p_sys->f_amp[j];
-                }
-                p_sys->x2[ch][1] = p_sys->x2[ch][0];
-                p_sys->x2[ch][0] = x2;
-
-                /* We add source PCM + filtered PCM */
-                out[ch] = p_sys->f_gamp * p_sys->f_gamp *( EQZ_IN_FACTOR * x2 + o );
-            }
-            else
+            o += v * p_sys->f_amp[j];
+        }
+        x[1] = x[0];
+        x[0] = in1;
+
+        /* Second filter */
+        if( p_sys->b_2eqz )
+        {
+            const afv_t in2 = EQZ_IN_FACTOR * in1 + o;
+            afv_t o2 = { 0 };
+
+            for( int j = 0; j < i_band; j++ )
             {
-                /* We add source PCM + filtered PCM */
-                out[ch] = p_sys->f_gamp *( EQZ_IN_FACTOR * x + o );
+                afv_t v = p_sys->f_alpha[j] * ( in2 - x2[1] ) +
+                          p_sys->f_gamma[j] * y2[j][0] -
+                          p_sys->f_beta[j]  * y2[j][1];
+
+                y2[j][1] = y2[j][0];
+                y2[j][0] = v;
+
+                o2 += v * p_sys->f_amp[j];
             }
+            x2[1] = x2[0];
+            x2[0] = in2;
+
+            /* We add source PCM + filtered PCM */
+            afv_Store( out, f_gamp * f_gamp *( EQZ_IN_FACTOR * in2 + o2 ), n );
+        }
+        else
+        {
+            /* We add source PCM + filtered PCM */
+            afv_Store( out, f_gamp *( EQZ_IN_FACTOR * in1 + o ), n );
         }
 
         in  += i_channels;
         out += i_channels;
     }
+
+    for( int k = 0; k < 2; k++ )
+    {
+        afv_Store( &p_sys->x[k][ch], x[k], AFV_LANES );
+        afv_Store( &p_sys->x2[k][ch], x2[k], AFV_LANES );
+        for( int j = 0; j < i_band; j++ )
+        {
+            afv_Store( &p_sys->y[j][k][ch], y[j][k], AFV_LANES );
+            afv_Store( &p_sys->y2[j][k][ch], y2[j][k], AFV_LANES );
+        }
+    }
+}
+
+static void EqzFilter( filter_t *p_filter, float *out, float *in,
+                       int i_samples, int i_channels )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    assert( i_channels <= EQZ_CHANNELS_MAX );
+
+    /* The bands are recursive in time, but channels are independent */
+    vlc_mutex_lock( &p_sys->lock );
+    for( int ch = 0; ch < i_channels; ch += AFV_LANES )
+        EqzFilterLanes( p_sys, out + ch, in + ch, i_samples, i_channels, ch,
+                        __MIN( (unsigned)(i_channels - ch), AFV_LANES ) );
     vlc_mutex_unlock( &p_sys->lock );
 }
 
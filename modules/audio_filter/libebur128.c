@@ -118,7 +118,7 @@ SendLoudnessMeter(filter_t *filter)
         for (unsigned i = 0; i < filter->fmt_in.audio.i_channels; ++i)
         {
             double truepeak;
-            error = ebur128_true_peak(sys->state, 0, &truepeak);
+            error = ebur128_true_peak(sys->state, i, &truepeak);
             if (error != EBUR128_SUCCESS)
                 return error;
             if (truepeak > loudness.truepeak)
@@ -36,6 +36,8 @@
 #include <vlc_aout.h>
 #include <vlc_filter.h>
 
+#include "planar.h"
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -43,7 +45,7 @@ static int  Open ( vlc_object_t * );
 static void Close( filter_t * );
 static void CalcPeakEQCoeffs( float, float, float, float, float * );
 static void CalcShelfEQCoeffs( float, float, float, int, float, float * );
-static void ProcessEQ( const float *, float *, float *, unsigned, unsigned,
+static void ProcessEQ( const float *, float *, afv_t *, unsigned, unsigned,
                        const float *, unsigned );
 static block_t *DoWork( filter_t *, block_t * );
 
@@ -92,7 +94,7 @@ typedef struct
     /* Filter computed coeffs */
     float   coeffs[5*5];
     /* State */
-    float  *p_state;
+    afv_t  *p_state;
 } filter_sys_t;
 
 
@@ -149,8 +151,15 @@ static int Open( vlc_object_t *p_this )
                       i_samplerate, p_sys->coeffs+3*5);
     CalcShelfEQCoeffs(p_sys->f_highf, 1, p_sys->f_highgain, 0,
                       i_samplerate, p_sys->coeffs+4*5);
-    p_sys->p_state = (float*)calloc( p_filter->fmt_in.audio.i_channels*5*4,
-                                     sizeof(float) );
+    size_t i_state = (p_filter->fmt_in.audio.i_channels + AFV_LANES - 1)
+                   / AFV_LANES * 5 * 4 * sizeof (afv_t);
+    p_sys->p_state = aligned_alloc( sizeof (afv_t), i_state );
+    if( !p_sys->p_state )
+    {
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
+    memset( p_sys->p_state, 0, i_state );
 
     return VLC_SUCCESS;
 }
@@ -158,7 +167,7 @@ static int Open( vlc_object_t *p_this )
 static void Close( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    free( p_sys->p_state );
+    aligned_free( p_sys->p_state );
     free( p_sys );
 }
 
@@ -281,45 +290,49 @@ static void CalcShelfEQCoeffs( float f0, float slope, float gainDB, int high,
 /*
   src is assumed to be interleaved
   dest is assumed to be interleaved
-  size of state is 4*channels*eqCount
+  state is planar (see planar.h): 4*eqCount vectors per group of channels
   samples is not premultiplied by channels
   size of coeffs is 5*eqCount
 */
-void ProcessEQ( const float *src, float *dest, float *state,
-                unsigned channels, unsigned samples, const float *coeffs,
-                unsigned eqCount )
+static void ProcessEQLanes( const float *src, float *dest, afv_t *state,
+                            unsigned channels, unsigned n, unsigned samples,
+                            const float *coeffs, unsigned eqCount )
 {
-    unsigned i, chn, eq;
-    float   b0, b1, b2, a1, a2;
-    float   x, y = 0;
-    const float *src1 = src;
-    float *dest1 = dest;
-
-    for (i = 0; i < samples; i++)
+    for (unsigned i = 0; i < samples; i++)
     {
-        float *state1 = state;
-        for (chn = 0; chn < channels; chn++)
+        afv_t *state1 = state;
+        const float *coeffs1 = coeffs;
+        afv_t x = afv_Load(src, n), y = { 0 };
+
+        /* Direct form 1 IIRs */
+        for (unsigned eq = 0; eq < eqCount; eq++)
         {
-            const float *coeffs1 = coeffs;
-            x = *src1++;
-            /* Direct form 1 IIRs */
-            for (eq = 0; eq < eqCount; eq++)
-            {
-                b0 = coeffs1[0];
-                b1 = coeffs1[1];
-                b2 = coeffs1[2];
-                a1 = coeffs1[3];
-                a2 = coeffs1[4];
-                coeffs1 += 5;
-                y = x*b0 + state1[0]*b1 + state1[1]*b2 - state1[2]*a1 - state1[3]*a2;
-                state1[1] = state1[0];
-                state1[0] = x;
-                state1[3] = state1[2];
-                state1[2] = y;
-                x = y;
-                state1 += 4;
-            }
-            *dest1++ = y;
+            y = x*coeffs1[0] + state1[0]*coeffs1[1] + state1[1]*coeffs1[2]
+              - state1[2]*coeffs1[3] - state1[3]*coeffs1[4];
+            state1[1] = state1[0];
+            state1[0] = x;
+            state1[3] = state1[2];
+            state1[2] = y;
+            x = y;
+            coeffs1 += 5;
+            state1 += 4;
         }
+        afv_Store(dest, y, n);
+        src += channels;
+        dest += channels;
+    }
+}
+
+void ProcessEQ( const float *src, float *dest, afv_t *state,
+                unsigned channels, unsigned samples, const float *coeffs,
+                unsigned eqCount )
+{
+    /* The filters are recursive in time, but channels are independent */
+    for (unsigned chn = 0; chn < channels; chn += AFV_LANES)
+    {
+        ProcessEQLanes(src + chn, dest + chn, state, channels,
+                       __MIN(channels - chn, AFV_LANES), samples,
+                       coeffs, eqCount);
+        state += 4 * eqCount;
     }
 }
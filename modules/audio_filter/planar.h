@@ -0,0 +1,100 @@
+/*****************************************************************************
+ * planar.h : helpers to filter several channels at once
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_AUDIO_FILTER_PLANAR_H
+#define VLC_AUDIO_FILTER_PLANAR_H 1
+
+#include <string.h>
+
+/**
+ * Recursive filters (biquads, envelopes...) cannot be vectorised along time,
+ * but the channels of a frame are independent. The filter state is thus
+ * stored planar, AFV_LANES channels side by side, and each group of channels
+ * is processed as one vector: SSE2 on x86, NEON on ARM, plain floats
+ * otherwise. Operations on afv_t values also accept a scalar operand.
+ */
+#if defined __has_attribute
+# if __has_attribute(__vector_size__)
+#  define AFV_LANES 4
+typedef float afv_t __attribute__((__vector_size__(16)));
+# endif
+#endif
+
+#ifdef AFV_LANES
+/**
+ * Loads the first n (at most AFV_LANES) values, zeroing the other lanes.
+ */
+static inline afv_t afv_Load(const float *p, unsigned n)
+{
+    afv_t v;
+
+    switch (n)
+    {
+        case 1:
+            return (afv_t){ p[0] };
+        case 2:
+            return (afv_t){ p[0], p[1] };
+        case 3:
+            return (afv_t){ p[0], p[1], p[2] };
+        default:
+            memcpy(&v, p, sizeof (v));
+            return v;
+    }
+}
+
+/**
+ * Stores the first n (at most AFV_LANES) lanes.
+ */
+static inline void afv_Store(float *p, afv_t v, unsigned n)
+{
+    switch (n)
+    {
+        case 3:
+            p[2] = v[2];
+            /* fall through */
+        case 2:
+            p[1] = v[1];
+            /* fall through */
+        case 1:
+            p[0] = v[0];
+            break;
+        default:
+            memcpy(p, &v, sizeof (v));
+    }
+}
+
+#else
+# define AFV_LANES 1
+typedef float afv_t;
+
+static inline afv_t afv_Load(const float *p, unsigned n)
+{
+    (void) n;
+    return *p;
+}
+
+static inline void afv_Store(float *p, afv_t v, unsigned n)
+{
+    (void) n;
+    *p = v;
+}
+#endif
+
+#endif
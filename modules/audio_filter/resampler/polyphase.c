@@ -0,0 +1,629 @@
+/*****************************************************************************
+ * polyphase.c : polyphase windowed-sinc audio resampler
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble:
+ *
+ * The low-pass filter is a Kaiser-windowed sinc, tabulated for PHASES
+ * fractional positions; coefficients between two phases are linearly
+ * interpolated. Any ratio can thus be reached with the same table, and the
+ * small rate changes of the clock drift compensation only change the step
+ * of the input position.
+ *
+ * Each output frame is computed for all the channels at once, from
+ * interleaved samples, with one vector lane per channel. Groups of
+ * channels are split across threads for wide layouts.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_plugin.h>
+#include <vlc_cpu.h>
+
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
+#include "../../video_chroma/slices.h"
+
+#define QUALITY_TEXT N_("Resampling quality")
+#define QUALITY_LONGTEXT N_("Length of the interpolation filter. " \
+    "Longer filters have a sharper cut-off and less aliasing, at some " \
+    "processing cost.")
+
+static const int quality_values[] = { 0, 1, 2 };
+static const char *const quality_texts[] = {
+    N_("Fast"), N_("Normal"), N_("High"),
+};
+
+static int Open(vlc_object_t *);
+static int OpenResampler(vlc_object_t *);
+
+vlc_module_begin()
+    set_shortname(N_("Polyphase resampler"))
+    set_description(N_("Polyphase windowed-sinc audio resampler"))
+    set_subcategory(SUBCAT_AUDIO_RESAMPLER)
+    add_integer("polyphase-resampler-quality", 1,
+                QUALITY_TEXT, QUALITY_LONGTEXT)
+        change_integer_list(quality_values, quality_texts)
+    set_capability("audio converter", 30)
+    set_callback(Open)
+
+    add_submodule()
+    set_capability("audio resampler", 30)
+    set_callback(OpenResampler)
+    add_shortcut("polyphase")
+vlc_module_end()
+
+#define PHASE_BITS 8
+#define PHASES (1 << PHASE_BITS) /**< tabulated fractional positions */
+#define FRAC_BITS 32 /**< fixed-point bits of the input position */
+
+/** Channels of a threading unit (one AVX vector) */
+#define GROUP 8
+
+static const struct
+{
+    unsigned taps; /**< filter length, multiple of 8 */
+    double beta; /**< Kaiser window parameter */
+    double rolloff; /**< cut-off relative to the Nyquist frequency */
+} qualities[] = {
+    { 16,  6.0, 0.90 },
+    { 32,  8.0, 0.94 },
+    { 64, 10.0, 0.97 },
+};
+
+typedef void (*resample_cb)(float *restrict dst, const float *src,
+                            const float *coefs, const size_t *offsets,
+                            size_t frames, unsigned channels, unsigned taps,
+                            unsigned first, unsigned last);
+
+typedef struct
+{
+    unsigned channels;
+    unsigned taps;
+    double beta;
+    double rolloff;
+    double cutoff; /**< cut-off that the table was built for */
+    float *table; /**< (PHASES + 1) rows of taps coefficients */
+
+    /* Pending input frames, including the filter history */
+    float *buf;
+    size_t buf_frames;
+    size_t buf_size; /**< allocated frames */
+    uint64_t pos; /**< input position of the next output, 32.32 */
+
+    /* Per-block interpolated coefficients */
+    float *coefs;
+    size_t *offsets;
+    size_t coefs_size; /**< allocated output frames */
+
+    resample_cb resample;
+    vlc_slices_t *slices;
+} filter_sys_t;
+
+/*****************************************************************************
+ * Filter design
+ *****************************************************************************/
+static double BesselI0(double x)
+{
+    double sum = 1., term = 1.;
+
+    for (unsigned k = 1; term > sum * 1e-12; k++)
+    {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+static int BuildTable(filter_sys_t *sys, double cutoff)
+{
+    const unsigned taps = sys->taps;
+    const double half = taps / 2;
+    float *table = aligned_alloc(32, (PHASES + 1) * taps * sizeof (*table));
+
+    if (unlikely(table == NULL))
+        return VLC_ENOMEM;
+
+    const double norm = BesselI0(sys->beta);
+
+    for (unsigned p = 0; p <= PHASES; p++)
+    {
+        float *row = table + p * taps;
+        double sum = 0.;
+
+        /* Tap k weighs the input frame (half - 1 - k) before the position */
+        for (unsigned k = 0; k < taps; k++)
+        {
+            double t = (double)p / PHASES + half - 1 - k;
+            double x = t / half;
+            double h = cutoff;
+
+            if (t != 0.)
+                h = sin(M_PI * cutoff * t) / (M_PI * t);
+            h *= (fabs(x) < 1.) ? BesselI0(sys->beta * sqrt(1. - x * x)) / norm
+                                : 0.;
+            row[k] = h;
+            sum += h;
+        }
+        /* Unity gain at DC for every phase */
+        for (unsigned k = 0; k < taps; k++)
+            row[k] /= sum;
+    }
+
+    free(sys->table);
+    sys->table = table;
+    sys->cutoff = cutoff;
+    return VLC_SUCCESS;
+}
+
+static double Cutoff(const filter_sys_t *sys, unsigned irate, unsigned orate)
+{
+    return sys->rolloff * ((orate < irate) ? (double)orate / irate : 1.);
+}
+
+/*****************************************************************************
+ * Sample loops
+ *****************************************************************************
+ * Output frame i of channel c is the dot product of the taps coefficients
+ * of coefs[i] with the channel c of the frames from src + offsets[i]. The
+ * loops process channels first to last - 1.
+ *****************************************************************************/
+static void ResampleChannels_C(float *restrict dst, const float *src,
+                               const float *coefs, const size_t *offsets,
+                               size_t frames, unsigned channels,
+                               unsigned taps, unsigned c, unsigned last)
+{
+    for (size_t i = 0; i < frames; i++)
+    {
+        const float *in = src + offsets[i] * channels;
+        const float *h = coefs + i * taps;
+
+        for (unsigned ch = c; ch < last; ch++)
+        {
+            float acc = 0.f;
+
+            for (unsigned k = 0; k < taps; k++)
+                acc += in[k * channels + ch] * h[k];
+            dst[i * channels + ch] = acc;
+        }
+    }
+}
+
+#ifdef CAN_COMPILE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static void Resample_SSE2(float *restrict dst, const float *src,
+                          const float *coefs, const size_t *offsets,
+                          size_t frames, unsigned channels, unsigned taps,
+                          unsigned first, unsigned last)
+{
+    unsigned c = first;
+
+    for (; c + 4 <= last; c += 4)
+        for (size_t i = 0; i < frames; i++)
+        {
+            const float *in = src + offsets[i] * channels + c;
+            const float *h = coefs + i * taps;
+            __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+
+            for (unsigned k = 0; k < taps; k += 2)
+            {
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(in),
+                                                   _mm_set1_ps(h[k])));
+                acc1 = _mm_add_ps(acc1,
+                                  _mm_mul_ps(_mm_loadu_ps(in + channels),
+                                             _mm_set1_ps(h[k + 1])));
+                in += 2 * channels;
+            }
+            _mm_storeu_ps(dst + i * channels + c, _mm_add_ps(acc0, acc1));
+        }
+
+    ResampleChannels_C(dst, src, coefs, offsets, frames, channels, taps,
+                       c, last);
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__ ((__target__ ("avx2")))
+static void Resample_AVX2(float *restrict dst, const float *src,
+                          const float *coefs, const size_t *offsets,
+                          size_t frames, unsigned channels, unsigned taps,
+                          unsigned first, unsigned last)
+{
+    unsigned c = first;
+
+    for (; c + 8 <= last; c += 8)
+        for (size_t i = 0; i < frames; i++)
+        {
+            const float *in = src + offsets[i] * channels + c;
+            const float *h = coefs + i * taps;
+            __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+
+            for (unsigned k = 0; k < taps; k += 2)
+            {
+                acc0 = _mm256_add_ps(acc0,
+                                     _mm256_mul_ps(_mm256_loadu_ps(in),
+                                                   _mm256_set1_ps(h[k])));
+                acc1 = _mm256_add_ps(acc1,
+                         _mm256_mul_ps(_mm256_loadu_ps(in + channels),
+                                       _mm256_set1_ps(h[k + 1])));
+                in += 2 * channels;
+            }
+            _mm256_storeu_ps(dst + i * channels + c,
+                             _mm256_add_ps(acc0, acc1));
+        }
+
+    for (; c + 4 <= last; c += 4)
+        for (size_t i = 0; i < frames; i++)
+        {
+            const float *in = src + offsets[i] * channels + c;
+            const float *h = coefs + i * taps;
+            __m128 acc = _mm_setzero_ps();
+
+            for (unsigned k = 0; k < taps; k++)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(in + k * channels),
+                                                 _mm_set1_ps(h[k])));
+            _mm_storeu_ps(dst + i * channels + c, acc);
+        }
+
+    ResampleChannels_C(dst, src, coefs, offsets, frames, channels, taps,
+                       c, last);
+}
+#endif
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+static void Resample_NEON(float *restrict dst, const float *src,
+                          const float *coefs, const size_t *offsets,
+                          size_t frames, unsigned channels, unsigned taps,
+                          unsigned first, unsigned last)
+{
+    unsigned c = first;
+
+    for (; c + 8 <= last; c += 8)
+        for (size_t i = 0; i < frames; i++)
+        {
+            const float *in = src + offsets[i] * channels + c;
+            const float *h = coefs + i * taps;
+            float32x4_t acc0 = vdupq_n_f32(0.f), acc1 = vdupq_n_f32(0.f);
+
+            for (unsigned k = 0; k < taps; k++)
+            {
+                acc0 = vfmaq_n_f32(acc0, vld1q_f32(in), h[k]);
+                acc1 = vfmaq_n_f32(acc1, vld1q_f32(in + 4), h[k]);
+                in += channels;
+            }
+            vst1q_f32(dst + i * channels + c, acc0);
+            vst1q_f32(dst + i * channels + c + 4, acc1);
+        }
+
+    for (; c + 4 <= last; c += 4)
+        for (size_t i = 0; i < frames; i++)
+        {
+            const float *in = src + offsets[i] * channels + c;
+            const float *h = coefs + i * taps;
+            float32x4_t acc = vdupq_n_f32(0.f);
+
+            for (unsigned k = 0; k < taps; k++)
+                acc = vfmaq_n_f32(acc, vld1q_f32(in + k * channels), h[k]);
+            vst1q_f32(dst + i * channels + c, acc);
+        }
+
+    ResampleChannels_C(dst, src, coefs, offsets, frames, channels, taps,
+                       c, last);
+}
+#endif
+
+/*****************************************************************************
+ * Processing
+ *****************************************************************************/
+struct resample_run
+{
+    filter_sys_t *sys;
+    float *dst;
+    size_t frames;
+};
+
+static void ResampleSlice(void *opaque, unsigned index, unsigned count)
+{
+    const struct resample_run *run = opaque;
+    const filter_sys_t *sys = run->sys;
+    unsigned first, last;
+
+    vlc_slice_Lines(sys->channels, GROUP, index, count, &first, &last);
+    sys->resample(run->dst, sys->buf, sys->coefs, sys->offsets, run->frames,
+                  sys->channels, sys->taps, first, last);
+}
+
+/** Makes room for the given count of input frames */
+static int Reserve(filter_sys_t *sys, size_t frames)
+{
+    size_t size = sys->buf_frames + frames;
+
+    if (size <= sys->buf_size)
+        return VLC_SUCCESS;
+
+    float *buf = realloc(sys->buf, size * sys->channels * sizeof (*buf));
+    if (unlikely(buf == NULL))
+        return VLC_ENOMEM;
+    sys->buf = buf;
+    sys->buf_size = size;
+    return VLC_SUCCESS;
+}
+
+/**
+ * Computes the output frames that the pending input allows, and drops the
+ * input that is no longer needed.
+ */
+static block_t *Process(filter_t *filter, vlc_tick_t pts)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned irate = filter->fmt_in.audio.i_rate;
+    const unsigned orate = filter->fmt_out.audio.i_rate;
+    const unsigned taps = sys->taps;
+
+    /* Only rebuild the filter for large rate changes (playback speed) */
+    double cutoff = Cutoff(sys, irate, orate);
+    if (fabs(cutoff - sys->cutoff) > .05 * sys->cutoff
+     && BuildTable(sys, cutoff))
+        return NULL;
+
+    const uint64_t step = ((uint64_t)irate << FRAC_BITS) / orate;
+    const uint64_t end = (uint64_t)(sys->buf_frames - taps + 1) << FRAC_BITS;
+    size_t frames = 0;
+
+    if (sys->buf_frames >= taps && sys->pos < end)
+        frames = (end - sys->pos + step - 1) / step;
+    if (frames == 0)
+        return NULL;
+
+    if (frames > sys->coefs_size)
+    {
+        free(sys->coefs);
+        free(sys->offsets);
+        sys->coefs = aligned_alloc(32, frames * taps * sizeof (*sys->coefs));
+        sys->offsets = malloc(frames * sizeof (*sys->offsets));
+        sys->coefs_size = frames;
+        if (unlikely(sys->coefs == NULL || sys->offsets == NULL))
+        {
+            free(sys->coefs);
+            free(sys->offsets);
+            sys->coefs = NULL;
+            sys->offsets = NULL;
+            sys->coefs_size = 0;
+            return NULL;
+        }
+    }
+
+    block_t *out = block_Alloc(frames * filter->fmt_out.audio.i_bytes_per_frame);
+    if (unlikely(out == NULL))
+        return NULL;
+
+    /* Interpolate the coefficients of each output between two phases */
+    uint64_t pos = sys->pos;
+    for (size_t i = 0; i < frames; i++, pos += step)
+    {
+        const uint32_t frac = pos;
+        const float *r0 = sys->table + (frac >> (FRAC_BITS - PHASE_BITS)) * taps;
+        const float *r1 = r0 + taps;
+        const float w = (frac & ((1u << (FRAC_BITS - PHASE_BITS)) - 1))
+                        * (1.f / (1u << (FRAC_BITS - PHASE_BITS)));
+        float *h = sys->coefs + i * taps;
+
+        for (unsigned k = 0; k < taps; k++)
+            h[k] = r0[k] + w * (r1[k] - r0[k]);
+        sys->offsets[i] = pos >> FRAC_BITS;
+    }
+
+    struct resample_run run = {
+        .sys = sys, .dst = (float *)out->p_buffer, .frames = frames,
+    };
+    unsigned groups = (sys->channels + GROUP - 1) / GROUP;
+    vlc_slices_Run(sys->slices, vlc_slices_Count(sys->slices, groups, 1),
+                   ResampleSlice, &run);
+
+    /* The first output is centred half a filter after the input position
+     * sys->pos, relative to the first frame of the buffer (dated pts). */
+    const double ahead = (double)sys->pos / (UINT64_C(1) << FRAC_BITS)
+                       + (taps / 2 - 1);
+    out->i_pts = pts + vlc_tick_from_sec(ahead / irate);
+    out->i_nb_samples = frames;
+    out->i_length = vlc_tick_from_samples(frames, orate);
+
+    /* Drop the input that later outputs do not need */
+    size_t consumed = pos >> FRAC_BITS;
+    if (consumed > sys->buf_frames)
+        consumed = sys->buf_frames;
+    memmove(sys->buf, sys->buf + consumed * sys->channels,
+            (sys->buf_frames - consumed) * sys->channels * sizeof (float));
+    sys->buf_frames -= consumed;
+    sys->pos = pos - ((uint64_t)consumed << FRAC_BITS);
+    return out;
+}
+
+/** Returns the date of the first pending input frame */
+static vlc_tick_t BufferDate(const filter_t *filter, vlc_tick_t pts,
+                             size_t queued)
+{
+    return pts - vlc_tick_from_samples(queued, filter->fmt_in.audio.i_rate);
+}
+
+static block_t *Resample(filter_t *filter, block_t *in)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const size_t queued = sys->buf_frames;
+
+    if (Reserve(sys, in->i_nb_samples))
+    {
+        block_Release(in);
+        return NULL;
+    }
+
+    memcpy(sys->buf + sys->buf_frames * sys->channels, in->p_buffer,
+           in->i_nb_samples * sys->channels * sizeof (float));
+    sys->buf_frames += in->i_nb_samples;
+
+    block_t *out = Process(filter, BufferDate(filter, in->i_pts, queued));
+    block_Release(in);
+    return out;
+}
+
+/** Resets the history, so that the first input frame is the first output */
+static void Reset(filter_sys_t *sys)
+{
+    sys->buf_frames = sys->taps / 2 - 1;
+    memset(sys->buf, 0, sys->buf_frames * sys->channels * sizeof (float));
+    sys->pos = 0;
+}
+
+static block_t *Drain(filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const size_t pad = sys->taps / 2;
+
+    if (sys->buf_frames <= sys->taps / 2 - 1 || Reserve(sys, pad))
+        return NULL;
+
+    /* Flush the real input out of the filter with silence */
+    memset(sys->buf + sys->buf_frames * sys->channels, 0,
+           pad * sys->channels * sizeof (float));
+    sys->buf_frames += pad;
+
+    block_t *out = Process(filter, VLC_TICK_INVALID);
+    if (out != NULL)
+        out->i_pts = VLC_TICK_INVALID;
+    Reset(sys);
+    return out;
+}
+
+static void Flush(filter_t *filter)
+{
+    Reset(filter->p_sys);
+}
+
+static void Close(filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    if (sys->slices != NULL)
+        vlc_slices_Delete(sys->slices);
+    free(sys->offsets);
+    free(sys->coefs);
+    free(sys->buf);
+    free(sys->table);
+    free(sys);
+}
+
+static int OpenResampler(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+
+    if (filter->fmt_in.audio.i_format != VLC_CODEC_FL32
+     || filter->fmt_out.audio.i_format != VLC_CODEC_FL32
+    /* Cannot remix */
+     || filter->fmt_in.audio.i_channels != filter->fmt_out.audio.i_channels
+     || filter->fmt_in.audio.i_channels == 0
+     || filter->fmt_in.audio.i_rate == 0 || filter->fmt_out.audio.i_rate == 0)
+        return VLC_EGENERIC;
+
+    filter_sys_t *sys = calloc(1, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    int64_t q = var_InheritInteger(obj, "polyphase-resampler-quality");
+    if (q < 0 || (size_t)q >= ARRAY_SIZE(qualities))
+        q = 1;
+
+    sys->channels = filter->fmt_in.audio.i_channels;
+    sys->taps = qualities[q].taps;
+    sys->beta = qualities[q].beta;
+    sys->rolloff = qualities[q].rolloff;
+
+    if (BuildTable(sys, Cutoff(sys, filter->fmt_in.audio.i_rate,
+                               filter->fmt_out.audio.i_rate))
+     || Reserve(sys, sys->taps / 2 - 1))
+    {
+        Close(filter);
+        return VLC_ENOMEM;
+    }
+    Reset(sys);
+
+    sys->resample = ResampleChannels_C;
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        sys->resample = Resample_AVX2;
+    else
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        sys->resample = Resample_SSE2;
+    else
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        sys->resample = Resample_NEON;
+    else
+#endif
+        (void) 0;
+
+    /* Channel groups can only be split for wide layouts */
+    if (sys->channels > GROUP)
+        sys->slices = vlc_slices_New(0);
+
+    msg_Dbg(filter, "%u taps polyphase resampler for %u channels",
+            sys->taps, sys->channels);
+
+    static const struct vlc_filter_operations filter_ops =
+    {
+        .filter_audio = Resample,
+        .drain_audio = Drain,
+        .flush = Flush,
+        .close = Close,
+    };
+    filter->ops = &filter_ops;
+    filter->p_sys = sys;
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+
+    /* Will change rate */
+    if (filter->fmt_in.audio.i_rate == filter->fmt_out.audio.i_rate)
+        return VLC_EGENERIC;
+    return OpenResampler(obj);
+}
@@ -32,6 +32,17 @@
 #include <vlc_aout.h>
 #include <vlc_filter.h>
 #include <vlc_modules.h>
+#include <vlc_cpu.h>
+
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+# include <arm_neon.h>
+#endif
 
 #include <stdatomic.h>
 #include <string.h> /* for memset */
@@ -67,6 +78,9 @@ vlc_module_begin ()
         N_("Overlap Length"), N_("Percentage of stride to overlap") )
     add_integer_with_range( "scaletempo-search", 14, 0, 200,
         N_("Search Length"), N_("Length in milliseconds to search for best overlap position") )
+    add_bool( "scaletempo-fast-search", false,
+        N_("Fast search"), N_("Search the best overlap position coarsely, "
+        "then refine it. This lowers the CPU usage at some quality cost.") )
 #ifdef PITCH_SHIFTER
     add_float_with_range( "pitch-shift", 0, -12, 12,
         N_("Pitch Shift"), N_("Pitch shift in semitones.") )
@@ -124,7 +138,10 @@ typedef struct
     void     *table_blend;
     void    (*output_overlap)( filter_t *p_filter, void *p_out_buf, unsigned bytes_off );
     /* best overlap */
+    bool      fast_search;
     unsigned  frames_search;
+    unsigned  frames_search_step;
+    float   (*correlate)( const float *, const float *, unsigned );
     void     *buf_pre_corr;
     void     *table_window;
     unsigned(*best_overlap_offset)( filter_t *p_filter );
@@ -135,6 +152,89 @@ typedef struct
 #endif
 } filter_sys_t;
 
+/*****************************************************************************
+ * correlate: dot product of the pre-correlation window and a search position
+ *****************************************************************************/
+static float correlate_c( const float *ppc, const float *ps, unsigned n )
+{
+    float corr = 0;
+    for( unsigned i = 0; i < n; i++ )
+        corr += ppc[i] * ps[i];
+    return corr;
+}
+
+#ifdef CAN_COMPILE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static float correlate_sse2( const float *ppc, const float *ps, unsigned n )
+{
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    unsigned i = 0;
+
+    for( ; i + 8 <= n; i += 8 )
+    {
+        acc0 = _mm_add_ps( acc0, _mm_mul_ps( _mm_loadu_ps( ppc + i ),
+                                             _mm_loadu_ps( ps + i ) ) );
+        acc1 = _mm_add_ps( acc1, _mm_mul_ps( _mm_loadu_ps( ppc + i + 4 ),
+                                             _mm_loadu_ps( ps + i + 4 ) ) );
+    }
+    acc0 = _mm_add_ps( acc0, acc1 );
+    acc0 = _mm_add_ps( acc0, _mm_movehl_ps( acc0, acc0 ) );
+    acc0 = _mm_add_ss( acc0, _mm_shuffle_ps( acc0, acc0, 1 ) );
+
+    float corr = _mm_cvtss_f32( acc0 );
+    for( ; i < n; i++ )
+        corr += ppc[i] * ps[i];
+    return corr;
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__ ((__target__ ("avx2")))
+static float correlate_avx2( const float *ppc, const float *ps, unsigned n )
+{
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    unsigned i = 0;
+
+    for( ; i + 16 <= n; i += 16 )
+    {
+        acc0 = _mm256_add_ps( acc0, _mm256_mul_ps( _mm256_loadu_ps( ppc + i ),
+                                                   _mm256_loadu_ps( ps + i ) ) );
+        acc1 = _mm256_add_ps( acc1, _mm256_mul_ps( _mm256_loadu_ps( ppc + i + 8 ),
+                                                   _mm256_loadu_ps( ps + i + 8 ) ) );
+    }
+    acc0 = _mm256_add_ps( acc0, acc1 );
+
+    __m128 acc = _mm_add_ps( _mm256_castps256_ps128( acc0 ),
+                             _mm256_extractf128_ps( acc0, 1 ) );
+    acc = _mm_add_ps( acc, _mm_movehl_ps( acc, acc ) );
+    acc = _mm_add_ss( acc, _mm_shuffle_ps( acc, acc, 1 ) );
+
+    float corr = _mm_cvtss_f32( acc );
+    for( ; i < n; i++ )
+        corr += ppc[i] * ps[i];
+    return corr;
+}
+#endif
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+static float correlate_neon( const float *ppc, const float *ps, unsigned n )
+{
+    float32x4_t acc0 = vdupq_n_f32( 0.f ), acc1 = vdupq_n_f32( 0.f );
+    unsigned i = 0;
+
+    for( ; i + 8 <= n; i += 8 )
+    {
+        acc0 = vfmaq_f32( acc0, vld1q_f32( ppc + i ), vld1q_f32( ps + i ) );
+        acc1 = vfmaq_f32( acc1, vld1q_f32( ppc + i + 4 ), vld1q_f32( ps + i + 4 ) );
+    }
+
+    float corr = vaddvq_f32( vaddq_f32( acc0, acc1 ) );
+    for( ; i < n; i++ )
+        corr += ppc[i] * ps[i];
+    return corr;
+}
+#endif
+
 /*****************************************************************************
  * best_overlap_offset: calculate best offset for overlap
  *****************************************************************************/
@@ -145,6 +245,8 @@ static unsigned best_overlap_offset_float( filter_t *p_filter )
     float best_corr = INT_MIN;
     unsigned best_off = 0;
     unsigned i, off;
+    const unsigned n = p->samples_overlap - p->samples_per_frame;
+    const unsigned step = p->frames_search_step;
 
     pw  = p->table_window;
     po  = p->buf_overlap;
@@ -154,19 +256,30 @@ static unsigned best_overlap_offset_float( filter_t *p_filter )
       *ppc++ = *pw++ * *po++;
     }
 
+    ppc = p->buf_pre_corr;
     search_start = (float *)p->buf_queue + p->samples_per_frame;
-    for( off = 0; off < p->frames_search; off++ ) {
-      float corr = 0;
-      float *ps = search_start;
-      ppc = p->buf_pre_corr;
-      for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
-        corr += *ppc++ * *ps++;
-      }
+    for( off = 0; off < p->frames_search; off += step ) {
+      float corr = p->correlate( ppc, search_start + off * p->samples_per_frame, n );
       if( corr > best_corr ) {
         best_corr = corr;
         best_off  = off;
       }
-      search_start += p->samples_per_frame;
+    }
+
+    if( step > 1 ) {
+      /* Refine around the best coarse position */
+      unsigned coarse = best_off;
+      unsigned lo = coarse >= step ? coarse - step + 1 : 0;
+      unsigned hi = __MIN( coarse + step, p->frames_search );
+      for( off = lo; off < hi; off++ ) {
+        if( off == coarse )
+          continue;
+        float corr = p->correlate( ppc, search_start + off * p->samples_per_frame, n );
+        if( corr > best_corr ) {
+          best_corr = corr;
+          best_off  = off;
+        }
+      }
     }
 
     return best_off * p->bytes_per_frame;
@@ -353,6 +466,11 @@ static int reinit_buffers( filter_t *p_filter )
         p->best_overlap_offset = best_overlap_offset_float;
     }
 
+    /* About 4 frames at 48 kHz between the positions of the coarse search */
+    p->frames_search_step = 1;
+    if( p->fast_search )
+        p->frames_search_step = __MAX( 1, ( p->sample_rate + 6000 ) / 12000 );
+
     unsigned new_size = ( p->frames_search + frames_stride + frames_overlap ) * p->bytes_per_frame;
     if( p->bytes_queued > new_size )
     {
@@ -420,9 +538,29 @@ static int Open( vlc_object_t *p_this )
     p_sys->ms_stride       = var_InheritInteger( p_this, "scaletempo-stride" );
     p_sys->percent_overlap = var_InheritFloat( p_this, "scaletempo-overlap" );
     p_sys->ms_search       = var_InheritInteger( p_this, "scaletempo-search" );
+    p_sys->fast_search     = var_InheritBool( p_this, "scaletempo-fast-search" );
+
+    p_sys->correlate = correlate_c;
+#ifdef HAVE_AVX2_INTRINSICS
+    if( vlc_CPU_AVX2() )
+        p_sys->correlate = correlate_avx2;
+    else
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
+        p_sys->correlate = correlate_sse2;
+    else
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if( vlc_CPU_ARM_NEON() )
+        p_sys->correlate = correlate_neon;
+    else
+#endif
+        (void) 0;
 
-    msg_Dbg( p_this, "params: %i stride, %.3f overlap, %i search",
-             p_sys->ms_stride, p_sys->percent_overlap, p_sys->ms_search );
+    msg_Dbg( p_this, "params: %i stride, %.3f overlap, %i search%s",
+             p_sys->ms_stride, p_sys->percent_overlap, p_sys->ms_search,
+             p_sys->fast_search ? " (fast)" : "" );
 
     p_sys->buf_queue      = NULL;
     p_sys->buf_overlap    = NULL;
@@ -33,6 +33,17 @@
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
+#include <vlc_cpu.h>
+
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+# include <arm_neon.h>
+#endif
 
 /*****************************************************************************
  * Local prototypes
@@ -49,32 +60,249 @@ vlc_module_begin ()
     set_callback( Create )
 vlc_module_end ()
 
+/*****************************************************************************
+ * Sample loops
+ *****************************************************************************
+ * Each loop processes the first n samples that a vector width divides, and
+ * returns that count; the C loop then finishes the buffer. Ramps apply
+ * from + step * (i + 1) to the sample i, computed from the index rather than
+ * accumulated so that all the versions agree.
+ *****************************************************************************/
+static void AmplifyFL32_C( float *p, size_t n, float mult )
+{
+    for( size_t i = 0; i < n; i++ )
+        p[i] *= mult;
+}
+
+static void RampFL32_C( float *p, size_t i, size_t n, float from, float step )
+{
+    for( ; i < n; i++ )
+        p[i] *= from + step * (float)(i + 1);
+}
+
+#ifdef CAN_COMPILE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static size_t AmplifyFL32_SSE( float *p, size_t n, float mult )
+{
+    const __m128 m = _mm_set1_ps( mult );
+
+    n &= ~(size_t)7;
+    for( size_t i = 0; i < n; i += 8 )
+    {
+        __m128 a = _mm_loadu_ps( p + i );
+        __m128 b = _mm_loadu_ps( p + i + 4 );
+        _mm_storeu_ps( p + i, _mm_mul_ps( a, m ) );
+        _mm_storeu_ps( p + i + 4, _mm_mul_ps( b, m ) );
+    }
+    return n;
+}
+
+__attribute__ ((__target__ ("sse2")))
+static size_t RampFL32_SSE( float *p, size_t n, float from, float step )
+{
+    const __m128 f = _mm_set1_ps( from ), s = _mm_set1_ps( step );
+    const __m128 four = _mm_set1_ps( 4.f );
+    __m128 idx = _mm_setr_ps( 1.f, 2.f, 3.f, 4.f );
+
+    n &= ~(size_t)3;
+    for( size_t i = 0; i < n; i += 4 )
+    {
+        __m128 g = _mm_add_ps( f, _mm_mul_ps( s, idx ) );
+        _mm_storeu_ps( p + i, _mm_mul_ps( _mm_loadu_ps( p + i ), g ) );
+        idx = _mm_add_ps( idx, four );
+    }
+    return n;
+}
+
+__attribute__ ((__target__ ("sse2")))
+static size_t AmplifyFL64_SSE2( double *p, size_t n, double mult )
+{
+    const __m128d m = _mm_set1_pd( mult );
+
+    n &= ~(size_t)3;
+    for( size_t i = 0; i < n; i += 4 )
+    {
+        __m128d a = _mm_loadu_pd( p + i );
+        __m128d b = _mm_loadu_pd( p + i + 2 );
+        _mm_storeu_pd( p + i, _mm_mul_pd( a, m ) );
+        _mm_storeu_pd( p + i + 2, _mm_mul_pd( b, m ) );
+    }
+    return n;
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__ ((__target__ ("avx2")))
+static size_t AmplifyFL32_AVX( float *p, size_t n, float mult )
+{
+    const __m256 m = _mm256_set1_ps( mult );
+
+    n &= ~(size_t)15;
+    for( size_t i = 0; i < n; i += 16 )
+    {
+        __m256 a = _mm256_loadu_ps( p + i );
+        __m256 b = _mm256_loadu_ps( p + i + 8 );
+        _mm256_storeu_ps( p + i, _mm256_mul_ps( a, m ) );
+        _mm256_storeu_ps( p + i + 8, _mm256_mul_ps( b, m ) );
+    }
+    return n;
+}
+
+__attribute__ ((__target__ ("avx2")))
+static size_t RampFL32_AVX( float *p, size_t n, float from, float step )
+{
+    const __m256 f = _mm256_set1_ps( from ), s = _mm256_set1_ps( step );
+    const __m256 eight = _mm256_set1_ps( 8.f );
+    __m256 idx = _mm256_setr_ps( 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f );
+
+    n &= ~(size_t)7;
+    for( size_t i = 0; i < n; i += 8 )
+    {
+        __m256 g = _mm256_add_ps( f, _mm256_mul_ps( s, idx ) );
+        _mm256_storeu_ps( p + i,
+                          _mm256_mul_ps( _mm256_loadu_ps( p + i ), g ) );
+        idx = _mm256_add_ps( idx, eight );
+    }
+    return n;
+}
+#endif
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+static size_t AmplifyFL32_NEON( float *p, size_t n, float mult )
+{
+    n &= ~(size_t)7;
+    for( size_t i = 0; i < n; i += 8 )
+    {
+        float32x4_t a = vld1q_f32( p + i );
+        float32x4_t b = vld1q_f32( p + i + 4 );
+        vst1q_f32( p + i, vmulq_n_f32( a, mult ) );
+        vst1q_f32( p + i + 4, vmulq_n_f32( b, mult ) );
+    }
+    return n;
+}
+
+static size_t RampFL32_NEON( float *p, size_t n, float from, float step )
+{
+    static const float init[4] = { 1.f, 2.f, 3.f, 4.f };
+    const float32x4_t f = vdupq_n_f32( from );
+    float32x4_t idx = vld1q_f32( init );
+
+    n &= ~(size_t)3;
+    for( size_t i = 0; i < n; i += 4 )
+    {
+        float32x4_t g = vaddq_f32( f, vmulq_n_f32( idx, step ) );
+        vst1q_f32( p + i, vmulq_f32( vld1q_f32( p + i ), g ) );
+        idx = vaddq_f32( idx, vdupq_n_f32( 4.f ) );
+    }
+    return n;
+}
+
+static size_t AmplifyFL64_NEON( double *p, size_t n, double mult )
+{
+    n &= ~(size_t)3;
+    for( size_t i = 0; i < n; i += 4 )
+    {
+        float64x2_t a = vld1q_f64( p + i );
+        float64x2_t b = vld1q_f64( p + i + 2 );
+        vst1q_f64( p + i, vmulq_n_f64( a, mult ) );
+        vst1q_f64( p + i + 2, vmulq_n_f64( b, mult ) );
+    }
+    return n;
+}
+#endif
+
 /**
  * Mixes a new output buffer
  */
-static void FilterFL32( audio_volume_t *p_volume, block_t *p_buffer,
-                        float f_multiplier )
+#define FL32_FILTERS(sfx, amplify_simd, ramp_simd) \
+static void FilterFL32##sfx( audio_volume_t *p_volume, block_t *p_buffer, \
+                             float f_multiplier ) \
+{ \
+    if( f_multiplier == 1.f ) \
+        return; /* nothing to do */ \
+\
+    float *p = (float *)p_buffer->p_buffer; \
+    size_t n = p_buffer->i_buffer / sizeof(*p); \
+    size_t done = amplify_simd( p, n, f_multiplier ); \
+\
+    AmplifyFL32_C( p + done, n - done, f_multiplier ); \
+    (void) p_volume; \
+} \
+\
+static void FilterRampFL32##sfx( audio_volume_t *p_volume, \
+                                 block_t *p_buffer, float from, float to ) \
+{ \
+    float *p = (float *)p_buffer->p_buffer; \
+    size_t n = p_buffer->i_buffer / sizeof(*p); \
+    if( n == 0 ) \
+        return; \
+\
+    float step = (to - from) / (float)n; \
+\
+    RampFL32_C( p, ramp_simd( p, n, from, step ), n, from, step ); \
+    (void) p_volume; \
+}
+
+static size_t AmplifyNone( const void *p, size_t n, double mult )
 {
-    if( f_multiplier == 1.f )
-        return; /* nothing to do */
+    (void) p; (void) n; (void) mult;
+    return 0;
+}
 
-    float *p = (float *)p_buffer->p_buffer;
-    for( size_t i = p_buffer->i_buffer / sizeof(*p); i > 0; i-- )
-        *(p++) *= f_multiplier;
+static size_t RampNone( float *p, size_t n, float from, float step )
+{
+    (void) p; (void) n; (void) from; (void) step;
+    return 0;
+}
 
-    (void) p_volume;
+FL32_FILTERS(, AmplifyNone, RampNone)
+#ifdef CAN_COMPILE_SSE2
+FL32_FILTERS(_SSE, AmplifyFL32_SSE, RampFL32_SSE)
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+FL32_FILTERS(_AVX, AmplifyFL32_AVX, RampFL32_AVX)
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+FL32_FILTERS(_NEON, AmplifyFL32_NEON, RampFL32_NEON)
+#endif
+
+#define FL64_FILTER(sfx, amplify_simd) \
+static void FilterFL64##sfx( audio_volume_t *p_volume, block_t *p_buffer, \
+                             float f_multiplier ) \
+{ \
+    double *p = (double *)p_buffer->p_buffer; \
+    double mult = f_multiplier; \
+    if( mult == 1. ) \
+        return; /* nothing to do */ \
+\
+    size_t n = p_buffer->i_buffer / sizeof(*p); \
+    for( size_t i = amplify_simd( p, n, mult ); i < n; i++ ) \
+        p[i] *= mult; \
+\
+    (void) p_volume; \
 }
 
-static void FilterFL64( audio_volume_t *p_volume, block_t *p_buffer,
-                        float f_multiplier )
+FL64_FILTER(, AmplifyNone)
+#ifdef CAN_COMPILE_SSE2
+FL64_FILTER(_SSE2, AmplifyFL64_SSE2)
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+FL64_FILTER(_NEON, AmplifyFL64_NEON)
+#endif
+
+static void FilterRampFL64( audio_volume_t *p_volume, block_t *p_buffer,
+                            float from, float to )
 {
     double *p = (double *)p_buffer->p_buffer;
-    double mult = f_multiplier;
-    if( mult == 1. )
-        return; /* nothing to do */
+    size_t n = p_buffer->i_buffer / sizeof(*p);
+
+    if( n == 0 )
+        return;
+
+    double step = ((double)to - from) / n;
 
-    for( size_t i = p_buffer->i_buffer / sizeof(*p); i > 0; i-- )
-        *(p++) *= mult;
+    for( size_t i = 0; i < n; i++ )
+        p[i] *= from + step * (double)(i + 1);
 
     (void) p_volume;
 }
@@ -90,9 +318,47 @@ static int Create( vlc_object_t *p_this )
     {
         case VLC_CODEC_FL32:
             p_volume->amplify = FilterFL32;
+            p_volume->amplify_ramp = FilterRampFL32;
+#ifdef HAVE_AVX2_INTRINSICS
+            if( vlc_CPU_AVX2() )
+            {
+                p_volume->amplify = FilterFL32_AVX;
+                p_volume->amplify_ramp = FilterRampFL32_AVX;
+            }
+            else
+#endif
+#ifdef CAN_COMPILE_SSE2
+            if( vlc_CPU_SSE2() )
+            {
+                p_volume->amplify = FilterFL32_SSE;
+                p_volume->amplify_ramp = FilterRampFL32_SSE;
+            }
+            else
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+            if( vlc_CPU_ARM_NEON() )
+            {
+                p_volume->amplify = FilterFL32_NEON;
+                p_volume->amplify_ramp = FilterRampFL32_NEON;
+            }
+            else
+#endif
+                (void) 0;
             break;
         case VLC_CODEC_FL64:
             p_volume->amplify = FilterFL64;
+            p_volume->amplify_ramp = FilterRampFL64;
+#ifdef CAN_COMPILE_SSE2
+            if( vlc_CPU_SSE2() )
+                p_volume->amplify = FilterFL64_SSE2;
+            else
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+            if( vlc_CPU_ARM_NEON() )
+                p_volume->amplify = FilterFL64_NEON;
+            else
+#endif
+                (void) 0;
             break;
         default:
             return -1;
@@ -29,6 +29,14 @@
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
+#include <vlc_cpu.h>
+
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
 
 static int Activate (vlc_object_t *);
 
@@ -60,6 +68,126 @@ static void FilterS32N (audio_volume_t *vol, block_t *block, float volume)
     (void) vol;
 }
 
+static void RampS32N (audio_volume_t *vol, block_t *block,
+                      float from, float to)
+{
+    int32_t *p = (int32_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
+    double step = ((double)to - from) / n;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double s = p[i] * (from + step * (double)(i + 1));
+        if (s > INT32_MAX)
+            s = INT32_MAX;
+        else
+        if (s < INT32_MIN)
+            s = INT32_MIN;
+        p[i] = s;
+    }
+    (void) vol;
+}
+
+static void AmplifyS16N (int16_t *p, size_t n, int_fast16_t mult)
+{
+    for (; n > 0; n--)
+    {
+        int_fast32_t s = (*p * (int_fast32_t)mult) >> 8;
+        if (s > INT16_MAX)
+            s = INT16_MAX;
+        else
+        if (s < INT16_MIN)
+            s = INT16_MIN;
+        *(p++) = s;
+    }
+}
+
+#ifdef CAN_COMPILE_SSE2
+/** Multiplies 8 samples by a Q8 factor with saturation, like the C loop */
+__attribute__ ((__target__ ("sse2")))
+static inline __m128i MulS16_SSE2 (__m128i v, __m128i m)
+{
+    __m128i lo = _mm_mullo_epi16 (v, m), hi = _mm_mulhi_epi16 (v, m);
+    __m128i a = _mm_srai_epi32 (_mm_unpacklo_epi16 (lo, hi), 8);
+    __m128i b = _mm_srai_epi32 (_mm_unpackhi_epi16 (lo, hi), 8);
+    return _mm_packs_epi32 (a, b);
+}
+
+__attribute__ ((__target__ ("sse2")))
+static size_t AmplifyS16N_SSE2 (int16_t *p, size_t n, int_fast16_t mult)
+{
+    const __m128i m = _mm_set1_epi16 (mult);
+
+    n &= ~(size_t)15;
+    for (size_t i = 0; i < n; i += 16)
+    {
+        __m128i a = _mm_loadu_si128 ((const __m128i *)(p + i));
+        __m128i b = _mm_loadu_si128 ((const __m128i *)(p + i + 8));
+        _mm_storeu_si128 ((__m128i *)(p + i), MulS16_SSE2 (a, m));
+        _mm_storeu_si128 ((__m128i *)(p + i + 8), MulS16_SSE2 (b, m));
+    }
+    return n;
+}
+
+static void FilterS16N_SSE2 (audio_volume_t *vol, block_t *block,
+                             float volume)
+{
+    int16_t *p = (int16_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
+
+    int_fast16_t mult = lroundf (volume * 0x1.p8f);
+    if (mult == (1 << 8))
+        return;
+
+    size_t done = AmplifyS16N_SSE2 (p, n, mult);
+    AmplifyS16N (p + done, n - done, mult);
+    (void) vol;
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i MulS16_AVX2 (__m256i v, __m256i m)
+{
+    /* Lane-wise unpacking and packing cancel each other out */
+    __m256i lo = _mm256_mullo_epi16 (v, m), hi = _mm256_mulhi_epi16 (v, m);
+    __m256i a = _mm256_srai_epi32 (_mm256_unpacklo_epi16 (lo, hi), 8);
+    __m256i b = _mm256_srai_epi32 (_mm256_unpackhi_epi16 (lo, hi), 8);
+    return _mm256_packs_epi32 (a, b);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static size_t AmplifyS16N_AVX2 (int16_t *p, size_t n, int_fast16_t mult)
+{
+    const __m256i m = _mm256_set1_epi16 (mult);
+
+    n &= ~(size_t)31;
+    for (size_t i = 0; i < n; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256 ((const __m256i *)(p + i));
+        __m256i b = _mm256_loadu_si256 ((const __m256i *)(p + i + 16));
+        _mm256_storeu_si256 ((__m256i *)(p + i), MulS16_AVX2 (a, m));
+        _mm256_storeu_si256 ((__m256i *)(p + i + 16), MulS16_AVX2 (b, m));
+    }
+    return n;
+}
+
+static void FilterS16N_AVX2 (audio_volume_t *vol, block_t *block,
+                             float volume)
+{
+    int16_t *p = (int16_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
+
+    int_fast16_t mult = lroundf (volume * 0x1.p8f);
+    if (mult == (1 << 8))
+        return;
+
+    size_t done = AmplifyS16N_AVX2 (p, n, mult);
+    AmplifyS16N (p + done, n - done, mult);
+    (void) vol;
+}
+#endif
+
 static void FilterS16N (audio_volume_t *vol, block_t *block, float volume)
 {
     int16_t *p = (int16_t *)block->p_buffer;
@@ -68,15 +196,26 @@ static void FilterS16N (audio_volume_t *vol, block_t *block, float volume)
     if (mult == (1 << 8))
         return;
 
-    for (size_t n = block->i_buffer / sizeof (*p); n > 0; n--)
+    AmplifyS16N (p, block->i_buffer / sizeof (*p), mult);
+    (void) vol;
+}
+
+static void RampS16N (audio_volume_t *vol, block_t *block,
+                      float from, float to)
+{
+    int16_t *p = (int16_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
+    float step = (to - from) / n;
+
+    for (size_t i = 0; i < n; i++)
     {
-        int_fast32_t s = (*p * (int_fast32_t)mult) >> 8;
+        float s = p[i] * (from + step * (float)(i + 1));
         if (s > INT16_MAX)
             s = INT16_MAX;
         else
         if (s < INT16_MIN)
             s = INT16_MIN;
-        *(p++) = s;
+        p[i] = s;
     }
     (void) vol;
 }
@@ -102,6 +241,25 @@ static void FilterU8 (audio_volume_t *vol, block_t *block, float volume)
     (void) vol;
 }
 
+static void RampU8 (audio_volume_t *vol, block_t *block, float from, float to)
+{
+    uint8_t *p = (uint8_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
+    float step = (to - from) / n;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        float s = (p[i] - 128) * (from + step * (float)(i + 1));
+        if (s > INT8_MAX)
+            s = INT8_MAX;
+        else
+        if (s < INT8_MIN)
+            s = INT8_MIN;
+        p[i] = (int)s + 128;
+    }
+    (void) vol;
+}
+
 static int Activate (vlc_object_t *obj)
 {
     audio_volume_t *vol = (audio_volume_t *)obj;
@@ -110,12 +268,24 @@ static int Activate (vlc_object_t *obj)
     {
         case VLC_CODEC_S32N:
             vol->amplify = FilterS32N;
+            vol->amplify_ramp = RampS32N;
             break;
         case VLC_CODEC_S16N:
             vol->amplify = FilterS16N;
+            vol->amplify_ramp = RampS16N;
+#ifdef HAVE_AVX2_INTRINSICS
+            if (vlc_CPU_AVX2 ())
+                vol->amplify = FilterS16N_AVX2;
+            else
+#endif
+#ifdef CAN_COMPILE_SSE2
+            if (vlc_CPU_SSE2 ())
+                vol->amplify = FilterS16N_SSE2;
+#endif
             break;
         case VLC_CODEC_U8:
             vol->amplify = FilterU8;
+            vol->amplify_ramp = RampU8;
             break;
         default:
             return -1;
@@ -64,6 +64,7 @@ vlc_module_end ()
  * Local prototypes
  *****************************************************************************/
 static int DecodeBlock( decoder_t *, block_t * );
+static int DecodeBatch( decoder_t *, block_t * );
 static void Flush( decoder_t * );
 
 typedef struct
@@ -288,6 +289,7 @@ static int DecoderOpen( vlc_object_t *p_this )
     date_Init( &p_sys->end_date, p_dec->fmt_out.audio.i_rate, 1 );
 
     p_dec->pf_decode = DecodeBlock;
+    p_dec->pf_decode_batch = DecodeBatch;
     p_dec->pf_flush  = Flush;
     p_dec->p_sys = p_sys;
 
@@ -366,6 +368,87 @@ skip:
     return VLCDEC_SUCCESS;
 }
 
+/****************************************************************************
+ * DecodeBatch: convert a run of contiguous blocks into a single buffer
+ ****************************************************************************/
+static int DecodeBatch( decoder_t *p_dec, block_t *p_chain )
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+
+    while( p_chain != NULL )
+    {
+        block_t *p_block = p_chain, *p_last = NULL;
+        date_t end_date = p_sys->end_date;
+        unsigned samples = 0;
+
+        /* Passed-through blocks are queued as is: only conversions can be
+         * merged, and only as long as there is no timestamp gap. */
+        for( block_t *p = p_chain; p != NULL && p_sys->decode != NULL;
+             p = p->p_next )
+        {
+            if( p->i_flags & (BLOCK_FLAG_CORRUPTED|BLOCK_FLAG_DISCONTINUITY) )
+                break;
+            if( p->i_pts != VLC_TICK_INVALID &&
+                p->i_pts != date_Get( &end_date ) )
+            {
+                if( p != p_chain )
+                    break;
+                date_Set( &end_date, p->i_pts );
+            }
+            else if( date_Get( &end_date ) == VLC_TICK_INVALID )
+                break;
+
+            unsigned count = (8 * p->i_buffer) / p_sys->framebits;
+            if( count == 0 )
+                break;
+            date_Increment( &end_date, count );
+            samples += count;
+            p_last = p;
+        }
+
+        if( p_last == NULL || p_last == p_chain )
+        {
+            p_chain = p_block->p_next;
+            p_block->p_next = NULL;
+            DecodeBlock( p_dec, p_block );
+            continue;
+        }
+
+        p_chain = p_last->p_next;
+        p_last->p_next = NULL;
+
+        if( p_block->i_pts != VLC_TICK_INVALID )
+            date_Set( &p_sys->end_date, p_block->i_pts );
+
+        block_t *p_out;
+        if( decoder_UpdateAudioFormat( p_dec )
+         || (p_out = decoder_NewAudioBuffer( p_dec, samples )) == NULL )
+        {
+            block_ChainRelease( p_block );
+            continue;
+        }
+
+        const size_t framesize = p_out->i_buffer / samples;
+        uint8_t *p_dst = p_out->p_buffer;
+
+        for( block_t *p = p_block; p != NULL; p = p->p_next )
+        {
+            unsigned count = (8 * p->i_buffer) / p_sys->framebits;
+
+            p_sys->decode( p_dst, p->p_buffer,
+                           count * p_dec->fmt_in.audio.i_channels );
+            p_dst += count * framesize;
+        }
+        block_ChainRelease( p_block );
+
+        p_out->i_pts = date_Get( &p_sys->end_date );
+        p_out->i_length = date_Increment( &p_sys->end_date, samples )
+                        - p_out->i_pts;
+        decoder_QueueAudio( p_dec, p_out );
+    }
+    return VLCDEC_SUCCESS;
+}
+
 static void S8Decode( void *outp, const uint8_t *in, unsigned samples )
 {
     uint8_t *out = outp;
@@ -72,6 +72,7 @@ typedef struct
 static void SetupOutputFormat( decoder_t *p_dec, bool b_trust );
 static block_t * ConvertAVFrame( decoder_t *p_dec, AVFrame *frame );
 static int  DecodeAudio( decoder_t *, block_t * );
+static int  DecodeBatch( decoder_t *, block_t * );
 static void Flush( decoder_t * );
 
 static void InitDecoderConfig( decoder_t *p_dec, AVCodecContext *p_context )
@@ -262,6 +263,7 @@ int InitAudioDec( vlc_object_t *obj )
     p_dec->fmt_out.audio.i_chan_mode = p_dec->fmt_in.audio.i_chan_mode;
 
     p_dec->pf_decode = DecodeAudio;
+    p_dec->pf_decode_batch = DecodeBatch;
     p_dec->pf_flush  = Flush;
 
     /* XXX: Writing input format makes little sense. */
@@ -489,6 +491,23 @@ static int DecodeAudio( decoder_t *p_dec, block_t *p_block )
     return i_ret;
 }
 
+static int DecodeBatch( decoder_t *p_dec, block_t *p_chain )
+{
+    while( p_chain != NULL )
+    {
+        block_t *p_block = p_chain;
+
+        p_chain = p_block->p_next;
+        p_block->p_next = NULL;
+        if( DecodeAudio( p_dec, p_block ) != VLCDEC_SUCCESS )
+        {
+            block_ChainRelease( p_chain );
+            return VLCDEC_ECRITICAL;
+        }
+    }
+    return VLCDEC_SUCCESS;
+}
+
 static block_t * ConvertAVFrame( decoder_t *p_dec, AVFrame *frame )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
@@ -52,10 +52,36 @@
 struct vaapi_vctx
 {
     VADisplay va_dpy;
+    vlc_decoder_device *dec_device;
     AVBufferRef *hwframes_ref;
     vlc_sem_t pool_sem;
 };
 
+/* Surfaces left to the next decoder of the device, cf. GetSurfacesKey() */
+struct vaapi_surfaces_key
+{
+    int sw_format;
+    int width;
+    int height;
+    int pool_size;
+};
+
+static void GetSurfacesKey(struct vaapi_surfaces_key *key,
+                           const AVHWFramesContext *hwframes_ctx)
+{
+    key->sw_format = hwframes_ctx->sw_format;
+    key->width = hwframes_ctx->width;
+    key->height = hwframes_ctx->height;
+    key->pool_size = hwframes_ctx->initial_pool_size;
+}
+
+static void ReleaseSurfaces(void *surfaces)
+{
+    AVBufferRef *hwframes_ref = surfaces;
+
+    av_buffer_unref(&hwframes_ref);
+}
+
 typedef struct {
     struct vaapi_pic_context ctx;
     AVFrame *avframe;
@@ -143,8 +169,13 @@ static void Delete(vlc_va_t *va)
 static void vaapi_ctx_destroy(void *priv)
 {
     struct vaapi_vctx *vaapi_vctx = priv;
+    struct vaapi_surfaces_key key;
 
-    av_buffer_unref(&vaapi_vctx->hwframes_ref);
+    /* All the pictures are released: the surfaces can serve another decoder
+     * instead of being reallocated */
+    GetSurfacesKey(&key, (AVHWFramesContext *)vaapi_vctx->hwframes_ref->data);
+    vlc_decoder_device_PutSurfaces(vaapi_vctx->dec_device, &key, sizeof (key),
+                                   vaapi_vctx->hwframes_ref, ReleaseSurfaces);
 }
 
 static const struct vlc_va_operations ops = { Get, Delete, };
@@ -200,12 +231,27 @@ static int Create(vlc_va_t *va, AVCodecContext *ctx, enum AVPixelFormat hwfmt,
         hwframes_ctx->initial_pool_size += 3;
     }
 
-    ret = av_hwframe_ctx_init(hwframes_ref);
-    if (ret < 0)
+    struct vaapi_surfaces_key key;
+    GetSurfacesKey(&key, hwframes_ctx);
+
+    AVBufferRef *cached_ref =
+        vlc_decoder_device_TakeSurfaces(dec_device, &key, sizeof (key));
+    if (cached_ref != NULL)
     {
-        msg_Err(va, "av_hwframe_ctx_init failed: %d", ret);
+        msg_Dbg(va, "reusing %d surfaces", key.pool_size);
         av_buffer_unref(&hwframes_ref);
-        return VLC_EGENERIC;
+        hwframes_ref = cached_ref;
+        hwframes_ctx = (AVHWFramesContext*)hwframes_ref->data;
+    }
+    else
+    {
+        ret = av_hwframe_ctx_init(hwframes_ref);
+        if (ret < 0)
+        {
+            msg_Err(va, "av_hwframe_ctx_init failed: %d", ret);
+            av_buffer_unref(&hwframes_ref);
+            return VLC_EGENERIC;
+        }
     }
 
     int vlc_chroma = 0;
@@ -257,6 +303,7 @@ static int Create(vlc_va_t *va, AVCodecContext *ctx, enum AVPixelFormat hwfmt,
         vlc_video_context_GetPrivate(vctx, VLC_VIDEO_CONTEXT_VAAPI);
 
     vaapi_vctx->va_dpy = va_dpy;
+    vaapi_vctx->dec_device = dec_device;
     vaapi_vctx->hwframes_ref = hwframes_ref;
     vlc_sem_init(&vaapi_vctx->pool_sem, hwframes_ctx->initial_pool_size);
 
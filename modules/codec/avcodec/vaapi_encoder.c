@@ -0,0 +1,401 @@
+/*****************************************************************************
+ * vaapi_encoder.c: VAAPI hardware video encoder using libavcodec
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * This encoder takes the VAAPI surfaces of the hardware decoder as is, so
+ * that transcoding never copies the pictures to the system memory. Software
+ * pictures are left to the other encoders.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_codec.h>
+#include <vlc_picture.h>
+#include <vlc_sout.h>
+
+#include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/hwcontext_vaapi.h>
+#include <libavutil/opt.h>
+
+#include "avcommon.h"
+#include "../../hw/vaapi/vlc_vaapi.h"
+
+#define ENC_CFG_PREFIX "sout-vaapi-"
+
+static int  Open (vlc_object_t *);
+static void Close(encoder_t *);
+
+static const char *const rc_values[] = { "vbr", "cbr", "cqp" };
+static const char *const rc_texts[] = {
+    N_("Variable bitrate"), N_("Constant bitrate"),
+    N_("Constant quantizer") };
+
+#define RC_TEXT N_("Rate control method")
+#define RC_LONGTEXT N_("Rate control method of the hardware encoder. " \
+    "The bitrate is taken from the transcoding settings.")
+#define QP_TEXT N_("Quantizer")
+#define QP_LONGTEXT N_("Quantizer used with the constant quantizer method " \
+    "(0 for the driver default).")
+#define KEYINT_TEXT N_("Maximum GOP size")
+#define KEYINT_LONGTEXT N_("Maximum number of frames between key frames " \
+    "(0 for the transcoding settings or the driver default).")
+#define LOWLAT_TEXT N_("Low latency")
+#define LOWLAT_LONGTEXT N_("Disable B-frames and encode each picture " \
+    "before taking the next one. This also keeps fewer decoder surfaces " \
+    "in use.")
+#define LOWPOWER_TEXT N_("Low power mode")
+#define LOWPOWER_LONGTEXT N_("Use the fixed function encoder of the GPU, " \
+    "if the driver supports it.")
+
+vlc_module_begin()
+    set_shortname("VAAPI")
+    set_description(N_("VAAPI video encoder"))
+    set_subcategory(SUBCAT_INPUT_VCODEC)
+    set_capability("video encoder", 250)
+    set_callback(Open)
+
+    add_string(ENC_CFG_PREFIX "rc-method", "vbr", RC_TEXT, RC_LONGTEXT)
+        change_string_list(rc_values, rc_texts)
+    add_integer_with_range(ENC_CFG_PREFIX "qp", 0, 0, 255,
+                           QP_TEXT, QP_LONGTEXT)
+    add_integer(ENC_CFG_PREFIX "keyint", 0, KEYINT_TEXT, KEYINT_LONGTEXT)
+    add_bool(ENC_CFG_PREFIX "low-latency", false,
+             LOWLAT_TEXT, LOWLAT_LONGTEXT)
+    add_bool(ENC_CFG_PREFIX "low-power", false,
+             LOWPOWER_TEXT, LOWPOWER_LONGTEXT)
+vlc_module_end()
+
+static const char *const ppsz_enc_options[] = {
+    "rc-method", "qp", "keyint", "low-latency", "low-power", NULL
+};
+
+typedef struct
+{
+    AVCodecContext *ctx;
+    AVBufferRef *hwframes_ref;
+    AVFrame *frame;
+    AVPacket *packet;
+    vlc_decoder_device *dec_device;
+    VADisplay va_dpy;
+} encoder_sys_t;
+
+static const char *GetEncoderName(vlc_fourcc_t codec)
+{
+    switch (codec)
+    {
+        case VLC_CODEC_H264: return "h264_vaapi";
+        case VLC_CODEC_HEVC: return "hevc_vaapi";
+        case VLC_CODEC_AV1:  return "av1_vaapi";
+        default:             return NULL;
+    }
+}
+
+static void ReleasePicture(void *opaque, uint8_t *data)
+{
+    VLC_UNUSED(data);
+    picture_Release(opaque);
+}
+
+/* Wraps the surface of the picture in a frame, without copying it */
+static int WrapPicture(encoder_t *enc, picture_t *pic)
+{
+    encoder_sys_t *sys = enc->p_sys;
+    AVFrame *frame = sys->frame;
+
+    if (vlc_vaapi_PicGetDisplay(pic) != sys->va_dpy)
+    {
+        msg_Err(enc, "picture from another VA display");
+        return VLC_EGENERIC;
+    }
+
+    VASurfaceID surface = vlc_vaapi_PicGetSurface(pic);
+
+    frame->buf[0] = av_buffer_create((uint8_t *)(uintptr_t)surface, 0,
+                                     ReleasePicture, picture_Hold(pic),
+                                     AV_BUFFER_FLAG_READONLY);
+    if (frame->buf[0] == NULL)
+    {
+        picture_Release(pic);
+        return VLC_ENOMEM;
+    }
+
+    frame->hw_frames_ctx = av_buffer_ref(sys->hwframes_ref);
+    if (frame->hw_frames_ctx == NULL)
+    {
+        av_frame_unref(frame);
+        return VLC_ENOMEM;
+    }
+
+    frame->format = AV_PIX_FMT_VAAPI;
+    frame->width = sys->ctx->width;
+    frame->height = sys->ctx->height;
+    frame->data[3] = (uint8_t *)(uintptr_t)surface;
+    frame->pts = TO_AVSCALE(pic->date, sys->ctx->time_base);
+    if (pic->b_force)
+        frame->pict_type = AV_PICTURE_TYPE_I;
+    return VLC_SUCCESS;
+}
+
+static block_t *Encode(encoder_t *enc, picture_t *pic)
+{
+    encoder_sys_t *sys = enc->p_sys;
+    AVCodecContext *ctx = sys->ctx;
+    int ret;
+
+    if (pic != NULL)
+    {
+        if (WrapPicture(enc, pic))
+            return NULL;
+        ret = avcodec_send_frame(ctx, sys->frame);
+        av_frame_unref(sys->frame);
+    }
+    else
+        ret = avcodec_send_frame(ctx, NULL); /* drain */
+
+    if (ret < 0 && ret != AVERROR_EOF)
+    {
+        msg_Err(enc, "cannot send the picture to the encoder: %d", ret);
+        return NULL;
+    }
+
+    block_t *chain = NULL, **last = &chain;
+
+    while ((ret = avcodec_receive_packet(ctx, sys->packet)) == 0)
+    {
+        AVPacket *packet = sys->packet;
+        block_t *block = block_Alloc(packet->size);
+
+        if (likely(block != NULL))
+        {
+            memcpy(block->p_buffer, packet->data, packet->size);
+            block->i_pts = FROM_AVSCALE(packet->pts, ctx->time_base);
+            block->i_dts = FROM_AVSCALE(packet->dts, ctx->time_base);
+            block->i_length = FROM_AVSCALE(packet->duration, ctx->time_base);
+            if (packet->flags & AV_PKT_FLAG_KEY)
+                block->i_flags |= BLOCK_FLAG_TYPE_I;
+            block_ChainLastAppend(&last, block);
+        }
+        av_packet_unref(packet);
+    }
+
+    if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+        msg_Err(enc, "cannot receive the encoded data: %d", ret);
+    return chain;
+}
+
+static AVBufferRef *CreateFrames(encoder_t *enc, VADisplay va_dpy,
+                                 enum AVPixelFormat sw_format)
+{
+    AVBufferRef *hwdev_ref = av_hwdevice_ctx_alloc(AV_HWDEVICE_TYPE_VAAPI);
+    if (hwdev_ref == NULL)
+        return NULL;
+
+    AVHWDeviceContext *hwdev_ctx = (void *) hwdev_ref->data;
+    AVVAAPIDeviceContext *vadev_ctx = hwdev_ctx->hwctx;
+    vadev_ctx->display = va_dpy;
+
+    if (av_hwdevice_ctx_init(hwdev_ref) < 0)
+    {
+        av_buffer_unref(&hwdev_ref);
+        return NULL;
+    }
+
+    AVBufferRef *hwframes_ref = av_hwframe_ctx_alloc(hwdev_ref);
+    av_buffer_unref(&hwdev_ref);
+    if (hwframes_ref == NULL)
+        return NULL;
+
+    /* The surfaces come from the decoder: the pool stays empty */
+    AVHWFramesContext *hwframes_ctx = (void *) hwframes_ref->data;
+    hwframes_ctx->format = AV_PIX_FMT_VAAPI;
+    hwframes_ctx->sw_format = sw_format;
+    hwframes_ctx->width = enc->fmt_in.video.i_width;
+    hwframes_ctx->height = enc->fmt_in.video.i_height;
+    hwframes_ctx->initial_pool_size = 0;
+
+    if (av_hwframe_ctx_init(hwframes_ref) < 0)
+    {
+        av_buffer_unref(&hwframes_ref);
+        return NULL;
+    }
+    return hwframes_ref;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    encoder_t *enc = (encoder_t *)obj;
+
+    if (!vlc_vaapi_IsChromaOpaque(enc->fmt_in.video.i_chroma)
+     || enc->vctx_in == NULL
+     || vlc_video_context_GetType(enc->vctx_in) != VLC_VIDEO_CONTEXT_VAAPI)
+        return VLC_EGENERIC;
+
+    if (enc->fmt_in.video.i_x_offset != 0 || enc->fmt_in.video.i_y_offset != 0)
+        return VLC_EGENERIC;
+
+    const char *name = GetEncoderName(enc->fmt_out.i_codec);
+    if (name == NULL)
+        return VLC_EGENERIC;
+
+    vlc_init_avcodec(obj);
+
+    const AVCodec *codec = avcodec_find_encoder_by_name(name);
+    if (codec == NULL)
+    {
+        msg_Dbg(enc, "%s not supported by libavcodec", name);
+        return VLC_EGENERIC;
+    }
+
+    encoder_sys_t *sys = calloc(1, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+    enc->p_sys = sys;
+
+    config_ChainParse(enc, ENC_CFG_PREFIX, ppsz_enc_options, enc->p_cfg);
+
+    sys->dec_device = vlc_video_context_HoldDevice(enc->vctx_in);
+    if (sys->dec_device == NULL
+     || sys->dec_device->type != VLC_DECODER_DEVICE_VAAPI)
+        goto error;
+    sys->va_dpy = sys->dec_device->opaque;
+
+    const bool high_depth =
+        enc->fmt_in.video.i_chroma == VLC_CODEC_VAAPI_420_10BPP;
+
+    sys->hwframes_ref = CreateFrames(enc, sys->va_dpy,
+                                     high_depth ? AV_PIX_FMT_P010
+                                                : AV_PIX_FMT_NV12);
+    if (sys->hwframes_ref == NULL)
+    {
+        msg_Err(enc, "cannot create the VAAPI frames context");
+        goto error;
+    }
+
+    sys->frame = av_frame_alloc();
+    sys->packet = av_packet_alloc();
+    sys->ctx = avcodec_alloc_context3(codec);
+    if (sys->frame == NULL || sys->packet == NULL || sys->ctx == NULL)
+        goto error;
+
+    AVCodecContext *ctx = sys->ctx;
+    const video_format_t *vfmt = &enc->fmt_in.video;
+
+    ctx->width = vfmt->i_visible_width;
+    ctx->height = vfmt->i_visible_height;
+    ctx->pix_fmt = AV_PIX_FMT_VAAPI;
+    ctx->hw_frames_ctx = av_buffer_ref(sys->hwframes_ref);
+    if (ctx->hw_frames_ctx == NULL)
+        goto error;
+
+    unsigned num = vfmt->i_frame_rate, den = vfmt->i_frame_rate_base;
+    if (num == 0 || den == 0)
+    {
+        num = 25;
+        den = 1;
+    }
+    ctx->framerate = (AVRational){ num, den };
+    ctx->time_base = (AVRational){ den, num };
+
+    if (vfmt->i_sar_num > 0 && vfmt->i_sar_den > 0)
+        ctx->sample_aspect_ratio = (AVRational){ vfmt->i_sar_num,
+                                                 vfmt->i_sar_den };
+
+    int keyint = var_GetInteger(enc, ENC_CFG_PREFIX "keyint");
+    if (keyint <= 0)
+        keyint = enc->i_iframes;
+    if (keyint > 0)
+        ctx->gop_size = keyint;
+
+    char *rc = var_GetString(enc, ENC_CFG_PREFIX "rc-method");
+    const char *rc_mode = "VBR";
+
+    if (rc != NULL && !strcmp(rc, "cqp"))
+    {
+        rc_mode = "CQP";
+        int qp = var_GetInteger(enc, ENC_CFG_PREFIX "qp");
+        if (qp > 0)
+            av_opt_set_int(ctx->priv_data, "qp", qp, 0);
+    }
+    else if (enc->fmt_out.i_bitrate > 0)
+    {
+        ctx->bit_rate = enc->fmt_out.i_bitrate;
+        if (rc != NULL && !strcmp(rc, "cbr"))
+        {
+            rc_mode = "CBR";
+            ctx->rc_max_rate = ctx->bit_rate;
+        }
+    }
+    else
+        rc_mode = "auto"; /* no bitrate: leave it to the driver */
+    free(rc);
+
+    if (av_opt_set(ctx->priv_data, "rc_mode", rc_mode, 0) < 0)
+        msg_Warn(enc, "rate control method %s not supported", rc_mode);
+
+    if (var_GetBool(enc, ENC_CFG_PREFIX "low-latency"))
+    {
+        ctx->max_b_frames = 0;
+        av_opt_set_int(ctx->priv_data, "async_depth", 1, 0);
+    }
+    if (var_GetBool(enc, ENC_CFG_PREFIX "low-power"))
+        av_opt_set_int(ctx->priv_data, "low_power", 1, 0);
+
+    /* Parameter sets are repeated in-band: no extradata is needed */
+    int ret = avcodec_open2(ctx, codec, NULL);
+    if (ret < 0)
+    {
+        msg_Err(enc, "cannot open %s: %d", name, ret);
+        goto error;
+    }
+
+    msg_Dbg(enc, "using %s (%ux%u, %s)", name, ctx->width, ctx->height,
+            rc_mode);
+
+    static const struct vlc_encoder_operations ops =
+    {
+        .close = Close,
+        .encode_video = Encode,
+    };
+    enc->ops = &ops;
+    return VLC_SUCCESS;
+
+error:
+    Close(enc);
+    return VLC_EGENERIC;
+}
+
+static void Close(encoder_t *enc)
+{
+    encoder_sys_t *sys = enc->p_sys;
+
+    /* the encoder holds the last pictures until it is freed */
+    avcodec_free_context(&sys->ctx);
+    av_packet_free(&sys->packet);
+    av_frame_free(&sys->frame);
+    av_buffer_unref(&sys->hwframes_ref);
+    if (sys->dec_device != NULL)
+        vlc_decoder_device_Release(sys->dec_device);
+    free(sys);
+}
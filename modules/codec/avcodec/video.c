@@ -78,6 +78,7 @@ typedef struct
     bool b_show_corrupted;
     bool b_from_preroll;
     enum AVDiscard i_skip_frame;
+    enum AVDiscard i_skip_loop_filter;
 
     struct frame_info_s frame_info[FRAME_INFO_DEPTH];
 
@@ -95,6 +96,8 @@ typedef struct
     /* for direct rendering */
     bool        b_direct_rendering;
     bool        b_dr_failure; /* Protected by lock */
+    unsigned    i_copied_pictures;
+    unsigned    i_decoded_pictures;
 
     /* Hack to force display of still pictures */
     bool b_first_frame;
@@ -166,6 +169,30 @@ static int lavc_GetVideoFormat(decoder_t *dec, video_format_t *restrict fmt,
             fmt->i_chroma = VLC_CODEC_RGB32;
 
         avcodec_align_dimensions2(ctx, &width, &height, aligns);
+
+        /* Widen the buffers so that every plane pitch, hence every plane
+         * offset, of the pool pictures matches the libavcodec alignment:
+         * direct rendering then works whatever the chroma and bit depth. */
+        const vlc_chroma_description_t *dsc =
+            vlc_fourcc_GetChromaDescription(fmt->i_chroma);
+        if (dsc != NULL && width > 0)
+        {
+            unsigned modulo = 1;
+
+            assert(dsc->plane_count <= 4);
+            for (unsigned i = 0; i < dsc->plane_count; i++)
+            {
+                if (aligns[i] <= 0)
+                    continue;
+
+                /* pitch = width / den * num * pixel_size */
+                unsigned bytes = dsc->p[i].w.num * dsc->pixel_size;
+                unsigned step = dsc->p[i].w.den
+                              * (aligns[i] / GCD(aligns[i], bytes));
+                modulo = modulo / GCD(modulo, step) * step;
+            }
+            width = (width + modulo - 1) / modulo * modulo;
+        }
     }
 
     if( width == 0 || height == 0 || width > 8192 || height > 8192 ||
@@ -468,6 +495,7 @@ int InitVideoDec( vlc_object_t *obj )
     else if( i_val == 2 ) p_context->skip_loop_filter = AVDISCARD_BIDIR;
     else if( i_val == 1 ) p_context->skip_loop_filter = AVDISCARD_NONREF;
     else p_context->skip_loop_filter = AVDISCARD_DEFAULT;
+    p_sys->i_skip_loop_filter = p_context->skip_loop_filter;
 
     /* ***** libavcodec frame skipping ***** */
     p_sys->b_hurry_up = var_CreateGetBool( p_dec, "avcodec-hurry-up" );
@@ -493,6 +521,8 @@ int InitVideoDec( vlc_object_t *obj )
     /* ***** libavcodec direct rendering ***** */
     p_sys->b_direct_rendering = false;
     p_sys->b_dr_failure = false;
+    p_sys->i_copied_pictures = 0;
+    p_sys->i_decoded_pictures = 0;
     if( var_CreateGetBool( p_dec, "avcodec-dr" ) &&
        (p_codec->capabilities & AV_CODEC_CAP_DR1) &&
         /* No idea why ... but this fixes flickering on some TSCC streams */
@@ -525,6 +555,8 @@ int InitVideoDec( vlc_object_t *obj )
 #else
         i_thread_count = __MIN( i_thread_count, p_codec->id == AV_CODEC_ID_HEVC ? 10 : 6 );
 #endif
+        /* Share the CPUs with the other running decoders */
+        i_thread_count = decoder_GetThreadBudget( p_dec, i_thread_count );
     }
     i_thread_count = __MIN( i_thread_count, p_codec->id == AV_CODEC_ID_HEVC ? 32 : 16 );
     msg_Dbg( p_dec, "allowing %d thread(s) for decoding", i_thread_count );
@@ -970,6 +1002,18 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
     if( p_sys->b_hurry_up )
     {
         p_context->skip_frame = p_sys->i_skip_frame;
+        p_context->skip_loop_filter = p_sys->i_skip_loop_filter;
+
+        /* Degrade step by step while the video output is late */
+        unsigned level = decoder_GetHurryLevel( p_dec );
+        if( level >= DECODER_HURRY_LOOP_FILTER )
+            p_context->skip_loop_filter = AVDISCARD_ALL;
+        if( level >= DECODER_HURRY_NONREF )
+            p_context->skip_frame = __MAX( p_context->skip_frame,
+                                           AVDISCARD_NONREF );
+        if( level >= DECODER_HURRY_BIDIR )
+            p_context->skip_frame = __MAX( p_context->skip_frame,
+                                           AVDISCARD_BIDIR );
 
         /* Check also if we should/can drop the block and move to next block
             as trying to catchup the speed*/
@@ -1188,6 +1232,8 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
             }
         }
 
+        p_sys->i_decoded_pictures++;
+
         picture_t *p_pic = frame->opaque;
         if( p_pic == NULL )
         {   /* When direct rendering is not used, get_format() and get_buffer()
@@ -1206,6 +1252,11 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
                 break;
             }
 
+            if( p_sys->i_copied_pictures++ == 0 )
+                msg_Dbg( p_dec, "copying decoded pictures (direct rendering "
+                         "%s)", p_sys->b_direct_rendering ? "failed"
+                                                          : "disabled" );
+
             /* Fill picture_t from AVFrame */
             if( lavc_CopyPicture( p_dec, p_pic, frame ) != VLC_SUCCESS )
             {
@@ -1330,6 +1381,10 @@ void EndVideoDec( vlc_object_t *obj )
 
     cc_Flush( &p_sys->cc );
 
+    if( p_sys->i_copied_pictures > 0 )
+        msg_Dbg( p_dec, "%u out of %u decoded pictures were copied",
+                 p_sys->i_copied_pictures, p_sys->i_decoded_pictures );
+
     avcodec_free_context( &ctx );
 
     if( p_sys->p_va )
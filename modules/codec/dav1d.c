@@ -402,11 +402,25 @@ static int OpenDecoder(vlc_object_t *p_this)
 
     dav1d_default_settings(&p_sys->s);
     p_sys->s.n_tile_threads = var_InheritInteger(p_this, "dav1d-thread-tiles");
-    if (p_sys->s.n_tile_threads == 0)
-        p_sys->s.n_tile_threads = VLC_CLIP(vlc_GetCPUCount(), 1, 4);
     p_sys->s.n_frame_threads = var_InheritInteger(p_this, "dav1d-thread-frames");
+
+    /* Share the CPUs with the other running decoders. Each frame thread runs
+     * its own tile threads: split the budget between them, favouring tile
+     * threads which cost neither latency nor picture buffers. */
+    unsigned i_cpus = vlc_GetCPUCount();
+    if (p_sys->s.n_tile_threads == 0 || p_sys->s.n_frame_threads == 0)
+        i_cpus = decoder_GetThreadBudget(dec, i_cpus);
+    if (p_sys->s.n_tile_threads == 0)
+    {
+        unsigned i_tiles = i_cpus;
+        if (p_sys->s.n_frame_threads > 0)
+            i_tiles /= p_sys->s.n_frame_threads;
+        p_sys->s.n_tile_threads = VLC_CLIP(i_tiles, 1, 4);
+    }
     if (p_sys->s.n_frame_threads == 0)
-        p_sys->s.n_frame_threads = __MAX(1, vlc_GetCPUCount());
+        p_sys->s.n_frame_threads =
+            VLC_CLIP(i_cpus / p_sys->s.n_tile_threads, 1,
+                     DAV1D_MAX_FRAME_THREADS);
     p_sys->s.allocator.cookie = dec;
     p_sys->s.allocator.alloc_picture_callback = NewPicture;
     p_sys->s.allocator.release_picture_callback = FreePicture;
@@ -60,6 +60,7 @@ vlc_module_end ()
  * Local prototypes
  ****************************************************************************/
 static int DecodeBlock( decoder_t *, block_t * );
+static int DecodeBatch( decoder_t *, block_t * );
 static void Flush( decoder_t * );
 static void DoReordering( uint32_t *, uint32_t *, int, int, uint8_t * );
 
@@ -189,6 +190,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->b_sbr = p_sys->b_ps = false;
 
     p_dec->pf_decode = DecodeBlock;
+    p_dec->pf_decode_batch = DecodeBatch;
     p_dec->pf_flush  = Flush;
     return VLC_SUCCESS;
 }
@@ -610,6 +612,22 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
     return VLCDEC_SUCCESS;
 }
 
+/*****************************************************************************
+ * DecodeBatch:
+ *****************************************************************************/
+static int DecodeBatch( decoder_t *p_dec, block_t *p_chain )
+{
+    while( p_chain != NULL )
+    {
+        block_t *p_block = p_chain;
+
+        p_chain = p_block->p_next;
+        p_block->p_next = NULL;
+        DecodeBlock( p_dec, p_block );
+    }
+    return VLCDEC_SUCCESS;
+}
+
 /*****************************************************************************
  * Close:
  *****************************************************************************/
@@ -72,6 +72,7 @@ typedef struct
 
     JSAMPARRAY p_row_pointers;
     struct jpeg_decompress_struct p_jpeg;
+    bool b_size_hint; /* the image handler tells the wanted size */
 } decoder_sys_t;
 
 static int  OpenDecoder(vlc_object_t *);
@@ -169,6 +170,7 @@ static int OpenDecoder(vlc_object_t *p_this)
     p_dec->p_sys = p_sys;
 
     p_sys->p_obj = p_this;
+    p_sys->b_size_hint = var_Type(p_dec, "image-width") != 0;
 
     p_sys->p_jpeg.err = jpeg_std_error(&p_sys->err);
     p_sys->err.error_exit = user_error_exit;
@@ -494,6 +496,29 @@ jpeg_GetOrientation( j_decompress_ptr cinfo )
     return 0;     /* No EXIF Orientation tag found */
 }
 
+/*
+ * Decodes at the smallest size not below the one wanted by the image handler:
+ * the IDCT then downscales by 2, 4 or 8 for free, and the converter only
+ * has the rest to do.
+ */
+static void SetScale(decoder_t *p_dec, struct jpeg_decompress_struct *p_jpeg)
+{
+    const unsigned i_width = var_GetInteger(p_dec, "image-width");
+    const unsigned i_height = var_GetInteger(p_dec, "image-height");
+
+    if (i_width == 0 && i_height == 0)
+        return;
+
+    unsigned i_denom = 1;
+    while (i_denom < 8
+        && p_jpeg->image_width / (i_denom * 2) >= i_width
+        && p_jpeg->image_height / (i_denom * 2) >= i_height)
+        i_denom *= 2;
+
+    p_jpeg->scale_num = 1;
+    p_jpeg->scale_denom = i_denom;
+}
+
 /*
  * This function must be fed with a complete compressed frame.
  */
@@ -525,6 +550,8 @@ static int DecodeBlock(decoder_t *p_dec, block_t *p_block)
     jpeg_read_header(&p_sys->p_jpeg, TRUE);
 
     p_sys->p_jpeg.out_color_space = JCS_RGB;
+    if (p_sys->b_size_hint)
+        SetScale(p_dec, &p_sys->p_jpeg);
 
     jpeg_start_decompress(&p_sys->p_jpeg);
 
@@ -72,6 +72,21 @@ vlc_module_end ()
 static int DecodeBlock( decoder_t *, block_t * );
 static void Flush( decoder_t * );
 
+/* Frames are rendered ahead for the next predicted dates. libass works with
+ * milliseconds, and container timestamps are often rounded to them. */
+#define AHEAD_FRAMES 4
+#define AHEAD_TOLERANCE VLC_TICK_FROM_MS(5)
+#define AHEAD_MAX_STEP  VLC_TICK_FROM_MS(250)
+
+typedef struct
+{
+    vlc_tick_t     i_date;    /* stream date, VLC_TICK_INVALID if unused */
+    unsigned       i_gen;     /* identifies the rendered image */
+    bool           b_drawn;   /* p_regions holds the image */
+    subpicture_region_t *p_regions;
+    unsigned       i_width, i_height;
+} libass_frame_t;
+
 /* */
 typedef struct
 {
@@ -89,6 +104,20 @@ typedef struct
 
     /* */
     ASS_Track      *p_track;
+    unsigned       i_image_gen; /* changes with the renderer output */
+
+    /* Render ahead worker, the following fields are protected by ahead_lock.
+     * ahead_lock may be taken with lock held, never the opposite. */
+    vlc_mutex_t    ahead_lock;
+    vlc_cond_t     ahead_wait;
+    vlc_thread_t   ahead_thread;
+    bool           b_ahead_thread;
+    bool           b_ahead_exit;
+    unsigned       i_ahead_epoch; /* changes when the frames become stale */
+    vlc_tick_t     i_ahead_last;  /* last date shown */
+    vlc_tick_t     i_ahead_step;  /* estimated frame duration */
+    vlc_tick_t     i_ahead_next;  /* next date to render */
+    libass_frame_t ahead[AHEAD_FRAMES];
 } decoder_sys_t;
 static void DecSysRelease( decoder_sys_t *p_sys );
 static void DecSysHold( decoder_sys_t *p_sys );
@@ -110,6 +139,8 @@ typedef struct
     vlc_tick_t    i_pts;
 
     ASS_Image     *p_img;
+    unsigned      i_gen; /* of the image shown */
+    libass_frame_t frame; /* rendered ahead, to be shown */
 } libass_spu_updater_sys_t;
 
 typedef struct
@@ -122,6 +153,10 @@ typedef struct
 
 static int BuildRegions( rectangle_t *p_region, int i_max_region, ASS_Image *p_img_list, int i_width, int i_height );
 static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img );
+static subpicture_region_t *RegionsNew( const video_format_t *p_fmt, ASS_Image *p_img );
+
+static void *AheadThread( void * );
+static void AheadClear( decoder_sys_t *p_sys );
 
 //#define DEBUG_REGION
 
@@ -152,6 +187,18 @@ static int Create( vlc_object_t *p_this )
     p_sys->p_library  = NULL;
     p_sys->p_renderer = NULL;
     p_sys->p_track    = NULL;
+    p_sys->i_image_gen = 1;
+
+    vlc_mutex_init( &p_sys->ahead_lock );
+    vlc_cond_init( &p_sys->ahead_wait );
+    p_sys->b_ahead_thread = false;
+    p_sys->b_ahead_exit = false;
+    p_sys->i_ahead_epoch = 0;
+    p_sys->i_ahead_last = VLC_TICK_INVALID;
+    p_sys->i_ahead_step = 0;
+    p_sys->i_ahead_next = VLC_TICK_INVALID;
+    for( int i = 0; i < AHEAD_FRAMES; i++ )
+        p_sys->ahead[i].i_date = VLC_TICK_INVALID;
 
     /* Create libass library */
     ASS_Library *p_library = p_sys->p_library = ass_library_init();
@@ -280,6 +327,13 @@ static int Create( vlc_object_t *p_this )
     }
     ass_process_codec_private( p_track, p_dec->fmt_in.p_extra, p_dec->fmt_in.i_extra );
 
+    /* Heavy typesetting would otherwise delay the video output thread */
+    if( vlc_clone( &p_sys->ahead_thread, AheadThread, p_sys,
+                   VLC_THREAD_PRIORITY_LOW ) == 0 )
+        p_sys->b_ahead_thread = true;
+    else
+        msg_Warn( p_dec, "cannot render subtitles ahead" );
+
     p_dec->fmt_out.i_codec = VLC_CODEC_RGBA;
 
     return VLC_SUCCESS;
@@ -313,6 +367,16 @@ static void DecSysRelease( decoder_sys_t *p_sys )
     }
     vlc_mutex_unlock( &p_sys->lock );
 
+    if( p_sys->b_ahead_thread )
+    {
+        vlc_mutex_lock( &p_sys->ahead_lock );
+        p_sys->b_ahead_exit = true;
+        vlc_cond_signal( &p_sys->ahead_wait );
+        vlc_mutex_unlock( &p_sys->ahead_lock );
+        vlc_join( p_sys->ahead_thread, NULL );
+    }
+    AheadClear( p_sys );
+
     if( p_sys->p_track )
         ass_free_track( p_sys->p_track );
     if( p_sys->p_renderer )
@@ -332,6 +396,13 @@ static void Flush( decoder_t *p_dec )
 
     p_sys->i_max_stop = VLC_TICK_INVALID;
     p_sys->i_last_pts = VLC_TICK_INVALID;
+
+    /* The libass caches are kept, only the frames ahead are dropped */
+    vlc_mutex_lock( &p_sys->ahead_lock );
+    AheadClear( p_sys );
+    p_sys->i_ahead_last = VLC_TICK_INVALID;
+    p_sys->i_ahead_next = VLC_TICK_INVALID;
+    vlc_mutex_unlock( &p_sys->ahead_lock );
 }
 
 /****************************************************************************
@@ -385,6 +456,9 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
         }
 
         p_spu_sys->p_img = NULL;
+        p_spu_sys->i_gen = 0;
+        p_spu_sys->frame.i_date = VLC_TICK_INVALID;
+        p_spu_sys->frame.p_regions = NULL;
         p_spu_sys->p_dec_sys = p_sys;
         p_spu_sys->i_pts = p_block->i_pts;
         p_spu->i_start = p_block->i_pts;
@@ -404,6 +478,14 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
     {
         ass_process_chunk( p_sys->p_track,(void *) p_block->p_buffer, p_block->i_buffer,
                            MS_FROM_VLC_TICK( p_block->i_pts ), MS_FROM_VLC_TICK( p_block->i_length ) );
+
+        /* The new event may show in the frames rendered ahead */
+        vlc_mutex_lock( &p_sys->ahead_lock );
+        AheadClear( p_sys );
+        if( p_sys->i_ahead_next != VLC_TICK_INVALID )
+            p_sys->i_ahead_next = p_sys->i_ahead_last + p_sys->i_ahead_step;
+        vlc_cond_signal( &p_sys->ahead_wait );
+        vlc_mutex_unlock( &p_sys->ahead_lock );
     }
     vlc_mutex_unlock( &p_sys->lock );
 
@@ -415,6 +497,133 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
     return VLCDEC_SUCCESS;
 }
 
+/****************************************************************************
+ * Render ahead
+ ****************************************************************************/
+/* Must be called with ahead_lock held */
+static void AheadClear( decoder_sys_t *p_sys )
+{
+    for( int i = 0; i < AHEAD_FRAMES; i++ )
+    {
+        libass_frame_t *p_frame = &p_sys->ahead[i];
+        if( p_frame->i_date == VLC_TICK_INVALID )
+            continue;
+        subpicture_region_ChainDelete( p_frame->p_regions );
+        p_frame->i_date = VLC_TICK_INVALID;
+    }
+    p_sys->i_ahead_epoch++;
+}
+
+/* Must be called with ahead_lock held. Returns the frame rendered for the
+ * date, if any, and drops the older ones. */
+static libass_frame_t AheadTake( decoder_sys_t *p_sys, vlc_tick_t i_date )
+{
+    libass_frame_t found = { .i_date = VLC_TICK_INVALID };
+
+    for( int i = 0; i < AHEAD_FRAMES; i++ )
+    {
+        libass_frame_t *p_frame = &p_sys->ahead[i];
+        if( p_frame->i_date == VLC_TICK_INVALID ||
+            p_frame->i_date > i_date + AHEAD_TOLERANCE )
+            continue;
+
+        if( found.i_date == VLC_TICK_INVALID &&
+            p_frame->i_date >= i_date - AHEAD_TOLERANCE )
+            found = *p_frame;
+        else
+            subpicture_region_ChainDelete( p_frame->p_regions );
+        p_frame->i_date = VLC_TICK_INVALID;
+    }
+    return found;
+}
+
+/* Must be called with ahead_lock held */
+static void AheadSchedule( decoder_sys_t *p_sys, vlc_tick_t i_date )
+{
+    if( i_date == p_sys->i_ahead_last )
+        return; /* same frame, from another subpicture */
+
+    const vlc_tick_t i_step = i_date - p_sys->i_ahead_last;
+    if( p_sys->i_ahead_last != VLC_TICK_INVALID &&
+        i_step > 0 && i_step <= AHEAD_MAX_STEP )
+    {
+        p_sys->i_ahead_step = i_step;
+        /* Start over if the worker fell behind */
+        if( p_sys->i_ahead_next == VLC_TICK_INVALID ||
+            p_sys->i_ahead_next <= i_date + AHEAD_TOLERANCE )
+            p_sys->i_ahead_next = i_date + i_step;
+        vlc_cond_signal( &p_sys->ahead_wait );
+    }
+    else
+    {
+        /* Discontinuity, wait for the next frame to predict */
+        AheadClear( p_sys );
+        p_sys->i_ahead_next = VLC_TICK_INVALID;
+    }
+    p_sys->i_ahead_last = i_date;
+}
+
+static libass_frame_t *AheadGetFree( decoder_sys_t *p_sys )
+{
+    for( int i = 0; i < AHEAD_FRAMES; i++ )
+        if( p_sys->ahead[i].i_date == VLC_TICK_INVALID )
+            return &p_sys->ahead[i];
+    return NULL;
+}
+
+static void *AheadThread( void *data )
+{
+    decoder_sys_t *p_sys = data;
+
+    vlc_mutex_lock( &p_sys->ahead_lock );
+    for( ;; )
+    {
+        libass_frame_t *p_free = NULL;
+        while( !p_sys->b_ahead_exit &&
+               ( p_sys->i_ahead_next == VLC_TICK_INVALID ||
+                 ( p_free = AheadGetFree( p_sys ) ) == NULL ) )
+            vlc_cond_wait( &p_sys->ahead_wait, &p_sys->ahead_lock );
+        if( p_sys->b_ahead_exit )
+            break;
+
+        const unsigned i_epoch = p_sys->i_ahead_epoch;
+        libass_frame_t frame = {
+            .i_date = p_sys->i_ahead_next,
+            .p_regions = NULL,
+        };
+        vlc_mutex_unlock( &p_sys->ahead_lock );
+
+        vlc_mutex_lock( &p_sys->lock );
+        int i_changed;
+        ASS_Image *p_img = ass_render_frame( p_sys->p_renderer, p_sys->p_track,
+                                             MS_FROM_VLC_TICK( frame.i_date ),
+                                             &i_changed );
+        if( i_changed )
+        {
+            p_sys->i_image_gen++;
+            frame.p_regions = RegionsNew( &p_sys->fmt, p_img );
+            frame.b_drawn = p_img == NULL || frame.p_regions != NULL;
+        }
+        else
+            frame.b_drawn = false; /* same as the previous frame */
+        frame.i_gen = p_sys->i_image_gen;
+        frame.i_width = p_sys->fmt.i_visible_width;
+        frame.i_height = p_sys->fmt.i_visible_height;
+        vlc_mutex_unlock( &p_sys->lock );
+
+        vlc_mutex_lock( &p_sys->ahead_lock );
+        if( i_epoch == p_sys->i_ahead_epoch )
+        {
+            *p_free = frame;
+            p_sys->i_ahead_next += p_sys->i_ahead_step;
+        }
+        else /* rendered with a stale track or size */
+            subpicture_region_ChainDelete( frame.p_regions );
+    }
+    vlc_mutex_unlock( &p_sys->ahead_lock );
+    return NULL;
+}
+
 /****************************************************************************
  *
  ****************************************************************************/
@@ -425,6 +634,30 @@ static int SubpictureValidate( subpicture_t *p_subpic,
 {
     libass_spu_updater_sys_t *p_spusys = p_subpic->updater.p_sys;
     decoder_sys_t *p_sys = p_spusys->p_dec_sys;
+    const vlc_tick_t i_stream_date = p_spusys->i_pts + (i_ts - p_subpic->i_start);
+
+    /* Use the frame rendered ahead if any, without waiting for the renderer */
+    libass_frame_t frame = { .i_date = VLC_TICK_INVALID };
+    vlc_mutex_lock( &p_sys->ahead_lock );
+    if( !b_fmt_src && !b_fmt_dst )
+        frame = AheadTake( p_sys, i_stream_date );
+    AheadSchedule( p_sys, i_stream_date );
+    vlc_mutex_unlock( &p_sys->ahead_lock );
+
+    if( frame.i_date != VLC_TICK_INVALID )
+    {
+        if( frame.i_gen == p_spusys->i_gen )
+        {
+            subpicture_region_ChainDelete( frame.p_regions );
+            return VLC_SUCCESS;
+        }
+        if( frame.b_drawn )
+        {
+            /* SubpictureUpdate will not take the lock */
+            p_spusys->frame = frame;
+            return VLC_EGENERIC;
+        }
+    }
 
     vlc_mutex_lock( &p_sys->lock );
 
@@ -440,21 +673,29 @@ static int SubpictureValidate( subpicture_t *p_subpic,
         const double dst_ratio = (double)p_fmt_dst->i_visible_width / p_fmt_dst->i_visible_height;
         ass_set_aspect_ratio( p_sys->p_renderer, dst_ratio / src_ratio, 1 );
         p_sys->fmt = fmt;
+
+        /* The frames ahead were rendered for the previous size */
+        vlc_mutex_lock( &p_sys->ahead_lock );
+        AheadClear( p_sys );
+        vlc_mutex_unlock( &p_sys->ahead_lock );
     }
 
     /* */
-    const vlc_tick_t i_stream_date = p_spusys->i_pts + (i_ts - p_subpic->i_start);
     int i_changed;
     ASS_Image *p_img = ass_render_frame( p_sys->p_renderer, p_sys->p_track,
                                          MS_FROM_VLC_TICK( i_stream_date ), &i_changed );
+    if( i_changed )
+        p_sys->i_image_gen++;
 
-    if( !i_changed && !b_fmt_src && !b_fmt_dst &&
-        (p_img != NULL) == (p_subpic->p_region != NULL) )
+    /* The previous frame may have been rendered for another subpicture or
+     * ahead, compare with what this one shows */
+    if( !b_fmt_src && !b_fmt_dst && p_spusys->i_gen == p_sys->i_image_gen )
     {
         vlc_mutex_unlock( &p_sys->lock );
         return VLC_SUCCESS;
     }
     p_spusys->p_img = p_img;
+    p_spusys->i_gen = p_sys->i_image_gen;
 
     /* The lock is released by SubpictureUpdate */
     return VLC_EGENERIC;
@@ -470,12 +711,38 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
     libass_spu_updater_sys_t *p_spusys = p_subpic->updater.p_sys;
     decoder_sys_t *p_sys = p_spusys->p_dec_sys;
 
-    video_format_t fmt = p_sys->fmt;
-    ASS_Image *p_img = p_spusys->p_img;
+    if( p_spusys->frame.i_date != VLC_TICK_INVALID )
+    {
+        /* Rendered ahead */
+        p_subpic->i_original_picture_height = p_spusys->frame.i_height;
+        p_subpic->i_original_picture_width = p_spusys->frame.i_width;
+        p_subpic->p_region = p_spusys->frame.p_regions;
+        p_spusys->i_gen = p_spusys->frame.i_gen;
+        p_spusys->frame.i_date = VLC_TICK_INVALID;
+        p_spusys->frame.p_regions = NULL;
+        return;
+    }
 
     /* */
-    p_subpic->i_original_picture_height = fmt.i_visible_height;
-    p_subpic->i_original_picture_width = fmt.i_visible_width;
+    p_subpic->i_original_picture_height = p_sys->fmt.i_visible_height;
+    p_subpic->i_original_picture_width = p_sys->fmt.i_visible_width;
+
+    p_subpic->p_region = RegionsNew( &p_sys->fmt, p_spusys->p_img );
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+static void SubpictureDestroy( subpicture_t *p_subpic )
+{
+    libass_spu_updater_sys_t *p_spusys = p_subpic->updater.p_sys;
+
+    subpicture_region_ChainDelete( p_spusys->frame.p_regions );
+    DecSysRelease( p_spusys->p_dec_sys );
+    free( p_spusys );
+}
+
+static subpicture_region_t *RegionsNew( const video_format_t *p_fmt, ASS_Image *p_img )
+{
+    video_format_t fmt = *p_fmt;
 
     /* XXX to improve efficiency we merge regions that are close minimizing
      * the lost surface.
@@ -487,14 +754,9 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
     rectangle_t region[i_max_region];
     const int i_region = BuildRegions( region, i_max_region, p_img, fmt.i_width, fmt.i_height );
 
-    if( i_region <= 0 )
-    {
-        vlc_mutex_unlock( &p_sys->lock );
-        return;
-    }
-
     /* Allocate the regions and draw them */
-    subpicture_region_t **pp_region_last = &p_subpic->p_region;
+    subpicture_region_t *p_regions = NULL;
+    subpicture_region_t **pp_region_last = &p_regions;
 
     for( int i = 0; i < i_region; i++ )
     {
@@ -522,15 +784,7 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
         *pp_region_last = r;
         pp_region_last = &r->p_next;
     }
-    vlc_mutex_unlock( &p_sys->lock );
-
-}
-static void SubpictureDestroy( subpicture_t *p_subpic )
-{
-    libass_spu_updater_sys_t *p_spusys = p_subpic->updater.p_sys;
-
-    DecSysRelease( p_spusys->p_dec_sys );
-    free( p_spusys );
+    return p_regions;
 }
 
 static rectangle_t r_create( int x0, int y0, int x1, int y1 )
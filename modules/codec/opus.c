@@ -159,6 +159,7 @@ static const uint32_t pi_3channels_in[] =
  ****************************************************************************/
 
 static int  DecodeAudio ( decoder_t *, block_t * );
+static int  DecodeBatch ( decoder_t *, block_t * );
 static void Flush( decoder_t * );
 static int  ProcessHeaders( decoder_t * );
 static int  ProcessInitialHeader ( decoder_t *, ogg_packet * );
@@ -287,6 +288,7 @@ static int OpenDecoder( vlc_object_t *p_this )
     p_dec->fmt_out.i_codec = VLC_CODEC_FL32;
 
     p_dec->pf_decode    = DecodeAudio;
+    p_dec->pf_decode_batch = DecodeBatch;
     p_dec->pf_flush     = Flush;
 
     p_sys->p_st = NULL;
@@ -341,6 +343,21 @@ static int DecodeAudio( decoder_t *p_dec, block_t *p_block )
     return VLCDEC_SUCCESS;
 }
 
+static int DecodeBatch( decoder_t *p_dec, block_t *p_chain )
+{
+    while( p_chain != NULL )
+    {
+        block_t *p_block = p_chain;
+
+        p_chain = p_block->p_next;
+        p_block->p_next = NULL;
+        p_block = DecodeBlock( p_dec, p_block );
+        if( p_block != NULL )
+            decoder_QueueAudio( p_dec, p_block );
+    }
+    return VLCDEC_SUCCESS;
+}
+
 /*****************************************************************************
  * ProcessHeaders: process Opus headers.
  *****************************************************************************/
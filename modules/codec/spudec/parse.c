@@ -68,11 +68,24 @@ typedef struct
 
 } subpicture_data_t;
 
+/* Undecoded subpicture, cf. OutputPicture() */
+typedef struct
+{
+    subpicture_data_t data;
+    spu_properties_t properties;
+    uint32_t palette[16+1];
+    bool b_decoded;
+
+    unsigned int i_spu_size;
+    unsigned int i_rle_size;
+    uint8_t buffer[]; /* copy of the SPU packet */
+} spu_rle_t;
+
 static int  ParseControlSeq( decoder_t *, vlc_tick_t i_pts,
                              void(*pf_queue)(decoder_t *, subpicture_t *) );
-static int  ParseRLE       ( decoder_t *, subpicture_data_t *,
-                             const spu_properties_t *, uint16_t * );
-static int  Render         ( decoder_t *, subpicture_t *, const uint16_t *,
+static int  ParseRLE       ( const spu_rle_t *, subpicture_data_t *,
+                             uint16_t * );
+static int  Render         ( subpicture_t *, const uint16_t *,
                              const subpicture_data_t *, const spu_properties_t * );
 
 /*****************************************************************************
@@ -91,12 +104,12 @@ static inline unsigned int AddNibble( unsigned int i_code,
     }
 }
 
-static void CLUTIdxToYUV(const struct subs_format_t *subs,
+static void CLUTIdxToYUV(const uint32_t palette[16+1],
                          const uint8_t idx[4], uint8_t yuv[4][3])
 {
     for( int i = 0; i < 4 ; i++ )
     {
-        uint32_t i_ayvu = subs->spu.palette[1+idx[i]];
+        uint32_t i_ayvu = palette[1+idx[i]];
         /* FIXME: this job should be done sooner */
         yuv[3-i][0] = i_ayvu>>16;
         yuv[3-i][1] = i_ayvu;
@@ -104,7 +117,8 @@ static void CLUTIdxToYUV(const struct subs_format_t *subs,
     }
 }
 
-static void ParsePXCTLI( decoder_t *p_dec, const subpicture_data_t *p_spu_data,
+static void ParsePXCTLI( const uint32_t palette[16+1],
+                         const subpicture_data_t *p_spu_data,
                          subpicture_t *p_spu )
 {
     plane_t *p_plane = &p_spu->p_region->p_picture->p[0];
@@ -119,7 +133,7 @@ static void ParsePXCTLI( decoder_t *p_dec, const subpicture_data_t *p_spu_data,
         if(p_palette->i_entries +4 >= VIDEO_PALETTE_COLORS_MAX)
             break;
 
-        if( p_dec->fmt_in.subs.spu.palette[0] == SPU_PALETTE_DEFINED )
+        if( palette[0] == SPU_PALETTE_DEFINED )
         {
             /* Lookup the CLUT palette for the YUV values */
             uint8_t idx[4];
@@ -129,7 +143,7 @@ static void ParsePXCTLI( decoder_t *p_dec, const subpicture_data_t *p_spu_data,
             idx[1] = (i_color >>  8)&0x0f;
             idx[2] = (i_color >>  4)&0x0f;
             idx[3] = i_color&0x0f;
-            CLUTIdxToYUV( &p_dec->fmt_in.subs, idx, yuv );
+            CLUTIdxToYUV( palette, idx, yuv );
 
             /* Process the contrast */
             alpha[3] = (i_contrast >> 12)&0x0f;
@@ -160,10 +174,7 @@ static void ParsePXCTLI( decoder_t *p_dec, const subpicture_data_t *p_spu_data,
                 if( i_index == VIDEO_PALETTE_COLORS_MAX )
                 {
                     if(p_palette->i_entries == VIDEO_PALETTE_COLORS_MAX)
-                    {
-                        msg_Warn( p_dec, "Cannot create new color, skipping PXCTLI" );
-                        return;
-                    }
+                        return; /* Cannot create new color, skip PXCTLI */
                     i_index = p_palette->i_entries++;
                     memcpy( p_palette->palette[ i_index ], yuvaentry, sizeof(uint8_t [4]) );
                 }
@@ -187,9 +198,68 @@ static void ParsePXCTLI( decoder_t *p_dec, const subpicture_data_t *p_spu_data,
     }
 }
 
+/*****************************************************************************
+ * UpdatePicture: decode the subpicture once it is about to be shown
+ *****************************************************************************/
+static int ValidatePicture( subpicture_t *p_spu,
+                            bool b_src_changed, const video_format_t *p_fmt_src,
+                            bool b_dst_changed, const video_format_t *p_fmt_dst,
+                            vlc_tick_t i_ts )
+{
+    VLC_UNUSED(b_src_changed); VLC_UNUSED(p_fmt_src);
+    VLC_UNUSED(b_dst_changed); VLC_UNUSED(p_fmt_dst);
+    VLC_UNUSED(i_ts);
+    const spu_rle_t *p_rle = p_spu->updater.p_sys;
+
+    /* The bitmap does not depend on the video format */
+    return p_rle->b_decoded ? VLC_SUCCESS : VLC_EGENERIC;
+}
+
+static void UpdatePicture( subpicture_t *p_spu,
+                           const video_format_t *p_fmt_src,
+                           const video_format_t *p_fmt_dst,
+                           vlc_tick_t i_ts )
+{
+    VLC_UNUSED(p_fmt_src); VLC_UNUSED(p_fmt_dst); VLC_UNUSED(i_ts);
+    spu_rle_t *p_rle = p_spu->updater.p_sys;
+
+    /* Once only, even if invalid */
+    p_rle->b_decoded = true;
+
+    /* we are going to expand the RLE stuff so that we won't need to read
+     * nibbles later on. This will speed things up a lot. Plus, we'll only
+     * need to do this stupid interlacing stuff once.
+     *
+     * Rationale for the "p_spudec->i_rle_size * 4*sizeof(*spu_data.p_data)":
+     *  one byte gaves two nibbles and may be used twice (once per field)
+     * generating 4 codes.
+     */
+    uint16_t *p_pixeldata = vlc_alloc( p_rle->i_rle_size,
+                                       sizeof(*p_pixeldata) * 2 * 2 );
+    if( unlikely(p_pixeldata == NULL) )
+        return;
+
+    /* We try to display it */
+    subpicture_data_t render_spu_data = p_rle->data; /* Need a copy */
+    if( ParseRLE( p_rle, &render_spu_data, p_pixeldata ) == VLC_SUCCESS
+     && Render( p_spu, p_pixeldata, &render_spu_data,
+                &p_rle->properties ) == VLC_SUCCESS
+     && render_spu_data.p_pxctli )
+        ParsePXCTLI( p_rle->palette, &render_spu_data, p_spu );
+
+    free( p_pixeldata );
+}
+
+static void DestroyPicture( subpicture_t *p_spu )
+{
+    free( p_spu->updater.p_sys );
+}
+
 /*****************************************************************************
  * OutputPicture:
  *****************************************************************************
+ * The RLE bitmap is only decoded when the subpicture is about to be shown:
+ * after a seek or with dense subtitles, many are never displayed.
  *****************************************************************************/
 static void OutputPicture( decoder_t *p_dec,
                            const subpicture_data_t *p_spu_data,
@@ -198,11 +268,46 @@ static void OutputPicture( decoder_t *p_dec,
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
     subpicture_t *p_spu;
-    uint16_t *p_pixeldata;
+
+    /* Keep what the RLE and PXCTLI parsers may read */
+    size_t i_size = p_sys->i_spu_size + 4;
+    if( p_spu_data->p_pxctli )
+        i_size = __MAX( i_size, (size_t)(p_spu_data->p_pxctli - p_sys->buffer)
+                                + 6 * p_spu_data->i_pxclti );
+
+    spu_rle_t *p_rle = malloc( sizeof(*p_rle) + i_size );
+    if( unlikely(p_rle == NULL) )
+        return;
+
+    p_rle->data = *p_spu_data;
+    p_rle->properties = *p_spu_properties;
+    memcpy( p_rle->palette, p_dec->fmt_in.subs.spu.palette,
+            sizeof(p_rle->palette) );
+    p_rle->b_decoded = false;
+    p_rle->i_spu_size = p_sys->i_spu_size;
+    p_rle->i_rle_size = p_sys->i_rle_size;
+
+    const size_t i_copy = __MIN( i_size, sizeof(p_sys->buffer) );
+    memcpy( p_rle->buffer, p_sys->buffer, i_copy );
+    memset( &p_rle->buffer[i_copy], 0, i_size - i_copy );
+    if( p_spu_data->p_pxctli )
+        p_rle->data.p_pxctli = &p_rle->buffer[p_spu_data->p_pxctli -
+                                              p_sys->buffer];
+
+    subpicture_updater_t updater = {
+        .pf_validate = ValidatePicture,
+        .pf_update   = UpdatePicture,
+        .pf_destroy  = DestroyPicture,
+        .p_sys       = p_rle,
+    };
 
     /* Allocate the subpicture internal data. */
-    p_spu = decoder_NewSubpicture( p_dec, NULL );
-    if( !p_spu ) return;
+    p_spu = decoder_NewSubpicture( p_dec, &updater );
+    if( !p_spu )
+    {
+        free( p_rle );
+        return;
+    }
 
     p_spu->i_original_picture_width =
         p_dec->fmt_in.subs.spu.i_original_frame_width;
@@ -220,44 +325,12 @@ static void OutputPicture( decoder_t *p_dec,
         p_spu->b_ephemer = true;
     }
 
-    /* we are going to expand the RLE stuff so that we won't need to read
-     * nibbles later on. This will speed things up a lot. Plus, we'll only
-     * need to do this stupid interlacing stuff once.
-     *
-     * Rationale for the "p_spudec->i_rle_size * 4*sizeof(*spu_data.p_data)":
-     *  one byte gaves two nibbles and may be used twice (once per field)
-     * generating 4 codes.
-     */
-    p_pixeldata = vlc_alloc( p_sys->i_rle_size, sizeof(*p_pixeldata) * 2 * 2 );
-
-    /* We try to display it */
-    subpicture_data_t render_spu_data = *p_spu_data; /* Need a copy */
-    if( ParseRLE( p_dec, &render_spu_data, p_spu_properties, p_pixeldata ) )
-    {
-        /* There was a parse error, delete the subpicture */
-        subpicture_Delete( p_spu );
-        free( p_pixeldata );
-        return;
-    }
-
 #ifdef DEBUG_SPUDEC
     msg_Dbg( p_dec, "total size: 0x%x, RLE offsets: 0x%x 0x%x",
              p_sys->i_spu_size,
-             render_spu_data.pi_offset[0], render_spu_data.pi_offset[1] );
+             p_spu_data->pi_offset[0], p_spu_data->pi_offset[1] );
 #endif
 
-    if( Render( p_dec, p_spu, p_pixeldata, &render_spu_data, p_spu_properties ) )
-    {
-        subpicture_Delete( p_spu );
-        free( p_pixeldata );
-        return;
-    }
-
-    free( p_pixeldata );
-
-    if( p_spu_data->p_pxctli && p_spu )
-        ParsePXCTLI( p_dec, p_spu_data, p_spu );
-
     pf_queue( p_dec, p_spu );
 }
 
@@ -448,7 +521,8 @@ static int ParseControlSeq( decoder_t *p_dec, vlc_tick_t i_pts,
                 idx[2] = (p_sys->buffer[i_index+2]>>4)&0x0f;
                 idx[3] = (p_sys->buffer[i_index+2])&0x0f;
 
-                CLUTIdxToYUV( &p_dec->fmt_in.subs, idx, spu_data_cmd.pi_yuv );
+                CLUTIdxToYUV( p_dec->fmt_in.subs.spu.palette, idx,
+                              spu_data_cmd.pi_yuv );
             }
 
             i_index += 3;
@@ -598,12 +672,11 @@ static int ParseControlSeq( decoder_t *p_dec, vlc_tick_t i_pts,
  * convenient structure for later decoding. For more information on the
  * subtitles format, see http://sam.zoy.org/doc/dvd/subtitles/index.html
  *****************************************************************************/
-static int ParseRLE( decoder_t *p_dec,
+static int ParseRLE( const spu_rle_t *p_rle,
                      subpicture_data_t *p_spu_data,
-                     const spu_properties_t *p_spu_properties,
                      uint16_t *p_pixeldata )
 {
-    decoder_sys_t *p_sys = p_dec->p_sys;
+    const spu_properties_t *p_spu_properties = &p_rle->properties;
 
     const unsigned int i_width = p_spu_properties->i_width;
     const unsigned int i_height = p_spu_properties->i_height;
@@ -638,12 +711,9 @@ static int ParseRLE( decoder_t *p_dec,
             i_code = 0;
             for( unsigned int i_min = 1; i_min <= 0x40 && i_code < i_min; i_min <<= 2 )
             {
-                if( (*pi_offset >> 1) >= p_sys->i_spu_size )
-                {
-                    msg_Err( p_dec, "out of bounds while reading rle" );
-                    return VLC_EGENERIC;
-                }
-                i_code = AddNibble( i_code, &p_sys->buffer[4], pi_offset );
+                if( (*pi_offset >> 1) >= p_rle->i_spu_size )
+                    return VLC_EGENERIC; /* out of bounds while reading rle */
+                i_code = AddNibble( i_code, &p_rle->buffer[4], pi_offset );
             }
             if( i_code < 0x0004 )
             {
@@ -653,11 +723,7 @@ static int ParseRLE( decoder_t *p_dec,
             }
 
             if( ( (i_code >> 2) + i_x + i_y * i_width ) > i_height * i_width )
-            {
-                msg_Err( p_dec, "out of bounds, %i at (%i,%i) is out of %ix%i",
-                         i_code >> 2, i_x, i_y, i_width, i_height );
-                return VLC_EGENERIC;
-            }
+                return VLC_EGENERIC; /* out of bounds */
 
             /* Try to find the border color */
             if( p_spu_data->pi_alpha[ i_code & 0x3 ] != 0x00 )
@@ -718,10 +784,7 @@ static int ParseRLE( decoder_t *p_dec,
 
         /* Check that we didn't go too far */
         if( i_x > i_width )
-        {
-            msg_Err( p_dec, "i_x overflowed, %i > %i", i_x, i_width );
             return VLC_EGENERIC;
-        }
 
         /* Byte-align the stream */
         if( *pi_offset & 0x1 )
@@ -735,38 +798,13 @@ static int ParseRLE( decoder_t *p_dec,
 
     /* We shouldn't get any padding bytes */
     if( i_y < i_height )
-    {
-        msg_Err( p_dec, "padding bytes found in RLE sequence" );
-        msg_Err( p_dec, "send mail to <sam@zoy.org> if you "
-                        "want to help debugging this" );
-
-        /* Skip them just in case */
-        while( i_y < i_height )
-        {
-            *p_dest++ = i_width << 2;
-            i_y++;
-        }
-
         return VLC_EGENERIC;
-    }
-
-#ifdef DEBUG_SPUDEC
-    msg_Dbg( p_dec, "valid subtitle, size: %ix%i, position: %i,%i",
-             p_spu_properties->i_width, p_spu_properties->i_height,
-             p_spu_properties->i_x, p_spu_properties->i_y );
-#endif
 
     /* Crop if necessary */
     if( i_skipped_top || i_skipped_bottom )
     {
         p_spu_data->i_y_top_offset = i_skipped_top;
         p_spu_data->i_y_bottom_offset = i_skipped_bottom;
-#ifdef DEBUG_SPUDEC
-        msg_Dbg( p_dec, "cropped to: %ix%i, position: %i,%i",
-                 p_spu_properties->i_width,
-                 p_spu_properties->i_height - (i_skipped_top + i_skipped_bottom),
-                 p_spu_properties->i_x, p_spu_properties->i_y + i_skipped_top );
-#endif
     }
 
     /* Handle color if no palette was found */
@@ -824,16 +862,12 @@ static int ParseRLE( decoder_t *p_dec,
             p_spu_data->pi_yuv[i_shade][2] = 0x80;
         }
 
-#ifdef DEBUG_SPUDEC
-        msg_Dbg( p_dec, "using custom palette (border %i, inner %i, shade %i)",
-                 i_border, i_inner, i_shade );
-#endif
     }
 
     return VLC_SUCCESS;
 }
 
-static int Render( decoder_t *p_dec, subpicture_t *p_spu,
+static int Render( subpicture_t *p_spu,
                     const uint16_t *p_pixeldata,
                     const subpicture_data_t *p_spu_data,
                     const spu_properties_t *p_spu_properties )
@@ -867,7 +901,6 @@ static int Render( decoder_t *p_dec, subpicture_t *p_spu,
     {
         fmt.p_palette = NULL;
         video_format_Clean( &fmt );
-        msg_Err( p_dec, "cannot allocate SPU region" );
         return VLC_EGENERIC;
     }
 
@@ -34,6 +34,7 @@
 
 #include <ctype.h>
 #include <assert.h>
+#include <search.h>
 
 #include "substext.h"
 #include "ttml.h"
@@ -82,6 +83,12 @@ typedef struct
     } display;
 }  ttml_style_t;
 
+typedef struct
+{
+    const tt_node_t *p_node;
+    ttml_style_t    *p_style; /* NULL if no style applies */
+} ttml_computed_style_t;
+
 typedef struct
 {
     vlc_dictionary_t regions;
@@ -89,6 +96,10 @@ typedef struct
     ttml_length_t    root_extent_h, root_extent_v;
     unsigned         i_cell_resolution_v;
     unsigned         i_cell_resolution_h;
+    /* Valid for the whole document, whatever the playback time */
+    vlc_dictionary_t style_nodes;  /* id to <style> node */
+    vlc_dictionary_t region_nodes; /* id to <region> node */
+    void *           computed_styles; /* tree of ttml_computed_style_t */
 } ttml_context_t;
 
 typedef struct
@@ -164,6 +175,7 @@ static ttml_style_t * ttml_style_Duplicate( const ttml_style_t *p_src )
     ttml_style_t *p_dup = ttml_style_New( );
     if( p_dup )
     {
+        text_style_Delete( p_dup->font_style );
         *p_dup = *p_src;
         p_dup->font_style = text_style_Duplicate( p_src->font_style );
     }
@@ -611,8 +623,8 @@ static void DictMergeWithStyleID( ttml_context_t *p_ctx, const char *psz_styles,
         while( psz_id )
         {
             /* Lookup referenced style ID */
-            const tt_node_t *p_node = FindNode( p_ctx->p_rootnode,
-                                                "style", -1, psz_id );
+            const tt_node_t *p_node =
+                vlc_dictionary_value_for_key( &p_ctx->style_nodes, psz_id );
             if( p_node )
                 DictionaryMerge( &p_node->attr_dict, &tempdict, true );
 
@@ -633,8 +645,8 @@ static void DictMergeWithRegionID( ttml_context_t *p_ctx, const char *psz_id,
     assert(p_ctx->p_rootnode);
     if( psz_id && p_ctx->p_rootnode )
     {
-        const tt_node_t *p_regionnode = FindNode( p_ctx->p_rootnode,
-                                                 "region", -1, psz_id );
+        const tt_node_t *p_regionnode =
+                vlc_dictionary_value_for_key( &p_ctx->region_nodes, psz_id );
         if( !p_regionnode )
             return;
 
@@ -674,7 +686,7 @@ static void DictToTTMLStyle( ttml_context_t *p_ctx, const vlc_dictionary_t *p_di
     ComputeTTMLStyles( p_ctx, p_dict, p_ttml_style );
 }
 
-static ttml_style_t * InheritTTMLStyles( ttml_context_t *p_ctx, tt_node_t *p_node )
+static ttml_style_t * ResolveTTMLStyles( ttml_context_t *p_ctx, const tt_node_t *p_node )
 {
     assert( p_node );
     ttml_style_t *p_ttml_style = NULL;
@@ -707,6 +719,50 @@ static ttml_style_t * InheritTTMLStyles( ttml_context_t *p_ctx, tt_node_t *p_nod
     return p_ttml_style;
 }
 
+static int ComputedStyleCmp( const void *a, const void *b )
+{
+    const ttml_computed_style_t *p_a = a, *p_b = b;
+    return (p_a->p_node > p_b->p_node) - (p_a->p_node < p_b->p_node);
+}
+
+static void ComputedStyleDelete( void *p )
+{
+    ttml_computed_style_t *p_computed = p;
+    if( p_computed->p_style )
+        ttml_style_Delete( p_computed->p_style );
+    free( p_computed );
+}
+
+/* Styles only depend on the document: resolve them once per node,
+ * as every text node and time interval would walk up the same tree */
+static ttml_style_t * InheritTTMLStyles( ttml_context_t *p_ctx, const tt_node_t *p_node )
+{
+    assert( p_node );
+    const ttml_computed_style_t key = { .p_node = p_node };
+    ttml_computed_style_t **pp_computed =
+            tfind( &key, &p_ctx->computed_styles, ComputedStyleCmp );
+    if( pp_computed == NULL )
+    {
+        ttml_computed_style_t *p_computed = malloc( sizeof(*p_computed) );
+        if( unlikely(p_computed == NULL) )
+            return ResolveTTMLStyles( p_ctx, p_node );
+
+        p_computed->p_node = p_node;
+        p_computed->p_style = ResolveTTMLStyles( p_ctx, p_node );
+        pp_computed = tsearch( p_computed, &p_ctx->computed_styles,
+                               ComputedStyleCmp );
+        if( unlikely(pp_computed == NULL) )
+        {
+            ttml_style_t *p_style = p_computed->p_style;
+            free( p_computed );
+            return p_style;
+        }
+    }
+
+    const ttml_style_t *p_style = (*pp_computed)->p_style;
+    return p_style ? ttml_style_Duplicate( p_style ) : NULL;
+}
+
 static int ParseTTMLChunk( xml_reader_t *p_reader, tt_node_t **pp_rootnode )
 {
     const char* psz_node_name;
@@ -1047,9 +1103,46 @@ static tt_node_t *ParseTTML( decoder_t *p_dec, const uint8_t *p_buffer, size_t i
     return p_rootnode;
 }
 
+static void IndexTTMLNodes( ttml_context_t *p_ctx, const tt_node_t *p_node )
+{
+    vlc_dictionary_t *p_index = NULL;
+    if( !tt_node_NameCompare( p_node->psz_node_name, "style" ) )
+        p_index = &p_ctx->style_nodes;
+    else if( !tt_node_NameCompare( p_node->psz_node_name, "region" ) )
+        p_index = &p_ctx->region_nodes;
+
+    if( p_index )
+    {
+        const char *psz_id = vlc_dictionary_value_for_key( &p_node->attr_dict, "xml:id" );
+        if( !psz_id ) /* People can't do xml properly */
+            psz_id = vlc_dictionary_value_for_key( &p_node->attr_dict, "id" );
+        /* First one in document order wins, as with FindNode() */
+        if( psz_id && !vlc_dictionary_has_key( p_index, psz_id ) )
+            vlc_dictionary_insert( p_index, psz_id, (void *) p_node );
+    }
+
+    for( const tt_basenode_t *p_child = p_node->p_child;
+                              p_child; p_child = p_child->p_next )
+    {
+        if( p_child->i_type != TT_NODE_TYPE_TEXT )
+            IndexTTMLNodes( p_ctx, (const tt_node_t *) p_child );
+    }
+}
+
+static void CleanTTMLContext( ttml_context_t *p_ctx )
+{
+    vlc_dictionary_clear( &p_ctx->style_nodes, NULL, NULL );
+    vlc_dictionary_clear( &p_ctx->region_nodes, NULL, NULL );
+    tdestroy( p_ctx->computed_styles, ComputedStyleDelete );
+}
+
 static void InitTTMLContext( tt_node_t *p_rootnode, ttml_context_t *p_ctx )
 {
     p_ctx->p_rootnode = p_rootnode;
+    vlc_dictionary_init( &p_ctx->style_nodes, 0 );
+    vlc_dictionary_init( &p_ctx->region_nodes, 0 );
+    p_ctx->computed_styles = NULL;
+    IndexTTMLNodes( p_ctx, p_rootnode );
     /* set defaults required for size/cells computation */
     p_ctx->root_extent_h.i_value = 100;
     p_ctx->root_extent_h.unit = TTML_UNIT_PERCENT;
@@ -1078,8 +1171,9 @@ static void InitTTMLContext( tt_node_t *p_rootnode, ttml_context_t *p_ctx )
     }
 }
 
-static ttml_region_t *GenerateRegions( tt_node_t *p_rootnode, tt_time_t playbacktime )
+static ttml_region_t *GenerateRegions( ttml_context_t *p_ctx, tt_time_t playbacktime )
 {
+    tt_node_t *p_rootnode = p_ctx->p_rootnode;
     ttml_region_t*  p_regions = NULL;
     ttml_region_t** pp_region_last = &p_regions;
 
@@ -1088,16 +1182,12 @@ static ttml_region_t *GenerateRegions( tt_node_t *p_rootnode, tt_time_t playback
         const tt_node_t *p_bodynode = FindNode( p_rootnode, "body", 1, NULL );
         if( p_bodynode )
         {
-            ttml_context_t context;
-            InitTTMLContext( p_rootnode, &context );
-            context.p_rootnode = p_rootnode;
-
-            vlc_dictionary_init( &context.regions, 1 );
-            ConvertNodesToRegionContent( &context, p_bodynode, NULL, NULL, playbacktime );
+            vlc_dictionary_init( &p_ctx->regions, 1 );
+            ConvertNodesToRegionContent( p_ctx, p_bodynode, NULL, NULL, playbacktime );
 
-            for( int i = 0; i < context.regions.i_size; ++i )
+            for( int i = 0; i < p_ctx->regions.i_size; ++i )
             {
-                for ( const vlc_dictionary_entry_t* p_entry = context.regions.p_entries[i];
+                for ( const vlc_dictionary_entry_t* p_entry = p_ctx->regions.p_entries[i];
                                                     p_entry != NULL; p_entry = p_entry->p_next )
                 {
                     *pp_region_last = (ttml_region_t *) p_entry->p_value;
@@ -1105,7 +1195,7 @@ static ttml_region_t *GenerateRegions( tt_node_t *p_rootnode, tt_time_t playback
                 }
             }
 
-            vlc_dictionary_clear( &context.regions, NULL, NULL );
+            vlc_dictionary_clear( &p_ctx->regions, NULL, NULL );
         }
     }
     else if ( !tt_node_NameCompare( p_rootnode->psz_node_name, "div" ) ||
@@ -1264,6 +1354,9 @@ static int ParseBlock( decoder_t *p_dec, const block_t *p_block )
     if(TTML_in_PES(p_dec) && i_block_start_time < p_sys->pes.i_prev_segment_start_time )
         i_block_start_time = p_sys->pes.i_prev_segment_start_time;
 
+    ttml_context_t context;
+    InitTTMLContext( p_rootnode, &context );
+
     for( size_t i=0; i+1 < i_timings_count; i++ )
     {
         /* We Only support absolute timings (2) */
@@ -1279,7 +1372,7 @@ static int ParseBlock( decoder_t *p_dec, const block_t *p_block )
 
         bool b_bitmap_regions = false;
         subpicture_t *p_spu = NULL;
-        ttml_region_t *p_regions = GenerateRegions( p_rootnode, p_timings_array[i] );
+        ttml_region_t *p_regions = GenerateRegions( &context, p_timings_array[i] );
         if( p_regions )
         {
             if( p_regions->bgbitmap.i_bytes > 0 && p_regions->updt.p_segments == NULL )
@@ -1320,6 +1413,7 @@ static int ParseBlock( decoder_t *p_dec, const block_t *p_block )
             decoder_QueueSub( p_dec, p_spu );
     }
 
+    CleanTTMLContext( &context );
     tt_node_RecursiveDelete( p_rootnode );
 
     free( p_timings_array );
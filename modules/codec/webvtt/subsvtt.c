@@ -157,6 +157,7 @@ typedef struct
 #ifdef HAVE_CSS
     /* CSS */
     vlc_css_rule_t *p_css_rules;
+    bool b_css_timed; /* rules depend on the playback time */
 #endif
 } decoder_sys_t;
 
@@ -742,6 +743,21 @@ static bool webvtt_domnode_Match_Attribute( const webvtt_dom_node_t *p_node,
     return false;
 }
 
+/* Only the :past and :future pseudo classes depend on the playback time */
+static bool webvtt_css_selectors_IsTimed( const vlc_css_selector_t *p_sel )
+{
+    for( ; p_sel; p_sel = p_sel->p_next )
+    {
+        if( p_sel->type == SELECTOR_PSEUDOCLASS &&
+            ( !strcmp( p_sel->psz_name, "past" ) || !strcmp( p_sel->psz_name, "future" ) ) )
+            return true;
+        if( webvtt_css_selectors_IsTimed( p_sel->specifiers.p_first ) ||
+            webvtt_css_selectors_IsTimed( p_sel->p_matchsel ) )
+            return true;
+    }
+    return false;
+}
+
 static bool webvtt_domnode_MatchType( const webvtt_dom_node_t *p_node,
                                       const vlc_css_selector_t *p_sel, vlc_tick_t i_nzplaybacktime )
 {
@@ -1747,14 +1763,18 @@ static void ApplyCSSRules( decoder_t *p_dec, const vlc_css_rule_t *p_rule,
 }
 #endif
 
-static void RenderRegions( decoder_t *p_dec, vlc_tick_t i_nzstart, vlc_tick_t i_nzstop )
+static void RenderRegions( decoder_t *p_dec, vlc_tick_t i_nzstart, vlc_tick_t i_nzstop,
+                           bool b_restyle )
 {
     subpicture_t *p_spu = NULL;
     substext_updater_region_t *p_updtregion = NULL;
     decoder_sys_t *p_sys = p_dec->p_sys;
 
 #ifdef HAVE_CSS
-    ApplyCSSRules( p_dec, p_sys->p_css_rules, i_nzstart );
+    if( b_restyle )
+        ApplyCSSRules( p_dec, p_sys->p_css_rules, i_nzstart );
+#else
+    VLC_UNUSED(b_restyle);
 #endif
 
     const webvtt_dom_cue_t *p_rlcue = NULL;
@@ -1891,6 +1911,9 @@ static void Render( decoder_t *p_dec, vlc_tick_t i_nzstart, vlc_tick_t i_nzstop
     if( timedtags.i_count )
         qsort( timedtags.pp_elems, timedtags.i_count, sizeof(*timedtags.pp_elems), timedtagsArrayCmp );
 
+    /* Unless the rules depend on the time, the DOM styles resolved for the
+     * first interval stay valid for the following ones */
+    bool b_restyle = true;
     vlc_tick_t i_subnzstart = i_nzstart;
     for( size_t i=0; i<timedtags.i_count; i++ )
     {
@@ -1898,17 +1921,20 @@ static void Render( decoder_t *p_dec, vlc_tick_t i_nzstart, vlc_tick_t i_nzstop
                  (const webvtt_dom_tag_t *) vlc_array_item_at_index( &timedtags, i );
          if( p_tag->i_nzstart != i_subnzstart ) /* might be duplicates */
          {
-             if( i > 0 )
+             if( i > 0 && b_restyle )
                  ClearCSSStyles( (webvtt_dom_node_t *)p_sys->p_root );
-             RenderRegions( p_dec, i_subnzstart, p_tag->i_nzstart );
+             RenderRegions( p_dec, i_subnzstart, p_tag->i_nzstart, b_restyle );
              i_subnzstart = p_tag->i_nzstart;
+#ifdef HAVE_CSS
+             b_restyle = p_sys->b_css_timed;
+#endif
          }
     }
     if( i_subnzstart != i_nzstop )
     {
-        if( i_subnzstart != i_nzstart )
+        if( i_subnzstart != i_nzstart && b_restyle )
             ClearCSSStyles( (webvtt_dom_node_t *)p_sys->p_root );
-        RenderRegions( p_dec, i_subnzstart, i_nzstop );
+        RenderRegions( p_dec, i_subnzstart, i_nzstop, b_restyle );
     }
 
     vlc_array_clear( &timedtags );
@@ -2028,6 +2054,11 @@ static void ParserHeaderHandler( void *priv, enum webvtt_header_line_e s,
 #  ifdef CSS_PARSER_DEBUG
                 vlc_css_parser_Debug( &p );
 #  endif
+                for( const vlc_css_rule_t *p_rule = p.rules.p_first;
+                                           p_rule; p_rule = p_rule->p_next )
+                    p_sys->b_css_timed |=
+                            webvtt_css_selectors_IsTimed( p_rule->p_selectors );
+
                 vlc_css_rule_t **pp_append = &p_sys->p_css_rules;
                 while( *pp_append )
                     pp_append = &((*pp_append)->p_next);
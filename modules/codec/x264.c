@@ -1103,6 +1103,15 @@ static int  Open ( vlc_object_t *p_this )
     if( i_val >= -1 && i_val <= 100 && i_val != 40 )
         p_sys->param.i_scenecut_threshold = i_val;
 
+    /* Fixed GOP requested by the owner, e.g. to align renditions */
+    if( p_enc->i_iframes > 0 )
+    {
+        p_sys->param.i_keyint_max = p_enc->i_iframes;
+        p_sys->param.i_keyint_min = p_enc->i_iframes;
+        p_sys->param.i_scenecut_threshold = 0;
+        p_sys->param.b_open_gop = false;
+    }
+
     p_sys->param.b_deterministic = var_GetBool( p_enc,
                         SOUT_CFG_PREFIX "non-deterministic" );
 
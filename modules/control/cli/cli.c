@@ -401,15 +401,60 @@ int cli_printf(struct cli_client *cl, const char *fmt, ...)
     return len;
 }
 
+/**
+ * Sends a status change to a client without waiting for it.
+ *
+ * Status changes are sent from the player callbacks to every client. A client
+ * that does not keep up with them is disconnected rather than left to stall
+ * the player and the other clients.
+ */
+static void cli_broadcast(struct cli_client *cl, const struct iovec *iov,
+                          unsigned iovlen, size_t len)
+{
+    vlc_mutex_lock(&cl->output_lock);
+    if (cl->fd != -1 && !cl->lagging)
+    {
+        if (cl->socket)
+        {
+            struct msghdr hdr = {
+                .msg_iov = (struct iovec *)iov,
+                .msg_iovlen = iovlen,
+            };
+            ssize_t val = vlc_sendmsg(cl->fd, &hdr, MSG_DONTWAIT);
+
+            if (val < 0 || (size_t)val < len)
+            {
+                msg_Warn(cl->intf, "disconnecting client: %s",
+                         (val < 0) ? vlc_strerror_c(errno)
+                                   : "output buffer full");
+                /* Force end-of-file on the client thread */
+                shutdown(cl->fd, SHUT_RDWR);
+                cl->lagging = true;
+            }
+        }
+        else
+            vlc_writev(cl->fd, iov, iovlen);
+    }
+    vlc_mutex_unlock(&cl->output_lock);
+}
+
 static void msg_vprint(intf_thread_t *p_intf, const char *fmt, va_list args)
 {
     intf_sys_t *sys = p_intf->p_sys;
     struct cli_client *cl;
+    char *msg;
+    int len = vasprintf(&msg, fmt, args);
+
+    if (unlikely(len < 0))
+        return;
+
+    struct iovec iov[2] = { { msg, len }, { (char *)"\n", 1 } };
 
     vlc_mutex_lock(&sys->clients_lock);
     vlc_list_foreach (cl, &sys->clients, node)
-        cli_vprintf(cl, fmt, args);
+        cli_broadcast(cl, iov, ARRAY_SIZE(iov), len + 1);
     vlc_mutex_unlock(&sys->clients_lock);
+    free(msg);
 }
 
 void msg_print(intf_thread_t *intf, const char *fmt, ...)
@@ -475,8 +520,14 @@ static struct cli_client *cli_client_new(intf_thread_t *intf, int fd,
     if (unlikely(cl == NULL))
         return NULL;
 
+    int type;
+    socklen_t typelen = sizeof (type);
+
     cl->stream = stream;
     cl->fd = fd;
+    cl->socket = getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &typelen) == 0
+              && type == SOCK_STREAM;
+    cl->lagging = false;
     atomic_init(&cl->zombie, false);
     cl->intf = intf;
     vlc_mutex_init(&cl->output_lock);
@@ -32,6 +32,8 @@ struct cli_client
 #ifndef _WIN32
     FILE *stream;
     int fd;
+    bool socket; /**< whether status changes can be sent without blocking */
+    bool lagging; /**< whether the client stopped reading status changes */
     atomic_bool zombie;
     vlc_mutex_t output_lock;
     struct vlc_list node;
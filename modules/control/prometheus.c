@@ -0,0 +1,228 @@
+/*****************************************************************************
+ * prometheus.c: stream output metrics exporter
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_interface.h>
+#include <vlc_httpd.h>
+#include <vlc_memstream.h>
+#include <vlc_sout.h>
+
+#define PATH_TEXT N_("URL path")
+#define PATH_LONGTEXT N_( \
+    "Path of the metrics within the HTTP server. The server address is " \
+    "set with the HTTP host and port options.")
+
+static int  Open ( vlc_object_t * );
+static void Close( vlc_object_t * );
+
+vlc_module_begin()
+    set_shortname(N_("Prometheus"))
+    set_description(N_("Prometheus metrics exporter"))
+    set_subcategory(SUBCAT_INTERFACE_CONTROL)
+    add_string("prometheus-path", "/metrics", PATH_TEXT, PATH_LONGTEXT)
+    set_capability("interface", 0)
+    set_callbacks(Open, Close)
+vlc_module_end()
+
+struct intf_sys_t
+{
+    httpd_host_t *host;
+    httpd_file_t *file;
+};
+
+static const char *const type_names[] = {
+    [SOUT_STATS_STREAM] = "stream",
+    [SOUT_STATS_MUX] = "mux",
+    [SOUT_STATS_ACCESS] = "access",
+};
+
+enum metric_value
+{
+    METRIC_BLOCKS,
+    METRIC_BYTES,
+    METRIC_RATE,
+    METRIC_LATE,
+    METRIC_DROPPED,
+    METRIC_IN_FLIGHT,
+    METRIC_QUEUED,
+    METRIC_QUEUED_BYTES,
+    METRIC_LATENCY,
+    METRIC_LATENCY_MAX,
+};
+
+static const struct
+{
+    const char *name;
+    const char *type;
+    const char *help;
+} metrics[] = {
+    [METRIC_BLOCKS] = { "blocks_total", "counter", "Blocks received" },
+    [METRIC_BYTES] = { "bytes_total", "counter", "Bytes received" },
+    [METRIC_RATE] = { "bytes_per_second", "gauge", "Recent byte rate" },
+    [METRIC_LATE] = { "late_blocks_total", "counter",
+                      "Blocks processed slower than real-time" },
+    [METRIC_DROPPED] = { "dropped_blocks_total", "counter",
+                         "Blocks rejected with an error" },
+    [METRIC_IN_FLIGHT] = { "blocks_in_flight", "gauge",
+                           "Blocks being or waiting to be processed" },
+    [METRIC_QUEUED] = { "queued_blocks", "gauge", "Blocks queued" },
+    [METRIC_QUEUED_BYTES] = { "queued_bytes", "gauge", "Bytes queued" },
+    [METRIC_LATENCY] = { "latency_seconds_total", "counter",
+                         "Time spent processing blocks" },
+    [METRIC_LATENCY_MAX] = { "latency_max_seconds", "gauge",
+                             "Longest time spent processing one block" },
+};
+
+static void PrintValue(struct vlc_memstream *ms, const sout_stats_t *st,
+                       enum metric_value m)
+{
+    switch (m)
+    {
+        case METRIC_BLOCKS:
+            vlc_memstream_printf(ms, "%"PRIu64"\n", st->i_blocks);
+            break;
+        case METRIC_BYTES:
+            vlc_memstream_printf(ms, "%"PRIu64"\n", st->i_bytes);
+            break;
+        case METRIC_RATE:
+            vlc_memstream_printf(ms, "%"PRIu64"\n", st->i_rate);
+            break;
+        case METRIC_LATE:
+            vlc_memstream_printf(ms, "%"PRIu64"\n", st->i_late);
+            break;
+        case METRIC_DROPPED:
+            vlc_memstream_printf(ms, "%"PRIu64"\n", st->i_dropped);
+            break;
+        case METRIC_IN_FLIGHT:
+            vlc_memstream_printf(ms, "%u\n", st->i_in_flight);
+            break;
+        case METRIC_QUEUED:
+            vlc_memstream_printf(ms, "%u\n", st->i_queued);
+            break;
+        case METRIC_QUEUED_BYTES:
+            vlc_memstream_printf(ms, "%zu\n", st->i_queued_bytes);
+            break;
+        case METRIC_LATENCY:
+            vlc_memstream_printf(ms, "%.6f\n",
+                                 secf_from_vlc_tick(st->i_latency));
+            break;
+        case METRIC_LATENCY_MAX:
+            vlc_memstream_printf(ms, "%.6f\n",
+                                 secf_from_vlc_tick(st->i_latency_max));
+            break;
+    }
+}
+
+static int Fill(httpd_file_sys_t *data, httpd_file_t *file,
+                uint8_t *request, uint8_t **pp_data, int *pi_data)
+{
+    intf_thread_t *intf = (intf_thread_t *)data;
+    struct vlc_memstream ms;
+    sout_stats_t *tab;
+    ssize_t count = sout_GetStats(intf, &tab);
+
+    (void) file; (void) request;
+
+    if (count < 0)
+        count = 0;
+
+    vlc_memstream_open(&ms);
+    for (size_t m = 0; m < ARRAY_SIZE(metrics); m++)
+    {
+        vlc_memstream_printf(&ms, "# HELP vlc_sout_%s %s\n"
+                             "# TYPE vlc_sout_%s %s\n", metrics[m].name,
+                             metrics[m].help, metrics[m].name,
+                             metrics[m].type);
+
+        for (ssize_t i = 0; i < count; i++)
+        {
+            const sout_stats_t *st = &tab[i];
+
+            vlc_memstream_printf(&ms, "vlc_sout_%s{id=\"%u\",owner=\"%u\","
+                                 "next=\"%u\",type=\"%s\",module=\"%s\"} ",
+                                 metrics[m].name, st->i_id, st->i_owner,
+                                 st->i_next, type_names[st->i_type],
+                                 st->psz_name);
+            PrintValue(&ms, st, m);
+        }
+    }
+    free(tab);
+
+    if (vlc_memstream_close(&ms))
+    {
+        *pp_data = NULL;
+        *pi_data = 0;
+        return VLC_ENOMEM;
+    }
+
+    *pp_data = (uint8_t *)ms.ptr;
+    *pi_data = ms.length;
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    intf_thread_t *intf = (intf_thread_t *)obj;
+    intf_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->host = vlc_http_HostNew(obj);
+    if (sys->host == NULL)
+        goto error;
+
+    char *path = var_InheritString(obj, "prometheus-path");
+    if (path == NULL)
+        goto error;
+
+    sys->file = httpd_FileNew(sys->host, path,
+                              "text/plain; version=0.0.4", NULL, NULL, Fill,
+                              (httpd_file_sys_t *)intf);
+    free(path);
+    if (sys->file == NULL)
+        goto error;
+
+    intf->p_sys = sys;
+    return VLC_SUCCESS;
+
+error:
+    if (sys->host != NULL)
+        httpd_HostDelete(sys->host);
+    free(sys);
+    return VLC_EGENERIC;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    intf_thread_t *intf = (intf_thread_t *)obj;
+    intf_sys_t *sys = intf->p_sys;
+
+    httpd_FileDelete(sys->file);
+    httpd_HostDelete(sys->host);
+    free(sys);
+}
@@ -335,6 +335,17 @@ SegmentTracker::prepareChunk(bool switch_allowed, Position pos) const
     return ChunkEntry(segmentChunk, pos, startTime, duration, displayTime);
 }
 
+void SegmentTracker::prefetchInitSegments(const Position &pos)
+{
+    /* So that switching does not wait for the new init segment */
+    for(BaseRepresentation *rep : adaptationSet->getRepresentations())
+    {
+        InitSegment *segment = rep != pos.rep ? rep->getInitSegment() : nullptr;
+        if(segment)
+            segment->prefetch(resources, pos.number, rep);
+    }
+}
+
 void SegmentTracker::resetChunksSequence()
 {
     while(!chunkssequence.empty())
@@ -380,6 +391,12 @@ ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed)
         initializing = true;
     }
 
+    if(first)
+    {
+        prefetchInitSegments(chunk.pos);
+        first = false;
+    }
+
     /* advance or don't trigger duplicate events */
     next = current = chunk.pos;
 
@@ -254,6 +254,7 @@ namespace adaptive
             std::list<ChunkEntry> chunkssequence;
             ChunkEntry prepareChunk(bool switch_allowed, Position pos) const;
             void resetChunksSequence();
+            void prefetchInitSegments(const Position &);
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const TrackerEvent &) const;
             bool first;
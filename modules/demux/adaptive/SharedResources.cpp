@@ -65,7 +65,11 @@ SharedResources * SharedResources::createDefault(vlc_object_t *obj,
     AuthStorage *auth = new AuthStorage(obj);
     Keyring *keyring = new Keyring(obj);
     HTTPConnectionManager *m = new HTTPConnectionManager(obj);
-    if(!var_InheritBool(obj, "adaptive-use-access")) /* only use http from access */
+    /* only use http from access, also when segments need to go through the
+     * disk cache of the access streams */
+    if(!var_InheritBool(obj, "adaptive-use-access") &&
+       (config_FindConfig("disk-cache-size") == nullptr ||
+        var_InheritInteger(obj, "disk-cache-size") == 0))
         m->addFactory(new LibVLCHTTPConnectionFactory(auth));
     m->addFactory(new StreamUrlConnectionFactory());
     ConnectionParams params(playlisturl);
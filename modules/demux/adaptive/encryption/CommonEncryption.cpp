@@ -27,6 +27,10 @@
 #include "../SharedResources.hpp"
 
 #include <vlc_common.h>
+#include <vlc_block.h>
+
+#include <algorithm>
+#include <cstring>
 
 #ifdef HAVE_GCRYPT
  #include <gcrypt.h>
@@ -93,6 +97,7 @@ bool CommonEncryptionSession::start(SharedResources *res, const CommonEncryption
             return false;
         }
         ctx = handle;
+        pending.clear();
     }
 #endif
     return true;
@@ -108,17 +113,42 @@ void CommonEncryptionSession::close()
 #endif
 }
 
-size_t CommonEncryptionSession::decrypt(void *inputdata, size_t inputbytes, bool last)
+block_t * CommonEncryptionSession::decrypt(block_t *p_block, bool last)
 {
 #ifndef HAVE_GCRYPT
-    VLC_UNUSED(inputdata);
     VLC_UNUSED(last);
 #else
     gcry_cipher_hd_t handle = reinterpret_cast<gcry_cipher_hd_t>(ctx);
     if(encryption.method == CommonEncryption::Method::AES_128 && ctx)
     {
-        if ((inputbytes % 16) != 0 || inputbytes < 16 ||
-            gcry_cipher_decrypt(handle, inputdata, inputbytes, nullptr, 0))
+        if(!pending.empty())
+        {
+            block_t *p_prepended = block_TryRealloc(p_block, pending.size(),
+                                                    p_block->i_buffer);
+            if(!p_prepended)
+            {
+                p_block->i_buffer = 0;
+                return p_block;
+            }
+            p_block = p_prepended;
+            memcpy(p_block->p_buffer, pending.data(), pending.size());
+            pending.clear();
+        }
+
+        size_t inputbytes = p_block->i_buffer;
+        if(!last)
+        {
+            /* keep the partial cipher block and the one before it */
+            const size_t held = std::min(inputbytes, inputbytes % 16 + 16);
+            pending.assign(&p_block->p_buffer[inputbytes - held],
+                           &p_block->p_buffer[inputbytes]);
+            inputbytes -= held;
+        }
+
+        /* CBC decryption is parallelizable: gcrypt uses the hardware
+         * instructions on the whole buffer at once */
+        if ((inputbytes % 16) != 0 || (last && inputbytes < 16) ||
+            gcry_cipher_decrypt(handle, p_block->p_buffer, inputbytes, nullptr, 0))
         {
             inputbytes = 0;
         }
@@ -126,22 +156,23 @@ size_t CommonEncryptionSession::decrypt(void *inputdata, size_t inputbytes, bool
         {
             /* last bytes */
             /* remove the PKCS#7 padding from the buffer */
-            const uint8_t pad = reinterpret_cast<uint8_t *>(inputdata)[inputbytes - 1];
+            const uint8_t pad = p_block->p_buffer[inputbytes - 1];
             for(uint8_t i=0; i<pad && i<16; i++)
             {
-                if(reinterpret_cast<uint8_t *>(inputdata)[inputbytes - i - 1] != pad)
+                if(p_block->p_buffer[inputbytes - i - 1] != pad)
                     break;
                 if(i+1==pad)
                     inputbytes -= pad;
             }
         }
+        p_block->i_buffer = inputbytes;
     }
     else
 #endif
     if(encryption.method != CommonEncryption::Method::None)
     {
-        inputbytes = 0;
+        p_block->i_buffer = 0;
     }
 
-    return inputbytes;
+    return p_block;
 }
@@ -20,6 +20,8 @@
 #ifndef COMMONENCRYPTION_H
 #define COMMONENCRYPTION_H
 
+#include <vlc_common.h>
+
 #include <vector>
 #include <string>
 
@@ -52,10 +54,14 @@ namespace adaptive
 
                 bool start(SharedResources *, const CommonEncryption &);
                 void close();
-                size_t decrypt(void *, size_t, bool);
+                /* Decrypts in place. The tail that can't be decrypted yet, or
+                 * could be the padded last cipher block, is held back and
+                 * prepended to the next block. */
+                block_t * decrypt(block_t *, bool);
 
             private:
                 std::vector<unsigned char> key;
+                std::vector<unsigned char> pending;
                 CommonEncryption encryption;
                 void *ctx;
         };
@@ -29,6 +29,7 @@
 #include "HTTPConnection.hpp"
 #include "HTTPConnectionManager.h"
 #include "Downloader.hpp"
+#include "SharedCache.hpp"
 
 #include <vlc_common.h>
 #include <vlc_block.h>
@@ -272,6 +273,11 @@ std::string HTTPChunkSource::getContentType() const
         return std::string();
 }
 
+const ConnectionParams & HTTPChunkSource::getConnectionParams() const
+{
+    return params;
+}
+
 void HTTPChunkSource::setIdentifier(const std::string &s, const BytesRange &r)
 {
     storeid =  makeStorageID(s, r);
@@ -334,6 +340,8 @@ HTTPChunkBufferedSource::HTTPChunkBufferedSource(const std::string& url, Abstrac
                                                  ChunkType type, const BytesRange &range,
                                                  bool access) :
     HTTPChunkSource(url, manager, sourceid, type, range, access),
+    sharedCache(nullptr),
+    sharedEntry(nullptr),
     p_head     (nullptr),
     pp_tail    (&p_head),
     buffered     (0)
@@ -355,6 +363,14 @@ HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
     while(held) /* wait release if not in queue but currently downloaded */
         avail.wait(lock);
 
+    if(sharedEntry)
+    {
+        /* no-op if completed */
+        sharedCache->finish(sharedEntry, RequestStatus::GenericError);
+        sharedCache->unref(sharedEntry);
+        sharedEntry = nullptr;
+    }
+
     if(p_head)
     {
         block_ChainRelease(p_head);
@@ -384,6 +400,25 @@ void HTTPChunkBufferedSource::release()
     avail.signal();
 }
 
+void HTTPChunkBufferedSource::share(SharedCache *cache, SharedCacheEntry *entry)
+{
+    sharedCache = cache;
+    sharedEntry = entry;
+}
+
+void HTTPChunkBufferedSource::publish(const block_t *p_block, bool b_done)
+{
+    if(p_block)
+        sharedCache->append(sharedEntry, p_block, getContentType());
+    if(b_done)
+    {
+        RequestStatus status = getRequestStatus();
+        if(!prepared && status == RequestStatus::Success)
+            status = RequestStatus::GenericError;
+        sharedCache->finish(sharedEntry, status);
+    }
+}
+
 void HTTPChunkBufferedSource::bufferize(size_t readsize)
 {
     {
@@ -393,6 +428,8 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
             done = true;
             eof = true;
             avail.signal();
+            if(sharedEntry)
+                publish(nullptr, true);
             return;
         }
 
@@ -416,6 +453,7 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         vlc_tick_t time;
         vlc_tick_t latency;
     } rate = {0,0,0};
+    bool b_done = false;
 
     ssize_t ret = connection->read(p_block->p_buffer, readsize);
     if(ret <= 0)
@@ -423,7 +461,7 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         block_Release(p_block);
         p_block = nullptr;
         mutex_locker locker {lock};
-        done = true;
+        done = b_done = true;
         downloadEndTime = vlc_tick_now();
         rate.size = buffered;
         rate.time = downloadEndTime - requestStartTime;
@@ -442,7 +480,7 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         }
         if((size_t) ret < readsize)
         {
-            done = true;
+            done = b_done = true;
             downloadEndTime = vlc_tick_now();
             rate.size = buffered;
             rate.time = downloadEndTime - requestStartTime;
@@ -456,6 +494,9 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
                                         rate.time, rate.latency);
     }
 
+    if(sharedEntry)
+        publish(p_block, b_done);
+
     avail.signal();
 }
 
@@ -127,6 +127,7 @@ namespace adaptive
                 virtual size_t      getBytesRead    () const  override;
                 virtual std::string getContentType  () const  override;
                 virtual void        recycle() override;
+                const ConnectionParams & getConnectionParams() const;
 
                 static const size_t CHUNK_SIZE = 32768;
                 static StorageID makeStorageID(const std::string &, const BytesRange &);
@@ -154,6 +155,9 @@ namespace adaptive
                 ConnectionParams    params;
         };
 
+        class SharedCache;
+        class SharedCacheEntry;
+
         class HTTPChunkBufferedSource : public HTTPChunkSource
         {
             friend class HTTPConnectionManager;
@@ -174,8 +178,12 @@ namespace adaptive
                 bool               isDone() const;
                 void               hold();
                 void               release();
+                void               share(SharedCache *, SharedCacheEntry *);
 
             private:
+                void               publish(const block_t *, bool);
+                SharedCache        *sharedCache;
+                SharedCacheEntry   *sharedEntry; /* also filled when set */
                 block_t            *p_head; /* read cache buffer */
                 block_t           **pp_tail;
                 const block_t      *p_read;
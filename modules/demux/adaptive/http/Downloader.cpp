@@ -25,35 +25,35 @@
 
 #include <vlc_threads.h>
 
-#include <atomic>
+#include <algorithm>
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Downloader(unsigned workers_, unsigned perhost_)
 {
     killed = false;
-    thread_handle_valid = false;
-    current = nullptr;
-    cancel_current = false;
+    workers = workers_ ? workers_ : 1;
+    perhost = perhost_ ? perhost_ : 1;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread,
-                 static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+    while(threads.size() < workers)
     {
-        return false;
+        vlc_thread_t thread_handle;
+        if(vlc_clone(&thread_handle, downloaderThread,
+                     static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+            break;
+        threads.push_back(thread_handle);
     }
-    thread_handle_valid = true;
-    return true;
+    return !threads.empty();
 }
 
 Downloader::~Downloader()
 {
     kill();
 
-    if(thread_handle_valid)
+    for(vlc_thread_t thread_handle : threads)
         vlc_join(thread_handle, nullptr);
 }
 
@@ -61,7 +61,7 @@ void Downloader::kill()
 {
     vlc::threads::mutex_locker locker {lock};
     killed = true;
-    wait_cond.signal();
+    wait_cond.broadcast();
 }
 
 void Downloader::schedule(HTTPChunkBufferedSource *source)
@@ -75,9 +75,10 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc::threads::mutex_locker locker {lock};
-    while (current == source)
+    while (isActive(source))
     {
-        cancel_current = true;
+        if(std::find(cancelled.begin(), cancelled.end(), source) == cancelled.end())
+            cancelled.push_back(source);
         updated_cond.wait(lock);
     }
 
@@ -88,6 +89,31 @@ void Downloader::cancel(HTTPChunkBufferedSource *source)
     }
 }
 
+bool Downloader::isActive(const HTTPChunkBufferedSource *source) const
+{
+    return std::find(active.begin(), active.end(), source) != active.end();
+}
+
+/* Returns the oldest source that no worker is serving,
+ * and whose host is not already at the connections limit */
+HTTPChunkBufferedSource * Downloader::getNext() const
+{
+    for(HTTPChunkBufferedSource *source : chunks)
+    {
+        if(isActive(source))
+            continue;
+
+        const std::string &hostname = source->getConnectionParams().getHostname();
+        unsigned count = 0;
+        for(const HTTPChunkBufferedSource *a : active)
+            if(a->getConnectionParams().getHostname() == hostname)
+                count++;
+        if(count < perhost)
+            return source;
+    }
+    return nullptr;
+}
+
 void * Downloader::downloaderThread(void *opaque)
 {
     Downloader *instance = static_cast<Downloader *>(opaque);
@@ -97,31 +123,38 @@ void * Downloader::downloaderThread(void *opaque)
 
 void Downloader::Run()
 {
+    lock.lock();
+
     while(1)
     {
-        lock.lock();
+        HTTPChunkBufferedSource *current = nullptr;
 
-        while(chunks.empty() && !killed)
+        while(!killed && (current = getNext()) == nullptr)
             wait_cond.wait(lock);
 
         if(killed)
-        {
-            lock.unlock();
             break;
-        }
 
-        current = chunks.front();
+        active.push_back(current);
         lock.unlock();
         current->bufferize(HTTPChunkSource::CHUNK_SIZE);
         lock.lock();
+        active.remove(current);
+
+        auto it = std::find(cancelled.begin(), cancelled.end(), current);
+        const bool cancel_current = it != cancelled.end();
+        if(cancel_current)
+            cancelled.erase(it);
+
         if(current->isDone() || cancel_current)
         {
-            chunks.pop_front();
+            chunks.remove(current);
             current->release();
         }
-        cancel_current = false;
-        current = nullptr;
-        updated_cond.signal();
-        lock.unlock();
+        updated_cond.broadcast();
+        /* A slot for this host might be free again */
+        wait_cond.signal();
     }
+
+    lock.unlock();
 }
@@ -25,6 +25,7 @@
 #include <vlc_common.h>
 #include <vlc_cxx_helpers.hpp>
 #include <list>
+#include <vector>
 
 namespace adaptive
 {
@@ -32,10 +33,13 @@ namespace adaptive
     namespace http
     {
 
+        /* Serves the scheduled sources by slices of CHUNK_SIZE, with up to
+         * <workers> sources downloading at once, and at most <perhost> of
+         * them from the same host */
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned workers = 1, unsigned perhost = 1);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
@@ -45,15 +49,18 @@ namespace adaptive
                 static void * downloaderThread(void *);
                 void Run();
                 void kill();
-                vlc_thread_t thread_handle;
+                HTTPChunkBufferedSource * getNext() const;
+                bool isActive(const HTTPChunkBufferedSource *) const;
+                std::vector<vlc_thread_t> threads;
                 vlc::threads::mutex lock;
                 vlc::threads::condition_variable wait_cond;
                 vlc::threads::condition_variable updated_cond;
-                bool         thread_handle_valid;
+                unsigned     workers;
+                unsigned     perhost;
                 bool         killed;
-                bool         cancel_current;
                 std::list<HTTPChunkBufferedSource *> chunks;
-                HTTPChunkBufferedSource *current;
+                std::list<HTTPChunkBufferedSource *> active;
+                std::list<HTTPChunkBufferedSource *> cancelled;
         };
 
     }
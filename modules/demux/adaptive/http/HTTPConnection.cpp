@@ -30,6 +30,8 @@
 #include <vlc_stream.h>
 #include <vlc_keystore.h>
 
+#include <cassert>
+
 extern "C"
 {
     #include "../access/http/resource.h"
@@ -88,16 +90,14 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
      friend class LibVLCHTTPConnection;
 
      public:
-        LibVLCHTTPSource(vlc_object_t *p_object, struct vlc_http_cookie_jar_t *jar)
+        LibVLCHTTPSource()
         {
-            http_mgr = vlc_http_mgr_create(p_object, jar);
+            http_mgr = nullptr;
             http_res = nullptr;
             totalRead = 0;
         }
         virtual ~LibVLCHTTPSource()
         {
-            if(http_mgr)
-                vlc_http_mgr_destroy(http_mgr);
         }
         virtual block_t *readNextBlock() override
         {
@@ -185,10 +185,10 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
 
         static const struct vlc_http_resource_cbs callbacks;
         size_t totalRead;
-        struct vlc_http_mgr *http_mgr;
         BytesRange range;
 
     public:
+        struct vlc_http_mgr *http_mgr;
         struct vlc_http_resource *http_res;
         int create(const char *uri,const std::string &ua,
                    const std::string &ref, const BytesRange &range)
@@ -235,10 +235,13 @@ const struct vlc_http_resource_cbs LibVLCHTTPSource::callbacks =
     LibVLCHTTPSource::validateresponse_handler,
 };
 
-LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth)
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_,
+                                           LibVLCHTTPConnectionFactory *factory_)
     : AbstractConnection( p_object_ )
 {
-    source = new adaptive::http::LibVLCHTTPSource(p_object_, auth->getJar());
+    factory = factory_;
+    session = nullptr;
+    source = new adaptive::http::LibVLCHTTPSource();
     sourceStream = new ChunksSourceStream(p_object, source);
     stream = nullptr;
     char *psz_useragent = var_InheritString(p_object_, "http-user-agent");
@@ -271,6 +274,12 @@ void LibVLCHTTPConnection::reset()
         vlc_stream_Delete(stream);
         stream = nullptr;
     }
+    if(session)
+    {
+        factory->releaseSession(session);
+        session = nullptr;
+        source->http_mgr = nullptr;
+    }
     bytesRange = BytesRange();
     contentType = std::string();
     bytesRead = 0;
@@ -289,14 +298,16 @@ bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
 RequestStatus LibVLCHTTPConnection::request(const std::string &path,
                                             const BytesRange &range)
 {
-    if(source->http_mgr == nullptr)
-        return RequestStatus::GenericError;
-
     reset();
 
     /* Set new path for this query */
     params.setPath(path);
 
+    session = factory->acquireSession(p_object, params);
+    if(session == nullptr)
+        return RequestStatus::GenericError;
+    source->http_mgr = session->mgr;
+
     if(range.isValid())
         msg_Dbg(p_object, "Retrieving %s @%zu-%zu", params.getUrl().c_str(),
                            range.getStartByte(), range.getEndByte());
@@ -318,6 +329,7 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
     }
 
     int status = vlc_http_res_get_status(source->http_res);
+    factory->updateSession(session);
     if (status < 0)
     {
         vlc_credential_clean(&crd);
@@ -541,13 +553,74 @@ LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( AuthStorage *auth )
     authStorage = auth;
 }
 
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    for(LibVLCHTTPSession *session : sessions)
+    {
+        assert(session->users == 0);
+        vlc_http_mgr_destroy(session->mgr);
+        delete session;
+    }
+}
+
+LibVLCHTTPSession * LibVLCHTTPConnectionFactory::acquireSession(vlc_object_t *p_object,
+                                                              const ConnectionParams &params)
+{
+    const std::string origin = params.getScheme() + "://" + params.getHostname() +
+                               ":" + std::to_string(params.getPort());
+
+    vlc::threads::mutex_locker locker {lock};
+
+    /* Share an HTTP/2 session, or reuse an idle one */
+    for(LibVLCHTTPSession *session : sessions)
+    {
+        if(session->origin == origin &&
+           (session->users == 0 || session->multiplexed))
+        {
+            session->users++;
+            return session;
+        }
+    }
+
+    LibVLCHTTPSession *session = new (std::nothrow) LibVLCHTTPSession;
+    if(session == nullptr)
+        return nullptr;
+    session->mgr = vlc_http_mgr_create(p_object, authStorage->getJar(), NULL);
+    if(session->mgr == nullptr)
+    {
+        delete session;
+        return nullptr;
+    }
+    session->origin = origin;
+    session->users = 1;
+    session->multiplexed = false;
+    sessions.push_back(session);
+    return session;
+}
+
+void LibVLCHTTPConnectionFactory::updateSession(LibVLCHTTPSession *session)
+{
+    /* Outside of our lock, as the manager's can be held by a pending request */
+    bool multiplexed = vlc_http_mgr_is_multiplexed(session->mgr);
+
+    vlc::threads::mutex_locker locker {lock};
+    session->multiplexed = multiplexed;
+}
+
+void LibVLCHTTPConnectionFactory::releaseSession(LibVLCHTTPSession *session)
+{
+    vlc::threads::mutex_locker locker {lock};
+    assert(session->users > 0);
+    session->users--;
+}
+
 AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
                                                                   const ConnectionParams &params)
 {
     if((params.getScheme() != "http" && params.getScheme() != "https") ||
        params.getHostname().empty())
         return nullptr;
-    return new LibVLCHTTPConnection(p_object, authStorage);
+    return new LibVLCHTTPConnection(p_object, this);
 }
 
 StreamUrlConnectionFactory::StreamUrlConnectionFactory()
@@ -28,8 +28,12 @@
 #include "ConnectionParams.hpp"
 #include "BytesRange.hpp"
 #include <vlc_common.h>
+#include <vlc_cxx_helpers.hpp>
+#include <list>
 #include <string>
 
+struct vlc_http_mgr;
+
 namespace adaptive
 {
     class ChunksSourceStream;
@@ -71,11 +75,13 @@ namespace adaptive
         };
 
        class LibVLCHTTPSource;
+       class LibVLCHTTPConnectionFactory;
+       struct LibVLCHTTPSession;
 
        class LibVLCHTTPConnection : public AbstractConnection
        {
             public:
-               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *);
+               LibVLCHTTPConnection(vlc_object_t *, LibVLCHTTPConnectionFactory *);
                virtual ~LibVLCHTTPConnection();
                virtual bool    canReuse     (const ConnectionParams &) const override;
                virtual RequestStatus request(const std::string& path,
@@ -87,6 +93,8 @@ namespace adaptive
                void reset();
                std::string useragent;
                std::string referer;
+               LibVLCHTTPConnectionFactory *factory;
+               LibVLCHTTPSession *session;
                LibVLCHTTPSource *source;
                ChunksSourceStream *sourceStream;
                stream_t *stream;
@@ -119,14 +127,30 @@ namespace adaptive
                virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &) = 0;
        };
 
+       /* Long lived HTTP session to an origin. It is shared by all the
+        * connections once it runs HTTP/2, otherwise it is kept alive for
+        * the next request. */
+       struct LibVLCHTTPSession
+       {
+           std::string origin;
+           struct vlc_http_mgr *mgr;
+           unsigned users;
+           bool multiplexed;
+       };
+
        class LibVLCHTTPConnectionFactory : public AbstractConnectionFactory
        {
            public:
                LibVLCHTTPConnectionFactory( AuthStorage * );
-               virtual ~LibVLCHTTPConnectionFactory() = default;
+               virtual ~LibVLCHTTPConnectionFactory();
                virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &) override;
+               LibVLCHTTPSession * acquireSession(vlc_object_t *, const ConnectionParams &);
+               void updateSession(LibVLCHTTPSession *);
+               void releaseSession(LibVLCHTTPSession *);
            private:
                AuthStorage *authStorage;
+               vlc::threads::mutex lock;
+               std::list<LibVLCHTTPSession *> sessions;
        };
 
        class StreamUrlConnectionFactory : public AbstractConnectionFactory
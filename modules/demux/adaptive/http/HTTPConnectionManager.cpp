@@ -29,6 +29,7 @@
 #include "HTTPConnection.hpp"
 #include "ConnectionParams.hpp"
 #include "Downloader.hpp"
+#include "SharedCache.hpp"
 #include "tools/Debug.hpp"
 #include <vlc_url.h>
 #include <vlc_http.h>
@@ -75,18 +76,32 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_)
       localAllowed(false)
 {
     vlc_mutex_init(&lock);
-    downloader = new Downloader();
+    /* Segments of the different tracks, and prefetched ones,
+     * download concurrently */
+    downloader = new Downloader(4, 3);
     downloaderhp = new Downloader();
     downloader->start();
     downloaderhp->start();
     cache_total = 0;
     cache_max = 1 << 19;
+    sharedCache = SharedCache::acquire();
 }
 
 HTTPConnectionManager::~HTTPConnectionManager   ()
 {
+    while(!prefetching.empty())
+    {
+        deleteSource(prefetching.front());
+        prefetching.pop_front();
+    }
+    while(!cache.empty())
+    {
+        deleteSource(cache.front());
+        cache.pop_front();
+    }
     delete downloader;
     delete downloaderhp;
+    sharedCache->release();
     this->closeAllConnections();
     while(!factories.empty())
     {
@@ -169,6 +184,16 @@ AbstractChunkSource *HTTPConnectionManager::makeSource(const std::string &url,
     {
         case ChunkType::Init:
         case ChunkType::Index:
+            cachePrefetched();
+            for(HTTPChunkBufferedSource *s : prefetching)
+            {
+                if(s->getStorageID() == storageid)
+                {
+                    prefetching.remove(s);
+                    CacheDebug(msg_Dbg(p_object, "Prefetch GET '%s'", storageid.c_str()));
+                    return s;
+                }
+            }
             for(HTTPChunkBufferedSource *s : cache)
             {
                 if(s->getStorageID() == storageid)
@@ -182,6 +207,15 @@ AbstractChunkSource *HTTPConnectionManager::makeSource(const std::string &url,
             }
             // fallthrough
         case ChunkType::Segment:
+        {
+            SharedCacheEntry *entry = sharedCache->get(storageid);
+            if(entry)
+            {
+                CacheDebug(msg_Dbg(p_object, "Shared GET '%s'", storageid.c_str()));
+                return new SharedChunkSource(sharedCache, entry, this, type, range);
+            }
+            return makeSharedSource(url, id, type, range);
+        }
         case ChunkType::Key:
         case ChunkType::Playlist:
         default:
@@ -228,6 +262,62 @@ void HTTPConnectionManager::recycleSource(AbstractChunkSource *source)
         deleteSource(source);
 }
 
+void HTTPConnectionManager::prefetch(const std::string &url, ChunkType type,
+                                     const BytesRange &range)
+{
+    cachePrefetched();
+    if(prefetching.size() >= MAX_PREFETCHING)
+        return;
+
+    StorageID storageid = HTTPChunkSource::makeStorageID(url, range);
+    for(const HTTPChunkBufferedSource *s : prefetching)
+        if(s->getStorageID() == storageid)
+            return;
+    for(const HTTPChunkBufferedSource *s : cache)
+        if(s->getStorageID() == storageid)
+            return;
+    /* makeSource() will read it from another session's download */
+    SharedCacheEntry *entry = sharedCache->get(storageid);
+    if(entry)
+    {
+        sharedCache->unref(entry);
+        return;
+    }
+
+    HTTPChunkBufferedSource *source = makeSharedSource(url, ID(), type, range);
+    CacheDebug(msg_Dbg(p_object, "Prefetch '%s'", storageid.c_str()));
+    prefetching.push_back(source);
+    start(source);
+}
+
+HTTPChunkBufferedSource * HTTPConnectionManager::makeSharedSource(const std::string &url,
+                                                                  const ID &id, ChunkType type,
+                                                                  const BytesRange &range)
+{
+    HTTPChunkBufferedSource *source = new HTTPChunkBufferedSource(url, this, id, type, range);
+    /* other sessions requesting it meanwhile will read from the entry */
+    source->share(sharedCache, sharedCache->create(source->getStorageID()));
+    return source;
+}
+
+void HTTPConnectionManager::cachePrefetched()
+{
+    /* size is only known once done */
+    for(auto it = prefetching.begin(); it != prefetching.end(); )
+    {
+        HTTPChunkBufferedSource *s = *it;
+        if(s->isDone())
+        {
+            it = prefetching.erase(it);
+            if(s->getRequestStatus() == RequestStatus::Success)
+                recycleSource(s);
+            else
+                deleteSource(s);
+        }
+        else ++it;
+    }
+}
+
 Downloader * HTTPConnectionManager::getDownloadQueue(const AbstractChunkSource *source) const
 {
     switch(source->getChunkType())
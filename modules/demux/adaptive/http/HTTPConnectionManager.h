@@ -44,6 +44,7 @@ namespace adaptive
         class Downloader;
         class AbstractChunkSource;
         class HTTPChunkBufferedSource;
+        class SharedCache;
         enum class ChunkType;
 
         class AbstractConnectionManager : public IDownloadRateObserver
@@ -57,6 +58,8 @@ namespace adaptive
                                                         const ID &, ChunkType,
                                                         const BytesRange &) = 0;
                 virtual void recycleSource(AbstractChunkSource *) = 0;
+                /* Starts downloading a source that makeSource() will return later */
+                virtual void prefetch(const std::string &, ChunkType, const BytesRange &) {}
 
                 virtual void start(AbstractChunkSource *) = 0;
                 virtual void cancel(AbstractChunkSource *) = 0;
@@ -85,6 +88,8 @@ namespace adaptive
                                                         const ID &, ChunkType,
                                                         const BytesRange &) override;
                 virtual void recycleSource(AbstractChunkSource *) override;
+                virtual void prefetch(const std::string &, ChunkType,
+                                      const BytesRange &) override;
 
                 virtual void start(AbstractChunkSource *)  override;
                 virtual void cancel(AbstractChunkSource *)  override;
@@ -104,6 +109,14 @@ namespace adaptive
                 std::list<HTTPChunkBufferedSource *> cache;
                 unsigned cache_total;
                 unsigned cache_max;
+                /* not yet done, moved to the cache when they are */
+                std::list<HTTPChunkBufferedSource *> prefetching;
+                static const unsigned MAX_PREFETCHING = 8;
+                void    cachePrefetched();
+                /* shared with the other sessions */
+                SharedCache *sharedCache;
+                HTTPChunkBufferedSource * makeSharedSource(const std::string &, const ID &,
+                                                           ChunkType, const BytesRange &);
         };
     }
 }
@@ -0,0 +1,290 @@
+/*
+ * SharedCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLabs and VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SharedCache.hpp"
+#include "HTTPConnectionManager.h"
+
+#include <vlc_block.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace adaptive::http;
+using vlc::threads::mutex_locker;
+
+static vlc::threads::mutex instance_lock;
+static SharedCache *instance = nullptr;
+
+SharedCacheEntry::SharedCacheEntry(const StorageID &id)
+{
+    storeid = id;
+    p_head = nullptr;
+    pp_tail = &p_head;
+    size = 0;
+    done = false;
+    listed = true;
+    status = RequestStatus::Success;
+    refs = 1;
+}
+
+SharedCacheEntry::~SharedCacheEntry()
+{
+    block_ChainRelease(p_head);
+}
+
+SharedCache::SharedCache()
+{
+    total = 0;
+    users = 0;
+}
+
+SharedCache::~SharedCache()
+{
+    for(SharedCacheEntry *entry : entries)
+    {
+        assert(entry->refs == 0);
+        delete entry;
+    }
+}
+
+SharedCache * SharedCache::acquire()
+{
+    mutex_locker locker {instance_lock};
+    if(!instance)
+        instance = new SharedCache();
+    instance->users++;
+    return instance;
+}
+
+void SharedCache::release()
+{
+    mutex_locker locker {instance_lock};
+    assert(instance == this);
+    if(--users == 0)
+    {
+        delete this;
+        instance = nullptr;
+    }
+}
+
+SharedCacheEntry * SharedCache::get(const StorageID &id)
+{
+    mutex_locker locker {lock};
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [id](const SharedCacheEntry *e){ return e->storeid == id; });
+    if(it == entries.end())
+        return nullptr;
+
+    SharedCacheEntry *entry = *it;
+    if(entry->done && entry->status != RequestStatus::Success)
+        return nullptr;
+
+    entries.splice(entries.begin(), entries, it);
+    entry->refs++;
+    return entry;
+}
+
+SharedCacheEntry * SharedCache::create(const StorageID &id)
+{
+    mutex_locker locker {lock};
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [id](const SharedCacheEntry *e){ return e->storeid == id; });
+    if(it != entries.end())
+    {
+        if(!(*it)->done || (*it)->status == RequestStatus::Success)
+            return nullptr;
+        /* replace the failed one */
+        unlink(*it);
+    }
+
+    SharedCacheEntry *entry = new SharedCacheEntry(id);
+    entries.push_front(entry);
+    return entry;
+}
+
+void SharedCache::unlink(SharedCacheEntry *entry)
+{
+    entries.remove(entry);
+    entry->listed = false;
+    total -= entry->size;
+    if(entry->refs == 0)
+        delete entry;
+}
+
+void SharedCache::unref(SharedCacheEntry *entry)
+{
+    mutex_locker locker {lock};
+    assert(entry->refs);
+    if(--entry->refs == 0 && !entry->listed)
+        delete entry;
+}
+
+void SharedCache::purge()
+{
+    for(auto it = entries.rbegin(); it != entries.rend() && total > MAX_SIZE; )
+    {
+        SharedCacheEntry *entry = *it;
+        ++it;
+        if(entry->done)
+            unlink(entry);
+    }
+}
+
+void SharedCache::append(SharedCacheEntry *entry, const block_t *p_block,
+                         const std::string &contentType)
+{
+    block_t *p_copy = block_Alloc(p_block->i_buffer);
+    if(!p_copy)
+        return;
+    memcpy(p_copy->p_buffer, p_block->p_buffer, p_block->i_buffer);
+
+    mutex_locker locker {lock};
+    assert(!entry->done);
+    if(entry->contentType.empty())
+        entry->contentType = contentType;
+    block_ChainLastAppend(&entry->pp_tail, p_copy);
+    entry->size += p_copy->i_buffer;
+    if(entry->listed)
+        total += p_copy->i_buffer;
+    avail.broadcast();
+}
+
+void SharedCache::finish(SharedCacheEntry *entry, RequestStatus status)
+{
+    mutex_locker locker {lock};
+    if(entry->done)
+        return;
+    entry->done = true;
+    entry->status = status;
+    avail.broadcast();
+    purge();
+}
+
+block_t * SharedCache::read(SharedCacheEntry *entry, size_t offset, size_t maxsize)
+{
+    mutex_locker locker {lock};
+    /* any amount for a block read */
+    const size_t wanted = offset + (maxsize ? maxsize : 1);
+    while(entry->size < wanted && !entry->done)
+        avail.wait(lock);
+
+    if(entry->size <= offset || entry->status != RequestStatus::Success)
+        return nullptr;
+
+    if(maxsize == 0 || maxsize > entry->size - offset)
+        maxsize = entry->size - offset;
+
+    block_t *p_block = block_Alloc(maxsize);
+    if(!p_block)
+        return nullptr;
+
+    size_t copied = 0;
+    for(const block_t *b = entry->p_head; b && copied < maxsize; b = b->p_next)
+    {
+        if(offset >= b->i_buffer)
+        {
+            offset -= b->i_buffer;
+            continue;
+        }
+        const size_t tocopy = std::min(b->i_buffer - offset, maxsize - copied);
+        memcpy(&p_block->p_buffer[copied], &b->p_buffer[offset], tocopy);
+        copied += tocopy;
+        offset = 0;
+    }
+    p_block->i_buffer = copied;
+    return p_block;
+}
+
+bool SharedCache::hasMoreData(SharedCacheEntry *entry, size_t offset)
+{
+    mutex_locker locker {lock};
+    return !entry->done || (entry->status == RequestStatus::Success &&
+                            entry->size > offset);
+}
+
+RequestStatus SharedCache::getRequestStatus(SharedCacheEntry *entry)
+{
+    mutex_locker locker {lock};
+    return entry->status;
+}
+
+std::string SharedCache::getContentType(SharedCacheEntry *entry)
+{
+    mutex_locker locker {lock};
+    return entry->contentType;
+}
+
+SharedChunkSource::SharedChunkSource(SharedCache *cache_, SharedCacheEntry *entry_,
+                                     AbstractConnectionManager *manager,
+                                     ChunkType type, const BytesRange &range)
+    : AbstractChunkSource(type, range)
+{
+    cache = cache_;
+    entry = entry_;
+    connManager = manager;
+    consumed = 0;
+}
+
+SharedChunkSource::~SharedChunkSource()
+{
+    cache->unref(entry);
+}
+
+block_t * SharedChunkSource::readBlock()
+{
+    return read(0);
+}
+
+block_t * SharedChunkSource::read(size_t size)
+{
+    block_t *p_block = cache->read(entry, consumed, size);
+    if(p_block)
+        consumed += p_block->i_buffer;
+    return p_block;
+}
+
+bool SharedChunkSource::hasMoreData() const
+{
+    return cache->hasMoreData(entry, consumed);
+}
+
+size_t SharedChunkSource::getBytesRead() const
+{
+    return consumed;
+}
+
+std::string SharedChunkSource::getContentType() const
+{
+    return cache->getContentType(entry);
+}
+
+RequestStatus SharedChunkSource::getRequestStatus() const
+{
+    return cache->getRequestStatus(entry);
+}
+
+void SharedChunkSource::recycle()
+{
+    connManager->recycleSource(this);
+}
@@ -0,0 +1,124 @@
+/*
+ * SharedCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLabs and VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef SHAREDCACHE_HPP_
+#define SHAREDCACHE_HPP_
+
+#include "Chunk.h"
+
+#include <vlc_common.h>
+#include <vlc_cxx_helpers.hpp>
+
+#include <list>
+#include <string>
+
+namespace adaptive
+{
+    namespace http
+    {
+        class SharedCache;
+
+        /* Data of a segment, filled by the source downloading it */
+        class SharedCacheEntry
+        {
+            friend class SharedCache;
+
+            private:
+                SharedCacheEntry(const StorageID &);
+                ~SharedCacheEntry();
+                StorageID           storeid;
+                std::string         contentType;
+                block_t            *p_head;
+                block_t           **pp_tail;
+                size_t              size;
+                bool                done;
+                bool                listed;
+                RequestStatus       status;
+                unsigned            refs;
+        };
+
+        /* Process wide segments cache, so concurrent sessions of the same
+         * stream share their downloads, including the ones in progress.
+         * Entries are refcounted and the least recently used completed
+         * ones are purged above MAX_SIZE. */
+        class SharedCache
+        {
+            public:
+                static SharedCache * acquire();
+                void release();
+
+                /* Returns a reference to a completed or in progress entry */
+                SharedCacheEntry * get(const StorageID &);
+                /* Returns a reference to a new entry to fill, or nullptr
+                 * if another source already does */
+                SharedCacheEntry * create(const StorageID &);
+                void unref(SharedCacheEntry *);
+
+                void append(SharedCacheEntry *, const block_t *, const std::string &);
+                void finish(SharedCacheEntry *, RequestStatus);
+                /* Waits for the requested size after the offset, or any data
+                 * if 0, returns nullptr at the end of the entry */
+                block_t * read(SharedCacheEntry *, size_t, size_t);
+                bool hasMoreData(SharedCacheEntry *, size_t);
+                RequestStatus getRequestStatus(SharedCacheEntry *);
+                std::string getContentType(SharedCacheEntry *);
+
+                static const size_t MAX_SIZE = 16 << 20;
+
+            private:
+                SharedCache();
+                ~SharedCache();
+                void unlink(SharedCacheEntry *);
+                void purge();
+                vlc::threads::mutex lock;
+                vlc::threads::condition_variable avail;
+                std::list<SharedCacheEntry *> entries; /* most recent first */
+                size_t total;
+                unsigned users;
+        };
+
+        class SharedChunkSource : public AbstractChunkSource
+        {
+            friend class HTTPConnectionManager;
+
+            public:
+                virtual ~SharedChunkSource();
+                virtual block_t *   readBlock       () override;
+                virtual block_t *   read            (size_t) override;
+                virtual bool        hasMoreData     () const override;
+                virtual size_t      getBytesRead    () const override;
+                virtual std::string getContentType  () const override;
+                virtual RequestStatus getRequestStatus() const override;
+                virtual void        recycle() override;
+
+            protected:
+                SharedChunkSource(SharedCache *, SharedCacheEntry *,
+                                  AbstractConnectionManager *,
+                                  ChunkType, const BytesRange &);
+
+            private:
+                SharedCache        *cache;
+                SharedCacheEntry   *entry;
+                AbstractConnectionManager *connManager;
+                size_t              consumed;
+        };
+    }
+}
+
+#endif /* SHAREDCACHE_HPP_ */
@@ -62,6 +62,7 @@ namespace adaptive
                     FixedRate,
                     Predictive,
                     NearOptimal,
+                    Hybrid,
                 };
 
             protected:
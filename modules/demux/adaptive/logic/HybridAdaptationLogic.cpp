@@ -0,0 +1,238 @@
+/*
+ * HybridAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "HybridAdaptationLogic.hpp"
+
+#include "Representationselectors.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../tools/Debug.hpp"
+
+#include <vlc_variables.h>
+
+#include <algorithm>
+#include <cinttypes>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/*
+ * Throughput and buffer based logic.
+ * The throughput is predicted with the harmonic mean of the last downloads,
+ * which is robust to the short peaks of mobile links. The buffer level
+ * tells how much of that prediction can be trusted, and switching up has a
+ * cost so that the quality does not oscillate around a bitrate.
+ * The estimate of the previous session on the same instance is used to
+ * start at a sensible quality.
+ */
+
+/* Shared with the next sessions, on the libvlc instance */
+#define HYBRID_BW_VAR      "adaptive-hybrid-bw"
+/* Upswitch needs that much more than the next bitrate */
+#define SWITCH_UP_COST     0.15
+/* Segments to wait after a switch before going up again */
+#define SWITCH_UP_HOLD     2
+/* Below that buffer ratio, switch down and never up */
+#define BUFFER_PANIC       0.25
+#define BUFFER_LOW         0.5
+
+HybridStats::HybridStats()
+{
+    samples_count = 0;
+    samples_pos = 0;
+    buffering_level = 0;
+    buffering_target = 1;
+    segments_since_switch = 0;
+    buffered = false;
+}
+
+void HybridStats::push(unsigned bps)
+{
+    samples[samples_pos] = bps;
+    samples_pos = (samples_pos + 1) % SAMPLES;
+    if(samples_count < SAMPLES)
+        samples_count++;
+}
+
+unsigned HybridStats::harmonicMean() const
+{
+    double inv = 0;
+    for(unsigned i = 0; i < samples_count; i++)
+        inv += 1.0 / samples[i];
+    return samples_count ? samples_count / inv : 0;
+}
+
+HybridAdaptationLogic::HybridAdaptationLogic(vlc_object_t *obj)
+    : AbstractAdaptationLogic(obj)
+{
+    estimatedBps = 0;
+    vlc_mutex_init(&lock);
+
+    vlc_object_t *libvlc = VLC_OBJECT(vlc_object_instance(obj));
+    var_Create(libvlc, HYBRID_BW_VAR, VLC_VAR_INTEGER);
+    startupBps = var_GetInteger(libvlc, HYBRID_BW_VAR);
+    if(startupBps)
+        msg_Dbg(p_obj, "hybrid logic starting with previous estimate %u kbps",
+                startupBps / 1000);
+}
+
+HybridAdaptationLogic::~HybridAdaptationLogic()
+{
+    /* The variable is kept alive until the instance is released */
+    if(estimatedBps)
+        var_SetInteger(vlc_object_instance(p_obj), HYBRID_BW_VAR, estimatedBps);
+}
+
+BaseRepresentation *HybridAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet, BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector(maxwidth, maxheight);
+    BaseRepresentation *rep;
+
+    vlc_mutex_lock(&lock);
+
+    std::map<ID, HybridStats>::iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end() || !prevRep)
+    {
+        /* 80% of the previous estimate, or the lowest if none */
+        rep = selector.select(adaptSet, startupBps / 10 * 8);
+        vlc_mutex_unlock(&lock);
+        return rep;
+    }
+
+    HybridStats &stats = (*it).second;
+    const double f_level = stats.buffering_target
+                         ? (double) stats.buffering_level / stats.buffering_target : 0;
+
+    /* Samples are taken while the other streams download: this is our share */
+    unsigned i_bw = stats.harmonicMean();
+    if(!i_bw)
+        i_bw = startupBps / 10 * 8;
+
+    /* The fuller the buffer, the more its margin absorbs a wrong prediction */
+    const uint64_t i_target = i_bw * std::min(0.75 + f_level / 2, 1.25);
+    const uint64_t i_prev = prevRep->getBandwidth();
+
+    /* Until the buffer first fills, only the throughput is meaningful */
+    if(f_level >= BUFFER_LOW)
+        stats.buffered = true;
+
+    if(stats.buffered && f_level < BUFFER_PANIC)
+    {
+        rep = selector.select(adaptSet, std::min(i_target / 2, i_prev));
+    }
+    else
+    {
+        rep = selector.select(adaptSet, i_target);
+        if(rep && rep->getBandwidth() > i_prev)
+        {
+            if((stats.buffered && (f_level < BUFFER_LOW ||
+                                   stats.segments_since_switch < SWITCH_UP_HOLD)) ||
+               rep->getBandwidth() * (1.0 + SWITCH_UP_COST) > i_target)
+                rep = prevRep;
+        }
+        else if(rep && rep->getBandwidth() < i_prev)
+        {
+            /* Throughput still covers the bitrate and the buffer is fine */
+            if(f_level >= BUFFER_LOW && i_bw >= i_prev)
+                rep = prevRep;
+        }
+    }
+
+    if(rep != prevRep)
+        stats.segments_since_switch = 0;
+    else
+        stats.segments_since_switch++;
+
+    if(rep)
+        msg_Dbg(p_obj, "hybrid stream %s bw %u kbps buffer %.2f %" PRIu64 " -> %" PRIu64 " kbps",
+                adaptSet->getID().str().c_str(), i_bw / 1000, f_level,
+                i_prev / 1000, rep->getBandwidth() / 1000);
+
+    vlc_mutex_unlock(&lock);
+
+    return rep;
+}
+
+void HybridAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize,
+                                               vlc_tick_t time, vlc_tick_t)
+{
+    if(time <= 0)
+        return;
+
+    vlc_mutex_lock(&lock);
+    std::map<ID, HybridStats>::iterator it = streams.find(id);
+    if(it != streams.end())
+    {
+        HybridStats &stats = (*it).second;
+        stats.push(std::max<uint64_t>(1, CLOCK_FREQ * dlsize * 8 / time));
+
+        estimatedBps = 0;
+        for(it = streams.begin(); it != streams.end(); ++it)
+            estimatedBps = std::max(estimatedBps, (*it).second.harmonicMean());
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+void HybridAdaptationLogic::trackerEvent(const TrackerEvent &ev)
+{
+    switch(ev.getType())
+    {
+    case TrackerEvent::Type::BufferingStateUpdate:
+        {
+            const BufferingStateUpdatedEvent &event =
+                    static_cast<const BufferingStateUpdatedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            if(event.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                    streams.insert(std::pair<ID, HybridStats>(id, HybridStats()));
+            }
+            else
+            {
+                std::map<ID, HybridStats>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+            }
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingLevelChange:
+        {
+            const BufferingLevelChangedEvent &event =
+                    static_cast<const BufferingLevelChangedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            HybridStats &stats = streams[id];
+            stats.buffering_level = event.current;
+            stats.buffering_target = event.target;
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    default:
+            break;
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * HybridAdaptationLogic.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef HYBRIDADAPTATIONLOGIC_HPP
+#define HYBRIDADAPTATIONLOGIC_HPP
+
+#include "AbstractAdaptationLogic.h"
+#include <map>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        class HybridStats
+        {
+            friend class HybridAdaptationLogic;
+
+            public:
+                HybridStats();
+                void push(unsigned);
+                unsigned harmonicMean() const;
+
+            private:
+                static const unsigned SAMPLES = 5;
+                unsigned samples[SAMPLES];
+                unsigned samples_count;
+                unsigned samples_pos;
+                vlc_tick_t buffering_level;
+                vlc_tick_t buffering_target;
+                unsigned segments_since_switch;
+                bool buffered;
+        };
+
+        class HybridAdaptationLogic : public AbstractAdaptationLogic
+        {
+            public:
+                HybridAdaptationLogic(vlc_object_t *);
+                virtual ~HybridAdaptationLogic();
+
+                virtual BaseRepresentation* getNextRepresentation(BaseAdaptationSet *,
+                                                                  BaseRepresentation *) override;
+                virtual void                updateDownloadRate     (const ID &, size_t,
+                                                                    vlc_tick_t, vlc_tick_t) override;
+                virtual void                trackerEvent           (const TrackerEvent &) override;
+
+            private:
+                std::map<adaptive::ID, HybridStats> streams;
+                unsigned                    estimatedBps;
+                unsigned                    startupBps;
+                vlc_mutex_t                 lock;
+        };
+    }
+}
+
+#endif // HYBRIDADAPTATIONLOGIC_HPP
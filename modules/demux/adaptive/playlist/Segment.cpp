@@ -269,6 +269,15 @@ const std::vector<Segment*> & Segment::subSegments() const
     return subsegments;
 }
 
+void InitSegment::prefetch(SharedResources *res, size_t index, BaseRepresentation *rep)
+{
+    BytesRange range;
+    if(startByte != endByte)
+        range = BytesRange(startByte, endByte);
+    res->getConnManager()->prefetch(getUrlSegment().toString(index, rep),
+                                    ChunkType::Init, range);
+}
+
 InitSegment::InitSegment(ICanonicalUrl *parent) :
     Segment(parent)
 {
@@ -111,6 +111,7 @@ namespace adaptive
         {
             public:
                 InitSegment( ICanonicalUrl *parent );
+                void prefetch(SharedResources *, size_t, BaseRepresentation *);
         };
 
         class IndexSegment : public Segment
@@ -26,6 +26,7 @@
 #include "SegmentTemplate.h"
 #include "SegmentTimeline.h"
 
+#include <algorithm>
 #include <limits>
 
 using namespace adaptive::playlist;
@@ -36,24 +37,14 @@ Segment * AbstractSegmentBaseType::findSegmentByScaledTime(const std::vector<Seg
     if(segments.empty() || (segments.size() > 1 && segments[1]->startTime.Get() == 0) )
         return nullptr;
 
-    Segment *ret = nullptr;
-    std::vector<Segment *>::const_iterator it = segments.begin();
-    while(it != segments.end())
-    {
-        Segment *seg = *it;
-        if(seg->startTime.Get() > time)
-        {
-            if(it == segments.begin())
-                return nullptr;
-            else
-                break;
-        }
-
-        ret = seg;
-        it++;
-    }
+    /* last segment starting at or before time */
+    std::vector<Segment *>::const_iterator it =
+            std::upper_bound(segments.cbegin(), segments.cend(), time,
+                             [](stime_t t, const Segment *seg) { return t < seg->startTime.Get(); });
+    if(it == segments.cbegin())
+        return nullptr;
 
-    return ret;
+    return *(--it);
 }
 
 uint64_t AbstractSegmentBaseType::findSegmentNumberByScaledTime(const std::vector<Segment *> &segments,
@@ -55,8 +55,7 @@ bool SegmentChunk::decrypt(block_t **pp_block)
     if(encryptionSession)
     {
         bool b_last = !hasMoreData();
-        p_block->i_buffer = encryptionSession->decrypt(p_block->p_buffer,
-                                                       p_block->i_buffer, b_last);
+        *pp_block = encryptionSession->decrypt(p_block, b_last);
         if(b_last)
             encryptionSession->close();
     }
@@ -30,6 +30,7 @@
 #include "SegmentInformation.hpp"
 #include "SegmentTimeline.h"
 
+#include <algorithm>
 #include <limits>
 #include <cassert>
 
@@ -49,6 +50,14 @@ SegmentList::~SegmentList()
         delete(*it);
 }
 
+std::vector<Segment *>::const_iterator SegmentList::findSegmentByNumber(uint64_t number) const
+{
+    /* first segment at or after number, segments are sorted */
+    return std::lower_bound(segments.cbegin(), segments.cend(), number,
+                            [](const Segment *seg, uint64_t n) {
+                                return seg->getSequenceNumber() < n; });
+}
+
 const std::vector<Segment*>& SegmentList::getSegments() const
 {
     return segments;
@@ -65,19 +74,9 @@ Segment * SegmentList::getMediaSegment(uint64_t number) const
         return segments.at(listindex);
     }
 
-    std::vector<Segment *>::const_iterator it = segments.begin();
-    for(it = segments.begin(); it != segments.end(); ++it)
-    {
-        Segment *seg = *it;
-        if(seg->getSequenceNumber() == number)
-        {
-            return seg;
-        }
-        else if (seg->getSequenceNumber() > number)
-        {
-            break;
-        }
-    }
+    std::vector<Segment *>::const_iterator it = findSegmentByNumber(number);
+    if(it != segments.end() && (*it)->getSequenceNumber() == number)
+        return *it;
     return nullptr;
 }
 
@@ -116,7 +115,7 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
         const uint64_t oldest = updated->segments.front()->getSequenceNumber();
 
         /* filter out known segments from the update */
-        updated->pruneBySegmentNumber(prevSegment->getSequenceNumber());
+        updated->pruneBySegmentNumber(prevSegment->getSequenceNumber() + 1);
 
         if(updated->segments.empty())
             return;
@@ -253,8 +252,8 @@ vlc_tick_t SegmentList::getMinAheadTime(uint64_t curnum) const
 
     vlc_tick_t minTime = 0;
     const Timescale timescale = inheritTimescale();
-    std::vector<Segment *>::const_iterator it;
-    for(it = segments.begin(); it != segments.end(); ++it)
+    std::vector<Segment *>::const_iterator it = findSegmentByNumber(curnum);
+    for(; it != segments.end(); ++it)
     {
         const Segment *seg = *it;
         if(seg->getSequenceNumber() > curnum)
@@ -278,16 +277,13 @@ Segment *  SegmentList::getNextMediaSegment(uint64_t i_pos,uint64_t *pi_newpos,
         return segments.at(listindex);
     }
 
-    std::vector<Segment *>::const_iterator it;
-    for(it = segments.begin(); it != segments.end(); ++it)
+    std::vector<Segment *>::const_iterator it = findSegmentByNumber(i_pos);
+    if(it != segments.end())
     {
         Segment *seg = *it;
-        if(seg->getSequenceNumber() >= i_pos)
-        {
-            *pi_newpos = seg->getSequenceNumber();
-            *pb_gap = (*pi_newpos != i_pos);
-            return seg;
-        }
+        *pi_newpos = seg->getSequenceNumber();
+        *pb_gap = (*pi_newpos != i_pos);
+        return seg;
     }
     return nullptr;
 }
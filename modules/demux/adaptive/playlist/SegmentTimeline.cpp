@@ -37,105 +37,82 @@ using namespace adaptive::playlist;
 SegmentTimeline::SegmentTimeline(AbstractMultipleSegmentBaseType *parent_)
     : AttrsNode(Type::Timeline, parent_)
 {
-    totalLength = 0;
     parent = parent_;
 }
 
 SegmentTimeline::~SegmentTimeline()
 {
-    std::list<Element *>::iterator it;
-    for(it = elements.begin(); it != elements.end(); ++it)
-        delete *it;
 }
 
 void SegmentTimeline::addElement(uint64_t number, stime_t d, uint64_t r, stime_t t)
 {
-    Element *element = new (std::nothrow) Element(number, d, r, t);
-    if(element)
+    Element element(number, d, r, t);
+    if(!elements.empty())
     {
-        if(!elements.empty() && !t)
-        {
-            const Element *el = elements.back();
-            element->t = el->t + (el->d * (el->r + 1));
-        }
-        elements.push_back(element);
-        totalLength += (d * (r + 1));
+        const Element &el = elements.back();
+        if(!t)
+            element.t = el.t + el.length();
+        element.offset = el.offset + el.length();
     }
+    elements.push_back(element);
 }
 
-stime_t SegmentTimeline::getMinAheadScaledTime(uint64_t number) const
+std::vector<SegmentTimeline::Element>::const_iterator
+SegmentTimeline::findElementByNumber(uint64_t number) const
 {
-    stime_t totalscaledtime = 0;
+    /* last element starting at or before number */
+    auto it = std::upper_bound(elements.cbegin(), elements.cend(), number,
+                               [](uint64_t n, const Element &el) { return n < el.number; });
+    if(it == elements.cbegin())
+        return elements.cend();
+    return --it;
+}
 
+stime_t SegmentTimeline::getMinAheadScaledTime(uint64_t number) const
+{
     if(!elements.size() ||
        minElementNumber() > number ||
        maxElementNumber() < number)
         return 0;
 
-    std::list<Element *>::const_reverse_iterator it;
-    for(it = elements.rbegin(); it != elements.rend(); ++it)
-    {
-        const Element *el = *it;
-        if(number > el->number + el->r)
-            break;
-        else if(number < el->number)
-            totalscaledtime += (el->d * (el->r + 1));
-        else /* within repeat range */
-            totalscaledtime += el->d * (el->number + el->r - number);
-    }
+    auto it = findElementByNumber(number);
+    const Element &last = elements.back();
+    stime_t totalscaledtime = last.offset + last.length() - (it->offset + it->length());
+    if(number <= it->number + it->r) /* within repeat range */
+        totalscaledtime += it->d * (it->number + it->r - number);
 
     return totalscaledtime;
 }
 
 uint64_t SegmentTimeline::getElementNumberByScaledPlaybackTime(stime_t scaled) const
 {
-    const Element *prevel = nullptr;
-    std::list<Element *>::const_iterator it;
-
     if(!elements.size())
         return 0;
 
-    for(it = elements.begin(); it != elements.end(); ++it)
-    {
-        const Element *el = *it;
-        if(scaled >= el->t)
-        {
-            if((uint64_t)scaled < el->t + (el->d * el->r))
-                return el->number + (scaled - el->t) / el->d;
-        }
-        /* might have been discontinuity */
-        else
-        {
-            if(prevel) /* > prev but < current */
-                return prevel->number + prevel->r;
-            else /* << first of the list */
-                return el->number;
-        }
-        prevel = el;
-    }
-
-    /* time is >> any of the list */
-    return prevel->number + prevel->r;
+    /* last element starting at or before that time */
+    auto it = std::upper_bound(elements.cbegin(), elements.cend(), scaled,
+                               [](stime_t time, const Element &el) { return time < el.t; });
+    /* << first of the list */
+    if(it == elements.cbegin())
+        return it->number;
+
+    const Element &el = *(--it);
+    /* past its end, might have been discontinuity */
+    if(!el.d || (uint64_t)(scaled - el.t) / el.d > el.r)
+        return el.number + el.r;
+    return el.number + (scaled - el.t) / el.d;
 }
 
 bool SegmentTimeline::getScaledPlaybackTimeDurationBySegmentNumber(uint64_t number,
                                                                    stime_t *time, stime_t *duration) const
 {
-    std::list<Element *>::const_iterator it;
-    for(it = elements.begin(); it != elements.end(); ++it)
-    {
-        const Element *el = *it;
-        if(number >= el->number)
-        {
-            if(number <= el->number + el->r)
-            {
-                *time = el->t + el->d * (number - el->number);
-                *duration = el->d;
-                return true;
-            }
-        }
-    }
-    return false;
+    auto it = findElementByNumber(number);
+    if(it == elements.cend() || number > it->number + it->r)
+        return false;
+
+    *time = it->t + it->d * (number - it->number);
+    *duration = it->d;
+    return true;
 }
 
 stime_t SegmentTimeline::getScaledPlaybackTimeByElementNumber(uint64_t number) const
@@ -147,7 +124,11 @@ stime_t SegmentTimeline::getScaledPlaybackTimeByElementNumber(uint64_t number) c
 
 stime_t SegmentTimeline::getTotalLength() const
 {
-    return totalLength;
+    if(elements.empty())
+        return 0;
+
+    const Element &last = elements.back();
+    return last.offset + last.length() - elements.front().offset;
 }
 
 uint64_t SegmentTimeline::maxElementNumber() const
@@ -155,30 +136,23 @@ uint64_t SegmentTimeline::maxElementNumber() const
     if(elements.empty())
         return 0;
 
-    const Element *e = elements.back();
-    return e->number + e->r;
+    const Element &e = elements.back();
+    return e.number + e.r;
 }
 
 uint64_t SegmentTimeline::minElementNumber() const
 {
     if(elements.empty())
         return 0;
-    return elements.front()->number;
+    return elements.front().number;
 }
 
 uint64_t SegmentTimeline::getElementIndexBySequence(uint64_t number) const
 {
-    std::list<Element *>::const_iterator it;
-    for(it = elements.begin(); it != elements.end(); ++it)
-    {
-        const Element *el = *it;
-        if(number >= el->number)
-        {
-            if(number <= el->number + el->r)
-                return std::distance(elements.begin(), it);
-        }
-    }
-    return std::numeric_limits<uint64_t>::max();
+    auto it = findElementByNumber(number);
+    if(it == elements.cend() || number > it->number + it->r)
+        return std::numeric_limits<uint64_t>::max();
+    return std::distance(elements.cbegin(), it);
 }
 
 void SegmentTimeline::pruneByPlaybackTime(vlc_tick_t time)
@@ -190,33 +164,30 @@ void SegmentTimeline::pruneByPlaybackTime(vlc_tick_t time)
 
 size_t SegmentTimeline::pruneBySequenceNumber(uint64_t number)
 {
+    if(elements.empty() || elements.front().number >= number)
+        return 0;
+
     size_t prunednow = 0;
-    while(elements.size())
+    auto it = elements.begin() + std::distance(elements.cbegin(), findElementByNumber(number));
+    for(auto it2 = elements.cbegin(); it2 != it; ++it2)
+        prunednow += it2->r + 1;
+
+    if(it->number + it->r >= number)
     {
-        Element *el = elements.front();
-        if(el->number >= number)
-        {
-            break;
-        }
-        else if(el->number + el->r >= number)
-        {
-            uint64_t count = number - el->number;
-            el->number += count;
-            el->t += count * el->d;
-            el->r -= count;
-            prunednow += count;
-            totalLength -= count * el->d;
-            break;
-        }
-        else
-        {
-            prunednow += el->r + 1;
-            elements.pop_front();
-            totalLength -= (el->d * (el->r + 1));
-            delete el;
-        }
+        uint64_t count = number - it->number;
+        it->number += count;
+        it->t += count * it->d;
+        it->r -= count;
+        it->offset += count * it->d;
+        prunednow += count;
+    }
+    else
+    {
+        prunednow += it->r + 1;
+        ++it;
     }
 
+    elements.erase(elements.begin(), it);
     return prunednow;
 }
 
@@ -224,40 +195,29 @@ void SegmentTimeline::updateWith(SegmentTimeline &other)
 {
     if(elements.empty())
     {
-        while(other.elements.size())
-        {
-            elements.push_back(other.elements.front());
-            other.elements.pop_front();
-        }
+        elements.swap(other.elements);
+        other.elements.clear();
         return;
     }
 
-    Element *last = elements.back();
-    while(other.elements.size())
+    for(const Element &el : other.elements)
     {
-        Element *el = other.elements.front();
-        other.elements.pop_front();
+        Element &last = elements.back();
 
-        if(last->contains(el->t)) /* Same element, but prev could have been middle of repeat */
+        if(last.contains(el.t)) /* Same element, but prev could have been middle of repeat */
         {
-            const uint64_t count = (el->t - last->t) / last->d;
-            totalLength -= (last->d * (last->r + 1));
-            last->r = std::max(last->r, el->r + count);
-            totalLength += (last->d * (last->r + 1));
-            delete el;
+            const uint64_t count = (el.t - last.t) / last.d;
+            last.r = std::max(last.r, el.r + count);
         }
-        else if(el->t < last->t)
+        else if(el.t >= last.t) /* Did not exist in previous list */
         {
-            delete el;
-        }
-        else /* Did not exist in previous list */
-        {
-            totalLength += (el->d * (el->r + 1));
-            elements.push_back(el);
-            el->number = last->number + last->r + 1;
-            last = el;
+            Element element = el;
+            element.number = last.number + last.r + 1;
+            element.offset = last.offset + last.length();
+            elements.push_back(element);
         }
     }
+    other.elements.clear();
 }
 
 void SegmentTimeline::debug(vlc_object_t *obj, int indent) const
@@ -266,9 +226,8 @@ void SegmentTimeline::debug(vlc_object_t *obj, int indent) const
     ss << std::string(indent, ' ') << "Timeline";
     msg_Dbg(obj, "%s", ss.str().c_str());
 
-    std::list<Element *>::const_iterator it;
-    for(it = elements.begin(); it != elements.end(); ++it)
-        (*it)->debug(obj, indent + 1);
+    for(const Element &el : elements)
+        el.debug(obj, indent + 1);
 }
 
 SegmentTimeline::Element::Element(uint64_t number_, stime_t d_, uint64_t r_, stime_t t_)
@@ -277,6 +236,12 @@ SegmentTimeline::Element::Element(uint64_t number_, stime_t d_, uint64_t r_, sti
     d = d_;
     t = t_;
     r = r_;
+    offset = 0;
+}
+
+stime_t SegmentTimeline::Element::length() const
+{
+    return d * (r + 1);
 }
 
 bool SegmentTimeline::Element::contains(stime_t time) const
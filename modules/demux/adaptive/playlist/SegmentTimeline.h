@@ -26,7 +26,7 @@
 #include "Inheritables.hpp"
 
 #include <vlc_common.h>
-#include <list>
+#include <vector>
 
 namespace adaptive
 {
@@ -56,21 +56,25 @@ namespace adaptive
                 void debug(vlc_object_t *, int = 0) const;
 
             private:
-                std::list<Element *> elements;
-                stime_t totalLength;
-                AbstractMultipleSegmentBaseType *parent;
-
                 class Element
                 {
                     public:
                         Element(uint64_t, stime_t, uint64_t, stime_t);
                         void debug(vlc_object_t *, int = 0) const;
                         bool contains(stime_t) const;
+                        stime_t  length() const;
                         stime_t  t;
                         stime_t  d;
                         uint64_t r;
                         uint64_t number;
+                        stime_t  offset; /* cumulated length of the previous elements */
                 };
+
+                /* sorted by number and time: lookups are binary searches */
+                std::vector<Element> elements;
+                AbstractMultipleSegmentBaseType *parent;
+
+                std::vector<Element>::const_iterator findElementByNumber(uint64_t) const;
         };
     }
 }
@@ -28,7 +28,6 @@
 #include <vlc_block.h>
 #include <vlc_meta.h>
 #include <algorithm>
-#include <set>
 
 using namespace adaptive;
 
@@ -310,6 +309,8 @@ CommandsQueue::CommandsQueue()
 {
     bufferinglevel = Times();
     nextsequence = 0;
+    incomingcount = 0;
+    b_incomingsorted = true;
 }
 
 CommandsQueue::~CommandsQueue()
@@ -362,14 +363,54 @@ void CommandsQueue::Schedule( AbstractCommand *command, EsType )
     }
     else
     {
-        incoming.push_back( Queueentry(nextsequence++, command) );
+        /* Non dated commands always sort by sequence, so a stream
+           run only needs a sort when its dated ones are out of order */
+        const void *id = nullptr;
+        if( command->getType() == ES_OUT_PRIVATE_COMMAND_SEND )
+            id = static_cast<EsOutSendCommand *>(command)->esIdentifier();
+        IncomingRun &run = getIncomingRun( id );
+        const vlc_tick_t t = command->getTimes().continuous;
+        if( t != VLC_TICK_INVALID )
+        {
+            auto it = std::find_if( run.entries.rbegin(), run.entries.rend(),
+                                    [](const Queueentry &e)
+                        { return e.second->getTimes().continuous != VLC_TICK_INVALID; } );
+            if( it != run.entries.rend() && t < (*it).second->getTimes().continuous )
+                b_incomingsorted = false;
+        }
+        run.entries.push_back( Queueentry(nextsequence++, command) );
+        incomingcount++;
     }
 }
 
+CommandsQueue::IncomingRun & CommandsQueue::getIncomingRun( const void *id )
+{
+    for( IncomingRun &run : incoming )
+        if( run.id == id )
+            return run;
+    incoming.push_back( IncomingRun{ id, std::vector<Queueentry>(), 0 } );
+    return incoming.back();
+}
+
+void CommandsQueue::clearIncoming()
+{
+    /* forget the runs of idle or removed streams */
+    incoming.erase( std::remove_if( incoming.begin(), incoming.end(),
+                                    [](const IncomingRun &run){ return run.entries.empty(); } ),
+                    incoming.end() );
+    for( IncomingRun &run : incoming )
+    {
+        run.entries.clear();
+        run.merged = 0;
+    }
+    incomingcount = 0;
+    b_incomingsorted = true;
+}
+
 Times CommandsQueue::Process( Times barrier )
 {
     Times lastdts = barrier;
-    std::set<const void *> disabled_esids;
+    std::vector<const void *> disabled_esids;
     bool b_datasent = false;
 
     /* We need to filter the current commands list
@@ -379,11 +420,8 @@ Times CommandsQueue::Process( Times barrier )
        ex: for a target time of 2, you must dequeue <= 2 until >= PCR2
        A0,A1,A2,B0,PCR0,B1,B2,PCR2,B3,A3,PCR3
     */
-    std::list<Queueentry> output;
-    std::list<Queueentry> in;
-
-
-    in.splice( in.end(), commands );
+    std::deque<Queueentry> &in = processing;
+    in.swap( commands );
 
     while( !in.empty() )
     {
@@ -404,21 +442,22 @@ Times CommandsQueue::Process( Times barrier )
 
         if( command->getType() == ES_OUT_PRIVATE_COMMAND_SEND )
         {
-            EsOutSendCommand *sendcommand = dynamic_cast<EsOutSendCommand *>(command);
+            EsOutSendCommand *sendcommand = static_cast<EsOutSendCommand *>(command);
             /* We need a stream identifier to send NON DATED data following DATA for the same ES */
-            const void *id = (sendcommand) ? sendcommand->esIdentifier() : 0;
+            const void *id = sendcommand->esIdentifier();
 
             /* Not for now */
             if( command->getTimes().continuous > barrier.continuous ) /* Not for now */
             {
                 /* ensure no more non dated for that ES is sent
                  * since we're sure that data is above barrier */
-                disabled_esids.insert( id );
+                if( std::find( disabled_esids.begin(), disabled_esids.end(), id ) == disabled_esids.end() )
+                    disabled_esids.push_back( id );
                 commands.push_back( entry );
             }
             else if( command->getTimes().continuous == VLC_TICK_INVALID )
             {
-                if( disabled_esids.find( id ) == disabled_esids.end() )
+                if( std::find( disabled_esids.begin(), disabled_esids.end(), id ) == disabled_esids.end() )
                     output.push_back( entry );
                 else
                     commands.push_back( entry );
@@ -432,16 +471,16 @@ Times CommandsQueue::Process( Times barrier )
     }
 
     /* push remaining ones if broke above */
-    commands.splice( commands.end(), in );
+    commands.insert( commands.end(), in.begin(), in.end() );
+    in.clear();
 
     if(commands.empty() && b_draining)
         b_draining = false;
 
     /* Now execute our selected commands */
-    while( !output.empty() )
+    for( const Queueentry &entry : output )
     {
-        AbstractCommand *command = output.front().second;
-        output.pop_front();
+        AbstractCommand *command = entry.second;
 
         if( command->getType() == ES_OUT_PRIVATE_COMMAND_SEND )
         {
@@ -453,6 +492,7 @@ Times CommandsQueue::Process( Times barrier )
         command->Execute();
         delete command;
     }
+    output.clear();
     pcr = lastdts; /* Warn! no PCR update/lock release until execution */
 
 
@@ -462,8 +502,37 @@ Times CommandsQueue::Process( Times barrier )
 void CommandsQueue::LockedCommit()
 {
     /* reorder all blocks by time between 2 PCR and merge with main list */
-    incoming.sort( compareCommands );
-    commands.splice( commands.end(), incoming );
+    if( incomingcount == 0 )
+        return;
+
+    if( b_incomingsorted )
+    {
+        /* k-way merge of the already ordered stream runs */
+        for( ;; )
+        {
+            IncomingRun *next = nullptr;
+            for( IncomingRun &run : incoming )
+            {
+                if( run.merged < run.entries.size() &&
+                   ( !next || compareCommands( run.entries[run.merged],
+                                               next->entries[next->merged] ) ) )
+                    next = &run;
+            }
+            if( !next )
+                break;
+            commands.push_back( next->entries[next->merged++] );
+        }
+    }
+    else
+    {
+        std::vector<Queueentry> sorted;
+        sorted.reserve( incomingcount );
+        for( const IncomingRun &run : incoming )
+            sorted.insert( sorted.end(), run.entries.begin(), run.entries.end() );
+        std::stable_sort( sorted.begin(), sorted.end(), compareCommands );
+        commands.insert( commands.end(), sorted.begin(), sorted.end() );
+    }
+    clearIncoming();
 }
 
 void CommandsQueue::Commit()
@@ -473,12 +542,13 @@ void CommandsQueue::Commit()
 
 void CommandsQueue::Abort( bool b_reset )
 {
-    commands.splice( commands.end(), incoming );
-    while( !commands.empty() )
-    {
-        delete commands.front().second;
-        commands.pop_front();
-    }
+    for( const IncomingRun &run : incoming )
+        for( const Queueentry &entry : run.entries )
+            delete entry.second;
+    clearIncoming();
+    for( const Queueentry &entry : commands )
+        delete entry.second;
+    commands.clear();
 
     if( b_reset )
     {
@@ -492,7 +562,7 @@ void CommandsQueue::Abort( bool b_reset )
 
 bool CommandsQueue::isEmpty() const
 {
-    return commands.empty() && incoming.empty();
+    return commands.empty() && incomingcount == 0;
 }
 
 void CommandsQueue::setDraining()
@@ -533,7 +603,7 @@ Times CommandsQueue::getBufferingLevel() const
 Times CommandsQueue::getFirstTimes() const
 {
     Times first = pcr;
-    std::list<Queueentry>::const_iterator it;
+    std::deque<Queueentry>::const_iterator it;
     for( it = commands.begin(); it != commands.end(); ++it )
     {
         const Times times = (*it).second->getTimes();
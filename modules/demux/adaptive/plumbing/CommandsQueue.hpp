@@ -27,7 +27,9 @@
 #include <vlc_es.h>
 
 #include <atomic>
+#include <deque>
 #include <list>
+#include <vector>
 
 namespace adaptive
 {
@@ -227,8 +229,22 @@ namespace adaptive
         private:
             void LockedCommit();
             void LockedSetDraining();
-            std::list<Queueentry> incoming;
-            std::list<Queueentry> commands;
+            /* Commands of a stream since the last PCR, in schedule order.
+               Storage is kept between commits. */
+            struct IncomingRun
+            {
+                const void *id;
+                std::vector<Queueentry> entries;
+                size_t merged;
+            };
+            IncomingRun & getIncomingRun( const void * );
+            void clearIncoming();
+            std::vector<IncomingRun> incoming;
+            size_t incomingcount;
+            bool b_incomingsorted;
+            std::deque<Queueentry> commands;
+            std::deque<Queueentry> processing;
+            std::vector<Queueentry> output;
             SegmentTimes bufferinglevel_media;
             Times bufferinglevel;
             Times pcr;
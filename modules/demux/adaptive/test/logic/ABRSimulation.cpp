@@ -0,0 +1,429 @@
+/*****************************************************************************
+ * ABRSimulation.cpp: adaptation logics against network traces
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../playlist/BasePlaylist.hpp"
+#include "../../playlist/BasePeriod.h"
+#include "../../playlist/BaseAdaptationSet.h"
+#include "../../playlist/BaseRepresentation.h"
+#include "../../logic/BufferingLogic.hpp"
+#include "../../logic/AlwaysLowestAdaptationLogic.hpp"
+#include "../../logic/AlwaysBestAdaptationLogic.h"
+#include "../../logic/RateBasedAdaptationLogic.h"
+#include "../../logic/PredictiveAdaptationLogic.hpp"
+#include "../../logic/NearOptimalAdaptationLogic.hpp"
+#include "../../logic/HybridAdaptationLogic.hpp"
+#include "../../http/HTTPConnectionManager.h"
+#include "../../SegmentTracker.hpp"
+#include "../../../../../lib/libvlc_internal.h"
+
+#include "../test.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+/*
+ * Plays a VOD stream in virtual time: segments are downloaded one after the
+ * other through a connection manager replaying a bandwidth and latency
+ * trace, while the playback drains the buffer. The adaptation logic gets
+ * the same download rates and tracker events as with the real streams.
+ *
+ * An additional trace can be given through the ADAPTIVE_ABR_TRACE
+ * environment variable, as a text file with one
+ * "<duration ms> <kbps> <latency ms>" step per line.
+ */
+
+using namespace adaptive;
+using namespace adaptive::http;
+using namespace adaptive::logic;
+using namespace adaptive::playlist;
+
+namespace
+{
+    struct TraceStep
+    {
+        vlc_tick_t duration;
+        unsigned kbps;
+        vlc_tick_t latency;
+    };
+
+    class NetworkTrace
+    {
+        public:
+            NetworkTrace(const char *n) : name(n), period(0) {}
+
+            void add(unsigned ms, unsigned kbps, unsigned latency)
+            {
+                steps.push_back({ VLC_TICK_FROM_MS(ms), kbps,
+                                  VLC_TICK_FROM_MS(latency) });
+                period += VLC_TICK_FROM_MS(ms);
+            }
+
+            bool isEmpty() const { return period == 0; }
+
+            /* Returns the step at a time of the looped trace, and the time
+             * left until the next step */
+            const TraceStep &at(vlc_tick_t t, vlc_tick_t *remaining) const
+            {
+                t %= period;
+                for(const TraceStep &step : steps)
+                {
+                    if(t < step.duration)
+                    {
+                        *remaining = step.duration - t;
+                        return step;
+                    }
+                    t -= step.duration;
+                }
+                vlc_assert_unreachable();
+            }
+
+            /* Returns the time to download a given size, starting at t */
+            vlc_tick_t transfer(vlc_tick_t t, size_t size,
+                                vlc_tick_t *latency) const
+            {
+                vlc_tick_t remaining;
+                *latency = at(t, &remaining).latency;
+
+                vlc_tick_t now = t + *latency;
+                double bits = size * 8.0;
+                while(bits > 0)
+                {
+                    const TraceStep &step = at(now, &remaining);
+                    const double bps = step.kbps * 1000.0;
+                    const double capacity = bps * remaining / CLOCK_FREQ;
+                    if(capacity >= bits)
+                    {
+                        now += std::max<vlc_tick_t>(1, bits * CLOCK_FREQ / bps);
+                        break;
+                    }
+                    bits -= capacity;
+                    now += remaining;
+                }
+                return now - t;
+            }
+
+            std::string name;
+
+        private:
+            std::vector<TraceStep> steps;
+            vlc_tick_t period;
+    };
+
+    /* Downloads in virtual time, and reports the rates like the chunks */
+    class TraceConnectionManager : public AbstractConnectionManager
+    {
+        public:
+            TraceConnectionManager(vlc_object_t *obj, const NetworkTrace &t)
+                : AbstractConnectionManager(obj), trace(t) {}
+            virtual ~TraceConnectionManager() = default;
+            virtual void closeAllConnections() override {}
+            virtual AbstractConnection * getConnection(ConnectionParams &) override
+            {
+                return nullptr;
+            }
+            virtual AbstractChunkSource *makeSource(const std::string &,
+                                                    const ID &, ChunkType,
+                                                    const BytesRange &) override
+            {
+                return nullptr;
+            }
+            virtual void recycleSource(AbstractChunkSource *) override {}
+            virtual void start(AbstractChunkSource *) override {}
+            virtual void cancel(AbstractChunkSource *) override {}
+
+            vlc_tick_t download(const ID &id, vlc_tick_t now, size_t size)
+            {
+                vlc_tick_t latency;
+                vlc_tick_t time = trace.transfer(now, size, &latency);
+                updateDownloadRate(id, size, time, latency);
+                return time;
+            }
+
+        private:
+            const NetworkTrace &trace;
+    };
+
+    class SimulationPlaylist : public BasePlaylist
+    {
+        public:
+            SimulationPlaylist() : BasePlaylist(nullptr) {}
+            virtual ~SimulationPlaylist() = default;
+            virtual bool isLive() const override { return false; }
+            virtual bool isLowLatency() const override { return false; }
+    };
+
+    struct QoE
+    {
+        unsigned segments;
+        unsigned switches;
+        unsigned stalls;
+        vlc_tick_t startup;
+        vlc_tick_t stalled;
+        uint64_t bitrate; /* average */
+
+        double rebufferRatio(vlc_tick_t duration) const
+        {
+            return (double) stalled / duration;
+        }
+    };
+}
+
+static const unsigned LADDER[] = { 300, 750, 1200, 2500, 4500, 8000 };
+#define SEGMENT_DURATION VLC_TICK_FROM_SEC(2)
+#define SEGMENTS         150
+
+static QoE Simulate(vlc_object_t *obj, AbstractAdaptationLogic *logic,
+                    const NetworkTrace &trace)
+{
+    SimulationPlaylist playlist;
+    BasePeriod *period = new BasePeriod(&playlist);
+    playlist.addPeriod(period);
+    BaseAdaptationSet *set = new BaseAdaptationSet(period);
+    period->addAdaptationSet(set);
+    set->setID(ID("video"));
+
+    for(unsigned kbps : LADDER)
+    {
+        BaseRepresentation *rep = new BaseRepresentation(set);
+        rep->setBandwidth(kbps * 1000);
+        rep->setID(ID(std::to_string(kbps)));
+        set->addRepresentation(rep);
+    }
+
+    DefaultBufferingLogic buffering;
+    buffering.setLowDelay(false);
+    const vlc_tick_t minbuf = buffering.getMinBuffering(&playlist);
+    const vlc_tick_t maxbuf = buffering.getMaxBuffering(&playlist);
+    const vlc_tick_t target = buffering.getStableBuffering(&playlist);
+
+    TraceConnectionManager conn(obj, trace);
+    conn.setDownloadRateObserver(logic);
+
+    const ID &id = set->getID();
+    QoE qoe = {};
+    BaseRepresentation *rep = nullptr;
+    vlc_tick_t now = 0, level = 0;
+    uint64_t bitrates = 0;
+    bool playing = false;
+
+    logic->trackerEvent(BufferingStateUpdatedEvent(id, true));
+
+    for(unsigned i = 0; i < SEGMENTS; i++)
+    {
+        /* Downloads pause while the buffer is full */
+        if(playing && level + SEGMENT_DURATION > maxbuf)
+        {
+            vlc_tick_t wait = level + SEGMENT_DURATION - maxbuf;
+            now += wait;
+            level -= wait;
+        }
+
+        BaseRepresentation *next = logic->getNextRepresentation(set, rep);
+        if(next == nullptr)
+            break;
+        if(next != rep)
+        {
+            if(rep != nullptr)
+                qoe.switches++;
+            logic->trackerEvent(RepresentationSwitchEvent(rep, next));
+            rep = next;
+        }
+        logic->trackerEvent(SegmentChangedEvent(id, i,
+                                                i * SEGMENT_DURATION,
+                                                i * SEGMENT_DURATION,
+                                                SEGMENT_DURATION));
+
+        const size_t size = rep->getBandwidth() * SEGMENT_DURATION
+                          / CLOCK_FREQ / 8;
+        vlc_tick_t time = conn.download(id, now, size);
+        now += time;
+
+        if(playing)
+        {
+            if(level >= time)
+                level -= time;
+            else
+            {
+                qoe.stalled += time - level;
+                qoe.stalls++;
+                level = 0;
+                playing = false;
+            }
+        }
+        else if(i > 0 && qoe.startup != 0)
+            qoe.stalled += time;
+
+        level += SEGMENT_DURATION;
+        bitrates += rep->getBandwidth();
+        qoe.segments++;
+
+        /* Playback (re)starts once the minimum is buffered */
+        if(!playing && (level >= minbuf || i + 1 == SEGMENTS))
+        {
+            playing = true;
+            if(qoe.startup == 0)
+                qoe.startup = now;
+        }
+
+        logic->trackerEvent(BufferingLevelChangedEvent(id, minbuf, maxbuf,
+                                                       level, target));
+    }
+
+    logic->trackerEvent(BufferingStateUpdatedEvent(id, false));
+    if(qoe.segments)
+        qoe.bitrate = bitrates / qoe.segments;
+    return qoe;
+}
+
+static void LoadTrace(NetworkTrace &trace, const char *path)
+{
+    FILE *stream = fopen(path, "rt");
+    if(stream == nullptr)
+    {
+        std::cerr << "cannot open trace " << path << std::endl;
+        return;
+    }
+
+    unsigned ms, kbps, latency;
+    while(fscanf(stream, "%u %u %u", &ms, &kbps, &latency) == 3)
+        if(ms > 0)
+            trace.add(ms, kbps, latency);
+    fclose(stream);
+}
+
+int ABRSimulation_test()
+{
+    /* Synthetic traces after the usual mobile and home measurements */
+    NetworkTrace umts("3G");
+    umts.add(4000, 1200, 150);
+    umts.add(3000, 600, 200);
+    umts.add(1500, 250, 400);
+    umts.add(5000, 1500, 150);
+    umts.add(2000, 900, 180);
+    umts.add(800, 0, 800);
+    umts.add(4000, 1800, 120);
+
+    NetworkTrace lte("LTE");
+    lte.add(5000, 12000, 50);
+    lte.add(3000, 6000, 70);
+    lte.add(2000, 2500, 90);
+    lte.add(4000, 18000, 40);
+    lte.add(1500, 1200, 120);
+    lte.add(6000, 9000, 60);
+
+    NetworkTrace wifi("Wi-Fi");
+    wifi.add(10000, 30000, 15);
+    wifi.add(1000, 8000, 40);
+    wifi.add(8000, 25000, 20);
+    wifi.add(500, 3000, 80);
+
+    NetworkTrace user("user");
+    const char *path = getenv("ADAPTIVE_ABR_TRACE");
+    if(path != nullptr)
+        LoadTrace(user, path);
+
+    const NetworkTrace *traces[] = { &umts, &lte, &wifi, &user };
+
+    struct
+    {
+        const char *name;
+        std::function<AbstractAdaptationLogic *(vlc_object_t *)> create;
+    } const logics[] = {
+        { "lowest", [](vlc_object_t *o) { return new AlwaysLowestAdaptationLogic(o); } },
+        { "best", [](vlc_object_t *o) { return new AlwaysBestAdaptationLogic(o); } },
+        { "rate", [](vlc_object_t *o) { return new RateBasedAdaptationLogic(o); } },
+        { "predictive", [](vlc_object_t *o) { return new PredictiveAdaptationLogic(o); } },
+        { "nearoptimal", [](vlc_object_t *o) { return new NearOptimalAdaptationLogic(o); } },
+        { "hybrid", [](vlc_object_t *o) { return new HybridAdaptationLogic(o); } },
+    };
+
+    /* The hybrid logic keeps its estimate on the instance */
+    libvlc_int_t *vlc = libvlc_InternalCreate();
+    if(vlc == nullptr)
+        return 1;
+    vlc_object_t *obj = VLC_OBJECT(vlc);
+    const vlc_tick_t duration = SEGMENTS * SEGMENT_DURATION;
+
+    try
+    {
+        for(const NetworkTrace *trace : traces)
+        {
+            if(trace->isEmpty())
+                continue;
+
+            for(const auto &l : logics)
+            {
+                /* Each session starts afresh */
+                var_Destroy(obj, "adaptive-hybrid-bw");
+
+                AbstractAdaptationLogic *logic = l.create(obj);
+                QoE qoe = Simulate(obj, logic, *trace);
+                delete logic;
+
+                char line[160];
+                snprintf(line, sizeof(line), "%-6s %-12s rebuffer %5.2f%% "
+                         "(%u stalls) bitrate %5" PRIu64 " kbps switches %3u "
+                         "startup %4" PRId64 " ms", trace->name.c_str(), l.name,
+                         qoe.rebufferRatio(duration) * 100, qoe.stalls,
+                         qoe.bitrate / 1000, qoe.switches,
+                         MS_FROM_VLC_TICK(qoe.startup));
+                std::cerr << " " << line << std::endl;
+
+                Expect(qoe.segments == SEGMENTS);
+                Expect(qoe.startup > 0);
+                Expect(qoe.bitrate >= LADDER[0] * 1000);
+
+                if(!strcmp(l.name, "lowest"))
+                {
+                    Expect(qoe.switches == 0);
+                    Expect(qoe.bitrate == LADDER[0] * 1000);
+                }
+                else if(!strcmp(l.name, "best"))
+                {
+                    Expect(qoe.switches == 0);
+                }
+            }
+        }
+
+        /* The bounds of what the adaptive logics can achieve */
+        QoE qlowest, qbest;
+        AbstractAdaptationLogic *logic = new AlwaysLowestAdaptationLogic(obj);
+        qlowest = Simulate(obj, logic, umts);
+        delete logic;
+        logic = new AlwaysBestAdaptationLogic(obj);
+        qbest = Simulate(obj, logic, umts);
+        delete logic;
+        Expect(qlowest.stalled == 0);
+        Expect(qbest.stalled > qlowest.stalled);
+    } catch(...) {
+        libvlc_InternalDestroy(vlc);
+        return 1;
+    }
+
+    libvlc_InternalDestroy(vlc);
+    return 0;
+}
@@ -417,6 +417,113 @@ int M3U8Playlist_test()
         return 1;
     }
 
+    /* Manifest 6 */
+    const char manifest6[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=1.0\n"
+    "#EXT-X-PART-INF:PART-TARGET=0.33334\n"
+    "#EXT-X-MEDIA-SEQUENCE:10\n"
+    "#EXTINF:4\n"
+    "foobar.ts\n"
+    "#EXTINF:4\n"
+    "foobar.ts\n"
+    "#EXT-X-PART:DURATION=0.33334,URI=\"foobar.part.ts\"\n";
+
+    m3u = ParseM3U8(obj, manifest6, sizeof(manifest6));
+    try
+    {
+        Expect(m3u);
+        Expect(m3u->isLive() == true);
+        Expect(m3u->isLowLatency() == true);
+        HLSRepresentation *rep = static_cast<HLSRepresentation *>(m3u->getFirstPeriod()->
+                                 getAdaptationSets().front()->getRepresentations().front());
+        Expect(rep->getProfile()->getStartSegmentNumber() == 10);
+        Expect(rep->getPlaylistUpdateUrl() == "stdin://?_HLS_msn=12");
+
+        delete m3u;
+    }
+    catch (...)
+    {
+        delete m3u;
+        return 1;
+    }
+
+    /* Manifest 7, followed by delta updates */
+    const char manifest7[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-SKIP-UNTIL=24\n"
+    "#EXT-X-MEDIA-SEQUENCE:10\n"
+    "#EXTINF:4\n"
+    "a.ts\n"
+    "#EXTINF:4\n"
+    "b.ts\n"
+    "#EXTINF:4\n"
+    "c.ts\n"
+    "#EXTINF:4\n"
+    "d.ts\n";
+
+    const char delta0[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-SKIP-UNTIL=24\n"
+    "#EXT-X-MEDIA-SEQUENCE:11\n"
+    "#EXT-X-SKIP:SKIPPED-SEGMENTS=2\n"
+    "#EXTINF:4\n"
+    "d.ts\n"
+    "#EXTINF:4\n"
+    "e.ts\n";
+
+    const char delta1[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-SKIP-UNTIL=24\n"
+    "#EXT-X-MEDIA-SEQUENCE:20\n"
+    "#EXT-X-SKIP:SKIPPED-SEGMENTS=2\n"
+    "#EXTINF:4\n"
+    "z.ts\n";
+
+    m3u = ParseM3U8(obj, manifest7, sizeof(manifest7));
+    try
+    {
+        Expect(m3u);
+        HLSRepresentation *rep = static_cast<HLSRepresentation *>(m3u->getFirstPeriod()->
+                                 getAdaptationSets().front()->getRepresentations().front());
+        Expect(rep->getPlaylistUpdateUrl() == "stdin://?_HLS_skip=YES");
+
+        M3U8Parser parser(nullptr);
+        stream_t *substream = vlc_stream_MemoryNew(obj, (uint8_t *)delta0, sizeof(delta0), true);
+        Expect(substream);
+        bool b_ok = parser.appendSegmentsFromStream(obj, rep, substream);
+        vlc_stream_Delete(substream);
+        Expect(b_ok);
+        Expect(rep->getProfile()->getStartSegmentNumber() == 11);
+        Segment *seg = rep->getMediaSegment(11);
+        Expect(seg);
+        Expect(seg->getUrlSegment().toString().find("b.ts") != std::string::npos);
+        Expect(seg->duration.Get() == (stime_t) vlc_tick_from_sec(4));
+        seg = rep->getMediaSegment(14);
+        Expect(seg);
+        Expect(seg->getUrlSegment().toString().find("e.ts") != std::string::npos);
+        Expect(seg->startTime.Get() == (stime_t) vlc_tick_from_sec(16));
+
+        /* skipped segments are unknown */
+        substream = vlc_stream_MemoryNew(obj, (uint8_t *)delta1, sizeof(delta1), true);
+        Expect(substream);
+        b_ok = parser.appendSegmentsFromStream(obj, rep, substream);
+        vlc_stream_Delete(substream);
+        Expect(!b_ok);
+        Expect(rep->getMediaSegment(14));
+        Expect(rep->getPlaylistUpdateUrl() == "stdin://");
+
+        delete m3u;
+    }
+    catch (...)
+    {
+        delete m3u;
+        return 1;
+    }
 
     return 0;
 }
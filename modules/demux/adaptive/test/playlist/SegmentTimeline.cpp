@@ -112,6 +112,9 @@ int Timeline_test()
         Expect(timeline->pruneBySequenceNumber(24) == 5+8);
         Expect(timeline->minElementNumber() == 24);
         Expect(timeline->getTotalLength() == 20 * 2 + 33 * 2);
+        Expect(timeline->getMinAheadScaledTime(24) == 20 + 33 * 2);
+        Expect(timeline->getMinAheadScaledTime(30) == 33 * 2);
+        Expect(timeline->getScaledPlaybackTimeByElementNumber(24) == START + 175 + 100*2 + 20*8);
 
         Timescale timescale(100);
         timeline->addAttribute(new TimescaleAttr(timescale));
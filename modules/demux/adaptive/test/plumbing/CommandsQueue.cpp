@@ -304,6 +304,36 @@ int CommandsQueue_test()
         Expect(esout.output.empty());
         queue.Abort(true);
 
+        /* reordering out of order stream */
+        for(size_t i=0; i<4; i++)
+        {
+            block_t *data = block_Alloc(0);
+            Expect(data);
+            data->i_dts = VLC_TICK_0 + OFFSET + vlc_tick_from_sec(3 - i);
+            cmd = factory.createEsOutSendCommand(id0, SegmentTimes(), data);
+            queue.Schedule(cmd);
+            data = block_Alloc(0);
+            Expect(data);
+            data->i_dts = VLC_TICK_0 + OFFSET + vlc_tick_from_sec(i);
+            cmd = factory.createEsOutSendCommand(id1, SegmentTimes(), data);
+            queue.Schedule(cmd);
+        }
+        cmd = factory.createEsOutControlPCRCommand(0, SegmentTimes(),
+                                                   VLC_TICK_0 + OFFSET + vlc_tick_from_sec(3));
+        queue.Schedule(cmd);
+        queue.Process(DT(VLC_TICK_0 + OFFSET + vlc_tick_from_sec(3)));
+        Expect(esout.output.size() == 8);
+        for(size_t i=0; i<8; i++)
+        {
+            const vlc_tick_t now = VLC_TICK_0 + OFFSET + vlc_tick_from_sec(i / 2);
+            OutputVal val = esout.output.front();
+            Expect(val.second->i_dts == now);
+            block_Release(val.second);
+            esout.output.pop_front();
+        }
+        Expect(esout.output.empty());
+        queue.Abort(true);
+
         /* reordering PCR before PTS */
         for(size_t i=0; i<2; i++)
         {
@@ -47,6 +47,7 @@ int M3U8MasterPlaylist_test();
 int M3U8Playlist_test();
 int CommandsQueue_test();
 int BufferingLogic_test();
+int ABRSimulation_test();
 int FakeEsOut_test();
 int SegmentTracker_test();
 
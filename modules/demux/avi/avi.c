@@ -116,13 +116,13 @@ typedef struct
 } avi_packet_t;
 
 
+/* Kept small, as there is one per chunk */
 typedef struct
 {
-    vlc_fourcc_t i_id;
-    uint32_t     i_flags;
     uint64_t     i_pos;
-    uint32_t     i_length;
     uint64_t     i_lengthtotal;
+    uint32_t     i_length;
+    uint32_t     i_flags;
 
 } avi_entry_t;
 
@@ -136,6 +136,7 @@ typedef struct
 static void avi_index_Init( avi_index_t * );
 static void avi_index_Clean( avi_index_t * );
 static void avi_index_Append( avi_index_t *, uint64_t *, avi_entry_t * );
+static int  avi_index_Reserve( avi_index_t *, uint32_t );
 
 typedef struct
 {
@@ -1164,7 +1165,6 @@ static int Demux_Seekable( demux_t *p_demux )
 
                     /* add this chunk to the index */
                     avi_entry_t index;
-                    index.i_id     = avi_pk.i_fourcc;
                     index.i_flags  = AVI_GetKeyFlag(tk->fmt.i_codec, avi_pk.i_peek);
                     index.i_pos    = avi_pk.i_pos;
                     index.i_length = avi_pk.i_size;
@@ -1854,7 +1854,6 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
 
             /* add this chunk to the index */
             avi_entry_t index;
-            index.i_id     = avi_pk.i_fourcc;
             index.i_flags  = AVI_GetKeyFlag(tk_pk->fmt.i_codec, avi_pk.i_peek);
             index.i_pos    = avi_pk.i_pos;
             index.i_length = avi_pk.i_size;
@@ -2273,6 +2272,19 @@ static void avi_index_Clean( avi_index_t *p_index )
 {
     free( p_index->p_entry );
 }
+static int avi_index_Reserve( avi_index_t *p_index, uint32_t i_count )
+{
+    if( i_count <= p_index->i_max )
+        return VLC_SUCCESS;
+
+    avi_entry_t *p_entry = vlc_reallocarray( p_index->p_entry, i_count,
+                                             sizeof( *p_entry ) );
+    if( !p_entry )
+        return VLC_ENOMEM;
+    p_index->p_entry = p_entry;
+    p_index->i_max = i_count;
+    return VLC_SUCCESS;
+}
 static void avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
                               avi_entry_t *p_entry )
 {
@@ -2283,10 +2295,10 @@ static void avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
     /* add the entry */
     if( p_index->i_size >= p_index->i_max )
     {
-        p_index->i_max += 16384;
-        p_index->p_entry = realloc_or_free( p_index->p_entry,
-                                            p_index->i_max * sizeof( *p_index->p_entry ) );
-        if( !p_index->p_entry )
+        /* grow geometrically, indexes can have millions of entries */
+        uint32_t i_max = __MAX( 16384, p_index->i_max + p_index->i_max / 2 );
+        if( i_max <= p_index->i_max ||
+            avi_index_Reserve( p_index, i_max ) )
             return;
     }
     /* calculate cumulate length */
@@ -2381,6 +2393,26 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
 
     p_sys->b_indexloaded = true;
 
+    /* Count the entries first, so that each index is allocated once */
+    uint32_t pi_count[p_sys->i_track];
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        pi_count[i] = p_index[i].i_size;
+
+    for( unsigned i_index = 0; i_index < p_idx1->i_entry_count; i_index++ )
+    {
+        enum es_format_category_e i_cat;
+        unsigned i_stream;
+
+        AVI_ParseStreamHeader( p_idx1->entry[i_index].i_fourcc,
+                               &i_stream,
+                               &i_cat );
+        if( i_stream < p_sys->i_track &&
+            (i_cat == p_sys->track[i_stream]->fmt.i_cat || i_cat == UNKNOWN_ES ) )
+            pi_count[i_stream]++;
+    }
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        avi_index_Reserve( &p_index[i], pi_count[i] );
+
     for( unsigned i_index = 0; i_index < p_idx1->i_entry_count; i_index++ )
     {
         enum es_format_category_e i_cat;
@@ -2393,7 +2425,6 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
             (i_cat == p_sys->track[i_stream]->fmt.i_cat || i_cat == UNKNOWN_ES ) )
         {
             avi_entry_t index;
-            index.i_id     = p_idx1->entry[i_index].i_fourcc;
             index.i_flags  = p_idx1->entry[i_index].i_flags&(~AVIIF_FIXKEYFRAME);
             index.i_pos    = p_idx1->entry[i_index].i_pos + i_offset;
             index.i_length = p_idx1->entry[i_index].i_length;
@@ -2435,11 +2466,13 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     p_sys->b_indexloaded = true;
 
     msg_Dbg( p_demux, "loading subindex(0x%x) %d entries", p_indx->i_indextype, p_indx->i_entriesinuse );
+    if( p_indx->i_entriesinuse > UINT32_MAX - p_index->i_size )
+        return;
+    avi_index_Reserve( p_index, p_index->i_size + p_indx->i_entriesinuse );
     if( p_indx->i_indexsubtype == 0 )
     {
         for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
         {
-            index.i_id     = p_indx->i_id;
             index.i_flags  = p_indx->idx.std[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
             index.i_pos    = p_indx->i_baseoffset + p_indx->idx.std[i].i_offset - 8;
             index.i_length = p_indx->idx.std[i].i_size&0x7fffffff;
@@ -2452,7 +2485,6 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     {
         for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
         {
-            index.i_id     = p_indx->i_id;
             index.i_flags  = p_indx->idx.field[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
             index.i_pos    = p_indx->i_baseoffset + p_indx->idx.field[i].i_offset - 8;
             index.i_length = p_indx->idx.field[i].i_size;
@@ -2656,7 +2688,6 @@ static void AVI_IndexCreate( demux_t *p_demux )
             avi_track_t *tk = p_sys->track[pk.i_stream];
 
             avi_entry_t index;
-            index.i_id      = pk.i_fourcc;
             index.i_flags   = AVI_GetKeyFlag(tk->fmt.i_codec, pk.i_peek);
             index.i_pos     = pk.i_pos;
             index.i_length  = pk.i_size;
@@ -88,6 +88,7 @@ typedef struct
 
     vlc_tick_t i_length; /* Length from stream info */
     uint64_t i_data_pos;
+    int64_t i_frame_pos; /* of the next output frame, -1 if unknown */
 
     /* */
     int         i_seekpoint;
@@ -107,6 +108,7 @@ typedef struct
 #define FLAC_PACKET_SIZE 16384
 #define FLAC_MAX_PREROLL      VLC_TICK_FROM_SEC(4)
 #define FLAC_MAX_SLOW_PREROLL VLC_TICK_FROM_SEC(45)
+#define FLAC_INDEX_INTERVAL   VLC_TICK_FROM_SEC(1)
 
 /*****************************************************************************
  * Open: initializes ES structures
@@ -144,6 +146,7 @@ static int Open( vlc_object_t * p_this )
     p_sys->p_packetizer = NULL;
     p_sys->p_meta = NULL;
     p_sys->i_length = 0;
+    p_sys->i_frame_pos = 0;
     p_sys->i_pts = VLC_TICK_INVALID;
     p_sys->b_stream_info = false;
     p_sys->p_es = NULL;
@@ -253,6 +256,7 @@ static void FlushPacketizer( decoder_t *p_packetizer )
 static void Reset( demux_sys_t *p_sys )
 {
     p_sys->i_pts = VLC_TICK_INVALID;
+    p_sys->i_frame_pos = -1;
 
     FlushPacketizer( p_sys->p_packetizer );
     if( p_sys->p_current_block )
@@ -262,6 +266,31 @@ static void Reset( demux_sys_t *p_sys )
     }
 }
 
+/* Adds a frame to the seek table, so that seeking back to an already played
+ * part of the stream does not need to search for it. The table stays sorted
+ * and only gets one point every FLAC_INDEX_INTERVAL. */
+static void IndexFrame( demux_sys_t *p_sys, vlc_tick_t i_time, uint64_t i_offset )
+{
+    int i = p_sys->i_seekpoint;
+
+    while( i > 0 && p_sys->seekpoint[i-1]->i_byte_offset > i_offset )
+        i--;
+
+    if( i > 0 && ( i_time - p_sys->seekpoint[i-1]->i_time_offset < FLAC_INDEX_INTERVAL ||
+                   p_sys->seekpoint[i-1]->i_byte_offset == i_offset ) )
+        return;
+    if( i < p_sys->i_seekpoint &&
+        p_sys->seekpoint[i]->i_time_offset - i_time < FLAC_INDEX_INTERVAL )
+        return;
+
+    flac_seekpoint_t *s = malloc( sizeof (*s) );
+    if( unlikely(s == NULL) )
+        return;
+    s->i_time_offset = i_time;
+    s->i_byte_offset = i_offset;
+    TAB_INSERT( p_sys->i_seekpoint, p_sys->seekpoint, s, i );
+}
+
 static int RefineSeek( demux_t *p_demux, vlc_tick_t i_time, double i_bytemicrorate,
                        uint64_t i_lowpos, uint64_t i_highpos )
 {
@@ -396,6 +425,15 @@ static int Demux( demux_t *p_demux )
             if(p_block_out->i_dts != VLC_TICK_INVALID)
                 p_sys->i_pts = p_block_out->i_dts;
 
+            /* Frames are contiguous until the next seek */
+            if( p_sys->i_frame_pos >= 0 )
+            {
+                if( p_block_out->i_dts != VLC_TICK_INVALID )
+                    IndexFrame( p_sys, p_block_out->i_dts - VLC_TICK_0,
+                                p_sys->i_frame_pos );
+                p_sys->i_frame_pos += p_block_out->i_buffer;
+            }
+
             es_out_Send( p_demux->out, p_sys->p_es, p_block_out );
 
             es_out_SetPCR( p_demux->out, p_sys->i_pts );
@@ -480,7 +518,7 @@ static int ControlSetTime( demux_t *p_demux, vlc_tick_t i_time )
                 break;
         }
 
-        i_lower = p_sys->seekpoint[0]->i_byte_offset + p_sys->i_data_pos;
+        i_lower = p_sys->seekpoint[__MAX(i, 0)]->i_byte_offset + p_sys->i_data_pos;
         if( i+1 < p_sys->i_seekpoint )
             i_upper = p_sys->seekpoint[i+1]->i_byte_offset + p_sys->i_data_pos;
 
@@ -33,6 +33,7 @@
 #include "../../adaptive/playlist/SegmentList.h"
 
 #include <ctime>
+#include <sstream>
 #include <limits>
 #include <cassert>
 
@@ -47,6 +48,10 @@ HLSRepresentation::HLSRepresentation  ( BaseAdaptationSet *set ) :
     updateFailureCount = 0;
     lastUpdateTime = 0;
     targetDuration = 0;
+    partTarget = 0;
+    b_canBlockReload = false;
+    skipUntil = 0;
+    nextSequenceNumber = 0;
     streamFormat = StreamFormat::Type::Unknown;
 }
 
@@ -64,6 +69,11 @@ bool HLSRepresentation::isLive() const
     return b_live;
 }
 
+bool HLSRepresentation::isLowLatency() const
+{
+    return b_live && partTarget > 0;
+}
+
 bool HLSRepresentation::initialized() const
 {
     return b_loaded;
@@ -89,6 +99,33 @@ Url HLSRepresentation::getPlaylistUrl() const
     }
 }
 
+std::string HLSRepresentation::getPlaylistUpdateUrl() const
+{
+    std::string url = getPlaylistUrl().toString();
+    if(!b_loaded || !b_live)
+        return url;
+
+    std::stringstream ss;
+    ss.imbue(std::locale("C"));
+    char sep = url.find('?') == std::string::npos ? '?' : '&';
+
+    /* Blocking reload: the server holds the request until the next
+     * segment is published, so we get it as soon as it exists */
+    if(b_canBlockReload)
+    {
+        ss << sep << "_HLS_msn=" << nextSequenceNumber;
+        sep = '&';
+    }
+
+    /* Delta update: only the segments we do not have yet, which requires
+     * our copy to be younger than half the skip boundary */
+    if(skipUntil && !updateFailureCount &&
+       vlc_tick_now() - lastUpdateTime < skipUntil / 2)
+        ss << sep << "_HLS_skip=YES";
+
+    return url.append(ss.str());
+}
+
 void HLSRepresentation::debug(vlc_object_t *obj, int indent) const
 {
     BaseRepresentation::debug(obj, indent);
@@ -140,6 +177,18 @@ bool HLSRepresentation::needsUpdate(uint64_t number) const
                             : VLC_TICK_FROM_SEC(2);
         if(updateFailureCount)
             duration /= 2;
+
+        if(b_canBlockReload && !updateFailureCount)
+        {
+            /* The reload returns only once the next segment is available:
+             * only issue it when there is nothing left to fetch */
+            if(elapsed < (partTarget ? partTarget : duration / 4))
+                return false;
+            if(number == std::numeric_limits<uint64_t>::max())
+                return elapsed >= duration;
+            return getMinAheadTime(number) == 0;
+        }
+
         if(elapsed < duration)
             return false;
 
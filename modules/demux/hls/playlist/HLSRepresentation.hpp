@@ -45,7 +45,9 @@ namespace hls
 
                 void setPlaylistUrl(const std::string &);
                 Url getPlaylistUrl() const;
+                std::string getPlaylistUpdateUrl() const;
                 bool isLive() const;
+                bool isLowLatency() const;
                 bool initialized() const;
                 virtual void scheduleNextUpdate(uint64_t, bool) override;
                 virtual bool needsUpdate(uint64_t) const override;
@@ -57,6 +59,10 @@ namespace hls
 
             protected:
                 time_t targetDuration;
+                vlc_tick_t partTarget;
+                bool b_canBlockReload;
+                vlc_tick_t skipUntil;
+                uint64_t nextSequenceNumber;
                 Url playlistUrl;
 
             private:
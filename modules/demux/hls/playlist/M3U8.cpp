@@ -67,3 +67,22 @@ bool M3U8::isLive() const
     return b_live;
 }
 
+bool M3U8::isLowLatency() const
+{
+    std::vector<BasePeriod *>::const_iterator itp;
+    for(itp = periods.begin(); itp != periods.end(); ++itp)
+    {
+        const std::vector<BaseAdaptationSet *> &sets = (*itp)->getAdaptationSets();
+        for(auto ita = sets.cbegin(); ita != sets.cend(); ++ita)
+        {
+            const std::vector<BaseRepresentation *> &reps = (*ita)->getRepresentations();
+            for(auto itr = reps.cbegin(); itr != reps.cend(); ++itr)
+            {
+                const HLSRepresentation *rep = dynamic_cast<const HLSRepresentation *>(*itr);
+                if(rep->initialized() && rep->isLowLatency())
+                    return true;
+            }
+        }
+    }
+    return false;
+}
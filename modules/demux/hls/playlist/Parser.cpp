@@ -162,25 +162,31 @@ void M3U8Parser::createAndFillRepresentation(vlc_object_t *p_obj, BaseAdaptation
 
 bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresentation *rep)
 {
-    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUrl().toString());
+    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUpdateUrl());
     if(p_block)
     {
+        bool b_ret = true;
         stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
         if(substream)
         {
-            std::list<Tag *> tagslist = parseEntries(substream);
+            b_ret = appendSegmentsFromStream(p_obj, rep, substream);
             vlc_stream_Delete(substream);
-
-            parseSegments(p_obj, rep, tagslist);
-
-            releaseTagsList(tagslist);
         }
         block_Release(p_block);
-        return true;
+        return b_ret;
     }
     return false;
 }
 
+bool M3U8Parser::appendSegmentsFromStream(vlc_object_t *p_obj, HLSRepresentation *rep,
+                                          stream_t *p_stream)
+{
+    std::list<Tag *> tagslist = parseEntries(p_stream);
+    bool b_ret = parseSegments(p_obj, rep, tagslist);
+    releaseTagsList(tagslist);
+    return b_ret;
+}
+
 static bool parseEncryption(const AttributesTag *keytag, const Url &playlistUrl,
                             CommonEncryption &encryption)
 {
@@ -216,7 +222,7 @@ static bool parseEncryption(const AttributesTag *keytag, const Url &playlistUrl,
     }
 }
 
-void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std::list<Tag *> &tagslist)
+bool M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std::list<Tag *> &tagslist)
 {
     bool b_pdt = tagslist.cend() != std::find_if(tagslist.cbegin(), tagslist.cend(),
                     [](const Tag *t){return t->getType() == SingleValueTag::EXTXPROGRAMDATETIME;});
@@ -228,6 +234,9 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
     rep->addAttribute(new TimescaleAttr(timescale));
     rep->b_loaded = true;
     rep->b_live = !b_vod;
+    rep->b_canBlockReload = false;
+    rep->partTarget = 0;
+    rep->skipUntil = 0;
 
     vlc_tick_t totalduration = 0;
     vlc_tick_t nzStartTime = 0;
@@ -384,11 +393,94 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                 discontinuitySequence++;
                 break;
 
+            case AttributesTag::EXTXSERVERCONTROL:
+            {
+                const Attribute *attr = static_cast<const AttributesTag *>(tag)->
+                                        getAttributeByName("CAN-BLOCK-RELOAD");
+                rep->b_canBlockReload = attr && attr->value == "YES";
+                attr = static_cast<const AttributesTag *>(tag)->getAttributeByName("CAN-SKIP-UNTIL");
+                if(attr)
+                    rep->skipUntil = vlc_tick_from_sec(attr->floatingPoint());
+            }
+            break;
+
+            case AttributesTag::EXTXSKIP:
+            {
+                /* Delta update: the skipped segments are the ones we already have */
+                const Attribute *attr = static_cast<const AttributesTag *>(tag)->
+                                        getAttributeByName("SKIPPED-SEGMENTS");
+                uint64_t skipped = attr ? attr->decimal() : 0;
+                const SegmentList *prevList = rep->inheritSegmentList();
+                std::vector<Segment *>::const_iterator sit;
+                if(prevList)
+                {
+                    const std::vector<Segment *> &prevsegs = prevList->getSegments();
+                    sit = std::lower_bound(prevsegs.cbegin(), prevsegs.cend(), sequenceNumber,
+                                           [](const Segment *s, uint64_t n) {
+                                                return s->getSequenceNumber() < n; });
+                    if(skipped > (uint64_t) std::distance(sit, prevsegs.cend()) ||
+                       (skipped && (*sit)->getSequenceNumber() != sequenceNumber))
+                        prevList = nullptr;
+                }
+                if(skipped && !prevList)
+                {
+                    for(HLSSegment *seg : segmentstoappend)
+                        delete seg;
+                    delete segmentList;
+                    /* next reload will need the full playlist */
+                    rep->skipUntil = 0;
+                    return false;
+                }
+
+                for(uint64_t i = 0; i < skipped; i++, ++sit)
+                {
+                    const HLSSegment *prev = static_cast<const HLSSegment *>(*sit);
+                    HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
+                    if(!segment)
+                        continue;
+                    segment->sourceUrl = prev->sourceUrl;
+                    segment->startByte = prev->startByte;
+                    segment->endByte = prev->endByte;
+                    segment->encryption = prev->encryption;
+                    segment->discontinuity = prev->discontinuity;
+                    discontinuitySequence = prev->getDiscontinuitySequenceNumber();
+                    segment->setDiscontinuitySequenceNumber(discontinuitySequence);
+                    encryption = prev->encryption;
+                    if(prev->endByte)
+                        prevbyterangeoffset = prev->endByte + 1;
+
+                    const vlc_tick_t nzDuration = timescale.ToTime(prev->duration.Get());
+                    segment->duration.Set(prev->duration.Get());
+                    segment->startTime.Set(timescale.ToScaled(nzStartTime));
+                    nzStartTime += nzDuration;
+                    totalduration += nzDuration;
+                    if(prev->getDisplayTime() != VLC_TICK_INVALID)
+                    {
+                        segment->setDisplayTime(prev->getDisplayTime());
+                        absReferenceTime = prev->getDisplayTime() + nzDuration;
+                    }
+
+                    segmentstoappend.push_back(segment);
+                }
+            }
+            break;
+
+            case AttributesTag::EXTXPARTINF:
+            {
+                const Attribute *attr = static_cast<const AttributesTag *>(tag)->
+                                        getAttributeByName("PART-TARGET");
+                if(attr)
+                    rep->partTarget = vlc_tick_from_sec(attr->floatingPoint());
+            }
+            break;
+
             case Tag::EXTXENDLIST:
                 break;
         }
     }
 
+    rep->nextSequenceNumber = sequenceNumber;
+
     for(HLSSegment *seg : segmentstoappend)
         segmentList->addSegment(seg);
     segmentstoappend.clear();
@@ -403,6 +495,8 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
     }
 
     rep->updateSegmentList(segmentList, true);
+
+    return true;
 }
 M3U8 * M3U8Parser::parse(vlc_object_t *p_object, stream_t *p_stream, const std::string &playlisturl)
 {
@@ -60,12 +60,13 @@ namespace hls
 
                 M3U8 *             parse  (vlc_object_t *p_obj, stream_t *p_stream, const std::string &);
                 bool appendSegmentsFromPlaylistURI(vlc_object_t *, HLSRepresentation *);
+                bool appendSegmentsFromStream(vlc_object_t *, HLSRepresentation *, stream_t *);
 
             private:
                 HLSRepresentation * createRepresentation(BaseAdaptationSet *, const AttributesTag *);
                 void createAndFillRepresentation(vlc_object_t *, BaseAdaptationSet *,
                                                  const AttributesTag *, const std::list<Tag *>&);
-                void parseSegments(vlc_object_t *, HLSRepresentation *, const std::list<Tag *>&);
+                bool parseSegments(vlc_object_t *, HLSRepresentation *, const std::list<Tag *>&);
                 std::list<Tag *> parseEntries(stream_t *);
                 adaptive::SharedResources *resources;
         };
@@ -27,6 +27,9 @@
 #include "util.hpp"
 #include "Ebml_parser.hpp"
 #include "Ebml_dispatcher.hpp"
+#include "stream_io_callback.hpp"
+
+#include <vlc_interrupt.h>
 
 #include <new>
 #include <iterator>
@@ -34,6 +37,19 @@
 
 namespace mkv {
 
+struct matroska_segment_c::cues_prefetch_t
+{
+    matroska_segment_c *p_segment;
+    vlc_thread_t       thread;
+    vlc_interrupt_t    *p_interrupt;
+    char               *psz_url;
+    uint64_t           i_size;
+    int64_t            i_position;
+
+    bool               b_loaded;
+    SegmentSeeker      seeker;
+};
+
 matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estream, KaxSegment *p_seg )
     :segment(p_seg)
     ,es(estream)
@@ -53,6 +69,7 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
     ,p_prev_segment_uid(NULL)
     ,p_next_segment_uid(NULL)
     ,b_cues(false)
+    ,p_cues_prefetch(NULL)
     ,psz_muxing_application(NULL)
     ,psz_writing_application(NULL)
     ,psz_segment_filename(NULL)
@@ -64,10 +81,20 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
     ,b_preloaded(false)
     ,b_ref_external_segments(false)
 {
+    block_frames.i_count = 0;
 }
 
 matroska_segment_c::~matroska_segment_c()
 {
+    if( p_cues_prefetch )
+    {
+        vlc_interrupt_kill( p_cues_prefetch->p_interrupt );
+        vlc_join( p_cues_prefetch->thread, NULL );
+        vlc_interrupt_destroy( p_cues_prefetch->p_interrupt );
+        free( p_cues_prefetch->psz_url );
+        delete p_cues_prefetch;
+    }
+
     free( psz_writing_application );
     free( psz_muxing_application );
     free( psz_segment_filename );
@@ -89,20 +116,29 @@ matroska_segment_c::~matroska_segment_c()
  * Tools                                                                     *
  *****************************************************************************
  *  * LoadCues : load the cues element and update index
+ *  * PrefetchCues : load the cues element in the background
  *  * LoadTags : load ... the tags element
  *  * InformationCreate : create all information, load tags if present
  *****************************************************************************/
 void matroska_segment_c::LoadCues( KaxCues *cues )
 {
-    EbmlElement *el;
-
     if( b_cues )
     {
         msg_Warn( &sys.demuxer, "There can be only 1 Cues per section." );
         return;
     }
 
-    EbmlParser eparser (&es, cues, &sys.demuxer );
+    ParseCues( cues, es, _seeker );
+    b_cues = true;
+    msg_Dbg( &sys.demuxer, "|   - loading cues done." );
+}
+
+/* Only reads the segment tracks and properties: can run on any thread */
+void matroska_segment_c::ParseCues( KaxCues *cues, EbmlStream & stream, SegmentSeeker & seeker )
+{
+    EbmlElement *el;
+
+    EbmlParser eparser (&stream, cues, &sys.demuxer );
     while( ( el = eparser.Get() ) != NULL )
     {
         if( MKV_IS_ID( el, KaxCuePoint ) )
@@ -126,7 +162,7 @@ void matroska_segment_c::LoadCues( KaxCues *cues )
                             b_invalid_cue = true;
                             break;
                         }
-                        cuetime->ReadData( es.I_O() );
+                        cuetime->ReadData( stream.I_O() );
                     }
                     catch(...)
                     {
@@ -153,15 +189,15 @@ void matroska_segment_c::LoadCues( KaxCues *cues )
 
                             if( MKV_CHECKED_PTR_DECL ( kct_ptr, KaxCueTrack, el ) )
                             {
-                                kct_ptr->ReadData( es.I_O() );
+                                kct_ptr->ReadData( stream.I_O() );
                                 track_id = static_cast<uint16>( *kct_ptr );
                             }
                             else if( MKV_CHECKED_PTR_DECL ( kccp_ptr, KaxCueClusterPosition, el ) )
                             {
-                                kccp_ptr->ReadData( es.I_O() );
+                                kccp_ptr->ReadData( stream.I_O() );
                                 cue_position = segment->GetGlobalPosition( static_cast<uint64>( *kccp_ptr ) );
 
-                                _seeker.add_cluster_position( cue_position );
+                                seeker.add_cluster_position( cue_position );
                             }
                             else if( MKV_CHECKED_PTR_DECL ( kcbn_ptr, KaxCueBlockNumber, el ) )
                             {
@@ -171,22 +207,22 @@ void matroska_segment_c::LoadCues( KaxCues *cues )
                             else if( MKV_CHECKED_PTR_DECL( cuerelative, KaxCueRelativePosition, el ) )
                             {
                                 // IGNORE
-                                cuerelative->ReadData( es.I_O() );
+                                cuerelative->ReadData( stream.I_O() );
                             }
                             else if( MKV_CHECKED_PTR_DECL( cueblock, KaxCueBlockNumber, el ) )
                             {
                                 // IGNORE
-                                cueblock->ReadData( es.I_O() );
+                                cueblock->ReadData( stream.I_O() );
                             }
                             else if( MKV_CHECKED_PTR_DECL( cueref, KaxCueReference, el ) )
                             {
                                 // IGNORE
-                                cueref->ReadData( es.I_O(), SCOPE_ALL_DATA );
+                                cueref->ReadData( stream.I_O(), SCOPE_ALL_DATA );
                             }
                             else if( MKV_CHECKED_PTR_DECL( cueduration, KaxCueDuration, el ) )
                             {
                                 /* For future use */
-                                cueduration->ReadData( es.I_O() );
+                                cueduration->ReadData( stream.I_O() );
                             }
 #endif
                             else
@@ -222,7 +258,7 @@ void matroska_segment_c::LoadCues( KaxCues *cues )
                             SegmentSeeker::Seekpoint::QUESTIONABLE;
                 }
 
-                _seeker.add_seekpoint( track_id,
+                seeker.add_seekpoint( track_id,
                     SegmentSeeker::Seekpoint( cue_position, cue_mk_time, level ) );
             }
         }
@@ -231,8 +267,115 @@ void matroska_segment_c::LoadCues( KaxCues *cues )
             msg_Dbg( &sys.demuxer, " * Unknown (%s)", typeid(*el).name() );
         }
     }
-    b_cues = true;
-    msg_Dbg( &sys.demuxer, "|   - loading cues done." );
+}
+
+
+void *matroska_segment_c::PrefetchCuesThread( void *data )
+{
+    cues_prefetch_t *p_prefetch = static_cast<cues_prefetch_t *>( data );
+    matroska_segment_c *p_segment = p_prefetch->p_segment;
+    demux_t *p_demux = &p_segment->sys.demuxer;
+
+    vlc_interrupt_set( p_prefetch->p_interrupt );
+
+    stream_t *s = vlc_stream_NewURL( p_demux, p_prefetch->psz_url );
+    if( s == NULL )
+        return NULL;
+
+    /* Make sure we did not open some outer container */
+    uint64_t i_size;
+    if( vlc_stream_GetSize( s, &i_size ) || i_size != p_prefetch->i_size )
+    {
+        vlc_stream_Delete( s );
+        return NULL;
+    }
+
+    vlc_stream_io_callback io_callback( s, true );
+    EbmlStream estream( io_callback );
+
+    try
+    {
+        io_callback.setFilePointer( p_prefetch->i_position, seek_beginning );
+        EbmlElement *el = estream.FindNextID( EBML_INFO(KaxCues), 0xFFFFFFFFL );
+        if( MKV_CHECKED_PTR_DECL ( kc_ptr, KaxCues, el ) )
+        {
+            p_segment->ParseCues( kc_ptr, estream, p_prefetch->seeker );
+            p_prefetch->b_loaded = !vlc_killed();
+        }
+        delete el;
+    }
+    catch(...)
+    {
+        msg_Err( p_demux, "Error while prefetching cues" );
+    }
+
+    return NULL;
+}
+
+/* Reads the cues on another stream, so that opening won't wait for that
+ * read far away in the file, usually at the end */
+bool matroska_segment_c::PrefetchCues( int64_t i_element_position )
+{
+    if( i_cues_position >= 0 || p_cues_prefetch )
+        return false;
+
+    stream_t *s = static_cast<vlc_stream_io_callback &>( es.I_O() ).GetStream();
+    uint64_t i_size;
+    if( s->psz_url == NULL || vlc_stream_GetSize( s, &i_size ) )
+        return false;
+
+    cues_prefetch_t *p_prefetch = new (std::nothrow) cues_prefetch_t;
+    if( p_prefetch == NULL )
+        return false;
+
+    p_prefetch->p_segment = this;
+    p_prefetch->i_size = i_size;
+    p_prefetch->i_position = i_element_position;
+    p_prefetch->b_loaded = false;
+    p_prefetch->psz_url = strdup( s->psz_url );
+    p_prefetch->p_interrupt = vlc_interrupt_create();
+    if( p_prefetch->psz_url == NULL || p_prefetch->p_interrupt == NULL ||
+        vlc_clone( &p_prefetch->thread, PrefetchCuesThread, p_prefetch,
+                   VLC_THREAD_PRIORITY_LOW ) )
+    {
+        if( p_prefetch->p_interrupt )
+            vlc_interrupt_destroy( p_prefetch->p_interrupt );
+        free( p_prefetch->psz_url );
+        delete p_prefetch;
+        return false;
+    }
+
+    msg_Dbg( &sys.demuxer, "|   - prefetching cues" );
+    p_cues_prefetch = p_prefetch;
+    i_cues_position = i_element_position;
+    return true;
+}
+
+/* Waits for the prefetched cues, loading them here if it failed */
+void matroska_segment_c::WaitCues()
+{
+    cues_prefetch_t *p_prefetch = p_cues_prefetch;
+    if( p_prefetch == NULL )
+        return;
+
+    vlc_join( p_prefetch->thread, NULL );
+    vlc_interrupt_destroy( p_prefetch->p_interrupt );
+    p_cues_prefetch = NULL;
+
+    if( p_prefetch->b_loaded )
+    {
+        _seeker.merge( p_prefetch->seeker );
+        b_cues = true;
+        msg_Dbg( &sys.demuxer, "|   - loading cues done." );
+    }
+    else
+    {
+        i_cues_position = -1;
+        LoadSeekHeadItem( EBML_INFO(KaxCues), p_prefetch->i_position );
+    }
+
+    free( p_prefetch->psz_url );
+    delete p_prefetch;
 }
 
 
@@ -838,6 +981,8 @@ bool matroska_segment_c::Seek( demux_t &demuxer, vlc_tick_t i_absolute_mk_date,
 
     // find appropriate seekpoints //
 
+    WaitCues();
+
     try {
         seekpoints = _seeker.get_seekpoints( *this, i_mk_date, priority, selected_tracks );
     }
@@ -1173,6 +1318,109 @@ void matroska_segment_c::ESDestroy( )
     }
 }
 
+static bool ReadVint( const uint8_t *p, size_t i_peek, size_t *pi, bool b_signed, int64_t *pi_value )
+{
+    if( *pi >= i_peek || p[*pi] == 0 )
+        return false;
+
+    unsigned i_len = 1;
+    while( !(p[*pi] & (0x80 >> (i_len - 1))) )
+        i_len++;
+    if( *pi + i_len > i_peek )
+        return false;
+
+    uint64_t i_value = p[*pi] & (0xFF >> i_len);
+    for( unsigned j = 1; j < i_len; j++ )
+        i_value = (i_value << 8) | p[*pi + j];
+    *pi += i_len;
+
+    if( b_signed )
+        *pi_value = (int64_t)i_value - ((INT64_C(1) << (7 * i_len - 1)) - 1);
+    else
+        *pi_value = i_value;
+    return true;
+}
+
+/* Locates the frames of a SimpleBlock from its header and lacing, which are
+ * peeked from the stream: nothing is allocated, and the stream stays at the
+ * start of the block data */
+bool matroska_segment_c::ParseBlockFrames( KaxSimpleBlock & sblock )
+{
+    block_frames.i_count = 0;
+
+    const uint64_t i_size = sblock.GetSize();
+    if( !sblock.IsFiniteSize() || i_size < 4 || i_size > UINT32_MAX )
+        return false;
+
+    stream_t *s = static_cast<vlc_stream_io_callback &>( es.I_O() ).GetStream();
+    const uint8_t *p_peek;
+    const ssize_t i_peek = vlc_stream_Peek( s, &p_peek, __MIN( i_size, 4096 ) );
+    if( i_peek < 4 )
+        return false;
+
+    size_t i = 0;
+    int64_t i_value;
+    if( !ReadVint( p_peek, i_peek, &i, false, &i_value ) || i + 3 > (size_t)i_peek )
+        return false; /* track number */
+    i += 2; /* timecode */
+    const uint8_t i_flags = p_peek[i++];
+
+    unsigned i_count = 1;
+    uint64_t i_laced = 0;
+    const unsigned i_lacing = (i_flags >> 1) & 0x03;
+    if( i_lacing != 0 )
+    {
+        if( i >= (size_t)i_peek )
+            return false;
+        i_count = p_peek[i++] + 1;
+
+        for( unsigned k = 0; k + 1 < i_count && i_lacing != 2 /* fixed */; k++ )
+        {
+            int64_t i_frame = 0;
+            if( i_lacing == 1 ) /* Xiph */
+            {
+                uint8_t i_byte;
+                do
+                {
+                    if( i >= (size_t)i_peek )
+                        return false;
+                    i_byte = p_peek[i++];
+                    i_frame += i_byte;
+                } while( i_byte == 0xFF );
+            }
+            else /* EBML */
+            {
+                if( !ReadVint( p_peek, i_peek, &i, k > 0, &i_value ) )
+                    return false;
+                i_frame = k > 0 ? block_frames.i_size[k - 1] + i_value : i_value;
+            }
+
+            if( i_frame < 0 || (uint64_t)i_frame > i_size )
+                return false;
+            block_frames.i_size[k] = i_frame;
+            i_laced += i_frame;
+        }
+    }
+
+    if( i > i_size || i_laced > i_size - i )
+        return false;
+    const uint64_t i_payload = i_size - i;
+
+    if( i_lacing == 2 )
+    {
+        if( i_payload % i_count )
+            return false;
+        for( unsigned k = 0; k < i_count; k++ )
+            block_frames.i_size[k] = i_payload / i_count;
+    }
+    else
+        block_frames.i_size[i_count - 1] = i_payload - i_laced;
+
+    block_frames.i_pos = es.I_O().getFilePointer() + i;
+    block_frames.i_count = i_count;
+    return true;
+}
+
 int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_simpleblock,
                                   KaxBlockAdditions * & pp_additions,
                                   bool *pb_key_picture, bool *pb_discardable_picture,
@@ -1256,7 +1504,16 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
             }
 
             vars.simpleblock = &ksblock;
-            vars.simpleblock->ReadData( vars.obj->es.I_O() );
+            /* when the frames can be located, only the header is read: the
+             * payload is read later into the blocks of the selected tracks */
+            if( vars.obj->ParseBlockFrames( ksblock ) )
+            {
+                /* the partial read needs the cluster timecode */
+                vars.simpleblock->SetParent( *vars.obj->cluster );
+                vars.simpleblock->ReadData( vars.obj->es.I_O(), SCOPE_PARTIAL_DATA );
+            }
+            else
+                vars.simpleblock->ReadData( vars.obj->es.I_O() );
             vars.simpleblock->SetParent( *vars.obj->cluster );
 
             if( ksblock.IsKeyframe() )
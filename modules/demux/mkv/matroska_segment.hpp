@@ -117,6 +117,10 @@ public:
 
     bool                    b_cues;
 
+    /* cues being read in the background, on another stream */
+    struct cues_prefetch_t;
+    cues_prefetch_t         *p_cues_prefetch;
+
     /* info */
     char                    *psz_muxing_application;
     char                    *psz_writing_application;
@@ -149,6 +153,17 @@ public:
     int BlockGet( KaxBlock * &, KaxSimpleBlock * &, KaxBlockAdditions * &,
                   bool *, bool *, int64_t *);
 
+    /* Frames of the last SimpleBlock, when its payload was left in the
+     * stream to be read straight into the block_t */
+    struct block_frames_t
+    {
+        uint64_t i_pos;          /* position of the first frame */
+        unsigned i_count;        /* 0 if the payload was read by libmatroska */
+        uint32_t i_size[256];
+    };
+    block_frames_t block_frames;
+    bool ParseBlockFrames( KaxSimpleBlock & );
+
     mkv_track_t * FindTrackByBlock(const KaxBlock *, const KaxSimpleBlock * );
 
     bool ESCreate( );
@@ -160,6 +175,10 @@ public:
 
 private:
     void LoadCues( KaxCues *cues );
+    void ParseCues( KaxCues *cues, EbmlStream &, SegmentSeeker & );
+    bool PrefetchCues( int64_t i_element_position );
+    void WaitCues();
+    static void *PrefetchCuesThread( void * );
     void LoadTags( KaxTags *tags );
     bool LoadSeekHeadItem( const EbmlCallbacks & ClassInfos, int64_t i_element_position );
     void ParseInfo( KaxInfo *info );
@@ -152,7 +152,9 @@ void matroska_segment_c::ParseSeekHead( KaxSeekHead *seekhead )
                 else if( id == EBML_ID(KaxCues) )
                 {
                     msg_Dbg( &sys.demuxer, "|   - cues at %" PRId64, i_pos );
-                    LoadSeekHeadItem( EBML_INFO(KaxCues), i_pos );
+                    /* don't wait for a distant read on slow streams */
+                    if( sys.b_fastseekable || !sys.b_seekable || !PrefetchCues( i_pos ) )
+                        LoadSeekHeadItem( EBML_INFO(KaxCues), i_pos );
                 }
                 else if( id == EBML_ID(KaxInfo) )
                 {
@@ -112,6 +112,24 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
     return it;
 }
 
+void
+SegmentSeeker::merge( SegmentSeeker const& other )
+{
+    for( tracks_seekpoints_t::const_iterator it = other._tracks_seekpoints.begin();
+         it != other._tracks_seekpoints.end(); ++it )
+    {
+        for( seekpoints_t::const_iterator sp = it->second.begin(); sp != it->second.end(); ++sp )
+            add_seekpoint( it->first, *sp );
+    }
+
+    for( cluster_positions_t::const_iterator it = other._cluster_positions.begin();
+         it != other._cluster_positions.end(); ++it )
+    {
+        if( !std::binary_search( _cluster_positions.begin(), _cluster_positions.end(), *it ) )
+            add_cluster_position( *it );
+    }
+}
+
 void
 SegmentSeeker::add_seekpoint( track_id_t track_id, Seekpoint sp )
 {
@@ -100,6 +100,7 @@ class SegmentSeeker
         typedef std::pair<Seekpoint, Seekpoint> seekpoint_pair_t;
 
         void add_seekpoint( track_id_t, Seekpoint );
+        void merge( SegmentSeeker const& );
 
         seekpoint_pair_t get_seekpoints_around( vlc_tick_t, seekpoints_t const& );
         Seekpoint get_first_seekpoint_around( vlc_tick_t, seekpoints_t const&, Seekpoint::TrustLevel = Seekpoint::TRUSTED );
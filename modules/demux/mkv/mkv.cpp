@@ -574,29 +574,61 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
 
     size_t frame_size = 0;
     size_t block_size = internal_block.GetSize();
-    const unsigned i_number_frames = internal_block.NumberFrames();
+
+    /* SimpleBlock payloads are usually still in the stream */
+    const matroska_segment_c::block_frames_t *p_frames =
+        simpleblock && p_segment->block_frames.i_count ? &p_segment->block_frames : NULL;
+    const unsigned i_number_frames = p_frames ? p_frames->i_count : internal_block.NumberFrames();
+    uint64_t i_frame_pos = p_frames ? p_frames->i_pos : 0;
 
     for( unsigned int i_frame = 0; i_frame < i_number_frames; i_frame++ )
     {
         block_t *p_block;
-        DataBuffer *data = &internal_block.GetBuffer(i_frame);
+        size_t extra_data = track.fmt.i_codec == VLC_CODEC_PRORES ? 8 : 0;
 
-        frame_size += data->Size();
-        if( !data->Buffer() || data->Size() > frame_size || frame_size > block_size  )
+        if( p_frames )
         {
-            msg_Warn( p_demux, "Cannot read frame (too long or no frame)" );
-            break;
+            const size_t i_size = p_frames->i_size[i_frame];
+            IOCallback & io = p_segment->es.I_O();
+
+            if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
+                track.p_compression_data != NULL &&
+                track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
+                p_block = ReadToBlock( io, i_frame_pos, i_size, track.p_compression_data->GetSize() + extra_data );
+            else if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
+            {
+                p_block = ReadToBlock( io, i_frame_pos, i_size, 0 );
+                if( p_block != NULL )
+                {
+                    block_t *p_raw = p_block;
+                    p_block = packetize_wavpack( track, p_raw->p_buffer, p_raw->i_buffer );
+                    block_Release( p_raw );
+                }
+            }
+            else
+                p_block = ReadToBlock( io, i_frame_pos, i_size, extra_data );
+            i_frame_pos += i_size;
         }
-        size_t extra_data = track.fmt.i_codec == VLC_CODEC_PRORES ? 8 : 0;
-
-        if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
-            track.p_compression_data != NULL &&
-            track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
-            p_block = MemToBlock( data->Buffer(), data->Size(), track.p_compression_data->GetSize() + extra_data );
-        else if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
-            p_block = packetize_wavpack( track, data->Buffer(), data->Size() );
         else
-            p_block = MemToBlock( data->Buffer(), data->Size(), extra_data );
+        {
+            DataBuffer *data = &internal_block.GetBuffer(i_frame);
+
+            frame_size += data->Size();
+            if( !data->Buffer() || data->Size() > frame_size || frame_size > block_size  )
+            {
+                msg_Warn( p_demux, "Cannot read frame (too long or no frame)" );
+                break;
+            }
+
+            if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
+                track.p_compression_data != NULL &&
+                track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
+                p_block = MemToBlock( data->Buffer(), data->Size(), track.p_compression_data->GetSize() + extra_data );
+            else if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
+                p_block = packetize_wavpack( track, data->Buffer(), data->Size() );
+            else
+                p_block = MemToBlock( data->Buffer(), data->Size(), extra_data );
+        }
 
         if( p_block == NULL )
         {
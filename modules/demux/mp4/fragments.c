@@ -36,7 +36,9 @@ void MP4_Fragments_Index_Delete( mp4_fragments_index_t *p_index )
 
 mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_num )
 {
-    if( !i_tracks || !i_num || SIZE_MAX / i_num < i_tracks )
+    if( !i_num )
+        i_num = 64;
+    if( !i_tracks || SIZE_MAX / i_num < i_tracks )
         return NULL;
     mp4_fragments_index_t *p_index = malloc( sizeof(*p_index) );
     if( p_index )
@@ -48,13 +50,43 @@ mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_n
             MP4_Fragments_Index_Delete( p_index );
             return NULL;
         }
-        p_index->i_entries = i_num;
+        p_index->i_entries = 0;
+        p_index->i_alloc = i_num;
         p_index->i_last_time = 0;
         p_index->i_tracks = i_tracks;
     }
     return p_index;
 }
 
+int MP4_Fragments_Index_Append( mp4_fragments_index_t *p_index, uint64_t i_pos,
+                                const stime_t *p_times )
+{
+    if( p_index->i_entries == p_index->i_alloc )
+    {
+        if( p_index->i_alloc > UINT_MAX / 2 ||
+            SIZE_MAX / p_index->i_tracks / 2 < p_index->i_alloc )
+            return VLC_ENOMEM;
+        const unsigned i_alloc = p_index->i_alloc * 2;
+
+        uint64_t *pi_pos = realloc( p_index->pi_pos, sizeof(*pi_pos) * i_alloc );
+        if( !pi_pos )
+            return VLC_ENOMEM;
+        p_index->pi_pos = pi_pos;
+
+        stime_t *p_newtimes = realloc( p_index->p_times,
+                                       sizeof(*p_newtimes) * i_alloc * p_index->i_tracks );
+        if( !p_newtimes )
+            return VLC_ENOMEM;
+        p_index->p_times = p_newtimes;
+        p_index->i_alloc = i_alloc;
+    }
+
+    memcpy( &p_index->p_times[(size_t)p_index->i_entries * p_index->i_tracks],
+            p_times, sizeof(*p_times) * p_index->i_tracks );
+    p_index->pi_pos[p_index->i_entries++] = i_pos;
+    return VLC_SUCCESS;
+}
+
 stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
                                               unsigned i_track_index, uint64_t i_moof_pos )
 {
@@ -68,6 +100,8 @@ stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
 
 stime_t MP4_Fragment_Index_GetTrackDuration( mp4_fragments_index_t *p_index, unsigned i )
 {
+    if( p_index->i_entries == 0 )
+        return 0;
     return p_index->p_times[(size_t)(p_index->i_entries - 1) * p_index->i_tracks + i];
 }
 
@@ -37,6 +37,7 @@
 #include <vlc_url.h>
 #include <assert.h>
 #include <limits.h>
+#include <stdatomic.h>
 #include "attachments.h"
 #include "heif.h"
 #include "../../codec/cc.h"
@@ -96,6 +97,21 @@ static int   DemuxRef( demux_t *p_demux ){ (void)p_demux; return 0;}
 static int   DemuxFrag( demux_t * );
 static int   Control ( demux_t *, int, va_list );
 
+/* Builds the moof index on its own stream while the file is played */
+typedef struct
+{
+    vlc_thread_t thread;
+    stream_t    *s;
+    uint64_t     i_start;
+
+    vlc_mutex_t  lock;         /* protects the fragments index */
+    vlc_cond_t   wait;         /* signaled on each new entry */
+    bool         b_done;
+    atomic_bool  b_quit;
+
+    stime_t      i_last_reported; /* only used by the demux thread */
+} mp4_fragindexer_t;
+
 typedef struct
 {
     MP4_Box_t    *p_root;      /* container for the whole file */
@@ -146,6 +162,7 @@ typedef struct
     } hacks;
 
     mp4_fragments_index_t *p_fragsindex;
+    mp4_fragindexer_t     *p_indexer; /* background indexing, can be NULL */
 
     ssize_t i_attachments;
     input_attachment_t **pp_attachments;
@@ -190,6 +207,10 @@ static stime_t GetMoovTrackDuration( demux_sys_t *p_sys, unsigned i_track_ID );
 
 static int  ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented );
 static int  ProbeFragmentsChecked( demux_t *p_demux );
+static void FragIndexLock( demux_sys_t *p_sys, stime_t i_time, uint64_t i_pos );
+static void FragIndexUnlock( demux_sys_t *p_sys );
+static void FragIndexerDelete( demux_sys_t *p_sys );
+static void FragIndexerUpdateDuration( demux_t *p_demux );
 static int  ProbeIndex( demux_t *p_demux );
 
 static int FragCreateTrunIndex( demux_t *, MP4_Box_t *, MP4_Box_t *, stime_t );
@@ -346,54 +367,6 @@ static es_out_id_t * MP4_CreateES( es_out_t *out, const es_format_t *p_fmt,
     return p_es;
 }
 
-static int MP4_ChunkAllocDtsEntries( mp4_chunk_t *ck )
-{
-    size_t entries = ck->i_entries_dts;
-
-    if( entries <= ARRAY_SIZE(ck->small_dts_buf) / 2 )
-    {
-        ck->p_sample_count_dts = ck->small_dts_buf;
-        ck->p_sample_delta_dts = ck->small_dts_buf + entries;
-        return 0;
-    }
-
-    uint32_t *buf = calloc( entries, sizeof( buf[0] ) * 2 );
-    if( unlikely(buf == NULL) )
-        return VLC_ENOMEM;
-
-    ck->p_sample_count_dts = buf;
-    ck->p_sample_delta_dts = buf + entries;
-    return 0;
-}
-
-static int MP4_ChunkAllocPtsEntries( mp4_chunk_t *ck )
-{
-    size_t entries = ck->i_entries_pts;
-
-    if( entries <= ARRAY_SIZE(ck->small_pts_buf) / 2 )
-    {
-        ck->p_sample_count_pts = ck->small_pts_buf;
-        ck->p_sample_offset_pts = ck->small_pts_buf + entries;
-        return 0;
-    }
-
-    uint32_t *buf = calloc( entries, sizeof( buf[0] ) * 2 );
-    if( unlikely(buf == NULL) )
-        return VLC_ENOMEM;
-
-    ck->p_sample_count_pts = buf;
-    ck->p_sample_offset_pts = buf + entries;
-    return 0;
-}
-
-static void MP4_ChunkDestroy( mp4_chunk_t *ck )
-{
-    if( ck->p_sample_count_dts != ck->small_dts_buf )
-        free( ck->p_sample_count_dts );
-    if( ck->p_sample_count_pts != ck->small_pts_buf )
-        free( ck->p_sample_count_pts );
-}
-
 static const mp4_chunk_t * MP4_TrackChunkForSample( const mp4_track_t *p_track,
                                                     uint32_t i_sample )
 {
@@ -408,42 +381,58 @@ static const mp4_chunk_t * MP4_TrackChunkForSample( const mp4_track_t *p_track,
     return NULL;
 }
 
-static stime_t MP4_ChunkGetSampleDTS( const mp4_chunk_t *p_chunk,
+static stime_t MP4_ChunkGetSampleDTS( const mp4_track_t *p_track,
+                                      const mp4_chunk_t *p_chunk,
                                       uint32_t i_sample )
 {
-    uint32_t i_index = 0;
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    uint32_t i_index = p_chunk->i_stts_entry;
+    uint32_t i_skip = p_chunk->i_stts_skip;
     stime_t sdts = p_chunk->i_first_dts;
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
+
+    if( i_sample > p_chunk->i_sample_count )
+        i_sample = p_chunk->i_sample_count;
+
+    while( i_sample > 0 && i_index < stts->i_entry_count )
     {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
+        const uint32_t i_count = stts->pi_sample_count[i_index] - i_skip;
+        const uint32_t i_delta = stts->pi_sample_delta[i_index];
+
+        if( i_sample > i_count )
         {
-            sdts += (stime_t)p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index++];
+            sdts += (stime_t)i_count * i_delta;
+            i_sample -= i_count;
+            i_index++;
+            i_skip = 0;
         }
         else
         {
-            sdts += (stime_t)i_sample * p_chunk->p_sample_delta_dts[i_index];
+            sdts += (stime_t)i_sample * i_delta;
             break;
         }
     }
     return sdts;
 }
 
-static bool MP4_ChunkGetSampleCTSDelta( const mp4_chunk_t *p_chunk,
+static bool MP4_ChunkGetSampleCTSDelta( const mp4_track_t *p_track,
+                                        const mp4_chunk_t *p_chunk,
                                         uint32_t i_sample, stime_t *pi_delta )
 {
-    if( p_chunk->p_sample_count_pts && p_chunk->p_sample_offset_pts )
+    const MP4_Box_data_ctts_t *ctts = p_track->p_ctts;
+
+    if( !ctts || i_sample >= p_chunk->i_sample_count )
+        return false;
+
+    i_sample += p_chunk->i_ctts_skip;
+    for( uint32_t i_index = p_chunk->i_ctts_entry; i_index < ctts->i_entry_count; i_index++ )
     {
-        for( uint32_t i_index = 0; i_index < p_chunk->i_entries_pts ; i_index++ )
+        if( i_sample < ctts->pi_sample_count[i_index] )
         {
-            if( i_sample < p_chunk->p_sample_count_pts[i_index] )
-            {
-                *pi_delta = p_chunk->p_sample_offset_pts[i_index];
-                return true;
-            }
-            i_sample -= p_chunk->p_sample_count_pts[i_index];
+            int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + p_track->i_cts_shift;
+            *pi_delta = i_ctsdelta < 0 ? 0 /* should not */ : i_ctsdelta;
+            return true;
         }
+        i_sample -= ctts->pi_sample_count[i_index];
     }
     return false;
 }
@@ -499,43 +488,10 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
     VLC_UNUSED( p_demux );
 
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    stime_t i_duration = 0;
+    const uint32_t i_first = p_track->i_sample - p_chunk->i_sample_first;
 
-    /* Forward to right index, and set remaining count in that index */
-    unsigned i_index = 0;
-    unsigned i_remain = 0;
-    for( unsigned i = p_chunk->i_sample_first;
-         i<p_track->i_sample && i_index < p_chunk->i_entries_dts; )
-    {
-        if( p_track->i_sample - i >= p_chunk->p_sample_count_dts[i_index] )
-        {
-            i += p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            i_remain = p_track->i_sample - i;
-            break;
-        }
-    }
-
-    /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
-        {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
-            i_index++;
-            i_remain = 0;
-        }
-        else
-        {
-            i_duration += (stime_t)i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
+    stime_t i_duration = MP4_ChunkGetSampleDTS( p_track, p_chunk, i_first + i_nb_samples ) -
+                         MP4_ChunkGetSampleDTS( p_track, p_chunk, i_first );
 
     return MP4_rescale_mtime( i_duration, p_track->i_timescale );
 }
@@ -1953,7 +1909,12 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
         if( p_sys->b_fragments_probed && p_sys->p_fragsindex )
         {
             stime_t i_basetime = MP4_rescale_qtime( i_sync_time, p_sys->i_timescale );
-            if( !MP4_Fragments_Index_Lookup( p_sys->p_fragsindex, &i_basetime, &i64, i_seek_track_index ) )
+            /* Wait for the background indexer to reach that time */
+            FragIndexLock( p_sys, i_basetime, 0 );
+            bool b_found = MP4_Fragments_Index_Lookup( p_sys->p_fragsindex, &i_basetime,
+                                                       &i64, i_seek_track_index );
+            FragIndexUnlock( p_sys );
+            if( !b_found )
             {
                 p_sys->b_error = (vlc_stream_Seek( p_demux->s, i_backup_pos ) != VLC_SUCCESS);
                 return VLC_EGENERIC;
@@ -2249,6 +2210,7 @@ static void Close ( vlc_object_t * p_this )
     msg_Dbg( p_demux, "freeing all memory" );
 
     FragResetContext( p_sys );
+    FragIndexerDelete( p_sys );
 
     MP4_BoxFree( p_sys->p_root );
 
@@ -2453,12 +2415,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
 
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2520,54 +2476,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
-{
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
-    {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_EINVAL;
-        }
-
-        if ( i_index_samples_left )
-        {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
-        }
-        else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
-    }
-
-    return VLC_SUCCESS;
-}
-
 static int TrackCreateSamplesIndex( demux_t *p_demux,
                                     mp4_track_t *p_demux_track )
 {
@@ -2605,18 +2513,9 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, read from the box */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2629,14 +2528,11 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         }
     }
 
-    /* Use stts table to create a sample number -> dts table.
+    /* Use stts table to map sample numbers to dts.
      * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+     *  the box! so each chunk only records where it starts in the
+     *  run-length encoded table (problem with raw stream where a sample
+     *  is sometime just channels*bits_per_sample/8 */
 
     int64_t i_next_dts = 0;
     /* Find stts
@@ -2650,97 +2546,43 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        const MP4_Box_data_stts_t *stts = p_box->data.p_stts;
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
+        p_demux_track->p_stts = stts;
+
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
+            uint32_t i_sample_count = ck->i_sample_count;
 
-            /* save first dts */
+            /* save first dts and table position */
             ck->i_first_dts = i_next_dts;
+            ck->i_stts_entry = i_index;
+            ck->i_stts_skip = i_skip;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocDtsEntries( ck );
-            if( i_ret )
+            while( i_sample_count > 0 && i_index < stts->i_entry_count )
             {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return i_ret;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
+                const uint32_t i_count = __MIN( stts->pi_sample_count[i_index] - i_skip,
+                                                i_sample_count );
+                i_next_dts += (int64_t)i_count * (uint32_t)stts->pi_sample_delta[i_index];
+                i_sample_count -= i_count;
+                i_skip += i_count;
+                if( i_skip == stts->pi_sample_count[i_index] )
                 {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_index++;
+                    i_skip = 0;
                 }
-
             }
+            ck->i_duration = i_next_dts - ck->i_first_dts;
+
+            if( i_sample_count > 0 )
+                msg_Err( p_demux, "invalid index counting total samples %u %u",
+                         i_index, stts->i_entry_count );
         }
     }
 
@@ -2751,7 +2593,7 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "ctts" );
     if( p_box && p_box->data.p_ctts )
     {
-        MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        const MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
@@ -2770,84 +2612,31 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
             }
         }
 
-        /* Create pts-dts table per chunk */
+        p_demux_track->p_ctts = ctts;
+        p_demux_track->i_cts_shift = i_cts_shift;
+
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocPtsEntries( ck );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return i_ret;
-            }
+            uint32_t i_sample_count = ck->i_sample_count;
 
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
+            ck->i_ctts_entry = i_index;
+            ck->i_ctts_skip = i_skip;
 
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
+            while( i_sample_count > 0 && i_index < ctts->i_entry_count )
             {
-                int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                if( i_ctsdelta < 0 ) /* should not */
-                    i_ctsdelta = 0;
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
+                const uint32_t i_count = __MIN( ctts->pi_sample_count[i_index] - i_skip,
+                                                i_sample_count );
+                i_sample_count -= i_count;
+                i_skip += i_count;
+                if( i_skip == ctts->pi_sample_count[i_index] )
                 {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_index++;
+                    i_skip = 0;
                 }
-
-
             }
         }
     }
@@ -3212,29 +3001,29 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
     i_sample = p_track->chunk[i_chunk].i_sample_first;
     i_dts    = p_track->chunk[i_chunk].i_first_dts;
 
-    for( uint_fast32_t i_index = 0;
-         i_index < p_track->chunk[i_chunk].i_entries_dts &&
-         i_sample < p_track->chunk[i_chunk].i_sample_count;
-         i_index++ )
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    uint32_t i_index = p_track->chunk[i_chunk].i_stts_entry;
+    uint32_t i_skip = p_track->chunk[i_chunk].i_stts_skip;
+    uint32_t i_left = p_track->chunk[i_chunk].i_sample_count;
+
+    while( i_left > 0 && i_index < stts->i_entry_count )
     {
-        if( i_dts +
-            (uint64_t)p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
-        {
-            i_dts    +=
-                (uint64_t)p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+        const uint32_t i_count = __MIN( stts->pi_sample_count[i_index] - i_skip, i_left );
+        const uint32_t i_delta = stts->pi_sample_delta[i_index];
 
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
+        if( i_dts + (uint64_t)i_count * i_delta < (uint64_t)i_start )
+        {
+            i_dts    += (uint64_t)i_count * i_delta;
+            i_sample += i_count;
+            i_left   -= i_count;
+            i_index++;
+            i_skip = 0;
         }
         else
         {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
-            {
+            if( i_delta == 0 )
                 break;
-            }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+            i_sample += ( i_start - i_dts ) / i_delta;
             break;
         }
     }
@@ -3384,8 +3173,7 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
     p_track->i_start_delta = p_track->i_next_delta;
 
     /* Probe the 16 first B frames */
-    const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    if( p_chunk->i_entries_pts )
+    if( p_track->p_ctts )
     {
         for( uint32_t i=1; i<16; i++ )
         {
@@ -3394,9 +3182,9 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
             if(!ck)
                 break;
             stime_t pts;
-            stime_t dts = pts = MP4_ChunkGetSampleDTS( ck, i_nextsample - ck->i_sample_first );
+            stime_t dts = pts = MP4_ChunkGetSampleDTS( p_track, ck, i_nextsample - ck->i_sample_first );
             stime_t delta = UNKNOWN_DELTA;
-            if( MP4_ChunkGetSampleCTSDelta( ck, i_nextsample - ck->i_sample_first, &delta ) )
+            if( MP4_ChunkGetSampleCTSDelta( p_track, ck, i_nextsample - ck->i_sample_first, &delta ) )
                 pts += delta;
             stime_t lowest = p_track->i_start_dts;
             if( p_track->i_start_delta != UNKNOWN_DELTA )
@@ -3414,9 +3202,9 @@ static void TrackUpdateSampleAndTimes( mp4_track_t *p_track )
 {
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
     uint32_t i_chunk_sample = p_track->i_sample - p_chunk->i_sample_first;
-    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_chunk, i_chunk_sample );
+    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_track, p_chunk, i_chunk_sample );
     stime_t i_next_delta;
-    if( !MP4_ChunkGetSampleCTSDelta( p_chunk, i_chunk_sample, &i_next_delta ) )
+    if( !MP4_ChunkGetSampleCTSDelta( p_track, p_chunk, i_chunk_sample, &i_next_delta ) )
         p_track->i_next_delta = UNKNOWN_DELTA;
     else
         p_track->i_next_delta = i_next_delta;
@@ -3709,16 +3497,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            MP4_ChunkDestroy( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     ASFPacketTrackReset( &p_track->asfinfo );
 
     free( p_track->context.runs.p_array );
@@ -4375,20 +4155,253 @@ static bool GetMoofTrackDuration( MP4_Box_t *p_moov, MP4_Box_t *p_moof,
     return true;
 }
 
-static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
+/* Gets the start times of the moof for each track, and advances
+ * pi_track_times to their end */
+static void FragIndexMoof( demux_sys_t *p_sys, MP4_Box_t *p_moof, bool b_first,
+                           stime_t *pi_track_times, stime_t *p_times )
+{
+    for( unsigned i=0; i<p_sys->i_tracks; i++ )
+    {
+        MP4_Box_t *p_tfdt = NULL;
+        MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
+        if( p_traf )
+            p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
+
+        if( p_tfdt && BOXDATA(p_tfdt) )
+        {
+            pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
+        }
+        else if( b_first ) /* Set first fragment time offset from moov */
+        {
+            stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
+            pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
+        }
+
+        p_times[i] = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
+
+        stime_t i_duration = 0;
+        if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
+            pi_track_times[i] += i_duration;
+    }
+}
+
+static int FragIndexAppend( demux_sys_t *p_sys, const MP4_Box_t *p_moof,
+                            const stime_t *pi_track_times, const stime_t *p_times )
 {
+    mp4_fragments_index_t *p_index = p_sys->p_fragsindex;
+
+    if( MP4_Fragments_Index_Append( p_index, p_moof->i_pos, p_times ) != VLC_SUCCESS )
+        return VLC_ENOMEM;
+
+    for( unsigned i=0; i<p_sys->i_tracks; i++ )
+    {
+        stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
+        if( p_index->i_last_time < i_movietime )
+            p_index->i_last_time = i_movietime;
+    }
+    return VLC_SUCCESS;
+}
+
+static void *FragIndexerThread( void *data )
+{
+    demux_t *p_demux = data;
     demux_sys_t *p_sys = p_demux->p_sys;
+    mp4_fragindexer_t *p_indexer = p_sys->p_indexer;
+    unsigned i_moof = 0;
 
-    msg_Dbg( p_demux, "probing fragments from %"PRId64, vlc_stream_Tell( p_demux->s ) );
+    stime_t *pi_track_times = calloc( 2 * p_sys->i_tracks, sizeof(*pi_track_times) );
+    if( pi_track_times && vlc_stream_Seek( p_indexer->s, p_indexer->i_start ) == VLC_SUCCESS )
+    {
+        stime_t *p_times = &pi_track_times[p_sys->i_tracks];
 
-    assert( p_sys->p_root );
+        /* Only top level boxes are read, mdat payloads are skipped */
+        while( !atomic_load( &p_indexer->b_quit ) )
+        {
+            MP4_Box_t *p_chunk = MP4_BoxGetNextChunk( p_indexer->s );
+            if( !p_chunk )
+                break;
+
+            int i_ret = VLC_SUCCESS;
+            MP4_Box_t *p_moof = MP4_BoxGet( p_chunk, "moof" );
+            if( p_moof )
+            {
+                FragIndexMoof( p_sys, p_moof, i_moof++ == 0, pi_track_times, p_times );
+
+                vlc_mutex_lock( &p_indexer->lock );
+                i_ret = FragIndexAppend( p_sys, p_moof, pi_track_times, p_times );
+                vlc_cond_broadcast( &p_indexer->wait );
+                vlc_mutex_unlock( &p_indexer->lock );
+            }
+            MP4_BoxFree( p_chunk );
+            if( i_ret != VLC_SUCCESS )
+                break;
+        }
+    }
+    free( pi_track_times );
+
+    msg_Dbg( p_demux, "fragments index completed with %u moof", i_moof );
+
+    vlc_mutex_lock( &p_indexer->lock );
+    p_indexer->b_done = true;
+    vlc_cond_broadcast( &p_indexer->wait );
+    vlc_mutex_unlock( &p_indexer->lock );
+    return NULL;
+}
+
+static int FragIndexerNew( demux_t *p_demux, uint64_t i_start )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_demux->psz_url )
+        return VLC_EGENERIC;
+
+    mp4_fragindexer_t *p_indexer = malloc( sizeof(*p_indexer) );
+    if( !p_indexer )
+        return VLC_ENOMEM;
+
+    p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, 0 );
+    p_indexer->s = vlc_stream_NewURL( p_demux, p_demux->psz_url );
+    if( !p_sys->p_fragsindex || !p_indexer->s )
+        goto error;
+
+    /* Make sure we did not open some outer container */
+    uint64_t i_size, i_indexer_size;
+    if( vlc_stream_GetSize( p_demux->s, &i_size ) ||
+        vlc_stream_GetSize( p_indexer->s, &i_indexer_size ) ||
+        i_size != i_indexer_size )
+        goto error;
+
+    p_indexer->i_start = i_start;
+    p_indexer->b_done = false;
+    p_indexer->i_last_reported = -1;
+    atomic_init( &p_indexer->b_quit, false );
+    vlc_mutex_init( &p_indexer->lock );
+    vlc_cond_init( &p_indexer->wait );
+
+    p_sys->p_indexer = p_indexer;
+    if( vlc_clone( &p_indexer->thread, FragIndexerThread, p_demux,
+                   VLC_THREAD_PRIORITY_LOW ) )
+    {
+        p_sys->p_indexer = NULL;
+        goto error;
+    }
+    return VLC_SUCCESS;
+
+error:
+    if( p_indexer->s )
+        vlc_stream_Delete( p_indexer->s );
+    free( p_indexer );
+    MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
+    p_sys->p_fragsindex = NULL;
+    return VLC_EGENERIC;
+}
+
+static void FragIndexerDelete( demux_sys_t *p_sys )
+{
+    mp4_fragindexer_t *p_indexer = p_sys->p_indexer;
+    if( !p_indexer )
+        return;
+
+    atomic_store( &p_indexer->b_quit, true );
+    vlc_join( p_indexer->thread, NULL );
+    vlc_stream_Delete( p_indexer->s );
+    free( p_indexer );
+    p_sys->p_indexer = NULL;
+}
+
+/* Locks the fragments index against the background indexer, after it has
+ * indexed the movie time i_time (if >= 0) and the moof at i_pos (if > 0) */
+static void FragIndexLock( demux_sys_t *p_sys, stime_t i_time, uint64_t i_pos )
+{
+    mp4_fragindexer_t *p_indexer = p_sys->p_indexer;
+    if( !p_indexer )
+        return;
+
+    const mp4_fragments_index_t *p_index = p_sys->p_fragsindex;
+
+    vlc_mutex_lock( &p_indexer->lock );
+    while( !p_indexer->b_done &&
+           ( (i_time >= 0 && p_index->i_last_time <= i_time) ||
+             (i_pos > 0 && (p_index->i_entries == 0 ||
+                            p_index->pi_pos[p_index->i_entries - 1] < i_pos)) ) )
+        vlc_cond_wait( &p_indexer->wait, &p_indexer->lock );
+}
+
+static void FragIndexUnlock( demux_sys_t *p_sys )
+{
+    if( p_sys->p_indexer )
+        vlc_mutex_unlock( &p_sys->p_indexer->lock );
+}
+
+/* Extends the length as the background indexer progresses */
+static void FragIndexerUpdateDuration( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    mp4_fragindexer_t *p_indexer = p_sys->p_indexer;
+
+    if( !p_indexer || MP4_BoxGet( p_sys->p_moov, "mvex/mehd" ) )
+        return;
 
+    vlc_mutex_lock( &p_indexer->lock );
+    if( p_indexer->i_last_reported != p_sys->p_fragsindex->i_last_time )
+    {
+        p_indexer->i_last_reported = p_sys->p_fragsindex->i_last_time;
+        p_sys->i_cumulated_duration = GetCumulatedDuration( p_demux );
+    }
+    vlc_mutex_unlock( &p_indexer->lock );
+}
+
+/* We stop at first moof, which validates our fragmentation condition */
+static bool ProbeFirstMoof( demux_t *p_demux )
+{
     MP4_Box_t *p_vroot = MP4_BoxNew(ATOM_root);
     if( !p_vroot )
-        return VLC_EGENERIC;
+        return false;
+
+    const uint32_t excllist[] = { ATOM_moof, 0 };
+    MP4_ReadBoxContainerRestricted( p_demux->s, p_vroot, NULL, excllist );
+    MP4_BoxFree( p_vroot );
+
+    /* Peek since we stopped before restriction */
+    const uint8_t *p_peek;
+    if ( vlc_stream_Peek( p_demux->s, &p_peek, 8 ) == 8 )
+        return VLC_FOURCC( p_peek[4], p_peek[5], p_peek[6], p_peek[7] ) == ATOM_moof;
+    return false;
+}
+
+static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const uint64_t i_start = vlc_stream_Tell( p_demux->s );
+    bool b_background = false;
+
+    msg_Dbg( p_demux, "probing fragments from %"PRId64, i_start );
+
+    assert( p_sys->p_root );
+
+    if( p_sys->b_seekable && p_sys->b_fastseekable && !p_sys->p_indexer )
+    {
+        /* Index the fragments in the background on another stream:
+         * seeking becomes possible as soon as the target is indexed */
+        *pb_fragmented = ProbeFirstMoof( p_demux );
+        b_background = !*pb_fragmented ||
+                       FragIndexerNew( p_demux, i_start ) == VLC_SUCCESS;
+        if( b_background )
+            p_sys->b_fragments_probed = *pb_fragmented;
+        else if( vlc_stream_Seek( p_demux->s, i_start ) != VLC_SUCCESS )
+            return VLC_EGENERIC;
+    }
 
-    if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) )
+    if( b_background )
     {
+        /* index is being built */
+    }
+    else if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) )
+    {
+        MP4_Box_t *p_vroot = MP4_BoxNew(ATOM_root);
+        if( !p_vroot )
+            return VLC_EGENERIC;
+
         MP4_ReadBoxContainerChildren( p_demux->s, p_vroot, NULL ); /* Get the rest of the file */
         p_sys->b_fragments_probed = true;
 
@@ -4403,7 +4416,7 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
                 return VLC_EGENERIC;
             }
 
-            stime_t *pi_track_times = calloc( p_sys->i_tracks, sizeof(*pi_track_times) );
+            stime_t *pi_track_times = calloc( 2 * p_sys->i_tracks, sizeof(*pi_track_times) );
             if( !pi_track_times )
             {
                 MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
@@ -4411,47 +4424,19 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
                 MP4_BoxFree( p_vroot );
                 return VLC_EGENERIC;
             }
+            stime_t *p_times = &pi_track_times[p_sys->i_tracks];
 
-            unsigned index = 0;
+            bool b_first = true;
 
             for( MP4_Box_t *p_moof = p_vroot->p_first; p_moof; p_moof = p_moof->p_next )
             {
                 if( p_moof->i_type != ATOM_moof )
                     continue;
 
-                for( unsigned i=0; i<p_sys->i_tracks; i++ )
-                {
-                    MP4_Box_t *p_tfdt = NULL;
-                    MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
-                    if( p_traf )
-                        p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
-
-                    if( p_tfdt && BOXDATA(p_tfdt) )
-                    {
-                        pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
-                    }
-                    else if( index == 0 ) /* Set first fragment time offset from moov */
-                    {
-                        stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
-                        pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
-                    }
-
-                    stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                    p_sys->p_fragsindex->p_times[index * p_sys->i_tracks + i] = i_movietime;
-
-                    stime_t i_duration = 0;
-                    if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
-                        pi_track_times[i] += i_duration;
-                }
-
-                p_sys->p_fragsindex->pi_pos[index++] = p_moof->i_pos;
-            }
-
-            for( unsigned i=0; i<p_sys->i_tracks; i++ )
-            {
-                stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                if( p_sys->p_fragsindex->i_last_time < i_movietime )
-                    p_sys->p_fragsindex->i_last_time = i_movietime;
+                FragIndexMoof( p_sys, p_moof, b_first, pi_track_times, p_times );
+                b_first = false;
+                /* cannot fail, the index was allocated for all moof */
+                FragIndexAppend( p_sys, p_moof, pi_track_times, p_times );
             }
 
             free( pi_track_times );
@@ -4459,26 +4444,21 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
             MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
 #endif
         }
+        MP4_BoxFree( p_vroot );
     }
     else
     {
-        /* We stop at first moof, which validates our fragmentation condition
-         * and we'll find others while reading. */
-        const uint32_t excllist[] = { ATOM_moof, 0 };
-        MP4_ReadBoxContainerRestricted( p_demux->s, p_vroot, NULL, excllist );
-        /* Peek since we stopped before restriction */
-        const uint8_t *p_peek;
-        if ( vlc_stream_Peek( p_demux->s, &p_peek, 8 ) == 8 )
-            *pb_fragmented = (VLC_FOURCC( p_peek[4], p_peek[5], p_peek[6], p_peek[7] ) == ATOM_moof);
-        else
-            *pb_fragmented = false;
+        /* we'll find other moof while reading */
+        *pb_fragmented = ProbeFirstMoof( p_demux );
     }
 
-    MP4_BoxFree( p_vroot );
-
     MP4_Box_t *p_mehd = MP4_BoxGet( p_sys->p_moov, "mvex/mehd");
     if ( !p_mehd )
-           p_sys->i_cumulated_duration = GetCumulatedDuration( p_demux );
+    {
+        FragIndexLock( p_sys, -1, 0 );
+        p_sys->i_cumulated_duration = GetCumulatedDuration( p_demux );
+        FragIndexUnlock( p_sys );
+    }
 
     return VLC_SUCCESS;
 }
@@ -4836,8 +4816,10 @@ static int FragCreateTrunIndex( demux_t *p_demux, MP4_Box_t *p_moof,
             {
                 unsigned i_track_index = (p_track - p_sys->track);
                 assert(&p_sys->track[i_track_index] == p_track);
+                FragIndexLock( p_sys, -1, p_moof->i_pos );
                 i_traf_start_time = MP4_Fragment_Index_GetTrackStartTime( p_sys->p_fragsindex,
                                                                           i_track_index, p_moof->i_pos );
+                FragIndexUnlock( p_sys );
                 i_traf_start_time = MP4_rescale( i_traf_start_time,
                                                  p_sys->i_timescale, p_track->i_timescale );
                 b_has_base_media_decode_time = true;
@@ -5107,6 +5089,8 @@ static int DemuxFrag( demux_t *p_demux )
         goto end;
     }
 
+    FragIndexerUpdateDuration( p_demux );
+
     /* check for newly selected/unselected track */
     for( unsigned i_track = 0; i_track < p_sys->i_tracks; i_track++ )
     {
@@ -46,15 +46,13 @@ typedef struct
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-    uint32_t     small_dts_buf[4];
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    uint32_t     *p_sample_offset_pts;  /* pts-dts */
-    uint32_t     small_pts_buf[4];
+    /* first stts and ctts entries of this chunk, and how many samples of
+       those entries belong to the previous chunks: the sample times are
+       resolved from the run-length encoded tables, never expanded */
+    uint32_t     i_stts_entry;
+    uint32_t     i_stts_skip;
+    uint32_t     i_ctts_entry;
+    uint32_t     i_ctts_skip;
 
     /* TODO if needed add pts
         but quickly *add* support for edts and seeking */
@@ -143,11 +141,15 @@ typedef struct
 
     mp4_chunk_t    *chunk; /* always defined  for each chunk */
 
+    /* time to sample tables, owned by the stbl boxes */
+    const MP4_Box_data_stts_t *p_stts;
+    const MP4_Box_data_ctts_t *p_ctts; /* could be NULL */
+    int64_t          i_cts_shift;
+
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+    const uint32_t   *p_sample_size; /* from the stsz box */
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
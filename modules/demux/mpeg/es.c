@@ -127,6 +127,14 @@ typedef struct
     seekpoint_t *p_seekpoint;
 } chap_entry_t;
 
+typedef struct
+{
+    vlc_tick_t i_time;
+    uint64_t i_pos;
+} index_entry_t;
+
+#define ES_INDEX_INTERVAL VLC_TICK_FROM_SEC(1)
+
 typedef struct
 {
     codec_t codec;
@@ -176,6 +184,14 @@ typedef struct
         size_t i_current;
         chap_entry_t *p_entry;
     } chapters;
+
+    /* Audio frames played from the start, for exact seeks back */
+    struct
+    {
+        size_t i_count;
+        index_entry_t *p_entry;
+        bool b_contiguous; /* no seek yet */
+    } index;
 } demux_sys_t;
 
 static int MpgaProbe( demux_t *p_demux, uint64_t *pi_offset );
@@ -239,6 +255,8 @@ static int OpenCommon( demux_t *p_demux,
     p_sys->p_packetized_data = NULL;
     p_sys->chapters.i_current = 0;
     TAB_INIT(p_sys->chapters.i_count, p_sys->chapters.p_entry);
+    TAB_INIT(p_sys->index.i_count, p_sys->index.p_entry);
+    p_sys->index.b_contiguous = i_cat == AUDIO_ES;
 
     if( vlc_stream_Seek( p_demux->s, p_sys->i_stream_offset ) )
     {
@@ -346,6 +364,37 @@ static void IncreaseChapter( demux_t *p_demux, vlc_tick_t i_time )
  *****************************************************************************
  * Returns -1 in case of error, 0 in case of EOF, 1 otherwise
  *****************************************************************************/
+static void IndexFrame( demux_sys_t *p_sys, vlc_tick_t i_time, uint64_t i_pos )
+{
+    if( p_sys->index.i_count > 0 &&
+        i_time - p_sys->index.p_entry[p_sys->index.i_count - 1].i_time < ES_INDEX_INTERVAL )
+        return;
+
+    index_entry_t e = { .i_time = i_time, .i_pos = i_pos };
+    TAB_APPEND( p_sys->index.i_count, p_sys->index.p_entry, e );
+}
+
+/* Returns the last indexed frame at or before the time, if the time lies
+ * within the indexed part of the stream */
+static const index_entry_t *IndexFind( demux_sys_t *p_sys, vlc_tick_t i_time )
+{
+    size_t i_low = 0, i_high = p_sys->index.i_count;
+
+    if( i_high == 0 || i_time < p_sys->index.p_entry[0].i_time ||
+        i_time >= p_sys->index.p_entry[i_high - 1].i_time + ES_INDEX_INTERVAL )
+        return NULL;
+
+    while( i_high - i_low > 1 )
+    {
+        size_t i_mid = (i_low + i_high) / 2;
+        if( p_sys->index.p_entry[i_mid].i_time <= i_time )
+            i_low = i_mid;
+        else
+            i_high = i_mid;
+    }
+    return &p_sys->index.p_entry[i_low];
+}
+
 static int Demux( demux_t *p_demux )
 {
     int ret = 1;
@@ -389,6 +438,10 @@ static int Demux( demux_t *p_demux )
             p_block_out->i_dts += p_sys->i_time_offset;
             es_out_SetPCR( p_demux->out, p_block_out->i_dts );
         }
+        /* Frames are contiguous until the first seek */
+        if( p_sys->index.b_contiguous && p_block_out->i_pts != VLC_TICK_INVALID )
+            IndexFrame( p_sys, p_sys->i_pts, p_sys->i_bytes );
+
         /* Re-estimate bitrate */
         if( p_sys->b_estimate_bitrate && p_sys->i_pts > VLC_TICK_FROM_MS(500) )
             p_sys->i_bitrate_avg = 8 * CLOCK_FREQ * p_sys->i_bytes
@@ -417,6 +470,7 @@ static void Close( vlc_object_t * p_this )
     for( size_t i=0; i< p_sys->chapters.i_count; i++ )
         vlc_seekpoint_Delete( p_sys->chapters.p_entry[i].p_seekpoint );
     TAB_CLEAN( p_sys->chapters.i_count, p_sys->chapters.p_entry );
+    TAB_CLEAN( p_sys->index.i_count, p_sys->index.p_entry );
     if( p_sys->mllt.p_bits )
         free( p_sys->mllt.p_bits );
     demux_PacketizerDestroy( p_sys->p_packetizer );
@@ -433,6 +487,7 @@ static int MovetoTimePos( demux_t *p_demux, vlc_tick_t i_time, uint64_t i_pos )
     if( i_ret != VLC_SUCCESS )
         return i_ret;
     p_sys->i_time_offset = i_time - p_sys->i_pts;
+    p_sys->index.b_contiguous = false;
     /* And reset buffered data */
     if( p_sys->p_packetized_data )
         block_ChainRelease( p_sys->p_packetized_data );
@@ -499,6 +554,24 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
                 uint64_t i_pos = SeekByMlltTable( p_demux, &i_time );
                 return MovetoTimePos( p_demux, i_time, i_pos );
             }
+            else
+            {
+                va_list ap;
+                va_copy( ap, args );
+                vlc_tick_t i_time = va_arg( ap, vlc_tick_t );
+                va_end( ap );
+
+                const index_entry_t *p_entry = IndexFind( p_sys, i_time );
+                if( p_entry )
+                {
+                    int i_ret = MovetoTimePos( p_demux, p_entry->i_time,
+                                               p_entry->i_pos );
+                    if( i_ret == VLC_SUCCESS )
+                        es_out_Control( p_demux->out, ES_OUT_SET_NEXT_DISPLAY_TIME,
+                                        VLC_TICK_0 + i_time );
+                    return i_ret;
+                }
+            }
             /* FIXME TODO: implement a high precision seek (with mp3 parsing)
              * needed for multi-input */
             break;
@@ -597,6 +670,8 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             p_sys->p_packetized_data = NULL;
         }
 
+        p_sys->index.b_contiguous = false;
+
         /* Reset chapter if any */
         p_sys->chapters.i_current = 0;
         p_sys->i_demux_flags |= INPUT_UPDATE_SEEKPOINT;
@@ -32,6 +32,8 @@
 #include <vlc_plugin.h>
 #include <vlc_demux.h>
 
+#include <stdatomic.h>
+
 #include "pes.h"
 #include "ps.h"
 
@@ -50,6 +52,11 @@
 #define CDXA_SECTOR_SIZE 2352
 #define CDXA_SECTOR_HEADER_SIZE 24
 
+/* Distance between the packs recorded by the seek index */
+#define PS_INDEX_STEP (256 * 1024)
+/* Larger SCR gaps or backward SCR are discontinuities */
+#define PS_INDEX_MAX_GAP VLC_TICK_FROM_SEC(60)
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -80,6 +87,31 @@ vlc_module_end ()
  * Local prototypes
  *****************************************************************************/
 
+typedef struct
+{
+    uint64_t    i_pos;  /* of the pack header */
+    vlc_tick_t  i_scr;
+    vlc_tick_t  i_time; /* from the first SCR, across discontinuities */
+} ps_index_entry_t;
+
+/* Sparse pack/SCR index, built by sampling one pack every PS_INDEX_STEP
+ * bytes on a separate stream, in the background */
+typedef struct
+{
+    vlc_thread_t thread;
+    stream_t    *s;
+    int          format;
+    uint64_t     i_start;
+    uint64_t     i_size;
+    atomic_bool  b_quit;
+
+    vlc_mutex_t  lock;
+    ps_index_entry_t *p_entries; /* protected by lock */
+    size_t       i_entries;
+    size_t       i_alloc;
+    bool         b_done;
+} ps_indexer_t;
+
 typedef struct
 {
     ps_psm_t    psm;
@@ -113,6 +145,8 @@ typedef struct
     int         current_title;
     int         current_seekpoint;
     unsigned    updates;
+
+    ps_indexer_t *p_indexer;
 } demux_sys_t;
 
 static int Demux  ( demux_t *p_demux );
@@ -121,6 +155,9 @@ static int Control( demux_t *p_demux, int i_query, va_list args );
 static int      ps_pkt_resynch( stream_t *, int, bool );
 static block_t *ps_pkt_read   ( stream_t * );
 
+static void IndexerNew( demux_t * );
+static void IndexerDelete( demux_sys_t * );
+
 /*****************************************************************************
  * Open
  *****************************************************************************/
@@ -233,12 +270,17 @@ static int OpenCommon( vlc_object_t *p_this, bool b_force )
     p_sys->current_title = 0;
     p_sys->current_seekpoint = 0;
     p_sys->updates = 0;
+    p_sys->p_indexer = NULL;
 
     vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &p_sys->b_seekable );
 
     ps_psm_init( &p_sys->psm );
     ps_track_init( p_sys->tk );
 
+    if( p_sys->b_seekable && !p_demux->b_preparsing &&
+        var_InheritBool( p_demux, "ps-trust-timestamps" ) )
+        IndexerNew( p_demux );
+
     /* TODO prescanning of ES */
 
     return VLC_SUCCESS;
@@ -275,6 +317,7 @@ static void Close( vlc_object_t *p_this )
 
     ps_psm_destroy( &p_sys->psm );
 
+    IndexerDelete( p_sys );
     free( p_sys );
 }
 
@@ -388,6 +431,271 @@ static bool FindLength( demux_t *p_demux )
     return true;
 }
 
+/*****************************************************************************
+ * Seek index
+ *****************************************************************************/
+
+/* Finds the first pack header from i_pos, within PS_INDEX_STEP bytes */
+static int IndexerFindPack( ps_indexer_t *p_idx, uint64_t i_pos,
+                            uint64_t *pi_pack, vlc_tick_t *pi_scr )
+{
+    stream_t *s = p_idx->s;
+
+    if( p_idx->format == CDXA_PS ) /* Align to sector payload */
+    {
+        uint64_t i_offset = i_pos - p_idx->i_start;
+        i_pos = p_idx->i_start + i_offset - (i_offset % CDXA_SECTOR_SIZE) +
+                CDXA_SECTOR_HEADER_SIZE;
+    }
+
+    if( vlc_stream_Seek( s, i_pos ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+
+    while( vlc_stream_Tell( s ) - i_pos < PS_INDEX_STEP &&
+           !atomic_load( &p_idx->b_quit ) )
+    {
+        int i_ret = ps_pkt_resynch( s, p_idx->format, true );
+        if( i_ret < 0 )
+            break;
+        if( i_ret == 0 )
+            continue;
+
+        uint64_t i_pack = vlc_stream_Tell( s );
+        block_t *p_pkt = ps_pkt_read( s );
+        if( p_pkt == NULL )
+            break;
+
+        vlc_tick_t i_scr; int i_mux_rate;
+        bool b_found = p_pkt->i_buffer >= 4 &&
+                       p_pkt->p_buffer[3] == PS_STREAM_ID_PACK_HEADER &&
+                       !ps_pkt_parse_pack( p_pkt->p_buffer, p_pkt->i_buffer,
+                                           &i_scr, &i_mux_rate );
+        block_Release( p_pkt );
+        if( b_found )
+        {
+            *pi_pack = i_pack;
+            *pi_scr = i_scr;
+            return VLC_SUCCESS;
+        }
+    }
+    return VLC_EGENERIC;
+}
+
+static void *IndexerThread( void *data )
+{
+    ps_indexer_t *p_idx = data;
+    vlc_tick_t i_time = 0, i_delta = 0;
+
+    for( uint64_t i_pos = p_idx->i_start;
+         i_pos < p_idx->i_size && !atomic_load( &p_idx->b_quit );
+         i_pos += PS_INDEX_STEP )
+    {
+        uint64_t i_pack;
+        vlc_tick_t i_scr;
+
+        if( IndexerFindPack( p_idx, i_pos, &i_pack, &i_scr ) )
+            continue;
+
+        vlc_mutex_lock( &p_idx->lock );
+        if( p_idx->i_entries > 0 )
+        {
+            const ps_index_entry_t *p_last =
+                &p_idx->p_entries[p_idx->i_entries - 1];
+            if( i_pack <= p_last->i_pos )
+            {
+                vlc_mutex_unlock( &p_idx->lock );
+                continue;
+            }
+            /* On SCR discontinuities, assume the previous step duration */
+            if( i_scr >= p_last->i_scr &&
+                i_scr - p_last->i_scr <= PS_INDEX_MAX_GAP )
+                i_delta = i_scr - p_last->i_scr;
+            i_time += i_delta;
+        }
+
+        if( p_idx->i_entries == p_idx->i_alloc )
+        {
+            size_t i_alloc = p_idx->i_alloc ? p_idx->i_alloc * 2 : 256;
+            ps_index_entry_t *p_realloc =
+                realloc( p_idx->p_entries, i_alloc * sizeof(*p_realloc) );
+            if( p_realloc == NULL )
+            {
+                vlc_mutex_unlock( &p_idx->lock );
+                break;
+            }
+            p_idx->p_entries = p_realloc;
+            p_idx->i_alloc = i_alloc;
+        }
+        p_idx->p_entries[p_idx->i_entries++] = (ps_index_entry_t) {
+            .i_pos = i_pack, .i_scr = i_scr, .i_time = i_time };
+        vlc_mutex_unlock( &p_idx->lock );
+    }
+
+    vlc_mutex_lock( &p_idx->lock );
+    p_idx->b_done = true;
+    vlc_mutex_unlock( &p_idx->lock );
+    return NULL;
+}
+
+static void IndexerNew( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    bool b_fastseek = false;
+    uint64_t i_size, i_indexer_size;
+
+    vlc_stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &b_fastseek );
+    if( !b_fastseek || !p_demux->psz_url ||
+        vlc_stream_GetSize( p_demux->s, &i_size ) || i_size == 0 )
+        return;
+
+    ps_indexer_t *p_idx = malloc( sizeof(*p_idx) );
+    if( !p_idx )
+        return;
+
+    p_idx->s = vlc_stream_NewURL( p_demux, p_demux->psz_url );
+    /* Make sure we did not open some outer container */
+    if( !p_idx->s ||
+        vlc_stream_GetSize( p_idx->s, &i_indexer_size ) ||
+        i_size != i_indexer_size )
+        goto error;
+
+    p_idx->format = p_sys->format;
+    p_idx->i_start = p_sys->i_start_byte;
+    p_idx->i_size = i_size;
+    p_idx->p_entries = NULL;
+    p_idx->i_entries = 0;
+    p_idx->i_alloc = 0;
+    p_idx->b_done = false;
+    atomic_init( &p_idx->b_quit, false );
+    vlc_mutex_init( &p_idx->lock );
+
+    if( vlc_clone( &p_idx->thread, IndexerThread, p_idx,
+                   VLC_THREAD_PRIORITY_LOW ) )
+        goto error;
+
+    p_sys->p_indexer = p_idx;
+    return;
+
+error:
+    if( p_idx->s )
+        vlc_stream_Delete( p_idx->s );
+    free( p_idx );
+}
+
+static void IndexerDelete( demux_sys_t *p_sys )
+{
+    ps_indexer_t *p_idx = p_sys->p_indexer;
+    if( !p_idx )
+        return;
+
+    atomic_store( &p_idx->b_quit, true );
+    vlc_join( p_idx->thread, NULL );
+    vlc_stream_Delete( p_idx->s );
+    free( p_idx->p_entries );
+    free( p_idx );
+    p_sys->p_indexer = NULL;
+}
+
+/* Returns the last entry at or before the byte position i_pos,
+ * the index being locked */
+static const ps_index_entry_t *IndexFindPos( const ps_indexer_t *p_idx,
+                                             uint64_t i_pos )
+{
+    size_t lo = 0, hi = p_idx->i_entries;
+
+    while( lo < hi )
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if( p_idx->p_entries[mid].i_pos <= i_pos )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo > 0 ? &p_idx->p_entries[lo - 1] : NULL;
+}
+
+/* Returns the last entry at or before the time i_time,
+ * the index being locked */
+static const ps_index_entry_t *IndexFindTime( const ps_indexer_t *p_idx,
+                                              vlc_tick_t i_time )
+{
+    size_t lo = 0, hi = p_idx->i_entries;
+
+    while( lo < hi )
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if( p_idx->p_entries[mid].i_time <= i_time )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo > 0 ? &p_idx->p_entries[lo - 1] : NULL;
+}
+
+/* Gets the time of the pack read at i_pos, once the index is complete */
+static int IndexGetTime( demux_sys_t *p_sys, uint64_t i_pos, vlc_tick_t i_scr,
+                         vlc_tick_t *pi_time )
+{
+    ps_indexer_t *p_idx = p_sys->p_indexer;
+    int i_ret = VLC_EGENERIC;
+
+    if( !p_idx || i_scr == VLC_TICK_INVALID )
+        return VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_idx->lock );
+    const ps_index_entry_t *p_entry = p_idx->b_done
+                                    ? IndexFindPos( p_idx, i_pos ) : NULL;
+    if( p_entry && i_scr >= p_entry->i_scr &&
+        i_scr - p_entry->i_scr <= PS_INDEX_MAX_GAP )
+    {
+        *pi_time = p_entry->i_time + i_scr - p_entry->i_scr;
+        i_ret = VLC_SUCCESS;
+    }
+    vlc_mutex_unlock( &p_idx->lock );
+    return i_ret;
+}
+
+/* Gets the total duration, once the index is complete */
+static int IndexGetLength( demux_sys_t *p_sys, vlc_tick_t *pi_length )
+{
+    ps_indexer_t *p_idx = p_sys->p_indexer;
+    int i_ret = VLC_EGENERIC;
+
+    if( !p_idx )
+        return VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_idx->lock );
+    if( p_idx->b_done && p_idx->i_entries > 1 &&
+        p_idx->p_entries[p_idx->i_entries - 1].i_time > 0 )
+    {
+        *pi_length = p_idx->p_entries[p_idx->i_entries - 1].i_time;
+        i_ret = VLC_SUCCESS;
+    }
+    vlc_mutex_unlock( &p_idx->lock );
+    return i_ret;
+}
+
+/* Gets the pack to seek to for the time i_time, if already indexed */
+static int IndexGetPos( demux_sys_t *p_sys, vlc_tick_t i_time, uint64_t *pi_pos )
+{
+    ps_indexer_t *p_idx = p_sys->p_indexer;
+    int i_ret = VLC_EGENERIC;
+
+    if( !p_idx )
+        return VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_idx->lock );
+    if( p_idx->i_entries > 0 &&
+        (p_idx->b_done || p_idx->p_entries[p_idx->i_entries - 1].i_time > i_time) )
+    {
+        const ps_index_entry_t *p_entry = IndexFindTime( p_idx, i_time );
+        *pi_pos = p_entry ? p_entry->i_pos : p_idx->p_entries[0].i_pos;
+        i_ret = VLC_SUCCESS;
+    }
+    vlc_mutex_unlock( &p_idx->lock );
+    return i_ret;
+}
+
 static void NotifyDiscontinuity( ps_track_t *p_tk, es_out_t *out )
 {
     bool b_selected;
@@ -761,6 +1069,14 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             break;
 
         case DEMUX_GET_TIME:
+        {
+            vlc_tick_t i_index_time;
+            if( IndexGetTime( p_sys, p_sys->i_lastpack_byte, p_sys->i_scr,
+                              &i_index_time ) == VLC_SUCCESS )
+            {
+                *va_arg( args, vlc_tick_t * ) = i_index_time;
+                return VLC_SUCCESS;
+            }
             if( p_sys->i_time_track_index >= 0 && p_sys->i_current_pts != VLC_TICK_INVALID )
             {
                 *va_arg( args, vlc_tick_t * ) = p_sys->i_current_pts - p_sys->tk[p_sys->i_time_track_index].i_first_pts;
@@ -780,28 +1096,44 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             }
             *va_arg( args, vlc_tick_t * ) = 0;
             break;
+        }
 
         case DEMUX_GET_LENGTH:
+        {
+            vlc_tick_t *pi_length = va_arg( args, vlc_tick_t * );
+            if( IndexGetLength( p_sys, pi_length ) == VLC_SUCCESS )
+                return VLC_SUCCESS;
             if( p_sys->i_length > VLC_TICK_0 )
             {
-                *va_arg( args, vlc_tick_t * ) = p_sys->i_length;
+                *pi_length = p_sys->i_length;
                 return VLC_SUCCESS;
             }
             else if( p_sys->i_mux_rate > 0 )
             {
-                *va_arg( args, vlc_tick_t * ) = vlc_tick_from_samples( stream_Size( p_demux->s ) - p_sys->i_start_byte / 50,
+                *pi_length = vlc_tick_from_samples( stream_Size( p_demux->s ) - p_sys->i_start_byte / 50,
                     p_sys->i_mux_rate );
                 return VLC_SUCCESS;
             }
-            *va_arg( args, vlc_tick_t * ) = 0;
+            *pi_length = 0;
             break;
+        }
 
         case DEMUX_SET_TIME:
         {
+            vlc_tick_t i_time = va_arg( args, vlc_tick_t );
+            uint64_t i_pos;
+            if( IndexGetPos( p_sys, i_time, &i_pos ) == VLC_SUCCESS )
+            {
+                if( vlc_stream_Seek( p_demux->s, i_pos ) != VLC_SUCCESS )
+                    break;
+                p_sys->i_current_pts = VLC_TICK_INVALID;
+                p_sys->i_scr = VLC_TICK_INVALID;
+                NotifyDiscontinuity( p_sys->tk, p_demux->out );
+                return VLC_SUCCESS;
+            }
             if( p_sys->i_time_track_index >= 0 && p_sys->i_current_pts != VLC_TICK_INVALID &&
                 p_sys->i_length > VLC_TICK_0)
             {
-                vlc_tick_t i_time = va_arg( args, vlc_tick_t );
                 i_time -= p_sys->tk[p_sys->i_time_track_index].i_first_pts;
                 return demux_Control( p_demux, DEMUX_SET_POSITION, (double) i_time / p_sys->i_length );
             }
@@ -44,6 +44,7 @@
 #include "ts_psip.h"
 
 #include "ts_hotfixes.h"
+#include "ts_record.h"
 #include "ts_sl.h"
 #include "ts_metadata.h"
 #include "sections.h"
@@ -61,6 +62,7 @@
 #endif
 
 #include <assert.h>
+#include <stdatomic.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -123,6 +125,15 @@ static void Close ( vlc_object_t * );
 #define TS_OFFSETFIX_TEXT   "Try to fix too early PCR (or late DTS)"
 #define TS_GENERATED_PCR_OFFSET_TEXT "Offset in ms for generated PCR"
 
+#define THREADS_TEXT N_("Demux threads")
+#define THREADS_LONGTEXT N_("Number of threads gathering and sending " \
+    "the programs data. Packet synchronization and clock handling stay " \
+    "on the input thread. 0 disables threading.")
+
+#define RECORD_TEXT N_("Record selected programs only")
+#define RECORD_LONGTEXT N_("Record the unmodified packets of the selected " \
+    "programs, with a PAT listing only them, instead of the whole stream.")
+
 #define PCR_TEXT N_("Trust in-stream PCR")
 #define PCR_LONGTEXT N_("Use the stream PCR as a reference.")
 
@@ -163,6 +174,9 @@ vlc_module_begin ()
     add_bool( "ts-pcr-offsetfix", true, TS_OFFSETFIX_TEXT, NULL )
     add_integer_with_range( "ts-generated-pcr-offset", 120, 0, 500,
                             TS_GENERATED_PCR_OFFSET_TEXT, NULL )
+    add_bool( "ts-record-programs", false, RECORD_TEXT, RECORD_LONGTEXT )
+    add_integer_with_range( "ts-threads", 0, 0, 32,
+                            THREADS_TEXT, THREADS_LONGTEXT )
 
     set_capability( "demux", 10 )
     set_callbacks( Open, Close )
@@ -190,11 +204,58 @@ static stime_t GetPCR( const block_t * );
 
 static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, int * );
 static bool GatherSectionsData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
-static bool GatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
+static bool GatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t, stime_t );
+static bool DemuxStreamPacket( demux_t *, ts_pid_t *, block_t *, size_t, stime_t );
+static stime_t StreamAppendPCR( demux_sys_t *, const ts_pid_t * );
+static ts_workers_t *TsWorkersNew( demux_t *, unsigned );
+static void TsWorkersDelete( ts_workers_t * );
+static bool TsWorkersPush( demux_t *, ts_pid_t *, block_t *, size_t );
+static void TsWorkersLock( demux_sys_t *, const ts_pmt_t * );
+static void TsWorkersUnlock( demux_sys_t *, const ts_pmt_t * );
+static void TsWorkersPCRFix( demux_t * );
+
+#define TS_WORKER_QUEUE 256 /* packets */
+
+typedef struct
+{
+    ts_pid_t *p_pid;
+    block_t  *p_pkt;
+    size_t    i_skip;
+    stime_t   i_append_pcr;
+} ts_worker_packet_t;
+
+typedef struct
+{
+    demux_t     *p_demux;
+    vlc_thread_t thread;
+
+    vlc_mutex_t  lock;
+    vlc_cond_t   wait;  /* signaled on new packet or quit */
+    vlc_cond_t   done;  /* signaled once a packet is processed */
+    ts_worker_packet_t queue[TS_WORKER_QUEUE];
+    unsigned     i_first;
+    unsigned     i_count;
+    bool         b_busy;
+    bool         b_quit;
+
+    /* Held while demuxing: protects the state of the worker programs */
+    vlc_mutex_t  state_lock;
+} ts_worker_t;
+
+struct ts_workers_t
+{
+    atomic_bool  b_pcrfix; /* a program has its PCR fix pending */
+    unsigned     i_count;
+    ts_worker_t  worker[];
+};
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
-static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, stime_t time );
+static uint64_t TSStreamTell( demux_sys_t * );
+static void TSStreamDrop( demux_sys_t * );
+static int TSStreamSeek( demux_sys_t *, uint64_t );
+static int SeekToTime( demux_t *p_demux, ts_pmt_t *, stime_t time );
+static void IndexAdd( ts_pmt_t *, stime_t, uint64_t, bool );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, stime_t );
 static void PCRFixHandle( demux_t *, ts_pmt_t *, block_t * );
@@ -399,6 +460,12 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_packet_size = i_packet_size;
     p_sys->i_packet_header_size = i_packet_header_size;
     p_sys->i_ts_read = 50;
+    p_sys->batch.p_buf = malloc( TS_BATCH_PACKETS * i_packet_size );
+    if( !p_sys->batch.p_buf )
+    {
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
     p_sys->csa = NULL;
     p_sys->b_start_record = false;
 
@@ -413,12 +480,14 @@ static int Open( vlc_object_t *p_this )
     patpid = GetPID(p_sys, 0);
     if ( !PIDSetup( p_demux, TYPE_PAT, patpid, NULL ) )
     {
+        free( p_sys->batch.p_buf );
         free( p_sys );
         return VLC_ENOMEM;
     }
     if( !ts_psi_PAT_Attach( patpid, p_demux ) )
     {
         PIDRelease( p_demux, patpid );
+        free( p_sys->batch.p_buf );
         free( p_sys );
         return VLC_EGENERIC;
     }
@@ -536,6 +605,14 @@ static int Open( vlc_object_t *p_this )
     else
         p_sys->es_creation = CREATE_ES;
 
+    const int i_threads = var_InheritInteger( p_demux, "ts-threads" );
+    if( i_threads > 0 )
+    {
+        p_sys->p_workers = TsWorkersNew( p_demux, i_threads );
+        if( p_sys->p_workers )
+            msg_Dbg( p_demux, "demuxing programs on %d threads", i_threads );
+    }
+
     /* Preparse time */
     if( p_demux->b_preparsing && p_sys->b_canseek )
     {
@@ -561,6 +638,12 @@ static void Close( vlc_object_t *p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    if( p_sys->p_workers )
+        TsWorkersDelete( p_sys->p_workers );
+
+    if( p_sys->p_record )
+        ts_record_Delete( p_demux, p_sys->p_record );
+
     PIDRelease( p_demux, GetPID(p_sys, 0) );
 
     vlc_mutex_lock( &p_sys->csa_lock );
@@ -591,6 +674,7 @@ static void Close( vlc_object_t *p_this )
     /* Clear up attachments */
     vlc_dictionary_clear( &p_sys->attachments, FreeDictAttachment, NULL );
 
+    free( p_sys->batch.p_buf );
     free( p_sys );
 }
 
@@ -624,10 +708,14 @@ static int Demux( demux_t *p_demux )
     demux_sys_t *p_sys = p_demux->p_sys;
     bool b_wait_es = p_sys->i_pmt_es <= 0;
 
+    if( p_sys->p_workers )
+        TsWorkersPCRFix( p_demux );
+
     /* If we had no PAT within MIN_PAT_INTERVAL, create PAT/PMT from probed streams */
     if( p_sys->i_pmt_es == 0 && !SEEN(GetPID(p_sys, 0)) && p_sys->patfix.status == PAT_MISSING )
     {
         msg_Warn( p_demux, "Generating PAT as we still have not received one" );
+        TsWorkersSync( p_sys );
         MissingPATPMTFixup( p_demux );
         GetPID(p_sys, 0)->u.p_pat->b_generated = true;
         p_sys->patfix.status = PAT_FIXTRIED;
@@ -641,17 +729,24 @@ static int Demux( demux_t *p_demux )
         block_t     *p_pkt;
         if( !(p_pkt = ReadTSPacket( p_demux )) )
         {
+            TsWorkersSync( p_sys );
             return VLC_DEMUXER_EOF;
         }
 
         if( p_sys->b_start_record )
         {
             /* Enable recording once synchronized */
-            vlc_stream_Control( p_sys->stream, STREAM_SET_RECORD_STATE, true,
-                                "ts" );
+            if( var_InheritBool( p_demux, "ts-record-programs" ) )
+                p_sys->p_record = ts_record_New( p_demux );
+            else
+                vlc_stream_Control( p_sys->stream, STREAM_SET_RECORD_STATE, true,
+                                    "ts" );
             p_sys->b_start_record = false;
         }
 
+        if( p_sys->p_record && p_pkt->i_buffer >= TS_PACKET_SIZE_188 )
+            ts_record_Packet( p_demux, p_sys->p_record, p_pkt->p_buffer );
+
         /* Early reject truncated packets from hw devices */
         if( unlikely(p_pkt->i_buffer < TS_PACKET_SIZE_188) )
         {
@@ -718,10 +813,25 @@ static int Demux( demux_t *p_demux )
             if( p_sys->es_creation == DELAY_ES ) /* No longer delay ES since that pid's program sends data */
             {
                 msg_Dbg( p_demux, "Creating delayed ES" );
+                TsWorkersSync( p_sys );
                 AddAndCreateES( p_demux, p_pid, true );
                 UpdatePESFilters( p_demux, p_sys->seltype == PROGRAM_ALL );
             }
 
+            /* Index video random access points, for faster seeking */
+            if( p_sys->b_canfastseek &&
+                (p_pkt->p_buffer[1] & 0x40) && /* Payload start */
+                (p_pkt->p_buffer[3] & 0x20) && p_pkt->p_buffer[4] > 0 &&
+                (p_pkt->p_buffer[5] & 0x40) ) /* random_access_indicator */
+            {
+                const ts_es_t *p_es = p_pid->u.p_stream->p_es;
+                stime_t i_current;
+                if( p_es && p_es->fmt.i_cat == VIDEO_ES && p_es->p_program &&
+                    (i_current = StreamAppendPCR( p_sys, p_pid )) > -1 )
+                    IndexAdd( p_es->p_program, i_current,
+                              TSStreamTell( p_sys ) - p_sys->i_packet_size, true );
+            }
+
             /* Emulate HW filter */
             if( !p_sys->b_access_control && !(p_pid->i_flags & FLAG_FILTERED) )
             {
@@ -730,19 +840,11 @@ static int Demux( demux_t *p_demux )
                 continue;
             }
 
-            if( p_pid->u.p_stream->transport == TS_TRANSPORT_PES )
-            {
-                b_frame = GatherPESData( p_demux, p_pid, p_pkt, i_header );
-            }
-            else if( p_pid->u.p_stream->transport == TS_TRANSPORT_SECTIONS )
-            {
-                b_frame = GatherSectionsData( p_demux, p_pid, p_pkt, i_header );
-            }
-            else // pid->u.p_pes->transport == TS_TRANSPORT_IGNORE
-            {
-                block_Release( p_pkt );
-            }
+            if( p_sys->p_workers && TsWorkersPush( p_demux, p_pid, p_pkt, i_header ) )
+                break;
 
+            b_frame = DemuxStreamPacket( p_demux, p_pid, p_pkt, i_header,
+                                         StreamAppendPCR( p_sys, p_pid ) );
             break;
 
         case TYPE_SI:
@@ -897,9 +999,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     bool b_bool, *pb_bool;
     int64_t i64;
     int i_int;
-    const ts_pmt_t *p_pmt = NULL;
+    ts_pmt_t *p_pmt = NULL;
     const ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
 
+    TsWorkersSync( p_sys );
+
     for( int i=0; i<p_pat->programs.i_size && !p_pmt; i++ )
     {
         if( p_pat->programs.p_elems[i]->u.p_pmt->b_selected )
@@ -953,7 +1057,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         if( (i64 = stream_Size( p_sys->stream) ) > 0 )
         {
-            uint64_t offset = vlc_stream_Tell( p_sys->stream );
+            uint64_t offset = TSStreamTell( p_sys );
             *pf = (double)offset / (double)i64;
             return VLC_SUCCESS;
         }
@@ -1000,7 +1104,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         i64 = stream_Size( p_sys->stream );
         if( i64 > 0 &&
-            vlc_stream_Seek( p_sys->stream, (int64_t)(i64 * f) ) == VLC_SUCCESS )
+            TSStreamSeek( p_sys, (int64_t)(i64 * f) ) == VLC_SUCCESS )
         {
             ReadyQueuesPostSeek( p_demux );
             return VLC_SUCCESS;
@@ -1151,9 +1255,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     }
 
     case DEMUX_SET_TITLE:
+        TSStreamDrop( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_TITLE, args );
 
     case DEMUX_SET_SEEKPOINT:
+        TSStreamDrop( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_SEEKPOINT,
                                      args );
 
@@ -1176,7 +1282,12 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     case DEMUX_SET_RECORD_STATE:
         b_bool = va_arg( args, int );
 
-        if( !b_bool )
+        if( !b_bool && p_sys->p_record )
+        {
+            ts_record_Delete( p_demux, p_sys->p_record );
+            p_sys->p_record = NULL;
+        }
+        else if( !b_bool )
             vlc_stream_Control( p_sys->stream, STREAM_SET_RECORD_STATE,
                                 false );
         p_sys->b_start_record = b_bool;
@@ -1766,14 +1877,105 @@ static void PESDataChainHandle( vlc_object_t *p_obj, void *priv, block_t *p_data
     ParsePESDataChain( (demux_t *)p_obj, (ts_pid_t *) priv, p_data, i_appendpcr );
 }
 
+static void TSPacketRelease( block_t *p_pkt )
+{
+    /* The packet views the read batch, owned by the demuxer */
+    VLC_UNUSED(p_pkt);
+}
+
+static const struct vlc_block_callbacks ts_packet_cbs =
+{
+    TSPacketRelease,
+};
+
+/* Position of the next packet ReadTSPacket will return */
+static uint64_t TSStreamTell( demux_sys_t *p_sys )
+{
+    return vlc_stream_Tell( p_sys->stream ) -
+           ( p_sys->batch.i_size - p_sys->batch.i_pos );
+}
+
+/* Discards the packets read ahead, when the stream is moved */
+static void TSStreamDrop( demux_sys_t *p_sys )
+{
+    p_sys->batch.i_size = p_sys->batch.i_pos = p_sys->batch.i_clear = 0;
+}
+
+static int TSStreamSeek( demux_sys_t *p_sys, uint64_t i_pos )
+{
+    TSStreamDrop( p_sys );
+    return vlc_stream_Seek( p_sys->stream, i_pos );
+}
+
+/* Makes at least i_want bytes available in the batch, unless at end of
+ * stream, and returns the number of available bytes.
+ * Only waits for the wanted bytes: further packets are only read if the
+ * access already has them, so that live streams do not get delayed. */
+static size_t TSStreamPeekBatch( demux_sys_t *p_sys, size_t i_want )
+{
+    const size_t i_alloc = TS_BATCH_PACKETS * p_sys->i_packet_size;
+    size_t i_avail = p_sys->batch.i_size - p_sys->batch.i_pos;
+
+    assert( i_want <= i_alloc );
+    if( i_avail >= i_want )
+        return i_avail;
+
+    memmove( p_sys->batch.p_buf, &p_sys->batch.p_buf[p_sys->batch.i_pos],
+             i_avail );
+    if( p_sys->batch.i_clear > p_sys->batch.i_pos )
+        p_sys->batch.i_clear -= p_sys->batch.i_pos;
+    else
+        p_sys->batch.i_clear = 0;
+    p_sys->batch.i_pos = 0;
+
+    while( i_avail < i_want )
+    {
+        ssize_t i_read = vlc_stream_ReadPartial( p_sys->stream,
+                                                 &p_sys->batch.p_buf[i_avail],
+                                                 i_alloc - i_avail );
+        if( i_read <= 0 )
+            break;
+        i_avail += i_read;
+    }
+    p_sys->batch.i_size = i_avail;
+
+    return i_avail;
+}
+
+/* Descrambles the synchronized packets read ahead at once, as batches are
+ * much faster than single packets */
+static void TSStreamDescramble( demux_sys_t *p_sys )
+{
+    uint8_t *pp_pkts[TS_BATCH_PACKETS];
+    unsigned i_pkts = 0;
+    size_t i_pos = p_sys->batch.i_pos;
+
+    while( p_sys->batch.i_size - i_pos >= p_sys->i_packet_size )
+    {
+        uint8_t *p = &p_sys->batch.p_buf[i_pos + p_sys->i_packet_header_size];
+        if( p[0] != 0x47 )
+            break;
+        if( p[3]&0x80 )
+            pp_pkts[i_pkts++] = p;
+        i_pos += p_sys->i_packet_size;
+    }
+    p_sys->batch.i_clear = i_pos;
+
+    if( i_pkts > 0 )
+    {
+        vlc_mutex_lock( &p_sys->csa_lock );
+        csa_DecryptBatch( p_sys->csa, pp_pkts, i_pkts, p_sys->i_csa_pkt_size );
+        vlc_mutex_unlock( &p_sys->csa_lock );
+    }
+}
+
 static block_t* ReadTSPacket( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
-    block_t     *p_pkt;
-
     /* Get a new TS packet */
-    if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
+    size_t i_avail = TSStreamPeekBatch( p_sys, p_sys->i_packet_size );
+    if( i_avail == 0 )
     {
         int64_t size = stream_Size( p_sys->stream );
         if( size >= 0 && (uint64_t)size == vlc_stream_Tell( p_sys->stream ) )
@@ -1783,37 +1985,30 @@ static block_t* ReadTSPacket( demux_t *p_demux )
         return NULL;
     }
 
-    if( p_pkt->i_buffer < TS_HEADER_SIZE + p_sys->i_packet_header_size )
+    if( i_avail < TS_HEADER_SIZE + p_sys->i_packet_header_size )
     {
-        block_Release( p_pkt );
+        p_sys->batch.i_pos += i_avail;
         return NULL;
     }
 
-    /* Skip header (BluRay streams).
-     * re-sync logic would do this (by adjusting packet start), but this would result in losing first and last ts packets.
-     * First packet is usually PAT, and losing it means losing whole first GOP. This is fatal with still-image based menus.
-     */
-    p_pkt->p_buffer += p_sys->i_packet_header_size;
-    p_pkt->i_buffer -= p_sys->i_packet_header_size;
-
     /* Check sync byte and re-sync if needed */
-    if( p_pkt->p_buffer[0] != 0x47 )
+    if( p_sys->batch.p_buf[p_sys->batch.i_pos + p_sys->i_packet_header_size] != 0x47 )
     {
         msg_Warn( p_demux, "lost synchro" );
-        block_Release( p_pkt );
+        p_sys->batch.i_pos += __MIN( i_avail, p_sys->i_packet_size );
         for( ;; )
         {
             const uint8_t *p_peek;
-            int i_peek = 0;
+            size_t i_peek = 0;
             unsigned i_skip = 0;
 
-            i_peek = vlc_stream_Peek( p_sys->stream, &p_peek,
-                    p_sys->i_packet_size * 10 );
-            if( i_peek < 0 || (unsigned)i_peek < p_sys->i_packet_size + 1 )
+            i_peek = TSStreamPeekBatch( p_sys, p_sys->i_packet_size * 10 );
+            if( i_peek < p_sys->i_packet_size + 1 )
             {
                 msg_Dbg( p_demux, "eof ?" );
                 return NULL;
             }
+            p_peek = &p_sys->batch.p_buf[p_sys->batch.i_pos];
 
             while( i_skip < i_peek - p_sys->i_packet_size )
             {
@@ -1825,22 +2020,40 @@ static block_t* ReadTSPacket( demux_t *p_demux )
                 i_skip++;
             }
             msg_Dbg( p_demux, "skipping %d bytes of garbage at %"PRIu64,
-                     i_skip, vlc_stream_Tell( p_sys->stream ) );
-            if (vlc_stream_Read( p_sys->stream, NULL, i_skip ) != i_skip)
-                return NULL;
+                     i_skip, TSStreamTell( p_sys ) );
+            p_sys->batch.i_pos += i_skip;
 
             if( i_skip < i_peek - p_sys->i_packet_size )
             {
                 break;
             }
         }
-        msg_Dbg( p_demux, "resynced at %" PRIu64, vlc_stream_Tell( p_sys->stream ) );
-        if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
+        msg_Dbg( p_demux, "resynced at %" PRIu64, TSStreamTell( p_sys ) );
+        i_avail = TSStreamPeekBatch( p_sys, p_sys->i_packet_size );
+        if( i_avail < TS_HEADER_SIZE + p_sys->i_packet_header_size )
         {
             msg_Dbg( p_demux, "eof ?" );
             return NULL;
         }
     }
+
+    if( p_sys->csa && p_sys->batch.i_pos >= p_sys->batch.i_clear )
+        TSStreamDescramble( p_sys );
+
+    /* Hand out a view on the batch: nothing keeps TS packets beyond the
+     * processing of the next one, PES payloads being copied when gathered */
+    const size_t i_pkt = __MIN( i_avail, p_sys->i_packet_size );
+    block_t *p_pkt = block_Init( &p_sys->batch.pkt, &ts_packet_cbs,
+                                 &p_sys->batch.p_buf[p_sys->batch.i_pos], i_pkt );
+    p_sys->batch.i_pos += i_pkt;
+
+    /* Skip header (BluRay streams).
+     * re-sync logic would do this (by adjusting packet start), but this would result in losing first and last ts packets.
+     * First packet is usually PAT, and losing it means losing whole first GOP. This is fatal with still-image based menus.
+     */
+    p_pkt->p_buffer += p_sys->i_packet_header_size;
+    p_pkt->i_buffer -= p_sys->i_packet_header_size;
+
     return p_pkt;
 }
 
@@ -1905,7 +2118,6 @@ static inline void FlushESBuffer( ts_stream_t *p_pes )
         p_pes->gather.i_gathered = p_pes->gather.i_data_size = 0;
         block_ChainRelease( p_pes->gather.p_data );
         p_pes->gather.p_data = NULL;
-        p_pes->gather.pp_last = &p_pes->gather.p_data;
         p_pes->gather.i_saved = 0;
     }
     if( p_pes->p_proc )
@@ -1951,23 +2163,93 @@ static void ReadyQueuesPostSeek( demux_t *p_demux )
     }
 }
 
-static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaledtime )
+/* One entry per interval, random access points being preferred */
+#define TS_INDEX_INTERVAL TO_SCALE_NZ(VLC_TICK_FROM_SEC(1))
+/* Farthest random access point before the target a seek can land on */
+#define TS_INDEX_RAP_REACH TO_SCALE_NZ(VLC_TICK_FROM_SEC(5))
+
+/* Returns the position of the first index entry after i_time */
+static int IndexFind( const ts_pmt_t *p_pmt, stime_t i_time )
+{
+    int i_low = 0;
+    int i_high = p_pmt->index.i_size;
+
+    while( i_low < i_high )
+    {
+        int i_mid = (i_low + i_high) / 2;
+        if( p_pmt->index.p_elems[i_mid].i_time <= i_time )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+static void IndexAdd( ts_pmt_t *p_pmt, stime_t i_time, uint64_t i_pos, bool b_rap )
+{
+    const int i = IndexFind( p_pmt, i_time );
+    ts_index_entry_t *p_prev = (i > 0) ? &p_pmt->index.p_elems[i - 1] : NULL;
+    const ts_index_entry_t *p_next = (i < p_pmt->index.i_size)
+                                   ? &p_pmt->index.p_elems[i] : NULL;
+
+    /* Same packet, i.e. PCR on a random access point */
+    if( p_prev && p_prev->i_pos == i_pos )
+    {
+        p_prev->b_rap |= b_rap;
+        return;
+    }
+
+    /* Offsets must grow with time, or there is a discontinuity */
+    if( (p_prev && p_prev->i_pos >= i_pos) || (p_next && p_next->i_pos <= i_pos) )
+        return;
+
+    const ts_index_entry_t entry = { .i_time = i_time, .i_pos = i_pos,
+                                     .b_rap = b_rap };
+    if( p_prev && i_time - p_prev->i_time < TS_INDEX_INTERVAL )
+    {
+        if( b_rap && !p_prev->b_rap )
+            *p_prev = entry;
+        return;
+    }
+    ARRAY_INSERT( p_pmt->index, entry, i );
+}
+
+static int SeekToTime( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_scaledtime )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
     /* Deal with common but worst binary search case */
     if( p_pmt->pcr.i_first == i_scaledtime && p_sys->b_canseek )
-        return vlc_stream_Seek( p_sys->stream, 0 );
+        return TSStreamSeek( p_sys, 0 );
 
     const int64_t i_stream_size = stream_Size( p_sys->stream );
     if( !p_sys->b_canfastseek || i_stream_size < p_sys->i_packet_size )
         return VLC_EGENERIC;
 
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TSStreamTell( p_sys );
 
-    /* Find the time position by using binary search algorithm. */
-    uint64_t i_head_pos = 0;
+    /* Land on a random access point seen close before the target */
+    const int i_next = IndexFind( p_pmt, i_scaledtime );
+    for( int i = i_next - 1; i >= 0; i-- )
+    {
+        const ts_index_entry_t *p_entry = &p_pmt->index.p_elems[i];
+        if( i_scaledtime - p_entry->i_time > TS_INDEX_RAP_REACH )
+            break;
+        if( p_entry->b_rap )
+            return TSStreamSeek( p_sys, p_entry->i_pos );
+    }
+
+    /* Find the time position by using binary search algorithm,
+     * between the closest positions known from the index. */
+    const bool b_head = i_next > 0; /* the index entries may move */
+    const uint64_t i_index_head = b_head ? p_pmt->index.p_elems[i_next - 1].i_pos : 0;
+    uint64_t i_head_pos = i_index_head;
     uint64_t i_tail_pos = (uint64_t) i_stream_size - p_sys->i_packet_size;
+    if( i_next < p_pmt->index.i_size &&
+        p_pmt->index.p_elems[i_next].i_pos < i_tail_pos )
+        i_tail_pos = p_pmt->index.p_elems[i_next].i_pos;
+    if( b_head && i_head_pos + p_sys->i_packet_size > i_tail_pos )
+        return TSStreamSeek( p_sys, i_index_head );
     if( i_head_pos >= i_tail_pos )
         return VLC_EGENERIC;
 
@@ -1979,7 +2261,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
         uint64_t i_div = i_splitpos % p_sys->i_packet_size;
         i_splitpos -= i_div;
 
-        if ( vlc_stream_Seek( p_sys->stream, i_splitpos ) != VLC_SUCCESS )
+        if ( TSStreamSeek( p_sys, i_splitpos ) != VLC_SUCCESS )
             break;
 
         uint64_t i_pos = i_splitpos;
@@ -1993,7 +2275,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
                 break;
             }
             else
-                i_pos = vlc_stream_Tell( p_sys->stream );
+                i_pos = TSStreamTell( p_sys );
 
             int i_pid = PIDGet( p_pkt );
             ts_pid_t *p_pid = GetPID(p_sys, i_pid);
@@ -2010,6 +2292,9 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
                     {
                         if( p_pmt->i_pid_pcr == i_pid )
                             i_pcr = GetPCR( p_pkt );
+                        if( i_pcr != -1 )
+                            IndexAdd( p_pmt, TimeStampWrapAround( p_pmt->pcr.i_first, i_pcr ),
+                                      i_pos - p_sys->i_packet_size, false );
                         i_skip += 1 + __MIN(p_pkt->p_buffer[4], 182);
                     }
                 }
@@ -2047,10 +2332,13 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
             i_tail_pos = (i_splitpos >= p_sys->i_packet_size) ? i_splitpos - p_sys->i_packet_size : 0;
     }
 
+    if( !b_found && b_head )
+        return TSStreamSeek( p_sys, i_index_head );
+
     if( !b_found )
     {
         msg_Dbg( p_demux, "Seek():cannot find a time position." );
-        if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) != VLC_SUCCESS )
+        if( TSStreamSeek( p_sys, i_initial_pos ) != VLC_SUCCESS )
             msg_Err( p_demux, "Can't seek back to %" PRIu64, i_initial_pos );
         return VLC_EGENERIC;
     }
@@ -2136,7 +2424,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, bool *pb_fou
                         if( b_end )
                         {
                             p_pmt->i_last_dts = i_pcr;
-                            p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                            p_pmt->i_last_dts_byte = TSStreamTell( p_sys );
                         }
                         /* Start, only keep first */
                         else if( b_pcrresult && p_pmt->pcr.i_first == -1 )
@@ -2164,7 +2452,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, bool *pb_fou
 int ProbeStart( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TSStreamTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
     int i_probe_count = 0;
@@ -2176,7 +2464,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
         i_pos = (int64_t)p_sys->i_packet_size * i_probe_count;
         i_pos = __MIN( i_pos, i_stream_size );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TSStreamSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         int i_count =  ProbeChunk( p_demux, i_program, false, &b_found );
@@ -2188,7 +2476,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
     } while( i_pos < i_stream_size && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TSStreamSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2197,7 +2485,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
 int ProbeEnd( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TSStreamTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
     int i_probe_count = PROBE_CHUNK_COUNT;
@@ -2209,7 +2497,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
         i_pos = i_stream_size - (p_sys->i_packet_size * i_probe_count);
         i_pos = __MAX( i_pos, 0 );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TSStreamSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         int i_count = ProbeChunk( p_demux, i_program, true, &b_found );
@@ -2221,7 +2509,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
     } while( i_pos > 0 && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TSStreamSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2241,6 +2529,8 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
         for( int i=0; i< p_pat->programs.i_size; i++ )
         {
             ts_pmt_t *p_opmt = p_pat->programs.p_elems[i]->u.p_pmt;
+            if( p_sys->p_workers && p_opmt != p_pmt )
+                continue; /* owned by another worker */
             for( int j=0; j<p_opmt->e_streams.i_size; j++ )
             {
                 ts_pid_t *p_pid = p_opmt->e_streams.p_elems[j];
@@ -2274,16 +2564,17 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
     if ( p_sys->i_pmt_es )
     {
         es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, FROM_SCALE(i_pcr) );
-        /* growing files/named fifo handling */
+        /* growing files/named fifo handling, not from a worker thread */
         if( p_sys->b_access_control == false &&
-            vlc_stream_Tell( p_sys->stream ) > p_pmt->i_last_dts_byte )
+            !(p_sys->p_workers && p_pmt->pcr.b_disable) &&
+            TSStreamTell( p_sys ) > p_pmt->i_last_dts_byte )
         {
             if( p_pmt->i_last_dts_byte == 0 ) /* first run */
                 p_pmt->i_last_dts_byte = stream_Size( p_sys->stream );
             else
             {
                 p_pmt->i_last_dts = i_pcr;
-                p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                p_pmt->i_last_dts_byte = TSStreamTell( p_sys );
             }
         }
     }
@@ -2291,24 +2582,15 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
 
 static int IsVideoEnd( ts_pid_t *p_pid )
 {
-    /* jump to near end of PES packet */
-    block_t *p = p_pid->u.p_stream->gather.p_data;
-    if( !p || !p->p_next )
-        return 0;
-    while( p->p_next->p_next )
-        p = p->p_next;
-    if( p->p_next->i_buffer > 4)
-        p = p->p_next;
-
-    /* extract last bytes */
-    uint8_t tail[ 188 ];
-    const int i_tail = block_ChainExtract( p, tail, sizeof( tail ) );
-    if( i_tail < 4 )
+    /* gathered data is a single block */
+    const block_t *p = p_pid->u.p_stream->gather.p_data;
+    if( !p || p->i_buffer < 4 )
         return 0;
 
     /* check for start code at end */
-    return ( tail[ i_tail - 4 ] == 0 && tail[ i_tail - 3 ] == 0 && tail[ i_tail - 2 ] == 1 &&
-             ( tail[ i_tail - 1 ] == 0xb7 ||  tail[ i_tail - 1 ] == 0x0a ) );
+    const uint8_t *tail = &p->p_buffer[p->i_buffer - 4];
+    return ( tail[0] == 0 && tail[1] == 0 && tail[2] == 1 &&
+             ( tail[3] == 0xb7 || tail[3] == 0x0a ) );
 }
 
 static void PCRCheckDTS( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr)
@@ -2396,6 +2678,8 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
         ts_pmt_t *p_pmt = p_pat->programs.p_elems[i]->u.p_pmt;
         if( p_pmt->pcr.b_disable )
             continue;
+
+        TsWorkersLock( p_sys, p_pmt );
         stime_t i_program_pcr = TimeStampWrapAround( p_pmt->pcr.i_first, i_pcr );
 
         if( p_pmt->i_pid_pcr == 0x1FFF ) /* That program has no dedicated PCR pid ISO/IEC 13818-1 2.4.4.9 */
@@ -2414,9 +2698,12 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
                 /* We've found a target group for update */
                 PCRCheckDTS( p_demux, p_pmt, i_pcr );
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
+                if( p_sys->b_canfastseek )
+                    IndexAdd( p_pmt, i_program_pcr,
+                              TSStreamTell( p_sys ) - p_sys->i_packet_size, false );
             }
         }
-
+        TsWorkersUnlock( p_sys, p_pmt );
     }
 }
 
@@ -2458,6 +2745,24 @@ int FindPCRCandidate( ts_pmt_t *p_pmt )
         return 0x1FFF;
 }
 
+static void PCRFixSelect( demux_t *p_demux, ts_pmt_t *p_pmt )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_pmt->pcr.i_current < 0 &&
+        GetPID( p_sys, p_pmt->i_pid_pcr )->probed.i_pcr_count == 0 )
+    {
+        int i_cand = FindPCRCandidate( p_pmt );
+        p_pmt->i_pid_pcr = i_cand;
+        if ( GetPID( p_sys, p_pmt->i_pid_pcr )->probed.i_pcr_count == 0 ) /* does not have PCR field */
+            p_pmt->pcr.b_disable = true;
+        msg_Warn( p_demux, "No PCR received for program %d, set up workaround using pid %d",
+                  p_pmt->i_number, i_cand );
+        UpdatePESFilters( p_demux, p_sys->seltype == PROGRAM_ALL );
+    }
+    p_pmt->pcr.b_fix_done = true;
+}
+
 /* Tries to reselect a new PCR when none has been received */
 static void PCRFixHandle( demux_t *p_demux, ts_pmt_t *p_pmt, block_t *p_block )
 {
@@ -2467,7 +2772,7 @@ static void PCRFixHandle( demux_t *p_demux, ts_pmt_t *p_pmt, block_t *p_block )
     if( !p_sys->b_check_pcr_offset && p_pmt->pcr.i_pcroffset == -1 )
         p_pmt->pcr.i_pcroffset = 0;
 
-    if ( p_pmt->pcr.b_disable || p_pmt->pcr.b_fix_done )
+    if ( p_pmt->pcr.b_disable || p_pmt->pcr.b_fix_done || p_pmt->pcr.b_fix_pending )
     {
         return;
     }
@@ -2478,18 +2783,14 @@ static void PCRFixHandle( demux_t *p_demux, ts_pmt_t *p_pmt, block_t *p_block )
     }
     else if( p_block->i_dts - FROM_SCALE(p_pmt->pcr.i_first_dts) > VLC_TICK_FROM_MS(500) ) /* "PCR repeat rate shall not exceed 100ms" */
     {
-        if( p_pmt->pcr.i_current < 0 &&
-            GetPID( p_sys, p_pmt->i_pid_pcr )->probed.i_pcr_count == 0 )
+        if( p_sys->p_workers ) /* selection looks at other pids and filters */
         {
-            int i_cand = FindPCRCandidate( p_pmt );
-            p_pmt->i_pid_pcr = i_cand;
-            if ( GetPID( p_sys, p_pmt->i_pid_pcr )->probed.i_pcr_count == 0 ) /* does not have PCR field */
-                p_pmt->pcr.b_disable = true;
-            msg_Warn( p_demux, "No PCR received for program %d, set up workaround using pid %d",
-                      p_pmt->i_number, i_cand );
-            UpdatePESFilters( p_demux, p_sys->seltype == PROGRAM_ALL );
+            p_pmt->pcr.b_fix_pending = true;
+            atomic_store_explicit( &p_sys->p_workers->b_pcrfix, true,
+                                   memory_order_release );
         }
-        p_pmt->pcr.b_fix_done = true;
+        else
+            PCRFixSelect( p_demux, p_pmt );
     }
 }
 
@@ -2637,7 +2938,8 @@ static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pk
     return p_pkt;
 }
 
-static bool GatherPESData( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pkt, size_t i_skip )
+static bool GatherPESData( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pkt, size_t i_skip,
+                           stime_t i_append_pcr )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
     ts_pes_parse_callback cb = { .p_obj = VLC_OBJECT(p_demux),
@@ -2647,10 +2949,6 @@ static bool GatherPESData( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pkt, si
     p_pkt->p_buffer += i_skip; /* point to PES */
     p_pkt->i_buffer -= i_skip;
 
-    const ts_es_t *p_es = p_pid->u.p_stream->p_es;
-    stime_t i_append_pcr = ( p_es && p_es->p_program )
-                         ? p_es->p_program->pcr.i_current : TS_TICK_UNKNOWN;
-
     return ts_pes_Gather( &cb, p_pid->u.p_stream,
                           p_pkt, b_unit_start,
                           p_sys->b_valid_scrambling,
@@ -2678,6 +2976,239 @@ static bool GatherSectionsData( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pk
     return b_ret;
 }
 
+static bool DemuxStreamPacket( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pkt,
+                               size_t i_skip, stime_t i_append_pcr )
+{
+    switch( p_pid->u.p_stream->transport )
+    {
+        case TS_TRANSPORT_PES:
+            return GatherPESData( p_demux, p_pid, p_pkt, i_skip, i_append_pcr );
+        case TS_TRANSPORT_SECTIONS:
+            return GatherSectionsData( p_demux, p_pid, p_pkt, i_skip );
+        default: /* TS_TRANSPORT_IGNORE */
+            block_Release( p_pkt );
+            return false;
+    }
+}
+
+/* Program clock at the time the packet is read */
+static stime_t StreamAppendPCR( demux_sys_t *p_sys, const ts_pid_t *p_pid )
+{
+    const ts_es_t *p_es = p_pid->u.p_stream->p_es;
+    if( !p_es || !p_es->p_program )
+        return TS_TICK_UNKNOWN;
+
+    ts_pmt_t *p_pmt = p_es->p_program;
+    if( p_sys->p_workers && p_pmt->pcr.b_disable )
+    {
+        /* Clock is then generated from the DTS, by the program worker */
+        TsWorkersLock( p_sys, p_pmt );
+        stime_t i_pcr = p_pmt->pcr.i_current;
+        TsWorkersUnlock( p_sys, p_pmt );
+        return i_pcr;
+    }
+    return p_pmt->pcr.i_current;
+}
+
+/****************************************************************************
+ * Worker threads
+ *
+ * With ts-threads, each program is assigned a worker gathering and sending
+ * the data of its streams, in the order the packets are read. The demux
+ * thread keeps the packets sync, continuity, clock and PSI handling: it
+ * holds the worker state lock when touching a program, and waits for all
+ * workers to be idle (TsWorkersSync) before programs or filters change.
+ ****************************************************************************/
+static ts_worker_t *ProgramWorker( demux_sys_t *p_sys, const ts_pmt_t *p_pmt )
+{
+    ts_workers_t *p_workers = p_sys->p_workers;
+
+    return &p_workers->worker[(unsigned)p_pmt->i_number % p_workers->i_count];
+}
+
+static void TsWorkersLock( demux_sys_t *p_sys, const ts_pmt_t *p_pmt )
+{
+    if( p_sys->p_workers )
+        vlc_mutex_lock( &ProgramWorker( p_sys, p_pmt )->state_lock );
+}
+
+static void TsWorkersUnlock( demux_sys_t *p_sys, const ts_pmt_t *p_pmt )
+{
+    if( p_sys->p_workers )
+        vlc_mutex_unlock( &ProgramWorker( p_sys, p_pmt )->state_lock );
+}
+
+static void *TsWorkerThread( void *data )
+{
+    ts_worker_t *p_worker = data;
+
+    vlc_mutex_lock( &p_worker->lock );
+    for( ;; )
+    {
+        while( p_worker->i_count == 0 && !p_worker->b_quit )
+            vlc_cond_wait( &p_worker->wait, &p_worker->lock );
+        if( p_worker->i_count == 0 )
+            break;
+
+        const ts_worker_packet_t pkt = p_worker->queue[p_worker->i_first];
+        p_worker->i_first = ( p_worker->i_first + 1 ) % TS_WORKER_QUEUE;
+        p_worker->i_count--;
+        p_worker->b_busy = true;
+        vlc_mutex_unlock( &p_worker->lock );
+
+        vlc_mutex_lock( &p_worker->state_lock );
+        DemuxStreamPacket( p_worker->p_demux, pkt.p_pid, pkt.p_pkt,
+                           pkt.i_skip, pkt.i_append_pcr );
+        vlc_mutex_unlock( &p_worker->state_lock );
+
+        vlc_mutex_lock( &p_worker->lock );
+        p_worker->b_busy = false;
+        vlc_cond_signal( &p_worker->done );
+    }
+    vlc_mutex_unlock( &p_worker->lock );
+
+    return NULL;
+}
+
+static ts_workers_t *TsWorkersNew( demux_t *p_demux, unsigned i_count )
+{
+    ts_workers_t *p_workers = malloc( sizeof(*p_workers) +
+                                      i_count * sizeof(p_workers->worker[0]) );
+    if( unlikely(!p_workers) )
+        return NULL;
+
+    atomic_init( &p_workers->b_pcrfix, false );
+    p_workers->i_count = 0;
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        ts_worker_t *p_worker = &p_workers->worker[i];
+
+        p_worker->p_demux = p_demux;
+        vlc_mutex_init( &p_worker->lock );
+        vlc_cond_init( &p_worker->wait );
+        vlc_cond_init( &p_worker->done );
+        vlc_mutex_init( &p_worker->state_lock );
+        p_worker->i_first = 0;
+        p_worker->i_count = 0;
+        p_worker->b_busy = false;
+        p_worker->b_quit = false;
+
+        if( vlc_clone( &p_worker->thread, TsWorkerThread, p_worker,
+                       VLC_THREAD_PRIORITY_INPUT ) )
+        {
+            msg_Warn( p_demux, "cannot create demux thread %u", i );
+            break;
+        }
+        p_workers->i_count++;
+    }
+
+    if( p_workers->i_count == 0 )
+    {
+        free( p_workers );
+        return NULL;
+    }
+    return p_workers;
+}
+
+static void TsWorkersDelete( ts_workers_t *p_workers )
+{
+    for( unsigned i = 0; i < p_workers->i_count; i++ )
+    {
+        ts_worker_t *p_worker = &p_workers->worker[i];
+
+        /* queued packets are processed before leaving */
+        vlc_mutex_lock( &p_worker->lock );
+        p_worker->b_quit = true;
+        vlc_cond_signal( &p_worker->wait );
+        vlc_mutex_unlock( &p_worker->lock );
+        vlc_join( p_worker->thread, NULL );
+    }
+    free( p_workers );
+}
+
+void TsWorkersSync( demux_sys_t *p_sys )
+{
+    ts_workers_t *p_workers = p_sys->p_workers;
+    if( !p_workers )
+        return;
+
+    for( unsigned i = 0; i < p_workers->i_count; i++ )
+    {
+        ts_worker_t *p_worker = &p_workers->worker[i];
+
+        vlc_mutex_lock( &p_worker->lock );
+        while( p_worker->i_count > 0 || p_worker->b_busy )
+            vlc_cond_wait( &p_worker->done, &p_worker->lock );
+        vlc_mutex_unlock( &p_worker->lock );
+    }
+}
+
+/* Queues a packet to its program worker, or returns false if it has
+ * to be demuxed by the caller */
+static bool TsWorkersPush( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pkt, size_t i_skip )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const ts_stream_t *p_stream = p_pid->u.p_stream;
+
+    if( !p_stream->p_es || !p_stream->p_es->p_program ||
+        p_stream->transport == TS_TRANSPORT_IGNORE )
+        return false;
+
+    /* SL sections add and remove the program ES */
+    if( p_stream->i_stream_type == 0x13 )
+    {
+        TsWorkersSync( p_sys );
+        return false;
+    }
+
+    /* The packet views the read batch */
+    ts_worker_packet_t pkt = {
+        .p_pid = p_pid,
+        .p_pkt = block_Duplicate( p_pkt ),
+        .i_skip = i_skip,
+        .i_append_pcr = StreamAppendPCR( p_sys, p_pid ),
+    };
+    block_Release( p_pkt );
+    if( unlikely(!pkt.p_pkt) )
+        return true;
+
+    ts_worker_t *p_worker = ProgramWorker( p_sys, p_stream->p_es->p_program );
+
+    vlc_mutex_lock( &p_worker->lock );
+    while( p_worker->i_count == TS_WORKER_QUEUE )
+        vlc_cond_wait( &p_worker->done, &p_worker->lock );
+    p_worker->queue[(p_worker->i_first + p_worker->i_count) % TS_WORKER_QUEUE] = pkt;
+    p_worker->i_count++;
+    vlc_cond_signal( &p_worker->wait );
+    vlc_mutex_unlock( &p_worker->lock );
+
+    return true;
+}
+
+/* Runs the PCR fixups the workers left to the demux thread */
+static void TsWorkersPCRFix( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !atomic_exchange_explicit( &p_sys->p_workers->b_pcrfix, false,
+                                   memory_order_acquire ) )
+        return;
+
+    TsWorkersSync( p_sys );
+
+    ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
+    for( int i = 0; i < p_pat->programs.i_size; i++ )
+    {
+        ts_pmt_t *p_pmt = p_pat->programs.p_elems[i]->u.p_pmt;
+        if( p_pmt->pcr.b_fix_pending )
+        {
+            p_pmt->pcr.b_fix_pending = false;
+            PCRFixSelect( p_demux, p_pmt );
+        }
+    }
+}
+
 void TsChangeStandard( demux_sys_t *p_sys, ts_standards_e v )
 {
     if( p_sys->standard != TS_STANDARD_AUTO &&
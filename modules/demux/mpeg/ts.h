@@ -24,11 +24,15 @@
     typedef struct arib_instance_t arib_instance_t;
 #endif
 typedef struct csa_t csa_t;
+typedef struct ts_workers_t ts_workers_t;
+typedef struct ts_record_t ts_record_t;
 
 #define TS_USER_PMT_NUMBER (0)
 
 #define TS_PSI_PAT_PID 0x00
 
+#define TS_BATCH_PACKETS 64 /* packets per stream read */
+
 #if (VLC_TICK_INVALID + 1 != VLC_TICK_0)
 #   error "can't define TS_UNKNOWN reference"
 #else
@@ -71,6 +75,16 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* TS packets read ahead, handed out one by one by ReadTSPacket */
+    struct
+    {
+        uint8_t *p_buf;     /* TS_BATCH_PACKETS packets */
+        size_t   i_size;
+        size_t   i_pos;     /* start of the next packet */
+        size_t   i_clear;   /* end of the packets already descrambled */
+        block_t  pkt;       /* view on the current packet */
+    } batch;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
@@ -142,6 +156,10 @@ struct demux_sys_t
 
     /* */
     bool        b_start_record;
+    ts_record_t *p_record; /* selected programs recording, see ts-record-programs */
+
+    /* Per program threads, NULL unless ts-threads is set */
+    ts_workers_t *p_workers;
 };
 
 void TsChangeStandard( demux_sys_t *, ts_standards_e );
@@ -150,6 +168,8 @@ bool ProgramIsSelected( demux_sys_t *, uint16_t i_pgrm );
 
 void UpdatePESFilters( demux_t *p_demux, bool b_all );
 
+void TsWorkersSync( demux_sys_t * );
+
 int ProbeStart( demux_t *p_demux, int i_program );
 int ProbeEnd( demux_t *p_demux, int i_program );
 
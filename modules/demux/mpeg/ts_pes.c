@@ -96,6 +96,50 @@ static uint8_t *FindNextPESHeader( uint8_t *p_buf, size_t i_buffer )
     return NULL;
 }
 
+/* Unbounded PES (video) start with this much room, then double */
+#define PES_GATHER_MIN_ALLOC 16384
+
+/* Copies the payload into the single gathering block, so that no TS packet
+ * outlives its demux iteration and no chain has to be gathered on output */
+static bool ts_pes_Append( ts_stream_t *p_pes, block_t *p_pkt )
+{
+    block_t *p_data = p_pes->gather.p_data;
+    const size_t i_used = p_pes->gather.i_gathered;
+    const size_t i_need = i_used + p_pkt->i_buffer;
+
+    if( p_data == NULL )
+    {
+        size_t i_alloc = __MAX( p_pes->gather.i_data_size, PES_GATHER_MIN_ALLOC );
+        if( i_alloc < i_need )
+            i_alloc = i_need;
+        p_data = block_Alloc( i_alloc );
+        if( unlikely(p_data == NULL) )
+            return false;
+        /* Flags of the first packet apply to the whole PES */
+        p_data->i_flags = p_pkt->i_flags;
+        p_pes->gather.i_alloc = i_alloc;
+    }
+    else if( i_need > p_pes->gather.i_alloc )
+    {
+        size_t i_alloc = __MAX( 2 * p_pes->gather.i_alloc, i_need );
+        p_data = block_Realloc( p_data, 0, i_alloc );
+        if( unlikely(p_data == NULL) )
+        {
+            p_pes->gather.p_data = NULL;
+            p_pes->gather.i_data_size = 0;
+            p_pes->gather.i_gathered = 0;
+            return false;
+        }
+        p_pes->gather.i_alloc = i_alloc;
+    }
+
+    memcpy( &p_data->p_buffer[i_used], p_pkt->p_buffer, p_pkt->i_buffer );
+    p_data->i_buffer = i_need;
+    p_pes->gather.p_data = p_data;
+    p_pes->gather.i_gathered = i_need;
+    return true;
+}
+
 static bool ts_pes_Push( ts_pes_parse_callback *cb,
                   ts_stream_t *p_pes, block_t *p_pkt,
                   bool b_unit_start, stime_t i_append_pcr )
@@ -109,7 +153,6 @@ static bool ts_pes_Push( ts_pes_parse_callback *cb,
         p_pes->gather.p_data = NULL;
         p_pes->gather.i_data_size = 0;
         p_pes->gather.i_gathered = 0;
-        p_pes->gather.pp_last = &p_pes->gather.p_data;
         cb->pf_parse( cb->p_obj, cb->priv, p_datachain, p_pes->gather.i_append_pcr );
         b_ret = true;
     }
@@ -133,8 +176,10 @@ static bool ts_pes_Push( ts_pes_parse_callback *cb,
         return b_ret;
     }
 
-    block_ChainLastAppend( &p_pes->gather.pp_last, p_pkt );
-    p_pes->gather.i_gathered += p_pkt->i_buffer;
+    bool b_appended = ts_pes_Append( p_pes, p_pkt );
+    block_Release( p_pkt );
+    if( unlikely(!b_appended) )
+        return b_ret;
 
     if( p_pes->gather.i_data_size > 0 &&
         p_pes->gather.i_gathered >= p_pes->gather.i_data_size )
@@ -42,8 +42,10 @@ void ts_pid_list_Init( ts_pid_list_t *p_list )
     p_list->pp_all = NULL;
     p_list->i_all = 0;
     p_list->i_all_alloc = 0;
-    p_list->i_last_pid = 0;
-    p_list->p_last = NULL;
+    memset( p_list->p_index, 0, sizeof(p_list->p_index) );
+    p_list->p_index[0] = &p_list->pat;
+    p_list->p_index[0x1FFB] = &p_list->base_si;
+    p_list->p_index[0x1FFF] = &p_list->dummy;
 }
 
 void ts_pid_list_Release( demux_t *p_demux, ts_pid_list_t *p_list )
@@ -80,80 +82,61 @@ static int ts_bsearch_searchkey_Compare( const void *key, const void *other )
 
 ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
 {
-    switch( i_pid )
-    {
-        case 0:
-            return &p_list->pat;
-        case 0x1FFB:
-            return &p_list->base_si;
-        case 0x1FFF:
-            return &p_list->dummy;
-        default:
-            if( p_list->i_last_pid == i_pid )
-                return p_list->p_last;
-        break;
-    }
+    assert( i_pid < TS_PID_COUNT );
+    i_pid &= TS_PID_COUNT - 1;
 
-    size_t i_index = 0;
-    ts_pid_t *p_pid = NULL;
+    ts_pid_t *p_pid = p_list->p_index[i_pid];
+    if( likely(p_pid != NULL) )
+        return p_pid;
 
-    if( p_list->pp_all )
+    /* First use of that pid: insert it, keeping pp_all sorted */
+    if( p_list->i_all >= p_list->i_all_alloc )
     {
-        struct searchkey pidkey;
-        pidkey.i_pid = i_pid;
-        pidkey.pp_last = NULL;
-
-        ts_pid_t **pp_pidk = bsearch( &pidkey, p_list->pp_all, p_list->i_all,
-                                      sizeof(ts_pid_t *), ts_bsearch_searchkey_Compare );
-        if ( pp_pidk )
-            p_pid = *pp_pidk;
-        else
-            i_index = (pidkey.pp_last - p_list->pp_all); /* Last visited index */
-    }
-
-    if( p_pid == NULL )
-    {
-        if( p_list->i_all >= p_list->i_all_alloc )
-        {
-            ts_pid_t **p_realloc = realloc( p_list->pp_all,
-                                            (p_list->i_all_alloc + PID_ALLOC_CHUNK) * sizeof(ts_pid_t *) );
-            if( !p_realloc )
-            {
-                abort();
-                //return NULL;
-            }
-            p_list->pp_all = p_realloc;
-            p_list->i_all_alloc += PID_ALLOC_CHUNK;
-        }
-
-        p_pid = calloc( 1, sizeof(*p_pid) );
-        if( !p_pid )
+        ts_pid_t **p_realloc = realloc( p_list->pp_all,
+                                        (p_list->i_all_alloc + PID_ALLOC_CHUNK) * sizeof(ts_pid_t *) );
+        if( !p_realloc )
         {
             abort();
             //return NULL;
         }
+        p_list->pp_all = p_realloc;
+        p_list->i_all_alloc += PID_ALLOC_CHUNK;
+    }
 
-        p_pid->i_cc  = 0xff;
-        p_pid->i_pid = i_pid;
+    p_pid = calloc( 1, sizeof(*p_pid) );
+    if( !p_pid )
+    {
+        abort();
+        //return NULL;
+    }
 
+    p_pid->i_cc  = 0xff;
+    p_pid->i_pid = i_pid;
+
+    size_t i_index = 0;
+    if( p_list->i_all )
+    {
         /* Do insertion based on last bsearch mid point */
-        if( p_list->i_all )
-        {
-            if( p_list->pp_all[i_index]->i_pid < i_pid )
-                i_index++;
+        struct searchkey pidkey;
+        pidkey.i_pid = i_pid;
+        pidkey.pp_last = NULL;
 
-            memmove( &p_list->pp_all[i_index + 1],
-                    &p_list->pp_all[i_index],
-                    (p_list->i_all - i_index) * sizeof(ts_pid_t *) );
-        }
+        bsearch( &pidkey, p_list->pp_all, p_list->i_all,
+                 sizeof(ts_pid_t *), ts_bsearch_searchkey_Compare );
+        i_index = (pidkey.pp_last - p_list->pp_all); /* Last visited index */
 
-        p_list->pp_all[i_index] = p_pid;
-        p_list->i_all++;
+        if( p_list->pp_all[i_index]->i_pid < i_pid )
+            i_index++;
 
+        memmove( &p_list->pp_all[i_index + 1],
+                &p_list->pp_all[i_index],
+                (p_list->i_all - i_index) * sizeof(ts_pid_t *) );
     }
 
-    p_list->p_last = p_pid;
-    p_list->i_last_pid = i_pid;
+    p_list->pp_all[i_index] = p_pid;
+    p_list->i_all++;
+
+    p_list->p_index[i_pid] = p_pid;
 
     return p_pid;
 }
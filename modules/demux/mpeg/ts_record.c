@@ -0,0 +1,252 @@
+/*****************************************************************************
+ * ts_record.c : TS programs pass-through recording
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_input_item.h>
+#include <vlc_fs.h>
+
+#ifndef _DVBPSI_DVBPSI_H_
+ #include <dvbpsi/dvbpsi.h>
+#endif
+#include <dvbpsi/descriptor.h>
+#include <dvbpsi/pat.h>
+#include <dvbpsi/pmt.h>
+
+#include "../../mux/mpeg/streams.h"
+#include "../../mux/mpeg/tsutil.h"
+#include "../../mux/mpeg/tables.h"
+
+#include "ts_pid.h"
+#include "ts_streams.h"
+#include "ts_streams_private.h"
+#include "ts.h"
+#include "ts_record.h"
+
+#include <errno.h>
+
+#define TS_PACKET_SIZE 188
+
+struct ts_record_t
+{
+    FILE *f;
+    bool  b_error;
+
+    /* pids of the recorded programs, PAT excepted */
+    uint8_t pids[TS_PID_COUNT / 8];
+
+    /* rewritten PAT */
+    tsmux_stream_t pat;
+    int i_pat_version;
+    DECL_ARRAY(int) numbers;
+    DECL_ARRAY(int) pmt_pids;
+};
+
+static void Write( demux_t *p_demux, ts_record_t *p_rec, const uint8_t *p_buf )
+{
+    const bool b_previous_error = p_rec->b_error;
+
+    p_rec->b_error = fwrite( p_buf, 1, TS_PACKET_SIZE, p_rec->f )
+                     != TS_PACKET_SIZE;
+    if( p_rec->b_error && !b_previous_error )
+        msg_Err( p_demux, "Failed to record data (begin)" );
+    else if( !p_rec->b_error && b_previous_error )
+        msg_Err( p_demux, "Failed to record data (end)" );
+}
+
+static void KeepPID( ts_record_t *p_rec, int i_pid )
+{
+    if( i_pid >= 0 && i_pid < 0x1FFF )
+        p_rec->pids[i_pid >> 3] |= 1 << (i_pid & 7);
+}
+
+static bool IsKept( const ts_record_t *p_rec, uint16_t i_pid )
+{
+    return p_rec->pids[i_pid >> 3] & (1 << (i_pid & 7));
+}
+
+typedef struct
+{
+    demux_t     *p_demux;
+    ts_record_t *p_rec;
+} record_callback_ctx_t;
+
+static void WritePATCallback( void *p_opaque, block_t *p_block )
+{
+    record_callback_ctx_t *ctx = p_opaque;
+
+    while( p_block )
+    {
+        block_t *p_next = p_block->p_next;
+        if( p_block->i_buffer == TS_PACKET_SIZE )
+            Write( ctx->p_demux, ctx->p_rec, p_block->p_buffer );
+        block_Release( p_block );
+        p_block = p_next;
+    }
+}
+
+/* Updates the recorded pids from the currently selected programs,
+ * then writes the PAT listing them */
+static void WritePAT( demux_t *p_demux, ts_record_t *p_rec )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    ts_pid_t *patpid = GetPID(p_sys, 0);
+    const ts_pat_t *p_pat = patpid->u.p_pat;
+    bool b_changed = false;
+    int i_count = 0;
+
+    memset( p_rec->pids, 0, sizeof(p_rec->pids) );
+
+    for( int i = 0; i < p_pat->programs.i_size; i++ )
+    {
+        const ts_pid_t *pmtpid = p_pat->programs.p_elems[i];
+        const ts_pmt_t *p_pmt = pmtpid->u.p_pmt;
+
+        if( !p_pmt->b_selected || p_pmt->i_number == TS_USER_PMT_NUMBER )
+            continue;
+
+        KeepPID( p_rec, pmtpid->i_pid );
+        KeepPID( p_rec, p_pmt->i_pid_pcr );
+        for( int j = 0; j < p_pmt->e_streams.i_size; j++ )
+            KeepPID( p_rec, p_pmt->e_streams.p_elems[j]->i_pid );
+
+        if( i_count < p_rec->numbers.i_size )
+        {
+            if( p_rec->numbers.p_elems[i_count] != p_pmt->i_number ||
+                p_rec->pmt_pids.p_elems[i_count] != pmtpid->i_pid )
+            {
+                p_rec->numbers.p_elems[i_count] = p_pmt->i_number;
+                p_rec->pmt_pids.p_elems[i_count] = pmtpid->i_pid;
+                b_changed = true;
+            }
+        }
+        else
+        {
+            ARRAY_APPEND( p_rec->numbers, p_pmt->i_number );
+            ARRAY_APPEND( p_rec->pmt_pids, pmtpid->i_pid );
+            b_changed = true;
+        }
+        i_count++;
+    }
+
+    if( i_count != p_rec->numbers.i_size )
+    {
+        p_rec->numbers.i_size = i_count;
+        p_rec->pmt_pids.i_size = i_count;
+        b_changed = true;
+    }
+
+    if( b_changed )
+        p_rec->i_pat_version = ( p_rec->i_pat_version + 1 ) % 32;
+
+    if( i_count == 0 )
+        return;
+
+    tsmux_stream_t *pmtstreams = vlc_alloc( i_count, sizeof(*pmtstreams) );
+    if( unlikely(!pmtstreams) )
+        return;
+    for( int i = 0; i < i_count; i++ )
+        pmtstreams[i].i_pid = p_rec->pmt_pids.p_elems[i];
+
+    record_callback_ctx_t ctx = { .p_demux = p_demux, .p_rec = p_rec };
+    BuildPAT( p_pat->handle, &ctx, WritePATCallback,
+              p_pat->i_ts_id < 0 ? 0 : p_pat->i_ts_id, p_rec->i_pat_version,
+              &p_rec->pat, i_count, pmtstreams, p_rec->numbers.p_elems );
+    free( pmtstreams );
+}
+
+ts_record_t * ts_record_New( demux_t *p_demux )
+{
+    char *psz_path = var_InheritString( p_demux, "input-record-path" );
+    if( !psz_path || !*psz_path )
+    {
+        free( psz_path );
+        psz_path = config_GetUserDir( VLC_DOWNLOAD_DIR );
+    }
+    if( !psz_path )
+        return NULL;
+
+    char *psz_file = input_item_CreateFilename( p_demux->p_input_item, psz_path,
+                                                INPUT_RECORD_PREFIX, "ts" );
+    free( psz_path );
+    if( !psz_file )
+        return NULL;
+
+    ts_record_t *p_rec = malloc( sizeof(*p_rec) );
+    if( unlikely(!p_rec) )
+    {
+        free( psz_file );
+        return NULL;
+    }
+
+    p_rec->f = vlc_fopen( psz_file, "wb" );
+    if( !p_rec->f )
+    {
+        msg_Err( p_demux, "cannot record into %s: %s", psz_file,
+                 vlc_strerror_c(errno) );
+        free( psz_file );
+        free( p_rec );
+        return NULL;
+    }
+
+    /* signal new record file */
+    var_SetString( vlc_object_instance(p_demux), "record-file", psz_file );
+    msg_Dbg( p_demux, "Recording selected programs into %s", psz_file );
+    free( psz_file );
+
+    p_rec->b_error = false;
+    memset( p_rec->pids, 0, sizeof(p_rec->pids) );
+    p_rec->pat.i_pid = 0;
+    p_rec->pat.i_continuity_counter = 0;
+    p_rec->pat.b_discontinuity = false;
+    p_rec->i_pat_version = 0;
+    ARRAY_INIT( p_rec->numbers );
+    ARRAY_INIT( p_rec->pmt_pids );
+
+    return p_rec;
+}
+
+void ts_record_Delete( demux_t *p_demux, ts_record_t *p_rec )
+{
+    msg_Dbg( p_demux, "Recording completed" );
+    fclose( p_rec->f );
+    ARRAY_RESET( p_rec->numbers );
+    ARRAY_RESET( p_rec->pmt_pids );
+    free( p_rec );
+}
+
+void ts_record_Packet( demux_t *p_demux, ts_record_t *p_rec, const uint8_t *p_pkt )
+{
+    const uint16_t i_pid = ((p_pkt[1] & 0x1f) << 8) | p_pkt[2];
+
+    if( i_pid == TS_PSI_PAT_PID )
+    {
+        /* Replace the PAT at the stream own rate */
+        if( (p_pkt[1] & 0x40) && !(p_pkt[1] & 0x80) )
+            WritePAT( p_demux, p_rec );
+    }
+    else if( IsKept( p_rec, i_pid ) )
+    {
+        Write( p_demux, p_rec, p_pkt );
+    }
+}
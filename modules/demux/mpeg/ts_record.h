@@ -0,0 +1,31 @@
+/*****************************************************************************
+ * ts_record.h : TS programs pass-through recording
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_RECORD_H
+#define VLC_TS_RECORD_H
+
+typedef struct ts_record_t ts_record_t;
+
+/* Records the TS packets of the selected programs, unmodified,
+ * along with a PAT only listing them */
+ts_record_t * ts_record_New( demux_t * );
+void ts_record_Delete( demux_t *, ts_record_t * );
+void ts_record_Packet( demux_t *, ts_record_t *, const uint8_t *p_pkt );
+
+#endif
@@ -112,6 +112,7 @@ ts_pmt_t *ts_pmt_New( demux_t *p_demux )
     }
 
     ARRAY_INIT( pmt->e_streams );
+    ARRAY_INIT( pmt->index );
 
     pmt->i_version  = -1;
     pmt->i_number   = -1;
@@ -134,6 +135,7 @@ ts_pmt_t *ts_pmt_New( demux_t *p_demux )
     pmt->pcr.i_pcroffset = -1;
 
     pmt->pcr.b_fix_done = false;
+    pmt->pcr.b_fix_pending = false;
 
     pmt->eit.i_event_length = 0;
     pmt->eit.i_event_start = 0;
@@ -152,6 +154,7 @@ void ts_pmt_Del( demux_t *p_demux, ts_pmt_t *pmt )
     for( int i=0; i<pmt->e_streams.i_size; i++ )
         PIDRelease( p_demux, pmt->e_streams.p_elems[i] );
     ARRAY_RESET( pmt->e_streams );
+    ARRAY_RESET( pmt->index );
     if( pmt->p_atsc_si_basepid )
         PIDRelease( p_demux, pmt->p_atsc_si_basepid );
     if( pmt->p_si_sdt_pid )
@@ -285,7 +288,7 @@ ts_stream_t *ts_stream_New( demux_t *p_demux, ts_pmt_t *p_program )
     pes->gather.i_data_size = 0;
     pes->gather.i_gathered = 0;
     pes->gather.p_data = NULL;
-    pes->gather.pp_last = &pes->gather.p_data;
+    pes->gather.i_alloc = 0;
     pes->gather.i_saved = 0;
     pes->gather.i_append_pcr = VLC_TICK_INVALID;
     pes->b_broken_PUSI_conformance = false;
@@ -38,6 +38,14 @@ struct ts_pat_t
 
 };
 
+/* Sparse index of a program, built while reading file */
+typedef struct
+{
+    stime_t  i_time;  /* PCR, wrapped around pcr.i_first */
+    uint64_t i_pos;   /* offset of the TS packet */
+    bool     b_rap;   /* video random access point */
+} ts_index_entry_t;
+
 struct ts_pmt_t
 {
     dvbpsi_t       *handle;
@@ -65,6 +73,7 @@ struct ts_pmt_t
         stime_t i_pcroffset;
         bool    b_disable; /* ignore PCR field, use dts */
         bool    b_fix_done;
+        bool    b_fix_pending; /* left to the demux thread, see ts-threads */
     } pcr;
 
     struct
@@ -76,6 +85,8 @@ struct ts_pmt_t
     stime_t i_last_dts;
     uint64_t i_last_dts_byte;
 
+    DECL_ARRAY(ts_index_entry_t) index; /* sorted by time and offset */
+
     /* ARIB specific */
     struct
     {
@@ -122,8 +133,8 @@ struct ts_stream_t
     {
         size_t      i_data_size;
         size_t      i_gathered;
-        block_t     *p_data;
-        block_t     **pp_last;
+        block_t     *p_data; /* single block, i_alloc bytes allocated */
+        size_t      i_alloc;
         uint8_t     saved[5];
         size_t      i_saved;
         stime_t     i_append_pcr;
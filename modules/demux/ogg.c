@@ -250,6 +250,7 @@ static int Open( vlc_object_t * p_this )
 
     /* Initialize the Ogg physical bitstream parser */
     ogg_sync_init( &p_sys->oy );
+    p_sys->i_page_pos = -1;
 
     /* */
     TAB_INIT( p_sys->i_seekpoints, p_sys->pp_seekpoints );
@@ -519,6 +520,10 @@ static int Demux( demux_t * p_demux )
             {
                 continue;
             }
+
+            if( p_sys->i_page_pos != -1 )
+                OggSeek_IndexAddPage( p_stream, &p_sys->current_page,
+                                      p_sys->i_page_pos );
         }
 
         /* clear the finished flag if pages after eos (ex: after a seek) */
@@ -928,6 +933,12 @@ static int Ogg_ReadPage( demux_t *p_demux, ogg_page *p_oggpage )
         ogg_sync_wrote( &p_ogg->oy, i_read );
     }
 
+    /* the page was just returned from the buffered data */
+    int64_t i_pos = vlc_stream_Tell( p_demux->s );
+    i_pos -= p_ogg->oy.fill - p_ogg->oy.returned;
+    i_pos -= p_oggpage->header_len + p_oggpage->body_len;
+    p_ogg->i_page_pos = i_pos >= 0 ? i_pos : -1;
+
     return VLC_SUCCESS;
 }
 
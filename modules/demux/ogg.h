@@ -196,6 +196,7 @@ typedef struct
 
     /* current page being parsed */
     ogg_page current_page;
+    int64_t i_page_pos; /* where it starts in the file, or -1 */
 
     /* */
     vlc_meta_t          *p_meta;
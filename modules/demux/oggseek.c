@@ -144,31 +144,68 @@ const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
     return idx;
 }
 
+/* Records a page read during playback. Pages are only kept every
+   OGGSEEK_INDEX_INTERVAL, so that later seeks can bisect between close
+   known points instead of over the whole file. */
+void OggSeek_IndexAddPage( logical_stream_t *p_stream, const ogg_page *p_page,
+                           int64_t i_pagepos )
+{
+    int64_t i_granule = ogg_page_granulepos( p_page );
+
+    if ( i_granule < 0 || i_pagepos < p_stream->i_data_start )
+        return;
+
+    /* Decoding must be able to start from any page */
+    if ( Ogg_GetKeyframeGranule( p_stream, 0xFF00FF00 ) != 0xFF00FF00 )
+        return;
+
+    vlc_tick_t i_time = Ogg_GranuleToTime( p_stream, i_granule,
+                                           !p_stream->b_contiguous, false );
+    if ( i_time == VLC_TICK_INVALID )
+        return;
+
+    for ( const demux_index_entry_t *idx = p_stream->idx; idx; idx = idx->p_next )
+    {
+        if ( idx->i_pagepos == i_pagepos ||
+             llabs( idx->i_value - i_time ) < OGGSEEK_INDEX_INTERVAL )
+            return;
+        if ( idx->i_pagepos > i_pagepos )
+            break;
+    }
+
+    OggSeek_IndexAdd( p_stream, i_time, i_pagepos );
+}
+
+/* Narrows the search bounds using the closest indexed pages around the
+   timestamp, and returns the time of the lower one */
 static bool OggSeekIndexFind ( logical_stream_t *p_stream, vlc_tick_t i_timestamp,
-                               int64_t *pi_pos_lower, int64_t *pi_pos_upper )
+                               int64_t *pi_pos_lower, int64_t *pi_pos_upper,
+                               vlc_tick_t *pi_time_lower )
 {
-    demux_index_entry_t *idx = p_stream->idx;
+    const demux_index_entry_t *lower = NULL, *upper = NULL;
 
-    while ( idx != NULL )
+    for ( const demux_index_entry_t *idx = p_stream->idx; idx; idx = idx->p_next )
     {
         if ( idx->i_value <= i_timestamp )
         {
-            if ( !idx->p_next ) /* found on last index */
-            {
-                *pi_pos_lower = idx->i_pagepos;
-                return true;
-            }
-            if ( idx->p_next->i_value > i_timestamp )
-            {
-                *pi_pos_lower = idx->i_pagepos;
-                *pi_pos_upper = idx->p_next->i_pagepos;
-                return true;
-            }
+            lower = idx;
+            upper = NULL;
         }
-        idx = idx->p_next;
+        else if ( lower != NULL && upper == NULL )
+            upper = idx;
     }
 
-    return false;
+    if ( lower == NULL )
+        return false;
+
+    if ( lower->i_pagepos > *pi_pos_lower )
+        *pi_pos_lower = lower->i_pagepos;
+    if ( upper != NULL && ( *pi_pos_upper == -1 || upper->i_pagepos < *pi_pos_upper ) )
+        *pi_pos_upper = upper->i_pagepos;
+    if ( pi_time_lower != NULL )
+        *pi_time_lower = lower->i_value;
+
+    return true;
 }
 
 /*********************************************************************
@@ -787,8 +824,12 @@ int Oggseek_BlindSeektoAbsoluteTime( demux_t *p_demux, logical_stream_t *p_strea
     Ogg_GetBoundsUsingSkeletonIndex( p_stream, i_time, &i_lowerpos, &i_upperpos );
     if ( i_lowerpos != -1 ) b_found = true;
 
-    /* And also search in our own index */
-    if ( !b_found && OggSeekIndexFind( p_stream, i_time, &i_lowerpos, &i_upperpos ) )
+    /* And also search in our own index. Unless the indexed page is close
+     * enough, only use it to narrow the bisection. */
+    vlc_tick_t i_indexed_time;
+    if ( !b_found && OggSeekIndexFind( p_stream, i_time, &i_lowerpos, &i_upperpos,
+                                       &i_indexed_time ) &&
+         ( !b_fastseek || i_time - i_indexed_time <= OGGSEEK_INDEX_INTERVAL ) )
     {
         b_found = true;
     }
@@ -807,7 +848,7 @@ int Oggseek_BlindSeektoAbsoluteTime( demux_t *p_demux, logical_stream_t *p_strea
     if ( !b_found && b_fastseek )
     {
         i_lowerpos = OggBisectSearchByTime( p_demux, p_stream, i_time,
-                                            p_stream->i_data_start, p_sys->i_total_length );
+                                            i_lowerpos, i_upperpos );
         b_found = ( i_lowerpos != -1 );
     }
 
@@ -894,7 +935,7 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
     OggDebug( msg_Dbg( p_demux, "Search bounds set to %"PRId64" %"PRId64" using skeleton index", i_offset_lower, i_offset_upper ) );
 
     OggNoDebug(
-        OggSeekIndexFind( p_stream, i_time, &i_offset_lower, &i_offset_upper )
+        OggSeekIndexFind( p_stream, i_time, &i_offset_lower, &i_offset_upper, NULL )
     );
 
     i_offset_lower = __MAX( i_offset_lower, p_stream->i_data_start );
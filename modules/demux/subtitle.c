@@ -108,9 +108,10 @@ typedef struct
     size_t  i_line_count;
     size_t  i_line;
     char    **line;
+    char    *p_data; /* lines point into it */
 } text_t;
 
-static int  TextLoad( text_t *, stream_t *s );
+static int  TextLoad( text_t *, stream_t *s, const char *psz_charset );
 static void TextUnload( text_t * );
 
 typedef struct
@@ -627,8 +628,9 @@ static int Open ( vlc_object_t *p_this )
 
     msg_Dbg( p_demux, "loading all subtitles..." );
 
-    if( e_bom == UTF8BOM && /* skip BOM */
-        vlc_stream_Read( p_demux->s, NULL, 3 ) != 3 )
+    const size_t i_bom = e_bom == UTF8BOM ? 3 : e_bom == NOBOM ? 0 : 2;
+    if( i_bom > 0 && /* skip BOM */
+        vlc_stream_Read( p_demux->s, NULL, i_bom ) != (ssize_t)i_bom )
     {
         Close( p_this );
         return VLC_EGENERIC;
@@ -636,14 +638,15 @@ static int Open ( vlc_object_t *p_this )
 
     /* Load the whole file */
     text_t txtlines;
-    TextLoad( &txtlines, p_demux->s );
+    TextLoad( &txtlines, p_demux->s,
+              e_bom == UTF16LE || e_bom == UTF16BE ? psz_bom : NULL );
 
     /* Parse it */
-    for( size_t i_max = 0; i_max < SIZE_MAX - 500 * sizeof(subtitle_t); )
+    for( size_t i_max = 0; i_max < SIZE_MAX / (2 * sizeof(subtitle_t)); )
     {
         if( p_sys->subtitles.i_count >= i_max )
         {
-            i_max += 500;
+            i_max = i_max > 0 ? i_max * 2 : 500;
             subtitle_t *p_realloc = realloc( p_sys->subtitles.p_array, sizeof(subtitle_t) * i_max );
             if( p_realloc == NULL )
             {
@@ -905,59 +908,117 @@ static int subtitle_cmp( const void *first, const void *second )
 static void Fix( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
+    size_t i;
+
+    /* Most files are already in order */
+    for( i = 1; i < p_sys->subtitles.i_count; i++ )
+        if( subtitle_cmp( &p_sys->subtitles.p_array[i - 1],
+                          &p_sys->subtitles.p_array[i] ) > 0 )
+            break;
+    if( i >= p_sys->subtitles.i_count )
+        return;
 
     /* *** fix order (to be sure...) *** */
     qsort( p_sys->subtitles.p_array, p_sys->subtitles.i_count, sizeof( p_sys->subtitles.p_array[0] ), subtitle_cmp);
 }
 
-static int TextLoad( text_t *txt, stream_t *s )
+static int TextLoad( text_t *txt, stream_t *s, const char *psz_charset )
 {
-    size_t i_line_max;
+    size_t i_size = 0, i_alloc = 0;
+    char *p_data = NULL;
+    uint64_t i_stream_size;
 
-    /* init txt */
-    i_line_max          = 500;
     txt->i_line_count   = 0;
     txt->i_line         = 0;
-    txt->line           = calloc( i_line_max, sizeof( char * ) );
-    if( !txt->line )
-        return VLC_ENOMEM;
+    txt->line           = NULL;
+    txt->p_data         = NULL;
+
+    /* Read the complete file in one buffer */
+    if( vlc_stream_GetSize( s, &i_stream_size ) == VLC_SUCCESS &&
+        i_stream_size < SIZE_MAX / 2 )
+        i_alloc = i_stream_size + 4096 + 1; /* room to hit EOF */
 
-    /* load the complete file */
     for( ;; )
     {
-        char *psz = vlc_stream_ReadLine( s );
+        if( i_alloc - i_size < 4096 )
+        {
+            i_alloc = __MAX( i_alloc * 2, 65536 );
+            char *p_realloc = realloc( p_data, i_alloc );
+            if( p_realloc == NULL )
+            {
+                free( p_data );
+                return VLC_ENOMEM;
+            }
+            p_data = p_realloc;
+        }
+        else if( p_data == NULL && (p_data = malloc( i_alloc )) == NULL )
+            return VLC_ENOMEM;
 
-        if( psz == NULL )
+        ssize_t i_read = vlc_stream_Read( s, &p_data[i_size],
+                                          i_alloc - i_size - 1 );
+        if( i_read <= 0 )
             break;
+        i_size += i_read;
+    }
+
+    if( psz_charset != NULL )
+    {
+        char *p_conv = FromCharset( psz_charset, p_data, i_size );
+        free( p_data );
+        if( p_conv == NULL )
+            return VLC_EGENERIC;
+        p_data = p_conv;
+        i_size = strlen( p_conv );
+    }
+    p_data[i_size] = '\0';
+
+    /* Split the lines in place, as vlc_stream_ReadLine() would: on LF,
+     * or on CR if there is no LF at all, without the trailing CR/LF */
+    const char eol = memchr( p_data, '\n', i_size ) ? '\n' : '\r';
+    const char *p_end = &p_data[i_size];
+    size_t i_line_max = 0;
+
+    for( char *p = p_data; p < p_end; )
+    {
+        char *psz_eol = memchr( p, eol, p_end - p );
+        char *p_next = psz_eol ? psz_eol + 1 : &p_data[i_size];
+
+        if( psz_eol == NULL )
+            psz_eol = &p_data[i_size];
+        while( psz_eol > p && (psz_eol[-1] == '\r' || psz_eol[-1] == '\n') )
+            psz_eol--;
+        *psz_eol = '\0';
 
-        txt->line[txt->i_line_count] = psz;
-        if( txt->i_line_count + 1 >= i_line_max )
+        if( txt->i_line_count >= i_line_max )
         {
-            i_line_max += 100;
+            i_line_max = __MAX( i_line_max * 2, 500 );
             char **p_realloc = realloc( txt->line, i_line_max * sizeof( char * ) );
             if( p_realloc == NULL )
+            {
+                free( txt->line );
+                free( p_data );
+                txt->line = NULL;
+                txt->i_line_count = 0;
                 return VLC_ENOMEM;
+            }
             txt->line = p_realloc;
         }
-        txt->i_line_count++;
+        txt->line[txt->i_line_count++] = p;
+        p = p_next;
     }
 
+    txt->p_data = p_data;
     if( txt->i_line_count == 0 )
-    {
-        free( txt->line );
         return VLC_EGENERIC;
-    }
 
     return VLC_SUCCESS;
 }
 static void TextUnload( text_t *txt )
 {
-    if( txt->i_line_count )
-    {
-        for( size_t i = 0; i < txt->i_line_count; i++ )
-            free( txt->line[i] );
-        free( txt->line );
-    }
+    free( txt->line );
+    free( txt->p_data );
+    txt->line         = NULL;
+    txt->p_data       = NULL;
     txt->i_line       = 0;
     txt->i_line_count = 0;
 }
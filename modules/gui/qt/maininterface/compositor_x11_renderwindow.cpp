@@ -71,19 +71,28 @@ void RenderTask::render(unsigned int requestId)
     xcb_flush(m_conn);
     xcb_render_picture_t drawingarea = getBackTexture();
 
-    if (m_hasAcrylic)
-    {
-        //clear screen
-        xcb_render_color_t clear = { 0x0000, 0x0000, 0x0000, 0x0000 };
-        xcb_rectangle_t rect = {0, 0, 0xFFFF, 0xFFFF};
-        xcb_render_fill_rectangles(m_conn, XCB_RENDER_PICT_OP_SRC, drawingarea,
-                                   clear, 1, &rect);
-    }
-
+    const QRect windowRect(QPoint(0, 0), m_renderSize.expandedTo(m_interfaceSize));
+    const QRegion damage = m_fullDamage ? QRegion(windowRect) : m_damage & windowRect;
+    m_damage = QRegion();
+    m_fullDamage = false;
 
+    for (const QRect& rect : damage)
     {
+        if (m_hasAcrylic)
+        {
+            //clear screen
+            xcb_render_color_t clear = { 0x0000, 0x0000, 0x0000, 0x0000 };
+            xcb_rectangle_t xrect = {
+                static_cast<int16_t>(rect.x()), static_cast<int16_t>(rect.y()),
+                static_cast<uint16_t>(rect.width()), static_cast<uint16_t>(rect.height())
+            };
+            xcb_render_fill_rectangles(m_conn, XCB_RENDER_PICT_OP_SRC, drawingarea,
+                                       clear, 1, &xrect);
+        }
+
         QMutexLocker lock(&m_pictureLock);
-        if (m_videoEmbed)
+        QRect videoRect = m_videoPosition & rect;
+        if (m_videoEmbed && !videoRect.isEmpty())
         {
             assert(m_videoClient);
             xcb_render_picture_t pic = m_videoClient->getPicture();
@@ -91,29 +100,38 @@ void RenderTask::render(unsigned int requestId)
             {
                 xcb_render_composite(m_conn, XCB_RENDER_PICT_OP_SRC,
                                      pic, 0, drawingarea,
-                                     0,0,0,0,
-                                     m_videoPosition.x(),m_videoPosition.y(),
-                                     m_videoPosition.width(), m_videoPosition.height());
+                                     videoRect.x() - m_videoPosition.x(),
+                                     videoRect.y() - m_videoPosition.y(),
+                                     0,0,
+                                     videoRect.x(), videoRect.y(),
+                                     videoRect.width(), videoRect.height());
             }
         }
 
+        QRect interfaceRect = QRect(QPoint(0, 0), m_interfaceSize) & rect;
         xcb_render_picture_t pic = m_interfaceClient->getPicture();
-        if (pic)
+        if (pic && !interfaceRect.isEmpty())
         {
             xcb_render_composite(m_conn, XCB_RENDER_PICT_OP_OVER,
                                  pic, 0, drawingarea,
-                                 0,0,0,0,
-                                 0, 0, m_interfaceSize.width(), m_interfaceSize.height());
+                                 interfaceRect.x(), interfaceRect.y(), 0,0,
+                                 interfaceRect.x(), interfaceRect.y(),
+                                 interfaceRect.width(), interfaceRect.height());
         }
 
-    } //picture lock scope
-
-    xcb_clear_area(m_conn, 0, m_wid,
-                   0, 0, 0, 0);
+        xcb_clear_area(m_conn, 0, m_wid,
+                       rect.x(), rect.y(), rect.width(), rect.height());
+    }
 
     m_refreshRequestId++;
 }
 
+void RenderTask::addDamage(const QRect& rect)
+{
+    if (!m_fullDamage)
+        m_damage += rect;
+}
+
 void RenderTask::onWindowSizeChanged(const QSize& newSize)
 {
     if (m_renderSize.isValid()
@@ -131,10 +149,21 @@ void RenderTask::onWindowSizeChanged(const QSize& newSize)
         m_renderSize.setHeight(vlc_align(newSize.height(), 128));
     }
     m_resizeRequested = true;
+    m_fullDamage = true;
 }
 
 void RenderTask::requestRefresh()
 {
+    //the interface is rendered as a whole
+    m_fullDamage = true;
+    emit requestRefreshInternal(m_refreshRequestId, {});
+}
+
+void RenderTask::onVideoDamaged()
+{
+    if (!m_videoEmbed)
+        return;
+    addDamage(m_videoPosition);
     emit requestRefreshInternal(m_refreshRequestId, {});
 }
 
@@ -151,6 +180,7 @@ void RenderTask::onVideoSurfaceChanged(CompositorX11RenderClient* surface)
 void RenderTask::onRegisterVideoWindow(unsigned int surface)
 {
     m_videoEmbed = (surface != 0);
+    m_fullDamage = true;
 }
 
 void RenderTask::onVideoPositionChanged(const QRect& position)
@@ -158,6 +188,7 @@ void RenderTask::onVideoPositionChanged(const QRect& position)
     if (m_videoPosition == position)
         return;
     m_videoPosition = position;
+    m_fullDamage = true;
     emit requestRefreshInternal(m_refreshRequestId, {});
 }
 
@@ -166,11 +197,13 @@ void RenderTask::onInterfaceSizeChanged(const QSize& size)
     if (m_interfaceSize == size)
         return;
     m_interfaceSize = size;
+    m_fullDamage = true;
 }
 
 void RenderTask::onVisibilityChanged(bool visible)
 {
     m_visible = visible;
+    m_fullDamage = true;
 }
 
 void RenderTask::onAcrylicChanged(bool enabled)
@@ -414,7 +447,7 @@ bool CompositorX11RenderWindow::startRendering()
     m_damageObserver->moveToThread(m_renderThread);
     connect(m_renderThread, &QThread::started, m_damageObserver, &X11DamageObserver::start);
     connect(this, &CompositorX11RenderWindow::registerVideoWindow, m_damageObserver,  &X11DamageObserver::onRegisterSurfaceDamage);
-    connect(m_damageObserver, &X11DamageObserver::needRefresh, m_renderTask, &RenderTask::requestRefresh);
+    connect(m_damageObserver, &X11DamageObserver::needRefresh, m_renderTask, &RenderTask::onVideoDamaged);
     connect(m_renderThread, &QThread::finished, m_damageObserver, &QObject::deleteLater);
 
     //start the rendering thread
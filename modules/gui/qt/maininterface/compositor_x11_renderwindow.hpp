@@ -26,6 +26,7 @@
 
 #include <QObject>
 #include <QMutex>
+#include <QRegion>
 #include <QMainWindow>
 
 #include <xcb/xcb.h>
@@ -52,6 +53,10 @@ class CompositorX11UISurface;
  * it grab the offscreen surface from the interface and the video and blends
  * them into the output surface. It will refresh the composition when either the
  * interface refresh or the video surface is updated
+ *
+ * Only the damaged area is composed again: a new video frame does not
+ * recompose the interface outside of the video, the interface surface being
+ * damaged as a whole.
  */
 class RenderTask : public QObject
 {
@@ -69,6 +74,7 @@ public slots:
     void onWindowSizeChanged(const QSize& newSize);
 
     void requestRefresh();
+    void onVideoDamaged();
 
     void onInterfaceSurfaceChanged(CompositorX11RenderClient*);
     void onVideoSurfaceChanged(CompositorX11RenderClient*);
@@ -86,6 +92,7 @@ signals:
 
 private:
     xcb_render_picture_t getBackTexture();
+    void addDamage(const QRect& rect);
 
     qt_intf_t* m_intf = nullptr;
     xcb_connection_t* m_conn = nullptr;
@@ -98,6 +105,9 @@ private:
 
     xcb_drawable_t m_wid = 0;
     unsigned int m_refreshRequestId = 0;
+    //area to compose again, the whole window if m_fullDamage is set
+    QRegion m_damage;
+    bool m_fullDamage = true;
     QRect m_videoPosition;
     QSize m_interfaceSize;
 
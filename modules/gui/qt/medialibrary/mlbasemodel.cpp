@@ -171,6 +171,14 @@ QVariant MLBaseModel::data(const QModelIndex &index, int role) const
 
 void MLBaseModel::onResetRequested()
 {
+    /* Reload the visible items in place, the model is only reset if the
+     * count has changed */
+    if (m_cache && m_cache->count() != COUNT_UNINITIALIZED)
+    {
+        m_cache->refresh();
+        return;
+    }
+
     beginResetModel();
     clear();
     endResetModel();
@@ -70,17 +70,34 @@ void MLListCache::refer(size_t index)
         return;
     }
 
-    /* index outside the known portion of the list */
-    if (!m_lastRangeRequested.contains(index))
+    bool forward = index >= m_lastReferred;
+    m_lastReferred = index;
+
+    /* index outside the known portion of the list, or close to its bounds */
+    if (!m_lastRangeRequested.contains(index) || isNearBound(index))
     {
-        /* FIXME bad heuristic if the interval of visible items crosses a cache
-         * page boundary */
-        size_t offset = index - index % m_chunkSize;
-        size_t count = qMin(m_total_count - offset, m_chunkSize);
+        /* load a window of two chunks, mostly ahead of the scroll direction,
+         * so that the visible items never cross its bounds */
+        size_t before = forward ? m_chunkSize / 2 : m_chunkSize * 3 / 2;
+        size_t count = qMin(static_cast<size_t>(m_total_count), 2 * m_chunkSize);
+        size_t offset = index > before ? index - before : 0;
+        offset = qMin(offset, m_total_count - count);
         asyncLoad(offset, count);
     }
 }
 
+bool MLListCache::isNearBound(size_t index) const
+{
+    const size_t margin = m_chunkSize / 4;
+    const MLRange &range = m_lastRangeRequested;
+
+    if (range.offset > 0 && index < range.offset + margin)
+        return true;
+
+    size_t end = range.offset + range.count;
+    return end < static_cast<size_t>(m_total_count) && index + margin >= end;
+}
+
 void MLListCache::asyncCount()
 {
     assert(!m_countTask);
@@ -107,28 +124,125 @@ void MLListCache::asyncCount()
 void MLListCache::asyncLoad(size_t offset, size_t count)
 {
     if (m_loadTask)
+    {
         m_medialib->cancelMLTask(this, m_loadTask);
+        m_loadTask = 0;
+    }
 
     m_lastRangeRequested = { offset, count };
+
+    /* The consecutive windows overlap, only load the items which are not
+     * cached yet. The cache only changes when a load completes, and there is
+     * at most one load at a time, so the cached items are still there when
+     * this one completes. */
+    size_t cachedBegin = m_offset;
+    size_t cachedEnd = m_offset + m_list.size();
+    size_t loadOffset = offset;
+    size_t loadCount = count;
+    if (offset >= cachedBegin && offset < cachedEnd)
+    {
+        loadOffset = cachedEnd;
+        loadCount = offset + count > cachedEnd ? offset + count - cachedEnd : 0;
+    }
+    else if (offset + count > cachedBegin && offset + count <= cachedEnd)
+        loadCount = cachedBegin - offset;
+
+    if (loadCount == 0)
+        /* the whole window is already cached */
+        return;
+
     struct Ctx {
         std::vector<ItemType> list;
     };
     m_loadTask = m_medialib->runOnMLThread<Ctx>(this,
         //ML thread
-        [loader = m_loader, offset, count]
+        [loader = m_loader, loadOffset, loadCount]
         (vlc_medialibrary_t* ml, Ctx& ctx)
         {
-            ctx.list = loader->load(ml, offset, count);
+            ctx.list = loader->load(ml, loadOffset, loadCount);
         },
         //UI thread
-        [this, offset](quint64, Ctx& ctx)
+        [this, offset, count, loadOffset](quint64, Ctx& ctx)
         {
             m_loadTask = 0;
 
+            const size_t loadEnd = loadOffset + ctx.list.size();
+            std::vector<ItemType> list;
+            list.reserve(count);
+            for (size_t i = offset; i < offset + count; ++i)
+            {
+                if (i >= loadOffset && i < loadEnd)
+                    list.push_back(std::move(ctx.list[i - loadOffset]));
+                else if (i >= m_offset && i < m_offset + m_list.size())
+                    list.push_back(std::move(m_list[i - m_offset]));
+                else
+                    /* less items than expected, the content has changed */
+                    break;
+            }
+
+            m_offset = offset;
+            m_list = std::move(list);
+
+            size_t listEnd = m_offset + m_list.size();
+            size_t changedEnd = qMin(loadEnd, listEnd);
+            if (changedEnd > loadOffset)
+                emit localDataChanged(loadOffset, changedEnd - loadOffset);
+        }
+    );
+}
+
+void MLListCache::refresh()
+{
+    assert(m_total_count != COUNT_UNINITIALIZED);
+
+    if (m_loadTask)
+    {
+        m_medialib->cancelMLTask(this, m_loadTask);
+        m_loadTask = 0;
+    }
+    if (m_refreshTask)
+        m_medialib->cancelMLTask(this, m_refreshTask);
+
+    struct Ctx {
+        ssize_t totalCount;
+        std::vector<ItemType> list;
+    };
+    m_refreshTask = m_medialib->runOnMLThread<Ctx>(this,
+        //ML thread
+        [loader = m_loader, range = m_lastRangeRequested]
+        (vlc_medialibrary_t* ml, Ctx& ctx)
+        {
+            ctx.totalCount = loader->count(ml);
+            size_t total = static_cast<size_t>(qMax<ssize_t>(ctx.totalCount, 0));
+            if (range.offset < total)
+                ctx.list = loader->load(ml, range.offset,
+                                        qMin(range.count, total - range.offset));
+        },
+        //UI thread
+        [this, offset = m_lastRangeRequested.offset](quint64, Ctx& ctx)
+        {
+            m_refreshTask = 0;
+
+            /* a load requested meanwhile would merge outdated items */
+            if (m_loadTask)
+            {
+                m_medialib->cancelMLTask(this, m_loadTask);
+                m_loadTask = 0;
+            }
+
+            bool sizeChanged = ctx.totalCount != m_total_count;
+            if (sizeChanged)
+                emit localSizeAboutToBeChanged(ctx.totalCount);
+
+            m_total_count = ctx.totalCount;
             m_offset = offset;
             m_list = std::move(ctx.list);
-            if (m_list.size())
-                emit localDataChanged(offset, m_list.size());
+            m_lastRangeRequested = { m_offset, m_list.size() };
+
+            if (sizeChanged)
+                emit localSizeChanged(m_total_count);
+            else if (m_list.size())
+                emit localDataChanged(m_offset, m_list.size());
         }
     );
 }
@@ -131,9 +131,21 @@ public:
 
     /**
      * Request to load data so that the item as index will become available
+     *
+     * The items around it are loaded too, mostly in the direction the list is
+     * scrolled, so that they are already available when they are shown.
      */
     void refer(size_t index);
 
+    /**
+     * Reload the count and the cached items, after the content has changed in
+     * the loader source
+     *
+     * If the count did not change, only `localDataChanged()` is emitted,
+     * instead of resetting the whole list.
+     */
+    void refresh();
+
 signals:
     /* useful for signaling QAbstractItemModel::modelAboutToBeReset() */
     void localSizeAboutToBeChanged(size_t size);
@@ -144,6 +156,7 @@ signals:
 private:
     void asyncLoad(size_t offset, size_t count);
     void asyncCount();
+    bool isNearBound(size_t index) const;
 
     MediaLib* m_medialib = nullptr;
 
@@ -158,9 +171,11 @@ private:
 
     bool m_countRequested = false;
     MLRange m_lastRangeRequested;
+    size_t m_lastReferred = 0;
 
     uint64_t m_loadTask = 0;
     uint64_t m_countTask = 0;
+    uint64_t m_refreshTask = 0;
 };
 
 #endif
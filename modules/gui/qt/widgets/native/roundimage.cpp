@@ -27,14 +27,24 @@
 
 #include "roundimage.hpp"
 
+#include <vlc_configuration.h>
+
 #include <qhashfunctions.h>
 
+#include <algorithm>
+
 #include <QBuffer>
 #include <QCache>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
 #include <QImage>
 #include <QImageReader>
+#include <QImageWriter>
 #include <QPainter>
 #include <QPainterPath>
+#include <QSaveFile>
 #include <QQuickWindow>
 #include <QGuiApplication>
 #include <QSGImageNode>
@@ -71,7 +81,12 @@ namespace
     }
 
     // images are cached (result of RoundImageGenerator) with the cost calculated from QImage::sizeInBytes
-    QCache<ImageCacheKey, QImage> imageCache(2 * 1024 * 1024); // 2 MiB
+    QCache<ImageCacheKey, QImage> imageCache(32 * 1024 * 1024); // 32 MiB
+
+    // The local pictures larger than a bucket are stored scaled down to the
+    // smallest bucket fitting the requested size, so that large artworks are
+    // not decoded at full size again for every view
+    const int scaledBuckets[] = { 128, 256, 512, 1024 };
 
     QString getPath(const QUrl &url)
     {
@@ -127,6 +142,79 @@ namespace
         file->open(QIODevice::ReadOnly);
         return file;
     }
+
+    const QString &getScaledStorage()
+    {
+        static const QString storage = [] {
+            char *dir = config_GetUserDir(VLC_CACHE_DIR);
+            QString path = qfu(dir) + "/art/qt-scaled";
+            free(dir);
+            return path;
+        }();
+        return storage;
+    }
+
+    // return the scaled down copy of the picture, created if needed, or
+    // nullptr if the original should be read
+    std::unique_ptr<QIODevice> getScaledReadable(const QUrl &url, const QSize &size)
+    {
+        if (!url.isLocalFile())
+            return {};
+
+        const int maxSide = std::max(size.width(), size.height());
+        const auto bucket = std::find_if(std::begin(scaledBuckets), std::end(scaledBuckets),
+                                         [maxSide](int b) { return b >= maxSide; });
+        if (bucket == std::end(scaledBuckets))
+            return {};
+
+        const QFileInfo info(url.toLocalFile());
+        if (!info.isFile())
+            return {};
+
+        // the modification date is part of the key, an updated picture is
+        // scaled again
+        const QByteArray key = info.absoluteFilePath().toUtf8() + '\0'
+                             + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+        const QString hash = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex());
+        const QDir dir(getScaledStorage() + '/' + QString::number(*bucket));
+
+        for (const char *suffix : { ".jpg", ".png" })
+        {
+            auto file = std::make_unique<QFile>(dir.absoluteFilePath(hash + suffix));
+            if (file->open(QIODevice::ReadOnly))
+                return file;
+        }
+
+        QImageReader reader(info.absoluteFilePath());
+        const QSize originalSize = reader.size();
+        if (!originalSize.isValid()
+            || (originalSize.width() <= *bucket && originalSize.height() <= *bucket))
+            return {};
+
+        // both sides must stay larger than the bucket for the crop
+        reader.setScaledSize(originalSize.scaled(*bucket, *bucket, Qt::KeepAspectRatioByExpanding));
+        const QImage scaled = reader.read();
+        if (scaled.isNull())
+            return {};
+
+        if (!dir.mkpath("."))
+            return {};
+
+        const bool hasAlpha = scaled.hasAlphaChannel();
+        QSaveFile output(dir.absoluteFilePath(hash + (hasAlpha ? ".png" : ".jpg")));
+        if (!output.open(QIODevice::WriteOnly))
+            return {};
+
+        QImageWriter writer(&output, hasAlpha ? "png" : "jpg");
+        writer.setQuality(90);
+        if (!writer.write(scaled) || !output.commit())
+            return {};
+
+        auto file = std::make_unique<QFile>(output.fileName());
+        if (!file->open(QIODevice::ReadOnly))
+            return {};
+        return file;
+    }
 }
 
 RoundImage::RoundImage(QQuickItem *parent) : QQuickItem {parent}
@@ -322,7 +410,9 @@ QImage RoundImage::RoundImageGenerator::execute()
     if (width <= 0 || height <= 0)
         return {};
 
-    auto file = getReadable(source);
+    auto file = getScaledReadable(source, QSizeF {width, height}.toSize());
+    if (!file)
+        file = getReadable(source);
     if (!file || !file->isOpen())
         return {};
 
@@ -46,8 +46,12 @@ typedef struct
 
     struct deinterlace_ctx         context;
     const d3d_format_t             *output_format;
+    picture_pool_t                 *output_pool;
 } filter_sys_t;
 
+/* output pictures reused once released downstream */
+#define OUTPUT_POOL_SIZE 8
+
 struct filter_mode_t
 {
     const char                           *psz_mode;
@@ -192,37 +196,17 @@ picture_t *AllocPicture( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
-    picture_t *pic = D3D11_AllocPicture(VLC_OBJECT(p_filter), &p_filter->fmt_out.video,
-                                        p_filter->vctx_out, false, p_sys->output_format);
-    if (pic == NULL)
-        return NULL;
-
-    picture_sys_d3d11_t *p_out_sys = ActiveD3D11PictureSys(pic);
-
-    D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC outDesc = {
-        .ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D,
-    };
-
-    HRESULT hr;
-    hr = ID3D11VideoDevice_CreateVideoProcessorOutputView(p_sys->d3d_proc.d3dviddev,
-                                                         p_out_sys->resource[0],
-                                                         p_sys->d3d_proc.procEnumerator,
-                                                         &outDesc,
-                                                         &p_out_sys->processorOutput);
-    if (FAILED(hr))
-    {
-        msg_Dbg(p_filter,"Failed to create processor output. (hr=0x%lX)", hr);
-        picture_Release(pic);
-        return NULL;
-    }
-
-    return pic;
+    return D3D11_GetOutputPicture(p_filter, &p_sys->d3d_proc, p_sys->output_pool,
+                                  &p_filter->fmt_out.video, p_filter->vctx_out,
+                                  p_sys->output_format);
 }
 
 static void D3D11CloseDeinterlace(filter_t *filter)
 {
     filter_sys_t *sys = filter->p_sys;
     Flush(filter);
+    if (sys->output_pool)
+        picture_pool_Release(sys->output_pool);
     D3D11_ReleaseProcessor( &sys->d3d_proc );
     vlc_video_context_Release(filter->vctx_out);
 
@@ -359,6 +343,12 @@ int D3D11OpenDeinterlace(filter_t *filter)
     {
        goto error;
     }
+
+    sys->output_pool = D3D11_CreateOutputPool(filter, &sys->d3d_proc, &out_fmt,
+                                              filter->vctx_in, sys->output_format,
+                                              OUTPUT_POOL_SIZE);
+    if (sys->output_pool == NULL)
+        msg_Dbg(filter, "no output pool, allocating each picture");
     d3d11_device_unlock(sys->d3d_dev);
 
     filter->fmt_out.video   = out_fmt;
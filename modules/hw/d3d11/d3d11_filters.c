@@ -49,7 +49,8 @@
 #define D3D11_VIDEO_PROCESSOR_FILTER_CAPS_SATURATION   0x8
 #endif
 
-#define PROCESSOR_SLICES 2
+/* output pictures reused once released downstream */
+#define OUTPUT_POOL_SIZE 8
 
 struct filter_level
 {
@@ -72,12 +73,8 @@ typedef struct
     d3d11_device_t                 *d3d_dev;
     d3d11_processor_t              d3d_proc;
 
-    union {
-        ID3D11Texture2D            *texture;
-        ID3D11Resource             *resource;
-    } out[PROCESSOR_SLICES];
-    ID3D11VideoProcessorInputView  *procInput[PROCESSOR_SLICES];
-    ID3D11VideoProcessorOutputView *procOutput[PROCESSOR_SLICES];
+    const d3d_format_t             *output_format;
+    picture_pool_t                 *output_pool;
 } filter_sys_t;
 
 #define CONT_TEXT N_("Image contrast (0-2)")
@@ -95,48 +92,20 @@ static const char *const ppsz_filter_options[] = {
     "contrast", "brightness", "hue", "saturation", "gamma", NULL
 };
 
-static bool ApplyFilter( filter_sys_t *p_sys,
-                         D3D11_VIDEO_PROCESSOR_FILTER filter,
-                         struct filter_level *p_level,
-                         ID3D11VideoProcessorInputView *input,
-                         ID3D11VideoProcessorOutputView *output,
-                         const video_format_t *fmt)
+static bool SetFilter( filter_sys_t *p_sys,
+                       D3D11_VIDEO_PROCESSOR_FILTER filter,
+                       struct filter_level *p_level )
 {
-    HRESULT hr;
-
     int level = atomic_load(&p_level->level);
-    if (level == p_level->Range.Default)
-        return false;
+    bool enable = level != p_level->Range.Default;
 
     ID3D11VideoContext_VideoProcessorSetStreamFilter(p_sys->d3d_proc.d3dvidctx,
                                                      p_sys->d3d_proc.videoProcessor,
                                                      0,
                                                      filter,
-                                                     TRUE,
+                                                     enable,
                                                      level);
-    ID3D11VideoContext_VideoProcessorSetStreamAutoProcessingMode(p_sys->d3d_proc.d3dvidctx,
-                                                                 p_sys->d3d_proc.videoProcessor,
-                                                                 0, FALSE);
-
-    RECT srcRect;
-    srcRect.left   = fmt->i_x_offset;
-    srcRect.top    = fmt->i_y_offset;
-    srcRect.right  = srcRect.left + fmt->i_visible_width;
-    srcRect.bottom = srcRect.top  + fmt->i_visible_height;
-    ID3D11VideoContext_VideoProcessorSetStreamSourceRect(p_sys->d3d_proc.d3dvidctx, p_sys->d3d_proc.videoProcessor,
-                                                         0, TRUE, &srcRect);
-    ID3D11VideoContext_VideoProcessorSetStreamDestRect(p_sys->d3d_proc.d3dvidctx, p_sys->d3d_proc.videoProcessor,
-                                                       0, TRUE, &srcRect);
-
-    D3D11_VIDEO_PROCESSOR_STREAM stream = {0};
-    stream.Enable = TRUE;
-    stream.pInputSurface = input;
-
-    hr = ID3D11VideoContext_VideoProcessorBlt(p_sys->d3d_proc.d3dvidctx,
-                                              p_sys->d3d_proc.videoProcessor,
-                                              output,
-                                              0, 1, &stream);
-    return SUCCEEDED(hr);
+    return enable;
 }
 
 static void SetLevel(struct filter_level *range, float val)
@@ -184,132 +153,78 @@ static void InitLevel(filter_t *filter, struct filter_level *range, const char *
     atomic_init( &range->level, range->Range.Default + level );
 }
 
-static picture_t *AllocPicture( filter_t *p_filter )
+static picture_t *Filter(filter_t *p_filter, picture_t *p_pic)
 {
-    d3d11_video_context_t *vctx_sys = GetD3D11ContextPrivate( p_filter->vctx_out );
+    filter_sys_t *p_sys = p_filter->p_sys;
 
-    const d3d_format_t *cfg = NULL;
-    for (const d3d_format_t *output_format = DxgiGetRenderFormatList();
-            output_format->name != NULL; ++output_format)
-    {
-        if (output_format->formatTexture == vctx_sys->format &&
-            is_d3d11_opaque(output_format->fourcc))
-        {
-            cfg = output_format;
-            break;
-        }
-    }
-    if (unlikely(cfg == NULL))
-        return NULL;
+    d3d11_device_lock( p_sys->d3d_dev );
 
-    return D3D11_AllocPicture(VLC_OBJECT(p_filter),
-                              &p_filter->fmt_out.video, p_filter->vctx_out,
-                              false, cfg);
-}
+    /* all the filters are applied in a single pass */
+    bool enabled = false;
+    enabled |= SetFilter( p_sys, D3D11_VIDEO_PROCESSOR_FILTER_CONTRAST, &p_sys->Contrast );
+    enabled |= SetFilter( p_sys, D3D11_VIDEO_PROCESSOR_FILTER_BRIGHTNESS, &p_sys->Brightness );
+    enabled |= SetFilter( p_sys, D3D11_VIDEO_PROCESSOR_FILTER_HUE, &p_sys->Hue );
+    enabled |= SetFilter( p_sys, D3D11_VIDEO_PROCESSOR_FILTER_SATURATION, &p_sys->Saturation );
 
-static picture_t *Filter(filter_t *p_filter, picture_t *p_pic)
-{
-    filter_sys_t *p_sys = p_filter->p_sys;
+    if (!enabled)
+    {
+        /* nothing to adjust, pass the picture through untouched */
+        d3d11_device_unlock( p_sys->d3d_dev );
+        return p_pic;
+    }
 
     picture_sys_d3d11_t *p_src_sys = ActiveD3D11PictureSys(p_pic);
     if (FAILED( D3D11_Assert_ProcessorInput(p_filter, &p_sys->d3d_proc, p_src_sys) ))
-    {
-        picture_Release( p_pic );
-        return NULL;
-    }
+        goto error;
 
-    picture_t *p_outpic = AllocPicture( p_filter );
+    picture_t *p_outpic = D3D11_GetOutputPicture(p_filter, &p_sys->d3d_proc,
+                                                 p_sys->output_pool,
+                                                 &p_filter->fmt_out.video,
+                                                 p_filter->vctx_out,
+                                                 p_sys->output_format);
     if( !p_outpic )
-    {
-        picture_Release( p_pic );
-        return NULL;
-    }
+        goto error;
     picture_sys_d3d11_t *p_out_sys = ActiveD3D11PictureSys(p_outpic);
-    if (unlikely(!p_out_sys))
-    {
-        /* the output filter configuration may have changed since the filter
-         * was opened */
-        picture_Release( p_pic );
-        return NULL;
-    }
 
     picture_CopyProperties( p_outpic, p_pic );
 
-    ID3D11VideoProcessorInputView *inputs[4] = {
-        p_src_sys->processorInput,
-        p_sys->procInput[0],
-        p_sys->procInput[1],
-        p_sys->procInput[0]
-    };
+    const video_format_t *fmt = &p_filter->fmt_out.video;
+    ID3D11VideoContext_VideoProcessorSetStreamAutoProcessingMode(p_sys->d3d_proc.d3dvidctx,
+                                                                 p_sys->d3d_proc.videoProcessor,
+                                                                 0, FALSE);
 
-    ID3D11VideoProcessorOutputView *outputs[4] = {
-        p_sys->procOutput[0],
-        p_sys->procOutput[1],
-        p_sys->procOutput[0],
-        p_sys->procOutput[1]
-    };
+    RECT srcRect;
+    srcRect.left   = fmt->i_x_offset;
+    srcRect.top    = fmt->i_y_offset;
+    srcRect.right  = srcRect.left + fmt->i_visible_width;
+    srcRect.bottom = srcRect.top  + fmt->i_visible_height;
+    ID3D11VideoContext_VideoProcessorSetStreamSourceRect(p_sys->d3d_proc.d3dvidctx, p_sys->d3d_proc.videoProcessor,
+                                                         0, TRUE, &srcRect);
+    ID3D11VideoContext_VideoProcessorSetStreamDestRect(p_sys->d3d_proc.d3dvidctx, p_sys->d3d_proc.videoProcessor,
+                                                       0, TRUE, &srcRect);
 
-    d3d11_device_lock( p_sys->d3d_dev );
+    D3D11_VIDEO_PROCESSOR_STREAM stream = {0};
+    stream.Enable = TRUE;
+    stream.pInputSurface = p_src_sys->processorInput;
 
-    size_t idx = 0, count = 0;
-    /* contrast */
-    if ( ApplyFilter( p_sys,
-                      D3D11_VIDEO_PROCESSOR_FILTER_CONTRAST, &p_sys->Contrast,
-                      inputs[idx], outputs[idx], &p_filter->fmt_out.video ) )
-    {
-        idx++;
-        count++;
-    }
-    /* brightness */
-    if ( ApplyFilter( p_sys,
-                      D3D11_VIDEO_PROCESSOR_FILTER_BRIGHTNESS, &p_sys->Brightness,
-                      inputs[idx], outputs[idx], &p_filter->fmt_out.video ) )
-    {
-        idx++;
-        count++;
-    }
-    /* hue */
-    if ( ApplyFilter( p_sys,
-                      D3D11_VIDEO_PROCESSOR_FILTER_HUE, &p_sys->Hue,
-                      inputs[idx], outputs[idx], &p_filter->fmt_out.video ) )
-    {
-        idx++;
-        count++;
-    }
-    /* saturation */
-    if ( ApplyFilter( p_sys,
-                      D3D11_VIDEO_PROCESSOR_FILTER_SATURATION, &p_sys->Saturation,
-                      inputs[idx], outputs[idx], &p_filter->fmt_out.video ) )
-    {
-        idx++;
-        count++;
-    }
+    HRESULT hr = ID3D11VideoContext_VideoProcessorBlt(p_sys->d3d_proc.d3dvidctx,
+                                                      p_sys->d3d_proc.videoProcessor,
+                                                      p_out_sys->processorOutput,
+                                                      0, 1, &stream);
+    d3d11_device_unlock( p_sys->d3d_dev );
 
-    if (count == 0)
-    {
-        ID3D11DeviceContext_CopySubresourceRegion(p_sys->d3d_dev->d3dcontext,
-                                                  p_out_sys->resource[KNOWN_DXGI_INDEX],
-                                                  p_out_sys->slice_index,
-                                                  0, 0, 0,
-                                                  p_src_sys->resource[KNOWN_DXGI_INDEX],
-                                                  p_src_sys->slice_index,
-                                                  NULL);
-    }
-    else
+    picture_Release( p_pic );
+    if (FAILED(hr))
     {
-        ID3D11DeviceContext_CopySubresourceRegion(p_sys->d3d_dev->d3dcontext,
-                                                  p_out_sys->resource[KNOWN_DXGI_INDEX],
-                                                  p_out_sys->slice_index,
-                                                  0, 0, 0,
-                                                  p_sys->out[outputs[idx] == p_sys->procOutput[0] ? 1 : 0].resource,
-                                                  0,
-                                                  NULL);
+        picture_Release( p_outpic );
+        return NULL;
     }
+    return p_outpic;
 
+error:
     d3d11_device_unlock( p_sys->d3d_dev );
-
     picture_Release( p_pic );
-    return p_outpic;
+    return NULL;
 }
 
 static int AdjustCallback( vlc_object_t *p_this, char const *psz_var,
@@ -341,15 +256,8 @@ static void D3D11CloseAdjust(filter_t *filter)
     var_DelCallback( filter, "saturation", AdjustCallback, sys );
     var_DelCallback( filter, "gamma",      AdjustCallback, sys );
 
-    for (int i=0; i<PROCESSOR_SLICES; i++)
-    {
-        if (sys->procInput[i])
-            ID3D11VideoProcessorInputView_Release(sys->procInput[i]);
-        if (sys->procOutput[i])
-            ID3D11VideoProcessorOutputView_Release(sys->procOutput[i]);
-    }
-    ID3D11Texture2D_Release(sys->out[0].texture);
-    ID3D11Texture2D_Release(sys->out[1].texture);
+    if (sys->output_pool)
+        picture_pool_Release(sys->output_pool);
     D3D11_ReleaseProcessor( &sys->d3d_proc );
     vlc_video_context_Release(filter->vctx_out);
 
@@ -381,6 +289,22 @@ static int D3D11OpenAdjust(filter_t *filter)
     sys->d3d_dev = &dev_sys->d3d_dev;
     DXGI_FORMAT format = vtcx_sys->format;
 
+    for (const d3d_format_t *output_format = DxgiGetRenderFormatList();
+            output_format->name != NULL; ++output_format)
+    {
+        if (output_format->formatTexture == format &&
+            is_d3d11_opaque(output_format->fourcc))
+        {
+            sys->output_format = output_format;
+            break;
+        }
+    }
+    if (unlikely(sys->output_format == NULL))
+    {
+        free(sys);
+        return VLC_EGENERIC;
+    }
+
     d3d11_device_lock(sys->d3d_dev);
 
     if (D3D11_CreateProcessor(filter, sys->d3d_dev, D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE,
@@ -465,67 +389,11 @@ static int D3D11OpenAdjust(filter_t *filter)
         goto error;
     }
 
-    D3D11_TEXTURE2D_DESC texDesc;
-    ZeroMemory(&texDesc, sizeof(texDesc));
-    texDesc.MipLevels = 1;
-    texDesc.SampleDesc.Count = 1;
-    texDesc.MiscFlags = 0; //D3D11_RESOURCE_MISC_SHARED;
-    texDesc.Usage = D3D11_USAGE_DEFAULT;
-    texDesc.CPUAccessFlags = 0;
-    texDesc.Format = format;
-    texDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
-    texDesc.Usage = D3D11_USAGE_DEFAULT;
-    texDesc.ArraySize = 1;
-    texDesc.Height = filter->fmt_out.video.i_height;
-    texDesc.Width  = filter->fmt_out.video.i_width;
-
-    hr = ID3D11Device_CreateTexture2D( sys->d3d_dev->d3ddevice, &texDesc, NULL, &sys->out[0].texture );
-    if (FAILED(hr)) {
-        msg_Err(filter, "CreateTexture2D failed. (hr=0x%lX)", hr);
-        goto error;
-    }
-    hr = ID3D11Device_CreateTexture2D( sys->d3d_dev->d3ddevice, &texDesc, NULL, &sys->out[1].texture );
-    if (FAILED(hr)) {
-        ID3D11Texture2D_Release(sys->out[0].texture);
-        msg_Err(filter, "CreateTexture2D failed. (hr=0x%lX)", hr);
-        goto error;
-    }
-
-    D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC outDesc = {
-        .ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D,
-    };
-
-    D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC inDesc = {
-        .FourCC = 0,
-        .ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D,
-        .Texture2D.MipSlice = 0,
-    };
-
-    for (int i=0; i<PROCESSOR_SLICES; i++)
-    {
-        hr = ID3D11VideoDevice_CreateVideoProcessorOutputView(sys->d3d_proc.d3dviddev,
-                                                             sys->out[i].resource,
-                                                             sys->d3d_proc.procEnumerator,
-                                                             &outDesc,
-                                                             &sys->procOutput[i]);
-        if (FAILED(hr))
-        {
-            msg_Dbg(filter,"Failed to create processor output. (hr=0x%lX)", hr);
-            goto error;
-        }
-
-        hr = ID3D11VideoDevice_CreateVideoProcessorInputView(sys->d3d_proc.d3dviddev,
-                                                             sys->out[i].resource,
-                                                             sys->d3d_proc.procEnumerator,
-                                                             &inDesc,
-                                                             &sys->procInput[i]);
-
-        if (FAILED(hr))
-        {
-            msg_Dbg(filter,"Failed to create processor input. (hr=0x%lX)", hr);
-            goto error;
-        }
-    }
+    sys->output_pool = D3D11_CreateOutputPool(filter, &sys->d3d_proc,
+                                              &filter->fmt_out.video, filter->vctx_in,
+                                              sys->output_format, OUTPUT_POOL_SIZE);
+    if (sys->output_pool == NULL)
+        msg_Dbg(filter, "no output pool, allocating each picture");
 
     filter->ops = &filter_ops;
     filter->p_sys = sys;
@@ -534,18 +402,6 @@ static int D3D11OpenAdjust(filter_t *filter)
 
     return VLC_SUCCESS;
 error:
-    for (int i=0; i<PROCESSOR_SLICES; i++)
-    {
-        if (sys->procInput[i])
-            ID3D11VideoProcessorInputView_Release(sys->procInput[i]);
-        if (sys->procOutput[i])
-            ID3D11VideoProcessorOutputView_Release(sys->procOutput[i]);
-    }
-
-    if (sys->out[0].texture)
-        ID3D11Texture2D_Release(sys->out[0].texture);
-    if (sys->out[1].texture)
-        ID3D11Texture2D_Release(sys->out[1].texture);
     D3D11_ReleaseProcessor(&sys->d3d_proc);
     d3d11_device_unlock(sys->d3d_dev);
     free(sys);
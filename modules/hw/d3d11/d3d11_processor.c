@@ -172,4 +172,93 @@ HRESULT D3D11_Assert_ProcessorInput(vlc_object_t *o, d3d11_processor_t *d3d_proc
 #endif
     return hr;
 }
+
+#undef D3D11_Assert_ProcessorOutput
+HRESULT D3D11_Assert_ProcessorOutput(vlc_object_t *o, d3d11_processor_t *d3d_proc, picture_sys_d3d11_t *p_sys)
+{
+    if (p_sys->processorOutput)
+        return S_OK;
+
+    D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC outDesc = {
+        .ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D,
+        .Texture2D.MipSlice = 0,
+    };
+    if (p_sys->slice_index != 0)
+    {
+        /* render in the slice of the texture array, not the first one */
+        outDesc.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2DARRAY;
+        outDesc.Texture2DArray.MipSlice = 0;
+        outDesc.Texture2DArray.FirstArraySlice = p_sys->slice_index;
+        outDesc.Texture2DArray.ArraySize = 1;
+    }
+    HRESULT hr;
+
+    hr = ID3D11VideoDevice_CreateVideoProcessorOutputView(d3d_proc->d3dviddev,
+                                                         p_sys->resource[KNOWN_DXGI_INDEX],
+                                                         d3d_proc->procEnumerator,
+                                                         &outDesc,
+                                                         &p_sys->processorOutput);
+#ifndef NDEBUG
+    if (FAILED(hr))
+        msg_Dbg(o,"Failed to create processor output for slice %d. (hr=0x%lX)", p_sys->slice_index, hr);
+#endif
+    return hr;
+}
+
+static picture_t *AllocOutputPicture(vlc_object_t *o, d3d11_processor_t *d3d_proc,
+                                     const video_format_t *fmt, vlc_video_context *vctx,
+                                     const d3d_format_t *cfg)
+{
+    picture_t *pic = D3D11_AllocPicture(o, fmt, vctx, false, cfg);
+    if (pic == NULL)
+        return NULL;
+
+    if (FAILED(D3D11_Assert_ProcessorOutput(o, d3d_proc, ActiveD3D11PictureSys(pic))))
+    {
+        picture_Release(pic);
+        return NULL;
+    }
+    return pic;
+}
+
+#undef D3D11_CreateOutputPool
+picture_pool_t *D3D11_CreateOutputPool(vlc_object_t *o, d3d11_processor_t *d3d_proc,
+                                       const video_format_t *fmt, vlc_video_context *vctx,
+                                       const d3d_format_t *cfg, unsigned count)
+{
+    picture_t *pics[count];
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        pics[i] = AllocOutputPicture(o, d3d_proc, fmt, vctx, cfg);
+        if (pics[i] == NULL)
+        {
+            while (i > 0)
+                picture_Release(pics[--i]);
+            return NULL;
+        }
+    }
+
+    picture_pool_t *pool = picture_pool_New(count, pics);
+    if (unlikely(pool == NULL))
+        for (unsigned i = 0; i < count; i++)
+            picture_Release(pics[i]);
+    return pool;
+}
+
+#undef D3D11_GetOutputPicture
+picture_t *D3D11_GetOutputPicture(vlc_object_t *o, d3d11_processor_t *d3d_proc,
+                                  picture_pool_t *pool,
+                                  const video_format_t *fmt, vlc_video_context *vctx,
+                                  const d3d_format_t *cfg)
+{
+    if (pool != NULL)
+    {
+        picture_t *pic = picture_pool_Get(pool);
+        if (pic != NULL)
+            return pic;
+    }
+    /* all the pooled pictures are still in use downstream */
+    return AllocOutputPicture(o, d3d_proc, fmt, vctx, cfg);
+}
 #endif
@@ -24,6 +24,7 @@
 #define VLC_D3D11_PROCESSOR_H
 
 #include <vlc_common.h>
+#include <vlc_picture_pool.h>
 
 #include "../../video_chroma/d3d11_fmt.h"
 
@@ -46,6 +47,31 @@ void D3D11_ReleaseProcessor(d3d11_processor_t *);
 
 HRESULT D3D11_Assert_ProcessorInput(vlc_object_t *, d3d11_processor_t *, picture_sys_d3d11_t *);
 #define D3D11_Assert_ProcessorInput(a,b,c) D3D11_Assert_ProcessorInput(VLC_OBJECT(a),b,c)
+
+HRESULT D3D11_Assert_ProcessorOutput(vlc_object_t *, d3d11_processor_t *, picture_sys_d3d11_t *);
+#define D3D11_Assert_ProcessorOutput(a,b,c) D3D11_Assert_ProcessorOutput(VLC_OBJECT(a),b,c)
+
+/**
+ * Create a pool of pictures to render the processor output into.
+ *
+ * The textures and their processor output views are created once and reused
+ * when the pictures are released by the next filters and the display.
+ */
+picture_pool_t *D3D11_CreateOutputPool(vlc_object_t *, d3d11_processor_t *,
+                                       const video_format_t *, vlc_video_context *,
+                                       const d3d_format_t *, unsigned count);
+#define D3D11_CreateOutputPool(a,b,c,d,e,f) D3D11_CreateOutputPool(VLC_OBJECT(a),b,c,d,e,f)
+
+/**
+ * Get a picture to render the processor output into.
+ *
+ * The picture comes from the pool when one is available, otherwise it is
+ * allocated.
+ */
+picture_t *D3D11_GetOutputPicture(vlc_object_t *, d3d11_processor_t *, picture_pool_t *,
+                                  const video_format_t *, vlc_video_context *,
+                                  const d3d_format_t *);
+#define D3D11_GetOutputPicture(a,b,c,d,e,f) D3D11_GetOutputPicture(VLC_OBJECT(a),b,c,d,e,f)
 #endif
 
 #endif /* VLC_D3D11_PROCESSOR_H */
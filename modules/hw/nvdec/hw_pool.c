@@ -56,6 +56,7 @@ void nvdec_pool_Release(nvdec_pool_t *pool)
 
     picture_pool_Release(pool->picture_pool);
     vlc_video_context_Release(pool->vctx);
+    free(pool);
 }
 
 nvdec_pool_t* nvdec_pool_Create(nvdec_pool_owner_t *owner,
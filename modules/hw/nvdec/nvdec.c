@@ -105,6 +105,7 @@ struct nvdec_ctx {
     size_t                      decoderHeight;
 
     unsigned int                outputPitch;
+    unsigned int                outputHeight; ///< lines of the output buffers
     nvdec_pool_t                *out_pool;
     nvdec_pool_owner_t          pool_owner;
 
@@ -118,11 +119,66 @@ struct nvdec_ctx {
 #define NVDEC_PICPOOLCTX_FROM_PICCTX(pic_ctx)  \
     container_of(NVDEC_PICCONTEXT_FROM_PICCTX(pic_ctx), pic_pool_context_nvdec_t, ctx)
 
+/* Output buffers left to the next decoder of the device */
+struct nvdec_surfaces_key
+{
+    unsigned int byte_width;
+    unsigned int height;
+};
+
+struct nvdec_surfaces
+{
+    decoder_device_nvdec_t *devsys;
+    CUdeviceptr             buffers[MAX_POOL_SIZE];
+};
+
+static void ReleaseSurfaces(void *opaque)
+{
+    struct nvdec_surfaces *surfaces = opaque;
+    CudaFunctions *cudaFunctions = surfaces->devsys->cudaFunctions;
+
+    cudaFunctions->cuCtxPushCurrent(surfaces->devsys->cuCtx);
+    for (size_t i=0; i < ARRAY_SIZE(surfaces->buffers); i++)
+        cudaFunctions->cuMemFree(surfaces->buffers[i]);
+    cudaFunctions->cuCtxPopCurrent(NULL);
+    free(surfaces);
+}
+
 static void PoolRelease(nvdec_pool_owner_t *owner, void *buffers[], size_t pics_count)
 {
     nvdec_ctx_t *p_sys = container_of(owner, nvdec_ctx_t, pool_owner);
-    for (size_t i=0; i < pics_count; i++)
-        p_sys->devsys->cudaFunctions->cuMemFree( (CUdeviceptr)buffers[i] );
+    struct nvdec_surfaces *surfaces = NULL;
+    vlc_decoder_device *dec_device = NULL;
+
+    if (pics_count == MAX_POOL_SIZE)
+    {
+        dec_device = vlc_video_context_HoldDevice(p_sys->vctx_out);
+        surfaces = malloc(sizeof (*surfaces));
+    }
+
+    if (surfaces != NULL && dec_device != NULL)
+    {
+        /* All the pictures are released: keep the buffers for the next
+         * decoder rather than freeing them */
+        const struct nvdec_surfaces_key key = {
+            p_sys->outputPitch, p_sys->outputHeight,
+        };
+
+        surfaces->devsys = p_sys->devsys;
+        for (size_t i=0; i < pics_count; i++)
+            surfaces->buffers[i] = (CUdeviceptr)buffers[i];
+        vlc_decoder_device_PutSurfaces(dec_device, &key, sizeof (key),
+                                       surfaces, ReleaseSurfaces);
+    }
+    else
+    {
+        free(surfaces);
+        for (size_t i=0; i < pics_count; i++)
+            p_sys->devsys->cudaFunctions->cuMemFree( (CUdeviceptr)buffers[i] );
+    }
+    if (dec_device != NULL)
+        vlc_decoder_device_Release(dec_device);
+
     cuvid_free_functions(&p_sys->cuvidFunctions);
     free(p_sys);
 }
@@ -337,19 +393,40 @@ static int CUDAAPI HandleVideoSequence(void *p_opaque, CUVIDEOFORMAT *p_format)
             goto cuda_error;
 
         CUdeviceptr outputDevicePtr[MAX_POOL_SIZE];
-        for (size_t i=0; i < ARRAY_SIZE(outputDevicePtr); i++)
+        const struct nvdec_surfaces_key key = { ByteWidth, Height };
+        struct nvdec_surfaces *surfaces = NULL;
+        vlc_decoder_device *dec_device =
+            vlc_video_context_HoldDevice(p_sys->vctx_out);
+        if (dec_device != NULL)
+        {
+            surfaces = vlc_decoder_device_TakeSurfaces(dec_device, &key,
+                                                       sizeof (key));
+            vlc_decoder_device_Release(dec_device);
+        }
+
+        if (surfaces != NULL)
+        {
+            msg_Dbg(p_dec, "reusing the output buffers");
+            memcpy(outputDevicePtr, surfaces->buffers, sizeof (outputDevicePtr));
+            free(surfaces);
+        }
+        else
         {
-            ret = CALL_CUDA_DEC(cuMemAlloc,
-                                &outputDevicePtr[i],
-                                ByteWidth * Height);
-            if (ret != CUDA_SUCCESS || outputDevicePtr[i] == 0)
+            for (size_t i=0; i < ARRAY_SIZE(outputDevicePtr); i++)
             {
-                while (i)
-                    CALL_CUDA_DEC(cuMemFree, outputDevicePtr[--i]);
-                outputDevicePtr[0] = 0;
-                break;
+                ret = CALL_CUDA_DEC(cuMemAlloc,
+                                    &outputDevicePtr[i],
+                                    ByteWidth * Height);
+                if (ret != CUDA_SUCCESS || outputDevicePtr[i] == 0)
+                {
+                    while (i)
+                        CALL_CUDA_DEC(cuMemFree, outputDevicePtr[--i]);
+                    outputDevicePtr[0] = 0;
+                    break;
+                }
             }
         }
+        p_sys->outputHeight = Height;
 
         p_sys->out_pool = NULL;
         if (outputDevicePtr[0])
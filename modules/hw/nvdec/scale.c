@@ -0,0 +1,545 @@
+/*****************************************************************************
+ * scale.c: NVDEC/CUDA scaling and conversion filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_codec.h>
+
+#include "nvdec_fmt.h"
+#include "hw_pool.h"
+
+static int OpenScale( filter_t * );
+
+vlc_module_begin()
+    set_shortname(N_("CUDA scaler"))
+    set_description(N_("CUDA/NVDEC scaling and conversion filter"))
+    set_subcategory(SUBCAT_VIDEO_VFILTER)
+    set_callback_video_converter(OpenScale, 10)
+vlc_module_end()
+
+#define CALL_CUDA(func, ...) CudaCheckErr(VLC_OBJECT(p_filter), devsys->cudaFunctions, devsys->cudaFunctions->func(__VA_ARGS__), #func)
+
+#define POOL_SIZE     4
+#define PITCH_ALIGN   256
+#define BLOCK_WIDTH   32
+#define BLOCK_HEIGHT  8
+
+/*
+ * Bilinear scaling of one plane, with one thread per destination sample (so
+ * that interleaved chroma planes are handled as planes with 2 channels), and
+ * conversion between 8 and 16 bits per sample. The source position is
+ * clamped to the cropped area.
+ *
+ * This is a hand-written kernel so that no CUDA compiler is needed to build
+ * VLC: the driver compiles it for the actual GPU when the module is loaded.
+ */
+static const char scale_ptx[] =
+    ".version 6.0\n"
+    ".target sm_30\n"
+    ".address_size 64\n"
+    "\n"
+    ".visible .entry vlc_cuda_scale(\n"
+    "    .param .u64 p_src, .param .u32 p_src_pitch,\n"
+    "    .param .u64 p_dst, .param .u32 p_dst_pitch,\n"
+    "    .param .u32 p_dst_samples, .param .u32 p_dst_height,\n"
+    "    .param .u32 p_channels,\n"
+    "    .param .f32 p_scale_x, .param .f32 p_scale_y,\n"
+    "    .param .f32 p_left, .param .f32 p_top,\n"
+    "    .param .f32 p_right, .param .f32 p_bottom,\n"
+    "    .param .u32 p_src_bytes, .param .u32 p_dst_bytes)\n"
+    "{\n"
+    "    .reg .pred  %p<4>;\n"
+    "    .reg .b32   %r<24>;\n"
+    "    .reg .b64   %rd<12>;\n"
+    "    .reg .f32   %f<24>;\n"
+    "\n"
+    /* destination sample (r4, r5) */
+    "    mov.u32         %r1, %ctaid.x;\n"
+    "    mov.u32         %r2, %ntid.x;\n"
+    "    mov.u32         %r3, %tid.x;\n"
+    "    mad.lo.s32      %r4, %r1, %r2, %r3;\n"
+    "    mov.u32         %r1, %ctaid.y;\n"
+    "    mov.u32         %r2, %ntid.y;\n"
+    "    mov.u32         %r3, %tid.y;\n"
+    "    mad.lo.s32      %r5, %r1, %r2, %r3;\n"
+    "    ld.param.u32    %r6, [p_dst_samples];\n"
+    "    ld.param.u32    %r7, [p_dst_height];\n"
+    "    setp.ge.u32     %p1, %r4, %r6;\n"
+    "    setp.ge.u32     %p2, %r5, %r7;\n"
+    "    or.pred         %p1, %p1, %p2;\n"
+    "    @%p1 bra        DONE;\n"
+    "\n"
+    /* pixel (r9) and channel (r10) */
+    "    ld.param.u32    %r8, [p_channels];\n"
+    "    div.u32         %r9, %r4, %r8;\n"
+    "    rem.u32         %r10, %r4, %r8;\n"
+    "\n"
+    /* source position (f7, f8) of the pixel center */
+    "    ld.param.f32    %f1, [p_scale_x];\n"
+    "    ld.param.f32    %f2, [p_scale_y];\n"
+    "    ld.param.f32    %f3, [p_left];\n"
+    "    ld.param.f32    %f4, [p_top];\n"
+    "    ld.param.f32    %f5, [p_right];\n"
+    "    ld.param.f32    %f6, [p_bottom];\n"
+    "    cvt.rn.f32.u32  %f7, %r9;\n"
+    "    add.f32         %f7, %f7, 0f3F000000;\n"
+    "    fma.rn.f32      %f7, %f7, %f1, %f3;\n"
+    "    sub.f32         %f7, %f7, 0f3F000000;\n"
+    "    max.f32         %f7, %f7, %f3;\n"
+    "    min.f32         %f7, %f7, %f5;\n"
+    "    cvt.rn.f32.u32  %f8, %r5;\n"
+    "    add.f32         %f8, %f8, 0f3F000000;\n"
+    "    fma.rn.f32      %f8, %f8, %f2, %f4;\n"
+    "    sub.f32         %f8, %f8, 0f3F000000;\n"
+    "    max.f32         %f8, %f8, %f4;\n"
+    "    min.f32         %f8, %f8, %f6;\n"
+    "\n"
+    /* neighbours (r11, r12) and (r13, r14), weights (f11, f12) */
+    "    cvt.rmi.f32.f32 %f9, %f7;\n"
+    "    cvt.rmi.f32.f32 %f10, %f8;\n"
+    "    sub.f32         %f11, %f7, %f9;\n"
+    "    sub.f32         %f12, %f8, %f10;\n"
+    "    cvt.rzi.u32.f32 %r11, %f9;\n"
+    "    cvt.rzi.u32.f32 %r12, %f10;\n"
+    "    setp.lt.f32     %p1, %f9, %f5;\n"
+    "    selp.u32        %r13, 1, 0, %p1;\n"
+    "    add.u32         %r13, %r11, %r13;\n"
+    "    setp.lt.f32     %p2, %f10, %f6;\n"
+    "    selp.u32        %r14, 1, 0, %p2;\n"
+    "    add.u32         %r14, %r12, %r14;\n"
+    "\n"
+    /* byte offsets in the lines */
+    "    mad.lo.s32      %r11, %r11, %r8, %r10;\n"
+    "    mad.lo.s32      %r13, %r13, %r8, %r10;\n"
+    "    ld.param.u32    %r15, [p_src_bytes];\n"
+    "    setp.eq.u32     %p3, %r15, 2;\n"
+    "    @%p3 shl.b32    %r11, %r11, 1;\n"
+    "    @%p3 shl.b32    %r13, %r13, 1;\n"
+    "\n"
+    "    ld.param.u64    %rd1, [p_src];\n"
+    "    cvta.to.global.u64 %rd1, %rd1;\n"
+    "    ld.param.u32    %r16, [p_src_pitch];\n"
+    "    mul.wide.u32    %rd2, %r12, %r16;\n"
+    "    add.s64         %rd2, %rd1, %rd2;\n"
+    "    mul.wide.u32    %rd3, %r14, %r16;\n"
+    "    add.s64         %rd3, %rd1, %rd3;\n"
+    "    cvt.u64.u32     %rd4, %r11;\n"
+    "    cvt.u64.u32     %rd5, %r13;\n"
+    "    add.s64         %rd6, %rd2, %rd4;\n"
+    "    add.s64         %rd7, %rd2, %rd5;\n"
+    "    add.s64         %rd8, %rd3, %rd4;\n"
+    "    add.s64         %rd9, %rd3, %rd5;\n"
+    "\n"
+    "    @%p3 bra        LOAD16;\n"
+    "    ld.global.u8    %r17, [%rd6];\n"
+    "    ld.global.u8    %r18, [%rd7];\n"
+    "    ld.global.u8    %r19, [%rd8];\n"
+    "    ld.global.u8    %r20, [%rd9];\n"
+    "    mov.f32         %f13, 0f437F0000;\n"
+    "    bra             INTERPOLATE;\n"
+    "LOAD16:\n"
+    "    ld.global.u16   %r17, [%rd6];\n"
+    "    ld.global.u16   %r18, [%rd7];\n"
+    "    ld.global.u16   %r19, [%rd8];\n"
+    "    ld.global.u16   %r20, [%rd9];\n"
+    "    mov.f32         %f13, 0f477FFF00;\n"
+    "\n"
+    /* normalized value (f14) */
+    "INTERPOLATE:\n"
+    "    cvt.rn.f32.u32  %f14, %r17;\n"
+    "    cvt.rn.f32.u32  %f15, %r18;\n"
+    "    cvt.rn.f32.u32  %f16, %r19;\n"
+    "    cvt.rn.f32.u32  %f17, %r20;\n"
+    "    sub.f32         %f15, %f15, %f14;\n"
+    "    fma.rn.f32      %f14, %f15, %f11, %f14;\n"
+    "    sub.f32         %f17, %f17, %f16;\n"
+    "    fma.rn.f32      %f16, %f17, %f11, %f16;\n"
+    "    sub.f32         %f16, %f16, %f14;\n"
+    "    fma.rn.f32      %f14, %f16, %f12, %f14;\n"
+    "    div.rn.f32      %f14, %f14, %f13;\n"
+    "\n"
+    "    ld.param.u64    %rd1, [p_dst];\n"
+    "    cvta.to.global.u64 %rd1, %rd1;\n"
+    "    ld.param.u32    %r16, [p_dst_pitch];\n"
+    "    mul.wide.u32    %rd2, %r5, %r16;\n"
+    "    add.s64         %rd1, %rd1, %rd2;\n"
+    "    ld.param.u32    %r15, [p_dst_bytes];\n"
+    "    setp.eq.u32     %p3, %r15, 2;\n"
+    "    @%p3 bra        STORE16;\n"
+    "    cvt.u64.u32     %rd2, %r4;\n"
+    "    add.s64         %rd1, %rd1, %rd2;\n"
+    "    fma.rn.f32      %f14, %f14, 0f437F0000, 0f3F000000;\n"
+    "    min.f32         %f14, %f14, 0f437F0000;\n"
+    "    cvt.rzi.u32.f32 %r21, %f14;\n"
+    "    st.global.u8    [%rd1], %r21;\n"
+    "    bra             DONE;\n"
+    "STORE16:\n"
+    "    mul.wide.u32    %rd2, %r4, 2;\n"
+    "    add.s64         %rd1, %rd1, %rd2;\n"
+    "    fma.rn.f32      %f14, %f14, 0f477FFF00, 0f3F000000;\n"
+    "    min.f32         %f14, %f14, 0f477FFF00;\n"
+    "    cvt.rzi.u32.f32 %r21, %f14;\n"
+    "    st.global.u16   [%rd1], %r21;\n"
+    "DONE:\n"
+    "    ret;\n"
+    "}\n";
+
+static const struct
+{
+    vlc_fourcc_t chroma;
+    unsigned     bytes; /* per sample */
+    bool         is_444;
+} formats[] = {
+    { VLC_CODEC_NVDEC_OPAQUE,         1, false },
+    { VLC_CODEC_NVDEC_OPAQUE_10B,     2, false },
+    { VLC_CODEC_NVDEC_OPAQUE_16B,     2, false },
+    { VLC_CODEC_NVDEC_OPAQUE_444,     1, true  },
+    { VLC_CODEC_NVDEC_OPAQUE_444_16B, 2, true  },
+};
+
+static int GetFormat(vlc_fourcc_t chroma)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(formats); i++)
+        if (formats[i].chroma == chroma)
+            return i;
+    return -1;
+}
+
+/* Outlives the filter, until the last output picture is released */
+typedef struct
+{
+    nvdec_pool_owner_t  owner;
+    vlc_decoder_device  *dec_dev;
+    vlc_video_context   *vctx;
+    unsigned int        pitch;
+    unsigned int        height;
+} scale_pool_t;
+
+typedef struct {
+  pic_context_nvdec_t ctx;
+  nvdec_pool_t        *pool;
+} pic_pool_context_nvdec_t;
+
+#define NVDEC_PICPOOLCTX_FROM_PICCTX(pic_ctx)  \
+    container_of(NVDEC_PICCONTEXT_FROM_PICCTX(pic_ctx), pic_pool_context_nvdec_t, ctx)
+
+typedef struct
+{
+    vlc_decoder_device  *dec_dev;
+    CUmodule            module;
+    CUfunction          kernel;
+    nvdec_pool_t        *out_pool;
+    unsigned int        src_bytes, dst_bytes;
+    bool                is_444;
+} filter_sys_t;
+
+static void PoolRelease(nvdec_pool_owner_t *owner, void *buffers[], size_t pics_count)
+{
+    scale_pool_t *pool = container_of(owner, scale_pool_t, owner);
+    decoder_device_nvdec_t *devsys = GetNVDECOpaqueDevice(pool->dec_dev);
+
+    for (size_t i=0; i < pics_count; i++)
+        devsys->cudaFunctions->cuMemFree( (CUdeviceptr)buffers[i] );
+    vlc_decoder_device_Release(pool->dec_dev);
+    free(pool);
+}
+
+static void scale_picture_CtxDestroy(struct picture_context_t *picctx)
+{
+    pic_pool_context_nvdec_t *srcpic = NVDEC_PICPOOLCTX_FROM_PICCTX(picctx);
+    nvdec_pool_Release(srcpic->pool);
+    free(srcpic);
+}
+
+static struct picture_context_t *scale_picture_CtxClone(struct picture_context_t *srcctx)
+{
+    pic_pool_context_nvdec_t *clonectx = malloc(sizeof(*clonectx));
+    if (unlikely(clonectx == NULL))
+        return NULL;
+    pic_pool_context_nvdec_t *srcpic = NVDEC_PICPOOLCTX_FROM_PICCTX(srcctx);
+
+    *clonectx = *srcpic;
+    vlc_video_context_Hold(clonectx->ctx.ctx.vctx);
+    nvdec_pool_AddRef(clonectx->pool);
+    return &clonectx->ctx.ctx;
+}
+
+static picture_context_t * PoolAttachPicture(nvdec_pool_owner_t *owner, nvdec_pool_t *pool, void *surface)
+{
+    scale_pool_t *p_pool = container_of(owner, scale_pool_t, owner);
+    pic_pool_context_nvdec_t *picctx = malloc(sizeof(*picctx));
+    if (unlikely(!picctx))
+        return NULL;
+
+    picctx->ctx.ctx = (picture_context_t) {
+        scale_picture_CtxDestroy,
+        scale_picture_CtxClone,
+        p_pool->vctx,
+    };
+    vlc_video_context_Hold(picctx->ctx.ctx.vctx);
+
+    picctx->ctx.devicePtr = (CUdeviceptr)surface;
+    picctx->ctx.bufferPitch = p_pool->pitch;
+    picctx->ctx.bufferHeight = p_pool->height;
+    picctx->pool = pool;
+    nvdec_pool_AddRef(picctx->pool);
+
+    return &picctx->ctx.ctx;
+}
+
+static int ScalePlane(filter_t *p_filter, decoder_device_nvdec_t *devsys,
+                      const pic_context_nvdec_t *src, unsigned src_plane,
+                      const pic_context_nvdec_t *dst, unsigned dst_plane,
+                      unsigned channels, unsigned div)
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const video_format_t *fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *fmt_out = &p_filter->fmt_out.video;
+
+    unsigned dst_x = fmt_out->i_x_offset / div;
+    unsigned dst_y = fmt_out->i_y_offset / div;
+    unsigned dst_width = (fmt_out->i_visible_width + div - 1) / div;
+    unsigned dst_height = (fmt_out->i_visible_height + div - 1) / div;
+    unsigned src_width = (fmt_in->i_visible_width + div - 1) / div;
+    unsigned src_height = (fmt_in->i_visible_height + div - 1) / div;
+
+    CUdeviceptr src_ptr = src->devicePtr
+                        + (CUdeviceptr)src_plane * src->bufferPitch * src->bufferHeight;
+    CUdeviceptr dst_ptr = dst->devicePtr
+                        + (CUdeviceptr)dst_plane * dst->bufferPitch * dst->bufferHeight
+                        + (CUdeviceptr)dst_y * dst->bufferPitch
+                        + dst_x * channels * p_sys->dst_bytes;
+    unsigned src_pitch = src->bufferPitch;
+    unsigned dst_pitch = dst->bufferPitch;
+    unsigned dst_samples = dst_width * channels;
+    float scale_x = (float)src_width / dst_width;
+    float scale_y = (float)src_height / dst_height;
+    float left = fmt_in->i_x_offset / div;
+    float top = fmt_in->i_y_offset / div;
+    float right = left + src_width - 1;
+    float bottom = top + src_height - 1;
+    unsigned src_bytes = p_sys->src_bytes;
+    unsigned dst_bytes = p_sys->dst_bytes;
+
+    void *params[] = {
+        &src_ptr, &src_pitch, &dst_ptr, &dst_pitch, &dst_samples, &dst_height,
+        &channels, &scale_x, &scale_y, &left, &top, &right, &bottom,
+        &src_bytes, &dst_bytes,
+    };
+
+    return CALL_CUDA(cuLaunchKernel, p_sys->kernel,
+                     (dst_samples + BLOCK_WIDTH - 1) / BLOCK_WIDTH,
+                     (dst_height + BLOCK_HEIGHT - 1) / BLOCK_HEIGHT, 1,
+                     BLOCK_WIDTH, BLOCK_HEIGHT, 1, 0, 0, params, NULL);
+}
+
+static picture_t * FilterScale( filter_t *p_filter, picture_t *src )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    picture_t *dst = nvdec_pool_Wait(p_sys->out_pool);
+    if (unlikely(dst == NULL))
+    {
+        picture_Release(src);
+        return NULL;
+    }
+
+    pic_context_nvdec_t *srcpic = NVDEC_PICCONTEXT_FROM_PICCTX(src->context);
+    pic_context_nvdec_t *dstpic = NVDEC_PICCONTEXT_FROM_PICCTX(dst->context);
+    decoder_device_nvdec_t *devsys = GetNVDECOpaqueDevice(p_sys->dec_dev);
+
+    int result = CALL_CUDA(cuCtxPushCurrent, devsys->cuCtx);
+    if (result != VLC_SUCCESS)
+    {
+        picture_Release(dst);
+        picture_Release(src);
+        return NULL;
+    }
+
+    if (p_sys->is_444)
+    {
+        for (unsigned i = 0; i < 3 && result == VLC_SUCCESS; i++)
+            result = ScalePlane(p_filter, devsys, srcpic, i, dstpic, i, 1, 1);
+    }
+    else
+    {
+        result = ScalePlane(p_filter, devsys, srcpic, 0, dstpic, 0, 1, 1);
+        if (result == VLC_SUCCESS)
+            result = ScalePlane(p_filter, devsys, srcpic, 1, dstpic, 1, 2, 2);
+    }
+
+    // Synchronize before releasing src, which the decoder may then reuse
+    int sync_result = CALL_CUDA(cuStreamSynchronize, 0);
+    result = result != VLC_SUCCESS ? result : sync_result;
+
+    CALL_CUDA(cuCtxPopCurrent, NULL);
+
+    if (result != VLC_SUCCESS)
+    {
+        picture_Release(dst);
+        dst = NULL;
+    }
+    else
+        picture_CopyProperties(dst, src);
+    picture_Release(src);
+    return dst;
+}
+
+static void CloseScale( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    decoder_device_nvdec_t *devsys = GetNVDECOpaqueDevice(p_sys->dec_dev);
+
+    nvdec_pool_Release(p_sys->out_pool);
+    if (CALL_CUDA(cuCtxPushCurrent, devsys->cuCtx) == VLC_SUCCESS)
+    {
+        CALL_CUDA(cuModuleUnload, p_sys->module);
+        CALL_CUDA(cuCtxPopCurrent, NULL);
+    }
+    vlc_video_context_Release(p_filter->vctx_out);
+    vlc_decoder_device_Release(p_sys->dec_dev);
+    free(p_sys);
+}
+
+static const struct vlc_filter_operations filter_ops = {
+    .filter_video = FilterScale, .close = CloseScale,
+};
+
+/* Crops, scales and converts the bit depth of NVDEC pictures without
+ * leaving the GPU, e.g. for transcoding. */
+static int OpenScale( filter_t *p_filter )
+{
+    const video_format_t *fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *fmt_out = &p_filter->fmt_out.video;
+
+    if ( p_filter->vctx_in == NULL ||
+         vlc_video_context_GetType(p_filter->vctx_in) != VLC_VIDEO_CONTEXT_NVDEC )
+        return VLC_EGENERIC;
+
+    int in = GetFormat(fmt_in->i_chroma);
+    int out = GetFormat(fmt_out->i_chroma);
+    if (in < 0 || out < 0 || formats[in].is_444 != formats[out].is_444)
+        return VLC_EGENERIC;
+    if (fmt_in->orientation != fmt_out->orientation)
+        return VLC_EGENERIC;
+    if (fmt_out->i_visible_width == 0 || fmt_out->i_visible_height == 0)
+        return VLC_EGENERIC;
+
+    filter_sys_t *p_sys = calloc(1, sizeof(*p_sys));
+    if (unlikely(p_sys == NULL))
+        return VLC_ENOMEM;
+
+    p_sys->src_bytes = formats[in].bytes;
+    p_sys->dst_bytes = formats[out].bytes;
+    p_sys->is_444 = formats[out].is_444;
+    p_sys->dec_dev = vlc_video_context_HoldDevice(p_filter->vctx_in);
+    p_filter->p_sys = p_sys;
+
+    decoder_device_nvdec_t *devsys = GetNVDECOpaqueDevice(p_sys->dec_dev);
+    if (devsys == NULL)
+        goto error;
+
+    scale_pool_t *pool = malloc(sizeof(*pool));
+    if (unlikely(pool == NULL))
+        goto error;
+
+    pool->owner = (nvdec_pool_owner_t) {
+        NULL, PoolRelease, PoolAttachPicture,
+    };
+    pool->dec_dev = vlc_decoder_device_Hold(p_sys->dec_dev);
+    pool->vctx = p_filter->vctx_in;
+    pool->pitch = vlc_align(fmt_out->i_width * p_sys->dst_bytes, PITCH_ALIGN);
+    pool->height = vlc_align(fmt_out->i_height, 2);
+
+    size_t size = (size_t)pool->pitch * pool->height;
+    size = p_sys->is_444 ? 3 * size : size + size / 2;
+
+    if (CALL_CUDA(cuCtxPushCurrent, devsys->cuCtx) != VLC_SUCCESS)
+    {
+        vlc_decoder_device_Release(pool->dec_dev);
+        free(pool);
+        goto error;
+    }
+
+    int result = CALL_CUDA(cuModuleLoadData, &p_sys->module, scale_ptx);
+    if (result == VLC_SUCCESS)
+    {
+        result = CALL_CUDA(cuModuleGetFunction, &p_sys->kernel,
+                           p_sys->module, "vlc_cuda_scale");
+        if (result != VLC_SUCCESS)
+            CALL_CUDA(cuModuleUnload, p_sys->module);
+    }
+
+    CUdeviceptr outputDevicePtr[POOL_SIZE] = { 0 };
+    for (size_t i=0; i < ARRAY_SIZE(outputDevicePtr) && result == VLC_SUCCESS; i++)
+    {
+        result = CALL_CUDA(cuMemAlloc, &outputDevicePtr[i], size);
+        if (result != VLC_SUCCESS)
+        {
+            while (i)
+                CALL_CUDA(cuMemFree, outputDevicePtr[--i]);
+            CALL_CUDA(cuModuleUnload, p_sys->module);
+        }
+    }
+    CALL_CUDA(cuCtxPopCurrent, NULL);
+
+    if (result != VLC_SUCCESS)
+    {
+        vlc_decoder_device_Release(pool->dec_dev);
+        free(pool);
+        goto error;
+    }
+
+    void *bufferPtr[ARRAY_SIZE(outputDevicePtr)];
+    for (size_t i=0; i<ARRAY_SIZE(outputDevicePtr); i++)
+        bufferPtr[i] = (void*)(uintptr_t)outputDevicePtr[i];
+    p_sys->out_pool = nvdec_pool_Create(&pool->owner, fmt_out,
+                                        p_filter->vctx_in, bufferPtr,
+                                        ARRAY_SIZE(outputDevicePtr));
+    if (p_sys->out_pool == NULL)
+    {
+        PoolRelease(&pool->owner, bufferPtr, ARRAY_SIZE(outputDevicePtr));
+        if (CALL_CUDA(cuCtxPushCurrent, devsys->cuCtx) == VLC_SUCCESS)
+        {
+            CALL_CUDA(cuModuleUnload, p_sys->module);
+            CALL_CUDA(cuCtxPopCurrent, NULL);
+        }
+        goto error;
+    }
+
+    p_filter->vctx_out = vlc_video_context_Hold(p_filter->vctx_in);
+    p_filter->ops = &filter_ops;
+
+    msg_Dbg(p_filter, "scaling %ux%u %4.4s to %ux%u %4.4s",
+            fmt_in->i_visible_width, fmt_in->i_visible_height,
+            (const char *) &fmt_in->i_chroma,
+            fmt_out->i_visible_width, fmt_out->i_visible_height,
+            (const char *) &fmt_out->i_chroma);
+    return VLC_SUCCESS;
+
+error:
+    vlc_decoder_device_Release(p_sys->dec_dev);
+    free(p_sys);
+    return VLC_EGENERIC;
+}
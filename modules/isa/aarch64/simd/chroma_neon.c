@@ -0,0 +1,289 @@
+/*****************************************************************************
+ * chroma_neon.c: AArch64 AdvSIMD chroma conversion kernels
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <arm_neon.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../../arm/neon/chroma_neon.h"
+
+/* Same as the 32-bit ARM NEON versions: the width is rounded up to the
+ * vector size, into the line padding (see chroma_neon.h). */
+
+/* Planar to packed YUV 4:2:2 */
+static void planar_packed(struct yuv_pack *const out,
+                          const struct yuv_planes *const in,
+                          int width, int height, int vsub, int uyvy)
+{
+    const size_t cpitch = in->pitch / 2;
+
+    for (int j = 0; j < height; j++) {
+        const uint8_t *y = (const uint8_t *)in->y + j * in->pitch;
+        const uint8_t *u = (const uint8_t *)in->u + (j / vsub) * cpitch;
+        const uint8_t *v = (const uint8_t *)in->v + (j / vsub) * cpitch;
+        uint8_t *o = (uint8_t *)out->yuv + j * out->pitch;
+
+        for (int i = 0; i < width; i += 16, o += 32) {
+            const uint8x16_t l = vld1q_u8(y + i);
+            const uint8x8_t cb = vld1_u8(u + i / 2);
+            const uint8x8_t cr = vld1_u8(v + i / 2);
+            const uint8x16_t c = vcombine_u8(vzip1_u8(cb, cr),
+                                             vzip2_u8(cb, cr));
+            uint8x16x2_t px;
+
+            if (uyvy) {
+                px.val[0] = vzip1q_u8(c, l);
+                px.val[1] = vzip2q_u8(c, l);
+            } else {
+                px.val[0] = vzip1q_u8(l, c);
+                px.val[1] = vzip2q_u8(l, c);
+            }
+            vst1q_u8(o, px.val[0]);
+            vst1q_u8(o + 16, px.val[1]);
+        }
+    }
+}
+
+void i420_yuyv_neon(struct yuv_pack *const out,
+                    const struct yuv_planes *const in, int width, int height)
+{
+    planar_packed(out, in, width, height, 2, 0);
+}
+
+void i420_uyvy_neon(struct yuv_pack *const out,
+                    const struct yuv_planes *const in, int width, int height)
+{
+    planar_packed(out, in, width, height, 2, 1);
+}
+
+void i422_yuyv_neon(struct yuv_pack *const out,
+                    const struct yuv_planes *const in, int width, int height)
+{
+    planar_packed(out, in, width, height, 1, 0);
+}
+
+void i422_uyvy_neon(struct yuv_pack *const out,
+                    const struct yuv_planes *const in, int width, int height)
+{
+    planar_packed(out, in, width, height, 1, 1);
+}
+
+/* Packed YUV 4:2:2 to planar */
+static void packed_planar(struct yuv_planes *const out,
+                          const struct yuv_pack *const in,
+                          int width, int height, int uyvy)
+{
+    const size_t cpitch = out->pitch / 2;
+
+    for (int j = 0; j < height; j++) {
+        const uint8_t *p = (const uint8_t *)in->yuv + j * in->pitch;
+        uint8_t *y = (uint8_t *)out->y + j * out->pitch;
+        uint8_t *u = (uint8_t *)out->u + j * cpitch;
+        uint8_t *v = (uint8_t *)out->v + j * cpitch;
+
+        for (int i = 0; i < width; i += 16, p += 32) {
+            const uint8x16x2_t px = vld2q_u8(p);
+            const uint8x8x2_t c = vuzp_u8(vget_low_u8(px.val[!uyvy]),
+                                          vget_high_u8(px.val[!uyvy]));
+
+            vst1q_u8(y + i, px.val[uyvy]);
+            vst1_u8(u + i / 2, c.val[0]);
+            vst1_u8(v + i / 2, c.val[1]);
+        }
+    }
+}
+
+void yuyv_i422_neon(struct yuv_planes *const out,
+                    const struct yuv_pack *const in, int width, int height)
+{
+    packed_planar(out, in, width, height, 0);
+}
+
+void uyvy_i422_neon(struct yuv_planes *const out,
+                    const struct yuv_pack *const in, int width, int height)
+{
+    packed_planar(out, in, width, height, 1);
+}
+
+/* Semiplanar to planar */
+void deinterleave_chroma_neon(struct uv_planes *const out,
+                              const struct yuv_pack *const in,
+                              int width, int height)
+{
+    for (int j = 0; j < height; j++) {
+        const uint8_t *p = (const uint8_t *)in->yuv + j * in->pitch;
+        uint8_t *u = (uint8_t *)out->u + j * out->pitch;
+        uint8_t *v = (uint8_t *)out->v + j * out->pitch;
+
+        for (int i = 0; i < width; i += 16) {
+            const uint8x16x2_t c = vld2q_u8(p + 2 * i);
+
+            vst1q_u8(u + i, c.val[0]);
+            vst1q_u8(v + i, c.val[1]);
+        }
+    }
+}
+
+/* YUV to RGB, with the coefficients of the 32-bit versions (scaled by 64):
+ * R = 74 * Y + 115 * V - 15872
+ * G = 74 * Y -  14 * U - 34 * V + 4992
+ * B = 74 * Y + 135 * U - 18432 */
+struct chroma
+{
+    int16x8_t r, g, b;
+};
+
+static inline struct chroma chroma_coefs(uint8x8_t u, uint8x8_t v)
+{
+    struct chroma c;
+    uint16x8_t g = vmull_u8(u, vdup_n_u8(14));
+
+    g = vmlal_u8(g, v, vdup_n_u8(34));
+    c.r = vaddq_s16(vdupq_n_s16(-15872),
+                    vreinterpretq_s16_u16(vmull_u8(v, vdup_n_u8(115))));
+    c.g = vsubq_s16(vdupq_n_s16(4992), vreinterpretq_s16_u16(g));
+    c.b = vaddq_s16(vdupq_n_s16(-18432),
+                    vreinterpretq_s16_u16(vmull_u8(u, vdup_n_u8(135))));
+    return c;
+}
+
+/* Converts 8 pixels, with one chroma value per pixel */
+static inline uint8x8x3_t rgb8(uint8x8_t y, int16x8_t r, int16x8_t g,
+                                int16x8_t b)
+{
+    const int16x8_t l = vreinterpretq_s16_u16(vmull_u8(y, vdup_n_u8(74)));
+    uint8x8x3_t px;
+
+    px.val[0] = vqrshrun_n_s16(vqaddq_s16(l, r), 6);
+    px.val[1] = vqrshrun_n_s16(vqaddq_s16(l, g), 6);
+    px.val[2] = vqrshrun_n_s16(vqaddq_s16(l, b), 6);
+    return px;
+}
+
+/* Converts 16 pixels of a line, with 8 chroma samples */
+static inline uint8x16x3_t rgb16(const uint8_t *y, const struct chroma *c)
+{
+    const uint8x16_t l = vld1q_u8(y);
+    const uint8x8x3_t lo = rgb8(vget_low_u8(l), vzip1q_s16(c->r, c->r),
+                                vzip1q_s16(c->g, c->g),
+                                vzip1q_s16(c->b, c->b));
+    const uint8x8x3_t hi = rgb8(vget_high_u8(l), vzip2q_s16(c->r, c->r),
+                                vzip2q_s16(c->g, c->g),
+                                vzip2q_s16(c->b, c->b));
+    uint8x16x3_t px;
+
+    for (int k = 0; k < 3; k++)
+        px.val[k] = vcombine_u8(lo.val[k], hi.val[k]);
+    return px;
+}
+
+static inline void store_rgba(uint8_t *o, const uint8x16x3_t *px)
+{
+    uint8x16x4_t rgba;
+
+    rgba.val[0] = px->val[0];
+    rgba.val[1] = px->val[1];
+    rgba.val[2] = px->val[2];
+    rgba.val[3] = vdupq_n_u8(255);
+    vst4q_u8(o, rgba);
+}
+
+static inline void store_rv16(uint8_t *o, const uint8x16x3_t *px)
+{
+    uint8x16x2_t rgb;
+
+    /* green low bits and blue in the low byte, red and green in the high */
+    rgb.val[0] = vsriq_n_u8(vshlq_n_u8(px->val[1], 3), px->val[2], 3);
+    rgb.val[1] = vsriq_n_u8(px->val[0], px->val[1], 5);
+    vst2q_u8(o, rgb);
+}
+
+enum chroma_layout
+{
+    PLANAR,
+    SEMIPLANAR_UV,
+    SEMIPLANAR_VU,
+};
+
+static inline void yuv420_rgb(struct yuv_pack *const out,
+                              const struct yuv_planes *const in,
+                              int width, int height,
+                              enum chroma_layout layout, int rv16)
+{
+    const size_t cpitch = layout == PLANAR ? in->pitch / 2 : in->pitch;
+
+    for (int j = 0; j < height; j++) {
+        const uint8_t *y = (const uint8_t *)in->y + j * in->pitch;
+        const uint8_t *u = (const uint8_t *)in->u + (j / 2) * cpitch;
+        uint8_t *o = (uint8_t *)out->yuv + j * out->pitch;
+
+        for (int i = 0; i < width; i += 16) {
+            struct chroma c;
+
+            if (layout == PLANAR) {
+                const uint8_t *v = (const uint8_t *)in->v + (j / 2) * cpitch;
+
+                c = chroma_coefs(vld1_u8(u + i / 2), vld1_u8(v + i / 2));
+            } else {
+                const uint8x8x2_t uv = vld2_u8(u + i);
+
+                if (layout == SEMIPLANAR_UV)
+                    c = chroma_coefs(uv.val[0], uv.val[1]);
+                else
+                    c = chroma_coefs(uv.val[1], uv.val[0]);
+            }
+
+            const uint8x16x3_t px = rgb16(y + i, &c);
+
+            if (rv16)
+                store_rv16(o + 2 * i, &px);
+            else
+                store_rgba(o + 4 * i, &px);
+        }
+    }
+}
+
+void i420_rgb_neon(struct yuv_pack *const out,
+                   const struct yuv_planes *const in, int width, int height)
+{
+    yuv420_rgb(out, in, width, height, PLANAR, 0);
+}
+
+void i420_rv16_neon(struct yuv_pack *const out,
+                    const struct yuv_planes *const in, int width, int height)
+{
+    yuv420_rgb(out, in, width, height, PLANAR, 1);
+}
+
+void nv12_rgb_neon(struct yuv_pack *const out,
+                   const struct yuv_planes *const in, int width, int height)
+{
+    yuv420_rgb(out, in, width, height, SEMIPLANAR_UV, 0);
+}
+
+void nv21_rgb_neon(struct yuv_pack *const out,
+                   const struct yuv_planes *const in, int width, int height)
+{
+    yuv420_rgb(out, in, width, height, SEMIPLANAR_VU, 0);
+}
@@ -29,6 +29,8 @@
 
 void merge8_arm64(void *, const void *, const void *, size_t);
 void merge16_arm64(void *, const void *, const void *, size_t);
+void yadif_line8_arm64(uint8_t *, uint8_t *, uint8_t *, uint8_t *,
+                       int, int, int, int, int);
 
 static void Probe(void *data)
 {
@@ -37,6 +39,7 @@ static void Probe(void *data)
 
         f->merges[0] = merge8_arm64;
         f->merges[1] = merge16_arm64;
+        f->yadif = yadif_line8_arm64;
     }
 }
 
@@ -0,0 +1,136 @@
+/*****************************************************************************
+ * simple_channel_mixer.c: AArch64 AdvSIMD simple channel mixer kernels
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <arm_neon.h>
+#include <stdbool.h>
+
+/* These implement the entry points declared by NEON_WRAPPER() in
+ * audio_filter/channel_mixer/simple_neon.h, with the same coefficients as
+ * the C DoWork functions. */
+
+void convert_7_x_to_2_0_neon_asm(float *dst, const float *src, int num,
+                                 bool lfe)
+{
+    const int stride = lfe ? 8 : 7;
+
+    for (int i = 0; i < num; i++, src += stride, dst += 2) {
+        float32x2_t v = vld1_f32(src);
+
+        v = vadd_f32(v, vdup_n_f32(src[6] * 0.7071f));
+        v = vmla_n_f32(v, vadd_f32(vld1_f32(src + 2), vld1_f32(src + 4)),
+                       0.25f);
+        vst1_f32(dst, v);
+    }
+}
+
+void convert_5_x_to_2_0_neon_asm(float *dst, const float *src, int num,
+                                 bool lfe)
+{
+    const int stride = lfe ? 6 : 5;
+
+    for (int i = 0; i < num; i++, src += stride, dst += 2) {
+        const float32x2_t s = vadd_f32(vdup_n_f32(src[4]),
+                                       vld1_f32(src + 2));
+
+        vst1_f32(dst, vmla_n_f32(vld1_f32(src), s, 0.7071f));
+    }
+}
+
+void convert_4_0_to_2_0_neon_asm(float *dst, const float *src, int num,
+                                 bool lfe)
+{
+    (void) lfe;
+
+    for (int i = 0; i < num; i++, src += 4, dst += 2) {
+        const float32x2_t s = vdup_n_f32(src[2] + src[3]);
+
+        vst1_f32(dst, vmla_n_f32(s, vld1_f32(src), 0.5f));
+    }
+}
+
+void convert_3_x_to_2_0_neon_asm(float *dst, const float *src, int num,
+                                 bool lfe)
+{
+    const int stride = lfe ? 4 : 3;
+
+    for (int i = 0; i < num; i++, src += stride, dst += 2) {
+        const float32x2_t s = vdup_n_f32(src[2]);
+
+        vst1_f32(dst, vmla_n_f32(s, vld1_f32(src), 0.5f));
+    }
+}
+
+void convert_7_x_to_1_0_neon_asm(float *dst, const float *src, int num,
+                                 bool lfe)
+{
+    static const float coeffs[4] = { 0.25f, 0.25f, 0.125f, 0.125f };
+    const float32x4_t c = vld1q_f32(coeffs);
+    const int stride = lfe ? 8 : 7;
+
+    for (int i = 0; i < num; i++, src += stride) {
+        const float32x4_t s = vmulq_f32(vld1q_f32(src), c);
+
+        *dst++ = vaddvq_f32(s) + (src[4] + src[5]) * 0.125f + src[6];
+    }
+}
+
+void convert_5_x_to_1_0_neon_asm(float *dst, const float *src, int num,
+                                 bool lfe)
+{
+    static const float coeffs[4] = { 0.7071f, 0.7071f, 0.5f, 0.5f };
+    const float32x4_t c = vld1q_f32(coeffs);
+    const int stride = lfe ? 6 : 5;
+
+    for (int i = 0; i < num; i++, src += stride)
+        *dst++ = vaddvq_f32(vmulq_f32(vld1q_f32(src), c)) + src[4];
+}
+
+void convert_7_x_to_4_0_neon_asm(float *dst, const float *src, int num,
+                                 bool lfe)
+{
+    const int stride = lfe ? 8 : 7;
+
+    for (int i = 0; i < num; i++, src += stride, dst += 4) {
+        const float32x2_t side = vld1_f32(src + 2);
+        const float32x2_t front = vmla_n_f32(vdup_n_f32(src[6]),
+                                             vld1_f32(src), 0.5f);
+        const float32x4_t v = vcombine_f32(front, vld1_f32(src + 4));
+
+        vst1q_f32(dst, vmlaq_n_f32(v, vcombine_f32(side, side), 1.f / 6));
+    }
+}
+
+void convert_5_x_to_4_0_neon_asm(float *dst, const float *src, int num,
+                                 bool lfe)
+{
+    const int stride = lfe ? 6 : 5;
+
+    for (int i = 0; i < num; i++, src += stride, dst += 4) {
+        const float32x2_t ctr = vdup_n_f32(src[4] * 0.7071f);
+        const float32x4_t v = vcombine_f32(vadd_f32(vld1_f32(src), ctr),
+                                           vld1_f32(src + 2));
+
+        vst1q_f32(dst, v);
+    }
+}
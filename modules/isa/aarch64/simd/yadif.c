@@ -0,0 +1,126 @@
+/*****************************************************************************
+ * yadif.c: AArch64 AdvSIMD Yadif line filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <arm_neon.h>
+#include <stdint.h>
+
+void yadif_line8_arm64(uint8_t *, uint8_t *, uint8_t *, uint8_t *,
+                       int, int, int, int, int);
+
+static inline int16x8_t load8(const uint8_t *p)
+{
+    return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p)));
+}
+
+static inline int16x8_t score(const uint8_t *cur, int mrefs, int prefs, int j)
+{
+    int16x8_t s = vabdq_s16(load8(&cur[mrefs - 1 + j]),
+                            load8(&cur[prefs - 1 - j]));
+
+    s = vaddq_s16(s, vabdq_s16(load8(&cur[mrefs + j]),
+                               load8(&cur[prefs - j])));
+    s = vaddq_s16(s, vabdq_s16(load8(&cur[mrefs + 1 + j]),
+                               load8(&cur[prefs + 1 - j])));
+    return s;
+}
+
+#define CHECK(j) \
+    do { \
+        const int16x8_t sc = score(cur, mrefs, prefs, j); \
+        better = vandq_u16(better, vcgtq_s16(spatial_score, sc)); \
+        spatial_score = vbslq_s16(better, sc, spatial_score); \
+        spatial_pred = vbslq_s16(better, \
+                                 vhaddq_s16(load8(&cur[mrefs + (j)]), \
+                                            load8(&cur[prefs - (j)])), \
+                                 spatial_pred); \
+    } while (0)
+
+/* Same as yadif_filter_line_c(), 8 pixels at a time. Like the x86 versions,
+ * this rounds the width up, into the line padding. */
+void yadif_line8_arm64(uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                       uint8_t *next, int w, int prefs, int mrefs,
+                       int parity, int mode)
+{
+    uint8_t *prev2 = parity ? prev : cur;
+    uint8_t *next2 = parity ? cur  : next;
+
+    for (int x = 0; x < w; x += 8) {
+        const int16x8_t c = load8(&cur[mrefs]);
+        const int16x8_t e = load8(&cur[prefs]);
+        const int16x8_t p2 = load8(prev2);
+        const int16x8_t n2 = load8(next2);
+        const int16x8_t d = vhaddq_s16(p2, n2);
+        const int16x8_t temporal_diff0 = vabdq_s16(p2, n2);
+        const int16x8_t temporal_diff1 =
+            vhaddq_s16(vabdq_s16(load8(&prev[mrefs]), c),
+                       vabdq_s16(load8(&prev[prefs]), e));
+        const int16x8_t temporal_diff2 =
+            vhaddq_s16(vabdq_s16(load8(&next[mrefs]), c),
+                       vabdq_s16(load8(&next[prefs]), e));
+        int16x8_t diff = vmaxq_s16(vmaxq_s16(vshrq_n_s16(temporal_diff0, 1),
+                                             temporal_diff1), temporal_diff2);
+        int16x8_t spatial_pred = vhaddq_s16(c, e);
+        int16x8_t spatial_score = vsubq_s16(score(cur, mrefs, prefs, 0),
+                                            vdupq_n_s16(1));
+        uint16x8_t better;
+
+        /* The second check of each side only applies where the first one
+         * improved the score, as in the nested C version. */
+        better = vdupq_n_u16(0xffff);
+        CHECK(-1);
+        CHECK(-2);
+        better = vdupq_n_u16(0xffff);
+        CHECK(1);
+        CHECK(2);
+
+        if (mode < 2) {
+            const int16x8_t b = vhaddq_s16(load8(&prev2[2 * mrefs]),
+                                           load8(&next2[2 * mrefs]));
+            const int16x8_t f = vhaddq_s16(load8(&prev2[2 * prefs]),
+                                           load8(&next2[2 * prefs]));
+            const int16x8_t de = vsubq_s16(d, e);
+            const int16x8_t dc = vsubq_s16(d, c);
+            const int16x8_t bc = vsubq_s16(b, c);
+            const int16x8_t fe = vsubq_s16(f, e);
+            const int16x8_t max = vmaxq_s16(vmaxq_s16(de, dc),
+                                            vminq_s16(bc, fe));
+            const int16x8_t min = vminq_s16(vminq_s16(de, dc),
+                                            vmaxq_s16(bc, fe));
+
+            diff = vmaxq_s16(vmaxq_s16(diff, min), vnegq_s16(max));
+        }
+
+        /* diff is never negative, so this is the same as the C clipping */
+        spatial_pred = vmaxq_s16(spatial_pred, vsubq_s16(d, diff));
+        spatial_pred = vminq_s16(spatial_pred, vaddq_s16(d, diff));
+        vst1_u8(dst, vqmovun_s16(spatial_pred));
+
+        dst += 8;
+        cur += 8;
+        prev += 8;
+        next += 8;
+        prev2 += 8;
+        next2 += 8;
+    }
+}
@@ -0,0 +1,70 @@
+/*****************************************************************************
+ * volume.c: AArch64 Scalable Vector Extension audio volume
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_plugin.h>
+#include <vlc_aout.h>
+#include <vlc_aout_volume.h>
+
+void amplify_float_arm_sve(float *, size_t, float);
+void amplify_ramp_float_arm_sve(float *, size_t, float, float);
+
+static void AmplifyFloat(audio_volume_t *volume, block_t *block, float amp)
+{
+    if (amp != 1.f)
+        amplify_float_arm_sve((float *)block->p_buffer,
+                              block->i_buffer / sizeof (float), amp);
+    (void) volume;
+}
+
+static void RampFloat(audio_volume_t *volume, block_t *block,
+                      float from, float to)
+{
+    size_t n = block->i_buffer / sizeof (float);
+
+    if (n > 0)
+        amplify_ramp_float_arm_sve((float *)block->p_buffer, n, from,
+                                   (to - from) / (float)n);
+    (void) volume;
+}
+
+static int Probe(vlc_object_t *obj)
+{
+    audio_volume_t *volume = (audio_volume_t *)obj;
+
+    if (!vlc_CPU_ARM_SVE() || volume->format != VLC_CODEC_FL32)
+        return VLC_ENOTSUP;
+
+    volume->amplify = AmplifyFloat;
+    volume->amplify_ramp = RampFloat;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_subcategory(SUBCAT_AUDIO_AFILTER)
+    set_description("AArch64 SVE optimisation for audio volume")
+    set_capability("audio volume", 20)
+    set_callback(Probe)
+vlc_module_end()
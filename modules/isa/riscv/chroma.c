@@ -0,0 +1,129 @@
+/*****************************************************************************
+ * chroma.c: RISC-V V planar YUV conversions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_plugin.h>
+
+typedef void (*rvv_line_fn)(void *, const void *, const void *, const void *,
+                            size_t);
+
+void rvv_yuyv_line(void *, const void *, const void *, const void *, size_t);
+void rvv_uyvy_line(void *, const void *, const void *, const void *, size_t);
+void rvv_rgba_line(void *, const void *, const void *, const void *, size_t);
+
+struct chroma_sys
+{
+    rvv_line_fn line;
+    unsigned vsub; /**< vertical chroma subsampling */
+    bool swap_uv;
+};
+
+static void Convert(filter_t *filter, picture_t *src, picture_t *dst)
+{
+    const struct chroma_sys *sys = filter->p_sys;
+    const unsigned width = filter->fmt_in.video.i_visible_width;
+    const unsigned height = filter->fmt_in.video.i_visible_height;
+    const plane_t *u = &src->p[sys->swap_uv ? V_PLANE : U_PLANE];
+    const plane_t *v = &src->p[sys->swap_uv ? U_PLANE : V_PLANE];
+
+    for (unsigned j = 0; j < height; j++)
+        sys->line(dst->p[0].p_pixels + j * dst->p[0].i_pitch,
+                  src->p[Y_PLANE].p_pixels + j * src->p[Y_PLANE].i_pitch,
+                  u->p_pixels + (j / sys->vsub) * u->i_pitch,
+                  v->p_pixels + (j / sys->vsub) * v->i_pitch,
+                  (width + 1) / 2);
+}
+
+VIDEO_FILTER_WRAPPER(Convert)
+
+static int Open(filter_t *filter)
+{
+    if (!vlc_CPU_RV_V())
+        return VLC_EGENERIC;
+
+    const video_format_t *in = &filter->fmt_in.video;
+    const video_format_t *out = &filter->fmt_out.video;
+
+    if (in->i_width != out->i_width || in->i_height != out->i_height
+     || in->orientation != out->orientation)
+        return VLC_EGENERIC;
+
+    struct chroma_sys cfg = { NULL, 2, false };
+
+    switch (in->i_chroma)
+    {
+        case VLC_CODEC_YV12:
+            cfg.swap_uv = true;
+            /* fall through */
+        case VLC_CODEC_I420:
+            break;
+        case VLC_CODEC_I422:
+            cfg.vsub = 1;
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+
+    switch (out->i_chroma)
+    {
+        case VLC_CODEC_YVYU:
+            cfg.swap_uv = !cfg.swap_uv;
+            /* fall through */
+        case VLC_CODEC_YUYV:
+            cfg.line = rvv_yuyv_line;
+            break;
+        case VLC_CODEC_VYUY:
+            cfg.swap_uv = !cfg.swap_uv;
+            /* fall through */
+        case VLC_CODEC_UYVY:
+            cfg.line = rvv_uyvy_line;
+            break;
+        case VLC_CODEC_RGB32:
+            if (cfg.vsub != 2
+             || out->i_rmask != 0x000000ff || out->i_gmask != 0x0000ff00
+             || out->i_bmask != 0x00ff0000)
+                return VLC_EGENERIC;
+            cfg.line = rvv_rgba_line;
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+
+    struct chroma_sys *sys = vlc_obj_malloc(VLC_OBJECT(filter), sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    *sys = cfg;
+    filter->p_sys = sys;
+    filter->ops = &Convert_ops;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_description("RISC-V V optimisation for video chroma conversions")
+    set_callback_video_converter(Open, 250)
+vlc_module_end()
@@ -0,0 +1,367 @@
+/*****************************************************************************
+ * chrome.c: Chrome trace event format tracer plugin
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * This tracer is a flight recorder: every thread writes fixed-size binary
+ * records into its own ring, without taking any lock nor allocating any
+ * memory once the ring exists. The oldest records are overwritten when a ring
+ * is full. The rings are only formatted when the tracer is destroyed, as a
+ * Chrome trace event file that chrome://tracing and Perfetto can load.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_fs.h>
+#include <vlc_tracer.h>
+
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+
+#define CHROME_FILENAME "vlc-trace.json"
+
+#define RECORD_ENTRIES  6
+#define RECORD_KEY_SIZE 12
+#define RECORD_STR_SIZE 24
+
+struct trace_entry
+{
+    union
+    {
+        int64_t integer;
+        char string[RECORD_STR_SIZE];
+    };
+    char key[RECORD_KEY_SIZE];
+    uint8_t type;
+};
+
+struct trace_record
+{
+    vlc_tick_t date;
+    unsigned long thread;
+    unsigned count;
+    struct trace_entry entries[RECORD_ENTRIES];
+};
+
+struct trace_ring
+{
+    struct trace_ring *next; /**< Next ring in the tracer list */
+    struct trace_ring *next_free; /**< Next ring not owned by any thread */
+    void *owner; /**< Tracer instance */
+    size_t written; /**< Total number of records ever written */
+    struct trace_record records[];
+};
+
+typedef struct
+{
+    FILE *stream;
+    vlc_threadvar_t key;
+    size_t ring_size;
+
+    vlc_mutex_t lock;
+    struct trace_ring *rings;
+    struct trace_ring *free_rings;
+} vlc_tracer_sys_t;
+
+/* Copies a string, truncating it on a UTF-8 sequence boundary. */
+static void CopyString(char *restrict dst, const char *src, size_t size)
+{
+    size_t len = strnlen(src, size);
+
+    if (len == size)
+    {
+        len = size - 1;
+        while (len > 0 && ((unsigned char)src[len] & 0xC0) == 0x80)
+            len--;
+    }
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+static void ReleaseRing(void *data)
+{
+    struct trace_ring *ring = data;
+    vlc_tracer_sys_t *sys = ring->owner;
+
+    /* The records are kept: they carry their own thread ID and will be
+     * dumped along with those of the next thread using this ring. */
+    vlc_mutex_lock(&sys->lock);
+    ring->next_free = sys->free_rings;
+    sys->free_rings = ring;
+    vlc_mutex_unlock(&sys->lock);
+}
+
+static struct trace_ring *AcquireRing(vlc_tracer_sys_t *sys)
+{
+    struct trace_ring *ring;
+
+    vlc_mutex_lock(&sys->lock);
+    ring = sys->free_rings;
+    if (ring != NULL)
+        sys->free_rings = ring->next_free;
+    vlc_mutex_unlock(&sys->lock);
+
+    if (ring == NULL)
+    {
+        ring = malloc(sizeof (*ring)
+                      + sys->ring_size * sizeof (ring->records[0]));
+        if (unlikely(ring == NULL))
+            return NULL;
+
+        ring->owner = sys;
+        ring->written = 0;
+
+        vlc_mutex_lock(&sys->lock);
+        ring->next = sys->rings;
+        sys->rings = ring;
+        vlc_mutex_unlock(&sys->lock);
+    }
+
+    vlc_threadvar_set(sys->key, ring);
+    return ring;
+}
+
+static void TraceChrome(void *opaque, va_list entries)
+{
+    vlc_tracer_sys_t *sys = opaque;
+    struct trace_ring *ring = vlc_threadvar_get(sys->key);
+
+    if (unlikely(ring == NULL))
+    {
+        ring = AcquireRing(sys);
+        if (ring == NULL)
+            return;
+    }
+
+    struct trace_record *rec =
+        &ring->records[ring->written & (sys->ring_size - 1)];
+
+    rec->date = vlc_tick_now();
+    rec->thread = vlc_thread_id();
+    rec->count = 0;
+
+    struct vlc_tracer_entry entry = va_arg(entries, struct vlc_tracer_entry);
+    while (entry.key != NULL && rec->count < RECORD_ENTRIES)
+    {
+        struct trace_entry *e = &rec->entries[rec->count++];
+
+        CopyString(e->key, entry.key, sizeof (e->key));
+        e->type = entry.type;
+        switch (entry.type)
+        {
+            case VLC_TRACER_INT:
+                e->integer = entry.value.integer;
+                break;
+            case VLC_TRACER_STRING:
+                CopyString(e->string, entry.value.string ? entry.value.string
+                                                         : "(null)",
+                           sizeof (e->string));
+                break;
+            default:
+                vlc_assert_unreachable();
+        }
+        entry = va_arg(entries, struct vlc_tracer_entry);
+    }
+
+    ring->written++;
+}
+
+static void PrintString(FILE *stream, const char *str)
+{
+    fputc('"', stream);
+    for (; *str != '\0'; str++)
+    {
+        unsigned char c = *str;
+
+        if (c == '"' || c == '\\')
+            fprintf(stream, "\\%c", c);
+        else if (c < 0x20 || c == 0x7F)
+            fprintf(stream, "\\u%04x", c);
+        else
+            fputc(c, stream);
+    }
+    fputc('"', stream);
+}
+
+static const struct trace_entry *FindEntry(const struct trace_record *rec,
+                                           const char *key)
+{
+    for (unsigned i = 0; i < rec->count; i++)
+        if (rec->entries[i].type == VLC_TRACER_STRING
+         && strcmp(rec->entries[i].key, key) == 0)
+            return &rec->entries[i];
+    return NULL;
+}
+
+static void PrintRecord(FILE *stream, const struct trace_record *rec,
+                        bool first)
+{
+    const struct trace_entry *type = FindEntry(rec, "type");
+    const struct trace_entry *span = FindEntry(rec, "span");
+    const char *phase = "i";
+
+    if (span != NULL)
+    {
+        if (strcmp(span->string, "begin") == 0)
+            phase = "B";
+        else if (strcmp(span->string, "end") == 0)
+            phase = "E";
+    }
+
+    fprintf(stream, "%s\n{\"name\":", first ? "" : ",");
+    PrintString(stream, type != NULL ? type->string : "trace");
+    fprintf(stream, ",\"cat\":\"vlc\",\"ph\":\"%s\",\"ts\":%"PRId64
+            ",\"pid\":1,\"tid\":%lu", phase, US_FROM_VLC_TICK(rec->date),
+            rec->thread);
+    if (phase[0] == 'i')
+        fputs(",\"s\":\"t\"", stream);
+
+    fputs(",\"args\":{", stream);
+    for (unsigned i = 0; i < rec->count; i++)
+    {
+        const struct trace_entry *e = &rec->entries[i];
+
+        if (i > 0)
+            fputc(',', stream);
+        PrintString(stream, e->key);
+        fputc(':', stream);
+        if (e->type == VLC_TRACER_INT)
+            fprintf(stream, "%"PRId64, e->integer);
+        else
+            PrintString(stream, e->string);
+    }
+    fputs("}}", stream);
+}
+
+static void Dump(vlc_tracer_sys_t *sys)
+{
+    FILE *stream = sys->stream;
+    bool first = true;
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", stream);
+    for (struct trace_ring *ring = sys->rings; ring != NULL; ring = ring->next)
+    {
+        size_t start = 0;
+
+        if (ring->written > sys->ring_size)
+            start = ring->written - sys->ring_size;
+
+        for (size_t i = start; i < ring->written; i++)
+        {
+            PrintRecord(stream, &ring->records[i & (sys->ring_size - 1)],
+                        first);
+            first = false;
+        }
+    }
+    fputs("\n]}\n", stream);
+}
+
+static void Close(void *opaque)
+{
+    vlc_tracer_sys_t *sys = opaque;
+
+    /* No more ring releases can happen once the key is gone. */
+    vlc_threadvar_delete(&sys->key);
+
+    Dump(sys);
+    fclose(sys->stream);
+
+    for (struct trace_ring *ring = sys->rings, *next; ring != NULL; ring = next)
+    {
+        next = ring->next;
+        free(ring);
+    }
+    free(sys);
+}
+
+static const struct vlc_tracer_operations chrome_ops =
+{
+    TraceChrome,
+    Close
+};
+
+static const struct vlc_tracer_operations *Open(vlc_object_t *obj,
+                                               void **restrict sysp)
+{
+    vlc_tracer_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    /* The ring size must be a power of two */
+    size_t size = var_InheritInteger(obj, "chrome-tracer-size");
+    sys->ring_size = 1;
+    while (sys->ring_size < size)
+        sys->ring_size <<= 1;
+
+    vlc_mutex_init(&sys->lock);
+    sys->rings = NULL;
+    sys->free_rings = NULL;
+
+    if (vlc_threadvar_create(&sys->key, ReleaseRing))
+    {
+        free(sys);
+        return NULL;
+    }
+
+    char *path = var_InheritString(obj, "chrome-tracer-file");
+    const char *filename = (path != NULL) ? path : CHROME_FILENAME;
+
+    msg_Dbg(obj, "opening trace file `%s'", filename);
+    sys->stream = vlc_fopen(filename, "wt");
+    if (sys->stream == NULL)
+    {
+        msg_Err(obj, "error opening trace file `%s': %s", filename,
+                vlc_strerror_c(errno));
+        free(path);
+        vlc_threadvar_delete(&sys->key);
+        free(sys);
+        return NULL;
+    }
+    free(path);
+
+    *sysp = sys;
+    return &chrome_ops;
+}
+
+#define FILE_NAME_TEXT N_("Trace filename")
+#define FILE_NAME_LONGTEXT N_("Specify the Chrome trace event filename.")
+
+#define SIZE_TEXT N_("Records per thread")
+#define SIZE_LONGTEXT N_( \
+    "Number of trace records kept for each thread. " \
+    "The oldest records are discarded first.")
+
+vlc_module_begin()
+    set_shortname(N_("Chrome tracer"))
+    set_description(N_("Chrome trace event tracer"))
+    set_subcategory(SUBCAT_ADVANCED_MISC)
+    set_capability("tracer", 0)
+    set_callback(Open)
+
+    add_savefile("chrome-tracer-file", NULL, FILE_NAME_TEXT,
+                 FILE_NAME_LONGTEXT)
+    add_integer_with_range("chrome-tracer-size", 4096, 16, 1 << 20,
+                           SIZE_TEXT, SIZE_LONGTEXT)
+vlc_module_end()
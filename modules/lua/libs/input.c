@@ -624,8 +624,24 @@ static int vlclua_input_item_stats( lua_State *L )
         STATS_INT( lost_pictures )
         STATS_INT( played_abuffers )
         STATS_INT( lost_abuffers )
+        STATS_FLOAT( clock_drift )
+        STATS_INT( latency )
+#define STATS_HISTOGRAM( n ) lua_createtable( L, ARRAY_SIZE(p_item->p_stats->i_ ## n), 0 ); \
+        for( size_t i = 0; i < ARRAY_SIZE(p_item->p_stats->i_ ## n); i++ ) \
+        { \
+            lua_pushinteger( L, p_item->p_stats->i_ ## n[i] ); \
+            lua_rawseti( L, -2, i + 1 ); \
+        } \
+        lua_setfield( L, -2, #n "_histogram" );
+        STATS_HISTOGRAM( clock_jitter )
+        STATS_HISTOGRAM( clock_drift )
+        STATS_HISTOGRAM( decode_late )
+        STATS_HISTOGRAM( filter_time )
+        STATS_HISTOGRAM( render_time )
+        STATS_HISTOGRAM( display_late )
 #undef STATS_INT
 #undef STATS_FLOAT
+#undef STATS_HISTOGRAM
     }
     vlc_mutex_unlock( &p_item->lock );
     return 1;
@@ -39,6 +39,8 @@
 #include <vlc_arrays.h>
 #include <vlc_charset.h>
 #include <vlc_fs.h>
+#include <vlc_list.h>
+#include <vlc_memstream.h>
 #include <vlc_services_discovery.h>
 #include <vlc_stream.h>
 
@@ -654,17 +656,168 @@ int vlclua_add_modules_path( lua_State *L, const char *psz_filename )
     return 0;
 }
 
+/*****************************************************************************
+ * Compiled scripts cache
+ *****************************************************************************
+ * The same scripts are loaded again for every item (meta fetchers, playlist
+ * parsers) and every new Lua state. Keep their bytecode, so that they are
+ * only parsed and compiled once, as long as the file is not modified.
+ *****************************************************************************/
+#define BYTECODE_CACHE_MAX (8 << 20)
+
+#if LUA_VERSION_NUM >= 503
+# define vlclua_dump( L, writer, data ) lua_dump( L, writer, data, 0 )
+#else
+# define vlclua_dump( L, writer, data ) lua_dump( L, writer, data )
+#endif
+
+struct vlclua_bytecode
+{
+    struct vlc_list node;
+    char *psz_path;
+    time_t i_mtime;
+    off_t i_size;
+    size_t i_length;
+    char *p_data;
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    struct vlc_list entries; /* most recently used first */
+    size_t i_length;
+} bytecode_cache = {
+    .lock = VLC_STATIC_MUTEX,
+    .entries = VLC_LIST_INITIALIZER(&bytecode_cache.entries),
+    .i_length = 0,
+};
+
+static void vlclua_bytecode_Delete( struct vlclua_bytecode *p_entry )
+{
+    vlc_list_remove( &p_entry->node );
+    bytecode_cache.i_length -= p_entry->i_length;
+    free( p_entry->psz_path );
+    free( p_entry->p_data );
+    free( p_entry );
+}
+
+#ifdef __has_attribute
+# if __has_attribute(destructor)
+__attribute__((destructor)) static void vlclua_bytecode_cache_destructor( void )
+{
+    struct vlclua_bytecode *p_entry;
+    vlc_list_foreach( p_entry, &bytecode_cache.entries, node )
+        vlclua_bytecode_Delete( p_entry );
+}
+# endif
+#endif
+
+static int vlclua_bytecode_write( lua_State *L, const void *p, size_t sz,
+                                  void *ud )
+{
+    VLC_UNUSED( L );
+    vlc_memstream_write( ud, p, sz );
+    return 0;
+}
+
+/** Replacement for luaL_loadfile, reusing the compiled chunk if possible */
+static int vlclua_loadfile( lua_State *L, const char *psz_path )
+{
+    struct stat st;
+    if( stat( psz_path, &st ) )
+        return luaL_loadfile( L, psz_path ); /* Let Lua report the error */
+
+    struct vlclua_bytecode *p_entry;
+
+    vlc_mutex_lock( &bytecode_cache.lock );
+    vlc_list_foreach( p_entry, &bytecode_cache.entries, node )
+    {
+        if( strcmp( p_entry->psz_path, psz_path ) )
+            continue;
+
+        if( p_entry->i_mtime == st.st_mtime && p_entry->i_size == st.st_size )
+        {
+            vlc_list_remove( &p_entry->node );
+            vlc_list_prepend( &p_entry->node, &bytecode_cache.entries );
+            int i_ret = luaL_loadbuffer( L, p_entry->p_data,
+                                         p_entry->i_length, psz_path );
+            vlc_mutex_unlock( &bytecode_cache.lock );
+            return i_ret;
+        }
+
+        /* The script was modified */
+        vlclua_bytecode_Delete( p_entry );
+        break;
+    }
+    vlc_mutex_unlock( &bytecode_cache.lock );
+
+    int i_ret = luaL_loadfile( L, psz_path );
+    if( i_ret )
+        return i_ret;
+
+    struct vlc_memstream ms;
+    if( vlc_memstream_open( &ms ) )
+        return 0;
+    bool b_dumped = vlclua_dump( L, vlclua_bytecode_write, &ms ) == 0;
+    if( vlc_memstream_close( &ms ) )
+        return 0;
+    if( !b_dumped || ms.length > BYTECODE_CACHE_MAX / 4 )
+    {
+        free( ms.ptr );
+        return 0;
+    }
+
+    p_entry = malloc( sizeof( *p_entry ) );
+    if( p_entry == NULL || !(p_entry->psz_path = strdup( psz_path )) )
+    {
+        free( p_entry );
+        free( ms.ptr );
+        return 0;
+    }
+    p_entry->i_mtime = st.st_mtime;
+    p_entry->i_size = st.st_size;
+    p_entry->i_length = ms.length;
+    p_entry->p_data = ms.ptr;
+
+    vlc_mutex_lock( &bytecode_cache.lock );
+    struct vlclua_bytecode *p_old;
+    vlc_list_foreach( p_old, &bytecode_cache.entries, node )
+        if( !strcmp( p_old->psz_path, psz_path ) ) /* loaded concurrently */
+            vlclua_bytecode_Delete( p_old );
+
+    vlc_list_prepend( &p_entry->node, &bytecode_cache.entries );
+    bytecode_cache.i_length += p_entry->i_length;
+
+    while( bytecode_cache.i_length > BYTECODE_CACHE_MAX )
+    {
+        p_old = vlc_list_last_entry_or_null( &bytecode_cache.entries,
+                                             struct vlclua_bytecode, node );
+        vlclua_bytecode_Delete( p_old );
+    }
+    vlc_mutex_unlock( &bytecode_cache.lock );
+
+    return 0;
+}
+
+static int vlclua_dofile_local( lua_State *L, const char *psz_path )
+{
+    int i_ret = vlclua_loadfile( L, psz_path );
+    if( !i_ret )
+        i_ret = lua_pcall( L, 0, LUA_MULTRET, 0 );
+    return i_ret;
+}
+
 /** Replacement for luaL_dofile, using VLC's input capabilities */
 int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *curi )
 {
     char *uri = ToLocaleDup( curi );
     if( !strstr( uri, "://" ) ) {
-        int ret = luaL_dofile( L, uri );
+        int ret = vlclua_dofile_local( L, uri );
         free( uri );
         return ret;
     }
     if( !strncasecmp( uri, "file://", 7 ) ) {
-        int ret = luaL_dofile( L, uri + 7 );
+        int ret = vlclua_dofile_local( L, uri + 7 );
         free( uri );
         return ret;
     }
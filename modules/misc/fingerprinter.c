@@ -23,6 +23,7 @@
 
 #include <assert.h>
 #include <stdatomic.h>
+#include <sys/stat.h>
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
@@ -30,6 +31,9 @@
 #include <vlc_modules.h>
 #include <vlc_meta.h>
 #include <vlc_url.h>
+#include <vlc_fs.h>
+#include <vlc_configuration.h>
+#include <vlc_arrays.h>
 
 #include <vlc_player.h>
 #include <vlc_fingerprinter.h>
@@ -40,12 +44,27 @@
  * Local prototypes
  *****************************************************************************/
 
-struct fingerprinter_sys_t
+/* Decodes the requests one at a time with its own player */
+typedef struct
 {
-    vlc_thread_t thread;
-    vlc_player_t *player;
+    fingerprinter_thread_t *p_fingerprinter;
+    vlc_object_t           *p_obj; /* holds the "fingerprint-data" variable */
+    vlc_thread_t            thread;
+    vlc_player_t           *player;
     vlc_player_listener_id *listener_id;
+    vlc_cond_t              cond;
+    bool                    b_working;
+} fingerprinter_worker_t;
+
+/* Fingerprint previously computed, indexed by the cache key of the item */
+typedef struct
+{
+    char        *psz_fingerprint;
+    unsigned int i_duration;
+} fingerprint_cache_entry_t;
 
+struct fingerprinter_sys_t
+{
     atomic_bool abort;
 
     struct
@@ -56,12 +75,15 @@ struct fingerprinter_sys_t
 
     vlc_cond_t              incoming_cond;
 
+    fingerprinter_worker_t *p_workers;
+    unsigned                i_workers;
+
     struct
     {
-        vlc_array_t         queue;
-        vlc_cond_t          cond;
-        bool                b_working;
-    } processing;
+        vlc_dictionary_t    entries;
+        vlc_mutex_t         lock;
+        char               *psz_path;
+    } cache;
 };
 
 static int  Open            (vlc_object_t *);
@@ -72,14 +94,148 @@ static void *Run(void *);
 /*****************************************************************************
  * Module descriptor
  ****************************************************************************/
+#define THREADS_TEXT N_("Fingerprinting threads")
+#define THREADS_LONGTEXT N_("Number of tracks decoded at the same time " \
+                            "(0 for the number of CPUs).")
+#define CACHE_TEXT N_("Cache the fingerprints")
+#define CACHE_LONGTEXT N_("Keep the computed fingerprints in the user cache " \
+                          "directory, so that the tracks are only decoded once.")
+
 vlc_module_begin ()
     set_subcategory(SUBCAT_ADVANCED_MISC)
     set_shortname(N_("acoustid"))
     set_description(N_("Track fingerprinter (based on Acoustid)"))
     set_capability("fingerprinter", 10)
+    add_integer("fingerprinter-threads", 0, THREADS_TEXT, THREADS_LONGTEXT)
+        change_integer_range(0, 32)
+    add_bool("fingerprinter-cache", true, CACHE_TEXT, CACHE_LONGTEXT)
     set_callbacks(Open, Close)
 vlc_module_end ()
 
+/*****************************************************************************
+ * Results cache
+ *****************************************************************************/
+
+/* The fingerprint hardly ever changes for a given file; local files are also
+ * keyed by their modification time, in case the file was replaced */
+static char *CacheKey( const char *psz_uri )
+{
+    long long i_mtime = 0;
+    char *psz_path = vlc_uri2path( psz_uri );
+    if( psz_path != NULL )
+    {
+        struct stat st;
+        if( vlc_stat( psz_path, &st ) == 0 )
+            i_mtime = st.st_mtime;
+        free( psz_path );
+    }
+
+    char *psz_key;
+    if( asprintf( &psz_key, "%s %lld", psz_uri, i_mtime ) == -1 )
+        return NULL;
+    return psz_key;
+}
+
+static void CacheEntryDelete( void *p_data, void *p_obj )
+{
+    VLC_UNUSED(p_obj);
+    fingerprint_cache_entry_t *p_entry = p_data;
+    free( p_entry->psz_fingerprint );
+    free( p_entry );
+}
+
+static void CacheInsert( fingerprinter_sys_t *p_sys, const char *psz_key,
+                         const char *psz_fingerprint, unsigned int i_duration )
+{
+    fingerprint_cache_entry_t *p_entry = malloc( sizeof( *p_entry ) );
+    if( unlikely(p_entry == NULL) )
+        return;
+    p_entry->psz_fingerprint = strdup( psz_fingerprint );
+    p_entry->i_duration = i_duration;
+    if( unlikely(p_entry->psz_fingerprint == NULL) )
+    {
+        free( p_entry );
+        return;
+    }
+
+    vlc_dictionary_remove_value_for_key( &p_sys->cache.entries, psz_key,
+                                         CacheEntryDelete, NULL );
+    vlc_dictionary_insert( &p_sys->cache.entries, psz_key, p_entry );
+}
+
+/* One "<uri> <mtime> <duration> <fingerprint>" line per track; the URI is
+ * percent-encoded, hence free of spaces */
+static void CacheLoad( fingerprinter_thread_t *p_fingerprinter )
+{
+    fingerprinter_sys_t *p_sys = p_fingerprinter->p_sys;
+
+    FILE *file = vlc_fopen( p_sys->cache.psz_path, "rt" );
+    if( file == NULL )
+        return;
+
+    char *psz_line = NULL;
+    size_t i_size = 0;
+    ssize_t i_len;
+    while( (i_len = getline( &psz_line, &i_size, file )) != -1 )
+    {
+        if( i_len > 0 && psz_line[i_len - 1] == '\n' )
+            psz_line[i_len - 1] = '\0';
+
+        /* "<uri> <mtime>" is the key */
+        char *psz_mtime = strchr( psz_line, ' ' );
+        char *psz_duration = psz_mtime ? strchr( psz_mtime + 1, ' ' ) : NULL;
+        char *psz_fingerprint = psz_duration ? strchr( psz_duration + 1, ' ' )
+                                             : NULL;
+        if( psz_fingerprint == NULL || psz_fingerprint[1] == '\0' )
+            continue;
+        *psz_duration++ = '\0';
+        *psz_fingerprint++ = '\0';
+
+        CacheInsert( p_sys, psz_line, psz_fingerprint,
+                     strtoul( psz_duration, NULL, 10 ) );
+    }
+    free( psz_line );
+    fclose( file );
+
+    msg_Dbg( p_fingerprinter, "%d cached fingerprints",
+             vlc_dictionary_keys_count( &p_sys->cache.entries ) );
+}
+
+static bool CacheLookup( fingerprinter_sys_t *p_sys, const char *psz_key,
+                         acoustid_fingerprint_t *fp )
+{
+    bool b_found = false;
+
+    vlc_mutex_lock( &p_sys->cache.lock );
+    fingerprint_cache_entry_t *p_entry =
+        vlc_dictionary_value_for_key( &p_sys->cache.entries, psz_key );
+    if( p_entry != NULL && p_entry != kVLCDictionaryNotFound )
+    {
+        fp->psz_fingerprint = strdup( p_entry->psz_fingerprint );
+        if( !fp->i_duration )
+            fp->i_duration = p_entry->i_duration;
+        b_found = fp->psz_fingerprint != NULL;
+    }
+    vlc_mutex_unlock( &p_sys->cache.lock );
+    return b_found;
+}
+
+static void CacheStore( fingerprinter_sys_t *p_sys, const char *psz_key,
+                        const acoustid_fingerprint_t *fp )
+{
+    vlc_mutex_lock( &p_sys->cache.lock );
+    CacheInsert( p_sys, psz_key, fp->psz_fingerprint, fp->i_duration );
+
+    FILE *file = vlc_fopen( p_sys->cache.psz_path, "at" );
+    if( file != NULL )
+    {
+        fprintf( file, "%s %u %s\n", psz_key, fp->i_duration,
+                 fp->psz_fingerprint );
+        fclose( file );
+    }
+    vlc_mutex_unlock( &p_sys->cache.lock );
+}
+
 /*****************************************************************************
  * Requests lifecycle
  *****************************************************************************/
@@ -94,17 +250,6 @@ static int EnqueueRequest( fingerprinter_thread_t *f, fingerprint_request_t *r )
     return i_ret;
 }
 
-static void QueueIncomingRequests( fingerprinter_sys_t *p_sys )
-{
-    for( size_t i = vlc_array_count( &p_sys->incoming.queue ); i > 0 ; i-- )
-    {
-        fingerprint_request_t *r = vlc_array_item_at_index( &p_sys->incoming.queue, i - 1 );
-        if( vlc_array_append( &p_sys->processing.queue, r ) )
-            fingerprint_request_Delete( r );
-    }
-    vlc_array_clear( &p_sys->incoming.queue );
-}
-
 static fingerprint_request_t * GetResult( fingerprinter_thread_t *f )
 {
     fingerprint_request_t *r = NULL;
@@ -136,15 +281,15 @@ static void player_on_state_changed(vlc_player_t *player,
                                     void *p_user_data)
 {
     VLC_UNUSED(player);
-    fingerprinter_sys_t *p_sys = p_user_data;
+    fingerprinter_worker_t *p_worker = p_user_data;
     if (new_state == VLC_PLAYER_STATE_STOPPED)
     {
-        p_sys->processing.b_working = false;
-        vlc_cond_signal( &p_sys->processing.cond );
+        p_worker->b_working = false;
+        vlc_cond_signal( &p_worker->cond );
     }
 }
 
-static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
+static void DoFingerprint( fingerprinter_worker_t *p_worker,
                            acoustid_fingerprint_t *fp,
                            const char *psz_uri )
 {
@@ -153,10 +298,11 @@ static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
          return;
 
     char *psz_sout_option;
-    /* Note: need at -max- 2 channels, but we can't guess it before playing */
-    /* the stereo upmix could make the mono tracks fingerprint to differ :/ */
+    /* Chromaprint downmixes and resamples to 11025Hz mono anyway: do it in
+     * the converter behind the decoder, so that the fingerprint does not
+     * depend on the channels layout and the sout carries 8 times less data */
     if ( asprintf( &psz_sout_option,
-                   "sout=#transcode{acodec=%s,channels=2}:chromaprint",
+                   "sout=#transcode{acodec=%s,channels=1,samplerate=11025}:chromaprint",
                    ( VLC_CODEC_S16L == VLC_CODEC_S16N ) ? "s16l" : "s16b" )
          == -1 )
     {
@@ -168,7 +314,15 @@ static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
     free( psz_sout_option );
     if ( fp->i_duration )
     {
-        if ( asprintf( &psz_sout_option, "stop-time=%u", fp->i_duration ) == -1 )
+        /* Only the beginning of the track is fingerprinted when its length
+         * is already known */
+        unsigned i_stop = fp->i_duration;
+        int64_t i_window = config_FindConfig( "duration" ) ?
+                           var_InheritInteger( p_worker->p_obj, "duration" ) : 0;
+        if ( i_window > 0 && (uint64_t)i_window < i_stop )
+            i_stop = i_window + 1;
+
+        if ( asprintf( &psz_sout_option, "stop-time=%u", i_stop ) == -1 )
         {
             input_item_Release( p_item );
             return;
@@ -183,24 +337,26 @@ static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
     chroma_fingerprint.psz_fingerprint = NULL;
     chroma_fingerprint.i_duration = fp->i_duration;
 
-    var_Create( p_fingerprinter, "fingerprint-data", VLC_VAR_ADDRESS );
-    var_SetAddress( p_fingerprinter, "fingerprint-data", &chroma_fingerprint );
+    var_SetAddress( p_worker->p_obj, "fingerprint-data", &chroma_fingerprint );
 
-    vlc_player_t *player = p_fingerprinter->p_sys->player;
+    vlc_player_t *player = p_worker->player;
     vlc_player_Lock(player);
 
-    p_fingerprinter->p_sys->processing.b_working = true;
+    p_worker->b_working = true;
 
-    int ret = vlc_player_SetCurrentMedia(player, p_item);
+    /* Close() stops the players after raising the flag */
+    fingerprinter_sys_t *p_sys = p_worker->p_fingerprinter->p_sys;
+    int ret = VLC_EGENERIC;
+    if (!atomic_load_explicit(&p_sys->abort, memory_order_relaxed))
+        ret = vlc_player_SetCurrentMedia(player, p_item);
     if (ret == VLC_SUCCESS)
         ret = vlc_player_Start(player);
     input_item_Release(p_item);
 
     if (ret == VLC_SUCCESS)
     {
-        while( p_fingerprinter->p_sys->processing.b_working )
-            vlc_player_CondWait(player,
-                                &p_fingerprinter->p_sys->processing.cond);
+        while( p_worker->b_working )
+            vlc_player_CondWait(player, &p_worker->cond);
 
         fp->psz_fingerprint = chroma_fingerprint.psz_fingerprint;
         if( !fp->i_duration ) /* had not given hint */
@@ -211,27 +367,25 @@ static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
 }
 
 /*****************************************************************************
- * Open:
+ * Workers
  *****************************************************************************/
-static int Open(vlc_object_t *p_this)
+static int WorkerInit( fingerprinter_thread_t *p_fingerprinter,
+                       fingerprinter_worker_t *p_worker )
 {
-    fingerprinter_thread_t *p_fingerprinter = (fingerprinter_thread_t*) p_this;
-    fingerprinter_sys_t *p_sys = calloc(1, sizeof(fingerprinter_sys_t));
+    p_worker->p_fingerprinter = p_fingerprinter;
+    p_worker->b_working = false;
+    vlc_cond_init( &p_worker->cond );
 
-    if ( !p_sys )
+    p_worker->p_obj = vlc_object_create( p_fingerprinter, sizeof(vlc_object_t) );
+    if (!p_worker->p_obj)
         return VLC_ENOMEM;
+    var_Create( p_worker->p_obj, "fingerprint-data", VLC_VAR_ADDRESS );
 
-    p_fingerprinter->p_sys = p_sys;
-
-    var_Create(p_fingerprinter, "vout", VLC_VAR_STRING);
-    var_SetString(p_fingerprinter, "vout", "dummy");
-    var_Create(p_fingerprinter, "aout", VLC_VAR_STRING);
-    var_SetString(p_fingerprinter, "aout", "dummy");
-    p_sys->player = vlc_player_New(VLC_OBJECT(p_fingerprinter),
-                                   VLC_PLAYER_LOCK_NORMAL, NULL, NULL );
-    if (!p_sys->player)
+    p_worker->player = vlc_player_New(p_worker->p_obj,
+                                      VLC_PLAYER_LOCK_NORMAL, NULL, NULL );
+    if (!p_worker->player)
     {
-        free(p_sys);
+        vlc_object_delete(p_worker->p_obj);
         return VLC_ENOMEM;
     }
 
@@ -239,40 +393,115 @@ static int Open(vlc_object_t *p_this)
         .on_state_changed = player_on_state_changed,
     };
 
-    vlc_player_Lock(p_sys->player);
-    p_sys->listener_id =
-        vlc_player_AddListener(p_sys->player, &cbs, p_fingerprinter->p_sys);
-    vlc_player_Unlock(p_sys->player);
-    if (!p_sys->listener_id)
+    vlc_player_Lock(p_worker->player);
+    p_worker->listener_id =
+        vlc_player_AddListener(p_worker->player, &cbs, p_worker);
+    vlc_player_Unlock(p_worker->player);
+    if (!p_worker->listener_id)
     {
-        vlc_player_Delete(p_sys->player);
-        free(p_sys);
+        vlc_player_Delete(p_worker->player);
+        vlc_object_delete(p_worker->p_obj);
         return VLC_ENOMEM;
     }
 
+    if( vlc_clone( &p_worker->thread, Run, p_worker,
+                   VLC_THREAD_PRIORITY_LOW ) )
+    {
+        msg_Err( p_fingerprinter, "cannot spawn fingerprinter thread" );
+        vlc_player_Lock(p_worker->player);
+        vlc_player_RemoveListener(p_worker->player, p_worker->listener_id);
+        vlc_player_Unlock(p_worker->player);
+        vlc_player_Delete(p_worker->player);
+        vlc_object_delete(p_worker->p_obj);
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static void WorkerClean( fingerprinter_worker_t *p_worker )
+{
+    vlc_join( p_worker->thread, NULL );
+
+    vlc_player_Lock(p_worker->player);
+    vlc_player_RemoveListener(p_worker->player, p_worker->listener_id);
+    vlc_player_Unlock(p_worker->player);
+    vlc_player_Delete(p_worker->player);
+    vlc_object_delete(p_worker->p_obj);
+}
+
+/*****************************************************************************
+ * Open:
+ *****************************************************************************/
+static int Open(vlc_object_t *p_this)
+{
+    fingerprinter_thread_t *p_fingerprinter = (fingerprinter_thread_t*) p_this;
+    fingerprinter_sys_t *p_sys = calloc(1, sizeof(fingerprinter_sys_t));
+
+    if ( !p_sys )
+        return VLC_ENOMEM;
+
+    p_fingerprinter->p_sys = p_sys;
+
+    var_Create(p_fingerprinter, "vout", VLC_VAR_STRING);
+    var_SetString(p_fingerprinter, "vout", "dummy");
+    var_Create(p_fingerprinter, "aout", VLC_VAR_STRING);
+    var_SetString(p_fingerprinter, "aout", "dummy");
+
     atomic_init( &p_sys->abort, false );
     vlc_array_init( &p_sys->incoming.queue );
     vlc_mutex_init( &p_sys->incoming.lock );
     vlc_cond_init( &p_sys->incoming_cond );
 
-    vlc_array_init( &p_sys->processing.queue );
-    vlc_cond_init( &p_sys->processing.cond );
-
     vlc_array_init( &p_sys->results.queue );
     vlc_mutex_init( &p_sys->results.lock );
 
+    vlc_mutex_init( &p_sys->cache.lock );
+    p_sys->cache.psz_path = NULL;
+    if( var_InheritBool( p_fingerprinter, "fingerprinter-cache" ) )
+    {
+        char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+        if( psz_cachedir != NULL )
+        {
+            if( asprintf( &p_sys->cache.psz_path,
+                          "%s" DIR_SEP "fingerprints", psz_cachedir ) == -1 )
+                p_sys->cache.psz_path = NULL;
+            else
+                vlc_mkdir( psz_cachedir, 0700 );
+            free( psz_cachedir );
+        }
+    }
+    vlc_dictionary_init( &p_sys->cache.entries,
+                         p_sys->cache.psz_path ? 1021 : 0 );
+    if( p_sys->cache.psz_path != NULL )
+        CacheLoad( p_fingerprinter );
+
     p_fingerprinter->pf_enqueue = EnqueueRequest;
     p_fingerprinter->pf_getresults = GetResult;
     p_fingerprinter->pf_apply = ApplyResult;
 
     var_Create( p_fingerprinter, "results-available", VLC_VAR_BOOL );
-    if( vlc_clone( &p_sys->thread, Run, p_fingerprinter,
-                   VLC_THREAD_PRIORITY_LOW ) )
-    {
-        msg_Err( p_fingerprinter, "cannot spawn fingerprinter thread" );
+
+    unsigned i_workers = var_InheritInteger( p_fingerprinter,
+                                             "fingerprinter-threads" );
+    if( i_workers == 0 )
+        i_workers = vlc_GetCPUCount();
+    if( i_workers == 0 )
+        i_workers = 1;
+
+    p_sys->p_workers = vlc_alloc( i_workers, sizeof(*p_sys->p_workers) );
+    if( !p_sys->p_workers )
         goto error;
+    for( unsigned i = 0; i < i_workers; i++ )
+    {
+        if( WorkerInit( p_fingerprinter, &p_sys->p_workers[i] ) )
+            break;
+        p_sys->i_workers++;
     }
+    if( p_sys->i_workers == 0 )
+        goto error;
 
+    msg_Dbg( p_fingerprinter, "fingerprinting %u tracks at a time",
+             p_sys->i_workers );
     return VLC_SUCCESS;
 
 error:
@@ -289,34 +518,39 @@ static void Close(vlc_object_t *p_this)
     fingerprinter_thread_t   *p_fingerprinter = (fingerprinter_thread_t*) p_this;
     fingerprinter_sys_t *p_sys = p_fingerprinter->p_sys;
 
-    vlc_mutex_lock( &p_sys->incoming.lock );
-    atomic_store_explicit( &p_sys->abort, true, memory_order_relaxed );
-    vlc_cond_signal( &p_sys->incoming_cond );
-    vlc_mutex_unlock( &p_sys->incoming.lock );
-    vlc_join( p_sys->thread, NULL );
-
     CleanSys( p_sys );
     free( p_sys );
 }
 
 static void CleanSys( fingerprinter_sys_t *p_sys )
 {
+    vlc_mutex_lock( &p_sys->incoming.lock );
+    atomic_store_explicit( &p_sys->abort, true, memory_order_relaxed );
+    vlc_cond_broadcast( &p_sys->incoming_cond );
+    vlc_mutex_unlock( &p_sys->incoming.lock );
+
+    /* Interrupt the tracks being decoded */
+    for ( unsigned i = 0; i < p_sys->i_workers; i++ )
+    {
+        vlc_player_t *player = p_sys->p_workers[i].player;
+        vlc_player_Lock(player);
+        vlc_player_Stop(player);
+        vlc_player_Unlock(player);
+    }
+    for ( unsigned i = 0; i < p_sys->i_workers; i++ )
+        WorkerClean( &p_sys->p_workers[i] );
+    free( p_sys->p_workers );
+
     for ( size_t i = 0; i < vlc_array_count( &p_sys->incoming.queue ); i++ )
         fingerprint_request_Delete( vlc_array_item_at_index( &p_sys->incoming.queue, i ) );
     vlc_array_clear( &p_sys->incoming.queue );
 
-    for ( size_t i = 0; i < vlc_array_count( &p_sys->processing.queue ); i++ )
-        fingerprint_request_Delete( vlc_array_item_at_index( &p_sys->processing.queue, i ) );
-    vlc_array_clear( &p_sys->processing.queue );
-
     for ( size_t i = 0; i < vlc_array_count( &p_sys->results.queue ); i++ )
         fingerprint_request_Delete( vlc_array_item_at_index( &p_sys->results.queue, i ) );
     vlc_array_clear( &p_sys->results.queue );
 
-    vlc_player_Lock(p_sys->player);
-    vlc_player_RemoveListener(p_sys->player, p_sys->listener_id);
-    vlc_player_Unlock(p_sys->player);
-    vlc_player_Delete(p_sys->player);
+    vlc_dictionary_clear( &p_sys->cache.entries, CacheEntryDelete, NULL );
+    free( p_sys->cache.psz_path );
 }
 
 static void fill_metas_with_results( fingerprint_request_t *p_r, acoustid_fingerprint_t *p_f )
@@ -345,7 +579,8 @@ static void fill_metas_with_results( fingerprint_request_t *p_r, acoustid_finger
  *****************************************************************************/
 static void *Run( void *opaque )
 {
-    fingerprinter_thread_t *p_fingerprinter = opaque;
+    fingerprinter_worker_t *p_worker = opaque;
+    fingerprinter_thread_t *p_fingerprinter = p_worker->p_fingerprinter;
     fingerprinter_sys_t *p_sys = p_fingerprinter->p_sys;
 
     /* main loop */
@@ -353,7 +588,8 @@ static void *Run( void *opaque )
     {
         vlc_mutex_lock( &p_sys->incoming.lock );
 
-        while( vlc_array_count( &p_sys->incoming.queue ) == 0 )
+        while( vlc_array_count( &p_sys->incoming.queue ) == 0 ||
+               atomic_load_explicit( &p_sys->abort, memory_order_relaxed ) )
         {
             if( atomic_load_explicit( &p_sys->abort, memory_order_relaxed ) )
             {
@@ -363,60 +599,67 @@ static void *Run( void *opaque )
             vlc_cond_wait( &p_sys->incoming_cond, &p_sys->incoming.lock );
         }
 
-        QueueIncomingRequests( p_sys );
+        /* The requests are handled in submission order, by the first
+         * worker available */
+        fingerprint_request_t *p_data = vlc_array_item_at_index( &p_sys->incoming.queue, 0 );
+        vlc_array_remove( &p_sys->incoming.queue, 0 );
 
         vlc_mutex_unlock( &p_sys->incoming.lock );
 
-        bool results_available = false;
-        while( vlc_array_count( &p_sys->processing.queue ) )
+        char *psz_uri = input_item_GetURI( p_data->p_item );
+        if ( psz_uri != NULL )
         {
-            fingerprint_request_t *p_data = vlc_array_item_at_index( &p_sys->processing.queue, 0 );
+            acoustid_fingerprint_t acoustid_print = {0};
 
-            char *psz_uri = input_item_GetURI( p_data->p_item );
-            if ( psz_uri != NULL )
+            /* overwrite with hint, as in this case, fingerprint's session will be truncated */
+            if ( p_data->i_duration )
+                acoustid_print.i_duration = p_data->i_duration;
+            else
             {
-                 acoustid_fingerprint_t acoustid_print = {0};
-
-                /* overwrite with hint, as in this case, fingerprint's session will be truncated */
-                if ( p_data->i_duration )
-                     acoustid_print.i_duration = p_data->i_duration;
-
-                DoFingerprint( p_fingerprinter, &acoustid_print, psz_uri );
-                free( psz_uri );
-
-                acoustid_config_t cfg = { .p_obj = VLC_OBJECT(p_fingerprinter),
-                                          .psz_server = NULL, .psz_apikey = NULL };
-                acoustid_lookup_fingerprint( &cfg, &acoustid_print );
-                fill_metas_with_results( p_data, &acoustid_print );
-
-                for( unsigned j = 0; j < acoustid_print.results.count; j++ )
-                     acoustid_result_release( &acoustid_print.results.p_results[j] );
-                if( acoustid_print.results.count )
-                    free( acoustid_print.results.p_results );
-                free( acoustid_print.psz_fingerprint );
+                vlc_tick_t i_length = input_item_GetDuration( p_data->p_item );
+                if ( i_length > 0 )
+                    acoustid_print.i_duration = SEC_FROM_VLC_TICK( i_length );
             }
 
-            /* copy results */
-            vlc_mutex_lock( &p_sys->results.lock );
-            if( vlc_array_append( &p_sys->results.queue, p_data ) )
-                fingerprint_request_Delete( p_data );
-            else
-                results_available = true;
-            vlc_mutex_unlock( &p_sys->results.lock );
-
-            // the fingerprint request must not exist both in the
-            // processing and results queue, even in case of thread
-            // cancellation, so remove it immediately
-            vlc_array_remove( &p_sys->processing.queue, 0 );
-
-            if( atomic_load_explicit( &p_sys->abort, memory_order_relaxed ) )
-                return NULL;
+            char *psz_key = p_sys->cache.psz_path ? CacheKey( psz_uri ) : NULL;
+            if ( psz_key == NULL ||
+                 !CacheLookup( p_sys, psz_key, &acoustid_print ) )
+            {
+                DoFingerprint( p_worker, &acoustid_print, psz_uri );
+                if ( psz_key != NULL && acoustid_print.psz_fingerprint != NULL )
+                    CacheStore( p_sys, psz_key, &acoustid_print );
+            }
+            free( psz_key );
+            free( psz_uri );
+
+            acoustid_config_t cfg = { .p_obj = VLC_OBJECT(p_fingerprinter),
+                                      .psz_server = NULL, .psz_apikey = NULL };
+            acoustid_lookup_fingerprint( &cfg, &acoustid_print );
+            fill_metas_with_results( p_data, &acoustid_print );
+
+            for( unsigned j = 0; j < acoustid_print.results.count; j++ )
+                 acoustid_result_release( &acoustid_print.results.p_results[j] );
+            if( acoustid_print.results.count )
+                free( acoustid_print.results.p_results );
+            free( acoustid_print.psz_fingerprint );
         }
 
+        /* copy results */
+        bool results_available = false;
+        vlc_mutex_lock( &p_sys->results.lock );
+        if( vlc_array_append( &p_sys->results.queue, p_data ) )
+            fingerprint_request_Delete( p_data );
+        else
+            results_available = true;
+        vlc_mutex_unlock( &p_sys->results.lock );
+
         if ( results_available )
         {
             var_TriggerCallback( p_fingerprinter, "results-available" );
         }
+
+        if( atomic_load_explicit( &p_sys->abort, memory_order_relaxed ) )
+            return NULL;
     }
 
     vlc_assert_unreachable();
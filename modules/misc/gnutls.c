@@ -47,6 +47,10 @@ typedef struct vlc_tls_gnutls
     vlc_tls_t tls;
     gnutls_session_t session;
     vlc_object_t *obj;
+    vlc_tls_client_t *client; /**< Credentials, for session resumption */
+    char *host; /**< Server waiting for a session ticket, or NULL */
+    char *service;
+    bool started;
 } vlc_tls_gnutls_t;
 
 static void gnutls_Banner(vlc_object_t *obj)
@@ -135,6 +139,46 @@ static int gnutls_GetFD(vlc_tls_t *tls, short *restrict events)
     return vlc_tls_GetPollFD(sock, events);
 }
 
+/**
+ * Stores the session resumption data, for later sessions to the same server.
+ */
+static void gnutls_SessionSave(vlc_tls_gnutls_t *priv, const char *host,
+                               const char *service)
+{
+    gnutls_session_t session = priv->session;
+    gnutls_datum_t data;
+    bool once = false;
+
+#if (GNUTLS_VERSION_NUMBER >= 0x030603)
+    /* TLS 1.3 tickets should not be reused (RFC 8446 appendix C.4) */
+    once = gnutls_protocol_get_version(session) == GNUTLS_TLS1_3;
+#endif
+    if (gnutls_session_get_data2(session, &data) == 0)
+    {
+        vlc_tls_SessionSave(priv->client, host, service, data.data,
+                            data.size, once);
+        gnutls_free(data.data);
+    }
+}
+
+static void gnutls_TicketCheck(vlc_tls_gnutls_t *priv)
+{
+#if (GNUTLS_VERSION_NUMBER >= 0x030603)
+    /* TLS 1.3 tickets come after the handshake, with the records */
+    if (priv->host == NULL
+     || !(gnutls_session_get_flags(priv->session)
+          & GNUTLS_SFLAGS_SESSION_TICKET))
+        return;
+
+    gnutls_SessionSave(priv, priv->host, priv->service);
+    free(priv->service);
+    free(priv->host);
+    priv->host = priv->service = NULL;
+#else
+    (void) priv;
+#endif
+}
+
 static ssize_t gnutls_Recv(vlc_tls_t *tls, struct iovec *iov, unsigned count)
 {
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
@@ -144,6 +188,7 @@ static ssize_t gnutls_Recv(vlc_tls_t *tls, struct iovec *iov, unsigned count)
     while (count > 0)
     {
         ssize_t val = gnutls_record_recv(session, iov->iov_base, iov->iov_len);
+        gnutls_TicketCheck(priv);
         if (val < 0)
             return rcvd ? (ssize_t)rcvd : gnutls_Error(priv, val);
 
@@ -208,6 +253,8 @@ static void gnutls_Close (vlc_tls_t *tls)
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
 
     gnutls_deinit(priv->session);
+    free(priv->service);
+    free(priv->host);
     free(priv);
 }
 
@@ -295,6 +342,10 @@ static vlc_tls_gnutls_t *gnutls_SessionOpen(vlc_object_t *obj, int type,
 
     priv->session = session;
     priv->obj = obj;
+    priv->client = NULL;
+    priv->host = NULL;
+    priv->service = NULL;
+    priv->started = false;
 
     vlc_tls_t *tls = &priv->tls;
 
@@ -352,6 +403,8 @@ static int gnutls_Handshake(vlc_tls_t *tls, char **restrict alp)
         msg_Dbg(obj, " - encrypt then MAC (RFC7366) enabled");
     if (flags & GNUTLS_SFLAGS_FALSE_START)
         msg_Dbg(obj, " - false start (RFC7918) enabled");
+    if (gnutls_session_is_resumed(session))
+        msg_Dbg(obj, " - session resumed");
 
     if (alp != NULL)
     {
@@ -384,6 +437,8 @@ static vlc_tls_t *gnutls_ClientSessionOpen(vlc_tls_client_t *crd,
 
     gnutls_session_t session = priv->session;
 
+    priv->client = crd;
+
     /* minimum DH prime bits */
     gnutls_dh_set_prime_bits (session, 1024);
 
@@ -395,9 +450,9 @@ static vlc_tls_t *gnutls_ClientSessionOpen(vlc_tls_client_t *crd,
     return &priv->tls;
 }
 
-static int gnutls_ClientHandshake(vlc_tls_t *tls,
-                                  const char *host, const char *service,
-                                  char **restrict alp)
+static int gnutls_ClientVerify(vlc_tls_t *tls,
+                               const char *host, const char *service,
+                               char **restrict alp)
 {
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
     vlc_object_t *obj = priv->obj;
@@ -529,6 +584,48 @@ error:
     return -1;
 }
 
+static int gnutls_ClientHandshake(vlc_tls_t *tls,
+                                  const char *host, const char *service,
+                                  char **restrict alp)
+{
+    vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
+    gnutls_session_t session = priv->session;
+
+    if (!priv->started)
+    {   /* Try to resume an earlier session with the same server */
+        size_t len;
+        void *data = vlc_tls_SessionLoad(priv->client, host, service, &len);
+
+        if (data != NULL)
+        {
+            gnutls_session_set_data(session, data, len);
+            free(data);
+        }
+        priv->started = true;
+    }
+
+    int val = gnutls_ClientVerify(tls, host, service, alp);
+    if (val != 0 || host == NULL)
+        return val;
+
+    /* Only sessions with an accepted peer are stored */
+#if (GNUTLS_VERSION_NUMBER >= 0x030603)
+    if (gnutls_protocol_get_version(session) == GNUTLS_TLS1_3)
+    {   /* Wait for the ticket */
+        priv->host = strdup(host);
+        priv->service = (service != NULL) ? strdup(service) : NULL;
+        if (unlikely(service != NULL && priv->service == NULL))
+        {
+            free(priv->host);
+            priv->host = NULL;
+        }
+        return 0;
+    }
+#endif
+    gnutls_SessionSave(priv, host, service);
+    return 0;
+}
+
 static void gnutls_ClientDestroy(vlc_tls_client_t *crd)
 {
     gnutls_certificate_credentials_t x509 = crd->sys;
@@ -27,6 +27,7 @@
 #include <vlc_thumbnailer.h>
 #include <vlc_fs.h>
 #include <vlc_block.h>
+#include <vlc_image.h>
 #include <vlc_url.h>
 #include <vlc_cxx_helpers.hpp>
 
@@ -36,10 +37,14 @@ Thumbnailer::Thumbnailer( vlc_medialibrary_module_t* ml )
     : m_ml( ml )
     , m_currentContext( nullptr )
     , m_thumbnailer( nullptr, &vlc_thumbnailer_Release )
+    , m_imageHandler( nullptr, &image_HandlerDelete )
 {
     m_thumbnailer.reset( vlc_thumbnailer_Create( VLC_OBJECT( ml ) ) );
     if ( unlikely( m_thumbnailer == nullptr ) )
         throw std::runtime_error( "Failed to instantiate a vlc_thumbnailer_t" );
+    m_imageHandler.reset( image_HandlerCreate( ml ) );
+    if ( unlikely( m_imageHandler == nullptr ) )
+        throw std::runtime_error( "Failed to instantiate an image handler" );
 }
 
 void Thumbnailer::onThumbnailComplete( void* data, picture_t* thumbnail )
@@ -83,9 +88,11 @@ bool Thumbnailer::generate( const medialibrary::IMedia&, const std::string& mrl,
     if ( ctx.thumbnail == nullptr )
         return false;
 
+    /* The thumbnails are generated one at a time by the media library */
     block_t* block;
-    if ( picture_Export( VLC_OBJECT( m_ml ), &block, nullptr, ctx.thumbnail,
-                         VLC_CODEC_JPEG, desiredWidth, desiredHeight, true ) != VLC_SUCCESS )
+    if ( picture_ExportWithHandler( m_imageHandler.get(), &block, nullptr,
+                                    ctx.thumbnail, VLC_CODEC_JPEG, desiredWidth,
+                                    desiredHeight, true ) != VLC_SUCCESS )
         return false;
     auto blockPtr = vlc::wrap_cptr( block, &block_Release );
 
@@ -39,6 +39,8 @@
 #include <medialibrary/filesystem/Errors.h>
 #include <sys/stat.h>
 #include <system_error>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 using InputItemPtr = vlc_shared_data_ptr_type(input_item_t,
@@ -65,19 +67,37 @@ SDDirectory::mrl() const
 const std::vector<std::shared_ptr<IFile>> &
 SDDirectory::files() const
 {
+    vlc::threads::mutex_locker lock( m_mutex );
     if ( !m_read_done )
-        read();
+        read( true );
     return m_files;
 }
 
 const std::vector<std::shared_ptr<IDirectory>> &
 SDDirectory::dirs() const
 {
+    vlc::threads::mutex_locker lock( m_mutex );
     if ( !m_read_done )
-        read();
+        read( true );
     return m_dirs;
 }
 
+void
+SDDirectory::prefetch() const
+{
+    vlc::threads::mutex_locker lock( m_mutex );
+    if ( m_read_done )
+        return;
+    try
+    {
+        read( false );
+    }
+    catch ( const std::exception& )
+    {
+        /* The error will be reported when the directory is actually read */
+    }
+}
+
 std::shared_ptr<IDevice>
 SDDirectory::device() const
 {
@@ -188,8 +208,89 @@ static bool request_metadata_sync( libvlc_int_t *libvlc, input_item_t *media,
     return req.success;
 }
 
+/* size and last modification date of the files, by mrl */
+using FileStats = std::unordered_map<std::string, std::pair<int64_t, time_t>>;
+
+/*
+ * Read a local directory directly, instead of running the preparser on it:
+ * the entries are stated relatively to the opened directory, and the
+ * subtitles are attached by the readdir helper, as the directory access
+ * does.
+ */
+static void read_local_directory( libvlc_int_t *libvlc, input_item_t *media,
+                                  const std::string &mrl,
+                                  std::vector<InputItemPtr> *out_children,
+                                  FileStats *out_stats )
+{
+    const auto path = vlc::wrap_cptr( vlc_uri2path( mrl.c_str() ) );
+    if ( path == nullptr )
+        throw medialibrary::fs::errors::System(
+            EINVAL, "Failed to browse directory: Invalid mrl" );
+
+    auto dir = vlc::wrap_cptr( vlc_opendir( path.get() ), &closedir );
+    if ( dir == nullptr )
+        throw medialibrary::fs::errors::System(
+            errno, "Failed to browse directory" );
+
+    auto node = vlc::wrap_cptr( input_item_node_Create( media ),
+                                &input_item_node_Delete );
+    if ( node == nullptr )
+        throw std::bad_alloc();
+
+    struct vlc_readdir_helper rdh;
+    vlc_readdir_helper_init( &rdh, VLC_OBJECT( libvlc ), node.get() );
+
+    int ret = VLC_SUCCESS;
+    const char *entry;
+    while ( ret == VLC_SUCCESS && ( entry = vlc_readdir( dir.get() ) ) != nullptr )
+    {
+        if ( !strcmp( entry, "." ) || !strcmp( entry, ".." ) )
+            continue;
+
+        struct stat st;
+#ifdef HAVE_FSTATAT
+        if ( fstatat( dirfd( dir.get() ), entry, &st, 0 ) != 0 )
+            continue;
+#else
+        std::string entryPath = std::string{ path.get() } + DIR_SEP + entry;
+        if ( vlc_stat( entryPath.c_str(), &st ) != 0 )
+            continue;
+#endif
+        int type;
+        if ( S_ISREG( st.st_mode ) )
+            type = ITEM_TYPE_FILE;
+        else if ( S_ISDIR( st.st_mode ) )
+            type = ITEM_TYPE_DIRECTORY;
+        else
+            continue;
+
+        auto encoded = vlc::wrap_cptr( vlc_uri_encode( entry ) );
+        if ( encoded == nullptr )
+        {
+            ret = VLC_ENOMEM;
+            break;
+        }
+        std::string uri = mrl + encoded.get();
+
+        input_item_t *item;
+        ret = vlc_readdir_helper_additem( &rdh, uri.c_str(), nullptr, entry,
+                                          type, ITEM_NET_UNKNOWN, &item );
+        /* the subtitles are stated too, they may be attached as slaves */
+        if ( ret == VLC_SUCCESS && type == ITEM_TYPE_FILE )
+            out_stats->emplace( std::move( uri ),
+                                std::make_pair( int64_t{ st.st_size }, st.st_mtime ) );
+    }
+
+    vlc_readdir_helper_finish( &rdh, ret == VLC_SUCCESS );
+    if ( ret != VLC_SUCCESS )
+        throw std::bad_alloc();
+
+    for ( int i = 0; i < node->i_children; ++i )
+        out_children->emplace_back( node->pp_children[i]->p_item );
+}
+
 void
-SDDirectory::read() const
+SDDirectory::read( bool prefetchChildren ) const
 {
     auto media =
         vlc::wrap_cptr( input_item_New( m_mrl.c_str(), m_mrl.c_str() ), &input_item_Release );
@@ -197,15 +298,31 @@ SDDirectory::read() const
         throw std::bad_alloc();
 
     std::vector<InputItemPtr> children;
+    FileStats stats;
+
+    /* a previous read might have failed halfway */
+    m_files.clear();
+    m_dirs.clear();
 
     input_item_AddOption( media.get(), "show-hiddenfiles", VLC_INPUT_OPTION_TRUSTED );
     input_item_AddOption( media.get(), "ignore-filetypes=''", VLC_INPUT_OPTION_TRUSTED );
     input_item_AddOption( media.get(), "sub-autodetect-fuzzy=2", VLC_INPUT_OPTION_TRUSTED );
-    auto status = request_metadata_sync( m_fs.libvlc(), media.get(), &children );
 
-    if ( status == false )
-        throw medialibrary::fs::errors::System(
-            EIO, "Failed to browse directory: Unknown error" );
+    if ( m_fs.isNetworkFileSystem() )
+    {
+        auto status = request_metadata_sync( m_fs.libvlc(), media.get(), &children );
+
+        if ( status == false )
+            throw medialibrary::fs::errors::System(
+                EIO, "Failed to browse directory: Unknown error" );
+    }
+    else
+        read_local_directory( m_fs.libvlc(), media.get(), m_mrl, &children, &stats );
+
+    auto fileStats = [&stats]( const char *mrl ) {
+        auto it = stats.find( mrl );
+        return it != stats.end() ? it->second : std::make_pair( int64_t{ 0 }, time_t{ 0 } );
+    };
 
     for ( const InputItemPtr& m : children )
     {
@@ -217,7 +334,8 @@ SDDirectory::read() const
         }
         else if ( type == ITEM_TYPE_FILE )
         {
-            addFile( mrl, IFile::LinkedFileType::None, {} );
+            auto st = fileStats( mrl );
+            addFile( mrl, IFile::LinkedFileType::None, {}, st.first, st.second );
             for ( auto i = 0; i < m->i_slaves; ++i )
             {
                 const auto* slave = m->pp_slaves[i];
@@ -225,35 +343,24 @@ SDDirectory::read() const
                                              ? IFile::LinkedFileType::SoundTrack
                                              : IFile::LinkedFileType::Subtitles;
 
-                addFile( slave->psz_uri, linked_type, mrl );
+                auto slaveSt = fileStats( slave->psz_uri );
+                addFile( slave->psz_uri, linked_type, mrl, slaveSt.first, slaveSt.second );
             }
         }
     }
 
     m_read_done = true;
+
+    /* The media library browses the subdirectories one after the other, read
+     * them in parallel meanwhile */
+    if ( prefetchChildren && !m_fs.isNetworkFileSystem() )
+        m_fs.prefetch( m_dirs );
 }
 
 void
-SDDirectory::addFile(std::string mrl, IFile::LinkedFileType fType, std::string linkedFile) const
+SDDirectory::addFile(std::string mrl, IFile::LinkedFileType fType, std::string linkedFile,
+                     int64_t fileSize, time_t lastModificationDate) const
 {
-    time_t lastModificationDate = 0;
-    int64_t fileSize = 0;
-
-    if ( m_fs.isNetworkFileSystem() == false )
-    {
-        const auto path = vlc::wrap_cptr( vlc_uri2path( mrl.c_str() ) );
-        struct stat stat;
-
-        if ( vlc_stat( path.get(), &stat ) != 0 )
-        {
-            if ( errno == EACCES )
-                return;
-            throw errors::System{ errno, "Failed to get file info" };
-        }
-        lastModificationDate = stat.st_mtime;
-        fileSize = stat.st_size;
-    }
-
     if ( fType == IFile::LinkedFileType::None )
     {
         m_files.push_back(
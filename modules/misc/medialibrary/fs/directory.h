@@ -42,13 +42,19 @@ public:
     std::shared_ptr<fs::IFile> file( const std::string& mrl ) const override;
     bool contains( const std::string& file ) const override;
 
+    /* Read the directory in advance, from a prefetch thread */
+    void prefetch() const;
+
 private:
-    void read() const;
-    void addFile( std::string mrl, fs::IFile::LinkedFileType, std::string linkedWith ) const;
+    void read( bool prefetchChildren ) const;
+    void addFile( std::string mrl, fs::IFile::LinkedFileType, std::string linkedWith,
+                  int64_t size, time_t lastModificationDate ) const;
 
     std::string m_mrl;
     SDFileSystemFactory &m_fs;
 
+    /* the directory may be read by a prefetch thread */
+    mutable vlc::threads::mutex m_mutex;
     mutable bool m_read_done = false;
     mutable std::vector<std::shared_ptr<fs::IFile>> m_files;
     mutable std::vector<std::shared_ptr<fs::IDirectory>> m_dirs;
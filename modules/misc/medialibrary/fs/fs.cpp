@@ -46,6 +46,20 @@ SDFileSystemFactory::SDFileSystemFactory(vlc_object_t *parent,
 {
     m_isNetwork = strncasecmp( m_scheme.c_str(), "file://",
                                m_scheme.length() ) != 0;
+
+    /* Directory reads mostly wait for the disk (or the NAS), use more
+     * threads than CPUs */
+    m_executor = m_isNetwork ? nullptr
+               : vlc_executor_New( std::max( 4u, 2 * vlc_GetCPUCount() ) );
+}
+
+SDFileSystemFactory::~SDFileSystemFactory()
+{
+    if ( m_executor != nullptr )
+    {
+        cancelPrefetch();
+        vlc_executor_Delete( m_executor );
+    }
 }
 
 bool SDFileSystemFactory::initialize(const IMediaLibrary* ml)
@@ -125,6 +139,7 @@ SDFileSystemFactory::stop()
     assert( isStarted() == true );
     m_deviceLister->stop();
     m_callbacks = nullptr;
+    cancelPrefetch();
 }
 
 libvlc_int_t *
@@ -188,6 +203,74 @@ bool SDFileSystemFactory::waitForDevice(const std::string& mrl,
     return true;
 }
 
+  } /* namespace medialibrary */
+} /* namespace vlc */
+
+extern "C" {
+
+static void runPrefetch( void *data )
+{
+    auto task = static_cast<vlc::medialibrary::SDFileSystemFactory::PrefetchTask*>( data );
+    task->dir->prefetch();
+    task->fs->onPrefetchDone( task );
+}
+
+} /* extern C */
+
+namespace vlc {
+  namespace medialibrary {
+
+void SDFileSystemFactory::prefetch(const std::vector<std::shared_ptr<IDirectory>>& dirs)
+{
+    if ( m_executor == nullptr )
+        return;
+
+    vlc::threads::mutex_locker lock( m_prefetchMutex );
+    for ( const auto& d : dirs )
+    {
+        auto task = new (std::nothrow) PrefetchTask;
+        if ( task == nullptr )
+            return;
+        task->runnable.run = runPrefetch;
+        task->runnable.userdata = task;
+        task->runnable.priority = VLC_RUNNABLE_PRIORITY_NORMAL;
+        task->fs = this;
+        task->dir = std::static_pointer_cast<SDDirectory>( d );
+        task->it = m_prefetchTasks.insert( m_prefetchTasks.end(), task );
+        vlc_executor_Submit( m_executor, &task->runnable );
+    }
+}
+
+void SDFileSystemFactory::onPrefetchDone(PrefetchTask *task)
+{
+    vlc::threads::mutex_locker lock( m_prefetchMutex );
+    m_prefetchTasks.erase( task->it );
+    delete task;
+}
+
+void SDFileSystemFactory::cancelPrefetch()
+{
+    if ( m_executor == nullptr )
+        return;
+
+    {
+        vlc::threads::mutex_locker lock( m_prefetchMutex );
+        for ( auto it = m_prefetchTasks.begin(); it != m_prefetchTasks.end(); )
+        {
+            PrefetchTask *task = *it;
+            if ( vlc_executor_Cancel( m_executor, &task->runnable ) )
+            {
+                it = m_prefetchTasks.erase( it );
+                delete task;
+            }
+            else
+                ++it;
+        }
+    }
+    /* wait for the directories being read */
+    vlc_executor_WaitIdle( m_executor );
+}
+
 std::shared_ptr<IDevice> SDFileSystemFactory::deviceByUuid(const std::string& uuid)
 {
     auto it = std::find_if( begin( m_devices ), end( m_devices ),
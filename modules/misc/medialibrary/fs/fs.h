@@ -21,9 +21,11 @@
 #ifndef SD_FS_H
 #define SD_FS_H
 
+#include <list>
 #include <memory>
 #include <vector>
 #include <vlc_common.h>
+#include <vlc_executor.h>
 #include <vlc_threads.h>
 #include <vlc_cxx_helpers.hpp>
 #include <medialibrary/filesystem/IFileSystemFactory.h>
@@ -42,10 +44,13 @@ namespace vlc {
 using namespace ::medialibrary;
 using namespace ::medialibrary::fs;
 
+class SDDirectory;
+
 class SDFileSystemFactory : public IFileSystemFactory, private IDeviceListerCb {
 public:
     SDFileSystemFactory(vlc_object_t *m_parent,
                         const std::string &scheme);
+    ~SDFileSystemFactory();
 
     bool
     initialize( const IMediaLibrary* ml ) override;
@@ -92,7 +97,24 @@ public:
     bool
     waitForDevice(const std::string& mrl, uint32_t timeout) const override;
 
+    /* Read the directories in the background */
+    void
+    prefetch(const std::vector<std::shared_ptr<IDirectory>>& dirs);
+
+    struct PrefetchTask
+    {
+        vlc_runnable runnable;
+        SDFileSystemFactory *fs;
+        std::shared_ptr<SDDirectory> dir;
+        std::list<PrefetchTask *>::iterator it;
+    };
+
+    void
+    onPrefetchDone(PrefetchTask *task);
+
 private:
+    void cancelPrefetch();
+
     std::shared_ptr<fs::IDevice>
     deviceByUuid(const std::string& uuid);
 
@@ -110,6 +132,12 @@ private:
     mutable vlc::threads::mutex m_mutex;
     mutable vlc::threads::condition_variable m_cond;
     std::vector<std::shared_ptr<IDevice>> m_devices;
+
+    /* Only local directories are prefetched, the network ones are read by
+     * the preparser */
+    vlc_executor_t *m_executor;
+    vlc::threads::mutex m_prefetchMutex;
+    std::list<PrefetchTask *> m_prefetchTasks;
 };
 
   } /* namespace medialibrary */
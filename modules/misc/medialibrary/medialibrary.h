@@ -144,6 +144,9 @@ private:
     vlc::threads::condition_variable m_cond;
     ThumbnailerCtx* m_currentContext;
     std::unique_ptr<vlc_thumbnailer_t, void(*)(vlc_thumbnailer_t*)> m_thumbnailer;
+    /* kept between thumbnails, so that the scaler and the encoder are not
+     * loaded again for every media */
+    std::unique_ptr<image_handler_t, void(*)(image_handler_t*)> m_imageHandler;
 };
 
 class MediaLibrary : public medialibrary::IMediaLibraryCb
@@ -35,6 +35,11 @@
 
 static inline block_t *AV1_Pack_Sample(block_t *p_block)
 {
+    /* OBUs are moved in place */
+    p_block = block_MakeWritable(p_block);
+    if(!p_block)
+        return NULL;
+
     AV1_OBU_iterator_ctx_t ctx;
     AV1_OBU_iterator_init(&ctx, p_block->p_buffer, p_block->i_buffer);
     const uint8_t *p_obu = NULL; size_t i_obu;
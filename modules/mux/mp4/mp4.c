@@ -54,6 +54,21 @@
     "\"Fast Start\" files are optimized for downloads and allow the user " \
     "to start previewing the file while it is downloading.")
 
+#define FRAGDURATION_TEXT N_("Fragment duration (ms)")
+#define FRAGDURATION_LONGTEXT N_(\
+    "Target duration of the fragments of fragmented and streamable MP4. " \
+    "Fragments are cut on keyframes when possible.")
+#define FRAGBUFFER_TEXT N_("Fragment buffer size (kB)")
+#define FRAGBUFFER_LONGTEXT N_(\
+    "Maximum amount of media data held while building a fragment. " \
+    "A fragment is written early when it is reached, so that memory " \
+    "use stays bounded even if a track stops sending data.")
+#define FRAGINDEX_TEXT N_("Write fragments index")
+#define FRAGINDEX_LONGTEXT N_(\
+    "Append a movie fragment random access (mfra) index at the end of " \
+    "fragmented MP4 files, for seeking. Its size is bounded, sparser " \
+    "entries being used for long recordings.")
+
 static int  Open   (vlc_object_t *);
 static void Close  (vlc_object_t *);
 static void CloseFrag  (vlc_object_t *);
@@ -67,6 +82,12 @@ vlc_module_begin ()
 
     add_bool(SOUT_CFG_PREFIX "faststart", false,
               FASTSTART_TEXT, FASTSTART_LONGTEXT)
+    add_integer_with_range(SOUT_CFG_PREFIX "fragment-duration", 1500, 100, 60000,
+                           FRAGDURATION_TEXT, FRAGDURATION_LONGTEXT)
+    add_integer_with_range(SOUT_CFG_PREFIX "fragment-buffer", 32768, 256, 1048576,
+                           FRAGBUFFER_TEXT, FRAGBUFFER_LONGTEXT)
+    add_bool(SOUT_CFG_PREFIX "fragment-index", true,
+             FRAGINDEX_TEXT, FRAGINDEX_LONGTEXT)
     set_capability("sout mux", 5)
     add_shortcut("mp4", "mov", "3gp")
     set_callbacks(Open, Close)
@@ -85,7 +106,7 @@ vlc_module_end ()
  * Exported prototypes
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
-    "faststart", NULL
+    "faststart", "fragment-duration", "fragment-buffer", "fragment-index", NULL
 };
 
 static int Control(sout_mux_t *, int, va_list);
@@ -107,6 +128,11 @@ struct mp4_fragentry_t
     mp4_fragentry_t *p_next;
 };
 
+/* mfra index entries are at least that far apart, and that spacing doubles
+ * each time the index is full, so that it covers endless recordings */
+#define FRAGINDEX_INTERVAL VLC_TICK_FROM_SEC(2)
+#define FRAGINDEX_MAX      4096
+
 typedef struct mp4_fragindex_t
 {
     uint64_t i_moofoffset;
@@ -148,6 +174,7 @@ typedef struct
     mp4_fragindex_t *p_indexentries;
     uint32_t         i_indexentriesmax;
     uint32_t         i_indexentries;
+    vlc_tick_t       i_indexinterval;
 } mp4_stream_t;
 
 typedef struct
@@ -171,6 +198,10 @@ typedef struct
     /* mp4frag */
     vlc_tick_t     i_written_duration;
     uint32_t       i_mfhd_sequence;
+    vlc_tick_t     i_fragment_length;
+    size_t         i_buffered;
+    size_t         i_max_buffered;
+    bool           b_index;
 } sout_mux_sys_t;
 
 static void mp4_stream_Delete(mp4_stream_t *p_stream)
@@ -211,6 +242,7 @@ static mp4_stream_t *mp4_stream_New(void)
         p_stream->i_first_dts = VLC_TICK_INVALID;
         p_stream->i_last_dts = VLC_TICK_INVALID;
         p_stream->i_last_pts = VLC_TICK_INVALID;
+        p_stream->i_indexinterval = FRAGINDEX_INTERVAL;
     }
     return p_stream;
 }
@@ -290,6 +322,16 @@ static int Open(vlc_object_t *p_this)
     p_sys->i_start_dts = VLC_TICK_INVALID;
     p_sys->i_mfhd_sequence = 1;
 
+    /* mp4frag */
+    p_sys->i_fragment_length = VLC_TICK_FROM_MS(
+            var_GetInteger(p_mux, SOUT_CFG_PREFIX "fragment-duration"));
+    p_sys->i_buffered = 0;
+    p_sys->i_max_buffered =
+            var_GetInteger(p_mux, SOUT_CFG_PREFIX "fragment-buffer") * 1024;
+    /* the index refers to absolute moof positions, so only files get one */
+    p_sys->b_index = p_mux->psz_mux && !strcmp(p_mux->psz_mux, "mp4frag") &&
+            var_GetBool(p_mux, SOUT_CFG_PREFIX "fragment-index");
+
     p_mux->p_sys        = p_sys;
     p_mux->pf_control   = Control;
     p_mux->pf_addstream = AddStream;
@@ -898,8 +940,6 @@ static void box_send(sout_mux_t *p_mux,  bo_t *box)
 /***************************************************************************
     MP4 Live submodule
 ****************************************************************************/
-#define FRAGMENT_LENGTH  VLC_TICK_FROM_MS(1500)
-
 #define ENQUEUE_ENTRY(object, entry) \
     do {\
         if (object.p_last)\
@@ -923,33 +963,37 @@ static void AddKeyframeEntry(mp4_stream_t *p_stream, const uint64_t i_moof_pos,
                              const uint8_t i_traf, const uint32_t i_sample,
                              const vlc_tick_t i_time)
 {
-    /* alloc or realloc */
-    mp4_fragindex_t *p_entries = p_stream->p_indexentries;
-    if (p_stream->i_indexentries >= p_stream->i_indexentriesmax)
+    if (p_stream->i_indexentries &&
+        i_time - p_stream->p_indexentries[p_stream->i_indexentries - 1].i_time
+            < p_stream->i_indexinterval)
+        return;
+
+    if (p_stream->i_indexentries == FRAGINDEX_MAX)
     {
-        p_stream->i_indexentriesmax += 256;
-        p_entries = xrealloc(p_stream->p_indexentries,
-                             p_stream->i_indexentriesmax * sizeof(mp4_fragindex_t));
-        if (p_entries) /* realloc can fail */
-            p_stream->p_indexentries = p_entries;
+        /* drop every other entry instead of growing */
+        for (uint32_t i = 1; i < FRAGINDEX_MAX / 2; i++)
+            p_stream->p_indexentries[i] = p_stream->p_indexentries[2 * i];
+        p_stream->i_indexentries = FRAGINDEX_MAX / 2;
+        p_stream->i_indexinterval *= 2;
     }
-
-    vlc_tick_t i_last_entry_time;
-    if (p_stream->i_indexentries)
-        i_last_entry_time = p_stream->p_indexentries[p_stream->i_indexentries - 1].i_time;
-    else
-        i_last_entry_time = 0;
-
-    if (p_entries && i_time - i_last_entry_time >= VLC_TICK_FROM_SEC(2))
+    else if (p_stream->i_indexentries >= p_stream->i_indexentriesmax)
     {
-        mp4_fragindex_t *p_indexentry = &p_stream->p_indexentries[p_stream->i_indexentries];
-        p_indexentry->i_time = i_time;
-        p_indexentry->i_moofoffset = i_moof_pos;
-        p_indexentry->i_sample = i_sample;
-        p_indexentry->i_traf = i_traf;
-        p_indexentry->i_trun = 1;
-        p_stream->i_indexentries++;
+        mp4_fragindex_t *p_entries =
+            realloc(p_stream->p_indexentries,
+                    (p_stream->i_indexentriesmax + 256) * sizeof(mp4_fragindex_t));
+        if (unlikely(!p_entries))
+            return;
+        p_stream->p_indexentries = p_entries;
+        p_stream->i_indexentriesmax += 256;
     }
+
+    mp4_fragindex_t *p_indexentry = &p_stream->p_indexentries[p_stream->i_indexentries];
+    p_indexentry->i_time = i_time;
+    p_indexentry->i_moofoffset = i_moof_pos;
+    p_indexentry->i_sample = i_sample;
+    p_indexentry->i_traf = i_traf;
+    p_indexentry->i_trun = 1;
+    p_stream->i_indexentries++;
 }
 
 /* Creates moof box and traf/trun information.
@@ -1144,11 +1188,12 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
                 i_sample++;
 
                 /* Add keyframe entry if needed */
-                if (p_stream->b_hasiframes && (p_entry->p_block->i_flags & BLOCK_FLAG_TYPE_I) &&
+                if (p_sys->b_index && p_stream->b_hasiframes &&
+                    (p_entry->p_block->i_flags & BLOCK_FLAG_TYPE_I) &&
                     (mp4mux_track_GetFmt(p_stream->tinfo)->i_cat == VIDEO_ES ||
                      mp4mux_track_GetFmt(p_stream->tinfo)->i_cat == AUDIO_ES))
                 {
-                    AddKeyframeEntry(p_stream, i_write_pos, i_trak, i_sample, i_time);
+                    AddKeyframeEntry(p_stream, i_write_pos, i_trak + 1, i_sample, i_time);
                 }
 
                 i_time += p_entry->p_block->i_length;
@@ -1205,6 +1250,7 @@ static void WriteFragmentMDAT(sout_mux_t *p_mux, size_t i_total_size)
         {
             mp4_fragentry_t *p_entry = p_stream->towrite.p_first;
             p_sys->i_pos += p_entry->p_block->i_buffer;
+            p_sys->i_buffered -= p_entry->p_block->i_buffer;
             p_stream->i_written_duration += p_entry->p_block->i_length;
 
             p_entry->p_block->i_flags &= ~BLOCK_FLAG_TYPE_I; // clear flag for http stream
@@ -1227,7 +1273,8 @@ static bo_t *GetMfraBox(sout_mux_t *p_mux)
         mp4_stream_t *p_stream = p_sys->pp_streams[i];
         if (p_stream->i_indexentries)
         {
-            bo_t *tfra = box_full_new("tfra", 0, 0x0);
+            /* 64 bits time and moof offset */
+            bo_t *tfra = box_full_new("tfra", 1, 0x0);
             if (!tfra) continue;
             bo_add_32be(tfra, mp4mux_track_GetID(p_stream->tinfo));
             bo_add_32be(tfra, 0x3); // reserved + lengths (1,1,4)=>(0,0,3)
@@ -1235,8 +1282,9 @@ static bo_t *GetMfraBox(sout_mux_t *p_mux)
             for(uint32_t i_index=0; i_index<p_stream->i_indexentries; i_index++)
             {
                 const mp4_fragindex_t *p_indexentry = &p_stream->p_indexentries[i_index];
-                bo_add_32be(tfra, p_indexentry->i_time);
-                bo_add_32be(tfra, p_indexentry->i_moofoffset);
+                bo_add_64be(tfra, samples_from_vlc_tick(p_indexentry->i_time,
+                                                        mp4mux_track_GetTimescale(p_stream->tinfo)));
+                bo_add_64be(tfra, p_indexentry->i_moofoffset);
                 assert(sizeof(p_indexentry->i_traf)==1); /* guard against sys changes */
                 assert(sizeof(p_indexentry->i_trun)==1);
                 assert(sizeof(p_indexentry->i_sample)==4);
@@ -1285,7 +1333,7 @@ static void WriteFragments(sout_mux_t *p_mux, bool b_flush)
 {
     sout_mux_sys_t *p_sys = (sout_mux_sys_t*) p_mux->p_sys;
     bo_t *moof = NULL;
-    vlc_tick_t i_barrier_time = p_sys->i_written_duration + FRAGMENT_LENGTH;
+    vlc_tick_t i_barrier_time = p_sys->i_written_duration + p_sys->i_fragment_length;
     size_t i_mdat_size = 0;
     bool b_has_samples = false;
 
@@ -1403,7 +1451,7 @@ static void CloseFrag(vlc_object_t *p_this)
 
     /* Write indexes, but only for non streamed content
        as they refer to moof by absolute position */
-    if (!strcmp(p_mux->psz_mux, "mp4frag"))
+    if (p_sys->b_index)
     {
         bo_t *mfra = GetMfraBox(p_mux);
         if (mfra)
@@ -1473,7 +1521,7 @@ static int MuxFrag(sout_mux_t *p_mux)
         p_stream->p_held_entry = NULL;
 
         if (p_stream->b_hasiframes && (p_heldblock->i_flags & BLOCK_FLAG_TYPE_I) &&
-            mp4mux_track_GetDuration(p_stream->tinfo) - p_sys->i_written_duration < FRAGMENT_LENGTH)
+            mp4mux_track_GetDuration(p_stream->tinfo) - p_sys->i_written_duration < p_sys->i_fragment_length)
         {
             /* Flag the last iframe time, we'll use it as boundary so it will start
                next fragment */
@@ -1495,6 +1543,7 @@ static int MuxFrag(sout_mux_t *p_mux)
     p_stream->p_held_entry->p_block  = p_currentblock;
     p_stream->p_held_entry->i_run    = p_stream->i_current_run;
     p_stream->p_held_entry->p_next   = NULL;
+    p_sys->i_buffered += p_currentblock->i_buffer;
 
     if (mp4mux_track_GetFmt(p_stream->tinfo)->i_cat == VIDEO_ES )
     {
@@ -1513,8 +1562,8 @@ static int MuxFrag(sout_mux_t *p_mux)
     for (unsigned int i=0; i<p_sys->i_nb_streams; i++)
     {
         const mp4_stream_t *p_s = p_sys->pp_streams[i];
-        if (mp4mux_track_GetFmt(p_stream->tinfo)->i_cat != VIDEO_ES &&
-            mp4mux_track_GetFmt(p_stream->tinfo)->i_cat != AUDIO_ES)
+        if (mp4mux_track_GetFmt(p_s->tinfo)->i_cat != VIDEO_ES &&
+            mp4mux_track_GetFmt(p_s->tinfo)->i_cat != AUDIO_ES)
             continue;
         if (mp4mux_track_GetDuration(p_s->tinfo) < i_min_read_duration)
             i_min_read_duration = mp4mux_track_GetDuration(p_s->tinfo);
@@ -1526,8 +1575,14 @@ static int MuxFrag(sout_mux_t *p_mux)
     p_sys->i_written_duration = i_min_written_duration;
 
     /* we have prerolled enough to know all streams, and have enough date to create a fragment */
-    if (p_stream->read.p_first && p_sys->i_read_duration - p_sys->i_written_duration >= FRAGMENT_LENGTH)
+    if (p_stream->read.p_first && p_sys->i_read_duration - p_sys->i_written_duration >= p_sys->i_fragment_length)
         WriteFragments(p_mux, false);
+    else if (p_sys->i_buffered > p_sys->i_max_buffered)
+    {
+        /* a track is late or stalled: do not wait for it */
+        msg_Dbg(p_mux, "fragment buffer full, flushing");
+        WriteFragments(p_mux, true);
+    }
 
     return VLC_SUCCESS;
 }
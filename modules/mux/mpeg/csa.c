@@ -27,10 +27,22 @@
 #endif
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <vlc_common.h>
+#include <vlc_threads.h>
 
 #include "csa.h"
 
+/* stream cypher state */
+typedef struct
+{
+    int     A[11];
+    int     B[11];
+    int     X, Y, Z;
+    int     D, E, F;
+    int     p, q, r;
+} csa_stream_t;
+
 struct csa_t
 {
     /* odd and even keys */
@@ -40,19 +52,28 @@ struct csa_t
     uint8_t o_kk[57];
     uint8_t e_kk[57];
 
-    /* cypher state */
-    int     A[11];
-    int     B[11];
-    int     X, Y, Z;
-    int     D, E, F;
-    int     p, q, r;
-
     bool    use_odd;
+
+    /* worker threads and the batch they share */
+    vlc_thread_t *threads;
+    unsigned     i_threads;
+    vlc_mutex_t  lock;
+    vlc_cond_t   wait;
+    vlc_cond_t   done;
+    unsigned     i_generation;
+    unsigned     i_busy;
+    bool         b_quit;
+
+    uint8_t *const *pp_pkts;
+    unsigned     i_pkts;
+    int          i_pkt_size;
+    bool         b_encrypt;
+    atomic_uint  i_next_group;
 };
 
 static void csa_ComputeKey( uint8_t kk[57], uint8_t ck[8] );
 
-static void csa_StreamCypher( csa_t *c, int b_init, uint8_t *ck, uint8_t *sb, uint8_t *cb );
+static void csa_StreamCypher( csa_stream_t *c, int b_init, uint8_t *ck, uint8_t *sb, uint8_t *cb );
 
 static void csa_BlockDecypher( uint8_t kk[57], uint8_t ib[8], uint8_t bd[8] );
 static void csa_BlockCypher( uint8_t kk[57], uint8_t bd[8], uint8_t ib[8] );
@@ -62,7 +83,15 @@ static void csa_BlockCypher( uint8_t kk[57], uint8_t bd[8], uint8_t ib[8] );
  *****************************************************************************/
 csa_t *csa_New( void )
 {
-    return calloc( 1, sizeof( csa_t ) );
+    csa_t *c = calloc( 1, sizeof( csa_t ) );
+    if( c )
+    {
+        vlc_mutex_init( &c->lock );
+        vlc_cond_init( &c->wait );
+        vlc_cond_init( &c->done );
+        atomic_init( &c->i_next_group, 0 );
+    }
+    return c;
 }
 
 /*****************************************************************************
@@ -70,6 +99,14 @@ csa_t *csa_New( void )
  *****************************************************************************/
 void csa_Delete( csa_t *c )
 {
+    vlc_mutex_lock( &c->lock );
+    c->b_quit = true;
+    vlc_cond_broadcast( &c->wait );
+    vlc_mutex_unlock( &c->lock );
+
+    for( unsigned i = 0; i < c->i_threads; i++ )
+        vlc_join( c->threads[i], NULL );
+    free( c->threads );
     free( c );
 }
 
@@ -137,6 +174,7 @@ void csa_UseKey( vlc_object_t *p_caller, csa_t *c, bool use_odd )
  *****************************************************************************/
 void csa_Decrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
 {
+    csa_stream_t s;
     uint8_t *ck;
     uint8_t *kk;
 
@@ -176,7 +214,7 @@ void csa_Decrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
         return;
 
     /* init csa state */
-    csa_StreamCypher( c, 1, ck, &pkt[i_hdr], ib );
+    csa_StreamCypher( &s, 1, ck, &pkt[i_hdr], ib );
 
     /* */
     n = (i_pkt_size - i_hdr) / 8;
@@ -189,7 +227,7 @@ void csa_Decrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
         csa_BlockDecypher( kk, ib, block );
         if( i != n )
         {
-            csa_StreamCypher( c, 0, ck, NULL, stream );
+            csa_StreamCypher( &s, 0, ck, NULL, stream );
             for( j = 0; j < 8; j++ )
             {
                 /* xor ib with stream */
@@ -213,7 +251,7 @@ void csa_Decrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
 
     if( i_residue > 0 )
     {
-        csa_StreamCypher( c, 0, ck, NULL, stream );
+        csa_StreamCypher( &s, 0, ck, NULL, stream );
         for( j = 0; j < i_residue; j++ )
         {
             pkt[i_pkt_size - i_residue + j] ^= stream[j];
@@ -226,6 +264,7 @@ void csa_Decrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
  *****************************************************************************/
 void csa_Encrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
 {
+    csa_stream_t s;
     uint8_t *ck;
     uint8_t *kk;
 
@@ -280,7 +319,7 @@ void csa_Encrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
     }
 
     /* init csa state */
-    csa_StreamCypher( c, 1, ck, ib[1], stream );
+    csa_StreamCypher( &s, 1, ck, ib[1], stream );
 
     for( i = 0; i < 8; i++ )
     {
@@ -288,7 +327,7 @@ void csa_Encrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
     }
     for( i = 2; i < n+1; i++ )
     {
-        csa_StreamCypher( c, 0, ck, NULL, stream );
+        csa_StreamCypher( &s, 0, ck, NULL, stream );
         for( j = 0; j < 8; j++ )
         {
             pkt[i_hdr+8*(i-1)+j] = ib[i][j] ^ stream[j];
@@ -296,7 +335,7 @@ void csa_Encrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
     }
     if( i_residue > 0 )
     {
-        csa_StreamCypher( c, 0, ck, NULL, stream );
+        csa_StreamCypher( &s, 0, ck, NULL, stream );
         for( j = 0; j < i_residue; j++ )
         {
             pkt[i_pkt_size - i_residue + j] ^= stream[j];
@@ -371,7 +410,7 @@ static const int sbox5[0x20] = {2,0,0,1,3,2,3,2, 0,1,3,3,1,0,2,1, 2,3,2,0,0,3,1,
 static const int sbox6[0x20] = {0,1,2,3,1,2,2,0, 0,1,3,0,2,3,1,3, 2,3,0,2,3,0,1,1, 2,1,1,2,0,3,3,0};
 static const int sbox7[0x20] = {0,3,2,2,3,0,0,1, 3,0,1,3,1,2,2,1, 1,0,3,3,0,1,1,2, 2,3,1,0,2,3,0,2};
 
-static void csa_StreamCypher( csa_t *c, int b_init, uint8_t *ck, uint8_t *sb, uint8_t *cb )
+static void csa_StreamCypher( csa_stream_t *c, int b_init, uint8_t *ck, uint8_t *sb, uint8_t *cb )
 {
     int i,j, k;
     int extra_B;
@@ -607,3 +646,623 @@ static void csa_BlockCypher( uint8_t kk[57], uint8_t bd[8], uint8_t ib[8] )
     }
 }
 
+
+/*****************************************************************************
+ * Batches
+ *****************************************************************************
+ * The stream cypher takes most of the time, and only works on a few bits at
+ * a time: for batches, it is bitsliced, each bit of a word holding the state
+ * of one packet, so that up to 64 packets are processed at once. The block
+ * cypher is byte oriented, and runs the packets interleaved instead.
+ *****************************************************************************/
+typedef uint64_t csa_word_t;
+
+#define CSA_LANES 64
+/* Below that, the packets are cheaper to process one by one */
+#define CSA_LANES_MIN 8
+
+
+static inline csa_word_t csa_bs_Mux( csa_word_t a, csa_word_t b, csa_word_t sel )
+{
+    return a ^ ( ( a ^ b ) & sel );
+}
+
+static inline csa_word_t csa_bs_Bit( uint32_t tt, int i )
+{
+    return ( ( tt >> i ) & 1 ) ? ~(csa_word_t)0 : 0;
+}
+
+/* Evaluates a 5 inputs boolean function on all the lanes, as a tree of
+ * multiplexers. The truth table is a constant, so that the tree folds at
+ * compile time. */
+#define CSA_BS_L1(tt, i, x0) \
+    csa_bs_Mux( csa_bs_Bit( tt, 2*(i) ), csa_bs_Bit( tt, 2*(i)+1 ), x0 )
+#define CSA_BS_L2(tt, i, x1, x0) \
+    csa_bs_Mux( CSA_BS_L1( tt, 2*(i), x0 ), CSA_BS_L1( tt, 2*(i)+1, x0 ), x1 )
+#define CSA_BS_L3(tt, i, x2, x1, x0) \
+    csa_bs_Mux( CSA_BS_L2( tt, 2*(i), x1, x0 ), CSA_BS_L2( tt, 2*(i)+1, x1, x0 ), x2 )
+#define CSA_BS_L4(tt, i, x3, x2, x1, x0) \
+    csa_bs_Mux( CSA_BS_L3( tt, 2*(i), x2, x1, x0 ), CSA_BS_L3( tt, 2*(i)+1, x2, x1, x0 ), x3 )
+#define CSA_BS_LUT(tt, x4, x3, x2, x1, x0) \
+    csa_bs_Mux( CSA_BS_L4( tt, 0, x3, x2, x1, x0 ), CSA_BS_L4( tt, 1, x3, x2, x1, x0 ), x4 )
+
+/* Transposes a 64x64 bits matrix, turning eight bytes of each packet into
+ * the lanes of 64 words, and back */
+static void csa_bs_Transpose( csa_word_t m[64] )
+{
+    csa_word_t mask = 0x00000000FFFFFFFF;
+
+    for( unsigned j = 32; j != 0; j >>= 1, mask ^= mask << j )
+    {
+        for( unsigned k = 0; k < 64; k = ( ( k | j ) + 1 ) & ~j )
+        {
+            const csa_word_t t = ( ( m[k] >> j ) ^ m[k | j] ) & mask;
+
+            m[k] ^= t << j;
+            m[k | j] ^= t;
+        }
+    }
+}
+
+/* Bitsliced stream cypher state, with the same registers as csa_stream_t:
+ * [register][bit], A[0] and B[0] being A[1] and B[1] there */
+typedef struct
+{
+    csa_word_t A[10][4];
+    csa_word_t B[10][4];
+    csa_word_t X[4], Y[4], Z[4];
+    csa_word_t D[4], E[4], F[4];
+    csa_word_t p, q, r;
+} csa_bs_stream_t;
+
+#define BIT(reg, n, b) ((reg)[(n)-1][b])
+
+/* s-box with the truth tables of its output bits */
+#define CSA_BS_SBOX(s, tt1, tt0, ...) \
+    do { \
+        s[1] = CSA_BS_LUT( tt1, __VA_ARGS__ ); \
+        s[0] = CSA_BS_LUT( tt0, __VA_ARGS__ ); \
+    } while( 0 )
+
+static void csa_bs_Init( csa_bs_stream_t *s, const csa_t *c, csa_word_t odd )
+{
+    memset( s, 0, sizeof( *s ) );
+
+    /* load first 32 bits of CK into A[1]..A[8], last 32 bits into B[1]..B[8] */
+    for( int i = 0; i < 8; i++ )
+    {
+        const int shift = ( i & 1 ) ? 0 : 4;
+
+        for( int b = 0; b < 4; b++ )
+        {
+            if( ( c->o_ck[i/2] >> ( shift + b ) ) & 1 )
+                s->A[i][b] |= odd;
+            if( ( c->e_ck[i/2] >> ( shift + b ) ) & 1 )
+                s->A[i][b] |= ~odd;
+            if( ( c->o_ck[4+i/2] >> ( shift + b ) ) & 1 )
+                s->B[i][b] |= odd;
+            if( ( c->e_ck[4+i/2] >> ( shift + b ) ) & 1 )
+                s->B[i][b] |= ~odd;
+        }
+    }
+}
+
+/* Runs the stream cypher for 8 bytes, as csa_StreamCypher(). During
+ * initialisation, sb holds the transposed first block of the packets. */
+static void csa_bs_StreamCypher( csa_bs_stream_t *s, const csa_word_t *sb,
+                                 csa_word_t cb[64] )
+{
+    for( int i = 0; i < 8; i++ )
+    {
+        for( int j = 0; j < 4; j++ )
+        {
+            const csa_word_t (*A)[4] = s->A, (*B)[4] = s->B;
+            csa_word_t s1[2], s2[2], s3[2], s4[2], s5[2], s6[2], s7[2];
+
+            CSA_BS_SBOX( s1, 0x4B368771, 0x78C6B16C,
+                         BIT(A,4,0), BIT(A,1,2), BIT(A,6,1), BIT(A,7,3), BIT(A,9,0) );
+            CSA_BS_SBOX( s2, 0x58B98679, 0xE41B4B63,
+                         BIT(A,2,1), BIT(A,3,2), BIT(A,6,3), BIT(A,7,0), BIT(A,9,1) );
+            CSA_BS_SBOX( s3, 0x69D25879, 0xE41B1BE4,
+                         BIT(A,1,3), BIT(A,2,0), BIT(A,5,1), BIT(A,5,3), BIT(A,6,2) );
+            CSA_BS_SBOX( s4, 0x66B492AD, 0x92AD994B,
+                         BIT(A,3,3), BIT(A,1,1), BIT(A,2,3), BIT(A,4,2), BIT(A,8,0) );
+            CSA_BS_SBOX( s5, 0x9C274CF1, 0x35E29E58,
+                         BIT(A,5,2), BIT(A,4,3), BIT(A,6,0), BIT(A,8,1), BIT(A,9,2) );
+            CSA_BS_SBOX( s6, 0x691BB46C, 0x66D2E61A,
+                         BIT(A,3,1), BIT(A,4,1), BIT(A,5,0), BIT(A,7,2), BIT(A,9,3) );
+            CSA_BS_SBOX( s7, 0xB38C691E, 0x266D9D92,
+                         BIT(A,2,2), BIT(A,3,0), BIT(A,7,1), BIT(A,8,2), BIT(A,8,3) );
+
+            /* use 4x4 xor to produce extra nibble for T3 */
+            const csa_word_t extra_B[4] =
+            {
+                BIT(B,9,2) ^ BIT(B,6,3) ^ BIT(B,3,1) ^ BIT(B,8,0),
+                BIT(B,5,3) ^ BIT(B,8,2) ^ BIT(B,4,0) ^ BIT(B,5,1),
+                BIT(B,6,0) ^ BIT(B,8,1) ^ BIT(B,3,3) ^ BIT(B,4,2),
+                BIT(B,3,0) ^ BIT(B,6,1) ^ BIT(B,7,2) ^ BIT(B,9,3),
+            };
+
+            csa_word_t next_A1[4], next_B1[4], next_E[4];
+            csa_word_t carry = s->r;
+
+            for( int b = 0; b < 4; b++ )
+            {
+                /* T1 and T2, with the input bits during initialisation */
+                next_A1[b] = BIT(A,10,b) ^ s->X[b];
+                next_B1[b] = BIT(B,7,b) ^ BIT(B,10,b) ^ s->Y[b];
+                if( sb )
+                {
+                    const csa_word_t in1 = sb[8*i + 4 + b], in2 = sb[8*i + b];
+
+                    next_A1[b] ^= s->D[b] ^ ( ( j % 2 ) ? in2 : in1 );
+                    next_B1[b] ^= ( j % 2 ) ? in1 : in2;
+                }
+
+                /* T3 */
+                s->D[b] = s->E[b] ^ s->Z[b] ^ extra_B[b];
+
+                /* T4 = sum, carry of Z + E + r, if q */
+                const csa_word_t sum = s->Z[b] ^ s->E[b] ^ carry;
+                carry = ( s->Z[b] & s->E[b] ) | ( carry & ( s->Z[b] ^ s->E[b] ) );
+                next_E[b] = s->F[b];
+                s->F[b] = s->E[b] ^ ( ( s->E[b] ^ sum ) & s->q );
+            }
+            s->r ^= ( s->r ^ carry ) & s->q;
+            memcpy( s->E, next_E, sizeof( s->E ) );
+
+            /* if p=1, rotate left */
+            csa_word_t rot[4];
+            for( int b = 0; b < 4; b++ )
+                rot[b] = next_B1[b] ^ ( ( next_B1[b] ^ next_B1[(b + 3) % 4] ) & s->p );
+
+            memmove( &s->A[1], &s->A[0], sizeof( s->A[0] ) * 9 );
+            memmove( &s->B[1], &s->B[0], sizeof( s->B[0] ) * 9 );
+            memcpy( s->A[0], next_A1, sizeof( s->A[0] ) );
+            memcpy( s->B[0], rot, sizeof( s->B[0] ) );
+
+            s->X[3] = s4[0]; s->X[2] = s3[0]; s->X[1] = s2[1]; s->X[0] = s1[1];
+            s->Y[3] = s6[0]; s->Y[2] = s5[0]; s->Y[1] = s4[1]; s->Y[0] = s3[1];
+            s->Z[3] = s2[0]; s->Z[2] = s1[0]; s->Z[1] = s6[1]; s->Z[0] = s5[1];
+            s->p = s7[1];
+            s->q = s7[0];
+
+            /* 2 output bits are a function of the 4 bits of D */
+            cb[8*i + 7 - 2*j] = s->D[3] ^ s->D[2];
+            cb[8*i + 6 - 2*j] = s->D[1] ^ s->D[0];
+        }
+    }
+}
+
+#undef CSA_BS_SBOX
+#undef BIT
+#undef CSA_BS_LUT
+#undef CSA_BS_L4
+#undef CSA_BS_L3
+#undef CSA_BS_L2
+#undef CSA_BS_L1
+
+/* Block cypher and decypher of one block per packet, as csa_BlockCypher()
+ * and csa_BlockDecypher(). Each byte of the words holds a packet: R[k][g]
+ * holds R[k+1] of the packets 8*g to 8*g+7, and only the s-box and
+ * permutation lookups are done byte per byte. */
+#define CSA_WORDS (CSA_LANES / 8)
+
+static inline void csa_BlockSbox( csa_word_t x, csa_word_t *sbox_out,
+                                  csa_word_t *perm_out )
+{
+    csa_word_t v = 0;
+
+    for( int b = 0; b < 8; b++ )
+        v |= (csa_word_t)block_sbox[ (uint8_t)( x >> (8*b) ) ] << (8*b);
+    *sbox_out = v;
+
+    /* block_perm[] only moves bits around */
+    *perm_out = ( ( v & 0x2929292929292929 ) << 1 ) |
+                ( ( v & 0x0202020202020202 ) << 6 ) |
+                ( ( v & 0x0404040404040404 ) << 3 ) |
+                ( ( v & 0x1010101010101010 ) >> 2 ) |
+                ( ( v & 0x4040404040404040 ) >> 6 ) |
+                ( ( v & 0x8080808080808080 ) >> 4 );
+}
+
+static void csa_BlockCypherLanes( const csa_word_t kk[57][CSA_WORDS],
+                                  csa_word_t R[8][CSA_WORDS], unsigned i_words )
+{
+    for( int i = 1; i <= 56; i++ )
+    {
+        for( unsigned g = 0; g < i_words; g++ )
+        {
+            csa_word_t sbox_out, perm_out;
+            csa_BlockSbox( kk[i][g]^R[7][g], &sbox_out, &perm_out );
+
+            const csa_word_t R1 = R[0][g];
+            R[0][g] = R[1][g];
+            R[1][g] = R[2][g] ^ R1;
+            R[2][g] = R[3][g] ^ R1;
+            R[3][g] = R[4][g] ^ R1;
+            R[4][g] = R[5][g];
+            R[5][g] = R[6][g] ^ perm_out;
+            R[6][g] = R[7][g];
+            R[7][g] = R1 ^ sbox_out;
+        }
+    }
+}
+
+static void csa_BlockDecypherLanes( const csa_word_t kk[57][CSA_WORDS],
+                                    csa_word_t R[8][CSA_WORDS], unsigned i_words )
+{
+    for( int i = 56; i > 0; i-- )
+    {
+        for( unsigned g = 0; g < i_words; g++ )
+        {
+            csa_word_t sbox_out, perm_out;
+            csa_BlockSbox( kk[i][g]^R[6][g], &sbox_out, &perm_out );
+
+            const csa_word_t R8 = R[7][g] ^ sbox_out;
+            R[7][g] = R[6][g];
+            R[6][g] = R[5][g] ^ perm_out;
+            R[5][g] = R[4][g];
+            R[4][g] = R[3][g] ^ R8;
+            R[3][g] = R[2][g] ^ R8;
+            R[2][g] = R[1][g] ^ R8;
+            R[1][g] = R[0][g];
+            R[0][g] = R8;
+        }
+    }
+}
+
+/* A packet of a batch */
+typedef struct
+{
+    uint8_t *pkt;
+    int      i_hdr;
+    int      n; /* full blocks */
+    int      i_residue;
+    bool     odd;
+} csa_lane_t;
+
+/* Spreads the key schedules of the packets over the bytes of the words */
+static void csa_LanesKey( const csa_t *c, const csa_lane_t *lanes,
+                          unsigned i_lanes, csa_word_t kk[57][CSA_WORDS] )
+{
+    memset( kk, 0, sizeof( csa_word_t[57][CSA_WORDS] ) );
+    for( unsigned l = 0; l < i_lanes; l++ )
+    {
+        const uint8_t *lane_kk = lanes[l].odd ? c->o_kk : c->e_kk;
+
+        for( int i = 1; i <= 56; i++ )
+            kk[i][l/8] |= (csa_word_t)lane_kk[i] << (8*(l%8));
+    }
+}
+
+static inline void csa_LanesLoad( csa_word_t R[8][CSA_WORDS], unsigned l,
+                                  const uint8_t *p, const uint8_t *next )
+{
+    for( int k = 0; k < 8; k++ )
+    {
+        const uint8_t v = p[k] ^ ( next ? next[k] : 0 );
+
+        R[k][l/8] &= ~( (csa_word_t)0xff << (8*(l%8)) );
+        R[k][l/8] |= (csa_word_t)v << (8*(l%8));
+    }
+}
+
+static inline void csa_LanesStore( const csa_word_t R[8][CSA_WORDS], unsigned l,
+                                   uint8_t *p, const uint8_t *next )
+{
+    for( int k = 0; k < 8; k++ )
+        p[k] = ( R[k][l/8] >> (8*(l%8)) ) ^ ( next ? next[k] : 0 );
+}
+
+/* Applies the stream cypher keystream to the packets, after their first
+ * block */
+static void csa_bs_Keystream( const csa_t *c, const csa_lane_t *lanes,
+                              unsigned i_lanes, int i_pkt_size )
+{
+    csa_word_t m[64] = { 0 };
+    csa_word_t odd = 0;
+    int i_blocks = 0;
+
+    for( unsigned l = 0; l < i_lanes; l++ )
+    {
+        const csa_lane_t *lane = &lanes[l];
+        const int i_lane_blocks = __MAX( lane->n - 1, 0 ) + ( lane->i_residue > 0 );
+
+        m[l] = GetQWLE( &lane->pkt[lane->i_hdr] );
+        if( lane->odd )
+            odd |= (csa_word_t)1 << l;
+        i_blocks = __MAX( i_blocks, i_lane_blocks );
+    }
+    if( i_blocks == 0 )
+        return;
+
+    csa_bs_stream_t s;
+    csa_word_t cb[64];
+
+    csa_bs_Transpose( m );
+    csa_bs_Init( &s, c, odd );
+    csa_bs_StreamCypher( &s, m, cb );
+
+    for( int g = 1; g <= i_blocks; g++ )
+    {
+        csa_bs_StreamCypher( &s, NULL, cb );
+        csa_bs_Transpose( cb );
+
+        for( unsigned l = 0; l < i_lanes; l++ )
+        {
+            const csa_lane_t *lane = &lanes[l];
+            uint8_t *p;
+
+            if( g < lane->n )
+            {
+                p = &lane->pkt[lane->i_hdr + 8*g];
+                SetQWLE( p, GetQWLE( p ) ^ cb[l] );
+            }
+            else if( g == __MAX( lane->n, 1 ) && lane->i_residue > 0 )
+            {
+                p = &lane->pkt[i_pkt_size - lane->i_residue];
+                for( int j = 0; j < lane->i_residue; j++ )
+                    p[j] ^= cb[l] >> ( 8*j );
+            }
+        }
+    }
+}
+
+static void csa_EncryptGroup( csa_t *c, uint8_t *const *pkts, unsigned i_pkts,
+                              int i_pkt_size )
+{
+    csa_lane_t lanes[CSA_LANES];
+    csa_word_t kk[57][CSA_WORDS];
+    csa_word_t R[8][CSA_WORDS] = { { 0 } };
+    unsigned i_lanes = 0;
+    int i_blocks = 0;
+
+    assert( i_pkts <= CSA_LANES );
+    for( unsigned i = 0; i < i_pkts; i++ )
+    {
+        csa_lane_t *lane = &lanes[i_lanes];
+        uint8_t *pkt = pkts[i];
+
+        /* set transport scrambling control */
+        pkt[3] |= 0x80;
+        if( c->use_odd )
+            pkt[3] |= 0x40;
+
+        lane->i_hdr = 4;
+        if( pkt[3]&0x20 )
+            lane->i_hdr += pkt[4] + 1;
+        lane->n = (i_pkt_size - lane->i_hdr) / 8;
+        lane->i_residue = (i_pkt_size - lane->i_hdr) % 8;
+        if( lane->n <= 0 )
+        {
+            pkt[3] &= 0x3f;
+            continue;
+        }
+
+        lane->pkt = pkt;
+        lane->odd = c->use_odd;
+        i_lanes++;
+        i_blocks = __MAX( i_blocks, lane->n );
+    }
+
+    const unsigned i_words = ( i_lanes + 7 ) / 8;
+    csa_LanesKey( c, lanes, i_lanes, kk );
+
+    /* block cypher, from the last block of each packet, in place */
+    for( int t = 0; t < i_blocks; t++ )
+    {
+        for( unsigned l = 0; l < i_lanes; l++ )
+        {
+            const int j = lanes[l].n - t;
+            if( j < 1 )
+                continue;
+
+            const uint8_t *p = &lanes[l].pkt[lanes[l].i_hdr + 8*(j-1)];
+            csa_LanesLoad( R, l, p, t > 0 ? p + 8 : NULL );
+        }
+
+        csa_BlockCypherLanes( kk, R, i_words );
+
+        for( unsigned l = 0; l < i_lanes; l++ )
+        {
+            const int j = lanes[l].n - t;
+
+            if( j >= 1 )
+                csa_LanesStore( R, l, &lanes[l].pkt[lanes[l].i_hdr + 8*(j-1)],
+                                NULL );
+        }
+    }
+
+    csa_bs_Keystream( c, lanes, i_lanes, i_pkt_size );
+}
+
+static void csa_DecryptGroup( csa_t *c, uint8_t *const *pkts, unsigned i_pkts,
+                              int i_pkt_size )
+{
+    csa_lane_t lanes[CSA_LANES];
+    csa_word_t kk[57][CSA_WORDS];
+    csa_word_t R[8][CSA_WORDS] = { { 0 } };
+    unsigned i_lanes = 0;
+    int i_blocks = 0;
+
+    assert( i_pkts <= CSA_LANES );
+    for( unsigned i = 0; i < i_pkts; i++ )
+    {
+        csa_lane_t *lane = &lanes[i_lanes];
+        uint8_t *pkt = pkts[i];
+
+        /* transport scrambling control */
+        if( (pkt[3]&0x80) == 0 )
+            continue;
+        lane->odd = pkt[3]&0x40;
+
+        /* clear transport scrambling control */
+        pkt[3] &= 0x3f;
+
+        lane->i_hdr = 4;
+        if( pkt[3]&0x20 )
+            lane->i_hdr += pkt[4] + 1;
+        if( 188 - lane->i_hdr < 8 )
+            continue;
+
+        lane->n = (i_pkt_size - lane->i_hdr) / 8;
+        lane->i_residue = (i_pkt_size - lane->i_hdr) % 8;
+        if( lane->n < 0 )
+            continue;
+
+        lane->pkt = pkt;
+        i_lanes++;
+        i_blocks = __MAX( i_blocks, lane->n );
+    }
+
+    csa_bs_Keystream( c, lanes, i_lanes, i_pkt_size );
+
+    const unsigned i_words = ( i_lanes + 7 ) / 8;
+    csa_LanesKey( c, lanes, i_lanes, kk );
+
+    /* block decypher, from the first block of each packet, in place */
+    for( int j = 1; j <= i_blocks; j++ )
+    {
+        for( unsigned l = 0; l < i_lanes; l++ )
+        {
+            if( j <= lanes[l].n )
+                csa_LanesLoad( R, l, &lanes[l].pkt[lanes[l].i_hdr + 8*(j-1)],
+                               NULL );
+        }
+
+        csa_BlockDecypherLanes( kk, R, i_words );
+
+        for( unsigned l = 0; l < i_lanes; l++ )
+        {
+            if( j > lanes[l].n )
+                continue;
+
+            uint8_t *p = &lanes[l].pkt[lanes[l].i_hdr + 8*(j-1)];
+            csa_LanesStore( R, l, p, j != lanes[l].n ? p + 8 : NULL );
+        }
+    }
+}
+
+static void csa_RunGroups( csa_t *c )
+{
+    for( ;; )
+    {
+        const unsigned i_first = CSA_LANES *
+            atomic_fetch_add_explicit( &c->i_next_group, 1, memory_order_relaxed );
+        if( i_first >= c->i_pkts )
+            break;
+
+        const unsigned i_count = __MIN( c->i_pkts - i_first, CSA_LANES );
+        if( c->b_encrypt )
+            csa_EncryptGroup( c, &c->pp_pkts[i_first], i_count, c->i_pkt_size );
+        else
+            csa_DecryptGroup( c, &c->pp_pkts[i_first], i_count, c->i_pkt_size );
+    }
+}
+
+static void *csa_Thread( void *data )
+{
+    csa_t *c = data;
+    unsigned i_generation = 0;
+
+    vlc_mutex_lock( &c->lock );
+    for( ;; )
+    {
+        while( c->i_generation == i_generation && !c->b_quit )
+            vlc_cond_wait( &c->wait, &c->lock );
+        if( c->b_quit )
+            break;
+        i_generation = c->i_generation;
+        vlc_mutex_unlock( &c->lock );
+
+        csa_RunGroups( c );
+
+        vlc_mutex_lock( &c->lock );
+        if( --c->i_busy == 0 )
+            vlc_cond_signal( &c->done );
+    }
+    vlc_mutex_unlock( &c->lock );
+    return NULL;
+}
+
+/*****************************************************************************
+ * csa_StartThreads: spreads the batches over i_count threads, including the
+ * calling one
+ *****************************************************************************/
+int csa_StartThreads( csa_t *c, unsigned i_count )
+{
+    assert( c->i_threads == 0 );
+    if( i_count <= 1 )
+        return VLC_SUCCESS;
+
+    c->threads = vlc_alloc( i_count - 1, sizeof( *c->threads ) );
+    if( unlikely( c->threads == NULL ) )
+        return VLC_ENOMEM;
+
+    for( unsigned i = 0; i < i_count - 1; i++ )
+    {
+        if( vlc_clone( &c->threads[i], csa_Thread, c,
+                       VLC_THREAD_PRIORITY_OUTPUT ) )
+            break;
+        c->i_threads++;
+    }
+    return c->i_threads ? VLC_SUCCESS : VLC_EGENERIC;
+}
+
+static void csa_Batch( csa_t *c, uint8_t *const *pkts, unsigned i_pkts,
+                       int i_pkt_size, bool b_encrypt )
+{
+    if( i_pkts < CSA_LANES_MIN )
+    {
+        for( unsigned i = 0; i < i_pkts; i++ )
+        {
+            if( b_encrypt )
+                csa_Encrypt( c, pkts[i], i_pkt_size );
+            else
+                csa_Decrypt( c, pkts[i], i_pkt_size );
+        }
+        return;
+    }
+
+    c->pp_pkts = pkts;
+    c->i_pkts = i_pkts;
+    c->i_pkt_size = i_pkt_size;
+    c->b_encrypt = b_encrypt;
+    atomic_store_explicit( &c->i_next_group, 0, memory_order_relaxed );
+
+    if( c->i_threads == 0 || i_pkts <= CSA_LANES )
+    {
+        csa_RunGroups( c );
+        return;
+    }
+
+    vlc_mutex_lock( &c->lock );
+    c->i_generation++;
+    c->i_busy = c->i_threads;
+    vlc_cond_broadcast( &c->wait );
+    vlc_mutex_unlock( &c->lock );
+
+    csa_RunGroups( c );
+
+    vlc_mutex_lock( &c->lock );
+    while( c->i_busy > 0 )
+        vlc_cond_wait( &c->done, &c->lock );
+    vlc_mutex_unlock( &c->lock );
+}
+
+/*****************************************************************************
+ * csa_EncryptBatch, csa_DecryptBatch: same as csa_Encrypt and csa_Decrypt
+ * on an array of packets
+ *****************************************************************************/
+void csa_EncryptBatch( csa_t *c, uint8_t *const *pkts, unsigned i_pkts,
+                       int i_pkt_size )
+{
+    csa_Batch( c, pkts, i_pkts, i_pkt_size, true );
+}
+
+void csa_DecryptBatch( csa_t *c, uint8_t *const *pkts, unsigned i_pkts,
+                       int i_pkt_size )
+{
+    csa_Batch( c, pkts, i_pkts, i_pkt_size, false );
+}
@@ -30,6 +30,9 @@ typedef struct csa_t csa_t;
 #define csa_UseKey  __csa_UseKey
 #define csa_Decrypt __csa_decrypt
 #define csa_Encrypt __csa_encrypt
+#define csa_StartThreads __csa_StartThreads
+#define csa_DecryptBatch __csa_DecryptBatch
+#define csa_EncryptBatch __csa_EncryptBatch
 
 csa_t *csa_New( void );
 void   csa_Delete( csa_t * );
@@ -40,4 +43,9 @@ void   csa_UseKey( vlc_object_t *p_caller, csa_t *, bool use_odd );
 void   csa_Decrypt( csa_t *, uint8_t *pkt, int i_pkt_size );
 void   csa_Encrypt( csa_t *, uint8_t *pkt, int i_pkt_size );
 
+/* Batches run up to 64 packets at once per thread */
+int    csa_StartThreads( csa_t *, unsigned i_count );
+void   csa_DecryptBatch( csa_t *, uint8_t *const *pkts, unsigned i_pkts, int i_pkt_size );
+void   csa_EncryptBatch( csa_t *, uint8_t *const *pkts, unsigned i_pkts, int i_pkt_size );
+
 #endif /* _CSA_H */
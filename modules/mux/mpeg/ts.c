@@ -32,6 +32,7 @@
 #endif
 
 #include <limits.h>
+#include <assert.h>
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
@@ -181,6 +182,10 @@ static const char *const ts_standards_list_text[] =
     "The encryption routines subtract the TS-header from the value before " \
     "encrypting." )
 
+#define CTHREADS_TEXT N_("Encryption threads")
+#define CTHREADS_LONGTEXT N_("Number of threads encrypting the packets " \
+    "(0 for one per CPU).")
+
 #define SOUT_CFG_PREFIX "sout-ts-"
 #define MAX_PMT 64       /* Maximum number of programs. FIXME: I just chose an arbitrary number. Where is the maximum in the spec? */
 #define MAX_PMT_PID 64       /* Maximum pids in each pmt.  FIXME: I just chose an arbitrary number. Where is the maximum in the spec? */
@@ -230,6 +235,8 @@ vlc_module_begin ()
     add_string( SOUT_CFG_PREFIX "csa2-ck", NULL, CK2_TEXT,  CK2_LONGTEXT)
     add_string( SOUT_CFG_PREFIX "csa-use", "1",  CU_TEXT,   CU_LONGTEXT)
     add_integer(SOUT_CFG_PREFIX "csa-pkt", 188,  CPKT_TEXT, CPKT_LONGTEXT)
+    add_integer_with_range(SOUT_CFG_PREFIX "csa-threads", 1, 0, 64,
+                           CTHREADS_TEXT, CTHREADS_LONGTEXT)
 
     set_callbacks( Open, Close )
 vlc_module_end ()
@@ -242,7 +249,7 @@ static const char *const ppsz_sout_options[] = {
     "pid-video", "pid-audio", "pid-spu", "pid-pmt", "tsid",
     "netid", "sdtdesc",
     "es-id-pid", "shaping", "pcr", "use-key-frames",
-    "dts-delay", "csa-ck", "csa2-ck", "csa-use", "csa-pkt", "crypt-audio", "crypt-video",
+    "dts-delay", "csa-ck", "csa2-ck", "csa-use", "csa-pkt", "csa-threads", "crypt-audio", "crypt-video",
     "muxpmt", "program-pmt", "alignment",
     NULL
 };
@@ -299,13 +306,6 @@ static inline block_t *BufferChainGet( sout_buffer_chain_t *c )
     return b;
 }
 
-static inline block_t *BufferChainPeek( sout_buffer_chain_t *c )
-{
-    block_t *b = c->p_first;
-
-    return b;
-}
-
 static inline void BufferChainClean( sout_buffer_chain_t *c )
 {
     block_t *b;
@@ -317,6 +317,81 @@ static inline void BufferChainClean( sout_buffer_chain_t *c )
     BufferChainInit( c );
 }
 
+/* TS packets are written straight into output blocks of up to TS_BATCH
+ * packets, which are sent as is once dated. 7 packets fill the usual 1316
+ * bytes of payload of IP datagrams. */
+#define TS_BATCH 7
+#define TS_CSA_BATCH 512 /* packets encrypted at once */
+
+typedef struct
+{
+    uint8_t    *p; /* 188 bytes within an output block */
+    vlc_tick_t  i_dts;
+    vlc_tick_t  i_length;
+    uint32_t    i_flags;
+} ts_packet_t;
+
+typedef struct
+{
+    sout_buffer_chain_t batches;
+    block_t     *p_batch; /* last output block, being filled */
+    ts_packet_t *p_packets;
+    int          i_count;
+    int          i_max;
+} ts_packets_t;
+
+static inline void TSPacketsReset( ts_packets_t *c )
+{
+    BufferChainClean( &c->batches );
+    c->p_batch = NULL;
+    c->i_count = 0;
+}
+
+static ts_packet_t *TSPacketsAppend( ts_packets_t *c, uint32_t i_flags )
+{
+    if( c->i_count == c->i_max )
+    {
+        int i_max = c->i_max ? c->i_max * 2 : 256;
+        ts_packet_t *p_packets = vlc_reallocarray( c->p_packets, i_max,
+                                                   sizeof(*p_packets) );
+        if( unlikely(p_packets == NULL) )
+            return NULL;
+        /* Output blocks are never reallocated, so the packets stay valid */
+        c->p_packets = p_packets;
+        c->i_max = i_max;
+    }
+
+    /* Headers and keyframes start an output block, as the access outputs
+     * gather headers and cut streams per block */
+    block_t *p_batch = c->p_batch;
+    if( p_batch == NULL || p_batch->i_buffer == TS_BATCH * 188
+     || (i_flags & (BLOCK_FLAG_HEADER | BLOCK_FLAG_TYPE_I))
+     || (c->p_packets[c->i_count - 1].i_flags & BLOCK_FLAG_HEADER) )
+    {
+        p_batch = block_Alloc( TS_BATCH * 188 );
+        if( unlikely(p_batch == NULL) )
+            return NULL;
+        p_batch->i_buffer = 0;
+        BufferChainAppend( &c->batches, p_batch );
+        c->p_batch = p_batch;
+    }
+
+    ts_packet_t *p_ts = &c->p_packets[c->i_count++];
+    p_ts->p = &p_batch->p_buffer[p_batch->i_buffer];
+    p_ts->i_dts = 0;
+    p_ts->i_length = 0;
+    p_ts->i_flags = i_flags;
+    p_batch->i_buffer += 188;
+    return p_ts;
+}
+
+/* Serialized PSI packet, reused until the tables change */
+typedef struct
+{
+    uint8_t         p[188];
+    tsmux_stream_t *ts; /* owner of the continuity counter */
+} ts_psi_packet_t;
+
 typedef struct
 {
     sout_buffer_chain_t chain_pes;
@@ -376,6 +451,13 @@ typedef struct
     int             i_csa_pkt_size;
     bool            b_crypt_audio;
     bool            b_crypt_video;
+
+    ts_packets_t    packets;
+
+    /* PAT, PMT and SDT packets */
+    ts_psi_packet_t *p_psi;
+    int             i_psi;
+    bool            b_psi_valid;
 } sout_mux_sys_t;
 
 
@@ -464,15 +546,22 @@ static int Mux      ( sout_mux_t * );
 
 static block_t *FixPES( sout_mux_t *p_mux, block_fifo_t *p_fifo );
 static block_t *Add_ADTS( block_t *, const es_format_t * );
-static void TSSchedule  ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSSchedule  ( sout_mux_t *p_mux, ts_packet_t *p_packets,
+                          int i_packet_count,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
-static void TSDate      ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSDate      ( sout_mux_t *p_mux, ts_packet_t *p_packets,
+                          int i_packet_count,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
+static void TSSend      ( sout_mux_t *p_mux, ts_packets_t *c );
 static void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
 static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
+static void UpdatePSI( sout_mux_t *p_mux );
+static bool WritePSI( sout_mux_t *p_mux, ts_packets_t *c, uint32_t i_flags );
 
-static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr );
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts );
+static bool TSIsKeyFrame( const sout_input_sys_t *p_stream );
+static void TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr,
+                   ts_packet_t *p_ts );
+static void TSSetPCR( uint8_t *p_ts, vlc_tick_t i_dts );
 
 static csa_t *csaSetup( vlc_object_t *p_this )
 {
@@ -524,6 +613,12 @@ static csa_t *csaSetup( vlc_object_t *p_this )
 
     msg_Dbg( p_mux, "encrypting %d bytes of packet", p_sys->i_csa_pkt_size );
 
+    unsigned i_threads = var_GetInteger( p_mux, SOUT_CFG_PREFIX "csa-threads" );
+    if( i_threads == 0 )
+        i_threads = vlc_GetCPUCount();
+    if( csa_StartThreads( csa, i_threads ) )
+        msg_Warn( p_mux, "cannot create encryption threads" );
+
     free(csack);
 
     return csa;
@@ -715,6 +810,8 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_use_key_frames = var_GetBool( p_mux, SOUT_CFG_PREFIX "use-key-frames" );
 
+    BufferChainInit( &p_sys->packets.batches );
+
     p_mux->p_sys        = p_sys;
 
     p_sys->csa = csaSetup(p_this);
@@ -752,6 +849,9 @@ static void Close( vlc_object_t * p_this )
         free( p_sys->sdt.desc[i].psz_provider );
     }
 
+    TSPacketsReset( &p_sys->packets );
+    free( p_sys->packets.p_packets );
+    free( p_sys->p_psi );
     free( p_sys );
 }
 
@@ -929,6 +1029,7 @@ static int AddStream( sout_mux_t *p_mux, sout_input_t *p_input )
 
     /* We only change PMT version (PAT isn't changed) */
     p_sys->i_pmt_version_number = ( p_sys->i_pmt_version_number + 1 )%32;
+    p_sys->b_psi_valid = false;
 
     /* Update pcr_pid */
     SelectPCRStream( p_mux, NULL );
@@ -989,18 +1090,7 @@ static void DelStream( sout_mux_t *p_mux, sout_input_t *p_input )
     /* We only change PMT version (PAT isn't changed) */
     p_sys->i_pmt_version_number++;
     p_sys->i_pmt_version_number %= 32;
-}
-
-static void SetHeader( sout_buffer_chain_t *c,
-                        int depth )
-{
-    block_t *p_ts = BufferChainPeek( c );
-    while( depth > 0 )
-    {
-        p_ts = p_ts->p_next;
-        depth--;
-    }
-    p_ts->i_flags |= BLOCK_FLAG_HEADER;
+    p_sys->b_psi_valid = false;
 }
 
 static block_t *Pack_Opus(block_t *p_data)
@@ -1111,6 +1201,10 @@ static block_t *Encap_J2K( block_t *p_data, const es_format_t *p_fmt )
     {
         p_data->p_buffer += (i_offset - 38);
         p_data->i_buffer -= (i_offset - 38);
+        /* The header is written in place: do not alter other references */
+        p_data = block_MakeWritable( p_data );
+        if( unlikely(!p_data) )
+            return NULL;
     }
 
     const int profile = j2k_get_profile( p_fmt->video.i_visible_width,
@@ -1151,7 +1245,6 @@ static bool MuxStreams(sout_mux_t *p_mux )
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
     sout_input_sys_t *p_pcr_stream = (sout_input_sys_t*)p_sys->p_pcr_input->p_sys;
 
-    sout_buffer_chain_t chain_ts;
     vlc_tick_t i_shaping_delay = p_pcr_stream->state.b_key_frame
         ? p_pcr_stream->state.i_pes_length
         : p_sys->i_shaping_delay;
@@ -1440,13 +1533,12 @@ static bool MuxStreams(sout_mux_t *p_mux )
     i_packet_count += (8 * i_pcr_length / p_sys->i_pcr_delay + 175) / 176;
 
     /* 3: mux PES into TS */
-    BufferChainInit( &chain_ts );
-    /* append PAT/PMT  -> FIXME with big pcr delay it won't have enough pat/pmt */
-    bool pat_was_previous = true; //This is to prevent unnecessary double PAT/PMT insertions
-    GetPAT( p_mux, &chain_ts );
-    GetPMT( p_mux, &chain_ts );
+    ts_packets_t *p_packets = &p_sys->packets;
+    UpdatePSI( p_mux );
+    /* PAT/PMT go first -> FIXME with big pcr delay it won't have enough pat/pmt */
+    bool b_psi = true;
     int i_packet_pos = 0;
-    i_packet_count += chain_ts.i_depth;
+    i_packet_count += p_sys->i_psi;
     /* msg_Dbg( p_mux, "estimated pck=%d", i_packet_count ); */
 
     const vlc_tick_t i_pcr_dts = p_pcr_stream->state.i_pes_dts;
@@ -1490,8 +1582,29 @@ static bool MuxStreams(sout_mux_t *p_mux )
             p_sys->i_pcr = i_pcr_dts + packet_length;
         }
 
+        const bool b_key = TSIsKeyFrame( p_stream );
+
+        /* Write PAT/PMT before every keyframe if use-key-frames is enabled,
+         * this helps to do segmenting with livehttp-output so it can cut segment
+         * and start new one with pat,pmt,keyframe*/
+        const uint32_t i_psi_flags =
+            ( p_sys->b_use_key_frames && p_input->p_fmt->i_cat == VIDEO_ES &&
+              b_key ) ? BLOCK_FLAG_HEADER : 0;
+        if( b_psi || i_psi_flags )
+        {
+            if( !b_psi ) /* Not counted yet */
+                i_packet_count += p_sys->i_psi;
+            b_psi = false;
+            if( !WritePSI( p_mux, p_packets, i_psi_flags ) )
+                break;
+        }
+
         /* Build the TS packet */
-        block_t *p_ts = TSNew( p_mux, p_stream, b_pcr );
+        ts_packet_t *p_ts = TSPacketsAppend( p_packets,
+                                             b_key ? BLOCK_FLAG_TYPE_I : 0 );
+        if( unlikely(p_ts == NULL) )
+            break;
+        TSNew( p_mux, p_stream, b_pcr, p_ts );
         if( p_sys->csa != NULL &&
              (p_input->p_fmt->i_cat != AUDIO_ES || p_sys->b_crypt_audio) &&
              (p_input->p_fmt->i_cat != VIDEO_ES || p_sys->b_crypt_video) )
@@ -1499,33 +1612,14 @@ static bool MuxStreams(sout_mux_t *p_mux )
             p_ts->i_flags |= BLOCK_FLAG_SCRAMBLED;
         }
         i_packet_pos++;
-
-        /* Write PAT/PMT before every keyframe if use-key-frames is enabled,
-         * this helps to do segmenting with livehttp-output so it can cut segment
-         * and start new one with pat,pmt,keyframe*/
-        if( ( p_sys->b_use_key_frames ) &&
-            ( p_input->p_fmt->i_cat == VIDEO_ES ) &&
-            ( p_ts->i_flags & BLOCK_FLAG_TYPE_I ) )
-        {
-            if( likely( !pat_was_previous ) )
-            {
-                int startcount = chain_ts.i_depth;
-                GetPAT( p_mux, &chain_ts );
-                GetPMT( p_mux, &chain_ts );
-                SetHeader( &chain_ts, startcount );
-                i_packet_count += (chain_ts.i_depth - startcount );
-            } else {
-                SetHeader( &chain_ts, 0); //We just inserted pat/pmt,so just flag it instead of adding new one
-            }
-        }
-        pat_was_previous = false;
-
-        /* */
-        BufferChainAppend( &chain_ts, p_ts );
     }
+    if( b_psi )
+        WritePSI( p_mux, p_packets, 0 );
 
     /* 4: date and send */
-    TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    TSSchedule( p_mux, p_packets->p_packets, p_packets->i_count,
+                i_pcr_length, i_pcr_dts );
+    TSSend( p_mux, p_packets );
     return false;
 }
 
@@ -1660,14 +1754,11 @@ static block_t *Add_ADTS( block_t *p_data, const es_format_t *p_fmt )
     return p_new_block;
 }
 
-static void TSSchedule( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSSchedule( sout_mux_t *p_mux, ts_packet_t *p_packets,
+                        int i_packet_count,
                         vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
 {
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
-    sout_buffer_chain_t new_chain;
-    int i_packet_count = p_chain_ts->i_depth;
-
-    BufferChainInit( &new_chain );
 
     if ( unlikely(i_pcr_length <= 0) )
     {
@@ -1676,48 +1767,46 @@ static void TSSchedule( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
 
     for (int i = 0; i < i_packet_count; i++ )
     {
-        block_t *p_ts = BufferChainGet( p_chain_ts );
+        const ts_packet_t *p_ts = &p_packets[i];
         vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
 
-        BufferChainAppend( &new_chain, p_ts );
-
         if (!p_ts->i_dts || p_ts->i_dts + p_sys->i_dts_delay * 2/3 >= i_new_dts)
             continue;
 
         vlc_tick_t i_max_diff = i_new_dts - p_ts->i_dts;
         vlc_tick_t i_cut_dts = p_ts->i_dts;
+        int i_cut = i + 1;
 
-        while( (p_ts = BufferChainPeek( p_chain_ts )) )
+        while( i_cut < i_packet_count )
         {
+            p_ts = &p_packets[i_cut];
             i_new_dts = i_pcr_dts + i_pcr_length * i++ / i_packet_count;
             if( p_ts->i_dts >= i_pcr_dts &&
                 i_new_dts - p_ts->i_dts >= i_max_diff )
                break;
-            p_ts = BufferChainGet( p_chain_ts );
-            BufferChainAppend( &new_chain, p_ts );
+            i_cut++;
             i_max_diff = i_new_dts - p_ts->i_dts;
             i_cut_dts = p_ts->i_dts;
         }
         msg_Dbg( p_mux, "adjusting rate at %"PRId64"/%"PRId64" (%d/%d)",
-                 i_cut_dts - i_pcr_dts, i_pcr_length, new_chain.i_depth,
-                 p_chain_ts->i_depth );
-        if ( new_chain.i_depth )
-            TSDate( p_mux, &new_chain, i_cut_dts - i_pcr_dts, i_pcr_dts );
-        if ( p_chain_ts->i_depth )
-            TSSchedule( p_mux, p_chain_ts, i_pcr_dts + i_pcr_length - i_cut_dts,
-                        i_cut_dts );
+                 i_cut_dts - i_pcr_dts, i_pcr_length, i_cut,
+                 i_packet_count - i_cut );
+        TSDate( p_mux, p_packets, i_cut, i_cut_dts - i_pcr_dts, i_pcr_dts );
+        if ( i_packet_count > i_cut )
+            TSSchedule( p_mux, &p_packets[i_cut], i_packet_count - i_cut,
+                        i_pcr_dts + i_pcr_length - i_cut_dts, i_cut_dts );
         return;
     }
 
-    if ( new_chain.i_depth )
-        TSDate( p_mux, &new_chain, i_pcr_length, i_pcr_dts );
+    if ( i_packet_count )
+        TSDate( p_mux, p_packets, i_packet_count, i_pcr_length, i_pcr_dts );
 }
 
-static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSDate( sout_mux_t *p_mux, ts_packet_t *p_packets,
+                    int i_packet_count,
                     vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
 {
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
-    int i_packet_count = p_chain_ts->i_depth;
 
     if ( unlikely(i_pcr_length / 1000 <= 0) )
     {
@@ -1726,12 +1815,14 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
         i_pcr_length = i_packet_count;
     }
 
+    /* Scrambled packets are encrypted by batches */
+    uint8_t *pp_scrambled[TS_CSA_BATCH];
+    unsigned i_scrambled = 0;
+
     /* msg_Dbg( p_mux, "real pck=%d", i_packet_count ); */
-    block_t *p_list = NULL;
-    block_t **pp_last = &p_list;
     for (int i = 0; i < i_packet_count; i++ )
     {
-        block_t *p_ts = BufferChainGet( p_chain_ts );
+        ts_packet_t *p_ts = &p_packets[i];
         vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
 
         p_ts->i_dts    = i_new_dts;
@@ -1740,29 +1831,72 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
         if( p_ts->i_flags & BLOCK_FLAG_CLOCK )
         {
             /* msg_Dbg( p_mux, "pcr=%lld ms", p_ts->i_dts / 1000 ); */
-            TSSetPCR( p_ts, p_ts->i_dts - p_sys->first_dts );
+            TSSetPCR( p_ts->p, p_ts->i_dts - p_sys->first_dts );
         }
         if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
         {
-            vlc_mutex_lock( &p_sys->csa_lock );
-            csa_Encrypt( p_sys->csa, p_ts->p_buffer, p_sys->i_csa_pkt_size );
-            vlc_mutex_unlock( &p_sys->csa_lock );
+            pp_scrambled[i_scrambled++] = p_ts->p;
+            if( i_scrambled == TS_CSA_BATCH )
+            {
+                vlc_mutex_lock( &p_sys->csa_lock );
+                csa_EncryptBatch( p_sys->csa, pp_scrambled, i_scrambled,
+                                  p_sys->i_csa_pkt_size );
+                vlc_mutex_unlock( &p_sys->csa_lock );
+                i_scrambled = 0;
+            }
         }
 
         /* latency */
         p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
+    }
+
+    if( i_scrambled > 0 )
+    {
+        vlc_mutex_lock( &p_sys->csa_lock );
+        csa_EncryptBatch( p_sys->csa, pp_scrambled, i_scrambled,
+                          p_sys->i_csa_pkt_size );
+        vlc_mutex_unlock( &p_sys->csa_lock );
+    }
+}
+
+/* Sends the dated packets, as dated by their first packet */
+static void TSSend( sout_mux_t *p_mux, ts_packets_t *c )
+{
+    const ts_packet_t *p_ts = c->p_packets;
 
-        block_ChainLastAppend( &pp_last, p_ts );
+    for( block_t *p_batch = c->batches.p_first; p_batch != NULL;
+         p_batch = p_batch->p_next )
+    {
+        p_batch->i_dts = p_ts->i_dts;
+        p_batch->i_flags = p_ts->i_flags & (BLOCK_FLAG_HEADER | BLOCK_FLAG_TYPE_I);
+        p_batch->i_length = 0;
+        for( size_t i = 0; i < p_batch->i_buffer; i += 188 )
+            p_batch->i_length += (p_ts++)->i_length;
     }
+    assert( p_ts == &c->p_packets[c->i_count] );
+
+    block_t *p_list = c->batches.p_first;
+    BufferChainInit( &c->batches );
+    TSPacketsReset( c );
     if ( p_list != NULL )
         sout_AccessOutWrite( p_mux->p_access, p_list );
 }
 
-static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
-                       bool b_pcr )
+static bool TSIsKeyFrame( const sout_input_sys_t *p_stream )
+{
+    const block_t *p_pes = p_stream->state.chain_pes.p_first;
+
+    return p_stream->state.i_pes_used <= 0
+        && !(p_pes->i_flags & BLOCK_FLAG_NO_KEYFRAME)
+        && (p_pes->i_flags & BLOCK_FLAG_TYPE_I);
+}
+
+static void TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr,
+                   ts_packet_t *p_ts )
 {
     VLC_UNUSED(p_mux);
     block_t *p_pes = p_stream->state.chain_pes.p_first;
+    uint8_t *p = p_ts->p;
 
     bool b_new_pes = false;
     bool b_adaptation_field = false;
@@ -1781,20 +1915,13 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
         b_adaptation_field = true;
     }
 
-    block_t *p_ts = block_Alloc( 188 );
-
-    if (b_new_pes && !(p_pes->i_flags & BLOCK_FLAG_NO_KEYFRAME) && p_pes->i_flags & BLOCK_FLAG_TYPE_I)
-    {
-        p_ts->i_flags |= BLOCK_FLAG_TYPE_I;
-    }
-
     p_ts->i_dts = p_pes->i_dts;
 
-    p_ts->p_buffer[0] = 0x47;
-    p_ts->p_buffer[1] = ( b_new_pes ? 0x40 : 0x00 ) |
+    p[0] = 0x47;
+    p[1] = ( b_new_pes ? 0x40 : 0x00 ) |
         ( ( p_stream->ts.i_pid >> 8 )&0x1f );
-    p_ts->p_buffer[2] = p_stream->ts.i_pid & 0xff;
-    p_ts->p_buffer[3] = ( b_adaptation_field ? 0x30 : 0x10 ) |
+    p[2] = p_stream->ts.i_pid & 0xff;
+    p[3] = ( b_adaptation_field ? 0x30 : 0x10 ) |
         p_stream->ts.i_continuity_counter;
 
     p_stream->ts.i_continuity_counter = (p_stream->ts.i_continuity_counter+1)%16;
@@ -1807,28 +1934,28 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
         {
             p_ts->i_flags |= BLOCK_FLAG_CLOCK;
 
-            p_ts->p_buffer[4] = 7 + i_stuffing;
-            p_ts->p_buffer[5] = 1 << 4; /* PCR_flag */
+            p[4] = 7 + i_stuffing;
+            p[5] = 1 << 4; /* PCR_flag */
             if( p_stream->ts.b_discontinuity )
             {
-                p_ts->p_buffer[5] |= 0x80; /* flag TS dicontinuity */
+                p[5] |= 0x80; /* flag TS dicontinuity */
                 p_stream->ts.b_discontinuity = false;
             }
-            memset(&p_ts->p_buffer[12], 0xff, i_stuffing);
+            memset(&p[12], 0xff, i_stuffing);
         }
         else
         {
-            p_ts->p_buffer[4] = --i_stuffing;
+            p[4] = --i_stuffing;
             if( i_stuffing-- )
             {
-                p_ts->p_buffer[5] = 0;
-                memset(&p_ts->p_buffer[6], 0xff, i_stuffing);
+                p[5] = 0;
+                memset(&p[6], 0xff, i_stuffing);
             }
         }
     }
 
     /* copy payload */
-    memcpy( &p_ts->p_buffer[188 - i_payload],
+    memcpy( &p[188 - i_payload],
             &p_pes->p_buffer[p_stream->state.i_pes_used], i_payload );
 
     p_stream->state.i_pes_used += i_payload;
@@ -1857,24 +1984,22 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
         }
         p_stream->state.i_pes_used = 0;
     }
-
-    return p_ts;
 }
 
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts )
+static void TSSetPCR( uint8_t *p_ts, vlc_tick_t i_dts )
 {
     int64_t i_pcr = TO_SCALE_NZ(i_dts);
 
-    p_ts->p_buffer[6]  = ( i_pcr >> 25 )&0xff;
-    p_ts->p_buffer[7]  = ( i_pcr >> 17 )&0xff;
-    p_ts->p_buffer[8]  = ( i_pcr >> 9  )&0xff;
-    p_ts->p_buffer[9]  = ( i_pcr >> 1  )&0xff;
-    p_ts->p_buffer[10] = ( i_pcr << 7  )&0x80;
-    p_ts->p_buffer[10] |= 0x7e;
-    p_ts->p_buffer[11] = 0; /* we don't set PCR extension */
+    p_ts[6]  = ( i_pcr >> 25 )&0xff;
+    p_ts[7]  = ( i_pcr >> 17 )&0xff;
+    p_ts[8]  = ( i_pcr >> 9  )&0xff;
+    p_ts[9]  = ( i_pcr >> 1  )&0xff;
+    p_ts[10] = ( i_pcr << 7  )&0x80;
+    p_ts[10] |= 0x7e;
+    p_ts[11] = 0; /* we don't set PCR extension */
 }
 
-void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
+static void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
 {
     sout_mux_sys_t       *p_sys = p_mux->p_sys;
 
@@ -1914,3 +2039,77 @@ static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
               p_sys->i_num_pmt, p_sys->pmt, p_sys->i_pmt_program_number,
               p_mux->i_nb_inputs, mapped );
 }
+
+static tsmux_stream_t *GetPSIStream( sout_mux_sys_t *p_sys, uint16_t i_pid )
+{
+    if( i_pid == p_sys->pat.i_pid )
+        return &p_sys->pat;
+    if( i_pid == p_sys->sdt.ts.i_pid )
+        return &p_sys->sdt.ts;
+    for( unsigned i = 0; i < p_sys->i_num_pmt; i++ )
+        if( i_pid == p_sys->pmt[i].i_pid )
+            return &p_sys->pmt[i];
+    return NULL;
+}
+
+/* Serializes the tables again, only once they have changed */
+static void UpdatePSI( sout_mux_t *p_mux )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+    sout_buffer_chain_t c;
+
+    if( p_sys->b_psi_valid )
+        return;
+
+    BufferChainInit( &c );
+    GetPAT( p_mux, &c );
+    GetPMT( p_mux, &c );
+
+    ts_psi_packet_t *p_psi = vlc_alloc( c.i_depth, sizeof(*p_psi) );
+    if( unlikely(p_psi == NULL) )
+    {
+        BufferChainClean( &c );
+        return;
+    }
+
+    int i_psi = 0;
+    for( block_t *p_ts; (p_ts = BufferChainGet( &c )) != NULL; i_psi++ )
+    {
+        memcpy( p_psi[i_psi].p, p_ts->p_buffer, 188 );
+        p_psi[i_psi].ts = GetPSIStream( p_sys,
+                              ((p_ts->p_buffer[1] & 0x1f) << 8) | p_ts->p_buffer[2] );
+        block_Release( p_ts );
+
+        /* Continuity counters are set when the packets are written */
+        if( p_psi[i_psi].ts != NULL )
+            p_psi[i_psi].ts->i_continuity_counter =
+                (p_psi[i_psi].ts->i_continuity_counter + 15) % 16;
+    }
+
+    free( p_sys->p_psi );
+    p_sys->p_psi = p_psi;
+    p_sys->i_psi = i_psi;
+    p_sys->b_psi_valid = true;
+}
+
+static bool WritePSI( sout_mux_t *p_mux, ts_packets_t *c, uint32_t i_flags )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+
+    for( int i = 0; i < p_sys->i_psi; i++ )
+    {
+        ts_packet_t *p_ts = TSPacketsAppend( c, i == 0 ? i_flags : 0 );
+        if( unlikely(p_ts == NULL) )
+            return false;
+
+        tsmux_stream_t *ts = p_sys->p_psi[i].ts;
+
+        memcpy( p_ts->p, p_sys->p_psi[i].p, 188 );
+        if( ts != NULL )
+        {
+            p_ts->p[3] = (p_ts->p[3] & 0xf0) | ts->i_continuity_counter;
+            ts->i_continuity_counter = (ts->i_continuity_counter + 1) % 16;
+        }
+    }
+    return true;
+}
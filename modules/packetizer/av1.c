@@ -79,12 +79,6 @@ static inline void InitQueue(block_t **pp_head, block_t ***ppp_tail)
     *ppp_tail = pp_head;
 }
 
-static bool block_Differs(const block_t *a, const block_t *b)
-{
-    return (a->i_buffer != b->i_buffer ||
-            memcmp(a->p_buffer, b->p_buffer, a->i_buffer));
-}
-
 #define INITQ(name) InitQueue(&p_sys->name.p_chain, &p_sys->name.pp_chain_last)
 #define PUSHQ(name,b) \
 {\
@@ -215,6 +209,29 @@ static block_t * OutputQueues(decoder_t *p_dec, bool b_valid)
 /****************************************************************************
  * Packetizer Helpers
  ****************************************************************************/
+static void UpdateSequenceHeader(av1_sys_t *p_sys,
+                                 const uint8_t *p_obu, size_t i_obu)
+{
+    /* Save a copy for Extradata */
+    block_t *p_copy = p_sys->p_sequence_header_block;
+    if(!p_copy || p_copy->i_buffer != i_obu ||
+       memcmp(p_copy->p_buffer, p_obu, i_obu))
+    {
+        p_copy = block_Alloc(i_obu);
+        if(p_copy)
+        {
+            memcpy(p_copy->p_buffer, p_obu, i_obu);
+            if(p_sys->p_sequence_header_block)
+                block_Release(p_sys->p_sequence_header_block);
+            p_sys->p_sequence_header_block = p_copy;
+        }
+    }
+
+    if(p_sys->p_sequence_header)
+        AV1_release_sequence_header(p_sys->p_sequence_header);
+    p_sys->p_sequence_header = AV1_OBU_parse_sequence_header(p_obu, i_obu);
+}
+
 static block_t *GatherAndValidateChain(decoder_t *p_dec, block_t *p_outputchain)
 {
     block_t *p_output = NULL;
@@ -279,20 +296,7 @@ static block_t *ParseOBUBlock(decoder_t *p_dec, block_t *p_obu)
                 p_output = OutputQueues(p_dec, p_sys->p_sequence_header != NULL);
 
             if(b_base_layer)
-            {
-                /* Save a copy for Extradata */
-                if(!p_sys->p_sequence_header_block ||
-                   block_Differs(p_sys->p_sequence_header_block, p_obu))
-                {
-                    if(p_sys->p_sequence_header_block)
-                        block_Release(p_sys->p_sequence_header_block);
-                    p_sys->p_sequence_header_block = block_Duplicate(p_obu);
-                }
-
-                if(p_sys->p_sequence_header)
-                    AV1_release_sequence_header(p_sys->p_sequence_header);
-                p_sys->p_sequence_header = AV1_OBU_parse_sequence_header(p_obu->p_buffer, p_obu->i_buffer);
-            }
+                UpdateSequenceHeader(p_sys, p_obu->p_buffer, p_obu->i_buffer);
             PUSHQ(tu.pre, p_obu);
         } break;
 
@@ -370,6 +374,126 @@ static block_t *ParseOBUBlock(decoder_t *p_dec, block_t *p_obu)
     return p_output;
 }
 
+/*
+ * Demuxers usually feed whole temporal units. When nothing is pending, the
+ * OBUs are checked in place and the block is output as is, instead of being
+ * split into one block per OBU and gathered back, which copies it twice.
+ * Returns false, with no change but to the sequence header, if the block
+ * does not hold exactly one simple temporal unit.
+ */
+static bool PacketizeTemporalUnit(decoder_t *p_dec, block_t *p_block,
+                                  block_t **pp_output)
+{
+    av1_sys_t *p_sys = p_dec->p_sys;
+    AV1_OBU_iterator_ctx_t it;
+    const uint8_t *p_obu; size_t i_obu;
+    const uint8_t *p_sh = NULL; size_t i_sh = 0;
+    size_t i_total = 0;
+    bool b_frame = false;
+
+    if(p_sys->obus.p_chain || p_sys->tu.pre.p_chain ||
+       p_sys->tu.frame.p_chain || p_sys->tu.post.p_chain)
+        return false;
+
+    /* Same order as the output queues, and no OBU to drop */
+    AV1_OBU_iterator_init(&it, p_block->p_buffer, p_block->i_buffer);
+    while(AV1_OBU_iterate_next(&it, &p_obu, &i_obu))
+    {
+        i_total += i_obu;
+        if(!AV1_OBUIsBaseLayer(p_obu, i_obu))
+            return false;
+
+        switch(AV1_OBUGetType(p_obu))
+        {
+            case AV1_OBU_TEMPORAL_DELIMITER:
+                if(p_obu != p_block->p_buffer)
+                    return false;
+                break;
+            case AV1_OBU_SEQUENCE_HEADER:
+                if(b_frame || p_sh)
+                    return false;
+                p_sh = p_obu;
+                i_sh = i_obu;
+                break;
+            case AV1_OBU_METADATA:
+                if(b_frame)
+                    return false;
+                break;
+            case AV1_OBU_FRAME:
+            case AV1_OBU_FRAME_HEADER:
+            case AV1_OBU_TILE_GROUP:
+                b_frame = true;
+                break;
+            default:
+                return false;
+        }
+    }
+    if(i_total != p_block->i_buffer || !b_frame)
+        return false;
+
+    if(p_sh)
+        UpdateSequenceHeader(p_sys, p_sh, i_sh);
+
+    if(!p_sys->p_sequence_header)
+    {
+        /* Undecodable, as the queued units would be */
+        block_Release(p_block);
+        *pp_output = NULL;
+        return true;
+    }
+
+    /* Nothing may follow the visible frame but its tiles */
+    uint32_t i_flags = 0;
+    bool b_visible = false, b_first = true;
+    AV1_OBU_iterator_init(&it, p_block->p_buffer, p_block->i_buffer);
+    while(AV1_OBU_iterate_next(&it, &p_obu, &i_obu))
+    {
+        const enum av1_obu_type_e OBUtype = AV1_OBUGetType(p_obu);
+        if(OBUtype == AV1_OBU_TILE_GROUP)
+            b_first = false;
+        if(OBUtype != AV1_OBU_FRAME && OBUtype != AV1_OBU_FRAME_HEADER)
+            continue;
+        if(b_visible)
+            return false;
+
+        av1_OBU_frame_header_t *p_fh =
+            AV1_OBU_parse_frame_header(p_obu, i_obu, p_sys->p_sequence_header);
+        if(!p_fh)
+        {
+            msg_Warn(p_dec, "could not parse frame header");
+            b_first = false;
+            continue;
+        }
+
+        /* The gathered unit keeps the flags of its first frame OBU */
+        if(b_first)
+        {
+            switch(AV1_get_frame_type(p_fh))
+            {
+                case AV1_FRAME_TYPE_KEY:
+                case AV1_FRAME_TYPE_INTRA_ONLY:
+                    i_flags = BLOCK_FLAG_TYPE_I;
+                    break;
+                case AV1_FRAME_TYPE_INTER:
+                    i_flags = BLOCK_FLAG_TYPE_P;
+                    break;
+                default:
+                    break;
+            }
+            b_first = false;
+        }
+        b_visible |= AV1_get_frame_visibility(p_fh);
+        AV1_release_frame_header(p_fh);
+    }
+    if(!b_visible)
+        return false;
+
+    p_block->i_flags |= i_flags | p_sys->i_next_block_flags;
+    p_sys->i_next_block_flags = 0;
+    *pp_output = p_block;
+    return true;
+}
+
 /****************************************************************************
  * Flush
  ****************************************************************************/
@@ -433,6 +557,15 @@ static block_t *PacketizeOBU(decoder_t *p_dec, block_t **pp_block)
             return NULL;
         }
         *pp_block = NULL;
+
+        block_t *p_output;
+        if(PacketizeTemporalUnit(p_dec, p_block, &p_output))
+        {
+            if(p_output)
+                UpdateDecoderFormat(p_dec);
+            return p_output;
+        }
+
         block_ChainLastAppend(&p_sys->obus.pp_chain_last, p_block);
     }
 
@@ -471,6 +604,8 @@ static block_t *PacketizeOBU(decoder_t *p_dec, block_t **pp_block)
         else
         {
             p_obublock = block_Alloc(i_obu);
+            if(unlikely(p_obublock == NULL))
+                break;
             memcpy(p_obublock->p_buffer, p_frag->p_buffer, i_obu);
             p_frag->i_buffer -= i_obu;
             p_frag->p_buffer += i_obu;
@@ -543,6 +543,14 @@ static block_t *GetCc( decoder_t *p_dec, decoder_cc_desc_t *p_desc )
     return cc_storage_get_current( p_sys->p_ccs, p_desc );
 }
 
+/* Captions are only extracted while someone retrieves them */
+static unsigned GetSEIFilter( const decoder_sys_t *p_sys )
+{
+    if( cc_storage_is_wanted( p_sys->p_ccs ) )
+        return HXXX_SEI_FILTER_ALL;
+    return HXXX_SEI_FILTER_ALL & ~HXXX_SEI_FILTER_ITU_T35;
+}
+
 /****************************************************************************
  * Helpers
  ****************************************************************************/
@@ -673,7 +681,8 @@ static block_t *ParseNALBlock( decoder_t *p_dec, bool *pb_ts_used, block_t *p_fr
                         if( (p_sei->i_flags & BLOCK_FLAG_PRIVATE_SEI) == 0 )
                             continue;
                         HxxxParse_AnnexB_SEI( p_sei->p_buffer, p_sei->i_buffer,
-                                              1 /* nal header */, ParseSeiCallback, p_dec );
+                                              1 /* nal header */, GetSEIFilter( p_sys ),
+                                              ParseSeiCallback, p_dec );
                     }
 
                     if( p_sys->b_slice )
@@ -348,6 +348,14 @@ static block_t *GetCc( decoder_t *p_dec, decoder_cc_desc_t *p_desc )
     return cc_storage_get_current( p_sys->p_ccs, p_desc );
 }
 
+/* Captions are only extracted while someone retrieves them */
+static unsigned GetSEIFilter( const decoder_sys_t *p_sys )
+{
+    if( cc_storage_is_wanted( p_sys->p_ccs ) )
+        return HXXX_SEI_FILTER_ALL;
+    return HXXX_SEI_FILTER_ALL & ~HXXX_SEI_FILTER_ITU_T35;
+}
+
 /****************************************************************************
  * Packetizer Helpers
  ****************************************************************************/
@@ -681,7 +689,8 @@ static void ParseStoredSEI( decoder_t *p_dec )
         if( hevc_getNALType(&p_nal->p_buffer[4]) == HEVC_NAL_PREF_SEI )
         {
             HxxxParse_AnnexB_SEI( p_nal->p_buffer, p_nal->i_buffer,
-                                  2 /* nal header */, ParseSEICallback, p_dec );
+                                  2 /* nal header */, GetSEIFilter(p_dec->p_sys),
+                                  ParseSEICallback, p_dec );
         }
     }
 }
@@ -846,7 +855,8 @@ static block_t * ParseAUTail(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_na
 
         case HEVC_NAL_SUFF_SEI:
             HxxxParse_AnnexB_SEI( p_nalb->p_buffer, p_nalb->i_buffer,
-                                  2 /* nal header */, ParseSEICallback, p_dec );
+                                  2 /* nal header */, GetSEIFilter(p_dec->p_sys),
+                                  ParseSEICallback, p_dec );
             break;
     }
 
@@ -31,8 +31,11 @@
 /****************************************************************************
  * Closed captions handling
  ****************************************************************************/
+#define CC_STORAGE_MAX_IDLE 16 /* pictures without retrieval */
+
 struct cc_storage_t
 {
+    unsigned i_idle;
     uint32_t i_flags;
     vlc_tick_t i_dts;
     vlc_tick_t i_pts;
@@ -48,6 +51,7 @@ cc_storage_t * cc_storage_new( void )
         p_ccs->i_pts = VLC_TICK_INVALID;
         p_ccs->i_dts = VLC_TICK_INVALID;
         p_ccs->i_flags = 0;
+        p_ccs->i_idle = 0;
         cc_Init( &p_ccs->current );
         cc_Init( &p_ccs->next );
     }
@@ -79,12 +83,21 @@ void cc_storage_commit( cc_storage_t *p_ccs, block_t *p_pic )
     p_ccs->i_flags = p_pic->i_flags;
     p_ccs->current = p_ccs->next;
     cc_Flush( &p_ccs->next );
+    if( p_ccs->i_idle < CC_STORAGE_MAX_IDLE )
+        p_ccs->i_idle++;
+}
+
+bool cc_storage_is_wanted( const cc_storage_t *p_ccs )
+{
+    return p_ccs->i_idle < CC_STORAGE_MAX_IDLE;
 }
 
 block_t * cc_storage_get_current( cc_storage_t *p_ccs, decoder_cc_desc_t *p_desc )
 {
     block_t *p_block;
 
+    p_ccs->i_idle = 0;
+
     if( !p_ccs->current.b_reorder && p_ccs->current.i_data <= 0 )
         return NULL;
 
@@ -34,6 +34,9 @@ void cc_storage_append( cc_storage_t *p_ccs, bool b_top_field_first,
 void cc_storage_commit( cc_storage_t *p_ccs, block_t *p_pic );
 
 block_t * cc_storage_get_current( cc_storage_t *p_ccs, decoder_cc_desc_t * );
+/* The decoder owner pulls the captions after each picture if it uses them,
+ * so they are only worth extracting while it keeps doing so */
+bool cc_storage_is_wanted( const cc_storage_t *p_ccs );
 
 /* */
 
@@ -29,15 +29,15 @@
 #include "hxxx_nal.h"
 #include "hxxx_ep3b.h"
 
-void HxxxParse_AnnexB_SEI(const uint8_t *p_buf, size_t i_buf,
-                          uint8_t i_header, pf_hxxx_sei_callback cb, void *cbdata)
+void HxxxParse_AnnexB_SEI(const uint8_t *p_buf, size_t i_buf, uint8_t i_header,
+                          unsigned i_filter, pf_hxxx_sei_callback cb, void *cbdata)
 {
     if( hxxx_strip_AnnexB_startcode( &p_buf, &i_buf ) )
-        HxxxParseSEI(p_buf, i_buf, i_header, cb, cbdata);
+        HxxxParseSEI(p_buf, i_buf, i_header, i_filter, cb, cbdata);
 }
 
-void HxxxParseSEI(const uint8_t *p_buf, size_t i_buf,
-                  uint8_t i_header, pf_hxxx_sei_callback pf_callback, void *cbdata)
+void HxxxParseSEI(const uint8_t *p_buf, size_t i_buf, uint8_t i_header,
+                  unsigned i_filter, pf_hxxx_sei_callback pf_callback, void *cbdata)
 {
     bs_t s;
     bool b_continue = true;
@@ -93,6 +93,8 @@ void HxxxParseSEI(const uint8_t *p_buf, size_t i_buf,
             /* Look for pic timing, do not decode locally */
             case HXXX_SEI_PIC_TIMING:
             {
+                if( !(i_filter & HXXX_SEI_FILTER_PIC_TIMING) )
+                    break;
                 sei_data.p_bs = &s;
                 b_continue = pf_callback( &sei_data, cbdata );
             } break;
@@ -100,6 +102,8 @@ void HxxxParseSEI(const uint8_t *p_buf, size_t i_buf,
             /* Look for user_data_registered_itu_t_t35 */
             case HXXX_SEI_USER_DATA_REGISTERED_ITU_T_T35:
             {
+                if( !(i_filter & HXXX_SEI_FILTER_ITU_T35) )
+                    break;
                 size_t i_t35;
                 uint8_t *p_t35 = malloc( i_size );
                 if( !p_t35 )
@@ -151,6 +155,8 @@ void HxxxParseSEI(const uint8_t *p_buf, size_t i_buf,
 
             case HXXX_SEI_FRAME_PACKING_ARRANGEMENT:
             {
+                if( !(i_filter & HXXX_SEI_FILTER_FRAME_PACKING) )
+                    break;
                 bs_read_ue( &s );
                 if ( !bs_read1( &s ) )
                 {
@@ -171,12 +177,16 @@ void HxxxParseSEI(const uint8_t *p_buf, size_t i_buf,
             /* Look for SEI recovery point */
             case HXXX_SEI_RECOVERY_POINT:
             {
+                if( !(i_filter & HXXX_SEI_FILTER_RECOVERY_POINT) )
+                    break;
                 sei_data.p_bs = &s;
                 b_continue = pf_callback( &sei_data, cbdata );
             } break;
 
             case HXXX_SEI_MASTERING_DISPLAY_COLOUR_VOLUME:
             {
+                if( !(i_filter & HXXX_SEI_FILTER_COLOUR_VOLUME) )
+                    break;
                 for ( size_t i = 0; i < 6 ; ++i)
                     sei_data.colour_volume.primaries[i] = bs_read( &s, 16 );
                 for ( size_t i = 0; i < 2 ; ++i)
@@ -190,6 +200,8 @@ void HxxxParseSEI(const uint8_t *p_buf, size_t i_buf,
 
             case HXXX_SEI_CONTENT_LIGHT_LEVEL:
             {
+                if( !(i_filter & HXXX_SEI_FILTER_LIGHT_LEVEL) )
+                    break;
                 sei_data.content_light_lvl.MaxCLL = bs_read( &s, 16 );
                 sei_data.content_light_lvl.MaxFALL = bs_read( &s, 16 );
                 if( bs_error( &s ) ) /* not enough data */
@@ -88,8 +88,20 @@ typedef struct
     };
 } hxxx_sei_data_t;
 
+/* Selects the decoded SEI payloads, the other ones are skipped unread */
+enum hxxx_sei_filter_e
+{
+    HXXX_SEI_FILTER_PIC_TIMING      = 1 << 0,
+    HXXX_SEI_FILTER_ITU_T35         = 1 << 1,
+    HXXX_SEI_FILTER_RECOVERY_POINT  = 1 << 2,
+    HXXX_SEI_FILTER_FRAME_PACKING   = 1 << 3,
+    HXXX_SEI_FILTER_COLOUR_VOLUME   = 1 << 4,
+    HXXX_SEI_FILTER_LIGHT_LEVEL     = 1 << 5,
+    HXXX_SEI_FILTER_ALL             = (1 << 6) - 1,
+};
+
 typedef bool (*pf_hxxx_sei_callback)(const hxxx_sei_data_t *, void *);
-void HxxxParseSEI(const uint8_t *, size_t, uint8_t, pf_hxxx_sei_callback, void *);
-void HxxxParse_AnnexB_SEI(const uint8_t *, size_t, uint8_t, pf_hxxx_sei_callback, void *);
+void HxxxParseSEI(const uint8_t *, size_t, uint8_t, unsigned, pf_hxxx_sei_callback, void *);
+void HxxxParse_AnnexB_SEI(const uint8_t *, size_t, uint8_t, unsigned, pf_hxxx_sei_callback, void *);
 
 #endif
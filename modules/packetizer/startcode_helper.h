@@ -34,6 +34,13 @@
 #  endif
 #endif
 
+#ifdef HAVE_AVX2_INTRINSICS
+#  include <immintrin.h>
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+#  include <arm_neon.h>
+#endif
+
 /* Looks up efficiently for an AnnexB startcode 0x00 0x00 0x01
  * by using a 4 times faster trick than single byte lookup. */
 
@@ -119,6 +126,64 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
 
 #endif
 
+/* The wide versions compare 3 shifted unaligned loads at once, so every
+ * position gets checked for the whole startcode without a second pass. */
+#ifdef HAVE_AVX2_INTRINSICS
+
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_FindAnnexB_AVX2( const uint8_t *p, const uint8_t *end )
+{
+    const __m256i zeros = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8(1);
+
+    for( ; end - p >= 32 + 2; p += 32 )
+    {
+        __m256i m0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), zeros);
+        __m256i m1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p + 1)), zeros);
+        __m256i m2 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p + 2)), ones);
+        uint32_t match = _mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(m0, m1), m2));
+        if( match )
+            return p + __builtin_ctz(match);
+    }
+
+    for (end -= 3; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+
+static inline const uint8_t * startcode_FindAnnexB_NEON( const uint8_t *p, const uint8_t *end )
+{
+    const uint8x16_t ones = vdupq_n_u8(1);
+
+    for( ; end - p >= 16 + 2; p += 16 )
+    {
+        uint8x16_t m = vandq_u8(vandq_u8(vceqzq_u8(vld1q_u8(p)),
+                                         vceqzq_u8(vld1q_u8(p + 1))),
+                                vceqq_u8(vld1q_u8(p + 2), ones));
+        /* narrow to one nibble per byte to get a scalar mask */
+        uint64_t match = vget_lane_u64(vreinterpret_u64_u8(
+                            vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+        if( match )
+            return p + (__builtin_ctzll(match) >> 2);
+    }
+
+    for (end -= 3; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
 /* That code is adapted from libav's ff_avc_find_startcode_internal
  * and i believe the trick originated from
  * https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
@@ -150,16 +215,21 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
-#ifdef CAN_COMPILE_SSE2
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return startcode_FindAnnexB_AVX2(p, end);
+#endif
+#ifdef CAN_COMPILE_SSE2
     if (vlc_CPU_SSE2())
         return startcode_FindAnnexB_SSE2(p, end);
-    else
-        return startcode_FindAnnexB_Bits(p, end);
-}
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    return startcode_FindAnnexB_NEON(p, end);
 #else
-    #define startcode_FindAnnexB startcode_FindAnnexB_Bits
+    return startcode_FindAnnexB_Bits(p, end);
 #endif
+}
 
 #endif
@@ -76,6 +76,8 @@
 /* Link-local SAP address */
 #define SAP_V4_LINK_ADDRESS     "224.0.0.255"
 #define ADD_SESSION 1
+/* Size of the announces hash table */
+#define SAP_HASH_SIZE 256
 
 static int Decompress( const unsigned char *psz_src, unsigned char **_dst, int i_len )
 {
@@ -135,6 +137,7 @@ typedef struct sap_announce_t
     uint32_t    i_source[4];
 
     input_item_t * p_item;
+    struct sap_announce_t *p_next; /* in the same hash bucket */
 } sap_announce_t;
 
 static sap_announce_t *CreateAnnounce(services_discovery_t *p_sd,
@@ -165,6 +168,7 @@ static sap_announce_t *CreateAnnounce(services_discovery_t *p_sd,
     p_sap->i_period_trust = 0;
     p_sap->i_hash = i_hash;
     memcpy (p_sap->i_source, i_source, sizeof(p_sap->i_source));
+    p_sap->p_next = NULL;
 
     /* Released in RemoveAnnounce */
     p_input = input_item_NewStream(uri, p_sdp->name,
@@ -224,10 +228,37 @@ typedef struct
     /* Table of announces */
     int i_announces;
     struct sap_announce_t **pp_announces;
+    /* Announces indexed by message hash and origin */
+    struct sap_announce_t *announce_hash[SAP_HASH_SIZE];
 
     vlc_tick_t i_timeout;
 } services_discovery_sys_t;
 
+static inline unsigned HashAnnounce( uint16_t i_hash,
+                                     const uint32_t *i_source )
+{
+    uint32_t h = i_hash ^ i_source[0] ^ i_source[1] ^ i_source[2]
+                        ^ i_source[3];
+
+    h ^= h >> 16;
+    return (h ^ (h >> 8)) % SAP_HASH_SIZE;
+}
+
+static sap_announce_t *FindAnnounce( services_discovery_sys_t *p_sys,
+                                     uint16_t i_hash,
+                                     const uint32_t *i_source )
+{
+    sap_announce_t *p_announce =
+        p_sys->announce_hash[HashAnnounce( i_hash, i_source )];
+
+    while( p_announce != NULL
+        && ( p_announce->i_hash != i_hash
+          || memcmp( p_announce->i_source, i_source,
+                     sizeof (p_announce->i_source) ) ) )
+        p_announce = p_announce->p_next;
+    return p_announce;
+}
+
 static int RemoveAnnounce( services_discovery_t *p_sd,
                            sap_announce_t *p_announce )
 {
@@ -239,6 +270,13 @@ static int RemoveAnnounce( services_discovery_t *p_sd,
     }
 
     services_discovery_sys_t *p_sys = p_sd->p_sys;
+    sap_announce_t **pp = &p_sys->announce_hash[
+        HashAnnounce( p_announce->i_hash, p_announce->i_source )];
+
+    while( *pp != p_announce )
+        pp = &(*pp)->p_next;
+    *pp = p_announce->p_next;
+
     TAB_REMOVE(p_sys->i_announces, p_sys->pp_announces, p_announce);
     free( p_announce );
 
@@ -312,6 +350,39 @@ static int ParseSAP( services_discovery_t *p_sd, const uint8_t *buf,
     if (buf > end)
         return VLC_EGENERIC;
 
+    /* Repeated announces are only accounted for: the payload is neither
+     * decompressed nor parsed again. */
+    sap_announce_t *p_announce = FindAnnounce( p_sys, i_hash, i_source );
+    if( p_announce != NULL )
+    {
+        /* We don't support delete announcement as they can easily
+         * Be used to hijack an announcement by a third party.
+         * Instead we cleverly implement Implicit Announcement removal.
+         *
+         * if( b_need_delete )
+         *    RemoveAnnounce( p_sd, p_announce );
+         * else
+         */
+
+        if( !b_need_delete )
+        {
+            /* No need to go after six, as we start to trust the
+             * average period at six */
+            if( p_announce->i_period_trust <= 5 )
+                p_announce->i_period_trust++;
+
+            /* Compute the average period */
+            vlc_tick_t now = vlc_tick_now();
+            p_announce->i_period = ( p_announce->i_period * (p_announce->i_period_trust-1) + (now - p_announce->i_last) ) / p_announce->i_period_trust;
+            p_announce->i_last = now;
+        }
+        return VLC_SUCCESS;
+    }
+
+    /* Do not create an announce for a deletion */
+    if( b_need_delete )
+        return VLC_SUCCESS;
+
     uint8_t *decomp = NULL;
     if( b_compressed )
     {
@@ -356,42 +427,16 @@ static int ParseSAP( services_discovery_t *p_sd, const uint8_t *buf,
         psz_sdp += clen;
     }
 
-    for( int i = 0 ; i < p_sys->i_announces ; i++ )
-    {
-        sap_announce_t * p_announce = p_sys->pp_announces[i];
-        /* FIXME: slow */
-        if (p_announce->i_hash == i_hash
-         && memcmp(p_announce->i_source, i_source, sizeof (i_source)) == 0)
-        {
-            /* We don't support delete announcement as they can easily
-             * Be used to hijack an announcement by a third party.
-             * Instead we cleverly implement Implicit Announcement removal.
-             *
-             * if( b_need_delete )
-             *    RemoveAnnounce( p_sd, p_sys->pp_announces[i]);
-             * else
-             */
-
-            if( !b_need_delete )
-            {
-                /* No need to go after six, as we start to trust the
-                 * average period at six */
-                if( p_announce->i_period_trust <= 5 )
-                    p_announce->i_period_trust++;
-
-                /* Compute the average period */
-                vlc_tick_t now = vlc_tick_now();
-                p_announce->i_period = ( p_announce->i_period * (p_announce->i_period_trust-1) + (now - p_announce->i_last) ) / p_announce->i_period_trust;
-                p_announce->i_last = now;
-            }
-            free (decomp);
-            return VLC_SUCCESS;
-        }
-    }
-
     sap_announce_t *sap = CreateAnnounce(p_sd, i_source, i_hash, psz_sdp);
     if (sap != NULL)
+    {
+        sap_announce_t **bucket =
+            &p_sys->announce_hash[HashAnnounce( i_hash, i_source )];
+
+        sap->p_next = *bucket;
+        *bucket = sap;
         TAB_APPEND(p_sys->i_announces, p_sys->pp_announces, sap);
+    }
 
     free (decomp);
     return VLC_SUCCESS;
@@ -580,6 +625,8 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->i_announces = 0;
     p_sys->pp_announces = NULL;
+    for( unsigned i = 0; i < SAP_HASH_SIZE; i++ )
+        p_sys->announce_hash[i] = NULL;
     /* TODO: create sockets here, and fix racy sockets table */
     if (vlc_clone (&p_sys->thread, Run, p_sd, VLC_THREAD_PRIORITY_LOW))
     {
@@ -43,6 +43,8 @@
 #include <assert.h>
 #include <limits.h>
 #include <algorithm>
+#include <list>
+#include <map>
 #include <set>
 #include <string>
 
@@ -182,20 +184,10 @@ vlc_module_begin()
 vlc_module_end()
 
 /*
- * Extracts the result document from a SOAP response
+ * Parses the DIDL-Lite document from the Result of a Browse response
  */
-IXML_Document* parseBrowseResult( IXML_Document* p_doc )
+static IXML_Document* parseDidl( const char* psz_raw_didl )
 {
-    assert( p_doc );
-
-    // ixml*_getElementsByTagName will ultimately only case the pointer to a Node
-    // pointer, and pass it to a private function. Don't bother have a IXML_Document
-    // version of getChildElementValue
-    const char* psz_raw_didl = xml_getChildElementValue( (IXML_Element*)p_doc, "Result" );
-
-    if( !psz_raw_didl )
-        return NULL;
-
     /* First, try parsing the buffer as is */
     IXML_Document* p_result_doc = ixmlParseBuffer( psz_raw_didl );
     if( !p_result_doc ) {
@@ -1171,22 +1163,115 @@ int MediaServer::sendActionCb( Upnp_EventType eventType,
 }
 
 /* Access part */
-IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
-                                           const char* psz_browser_flag_,
-                                           const char* psz_filter_,
-                                           const char* psz_starting_index,
-                                           const char* psz_requested_count_,
-                                           const char* psz_sort_criteria_ )
+
+/*
+ * Browse results of the containers listed recently, valid as long as their
+ * server reports the same SystemUpdateID
+ */
+namespace
+{
+
+struct BrowseCacheEntry
+{
+    std::string updateId;
+    std::vector<std::string> didl; /* one per response */
+    size_t size;
+};
+
+vlc::threads::mutex cache_lock;
+std::map<std::string, BrowseCacheEntry> cache;
+size_t cache_size = 0;
+
+}
+
+#define BROWSE_PAGE_SIZE 5000
+#define BROWSE_MAX_REQUESTS 4
+#define BROWSE_CACHE_MAX (64 * 1024 * 1024) /* 64 MB */
+
+static bool cacheGet( const std::string& key, const std::string& updateId,
+                      std::vector<std::string>& didl )
+{
+    vlc::threads::mutex_locker lock( cache_lock );
+    auto it = cache.find( key );
+    if ( it == cache.end() )
+        return false;
+    if ( it->second.updateId != updateId )
+    {
+        cache_size -= it->second.size;
+        cache.erase( it );
+        return false;
+    }
+    didl = it->second.didl;
+    return true;
+}
+
+static void cachePut( const std::string& key, const std::string& updateId,
+                      std::vector<std::string>& didl, size_t size )
+{
+    if ( size > BROWSE_CACHE_MAX / 4 )
+        return;
+
+    vlc::threads::mutex_locker lock( cache_lock );
+    auto it = cache.find( key );
+    if ( it != cache.end() )
+    {
+        cache_size -= it->second.size;
+        cache.erase( it );
+    }
+    while ( cache_size + size > BROWSE_CACHE_MAX && !cache.empty() )
+    {
+        cache_size -= cache.begin()->second.size;
+        cache.erase( cache.begin() );
+    }
+    BrowseCacheEntry& entry = cache[key];
+    entry.updateId = updateId;
+    entry.didl.swap( didl );
+    entry.size = size;
+    cache_size += size;
+}
+
+/*
+ * Sends an action, returning the callback to wait for before reading the
+ * response, or NULL if it could not be sent
+ */
+Upnp_i11e_cb* MediaServer::_sendAction( IXML_Document* p_action,
+                                        IXML_Document** pp_response )
 {
-    IXML_Document* p_action = NULL;
-    IXML_Document* p_response = NULL;
-    Upnp_i11e_cb *i11eCb = NULL;
     access_sys_t *sys = (access_sys_t *)m_access->p_sys;
 
-    int i_res;
+    *pp_response = NULL;
 
-    if ( vlc_killed() )
+    /* Setup an interruptible callback that will call sendActionCb if not
+     * interrupted by vlc_interrupt_kill */
+    Upnp_i11e_cb *i11eCb = new Upnp_i11e_cb( sendActionCb, pp_response );
+    int i_res = UpnpSendActionAsync( sys->p_upnp->handle(),
+              m_psz_root,
+              CONTENT_DIRECTORY_SERVICE_TYPE,
+              NULL, /* ignored in SDK, must be NULL */
+              p_action,
+              Upnp_i11e_cb::run, i11eCb );
+
+    if ( i_res != UPNP_E_SUCCESS )
+    {
+        msg_Err( m_access, "%s when trying the send() action with URL: %s",
+                UpnpGetErrorMessage( i_res ), m_access->psz_location );
+        /* The callback will never run */
+        delete i11eCb;
         return NULL;
+    }
+    return i11eCb;
+}
+
+IXML_Document* MediaServer::_browseActionNew( const char* psz_object_id_,
+                                              const char* psz_browser_flag_,
+                                              const char* psz_filter_,
+                                              const char* psz_starting_index,
+                                              const char* psz_requested_count_,
+                                              const char* psz_sort_criteria_ )
+{
+    IXML_Document* p_action = NULL;
+
+    int i_res;
 
     i_res = UpnpAddToAction( &p_action, "Browse",
             CONTENT_DIRECTORY_SERVICE_TYPE, "ObjectID", psz_object_id_ ? psz_object_id_ : "0" );
@@ -1195,7 +1280,7 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Dbg( m_access, "AddToAction 'ObjectID' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
@@ -1205,7 +1290,7 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Dbg( m_access, "AddToAction 'BrowseFlag' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
@@ -1215,7 +1300,7 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Dbg( m_access, "AddToAction 'Filter' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
@@ -1224,7 +1309,7 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Dbg( m_access, "AddToAction 'StartingIndex' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
@@ -1234,7 +1319,7 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Dbg( m_access, "AddToAction 'RequestedCount' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
@@ -1244,103 +1329,271 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Dbg( m_access, "AddToAction 'SortCriteria' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
-    /* Setup an interruptible callback that will call sendActionCb if not
-     * interrupted by vlc_interrupt_kill */
-    i11eCb = new Upnp_i11e_cb( sendActionCb, &p_response );
-    i_res = UpnpSendActionAsync( sys->p_upnp->handle(),
-              m_psz_root,
-              CONTENT_DIRECTORY_SERVICE_TYPE,
-              NULL, /* ignored in SDK, must be NULL */
-              p_action,
-              Upnp_i11e_cb::run, i11eCb );
+    return p_action;
 
-    if ( i_res != UPNP_E_SUCCESS )
+browseActionError:
+    ixmlDocument_free( p_action );
+    return NULL;
+}
+
+/*
+ * Sends a request for the children of the container, from the given index
+ */
+Upnp_i11e_cb* MediaServer::_browseChildren( unsigned long i_start, unsigned long i_count,
+                                            IXML_Document** pp_response )
+{
+    if ( vlc_killed() )
+        return NULL;
+
+    const std::string start = std::to_string( i_start );
+    // Some servers don't understand "0" as "no-limit"
+    const std::string count = std::to_string( i_count );
+    IXML_Document* p_action = _browseActionNew( m_psz_objectId,
+                                                "BrowseDirectChildren",
+                                                "*",
+                                                start.c_str(),
+                                                count.c_str(),
+                                                "" /* SortCriteria */
+                                                );
+    if ( !p_action )
+        return NULL;
+
+    Upnp_i11e_cb* i11eCb = _sendAction( p_action, pp_response );
+    ixmlDocument_free( p_action );
+    return i11eCb;
+}
+
+/*
+ * Returns the SystemUpdateID of the server, changed whenever its content
+ * changes, or an empty string if it does not tell
+ */
+std::string MediaServer::getSystemUpdateId()
+{
+    std::string id;
+
+    if ( vlc_killed() )
+        return id;
+
+    IXML_Document* p_action = UpnpMakeAction( "GetSystemUpdateID",
+                                              CONTENT_DIRECTORY_SERVICE_TYPE,
+                                              0, NULL );
+    if ( !p_action )
+        return id;
+
+    IXML_Document* p_response;
+    Upnp_i11e_cb* i11eCb = _sendAction( p_action, &p_response );
+    ixmlDocument_free( p_action );
+    if ( !i11eCb )
+        return id;
+    i11eCb->waitAndRelease();
+
+    if ( p_response )
     {
-        msg_Err( m_access, "%s when trying the send() action with URL: %s",
-                UpnpGetErrorMessage( i_res ), m_access->psz_location );
+        const char* psz_id = xml_getChildElementValue( (IXML_Element*)p_response, "Id" );
+        if ( psz_id )
+            id = psz_id;
+        ixmlDocument_free( p_response );
     }
-    /* Wait for the callback to fill p_response or wait for an interrupt */
-    i11eCb->waitAndRelease();
+    return id;
+}
 
-browseActionCleanup:
-    ixmlDocument_free( p_action );
-    return p_response;
+/*
+ * Adds the containers and items of a DIDL-Lite document to the node
+ */
+void MediaServer::addResult( IXML_Document* p_result )
+{
+#ifndef NDEBUG
+    msg_Dbg( m_access, "Got DIDL document: %s", ixmlPrintDocument( p_result ) );
+#endif
+
+    IXML_NodeList* containerNodeList =
+    ixmlDocument_getElementsByTagName( p_result, "container" );
+
+    if ( containerNodeList )
+    {
+        for ( unsigned int i = 0; i < ixmlNodeList_length( containerNodeList ); i++)
+            addContainer( (IXML_Element*)ixmlNodeList_item( containerNodeList, i ) );
+        ixmlNodeList_free( containerNodeList );
+    }
+
+    IXML_NodeList* itemNodeList = ixmlDocument_getElementsByTagName( p_result,
+                                                                    "item" );
+    if ( itemNodeList )
+    {
+        for ( unsigned int i = 0; i < ixmlNodeList_length( itemNodeList ); i++)
+            addItem( (IXML_Element*)ixmlNodeList_item( itemNodeList, i ) );
+        ixmlNodeList_free( itemNodeList );
+    }
 }
 
 /*
- * Fetches and parses the UPNP response
+ * Adds the content of a Browse response, and returns the number of objects it
+ * contained, or -1 on error
  */
-bool MediaServer::fetchContents()
+long MediaServer::addResponse( IXML_Document* p_response, unsigned long* pi_total,
+                               std::vector<std::string>& didl, size_t& didl_size )
 {
-    std::string StartingIndex = "0";
-    std::string RequestedCount = "5000";
-    const char* psz_TotalMatches = "0";
-    const char* psz_NumberReturned = "0";
-    long  l_reqCount = 0;
+    const char* psz_total = xml_getChildElementValue( (IXML_Element*)p_response, "TotalMatches" );
+    const char* psz_returned = xml_getChildElementValue( (IXML_Element*)p_response, "NumberReturned" );
+    const char* psz_raw_didl = xml_getChildElementValue( (IXML_Element*)p_response, "Result" );
 
-    do
+    if ( !psz_total || !psz_returned || !psz_raw_didl )
     {
-        IXML_Document* p_response = _browseAction( m_psz_objectId,
-                                                  "BrowseDirectChildren",
-                                                  "*",
-                                                  StartingIndex.c_str(),
-                                                  // Some servers don't understand "0" as "no-limit"
-                                                  RequestedCount.c_str(), /* RequestedCount */
-                                                  "" /* SortCriteria */
-                                                  );
-        if ( !p_response )
-        {
-            msg_Err( m_access, "No response from browse() action" );
-            return false;
-        }
+        msg_Err( m_access, "browse() response parsing failed" );
+        return -1;
+    }
 
-        psz_TotalMatches = xml_getChildElementValue( (IXML_Element*)p_response, "TotalMatches" );
-        psz_NumberReturned = xml_getChildElementValue( (IXML_Element*)p_response, "NumberReturned" );
+    IXML_Document* p_result = parseDidl( psz_raw_didl );
+    if ( !p_result )
+    {
+        msg_Err( m_access, "browse() response parsing failed" );
+        return -1;
+    }
 
-        StartingIndex = std::to_string(  std::stol(psz_NumberReturned) + std::stol(StartingIndex) );
-        l_reqCount = std::stol(psz_TotalMatches) - std::stol(StartingIndex) ;
-        RequestedCount = std::to_string(l_reqCount);
+    *pi_total = strtoul( psz_total, NULL, 10 );
+    long i_returned = strtol( psz_returned, NULL, 10 );
 
-        IXML_Document* p_result = parseBrowseResult( p_response );
+    addResult( p_result );
+    ixmlDocument_free( p_result );
 
-        ixmlDocument_free( p_response );
+    didl.emplace_back( psz_raw_didl );
+    didl_size += didl.back().size();
+    return i_returned > 0 ? i_returned : 0;
+}
 
-        if ( !p_result )
+/*
+ * Fetches and parses the UPNP response
+ *
+ * The first response tells how many children there are and how many the
+ * server sends at once: the rest is then requested in pages of that size,
+ * a few at a time.
+ */
+bool MediaServer::fetchContents()
+{
+    const std::string updateId = getSystemUpdateId();
+    const std::string key = std::string( m_psz_root ) + "\n" +
+                            ( m_psz_objectId ? m_psz_objectId : "0" );
+    std::vector<std::string> didl;
+    size_t didl_size = 0;
+
+    if ( !updateId.empty() && cacheGet( key, updateId, didl ) )
+    {
+        msg_Dbg( m_access, "using cached browse results" );
+        for ( const std::string& raw : didl )
         {
-            msg_Err( m_access, "browse() response parsing failed" );
-            return false;
+            IXML_Document* p_result = parseDidl( raw.c_str() );
+            if ( p_result )
+            {
+                addResult( p_result );
+                ixmlDocument_free( p_result );
+            }
         }
+        return true;
+    }
 
-#ifndef NDEBUG
-        msg_Dbg( m_access, "Got DIDL document: %s", ixmlPrintDocument( p_result ) );
-#endif
+    /* The first response tells how many objects the server sends at once */
+    IXML_Document* p_response;
+    Upnp_i11e_cb* i11eCb = _browseChildren( 0, BROWSE_PAGE_SIZE, &p_response );
+    if ( !i11eCb )
+        return false;
+    /* Wait for the callback to fill p_response or wait for an interrupt */
+    i11eCb->waitAndRelease();
+    if ( !p_response )
+    {
+        msg_Err( m_access, "No response from browse() action" );
+        return false;
+    }
+
+    unsigned long i_total;
+    long i_returned = addResponse( p_response, &i_total, didl, didl_size );
+    ixmlDocument_free( p_response );
+    if ( i_returned < 0 )
+        return false;
 
-        IXML_NodeList* containerNodeList =
-        ixmlDocument_getElementsByTagName( p_result, "container" );
+    struct Request
+    {
+        unsigned long i_start;
+        unsigned long i_count;
+        IXML_Document* p_response;
+        Upnp_i11e_cb* i11eCb;
+    };
+    std::list<Request> requests;
+    const unsigned long i_page = i_returned;
+    unsigned long i_next = i_returned;
+    bool b_ok = true;
 
-        if ( containerNodeList )
+    while ( b_ok && i_page > 0 && ( i_next < i_total || !requests.empty() ) )
+    {
+        while ( i_next < i_total && requests.size() < BROWSE_MAX_REQUESTS )
         {
-            for ( unsigned int i = 0; i < ixmlNodeList_length( containerNodeList ); i++)
-                addContainer( (IXML_Element*)ixmlNodeList_item( containerNodeList, i ) );
-            ixmlNodeList_free( containerNodeList );
+            requests.emplace_back();
+            Request& req = requests.back();
+            req.i_start = i_next;
+            req.i_count = std::min( i_page, i_total - i_next );
+            req.i11eCb = _browseChildren( req.i_start, req.i_count, &req.p_response );
+            if ( !req.i11eCb )
+            {
+                requests.pop_back();
+                b_ok = false;
+                break;
+            }
+            i_next += req.i_count;
         }
+        if ( !b_ok || requests.empty() )
+            break;
+
+        requests.front().i11eCb->waitAndRelease();
+        Request req = requests.front();
+        requests.pop_front();
 
-        IXML_NodeList* itemNodeList = ixmlDocument_getElementsByTagName( p_result,
-                                                                        "item" );
-        if ( itemNodeList )
+        p_response = req.p_response;
+        while ( b_ok )
         {
-            for ( unsigned int i = 0; i < ixmlNodeList_length( itemNodeList ); i++)
-                addItem( (IXML_Element*)ixmlNodeList_item( itemNodeList, i ) );
-            ixmlNodeList_free( itemNodeList );
+            if ( !p_response )
+            {
+                msg_Err( m_access, "No response from browse() action" );
+                b_ok = false;
+                break;
+            }
+
+            unsigned long i_unused;
+            i_returned = addResponse( p_response, &i_unused, didl, didl_size );
+            ixmlDocument_free( p_response );
+            if ( i_returned < 0 )
+                b_ok = false;
+            else if ( i_returned == 0 )
+                i_total = i_next; /* nothing more, don't ask for more pages */
+            if ( i_returned <= 0 || (unsigned long)i_returned >= req.i_count )
+                break;
+
+            /* The server sent less than asked, get the rest of this page
+             * before the next ones to keep the order */
+            req.i_start += i_returned;
+            req.i_count -= i_returned;
+            i11eCb = _browseChildren( req.i_start, req.i_count, &p_response );
+            if ( !i11eCb )
+            {
+                b_ok = false;
+                break;
+            }
+            i11eCb->waitAndRelease();
         }
+    }
 
-        ixmlDocument_free( p_result );
+    /* Release the pending requests on error */
+    for ( Request& req : requests )
+    {
+        req.i11eCb->waitAndRelease();
+        if ( req.p_response )
+            ixmlDocument_free( req.p_response );
     }
-    while( l_reqCount );
-    return true;
+
+    if ( b_ok && !updateId.empty() )
+        cachePut( key, updateId, didl, didl_size );
+    return b_ok;
 }
 
 static int ReadDirectory( stream_t *p_access, input_item_node_t* p_node )
@@ -112,8 +112,16 @@ private:
     bool addContainer( IXML_Element* containerElement );
     bool addItem( IXML_Element* itemElement );
 
-    IXML_Document* _browseAction(const char*, const char*, const char*,
+    void addResult( IXML_Document* p_result );
+    long addResponse( IXML_Document* p_response, unsigned long* pi_total,
+                      std::vector<std::string>& didl, size_t& didl_size );
+
+    IXML_Document* _browseActionNew(const char*, const char*, const char*,
             const char*, const char*, const char* );
+    Upnp_i11e_cb* _browseChildren( unsigned long i_start, unsigned long i_count,
+                                   IXML_Document** pp_response );
+    Upnp_i11e_cb* _sendAction( IXML_Document* p_action, IXML_Document** pp_response );
+    std::string getSystemUpdateId();
     static int sendActionCb( Upnp_EventType, UpnpEventPtr, void *);
 
 private:
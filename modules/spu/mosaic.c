@@ -54,6 +54,25 @@ static int MosaicCallback   ( vlc_object_t *, char const *, vlc_value_t,
 /*****************************************************************************
  * filter_sys_t : filter descriptor
  *****************************************************************************/
+typedef struct
+{
+    picture_t *p_source;      /* Bridged picture the tile was scaled from */
+    picture_t *p_converted;   /* Scaled picture */
+    vlc_fourcc_t i_chroma;    /* Requested format of the scaled picture */
+    unsigned i_width, i_height;
+    bool b_used;              /* Displayed by the current Filter() call */
+} mosaic_tile_t;
+
+typedef struct
+{
+    picture_t *p_picture;     /* Held bridged picture */
+    int i_es;                 /* Index of the input in the bridge */
+    int i_real_index;
+    int i_alpha;
+    int i_x;
+    int i_y;
+} mosaic_input_t;
+
 typedef struct
 {
     vlc_mutex_t lock;         /* Internal filter lock */
@@ -78,6 +97,9 @@ typedef struct
     int i_offsets_length;
 
     vlc_tick_t i_delay;
+
+    mosaic_tile_t *p_tiles;   /* Last scaled picture of each bridged input */
+    int i_tiles;
 } filter_sys_t;
 
 /*****************************************************************************
@@ -293,6 +315,9 @@ static int CreateFilter( filter_t *p_filter )
     vlc_mutex_init( &p_sys->lock );
     vlc_mutex_lock( &p_sys->lock );
 
+    p_sys->p_tiles = NULL;
+    p_sys->i_tiles = 0;
+
     config_ChainParse( p_filter, CFG_PREFIX, ppsz_filter_options,
                        p_filter->p_cfg );
 
@@ -375,6 +400,61 @@ static int CreateFilter( filter_t *p_filter )
 /*****************************************************************************
  * DestroyFilter: destroy mosaic video filter
  *****************************************************************************/
+static void ReleaseTile( mosaic_tile_t *p_tile )
+{
+    if( p_tile->p_source )
+        picture_Release( p_tile->p_source );
+    if( p_tile->p_converted )
+        picture_Release( p_tile->p_converted );
+    p_tile->p_source = p_tile->p_converted = NULL;
+}
+
+/**
+ * Scale the picture of a bridged input, or return the previous scaled
+ * picture if the input did not provide a new one since
+ */
+static picture_t *GetTile( filter_t *p_filter, int i_es, picture_t *p_pic,
+                           const video_format_t *p_fmt_in,
+                           video_format_t *p_fmt_out )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    if( i_es >= p_sys->i_tiles )
+    {
+        mosaic_tile_t *p_tiles = realloc( p_sys->p_tiles,
+                                          (i_es + 1) * sizeof(*p_tiles) );
+        if( p_tiles == NULL )
+            return image_Convert( p_sys->p_image, p_pic, p_fmt_in, p_fmt_out );
+        memset( &p_tiles[p_sys->i_tiles], 0,
+                (i_es + 1 - p_sys->i_tiles) * sizeof(*p_tiles) );
+        p_sys->p_tiles = p_tiles;
+        p_sys->i_tiles = i_es + 1;
+    }
+
+    mosaic_tile_t *p_tile = &p_sys->p_tiles[i_es];
+    p_tile->b_used = true;
+
+    if( p_tile->p_source == p_pic
+     && p_tile->i_chroma == p_fmt_out->i_chroma
+     && p_tile->i_width == p_fmt_out->i_width
+     && p_tile->i_height == p_fmt_out->i_height )
+        return picture_Hold( p_tile->p_converted );
+
+    ReleaseTile( p_tile );
+
+    picture_t *p_converted = image_Convert( p_sys->p_image, p_pic,
+                                            p_fmt_in, p_fmt_out );
+    if( p_converted == NULL )
+        return NULL;
+
+    p_tile->p_source = picture_Hold( p_pic );
+    p_tile->p_converted = picture_Hold( p_converted );
+    p_tile->i_chroma = p_fmt_out->i_chroma;
+    p_tile->i_width = p_fmt_out->i_width;
+    p_tile->i_height = p_fmt_out->i_height;
+    return p_converted;
+}
+
 static void DestroyFilter( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
@@ -420,6 +500,10 @@ static void DestroyFilter( filter_t *p_filter )
         p_sys->i_offsets_length = 0;
     }
 
+    for( int i = 0; i < p_sys->i_tiles; i++ )
+        ReleaseTile( &p_sys->p_tiles[i] );
+    free( p_sys->p_tiles );
+
     free( p_sys );
 }
 
@@ -517,13 +601,24 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
     row_inner_height = ( ( p_sys->i_height - ( p_sys->i_rows - 1 )
                        * p_sys->i_borderh ) / p_sys->i_rows );
 
+    /* Only pick the current picture of each input under the bridge lock, so
+     * that the bridges are not blocked while the pictures are scaled */
+    mosaic_input_t *p_inputs = vlc_alloc( p_bridge->i_es_num,
+                                          sizeof(*p_inputs) );
+    int i_inputs = 0;
+    if( unlikely(p_inputs == NULL && p_bridge->i_es_num > 0) )
+    {
+        vlc_global_unlock( VLC_MOSAIC_MUTEX );
+        vlc_mutex_unlock( &p_sys->lock );
+        subpicture_Delete( p_spu );
+        return NULL;
+    }
+
     i_real_index = 0;
 
     for( int i_index = 0; i_index < p_bridge->i_es_num; i_index++ )
     {
         bridged_es_t *p_es = p_bridge->pp_es[i_index];
-        video_format_t fmt_in, fmt_out;
-        picture_t *p_converted;
 
         if ( p_es->b_empty )
             continue;
@@ -582,13 +677,36 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
             if ( i == p_sys->i_order_length )
                 i_real_index = ++i_greatest_real_index_used;
         }
+
+        mosaic_input_t *p_input = &p_inputs[i_inputs++];
+        p_input->p_picture =
+            picture_Hold( vlc_picture_chain_PeekFront( &p_es->pictures ) );
+        p_input->i_es = i_index;
+        p_input->i_real_index = i_real_index;
+        p_input->i_alpha = p_es->i_alpha;
+        p_input->i_x = p_es->i_x;
+        p_input->i_y = p_es->i_y;
+    }
+
+    vlc_global_unlock( VLC_MOSAIC_MUTEX );
+
+    for( int i = 0; i < p_sys->i_tiles; i++ )
+        p_sys->p_tiles[i].b_used = false;
+
+    for( int i_input = 0; i_input < i_inputs; i_input++ )
+    {
+        const mosaic_input_t *p_input = &p_inputs[i_input];
+        video_format_t fmt_in, fmt_out;
+        picture_t *p_converted;
+
+        i_real_index = p_input->i_real_index;
         i_row = ( i_real_index / p_sys->i_cols ) % p_sys->i_rows;
         i_col = i_real_index % p_sys->i_cols ;
 
         video_format_Init( &fmt_in, 0 );
         video_format_Init( &fmt_out, 0 );
 
-        p_converted = vlc_picture_chain_PeekFront( &p_es->pictures );
+        p_converted = p_input->p_picture;
         if ( !p_sys->b_keep )
         {
             /* Convert the images */
@@ -622,8 +740,8 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
             fmt_out.i_visible_width = fmt_out.i_width;
             fmt_out.i_visible_height = fmt_out.i_height;
 
-            p_converted = image_Convert( p_sys->p_image, p_converted,
-                                         &fmt_in, &fmt_out );
+            p_converted = GetTile( p_filter, p_input->i_es, p_converted,
+                                   &fmt_in, &fmt_out );
             if( !p_converted )
             {
                 msg_Warn( p_filter,
@@ -655,15 +773,14 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
             video_format_Clean( &fmt_out );
             msg_Err( p_filter, "cannot allocate SPU region" );
             subpicture_Delete( p_spu );
-            vlc_global_unlock( VLC_MOSAIC_MUTEX );
-            vlc_mutex_unlock( &p_sys->lock );
-            return NULL;
+            p_spu = NULL;
+            break;
         }
 
-        if( p_es->i_x >= 0 && p_es->i_y >= 0 )
+        if( p_input->i_x >= 0 && p_input->i_y >= 0 )
         {
-            p_region->i_x = p_es->i_x;
-            p_region->i_y = p_es->i_y;
+            p_region->i_x = p_input->i_x;
+            p_region->i_y = p_input->i_y;
         }
         else if( p_sys->i_position == position_offsets )
         {
@@ -709,7 +826,7 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
             }
         }
         p_region->i_align = p_sys->i_align;
-        p_region->i_alpha = p_es->i_alpha;
+        p_region->i_alpha = p_input->i_alpha;
 
         if( p_region_prev == NULL )
         {
@@ -726,7 +843,15 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
         p_region_prev = p_region;
     }
 
-    vlc_global_unlock( VLC_MOSAIC_MUTEX );
+    /* Drop the tiles of the inputs that are gone or not displayed anymore */
+    for( int i = 0; i < p_sys->i_tiles; i++ )
+        if( !p_sys->p_tiles[i].b_used )
+            ReleaseTile( &p_sys->p_tiles[i] );
+
+    for( int i_input = 0; i_input < i_inputs; i_input++ )
+        picture_Release( p_inputs[i_input].p_picture );
+    free( p_inputs );
+
     vlc_mutex_unlock( &p_sys->lock );
 
     return p_spu;
@@ -30,6 +30,8 @@
 #include <vlc_stream_extractor.h>
 #include <vlc_dialog.h>
 #include <vlc_input_item.h>
+#include <vlc_arrays.h>
+#include <vlc_list.h>
 
 #include <assert.h>
 #include <archive.h>
@@ -74,11 +76,22 @@ struct private_sys_t
     bool b_eof;
 
     uint64_t i_offset;
+    int64_t i_entry_size;  /* -1 if unknown */
+    int64_t i_data_offset; /* position of a stored entry in the source or -1 */
+
+    const uint8_t* p_block; /* data block returned by libarchive */
+    size_t i_block;
+    uint64_t i_block_offset;
 
     uint8_t buffer[ 8192 ];
+    int64_t i_buffer_pos;  /* position of the buffer in the source or -1 */
+    size_t i_buffer_len;
     bool b_seekable_source;
     bool b_seekable_archive;
 
+    bool b_indexed;
+    uint64_t i_source_size;
+
     libarchive_callback_t** pp_callback_data;
     size_t i_callback_data;
 };
@@ -91,6 +104,195 @@ struct libarchive_callback_t {
 
 /* ------------------------------------------------------------------------- */
 
+/* Entries of the recently opened archives, so that re-opening an entry does
+ * not scan the archive again, and stored entries are read directly from the
+ * source instead of going through libarchive. */
+
+#define ARCHIVE_INDEX_MAX 16
+
+typedef struct archive_index_t archive_index_t;
+
+struct archive_index_t
+{
+    struct vlc_list node;
+    char* psz_url;
+    uint64_t i_source_size;
+    bool b_complete; /* every entry of the archive has been seen */
+    vlc_dictionary_t entries;
+};
+
+typedef struct
+{
+    int64_t i_size;        /* -1 if unknown */
+    int64_t i_data_offset; /* position of a stored entry in the source or -1 */
+} archive_index_entry_t;
+
+static vlc_mutex_t index_lock = VLC_STATIC_MUTEX;
+static struct vlc_list index_list = VLC_LIST_INITIALIZER( &index_list );
+static size_t index_count;
+
+static void archive_index_entry_free( void* p_data, void* p_obj )
+{
+    VLC_UNUSED( p_obj );
+    free( p_data );
+}
+
+static void archive_index_delete( archive_index_t* p_index )
+{
+    vlc_list_remove( &p_index->node );
+    vlc_dictionary_clear( &p_index->entries, archive_index_entry_free, NULL );
+    free( p_index->psz_url );
+    free( p_index );
+    index_count--;
+}
+
+#ifdef __has_attribute
+  #if __has_attribute(destructor)
+__attribute__((destructor)) static void archive_index_destructor( void )
+{
+    archive_index_t* p_index;
+
+    vlc_list_foreach( p_index, &index_list, node )
+        archive_index_delete( p_index );
+}
+  #endif
+#endif
+
+/* must be called with index_lock held */
+static archive_index_t* archive_index_get( private_sys_t* p_sys, bool b_create )
+{
+    archive_index_t* p_index;
+
+    vlc_list_foreach( p_index, &index_list, node )
+    {
+        if( strcmp( p_index->psz_url, p_sys->source->psz_url ) )
+            continue;
+
+        if( p_index->i_source_size != p_sys->i_source_size )
+        {   /* the archive has changed */
+            archive_index_delete( p_index );
+            break;
+        }
+
+        /* keep the most recently used first */
+        vlc_list_remove( &p_index->node );
+        vlc_list_prepend( &p_index->node, &index_list );
+        return p_index;
+    }
+
+    if( !b_create )
+        return NULL;
+
+    if( index_count >= ARCHIVE_INDEX_MAX )
+        archive_index_delete( vlc_list_last_entry_or_null( &index_list,
+                                                           archive_index_t,
+                                                           node ) );
+
+    p_index = malloc( sizeof( *p_index ) );
+
+    if( unlikely( !p_index ) )
+        return NULL;
+
+    p_index->psz_url = strdup( p_sys->source->psz_url );
+
+    if( unlikely( !p_index->psz_url ) )
+    {
+        free( p_index );
+        return NULL;
+    }
+
+    p_index->i_source_size = p_sys->i_source_size;
+    p_index->b_complete = false;
+    vlc_dictionary_init( &p_index->entries, 0 );
+    vlc_list_prepend( &p_index->node, &index_list );
+    index_count++;
+
+    return p_index;
+}
+
+static void archive_index_update( private_sys_t* p_sys, char const* psz_path,
+  int64_t i_size, int64_t i_data_offset )
+{
+    if( !p_sys->b_indexed )
+        return;
+
+    vlc_mutex_lock( &index_lock );
+
+    archive_index_t* p_index = archive_index_get( p_sys, true );
+
+    if( p_index )
+    {
+        archive_index_entry_t* p_entry =
+            vlc_dictionary_value_for_key( &p_index->entries, psz_path );
+
+        if( p_entry == NULL )
+        {
+            p_entry = malloc( sizeof( *p_entry ) );
+
+            if( likely( p_entry ) )
+            {
+                p_entry->i_size = i_size;
+                p_entry->i_data_offset = i_data_offset;
+                vlc_dictionary_insert( &p_index->entries, psz_path, p_entry );
+            }
+        }
+        else if( p_entry->i_size == i_size && i_data_offset >= 0 )
+        {   /* the first entry of a given name is the one opened */
+            p_entry->i_data_offset = i_data_offset;
+        }
+    }
+
+    vlc_mutex_unlock( &index_lock );
+}
+
+static void archive_index_complete( private_sys_t* p_sys )
+{
+    if( !p_sys->b_indexed )
+        return;
+
+    vlc_mutex_lock( &index_lock );
+
+    archive_index_t* p_index = archive_index_get( p_sys, false );
+
+    if( p_index )
+        p_index->b_complete = true;
+
+    vlc_mutex_unlock( &index_lock );
+}
+
+/* Returns VLC_ENOENT if the archive is known not to contain the entry */
+static int archive_index_find( private_sys_t* p_sys, char const* psz_path,
+  archive_index_entry_t* p_result )
+{
+    int i_ret = VLC_EGENERIC;
+
+    if( !p_sys->b_indexed )
+        return i_ret;
+
+    vlc_mutex_lock( &index_lock );
+
+    archive_index_t* p_index = archive_index_get( p_sys, false );
+
+    if( p_index )
+    {
+        archive_index_entry_t* p_entry =
+            vlc_dictionary_value_for_key( &p_index->entries, psz_path );
+
+        if( p_entry )
+        {
+            *p_result = *p_entry;
+            i_ret = VLC_SUCCESS;
+        }
+        else if( p_index->b_complete )
+            i_ret = VLC_ENOENT;
+    }
+
+    vlc_mutex_unlock( &index_lock );
+    return i_ret;
+}
+
+/* ------------------------------------------------------------------------- */
+
 static int libarchive_exit_cb( libarchive_t* p_arc, void* p_obj )
 {
     VLC_UNUSED( p_arc );
@@ -187,6 +389,11 @@ static la_ssize_t libarchive_read_cb( libarchive_t* p_arc, void* p_obj,
     stream_t*  p_source = p_cb->p_source;
     private_sys_t* p_sys = p_cb->p_sys;
 
+    /* remember where the data comes from, to locate stored entries */
+    p_sys->i_buffer_pos = p_source == p_sys->source
+                        ? (int64_t)vlc_stream_Tell( p_source ) : -1;
+    p_sys->i_buffer_len = 0;
+
     ssize_t i_ret = vlc_stream_Read( p_source, &p_sys->buffer,
       sizeof( p_sys->buffer ) );
 
@@ -198,6 +405,7 @@ static la_ssize_t libarchive_read_cb( libarchive_t* p_arc, void* p_obj,
         return ARCHIVE_FATAL;
     }
 
+    p_sys->i_buffer_len = i_ret;
     *pp_dst = &p_sys->buffer;
     return i_ret;
 }
@@ -329,10 +537,109 @@ static int archive_clean( private_sys_t* p_sys )
 
     p_sys->p_entry   = NULL;
     p_sys->p_archive = NULL;
+    p_sys->p_block   = NULL;
+    p_sys->i_block   = 0;
+    p_sys->i_block_offset = 0;
 
     return VLC_SUCCESS;
 }
 
+static int archive_read_block( private_sys_t* p_sys )
+{
+    libarchive_t* p_arc = p_sys->p_archive;
+    const void* p_block;
+    la_int64_t i_offset;
+
+    int i_ret = archive_read_data_block( p_arc, &p_block, &p_sys->i_block,
+                                         &i_offset );
+    switch( i_ret )
+    {
+        case ARCHIVE_OK:
+            p_sys->p_block = p_block;
+            p_sys->i_block_offset = i_offset;
+            return VLC_SUCCESS;
+
+        case ARCHIVE_EOF:
+            break;
+
+        case ARCHIVE_RETRY:
+        case ARCHIVE_FAILED:
+            msg_Dbg( p_sys->p_obj, "libarchive: %s", archive_error_string( p_arc ) );
+            break;
+
+        case ARCHIVE_WARN:
+            msg_Warn( p_sys->p_obj, "libarchive: %s", archive_error_string( p_arc ) );
+            break;
+
+        default:
+            msg_Err( p_sys->p_obj, "libarchive: %s", archive_error_string( p_arc ) );
+            p_sys->b_dead = true;
+            break;
+    }
+
+    p_sys->i_block = 0;
+    p_sys->b_eof = true;
+    return VLC_EGENERIC;
+}
+
+static void archive_consume_block( private_sys_t* p_sys, size_t i_size )
+{
+    p_sys->p_block += i_size;
+    p_sys->i_block -= i_size;
+    p_sys->i_block_offset += i_size;
+}
+
+/* Locates the data of a stored entry in the source: libarchive hands out
+ * such data straight from the buffer filled by libarchive_read_cb. The first
+ * block is kept for Read(). */
+static void archive_probe_entry( private_sys_t* p_sys )
+{
+    p_sys->i_data_offset = -1;
+
+    if( p_sys->i_entry_size <= 0 || !p_sys->b_seekable_source
+     || p_sys->i_callback_data != 1
+     || archive_filter_count( p_sys->p_archive ) != 1
+     || archive_entry_sparse_count( p_sys->p_entry ) != 0 )
+        return;
+
+    /* formats storing the data of an entry in one contiguous chunk */
+    switch( archive_format( p_sys->p_archive ) & ARCHIVE_FORMAT_BASE_MASK )
+    {
+        case ARCHIVE_FORMAT_TAR:
+        case ARCHIVE_FORMAT_ZIP:
+        case ARCHIVE_FORMAT_CPIO:
+        case ARCHIVE_FORMAT_RAR:
+#ifdef ARCHIVE_FORMAT_RAR_V5
+        case ARCHIVE_FORMAT_RAR_V5:
+#endif
+            break;
+        default:
+            return;
+    }
+
+    if( archive_read_block( p_sys ) || p_sys->i_buffer_pos < 0 )
+        return;
+
+    uintptr_t i_block = (uintptr_t)p_sys->p_block;
+    uintptr_t i_buffer = (uintptr_t)p_sys->buffer;
+
+    if( i_block < i_buffer
+     || i_block + p_sys->i_block > i_buffer + p_sys->i_buffer_len )
+        return; /* decompressed or copied by libarchive */
+
+    int64_t i_data_offset = p_sys->i_buffer_pos + ( i_block - i_buffer )
+                          - p_sys->i_block_offset;
+    uint64_t i_source_size;
+
+    if( i_data_offset < 0
+     || vlc_stream_GetSize( p_sys->source, &i_source_size )
+     || (uint64_t)i_data_offset + p_sys->i_entry_size > i_source_size )
+        return;
+
+    msg_Dbg( p_sys->p_obj, "stored entry at offset %"PRId64, i_data_offset );
+    p_sys->i_data_offset = i_data_offset;
+}
+
 static int archive_seek_subentry( private_sys_t* p_sys, char const* psz_subentry )
 {
     libarchive_t* p_arc = p_sys->p_archive;
@@ -344,6 +651,9 @@ static int archive_seek_subentry( private_sys_t* p_sys, char const* psz_subentry
     {
         char const* entry_path = archive_entry_pathname( entry );
 
+        if( unlikely( !entry_path ) )
+            continue;
+
         if( strcmp( entry_path, psz_subentry ) == 0 )
         {
             p_sys->p_entry = archive_entry_clone( entry );
@@ -354,6 +664,9 @@ static int archive_seek_subentry( private_sys_t* p_sys, char const* psz_subentry
             break;
         }
 
+        archive_index_update( p_sys, entry_path,
+          archive_entry_size_is_set( entry ) ? archive_entry_size( entry ) : -1,
+          -1 );
         archive_read_data_skip( p_arc );
     }
 
@@ -363,9 +676,11 @@ static int archive_seek_subentry( private_sys_t* p_sys, char const* psz_subentry
             msg_Warn( p_sys->p_obj,
               "libarchive: %s", archive_error_string( p_arc ) );
             /* fall through */
-        case ARCHIVE_EOF:
         case ARCHIVE_FATAL:
         case ARCHIVE_RETRY:
+            if( archive_status == ARCHIVE_EOF )
+                archive_index_complete( p_sys );
+
             archive_set_error( p_arc, ARCHIVE_FATAL,
                 "archive does not contain >>> %s <<<", psz_subentry );
 
@@ -380,6 +695,13 @@ static int archive_seek_subentry( private_sys_t* p_sys, char const* psz_subentry
             p_sys->b_seekable_archive = true;
     }
 
+    p_sys->i_entry_size = archive_entry_size_is_set( p_sys->p_entry )
+                        ? archive_entry_size( p_sys->p_entry ) : -1;
+
+    archive_probe_entry( p_sys );
+    archive_index_update( p_sys, psz_subentry, p_sys->i_entry_size,
+                          p_sys->i_data_offset );
+
     return VLC_SUCCESS;
 }
 
@@ -433,6 +755,13 @@ static private_sys_t* setup( vlc_object_t* obj, stream_t* source )
 
     p_sys->source = source;
     p_sys->p_obj = obj;
+    p_sys->i_entry_size = -1;
+    p_sys->i_data_offset = -1;
+    p_sys->i_buffer_pos = -1;
+
+    /* concatenated volumes are not indexed */
+    p_sys->b_indexed = source->psz_url != NULL && p_sys->i_callback_data == 1
+                    && !vlc_stream_GetSize( source, &p_sys->i_source_size );
 
     return p_sys;
 
@@ -497,6 +826,9 @@ static int Control( stream_extractor_t* p_extractor, int i_query, va_list args )
     switch( i_query )
     {
         case STREAM_CAN_FASTSEEK:
+            if( p_sys->i_data_offset >= 0 )
+                return vlc_stream_vaControl( p_extractor->source, i_query, args );
+
             *va_arg( args, bool* ) = false;
             break;
 
@@ -505,13 +837,10 @@ static int Control( stream_extractor_t* p_extractor, int i_query, va_list args )
             break;
 
         case STREAM_GET_SIZE:
-            if( p_sys->p_entry == NULL )
+            if( p_sys->i_entry_size < 0 )
                 return VLC_EGENERIC;
 
-            if( !archive_entry_size_is_set( p_sys->p_entry ) )
-                return VLC_EGENERIC;
-
-            *va_arg( args, uint64_t* ) = archive_entry_size( p_sys->p_entry );
+            *va_arg( args, uint64_t* ) = p_sys->i_entry_size;
             break;
 
         default:
@@ -541,6 +870,10 @@ static int ReadDir( stream_directory_t* p_directory, input_item_node_t* p_node )
         if( unlikely( !path ) )
             break;
 
+        archive_index_update( p_sys, path,
+          archive_entry_size_is_set( entry ) ? archive_entry_size( entry ) : -1,
+          -1 );
+
         char*       mrl  = vlc_stream_extractor_CreateMRL( p_directory, path );
 
         if( unlikely( !mrl ) )
@@ -569,52 +902,84 @@ static int ReadDir( stream_directory_t* p_directory, input_item_node_t* p_node )
             break;
     }
 
+    if( archive_status == ARCHIVE_EOF )
+        archive_index_complete( p_sys );
+
     vlc_readdir_helper_finish( &rdh, archive_status == ARCHIVE_EOF );
     return archive_status == ARCHIVE_EOF ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
-static ssize_t Read( stream_extractor_t *p_extractor, void* p_data, size_t i_size )
+static ssize_t ReadStored( stream_extractor_t *p_extractor, void* p_data,
+  size_t i_size )
 {
-    char dummy_buffer[ 8192 ];
-
     private_sys_t* p_sys = p_extractor->p_sys;
-    libarchive_t* p_arc = p_sys->p_archive;
-    ssize_t       i_ret;
+    stream_t* p_source = p_extractor->source;
 
-    if( p_sys->b_dead || p_sys->p_entry == NULL )
+    if( p_sys->i_offset >= (uint64_t)p_sys->i_entry_size )
         return 0;
 
-    if( p_sys->b_eof )
-        return 0;
+    i_size = __MIN( i_size, p_sys->i_entry_size - p_sys->i_offset );
 
-    i_ret = archive_read_data( p_arc,
-      p_data ? p_data :                        dummy_buffer,
-      p_data ? i_size : __MIN( i_size, sizeof( dummy_buffer ) ) );
+    uint64_t i_pos = p_sys->i_data_offset + p_sys->i_offset;
 
-    switch( i_ret )
-    {
-        case ARCHIVE_RETRY:
-        case ARCHIVE_FAILED:
-            msg_Dbg( p_extractor, "libarchive: %s", archive_error_string( p_arc ) );
-            goto eof;
+    if( vlc_stream_Tell( p_source ) != i_pos
+     && vlc_stream_Seek( p_source, i_pos ) )
+        return 0;
 
-        case ARCHIVE_WARN:
-            msg_Warn( p_extractor, "libarchive: %s", archive_error_string( p_arc ) );
-            goto eof;
+    ssize_t i_ret = vlc_stream_Read( p_source, p_data, i_size );
 
-        case ARCHIVE_FATAL:
-            msg_Err( p_extractor, "libarchive: %s", archive_error_string( p_arc ) );
-            goto fatal_error;
-    }
+    if( i_ret <= 0 )
+        return 0;
 
     p_sys->i_offset += i_ret;
     return i_ret;
+}
 
-fatal_error:
-    p_sys->b_dead = true;
+static ssize_t Read( stream_extractor_t *p_extractor, void* p_data, size_t i_size )
+{
+    private_sys_t* p_sys = p_extractor->p_sys;
+
+    if( p_sys->i_data_offset >= 0 )
+        return ReadStored( p_extractor, p_data, i_size );
+
+    if( p_sys->b_dead || p_sys->p_entry == NULL )
+        return 0;
+
+    while( !p_sys->b_eof )
+    {
+        if( p_sys->i_block_offset > p_sys->i_offset )
+        {   /* hole in a sparse entry */
+            i_size = __MIN( i_size, p_sys->i_block_offset - p_sys->i_offset );
+
+            if( p_data )
+                memset( p_data, 0, i_size );
+
+            p_sys->i_offset += i_size;
+            return i_size;
+        }
+
+        /* drop the data before the current offset, after a seek */
+        archive_consume_block( p_sys, __MIN( p_sys->i_block,
+          p_sys->i_offset - p_sys->i_block_offset ) );
+
+        if( p_sys->i_block == 0 )
+        {
+            if( archive_read_block( p_sys ) )
+                break;
+
+            continue;
+        }
+
+        i_size = __MIN( i_size, p_sys->i_block );
+
+        if( p_data )
+            memcpy( p_data, p_sys->p_block, i_size );
+
+        archive_consume_block( p_sys, i_size );
+        p_sys->i_offset += i_size;
+        return i_size;
+    }
 
-eof:
-    p_sys->b_eof = true;
     return 0;
 }
 
@@ -637,11 +1002,16 @@ static int Seek( stream_extractor_t* p_extractor, uint64_t i_req )
 {
     private_sys_t* p_sys = p_extractor->p_sys;
 
+    if( p_sys->i_data_offset >= 0 )
+    {   /* stored entry, see ReadStored() */
+        p_sys->i_offset = i_req;
+        return VLC_SUCCESS;
+    }
+
     if( !p_sys->p_entry || !p_sys->b_seekable_source )
         return VLC_EGENERIC;
 
-    if( archive_entry_size_is_set( p_sys->p_entry ) &&
-        (uint64_t)archive_entry_size( p_sys->p_entry ) <= i_req )
+    if( p_sys->i_entry_size >= 0 && (uint64_t)p_sys->i_entry_size <= i_req )
     {
         p_sys->b_eof = true;
         return VLC_SUCCESS;
@@ -674,6 +1044,11 @@ static int Seek( stream_extractor_t* p_extractor, uint64_t i_req )
         if( archive_skip_decompressed( p_extractor, i_skip ) )
             msg_Dbg( p_extractor, "failed to skip to seek position" );
     }
+    else
+    {
+        p_sys->i_block = 0;
+        p_sys->i_block_offset = i_req;
+    }
 
     p_sys->i_offset = i_req;
     return VLC_SUCCESS;
@@ -712,18 +1087,7 @@ static private_sys_t* CommonOpen( vlc_object_t* p_obj, stream_t* source  )
     if( probe( source ) )
         return NULL;
 
-    private_sys_t* p_sys = setup( p_obj, source );
-
-    if( p_sys == NULL )
-        return NULL;
-
-    if( archive_init( p_sys, source ) )
-    {
-        CommonClose( p_sys );
-        return NULL;
-    }
-
-    return p_sys;
+    return setup( p_obj, source );
 }
 
 static int DirectoryOpen( vlc_object_t* p_obj )
@@ -734,6 +1098,12 @@ static int DirectoryOpen( vlc_object_t* p_obj )
     if( p_sys == NULL )
         return VLC_EGENERIC;
 
+    if( archive_init( p_sys, p_directory->source ) )
+    {
+        CommonClose( p_sys );
+        return VLC_EGENERIC;
+    }
+
     p_directory->p_sys = p_sys;
     p_directory->pf_readdir = ReadDir;
 
@@ -748,10 +1118,37 @@ static int ExtractorOpen( vlc_object_t* p_obj )
     if( p_sys == NULL )
         return VLC_EGENERIC;
 
-    if( archive_seek_subentry( p_sys, p_extractor->identifier ) )
+    archive_index_entry_t entry;
+    bool b_seekable;
+
+    switch( archive_index_find( p_sys, p_extractor->identifier, &entry ) )
     {
-        CommonClose( p_sys );
-        return VLC_EGENERIC;
+        case VLC_ENOENT:
+            msg_Dbg( p_obj, "archive does not contain >>> %s <<<",
+                     p_extractor->identifier );
+            CommonClose( p_sys );
+            return VLC_EGENERIC;
+
+        case VLC_SUCCESS:
+            /* stored entry seen before, no need for libarchive */
+            if( entry.i_data_offset >= 0
+             && !vlc_stream_Control( p_extractor->source, STREAM_CAN_SEEK,
+                                     &b_seekable ) && b_seekable )
+            {
+                p_sys->b_seekable_source = true;
+                p_sys->i_entry_size = entry.i_size;
+                p_sys->i_data_offset = entry.i_data_offset;
+                break;
+            }
+            /* fall through */
+        default:
+            if( archive_init( p_sys, p_extractor->source )
+             || archive_seek_subentry( p_sys, p_extractor->identifier ) )
+            {
+                CommonClose( p_sys );
+                return VLC_EGENERIC;
+            }
+            break;
     }
 
     p_extractor->p_sys = p_sys;
@@ -95,6 +95,15 @@ static ssize_t Read( stream_t *s, void *buffer, size_t i_read )
     return vlc_stream_Read( s->s, buffer, i_read );
 }
 
+static block_t *ReadBlock( stream_t *s, bool *restrict eof )
+{
+    block_t *block = vlc_stream_ReadBlock( s->s );
+
+    if( block == NULL )
+        *eof = vlc_stream_Eof( s->s );
+    return block;
+}
+
 static int Seek( stream_t *s, uint64_t offset )
 {
     stream_sys_t *p_sys = s->p_sys;
@@ -140,7 +149,10 @@ static int Open( vlc_object_t *p_object )
         return VLC_EGENERIC;
 
     p_stream->p_sys = p_sys;
-    p_stream->pf_read = Read;
+    if (p_stream->s->pf_block != NULL)
+        p_stream->pf_block = ReadBlock;
+    else
+        p_stream->pf_read = Read;
     p_stream->pf_seek = p_sys->b_seek ? Seek : NULL;
     p_stream->pf_control = Control;
 
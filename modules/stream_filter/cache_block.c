@@ -67,6 +67,7 @@
 typedef struct
 {
     block_bytestream_t cache; /* bytestream chain for storing cache */
+    uint64_t offset; /* stream offset of the cache read pointer */
 
     struct
     {
@@ -174,6 +175,7 @@ static void AStreamControlReset(stream_t *s)
     stream_sys_t *sys = s->p_sys;
 
     block_BytestreamEmpty( &sys->cache );
+    sys->offset = vlc_stream_Tell(s->s);
 
     /* Do the prebuffering */
     AStreamPrebufferBlock(s);
@@ -183,14 +185,19 @@ static int AStreamSeekBlock(stream_t *s, uint64_t i_pos)
 {
     stream_sys_t *sys = s->p_sys;
 
-    if( block_SkipBytes( &sys->cache, i_pos) == VLC_SUCCESS )
+    if( i_pos >= sys->offset
+     && block_SkipBytes( &sys->cache, i_pos - sys->offset) == VLC_SUCCESS )
+    {
+        sys->offset = i_pos;
         return VLC_SUCCESS;
+    }
 
     /* Not enough bytes, empty and seek */
     /* Do the access seek */
     if (vlc_stream_Seek(s->s, i_pos)) return VLC_EGENERIC;
 
     block_BytestreamEmpty( &sys->cache );
+    sys->offset = i_pos;
 
     /* Refill a block */
     if (AStreamRefillBlock(s))
@@ -199,36 +206,47 @@ static int AStreamSeekBlock(stream_t *s, uint64_t i_pos)
     return VLC_SUCCESS;
 }
 
-static ssize_t AStreamReadBlock(stream_t *s, void *buf, size_t len)
+static block_t *AStreamReadBlock(stream_t *s, bool *restrict eof)
 {
     stream_sys_t *sys = s->p_sys;
 
-    ssize_t i_current = block_BytestreamRemaining( &sys->cache );
-    size_t i_copy = VLC_CLIP((size_t)i_current, 0, len);
-
     /**
      * we should not signal end-of-file if we have not exhausted
-     * the cache. i_copy == 0 just means that the cache currently does
-     * not contain data at the offset that we want, not EOF.
+     * the cache.
      **/
-    if( i_copy == 0 )
+    if( block_BytestreamRemaining( &sys->cache ) == 0 )
     {
         /* Return EOF if we are unable to refill cache, most likely
          * really EOF */
         if( AStreamRefillBlock(s) == VLC_EGENERIC )
-            return 0;
+        {
+            *eof = true;
+            return NULL;
+        }
+        if( block_BytestreamRemaining( &sys->cache ) == 0 )
+            return NULL;
     }
 
-    /* Copy data */
-    if( block_GetBytes( &sys->cache, buf, i_copy ) )
-        return -1;
+    /* Hand the first unread block over, without copying its data */
+    block_bytestream_t *cache = &sys->cache;
+
+    block_BytestreamFlush( cache );
+
+    block_t *block = cache->p_chain;
+    assert( block != NULL && cache->p_block == block );
 
+    cache->p_chain = cache->p_block = block->p_next;
+    if( cache->p_chain == NULL )
+        cache->pp_last = &cache->p_chain;
+    cache->i_total -= block->i_buffer;
 
-    /* If we ended up on refill, try to read refilled cache */
-    if( i_copy == 0 && sys->cache.p_chain )
-        return AStreamReadBlock( s, buf, len );
+    block->p_next = NULL;
+    block->p_buffer += cache->i_block_offset;
+    block->i_buffer -= cache->i_block_offset;
+    cache->i_block_offset = 0;
 
-    return i_copy;
+    sys->offset += block->i_buffer;
+    return block;
 }
 
 /****************************************************************************
@@ -289,6 +307,7 @@ static int Open(vlc_object_t *obj)
 
     /* Init all fields of sys->block */
     block_BytestreamInit( &sys->cache );
+    sys->offset = vlc_stream_Tell(s->s);
 
     s->p_sys = sys;
     /* Do the prebuffering */
@@ -301,7 +320,7 @@ static int Open(vlc_object_t *obj)
         return VLC_EGENERIC;
     }
 
-    s->pf_read = AStreamReadBlock;
+    s->pf_block = AStreamReadBlock;
     s->pf_seek = AStreamSeekBlock;
     s->pf_control = AStreamControl;
     return VLC_SUCCESS;
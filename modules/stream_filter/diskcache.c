@@ -0,0 +1,535 @@
+/*****************************************************************************
+ * diskcache.c: persistent on-disk cache stream filter
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Remote streams are cached in fixed-size chunks, in one sparse file per
+ * content. The file name is a hash of the URL, of the size and of a validator
+ * (e.g. an HTTP entity tag) of the content, so that a changed content never
+ * hits stale data. A map of the cached chunks is kept next to each data file.
+ * The least recently used entries are deleted to keep the total size capped.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_stream.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_strings.h>
+#include <vlc_sort.h>
+
+#define DISKCACHE_CHUNK (128u << 10)
+#define DISKCACHE_MAGIC "VLCdc001"
+
+struct diskcache_header
+{
+    char magic[8];
+    uint64_t size;
+    uint32_t chunk_size;
+    uint32_t reserved;
+};
+
+typedef struct
+{
+    int      fd; /**< Data file */
+    char    *path; /**< Entry path, without extension */
+    uint64_t size;
+    uint64_t offset; /**< Downstream offset */
+    uint64_t upstream; /**< Upstream offset */
+
+    size_t   chunks;
+    uint8_t *map; /**< Bitmap of the chunks stored in the data file */
+    bool     dirty;
+
+    size_t   buffer_chunk; /**< Chunk held in the buffer (or SIZE_MAX) */
+    size_t   buffer_length;
+    uint8_t  buffer[DISKCACHE_CHUNK];
+} stream_sys_t;
+
+static bool IsCached(const stream_sys_t *sys, size_t chunk)
+{
+    return (sys->map[chunk / 8] >> (chunk % 8)) & 1;
+}
+
+static size_t ChunkLength(const stream_sys_t *sys, size_t chunk)
+{
+    uint64_t start = (uint64_t)chunk * DISKCACHE_CHUNK;
+    uint64_t left = sys->size - start;
+
+    return (left < DISKCACHE_CHUNK) ? left : DISKCACHE_CHUNK;
+}
+
+/**
+ * Fetches a chunk from upstream, and stores it into the data file.
+ */
+static int FetchChunk(stream_t *s, size_t chunk)
+{
+    stream_sys_t *sys = s->p_sys;
+    uint64_t start = (uint64_t)chunk * DISKCACHE_CHUNK;
+    size_t length = ChunkLength(sys, chunk);
+
+    sys->buffer_chunk = SIZE_MAX;
+
+    if (sys->upstream != start)
+    {
+        if (vlc_stream_Seek(s->s, start))
+            return -1;
+        sys->upstream = start;
+    }
+
+    ssize_t val = vlc_stream_Read(s->s, sys->buffer, length);
+    if (val < 0)
+        return -1;
+
+    sys->upstream += val;
+    sys->buffer_chunk = chunk;
+    sys->buffer_length = val;
+
+    /* Partial chunks (interruption, error) are not cached */
+    if ((size_t)val == length
+     && pwrite(sys->fd, sys->buffer, length, start) == (ssize_t)length)
+    {
+        sys->map[chunk / 8] |= 1 << (chunk % 8);
+        sys->dirty = true;
+    }
+    return 0;
+}
+
+/**
+ * Loads a cached chunk from the data file.
+ */
+static int LoadChunk(stream_t *s, size_t chunk)
+{
+    stream_sys_t *sys = s->p_sys;
+    size_t length = ChunkLength(sys, chunk);
+    ssize_t val = pread(sys->fd, sys->buffer, length,
+                        (uint64_t)chunk * DISKCACHE_CHUNK);
+
+    if (val != (ssize_t)length)
+    {
+        msg_Warn(s, "cannot read cache: %s",
+                 (val < 0) ? vlc_strerror_c(errno) : "truncated file");
+        sys->map[chunk / 8] &= ~(1 << (chunk % 8));
+        sys->dirty = true;
+        return FetchChunk(s, chunk);
+    }
+
+    sys->buffer_chunk = chunk;
+    sys->buffer_length = length;
+    return 0;
+}
+
+static ssize_t Read(stream_t *s, void *buf, size_t len)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    if (sys->offset >= sys->size || len == 0)
+        return 0;
+
+    size_t chunk = sys->offset / DISKCACHE_CHUNK;
+
+    if (sys->buffer_chunk != chunk
+     && (IsCached(sys, chunk) ? LoadChunk(s, chunk) : FetchChunk(s, chunk)))
+        return -1;
+
+    size_t pos = sys->offset - (uint64_t)chunk * DISKCACHE_CHUNK;
+
+    if (pos >= sys->buffer_length)
+    {   /* The chunk was truncated: try again from upstream next time. */
+        sys->buffer_chunk = SIZE_MAX;
+        return 0;
+    }
+
+    if (len > sys->buffer_length - pos)
+        len = sys->buffer_length - pos;
+
+    memcpy(buf, sys->buffer + pos, len);
+    sys->offset += len;
+    return len;
+}
+
+static int Seek(stream_t *s, uint64_t offset)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    sys->offset = offset;
+    return VLC_SUCCESS;
+}
+
+static int Control(stream_t *s, int query, va_list args)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+            *va_arg(args, bool *) = true;
+            break;
+        case STREAM_GET_SIZE:
+            *va_arg(args, uint64_t *) = sys->size;
+            break;
+        default:
+            return vlc_stream_vaControl(s->s, query, args);
+    }
+    return VLC_SUCCESS;
+}
+
+/*** Cache entries ***/
+
+static char *EntryPath(const char *path, const char *ext)
+{
+    char *ret;
+
+    if (asprintf(&ret, "%s.%s", path, ext) < 0)
+        ret = NULL;
+    return ret;
+}
+
+/**
+ * Reads the chunk map of an entry, ORing it into the given map.
+ */
+static void LoadMap(stream_sys_t *sys)
+{
+    char *path = EntryPath(sys->path, "map");
+    if (unlikely(path == NULL))
+        return;
+
+    int fd = vlc_open(path, O_RDONLY);
+    free(path);
+    if (fd == -1)
+        return;
+
+    struct diskcache_header hdr;
+    size_t maplen = (sys->chunks + 7) / 8;
+    uint8_t *map = malloc(maplen);
+
+    if (likely(map != NULL)
+     && read(fd, &hdr, sizeof (hdr)) == sizeof (hdr)
+     && memcmp(hdr.magic, DISKCACHE_MAGIC, sizeof (hdr.magic)) == 0
+     && hdr.size == sys->size && hdr.chunk_size == DISKCACHE_CHUNK
+     && read(fd, map, maplen) == (ssize_t)maplen)
+        for (size_t i = 0; i < maplen; i++)
+            sys->map[i] |= map[i];
+
+    free(map);
+    vlc_close(fd);
+}
+
+static void SaveMap(stream_t *s)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    /* Another instance may have cached other chunks in the mean time. */
+    LoadMap(sys);
+
+    char *path = EntryPath(sys->path, "map");
+    if (unlikely(path == NULL))
+        return;
+
+    int fd = vlc_open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd == -1)
+    {
+        msg_Warn(s, "cannot save cache map %s: %s", path,
+                 vlc_strerror_c(errno));
+        free(path);
+        return;
+    }
+    free(path);
+
+    struct diskcache_header hdr = {
+        .size = sys->size,
+        .chunk_size = DISKCACHE_CHUNK,
+    };
+    size_t maplen = (sys->chunks + 7) / 8;
+
+    memcpy(hdr.magic, DISKCACHE_MAGIC, sizeof (hdr.magic));
+    if (write(fd, &hdr, sizeof (hdr)) != sizeof (hdr)
+     || write(fd, sys->map, maplen) != (ssize_t)maplen)
+        msg_Warn(s, "cannot save cache map: %s", vlc_strerror_c(errno));
+    vlc_close(fd);
+}
+
+struct diskcache_entry
+{
+    char *name;
+    time_t mtime;
+    uint64_t size;
+};
+
+static int EntryCmp(const void *a, const void *b, void *data)
+{
+    const struct diskcache_entry *ea = a, *eb = b;
+
+    (void) data;
+    return (ea->mtime > eb->mtime) - (ea->mtime < eb->mtime);
+}
+
+static void RemoveEntry(stream_t *s, const char *dir, const char *name)
+{
+    char *path;
+
+    if (asprintf(&path, "%s" DIR_SEP "%s", dir, name) < 0)
+        return;
+
+    msg_Dbg(s, "evicting %s", path);
+    vlc_unlink(path);
+    memcpy(path + strlen(path) - 4, "map", 4); /* "data" -> "map" */
+    vlc_unlink(path);
+    free(path);
+}
+
+/**
+ * Deletes the least recently used entries, until the total size of the other
+ * entries fits in the given budget.
+ */
+static void Evict(stream_t *s, const char *dir, const char *keep,
+                  uint64_t budget)
+{
+    DIR *handle = vlc_opendir(dir);
+    if (handle == NULL)
+        return;
+
+    struct diskcache_entry *entries = NULL;
+    size_t count = 0, alloc = 0;
+    uint64_t total = 0;
+    const char *name;
+
+    while ((name = vlc_readdir(handle)) != NULL)
+    {
+        size_t len = strlen(name);
+        if (len < 5 || strcmp(name + len - 5, ".data") != 0
+         || strcmp(name, keep) == 0)
+            continue;
+
+        char *path;
+        struct stat st;
+
+        if (asprintf(&path, "%s" DIR_SEP "%s", dir, name) < 0)
+            break;
+        if (vlc_stat(path, &st))
+        {
+            free(path);
+            continue;
+        }
+        free(path);
+
+        if (count == alloc)
+        {
+            alloc = alloc ? alloc * 2 : 32;
+            void *p = realloc(entries, alloc * sizeof (*entries));
+            if (unlikely(p == NULL))
+                break;
+            entries = p;
+        }
+
+        char *dup = strdup(name);
+        if (unlikely(dup == NULL))
+            break;
+
+        entries[count].name = dup;
+        entries[count].mtime = st.st_mtime;
+        /* Data files are sparse: count the allocated space */
+        entries[count].size = (uint64_t)st.st_blocks * 512;
+        total += entries[count].size;
+        count++;
+    }
+    closedir(handle);
+
+    vlc_qsort(entries, count, sizeof (*entries), EntryCmp, NULL);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (total > budget)
+        {
+            RemoveEntry(s, dir, entries[i].name);
+            total -= entries[i].size;
+        }
+        free(entries[i].name);
+    }
+    free(entries);
+}
+
+static char *CacheDir(vlc_object_t *obj)
+{
+    char *dir = var_InheritString(obj, "disk-cache-dir");
+    if (dir != NULL)
+        return dir;
+
+    char *base = config_GetUserDir(VLC_CACHE_DIR);
+    if (base == NULL)
+        return NULL;
+    if (asprintf(&dir, "%s" DIR_SEP "diskcache", base) < 0)
+        dir = NULL;
+    free(base);
+    return dir;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *s = (stream_t *)obj;
+    uint64_t capacity = var_InheritInteger(obj, "disk-cache-size");
+    bool b;
+
+    if (capacity == 0 || s->psz_url == NULL)
+        return VLC_EGENERIC;
+    capacity <<= 20;
+
+    /* Only cache remote, seekable, finite and identifiable contents */
+    if (vlc_stream_Control(s->s, STREAM_CAN_FASTSEEK, &b) || b)
+        return VLC_EGENERIC;
+    if (vlc_stream_Control(s->s, STREAM_CAN_SEEK, &b) || !b)
+        return VLC_EGENERIC;
+
+    uint64_t size;
+    if (vlc_stream_GetSize(s->s, &size) || size == 0 || size > capacity)
+        return VLC_EGENERIC;
+
+    char *validator;
+    if (vlc_stream_Control(s->s, STREAM_GET_VALIDATOR, &validator))
+        return VLC_EGENERIC;
+
+    char key[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_t md5;
+
+    vlc_hash_md5_Init(&md5);
+    vlc_hash_md5_Update(&md5, s->psz_url, strlen(s->psz_url) + 1);
+    vlc_hash_md5_Update(&md5, validator, strlen(validator) + 1);
+    vlc_hash_md5_Update(&md5, &size, sizeof (size));
+    vlc_hash_FinishHex(&md5, key);
+    free(validator);
+
+    char *dir = CacheDir(obj);
+    if (dir == NULL)
+        return VLC_EGENERIC;
+    vlc_mkdir(dir, 0700);
+
+    stream_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+    {
+        free(dir);
+        return VLC_ENOMEM;
+    }
+
+    char data_name[VLC_HASH_MD5_DIGEST_HEX_SIZE + 5];
+
+    snprintf(data_name, sizeof (data_name), "%s.data", key);
+    Evict(s, dir, data_name, capacity - size);
+
+    if (asprintf(&sys->path, "%s" DIR_SEP "%s", dir, key) < 0)
+        sys->path = NULL;
+    free(dir);
+    if (unlikely(sys->path == NULL))
+        goto error;
+
+    char *path = EntryPath(sys->path, "data");
+    if (unlikely(path == NULL))
+        goto error;
+
+    sys->fd = vlc_open(path, O_RDWR | O_CREAT, 0600);
+    if (sys->fd == -1)
+    {
+        msg_Err(s, "cannot open cache %s: %s", path, vlc_strerror_c(errno));
+        free(path);
+        goto error;
+    }
+    free(path);
+
+    struct stat st;
+    if (fstat(sys->fd, &st) == 0 && (uint64_t)st.st_size != size
+     && ftruncate(sys->fd, size))
+    {
+        msg_Err(s, "cannot size cache: %s", vlc_strerror_c(errno));
+        vlc_close(sys->fd);
+        goto error;
+    }
+    /* The modification time tracks the last use */
+    futimens(sys->fd, NULL);
+
+    sys->size = size;
+    sys->offset = 0;
+    sys->upstream = 0;
+    sys->chunks = (size + DISKCACHE_CHUNK - 1) / DISKCACHE_CHUNK;
+    sys->map = calloc((sys->chunks + 7) / 8, 1);
+    sys->dirty = false;
+    sys->buffer_chunk = SIZE_MAX;
+    sys->buffer_length = 0;
+    if (unlikely(sys->map == NULL))
+    {
+        vlc_close(sys->fd);
+        goto error;
+    }
+    s->p_sys = sys;
+    LoadMap(sys);
+
+    size_t cached = 0;
+    for (size_t i = 0; i < sys->chunks; i++)
+        cached += IsCached(sys, i);
+    msg_Dbg(s, "cache %s: %zu of %zu chunks", sys->path, cached, sys->chunks);
+
+    s->pf_read = Read;
+    s->pf_seek = Seek;
+    s->pf_control = Control;
+    return VLC_SUCCESS;
+
+error:
+    free(sys->path);
+    free(sys);
+    return VLC_EGENERIC;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    stream_t *s = (stream_t *)obj;
+    stream_sys_t *sys = s->p_sys;
+
+    if (sys->dirty)
+        SaveMap(s);
+    vlc_close(sys->fd);
+    free(sys->map);
+    free(sys->path);
+    free(sys);
+}
+
+#define DIR_TEXT N_("Disk cache directory")
+#define DIR_LONGTEXT N_( \
+    "Directory of the persistent cache of remote media. " \
+    "By default, a subdirectory of the user cache directory is used.")
+
+vlc_module_begin()
+    set_shortname(N_("Disk cache"))
+    set_description(N_("Persistent disk cache stream filter"))
+    set_subcategory(SUBCAT_INPUT_STREAM_FILTER)
+    set_capability("stream_filter", 0)
+    set_callbacks(Open, Close)
+
+    add_directory("disk-cache-dir", NULL, DIR_TEXT, DIR_LONGTEXT)
+vlc_module_end()
@@ -35,6 +35,27 @@
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
 
+/* Number of cached ranges, besides the circular buffer */
+#define PREFETCH_RANGES 4
+/* Readahead is sized to cover this much time at the measured bandwidth */
+#define PREFETCH_READAHEAD_TIME VLC_TICK_FROM_SEC(4)
+#define PREFETCH_READAHEAD_MIN  (256 << 10)
+
+/**
+ * Data saved from the circular buffer before it is discarded.
+ *
+ * The start of the buffer, i.e. the head of the stream or the target of the
+ * latest upstream seek, is kept when the buffer moves on. This covers the
+ * common seek back and forth patterns, e.g. MP4 with the index at the end.
+ */
+struct prefetch_range
+{
+    uint64_t offset;
+    size_t   length;
+    uint64_t used; /**< Last use, for LRU replacement */
+    char    *data;
+};
+
 struct stream_ctrl
 {
     struct stream_ctrl *next;
@@ -75,9 +96,106 @@ typedef struct
     char        *buffer;
     size_t       seek_threshold;
 
+    uint64_t     window_start; /**< Offset of the latest upstream seek */
+    bool         window_saved;
+    size_t       range_size;
+    uint64_t     range_clock;
+    struct prefetch_range ranges[PREFETCH_RANGES];
+
+    size_t       readahead;
+    uint64_t     read_bytes;
+    vlc_tick_t   read_time;
+    struct vlc_stream_cache_stats stats;
+
     struct stream_ctrl *controls;
 } stream_sys_t;
 
+static struct prefetch_range *FindRange(stream_sys_t *sys, uint64_t offset)
+{
+    for (size_t i = 0; i < PREFETCH_RANGES; i++)
+    {
+        struct prefetch_range *range = &sys->ranges[i];
+
+        if (offset >= range->offset && offset - range->offset < range->length)
+            return range;
+    }
+    return NULL;
+}
+
+/**
+ * Saves the start of the current buffer window, before it is discarded.
+ */
+static void SaveWindow(stream_sys_t *sys)
+{
+    if (sys->window_saved || sys->range_size == 0
+     || sys->buffer_offset != sys->window_start || sys->buffer_length == 0)
+        return;
+
+    sys->window_saved = true;
+
+    /* Reuse the range at the same offset, or else an empty one, or else the
+     * least recently used one. The head of the stream is never evicted. */
+    struct prefetch_range *range = NULL;
+
+    for (size_t i = 0; i < PREFETCH_RANGES; i++)
+    {
+        struct prefetch_range *r = &sys->ranges[i];
+
+        if (r->length > 0 && r->offset == sys->window_start)
+        {
+            range = r;
+            break;
+        }
+        if (r->length > 0 && r->offset == 0)
+            continue;
+        if (range == NULL || r->length == 0
+         || (range->length > 0 && r->used < range->used))
+            range = r;
+    }
+
+    if (range == NULL)
+        return;
+    if (range->data == NULL)
+    {
+        range->data = malloc(sys->range_size);
+        if (unlikely(range->data == NULL))
+            return;
+    }
+
+    size_t length = sys->buffer_length;
+    if (length > sys->range_size)
+        length = sys->range_size;
+
+    size_t offset = sys->buffer_offset % sys->buffer_size;
+    size_t first = sys->buffer_size - offset;
+    if (first > length)
+        first = length;
+
+    memcpy(range->data, sys->buffer + offset, first);
+    memcpy(range->data + first, sys->buffer, length - first);
+    range->offset = sys->window_start;
+    range->length = length;
+    range->used = ++sys->range_clock;
+}
+
+/**
+ * Determines where upstream needs to be read from next.
+ *
+ * This is the downstream offset, unless data from there on is cached in
+ * ranges, in which case upstream can skip past them.
+ */
+static uint64_t TargetOffset(stream_sys_t *sys)
+{
+    uint64_t offset = sys->stream_offset;
+    const struct prefetch_range *range;
+
+    while ((offset < sys->buffer_offset
+         || offset > sys->buffer_offset + sys->buffer_length)
+        && (range = FindRange(sys, offset)) != NULL)
+        offset = range->offset + range->length;
+    return offset;
+}
+
 static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
 {
     stream_sys_t *sys = stream->p_sys;
@@ -85,9 +203,36 @@ static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
     vlc_mutex_unlock(&sys->lock);
     assert(length > 0);
 
+    vlc_tick_t start = vlc_tick_now();
     ssize_t val = vlc_stream_ReadPartial(stream->s, buf, length);
+    vlc_tick_t now = vlc_tick_now();
 
     vlc_mutex_lock(&sys->lock);
+
+    if (val > 0)
+    {   /* Measure bandwidth over at least a quarter of a second at a time,
+         * and grow the readahead accordingly. */
+        sys->read_bytes += val;
+        sys->read_time += now - start;
+
+        if (sys->read_time >= VLC_TICK_FROM_MS(250))
+        {
+            uint64_t bandwidth = sys->read_bytes * CLOCK_FREQ
+                                 / sys->read_time;
+
+            sys->stats.bandwidth = sys->stats.bandwidth
+                ? (3 * sys->stats.bandwidth + bandwidth) / 4 : bandwidth;
+            sys->read_bytes = 0;
+            sys->read_time = 0;
+
+            uint64_t readahead = sys->stats.bandwidth
+                * PREFETCH_READAHEAD_TIME / CLOCK_FREQ;
+            if (readahead > sys->buffer_size)
+                readahead = sys->buffer_size;
+            if (readahead > sys->readahead)
+                sys->readahead = readahead;
+        }
+    }
     return val;
 }
 
@@ -102,6 +247,12 @@ static int ThreadSeek(stream_t *stream, uint64_t seek_offset)
         msg_Err(stream, "cannot seek (to offset %"PRIu64")", seek_offset);
 
     vlc_mutex_lock(&sys->lock);
+    sys->stats.seeks++;
+    if (val == VLC_SUCCESS)
+    {
+        sys->window_start = seek_offset;
+        sys->window_saved = false;
+    }
 
     return (val == VLC_SUCCESS) ? 0 : -1;
 }
@@ -159,10 +310,11 @@ static void *Thread(void *data)
             continue;
         }
 
-        uint_fast64_t stream_offset = sys->stream_offset;
+        uint_fast64_t stream_offset = TargetOffset(sys);
 
         if (stream_offset < sys->buffer_offset)
         {   /* Need to seek backward */
+            SaveWindow(sys);
             if (ThreadSeek(stream, stream_offset) == 0)
             {
                 sys->buffer_offset = stream_offset;
@@ -199,6 +351,7 @@ static void *Thread(void *data)
         if (sys->can_seek
          && history >= (sys->buffer_length + sys->seek_threshold))
         {
+            SaveWindow(sys);
             if (ThreadSeek(stream, stream_offset) == 0)
             {
                 sys->buffer_offset = stream_offset;
@@ -220,6 +373,13 @@ static void *Thread(void *data)
 
         assert(sys->buffer_size >= sys->buffer_length);
 
+        if (history < sys->buffer_length
+         && sys->buffer_length - history >= sys->readahead)
+        {   /* Read far enough ahead for the current bandwidth */
+            vlc_cond_wait(&sys->wait_space, &sys->lock);
+            continue;
+        }
+
         size_t len = sys->buffer_size - sys->buffer_length;
         if (len == 0)
         {   /* Buffer is full */
@@ -230,6 +390,7 @@ static void *Thread(void *data)
             }
 
             /* Discard some historical data to make room. */
+            SaveWindow(sys);
             len = history > sys->buffer_length ? sys->buffer_length : history;
 
             sys->buffer_offset += len;
@@ -297,8 +458,9 @@ static size_t BufferLevel(const stream_t *stream, bool *eof)
 static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 {
     stream_sys_t *sys = stream->p_sys;
+    const struct prefetch_range *range = NULL;
     size_t copy, offset;
-    bool eof;
+    bool eof, waited = false;
 
     if (buflen == 0)
         return buflen;
@@ -315,6 +477,13 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
     {
         void *data[2];
 
+        range = FindRange(sys, sys->stream_offset);
+        if (range != NULL)
+        {
+            copy = range->offset + range->length - sys->stream_offset;
+            break;
+        }
+
         if (sys->error)
         {
             vlc_mutex_unlock(&sys->lock);
@@ -324,16 +493,32 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
         vlc_interrupt_forward_start(sys->interrupt, data);
         vlc_cond_wait(&sys->wait_data, &sys->lock);
         vlc_interrupt_forward_stop(data);
+        waited = true;
     }
 
-    offset = sys->stream_offset % sys->buffer_size;
     if (copy > buflen)
         copy = buflen;
-    /* Do not step past the sharp edge of the circular buffer */
-    if (offset + copy > sys->buffer_size)
-        copy = sys->buffer_size - offset;
 
-    memcpy(buf, sys->buffer + offset, copy);
+    if (range != NULL)
+    {   /* Not in the buffer, but in a cached range */
+        memcpy(buf, range->data + (sys->stream_offset - range->offset), copy);
+        sys->ranges[range - sys->ranges].used = ++sys->range_clock;
+        sys->stats.range_hits++;
+    }
+    else
+    {
+        offset = sys->stream_offset % sys->buffer_size;
+        /* Do not step past the sharp edge of the circular buffer */
+        if (offset + copy > sys->buffer_size)
+            copy = sys->buffer_size - offset;
+
+        memcpy(buf, sys->buffer + offset, copy);
+    }
+
+    if (waited)
+        sys->stats.misses++;
+    else
+        sys->stats.hits++;
     sys->stream_offset += copy;
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
@@ -413,6 +598,17 @@ static int Control(stream_t *stream, int query, va_list args)
         case STREAM_SET_PRIVATE_ID_CA:
         case STREAM_GET_PRIVATE_ID_STATE:
             return VLC_EGENERIC;
+        case STREAM_GET_PRIVATE_CACHE_STATS:
+        {
+            struct vlc_stream_cache_stats *stats =
+                va_arg(args, struct vlc_stream_cache_stats *);
+
+            vlc_mutex_lock(&sys->lock);
+            *stats = sys->stats;
+            stats->readahead = sys->readahead;
+            vlc_mutex_unlock(&sys->lock);
+            break;
+        }
         default:
             msg_Err(stream, "unimplemented query (%d) in control", query);
             return VLC_EGENERIC;
@@ -465,6 +661,19 @@ static int Open(vlc_object_t *obj)
     sys->buffer_length = 0;
     sys->buffer_size = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
     sys->seek_threshold = var_InheritInteger(obj, "prefetch-seek-threshold");
+    sys->window_start = 0;
+    sys->window_saved = false;
+    sys->range_size = var_InheritInteger(obj, "prefetch-range-size") << 10u;
+    sys->range_clock = 0;
+    for (size_t i = 0; i < PREFETCH_RANGES; i++)
+    {
+        sys->ranges[i].offset = 0;
+        sys->ranges[i].length = 0;
+        sys->ranges[i].data = NULL;
+    }
+    sys->read_bytes = 0;
+    sys->read_time = 0;
+    memset(&sys->stats, 0, sizeof (sys->stats));
     sys->controls = NULL;
 
     uint64_t size = stream_Size(stream->s);
@@ -472,8 +681,14 @@ static int Open(vlc_object_t *obj)
     {   /* No point allocating a buffer larger than the source stream */
         if (sys->buffer_size > size)
             sys->buffer_size = size;
+        if (sys->range_size > size)
+            sys->range_size = size;
     }
 
+    sys->readahead = PREFETCH_READAHEAD_MIN;
+    if (sys->readahead > sys->buffer_size)
+        sys->readahead = sys->buffer_size;
+
     sys->buffer = malloc(sys->buffer_size);
     if (sys->buffer == NULL)
         goto error;
@@ -530,6 +745,8 @@ static void Close (vlc_object_t *obj)
         sys->controls = ctrl->next;
         free(ctrl);
     }
+    for (size_t i = 0; i < PREFETCH_RANGES; i++)
+        free(sys->ranges[i].data);
     free(sys->buffer);
     free(sys->content_type);
     free(sys);
@@ -549,4 +766,8 @@ vlc_module_begin()
     add_integer("prefetch-seek-threshold", 1 << 14, N_("Seek threshold"),
                 N_("Prefetch forward seek threshold (bytes)"))
         change_integer_range(0, UINT64_C(1) << 60)
+    add_integer("prefetch-range-size", 1 << 10, N_("Cached range size"),
+                N_("Size of each range of data kept after seeking away, "
+                   "such as the head of the stream (KiB)"))
+        change_integer_range(0, 1 << 16)
 vlc_module_end()
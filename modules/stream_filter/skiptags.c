@@ -152,6 +152,15 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
     return vlc_stream_Read(stream->s, buf, buflen);
 }
 
+static block_t *ReadBlock(stream_t *stream, bool *restrict eof)
+{
+    block_t *block = vlc_stream_ReadBlock(stream->s);
+
+    if (block == NULL)
+        *eof = vlc_stream_Eof(stream->s);
+    return block;
+}
+
 static int Seek(stream_t *stream, uint64_t offset)
 {
     const struct skiptags_sys_t *sys = stream->p_sys;
@@ -219,7 +228,10 @@ static int Open(vlc_object_t *obj)
     sys->header_skip = offset;
     sys->p_tags = p_tags;
     stream->p_sys = sys;
-    stream->pf_read = Read;
+    if (s->pf_block != NULL)
+        stream->pf_block = ReadBlock;
+    else
+        stream->pf_read = Read;
     stream->pf_seek = Seek;
     stream->pf_control = Control;
     return VLC_SUCCESS;
@@ -39,6 +39,7 @@
 #include <vlc_modules.h>
 #include <vlc_httpd.h>
 
+#include <algorithm>
 #include <cassert>
 
 #define TRANSCODING_NONE 0x0
@@ -71,6 +72,9 @@ private:
     void initCopy();
     void putCopy(block_t *p_block);
     void restoreCopy();
+    void updateRate(size_t i_size);
+    size_t paceSize() const;
+    size_t chunkSize() const;
 
     intf_sys_t * const m_intf;
     httpd_url_t       *m_url;
@@ -82,6 +86,10 @@ private:
     size_t             m_copy_size;
     bool               m_eof;
     std::string        m_mime;
+    /* rate at which the receiver reads, in bytes per second */
+    size_t             m_rate;
+    size_t             m_rate_bytes;
+    vlc_tick_t         m_rate_start;
 };
 
 typedef struct sout_stream_id_sys_t sout_stream_id_sys_t;
@@ -207,6 +215,11 @@ static const char *const ppsz_sout_options[] = {
 /* Fifo size after we drop packets (should not happen) */
 #define HTTPD_BUFFER_MAX INT64_C(32 * 1024 * 1024) /* 32 MB */
 #define HTTPD_BUFFER_COPY_MAX INT64_C(10 * 1024 * 1024) /* 10 MB */
+/* Duration of data to keep ahead of the receiver, once its rate is known */
+#define HTTPD_BUFFER_DURATION 4
+/* Size of each HTTP answer */
+#define HTTPD_CHUNK_MIN (512 * 1024) /* 512 kB */
+#define HTTPD_CHUNK_MAX (4 * 1024 * 1024) /* 4 MB */
 
 vlc_module_begin ()
 
@@ -343,6 +356,9 @@ sout_access_out_sys_t::sout_access_out_sys_t(httpd_host_t *httpd_host,
     , m_header(NULL)
     , m_copy_chain(NULL)
     , m_eof(true)
+    , m_rate(0)
+    , m_rate_bytes(0)
+    , m_rate_start(VLC_TICK_INVALID)
 {
     m_fifo = block_FifoNew();
     if (!m_fifo)
@@ -413,6 +429,45 @@ void sout_access_out_sys_t::restoreCopy()
     }
 }
 
+void sout_access_out_sys_t::updateRate(size_t i_size)
+{
+    const vlc_tick_t now = vlc_tick_now();
+
+    /* The first answer is the receiver pre-buffering, don't count it */
+    if (m_rate_start == VLC_TICK_INVALID)
+    {
+        m_rate_start = now;
+        m_rate_bytes = 0;
+        return;
+    }
+
+    m_rate_bytes += i_size;
+    const vlc_tick_t elapsed = now - m_rate_start;
+    if (elapsed >= VLC_TICK_FROM_SEC(2))
+    {
+        const size_t rate = m_rate_bytes * CLOCK_FREQ / elapsed;
+        m_rate = m_rate ? (3 * m_rate + rate) / 4 : rate;
+        m_rate_start = now;
+        m_rate_bytes = 0;
+    }
+}
+
+size_t sout_access_out_sys_t::paceSize() const
+{
+    /* High bitrate streams need more than the default buffer to absorb the
+     * receiver reading in bursts */
+    return std::min<size_t>(std::max<size_t>(m_rate * HTTPD_BUFFER_DURATION,
+                                             HTTPD_BUFFER_PACE),
+                            HTTPD_BUFFER_MAX / 2);
+}
+
+size_t sout_access_out_sys_t::chunkSize() const
+{
+    /* Send about a quarter of a second of data per answer */
+    return std::min<size_t>(std::max<size_t>(m_rate / 4, HTTPD_CHUNK_MIN),
+                            HTTPD_CHUNK_MAX);
+}
+
 void sout_access_out_sys_t::clear()
 {
     vlc_fifo_Lock(m_fifo);
@@ -440,6 +495,8 @@ void sout_access_out_sys_t::prepare(sout_stream_t *p_stream, const std::string &
     m_intf->setPacing(false);
     m_mime = mime;
     m_eof = false;
+    m_rate = 0;
+    m_rate_start = VLC_TICK_INVALID;
     vlc_fifo_Unlock(m_fifo);
 }
 
@@ -467,8 +524,7 @@ int sout_access_out_sys_t::url_cb(httpd_client_t *cl, httpd_message_t *answer,
         m_client = cl;
     }
 
-    /* Send data per 512kB minimum */
-    size_t i_min_buffer = 524288;
+    size_t i_min_buffer = chunkSize();
     while (m_client && vlc_fifo_GetBytes(m_fifo) < i_min_buffer && !m_eof)
         vlc_fifo_Wait(m_fifo);
 
@@ -507,7 +563,7 @@ int sout_access_out_sys_t::url_cb(httpd_client_t *cl, httpd_message_t *answer,
         else
             p_block = p_first;
 
-        if (vlc_fifo_GetBytes(m_fifo) < HTTPD_BUFFER_PACE)
+        if (vlc_fifo_GetBytes(m_fifo) < paceSize())
             m_intf->setPacing(false);
     }
 
@@ -544,6 +600,7 @@ int sout_access_out_sys_t::url_cb(httpd_client_t *cl, httpd_message_t *answer,
             memcpy(&answer->p_body[i_block_offset], p_block->p_buffer, p_block->i_buffer);
         }
 
+        updateRate(p_block->i_buffer);
         putCopy(p_block);
     }
     if (!answer->i_body)
@@ -568,7 +625,7 @@ ssize_t sout_access_out_sys_t::write(sout_access_out_t *p_access, block_t *p_blo
     else
     {
         /* Drop buffer is the fifo is really full */
-        if (vlc_fifo_GetBytes(m_fifo) >= HTTPD_BUFFER_PACE)
+        if (vlc_fifo_GetBytes(m_fifo) >= paceSize())
         {
             /* XXX: Hackisk way to pace between the sout (controlled by the
              * decoder thread) and the demux filter (controlled by the input
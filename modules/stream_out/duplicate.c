@@ -61,18 +61,32 @@ static int   Send( sout_stream_t *, void *, block_t * );
 
 typedef struct
 {
+    int                 i_nb_ids;
+    void                **pp_ids;
+    es_format_t         fmt;
+} sout_stream_id_sys_t;
+
+typedef struct
+{
+    vlc_mutex_t     lock;
+
     int             i_nb_streams;
     sout_stream_t   **pp_streams;
 
     int             i_nb_select;
     char            **ppsz_select;
-} sout_stream_sys_t;
 
-typedef struct
-{
-    int                 i_nb_ids;
-    void                **pp_ids;
-} sout_stream_id_sys_t;
+    /* Chain of each output added from the hub, NULL for the dst= ones */
+    int             i_nb_hub_chains;
+    char            **ppsz_hub_chains;
+
+    /* Object owning the variable listing the dynamic outputs */
+    vlc_object_t    *p_hub;
+    char            *psz_hub;
+
+    int             i_nb_es;
+    sout_stream_id_sys_t **pp_es;
+} sout_stream_sys_t;
 
 static bool ESSelected( struct vlc_logger *, const es_format_t *fmt,
                         char *psz_select );
@@ -91,12 +105,14 @@ static int Control( sout_stream_t *p_stream, int i_query, va_list args )
         {
             sout_stream_id_sys_t *id = va_arg(args, void *);
             void *spu_hl = va_arg(args, void *);
+            vlc_mutex_lock( &p_sys->lock );
             for( int i = 0; i < id->i_nb_ids; i++ )
             {
                 if( id->pp_ids[i] )
                     sout_StreamControl( p_sys->pp_streams[i], i_query,
                                         id->pp_ids[i], spu_hl );
             }
+            vlc_mutex_unlock( &p_sys->lock );
             return VLC_SUCCESS;
         }
     }
@@ -108,6 +124,148 @@ static const struct sout_stream_operations ops = {
     Add, Del, Send, Control, NULL,
 };
 
+/*****************************************************************************
+ * Hub outputs:
+ *****************************************************************************/
+static void AddHubOutput( sout_stream_t *p_stream, const char *psz_chain )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    for( int i = 0; i < p_sys->i_nb_hub_chains; i++ )
+    {
+        if( p_sys->ppsz_hub_chains[i] &&
+            !strcmp( p_sys->ppsz_hub_chains[i], psz_chain ) )
+        {
+            vlc_mutex_unlock( &p_sys->lock );
+            return;
+        }
+    }
+
+    msg_Dbg( p_stream, " * adding `%s' from the hub", psz_chain );
+    char *psz_dup = strdup( psz_chain );
+    sout_stream_t *s = psz_dup ? sout_StreamChainNew( VLC_OBJECT(p_stream),
+                                                      psz_chain,
+                                                      p_stream->p_next )
+                               : NULL;
+    if( s == NULL )
+    {
+        msg_Err( p_stream, "cannot add `%s' from the hub", psz_chain );
+        vlc_mutex_unlock( &p_sys->lock );
+        free( psz_dup );
+        return;
+    }
+
+    TAB_APPEND( p_sys->i_nb_streams, p_sys->pp_streams, s );
+    TAB_APPEND( p_sys->i_nb_select,  p_sys->ppsz_select, NULL );
+    TAB_APPEND( p_sys->i_nb_hub_chains, p_sys->ppsz_hub_chains, psz_dup );
+
+    /* Feed the new output with the ES already flowing through */
+    for( int i = 0; i < p_sys->i_nb_es; i++ )
+    {
+        sout_stream_id_sys_t *id = p_sys->pp_es[i];
+        void *id_new = sout_StreamIdAdd( s, &id->fmt );
+        TAB_APPEND( id->i_nb_ids, id->pp_ids, id_new );
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+static void DelHubOutputAt( sout_stream_t *p_stream, int i_stream )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    sout_stream_t *out = p_sys->pp_streams[i_stream];
+
+    msg_Dbg( p_stream, " * removing `%s' from the hub",
+             p_sys->ppsz_hub_chains[i_stream] );
+    for( int i = 0; i < p_sys->i_nb_es; i++ )
+    {
+        sout_stream_id_sys_t *id = p_sys->pp_es[i];
+        if( id->pp_ids[i_stream] )
+            sout_StreamIdDel( out, id->pp_ids[i_stream] );
+        TAB_ERASE( id->i_nb_ids, id->pp_ids, i_stream );
+    }
+    sout_StreamChainDelete( out, p_stream->p_next );
+
+    free( p_sys->ppsz_select[i_stream] );
+    free( p_sys->ppsz_hub_chains[i_stream] );
+    TAB_ERASE( p_sys->i_nb_streams, p_sys->pp_streams, i_stream );
+    TAB_ERASE( p_sys->i_nb_select, p_sys->ppsz_select, i_stream );
+    TAB_ERASE( p_sys->i_nb_hub_chains, p_sys->ppsz_hub_chains, i_stream );
+}
+
+static void DelHubOutput( sout_stream_t *p_stream, const char *psz_chain )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    for( int i = p_sys->i_nb_hub_chains - 1; i >= 0; i-- )
+    {
+        if( p_sys->ppsz_hub_chains[i] == NULL )
+            continue;
+        if( psz_chain == NULL || !strcmp( p_sys->ppsz_hub_chains[i], psz_chain ) )
+            DelHubOutputAt( p_stream, i );
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+static int HubCallback( vlc_object_t *p_this, const char *psz_var, int i_action,
+                        vlc_value_t *p_val, void *p_data )
+{
+    sout_stream_t *p_stream = p_data;
+    VLC_UNUSED(p_this); VLC_UNUSED(psz_var);
+
+    switch( i_action )
+    {
+        case VLC_VAR_ADDCHOICE:
+            if( p_val->psz_string && *p_val->psz_string )
+                AddHubOutput( p_stream, p_val->psz_string );
+            break;
+        case VLC_VAR_DELCHOICE:
+            if( p_val->psz_string && *p_val->psz_string )
+                DelHubOutput( p_stream, p_val->psz_string );
+            break;
+        case VLC_VAR_CLEARCHOICES:
+            DelHubOutput( p_stream, NULL );
+            break;
+    }
+    return VLC_SUCCESS;
+}
+
+static int OpenHub( sout_stream_t *p_stream )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    vlc_object_t *p_hub = VLC_OBJECT(p_stream);
+
+    /* The hub is the closest ancestor owning the variable */
+    while( p_hub != NULL && var_Type( p_hub, p_sys->psz_hub ) == 0 )
+        p_hub = vlc_object_parent( p_hub );
+    if( p_hub == NULL )
+    {
+        msg_Err( p_stream, "no hub `%s' found", p_sys->psz_hub );
+        return VLC_EGENERIC;
+    }
+
+    p_sys->p_hub = p_hub;
+    var_AddListCallback( p_hub, p_sys->psz_hub, HubCallback, p_stream );
+
+    /* Outputs listed before the callback was set; the duplicates of the
+     * ones added concurrently are ignored by AddHubOutput() */
+    vlc_value_t *p_vals;
+    size_t i_count;
+    if( var_Change( p_hub, p_sys->psz_hub, VLC_VAR_GETCHOICES,
+                    &i_count, &p_vals, (char ***)NULL ) == VLC_SUCCESS )
+    {
+        for( size_t i = 0; i < i_count; i++ )
+        {
+            if( p_vals[i].psz_string && *p_vals[i].psz_string )
+                AddHubOutput( p_stream, p_vals[i].psz_string );
+            free( p_vals[i].psz_string );
+        }
+        free( p_vals );
+    }
+    return VLC_SUCCESS;
+}
+
 /*****************************************************************************
  * Open:
  *****************************************************************************/
@@ -123,8 +281,13 @@ static int Open( vlc_object_t *p_this )
     if( !p_sys )
         return VLC_ENOMEM;
 
+    vlc_mutex_init( &p_sys->lock );
     TAB_INIT( p_sys->i_nb_streams, p_sys->pp_streams );
     TAB_INIT( p_sys->i_nb_select, p_sys->ppsz_select );
+    TAB_INIT( p_sys->i_nb_hub_chains, p_sys->ppsz_hub_chains );
+    TAB_INIT( p_sys->i_nb_es, p_sys->pp_es );
+    p_sys->p_hub = NULL;
+    p_sys->psz_hub = NULL;
 
     char **ppsz_select = NULL;
 
@@ -142,9 +305,19 @@ static int Open( vlc_object_t *p_this )
             {
                 TAB_APPEND( p_sys->i_nb_streams, p_sys->pp_streams, s );
                 TAB_APPEND( p_sys->i_nb_select,  p_sys->ppsz_select, NULL );
+                TAB_APPEND( p_sys->i_nb_hub_chains, p_sys->ppsz_hub_chains,
+                            NULL );
                 ppsz_select = &p_sys->ppsz_select[p_sys->i_nb_select - 1];
             }
         }
+        else if( !strcmp( p_cfg->psz_name, "hub" ) )
+        {
+            if( p_cfg->psz_value && *p_cfg->psz_value )
+            {
+                free( p_sys->psz_hub );
+                p_sys->psz_hub = strdup( p_cfg->psz_value );
+            }
+        }
         else if( !strncmp( p_cfg->psz_name, "select", strlen( "select" ) ) )
         {
             char *psz = p_cfg->psz_value;
@@ -169,15 +342,23 @@ static int Open( vlc_object_t *p_this )
         }
     }
 
-    if( p_sys->i_nb_streams == 0 )
+    p_stream->p_sys = p_sys;
+
+    if( p_sys->psz_hub != NULL )
+    {
+        if( OpenHub( p_stream ) != VLC_SUCCESS )
+        {
+            Close( p_this );
+            return VLC_EGENERIC;
+        }
+    }
+    else if( p_sys->i_nb_streams == 0 )
     {
         msg_Err( p_stream, "no destination given" );
-        free( p_sys );
-
+        Close( p_this );
         return VLC_EGENERIC;
     }
 
-    p_stream->p_sys = p_sys;
     p_stream->ops = &ops;
     return VLC_SUCCESS;
 }
@@ -191,13 +372,22 @@ static void Close( vlc_object_t * p_this )
     sout_stream_sys_t *p_sys = p_stream->p_sys;
 
     msg_Dbg( p_stream, "closing a duplication" );
+    /* Waits for the hub callback in progress, if any */
+    if( p_sys->p_hub != NULL )
+        var_DelListCallback( p_sys->p_hub, p_sys->psz_hub, HubCallback,
+                             p_stream );
+
     for( int i = 0; i < p_sys->i_nb_streams; i++ )
     {
         sout_StreamChainDelete(p_sys->pp_streams[i], p_stream->p_next);
         free( p_sys->ppsz_select[i] );
+        free( p_sys->ppsz_hub_chains[i] );
     }
     free( p_sys->pp_streams );
     free( p_sys->ppsz_select );
+    free( p_sys->ppsz_hub_chains );
+    free( p_sys->pp_es );
+    free( p_sys->psz_hub );
 
     free( p_sys );
 }
@@ -216,7 +406,13 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
         return NULL;
 
     TAB_INIT( id->i_nb_ids, id->pp_ids );
+    if( es_format_Copy( &id->fmt, p_fmt ) != VLC_SUCCESS )
+    {
+        free( id );
+        return NULL;
+    }
 
+    vlc_mutex_lock( &p_sys->lock );
     msg_Dbg( p_stream, "duplicated a new stream codec=%4.4s (es=%d group=%d)",
              (char*)&p_fmt->i_codec, p_fmt->i_id, p_fmt->i_group );
 
@@ -250,12 +446,16 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
         TAB_APPEND( id->i_nb_ids, id->pp_ids, id_new );
     }
 
-    if( i_valid_streams <= 0 )
+    /* With a hub, the outputs may come later */
+    if( i_valid_streams <= 0 && p_sys->p_hub == NULL )
     {
+        vlc_mutex_unlock( &p_sys->lock );
         Del( p_stream, id );
         return NULL;
     }
 
+    TAB_APPEND( p_sys->i_nb_es, p_sys->pp_es, id );
+    vlc_mutex_unlock( &p_sys->lock );
     return id;
 }
 
@@ -268,6 +468,8 @@ static void Del( sout_stream_t *p_stream, void *_id )
     sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
     int               i_stream;
 
+    vlc_mutex_lock( &p_sys->lock );
+    TAB_REMOVE( p_sys->i_nb_es, p_sys->pp_es, id );
     for( i_stream = 0; i_stream < p_sys->i_nb_streams; i_stream++ )
     {
         if( id->pp_ids[i_stream] )
@@ -276,7 +478,9 @@ static void Del( sout_stream_t *p_stream, void *_id )
             sout_StreamIdDel( out, id->pp_ids[i_stream] );
         }
     }
+    vlc_mutex_unlock( &p_sys->lock );
 
+    es_format_Clean( &id->fmt );
     free( id->pp_ids );
     free( id );
 }
@@ -291,12 +495,16 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
     sout_stream_t     *p_dup_stream;
     int               i_stream;
 
+    vlc_mutex_lock( &p_sys->lock );
     /* Loop through the linked list of buffers */
     while( p_buffer )
     {
         block_t *p_next = p_buffer->p_next;
 
         p_buffer->p_next = NULL;
+        /* All outputs read the same payload */
+        if( p_sys->i_nb_streams > 1 )
+            p_buffer = block_Shared( p_buffer );
 
         for( i_stream = 0; i_stream < p_sys->i_nb_streams - 1; i_stream++ )
         {
@@ -304,7 +512,7 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
 
             if( id->pp_ids[i_stream] )
             {
-                block_t *p_dup = block_Duplicate( p_buffer );
+                block_t *p_dup = block_Clone( p_buffer );
 
                 if( p_dup )
                     sout_StreamIdSend( p_dup_stream, id->pp_ids[i_stream], p_dup );
@@ -323,6 +531,7 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
 
         p_buffer = p_next;
     }
+    vlc_mutex_unlock( &p_sys->lock );
     return VLC_SUCCESS;
 }
 
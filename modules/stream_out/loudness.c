@@ -0,0 +1,629 @@
+/*****************************************************************************
+ * loudness.c: measure the loudness of audio elementary streams
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_sout.h>
+#include <vlc_block.h>
+#include <vlc_codec.h>
+#include <vlc_aout.h>
+#include <vlc_modules.h>
+#include <vlc_list.h>
+#include <vlc_fs.h>
+
+/* Maximum number of blocks waiting for the worker, per ES */
+#define MAX_QUEUED_BLOCKS 500
+
+/*****************************************************************************
+ * Local prototypes
+ *****************************************************************************/
+typedef struct
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /* signaled when there is work or on exit */
+    vlc_cond_t idle; /* signaled when the worker releases an ES */
+    struct vlc_list ids;
+    bool stop;
+    vlc_thread_t thread;
+
+    FILE *output;
+    char *prefix;
+    char *meter;
+} sout_stream_sys_t;
+
+typedef struct sout_stream_id_sys_t sout_stream_id_sys_t;
+
+struct decoder_owner
+{
+    decoder_t dec;
+    sout_stream_id_sys_t *id;
+};
+
+struct sout_stream_id_sys_t
+{
+    sout_stream_t *stream;
+    int id;
+    void *next_id;
+
+    /* Only for audio ES, NULL otherwise */
+    decoder_t *decoder;
+
+    /* Protected by sys->lock */
+    struct vlc_list node;
+    block_t *queue;
+    block_t **queue_last;
+    size_t queued;
+    unsigned dropped;
+    bool discontinuity;
+    bool flush;
+    bool busy;
+
+    /* Only accessed by the thread owning the decoder */
+    audio_sample_format_t fmt;
+    struct vlc_audio_meter meter;
+    vlc_audio_meter_plugin *plugin;
+    struct vlc_audio_loudness loudness;
+    vlc_tick_t date;
+};
+
+static inline sout_stream_id_sys_t *dec_get_id( decoder_t *p_dec )
+{
+    return container_of( p_dec, struct decoder_owner, dec )->id;
+}
+
+static void Report( sout_stream_id_sys_t *id, bool final )
+{
+    sout_stream_t *p_stream = id->stream;
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    const struct vlc_audio_loudness *l = &id->loudness;
+
+    if( p_sys->output )
+        fprintf( p_sys->output, "%s%s\t%d\t%"PRId64"\t%.2f\t%.2f\t%.2f\t%.2f\t%.4f\n",
+                 final ? "#" : "", p_sys->prefix, id->id, id->date,
+                 l->loudness_momentary, l->loudness_shortterm,
+                 l->loudness_integrated, l->loudness_range, l->truepeak );
+    else if( final )
+        msg_Info( p_stream, "%s: final track:%d integrated:%.2f LUFS"
+                  " range:%.2f LU truepeak:%.4f",
+                  p_sys->prefix, id->id, l->loudness_integrated,
+                  l->loudness_range, l->truepeak );
+    else
+        msg_Dbg( p_stream, "%s: track:%d date:%"PRId64" momentary:%.2f"
+                 " shortterm:%.2f integrated:%.2f range:%.2f truepeak:%.4f",
+                 p_sys->prefix, id->id, id->date, l->loudness_momentary,
+                 l->loudness_shortterm, l->loudness_integrated,
+                 l->loudness_range, l->truepeak );
+}
+
+static void OnLoudness( vlc_tick_t date,
+                        const struct vlc_audio_loudness *loudness, void *data )
+{
+    sout_stream_id_sys_t *id = data;
+
+    id->loudness = *loudness;
+    id->date = date;
+    Report( id, false );
+}
+
+/*****************************************************************************
+ * Decoder callbacks (called from the thread decoding the ES)
+ *****************************************************************************/
+static int AudioFormatUpdate( decoder_t *p_dec )
+{
+    sout_stream_id_sys_t *id = dec_get_id( p_dec );
+
+    p_dec->fmt_out.audio.i_format = p_dec->fmt_out.i_codec;
+    aout_FormatPrepare( &p_dec->fmt_out.audio );
+
+    if( !AOUT_FMT_LINEAR( &p_dec->fmt_out.audio ) )
+        return VLC_EGENERIC;
+
+    id->fmt = p_dec->fmt_out.audio;
+    if( vlc_audio_meter_Reset( &id->meter, &id->fmt ) != VLC_SUCCESS )
+        msg_Warn( id->stream, "track %d: cannot meter '%4.4s' samples",
+                  id->id, (const char *)&id->fmt.i_format );
+    return VLC_SUCCESS;
+}
+
+static void AudioQueue( decoder_t *p_dec, block_t *p_audio )
+{
+    sout_stream_id_sys_t *id = dec_get_id( p_dec );
+
+    if( id->fmt.i_format != 0 && p_audio->i_pts != VLC_TICK_INVALID )
+        vlc_audio_meter_Process( &id->meter, p_audio, p_audio->i_pts );
+    block_Release( p_audio );
+}
+
+static void Decode( sout_stream_id_sys_t *id, block_t *p_chain )
+{
+    decoder_t *p_dec = id->decoder;
+
+    while( p_chain != NULL )
+    {
+        block_t *p_block = p_chain;
+
+        p_chain = p_chain->p_next;
+        p_block->p_next = NULL;
+        p_dec->pf_decode( p_dec, p_block );
+    }
+}
+
+/*****************************************************************************
+ * Worker: decodes and meters every audio ES of the stream
+ *****************************************************************************/
+static void *Run( void *data )
+{
+    sout_stream_t *p_stream = data;
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    for( ;; )
+    {
+        sout_stream_id_sys_t *id, *found = NULL;
+
+        vlc_list_foreach( id, &p_sys->ids, node )
+            if( id->queue != NULL || id->flush )
+            {
+                found = id;
+                break;
+            }
+
+        if( found == NULL )
+        {
+            if( p_sys->stop )
+                break;
+            vlc_cond_wait( &p_sys->wait, &p_sys->lock );
+            continue;
+        }
+
+        block_t *p_chain = found->queue;
+        bool flush = found->flush;
+
+        found->queue = NULL;
+        found->queue_last = &found->queue;
+        found->queued = 0;
+        found->flush = false;
+        found->busy = true;
+        /* Round-robin between the ES */
+        vlc_list_remove( &found->node );
+        vlc_list_append( &found->node, &p_sys->ids );
+        vlc_mutex_unlock( &p_sys->lock );
+
+        if( flush )
+        {
+            if( found->decoder->pf_flush != NULL )
+                found->decoder->pf_flush( found->decoder );
+            vlc_audio_meter_Flush( &found->meter );
+        }
+        Decode( found, p_chain );
+
+        vlc_mutex_lock( &p_sys->lock );
+        found->busy = false;
+        vlc_cond_broadcast( &p_sys->idle );
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+    return NULL;
+}
+
+static int Enqueue( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                    block_t *p_chain )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    while( p_chain != NULL )
+    {
+        block_t *p_block = p_chain;
+
+        p_chain = p_chain->p_next;
+        p_block->p_next = NULL;
+
+        if( id->queued >= MAX_QUEUED_BLOCKS )
+        {
+            /* The measurement cannot keep up: drop rather than stall the
+             * stream output. */
+            if( id->dropped++ == 0 )
+                msg_Warn( p_stream, "%s: track %d: metering too slow, "
+                          "dropping data", p_sys->prefix, id->id );
+            id->discontinuity = true;
+            block_Release( p_block );
+            continue;
+        }
+
+        if( id->discontinuity )
+        {
+            p_block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+            id->discontinuity = false;
+        }
+        *id->queue_last = p_block;
+        id->queue_last = &p_block->p_next;
+        id->queued++;
+    }
+    vlc_cond_signal( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+    return VLC_SUCCESS;
+}
+
+static int CreateDecoder( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                          const es_format_t *p_fmt )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    struct decoder_owner *p_owner = vlc_object_create( p_stream,
+                                                       sizeof( *p_owner ) );
+    if( unlikely(p_owner == NULL) )
+        return VLC_ENOMEM;
+
+    decoder_t *p_dec = &p_owner->dec;
+    p_owner->id = id;
+    decoder_Init( p_dec, p_fmt );
+
+    static const struct decoder_owner_callbacks dec_cbs =
+    {
+        .audio = {
+            .format_update = AudioFormatUpdate,
+            .queue = AudioQueue,
+        },
+    };
+    p_dec->cbs = &dec_cbs;
+
+    vlc_audio_meter_Init( &id->meter, p_dec );
+
+    static const struct vlc_audio_meter_cbs meter_cbs =
+    {
+        .on_loudness = OnLoudness,
+    };
+    const struct vlc_audio_meter_plugin_owner meter_owner =
+    {
+        .cbs = &meter_cbs,
+        .sys = id,
+    };
+    id->plugin = vlc_audio_meter_AddPlugin( &id->meter, p_sys->meter,
+                                            &meter_owner );
+    if( id->plugin == NULL )
+    {
+        msg_Err( p_stream, "cannot create audio meter '%s'", p_sys->meter );
+        decoder_Destroy( p_dec );
+        return VLC_EGENERIC;
+    }
+
+    /* format_update can happen on open() */
+    p_dec->p_module = module_need_var( p_dec, "audio decoder", "codec" );
+    if( p_dec->p_module == NULL )
+    {
+        msg_Err( p_stream, "cannot find audio decoder for '%4.4s'",
+                 (const char *)&p_fmt->i_codec );
+        vlc_audio_meter_Destroy( &id->meter );
+        decoder_Destroy( p_dec );
+        return VLC_EGENERIC;
+    }
+
+    id->decoder = p_dec;
+    return VLC_SUCCESS;
+}
+
+static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    sout_stream_id_sys_t *id;
+
+    id = malloc( sizeof( *id ) );
+    if( unlikely( !id ) )
+        return NULL;
+
+    id->stream = p_stream;
+    id->id = p_fmt->i_id;
+    id->next_id = NULL;
+    id->decoder = NULL;
+    id->queue = NULL;
+    id->queue_last = &id->queue;
+    id->queued = 0;
+    id->dropped = 0;
+    id->discontinuity = false;
+    id->flush = false;
+    id->busy = false;
+    id->fmt.i_format = 0;
+    id->loudness = (struct vlc_audio_loudness) { 0, 0, 0, 0, 0 };
+    id->date = VLC_TICK_INVALID;
+
+    if( p_fmt->i_cat == AUDIO_ES
+     && CreateDecoder( p_stream, id, p_fmt ) == VLC_SUCCESS )
+    {
+        msg_Dbg( p_stream, "%s: metering track id:%d", p_sys->prefix, id->id );
+
+        vlc_mutex_lock( &p_sys->lock );
+        vlc_list_append( &id->node, &p_sys->ids );
+        vlc_mutex_unlock( &p_sys->lock );
+    }
+    return id;
+}
+
+static void Del( sout_stream_t *p_stream, void *_id )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    sout_stream_id_sys_t *id = _id;
+
+    if( id->decoder != NULL )
+    {
+        /* Take the ES back from the worker */
+        vlc_mutex_lock( &p_sys->lock );
+        while( id->busy )
+            vlc_cond_wait( &p_sys->idle, &p_sys->lock );
+        vlc_list_remove( &id->node );
+        vlc_mutex_unlock( &p_sys->lock );
+
+        /* Measure until the very end */
+        Decode( id, id->queue );
+        id->decoder->pf_decode( id->decoder, NULL );
+        vlc_audio_meter_Flush( &id->meter );
+
+        if( id->date != VLC_TICK_INVALID )
+            Report( id, true );
+        if( id->dropped > 0 )
+            msg_Warn( p_stream, "%s: track %d: %u blocks were not metered",
+                      p_sys->prefix, id->id, id->dropped );
+
+        vlc_audio_meter_Destroy( &id->meter );
+        decoder_Destroy( id->decoder );
+    }
+    free( id );
+}
+
+static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
+{
+    sout_stream_id_sys_t *id = _id;
+
+    if( id->decoder == NULL )
+    {
+        block_ChainRelease( p_buffer );
+        return VLC_SUCCESS;
+    }
+    return Enqueue( p_stream, id, p_buffer );
+}
+
+static void Flush( sout_stream_t *p_stream, void *_id )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    sout_stream_id_sys_t *id = _id;
+
+    if( id->decoder == NULL )
+        return;
+
+    vlc_mutex_lock( &p_sys->lock );
+    block_ChainRelease( id->queue );
+    id->queue = NULL;
+    id->queue_last = &id->queue;
+    id->queued = 0;
+    id->flush = true;
+    vlc_cond_signal( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+/*****************************************************************************
+ * Open:
+ *****************************************************************************/
+static const char *ppsz_sout_options[] = {
+    "output", "prefix", "meter", NULL
+};
+
+#define SOUT_CFG_PREFIX "sout-loudness-"
+
+static int Open( sout_stream_t *p_stream )
+{
+    sout_stream_sys_t *p_sys;
+    char              *outputFile;
+
+    p_sys = calloc( 1, sizeof( sout_stream_sys_t ) );
+    if( !p_sys )
+        return VLC_ENOMEM;
+
+    config_ChainParse( p_stream, SOUT_CFG_PREFIX, ppsz_sout_options,
+                   p_stream->p_cfg );
+
+    outputFile = var_InheritString( p_stream, SOUT_CFG_PREFIX "output" );
+    if( outputFile )
+    {
+        p_sys->output = vlc_fopen( outputFile, "wt" );
+        if( !p_sys->output )
+        {
+            msg_Err( p_stream, "Unable to open file '%s' for writing", outputFile );
+            free( p_sys );
+            free( outputFile );
+            return VLC_EGENERIC;
+        }
+        fprintf( p_sys->output, "#prefix\ttrack\tdate\tmomentary\tshortterm"
+                 "\tintegrated\trange\ttruepeak\n" );
+        free( outputFile );
+    }
+    p_sys->prefix = var_InheritString( p_stream, SOUT_CFG_PREFIX "prefix" );
+    p_sys->meter = var_InheritString( p_stream, SOUT_CFG_PREFIX "meter" );
+    if( p_sys->prefix == NULL )
+        p_sys->prefix = strdup( "" );
+    if( p_sys->meter == NULL )
+        p_sys->meter = strdup( "ebur128{mode=4}" );
+    if( unlikely(p_sys->prefix == NULL || p_sys->meter == NULL) )
+        goto error;
+
+    vlc_mutex_init( &p_sys->lock );
+    vlc_cond_init( &p_sys->wait );
+    vlc_cond_init( &p_sys->idle );
+    vlc_list_init( &p_sys->ids );
+    p_sys->stop = false;
+
+    p_stream->p_sys = p_sys;
+
+    if( vlc_clone( &p_sys->thread, Run, p_stream, VLC_THREAD_PRIORITY_LOW ) )
+        goto error;
+    return VLC_SUCCESS;
+
+error:
+    if( p_sys->output )
+        fclose( p_sys->output );
+    free( p_sys->meter );
+    free( p_sys->prefix );
+    free( p_sys );
+    return VLC_ENOMEM;
+}
+
+static const struct sout_stream_operations output_ops = {
+    Add, Del, Send, NULL, Flush,
+};
+
+static int OutputOpen( vlc_object_t *obj )
+{
+    sout_stream_t *stream = (sout_stream_t *)obj;
+
+    if( stream->p_next != NULL )
+        return VLC_EGENERIC;
+
+    int val = Open( stream );
+
+    if( val == VLC_SUCCESS )
+        stream->ops = &output_ops;
+
+    return val;
+}
+
+static void *FilterAdd( sout_stream_t *stream, const es_format_t *fmt )
+{
+    sout_stream_id_sys_t *id = Add( stream, fmt );
+
+    if( likely(id != NULL) )
+        id->next_id = sout_StreamIdAdd( stream->p_next, fmt );
+
+    return id;
+}
+
+static void FilterDel( sout_stream_t *stream, void *opaque )
+{
+    sout_stream_id_sys_t *id = opaque;
+
+    if( id->next_id != NULL )
+        sout_StreamIdDel( stream->p_next, id->next_id );
+    Del( stream, id );
+}
+
+static int FilterSend( sout_stream_t *stream, void *opaque, block_t *block )
+{
+    sout_stream_id_sys_t *id = opaque;
+
+    if( id->decoder != NULL )
+    {
+        block_t *copies = NULL, **last = &copies;
+
+        for( block_t *b = block; b != NULL; b = b->p_next )
+        {
+            block_t *copy = block_Duplicate( b );
+            if( unlikely(copy == NULL) )
+                break;
+            *last = copy;
+            last = &copy->p_next;
+        }
+        Enqueue( stream, id, copies );
+    }
+    return sout_StreamIdSend( stream->p_next, id->next_id, block );
+}
+
+static void FilterFlush( sout_stream_t *stream, void *opaque )
+{
+    sout_stream_id_sys_t *id = opaque;
+
+    Flush( stream, id );
+    sout_StreamFlush( stream->p_next, id->next_id );
+}
+
+static const struct sout_stream_operations filter_ops = {
+    FilterAdd, FilterDel, FilterSend, NULL, FilterFlush,
+};
+
+static int FilterOpen( vlc_object_t *obj )
+{
+    sout_stream_t *stream = (sout_stream_t *)obj;
+
+    if( stream->p_next == NULL )
+        return VLC_EGENERIC;
+
+    int val = Open( stream );
+
+    if( val == VLC_SUCCESS )
+        stream->ops = &filter_ops;
+
+    return val;
+}
+
+/*****************************************************************************
+ * Close:
+ *****************************************************************************/
+static void Close( vlc_object_t * p_this )
+{
+    sout_stream_t     *p_stream = (sout_stream_t*)p_this;
+    sout_stream_sys_t *p_sys = (sout_stream_sys_t *)p_stream->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    assert( vlc_list_is_empty( &p_sys->ids ) );
+    p_sys->stop = true;
+    vlc_cond_signal( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+    vlc_join( p_sys->thread, NULL );
+
+    if( p_sys->output )
+        fclose( p_sys->output );
+
+    free( p_sys->meter );
+    free( p_sys->prefix );
+    free( p_sys );
+}
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+#define OUTPUT_TEXT N_("Output file")
+#define OUTPUT_LONGTEXT N_( \
+    "Writes loudness measurements to file instead of the log" )
+#define PREFIX_TEXT N_("Prefix to show on output line")
+#define METER_TEXT N_("Audio meter")
+#define METER_LONGTEXT N_( \
+    "Audio meter module and options used to measure each audio track" )
+
+vlc_module_begin()
+    set_shortname( N_("Loudness"))
+    set_description( N_("Measures the loudness of audio tracks"))
+    set_capability( "sout output", 0 )
+    add_shortcut( "loudness" )
+    set_subcategory( SUBCAT_SOUT_STREAM )
+    set_callbacks( OutputOpen, Close )
+    add_string( SOUT_CFG_PREFIX "output", "", OUTPUT_TEXT, OUTPUT_LONGTEXT );
+    add_string( SOUT_CFG_PREFIX "prefix", "loudness", PREFIX_TEXT, NULL );
+    add_string( SOUT_CFG_PREFIX "meter", "ebur128{mode=4}", METER_TEXT,
+                METER_LONGTEXT );
+    add_submodule()
+    set_capability( "sout filter", 0 )
+    add_shortcut( "loudness" )
+    set_callbacks( FilterOpen, Close )
+vlc_module_end()
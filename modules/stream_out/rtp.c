@@ -142,7 +142,19 @@
 #define SRTP_SALT_TEXT N_("SRTP salt (hexadecimal)")
 #define SRTP_SALT_LONGTEXT N_( \
     "Secure RTP requires a (non-secret) master salt value. " \
-    "This must be a 28-character-long hexadecimal string.")
+    "This must be a 28-character-long hexadecimal string " \
+    "(24 characters with AES-GCM).")
+
+#define SRTP_CIPHER_TEXT N_("SRTP crypto-suite")
+#define SRTP_CIPHER_LONGTEXT N_( \
+    "Secure RTP crypto-suite. AES-GCM encrypts and authenticates " \
+    "in a single pass.")
+
+#ifdef HAVE_SRTP
+static const char *const ppsz_srtp_ciphers[] = {
+    "AES_CM_128_HMAC_SHA1_80", "AEAD_AES_128_GCM",
+};
+#endif
 
 static const char *const ppsz_protos[] = {
     "dccp", "sctp", "tcp", "udp", "udplite",
@@ -226,6 +238,9 @@ vlc_module_begin ()
                 SRTP_KEY_TEXT, SRTP_KEY_LONGTEXT )
     add_string( SOUT_CFG_PREFIX "salt", "",
                 SRTP_SALT_TEXT, SRTP_SALT_LONGTEXT )
+    add_string( SOUT_CFG_PREFIX "cipher", ppsz_srtp_ciphers[0],
+                SRTP_CIPHER_TEXT, SRTP_CIPHER_LONGTEXT )
+        change_string_list( ppsz_srtp_ciphers, ppsz_srtp_ciphers )
 #endif
 
     add_bool( SOUT_CFG_PREFIX "mp4a-latm", false, RFC3016_TEXT,
@@ -241,7 +256,7 @@ static const char *const ppsz_sout_options[] = {
     "dst", "name", "cat", "port", "port-audio", "port-video", "*sdp", "ttl",
     "mux", "sap", "description", "proto", "rtcp-mux", "caching",
 #ifdef HAVE_SRTP
-    "key", "salt",
+    "key", "salt", "cipher",
 #endif
     "mp4a-latm", NULL
 };
@@ -316,6 +331,10 @@ typedef struct rtp_sink_t
     rtcp_sender_t *rtcp;
 } rtp_sink_t;
 
+/* Maximum number of packets waiting for ThreadSend(): this is enough for
+ * the default caching delay at well over 100 Mbit/s. */
+#define RTP_QUEUE_SIZE 4096
+
 struct sout_stream_id_sys_t
 {
     sout_stream_t *p_stream;
@@ -343,7 +362,7 @@ struct sout_stream_id_sys_t
     /* Packets sinks */
     vlc_thread_t      thread;
     vlc_mutex_t       lock_sink;
-    vlc_queue_t       queue;
+    vlc_ring_t       *queue;
     bool              dead;
     int               sinkc;
     rtp_sink_t       *sinkv;
@@ -938,7 +957,7 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
     id->sinkc = 0;
     id->sinkv = NULL;
     id->rtsp_id = NULL;
-    vlc_queue_Init(&id->queue, offsetof (block_t, p_next));
+    id->queue = NULL;
     id->dead = true;
     id->listen.fd = NULL;
 
@@ -967,9 +986,18 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
     char *key = var_GetNonEmptyString (p_stream, SOUT_CFG_PREFIX"key");
     if (key)
     {
+        char *cipher = var_GetNonEmptyString (p_stream,
+                                              SOUT_CFG_PREFIX"cipher");
+        bool gcm = cipher != NULL && !strcmp (cipher, "AEAD_AES_128_GCM");
+        free (cipher);
+
         vlc_gcrypt_init ();
-        id->srtp = srtp_create (SRTP_ENCR_AES_CM, SRTP_AUTH_HMAC_SHA1, 10,
-                                   SRTP_PRF_AES_CM, SRTP_RCC_MODE1);
+        if (gcm)
+            id->srtp = srtp_create (SRTP_ENCR_AES_GCM, SRTP_AUTH_NULL, 16,
+                                    SRTP_PRF_AES_CM, 0);
+        else
+            id->srtp = srtp_create (SRTP_ENCR_AES_CM, SRTP_AUTH_HMAC_SHA1, 10,
+                                    SRTP_PRF_AES_CM, SRTP_RCC_MODE1);
         if (id->srtp == NULL)
         {
             free (key);
@@ -1124,6 +1152,10 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
         id->rtsp_id = RtspAddId( p_sys->rtsp, id, GetDWBE( id->ssrc ),
                                  id->rtp_fmt.clock_rate, mcast_fd );
 
+    id->queue = vlc_ring_New( RTP_QUEUE_SIZE, VLC_RING_MULTI_PRODUCER );
+    if( unlikely(id->queue == NULL) )
+        goto error;
+
     id->dead = false;
     if( vlc_clone( &id->thread, ThreadSend, id, VLC_THREAD_PRIORITY_HIGHEST ) )
     {
@@ -1167,9 +1199,11 @@ static void Del( sout_stream_t *p_stream, void *_id )
 
     if (!id->dead)
     {
-        vlc_queue_Kill(&id->queue, &id->dead);
+        vlc_ring_Kill( id->queue );
         vlc_join( id->thread, NULL );
      }
+    if( id->queue != NULL )
+        vlc_ring_Delete( id->queue );
     free( id->rtp_fmt.fmtp );
 
     if( id->rtsp_id )
@@ -1325,75 +1359,177 @@ static int  HttpCallback( httpd_file_sys_t *p_args,
 /****************************************************************************
  * RTP send
  ****************************************************************************/
-static void* ThreadSend( void *data )
+#define RTP_SEND_BATCH 16
+
+#ifdef HAVE_SRTP
+#define SRTP_MAX_OVERHEAD 16 /* largest tag (AES-GCM) or RoC + tag */
+
+/* Protects a batch of packets, and drops those that fail */
+static unsigned ProtectBatch( sout_stream_id_sys_t *id, block_t **batch,
+                              unsigned count )
 {
+    srtp_packet_t pkts[RTP_SEND_BATCH];
+    unsigned n = 0;
+
+    for( unsigned i = 0; i < count; i++ )
+    {
+        size_t len = batch[i]->i_buffer;
+        block_t *out = block_Realloc( batch[i], 0, len + SRTP_MAX_OVERHEAD );
+        if( unlikely(out == NULL) )
+            continue;
+
+        out->i_buffer = len;
+        batch[n] = out;
+        pkts[n].buf = out->p_buffer;
+        pkts[n].len = len;
+        pkts[n].size = len + SRTP_MAX_OVERHEAD;
+        n++;
+    }
+
+    srtp_send_batch( id->srtp, pkts, n );
+
+    count = 0;
+    for( unsigned i = 0; i < n; i++ )
+    {
+        if( pkts[i].error )
+        {
+            msg_Dbg( id->p_stream, "SRTP sending error: %s",
+                     vlc_strerror_c(pkts[i].error) );
+            block_Release( batch[i] );
+            continue;
+        }
+        batch[i]->i_buffer = pkts[i].len;
+        batch[count++] = batch[i];
+    }
+    return count;
+}
+#endif
+
 #ifdef _WIN32
 # define ENOBUFS      WSAENOBUFS
 # define EAGAIN       WSAEWOULDBLOCK
 # define EWOULDBLOCK  WSAEWOULDBLOCK
 #endif
-    sout_stream_id_sys_t *id = data;
-    vlc_tick_t i_caching = id->i_caching;
-    block_t *out;
 
-    while ((out = vlc_queue_DequeueKillable(&id->queue, &id->dead)) != NULL)
+/* Sends one packet to a sink, returns -1 if the connection is broken */
+static int SendPacket( int fd, const block_t *out )
+{
+    if( send( fd, out->p_buffer, out->i_buffer, 0 ) == -1
+     && net_errno != EAGAIN && net_errno != EWOULDBLOCK
+     && net_errno != ENOBUFS && net_errno != ENOMEM )
     {
-#ifdef HAVE_SRTP
-        if( id->srtp )
-        {   /* FIXME: this is awfully inefficient */
-            size_t len = out->i_buffer;
-            out = block_Realloc( out, 0, len + 10 );
-            out->i_buffer = len;
+        int type;
+        getsockopt( fd, SOL_SOCKET, SO_TYPE,
+                    &type, &(socklen_t){ sizeof(type) });
+        if( type != SOCK_DGRAM )
+            return -1; /* Broken connection */
+
+        /* ICMP soft error: ignore and retry */
+        send( fd, out->p_buffer, out->i_buffer, 0 );
+    }
+    return 0;
+}
 
-            int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
-            if( val )
-            {
-                msg_Dbg( id->p_stream, "SRTP sending error: %s",
-                         vlc_strerror_c(val) );
-                block_Release( out );
-                continue;
-            }
-            out->i_buffer = len;
+/* Sends packets to a sink, returns -1 if the connection is broken */
+static int SendPackets( int fd, block_t *const *pkts, unsigned count )
+{
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgv[RTP_SEND_BATCH];
+    struct iovec iov[RTP_SEND_BATCH];
+
+    assert( count <= RTP_SEND_BATCH );
+    for( unsigned i = 0; i < count; i++ )
+    {
+        iov[i].iov_base = pkts[i]->p_buffer;
+        iov[i].iov_len = pkts[i]->i_buffer;
+        memset( &msgv[i], 0, sizeof (msgv[i]) );
+        msgv[i].msg_hdr.msg_iov = &iov[i];
+        msgv[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    for( unsigned i = 0; i < count; )
+    {
+        int val = sendmmsg( fd, msgv + i, count - i, 0 );
+        if( val <= 0 )
+        {
+            /* The first packet failed: handle it as a single one */
+            if( SendPacket( fd, pkts[i] ) )
+                return -1;
+            val = 1;
         }
+        i += val;
+    }
+#else
+    for( unsigned i = 0; i < count; i++ )
+        if( SendPacket( fd, pkts[i] ) )
+            return -1;
 #endif
-        vlc_tick_wait (out->i_dts + i_caching);
-
-        ssize_t len = out->i_buffer;
+    return 0;
+}
 
-        vlc_mutex_lock( &id->lock_sink );
-        unsigned deadc = 0; /* How many dead sockets? */
-        int deadv[id->sinkc ? id->sinkc : 1]; /* Dead sockets list */
+/* Sends packets to every sink, with one system call per sink if possible */
+static void SendBatch( sout_stream_id_sys_t *id, block_t *const *pkts,
+                       unsigned count )
+{
+    vlc_mutex_lock( &id->lock_sink );
+    unsigned deadc = 0; /* How many dead sockets? */
+    int deadv[id->sinkc ? id->sinkc : 1]; /* Dead sockets list */
 
-        for( int i = 0; i < id->sinkc; i++ )
-        {
+    for( int i = 0; i < id->sinkc; i++ )
+    {
 #ifdef HAVE_SRTP
-            if( !id->srtp ) /* FIXME: SRTCP support */
+        if( !id->srtp ) /* FIXME: SRTCP support */
 #endif
-                SendRTCP( id->sinkv[i].rtcp, out );
+            for( unsigned j = 0; j < count; j++ )
+                SendRTCP( id->sinkv[i].rtcp, pkts[j] );
 
-            if( send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 ) == -1
-             && net_errno != EAGAIN && net_errno != EWOULDBLOCK
-             && net_errno != ENOBUFS && net_errno != ENOMEM )
-            {
-                int type;
-                getsockopt( id->sinkv[i].rtp_fd, SOL_SOCKET, SO_TYPE,
-                            &type, &(socklen_t){ sizeof(type) });
-                if( type == SOCK_DGRAM )
-                    /* ICMP soft error: ignore and retry */
-                    send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 );
-                else
-                    /* Broken connection */
-                    deadv[deadc++] = id->sinkv[i].rtp_fd;
-            }
-        }
-        id->i_seq_sent_next = ntohs(((uint16_t *) out->p_buffer)[1]) + 1;
-        vlc_mutex_unlock( &id->lock_sink );
-        block_Release( out );
+        if( SendPackets( id->sinkv[i].rtp_fd, pkts, count ) )
+            deadv[deadc++] = id->sinkv[i].rtp_fd;
+    }
+    id->i_seq_sent_next =
+        ntohs(((uint16_t *) pkts[count - 1]->p_buffer)[1]) + 1;
+    vlc_mutex_unlock( &id->lock_sink );
+
+    for( unsigned i = 0; i < deadc; i++ )
+    {
+        msg_Dbg( id->p_stream, "removing socket %d", deadv[i] );
+        rtp_del_sink( id, deadv[i] );
+    }
+}
 
-        for( unsigned i = 0; i < deadc; i++ )
+static void* ThreadSend( void *data )
+{
+    sout_stream_id_sys_t *id = data;
+    vlc_tick_t i_caching = id->i_caching;
+    block_t *batch[RTP_SEND_BATCH];
+
+    while ((batch[0] = vlc_ring_Dequeue(id->queue)) != NULL)
+    {
+        /* Whatever else is already queued is processed along */
+        unsigned count = 1;
+        while (count < RTP_SEND_BATCH
+            && (batch[count] = vlc_ring_TryDequeue(id->queue)) != NULL)
+            count++;
+
+#ifdef HAVE_SRTP
+        if( id->srtp )
+            count = ProtectBatch( id, batch, count );
+#endif
+
+        for( unsigned b = 0; b < count; )
         {
-            msg_Dbg( id->p_stream, "removing socket %d", deadv[i] );
-            rtp_del_sink( id, deadv[i] );
+            vlc_tick_wait (batch[b]->i_dts + i_caching);
+
+            /* The packets that are due by now are sent together */
+            vlc_tick_t now = vlc_tick_now();
+            unsigned n = 1;
+            while (b + n < count && batch[b + n]->i_dts + i_caching <= now)
+                n++;
+
+            SendBatch( id, batch + b, n );
+            for( unsigned i = 0; i < n; i++ )
+                block_Release( batch[b + i] );
+            b += n;
         }
     }
     return NULL;
@@ -1555,7 +1691,8 @@ uint16_t rtp_get_extended_sequence( sout_stream_id_sys_t *id )
 
 void rtp_packetize_send( sout_stream_id_sys_t *id, block_t *out )
 {
-    vlc_queue_Enqueue(&id->queue, out);
+    if( vlc_ring_Enqueue( id->queue, out ) )
+        block_Release( out );
 }
 
 /**
@@ -1653,6 +1790,10 @@ static ssize_t AccessOutGrabberWriteBuffer( sout_stream_t *p_stream,
 
         i_size = __MIN( i_data,
                         (unsigned)(id->i_mtu - p_sys->packet->i_buffer) );
+        /* The TS muxer sends several packets per block: keep them whole */
+        if( i_size < i_data && i_size > 188
+         && !strncasecmp( p_sys->p_mux->psz_mux, "ts", 2 ) )
+            i_size -= i_size % 188;
 
         memcpy( &p_sys->packet->p_buffer[p_sys->packet->i_buffer],
                 p_data, i_size );
@@ -69,6 +69,7 @@ DBMSDIOutput::DBMSDIOutput(sout_stream_t *p_stream) :
     lasttimestamp = 0;
     b_running = false;
     streamStartTime = VLC_TICK_INVALID;
+    slices = vlc_slices_New(0);
     vlc_mutex_init(&feeder.lock);
     vlc_cond_init(&feeder.cond);
     feeder.canceled = false;
@@ -100,6 +101,8 @@ DBMSDIOutput::~DBMSDIOutput()
     }
     if(p_card)
         p_card->Release();
+    if(slices)
+        vlc_slices_Delete(slices);
 }
 
 AbstractStream *DBMSDIOutput::Add(const es_format_t *fmt)
@@ -799,7 +802,7 @@ int DBMSDIOutput::doProcessVideo(picture_t *picture, block_t *p_cc)
             captions.FillBuffer(reinterpret_cast<uint8_t*>(buf), stride);
         }
 
-        sdi::V210::Convert(picture, stride, frame_bytes);
+        sdi::V210::Convert(picture, stride, frame_bytes, slices);
 
         result = pDLVideoFrame->SetAncillaryData(vanc);
         vanc->Release();
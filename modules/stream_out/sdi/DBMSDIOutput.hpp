@@ -25,6 +25,7 @@
 
 #include <vlc_es.h>
 #include "../../access/vlc_decklink.h"
+#include "../../video_chroma/slices.h"
 
 namespace sdi_sout
 {
@@ -66,6 +67,7 @@ namespace sdi_sout
             } clock;
             bool b_running;
             vlc_tick_t streamStartTime;
+            vlc_slices_t *slices; /* v210 packing threads */
             int StartPlayback();
             struct
             {
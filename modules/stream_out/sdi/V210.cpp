@@ -25,6 +25,14 @@
 #include "V210.hpp"
 
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
+
+#if defined (HAVE_SSE2_INTRINSICS) || defined (HAVE_AVX2_INTRINSICS)
+# include <immintrin.h>
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+# include <arm_neon.h>
+#endif
 
 using namespace sdi;
 
@@ -41,18 +49,234 @@ static inline void put_le32(uint8_t **p, uint32_t d)
     (*p) += 4;
 }
 
-void V210::Convert(const picture_t *pic, unsigned dst_stride, void *frame_bytes)
+/* The SIMD versions convert groups of 6 pixels (4 words), and leave the
+ * incomplete groups at the end of the line to the C code. As they load and
+ * store 8 samples at a time, they stop 2 pixels before the end of the line.
+ *
+ * The words of a group hold the samples in this order (lowest bits first):
+ *   U0 Y0 V0 | Y1 U1 Y2 | V1 Y3 U2 | Y4 V2 Y5
+ * The shuffles below gather the first, second and third sample of every word
+ * from the luma and the chroma vectors, in 32-bits lanes. The chroma vector
+ * holds 4 U then 4 V samples. */
+#define Z -1
+static const int8_t pack_shuf[6][16] = {
+    /* Luma, then chroma, to the lowest 10 bits */
+    { Z,Z,Z,Z,  2, 3,Z,Z, Z,Z,Z,Z,  8, 9,Z,Z },
+    { 0, 1,Z,Z, Z,Z,Z,Z, 10,11,Z,Z, Z,Z,Z,Z },
+    /* to the middle 10 bits */
+    { 0, 1,Z,Z, Z,Z,Z,Z,  6, 7,Z,Z, Z,Z,Z,Z },
+    { Z,Z,Z,Z,  2, 3,Z,Z, Z,Z,Z,Z, 12,13,Z,Z },
+    /* to the highest 10 bits */
+    { Z,Z,Z,Z,  4, 5,Z,Z, Z,Z,Z,Z, 10,11,Z,Z },
+    { 8, 9,Z,Z, Z,Z,Z,Z,  4, 5,Z,Z, Z,Z,Z,Z },
+};
+
+/* The unpacking masks the 3 samples of every word (a, b, c), and packs them
+ * in two vectors: a0-a3 b0-b3, and c0-c3 twice. The shuffles below take
+ * the luma samples (b0 a1 c1 b2 a3 c3), then 3 U (a0 b1 c2) and 3 V
+ * (c0 a2 b3) samples in the low and high halves. */
+static const int8_t unpack_shuf[4][16] = {
+    {  8, 9, 2, 3, Z,Z, 12,13, 6, 7, Z,Z, Z,Z,Z,Z },
+    { Z,Z, Z,Z, 2, 3, Z,Z, Z,Z, 6, 7, Z,Z,Z,Z },
+    {  0, 1,10,11, Z,Z, Z,Z, Z,Z, 4, 5,14,15, Z,Z },
+    { Z,Z, Z,Z, 4, 5, Z,Z,  0, 1, Z,Z, Z,Z, Z,Z },
+};
+#undef Z
+
+#ifdef HAVE_SSE2_INTRINSICS
+__attribute__ ((__target__ ("sse4.1")))
+static unsigned PackSSE41(uint8_t *dst, const uint16_t *y, const uint16_t *u,
+                          const uint16_t *v, unsigned width)
+{
+    const __m128i lo = _mm_set1_epi16(4), hi = _mm_set1_epi16(1019);
+    __m128i shuf[6];
+    unsigned w = 0;
+
+    for (int i = 0; i < 6; i++)
+        shuf[i] = _mm_loadu_si128((const __m128i *)pack_shuf[i]);
+
+    for (; w + 8 <= width; w += 6, dst += 16) {
+        __m128i luma = _mm_loadu_si128((const __m128i *)&y[w]);
+        __m128i chroma = _mm_unpacklo_epi64(
+                _mm_loadl_epi64((const __m128i *)&u[w / 2]),
+                _mm_loadl_epi64((const __m128i *)&v[w / 2]));
+
+        luma = _mm_min_epu16(_mm_max_epu16(luma, lo), hi);
+        chroma = _mm_min_epu16(_mm_max_epu16(chroma, lo), hi);
+
+        __m128i words[3];
+        for (int i = 0; i < 3; i++)
+            words[i] = _mm_or_si128(_mm_shuffle_epi8(luma, shuf[2 * i]),
+                                    _mm_shuffle_epi8(chroma, shuf[2 * i + 1]));
+
+        __m128i out = _mm_or_si128(words[0], _mm_slli_epi32(words[1], 10));
+        out = _mm_or_si128(out, _mm_slli_epi32(words[2], 20));
+        _mm_storeu_si128((__m128i *)dst, out);
+    }
+    return w;
+}
+
+__attribute__ ((__target__ ("sse4.1")))
+static unsigned UnpackSSE41(uint16_t *y, uint16_t *u, uint16_t *v,
+                            const uint32_t *src, unsigned width)
+{
+    const __m128i mask = _mm_set1_epi32(0x3FF);
+    __m128i shuf[4];
+    unsigned w = 0;
+
+    for (int i = 0; i < 4; i++)
+        shuf[i] = _mm_loadu_si128((const __m128i *)unpack_shuf[i]);
+
+    for (; w + 8 <= width; w += 6, src += 4) {
+        const __m128i in = _mm_loadu_si128((const __m128i *)src);
+        const __m128i a = _mm_and_si128(in, mask);
+        const __m128i b = _mm_and_si128(_mm_srli_epi32(in, 10), mask);
+        const __m128i c = _mm_and_si128(_mm_srli_epi32(in, 20), mask);
+        const __m128i ab = _mm_packus_epi32(a, b);
+        const __m128i cc = _mm_packus_epi32(c, c);
+
+        __m128i luma = _mm_or_si128(_mm_shuffle_epi8(ab, shuf[0]),
+                                    _mm_shuffle_epi8(cc, shuf[1]));
+        __m128i chroma = _mm_or_si128(_mm_shuffle_epi8(ab, shuf[2]),
+                                      _mm_shuffle_epi8(cc, shuf[3]));
+
+        _mm_storeu_si128((__m128i *)&y[w], luma);
+        _mm_storel_epi64((__m128i *)&u[w / 2], chroma);
+        _mm_storel_epi64((__m128i *)&v[w / 2], _mm_srli_si128(chroma, 8));
+    }
+    return w;
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+/* Two groups at a time, one per 128-bits lane */
+__attribute__ ((__target__ ("avx2")))
+static unsigned PackAVX2(uint8_t *dst, const uint16_t *y, const uint16_t *u,
+                         const uint16_t *v, unsigned width)
+{
+    const __m256i lo = _mm256_set1_epi16(4), hi = _mm256_set1_epi16(1019);
+    __m256i shuf[6];
+    unsigned w = 0;
+
+    for (int i = 0; i < 6; i++)
+        shuf[i] = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((const __m128i *)pack_shuf[i]));
+
+    for (; w + 14 <= width; w += 12, dst += 32) {
+        __m256i luma = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                _mm_loadu_si128((const __m128i *)&y[w])),
+                _mm_loadu_si128((const __m128i *)&y[w + 6]), 1);
+        __m256i chroma = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                _mm_unpacklo_epi64(
+                    _mm_loadl_epi64((const __m128i *)&u[w / 2]),
+                    _mm_loadl_epi64((const __m128i *)&v[w / 2]))),
+                _mm_unpacklo_epi64(
+                    _mm_loadl_epi64((const __m128i *)&u[w / 2 + 3]),
+                    _mm_loadl_epi64((const __m128i *)&v[w / 2 + 3])), 1);
+
+        luma = _mm256_min_epu16(_mm256_max_epu16(luma, lo), hi);
+        chroma = _mm256_min_epu16(_mm256_max_epu16(chroma, lo), hi);
+
+        __m256i words[3];
+        for (int i = 0; i < 3; i++)
+            words[i] = _mm256_or_si256(
+                    _mm256_shuffle_epi8(luma, shuf[2 * i]),
+                    _mm256_shuffle_epi8(chroma, shuf[2 * i + 1]));
+
+        __m256i out = _mm256_or_si256(words[0],
+                                      _mm256_slli_epi32(words[1], 10));
+        out = _mm256_or_si256(out, _mm256_slli_epi32(words[2], 20));
+        _mm256_storeu_si256((__m256i *)dst, out);
+    }
+    return w;
+}
+#endif
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+static unsigned PackNEON(uint8_t *dst, const uint16_t *y, const uint16_t *u,
+                         const uint16_t *v, unsigned width)
+{
+    const uint16x8_t lo = vdupq_n_u16(4), hi = vdupq_n_u16(1019);
+    uint8x16_t shuf[6];
+    unsigned w = 0;
+
+    for (int i = 0; i < 6; i++)
+        shuf[i] = vld1q_u8((const uint8_t *)pack_shuf[i]);
+
+    for (; w + 8 <= width; w += 6, dst += 16) {
+        uint16x8_t luma = vld1q_u16(&y[w]);
+        uint16x8_t chroma = vcombine_u16(vld1_u16(&u[w / 2]),
+                                         vld1_u16(&v[w / 2]));
+
+        luma = vminq_u16(vmaxq_u16(luma, lo), hi);
+        chroma = vminq_u16(vmaxq_u16(chroma, lo), hi);
+
+        uint32x4_t words[3];
+        for (int i = 0; i < 3; i++)
+            words[i] = vreinterpretq_u32_u8(vorrq_u8(
+                    vqtbl1q_u8(vreinterpretq_u8_u16(luma), shuf[2 * i]),
+                    vqtbl1q_u8(vreinterpretq_u8_u16(chroma), shuf[2 * i + 1])));
+
+        uint32x4_t out = vorrq_u32(words[0], vshlq_n_u32(words[1], 10));
+        out = vorrq_u32(out, vshlq_n_u32(words[2], 20));
+        vst1q_u8(dst, vreinterpretq_u8_u32(out));
+    }
+    return w;
+}
+
+static unsigned UnpackNEON(uint16_t *y, uint16_t *u, uint16_t *v,
+                           const uint32_t *src, unsigned width)
+{
+    const uint32x4_t mask = vdupq_n_u32(0x3FF);
+    uint8x16_t shuf[4];
+    unsigned w = 0;
+
+    for (int i = 0; i < 4; i++)
+        shuf[i] = vld1q_u8((const uint8_t *)unpack_shuf[i]);
+
+    for (; w + 8 <= width; w += 6, src += 4) {
+        const uint32x4_t in = vld1q_u32(src);
+        const uint16x4_t c = vmovn_u32(vandq_u32(vshrq_n_u32(in, 20), mask));
+        const uint8x16_t ab = vreinterpretq_u8_u16(vcombine_u16(
+                vmovn_u32(vandq_u32(in, mask)),
+                vmovn_u32(vandq_u32(vshrq_n_u32(in, 10), mask))));
+        const uint8x16_t cc = vreinterpretq_u8_u16(vcombine_u16(c, c));
+
+        const uint16x8_t luma = vreinterpretq_u16_u8(
+                vorrq_u8(vqtbl1q_u8(ab, shuf[0]), vqtbl1q_u8(cc, shuf[1])));
+        const uint16x8_t chroma = vreinterpretq_u16_u8(
+                vorrq_u8(vqtbl1q_u8(ab, shuf[2]), vqtbl1q_u8(cc, shuf[3])));
+
+        vst1q_u16(&y[w], luma);
+        vst1_u16(&u[w / 2], vget_low_u16(chroma));
+        vst1_u16(&v[w / 2], vget_high_u16(chroma));
+    }
+    return w;
+}
+#endif
+
+static void PackLine(uint8_t *dst, const uint16_t *y, const uint16_t *u,
+                     const uint16_t *v, unsigned width)
 {
-    unsigned width = pic->format.i_width;
-    unsigned height = pic->format.i_height;
-    unsigned payload_size = ((width * 8 + 11) / 12) * 4;
-    unsigned line_padding = (payload_size < dst_stride) ? dst_stride - payload_size : 0;
-    unsigned h, w;
-    uint8_t *dst = (uint8_t*)frame_bytes;
+    unsigned w = 0;
 
-    const uint16_t *y = (const uint16_t*)pic->p[0].p_pixels;
-    const uint16_t *u = (const uint16_t*)pic->p[1].p_pixels;
-    const uint16_t *v = (const uint16_t*)pic->p[2].p_pixels;
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        w = PackAVX2(dst, y, u, v, width);
+#endif
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE4_1())
+        w += PackSSE41(dst + w / 6 * 16, y + w, u + w / 2, v + w / 2,
+                       width - w);
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        w = PackNEON(dst, y, u, v, width);
+#endif
+    dst += w / 6 * 16;
+    y += w;
+    u += w / 2;
+    v += w / 2;
 
 #define WRITE_PIXELS(a, b, c)           \
     do {                                \
@@ -62,37 +286,167 @@ void V210::Convert(const picture_t *pic, unsigned dst_stride, void *frame_bytes)
         put_le32(&dst, val);           \
     } while (0)
 
-    for (h = 0; h < height; h++) {
-        uint32_t val = 0;
-        for (w = 0; w + 5 < width; w += 6) {
-            WRITE_PIXELS(u, y, v);
-            WRITE_PIXELS(y, u, y);
-            WRITE_PIXELS(v, y, u);
-            WRITE_PIXELS(y, v, y);
-        }
-        if (w + 1 < width) {
-            WRITE_PIXELS(u, y, v);
-
-            val = clip(*y++);
-            if (w + 2 == width)
-                put_le32(&dst, val);
-#undef WRITE_PIXELS
-        }
-        if (w + 3 < width) {
-            val |= (clip(*u++) << 10) | (clip(*y++) << 20);
-            put_le32(&dst, val);
+    uint32_t val = 0;
+    for (; w + 5 < width; w += 6) {
+        WRITE_PIXELS(u, y, v);
+        WRITE_PIXELS(y, u, y);
+        WRITE_PIXELS(v, y, u);
+        WRITE_PIXELS(y, v, y);
+    }
+    if (w + 1 < width) {
+        WRITE_PIXELS(u, y, v);
 
-            val = clip(*v++) | (clip(*y++) << 10);
+        val = clip(*y++);
+        if (w + 2 == width)
             put_le32(&dst, val);
-        }
+#undef WRITE_PIXELS
+    }
+    if (w + 3 < width) {
+        val |= (clip(*u++) << 10) | (clip(*y++) << 20);
+        put_le32(&dst, val);
+
+        val = clip(*v++) | (clip(*y++) << 10);
+        put_le32(&dst, val);
+    }
+}
+
+static void UnpackLine(uint16_t *y, uint16_t *u, uint16_t *v,
+                       const uint32_t *src, unsigned width)
+{
+    unsigned w = 0;
+
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE4_1())
+        w = UnpackSSE41(y, u, v, src, width);
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        w = UnpackNEON(y, u, v, src, width);
+#endif
+    src += w / 6 * 4;
+    y += w;
+    u += w / 2;
+    v += w / 2;
 
-        memset(dst, 0, line_padding);
-        dst += line_padding;
+#define READ_PIXELS(a, b, c)         \
+    do {                             \
+        val  = GetDWLE(src++);       \
+        *a++ =  val & 0x3FF;         \
+        *b++ = (val >> 10) & 0x3FF;  \
+        *c++ = (val >> 20) & 0x3FF;  \
+    } while (0)
+
+    uint32_t val = 0;
+    for (; w + 5 < width; w += 6) {
+        READ_PIXELS(u, y, v);
+        READ_PIXELS(y, u, y);
+        READ_PIXELS(v, y, u);
+        READ_PIXELS(y, v, y);
+    }
+    if (w + 1 < width) {
+        READ_PIXELS(u, y, v);
+#undef READ_PIXELS
 
-        y += pic->p[0].i_pitch / 2 - width;
-        u += pic->p[1].i_pitch / 2 - width / 2;
-        v += pic->p[2].i_pitch / 2 - width / 2;
+        val  = GetDWLE(src++);
+        *y++ =  val & 0x3FF;
     }
+    if (w + 3 < width) {
+        *u++ = (val >> 10) & 0x3FF;
+        *y++ = (val >> 20) & 0x3FF;
+
+        val  = GetDWLE(src++);
+        *v++ =  val & 0x3FF;
+        *y++ = (val >> 10) & 0x3FF;
+    }
+}
+
+/* Lines below which a band is not worth a thread */
+#define V210_SLICE_LINES 64
+
+namespace
+{
+    struct PackJob
+    {
+        const picture_t *pic;
+        uint8_t *dst;
+        size_t dst_pitch;
+        size_t payload_size;
+    };
+
+    struct UnpackJob
+    {
+        uint16_t *dst;
+        const uint32_t *src;
+        size_t src_pitch; /* in words */
+        unsigned width;
+        unsigned height;
+    };
+}
+
+static void PackSlice(void *opaque, unsigned index, unsigned count)
+{
+    const PackJob *job = static_cast<const PackJob *>(opaque);
+    const picture_t *pic = job->pic;
+    unsigned start, end;
+
+    vlc_slice_Lines(pic->format.i_height, 1, index, count, &start, &end);
+
+    for (unsigned h = start; h < end; h++) {
+        uint8_t *dst = job->dst + h * job->dst_pitch;
+
+        PackLine(dst,
+                 (const uint16_t *)(pic->p[0].p_pixels + h * pic->p[0].i_pitch),
+                 (const uint16_t *)(pic->p[1].p_pixels + h * pic->p[1].i_pitch),
+                 (const uint16_t *)(pic->p[2].p_pixels + h * pic->p[2].i_pitch),
+                 pic->format.i_width);
+        memset(dst + job->payload_size, 0,
+               job->dst_pitch - job->payload_size);
+    }
+}
+
+static void UnpackSlice(void *opaque, unsigned index, unsigned count)
+{
+    const UnpackJob *job = static_cast<const UnpackJob *>(opaque);
+    const size_t luma_size = (size_t)job->width * job->height;
+    unsigned start, end;
+
+    vlc_slice_Lines(job->height, 1, index, count, &start, &end);
+
+    for (unsigned h = start; h < end; h++)
+        UnpackLine(&job->dst[h * job->width],
+                   &job->dst[luma_size + h * job->width / 2],
+                   &job->dst[luma_size * 3 / 2 + h * job->width / 2],
+                   &job->src[h * job->src_pitch], job->width);
+}
+
+void V210::Convert(const picture_t *pic, unsigned dst_stride, void *frame_bytes,
+                   vlc_slices_t *slices)
+{
+    PackJob job;
+
+    job.pic = pic;
+    job.dst = (uint8_t*)frame_bytes;
+    job.payload_size = ((pic->format.i_width * 8 + 11) / 12) * 4;
+    job.dst_pitch = __MAX(job.payload_size, dst_stride);
+
+    vlc_slices_Run(slices, vlc_slices_Count(slices, pic->format.i_height,
+                                            V210_SLICE_LINES),
+                   PackSlice, &job);
+}
+
+void V210::Unpack(uint16_t *dst, const uint32_t *bytes, unsigned width,
+                  unsigned height, vlc_slices_t *slices)
+{
+    UnpackJob job;
+
+    job.dst = dst;
+    job.src = bytes;
+    job.src_pitch = ((width + 47) / 48) * 48 * 8 / 3 / 4;
+    job.width = width;
+    job.height = height;
+
+    vlc_slices_Run(slices, vlc_slices_Count(slices, height, V210_SLICE_LINES),
+                   UnpackSlice, &job);
 }
 
 void V210::Convert(const uint16_t *src, size_t srccount, void *out)
@@ -22,6 +22,7 @@
 #define V210_HPP
 
 #include <vlc_common.h>
+#include "../../video_chroma/slices.h"
 
 namespace sdi
 {
@@ -30,8 +31,14 @@ namespace sdi
     {
         public:
             static const int ALIGNMENT_U16 = 6;
-            static void Convert(const picture_t *, unsigned, void *);
+            /* Packs a 4:2:2 10 bits picture, in bands over the slices
+             * runner threads if any */
+            static void Convert(const picture_t *, unsigned, void *,
+                                vlc_slices_t * = NULL);
             static void Convert(const uint16_t *, size_t, void *);
+            /* Unpacks a v210 frame into contiguous 4:2:2 10 bits planes */
+            static void Unpack(uint16_t *, const uint32_t *,
+                               unsigned, unsigned, vlc_slices_t * = NULL);
     };
 
 }
@@ -23,7 +23,6 @@
 #include <vlc_common.h>
 #include <vlc_modules.h>
 #include <vlc_codec.h>
-#include <vlc_picture_fifo.h>
 #include <vlc_aout.h>
 #include <vlc_sout.h>
 
@@ -49,7 +48,6 @@ void transcode_encoder_delete( transcode_encoder_t *p_enc )
         if( p_enc->p_encoder->fmt_in.i_cat == VIDEO_ES )
         {
             block_ChainRelease( p_enc->p_buffers );
-            picture_fifo_Delete( p_enc->pp_pics );
         }
         es_format_Clean( &p_enc->p_encoder->fmt_in );
         es_format_Clean( &p_enc->p_encoder->fmt_out );
@@ -96,15 +94,6 @@ transcode_encoder_t * transcode_encoder_new( encoder_t *p_encoder,
     switch( p_fmt->i_cat )
     {
         case VIDEO_ES:
-            p_enc->pp_pics = picture_fifo_New();
-            if( !p_enc->pp_pics )
-            {
-                es_format_Clean( &p_enc->p_encoder->fmt_in );
-                es_format_Clean( &p_enc->p_encoder->fmt_out );
-                vlc_object_delete(p_enc->p_encoder);
-                free( p_enc );
-                return NULL;
-            }
             vlc_mutex_init( &p_enc->lock_out );
             break;
         default:
@@ -39,11 +39,13 @@ typedef struct
             unsigned int    i_height, i_maxheight;
             bool            b_hurry_up;
             vlc_rational_t  fps;
+            vlc_tick_t      i_gop; /* fixed keyframe interval, 0 if none */
             struct
             {
                 unsigned int i_count;
                 int          i_priority;
                 uint32_t     pool_size;
+                bool         b_pipeline; /* filter in a separate thread */
             } threads;
         } video;
         struct
@@ -16,7 +16,7 @@
  * You should have received a copy of the GNU Lesser General Public License
  * along with this program; if not, If not, see https://www.gnu.org/licenses/
  *****************************************************************************/
-#include <vlc_picture_fifo.h>
+#include <vlc_queue.h>
 
 struct transcode_encoder_t
 {
@@ -24,13 +24,19 @@ struct transcode_encoder_t
     vlc_thread_t    thread;
     vlc_mutex_t     lock_out;
     bool            b_abort;
-    picture_fifo_t *pp_pics;
-    vlc_sem_t       picture_pool_has_room;
-    vlc_cond_t      cond;
+    vlc_ring_t     *pics; /**< Pictures queued to the encoder thread */
 
     /* output buffers */
     block_t         *p_buffers;
     bool b_threaded;
+
+    /* Statistics of the encoder thread */
+    struct
+    {
+        unsigned        i_pictures;
+        vlc_tick_t      i_busy; /**< Time spent encoding */
+        vlc_tick_t      i_stalled; /**< Time the producer waited for room */
+    } stats;
 };
 
 int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
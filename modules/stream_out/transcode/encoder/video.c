@@ -28,6 +28,7 @@
 #endif
 
 #include <vlc_common.h>
+#include <vlc_cpu.h>
 #include <vlc_modules.h>
 #include <vlc_codec.h>
 #include <vlc_sout.h>
@@ -353,59 +354,62 @@ int transcode_encoder_video_test( encoder_t *p_encoder,
     return p_module != NULL ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
+static void EncoderAppend( transcode_encoder_t *p_enc, block_t *p_block )
+{
+    vlc_mutex_lock( &p_enc->lock_out );
+    block_ChainAppend( &p_enc->p_buffers, p_block );
+    vlc_mutex_unlock( &p_enc->lock_out );
+}
+
 static void* EncoderThread( void *obj )
 {
     transcode_encoder_t *p_enc = obj;
-    picture_t *p_pic = NULL;
+    picture_t *p_pic;
     int canc = vlc_savecancel ();
     block_t *p_block = NULL;
 
-    vlc_mutex_lock( &p_enc->lock_out );
-
-    for( ;; )
-    {
-        while( !p_enc->b_abort &&
-               (p_pic = picture_fifo_Pop( p_enc->pp_pics )) == NULL )
-            vlc_cond_wait( &p_enc->cond, &p_enc->lock_out );
-        vlc_sem_post( &p_enc->picture_pool_has_room );
-
-        if( p_pic )
-        {
-            /* release lock while encoding */
-            vlc_mutex_unlock( &p_enc->lock_out );
-            p_block = vlc_encoder_EncodeVideo( p_enc->p_encoder, p_pic );
-            picture_Release( p_pic );
-            vlc_mutex_lock( &p_enc->lock_out );
-
-            block_ChainAppend( &p_enc->p_buffers, p_block );
-        }
-
-        if( p_enc->b_abort )
-            break;
-    }
+    vlc_CPU_PinThread( VLC_OBJECT(p_enc->p_encoder), "sout" );
 
-    /*Encode what we have in the buffer on closing*/
-    while( (p_pic = picture_fifo_Pop( p_enc->pp_pics )) != NULL )
+    /* Encode until the ring is killed and empty */
+    while( (p_pic = vlc_ring_Dequeue( p_enc->pics )) != NULL )
     {
-        vlc_sem_post( &p_enc->picture_pool_has_room );
+        vlc_tick_t i_start = vlc_tick_now();
         p_block = vlc_encoder_EncodeVideo( p_enc->p_encoder, p_pic );
+        p_enc->stats.i_busy += vlc_tick_now() - i_start;
+        p_enc->stats.i_pictures++;
         picture_Release( p_pic );
-        block_ChainAppend( &p_enc->p_buffers, p_block );
+
+        EncoderAppend( p_enc, p_block );
     }
 
     /*Now flush encoder*/
     do {
         p_block = vlc_encoder_EncodeVideo(p_enc->p_encoder, NULL );
-        block_ChainAppend( &p_enc->p_buffers, p_block );
+        EncoderAppend( p_enc, p_block );
     } while( p_block );
 
-    vlc_mutex_unlock( &p_enc->lock_out );
-
     vlc_restorecancel (canc);
 
     return NULL;
 }
 
+static void EncoderThreadStop( transcode_encoder_t *p_enc )
+{
+    if( !p_enc->b_threaded || p_enc->b_abort )
+        return;
+
+    vlc_ring_Kill( p_enc->pics );
+    vlc_join( p_enc->thread, NULL );
+    vlc_ring_Delete( p_enc->pics );
+    p_enc->pics = NULL;
+    p_enc->b_abort = true;
+
+    msg_Dbg( p_enc->p_encoder, "encoded %u pictures in %"PRId64" ms, "
+             "input stalled for %"PRId64" ms", p_enc->stats.i_pictures,
+             MS_FROM_VLC_TICK( p_enc->stats.i_busy ),
+             MS_FROM_VLC_TICK( p_enc->stats.i_stalled ) );
+}
+
 int transcode_encoder_video_drain( transcode_encoder_t *p_enc, block_t **out )
 {
     if( !p_enc->b_threaded )
@@ -418,14 +422,7 @@ int transcode_encoder_video_drain( transcode_encoder_t *p_enc, block_t **out )
     }
     else
     {
-        if( p_enc->b_threaded && !p_enc->b_abort )
-        {
-            vlc_mutex_lock( &p_enc->lock_out );
-            p_enc->b_abort = true;
-            vlc_cond_signal( &p_enc->cond );
-            vlc_mutex_unlock( &p_enc->lock_out );
-            vlc_join( p_enc->thread, NULL );
-        }
+        EncoderThreadStop( p_enc );
         block_ChainAppend( out, transcode_encoder_get_output_async( p_enc ) );
     }
     return VLC_SUCCESS;
@@ -433,14 +430,7 @@ int transcode_encoder_video_drain( transcode_encoder_t *p_enc, block_t **out )
 
 void transcode_encoder_video_close( transcode_encoder_t *p_enc )
 {
-    if( p_enc->b_threaded && !p_enc->b_abort )
-    {
-        vlc_mutex_lock( &p_enc->lock_out );
-        p_enc->b_abort = true;
-        vlc_cond_signal( &p_enc->cond );
-        vlc_mutex_unlock( &p_enc->lock_out );
-        vlc_join( p_enc->thread, NULL );
-    }
+    EncoderThreadStop( p_enc );
 
     /* Close encoder */
     module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
@@ -454,6 +444,16 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
     p_enc->p_encoder->p_cfg = p_cfg->p_config_chain;
     p_enc->p_encoder->ops = NULL;
 
+    /* Encoders honoring i_iframes use a closed GOP without scene cuts, so
+     * that the same input always gets its keyframes at the same dates */
+    const video_format_t *p_vfmt_in = &p_enc->p_encoder->fmt_in.video;
+    p_enc->p_encoder->i_iframes = 0;
+    if( p_cfg->video.i_gop > 0 && p_vfmt_in->i_frame_rate_base )
+        p_enc->p_encoder->i_iframes =
+            __MAX( 1, samples_from_vlc_tick( p_cfg->video.i_gop,
+                                             p_vfmt_in->i_frame_rate )
+                      / p_vfmt_in->i_frame_rate_base );
+
     p_enc->p_encoder->p_module =
         module_need( p_enc->p_encoder, "video encoder", p_cfg->psz_name, true );
     if( !p_enc->p_encoder->p_module )
@@ -467,15 +467,21 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
     p_enc->p_encoder->fmt_out.i_codec =
         vlc_fourcc_GetCodec( VIDEO_ES, p_enc->p_encoder->fmt_out.i_codec );
 
-    vlc_sem_init( &p_enc->picture_pool_has_room, p_cfg->video.threads.pool_size );
-    vlc_cond_init( &p_enc->cond );
     p_enc->p_buffers = NULL;
     p_enc->b_abort = false;
+    p_enc->b_threaded = false;
 
     if( p_cfg->video.threads.i_count > 0 )
     {
-        if( vlc_clone( &p_enc->thread, EncoderThread, p_enc, p_cfg->video.threads.i_priority ) )
+        memset( &p_enc->stats, 0, sizeof(p_enc->stats) );
+        /* The bounded ring makes the producer wait for the encoder */
+        p_enc->pics = vlc_ring_New( p_cfg->video.threads.pool_size, 0 );
+        if( p_enc->pics == NULL ||
+            vlc_clone( &p_enc->thread, EncoderThread, p_enc, p_cfg->video.threads.i_priority ) )
         {
+            if( p_enc->pics )
+                vlc_ring_Delete( p_enc->pics );
+            p_enc->pics = NULL;
             module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
             p_enc->p_encoder->p_module = NULL;
             return VLC_EGENERIC;
@@ -493,11 +499,14 @@ block_t * transcode_encoder_video_encode( transcode_encoder_t *p_enc, picture_t
         return vlc_encoder_EncodeVideo( p_enc->p_encoder, p_pic );
     }
 
-    vlc_sem_wait( &p_enc->picture_pool_has_room );
-    vlc_mutex_lock( &p_enc->lock_out );
     picture_Hold( p_pic );
-    picture_fifo_Push( p_enc->pp_pics, p_pic );
-    vlc_cond_signal( &p_enc->cond );
-    vlc_mutex_unlock( &p_enc->lock_out );
+    if( !vlc_ring_TryEnqueue( p_enc->pics, p_pic ) )
+    {
+        /* Back-pressure: wait for the encoder to catch up */
+        vlc_tick_t i_start = vlc_tick_now();
+        if( vlc_ring_Enqueue( p_enc->pics, p_pic ) )
+            picture_Release( p_pic );
+        p_enc->stats.i_stalled += vlc_tick_now() - i_start;
+    }
     return NULL;
 }
@@ -75,6 +75,16 @@
 #define MAXHEIGHT_TEXT N_("Maximum video height")
 #define MAXHEIGHT_LONGTEXT N_( \
     "Maximum output video height." )
+#define LADDER_TEXT N_("Video ladder")
+#define LADDER_LONGTEXT N_( \
+    "Colon-separated list of renditions, as WIDTHxHEIGHT@KBPS, to encode " \
+    "from a single decoding of the video (eg: 1280x720@2500:640x0@800). " \
+    "A zero dimension keeps the aspect ratio.")
+#define GOP_TEXT N_("Keyframe interval")
+#define GOP_LONGTEXT N_( \
+    "Fixed interval between video keyframes in milliseconds, or 0 for the " \
+    "encoder default. Ladders use 2000 by default, so that their renditions " \
+    "have aligned keyframes." )
 #define VFILTER_TEXT N_("Video filter")
 #define VFILTER_LONGTEXT N_( \
     "Video filters will be applied to the video streams (after overlays " \
@@ -131,6 +141,10 @@
 #define POOL_TEXT N_("Picture pool size")
 #define POOL_LONGTEXT N_( "Defines how many pictures we allow to be in pool "\
     "between decoder/encoder threads when threads > 0" )
+#define PIPELINE_TEXT N_("Pipelined video filters")
+#define PIPELINE_LONGTEXT N_( \
+    "Runs the video filters and scaling in their own thread, between the " \
+    "decoder and the encoder thread." )
 
 
 /* Note: Skip adding translated accompanying labels - too technical, not worth it */
@@ -177,6 +191,10 @@ vlc_module_begin ()
                  MAXHEIGHT_LONGTEXT )
     add_module_list(SOUT_CFG_PREFIX "vfilter", "video filter", NULL,
                     VFILTER_TEXT, VFILTER_LONGTEXT)
+    add_string( SOUT_CFG_PREFIX "ladder", NULL, LADDER_TEXT,
+                LADDER_LONGTEXT )
+    add_integer( SOUT_CFG_PREFIX "gop", 0, GOP_TEXT, GOP_LONGTEXT )
+        change_integer_range( 0, 60000 )
 
     set_section( N_("Audio"), NULL )
     add_module(SOUT_CFG_PREFIX "aenc", "audio encoder", "none",
@@ -212,6 +230,8 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "pool-size", 10, POOL_TEXT, POOL_LONGTEXT )
         change_integer_range( 1, 1000 )
     add_bool( SOUT_CFG_PREFIX "high-priority", false, HP_TEXT, HP_LONGTEXT )
+    add_bool( SOUT_CFG_PREFIX "pipeline", false, PIPELINE_TEXT,
+              PIPELINE_LONGTEXT )
 
 vlc_module_end ()
 
@@ -221,7 +241,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
-    NULL
+    "ladder", "gop", "pipeline", NULL
 };
 
 /*****************************************************************************
@@ -320,8 +340,15 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
     p_cfg->video.i_maxwidth = var_GetInteger( p_stream, SOUT_CFG_PREFIX "maxwidth" );
     p_cfg->video.i_maxheight = var_GetInteger( p_stream, SOUT_CFG_PREFIX "maxheight" );
 
+    p_cfg->video.i_gop = VLC_TICK_FROM_MS(
+        var_GetInteger( p_stream, SOUT_CFG_PREFIX "gop" ) );
+
     p_cfg->video.threads.i_count = var_GetInteger( p_stream, SOUT_CFG_PREFIX "threads" );
     p_cfg->video.threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
+    /* The pipeline ends with the encoder thread */
+    p_cfg->video.threads.b_pipeline = var_GetBool( p_stream, SOUT_CFG_PREFIX "pipeline" );
+    if( p_cfg->video.threads.b_pipeline && p_cfg->video.threads.i_count == 0 )
+        p_cfg->video.threads.i_count = 1;
 
 #if VLC_THREAD_PRIORITY_OUTPUT != VLC_THREAD_PRIORITY_VIDEO
     if( var_GetBool( p_stream, SOUT_CFG_PREFIX "high-priority" ) )
@@ -331,6 +358,46 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
         p_cfg->video.threads.i_priority = VLC_THREAD_PRIORITY_VIDEO;
 }
 
+static void SetVideoLadderConfig( sout_stream_t *p_stream, sout_stream_sys_t *p_sys )
+{
+    char *psz_ladder = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "ladder" );
+    if( !psz_ladder )
+        return;
+
+    char *psz_save;
+    for( const char *psz_rung = strtok_r( psz_ladder, ":", &psz_save );
+         psz_rung != NULL; psz_rung = strtok_r( NULL, ":", &psz_save ) )
+    {
+        unsigned i_width, i_height, i_kbps;
+        if( sscanf( psz_rung, "%ux%u@%u", &i_width, &i_height, &i_kbps ) != 3 )
+        {
+            msg_Warn( p_stream, "invalid ladder rendition %s", psz_rung );
+            continue;
+        }
+        if( p_sys->i_ladder == TRANSCODE_LADDER_MAX )
+        {
+            msg_Warn( p_stream, "too many ladder renditions, ignoring %s",
+                      psz_rung );
+            break;
+        }
+
+        /* Copy of the main settings, the strings are not owned */
+        transcode_encoder_config_t *p_cfg = &p_sys->ladder_cfg[p_sys->i_ladder++];
+        *p_cfg = p_sys->venc_cfg;
+        p_cfg->video.i_width = i_width;
+        p_cfg->video.i_height = i_height;
+        p_cfg->video.i_maxwidth = p_cfg->video.i_maxheight = 0;
+        p_cfg->video.f_scale = 0.f;
+        p_cfg->video.i_bitrate = i_kbps * 1000;
+        /* Each rendition encodes in its own thread */
+        if( p_cfg->video.threads.i_count == 0 )
+            p_cfg->video.threads.i_count = 1;
+        if( p_cfg->video.i_gop == 0 )
+            p_cfg->video.i_gop = VLC_TICK_FROM_SEC(2);
+    }
+    free( psz_ladder );
+}
+
 static void SetSPUEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
 {
     char *psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "senc" );
@@ -418,6 +485,7 @@ static int Open( vlc_object_t *p_this )
                  p_sys->venc_cfg.video.i_height,
                  p_sys->venc_cfg.video.f_scale,
                  p_sys->venc_cfg.video.i_bitrate / 1000 );
+        SetVideoLadderConfig( p_stream, p_sys );
     }
 
     /* Video Filter Parameters */
@@ -454,6 +522,11 @@ static int Open( vlc_object_t *p_this )
         msg_Dbg( p_stream, "codec spu=%4.4s", (char *)&p_sys->senc_cfg.i_codec );
 
     p_sys->b_soverlay = var_GetBool( p_stream, SOUT_CFG_PREFIX "soverlay" );
+    if( p_sys->b_soverlay && p_sys->i_ladder > 0 )
+    {
+        msg_Warn( p_stream, "subtitle overlay is not supported with a ladder" );
+        p_sys->b_soverlay = false;
+    }
     /* Set default size for TEXT spu non overlay conversion / updater */
     p_sys->senc_cfg.spu.i_width = (p_sys->venc_cfg.video.i_width) ? p_sys->venc_cfg.video.i_width : 1280;
     p_sys->senc_cfg.spu.i_height = (p_sys->venc_cfg.video.i_height) ? p_sys->venc_cfg.video.i_height : 720;
@@ -542,6 +615,13 @@ static int ValidateDrift( void *cbdata, vlc_tick_t i_drift )
     return VLC_SUCCESS;
 }
 
+static int SendRendition( void *cbdata, sout_stream_id_sys_t *rendition,
+                          block_t *p_out )
+{
+    sout_stream_t *p_stream = cbdata;
+    return sout_StreamIdSend( p_stream->p_next, rendition->downstream_id, p_out );
+}
+
 static void *transcode_downstream_Add( sout_stream_t *p_stream,
                                        const es_format_t *fmt_orig,
                                        const es_format_t *fmt)
@@ -607,6 +687,11 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
         case VIDEO_ES:
             id->p_filterscfg = &p_sys->vfilters_cfg;
             id->p_enccfg = &p_sys->venc_cfg;
+            if( p_sys->i_ladder > 0 )
+            {
+                id->pf_send_rendition = SendRendition;
+                id->callback_data = p_stream;
+            }
             break;
         case SPU_ES:
             id->p_filterscfg = NULL;
@@ -633,7 +718,8 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
     }
     else if( p_fmt->i_cat == VIDEO_ES && id->p_enccfg->i_codec )
     {
-        success = !transcode_video_init(p_stream, p_fmt, id);
+        success = !transcode_video_init(p_stream, p_fmt, id,
+                                        p_sys->ladder_cfg, p_sys->i_ladder);
         vlc_mutex_lock( &p_sys->lock );
         if( success && !p_sys->id_video )
             p_sys->id_video = id;
@@ -689,6 +775,10 @@ static void Del( sout_stream_t *p_stream, void *_id )
             if( id == p_sys->id_video )
                 p_sys->id_video = NULL;
             vlc_mutex_unlock( &p_sys->lock );
+            for( size_t i = 0; i < id->i_renditions; i++ )
+                if( id->pp_renditions[i]->downstream_id )
+                    sout_StreamIdDel( p_stream->p_next,
+                                      id->pp_renditions[i]->downstream_id );
             transcode_video_clean( id );
             break;
         case SPU_ES:
@@ -6,6 +6,9 @@
 /*100ms is around the limit where people are noticing lipsync issues*/
 #define MASTER_SYNC_MAX_DRIFT VLC_TICK_FROM_MS(100)
 
+/* Maximum number of renditions of a video ladder */
+#define TRANSCODE_LADDER_MAX 8
+
 typedef struct
 {
     char *psz_filters;
@@ -52,6 +55,9 @@ typedef struct
     /* Video */
     transcode_encoder_config_t venc_cfg;
     sout_filters_config_t vfilters_cfg;
+    /* Video ladder, sharing the strings and chain of venc_cfg */
+    transcode_encoder_config_t ladder_cfg[TRANSCODE_LADDER_MAX];
+    size_t          i_ladder;
 
     /* SPU */
     transcode_encoder_config_t senc_cfg;
@@ -106,6 +112,11 @@ struct sout_stream_id_sys_t
             int (*pf_drift_validate)(void *cbdata, vlc_tick_t);
         };
         struct
+        {
+            int (*pf_send_rendition)(void *cbdata, sout_stream_id_sys_t *,
+                                     block_t *);
+        };
+        struct
         {
             void (*pf_send_subpicture)(void *cbdata, subpicture_t *);
             int (*pf_get_output_dimensions)(void *cbdata, unsigned *, unsigned *);
@@ -125,6 +136,15 @@ struct sout_stream_id_sys_t
              spu_t           *p_spu;
              vlc_decoder_device *dec_dev;
              vlc_video_context *enc_vctx_in;
+             /* Ladder renditions, encoding the pictures of this decoder */
+             sout_stream_id_sys_t *pp_renditions[TRANSCODE_LADDER_MAX];
+             size_t          i_renditions;
+             struct transcode_video_stage *p_stage; /**< filter thread */
+             struct
+             {
+                 unsigned    i_blocks;
+                 vlc_tick_t  i_busy;
+             } decode_stats;
          };
          struct
          {
@@ -208,4 +228,5 @@ int transcode_video_get_output_dimensions( sout_stream_id_sys_t *,
                                            unsigned *w, unsigned *h );
 void transcode_video_push_spu( sout_stream_t *, sout_stream_id_sys_t *, subpicture_t * );
 int  transcode_video_init    ( sout_stream_t *, const es_format_t *,
-                               sout_stream_id_sys_t *);
+                               sout_stream_id_sys_t *,
+                               const transcode_encoder_config_t *, size_t );
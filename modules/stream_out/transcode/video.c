@@ -35,6 +35,7 @@
 #include <vlc_spu.h>
 #include <vlc_modules.h>
 #include <vlc_sout.h>
+#include <vlc_queue.h>
 
 #include "transcode.h"
 
@@ -105,7 +106,10 @@ static int video_update_format_decoder( decoder_t *p_dec, vlc_video_context *vct
 
     vlc_mutex_lock( &id->fifo.lock );
 
-    const es_format_t *p_enc_in = transcode_encoder_format_in( id->encoder );
+    /* All the renditions of a ladder encode to the same codec */
+    const transcode_encoder_t *p_enc = id->i_renditions > 0 ?
+                                       id->pp_renditions[0]->encoder : id->encoder;
+    const es_format_t *p_enc_in = transcode_encoder_format_in( p_enc );
 
     if( p_enc_in->i_codec == p_dec->fmt_out.i_codec ||
         video_format_IsSimilar( &id->decoder_out.video, &p_dec->fmt_out.video ) )
@@ -168,8 +172,104 @@ static vlc_picture_chain_t transcode_dequeue_all_pics( sout_stream_id_sys_t *id
     return p_pics;
 }
 
+static int transcode_video_stage_start( sout_stream_t *, sout_stream_id_sys_t * );
+static void transcode_video_stage_delete( sout_stream_id_sys_t * );
+
+/*
+ * Because some info about the decoded input will only be available
+ * once the first frame is decoded, we actually only test the availability
+ * of the encoder here.
+ */
+static int transcode_video_encoder_init( sout_stream_t *p_stream,
+                                         sout_stream_id_sys_t *id )
+{
+    /* Should be the same format until encoder loads */
+    es_format_t encoder_tested_fmt_in;
+    es_format_Init( &encoder_tested_fmt_in, id->decoder_out.i_cat, 0 );
+
+    struct encoder_owner *p_enc_owner = (struct encoder_owner*)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
+    if ( unlikely(p_enc_owner == NULL))
+       goto error;
+
+    p_enc_owner->id = id;
+    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
+
+    if( transcode_encoder_test( &p_enc_owner->enc,
+                                id->p_enccfg,
+                                &id->p_decoder->fmt_in,
+                                id->p_decoder->fmt_out.i_codec,
+                                &encoder_tested_fmt_in ) )
+       goto error;
+
+    p_enc_owner = (struct encoder_owner *)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
+    if ( unlikely(p_enc_owner == NULL))
+       goto error;
+
+    id->encoder = transcode_encoder_new( &p_enc_owner->enc, &encoder_tested_fmt_in );
+    if( !id->encoder )
+       goto error;
+
+    p_enc_owner->id = id;
+    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
+
+    es_format_Clean( &encoder_tested_fmt_in );
+
+    return VLC_SUCCESS;
+
+error:
+    es_format_Clean( &encoder_tested_fmt_in );
+    return VLC_EGENERIC;
+}
+
+/* Creates a rendition, sharing the decoder and filters settings of id */
+static sout_stream_id_sys_t *
+transcode_video_rendition_new( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                               const transcode_encoder_config_t *p_cfg )
+{
+    sout_stream_id_sys_t *rendition = calloc( 1, sizeof( *rendition ) );
+    if( !rendition )
+        return NULL;
+
+    vlc_mutex_init( &rendition->fifo.lock );
+    vlc_picture_chain_Init( &rendition->fifo.pic );
+    rendition->b_transcode = true;
+    rendition->pf_transcode_downstream_add = id->pf_transcode_downstream_add;
+    rendition->p_decoder = id->p_decoder;
+    rendition->p_filterscfg = id->p_filterscfg;
+    rendition->p_enccfg = p_cfg;
+    es_format_Copy( &rendition->decoder_out, &id->decoder_out );
+    if( id->dec_dev )
+        rendition->dec_dev = vlc_decoder_device_Hold( id->dec_dev );
+
+    if( transcode_video_encoder_init( p_stream, rendition ) ||
+        ( p_cfg->video.threads.b_pipeline &&
+          transcode_video_stage_start( p_stream, rendition ) ) )
+    {
+        transcode_video_clean( rendition );
+        free( rendition );
+        return NULL;
+    }
+
+    msg_Dbg( p_stream, "video rendition %ux%u %ukb/s",
+             p_cfg->video.i_width, p_cfg->video.i_height,
+             p_cfg->video.i_bitrate / 1000 );
+    return rendition;
+}
+
+static void transcode_video_renditions_clean( sout_stream_id_sys_t *id )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        transcode_video_clean( id->pp_renditions[i] );
+        free( id->pp_renditions[i] );
+    }
+    id->i_renditions = 0;
+}
+
 int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
-                          sout_stream_id_sys_t *id )
+                          sout_stream_id_sys_t *id,
+                          const transcode_encoder_config_t *p_ladder,
+                          size_t i_ladder )
 {
     msg_Dbg( p_stream,
              "creating video transcoding from fcc=`%4.4s' to fcc=`%4.4s'",
@@ -211,50 +311,47 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
         es_format_Copy( &id->decoder_out, &id->p_decoder->fmt_out );
     }
 
-    /*
-     * Open encoder.
-     * Because some info about the decoded input will only be available
-     * once the first frame is decoded, we actually only test the availability
-     * of the encoder here.
-     */
-
-    /* Should be the same format until encoder loads */
-    es_format_t encoder_tested_fmt_in;
-    es_format_Init( &encoder_tested_fmt_in, id->decoder_out.i_cat, 0 );
-
-    struct encoder_owner *p_enc_owner = (struct encoder_owner*)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
-    if ( unlikely(p_enc_owner == NULL))
-       goto error;
-
-    p_enc_owner->id = id;
-    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
-
-    if( transcode_encoder_test( &p_enc_owner->enc,
-                                id->p_enccfg,
-                                &id->p_decoder->fmt_in,
-                                id->p_decoder->fmt_out.i_codec,
-                                &encoder_tested_fmt_in ) )
-       goto error;
-
-    p_enc_owner = (struct encoder_owner *)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
-    if ( unlikely(p_enc_owner == NULL))
-       goto error;
-
-    id->encoder = transcode_encoder_new( &p_enc_owner->enc, &encoder_tested_fmt_in );
-    if( !id->encoder )
-       goto error;
-
-    p_enc_owner->id = id;
-    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
+    /* Open encoder, or the encoders of all the renditions */
+    if( i_ladder == 0 )
+    {
+        if( transcode_video_encoder_init( p_stream, id ) )
+            goto error;
+        if( id->p_enccfg->video.threads.b_pipeline )
+        {
+            /* Created here, as subpictures get pushed from another thread */
+            id->p_spu = spu_Create( p_stream, NULL );
+            if( transcode_video_stage_start( p_stream, id ) )
+                goto error;
+        }
+        return VLC_SUCCESS;
+    }
 
-    es_format_Clean( &encoder_tested_fmt_in );
+    assert( i_ladder <= TRANSCODE_LADDER_MAX );
+    for( size_t i = 0; i < i_ladder; i++ )
+    {
+        sout_stream_id_sys_t *rendition =
+            transcode_video_rendition_new( p_stream, id, &p_ladder[i] );
+        if( !rendition )
+            goto error;
+        id->pp_renditions[id->i_renditions++] = rendition;
+    }
 
     return VLC_SUCCESS;
 
 error:
+    transcode_video_renditions_clean( id );
+    if( id->encoder )
+    {
+        transcode_encoder_delete( id->encoder );
+        id->encoder = NULL;
+    }
+    if( id->p_spu )
+    {
+        spu_Destroy( id->p_spu );
+        id->p_spu = NULL;
+    }
     module_unneed( id->p_decoder, id->p_decoder->p_module );
     id->p_decoder->p_module = NULL;
-    es_format_Clean( &encoder_tested_fmt_in );
     es_format_Clean( &id->decoder_out );
     return VLC_EGENERIC;
 }
@@ -340,9 +437,15 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
 
 void transcode_video_clean( sout_stream_id_sys_t *id )
 {
+    transcode_video_stage_delete( id );
+    transcode_video_renditions_clean( id );
+
     /* Close encoder */
-    transcode_encoder_close( id->encoder );
-    transcode_encoder_delete( id->encoder );
+    if( id->encoder )
+    {
+        transcode_encoder_close( id->encoder );
+        transcode_encoder_delete( id->encoder );
+    }
 
     es_format_Clean( &id->decoder_out );
 
@@ -361,7 +464,9 @@ void transcode_video_clean( sout_stream_id_sys_t *id )
 void transcode_video_push_spu( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                subpicture_t *p_subpicture )
 {
-    if( !id->p_spu )
+    if( id->i_renditions > 0 ) /* not blended in ladders */
+        subpicture_Delete( p_subpicture );
+    else if( !id->p_spu )
         id->p_spu = spu_Create( p_stream, NULL );
     if( !id->p_spu )
         subpicture_Delete( p_subpicture );
@@ -440,212 +545,402 @@ static void tag_last_block_with_flag( block_t **out, int i_flag )
     }
 }
 
-int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
-                                    block_t *in, block_t **out )
+static bool transcode_video_add_output( sout_stream_t *p_stream,
+                                        sout_stream_id_sys_t *id )
 {
-    *out = NULL;
-
-    bool b_eos = in && (in->i_flags & BLOCK_FLAG_END_OF_SEQUENCE);
+    if( !id->downstream_id )
+        id->downstream_id =
+            id->pf_transcode_downstream_add( p_stream,
+                                             &id->p_decoder->fmt_in,
+                                             transcode_encoder_format_out( id->encoder ) );
+    if( !id->downstream_id )
+    {
+        msg_Err( p_stream, "cannot output transcoded stream %4.4s",
+                           (char *) &id->p_enccfg->i_codec );
+        return false;
+    }
+    return true;
+}
 
-    int ret = id->p_decoder->pf_decode( id->p_decoder, in );
-    if( ret != VLCDEC_SUCCESS )
-        return VLC_EGENERIC;
+static void transcode_video_encode_eos( sout_stream_t *p_stream,
+                                       sout_stream_id_sys_t *id,
+                                       block_t **out )
+{
+    msg_Info( p_stream, "Drain/restart on EOS" );
+    if( transcode_encoder_drain( id->encoder, out ) != VLC_SUCCESS )
+    {
+        id->b_error = true;
+        return;
+    }
+    transcode_encoder_close( id->encoder );
+    /* Close filters */
+    transcode_remove_filters( &id->p_f_chain );
+    transcode_remove_filters( &id->p_uf_chain );
+    transcode_remove_filters( &id->p_final_conv_static );
+    tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
+}
 
-    vlc_picture_chain_t p_pics = transcode_dequeue_all_pics( id );
+/* Configures, filters and encodes one picture, which is always released */
+static void transcode_video_encode_picture( sout_stream_t *p_stream,
+                                            sout_stream_id_sys_t *id,
+                                            picture_t *p_pic, bool *pb_eos,
+                                            block_t **out )
+{
+    if( id->b_error )
+    {
+        picture_Release( p_pic );
+        return;
+    }
 
-    while( !vlc_picture_chain_IsEmpty( &p_pics ) )
+    if( unlikely(!transcode_encoder_opened(id->encoder)) ||
+        !video_format_IsSimilar( &id->decoder_out.video, &p_pic->format ) )
     {
-        picture_t *p_pic = vlc_picture_chain_PopFront( &p_pics );
+        if( !transcode_encoder_opened(id->encoder) ) /* Configure Encoder input/output */
+        {
+            assert( !id->p_f_chain && !id->p_uf_chain );
+            transcode_encoder_video_configure( VLC_OBJECT(p_stream),
+                                               &id->p_decoder->fmt_out.video,
+                                               id->p_enccfg,
+                                               &p_pic->format,
+                                               picture_GetVideoContext(p_pic),
+                                               id->encoder );
+            /* will be opened below */
+        }
+        else /* picture format has changed */
+        {
+            msg_Info( p_stream, "aspect-ratio changed, reiniting. %i -> %i : %i -> %i.",
+                        id->decoder_out.video.i_sar_num, p_pic->format.i_sar_num,
+                        id->decoder_out.video.i_sar_den, p_pic->format.i_sar_den
+                    );
+            /* Close filters, encoder format input can't change */
+            transcode_remove_filters( &id->p_f_chain );
+            transcode_remove_filters( &id->p_uf_chain );
+            transcode_remove_filters( &id->p_final_conv_static );
+            if( id->p_spu_blender )
+                filter_DeleteBlend( id->p_spu_blender );
+            id->p_spu_blender = NULL;
 
-        if( id->b_error && p_pic )
+            video_format_Clean( &id->decoder_out.video );
+        }
+
+        video_format_Copy( &id->decoder_out.video, &p_pic->format );
+        /* Renditions of a ladder miss the format updates of the decoder */
+        id->decoder_out.i_codec = p_pic->format.i_chroma;
+        transcode_video_framerate_apply( &p_pic->format, &id->decoder_out.video );
+        transcode_video_sar_apply( &p_pic->format, &id->decoder_out.video );
+
+        if( !transcode_video_filters_configured( id ) )
         {
-            picture_Release( p_pic );
-            continue;
+            if( transcode_video_filters_init( p_stream,
+                                              id->p_filterscfg,
+                                             &id->decoder_out,
+                                             picture_GetVideoContext(p_pic),
+                                             transcode_encoder_format_in( id->encoder ),
+                                             id ) != VLC_SUCCESS )
+                goto error;
         }
 
-        if( p_pic && ( unlikely(!transcode_encoder_opened(id->encoder)) ||
-              !video_format_IsSimilar( &id->decoder_out.video, &p_pic->format ) ) )
+        /* Store the current encoder input chroma to detect whether we need
+         * a converter in p_final_conv_static. The encoder will override it
+         * if it needs any different format or chroma. */
+        es_format_t filter_fmt_out;
+        es_format_Copy( &filter_fmt_out, transcode_encoder_format_in( id->encoder ) );
+        bool is_encoder_open = transcode_encoder_opened( id->encoder );
+
+        /* Start missing encoder */
+        if( !is_encoder_open &&
+            transcode_encoder_open( id->encoder, id->p_enccfg ) != VLC_SUCCESS )
         {
-            if( !transcode_encoder_opened(id->encoder) ) /* Configure Encoder input/output */
-            {
-                assert( !id->p_f_chain && !id->p_uf_chain );
-                transcode_encoder_video_configure( VLC_OBJECT(p_stream),
-                                                   &id->p_decoder->fmt_out.video,
-                                                   id->p_enccfg,
-                                                   &p_pic->format,
-                                                   picture_GetVideoContext(p_pic),
-                                                   id->encoder );
-                /* will be opened below */
-            }
-            else /* picture format has changed */
-            {
-                msg_Info( p_stream, "aspect-ratio changed, reiniting. %i -> %i : %i -> %i.",
-                            id->decoder_out.video.i_sar_num, p_pic->format.i_sar_num,
-                            id->decoder_out.video.i_sar_den, p_pic->format.i_sar_den
-                        );
-                /* Close filters, encoder format input can't change */
-                transcode_remove_filters( &id->p_f_chain );
-                transcode_remove_filters( &id->p_uf_chain );
-                transcode_remove_filters( &id->p_final_conv_static );
-                if( id->p_spu_blender )
-                    filter_DeleteBlend( id->p_spu_blender );
-                id->p_spu_blender = NULL;
-
-                video_format_Clean( &id->decoder_out.video );
-            }
+            msg_Err( p_stream, "cannot find video encoder (module:%s fourcc:%4.4s). "
+                               "Take a look few lines earlier to see possible reason.",
+                               id->p_enccfg->psz_name ? id->p_enccfg->psz_name : "any",
+                               (char *)&id->p_enccfg->i_codec );
+            goto error;
+        }
 
-            video_format_Copy( &id->decoder_out.video, &p_pic->format );
-            transcode_video_framerate_apply( &p_pic->format, &id->decoder_out.video );
-            transcode_video_sar_apply( &p_pic->format, &id->decoder_out.video );
+        /* The fmt_in may have been overridden by the encoder. */
+        const es_format_t *encoder_fmt_in = transcode_encoder_format_in( id->encoder );
 
-            if( !transcode_video_filters_configured( id ) )
+        /* check if we need to add a converter between last user filter and encoder. */
+        if( filter_fmt_out.i_codec != encoder_fmt_in->i_codec ||
+            id->decoder_out.video.i_width  != encoder_fmt_in->video.i_width ||
+            id->decoder_out.video.i_height != encoder_fmt_in->video.i_height ||
+            id->decoder_out.video.i_visible_width  != encoder_fmt_in->video.i_visible_width ||
+            id->decoder_out.video.i_visible_height != encoder_fmt_in->video.i_visible_height )
+        {
+            if ( !id->p_final_conv_static )
+                id->p_final_conv_static =
+                    filter_chain_NewVideo( p_stream, false, NULL );
+
+            const es_format_t *p_fmt_filtered = &filter_fmt_out;
+            es_format_t tmpdst;
+            if ( id->p_filterscfg->video.b_reorient &&
+                filter_fmt_out.video.orientation != ORIENT_NORMAL )
             {
-                if( transcode_video_filters_init( p_stream,
-                                                  id->p_filterscfg,
-                                                 &id->decoder_out,
-                                                 picture_GetVideoContext(p_pic),
-                                                 transcode_encoder_format_in( id->encoder ),
-                                                 id ) != VLC_SUCCESS )
-                    goto error;
+                es_format_Init( &tmpdst, VIDEO_ES, p_fmt_filtered->video.i_chroma );
+                video_format_ApplyRotation( &tmpdst.video, &p_fmt_filtered->video );
+                p_fmt_filtered = &tmpdst;
             }
 
-            /* Store the current encoder input chroma to detect whether we need
-             * a converter in p_final_conv_static. The encoder will override it
-             * if it needs any different format or chroma. */
-            es_format_t filter_fmt_out;
-            es_format_Copy( &filter_fmt_out, transcode_encoder_format_in( id->encoder ) );
-            bool is_encoder_open = transcode_encoder_opened( id->encoder );
+            filter_chain_Reset( id->p_final_conv_static,
+                                &id->decoder_out,
+                                picture_GetVideoContext(p_pic),
+                                encoder_fmt_in );
+            filter_chain_AppendConverter( id->p_final_conv_static, NULL );
+        }
+        es_format_Clean(&filter_fmt_out);
+
+        msg_Dbg( p_stream, "destination (after video filters) %ux%u",
+                           transcode_encoder_format_in( id->encoder )->video.i_width,
+                           transcode_encoder_format_in( id->encoder )->video.i_height );
 
-            /* Start missing encoder */
-            if( !is_encoder_open &&
-                transcode_encoder_open( id->encoder, id->p_enccfg ) != VLC_SUCCESS )
-            {
-                msg_Err( p_stream, "cannot find video encoder (module:%s fourcc:%4.4s). "
-                                   "Take a look few lines earlier to see possible reason.",
-                                   id->p_enccfg->psz_name ? id->p_enccfg->psz_name : "any",
-                                   (char *)&id->p_enccfg->i_codec );
-                goto error;
-            }
+        /* Outputs can only be added from the stream thread, see
+         * transcode_video_encode_flush() for the filter thread case */
+        if( !id->p_stage && !transcode_video_add_output( p_stream, id ) )
+            goto error;
+    }
 
-            /* The fmt_in may have been overridden by the encoder. */
-            const es_format_t *encoder_fmt_in = transcode_encoder_format_in( id->encoder );
+    /* Run the filter and output chains; first with the picture,
+     * and then with NULL as many times as we need until they
+     * stop outputting frames.
+     */
+    for ( picture_t *p_in = p_pic; ; p_in = NULL /* drain second time */ )
+    {
+        /* Run filter chain */
+        if( id->p_f_chain )
+            p_in = filter_chain_VideoFilter( id->p_f_chain, p_in );
 
-            /* check if we need to add a converter between last user filter and encoder. */
-            if( filter_fmt_out.i_codec != encoder_fmt_in->i_codec ||
-                id->decoder_out.video.i_width  != encoder_fmt_in->video.i_width ||
-                id->decoder_out.video.i_height != encoder_fmt_in->video.i_height ||
-                id->decoder_out.video.i_visible_width  != encoder_fmt_in->video.i_visible_width ||
-                id->decoder_out.video.i_visible_height != encoder_fmt_in->video.i_visible_height )
+        if( !p_in )
+            break;
+
+        for ( ;; p_in = NULL /* drain second time */ )
+        {
+            /* Run user specified filter chain */
+            filter_chain_t * secondary_chains[] = { id->p_uf_chain,
+                                                    id->p_final_conv_static };
+            for( size_t i=0; p_in && i<ARRAY_SIZE(secondary_chains); i++ )
             {
-                if ( !id->p_final_conv_static )
-                    id->p_final_conv_static =
-                        filter_chain_NewVideo( p_stream, false, NULL );
-
-                const es_format_t *p_fmt_filtered = &filter_fmt_out;
-                es_format_t tmpdst;
-                if ( id->p_filterscfg->video.b_reorient &&
-                    filter_fmt_out.video.orientation != ORIENT_NORMAL )
-                {
-                    es_format_Init( &tmpdst, VIDEO_ES, p_fmt_filtered->video.i_chroma );
-                    video_format_ApplyRotation( &tmpdst.video, &p_fmt_filtered->video );
-                    p_fmt_filtered = &tmpdst;
-                }
-
-                filter_chain_Reset( id->p_final_conv_static,
-                                    &id->decoder_out,
-                                    picture_GetVideoContext(p_pic),
-                                    encoder_fmt_in );
-                filter_chain_AppendConverter( id->p_final_conv_static, NULL );
+                if( !secondary_chains[i] )
+                    continue;
+                p_in = filter_chain_VideoFilter( secondary_chains[i], p_in );
             }
-            es_format_Clean(&filter_fmt_out);
-
-            msg_Dbg( p_stream, "destination (after video filters) %ux%u",
-                               transcode_encoder_format_in( id->encoder )->video.i_width,
-                               transcode_encoder_format_in( id->encoder )->video.i_height );
-
-            if( !id->downstream_id )
-                id->downstream_id =
-                    id->pf_transcode_downstream_add( p_stream,
-                                                     &id->p_decoder->fmt_in,
-                                                     transcode_encoder_format_out( id->encoder ) );
-            if( !id->downstream_id )
+
+            if( !p_in )
+                break;
+
+            /* Blend subpictures */
+            p_in = RenderSubpictures( id, p_in );
+
+            if( p_in )
             {
-                msg_Err( p_stream, "cannot output transcoded stream %4.4s",
-                                   (char *) &id->p_enccfg->i_codec );
-                goto error;
+                block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
+                if( p_encoded )
+                    block_ChainAppend( out, p_encoded );
+                picture_Release( p_in );
             }
         }
+    }
+
+    if( *pb_eos )
+    {
+        transcode_video_encode_eos( p_stream, id, out );
+        *pb_eos = false;
+    }
+    return;
+
+error:
+    picture_Release( p_pic );
+    id->b_error = true;
+}
+
+/*
+ * Filter thread
+ *
+ * When pipelined, the filters and scaling of a video ES run in their own
+ * thread, between the decoder (the stream thread) and the encoder thread.
+ * Bounded rings connect the stages, so that a slower stage makes the
+ * previous one wait.
+ */
+struct transcode_video_stage
+{
+    vlc_thread_t    thread;
+    sout_stream_t  *p_stream;
+    sout_stream_id_sys_t *id;
+    vlc_ring_t     *pics; /**< Decoded pictures, or the EOS marker */
+    bool            b_running;
+
+    vlc_mutex_t     lock;
+    block_t        *out; /**< Encoded blocks output by an EOS drain */
 
-        /* Run the filter and output chains; first with the picture,
-         * and then with NULL as many times as we need until they
-         * stop outputting frames.
-         */
-        for ( picture_t *p_in = p_pic; ; p_in = NULL /* drain second time */ )
+    struct
+    {
+        unsigned    i_pictures;
+        vlc_tick_t  i_busy; /**< Time spent filtering, and to queue to the encoder */
+        vlc_tick_t  i_stalled; /**< Time the decoder waited for room */
+    } stats;
+};
+
+static char transcode_video_stage_eos; /* marker queued on end of sequence */
+
+static void *transcode_video_stage_Thread( void *data )
+{
+    struct transcode_video_stage *p_stage = data;
+    sout_stream_id_sys_t *id = p_stage->id;
+    void *p_entry;
+    int canc = vlc_savecancel();
+
+    while( (p_entry = vlc_ring_Dequeue( p_stage->pics )) != NULL )
+    {
+        if( p_entry == &transcode_video_stage_eos )
         {
-            /* Run filter chain */
-            if( id->p_f_chain )
-                p_in = filter_chain_VideoFilter( id->p_f_chain, p_in );
+            /* Drained under the lock to keep the order of the output */
+            vlc_mutex_lock( &p_stage->lock );
+            if( !id->b_error && transcode_encoder_opened( id->encoder ) )
+                transcode_video_encode_eos( p_stage->p_stream, id,
+                                            &p_stage->out );
+            vlc_mutex_unlock( &p_stage->lock );
+            continue;
+        }
 
-            if( !p_in )
-                break;
+        block_t *out = NULL;
+        bool b_eos = false;
+        vlc_tick_t i_start = vlc_tick_now();
 
-            for ( ;; p_in = NULL /* drain second time */ )
-            {
-                /* Run user specified filter chain */
-                filter_chain_t * secondary_chains[] = { id->p_uf_chain,
-                                                        id->p_final_conv_static };
-                for( size_t i=0; p_in && i<ARRAY_SIZE(secondary_chains); i++ )
-                {
-                    if( !secondary_chains[i] )
-                        continue;
-                    p_in = filter_chain_VideoFilter( secondary_chains[i], p_in );
-                }
-
-                if( !p_in )
-                    break;
-
-                /* Blend subpictures */
-                p_in = RenderSubpictures( id, p_in );
-
-                if( p_in )
-                {
-                    block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
-                    if( p_encoded )
-                        block_ChainAppend( out, p_encoded );
-                    picture_Release( p_in );
-                }
-            }
+        transcode_video_encode_picture( p_stage->p_stream, id, p_entry,
+                                        &b_eos, &out );
+        p_stage->stats.i_busy += vlc_tick_now() - i_start;
+        p_stage->stats.i_pictures++;
+
+        if( out )
+        {
+            vlc_mutex_lock( &p_stage->lock );
+            block_ChainAppend( &p_stage->out, out );
+            vlc_mutex_unlock( &p_stage->lock );
         }
+    }
+
+    vlc_restorecancel( canc );
+    return NULL;
+}
 
-        if( b_eos )
+static int transcode_video_stage_start( sout_stream_t *p_stream,
+                                        sout_stream_id_sys_t *id )
+{
+    struct transcode_video_stage *p_stage = calloc( 1, sizeof( *p_stage ) );
+    if( !p_stage )
+        return VLC_ENOMEM;
+
+    p_stage->pics = vlc_ring_New( id->p_enccfg->video.threads.pool_size, 0 );
+    if( !p_stage->pics )
+    {
+        free( p_stage );
+        return VLC_ENOMEM;
+    }
+    p_stage->p_stream = p_stream;
+    p_stage->id = id;
+    vlc_mutex_init( &p_stage->lock );
+
+    /* Set before the thread runs the filters */
+    id->p_stage = p_stage;
+    if( vlc_clone( &p_stage->thread, transcode_video_stage_Thread, p_stage,
+                   id->p_enccfg->video.threads.i_priority ) )
+    {
+        id->p_stage = NULL;
+        vlc_ring_Delete( p_stage->pics );
+        free( p_stage );
+        return VLC_EGENERIC;
+    }
+    p_stage->b_running = true;
+    return VLC_SUCCESS;
+}
+
+/* Waits for the queued pictures to be filtered */
+static void transcode_video_stage_stop( struct transcode_video_stage *p_stage )
+{
+    if( !p_stage->b_running )
+        return;
+
+    vlc_ring_Kill( p_stage->pics );
+    vlc_join( p_stage->thread, NULL );
+    p_stage->b_running = false;
+
+    msg_Dbg( p_stage->p_stream, "filtered %u pictures in %"PRId64" ms, "
+             "decoder stalled for %"PRId64" ms", p_stage->stats.i_pictures,
+             MS_FROM_VLC_TICK( p_stage->stats.i_busy ),
+             MS_FROM_VLC_TICK( p_stage->stats.i_stalled ) );
+}
+
+static void transcode_video_stage_delete( sout_stream_id_sys_t *id )
+{
+    struct transcode_video_stage *p_stage = id->p_stage;
+    if( !p_stage )
+        return;
+
+    transcode_video_stage_stop( p_stage );
+    vlc_ring_Delete( p_stage->pics );
+    block_ChainRelease( p_stage->out );
+    free( p_stage );
+    id->p_stage = NULL;
+}
+
+static void transcode_video_stage_push( struct transcode_video_stage *p_stage,
+                                        void *p_entry )
+{
+    if( vlc_ring_TryEnqueue( p_stage->pics, p_entry ) )
+        return;
+
+    /* Back-pressure: wait for the filter thread to catch up */
+    vlc_tick_t i_start = vlc_tick_now();
+    if( vlc_ring_Enqueue( p_stage->pics, p_entry )
+     && p_entry != &transcode_video_stage_eos )
+        picture_Release( p_entry );
+    p_stage->stats.i_stalled += vlc_tick_now() - i_start;
+}
+
+/* Filters and encodes a picture here, or in the filter thread */
+static void transcode_video_submit( sout_stream_t *p_stream,
+                                    sout_stream_id_sys_t *id,
+                                    picture_t *p_pic, bool *pb_eos,
+                                    block_t **out )
+{
+    if( id->p_stage )
+        transcode_video_stage_push( id->p_stage, p_pic );
+    else
+        transcode_video_encode_picture( p_stream, id, p_pic, pb_eos, out );
+}
+
+/* Picks up the output of the encoder thread, and drains on end of stream */
+static void transcode_video_encode_flush( sout_stream_t *p_stream,
+                                          sout_stream_id_sys_t *id,
+                                          bool b_drain, bool b_eos,
+                                          block_t **out )
+{
+    struct transcode_video_stage *p_stage = id->p_stage;
+
+    if( p_stage )
+    {
+        if( b_eos ) /* tagged by the filter thread */
         {
-            msg_Info( p_stream, "Drain/restart on EOS" );
-            if( transcode_encoder_drain( id->encoder, out ) != VLC_SUCCESS )
-                goto error;
-            transcode_encoder_close( id->encoder );
-            /* Close filters */
-            transcode_remove_filters( &id->p_f_chain );
-            transcode_remove_filters( &id->p_uf_chain );
-            transcode_remove_filters( &id->p_final_conv_static );
-            tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
+            transcode_video_stage_push( p_stage, &transcode_video_stage_eos );
             b_eos = false;
         }
+        if( b_drain )
+            transcode_video_stage_stop( p_stage );
 
-        continue;
-error:
-        if( p_pic )
-            picture_Release( p_pic );
-        id->b_error = true;
+        vlc_mutex_lock( &p_stage->lock );
+        block_ChainAppend( out, p_stage->out );
+        p_stage->out = NULL;
+        block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
+        vlc_mutex_unlock( &p_stage->lock );
     }
-
-    if( id->p_enccfg->video.threads.i_count >= 1 )
+    else if( id->p_enccfg->video.threads.i_count >= 1 )
     {
         /* Pick up any return data the encoder thread wants to output. */
         block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
     }
 
     /* Drain encoder */
-    if( unlikely( !id->b_error && in == NULL ) && transcode_encoder_opened( id->encoder ) )
+    if( unlikely( !id->b_error && b_drain ) && transcode_encoder_opened( id->encoder ) )
     {
         msg_Dbg( p_stream, "Flushing thread and waiting that");
         if( transcode_encoder_drain( id->encoder, out ) == VLC_SUCCESS )
@@ -656,6 +951,133 @@ error:
 
     if( b_eos )
         tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
+}
+
+/* Adds the output of a pipelined ES with its first encoded blocks, as the
+ * encoder output format is only known from the filter thread by then */
+static void transcode_video_stage_output( sout_stream_t *p_stream,
+                                          sout_stream_id_sys_t *id,
+                                          block_t **out )
+{
+    if( *out && !id->b_error && !transcode_video_add_output( p_stream, id ) )
+        id->b_error = true;
+    if( id->b_error )
+    {
+        block_ChainRelease( *out );
+        *out = NULL;
+    }
+}
+
+/* Gives blocks back to the filter thread, to be picked up again later */
+static void transcode_video_stage_unget( struct transcode_video_stage *p_stage,
+                                         block_t *out )
+{
+    vlc_mutex_lock( &p_stage->lock );
+    block_ChainAppend( &out, p_stage->out );
+    p_stage->out = out;
+    vlc_mutex_unlock( &p_stage->lock );
+}
+
+/* Sends every decoded picture to all the renditions of a ladder. Each
+ * rendition scales on this thread, then queues its picture to its own
+ * encoder thread, so that the encoders run in parallel. */
+static int transcode_video_ladder_process( sout_stream_t *p_stream,
+                                           sout_stream_id_sys_t *id,
+                                           vlc_picture_chain_t *p_pics,
+                                           bool b_drain, bool b_eos )
+{
+    bool eos[TRANSCODE_LADDER_MAX];
+    block_t *out[TRANSCODE_LADDER_MAX];
+
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        eos[i] = b_eos;
+        out[i] = NULL;
+    }
+
+    while( !vlc_picture_chain_IsEmpty( p_pics ) )
+    {
+        picture_t *p_pic = vlc_picture_chain_PopFront( p_pics );
+
+        for( size_t i = 0; i < id->i_renditions; i++ )
+        {
+            /* Pictures are chained in the encoder queues, so each rendition
+             * needs its own picture, referencing the decoded pixels */
+            picture_t *p_clone = picture_Clone( p_pic );
+            if( unlikely(p_clone == NULL) )
+                continue;
+            picture_CopyProperties( p_clone, p_pic );
+            transcode_video_submit( p_stream, id->pp_renditions[i],
+                                    p_clone, &eos[i], &out[i] );
+        }
+        picture_Release( p_pic );
+    }
+
+    bool b_error = true, b_ordered = true;
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        sout_stream_id_sys_t *rendition = id->pp_renditions[i];
+
+        transcode_video_encode_flush( p_stream, rendition, b_drain, eos[i],
+                                      &out[i] );
+        if( rendition->p_stage )
+        {
+            /* Add the outputs in the order of the ladder */
+            if( out[i] && !b_ordered && !b_drain )
+            {
+                transcode_video_stage_unget( rendition->p_stage, out[i] );
+                out[i] = NULL;
+            }
+            transcode_video_stage_output( p_stream, rendition, &out[i] );
+        }
+        if( !rendition->downstream_id && !rendition->b_error )
+            b_ordered = false;
+
+        if( out[i] && id->pf_send_rendition( id->callback_data, rendition,
+                                             out[i] ) )
+            rendition->b_error = true;
+        b_error &= rendition->b_error;
+    }
+
+    /* The ladder goes on as long as one rendition works */
+    id->b_error = b_error;
+    return b_error ? VLC_EGENERIC : VLC_SUCCESS;
+}
+
+int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                                    block_t *in, block_t **out )
+{
+    *out = NULL;
+
+    bool b_eos = in && (in->i_flags & BLOCK_FLAG_END_OF_SEQUENCE);
+
+    vlc_tick_t i_start = vlc_tick_now();
+    int ret = id->p_decoder->pf_decode( id->p_decoder, in );
+    id->decode_stats.i_busy += vlc_tick_now() - i_start;
+    if( ret != VLCDEC_SUCCESS )
+        return VLC_EGENERIC;
+
+    if( in )
+        id->decode_stats.i_blocks++;
+    else
+        msg_Dbg( p_stream, "decoded %u blocks in %"PRId64" ms",
+                 id->decode_stats.i_blocks,
+                 MS_FROM_VLC_TICK( id->decode_stats.i_busy ) );
+
+    vlc_picture_chain_t p_pics = transcode_dequeue_all_pics( id );
+
+    if( id->i_renditions > 0 )
+        return transcode_video_ladder_process( p_stream, id, &p_pics,
+                                               in == NULL, b_eos );
+
+    while( !vlc_picture_chain_IsEmpty( &p_pics ) )
+        transcode_video_submit( p_stream, id,
+                                vlc_picture_chain_PopFront( &p_pics ),
+                                &b_eos, out );
+
+    transcode_video_encode_flush( p_stream, id, in == NULL, b_eos, out );
+    if( id->p_stage )
+        transcode_video_stage_output( p_stream, id, out );
 
     return id->b_error ? VLC_EGENERIC : VLC_SUCCESS;
 }
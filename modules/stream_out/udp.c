@@ -29,6 +29,10 @@
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
 #endif
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_block.h>
@@ -39,6 +43,15 @@
 #include <vlc_memstream.h>
 #include "sdp_helper.h"
 
+#ifdef UDP_SEGMENT
+/* Kernel limits for UDP segmentation offload */
+# define GSO_MAX_SEGS 64
+#else
+# define GSO_MAX_SEGS 1
+#endif
+/* Largest UDP payload, with an IPv4 header */
+#define GSO_MAX_SIZE 65507
+
 struct sout_stream_udp
 {
     sout_access_out_t *access;
@@ -46,6 +59,14 @@ struct sout_stream_udp
     session_descriptor_t *sap;
     int fd;
     uint_fast16_t mtu;
+    unsigned max_segs; /**< datagrams per system call */
+
+    struct {
+        uint64_t datagrams;
+        uint64_t syscalls;
+        uint64_t bytes;
+        vlc_tick_t start;
+    } stats;
 };
 
 static void *Add(sout_stream_t *stream, const es_format_t *fmt)
@@ -145,39 +166,116 @@ static int Control(sout_stream_t *stream, int query, va_list args)
     return VLC_SUCCESS;
 }
 
+/* Maximum number of blocks gathered into one datagram */
+#define DGRAM_IOV_MAX 16
+
+/**
+ * Gathers blocks into one datagram of at most the MTU (unless a single block
+ * is larger).
+ *
+ * \return the number of I/O vectors used
+ */
+static unsigned GatherDatagram(const struct sout_stream_udp *sys,
+                               block_t **restrict blockp,
+                               struct iovec *restrict iov,
+                               size_t *restrict lenp)
+{
+    block_t *block = *blockp;
+    unsigned iovlen = 0;
+    size_t len = 0;
+
+    do {
+        if (iovlen >= DGRAM_IOV_MAX)
+            break;
+        if (block->i_buffer + len > sys->mtu && likely(iovlen > 0))
+            break;
+
+        iov[iovlen].iov_base = block->p_buffer;
+        iov[iovlen].iov_len = block->i_buffer;
+        iovlen++;
+        len += block->i_buffer;
+        block = block->p_next;
+    } while (block != NULL);
+
+    *blockp = block;
+    *lenp = len;
+    return iovlen;
+}
+
 static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
 {
     struct sout_stream_udp *sys = access->p_sys;
     ssize_t total = 0;
 
     while (block != NULL) {
-        struct iovec iov[16];
+        struct iovec iov[4 * DGRAM_IOV_MAX];
         block_t *unsent = block;
-        unsigned iovlen = 0;
-        size_t tosend = 0;
+        unsigned iovlen = 0, segs = 0;
+        size_t segsize = 0, tosend = 0;
 
-        /* Count how many blocks to gather */
+        /* Gather datagrams of the same size, except for the last one, so
+         * that the kernel can segment them (on Linux). */
         do {
-            if (iovlen >= ARRAY_SIZE(iov))
+            block_t *next = unsent;
+            size_t len;
+
+            if (iovlen + DGRAM_IOV_MAX > ARRAY_SIZE(iov))
                 break;
-            if (unsent->i_buffer + tosend > sys->mtu && likely(iovlen > 0))
+
+            unsigned n = GatherDatagram(sys, &next, iov + iovlen, &len);
+
+            if (segs > 0 && (len > segsize || tosend + len > GSO_MAX_SIZE))
                 break;
 
-            iov[iovlen].iov_base = unsent->p_buffer;
-            iov[iovlen].iov_len = unsent->i_buffer;
-            iovlen++;
-            tosend += unsent->i_buffer;
-            unsent = unsent->p_next;
-        } while (unsent != NULL);
+            iovlen += n;
+            tosend += len;
+            unsent = next;
+
+            if (segs++ == 0)
+                segsize = len;
+            else if (len < segsize)
+                break;
+        } while (unsent != NULL && segs < sys->max_segs);
 
         /* Send */
         struct msghdr hdr = { .msg_iov = iov, .msg_iovlen = iovlen };
-        int val = sendmsg(sys->fd, &hdr, 0);
+#ifdef UDP_SEGMENT
+        union {
+            struct cmsghdr hdr;
+            char buf[CMSG_SPACE(sizeof (uint16_t))];
+        } cmsg;
+
+        if (segs > 1) {
+            uint16_t size = segsize;
+
+            hdr.msg_control = &cmsg;
+            hdr.msg_controllen = sizeof (cmsg);
 
+            struct cmsghdr *c = CMSG_FIRSTHDR(&hdr);
+
+            c->cmsg_level = IPPROTO_UDP;
+            c->cmsg_type = UDP_SEGMENT;
+            c->cmsg_len = CMSG_LEN(sizeof (size));
+            memcpy(CMSG_DATA(c), &size, sizeof (size));
+        }
+#endif
+        ssize_t val = sendmsg(sys->fd, &hdr, 0);
+
+        if (val < 0 && segs > 1 && (errno == EINVAL || errno == EIO)) {
+            msg_Warn(access, "segmentation offload failed: %s",
+                     vlc_strerror_c(errno));
+            sys->max_segs = 1;
+            continue; /* retry the same blocks, one datagram at a time */
+        }
+
+        sys->stats.syscalls++;
         if (val < 0)
             msg_Err(access, "send error: %s", vlc_strerror_c(errno));
-        else
+        else {
+            sys->stats.datagrams += segs;
+            sys->stats.bytes += val;
             total += val;
+        }
 
         /* Free */
         do {
@@ -202,6 +300,15 @@ static void Close(vlc_object_t *obj)
     sout_MuxDelete(sys->mux);
     sout_AccessOutDelete(sys->access);
     net_Close(sys->fd);
+
+    vlc_tick_t elapsed = vlc_tick_now() - sys->stats.start;
+
+    if (sys->stats.syscalls > 0 && elapsed > 0)
+        msg_Dbg(stream, "sent %"PRIu64" datagrams in %"PRIu64" calls, "
+                "%.0f datagram/s, %.3f Mbit/s", sys->stats.datagrams,
+                sys->stats.syscalls,
+                sys->stats.datagrams * (double)CLOCK_FREQ / elapsed,
+                sys->stats.bytes * 8. * CLOCK_FREQ / elapsed / 1e6);
     free(sys);
 }
 
@@ -308,6 +415,11 @@ static int Open(vlc_object_t *obj)
     sys->access = access;
     sys->fd = fd;
     sys->mtu = var_InheritInteger(stream, "mtu");
+    sys->max_segs = GSO_MAX_SEGS;
+    sys->stats.datagrams = 0;
+    sys->stats.syscalls = 0;
+    sys->stats.bytes = 0;
+    sys->stats.start = vlc_tick_now();
 
     sout_mux_t *mux = sout_MuxNew(access, muxmod);
     if (mux == NULL) {
@@ -60,6 +60,12 @@ struct vlc_font_select_t
      */
     vlc_dictionary_t  fallback_map;
 
+    /**
+     * This maps a fallback list and a block of codepoints to the last
+     * vlc_family_t of that list found to cover a codepoint of the block
+     */
+    vlc_dictionary_t  fallback_hints;
+
     int               i_fallback_counter;
 
 #if defined( _WIN32 )
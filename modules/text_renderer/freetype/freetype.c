@@ -41,6 +41,7 @@
 #include <vlc_subpicture.h>
 #include <vlc_text_style.h>                                   /* text_style_t*/
 #include <vlc_charset.h>
+#include <vlc_memstream.h>
 
 #include <assert.h>
 
@@ -971,6 +972,102 @@ static size_t SegmentsToTextAndStyles( filter_t *p_filter, const text_segment_t
     return i_nb_char;
 }
 
+/* Rendered regions, returned again for the same text and layout as long as
+ * they are in the cache, without shaping nor blending the glyphs again. */
+#define RENDER_CACHE_SIZE 8
+
+typedef struct
+{
+    picture_t     *p_picture;
+    video_format_t fmt;
+    int            i_x;
+    int            i_y;
+} render_cache_entry_t;
+
+static void RenderCacheReleaseEntry( void *priv, void *value )
+{
+    VLC_UNUSED(priv);
+    render_cache_entry_t *p_entry = value;
+    picture_Release( p_entry->p_picture );
+    free( p_entry );
+}
+
+static void RenderCacheAddStyle( struct vlc_memstream *ms, const text_style_t *p_style )
+{
+    vlc_memstream_printf( ms, "{%s|%s|%x|%x|%a|%d|%x|%x|%d|%x|%x|%d|%x|%x|%d|%x|%x|%d}",
+                          p_style->psz_fontname ? p_style->psz_fontname : "",
+                          p_style->psz_monofontname ? p_style->psz_monofontname : "",
+                          p_style->i_features, p_style->i_style_flags,
+                          p_style->f_font_relsize, p_style->i_font_size,
+                          p_style->i_font_color, p_style->i_font_alpha,
+                          p_style->i_spacing,
+                          p_style->i_outline_color, p_style->i_outline_alpha,
+                          p_style->i_outline_width,
+                          p_style->i_shadow_color, p_style->i_shadow_alpha,
+                          p_style->i_shadow_width,
+                          p_style->i_background_color, p_style->i_background_alpha,
+                          p_style->e_wrapinfo );
+}
+
+/**
+ * Builds the key of a rendered region, from everything Render() depends on
+ */
+static char *RenderCacheKey( filter_t *p_filter,
+                             const subpicture_region_t *p_region_out,
+                             const subpicture_region_t *p_region_in,
+                             const layout_text_block_t *p_text_block,
+                             const vlc_fourcc_t *p_chroma_list )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const video_format_t *p_fmt = &p_filter->fmt_out.video;
+    struct vlc_memstream ms;
+
+    if( vlc_memstream_open( &ms ) )
+        return NULL;
+
+    vlc_memstream_printf( &ms, "%d:%d:%d:%ux%u:%ux%u:%d,%d:%d,%d:%x:%x:%d%d%d:%u/%u:%d,%d,%d:",
+                          p_sys->i_scale, p_sys->i_font_default_size,
+                          p_sys->i_outline_thickness,
+                          p_fmt->i_width, p_fmt->i_height,
+                          p_fmt->i_visible_width, p_fmt->i_visible_height,
+                          p_region_in->i_x, p_region_in->i_y,
+                          p_region_in->i_max_width, p_region_in->i_max_height,
+                          p_region_in->i_text_align, p_region_out->i_text_align,
+                          p_region_in->b_gridmode, p_region_in->b_balanced_text,
+                          p_region_out->b_noregionbg,
+                          p_region_out->fmt.i_sar_num, p_region_out->fmt.i_sar_den,
+                          p_region_out->fmt.transfer, p_region_out->fmt.primaries,
+                          p_region_out->fmt.space );
+
+    for( const vlc_fourcc_t *p_chroma = p_chroma_list; *p_chroma != 0; p_chroma++ )
+        vlc_memstream_printf( &ms, "%"PRIx32",", *p_chroma );
+
+    const text_style_t *p_style = NULL;
+    const ruby_block_t *p_ruby = NULL;
+    for( size_t i = 0; i < p_text_block->i_count; i++ )
+    {
+        if( p_text_block->pp_styles[i] != p_style )
+        {
+            p_style = p_text_block->pp_styles[i];
+            RenderCacheAddStyle( &ms, p_style );
+        }
+        if( p_text_block->pp_ruby && p_text_block->pp_ruby[i] != p_ruby )
+        {
+            p_ruby = p_text_block->pp_ruby[i];
+            vlc_memstream_putc( &ms, '<' );
+            if( p_ruby )
+                for( size_t j = 0; j < p_ruby->i_count; j++ )
+                    vlc_memstream_printf( &ms, "%"PRIx32",", p_ruby->p_uchars[j] );
+            vlc_memstream_putc( &ms, '>' );
+        }
+        vlc_memstream_printf( &ms, "%"PRIx32",", p_text_block->p_uchars[i] );
+    }
+
+    if( vlc_memstream_close( &ms ) )
+        return NULL;
+    return ms.ptr;
+}
+
 /**
  * This function renders a text subpicture region into another one.
  * It also calculates the size needed for this string, and renders the
@@ -1015,6 +1112,40 @@ static int Render( filter_t *p_filter, subpicture_region_t *p_region_out,
         return VLC_EGENERIC;
     }
 
+    const vlc_fourcc_t p_chroma_list_yuvp[] = { VLC_CODEC_YUVP, 0 };
+    const vlc_fourcc_t p_chroma_list_rgba[] = { VLC_CODEC_RGBA, 0 };
+
+    if( p_sys->i_forced_chroma == VLC_CODEC_YUVP )
+        p_chroma_list = p_chroma_list_yuvp;
+    else if( !p_chroma_list || *p_chroma_list == 0 )
+        p_chroma_list = p_chroma_list_rgba;
+
+    char *psz_cache_key = NULL;
+    if( p_sys->render_cache && p_sys->i_forced_chroma != VLC_CODEC_YUVP )
+    {
+        psz_cache_key = RenderCacheKey( p_filter, p_region_out, p_region_in,
+                                        &text_block, p_chroma_list );
+        render_cache_entry_t *p_entry = psz_cache_key ?
+            vlc_lru_Get( p_sys->render_cache, psz_cache_key ) : NULL;
+        if( p_entry )
+        {
+            assert( !p_region_out->p_picture );
+            p_region_out->p_picture = picture_Hold( p_entry->p_picture );
+            video_format_t fmt = p_entry->fmt;
+            fmt.mastering = p_region_out->fmt.mastering;
+            p_region_out->fmt = fmt;
+            p_region_out->i_x = p_entry->i_x;
+            p_region_out->i_y = p_entry->i_y;
+
+            free( psz_cache_key );
+            free( text_block.p_uchars );
+            FreeStylesArray( text_block.pp_styles, text_block.i_count );
+            if( text_block.pp_ruby )
+                FreeRubyBlockArray( text_block.pp_ruby, text_block.i_count );
+            return VLC_SUCCESS;
+        }
+    }
+
     /* */
     int rv = VLC_SUCCESS;
     FT_BBox bbox;
@@ -1040,20 +1171,12 @@ static int Render( filter_t *p_filter, subpicture_region_t *p_region_out,
      * properly. */
     if( !rv && text_block.i_count > 0 && bbox.xMin < bbox.xMax && bbox.yMin < bbox.yMax )
     {
-        const vlc_fourcc_t p_chroma_list_yuvp[] = { VLC_CODEC_YUVP, 0 };
-        const vlc_fourcc_t p_chroma_list_rgba[] = { VLC_CODEC_RGBA, 0 };
-
         int i_margin = (p_sys->p_default_style->i_background_alpha > 0 && !p_region_in->b_gridmode)
                      ? i_max_face_height / 4 : 0;
 
         if( (unsigned)i_margin * 2 >= i_max_width || (unsigned)i_margin * 2 >= i_max_height )
             i_margin = 0;
 
-        if( p_sys->i_forced_chroma == VLC_CODEC_YUVP )
-            p_chroma_list = p_chroma_list_yuvp;
-        else if( !p_chroma_list || *p_chroma_list == 0 )
-            p_chroma_list = p_chroma_list_rgba;
-
         FT_BBox paddedbbox = bbox;
         paddedbbox.xMin -= i_margin;
         paddedbbox.xMax += i_margin;
@@ -1182,6 +1305,21 @@ static int Render( filter_t *p_filter, subpicture_region_t *p_region_out,
 
     FreeLines( text_block.p_laid );
 
+    if( psz_cache_key && rv == VLC_SUCCESS
+     && p_region_out->fmt.i_chroma != VLC_CODEC_YUVP )
+    {
+        render_cache_entry_t *p_entry = malloc( sizeof(*p_entry) );
+        if( p_entry )
+        {
+            p_entry->p_picture = picture_Hold( p_region_out->p_picture );
+            p_entry->fmt = p_region_out->fmt;
+            p_entry->i_x = p_region_out->i_x;
+            p_entry->i_y = p_region_out->i_y;
+            vlc_lru_Insert( p_sys->render_cache, psz_cache_key, p_entry );
+        }
+    }
+    free( psz_cache_key );
+
     free( text_block.p_uchars );
     FreeStylesArray( text_block.pp_styles, text_block.i_count );
     if( text_block.pp_ruby )
@@ -1228,6 +1366,11 @@ static int Create( filter_t *p_filter )
     if( !p_sys->ftcache )
         goto error;
 
+    p_sys->render_cache = vlc_lru_New( RENDER_CACHE_SIZE,
+                                       RenderCacheReleaseEntry, NULL );
+    if( !p_sys->render_cache )
+        goto error;
+
     p_sys->i_scale = 100;
 
     /* default style to apply to incomplete segments styles */
@@ -1294,6 +1437,9 @@ static void Destroy( filter_t *p_filter )
         DumpFamilies( p_sys->fs );
 #endif
 
+    if( p_sys->render_cache )
+        vlc_lru_Release( p_sys->render_cache );
+
     if( p_sys->ftcache )
         vlc_ftcache_Delete( p_sys->ftcache );
 
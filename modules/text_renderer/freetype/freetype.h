@@ -73,6 +73,7 @@ typedef uint32_t uni_char_t;
 #endif
 
 #include "ftcache.h"
+#include "lru.h"
 
 typedef struct vlc_font_select_t vlc_font_select_t;
 
@@ -113,6 +114,9 @@ typedef struct
     vlc_font_select_t *fs;
     vlc_ftcache_t     *ftcache;
 
+    /* Last rendered regions, by text, styles and layout constraints */
+    vlc_lru           *render_cache;
+
 } filter_sys_t;
 
 /**
@@ -146,11 +146,26 @@ static vlc_font_t *GetBestFont( vlc_font_select_t *fs, const vlc_family_t *p_fam
     return p_family->p_fonts;
 }
 
+/* Codepoints per block of the fallback hints, as most Unicode blocks are
+ * multiples of 128 codepoints */
+#define FB_HINT_BLOCK_SHIFT 7
+
 vlc_family_t *SearchFallbacks( vlc_font_select_t *fs, vlc_family_t *p_fallbacks,
                                       uni_char_t codepoint )
 {
     vlc_family_t *p_family = NULL;
 
+    /* A family covering a codepoint usually covers its whole block: try the
+     * one found previously first, instead of loading every fallback face */
+    char psz_hint[32];
+    snprintf( psz_hint, sizeof(psz_hint), "%p/%"PRIx32,
+              (void *) p_fallbacks, codepoint >> FB_HINT_BLOCK_SHIFT );
+    vlc_family_t *p_hint = vlc_dictionary_value_for_key( &fs->fallback_hints,
+                                                         psz_hint );
+    if( p_hint != kVLCDictionaryNotFound &&
+        CheckFace( fs, p_hint->p_fonts, codepoint ) )
+        return p_hint;
+
     for( vlc_family_t *p_fallback = p_fallbacks; p_fallback;
          p_fallback = p_fallback->p_next )
     {
@@ -169,6 +184,13 @@ vlc_family_t *SearchFallbacks( vlc_font_select_t *fs, vlc_family_t *p_fallbacks,
         break;
     }
 
+    if( p_family )
+    {
+        vlc_dictionary_remove_value_for_key( &fs->fallback_hints, psz_hint,
+                                             NULL, NULL );
+        vlc_dictionary_insert( &fs->fallback_hints, psz_hint, p_family );
+    }
+
     return p_family;
 }
 
@@ -875,6 +897,7 @@ vlc_font_select_t * FontSelectNew( filter_t *p_filter )
     /* Dictionaries for families */
     vlc_dictionary_init( &fs->family_map, 53 );
     vlc_dictionary_init( &fs->fallback_map, 23 );
+    vlc_dictionary_init( &fs->fallback_hints, 53 );
 
     fs->families_lookup_lru = vlc_lru_New( 23, NULL, NULL );
     if( !fs->families_lookup_lru )
@@ -954,6 +977,7 @@ void FontSelectDelete( vlc_font_select_t *fs )
         vlc_lru_Release( fs->families_lookup_lru );
 
     /* Dicts */
+    vlc_dictionary_clear( &fs->fallback_hints, NULL, NULL );
     vlc_dictionary_clear( &fs->fallback_map, FreeFamilies, fs );
     vlc_dictionary_clear( &fs->family_map, NULL, NULL );
     if( fs->p_families )
@@ -33,6 +33,12 @@
 #include <vlc_picture.h>
 #include <vlc_cpu.h>
 #include <assert.h>
+#if defined (HAVE_AVX2_INTRINSICS) || defined (HAVE_AVX512_INTRINSICS)
+# include <immintrin.h>
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+# include <arm_neon.h>
+#endif
 
 #include "copy.h"
 static void CopyPlane(uint8_t *dst, size_t dst_pitch,
@@ -130,6 +136,10 @@ void CopyCleanCache(copy_cache_t *cache)
 # define vlc_CPU_SSSE3() (0)
 # undef vlc_CPU_SSE2
 # define vlc_CPU_SSE2() (0)
+# undef vlc_CPU_AVX2
+# define vlc_CPU_AVX2() (0)
+# undef vlc_CPU_AVX512
+# define vlc_CPU_AVX512() (0)
 #endif
 
 /* Optimized copy from "Uncacheable Speculative Write Combining" memory
@@ -460,6 +470,239 @@ static void SSE_SplitUV(uint8_t *dstu, size_t dstu_pitch,
 #undef LOAD64
 }
 
+#ifdef HAVE_AVX2_INTRINSICS
+/* The AVX2 and AVX-512 variants only replace the cache-to-destination step:
+ * the source is still read through CopyFromUswc() (which also applies the
+ * bit shift), as wider non-temporal loads do not help on USWC memory. */
+__attribute__ ((__target__ ("avx2")))
+static void AVX2_SplitUV(uint8_t *dstu, size_t dstu_pitch,
+                         uint8_t *dstv, size_t dstv_pitch,
+                         const uint8_t *src, size_t src_pitch,
+                         unsigned width, unsigned height, uint8_t pixel_size)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+
+    /* Gather the U samples in the low and the V samples in the high
+     * quadword of each 128-bits lane */
+    const __m256i shuffle = pixel_size == 1
+        ? _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+                           0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15)
+        : _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+                           0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        unsigned x = 0;
+
+        for (; x < (width & ~31); x += 32)
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i *)&src[2*x]);
+            __m256i b = _mm256_loadu_si256((const __m256i *)&src[2*x+32]);
+
+            a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(a, shuffle), 0xD8);
+            b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(b, shuffle), 0xD8);
+            _mm256_storeu_si256((__m256i *)&dstu[x],
+                                _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256((__m256i *)&dstv[x],
+                                _mm256_permute2x128_si256(a, b, 0x31));
+        }
+
+        if (pixel_size == 1)
+        {
+            for (; x < width; x++) {
+                dstu[x] = src[2*x+0];
+                dstv[x] = src[2*x+1];
+            }
+        }
+        else
+        {
+            for (; x < width; x+= 2) {
+                dstu[x] = src[2*x+0];
+                dstu[x+1] = src[2*x+1];
+                dstv[x] = src[2*x+2];
+                dstv[x+1] = src[2*x+3];
+            }
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void AVX2_InterleaveUV(uint8_t *dst, size_t dst_pitch,
+                              const uint8_t *srcu, size_t srcu_pitch,
+                              const uint8_t *srcv, size_t srcv_pitch,
+                              unsigned width, unsigned height,
+                              uint8_t pixel_size)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        unsigned x = 0;
+
+        for (; x < (width & ~31); x += 32)
+        {
+            /* Swap the middle quadwords, so that unpacking within the lanes
+             * yields the samples in order */
+            __m256i u = _mm256_permute4x64_epi64(
+                _mm256_loadu_si256((const __m256i *)&srcu[x]), 0xD8);
+            __m256i v = _mm256_permute4x64_epi64(
+                _mm256_loadu_si256((const __m256i *)&srcv[x]), 0xD8);
+            __m256i lo, hi;
+
+            if (pixel_size == 1)
+            {
+                lo = _mm256_unpacklo_epi8(u, v);
+                hi = _mm256_unpackhi_epi8(u, v);
+            }
+            else
+            {
+                lo = _mm256_unpacklo_epi16(u, v);
+                hi = _mm256_unpackhi_epi16(u, v);
+            }
+            _mm256_storeu_si256((__m256i *)&dst[2*x], lo);
+            _mm256_storeu_si256((__m256i *)&dst[2*x+32], hi);
+        }
+
+        if (pixel_size == 1)
+        {
+            for (; x < width; x++) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcv[x];
+            }
+        }
+        else
+        {
+            for (; x < width; x+= 2) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcu[x + 1];
+                dst[2*x+2] = srcv[x];
+                dst[2*x+3] = srcv[x + 1];
+            }
+        }
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+        dst += dst_pitch;
+    }
+}
+#endif
+
+#ifdef HAVE_AVX512_INTRINSICS
+__attribute__ ((__target__ ("avx512f,avx512bw")))
+static void AVX512_SplitUV(uint8_t *dstu, size_t dstu_pitch,
+                           uint8_t *dstv, size_t dstv_pitch,
+                           const uint8_t *src, size_t src_pitch,
+                           unsigned width, unsigned height, uint8_t pixel_size)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+
+    const __m512i shuffle = _mm512_broadcast_i32x4(pixel_size == 1
+        ? _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15)
+        : _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15));
+    const __m512i even = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+    const __m512i odd  = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        unsigned x = 0;
+
+        for (; x < (width & ~63); x += 64)
+        {
+            __m512i a = _mm512_loadu_si512(&src[2*x]);
+            __m512i b = _mm512_loadu_si512(&src[2*x+64]);
+
+            a = _mm512_shuffle_epi8(a, shuffle);
+            b = _mm512_shuffle_epi8(b, shuffle);
+            _mm512_storeu_si512(&dstu[x], _mm512_permutex2var_epi64(a, even, b));
+            _mm512_storeu_si512(&dstv[x], _mm512_permutex2var_epi64(a, odd, b));
+        }
+
+        if (pixel_size == 1)
+        {
+            for (; x < width; x++) {
+                dstu[x] = src[2*x+0];
+                dstv[x] = src[2*x+1];
+            }
+        }
+        else
+        {
+            for (; x < width; x+= 2) {
+                dstu[x] = src[2*x+0];
+                dstu[x+1] = src[2*x+1];
+                dstv[x] = src[2*x+2];
+                dstv[x+1] = src[2*x+3];
+            }
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+__attribute__ ((__target__ ("avx512f,avx512bw")))
+static void AVX512_InterleaveUV(uint8_t *dst, size_t dst_pitch,
+                                const uint8_t *srcu, size_t srcu_pitch,
+                                const uint8_t *srcv, size_t srcv_pitch,
+                                unsigned width, unsigned height,
+                                uint8_t pixel_size)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+
+    /* Put quadwords n and n+4 in lane n, so that unpacking within the lanes
+     * yields the samples in order */
+    const __m512i order = _mm512_setr_epi64(0, 4, 1, 5, 2, 6, 3, 7);
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        unsigned x = 0;
+
+        for (; x < (width & ~63); x += 64)
+        {
+            __m512i u = _mm512_permutexvar_epi64(order,
+                                                 _mm512_loadu_si512(&srcu[x]));
+            __m512i v = _mm512_permutexvar_epi64(order,
+                                                 _mm512_loadu_si512(&srcv[x]));
+            __m512i lo, hi;
+
+            if (pixel_size == 1)
+            {
+                lo = _mm512_unpacklo_epi8(u, v);
+                hi = _mm512_unpackhi_epi8(u, v);
+            }
+            else
+            {
+                lo = _mm512_unpacklo_epi16(u, v);
+                hi = _mm512_unpackhi_epi16(u, v);
+            }
+            _mm512_storeu_si512(&dst[2*x], lo);
+            _mm512_storeu_si512(&dst[2*x+64], hi);
+        }
+
+        if (pixel_size == 1)
+        {
+            for (; x < width; x++) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcv[x];
+            }
+        }
+        else
+        {
+            for (; x < width; x+= 2) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcu[x + 1];
+                dst[2*x+2] = srcv[x];
+                dst[2*x+3] = srcv[x + 1];
+            }
+        }
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+        dst += dst_pitch;
+    }
+}
+#endif
+
 static void SSE_CopyPlane(uint8_t *dst, size_t dst_pitch,
                           const uint8_t *src, size_t src_pitch,
                           uint8_t *cache, size_t cache_size,
@@ -516,6 +759,20 @@ SSE_InterleavePlanes(uint8_t *dst, size_t dst_pitch,
                      cachev_width, hblock, bitshift);
 
         /* Copy from our cache to the destination */
+#ifdef HAVE_AVX512_INTRINSICS
+        if (vlc_CPU_AVX512())
+            AVX512_InterleaveUV(dst, dst_pitch, cache, w16,
+                                cache + w16 * hblock, w16,
+                                copy_pitch, hblock, pixel_size);
+        else
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+        if (vlc_CPU_AVX2())
+            AVX2_InterleaveUV(dst, dst_pitch, cache, w16,
+                              cache + w16 * hblock, w16,
+                              copy_pitch, hblock, pixel_size);
+        else
+#endif
         SSE_InterleaveUV(dst, dst_pitch, cache, w16,
                          cache + w16 * hblock, w16,
                          copy_pitch, hblock, pixel_size);
@@ -546,6 +803,18 @@ static void SSE_SplitPlanes(uint8_t *dstu, size_t dstu_pitch,
         CopyFromUswc(cache, w16, src, src_pitch, cache_width, hblock, bitshift);
 
         /* Copy from our cache to the destination */
+#ifdef HAVE_AVX512_INTRINSICS
+        if (vlc_CPU_AVX512())
+            AVX512_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
+                           cache, w16, copy_pitch, hblock, pixel_size);
+        else
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+        if (vlc_CPU_AVX2())
+            AVX2_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
+                         cache, w16, copy_pitch, hblock, pixel_size);
+        else
+#endif
         SSE_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
                     cache, w16, copy_pitch, hblock, pixel_size);
 
@@ -609,6 +878,227 @@ static void SSE_Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
 #undef COPY64
 #endif /* CAN_COMPILE_SSE2 */
 
+#if defined (__aarch64__) && defined (__ARM_NEON)
+#ifdef COPY_TEST_NOOPTIM
+# undef vlc_CPU_ARM_NEON
+# define vlc_CPU_ARM_NEON() (0)
+#endif
+
+static void NEON_CopyPlane(uint8_t *dst, size_t dst_pitch,
+                           const uint8_t *src, size_t src_pitch,
+                           unsigned height, int bitshift)
+{
+    if (bitshift == 0)
+    {
+        CopyPlane(dst, dst_pitch, src, src_pitch, height, 0);
+        return;
+    }
+
+    /* A negative shift count shifts to the right */
+    const int16x8_t shift = vdupq_n_s16(-bitshift);
+    const unsigned width = __MIN(src_pitch, dst_pitch) / 2;
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        const uint16_t *src16 = (const uint16_t *)src;
+        uint16_t *dst16 = (uint16_t *)dst;
+        unsigned x = 0;
+
+        for (; x + 8 <= width; x += 8)
+            vst1q_u16(&dst16[x], vshlq_u16(vld1q_u16(&src16[x]), shift));
+        for (; x < width; x++)
+            dst16[x] = bitshift > 0 ? src16[x] >> bitshift
+                                    : src16[x] << -bitshift;
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+
+static void NEON_SplitPlanes(uint8_t *dstu, size_t dstu_pitch,
+                             uint8_t *dstv, size_t dstv_pitch,
+                             const uint8_t *src, size_t src_pitch,
+                             unsigned height, uint8_t pixel_size, int bitshift)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+    assert(pixel_size == 2 || bitshift == 0);
+
+    const int16x8_t shift = vdupq_n_s16(-bitshift);
+    const size_t copy_pitch = __MIN(__MIN(src_pitch / 2, dstu_pitch), dstv_pitch);
+    const unsigned width = copy_pitch / pixel_size;
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        unsigned x = 0;
+
+        if (pixel_size == 1)
+        {
+            for (; x + 16 <= width; x += 16)
+            {
+                uint8x16x2_t uv = vld2q_u8(&src[2*x]);
+                vst1q_u8(&dstu[x], uv.val[0]);
+                vst1q_u8(&dstv[x], uv.val[1]);
+            }
+            for (; x < width; x++) {
+                dstu[x] = src[2*x+0];
+                dstv[x] = src[2*x+1];
+            }
+        }
+        else
+        {
+            const uint16_t *src16 = (const uint16_t *)src;
+            uint16_t *dstu16 = (uint16_t *)dstu;
+            uint16_t *dstv16 = (uint16_t *)dstv;
+
+            for (; x + 8 <= width; x += 8)
+            {
+                uint16x8x2_t uv = vld2q_u16(&src16[2*x]);
+                vst1q_u16(&dstu16[x], vshlq_u16(uv.val[0], shift));
+                vst1q_u16(&dstv16[x], vshlq_u16(uv.val[1], shift));
+            }
+            for (; x < width; x++)
+            {
+                if (bitshift >= 0)
+                {
+                    dstu16[x] = src16[2*x+0] >> bitshift;
+                    dstv16[x] = src16[2*x+1] >> bitshift;
+                }
+                else
+                {
+                    dstu16[x] = src16[2*x+0] << -bitshift;
+                    dstv16[x] = src16[2*x+1] << -bitshift;
+                }
+            }
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+static void NEON_InterleavePlanes(uint8_t *dst, size_t dst_pitch,
+                                  const uint8_t *srcu, size_t srcu_pitch,
+                                  const uint8_t *srcv, size_t srcv_pitch,
+                                  unsigned height, uint8_t pixel_size,
+                                  int bitshift)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+    assert(pixel_size == 2 || bitshift == 0);
+
+    const int16x8_t shift = vdupq_n_s16(-bitshift);
+    const size_t copy_pitch = __MIN(__MIN(srcu_pitch, srcv_pitch), dst_pitch / 2);
+    const unsigned width = copy_pitch / pixel_size;
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        unsigned x = 0;
+
+        if (pixel_size == 1)
+        {
+            for (; x + 16 <= width; x += 16)
+            {
+                uint8x16x2_t uv = { { vld1q_u8(&srcu[x]), vld1q_u8(&srcv[x]) } };
+                vst2q_u8(&dst[2*x], uv);
+            }
+            for (; x < width; x++) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcv[x];
+            }
+        }
+        else
+        {
+            const uint16_t *srcu16 = (const uint16_t *)srcu;
+            const uint16_t *srcv16 = (const uint16_t *)srcv;
+            uint16_t *dst16 = (uint16_t *)dst;
+
+            for (; x + 8 <= width; x += 8)
+            {
+                uint16x8x2_t uv = { {
+                    vshlq_u16(vld1q_u16(&srcu16[x]), shift),
+                    vshlq_u16(vld1q_u16(&srcv16[x]), shift),
+                } };
+                vst2q_u16(&dst16[2*x], uv);
+            }
+            for (; x < width; x++)
+            {
+                if (bitshift >= 0)
+                {
+                    dst16[2*x+0] = srcu16[x] >> bitshift;
+                    dst16[2*x+1] = srcv16[x] >> bitshift;
+                }
+                else
+                {
+                    dst16[2*x+0] = srcu16[x] << -bitshift;
+                    dst16[2*x+1] = srcv16[x] << -bitshift;
+                }
+            }
+        }
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+        dst  += dst_pitch;
+    }
+}
+#endif /* __aarch64__ && __ARM_NEON */
+
+#if defined (__riscv) && defined (CAN_COMPILE_RVV)
+#ifdef COPY_TEST_NOOPTIM
+# undef vlc_CPU_RV_V
+# define vlc_CPU_RV_V() (0)
+#endif
+
+void rvv_split_uv8(uint8_t *, uint8_t *, const uint8_t *, size_t);
+void rvv_split_uv16(uint8_t *, uint8_t *, const uint8_t *, size_t, int);
+void rvv_interleave_uv8(uint8_t *, const uint8_t *, const uint8_t *, size_t);
+void rvv_interleave_uv16(uint8_t *, const uint8_t *, const uint8_t *, size_t,
+                         int);
+
+static void RVV_SplitPlanes(uint8_t *dstu, size_t dstu_pitch,
+                            uint8_t *dstv, size_t dstv_pitch,
+                            const uint8_t *src, size_t src_pitch,
+                            unsigned height, uint8_t pixel_size, int bitshift)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+    assert(pixel_size == 2 || bitshift == 0);
+
+    const size_t copy_pitch = __MIN(__MIN(src_pitch / 2, dstu_pitch), dstv_pitch);
+    const size_t width = copy_pitch / pixel_size;
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        if (pixel_size == 1)
+            rvv_split_uv8(dstu, dstv, src, width);
+        else
+            rvv_split_uv16(dstu, dstv, src, width, bitshift);
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+static void RVV_InterleavePlanes(uint8_t *dst, size_t dst_pitch,
+                                 const uint8_t *srcu, size_t srcu_pitch,
+                                 const uint8_t *srcv, size_t srcv_pitch,
+                                 unsigned height, uint8_t pixel_size,
+                                 int bitshift)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+    assert(pixel_size == 2 || bitshift == 0);
+
+    const size_t copy_pitch = __MIN(__MIN(srcu_pitch, srcv_pitch), dst_pitch / 2);
+    const size_t width = copy_pitch / pixel_size;
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        if (pixel_size == 1)
+            rvv_interleave_uv8(dst, srcu, srcv, width);
+        else
+            rvv_interleave_uv16(dst, srcu, srcv, width, bitshift);
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+        dst  += dst_pitch;
+    }
+}
+#endif /* __riscv && CAN_COMPILE_RVV */
+
 static void CopyPlane(uint8_t *dst, size_t dst_pitch,
                       const uint8_t *src, size_t src_pitch,
                       unsigned height, int bitshift)
@@ -747,6 +1237,28 @@ void Copy420_SP_to_P(picture_t *dst, const uint8_t *src[static 2],
 #else
     VLC_UNUSED(cache);
 #endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+    {
+        CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                  src[0], src_pitch[0], height, 0);
+        NEON_SplitPlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                         dst->p[2].p_pixels, dst->p[2].i_pitch,
+                         src[1], src_pitch[1], (height+1)/2, 1, 0);
+        return;
+    }
+#endif
+#if defined (__riscv) && defined (CAN_COMPILE_RVV)
+    if (vlc_CPU_RV_V())
+    {
+        CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                  src[0], src_pitch[0], height, 0);
+        RVV_SplitPlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                        dst->p[2].p_pixels, dst->p[2].i_pitch,
+                        src[1], src_pitch[1], (height+1)/2, 1, 0);
+        return;
+    }
+#endif
 
     CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
               src[0], src_pitch[0], height, 0);
@@ -768,6 +1280,28 @@ void Copy420_16_SP_to_P(picture_t *dst, const uint8_t *src[static 2],
 #else
     VLC_UNUSED(cache);
 #endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+    {
+        NEON_CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                       src[0], src_pitch[0], height, bitshift);
+        NEON_SplitPlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                         dst->p[2].p_pixels, dst->p[2].i_pitch,
+                         src[1], src_pitch[1], (height+1)/2, 2, bitshift);
+        return;
+    }
+#endif
+#if defined (__riscv) && defined (CAN_COMPILE_RVV)
+    if (vlc_CPU_RV_V())
+    {
+        CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                  src[0], src_pitch[0], height, bitshift);
+        RVV_SplitPlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                        dst->p[2].p_pixels, dst->p[2].i_pitch,
+                        src[1], src_pitch[1], (height+1)/2, 2, bitshift);
+        return;
+    }
+#endif
 
     CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
               src[0], src_pitch[0], height, bitshift);
@@ -823,6 +1357,30 @@ void Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
 #else
     (void) cache;
 #endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+    {
+        CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                  src[0], src_pitch[0], height, 0);
+        NEON_InterleavePlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                              src[U_PLANE], src_pitch[U_PLANE],
+                              src[V_PLANE], src_pitch[V_PLANE],
+                              (height+1)/2, 1, 0);
+        return;
+    }
+#endif
+#if defined (__riscv) && defined (CAN_COMPILE_RVV)
+    if (vlc_CPU_RV_V())
+    {
+        CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                  src[0], src_pitch[0], height, 0);
+        RVV_InterleavePlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                             src[U_PLANE], src_pitch[U_PLANE],
+                             src[V_PLANE], src_pitch[V_PLANE],
+                             (height+1)/2, 1, 0);
+        return;
+    }
+#endif
 
     CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
               src[0], src_pitch[0], height, 0);
@@ -854,6 +1412,30 @@ void Copy420_16_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
 #else
     (void) cache;
 #endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+    {
+        NEON_CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                       src[0], src_pitch[0], height, bitshift);
+        NEON_InterleavePlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                              src[U_PLANE], src_pitch[U_PLANE],
+                              src[V_PLANE], src_pitch[V_PLANE],
+                              (height+1)/2, 2, bitshift);
+        return;
+    }
+#endif
+#if defined (__riscv) && defined (CAN_COMPILE_RVV)
+    if (vlc_CPU_RV_V())
+    {
+        CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                  src[0], src_pitch[0], height, bitshift);
+        RVV_InterleavePlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                             src[U_PLANE], src_pitch[U_PLANE],
+                             src[V_PLANE], src_pitch[V_PLANE],
+                             (height+1)/2, 2, bitshift);
+        return;
+    }
+#endif
 
     CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
               src[0], src_pitch[0], height, bitshift);
@@ -1102,8 +1684,108 @@ static picture_t *pic_new_unaligned(const video_format_t *fmt)
     return picture_NewFromResource(fmt, &rsc);
 }
 
-int main(void)
+static const char *bench_isa(void)
+{
+#ifdef CAN_COMPILE_SSE2
+# ifdef HAVE_AVX512_INTRINSICS
+    if (vlc_CPU_AVX512())
+        return "AVX-512";
+# endif
+# ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return "AVX2";
+# endif
+    if (vlc_CPU_SSE2())
+        return "SSE";
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        return "NEON";
+#endif
+    return "C";
+}
+
+/* Measures the throughput of each conversion on UHD pictures:
+ * run the test program with the "bench" argument. */
+static void bench(void)
+{
+    const unsigned count = 100;
+
+    fprintf(stderr, "benchmarking %s code, %u frames per conversion\n",
+            bench_isa(), count);
+
+    for (size_t i = 0; i < NB_CONVS; ++i)
+    {
+        const struct test_conv *conv = &convs[i];
+        const vlc_chroma_description_t *src_dsc =
+            vlc_fourcc_GetChromaDescription(conv->src_chroma);
+        assert(src_dsc);
+
+        video_format_t fmt;
+        video_format_Init(&fmt, 0);
+        video_format_Setup(&fmt, conv->src_chroma, 3840, 2160, 3840, 2160,
+                           1, 1);
+        picture_t *src = picture_NewFromFormat(&fmt);
+        assert(src);
+        piccheck(src, src_dsc, true);
+
+        size_t bytes = 0;
+        for (int p = 0; p < src->i_planes; ++p)
+            bytes += src->p[p].i_visible_pitch * src->p[p].i_visible_lines;
+
+        copy_cache_t cache;
+        int ret = CopyInitCache(&cache, src->format.i_width
+                                * src_dsc->pixel_size);
+        assert(ret == VLC_SUCCESS);
+
+        for (size_t f = 0; conv->dsts[f].chroma != 0; ++f)
+        {
+            const struct test_dst *test_dst = &conv->dsts[f];
+
+            fmt.i_chroma = test_dst->chroma;
+            picture_t *dst = picture_NewFromFormat(&fmt);
+            assert(dst);
+
+            const uint8_t * src_planes[3] = { src->p[Y_PLANE].p_pixels,
+                                              src->p[U_PLANE].p_pixels,
+                                              src->p[V_PLANE].p_pixels };
+            const size_t    src_pitches[3] = { src->p[Y_PLANE].i_pitch,
+                                               src->p[U_PLANE].i_pitch,
+                                               src->p[V_PLANE].i_pitch };
+
+            vlc_tick_t start = vlc_tick_now();
+            for (unsigned n = 0; n < count; n++)
+            {
+                if (test_dst->bitshift == 0)
+                    test_dst->conv(dst, src_planes, src_pitches,
+                                   src->format.i_visible_height, &cache);
+                else
+                    test_dst->conv16(dst, src_planes, src_pitches,
+                                     src->format.i_visible_height,
+                                     test_dst->bitshift, &cache);
+            }
+            vlc_tick_t elapsed = vlc_tick_now() - start;
+
+            fprintf(stderr, "%4.4s -> %4.4s: %6.3f ms/frame, %7.1f MiB/s\n",
+                    (const char *) &src->format.i_chroma,
+                    (const char *) &dst->format.i_chroma,
+                    secf_from_vlc_tick(elapsed) * 1000.f / count,
+                    (bytes * count / 1048576.f) / secf_from_vlc_tick(elapsed));
+            picture_Release(dst);
+        }
+        picture_Release(src);
+        CopyCleanCache(&cache);
+    }
+}
+
+int main(int argc, char *argv[])
 {
+    if (argc > 1 && !strcmp(argv[1], "bench"))
+    {
+        bench();
+        return 0;
+    }
+
     alarm(10);
 
 #ifndef COPY_TEST_NOOPTIM
@@ -36,6 +36,7 @@
 #include <vlc_cpu.h>
 
 #include "i420_rgb.h"
+#include "slices.h"
 #ifdef PLUGIN_PLAIN
 # include "i420_rgb_c.h"
 
@@ -71,17 +72,117 @@ vlc_module_begin ()
 #endif
 vlc_module_end ()
 
+/*****************************************************************************
+ * Convert: run a conversion function, in parallel slices if possible
+ *****************************************************************************
+ * Without scaling, the conversion functions do not write anything to the
+ * filter state, so that disjoint bands of lines can be converted
+ * concurrently. Slice boundaries are multiples of 4 lines to keep the chroma
+ * sub-sampling and the RGB8 dither pattern in phase.
+ *****************************************************************************/
+typedef void (*convert_cb)( filter_t *, picture_t *, picture_t * );
+
+struct convert_job
+{
+    filter_t  *p_filter;
+    picture_t *p_src;
+    picture_t *p_dst;
+    convert_cb pf_convert;
+    unsigned   i_lines;
+};
+
+static void ConvertSlice( void *opaque, unsigned index, unsigned count )
+{
+    const struct convert_job *job = opaque;
+    const filter_t *p_filter = job->p_filter;
+    unsigned start, end;
+
+    vlc_slice_Lines( job->i_lines, 4, index, count, &start, &end );
+    if( start >= end )
+        return;
+
+    filter_t slice = {
+        .p_sys = p_filter->p_sys,
+        .fmt_in = p_filter->fmt_in,
+        .fmt_out = p_filter->fmt_out,
+    };
+    slice.fmt_in.video.i_y_offset = 0;
+    slice.fmt_in.video.i_visible_height = end - start;
+    slice.fmt_out.video.i_y_offset = 0;
+    slice.fmt_out.video.i_visible_height = end - start;
+
+    picture_t src = { .i_planes = job->p_src->i_planes };
+    picture_t dst = { .i_planes = job->p_dst->i_planes };
+
+    for( int i = 0; i < src.i_planes; i++ )
+    {
+        src.p[i] = job->p_src->p[i];
+        src.p[i].p_pixels += (i == Y_PLANE ? start : start / 2)
+                           * src.p[i].i_pitch;
+    }
+    dst.p[0] = job->p_dst->p[0];
+    dst.p[0].p_pixels += start * dst.p[0].i_pitch;
+
+    job->pf_convert( &slice, &src, &dst );
+}
+
+static picture_t *Convert( filter_t *p_filter, picture_t *p_pic,
+                           convert_cb pf_convert )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const video_format_t *fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *fmt_out = &p_filter->fmt_out.video;
+
+    picture_t *p_outpic = filter_NewPicture( p_filter );
+    if( p_outpic )
+    {
+        struct convert_job job = {
+            .p_filter = p_filter,
+            .p_src = p_pic,
+            .p_dst = p_outpic,
+            .pf_convert = pf_convert,
+            .i_lines = fmt_in->i_y_offset + fmt_in->i_visible_height,
+        };
+        unsigned count = 1;
+
+        if( fmt_in->i_x_offset + fmt_in->i_visible_width
+             == fmt_out->i_x_offset + fmt_out->i_visible_width
+         && fmt_in->i_y_offset + fmt_in->i_visible_height
+             == fmt_out->i_y_offset + fmt_out->i_visible_height )
+            count = vlc_slices_Count( p_sys->slices, job.i_lines, 64 );
+
+        if( count > 1 )
+            vlc_slices_Run( p_sys->slices, count, ConvertSlice, &job );
+        else
+            pf_convert( p_filter, p_pic, p_outpic );
+        picture_CopyProperties( p_outpic, p_pic );
+    }
+    picture_Release( p_pic );
+    return p_outpic;
+}
+
+#define CONVERT_WRAPPER( name )                                         \
+    void name( filter_t *, picture_t *, picture_t * );                  \
+    static picture_t *name ## _Filter( filter_t *p_filter,              \
+                                       picture_t *p_pic )               \
+    {                                                                   \
+        return Convert( p_filter, p_pic, name );                        \
+    }                                                                   \
+    static const struct vlc_filter_operations name ## _ops = {          \
+        .filter_video = name ## _Filter, .close = Deactivate,           \
+    };
+
 #ifndef PLUGIN_PLAIN
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_R5G5B5, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_R5G6B5, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_A8R8G8B8, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_R8G8B8A8, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_B8G8R8A8, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_A8B8G8R8, Deactivate )
+CONVERT_WRAPPER( I420_R5G5B5 )
+CONVERT_WRAPPER( I420_R5G6B5 )
+CONVERT_WRAPPER( I420_A8R8G8B8 )
+CONVERT_WRAPPER( I420_R8G8B8A8 )
+CONVERT_WRAPPER( I420_B8G8R8A8 )
+CONVERT_WRAPPER( I420_A8B8G8R8 )
 #else
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_RGB8, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_RGB16, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_RGB32, Deactivate )
+CONVERT_WRAPPER( I420_RGB8 )
+CONVERT_WRAPPER( I420_RGB16 )
+CONVERT_WRAPPER( I420_RGB32 )
 #endif
 
 /*****************************************************************************
@@ -202,6 +303,7 @@ static int Activate( filter_t *p_filter )
 
     p_sys->i_buffer_size = 0;
     p_sys->p_buffer = NULL;
+    p_sys->slices = NULL;
     switch( p_filter->fmt_out.video.i_chroma )
     {
 #ifdef PLUGIN_PLAIN
@@ -265,6 +367,9 @@ static int Activate( filter_t *p_filter )
     video_format_Clean( &vfmt );
 #endif
 
+    /* Without a runner, pictures are converted on the calling thread */
+    p_sys->slices = vlc_slices_New( 0 );
+
     return 0;
 }
 
@@ -282,6 +387,8 @@ static void Deactivate( filter_t *p_filter )
 #endif
     free( p_sys->p_offset );
     free( p_sys->p_buffer );
+    if( p_sys->slices != NULL )
+        vlc_slices_Delete( p_sys->slices );
     free( p_sys );
 }
 
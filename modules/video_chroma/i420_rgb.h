@@ -40,6 +40,7 @@ typedef struct
     size_t    i_buffer_size;
     uint8_t   i_bytespp;
     int *p_offset;
+    struct vlc_slices *slices;          /**< slice runner (may be NULL) */
 
 #ifdef PLUGIN_PLAIN
     /**< Pre-calculated conversion tables */
@@ -0,0 +1,200 @@
+/*****************************************************************************
+ * slices.c: slice-parallel picture processing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_executor.h>
+
+#include "slices.h"
+
+struct vlc_slices
+{
+    unsigned max_threads;
+};
+
+/* Worker threads shared by all runners of the plugin. This helper library is
+ * statically linked into each plugin, so every plugin has its own pool. */
+static vlc_mutex_t pool_lock = VLC_STATIC_MUTEX;
+static vlc_executor_t *pool;
+static unsigned pool_refs;
+
+struct slices_job
+{
+    vlc_slice_cb cb;
+    void *opaque;
+    unsigned count;
+    atomic_uint next;
+
+    vlc_mutex_t lock;
+    vlc_cond_t done;
+    unsigned pending;
+    struct vlc_runnable runnables[VLC_SLICES_MAX - 1];
+};
+
+unsigned vlc_slices_DefaultThreads(void)
+{
+    unsigned cpus = vlc_GetCPUCount();
+
+    return __MAX(1, __MIN(cpus, VLC_SLICES_MAX));
+}
+
+vlc_slices_t *vlc_slices_New(unsigned max_threads)
+{
+    if (max_threads == 0)
+        max_threads = vlc_slices_DefaultThreads();
+    max_threads = __MIN(max_threads, VLC_SLICES_MAX);
+
+    vlc_slices_t *slices = malloc(sizeof (*slices));
+    if (unlikely(slices == NULL))
+        return NULL;
+
+    slices->max_threads = 1;
+
+    if (max_threads > 1)
+    {
+        vlc_mutex_lock(&pool_lock);
+        if (pool == NULL)
+        {
+            unsigned workers = vlc_slices_DefaultThreads() - 1;
+
+            if (workers > 0)
+                pool = vlc_executor_New(workers);
+        }
+        if (pool != NULL)
+        {
+            pool_refs++;
+            slices->max_threads = max_threads;
+        }
+        vlc_mutex_unlock(&pool_lock);
+    }
+    return slices;
+}
+
+void vlc_slices_Delete(vlc_slices_t *slices)
+{
+    if (slices->max_threads > 1)
+    {
+        vlc_executor_t *executor = NULL;
+
+        vlc_mutex_lock(&pool_lock);
+        assert(pool_refs > 0);
+        if (--pool_refs == 0)
+        {
+            executor = pool;
+            pool = NULL;
+        }
+        vlc_mutex_unlock(&pool_lock);
+
+        if (executor != NULL)
+            vlc_executor_Delete(executor);
+    }
+    free(slices);
+}
+
+unsigned vlc_slices_Count(const vlc_slices_t *slices, unsigned lines,
+                          unsigned min_lines)
+{
+    if (slices == NULL || min_lines == 0)
+        return 1;
+
+    unsigned count = lines / min_lines;
+
+    return __MAX(1, __MIN(count, slices->max_threads));
+}
+
+static void RunSlices(struct slices_job *job)
+{
+    unsigned index;
+
+    while ((index = atomic_fetch_add_explicit(&job->next, 1,
+                                              memory_order_relaxed))
+           < job->count)
+        job->cb(job->opaque, index, job->count);
+}
+
+static void RunWorker(void *data)
+{
+    struct slices_job *job = data;
+
+    RunSlices(job);
+
+    vlc_mutex_lock(&job->lock);
+    assert(job->pending > 0);
+    if (--job->pending == 0)
+        vlc_cond_signal(&job->done);
+    vlc_mutex_unlock(&job->lock);
+}
+
+void vlc_slices_Run(vlc_slices_t *slices, unsigned count, vlc_slice_cb cb,
+                    void *opaque)
+{
+    unsigned workers = 0;
+
+    if (slices != NULL)
+        workers = __MIN(count, slices->max_threads) - 1;
+
+    if (workers == 0)
+    {
+        for (unsigned i = 0; i < count; i++)
+            cb(opaque, i, count);
+        return;
+    }
+
+    struct slices_job job = {
+        .cb = cb,
+        .opaque = opaque,
+        .count = count,
+        .pending = workers,
+    };
+
+    atomic_init(&job.next, 0);
+    vlc_mutex_init(&job.lock);
+    vlc_cond_init(&job.done);
+
+    /* The pool cannot go away while a runner exists */
+    for (unsigned i = 0; i < workers; i++)
+    {
+        struct vlc_runnable *runnable = &job.runnables[i];
+
+        runnable->run = RunWorker;
+        runnable->userdata = &job;
+        runnable->priority = VLC_RUNNABLE_PRIORITY_HIGH;
+        vlc_executor_Submit(pool, runnable);
+    }
+
+    /* The calling thread takes its share of the slices, and all of them if
+     * the workers are slow to start. */
+    RunSlices(&job);
+
+    vlc_mutex_lock(&job.lock);
+    for (unsigned i = 0; i < workers; i++)
+        if (vlc_executor_Cancel(pool, &job.runnables[i]))
+            job.pending--;
+    while (job.pending > 0)
+        vlc_cond_wait(&job.done, &job.lock);
+    vlc_mutex_unlock(&job.lock);
+}
@@ -0,0 +1,118 @@
+/*****************************************************************************
+ * slices.h: slice-parallel picture processing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_VIDEOCHROMA_SLICES_H_
+#define VLC_VIDEOCHROMA_SLICES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of slices (and threads) of a single run */
+#define VLC_SLICES_MAX 16
+
+typedef struct vlc_slices vlc_slices_t;
+
+/**
+ * Slice callback.
+ *
+ * \param opaque data pointer passed to vlc_slices_Run()
+ * \param index slice index, between 0 and count - 1
+ * \param count total number of slices of the run
+ */
+typedef void (*vlc_slice_cb)(void *opaque, unsigned index, unsigned count);
+
+/**
+ * Returns the default number of threads for slice processing.
+ *
+ * This is the number of CPUs, up to VLC_SLICES_MAX.
+ */
+unsigned vlc_slices_DefaultThreads(void);
+
+/**
+ * Creates a slice runner.
+ *
+ * The worker threads are shared by all the runners of the calling plugin,
+ * and are only started when first needed.
+ *
+ * \param max_threads maximum number of threads used by a run, including the
+ * calling thread (0 for the default)
+ * \return a runner, or NULL on error (the caller may then process the whole
+ * picture inline)
+ */
+vlc_slices_t *vlc_slices_New(unsigned max_threads);
+
+void vlc_slices_Delete(vlc_slices_t *);
+
+/**
+ * Computes a number of slices for a picture band.
+ *
+ * \param lines height of the processed band (in lines)
+ * \param min_lines minimum height of a slice, below which the threading
+ * overhead outweighs the gain
+ * \return the number of slices to pass to vlc_slices_Run() (at least 1)
+ */
+unsigned vlc_slices_Count(const vlc_slices_t *, unsigned lines,
+                          unsigned min_lines);
+
+/**
+ * Runs slices in parallel.
+ *
+ * The callback is invoked once for each slice index, from the calling thread
+ * and from worker threads. This function returns once all slices are done.
+ *
+ * \param slices runner (if NULL, all slices run on the calling thread)
+ * \param count number of slices
+ * \param cb slice callback
+ * \param opaque data pointer for the callback
+ */
+void vlc_slices_Run(vlc_slices_t *slices, unsigned count, vlc_slice_cb cb,
+                    void *opaque);
+
+/**
+ * Splits a height into slices.
+ *
+ * Slice boundaries are multiples of the alignment (e.g. the vertical chroma
+ * subsampling factor), except for the end of the last slice.
+ *
+ * \param lines total height (in lines)
+ * \param align alignment of the slice boundaries (in lines)
+ * \param index slice index
+ * \param count number of slices
+ * \param start [OUT] first line of the slice
+ * \param end [OUT] line following the last line of the slice
+ */
+static inline void vlc_slice_Lines(unsigned lines, unsigned align,
+                                   unsigned index, unsigned count,
+                                   unsigned *restrict start,
+                                   unsigned *restrict end)
+{
+    const unsigned units = (lines + align - 1) / align;
+
+    *start = __MIN(lines, (units * index / count) * align);
+    *end = index + 1 < count
+         ? __MIN(lines, (units * (index + 1) / count) * align) : lines;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
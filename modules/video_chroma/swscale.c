@@ -37,12 +37,22 @@
 
 #include <libswscale/swscale.h>
 #include <libswscale/version.h>
+#include <libavutil/frame.h>
+#include <libavutil/opt.h>
 
 #ifdef __APPLE__
 # include <TargetConditionals.h>
 #endif
 
 #include "../codec/avcodec/chroma.h" // Chroma Avutil <-> VLC conversion
+#include "slices.h"
+
+#ifndef AV_VERSION_INT
+# define AV_VERSION_INT(a, b, c) ((a)<<16 | (b)<<8 | (c))
+#endif
+
+/* libswscale runs slices of a frame in its own threads from this version */
+#define SWS_THREADS (LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100))
 
 /* Gruikkkkkkkkkk!!!!! */
 #undef AVPALETTE_SIZE
@@ -102,6 +112,12 @@ typedef struct
     bool b_copy;
     bool b_swap_uvi;
     bool b_swap_uvo;
+
+    /* Geometry of the scaling contexts (for the threaded frame API) */
+    enum AVPixelFormat i_fmti;
+    enum AVPixelFormat i_fmto;
+    int i_src_width;
+    int i_dst_width;
 } filter_sys_t;
 
 static picture_t *Filter( filter_t *, picture_t * );
@@ -374,6 +390,40 @@ static int GetParameters( ScalerConfiguration *p_cfg,
     return VLC_SUCCESS;
 }
 
+static struct SwsContext *GetContext( filter_sys_t *p_sys,
+                                      int i_src_width, int i_src_height,
+                                      enum AVPixelFormat i_src_fmt,
+                                      int i_dst_width, int i_dst_height,
+                                      enum AVPixelFormat i_dst_fmt,
+                                      int i_sws_flags )
+{
+#if SWS_THREADS
+    struct SwsContext *ctx = sws_alloc_context();
+    if( ctx == NULL )
+        return NULL;
+
+    av_opt_set_int( ctx, "srcw", i_src_width, 0 );
+    av_opt_set_int( ctx, "srch", i_src_height, 0 );
+    av_opt_set_int( ctx, "src_format", i_src_fmt, 0 );
+    av_opt_set_int( ctx, "dstw", i_dst_width, 0 );
+    av_opt_set_int( ctx, "dsth", i_dst_height, 0 );
+    av_opt_set_int( ctx, "dst_format", i_dst_fmt, 0 );
+    av_opt_set_int( ctx, "sws_flags", i_sws_flags, 0 );
+    av_opt_set_int( ctx, "threads", vlc_slices_DefaultThreads(), 0 );
+
+    if( sws_init_context( ctx, p_sys->p_filter, NULL ) < 0 )
+    {
+        sws_freeContext( ctx );
+        return NULL;
+    }
+    return ctx;
+#else
+    return sws_getContext( i_src_width, i_src_height, i_src_fmt,
+                           i_dst_width, i_dst_height, i_dst_fmt,
+                           i_sws_flags, p_sys->p_filter, NULL, 0 );
+#endif
+}
+
 static int Init( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
@@ -422,16 +472,19 @@ static int Init( filter_t *p_filter )
 
     const unsigned i_fmti_visible_width = p_fmti->i_visible_width * p_sys->i_extend_factor;
     const unsigned i_fmto_visible_width = p_fmto->i_visible_width * p_sys->i_extend_factor;
+    p_sys->i_fmti = cfg.i_fmti;
+    p_sys->i_fmto = cfg.i_fmto;
+    p_sys->i_src_width = i_fmti_visible_width;
+    p_sys->i_dst_width = i_fmto_visible_width;
     for( int n = 0; n < (cfg.b_has_a ? 2 : 1); n++ )
     {
         const int i_fmti = n == 0 ? cfg.i_fmti : AV_PIX_FMT_GRAY8;
         const int i_fmto = n == 0 ? cfg.i_fmto : AV_PIX_FMT_GRAY8;
         struct SwsContext *ctx;
 
-        ctx = sws_getContext( i_fmti_visible_width, p_fmti->i_visible_height, i_fmti,
-                              i_fmto_visible_width, p_fmto->i_visible_height, i_fmto,
-                              cfg.i_sws_flags,
-                              p_sys->p_filter, NULL, 0 );
+        ctx = GetContext( p_sys, i_fmti_visible_width, p_fmti->i_visible_height, i_fmti,
+                          i_fmto_visible_width, p_fmto->i_visible_height, i_fmto,
+                          cfg.i_sws_flags );
         if( n == 0 )
             p_sys->ctx = ctx;
         else
@@ -610,6 +663,57 @@ static void SwapUV( picture_t *p_dst, const picture_t *p_src )
     picture_CopyPixels( p_dst, &tmp );
 }
 
+#if SWS_THREADS
+static void NoFree( void *opaque, uint8_t *data )
+{
+    VLC_UNUSED(opaque); VLC_UNUSED(data);
+}
+
+static int WrapFrame( AVFrame *frame, uint8_t *pixels[4], const int pitch[4],
+                      int width, int height, enum AVPixelFormat format )
+{
+    /* The pictures stay owned by VLC: the buffer references do not free */
+    frame->buf[0] = av_buffer_create( pixels[0], pitch[0] * height, NoFree,
+                                      NULL, 0 );
+    if( frame->buf[0] == NULL )
+        return -1;
+
+    for( unsigned i = 0; i < 4; i++ )
+    {
+        frame->data[i] = pixels[i];
+        frame->linesize[i] = pitch[i];
+    }
+    frame->width = width;
+    frame->height = height;
+    frame->format = format;
+    return 0;
+}
+
+static int ScaleFrame( struct SwsContext *ctx,
+                       uint8_t *src[4], const int src_stride[4],
+                       int i_src_width, int i_src_height,
+                       enum AVPixelFormat i_src_fmt,
+                       uint8_t *dst[4], const int dst_stride[4],
+                       int i_dst_width, int i_dst_height,
+                       enum AVPixelFormat i_dst_fmt )
+{
+    AVFrame *in = av_frame_alloc();
+    AVFrame *out = av_frame_alloc();
+    int ret = -1;
+
+    if( in != NULL && out != NULL
+     && WrapFrame( in, src, src_stride, i_src_width, i_src_height,
+                   i_src_fmt ) == 0
+     && WrapFrame( out, dst, dst_stride, i_dst_width, i_dst_height,
+                   i_dst_fmt ) == 0 )
+        ret = sws_scale_frame( ctx, out, in );
+
+    av_frame_free( &in );
+    av_frame_free( &out );
+    return ret < 0 ? -1 : 0;
+}
+#endif
+
 static void Convert( filter_t *p_filter, struct SwsContext *ctx,
                      picture_t *p_dst, picture_t *p_src, int i_height,
                      int i_plane_count, bool b_swap_uvi, bool b_swap_uvo )
@@ -638,6 +742,16 @@ static void Convert( filter_t *p_filter, struct SwsContext *ctx,
     for (size_t i = 0; i < ARRAY_SIZE(src); i++)
         csrc[i] = src[i];
 
+#if SWS_THREADS
+    /* Only the frame API spreads the slices over the context threads */
+    const bool b_alpha = ctx == p_sys->ctxA;
+    if( ScaleFrame( ctx, src, src_stride, p_sys->i_src_width, i_height,
+                    b_alpha ? AV_PIX_FMT_GRAY8 : p_sys->i_fmti,
+                    dst, dst_stride, p_sys->i_dst_width,
+                    p_filter->fmt_out.video.i_visible_height,
+                    b_alpha ? AV_PIX_FMT_GRAY8 : p_sys->i_fmto ) == 0 )
+        return;
+#endif
 #if LIBSWSCALE_VERSION_INT  >= ((0<<16)+(5<<8)+0)
     sws_scale( ctx, csrc, src_stride, 0, i_height,
                dst, dst_stride );
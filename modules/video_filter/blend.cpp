@@ -31,7 +31,19 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
+#include "../video_chroma/slices.h"
+
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+# include <arm_neon.h>
+#endif
 
 /*****************************************************************************
  * Module descriptor
@@ -79,6 +91,18 @@ public:
     {
         return fmt;
     }
+    const plane_t *getPlane(unsigned plane) const
+    {
+        return &picture->p[plane];
+    }
+    unsigned getX() const
+    {
+        return x;
+    }
+    unsigned getY() const
+    {
+        return y;
+    }
     bool isFull(unsigned) const
     {
         return true;
@@ -560,6 +584,590 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
 
+/*****************************************************************************
+ * Specialised blenders
+ *****************************************************************************
+ * The line kernels compute exactly the same as merge() with the factor
+ * div255(alpha * a), so the specialised and the generic blenders render
+ * identically.
+ *****************************************************************************/
+namespace {
+
+struct CLines {
+    /* dst[i] over src[i] with the alpha a[i] */
+    static void plane(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                      unsigned n, unsigned alpha)
+    {
+        for (unsigned i = 0; i < n; i++) {
+            unsigned f = div255(alpha * a[i]);
+            if (f > 0)
+                ::merge(&dst[i], src[i], f);
+        }
+    }
+    /* dst[i] over src[2 * i] with the alpha a[2 * i] (subsampled chroma) */
+    static void planeSub2(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                          unsigned n, unsigned alpha)
+    {
+        for (unsigned i = 0; i < n; i++) {
+            unsigned f = div255(alpha * a[2 * i]);
+            if (f > 0)
+                ::merge(&dst[i], src[2 * i], f);
+        }
+    }
+    /* dst[2 * i] and dst[2 * i + 1] over u[2 * i] and v[2 * i] with the alpha
+     * a[2 * i] (semi-planar chroma) */
+    static void semiPlanar(uint8_t *dst, const uint8_t *u, const uint8_t *v,
+                           const uint8_t *a, unsigned n, unsigned alpha)
+    {
+        for (unsigned i = 0; i < n; i++) {
+            unsigned f = div255(alpha * a[2 * i]);
+            if (f > 0) {
+                ::merge(&dst[2 * i + 0], u[2 * i], f);
+                ::merge(&dst[2 * i + 1], v[2 * i], f);
+            }
+        }
+    }
+    /* RGBA over RGBA, see CPictureRGBX::merge() */
+    static void rgba(uint8_t *dst, const uint8_t *src, unsigned n,
+                     unsigned alpha)
+    {
+        for (unsigned i = 0; i < n; i++, dst += 4, src += 4) {
+            unsigned f = div255(alpha * src[3]);
+            if (f == 0)
+                continue;
+            for (unsigned c = 0; c < 3; c++) {
+                ::merge(&dst[c], src[c], 255 - dst[3]);
+                ::merge(&dst[c], src[c], f);
+            }
+            ::merge(&dst[3], 255, f);
+        }
+    }
+};
+
+#ifdef CAN_COMPILE_SSE2
+/* ((v >> 8) + v + 1) >> 8 on words */
+__attribute__ ((__target__ ("sse2")))
+static inline __m128i Div255_sse2(__m128i v)
+{
+    v = _mm_add_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)),
+                      _mm_set1_epi16(1));
+    return _mm_srli_epi16(v, 8);
+}
+
+/* Blending factors div255(alpha * a) of 16 bytes */
+__attribute__ ((__target__ ("sse2")))
+static inline __m128i Factor_sse2(__m128i a, __m128i alpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = Div255_sse2(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), alpha));
+    __m128i hi = Div255_sse2(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), alpha));
+    return _mm_packus_epi16(lo, hi);
+}
+
+/* merge() of 16 bytes with the factors f */
+__attribute__ ((__target__ ("sse2")))
+static inline __m128i Merge_sse2(__m128i d, __m128i s, __m128i f)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i nf = _mm_xor_si128(f, _mm_set1_epi8(-1)); /* 255 - f */
+    __m128i lo = _mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(nf, zero)),
+        _mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(f, zero)));
+    __m128i hi = _mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(nf, zero)),
+        _mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(f, zero)));
+    return _mm_packus_epi16(Div255_sse2(lo), Div255_sse2(hi));
+}
+
+/* Even bytes of 32 bytes */
+__attribute__ ((__target__ ("sse2")))
+static inline __m128i Even_sse2(const uint8_t *p)
+{
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    return _mm_packus_epi16(
+        _mm_and_si128(_mm_loadu_si128((const __m128i *)&p[0]), mask),
+        _mm_and_si128(_mm_loadu_si128((const __m128i *)&p[16]), mask));
+}
+
+/* Alpha byte of each pixel, copied to all its bytes */
+__attribute__ ((__target__ ("sse2")))
+static inline __m128i SplatAlpha_sse2(__m128i v)
+{
+    v = _mm_srli_epi32(v, 24);
+    v = _mm_or_si128(v, _mm_slli_epi32(v, 8));
+    return _mm_or_si128(v, _mm_slli_epi32(v, 16));
+}
+
+struct CLinesSSE2 {
+    __attribute__ ((__target__ ("sse2")))
+    static void plane(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                      unsigned n, unsigned alpha)
+    {
+        const __m128i alpha16 = _mm_set1_epi16(alpha);
+        unsigned i = 0;
+
+        for (; i + 16 <= n; i += 16) {
+            __m128i d = _mm_loadu_si128((const __m128i *)&dst[i]);
+            __m128i s = _mm_loadu_si128((const __m128i *)&src[i]);
+            __m128i f = Factor_sse2(_mm_loadu_si128((const __m128i *)&a[i]),
+                                    alpha16);
+            _mm_storeu_si128((__m128i *)&dst[i], Merge_sse2(d, s, f));
+        }
+        CLines::plane(&dst[i], &src[i], &a[i], n - i, alpha);
+    }
+    __attribute__ ((__target__ ("sse2")))
+    static void planeSub2(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                          unsigned n, unsigned alpha)
+    {
+        const __m128i alpha16 = _mm_set1_epi16(alpha);
+        unsigned i = 0;
+
+        /* The sources are read up to the odd byte following the last sample */
+        for (; i + 16 < n; i += 16) {
+            __m128i d = _mm_loadu_si128((const __m128i *)&dst[i]);
+            __m128i f = Factor_sse2(Even_sse2(&a[2 * i]), alpha16);
+            _mm_storeu_si128((__m128i *)&dst[i],
+                             Merge_sse2(d, Even_sse2(&src[2 * i]), f));
+        }
+        CLines::planeSub2(&dst[i], &src[2 * i], &a[2 * i], n - i, alpha);
+    }
+    __attribute__ ((__target__ ("sse2")))
+    static void semiPlanar(uint8_t *dst, const uint8_t *u, const uint8_t *v,
+                           const uint8_t *a, unsigned n, unsigned alpha)
+    {
+        const __m128i alpha16 = _mm_set1_epi16(alpha);
+        const __m128i mask = _mm_set1_epi16(0x00ff);
+        unsigned i = 0;
+
+        for (; i + 8 < n; i += 8) {
+            __m128i d = _mm_loadu_si128((const __m128i *)&dst[2 * i]);
+            __m128i us = _mm_loadu_si128((const __m128i *)&u[2 * i]);
+            __m128i vs = _mm_loadu_si128((const __m128i *)&v[2 * i]);
+            __m128i as = _mm_and_si128(_mm_loadu_si128((const __m128i *)&a[2 * i]),
+                                       mask);
+            __m128i s = _mm_or_si128(_mm_and_si128(us, mask),
+                                     _mm_slli_epi16(vs, 8));
+            __m128i f = Factor_sse2(_mm_or_si128(as, _mm_slli_epi16(as, 8)),
+                                    alpha16);
+            _mm_storeu_si128((__m128i *)&dst[2 * i], Merge_sse2(d, s, f));
+        }
+        CLines::semiPlanar(&dst[2 * i], &u[2 * i], &v[2 * i], &a[2 * i],
+                           n - i, alpha);
+    }
+    __attribute__ ((__target__ ("sse2")))
+    static void rgba(uint8_t *dst, const uint8_t *src, unsigned n,
+                     unsigned alpha)
+    {
+        const __m128i alpha16 = _mm_set1_epi16(alpha);
+        const __m128i amask = _mm_set1_epi32(0xff000000);
+        unsigned i = 0;
+
+        for (; i + 4 <= n; i += 4) {
+            __m128i d = _mm_loadu_si128((const __m128i *)&dst[4 * i]);
+            __m128i s = _mm_loadu_si128((const __m128i *)&src[4 * i]);
+            __m128i f = Factor_sse2(SplatAlpha_sse2(s), alpha16);
+            /* Blend the colour with the destination alpha first */
+            __m128i nda = _mm_xor_si128(SplatAlpha_sse2(d), _mm_set1_epi8(-1));
+            __m128i r = Merge_sse2(d, s, nda);
+            r = _mm_or_si128(_mm_andnot_si128(amask, r), _mm_and_si128(amask, d));
+            r = Merge_sse2(r, _mm_or_si128(s, amask), f);
+            /* Fully transparent pixels are left untouched */
+            __m128i skip = _mm_cmpeq_epi8(f, _mm_setzero_si128());
+            r = _mm_or_si128(_mm_and_si128(skip, d), _mm_andnot_si128(skip, r));
+            _mm_storeu_si128((__m128i *)&dst[4 * i], r);
+        }
+        CLines::rgba(&dst[4 * i], &src[4 * i], n - i, alpha);
+    }
+};
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i Div255_avx2(__m256i v)
+{
+    v = _mm256_add_epi16(_mm256_add_epi16(v, _mm256_srli_epi16(v, 8)),
+                         _mm256_set1_epi16(1));
+    return _mm256_srli_epi16(v, 8);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i Factor_avx2(__m256i a, __m256i alpha)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo = Div255_avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, zero),
+                                                alpha));
+    __m256i hi = Div255_avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, zero),
+                                                alpha));
+    return _mm256_packus_epi16(lo, hi);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i Merge_avx2(__m256i d, __m256i s, __m256i f)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i nf = _mm256_xor_si256(f, _mm256_set1_epi8(-1));
+    __m256i lo = _mm256_add_epi16(
+        _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero),
+                           _mm256_unpacklo_epi8(nf, zero)),
+        _mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero),
+                           _mm256_unpacklo_epi8(f, zero)));
+    __m256i hi = _mm256_add_epi16(
+        _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero),
+                           _mm256_unpackhi_epi8(nf, zero)),
+        _mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero),
+                           _mm256_unpackhi_epi8(f, zero)));
+    return _mm256_packus_epi16(Div255_avx2(lo), Div255_avx2(hi));
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i Even_avx2(const uint8_t *p)
+{
+    const __m256i mask = _mm256_set1_epi16(0x00ff);
+    __m256i v = _mm256_packus_epi16(
+        _mm256_and_si256(_mm256_loadu_si256((const __m256i *)&p[0]), mask),
+        _mm256_and_si256(_mm256_loadu_si256((const __m256i *)&p[32]), mask));
+    /* packus works within 128-bit lanes */
+    return _mm256_permute4x64_epi64(v, 0xd8);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i SplatAlpha_avx2(__m256i v)
+{
+    v = _mm256_srli_epi32(v, 24);
+    v = _mm256_or_si256(v, _mm256_slli_epi32(v, 8));
+    return _mm256_or_si256(v, _mm256_slli_epi32(v, 16));
+}
+
+struct CLinesAVX2 {
+    __attribute__ ((__target__ ("avx2")))
+    static void plane(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                      unsigned n, unsigned alpha)
+    {
+        const __m256i alpha16 = _mm256_set1_epi16(alpha);
+        unsigned i = 0;
+
+        for (; i + 32 <= n; i += 32) {
+            __m256i d = _mm256_loadu_si256((const __m256i *)&dst[i]);
+            __m256i s = _mm256_loadu_si256((const __m256i *)&src[i]);
+            __m256i f = Factor_avx2(_mm256_loadu_si256((const __m256i *)&a[i]),
+                                    alpha16);
+            _mm256_storeu_si256((__m256i *)&dst[i], Merge_avx2(d, s, f));
+        }
+        CLines::plane(&dst[i], &src[i], &a[i], n - i, alpha);
+    }
+    __attribute__ ((__target__ ("avx2")))
+    static void planeSub2(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                          unsigned n, unsigned alpha)
+    {
+        const __m256i alpha16 = _mm256_set1_epi16(alpha);
+        unsigned i = 0;
+
+        for (; i + 32 < n; i += 32) {
+            __m256i d = _mm256_loadu_si256((const __m256i *)&dst[i]);
+            __m256i f = Factor_avx2(Even_avx2(&a[2 * i]), alpha16);
+            _mm256_storeu_si256((__m256i *)&dst[i],
+                                Merge_avx2(d, Even_avx2(&src[2 * i]), f));
+        }
+        CLines::planeSub2(&dst[i], &src[2 * i], &a[2 * i], n - i, alpha);
+    }
+    __attribute__ ((__target__ ("avx2")))
+    static void semiPlanar(uint8_t *dst, const uint8_t *u, const uint8_t *v,
+                           const uint8_t *a, unsigned n, unsigned alpha)
+    {
+        const __m256i alpha16 = _mm256_set1_epi16(alpha);
+        const __m256i mask = _mm256_set1_epi16(0x00ff);
+        unsigned i = 0;
+
+        for (; i + 16 < n; i += 16) {
+            __m256i d = _mm256_loadu_si256((const __m256i *)&dst[2 * i]);
+            __m256i us = _mm256_loadu_si256((const __m256i *)&u[2 * i]);
+            __m256i vs = _mm256_loadu_si256((const __m256i *)&v[2 * i]);
+            __m256i as = _mm256_and_si256(
+                _mm256_loadu_si256((const __m256i *)&a[2 * i]), mask);
+            __m256i s = _mm256_or_si256(_mm256_and_si256(us, mask),
+                                        _mm256_slli_epi16(vs, 8));
+            __m256i f = Factor_avx2(_mm256_or_si256(as, _mm256_slli_epi16(as, 8)),
+                                    alpha16);
+            _mm256_storeu_si256((__m256i *)&dst[2 * i], Merge_avx2(d, s, f));
+        }
+        CLines::semiPlanar(&dst[2 * i], &u[2 * i], &v[2 * i], &a[2 * i],
+                           n - i, alpha);
+    }
+    __attribute__ ((__target__ ("avx2")))
+    static void rgba(uint8_t *dst, const uint8_t *src, unsigned n,
+                     unsigned alpha)
+    {
+        const __m256i alpha16 = _mm256_set1_epi16(alpha);
+        const __m256i amask = _mm256_set1_epi32(0xff000000);
+        unsigned i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            __m256i d = _mm256_loadu_si256((const __m256i *)&dst[4 * i]);
+            __m256i s = _mm256_loadu_si256((const __m256i *)&src[4 * i]);
+            __m256i f = Factor_avx2(SplatAlpha_avx2(s), alpha16);
+            __m256i nda = _mm256_xor_si256(SplatAlpha_avx2(d),
+                                           _mm256_set1_epi8(-1));
+            __m256i r = Merge_avx2(d, s, nda);
+            r = _mm256_or_si256(_mm256_andnot_si256(amask, r),
+                                _mm256_and_si256(amask, d));
+            r = Merge_avx2(r, _mm256_or_si256(s, amask), f);
+            __m256i skip = _mm256_cmpeq_epi8(f, _mm256_setzero_si256());
+            r = _mm256_blendv_epi8(r, d, skip);
+            _mm256_storeu_si256((__m256i *)&dst[4 * i], r);
+        }
+        CLines::rgba(&dst[4 * i], &src[4 * i], n - i, alpha);
+    }
+};
+#endif
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+/* div255() of the factors alpha * a */
+static inline uint8x16_t Factor_neon(uint8x16_t a, uint8x8_t alpha)
+{
+    uint16x8_t lo = vmull_u8(vget_low_u8(a), alpha);
+    uint16x8_t hi = vmull_u8(vget_high_u8(a), alpha);
+    const uint16x8_t one = vdupq_n_u16(1);
+
+    /* ((v >> 8) + v + 1) >> 8 */
+    lo = vsraq_n_u16(lo, lo, 8);
+    hi = vsraq_n_u16(hi, hi, 8);
+    return vcombine_u8(vaddhn_u16(lo, one), vaddhn_u16(hi, one));
+}
+
+static inline uint8x16_t Merge_neon(uint8x16_t d, uint8x16_t s, uint8x16_t f)
+{
+    const uint8x16_t nf = vmvnq_u8(f);
+    const uint16x8_t one = vdupq_n_u16(1);
+    uint16x8_t lo = vmull_u8(vget_low_u8(d), vget_low_u8(nf));
+    uint16x8_t hi = vmull_u8(vget_high_u8(d), vget_high_u8(nf));
+
+    lo = vmlal_u8(lo, vget_low_u8(s), vget_low_u8(f));
+    hi = vmlal_u8(hi, vget_high_u8(s), vget_high_u8(f));
+    lo = vsraq_n_u16(lo, lo, 8);
+    hi = vsraq_n_u16(hi, hi, 8);
+    return vcombine_u8(vaddhn_u16(lo, one), vaddhn_u16(hi, one));
+}
+
+struct CLinesNEON {
+    static void plane(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                      unsigned n, unsigned alpha)
+    {
+        const uint8x8_t alpha8 = vdup_n_u8(alpha);
+        unsigned i = 0;
+
+        for (; i + 16 <= n; i += 16) {
+            uint8x16_t f = Factor_neon(vld1q_u8(&a[i]), alpha8);
+            vst1q_u8(&dst[i], Merge_neon(vld1q_u8(&dst[i]),
+                                         vld1q_u8(&src[i]), f));
+        }
+        CLines::plane(&dst[i], &src[i], &a[i], n - i, alpha);
+    }
+    static void planeSub2(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                          unsigned n, unsigned alpha)
+    {
+        const uint8x8_t alpha8 = vdup_n_u8(alpha);
+        unsigned i = 0;
+
+        for (; i + 16 < n; i += 16) {
+            uint8x16_t f = Factor_neon(vld2q_u8(&a[2 * i]).val[0], alpha8);
+            vst1q_u8(&dst[i], Merge_neon(vld1q_u8(&dst[i]),
+                                         vld2q_u8(&src[2 * i]).val[0], f));
+        }
+        CLines::planeSub2(&dst[i], &src[2 * i], &a[2 * i], n - i, alpha);
+    }
+    static void semiPlanar(uint8_t *dst, const uint8_t *u, const uint8_t *v,
+                           const uint8_t *a, unsigned n, unsigned alpha)
+    {
+        const uint8x8_t alpha8 = vdup_n_u8(alpha);
+        unsigned i = 0;
+
+        for (; i + 16 < n; i += 16) {
+            uint8x16x2_t d = vld2q_u8(&dst[2 * i]);
+            uint8x16_t f = Factor_neon(vld2q_u8(&a[2 * i]).val[0], alpha8);
+
+            d.val[0] = Merge_neon(d.val[0], vld2q_u8(&u[2 * i]).val[0], f);
+            d.val[1] = Merge_neon(d.val[1], vld2q_u8(&v[2 * i]).val[0], f);
+            vst2q_u8(&dst[2 * i], d);
+        }
+        CLines::semiPlanar(&dst[2 * i], &u[2 * i], &v[2 * i], &a[2 * i],
+                           n - i, alpha);
+    }
+    static void rgba(uint8_t *dst, const uint8_t *src, unsigned n,
+                     unsigned alpha)
+    {
+        const uint8x8_t alpha8 = vdup_n_u8(alpha);
+        unsigned i = 0;
+
+        for (; i + 16 <= n; i += 16) {
+            const uint8x16x4_t d = vld4q_u8(&dst[4 * i]);
+            const uint8x16x4_t s = vld4q_u8(&src[4 * i]);
+            const uint8x16_t f = Factor_neon(s.val[3], alpha8);
+            const uint8x16_t nda = vmvnq_u8(d.val[3]);
+            const uint8x16_t skip = vceqq_u8(f, vdupq_n_u8(0));
+            uint8x16x4_t r;
+
+            for (unsigned c = 0; c < 3; c++) {
+                uint8x16_t v = Merge_neon(d.val[c], s.val[c], nda);
+                v = Merge_neon(v, s.val[c], f);
+                r.val[c] = vbslq_u8(skip, d.val[c], v);
+            }
+            r.val[3] = vbslq_u8(skip, d.val[3],
+                                Merge_neon(d.val[3], vdupq_n_u8(255), f));
+            vst4q_u8(&dst[4 * i], r);
+        }
+        CLines::rgba(&dst[4 * i], &src[4 * i], n - i, alpha);
+    }
+};
+#endif
+
+/* Sources of the 4:2:0 blenders, as spans of planar YUVA */
+class CSpanYUVA {
+public:
+    CSpanYUVA(const CPicture &src)
+    {
+        for (unsigned i = 0; i < 4; i++) {
+            const plane_t *p = src.getPlane(i);
+            data[i] = &p->p_pixels[src.getY() * p->i_pitch + src.getX()];
+            pitch[i] = p->i_pitch;
+        }
+    }
+    unsigned get(const uint8_t *span[4], unsigned y, unsigned x, unsigned n)
+    {
+        for (unsigned i = 0; i < 4; i++)
+            span[i] = &data[i][y * pitch[i] + x];
+        return n;
+    }
+private:
+    const uint8_t *data[4];
+    int pitch[4];
+};
+
+class CSpanYUVP {
+public:
+    CSpanYUVP(const CPicture &src) : palette(src.getFormat()->p_palette)
+    {
+        const plane_t *p = src.getPlane(0);
+        data = &p->p_pixels[src.getY() * p->i_pitch + src.getX()];
+        pitch = p->i_pitch;
+    }
+    unsigned get(const uint8_t *span[4], unsigned y, unsigned x, unsigned n)
+    {
+        const uint8_t *index = &data[y * pitch + x];
+
+        n = __MIN(n, sizeof (buffer[0]));
+        for (unsigned i = 0; i < n; i++) {
+            const uint8_t *entry = palette->palette[index[i]];
+
+            buffer[0][i] = entry[0];
+            buffer[1][i] = entry[1];
+            buffer[2][i] = entry[2];
+            buffer[3][i] = entry[3];
+        }
+        for (unsigned c = 0; c < 4; c++)
+            span[c] = buffer[c];
+        return n;
+    }
+private:
+    const video_palette_t *palette;
+    const uint8_t *data;
+    int pitch;
+    uint8_t buffer[4][256];
+};
+
+/* YUVA or YUVP to 8-bits 4:2:0 planar or semi-planar */
+template <class TLines, class TSpan, bool semiplanar, bool swap_uv>
+void Blend420(const CPicture &dst_data, const CPicture &src_data,
+              unsigned width, unsigned height, int alpha)
+{
+    const plane_t *py = dst_data.getPlane(0);
+    const plane_t *pu = dst_data.getPlane(semiplanar || !swap_uv ? 1 : 2);
+    const plane_t *pv = dst_data.getPlane(semiplanar || !swap_uv ? 2 : 1);
+    TSpan src(src_data);
+
+    for (unsigned y = 0; y < height; y++) {
+        const unsigned dy = dst_data.getY() + y;
+        uint8_t *line_y = &py->p_pixels[dy * py->i_pitch];
+        uint8_t *line_u = &pu->p_pixels[(dy / 2) * pu->i_pitch];
+        uint8_t *line_v = semiplanar ? NULL
+                                     : &pv->p_pixels[(dy / 2) * pv->i_pitch];
+
+        for (unsigned x = 0, n; x < width; x += n) {
+            const uint8_t *span[4];
+            const unsigned dx = dst_data.getX() + x;
+
+            n = src.get(span, y, x, width - x);
+            TLines::plane(&line_y[dx], span[0], span[3], n, alpha);
+
+            /* Chroma is sampled from the top-left pixel of each 2x2 block,
+             * as by the generic blender */
+            const unsigned odd = dx & 1;
+            if ((dy & 1) || n <= odd)
+                continue;
+
+            const unsigned cn = (n - odd + 1) / 2;
+            const unsigned cx = (dx + odd) / 2;
+            if (semiplanar)
+                TLines::semiPlanar(&line_u[2 * cx],
+                                   span[swap_uv ? 2 : 1] + odd,
+                                   span[swap_uv ? 1 : 2] + odd,
+                                   span[3] + odd, cn, alpha);
+            else {
+                TLines::planeSub2(&line_u[cx], span[1] + odd, span[3] + odd,
+                                  cn, alpha);
+                TLines::planeSub2(&line_v[cx], span[2] + odd, span[3] + odd,
+                                  cn, alpha);
+            }
+        }
+    }
+}
+
+template <class TLines>
+void BlendRGBA(const CPicture &dst_data, const CPicture &src_data,
+               unsigned width, unsigned height, int alpha)
+{
+    const plane_t *dp = dst_data.getPlane(0);
+    const plane_t *sp = src_data.getPlane(0);
+    uint8_t *dst = &dp->p_pixels[dst_data.getY() * dp->i_pitch
+                                 + dst_data.getX() * 4];
+    const uint8_t *src = &sp->p_pixels[src_data.getY() * sp->i_pitch
+                                       + src_data.getX() * 4];
+
+    for (unsigned y = 0; y < height; y++) {
+        TLines::rgba(dst, src, width, alpha);
+        dst += dp->i_pitch;
+        src += sp->i_pitch;
+    }
+}
+
+template <class TLines>
+blend_function_t FindFastBlend(vlc_fourcc_t dst, vlc_fourcc_t src)
+{
+    static const struct {
+        vlc_fourcc_t     dst;
+        vlc_fourcc_t     src;
+        blend_function_t blend;
+    } fast[] = {
+#define YUV420(csp, semiplanar, swap_uv) \
+    { csp, VLC_CODEC_YUVA, Blend420<TLines, CSpanYUVA, semiplanar, swap_uv> }, \
+    { csp, VLC_CODEC_YUVP, Blend420<TLines, CSpanYUVP, semiplanar, swap_uv> }
+        YUV420(VLC_CODEC_I420, false, false),
+        YUV420(VLC_CODEC_J420, false, false),
+        YUV420(VLC_CODEC_YV12, false, true),
+        YUV420(VLC_CODEC_NV12, true,  false),
+        YUV420(VLC_CODEC_NV21, true,  true),
+#undef YUV420
+        { VLC_CODEC_RGBA, VLC_CODEC_RGBA, BlendRGBA<TLines> },
+    };
+
+    for (size_t i = 0; i < sizeof(fast) / sizeof(*fast); i++) {
+        if (fast[i].src == src && fast[i].dst == dst)
+            return fast[i].blend;
+    }
+    return NULL;
+}
+
+} // namespace
+
 namespace {
 
 static const struct {
@@ -637,14 +1245,48 @@ static const struct {
 };
 
 struct filter_sys_t {
-    filter_sys_t() : blend(NULL)
+    filter_sys_t() : blend(NULL), slices(NULL)
     {
     }
     blend_function_t blend;
+    vlc_slices_t *slices;
+};
+
+/* Minimum size of a band blended by a thread */
+#define MIN_SLICE_PIXELS (128 * 1024)
+
+struct blend_job {
+    blend_function_t blend;
+    const picture_t *dst;
+    const picture_t *src;
+    const video_format_t *dst_fmt;
+    const video_format_t *src_fmt;
+    unsigned dst_x, dst_y;
+    unsigned src_x, src_y;
+    unsigned width, height;
+    int alpha;
 };
 
 } // namespace
 
+/* Each line of the destination is written from a single source line, so
+ * bands of lines can be blended independently. */
+static void BlendSlice(void *opaque, unsigned index, unsigned count)
+{
+    const struct blend_job *job = static_cast<const struct blend_job *>(opaque);
+    unsigned start, end;
+
+    vlc_slice_Lines(job->height, 1, index, count, &start, &end);
+    if (start >= end)
+        return;
+
+    job->blend(CPicture(job->dst, job->dst_fmt,
+                        job->dst_x, job->dst_y + start),
+               CPicture(job->src, job->src_fmt,
+                        job->src_x, job->src_y + start),
+               job->width, end - start, job->alpha);
+}
+
 /**
  * It blends 2 picture together.
  */
@@ -670,13 +1312,23 @@ static void DoBlend(filter_t *filter,
     video_format_FixRgb(&filter->fmt_out.video);
     video_format_FixRgb(&filter->fmt_in.video);
 
-    sys->blend(CPicture(dst, &filter->fmt_out.video,
-                        filter->fmt_out.video.i_x_offset + x_offset,
-                        filter->fmt_out.video.i_y_offset + y_offset),
-               CPicture(src, &filter->fmt_in.video,
-                        filter->fmt_in.video.i_x_offset,
-                        filter->fmt_in.video.i_y_offset),
-               width, height, alpha);
+    struct blend_job job;
+    job.blend   = sys->blend;
+    job.dst     = dst;
+    job.src     = src;
+    job.dst_fmt = &filter->fmt_out.video;
+    job.src_fmt = &filter->fmt_in.video;
+    job.dst_x   = filter->fmt_out.video.i_x_offset + x_offset;
+    job.dst_y   = filter->fmt_out.video.i_y_offset + y_offset;
+    job.src_x   = filter->fmt_in.video.i_x_offset;
+    job.src_y   = filter->fmt_in.video.i_y_offset;
+    job.width   = width;
+    job.height  = height;
+    job.alpha   = alpha;
+
+    unsigned count = vlc_slices_Count(sys->slices, height,
+                                      __MAX(1, MIN_SLICE_PIXELS / width));
+    vlc_slices_Run(sys->slices, count, BlendSlice, &job);
 }
 
 static const struct FilterOperationInitializer {
@@ -694,7 +1346,21 @@ static int Open(filter_t *filter)
     const vlc_fourcc_t dst = filter->fmt_out.video.i_chroma;
 
     filter_sys_t *sys = new filter_sys_t();
-    for (size_t i = 0; i < sizeof(blends) / sizeof(*blends); i++) {
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        sys->blend = FindFastBlend<CLinesAVX2>(dst, src);
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if (!sys->blend && vlc_CPU_SSE2())
+        sys->blend = FindFastBlend<CLinesSSE2>(dst, src);
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (!sys->blend && vlc_CPU_ARM_NEON())
+        sys->blend = FindFastBlend<CLinesNEON>(dst, src);
+#endif
+    if (!sys->blend)
+        sys->blend = FindFastBlend<CLines>(dst, src);
+    for (size_t i = 0; !sys->blend && i < sizeof(blends) / sizeof(*blends); i++) {
         if (blends[i].src == src && blends[i].dst == dst)
             sys->blend = blends[i].blend;
     }
@@ -706,6 +1372,8 @@ static int Open(filter_t *filter)
         return VLC_EGENERIC;
     }
 
+    sys->slices = vlc_slices_New(0);
+
     filter->ops = &filter_ops.ops;
     filter->p_sys          = sys;
     return VLC_SUCCESS;
@@ -714,5 +1382,7 @@ static int Open(filter_t *filter)
 static void Close(filter_t *filter)
 {
     filter_sys_t *p_sys = reinterpret_cast<filter_sys_t *>( filter->p_sys );
+    if (p_sys->slices)
+        vlc_slices_Delete(p_sys->slices);
     delete p_sys;
 }
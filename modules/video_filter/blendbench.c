@@ -251,16 +251,31 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
     }
     assert( p_blend->ops != NULL );
 
-    vlc_tick_t time = vlc_tick_now();
+    vlc_tick_t time = 0, best = VLC_TICK_MAX;
     for( int i_iter = 0; i_iter < p_sys->i_loops; ++i_iter )
     {
+        vlc_tick_t start = vlc_tick_now();
         filter_Blend( p_blend, p_sys->p_base_image,
                       0, 0, p_sys->p_blend_image, p_sys->i_alpha );
+        vlc_tick_t duration = vlc_tick_now() - start;
+
+        time += duration;
+        if( duration < best )
+            best = duration;
     }
-    time = vlc_tick_now() - time;
+    if( time <= 0 )
+        time = 1;
 
     msg_Info( p_filter, "Blended %d images in %f sec", p_sys->i_loops,
               secf_from_vlc_tick(time) );
+    if( p_sys->i_loops > 0 )
+        msg_Info( p_filter, "%4.4s onto %4.4s with %s: %f ms per image "
+                  "on average, %f ms at best",
+                  (const char *)&p_sys->p_blend_image->format.i_chroma,
+                  (const char *)&p_sys->p_base_image->format.i_chroma,
+                  module_get_object( p_blend->p_module ),
+                  secf_from_vlc_tick( time ) * 1000.f / p_sys->i_loops,
+                  secf_from_vlc_tick( best ) * 1000.f );
     msg_Info( p_filter, "Speed is: %f images/second, %f pixels/second",
               (float) p_sys->i_loops / time * CLOCK_FREQ,
               (float) p_sys->i_loops / time * CLOCK_FREQ *
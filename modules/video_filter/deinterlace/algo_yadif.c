@@ -37,6 +37,11 @@
 #include "common.h"      /* FFMIN3 et al. */
 
 #include "algo_yadif.h"
+#include "../../video_chroma/slices.h"
+
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
 
 /*****************************************************************************
  * Yadif (Yet Another DeInterlacing Filter).
@@ -45,17 +50,236 @@
 /* yadif.h comes from yadif.c of FFmpeg project.
    Necessary preprocessor macros are defined in common.h. */
 #include "yadif.h"
+/* bwdif.h comes from vf_bwdif.c of FFmpeg project. */
+#include "bwdif.h"
 
-int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
+#ifdef HAVE_AVX2_INTRINSICS
+/* Same as yadif_filter_line_c(), 16 pixels at a time on 16-bit lanes */
+#define LOAD16(p) _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(p)))
+#define ABSDIFF(a, b) _mm256_abs_epi16(_mm256_sub_epi16(a, b))
+#define SCORE(j) \
+    _mm256_add_epi16(_mm256_add_epi16( \
+        ABSDIFF(LOAD16(&cur[mrefs-1+(j)]), LOAD16(&cur[prefs-1-(j)])), \
+        ABSDIFF(LOAD16(&cur[mrefs  +(j)]), LOAD16(&cur[prefs  -(j)]))), \
+        ABSDIFF(LOAD16(&cur[mrefs+1+(j)]), LOAD16(&cur[prefs+1-(j)])))
+#define PRED(j) \
+    _mm256_srli_epi16(_mm256_add_epi16(LOAD16(&cur[mrefs+(j)]), \
+                                       LOAD16(&cur[prefs-(j)])), 1)
+#define CHECK_AVX2(j) \
+    score = SCORE(j); \
+    better = _mm256_and_si256(better, _mm256_cmpgt_epi16(spatial_score, score)); \
+    spatial_score = _mm256_blendv_epi8(spatial_score, score, better); \
+    spatial_pred = _mm256_blendv_epi8(spatial_pred, PRED(j), better);
+
+__attribute__ ((__target__ ("avx2")))
+static void yadif_filter_line_avx2(uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                                   uint8_t *next, int w, int prefs, int mrefs,
+                                   int parity, int mode)
 {
-    return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
+    uint8_t *prev2 = parity ? prev : cur;
+    uint8_t *next2 = parity ? cur  : next;
+    int x;
+
+    for (x = 0; x + 16 <= w; x += 16)
+    {
+        const __m256i c = LOAD16(&cur[mrefs]);
+        const __m256i e = LOAD16(&cur[prefs]);
+        const __m256i p2 = LOAD16(prev2);
+        const __m256i n2 = LOAD16(next2);
+        const __m256i d = _mm256_srli_epi16(_mm256_add_epi16(p2, n2), 1);
+        const __m256i temporal_diff0 = ABSDIFF(p2, n2);
+        const __m256i temporal_diff1 = _mm256_srli_epi16(_mm256_add_epi16(
+            ABSDIFF(LOAD16(&prev[mrefs]), c), ABSDIFF(LOAD16(&prev[prefs]), e)), 1);
+        const __m256i temporal_diff2 = _mm256_srli_epi16(_mm256_add_epi16(
+            ABSDIFF(LOAD16(&next[mrefs]), c), ABSDIFF(LOAD16(&next[prefs]), e)), 1);
+        __m256i diff = _mm256_max_epi16(_mm256_max_epi16(
+            _mm256_srli_epi16(temporal_diff0, 1), temporal_diff1), temporal_diff2);
+        __m256i spatial_pred = _mm256_srli_epi16(_mm256_add_epi16(c, e), 1);
+        __m256i spatial_score = _mm256_sub_epi16(SCORE(0), _mm256_set1_epi16(1));
+        __m256i score, better;
+
+        /* The second check of each side only applies where the first one
+         * improved the score, as in the nested C version. */
+        better = _mm256_set1_epi16(-1);
+        CHECK_AVX2(-1) CHECK_AVX2(-2)
+        better = _mm256_set1_epi16(-1);
+        CHECK_AVX2( 1) CHECK_AVX2( 2)
+
+        if (mode < 2)
+        {
+            const __m256i b = _mm256_srli_epi16(_mm256_add_epi16(
+                LOAD16(&prev2[2*mrefs]), LOAD16(&next2[2*mrefs])), 1);
+            const __m256i f = _mm256_srli_epi16(_mm256_add_epi16(
+                LOAD16(&prev2[2*prefs]), LOAD16(&next2[2*prefs])), 1);
+            const __m256i de = _mm256_sub_epi16(d, e);
+            const __m256i dc = _mm256_sub_epi16(d, c);
+            const __m256i bc = _mm256_sub_epi16(b, c);
+            const __m256i fe = _mm256_sub_epi16(f, e);
+            const __m256i max = _mm256_max_epi16(_mm256_max_epi16(de, dc),
+                                                 _mm256_min_epi16(bc, fe));
+            const __m256i min = _mm256_min_epi16(_mm256_min_epi16(de, dc),
+                                                 _mm256_max_epi16(bc, fe));
+
+            diff = _mm256_max_epi16(_mm256_max_epi16(diff, min),
+                                    _mm256_sub_epi16(_mm256_setzero_si256(), max));
+        }
+
+        /* diff is never negative, so this is the same as the C clipping */
+        spatial_pred = _mm256_max_epi16(spatial_pred, _mm256_sub_epi16(d, diff));
+        spatial_pred = _mm256_min_epi16(spatial_pred, _mm256_add_epi16(d, diff));
+
+        const __m256i packed = _mm256_permute4x64_epi64(
+            _mm256_packus_epi16(spatial_pred, spatial_pred), 0xD8);
+        _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(packed));
+
+        dst += 16;
+        cur += 16;
+        prev += 16;
+        next += 16;
+        prev2 += 16;
+        next2 += 16;
+    }
+
+    if (x < w)
+        yadif_filter_line_c(dst, prev, cur, next, w - x, prefs, mrefs,
+                            parity, mode);
 }
+#undef CHECK_AVX2
+#undef PRED
+#undef SCORE
+#undef ABSDIFF
+#undef LOAD16
+#endif
 
-int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
-                 int i_order, int i_field )
+typedef void (*yadif_line_fn)(uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                              uint8_t *next, int w, int prefs, int mrefs,
+                              int parity, int mode);
+typedef void (*bwdif_line_fn)(uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                              uint8_t *next, int w, int prefs, int mrefs,
+                              int refs, int parity, int mode, int clip_max);
+
+/* A field being interpolated, shared by all the slices */
+struct temporal_job
 {
-    VLC_UNUSED(p_src);
+    picture_t *p_dst;
+    const picture_t *p_prev, *p_cur, *p_next;
+    int i_field;
+    int parity;
+    int pixel_size;
+    int clip_max;
+    yadif_line_fn yadif; /* NULL for bwdif */
+    bwdif_line_fn bwdif;
+};
+
+static void YadifPlane( const struct temporal_job *job, int n,
+                        int start, int end )
+{
+    const plane_t *prevp = &job->p_prev->p[n];
+    const plane_t *curp  = &job->p_cur->p[n];
+    const plane_t *nextp = &job->p_next->p[n];
+    plane_t *dstp        = &job->p_dst->p[n];
+    const int w = dstp->i_visible_pitch / job->pixel_size;
+
+    for( int y = __MAX(start, 1); y < __MIN(end, dstp->i_visible_lines - 1); y++ )
+    {
+        if( (y % 2) == job->i_field  ||  job->parity == 2 )
+        {
+            memcpy( &dstp->p_pixels[y * dstp->i_pitch],
+                        &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
+        }
+        else
+        {
+            int mode;
+            /* Spatial checks only when enough data */
+            mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
+
+            assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+            job->yadif( &dstp->p_pixels[y * dstp->i_pitch],
+                        &prevp->p_pixels[y * prevp->i_pitch],
+                        &curp->p_pixels[y * curp->i_pitch],
+                        &nextp->p_pixels[y * nextp->i_pitch],
+                        w,
+                        y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
+                        y  - 1  ?  -curp->i_pitch : curp->i_pitch,
+                        job->parity,
+                        mode );
+        }
+
+        /* We duplicate the first and last lines */
+        if( y == 1 )
+            memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
+                       &dstp->p_pixels[ y    * dstp->i_pitch],
+                       dstp->i_pitch);
+        else if( y == dstp->i_visible_lines - 2 )
+            memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
+                       &dstp->p_pixels[ y    * dstp->i_pitch],
+                       dstp->i_pitch);
+    }
+}
+
+static void BwdifPlane( const struct temporal_job *job, int n,
+                        int start, int end )
+{
+    const plane_t *prevp = &job->p_prev->p[n];
+    const plane_t *curp  = &job->p_cur->p[n];
+    const plane_t *nextp = &job->p_next->p[n];
+    plane_t *dstp        = &job->p_dst->p[n];
+    const int w = dstp->i_visible_pitch / job->pixel_size;
+    const int h = dstp->i_visible_lines;
+    const int refs = curp->i_pitch;
+
+    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+
+    for( int y = start; y < end; y++ )
+    {
+        if( (y % 2) == job->i_field  ||  job->parity == 2 )
+        {
+            memcpy( &dstp->p_pixels[y * dstp->i_pitch],
+                    &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
+            continue;
+        }
 
+        int prefs = refs, mrefs = -refs, mode = 0;
+
+        /* Mirror the references at the edges, and use the simpler filters
+         * where the full one lacks context lines */
+        if( y < 4 || y + 5 > h )
+        {
+            prefs = y + 1 < h ? refs : -refs;
+            mrefs = y > 0 ? -refs : refs;
+            mode = (y < 2 || y + 3 > h) ? 2 : 1;
+        }
+
+        job->bwdif( &dstp->p_pixels[y * dstp->i_pitch],
+                    &prevp->p_pixels[y * prevp->i_pitch],
+                    &curp->p_pixels[y * curp->i_pitch],
+                    &nextp->p_pixels[y * nextp->i_pitch],
+                    w, prefs, mrefs, refs, job->parity, mode, job->clip_max );
+    }
+}
+
+static void RenderSlice( void *opaque, unsigned index, unsigned count )
+{
+    const struct temporal_job *job = opaque;
+
+    for( int n = 0; n < job->p_dst->i_planes; n++ )
+    {
+        unsigned start, end;
+
+        /* Each slice keeps whole pairs of lines, so that the lines it
+         * duplicates or copies are its own */
+        vlc_slice_Lines( job->p_dst->p[n].i_visible_lines, 2, index, count,
+                         &start, &end );
+        if( job->yadif != NULL )
+            YadifPlane( job, n, start, end );
+        else
+            BwdifPlane( job, n, start, end );
+    }
+}
+
+static int RenderTemporal( filter_t *p_filter, picture_t *p_dst,
+                           int i_order, int i_field, bool b_bwdif )
+{
     filter_sys_t *p_sys = p_filter->p_sys;
 
     /* */
@@ -108,66 +332,44 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
     /* Filter if we have all the pictures we need */
     if( p_prev && p_cur && p_next )
     {
-        /* */
-        void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
-                       int w, int prefs, int mrefs, int parity, int mode);
+        struct temporal_job job = {
+            .p_dst = p_dst,
+            .p_prev = p_prev,
+            .p_cur = p_cur,
+            .p_next = p_next,
+            .i_field = i_field,
+            .parity = yadif_parity,
+            .pixel_size = p_sys->chroma->pixel_size,
+            .clip_max = (1 << p_sys->chroma->pixel_bits) - 1,
+        };
 
+        if( b_bwdif )
+            job.bwdif = job.pixel_size == 2 ? bwdif_filter_line_c_16bit
+                                            : bwdif_filter_line_c;
+        else if( job.pixel_size == 2 )
+            job.yadif = yadif_filter_line_c_16bit;
+        else
+#ifdef HAVE_AVX2_INTRINSICS
+        if( vlc_CPU_AVX2() )
+            job.yadif = yadif_filter_line_avx2;
+        else
+#endif
 #if defined(HAVE_X86ASM)
         if( vlc_CPU_SSSE3() )
-            filter = vlcpriv_yadif_filter_line_ssse3;
+            job.yadif = vlcpriv_yadif_filter_line_ssse3;
         else
         if( vlc_CPU_SSE2() )
-            filter = vlcpriv_yadif_filter_line_sse2;
+            job.yadif = vlcpriv_yadif_filter_line_sse2;
         else
 #endif
-            filter = yadif_filter_line_c;
-
-        if( p_sys->chroma->pixel_size == 2 )
-            filter = yadif_filter_line_c_16bit;
+        if( p_sys->pf_yadif != NULL )
+            job.yadif = p_sys->pf_yadif;
+        else
+            job.yadif = yadif_filter_line_c;
 
-        for( int n = 0; n < p_dst->i_planes; n++ )
-        {
-            const plane_t *prevp = &p_prev->p[n];
-            const plane_t *curp  = &p_cur->p[n];
-            const plane_t *nextp = &p_next->p[n];
-            plane_t *dstp        = &p_dst->p[n];
-
-            for( int y = 1; y < dstp->i_visible_lines - 1; y++ )
-            {
-                if( (y % 2) == i_field  ||  yadif_parity == 2 )
-                {
-                    memcpy( &dstp->p_pixels[y * dstp->i_pitch],
-                                &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
-                }
-                else
-                {
-                    int mode;
-                    /* Spatial checks only when enough data */
-                    mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
-
-                    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
-                    filter( &dstp->p_pixels[y * dstp->i_pitch],
-                            &prevp->p_pixels[y * prevp->i_pitch],
-                            &curp->p_pixels[y * curp->i_pitch],
-                            &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
-                            y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
-                            y  - 1  ?  -curp->i_pitch : curp->i_pitch,
-                            yadif_parity,
-                            mode );
-                }
-
-                /* We duplicate the first and last lines */
-                if( y == 1 )
-                    memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-                else if( y == dstp->i_visible_lines - 2 )
-                    memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-            }
-        }
+        unsigned count = vlc_slices_Count( p_sys->slices,
+                                           p_dst->p[0].i_visible_lines, 64 );
+        vlc_slices_Run( p_sys->slices, count, RenderSlice, &job );
 
         p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
 
@@ -189,3 +391,27 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
         return VLC_EGENERIC;
     }
 }
+
+int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
+{
+    return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
+}
+
+int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
+                 int i_order, int i_field )
+{
+    VLC_UNUSED(p_src);
+    return RenderTemporal( p_filter, p_dst, i_order, i_field, false );
+}
+
+int RenderBwdifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
+{
+    return RenderBwdif( p_filter, p_dst, p_src, 0, 0 );
+}
+
+int RenderBwdif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
+                 int i_order, int i_field )
+{
+    VLC_UNUSED(p_src);
+    return RenderTemporal( p_filter, p_dst, i_order, i_field, true );
+}
@@ -28,6 +28,7 @@
  * \file
  * Adapter to fit the Yadif (Yet Another DeInterlacing Filter) algorithm
  * from FFmpeg into VLC. The algorithm itself is implemented in yadif.h.
+ * The BobWeaver variant (bwdif.h) shares the same adapter.
  */
 
 /* Forward declarations */
@@ -90,4 +91,25 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
  */
 int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src );
 
+/**
+ * BobWeaver Deinterlacing Filter (bwdif) from FFmpeg.
+ *
+ * Uses the same motion-adaptive scheme as Yadif, but interpolates the missing
+ * lines with a cubic filter, and checks the temporal differences across more
+ * lines. It is slightly slower and produces fewer artifacts on diagonal
+ * edges.
+ *
+ * The parameters and the history requirements are the same as for
+ * RenderYadif().
+ *
+ * @see RenderYadif()
+ */
+int RenderBwdif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
+                 int i_order, int i_field );
+
+/**
+ * Same as RenderBwdif() but with no temporal references
+ */
+int RenderBwdifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src );
+
 #endif
@@ -0,0 +1,114 @@
+/*
+ * BobWeaver Deinterlacing Filter
+ * Copyright (C) 2016 Thomas Mundt <loudmax@yahoo.de>
+ *
+ * Based on YADIF (Yet Another Deinterlacing Filter)
+ * Copyright (C) 2006-2011 Michael Niedermayer <michaelni@gmx.at>
+ *               2010      James Darnley <james.darnley@gmail.com>
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Coefficients of the low-pass, high-pass and spatial-only filters
+ * (sum-normalized to 1 << 13) */
+static const int bwdif_coef_lf[2] = { 4309, 213 };
+static const int bwdif_coef_hf[3] = { 5570, 3801, 1016 };
+static const int bwdif_coef_sp[2] = { 5077, 981 };
+
+/* mode 0: full filter, 4 lines of context on both sides
+ * mode 1: edge line, spatial check only (2 lines of context)
+ * mode 2: edge line, no spatial check */
+#define BWDIF_FILTER \
+    for (x = 0; x < w; x++) { \
+        int c = cur[mrefs]; \
+        int d = (prev2[0] + next2[0]) >> 1; \
+        int e = cur[prefs]; \
+        int temporal_diff0 = FFABS(prev2[0] - next2[0]); \
+        int temporal_diff1 =(FFABS(prev[mrefs] - c) + FFABS(prev[prefs] - e)) >> 1; \
+        int temporal_diff2 =(FFABS(next[mrefs] - c) + FFABS(next[prefs] - e)) >> 1; \
+        int diff = FFMAX3(temporal_diff0 >> 1, temporal_diff1, temporal_diff2); \
+ \
+        if (!diff) { \
+            dst[0] = d; \
+        } else { \
+            int interpol; \
+ \
+            if (mode < 2) { \
+                int b = ((prev2[mrefs2] + next2[mrefs2]) >> 1) - c; \
+                int f = ((prev2[prefs2] + next2[prefs2]) >> 1) - e; \
+                int dc = d - c; \
+                int de = d - e; \
+                int max = FFMAX3(de, dc, FFMIN(b, f)); \
+                int min = FFMIN3(de, dc, FFMAX(b, f)); \
+                diff = FFMAX3(diff, min, -max); \
+            } \
+ \
+            if (mode > 0) { \
+                interpol = (c + e) >> 1; \
+            } else if (FFABS(c - e) > temporal_diff0) { \
+                interpol = (((bwdif_coef_hf[0] * (prev2[0] + next2[0]) \
+                    - bwdif_coef_hf[1] * (prev2[mrefs2] + next2[mrefs2] + prev2[prefs2] + next2[prefs2]) \
+                    + bwdif_coef_hf[2] * (prev2[mrefs4] + next2[mrefs4] + prev2[prefs4] + next2[prefs4])) >> 2) \
+                    + bwdif_coef_lf[0] * (c + e) - bwdif_coef_lf[1] * (cur[mrefs3] + cur[prefs3])) >> 13; \
+            } else { \
+                interpol = (bwdif_coef_sp[0] * (c + e) - bwdif_coef_sp[1] * (cur[mrefs3] + cur[prefs3])) >> 13; \
+            } \
+ \
+            if (interpol > d + diff) \
+                interpol = d + diff; \
+            else if (interpol < d - diff) \
+                interpol = d - diff; \
+ \
+            dst[0] = interpol < 0 ? 0 : interpol > clip_max ? clip_max : interpol; \
+        } \
+ \
+        dst++; \
+        cur++; \
+        prev++; \
+        next++; \
+        prev2++; \
+        next2++; \
+    }
+
+/* prefs and mrefs may be mirrored at the picture edges, refs is the plain
+ * line pitch. */
+static void bwdif_filter_line_c(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int refs, int parity, int mode, int clip_max) {
+    int x;
+    uint8_t *prev2= parity ? prev : cur ;
+    uint8_t *next2= parity ? cur  : next;
+    const int prefs2 = 2 * refs, mrefs2 = -2 * refs;
+    const int prefs3 = 3 * refs, mrefs3 = -3 * refs;
+    const int prefs4 = 4 * refs, mrefs4 = -4 * refs;
+    BWDIF_FILTER
+}
+
+static void bwdif_filter_line_c_16bit(uint8_t *dst8, uint8_t *prev8, uint8_t *cur8, uint8_t *next8, int w, int prefs, int mrefs, int refs, int parity, int mode, int clip_max) {
+    uint16_t *dst = (uint16_t *)dst8;
+    uint16_t *prev = (uint16_t *)prev8;
+    uint16_t *cur = (uint16_t *)cur8;
+    uint16_t *next = (uint16_t *)next8;
+    int x;
+    uint16_t *prev2= parity ? prev : cur ;
+    uint16_t *next2= parity ? cur  : next;
+    mrefs /= 2;
+    prefs /= 2;
+    refs /= 2;
+    const int prefs2 = 2 * refs, mrefs2 = -2 * refs;
+    const int prefs3 = 3 * refs, mrefs3 = -3 * refs;
+    const int prefs4 = 4 * refs, mrefs4 = -4 * refs;
+    BWDIF_FILTER
+}
@@ -45,6 +45,7 @@
 #include "deinterlace.h"
 #include "helpers.h"
 #include "merge.h"
+#include "../../video_chroma/slices.h"
 
 /*****************************************************************************
  * video filter functions
@@ -355,6 +356,10 @@ static struct filter_mode_t filter_mode [] = {
                  { false, true, false, false }, false, true },
     { "yadif2x", .pf_render_ordered = RenderYadif,
                  { true, true, false, false }, false, true },
+    { "bwdif", .pf_render_single_pic = RenderBwdifSingle,
+                 { false, true, false, false }, false, true },
+    { "bwdif2x", .pf_render_ordered = RenderBwdif,
+                 { true, true, false, false }, false, true },
     { "x", .pf_render_single_pic = RenderX,
                  { false, false, false, false }, false, false },
     { "phosphor", .pf_render_ordered = RenderPhosphor,
@@ -434,11 +439,30 @@ picture_t *AllocPicture( filter_t *filter )
     return filter_NewPicture( filter );
 }
 
+/* Number of frames between two cost reports in the debug log */
+#define COST_REPORT_FRAMES 250
+
 /* This is the filter function. See Open(). */
 picture_t *Deinterlace( filter_t *p_filter, picture_t *p_pic )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    return DoDeinterlacing( p_filter, &p_sys->context, p_pic );
+    vlc_tick_t start = vlc_tick_now();
+    picture_t *p_out = DoDeinterlacing( p_filter, &p_sys->context, p_pic );
+    vlc_tick_t cost = vlc_tick_now() - start;
+
+    /* Keep a smoothed per-frame cost, so that the owner can fall back to a
+     * cheaper method (e.g. "linear" instead of "yadif") when the frame
+     * period is not met. */
+    if( p_sys->i_cost_frames == 0 )
+        p_sys->i_cost = cost;
+    else
+        p_sys->i_cost += (cost - p_sys->i_cost) / 8;
+    var_SetInteger( p_filter, "deinterlace-cost", p_sys->i_cost );
+
+    if( ++p_sys->i_cost_frames % COST_REPORT_FRAMES == 0 )
+        msg_Dbg( p_filter, "average cost: %"PRId64" us per frame",
+                 US_FROM_VLC_TICK(p_sys->i_cost) );
+    return p_out;
 }
 
 /*****************************************************************************
@@ -477,8 +501,13 @@ int Mouse( filter_t *p_filter,
  */
 static void Close( filter_t *p_filter )
 {
+    filter_sys_t *p_sys = p_filter->p_sys;
+
     Flush( p_filter );
-    free( p_filter->p_sys );
+    var_Destroy( p_filter, "deinterlace-cost" );
+    if( p_sys->slices != NULL )
+        vlc_slices_Delete( p_sys->slices );
+    free( p_sys );
 }
 
 static const struct vlc_filter_operations filter_ops = {
@@ -490,6 +519,7 @@ static const struct vlc_filter_operations filter_ops = {
 
 static struct deinterlace_functions funcs = {
     { Merge8BitGeneric, Merge16BitGeneric, },
+    NULL,
 };
 
 /*****************************************************************************
@@ -536,6 +566,9 @@ notsupp:
         return VLC_ENOMEM;
 
     p_sys->chroma = chroma;
+    p_sys->slices = NULL;
+    p_sys->i_cost = 0;
+    p_sys->i_cost_frames = 0;
 
     InitDeinterlacingContext( &p_sys->context );
 
@@ -552,6 +585,9 @@ notsupp:
 
     IVTCClearState( p_filter );
 
+    vlc_CPU_functions_init_once("deinterlace functions", &funcs);
+    p_sys->pf_yadif = funcs.yadif;
+
 #if defined(CAN_COMPILE_C_ALTIVEC)
     if( pixel_size == 1 && vlc_CPU_ALTIVEC() )
         p_sys->pf_merge = MergeAltivec;
@@ -566,7 +602,6 @@ notsupp:
     else
 #endif
     {
-        vlc_CPU_functions_init_once("deinterlace functions", &funcs);
         p_sys->pf_merge = funcs.merges[vlc_ctz(pixel_size)];
 #if defined(__i386__) || defined(__x86_64__)
         p_sys->pf_end_merge = NULL;
@@ -616,8 +651,14 @@ notsupp:
                         VLC_CODEC_J422 : VLC_CODEC_I422;
         }
     }
+    /* Only the temporal methods are heavy enough to be split */
+    if( !strncmp( psz_mode, "yadif", 5 ) || !strncmp( psz_mode, "bwdif", 5 ) )
+        p_sys->slices = vlc_slices_New( 0 );
     free( psz_mode );
 
+    /* Average time spent on each input frame */
+    var_Create( p_filter, "deinterlace-cost", VLC_VAR_INTEGER );
+
     if( !p_filter->b_allow_fmt_out_change &&
         ( fmt.i_chroma != p_filter->fmt_in.video.i_chroma ||
           fmt.i_height != p_filter->fmt_in.video.i_height ) )
@@ -50,12 +50,12 @@ struct vlc_object_t;
 /** Available deinterlace modes. */
 static const char *const mode_list[] = {
     "discard", "blend", "mean", "bob", "linear", "x",
-    "yadif", "yadif2x", "phosphor", "ivtc" };
+    "yadif", "yadif2x", "bwdif", "bwdif2x", "phosphor", "ivtc" };
 
 /** User labels for the available deinterlace modes. */
 static const char *const mode_list_text[] = {
     N_("Discard"), N_("Blend"), N_("Mean"), N_("Bob"), N_("Linear"), "X",
-    "Yadif", "Yadif (2x)", N_("Phosphor"), N_("Film NTSC (IVTC)") };
+    "Yadif", "Yadif (2x)", "BWDif", "BWDif (2x)", N_("Phosphor"), N_("Film NTSC (IVTC)") };
 
 /*****************************************************************************
  * Data structures
@@ -74,6 +74,16 @@ typedef struct
     /** Merge finalization routine for SSE */
     void (*pf_end_merge) ( void );
 #endif
+    /** 8-bit Yadif line routine from the CPU plugins, or NULL */
+    void (*pf_yadif) ( uint8_t *, uint8_t *, uint8_t *, uint8_t *,
+                       int, int, int, int, int );
+
+    /** Worker threads for the Yadif and bwdif bands */
+    struct vlc_slices *slices;
+
+    /** Average processing time of a frame (exponential moving average) */
+    vlc_tick_t i_cost;
+    unsigned i_cost_frames;
 
     struct deinterlace_ctx   context;
 
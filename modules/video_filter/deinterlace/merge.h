@@ -49,6 +49,17 @@
 
 typedef void (*merge_cb)(void *d, const void *s1, const void *s2, size_t len);
 
+/**
+ * Yadif line interpolation, see yadif_filter_line_c() in yadif.h.
+ *
+ * \param w width of the line in pixels
+ * \param prefs offset of the next line in bytes
+ * \param mrefs offset of the previous line in bytes
+ */
+typedef void (*yadif_line_cb)(uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                              uint8_t *next, int w, int prefs, int mrefs,
+                              int parity, int mode);
+
 /**
  * Deinterlacing optimisation callbacks.
  */
@@ -58,6 +69,8 @@ struct deinterlace_functions {
      * The first array entries are indexed by the binary order of magnitude
      * of the element size in bytes: 0 for 8-bit, 1 for 16-bit. */
     merge_cb merges[2];
+    /** 8-bit Yadif line filter (NULL for the C version) */
+    yadif_line_cb yadif;
 };
 
 /*****************************************************************************
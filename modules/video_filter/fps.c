@@ -33,12 +33,27 @@
 #include <vlc_filter.h>
 #include <vlc_picture.h>
 
+#include "fps_mc.h"
+
 static int Open( filter_t * );
 static picture_t *Filter( filter_t *p_filter, picture_t *p_picture);
 
 #define CFG_PREFIX "fps-"
 
 #define FPS_TEXT N_( "Frame rate" )
+#define QUALITY_TEXT N_( "Interpolation quality" )
+#define QUALITY_LONGTEXT N_( "How pictures are created on frame rate " \
+    "increase. Motion compensation produces smoother motion, at a higher " \
+    "CPU cost." )
+
+static const int pi_quality_values[] = {
+    FPS_QUALITY_DUPLICATE, FPS_QUALITY_BLEND,
+    FPS_QUALITY_MC_FAST, FPS_QUALITY_MC_FULL,
+};
+static const char *const ppsz_quality_texts[] = {
+    N_("Duplicate"), N_("Blend"),
+    N_("Motion compensation (fast)"), N_("Motion compensation (best)"),
+};
 
 vlc_module_begin ()
     set_description( N_("FPS conversion video filter") )
@@ -47,11 +62,15 @@ vlc_module_begin ()
 
     add_shortcut( "fps" )
     add_string( CFG_PREFIX "fps", NULL, FPS_TEXT, NULL )
+    add_integer_with_range( CFG_PREFIX "quality", FPS_QUALITY_DUPLICATE,
+                            FPS_QUALITY_DUPLICATE, FPS_QUALITY_MC_FULL,
+                            QUALITY_TEXT, QUALITY_LONGTEXT )
+        change_integer_list( pi_quality_values, ppsz_quality_texts )
     set_callback_video_filter( Open )
 vlc_module_end ()
 
 static const char *const ppsz_filter_options[] = {
-    "fps",
+    "fps", "quality",
     NULL
 };
 
@@ -62,6 +81,12 @@ typedef struct
     date_t          next_output_pts; /**< output calculated PTS */
     picture_t       *p_previous_pic; /**< kept source picture used to produce filter output */
     vlc_tick_t      i_output_frame_interval;
+
+    /* Interpolation (fps-quality above FPS_QUALITY_DUPLICATE) */
+    fps_mc_t        *p_mc;
+    vlc_tick_t      i_previous_date; /**< source date of p_previous_pic */
+    bool            b_previous_sent; /**< p_previous_pic was output as is */
+    vlc_tick_t      i_max_gap; /**< source gap treated as a discontinuity */
 } filter_sys_t;
 
 static void SetOutputDate(filter_sys_t *p_sys, picture_t *pic)
@@ -70,6 +95,67 @@ static void SetOutputDate(filter_sys_t *p_sys, picture_t *pic)
     date_Increment( &p_sys->next_output_pts, 1 );
 }
 
+/* Outputs every picture due before the new source picture, interpolated
+   between it and the previous one */
+static picture_t *Interpolate( filter_t *p_filter, picture_t *p_picture )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    picture_t *p_prev = p_sys->p_previous_pic;
+    const vlc_tick_t prev_date = p_sys->i_previous_date;
+    const vlc_tick_t src_date = p_picture->date;
+    picture_t *p_first = NULL, *p_last = NULL;
+    bool b_estimated = false;
+
+    while( date_Get( &p_sys->next_output_pts ) < src_date )
+    {
+        const vlc_tick_t date = date_Get( &p_sys->next_output_pts );
+        unsigned i_phase = 0;
+        if( date > prev_date )
+            i_phase = __MIN( ( date - prev_date ) * 256 / ( src_date - prev_date ),
+                             255 );
+
+        picture_t *p_out;
+        if( i_phase == 0 && !p_sys->b_previous_sent )
+        {
+            p_out = picture_Hold( p_prev );
+            p_sys->b_previous_sent = true;
+        }
+        else
+        {
+            p_out = picture_NewFromFormat( &p_filter->fmt_out.video );
+            if( unlikely( p_out == NULL ) )
+                break;
+
+            if( i_phase == 0 )
+                picture_Copy( p_out, p_prev );
+            else
+            {
+                if( !b_estimated )
+                {
+                    fps_mc_Estimate( p_sys->p_mc, p_prev, p_picture );
+                    b_estimated = true;
+                }
+                picture_CopyProperties( p_out, p_prev );
+                fps_mc_Interpolate( p_sys->p_mc, p_out, p_prev, p_picture,
+                                    i_phase );
+            }
+        }
+        SetOutputDate( p_sys, p_out );
+
+        if( p_last )
+            vlc_picture_chain_AppendChain( p_last, p_out );
+        else
+            p_first = p_out;
+        p_last = p_out;
+    }
+
+    picture_Release( p_prev );
+    p_sys->p_previous_pic = p_picture;
+    p_sys->i_previous_date = src_date;
+    p_sys->b_previous_sent = false;
+    return p_first;
+}
+
 static picture_t *Filter( filter_t *p_filter, picture_t *p_picture)
 {
     filter_sys_t *p_sys = p_filter->p_sys;
@@ -89,15 +175,25 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_picture)
 
     /* First time we get some valid timestamp, we'll take it as base for output
         later on we retake new timestamp if it has jumped too much */
-    if( unlikely( ( date_Get( &p_sys->next_output_pts ) == VLC_TICK_INVALID ) ||
-                   ( src_date > ( date_Get( &p_sys->next_output_pts ) + p_sys->i_output_frame_interval ) )
-                ) )
+    bool b_reset = date_Get( &p_sys->next_output_pts ) == VLC_TICK_INVALID;
+    if( p_sys->p_mc )
+        /* Output dates always catch up with the source while interpolating */
+        b_reset = b_reset || src_date < p_sys->i_previous_date ||
+                  src_date > p_sys->i_previous_date + p_sys->i_max_gap;
+    else
+        b_reset = b_reset || src_date > ( date_Get( &p_sys->next_output_pts ) +
+                                          p_sys->i_output_frame_interval );
+    if( unlikely( b_reset ) )
     {
         msg_Dbg( p_filter, "Resetting timestamps" );
         date_Set( &p_sys->next_output_pts, src_date );
         if( p_sys->p_previous_pic )
             picture_Release( p_sys->p_previous_pic );
         p_sys->p_previous_pic = picture_Hold( p_picture );
+        p_sys->i_previous_date = src_date;
+        p_sys->b_previous_sent = true;
+        if( p_sys->p_mc )
+            fps_mc_Reset( p_sys->p_mc );
         SetOutputDate( p_sys, p_picture );
         return p_picture;
     }
@@ -109,9 +205,14 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_picture)
         if( p_sys->p_previous_pic )
             picture_Release( p_sys->p_previous_pic );
         p_sys->p_previous_pic = p_picture;
+        p_sys->i_previous_date = src_date;
+        p_sys->b_previous_sent = false;
         return NULL;
     }
 
+    if( p_sys->p_mc )
+        return Interpolate( p_filter, p_picture );
+
     SetOutputDate( p_sys, p_sys->p_previous_pic );
 
     picture_t *last_pic = p_sys->p_previous_pic;
@@ -144,11 +245,18 @@ static void Flush( filter_t *p_filter )
         picture_Release( p_sys->p_previous_pic );
         p_sys->p_previous_pic = NULL;
     }
+    p_sys->i_previous_date = VLC_TICK_INVALID;
+    if( p_sys->p_mc )
+        fps_mc_Reset( p_sys->p_mc );
 }
 
 static void Close( filter_t *p_filter )
 {
+    filter_sys_t *p_sys = p_filter->p_sys;
+
     Flush( p_filter );
+    if( p_sys->p_mc )
+        fps_mc_Delete( p_sys->p_mc );
     if( p_filter->vctx_out )
         vlc_video_context_Release( p_filter->vctx_out );
 }
@@ -206,6 +314,28 @@ static int Open( filter_t *p_filter )
                p_filter->fmt_out.video.i_frame_rate, p_filter->fmt_out.video.i_frame_rate_base );
 
     p_sys->p_previous_pic = NULL;
+    p_sys->i_previous_date = VLC_TICK_INVALID;
+    p_sys->b_previous_sent = false;
+
+    /* Allow some jitter, and assume at least 10 fps if the source rate is
+       unknown */
+    vlc_tick_t i_input_frame_interval = VLC_TICK_FROM_MS(100);
+    if( p_filter->fmt_in.video.i_frame_rate && p_filter->fmt_in.video.i_frame_rate_base )
+        i_input_frame_interval = vlc_tick_from_samples( p_filter->fmt_in.video.i_frame_rate_base,
+                                                        p_filter->fmt_in.video.i_frame_rate );
+    p_sys->i_max_gap = 2 * __MAX( i_input_frame_interval, p_sys->i_output_frame_interval );
+
+    p_sys->p_mc = NULL;
+    const int i_quality = var_InheritInteger( p_filter, CFG_PREFIX "quality" );
+    if( i_quality > FPS_QUALITY_DUPLICATE )
+    {
+        if( p_filter->vctx_in == NULL )
+            p_sys->p_mc = fps_mc_New( VLC_OBJECT(p_filter), &p_filter->fmt_out.video,
+                                      i_quality );
+        if( p_sys->p_mc == NULL )
+            msg_Warn( p_filter, "cannot interpolate %4.4s pictures, duplicating",
+                      (const char *)&p_filter->fmt_in.video.i_chroma );
+    }
 
     p_filter->ops = &filter_ops;
 
@@ -0,0 +1,693 @@
+/*****************************************************************************
+ * fps_mc.c : frame interpolation for the fps conversion filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_picture.h>
+
+#ifdef CAN_COMPILE_SSE2
+#   include <emmintrin.h>
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+#   include <immintrin.h>
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+#   include <arm_neon.h>
+#endif
+
+#include "../video_chroma/slices.h"
+#include "fps_mc.h"
+
+/* Motion is estimated on the luma plane, by blocks of MC_BLOCK x MC_BLOCK
+ * pixels. Each vector points from a block of the current picture to its best
+ * match in the previous picture. */
+#define MC_BLOCK      16
+/* Maximum vector component (in luma pixels) */
+#define MC_RANGE      32
+/* Window of the exhaustive search (FPS_QUALITY_MC_FULL) */
+#define MC_FULL_RANGE 16
+/* Downscaling factor of the pictures for the initial, coarse search over the
+ * whole range */
+#define MC_COARSE     4
+/* Cost of a vector component deviating by one pixel from the prediction:
+ * this keeps the field smooth in flat areas, where any vector matches */
+#define MC_LAMBDA     4
+/* Average absolute difference per pixel beyond which the match is deemed
+ * wrong (occlusion, scene change...), and the block is cross-faded */
+#define MC_BAD_DIFF   20
+/* Minimum number of block rows per slice */
+#define MIN_SLICE_ROWS 4
+/* Minimum number of lines per slice when blending */
+#define MIN_SLICE_LINES 64
+
+typedef struct
+{
+    int8_t x, y;
+    bool   fallback; /* no reliable match, do not compensate */
+} mc_vector_t;
+
+typedef unsigned (*mc_sad_t)(const uint8_t *, ptrdiff_t,
+                             const uint8_t *, ptrdiff_t);
+typedef void (*mc_blend_t)(uint8_t *, const uint8_t *, const uint8_t *,
+                           unsigned width, unsigned weight);
+
+struct fps_mc
+{
+    const vlc_chroma_description_t *chroma;
+    unsigned    width, height;
+    int         quality;
+    bool        compensate;
+
+    /* Motion field, in blocks: partial blocks at the right and bottom edges
+     * are merged into the last complete column and row */
+    unsigned    cols, rows;
+    mc_vector_t *fields;
+    mc_vector_t *field;   /* last estimated field */
+    mc_vector_t *scratch; /* field being estimated */
+    /* Downscaled luma of the previous and current pictures */
+    uint8_t     *coarse[2];
+    unsigned    coarse_width, coarse_height;
+
+    mc_sad_t    sad;
+    mc_blend_t  blend;
+    vlc_slices_t *slices;
+};
+
+/*****************************************************************************
+ * Kernels
+ *****************************************************************************/
+
+/* Sum of absolute differences of two blocks of the coarse pictures */
+static unsigned sad_coarse(const uint8_t *a, const uint8_t *b, ptrdiff_t pitch)
+{
+    unsigned sum = 0;
+
+    for (unsigned y = 0; y < MC_BLOCK / MC_COARSE; y++, a += pitch, b += pitch)
+        for (unsigned x = 0; x < MC_BLOCK / MC_COARSE; x++)
+            sum += abs(a[x] - b[x]);
+    return sum;
+}
+
+/* Sum of absolute differences of two MC_BLOCK x MC_BLOCK blocks */
+static unsigned sad16_c(const uint8_t *a, ptrdiff_t a_pitch,
+                        const uint8_t *b, ptrdiff_t b_pitch)
+{
+    unsigned sum = 0;
+
+    for (unsigned y = 0; y < MC_BLOCK; y++, a += a_pitch, b += b_pitch)
+        for (unsigned x = 0; x < MC_BLOCK; x++)
+            sum += abs(a[x] - b[x]);
+    return sum;
+}
+
+/* dst = (a * (256 - weight) + b * weight) / 256, rounded */
+static void blend_row_c(uint8_t *dst, const uint8_t *a, const uint8_t *b,
+                        unsigned width, unsigned weight)
+{
+    for (unsigned x = 0; x < width; x++)
+        dst[x] = (a[x] * (256 - weight) + b[x] * weight + 128) >> 8;
+}
+
+#ifdef CAN_COMPILE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static unsigned sad16_sse2(const uint8_t *a, ptrdiff_t a_pitch,
+                           const uint8_t *b, ptrdiff_t b_pitch)
+{
+    __m128i sum = _mm_setzero_si128();
+
+    for (unsigned y = 0; y < MC_BLOCK; y++, a += a_pitch, b += b_pitch) {
+        const __m128i va = _mm_loadu_si128((const __m128i *)a);
+        const __m128i vb = _mm_loadu_si128((const __m128i *)b);
+
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(va, vb));
+    }
+    return _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void blend_row_sse2(uint8_t *dst, const uint8_t *a, const uint8_t *b,
+                           unsigned width, unsigned weight)
+{
+    const __m128i wa = _mm_set1_epi16(256 - weight);
+    const __m128i wb = _mm_set1_epi16(weight);
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i zero = _mm_setzero_si128();
+    unsigned x = 0;
+
+    /* The sums fit in 16 bits as the weights add up to 256 */
+    for (; x + 16 <= width; x += 16) {
+        const __m128i va = _mm_loadu_si128((const __m128i *)&a[x]);
+        const __m128i vb = _mm_loadu_si128((const __m128i *)&b[x]);
+        __m128i lo = _mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb));
+        __m128i hi = _mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb));
+
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 8);
+        _mm_storeu_si128((__m128i *)&dst[x], _mm_packus_epi16(lo, hi));
+    }
+    blend_row_c(&dst[x], &a[x], &b[x], width - x, weight);
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+/* Two rows per iteration, one in each 128-bit lane */
+__attribute__ ((__target__ ("avx2")))
+static unsigned sad16_avx2(const uint8_t *a, ptrdiff_t a_pitch,
+                           const uint8_t *b, ptrdiff_t b_pitch)
+{
+    __m256i sum = _mm256_setzero_si256();
+
+    for (unsigned y = 0; y < MC_BLOCK; y += 2) {
+        const __m256i va = _mm256_inserti128_si256(_mm256_castsi128_si256(
+            _mm_loadu_si128((const __m128i *)a)),
+            _mm_loadu_si128((const __m128i *)(a + a_pitch)), 1);
+        const __m256i vb = _mm256_inserti128_si256(_mm256_castsi128_si256(
+            _mm_loadu_si128((const __m128i *)b)),
+            _mm_loadu_si128((const __m128i *)(b + b_pitch)), 1);
+
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(va, vb));
+        a += 2 * a_pitch;
+        b += 2 * b_pitch;
+    }
+
+    const __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum),
+                                       _mm256_extracti128_si256(sum, 1));
+    return _mm_cvtsi128_si32(half) + _mm_cvtsi128_si32(_mm_srli_si128(half, 8));
+}
+#endif
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+static unsigned sad16_neon(const uint8_t *a, ptrdiff_t a_pitch,
+                           const uint8_t *b, ptrdiff_t b_pitch)
+{
+    /* At most 2 * MC_BLOCK * 255 per lane: no 16-bit overflow */
+    uint16x8_t sum = vdupq_n_u16(0);
+
+    for (unsigned y = 0; y < MC_BLOCK; y++, a += a_pitch, b += b_pitch) {
+        const uint8x16_t va = vld1q_u8(a);
+        const uint8x16_t vb = vld1q_u8(b);
+
+        sum = vabal_u8(sum, vget_low_u8(va), vget_low_u8(vb));
+        sum = vabal_high_u8(sum, va, vb);
+    }
+    return vaddlvq_u16(sum);
+}
+
+static void blend_row_neon(uint8_t *dst, const uint8_t *a, const uint8_t *b,
+                           unsigned width, unsigned weight)
+{
+    const uint16x8_t wa = vdupq_n_u16(256 - weight);
+    const uint16x8_t wb = vdupq_n_u16(weight);
+    unsigned x = 0;
+
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16_t va = vld1q_u8(&a[x]);
+        const uint8x16_t vb = vld1q_u8(&b[x]);
+        uint16x8_t lo = vmulq_u16(vmovl_u8(vget_low_u8(va)), wa);
+        uint16x8_t hi = vmulq_u16(vmovl_high_u8(va), wa);
+
+        lo = vmlaq_u16(lo, vmovl_u8(vget_low_u8(vb)), wb);
+        hi = vmlaq_u16(hi, vmovl_high_u8(vb), wb);
+        vst1q_u8(&dst[x], vcombine_u8(vrshrn_n_u16(lo, 8),
+                                      vrshrn_n_u16(hi, 8)));
+    }
+    blend_row_c(&dst[x], &a[x], &b[x], width - x, weight);
+}
+#endif
+
+/*****************************************************************************
+ * Motion estimation
+ *****************************************************************************/
+
+struct mc_search
+{
+    const fps_mc_t *mc;
+    const uint8_t *cur, *prev; /* block in each picture */
+    ptrdiff_t cur_pitch, prev_pitch;
+    int min_x, max_x, min_y, max_y;
+    int pred_x, pred_y;
+    int best_x, best_y;
+    unsigned best_cost, best_sad;
+};
+
+static void CheckVector(struct mc_search *s, int x, int y)
+{
+    if (x < s->min_x || x > s->max_x || y < s->min_y || y > s->max_y)
+        return;
+
+    const unsigned sad = s->mc->sad(s->cur, s->cur_pitch,
+                                    s->prev + y * s->prev_pitch + x,
+                                    s->prev_pitch);
+    const unsigned cost = sad + MC_LAMBDA * (abs(x - s->pred_x) +
+                                             abs(y - s->pred_y));
+    if (cost < s->best_cost) {
+        s->best_cost = cost;
+        s->best_sad = sad;
+        s->best_x = x;
+        s->best_y = y;
+    }
+}
+
+static int Median(int a, int b, int c)
+{
+    return __MAX(__MIN(a, b), __MIN(__MAX(a, b), c));
+}
+
+/* Finds the best match over the whole range in the downscaled pictures,
+ * as the predictions alone may all be off in textured areas */
+static void SearchCoarse(const fps_mc_t *mc, struct mc_search *s,
+                         unsigned bx, unsigned by)
+{
+    const ptrdiff_t pitch = mc->coarse_width;
+    const int x = bx * (MC_BLOCK / MC_COARSE), y = by * (MC_BLOCK / MC_COARSE);
+    const uint8_t *cur = &mc->coarse[1][y * pitch + x];
+    const uint8_t *prev = &mc->coarse[0][y * pitch + x];
+    unsigned best = UINT_MAX;
+    int best_x = 0, best_y = 0;
+
+    for (int vy = s->min_y / MC_COARSE; vy <= s->max_y / MC_COARSE; vy++)
+        for (int vx = s->min_x / MC_COARSE; vx <= s->max_x / MC_COARSE; vx++) {
+            /* Favour short vectors on ties */
+            const unsigned cost = sad_coarse(cur, prev + vy * pitch + vx, pitch)
+                                + abs(vx) + abs(vy);
+            if (cost < best) {
+                best = cost;
+                best_x = vx;
+                best_y = vy;
+            }
+        }
+
+    CheckVector(s, best_x * MC_COARSE, best_y * MC_COARSE);
+}
+
+static void SearchBlock(const fps_mc_t *mc, const picture_t *prev,
+                        const picture_t *cur, unsigned bx, unsigned by,
+                        unsigned first_row)
+{
+    const int x = bx * MC_BLOCK, y = by * MC_BLOCK;
+    const mc_vector_t *field = mc->scratch;
+    struct mc_search s = {
+        .mc = mc,
+        .cur = &cur->p[0].p_pixels[y * cur->p[0].i_pitch + x],
+        .prev = &prev->p[0].p_pixels[y * prev->p[0].i_pitch + x],
+        .cur_pitch = cur->p[0].i_pitch,
+        .prev_pitch = prev->p[0].i_pitch,
+        .min_x = __MAX(-MC_RANGE, -x),
+        .max_x = __MIN(MC_RANGE, (int)mc->width - MC_BLOCK - x),
+        .min_y = __MAX(-MC_RANGE, -y),
+        .max_y = __MIN(MC_RANGE, (int)mc->height - MC_BLOCK - y),
+        .best_cost = UINT_MAX,
+    };
+
+    /* Spatial neighbours, only from this slice as the others are being
+     * estimated concurrently */
+    static const mc_vector_t zero;
+    const mc_vector_t *left = bx > 0 ? &field[by * mc->cols + bx - 1] : &zero;
+    const mc_vector_t *top = &zero, *top_right = &zero;
+    if (by > first_row) {
+        top = &field[(by - 1) * mc->cols + bx];
+        if (bx + 1 < mc->cols)
+            top_right = &field[(by - 1) * mc->cols + bx + 1];
+    }
+
+    s.pred_x = Median(left->x, top->x, top_right->x);
+    s.pred_y = Median(left->y, top->y, top_right->y);
+
+    CheckVector(&s, 0, 0);
+    SearchCoarse(mc, &s, bx, by);
+    CheckVector(&s, s.pred_x, s.pred_y);
+    CheckVector(&s, left->x, left->y);
+    CheckVector(&s, top->x, top->y);
+    CheckVector(&s, top_right->x, top_right->y);
+
+    /* Temporal neighbours, from the previous pair */
+    const mc_vector_t *last = &mc->field[by * mc->cols + bx];
+    CheckVector(&s, last->x, last->y);
+    if (bx + 1 < mc->cols)
+        CheckVector(&s, last[1].x, last[1].y);
+    if (by + 1 < mc->rows)
+        CheckVector(&s, last[mc->cols].x, last[mc->cols].y);
+
+    if (mc->quality >= FPS_QUALITY_MC_FULL) {
+        for (int vy = -MC_FULL_RANGE; vy <= MC_FULL_RANGE; vy++)
+            for (int vx = -MC_FULL_RANGE; vx <= MC_FULL_RANGE; vx++)
+                CheckVector(&s, vx, vy);
+    }
+
+    /* Small diamond refinement around the best candidate */
+    for (unsigned i = 0; i < 2 * MC_RANGE; i++) {
+        const int cx = s.best_x, cy = s.best_y;
+
+        CheckVector(&s, cx - 1, cy);
+        CheckVector(&s, cx + 1, cy);
+        CheckVector(&s, cx, cy - 1);
+        CheckVector(&s, cx, cy + 1);
+        if (cx == s.best_x && cy == s.best_y)
+            break;
+    }
+
+    if (mc->quality >= FPS_QUALITY_MC_FULL) {
+        const int cx = s.best_x, cy = s.best_y;
+
+        CheckVector(&s, cx - 1, cy - 1);
+        CheckVector(&s, cx + 1, cy - 1);
+        CheckVector(&s, cx - 1, cy + 1);
+        CheckVector(&s, cx + 1, cy + 1);
+    }
+
+    mc_vector_t *v = &mc->scratch[by * mc->cols + bx];
+    v->x = s.best_x;
+    v->y = s.best_y;
+    v->fallback = s.best_sad > MC_BAD_DIFF * MC_BLOCK * MC_BLOCK;
+}
+
+struct mc_job
+{
+    const fps_mc_t *mc;
+    picture_t *dst;
+    const picture_t *prev, *cur;
+    unsigned phase;
+};
+
+static void Downscale(uint8_t *dst, ptrdiff_t dst_pitch, const plane_t *src,
+                      unsigned width, unsigned start, unsigned end)
+{
+    for (unsigned y = start; y < end; y++) {
+        const uint8_t *in = &src->p_pixels[y * MC_COARSE * src->i_pitch];
+
+        for (unsigned x = 0; x < width; x++) {
+            unsigned sum = 0;
+
+            for (unsigned i = 0; i < MC_COARSE; i++)
+                for (unsigned j = 0; j < MC_COARSE; j++)
+                    sum += in[i * src->i_pitch + x * MC_COARSE + j];
+            dst[y * dst_pitch + x] = (sum + MC_COARSE * MC_COARSE / 2)
+                                   / (MC_COARSE * MC_COARSE);
+        }
+    }
+}
+
+static void DownscaleSlice(void *opaque, unsigned index, unsigned count)
+{
+    const struct mc_job *job = opaque;
+    const fps_mc_t *mc = job->mc;
+    unsigned start, end;
+
+    vlc_slice_Lines(mc->coarse_height, 1, index, count, &start, &end);
+    Downscale(mc->coarse[0], mc->coarse_width, &job->prev->p[0],
+              mc->coarse_width, start, end);
+    Downscale(mc->coarse[1], mc->coarse_width, &job->cur->p[0],
+              mc->coarse_width, start, end);
+}
+
+static void EstimateSlice(void *opaque, unsigned index, unsigned count)
+{
+    const struct mc_job *job = opaque;
+    const fps_mc_t *mc = job->mc;
+    unsigned start, end;
+
+    vlc_slice_Lines(mc->rows, 1, index, count, &start, &end);
+    for (unsigned by = start; by < end; by++)
+        for (unsigned bx = 0; bx < mc->cols; bx++)
+            SearchBlock(mc, job->prev, job->cur, bx, by, start);
+}
+
+void fps_mc_Estimate(fps_mc_t *mc, const picture_t *prev, const picture_t *cur)
+{
+    if (!mc->compensate)
+        return;
+
+    struct mc_job job = {
+        .mc = mc,
+        .prev = prev,
+        .cur = cur,
+    };
+    const unsigned count = vlc_slices_Count(mc->slices, mc->rows,
+                                            MIN_SLICE_ROWS);
+
+    vlc_slices_Run(mc->slices, count, DownscaleSlice, &job);
+    vlc_slices_Run(mc->slices, count, EstimateSlice, &job);
+
+    mc_vector_t *field = mc->field;
+    mc->field = mc->scratch;
+    mc->scratch = field;
+}
+
+/*****************************************************************************
+ * Interpolation
+ *****************************************************************************/
+
+/* Rounds v * phase * num / (256 * den) to the nearest integer */
+static int ScaleVector(int v, unsigned phase, unsigned num, unsigned den)
+{
+    const int n = v * (int)(phase * num);
+    const int d = 256 * den;
+
+    return n >= 0 ? (n + d / 2) / d : -((d / 2 - n) / d);
+}
+
+/* Blends the block (x0, y0)-(x1, y1) of a, displaced by (ax, ay), with that
+ * of b, displaced by (bx, by) */
+static void CompensateBlock(const fps_mc_t *mc, plane_t *dst,
+                            const plane_t *a, const plane_t *b,
+                            int w, int h, int x0, int x1, int y0, int y1,
+                            int ax, int ay, int bx, int by, unsigned weight)
+{
+    if (x0 + __MIN(ax, bx) >= 0 && x1 + __MAX(ax, bx) <= w
+     && y0 + __MIN(ay, by) >= 0 && y1 + __MAX(ay, by) <= h) {
+        for (int y = y0; y < y1; y++)
+            mc->blend(&dst->p_pixels[y * dst->i_pitch + x0],
+                      &a->p_pixels[(y + ay) * a->i_pitch + x0 + ax],
+                      &b->p_pixels[(y + by) * b->i_pitch + x0 + bx],
+                      x1 - x0, weight);
+        return;
+    }
+
+    /* Extend the edges of the picture */
+    for (int y = y0; y < y1; y++) {
+        uint8_t *out = &dst->p_pixels[y * dst->i_pitch];
+        const uint8_t *la = &a->p_pixels[VLC_CLIP(y + ay, 0, h - 1) * a->i_pitch];
+        const uint8_t *lb = &b->p_pixels[VLC_CLIP(y + by, 0, h - 1) * b->i_pitch];
+
+        for (int x = x0; x < x1; x++)
+            out[x] = (la[VLC_CLIP(x + ax, 0, w - 1)] * (256 - weight) +
+                      lb[VLC_CLIP(x + bx, 0, w - 1)] * weight + 128) >> 8;
+    }
+}
+
+static void InterpolateSlice(void *opaque, unsigned index, unsigned count)
+{
+    const struct mc_job *job = opaque;
+    const fps_mc_t *mc = job->mc;
+    const unsigned phase = job->phase;
+    unsigned start, end;
+
+    vlc_slice_Lines(mc->rows, 1, index, count, &start, &end);
+
+    for (int i = 0; i < job->dst->i_planes; i++) {
+        const vlc_rational_t *pw = &mc->chroma->p[i].w;
+        const vlc_rational_t *ph = &mc->chroma->p[i].h;
+        const int w = mc->width  * pw->num / pw->den;
+        const int h = mc->height * ph->num / ph->den;
+        const int bw = MC_BLOCK * pw->num / pw->den;
+        const int bh = MC_BLOCK * ph->num / ph->den;
+
+        for (unsigned by = start; by < end; by++) {
+            const int y0 = by * bh;
+            const int y1 = by + 1 < mc->rows ? y0 + bh : h;
+
+            for (unsigned bx = 0; bx < mc->cols; bx++) {
+                const mc_vector_t *v = &mc->field[by * mc->cols + bx];
+                const int x0 = bx * bw;
+                const int x1 = bx + 1 < mc->cols ? x0 + bw : w;
+                int ax = 0, ay = 0, cx = 0, cy = 0;
+
+                /* The block moved by v from prev to cur: at this phase, it
+                 * is found at a fraction of v in both pictures */
+                if (!v->fallback) {
+                    ax = ScaleVector(v->x, phase, pw->num, pw->den);
+                    ay = ScaleVector(v->y, phase, ph->num, ph->den);
+                    cx = -ScaleVector(v->x, 256 - phase, pw->num, pw->den);
+                    cy = -ScaleVector(v->y, 256 - phase, ph->num, ph->den);
+                }
+                CompensateBlock(mc, &job->dst->p[i], &job->prev->p[i],
+                                &job->cur->p[i], w, h, x0, x1, y0, y1,
+                                ax, ay, cx, cy, phase);
+            }
+        }
+    }
+}
+
+static void BlendSlice(void *opaque, unsigned index, unsigned count)
+{
+    const struct mc_job *job = opaque;
+    const fps_mc_t *mc = job->mc;
+
+    for (int i = 0; i < job->dst->i_planes; i++) {
+        plane_t *dst = &job->dst->p[i];
+        const plane_t *a = &job->prev->p[i];
+        const plane_t *b = &job->cur->p[i];
+        const unsigned lines = __MIN(dst->i_visible_lines,
+                                     __MIN(a->i_visible_lines,
+                                           b->i_visible_lines));
+        const unsigned width = __MIN(dst->i_visible_pitch,
+                                     __MIN(a->i_visible_pitch,
+                                           b->i_visible_pitch));
+        unsigned start, end;
+
+        vlc_slice_Lines(lines, 1, index, count, &start, &end);
+        for (unsigned y = start; y < end; y++)
+            mc->blend(&dst->p_pixels[y * dst->i_pitch],
+                      &a->p_pixels[y * a->i_pitch],
+                      &b->p_pixels[y * b->i_pitch], width, job->phase);
+    }
+}
+
+void fps_mc_Interpolate(fps_mc_t *mc, picture_t *dst, const picture_t *prev,
+                        const picture_t *cur, unsigned phase)
+{
+    struct mc_job job = {
+        .mc = mc,
+        .dst = dst,
+        .prev = prev,
+        .cur = cur,
+        .phase = __MIN(phase, 256),
+    };
+
+    if (mc->compensate)
+        vlc_slices_Run(mc->slices,
+                       vlc_slices_Count(mc->slices, mc->rows, MIN_SLICE_ROWS),
+                       InterpolateSlice, &job);
+    else
+        vlc_slices_Run(mc->slices,
+                       vlc_slices_Count(mc->slices, mc->height, MIN_SLICE_LINES),
+                       BlendSlice, &job);
+}
+
+/*****************************************************************************
+ * Setup
+ *****************************************************************************/
+
+void fps_mc_Reset(fps_mc_t *mc)
+{
+    if (mc->field != NULL)
+        memset(mc->field, 0, mc->cols * mc->rows * sizeof (*mc->field));
+}
+
+fps_mc_t *fps_mc_New(vlc_object_t *obj, const video_format_t *fmt, int quality)
+{
+    const vlc_chroma_description_t *chroma =
+        vlc_fourcc_GetChromaDescription(fmt->i_chroma);
+
+    if (chroma == NULL || chroma->plane_count == 0 || chroma->pixel_size != 1)
+        return NULL;
+
+    fps_mc_t *mc = malloc(sizeof (*mc));
+    if (unlikely(mc == NULL))
+        return NULL;
+
+    mc->chroma = chroma;
+    mc->width = fmt->i_width;
+    mc->height = fmt->i_height;
+    mc->quality = quality;
+    mc->cols = mc->width / MC_BLOCK;
+    mc->rows = mc->height / MC_BLOCK;
+    mc->fields = mc->field = mc->scratch = NULL;
+    mc->coarse[0] = mc->coarse[1] = NULL;
+    mc->coarse_width = mc->width / MC_COARSE;
+    mc->coarse_height = mc->height / MC_COARSE;
+
+    /* Semi-planar chroma samples are interleaved, and cannot be displaced
+     * like the luma ones */
+    mc->compensate = quality >= FPS_QUALITY_MC_FAST
+                  && chroma->plane_count != 2
+                  && mc->cols > 0 && mc->rows > 0;
+    if (quality >= FPS_QUALITY_MC_FAST && !mc->compensate)
+        msg_Dbg(obj, "cannot compensate motion for %4.4s %ux%u, blending",
+                (const char *)&fmt->i_chroma, mc->width, mc->height);
+
+    if (mc->compensate) {
+        const size_t coarse_size = mc->coarse_width * mc->coarse_height;
+
+        mc->fields = calloc(2 * mc->cols * mc->rows, sizeof (*mc->fields));
+        mc->coarse[0] = malloc(2 * coarse_size);
+        if (unlikely(mc->fields == NULL || mc->coarse[0] == NULL)) {
+            free(mc->coarse[0]);
+            free(mc->fields);
+            free(mc);
+            return NULL;
+        }
+        mc->coarse[1] = mc->coarse[0] + coarse_size;
+        mc->field = mc->fields;
+        mc->scratch = mc->fields + mc->cols * mc->rows;
+    }
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        mc->sad = sad16_avx2;
+    else
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        mc->sad = sad16_neon;
+    else
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        mc->sad = sad16_sse2;
+    else
+#endif
+        mc->sad = sad16_c;
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        mc->blend = blend_row_neon;
+    else
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        mc->blend = blend_row_sse2;
+    else
+#endif
+        mc->blend = blend_row_c;
+
+    mc->slices = vlc_slices_New(0);
+    return mc;
+}
+
+void fps_mc_Delete(fps_mc_t *mc)
+{
+    if (mc->slices != NULL)
+        vlc_slices_Delete(mc->slices);
+    free(mc->coarse[0]);
+    free(mc->fields);
+    free(mc);
+}
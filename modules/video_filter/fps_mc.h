@@ -0,0 +1,68 @@
+/*****************************************************************************
+ * fps_mc.h : frame interpolation for the fps conversion filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_FPS_MC_H
+#define VLC_FPS_MC_H 1
+
+/** Interpolation quality levels (fps-quality) */
+enum
+{
+    FPS_QUALITY_DUPLICATE,  /**< repeat the previous picture */
+    FPS_QUALITY_BLEND,      /**< cross-fade the surrounding pictures */
+    FPS_QUALITY_MC_FAST,    /**< motion compensation, predictive search */
+    FPS_QUALITY_MC_FULL,    /**< motion compensation, exhaustive search */
+};
+
+typedef struct fps_mc fps_mc_t;
+
+/**
+ * Creates a frame interpolator.
+ *
+ * Motion compensation needs planar 8-bit pictures; other 8-bit formats are
+ * only blended.
+ *
+ * \param quality one of FPS_QUALITY_BLEND, FPS_QUALITY_MC_FAST or
+ * FPS_QUALITY_MC_FULL
+ * \return an interpolator, or NULL if the format is not supported
+ */
+fps_mc_t *fps_mc_New(vlc_object_t *, const video_format_t *, int quality);
+void fps_mc_Delete(fps_mc_t *);
+
+/**
+ * Forgets the motion of the past pictures (e.g. after a discontinuity).
+ */
+void fps_mc_Reset(fps_mc_t *);
+
+/**
+ * Estimates the motion between two consecutive source pictures.
+ *
+ * This must be called once for each pair, before fps_mc_Interpolate().
+ */
+void fps_mc_Estimate(fps_mc_t *, const picture_t *prev, const picture_t *cur);
+
+/**
+ * Renders an intermediate picture.
+ *
+ * \param phase temporal position of the output from prev (0) to cur (256)
+ */
+void fps_mc_Interpolate(fps_mc_t *, picture_t *dst, const picture_t *prev,
+                        const picture_t *cur, unsigned phase);
+
+#endif
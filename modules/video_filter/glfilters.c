@@ -0,0 +1,685 @@
+/*****************************************************************************
+ * glfilters.c: OpenGL versions of common video filters
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/**
+ * These are shader implementations of the adjust, croppadd, gradfun, invert,
+ * sepia and sharpen video filters. They use the options of the CPU filters,
+ * which must therefore be available.
+ *
+ * Each one is exposed as an OpenGL filter named after the CPU filter with a
+ * "gl" prefix:
+ *
+ *     ./vlc file.mkv --video-filter='opengl{filter="gladjust:glsharpen"}'
+ *
+ * and as a video filter with the same name as the CPU filter, which takes
+ * precedence over the CPU filter when the input pictures are hardware
+ * surfaces, so that they are filtered without being copied to system memory
+ * first (this helps the most when the OpenGL offscreen output is itself a
+ * hardware surface):
+ *
+ *     ./vlc file.mkv --dec-dev=vaapi --video-filter=adjust --contrast=1.5
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+#include <vlc_plugin.h>
+#include <vlc_modules.h>
+#include <vlc_opengl.h>
+#include <vlc_filter.h>
+
+#include "video_output/opengl/filter.h"
+#include "video_output/opengl/gl_api.h"
+#include "video_output/opengl/gl_common.h"
+#include "video_output/opengl/gl_util.h"
+#include "video_output/opengl/sampler.h"
+
+/* Output area, in pixels */
+struct geometry {
+    unsigned width, height;
+    /* Cropped input borders, and padded output borders */
+    unsigned crop_top, crop_left, crop_bottom, crop_right;
+    unsigned padd_top, padd_left, padd_bottom, padd_right;
+};
+
+struct glfilter_desc {
+    const char *name; /* of the CPU filter */
+    const char *prefix;
+    const char *const *options;
+
+    /* GLSL code defining "vec4 filter(vec2 coords)", which may use
+     * vlc_texture(), the "params" uniforms and the texel_x/texel_y vectors
+     * (one pixel to the right and up, in texture coordinates) */
+    const char *body;
+
+    /* Computes the shader parameters, read on every picture so that the
+     * options can be changed at run time */
+    void (*get_params)(vlc_object_t *, float params[8]);
+
+    /* Computes the output geometry from the input size (optional) */
+    int (*get_geometry)(vlc_object_t *, unsigned width, unsigned height,
+                        struct geometry *);
+};
+
+struct sys {
+    const struct glfilter_desc *desc;
+    struct vlc_gl_sampler *sampler;
+
+    GLuint program_id;
+
+    GLuint vbo;
+
+    struct {
+        GLint vertex_pos;
+        GLint tex_coords_in;
+        GLint texel_x;
+        GLint texel_y;
+        GLint params;
+    } loc;
+
+    struct geometry geometry;
+    unsigned width_in, height_in;
+    float texel[4];
+};
+
+/*****************************************************************************
+ * Filters
+ *****************************************************************************/
+
+/* Full range BT.601, as the CPU filters work on YUV */
+static const char *const YUV_FUNCTIONS =
+    "vec3 rgb_to_yuv(vec3 rgb) {\n"
+    "  return vec3(dot(rgb, vec3(0.299, 0.587, 0.114)),\n"
+    "              dot(rgb, vec3(-0.168736, -0.331264, 0.5)) + 0.5,\n"
+    "              dot(rgb, vec3(0.5, -0.418688, -0.081312)) + 0.5);\n"
+    "}\n"
+    "vec3 yuv_to_rgb(vec3 yuv) {\n"
+    "  vec2 uv = yuv.yz - 0.5;\n"
+    "  return clamp(vec3(yuv.x + 1.402 * uv.y,\n"
+    "                    yuv.x - 0.344136 * uv.x - 0.714136 * uv.y,\n"
+    "                    yuv.x + 1.772 * uv.x), 0.0, 1.0);\n"
+    "}\n";
+
+static const char *const adjust_options[] = {
+    "contrast", "brightness", "hue", "saturation", "gamma", NULL
+};
+
+static void AdjustParams(vlc_object_t *obj, float params[8])
+{
+    float contrast = var_InheritFloat(obj, "contrast");
+    float brightness = var_InheritFloat(obj, "brightness");
+    float hue = var_InheritFloat(obj, "hue") * (float)(M_PI / 180.);
+
+    /* Same luma function as the CPU filter */
+    params[0] = contrast;
+    params[1] = brightness - 1.f + .5f - contrast / 2.f;
+    params[2] = 1.f / var_InheritFloat(obj, "gamma");
+    params[3] = var_InheritFloat(obj, "saturation");
+    params[4] = cosf(hue);
+    params[5] = sinf(hue);
+}
+
+static const struct glfilter_desc adjust_desc = {
+    .name = "adjust",
+    .prefix = "",
+    .options = adjust_options,
+    .body =
+        "vec4 filter(vec2 coords) {\n"
+        "  vec4 pix = vlc_texture(coords);\n"
+        "  vec3 yuv = rgb_to_yuv(pix.rgb);\n"
+        "  float y = pow(clamp(params[0].x * yuv.x + params[0].y, 0.0, 1.0),\n"
+        "                params[0].z);\n"
+        "  vec2 uv = yuv.yz - 0.5;\n"
+        "  uv = params[0].w * vec2(uv.x * params[1].x + uv.y * params[1].y,\n"
+        "                          uv.y * params[1].x - uv.x * params[1].y);\n"
+        "  return vec4(yuv_to_rgb(vec3(y, uv + 0.5)), pix.a);\n"
+        "}\n",
+    .get_params = AdjustParams,
+};
+
+static const char *const sepia_options[] = { "intensity", NULL };
+
+static void SepiaParams(vlc_object_t *obj, float params[8])
+{
+    params[0] = var_InheritInteger(obj, "sepia-intensity") / 255.f;
+}
+
+static const struct glfilter_desc sepia_desc = {
+    .name = "sepia",
+    .prefix = "sepia-",
+    .options = sepia_options,
+    .body =
+        "vec4 filter(vec2 coords) {\n"
+        "  vec4 pix = vlc_texture(coords);\n"
+        "  float i = params[0].x;\n"
+        "  float y = rgb_to_yuv(pix.rgb).x * 0.75 + i / 4.0;\n"
+        "  return vec4(yuv_to_rgb(vec3(y, 0.5 - i / 6.0, 0.5 + i / 14.0)),\n"
+        "              pix.a);\n"
+        "}\n",
+    .get_params = SepiaParams,
+};
+
+static const char *const no_options[] = { NULL };
+
+/* Inverting Y, U and V is inverting R, G and B */
+static const struct glfilter_desc invert_desc = {
+    .name = "invert",
+    .prefix = "",
+    .options = no_options,
+    .body =
+        "vec4 filter(vec2 coords) {\n"
+        "  vec4 pix = vlc_texture(coords);\n"
+        "  return vec4(1.0 - pix.rgb, pix.a);\n"
+        "}\n",
+};
+
+static const char *const sharpen_options[] = { "sigma", NULL };
+
+static void SharpenParams(vlc_object_t *obj, float params[8])
+{
+    params[0] = var_InheritFloat(obj, "sharpen-sigma");
+}
+
+/* The luma difference is added to all the components, which only changes
+ * the luma */
+static const struct glfilter_desc sharpen_desc = {
+    .name = "sharpen",
+    .prefix = "sharpen-",
+    .options = sharpen_options,
+    .body =
+        "float luma(vec2 coords) {\n"
+        "  return dot(vlc_texture(coords).rgb, vec3(0.299, 0.587, 0.114));\n"
+        "}\n"
+        "vec4 filter(vec2 coords) {\n"
+        "  vec4 pix = vlc_texture(coords);\n"
+        "  float sum = luma(coords - texel_x - texel_y)\n"
+        "            + luma(coords - texel_y)\n"
+        "            + luma(coords + texel_x - texel_y)\n"
+        "            + luma(coords - texel_x)\n"
+        "            + luma(coords + texel_x)\n"
+        "            + luma(coords - texel_x + texel_y)\n"
+        "            + luma(coords + texel_y)\n"
+        "            + luma(coords + texel_x + texel_y);\n"
+        "  float y = dot(pix.rgb, vec3(0.299, 0.587, 0.114));\n"
+        "  float d = clamp(8.0 * y - sum, -1.0, 1.0) * params[0].x;\n"
+        "  return vec4(clamp(pix.rgb + d, 0.0, 1.0), pix.a);\n"
+        "}\n",
+    .get_params = SharpenParams,
+};
+
+static const char *const gradfun_options[] = { "radius", "strength", NULL };
+
+static void GradfunParams(vlc_object_t *obj, float params[8])
+{
+    int64_t radius = var_InheritInteger(obj, "gradfun-radius");
+    float strength = var_InheritFloat(obj, "gradfun-strength");
+
+    params[0] = VLC_CLIP(radius, 4, 32);
+    params[1] = 255.f / (2.f * VLC_CLIP(strength, .51f, 255.f));
+}
+
+/* The blur is sampled on a 4x4 grid over the (2 * radius) wide window of the
+ * CPU filter, and the correction uses the same threshold function. As the
+ * correction is mostly smaller than one 8-bit step, the output is dithered
+ * (with interleaved gradient noise instead of the CPU filter matrix). */
+static const struct glfilter_desc gradfun_desc = {
+    .name = "gradfun",
+    .prefix = "gradfun-",
+    .options = gradfun_options,
+    .body =
+        "vec4 filter(vec2 coords) {\n"
+        "  vec4 pix = vlc_texture(coords);\n"
+        "  vec3 avg = vec3(0.0);\n"
+        "  for (int i = 0; i < 4; i++)\n"
+        "    for (int j = 0; j < 4; j++) {\n"
+        "      vec2 o = (vec2(float(i), float(j)) - 1.5) * 0.5 * params[0].x;\n"
+        "      avg += vlc_texture(coords + o.x * texel_x + o.y * texel_y).rgb;\n"
+        "    }\n"
+        "  vec3 delta = avg / 16.0 - pix.rgb;\n"
+        "  vec3 w = clamp(1.0 - abs(delta) * params[0].y, 0.0, 1.0);\n"
+        "  float dither = fract(52.9829189 * fract(dot(gl_FragCoord.xy,\n"
+        "                       vec2(0.06711056, 0.00583715)))) - 0.5;\n"
+        "  return vec4(clamp(pix.rgb + delta * w * w + dither / 255.0,\n"
+        "                    0.0, 1.0), pix.a);\n"
+        "}\n",
+    .get_params = GradfunParams,
+};
+
+static const char *const croppadd_options[] = {
+    "croptop", "cropbottom", "cropleft", "cropright",
+    "paddtop", "paddbottom", "paddleft", "paddright", NULL
+};
+
+static int CroppaddGeometry(vlc_object_t *obj, unsigned width,
+                            unsigned height, struct geometry *g)
+{
+    unsigned croptop, cropbottom, cropleft, cropright;
+    unsigned paddtop, paddbottom, paddleft, paddright;
+#define GET(name) \
+    name = __MIN(var_InheritInteger(obj, "croppadd-" #name), 0x10000)
+    GET(croptop); GET(cropbottom); GET(cropleft); GET(cropright);
+    GET(paddtop); GET(paddbottom); GET(paddleft); GET(paddright);
+#undef GET
+
+    if (croptop + cropbottom >= height || cropleft + cropright >= width)
+    {
+        msg_Err(obj, "Cropping the whole picture");
+        return VLC_EGENERIC;
+    }
+
+    g->crop_top = croptop;
+    g->crop_left = cropleft;
+    g->crop_bottom = cropbottom;
+    g->crop_right = cropright;
+    g->padd_top = paddtop;
+    g->padd_left = paddleft;
+    g->padd_bottom = paddbottom;
+    g->padd_right = paddright;
+    g->width = width - cropleft - cropright + paddleft + paddright;
+    g->height = height - croptop - cropbottom + paddtop + paddbottom;
+    return VLC_SUCCESS;
+}
+
+static const struct glfilter_desc croppadd_desc = {
+    .name = "croppadd",
+    .prefix = "croppadd-",
+    .options = croppadd_options,
+    .body =
+        "vec4 filter(vec2 coords) {\n"
+        "  return vlc_texture(coords);\n"
+        "}\n",
+    .get_geometry = CroppaddGeometry,
+};
+
+/*****************************************************************************
+ * OpenGL filter
+ *****************************************************************************/
+
+static void
+UpdateVertices(struct vlc_gl_filter *filter, const struct vlc_gl_picture *pic)
+{
+    struct sys *sys = filter->sys;
+    const struct geometry *g = &sys->geometry;
+    const opengl_vtable_t *vt = &filter->api->vt;
+
+    /* Drawn area, in normalized device coordinates */
+    float x0 = 2.f * g->padd_left / g->width - 1.f;
+    float x1 = 1.f - 2.f * g->padd_right / g->width;
+    float y0 = 1.f - 2.f * g->padd_top / g->height;
+    float y1 = 2.f * g->padd_bottom / g->height - 1.f;
+
+    /* Visible input area, in picture coordinates (origin at bottom-left) */
+    float left = (float) g->crop_left / sys->width_in;
+    float right = 1.f - (float) g->crop_right / sys->width_in;
+    float top = 1.f - (float) g->crop_top / sys->height_in;
+    float bottom = (float) g->crop_bottom / sys->height_in;
+
+    float coords[] = {
+        left,  top,
+        left,  bottom,
+        right, top,
+        right, bottom,
+    };
+
+    /* Transform coordinates in place */
+    vlc_gl_picture_ToTexCoords(pic, 4, coords, coords);
+
+    const float data[] = {
+        x0, y0, coords[0], coords[1],
+        x0, y1, coords[2], coords[3],
+        x1, y0, coords[4], coords[5],
+        x1, y1, coords[6], coords[7],
+    };
+    vt->BindBuffer(GL_ARRAY_BUFFER, sys->vbo);
+    vt->BufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
+
+    /* One pixel to the right and up, in texture coordinates, taking any
+     * orientation into account (see glblend) */
+    float direction[2*2];
+    vlc_gl_picture_ComputeDirectionMatrix(pic, direction);
+
+    const struct vlc_gl_format *glfmt = &sys->sampler->glfmt;
+    GLsizei width = glfmt->tex_widths[0];
+    GLsizei height = glfmt->tex_heights[0];
+    sys->texel[0] = direction[0] / width;
+    sys->texel[1] = direction[1] / height;
+    sys->texel[2] = direction[2] / width;
+    sys->texel[3] = direction[3] / height;
+}
+
+static int
+Draw(struct vlc_gl_filter *filter, const struct vlc_gl_picture *pic,
+     const struct vlc_gl_input_meta *meta)
+{
+    (void) meta;
+
+    struct sys *sys = filter->sys;
+
+    const opengl_vtable_t *vt = &filter->api->vt;
+
+    vt->UseProgram(sys->program_id);
+
+    struct vlc_gl_sampler *sampler = sys->sampler;
+    vlc_gl_sampler_Update(sampler, pic);
+    vlc_gl_sampler_Load(sampler);
+
+    if (pic->mtx_has_changed)
+        UpdateVertices(filter, pic);
+    else
+        vt->BindBuffer(GL_ARRAY_BUFFER, sys->vbo);
+
+    const GLsizei stride = 4 * sizeof(float);
+
+    vt->EnableVertexAttribArray(sys->loc.vertex_pos);
+    vt->VertexAttribPointer(sys->loc.vertex_pos, 2, GL_FLOAT, GL_FALSE, stride,
+                            (const void *) 0);
+
+    intptr_t offset = 2 * sizeof(float);
+    vt->EnableVertexAttribArray(sys->loc.tex_coords_in);
+    vt->VertexAttribPointer(sys->loc.tex_coords_in, 2, GL_FLOAT, GL_FALSE,
+                            stride, (const void *) offset);
+
+    if (sys->loc.texel_x != -1)
+        vt->Uniform2f(sys->loc.texel_x, sys->texel[0], sys->texel[1]);
+    if (sys->loc.texel_y != -1)
+        vt->Uniform2f(sys->loc.texel_y, sys->texel[2], sys->texel[3]);
+
+    if (sys->desc->get_params != NULL && sys->loc.params != -1)
+    {
+        float params[8] = { 0 };
+
+        sys->desc->get_params(VLC_OBJECT(filter), params);
+        vt->Uniform4fv(sys->loc.params, 2, params);
+    }
+
+    /* The padded borders are black */
+    vt->ClearColor(0.f, 0.f, 0.f, 1.f);
+    vt->Clear(GL_COLOR_BUFFER_BIT);
+    vt->DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    return VLC_SUCCESS;
+}
+
+static void
+Close(struct vlc_gl_filter *filter)
+{
+    struct sys *sys = filter->sys;
+
+    vlc_gl_sampler_Delete(sys->sampler);
+
+    const opengl_vtable_t *vt = &filter->api->vt;
+    vt->DeleteProgram(sys->program_id);
+    vt->DeleteBuffers(1, &sys->vbo);
+
+    free(sys);
+}
+
+static int
+Open(struct vlc_gl_filter *filter, const config_chain_t *config,
+     const struct vlc_gl_format *glfmt, struct vlc_gl_tex_size *size_out,
+     const struct glfilter_desc *desc)
+{
+    static const struct vlc_gl_filter_ops ops = {
+        .draw = Draw,
+        .close = Close,
+    };
+
+    /* Without configuration, the options are inherited from the video filter
+     * (or its parents), and may change at run time. */
+    if (config != NULL)
+        config_ChainParse(filter, desc->prefix, desc->options, config);
+
+    struct sys *sys = filter->sys = malloc(sizeof(*sys));
+    if (!sys)
+        return VLC_EGENERIC;
+
+    sys->desc = desc;
+    sys->width_in = size_out->width;
+    sys->height_in = size_out->height;
+    sys->geometry = (struct geometry) {
+        .width = size_out->width,
+        .height = size_out->height,
+    };
+
+    if (desc->get_geometry != NULL)
+    {
+        if (desc->get_geometry(VLC_OBJECT(filter), size_out->width,
+                               size_out->height, &sys->geometry))
+            goto error;
+        size_out->width = sys->geometry.width;
+        size_out->height = sys->geometry.height;
+    }
+
+    struct vlc_gl_sampler *sampler =
+        vlc_gl_sampler_New(filter->gl, filter->api, glfmt, false);
+    if (!sampler)
+        goto error;
+
+    sys->sampler = sampler;
+
+    static const char *const VERTEX_SHADER =
+        "attribute vec2 vertex_pos;\n"
+        "attribute vec2 tex_coords_in;\n"
+        "varying vec2 tex_coords;\n"
+        "void main() {\n"
+        "  gl_Position = vec4(vertex_pos, 0.0, 1.0);\n"
+        "  tex_coords = tex_coords_in;\n"
+        "}\n";
+
+    static const char *const FRAGMENT_HEADER =
+        "uniform vec2 texel_x;\n"
+        "uniform vec2 texel_y;\n"
+        "uniform vec4 params[2];\n";
+
+    static const char *const FRAGMENT_MAIN =
+        "varying vec2 tex_coords;\n"
+        "void main() {\n"
+        "  gl_FragColor = filter(tex_coords);\n"
+        "}\n";
+
+    const char *shader_version;
+    const char *shader_precision;
+    if (filter->api->is_gles)
+    {
+        shader_version = "#version 100\n";
+        shader_precision = "precision highp float;\n";
+    }
+    else
+    {
+        shader_version = "#version 120\n";
+        shader_precision = "";
+    }
+
+    const char *extensions = sampler->shader.extensions
+                           ? sampler->shader.extensions : "";
+
+    const opengl_vtable_t *vt = &filter->api->vt;
+
+    const char *vertex_shader[] = { shader_version, VERTEX_SHADER };
+    const char *fragment_shader[] = {
+        shader_version,
+        extensions,
+        shader_precision,
+        sampler->shader.body,
+        FRAGMENT_HEADER,
+        YUV_FUNCTIONS,
+        desc->body,
+        FRAGMENT_MAIN,
+    };
+
+    GLuint program_id =
+        vlc_gl_BuildProgram(VLC_OBJECT(filter), vt,
+                            ARRAY_SIZE(vertex_shader), vertex_shader,
+                            ARRAY_SIZE(fragment_shader), fragment_shader);
+    if (!program_id)
+    {
+        vlc_gl_sampler_Delete(sampler);
+        goto error;
+    }
+
+    vlc_gl_sampler_FetchLocations(sampler, program_id);
+
+    sys->program_id = program_id;
+
+    sys->loc.vertex_pos = vt->GetAttribLocation(program_id, "vertex_pos");
+    assert(sys->loc.vertex_pos != -1);
+
+    sys->loc.tex_coords_in = vt->GetAttribLocation(program_id, "tex_coords_in");
+    assert(sys->loc.tex_coords_in != -1);
+
+    /* These may be optimized out, depending on the filter */
+    sys->loc.texel_x = vt->GetUniformLocation(program_id, "texel_x");
+    sys->loc.texel_y = vt->GetUniformLocation(program_id, "texel_y");
+    sys->loc.params = vt->GetUniformLocation(program_id, "params");
+
+    vt->GenBuffers(1, &sys->vbo);
+
+    filter->ops = &ops;
+    return VLC_SUCCESS;
+
+error:
+    free(sys);
+    return VLC_EGENERIC;
+}
+
+/*****************************************************************************
+ * Video filter
+ *****************************************************************************/
+
+static int OpenVideoFilter(filter_t *filter, const struct glfilter_desc *desc)
+{
+    const video_format_t *fmt = &filter->fmt_in.video;
+    const vlc_chroma_description_t *chroma =
+        vlc_fourcc_GetChromaDescription(fmt->i_chroma);
+
+    /* Software pictures are better handled by the CPU filters, which do not
+     * change the output chroma */
+    if (chroma == NULL || chroma->plane_count != 0)
+        return VLC_EGENERIC;
+
+    if (!filter->b_allow_fmt_out_change)
+    {
+        msg_Dbg(filter, "Format change is not allowed");
+        return VLC_EGENERIC;
+    }
+
+    /* Create the options as commands, so that the changes are forwarded to
+     * this filter, and inherited by the OpenGL filter. */
+    config_ChainParse(filter, desc->prefix, desc->options, filter->p_cfg);
+    for (const char *const *option = desc->options; *option != NULL; option++)
+    {
+        char name[32];
+
+        snprintf(name, sizeof (name), "%s%s", desc->prefix, *option);
+        int type = config_GetType(name);
+        if (type != 0)
+            var_Create(filter, name, type | VLC_VAR_DOINHERIT
+                                     | VLC_VAR_ISCOMMAND);
+    }
+
+    if (desc->get_geometry != NULL)
+    {
+        struct geometry g;
+
+        /* The OpenGL filters work on pictures in display orientation */
+        if (fmt->orientation != ORIENT_NORMAL)
+            return VLC_EGENERIC;
+
+        if (desc->get_geometry(VLC_OBJECT(filter), fmt->i_visible_width,
+                               fmt->i_visible_height, &g))
+            return VLC_EGENERIC;
+
+        video_format_t *fmt_out = &filter->fmt_out.video;
+        fmt_out->i_x_offset = fmt_out->i_y_offset = 0;
+        fmt_out->i_width = fmt_out->i_visible_width = g.width;
+        fmt_out->i_height = fmt_out->i_visible_height = g.height;
+    }
+
+    char gl_name[32];
+    snprintf(gl_name, sizeof (gl_name), "gl%s", desc->name);
+
+    module_t *module = vlc_gl_WrapOpenGLFilter(filter, gl_name);
+    if (module == NULL)
+        return VLC_EGENERIC;
+
+    msg_Dbg(filter, "filtering %4.4s pictures with OpenGL",
+            (const char *) &fmt->i_chroma);
+    return VLC_SUCCESS;
+}
+
+#define GLFILTER_CALLBACKS(name) \
+static int Open_##name(struct vlc_gl_filter *filter, \
+                       const config_chain_t *config, \
+                       const struct vlc_gl_format *glfmt, \
+                       struct vlc_gl_tex_size *size_out) \
+{ \
+    return Open(filter, config, glfmt, size_out, &name##_desc); \
+} \
+static int OpenVideoFilter_##name(filter_t *filter) \
+{ \
+    return OpenVideoFilter(filter, &name##_desc); \
+}
+
+GLFILTER_CALLBACKS(adjust)
+GLFILTER_CALLBACKS(croppadd)
+GLFILTER_CALLBACKS(gradfun)
+GLFILTER_CALLBACKS(invert)
+GLFILTER_CALLBACKS(sepia)
+GLFILTER_CALLBACKS(sharpen)
+
+/* Above the CPU filters, which they defer to for software pictures */
+#define add_glfilter(name, text) \
+    add_submodule() \
+        set_description(text) \
+        set_capability("video filter", 10) \
+        set_callback(OpenVideoFilter_##name) \
+        add_shortcut(#name) \
+    add_submodule() \
+        set_description(text) \
+        set_capability("opengl filter", 0) \
+        set_callback_opengl_filter(Open_##name) \
+        add_shortcut("gl" #name)
+
+vlc_module_begin()
+    set_shortname(N_("OpenGL filters"))
+    set_description(N_("OpenGL image properties filter"))
+    set_subcategory(SUBCAT_VIDEO_VFILTER)
+    set_capability("opengl filter", 0)
+    set_callback_opengl_filter(Open_adjust)
+    add_shortcut("gladjust")
+
+    add_submodule()
+        set_description(N_("OpenGL image properties filter"))
+        set_capability("video filter", 10)
+        set_callback(OpenVideoFilter_adjust)
+        add_shortcut("adjust")
+
+    add_glfilter(croppadd, N_("OpenGL video cropping and padding filter"))
+    add_glfilter(gradfun, N_("OpenGL gradfun filter"))
+    add_glfilter(invert, N_("OpenGL invert video filter"))
+    add_glfilter(sepia, N_("OpenGL sepia video filter"))
+    add_glfilter(sharpen, N_("OpenGL sharpen video filter"))
+vlc_module_end()
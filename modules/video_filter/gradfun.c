@@ -36,6 +36,8 @@
 #include <vlc_filter.h>
 #include <vlc_picture.h>
 
+#include "../video_chroma/slices.h"
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -70,6 +72,7 @@ vlc_module_end()
  * Local prototypes
  *****************************************************************************/
 #define FFMAX(a,b) __MAX(a,b)
+#define FFMIN(a,b) __MIN(a,b)
 #ifdef CAN_COMPILE_SSE2
 #   define HAVE_SSE2 1
 #else
@@ -88,6 +91,12 @@ vlc_module_end()
 #endif
 #define av_clip_uint8 clip_uint8_vlc
 #include <stdalign.h>
+#ifdef HAVE_AVX2_INTRINSICS
+#   include <immintrin.h>
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+#   include <arm_neon.h>
+#endif
 #include "gradfun.h"
 
 static int Callback(vlc_object_t *, char const *, vlc_value_t, vlc_value_t, void *);
@@ -100,8 +109,15 @@ typedef struct
     int              radius;
     const vlc_chroma_description_t *chroma;
     struct vf_priv_s cfg;
+    vlc_slices_t     *slices;
+    unsigned         buf_count; /* one blur buffer per band */
+    size_t           buf_size;
 } filter_sys_t;
 
+/* Minimum height of a band: each one first reads the r pairs of lines
+ * above it */
+#define MIN_SLICE_LINES (8 * RADIUS_MAX)
+
 static int Open(filter_t *filter)
 {
     const vlc_fourcc_t fourcc = filter->fmt_in.video.i_chroma;
@@ -128,17 +144,39 @@ static int Open(filter_t *filter)
     cfg->thresh      = 0.0;
     cfg->radius      = 0;
     cfg->buf         = NULL;
+    sys->slices      = vlc_slices_New(0);
+    sys->buf_count   = 0;
 
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        cfg->blur_line = blur_line_avx2;
+    else
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        cfg->blur_line = blur_line_neon;
+    else
+#endif
 #if HAVE_SSE2 && HAVE_6REGS
     if (vlc_CPU_SSE2())
         cfg->blur_line = blur_line_sse2;
     else
 #endif
         cfg->blur_line   = blur_line_c;
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        cfg->filter_line = filter_line_avx2;
+    else
+#endif
 #if HAVE_SSSE3
     if (vlc_CPU_SSSE3())
         cfg->filter_line = filter_line_ssse3;
     else
+#endif
+#if defined (__aarch64__) && defined (__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        cfg->filter_line = filter_line_neon;
+    else
 #endif
         cfg->filter_line = filter_line_c;
 
@@ -154,9 +192,51 @@ static void Close(filter_t *filter)
     var_DelCallback(filter, CFG_PREFIX "radius",   Callback, NULL);
     var_DelCallback(filter, CFG_PREFIX "strength", Callback, NULL);
     aligned_free(sys->cfg.buf);
+    if (sys->slices)
+        vlc_slices_Delete(sys->slices);
     free(sys);
 }
 
+struct gradfun_job
+{
+    filter_sys_t *sys;
+    const video_format_t *fmt;
+    picture_t *src, *dst;
+};
+
+static void FilterSlice(void *opaque, unsigned index, unsigned count)
+{
+    const struct gradfun_job *job = opaque;
+    filter_sys_t *sys = job->sys;
+    struct vf_priv_s *cfg = &sys->cfg;
+    uint16_t *buffer = cfg->buf + index * sys->buf_size;
+
+    for (int i = 0; i < job->dst->i_planes; i++) {
+        const plane_t *srcp = &job->src->p[i];
+        plane_t       *dstp = &job->dst->p[i];
+
+        const vlc_chroma_description_t *chroma = sys->chroma;
+        int w = job->fmt->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
+        int h = job->fmt->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
+        int r = (cfg->radius  * chroma->p[i].w.num / chroma->p[i].w.den +
+                 cfg->radius  * chroma->p[i].h.num / chroma->p[i].h.den) / 2;
+        r = VLC_CLIP((r + 1) & ~1, RADIUS_MIN, RADIUS_MAX);
+
+        /* Pairs of lines, as the window moves two lines at a time */
+        unsigned start, end;
+        vlc_slice_Lines(h, 2, index, count, &start, &end);
+
+        if (__MIN(w, h) > 2 * r) {
+            if (start < end)
+                filter_plane(cfg, buffer, dstp->p_pixels, srcp->p_pixels,
+                             w, h, dstp->i_pitch, srcp->i_pitch, r,
+                             start, end);
+        } else if (index == 0) {
+            plane_CopyPixels(dstp, srcp);
+        }
+    }
+}
+
 static void Filter(filter_t *filter, picture_t *src, picture_t *dst)
 {
     filter_sys_t *sys = filter->p_sys;
@@ -168,31 +248,31 @@ static void Filter(filter_t *filter, picture_t *src, picture_t *dst)
 
     const video_format_t *fmt = &filter->fmt_in.video;
     struct vf_priv_s *cfg = &sys->cfg;
+    unsigned count = vlc_slices_Count(sys->slices, fmt->i_height,
+                                      MIN_SLICE_LINES);
 
     cfg->thresh = (1 << 15) / strength;
-    if (cfg->radius != radius) {
+    if (cfg->radius != radius || sys->buf_count < count) {
+        sys->buf_size = ((fmt->i_width + 15) & ~15) * (radius + 1) / 2 + 32;
+        aligned_free(cfg->buf);
         cfg->radius = radius;
-        cfg->buf    = aligned_alloc(16,
-                                   (((fmt->i_width + 15) & ~15) * (cfg->radius + 1) / 2 + 32) * sizeof(*cfg->buf));
+        cfg->buf    = aligned_alloc(16, count * sys->buf_size * sizeof(*cfg->buf));
+        sys->buf_count = cfg->buf ? count : 0;
     }
 
-    for (int i = 0; i < dst->i_planes; i++) {
-        const plane_t *srcp = &src->p[i];
-        plane_t       *dstp = &dst->p[i];
-
-        const vlc_chroma_description_t *chroma = sys->chroma;
-        int w = fmt->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
-        int h = fmt->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
-        int r = (cfg->radius  * chroma->p[i].w.num / chroma->p[i].w.den +
-                 cfg->radius  * chroma->p[i].h.num / chroma->p[i].h.den) / 2;
-        r = VLC_CLIP((r + 1) & ~1, RADIUS_MIN, RADIUS_MAX);
-        if (__MIN(w, h) > 2 * r && cfg->buf) {
-            filter_plane(cfg, dstp->p_pixels, srcp->p_pixels,
-                         w, h, dstp->i_pitch, srcp->i_pitch, r);
-        } else {
-            plane_CopyPixels(dstp, srcp);
-        }
+    if (!cfg->buf) {
+        for (int i = 0; i < dst->i_planes; i++)
+            plane_CopyPixels(&dst->p[i], &src->p[i]);
+        return;
     }
+
+    struct gradfun_job job = {
+        .sys = sys,
+        .fmt = fmt,
+        .src = src,
+        .dst = dst,
+    };
+    vlc_slices_Run(sys->slices, count, FilterSlice, &job);
 }
 
 static int Callback(vlc_object_t *object, char const *cmd,
@@ -172,45 +172,195 @@ static void blur_line_sse2(uint16_t *dc, uint16_t *buf, uint16_t *buf1,
 }
 #endif // HAVE_6REGS && HAVE_SSE2
 
-static void filter_plane(struct vf_priv_s *ctx, uint8_t *dst, uint8_t *src,
-                         int width, int height, int dstride, int sstride, int r)
+#ifdef HAVE_AVX2_INTRINSICS
+/* Same as filter_line_ssse3(), 16 pixels at a time */
+__attribute__ ((__target__ ("avx2")))
+static void filter_line_avx2(uint8_t *dst, uint8_t *src, uint16_t *dc,
+                             int width, int thresh, const uint16_t *dithers)
+{
+    const __m256i t = _mm256_set1_epi16(thresh);
+    const __m256i d = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)dithers));
+    const __m256i m7f = _mm256_set1_epi16(127);
+    int x;
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        __m256i pix = _mm256_slli_epi16(_mm256_cvtepu8_epi16(
+            _mm_loadu_si128((const __m128i *)&src[x])), 7);
+        __m256i dcv = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128((const __m128i *)&dc[x/2]));
+        dcv = _mm256_or_si256(dcv, _mm256_slli_epi32(dcv, 16));
+
+        __m256i delta = _mm256_sub_epi16(dcv, pix); // delta = dc - pix
+        __m256i m = _mm256_mulhi_epu16(_mm256_abs_epi16(delta), t);
+        m = _mm256_min_epi16(_mm256_sub_epi16(m, m7f), _mm256_setzero_si256());
+        m = _mm256_slli_epi16(_mm256_mullo_epi16(m, m), 1);
+        pix = _mm256_add_epi16(pix, d);
+        pix = _mm256_add_epi16(pix, _mm256_mulhrs_epi16(delta, m));
+        pix = _mm256_srai_epi16(pix, 7);
+
+        __m256i out = _mm256_permute4x64_epi64(_mm256_packus_epi16(pix, pix), 0xD8);
+        _mm_storeu_si128((__m128i *)&dst[x], _mm256_castsi256_si128(out));
+    }
+
+    if (x + 8 <= width) {
+        __m128i pix = _mm_slli_epi16(_mm_cvtepu8_epi16(
+            _mm_loadl_epi64((const __m128i *)&src[x])), 7);
+        __m128i dcv = _mm_loadl_epi64((const __m128i *)&dc[x/2]);
+        dcv = _mm_unpacklo_epi16(dcv, dcv);
+
+        __m128i delta = _mm_sub_epi16(dcv, pix);
+        __m128i m = _mm_mulhi_epu16(_mm_abs_epi16(delta),
+                                    _mm256_castsi256_si128(t));
+        m = _mm_min_epi16(_mm_sub_epi16(m, _mm256_castsi256_si128(m7f)),
+                          _mm_setzero_si128());
+        m = _mm_slli_epi16(_mm_mullo_epi16(m, m), 1);
+        pix = _mm_add_epi16(pix, _mm256_castsi256_si128(d));
+        pix = _mm_add_epi16(pix, _mm_mulhrs_epi16(delta, m));
+        pix = _mm_srai_epi16(pix, 7);
+        _mm_storel_epi64((__m128i *)&dst[x], _mm_packus_epi16(pix, pix));
+        x += 8;
+    }
+
+    if (x < width)
+        filter_line_c(dst+x, src+x, dc+x/2, width-x, thresh, dithers);
+}
+
+/* Same as blur_line_c(), 16 pixels at a time */
+__attribute__ ((__target__ ("avx2")))
+static void blur_line_avx2(uint16_t *dc, uint16_t *buf, uint16_t *buf1,
+                           uint8_t *src, int sstride, int width)
+{
+    const __m256i ff = _mm256_set1_epi16(0xff);
+    int x;
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)&src[2*x]);
+        __m256i b = _mm256_loadu_si256((const __m256i *)&src[2*x+sstride]);
+        __m256i v = _mm256_add_epi16(
+            _mm256_add_epi16(_mm256_srli_epi16(a, 8), _mm256_and_si256(a, ff)),
+            _mm256_add_epi16(_mm256_srli_epi16(b, 8), _mm256_and_si256(b, ff)));
+        v = _mm256_add_epi16(v, _mm256_loadu_si256((const __m256i *)&buf1[x]));
+
+        __m256i old = _mm256_loadu_si256((const __m256i *)&buf[x]);
+        _mm256_storeu_si256((__m256i *)&buf[x], v);
+        _mm256_storeu_si256((__m256i *)&dc[x], _mm256_sub_epi16(v, old));
+    }
+
+    if (x < width)
+        blur_line_c(dc+x, buf+x, buf1+x, src+2*x, sstride, width-x);
+}
+#endif // HAVE_AVX2_INTRINSICS
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+/* Same as filter_line_ssse3(), 8 pixels at a time */
+static void filter_line_neon(uint8_t *dst, uint8_t *src, uint16_t *dc,
+                             int width, int thresh, const uint16_t *dithers)
+{
+    const int16x8_t d = vreinterpretq_s16_u16(vld1q_u16(dithers));
+    int x;
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        int16x8_t pix = vreinterpretq_s16_u16(vshll_n_u8(vld1_u8(&src[x]), 7));
+        uint16x4_t dcv = vld1_u16(&dc[x/2]);
+        int16x8_t delta = vsubq_s16(vreinterpretq_s16_u16(
+            vcombine_u16(vzip1_u16(dcv, dcv), vzip2_u16(dcv, dcv))), pix);
+        uint16x8_t ad = vreinterpretq_u16_s16(vabsq_s16(delta));
+        uint16x8_t mu = vcombine_u16(
+            vshrn_n_u32(vmull_u16(vget_low_u16(ad), vdup_n_u16(thresh)), 16),
+            vshrn_n_u32(vmull_high_u16(ad, vdupq_n_u16(thresh)), 16));
+        int16x8_t m = vminq_s16(vsubq_s16(vreinterpretq_s16_u16(mu),
+                                          vdupq_n_s16(127)), vdupq_n_s16(0));
+
+        m = vshlq_n_s16(vmulq_s16(m, m), 1);
+        pix = vaddq_s16(pix, d);
+        pix = vaddq_s16(pix, vqrdmulhq_s16(delta, m));
+        vst1_u8(&dst[x], vqshrun_n_s16(pix, 7));
+    }
+
+    if (x < width)
+        filter_line_c(dst+x, src+x, dc+x/2, width-x, thresh, dithers);
+}
+
+/* Same as blur_line_c(), 8 pixels at a time */
+static void blur_line_neon(uint16_t *dc, uint16_t *buf, uint16_t *buf1,
+                           uint8_t *src, int sstride, int width)
+{
+    int x;
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        uint16x8_t v = vaddq_u16(vpaddlq_u8(vld1q_u8(&src[2*x])),
+                                 vpaddlq_u8(vld1q_u8(&src[2*x+sstride])));
+        v = vaddq_u16(v, vld1q_u16(&buf1[x]));
+
+        uint16x8_t old = vld1q_u16(&buf[x]);
+        vst1q_u16(&buf[x], v);
+        vst1q_u16(&dc[x], vsubq_u16(v, old));
+    }
+
+    if (x < width)
+        blur_line_c(dc+x, buf+x, buf1+x, src+2*x, sstride, width-x);
+}
+#endif // __aarch64__ && __ARM_NEON
+
+/* Adds the lines y+r and y+r+1 to the blur window, and subtracts the lines
+ * that left it, then blurs it horizontally into dc. */
+static void blur_window(const struct vf_priv_s *ctx, uint16_t *dc,
+                        uint16_t *buf, uint8_t *src, int width, int sstride,
+                        int bstride, int r, uint32_t dc_factor, int y)
+{
+    int mod = ((y+r)/2)%r;
+    uint16_t *buf0 = buf+mod*bstride;
+    uint16_t *buf1 = buf+(mod?mod-1:r-1)*bstride;
+    int x, v;
+
+    ctx->blur_line(dc, buf0, buf1, src+(y+r)*sstride, sstride, width/2);
+    for (x=v=0; x<r; x++)
+        v += dc[x];
+    for (; x<width/2; x++) {
+        v += dc[x] - dc[x-r];
+        dc[x-r] = v * dc_factor >> 16;
+    }
+    for (; x<(width+r+1)/2; x++)
+        dc[x-r] = v * dc_factor >> 16;
+    for (x=-r/2; x<0; x++)
+        dc[x] = dc[0];
+}
+
+/* Filters the lines start to end - 1 (start being even). The window only
+ * depends on the r pairs of lines above it, so that a band can start
+ * anywhere with its own buffer. */
+static void filter_plane(const struct vf_priv_s *ctx, uint16_t *buffer,
+                         uint8_t *dst, uint8_t *src, int width, int height,
+                         int dstride, int sstride, int r, int start, int end)
 {
     int bstride = ((width+15)&~15)/2;
-    int y;
     uint32_t dc_factor = (1<<21)/(r*r);
-    uint16_t *dc = ctx->buf+16;
-    uint16_t *buf = ctx->buf+bstride+32;
+    uint16_t *dc = buffer+16;
+    uint16_t *buf = buffer+bstride+32;
     int thresh = ctx->thresh;
+    /* Last line where the window moves: the lines above the first window and
+     * below the last one are filtered with these windows. */
+    const int last = (height-r-1)&~1;
+    int y = FFMAX(start, r);
+    const int yw = FFMIN(y, last);
+    const int first = (yw+r)/2-r;
 
     memset(dc, 0, (bstride+16)*sizeof(*buf));
-    for (y=0; y<r; y++)
-        ctx->blur_line(dc, buf+y*bstride, buf+(y-1)*bstride, src+2*y*sstride, sstride, width/2);
-    for (;;) {
-        if (y < height-r) {
-            int mod = ((y+r)/2)%r;
-            uint16_t *buf0 = buf+mod*bstride;
-            uint16_t *buf1 = buf+(mod?mod-1:r-1)*bstride;
-            int x, v;
-            ctx->blur_line(dc, buf0, buf1, src+(y+r)*sstride, sstride, width/2);
-            for (x=v=0; x<r; x++)
-                v += dc[x];
-            for (; x<width/2; x++) {
-                v += dc[x] - dc[x-r];
-                dc[x-r] = v * dc_factor >> 16;
-            }
-            for (; x<(width+r+1)/2; x++)
-                dc[x-r] = v * dc_factor >> 16;
-            for (x=-r/2; x<0; x++)
-                dc[x] = dc[0];
-        }
-        if (y == r) {
-            for (y=0; y<r; y++)
-                ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        }
-        ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
+    /* The row before the first one is the zeroed dc */
+    for (int p = first; p < first+r; p++)
+        ctx->blur_line(dc, buf+(p%r)*bstride,
+                       p > first ? buf+((p-1)%r)*bstride : buf-bstride,
+                       src+2*p*sstride, sstride, width/2);
+    blur_window(ctx, dc, buf, src, width, sstride, bstride, r, dc_factor, yw);
+
+    for (int i = start; i < FFMIN(r, end); i++)
+        ctx->filter_line(dst+i*dstride, src+i*sstride, dc-r/2, width, thresh, dither[i&7]);
+    for (; y < end; y += 2) {
+        if (y > yw && y <= last)
+            blur_window(ctx, dc, buf, src, width, sstride, bstride, r,
+                        dc_factor, y);
         ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
+        if (y+1 < end)
+            ctx->filter_line(dst+(y+1)*dstride, src+(y+1)*sstride, dc-r/2, width, thresh, dither[(y+1)&7]);
     }
 }
-
@@ -30,10 +30,11 @@
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
+#include <vlc_cpu.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
 #include "filter_picture.h"
-
+#include "../video_chroma/slices.h"
 
 #include "hqdn3d.h"
 
@@ -90,11 +91,23 @@ typedef struct
     int w[3], h[3];
 
     struct vf_priv_s cfg;
+    vlc_slices_t *slices;
+    unsigned int *horiz; /* horizontally filtered plane, when sliced */
+    void (*vertical_line)(const unsigned int *, unsigned int *,
+                          unsigned short *, unsigned char *, int,
+                          int *, int *);
+    void (*temporal)(unsigned char *, unsigned char *, unsigned short *,
+                     int, int, int, int, int *);
     bool   b_recalc_coefs;
     vlc_mutex_t coefs_mutex;
     float  luma_spat, luma_temp, chroma_spat, chroma_temp;
 } filter_sys_t;
 
+/* Minimum height of a band, and alignment of the width of a column strip
+ * (a cache line of the output) */
+#define MIN_SLICE_LINES 64
+#define SLICE_COLUMNS   64
+
 /*****************************************************************************
  * Open
  *****************************************************************************/
@@ -140,6 +153,28 @@ static int Open(filter_t *filter)
         return VLC_ENOMEM;
     }
 
+    sys->slices = vlc_slices_New(0);
+    if (vlc_slices_Count(sys->slices, sys->h[0], MIN_SLICE_LINES) > 1) {
+        sys->horiz = vlc_alloc(sys->w[0] * sys->h[0], sizeof (*sys->horiz));
+        if (!sys->horiz) {
+            vlc_slices_Delete(sys->slices);
+            free(cfg->Line);
+            free(sys);
+            return VLC_ENOMEM;
+        }
+    }
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2()) {
+        sys->vertical_line = deNoiseVerticalLine_avx2;
+        sys->temporal = deNoiseTemporal_avx2;
+    } else
+#endif
+    {
+        sys->vertical_line = deNoiseVerticalLine;
+        sys->temporal = deNoiseTemporal;
+    }
+
     config_ChainParse(filter, FILTER_PREFIX, filter_options,
                       filter->p_cfg);
 
@@ -184,12 +219,126 @@ static void Close(filter_t *filter)
         free(cfg->Frame[i]);
     }
     free(cfg->Line);
+    free(sys->horiz);
+    if (sys->slices)
+        vlc_slices_Delete(sys->slices);
     free(sys);
 }
 
 /*****************************************************************************
  * Filter
  *****************************************************************************/
+
+struct denoise_job
+{
+    filter_sys_t *sys;
+    const plane_t *src;
+    plane_t *dst;
+    unsigned short *frame_ant;
+    int w, h;
+    int *horizontal, *vertical, *temporal;
+};
+
+/* Temporal low-pass only, on a band of lines */
+static void TemporalSlice(void *opaque, unsigned index, unsigned count)
+{
+    const struct denoise_job *job = opaque;
+    unsigned start, end;
+
+    vlc_slice_Lines(job->h, 1, index, count, &start, &end);
+    job->sys->temporal(&job->src->p_pixels[start * job->src->i_pitch],
+                       &job->dst->p_pixels[start * job->dst->i_pitch],
+                       &job->frame_ant[start * job->w],
+                       job->w, end - start,
+                       job->src->i_pitch, job->dst->i_pitch, job->temporal);
+}
+
+/* Horizontal low-pass, on a band of lines */
+static void HorizontalSlice(void *opaque, unsigned index, unsigned count)
+{
+    const struct denoise_job *job = opaque;
+    unsigned start, end;
+
+    vlc_slice_Lines(job->h, 1, index, count, &start, &end);
+    deNoiseHorizontal(&job->src->p_pixels[start * job->src->i_pitch],
+                      &job->sys->horiz[start * job->w],
+                      job->w, end - start, job->src->i_pitch,
+                      job->horizontal, start == 0 && !job->temporal[0]);
+}
+
+/* Vertical and temporal low-pass, on a strip of columns */
+static void VerticalSlice(void *opaque, unsigned index, unsigned count)
+{
+    const struct denoise_job *job = opaque;
+    filter_sys_t *sys = job->sys;
+    unsigned start, end;
+
+    vlc_slice_Lines(job->w, SLICE_COLUMNS, index, count, &start, &end);
+
+    /* No temporal filter at all in the spatial-only mode */
+    int *temporal = job->temporal[0] ? job->temporal : NULL;
+    const unsigned int *horiz = &sys->horiz[start];
+    unsigned int *line = &sys->cfg.Line[start];
+    unsigned short *frame_ant = &job->frame_ant[start];
+    unsigned char *dst = &job->dst->p_pixels[start];
+
+    for (int y = 0; y < job->h; y++) {
+        sys->vertical_line(horiz, line, frame_ant, dst, end - start,
+                           y > 0 ? job->vertical : NULL, temporal);
+        horiz += job->w;
+        frame_ant += job->w;
+        dst += job->dst->i_pitch;
+    }
+}
+
+static void DenoisePlane(filter_sys_t *sys, const plane_t *src, plane_t *dst,
+                         int i, int *horizontal, int *vertical, int *temporal)
+{
+    struct vf_priv_s *cfg = &sys->cfg;
+    const int w = sys->w[i], h = sys->h[i];
+    unsigned count = vlc_slices_Count(sys->slices, h, MIN_SLICE_LINES);
+
+    /* The spatial filters are recursive: without threads, a single pass
+     * is faster than the split one */
+    const bool spatial = horizontal[0] || vertical[0];
+    if (spatial && (count <= 1 || sys->horiz == NULL)) {
+        deNoise(src->p_pixels, dst->p_pixels, cfg->Line, &cfg->Frame[i],
+                w, h, src->i_pitch, dst->i_pitch,
+                horizontal, vertical, temporal);
+        return;
+    }
+
+    if (!cfg->Frame[i]) {
+        cfg->Frame[i] = vlc_alloc(w * h, sizeof (unsigned short));
+        if (!cfg->Frame[i])
+            return;
+        for (int y = 0; y < h; y++)
+            for (int x = 0; x < w; x++)
+                cfg->Frame[i][y * w + x] = src->p_pixels[y * src->i_pitch + x] << 8;
+    }
+
+    struct denoise_job job = {
+        .sys = sys,
+        .src = src,
+        .dst = dst,
+        .frame_ant = cfg->Frame[i],
+        .w = w,
+        .h = h,
+        .horizontal = horizontal,
+        .vertical = vertical,
+        .temporal = temporal,
+    };
+
+    if (!spatial) {
+        vlc_slices_Run(sys->slices, count, TemporalSlice, &job);
+        return;
+    }
+
+    /* Each strip keeps its own part of the line and frame histories */
+    vlc_slices_Run(sys->slices, count, HorizontalSlice, &job);
+    count = __MAX(1, __MIN(count, (unsigned)w / SLICE_COLUMNS));
+    vlc_slices_Run(sys->slices, count, VerticalSlice, &job);
+}
 static picture_t *Filter(filter_t *filter, picture_t *src)
 {
     picture_t *dst;
@@ -219,24 +368,12 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
+    DenoisePlane(sys, &src->p[0], &dst->p[0], 0,
+                 cfg->Coefs[0], cfg->Coefs[0], cfg->Coefs[1]);
+    DenoisePlane(sys, &src->p[1], &dst->p[1], 1,
+                 cfg->Coefs[2], cfg->Coefs[2], cfg->Coefs[3]);
+    DenoisePlane(sys, &src->p[2], &dst->p[2], 2,
+                 cfg->Coefs[2], cfg->Coefs[2], cfg->Coefs[3]);
 
     if(unlikely(!cfg->Frame[0] || !cfg->Frame[1] || !cfg->Frame[2]))
     {
@@ -175,6 +175,169 @@ static void deNoise(unsigned char *Frame,        // mpi->planes[x]
 }
 
 
+/***************************************************************************/
+
+/* Split version of deNoiseSpacial() and deNoise(), for parallel processing:
+ * the horizontal low-pass only depends on the current line, and the vertical
+ * and temporal ones only on the current column. Both produce the same
+ * output as the single pass versions. */
+
+/* Horizontal low-pass of lines, kept with 16 bits of precision.
+ * If Spacial is set, the first line is filtered as in deNoiseSpacial(),
+ * against its first pixel only. */
+static void deNoiseHorizontal(
+                    const unsigned char *Frame,  // mpi->planes[x]
+                    unsigned int *Horiz,         // W * H intermediate
+                    int W, int H, int sStride,
+                    int *Horizontal, int Spacial)
+{
+    for (long Y = 0; Y < H; Y++){
+        unsigned int PixelAnt = Frame[0]<<16;
+
+        Horiz[0] = PixelAnt;
+        for (long X = 1; X < W; X++){
+            Horiz[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
+            if (!Spacial || Y > 0)
+                PixelAnt = Horiz[X];
+        }
+        Frame += sStride;
+        Horiz += W;
+    }
+}
+
+/* Vertical (unless Vertical is NULL, for the first line) and temporal
+ * (unless Temporal is NULL) low-pass of W columns of a line */
+static void deNoiseVerticalLine(
+                    const unsigned int *Horiz,
+                    unsigned int *LineAnt,
+                    unsigned short *FrameAnt,
+                    unsigned char *FrameDest,
+                    int W, int *Vertical, int *Temporal)
+{
+    for (long X = 0; X < W; X++){
+        unsigned int PixelDst;
+
+        if (Vertical)
+            LineAnt[X] = LowPassMul(LineAnt[X], Horiz[X], Vertical);
+        else
+            LineAnt[X] = Horiz[X];
+        PixelDst = LineAnt[X];
+        if (Temporal){
+            PixelDst = LowPassMul(FrameAnt[X]<<8, PixelDst, Temporal);
+            FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
+        }
+        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
+    }
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i LowPassMul_avx2(__m256i PrevMul, __m256i CurrMul,
+                                      const int *Coef)
+{
+    __m256i d = _mm256_add_epi32(_mm256_sub_epi32(PrevMul, CurrMul),
+                                 _mm256_set1_epi32(0x10007FF));
+
+    d = _mm256_srli_epi32(d, 12);
+    return _mm256_add_epi32(CurrMul, _mm256_i32gather_epi32(Coef, d, 4));
+}
+
+/* Packs the low 16 bits of each 32-bit lane */
+__attribute__ ((__target__ ("avx2")))
+static inline __m128i Pack16_avx2(__m256i v)
+{
+    v = _mm256_and_si256(v, _mm256_set1_epi32(0xFFFF));
+    v = _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0xD8);
+    return _mm256_castsi256_si128(v);
+}
+
+/* Same as deNoiseVerticalLine(), 8 pixels at a time */
+__attribute__ ((__target__ ("avx2")))
+static void deNoiseVerticalLine_avx2(
+                    const unsigned int *Horiz,
+                    unsigned int *LineAnt,
+                    unsigned short *FrameAnt,
+                    unsigned char *FrameDest,
+                    int W, int *Vertical, int *Temporal)
+{
+    const __m256i bias16 = _mm256_set1_epi32(0x10007FFF);
+    const __m256i bias8 = _mm256_set1_epi32(0x1000007F);
+    long X = 0;
+
+    for (; X + 8 <= W; X += 8){
+        __m256i PixelDst = _mm256_loadu_si256((const __m256i *)&Horiz[X]);
+
+        if (Vertical)
+            PixelDst = LowPassMul_avx2(
+                _mm256_loadu_si256((const __m256i *)&LineAnt[X]),
+                PixelDst, Vertical);
+        _mm256_storeu_si256((__m256i *)&LineAnt[X], PixelDst);
+        if (Temporal){
+            __m256i Ant = _mm256_cvtepu16_epi32(
+                _mm_loadu_si128((const __m128i *)&FrameAnt[X]));
+
+            PixelDst = LowPassMul_avx2(_mm256_slli_epi32(Ant, 8), PixelDst,
+                                       Temporal);
+            _mm_storeu_si128((__m128i *)&FrameAnt[X], Pack16_avx2(
+                _mm256_srli_epi32(_mm256_add_epi32(PixelDst, bias8), 8)));
+        }
+
+        __m128i Dst = Pack16_avx2(_mm256_and_si256(
+            _mm256_srli_epi32(_mm256_add_epi32(PixelDst, bias16), 16),
+            _mm256_set1_epi32(0xFF)));
+        _mm_storel_epi64((__m128i *)&FrameDest[X], _mm_packus_epi16(Dst, Dst));
+    }
+
+    if (X < W)
+        deNoiseVerticalLine(Horiz + X, LineAnt + X, FrameAnt + X,
+                            FrameDest + X, W - X, Vertical, Temporal);
+}
+
+/* Same as deNoiseTemporal(), 8 pixels at a time */
+__attribute__ ((__target__ ("avx2")))
+static void deNoiseTemporal_avx2(
+                    unsigned char *Frame,        // mpi->planes[x]
+                    unsigned char *FrameDest,    // dmpi->planes[x]
+                    unsigned short *FrameAnt,
+                    int W, int H, int sStride, int dStride,
+                    int *Temporal)
+{
+    const __m256i bias16 = _mm256_set1_epi32(0x10007FFF);
+    const __m256i bias8 = _mm256_set1_epi32(0x1000007F);
+
+    for (long Y = 0; Y < H; Y++){
+        long X = 0;
+
+        for (; X + 8 <= W; X += 8){
+            __m256i Curr = _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64((const __m128i *)&Frame[X]));
+            __m256i Ant = _mm256_cvtepu16_epi32(
+                _mm_loadu_si128((const __m128i *)&FrameAnt[X]));
+            __m256i PixelDst = LowPassMul_avx2(_mm256_slli_epi32(Ant, 8),
+                                               _mm256_slli_epi32(Curr, 16),
+                                               Temporal);
+
+            _mm_storeu_si128((__m128i *)&FrameAnt[X], Pack16_avx2(
+                _mm256_srli_epi32(_mm256_add_epi32(PixelDst, bias8), 8)));
+
+            __m128i Dst = Pack16_avx2(_mm256_and_si256(
+                _mm256_srli_epi32(_mm256_add_epi32(PixelDst, bias16), 16),
+                _mm256_set1_epi32(0xFF)));
+            _mm_storel_epi64((__m128i *)&FrameDest[X],
+                             _mm_packus_epi16(Dst, Dst));
+        }
+        if (X < W)
+            deNoiseTemporal(Frame + X, FrameDest + X, FrameAnt + X,
+                            W - X, 1, sStride, dStride, Temporal);
+        Frame += sStride;
+        FrameDest += dStride;
+        FrameAnt += W;
+    }
+}
+#endif
+
 //===========================================================================//
 
 static void PrecalcCoefs(int *Ct, double Dist25)
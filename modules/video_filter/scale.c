@@ -34,11 +34,13 @@
 #include <vlc_filter.h>
 #include <vlc_picture.h>
 
+#include "../video_chroma/slices.h"
+
 /****************************************************************************
  * Local prototypes
  ****************************************************************************/
 static int  OpenFilter ( filter_t * );
-VIDEO_FILTER_WRAPPER(Filter)
+VIDEO_FILTER_WRAPPER_CLOSE(Filter, CloseFilter)
 
 /*****************************************************************************
  * Module descriptor
@@ -72,6 +74,8 @@ static int OpenFilter( filter_t *p_filter )
 #warning Converter cannot (really) change output format.
     video_format_ScaleCropAr( &p_filter->fmt_out.video, &p_filter->fmt_in.video );
 
+    /* Without a runner, pictures are scaled on the calling thread */
+    p_filter->p_sys = vlc_slices_New( 0 );
     p_filter->ops = &Filter_ops;
 
     msg_Dbg( p_filter, "%ix%i -> %ix%i", p_filter->fmt_in.video.i_width,
@@ -81,105 +85,159 @@ static int OpenFilter( filter_t *p_filter )
     return VLC_SUCCESS;
 }
 
+static void CloseFilter( filter_t *p_filter )
+{
+    vlc_slices_t *slices = p_filter->p_sys;
+
+    if( slices != NULL )
+        vlc_slices_Delete( slices );
+}
+
+#define SHIFT_SIZE 16
+
 /****************************************************************************
- * Filter: the whole thing
+ * ScalePlane: scale the destination lines [start, end) of a plane
  ****************************************************************************/
-static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_pic_dst )
+static void ScalePlane( const filter_t *p_filter, const plane_t *p_srcp,
+                        const plane_t *p_dstp, unsigned start, unsigned end )
 {
-#warning Converter cannot (really) change output format.
-    video_format_ScaleCropAr( &p_filter->fmt_out.video, &p_filter->fmt_in.video );
-
-    if( p_filter->fmt_in.video.i_chroma != VLC_CODEC_RGBA &&
-        p_filter->fmt_in.video.i_chroma != VLC_CODEC_ARGB &&
-        p_filter->fmt_in.video.i_chroma != VLC_CODEC_BGRA &&
-        p_filter->fmt_in.video.i_chroma != VLC_CODEC_RGB32 )
+    const int i_src_pitch    = p_srcp->i_pitch;
+    const int i_dst_pitch    = p_dstp->i_pitch;
+    const int i_src_height   = p_filter->fmt_in.video.i_height;
+    const int i_src_width    = p_filter->fmt_in.video.i_width;
+    const int i_dst_height   = p_filter->fmt_out.video.i_height;
+    const int i_dst_width    = p_filter->fmt_out.video.i_width;
+    const int i_dst_visible_pitch = p_dstp->i_visible_pitch;
+    const int i_dst_hidden_pitch  = i_dst_pitch - i_dst_visible_pitch;
+    const int i_height_coef  = ( i_src_height << SHIFT_SIZE )
+                               / i_dst_height;
+    const int i_width_coef   = ( i_src_width << SHIFT_SIZE )
+                               / i_dst_width;
+    const int i_src_height_1 = i_src_height - 1;
+    const int i_src_width_1  = i_src_width - 1;
+
+    const uint8_t *p_src = p_srcp->p_pixels;
+    uint8_t *p_dst = p_dstp->p_pixels + start * i_dst_pitch;
+    uint8_t *p_dstendline = p_dst + i_dst_visible_pitch;
+    const uint8_t *p_dstend = p_dstp->p_pixels + end * i_dst_pitch;
+
+    const int i_shift_height = i_dst_height / i_src_height;
+    const int i_shift_width = i_dst_width / i_src_width;
+
+    int l = (1<<(SHIFT_SIZE-i_shift_height)) + (int)start * i_height_coef;
+    for( ; p_dst < p_dstend;
+         p_dst += i_dst_hidden_pitch,
+         p_dstendline += i_dst_pitch, l += i_height_coef )
     {
-        for( int i_plane = 0; i_plane < p_pic_dst->i_planes; i_plane++ )
+        int k = 1<<(SHIFT_SIZE-i_shift_width);
+        const uint8_t *p_srcl = p_src
+               + (__MIN( i_src_height_1, l >> SHIFT_SIZE )*i_src_pitch);
+
+        for( ; p_dst < p_dstendline; p_dst++, k += i_width_coef )
         {
-            const int i_src_pitch    = p_pic->p[i_plane].i_pitch;
-            const int i_dst_pitch    = p_pic_dst->p[i_plane].i_pitch;
-            const int i_src_height   = p_filter->fmt_in.video.i_height;
-            const int i_src_width    = p_filter->fmt_in.video.i_width;
-            const int i_dst_height   = p_filter->fmt_out.video.i_height;
-            const int i_dst_width    = p_filter->fmt_out.video.i_width;
-            const int i_dst_visible_lines =
-                                       p_pic_dst->p[i_plane].i_visible_lines;
-            const int i_dst_visible_pitch =
-                                       p_pic_dst->p[i_plane].i_visible_pitch;
-            const int i_dst_hidden_pitch  = i_dst_pitch - i_dst_visible_pitch;
-#define SHIFT_SIZE 16
-            const int i_height_coef  = ( i_src_height << SHIFT_SIZE )
-                                       / i_dst_height;
-            const int i_width_coef   = ( i_src_width << SHIFT_SIZE )
-                                       / i_dst_width;
-            const int i_src_height_1 = i_src_height - 1;
-            const int i_src_width_1  = i_src_width - 1;
-
-            uint8_t *p_src = p_pic->p[i_plane].p_pixels;
-            uint8_t *p_dst = p_pic_dst->p[i_plane].p_pixels;
-            uint8_t *p_dstendline = p_dst + i_dst_visible_pitch;
-            const uint8_t *p_dstend = p_dst + i_dst_visible_lines*i_dst_pitch;
-
-            const int i_shift_height = i_dst_height / i_src_height;
-            const int i_shift_width = i_dst_width / i_src_width;
-
-            int l = 1<<(SHIFT_SIZE-i_shift_height);
-            for( ; p_dst < p_dstend;
-                 p_dst += i_dst_hidden_pitch,
-                 p_dstendline += i_dst_pitch, l += i_height_coef )
-            {
-                int k = 1<<(SHIFT_SIZE-i_shift_width);
-                uint8_t *p_srcl = p_src
-                       + (__MIN( i_src_height_1, l >> SHIFT_SIZE )*i_src_pitch);
-
-                for( ; p_dst < p_dstendline; p_dst++, k += i_width_coef )
-                {
-                    *p_dst = p_srcl[__MIN( i_src_width_1, k >> SHIFT_SIZE )];
-                }
-            }
+            *p_dst = p_srcl[__MIN( i_src_width_1, k >> SHIFT_SIZE )];
         }
     }
-    else /* RGBA */
+}
+
+/****************************************************************************
+ * ScalePlaneRGBA: scale the destination lines [start, end) of a packed plane
+ ****************************************************************************/
+static void ScalePlaneRGBA( const filter_t *p_filter, const plane_t *p_srcp,
+                            const plane_t *p_dstp, unsigned start,
+                            unsigned end )
+{
+    const int i_src_pitch = p_srcp->i_pitch;
+    const int i_dst_pitch = p_dstp->i_pitch;
+    const int i_src_height   = p_filter->fmt_in.video.i_height;
+    const int i_src_width    = p_filter->fmt_in.video.i_width;
+    const int i_dst_height   = p_filter->fmt_out.video.i_height;
+    const int i_dst_width    = p_filter->fmt_out.video.i_width;
+    const int i_dst_visible_pitch = p_dstp->i_visible_pitch;
+    const int i_dst_hidden_pitch  = i_dst_pitch - i_dst_visible_pitch;
+    const int i_height_coef  = ( i_src_height << SHIFT_SIZE )
+                               / i_dst_height;
+    const int i_width_coef   = ( i_src_width << SHIFT_SIZE )
+                               / i_dst_width;
+    const int i_src_height_1 = i_src_height - 1;
+    const int i_src_width_1  = i_src_width - 1;
+
+    const uint32_t *p_src = (const uint32_t*)p_srcp->p_pixels;
+    uint32_t *p_dst = (uint32_t*)p_dstp->p_pixels + start*(i_dst_pitch>>2);
+    uint32_t *p_dstendline = p_dst + (i_dst_visible_pitch>>2);
+    const uint32_t *p_dstend = (const uint32_t*)p_dstp->p_pixels
+                             + end*(i_dst_pitch>>2);
+
+    const int i_shift_height = i_dst_height / i_src_height;
+    const int i_shift_width = i_dst_width / i_src_width;
+
+    int l = (1<<(SHIFT_SIZE-i_shift_height)) + (int)start * i_height_coef;
+    for( ; p_dst < p_dstend;
+         p_dst += (i_dst_hidden_pitch>>2),
+         p_dstendline += (i_dst_pitch>>2),
+         l += i_height_coef )
     {
-        const int i_src_pitch = p_pic->p->i_pitch;
-        const int i_dst_pitch = p_pic_dst->p->i_pitch;
-        const int i_src_height   = p_filter->fmt_in.video.i_height;
-        const int i_src_width    = p_filter->fmt_in.video.i_width;
-        const int i_dst_height   = p_filter->fmt_out.video.i_height;
-        const int i_dst_width    = p_filter->fmt_out.video.i_width;
-        const int i_dst_visible_lines =
-                                   p_pic_dst->p->i_visible_lines;
-        const int i_dst_visible_pitch =
-                                   p_pic_dst->p->i_visible_pitch;
-        const int i_dst_hidden_pitch  = i_dst_pitch - i_dst_visible_pitch;
-        const int i_height_coef  = ( i_src_height << SHIFT_SIZE )
-                                   / i_dst_height;
-        const int i_width_coef   = ( i_src_width << SHIFT_SIZE )
-                                   / i_dst_width;
-        const int i_src_height_1 = i_src_height - 1;
-        const int i_src_width_1  = i_src_width - 1;
-
-        uint32_t *p_src = (uint32_t*)p_pic->p->p_pixels;
-        uint32_t *p_dst = (uint32_t*)p_pic_dst->p->p_pixels;
-        uint32_t *p_dstendline = p_dst + (i_dst_visible_pitch>>2);
-        const uint32_t *p_dstend = p_dst + i_dst_visible_lines*(i_dst_pitch>>2);
-
-        const int i_shift_height = i_dst_height / i_src_height;
-        const int i_shift_width = i_dst_width / i_src_width;
-
-        int l = 1<<(SHIFT_SIZE-i_shift_height);
-        for( ; p_dst < p_dstend;
-             p_dst += (i_dst_hidden_pitch>>2),
-             p_dstendline += (i_dst_pitch>>2),
-             l += i_height_coef )
+        int k = 1<<(SHIFT_SIZE-i_shift_width);
+        const uint32_t *p_srcl = p_src
+                + (__MIN( i_src_height_1, l >> SHIFT_SIZE )*(i_src_pitch>>2));
+        for( ; p_dst < p_dstendline; p_dst++, k += i_width_coef )
         {
-            int k = 1<<(SHIFT_SIZE-i_shift_width);
-            uint32_t *p_srcl = p_src
-                    + (__MIN( i_src_height_1, l >> SHIFT_SIZE )*(i_src_pitch>>2));
-            for( ; p_dst < p_dstendline; p_dst++, k += i_width_coef )
-            {
-                *p_dst = p_srcl[__MIN( i_src_width_1, k >> SHIFT_SIZE )];
-            }
+            *p_dst = p_srcl[__MIN( i_src_width_1, k >> SHIFT_SIZE )];
         }
     }
 }
+
+struct scale_job
+{
+    const filter_t *p_filter;
+    const picture_t *p_pic;
+    const picture_t *p_pic_dst;
+    bool b_rgba;
+};
+
+static void ScaleSlice( void *opaque, unsigned index, unsigned count )
+{
+    const struct scale_job *job = opaque;
+    const picture_t *p_pic_dst = job->p_pic_dst;
+
+    for( int i_plane = 0; i_plane < (job->b_rgba ? 1 : p_pic_dst->i_planes);
+         i_plane++ )
+    {
+        const plane_t *p_dstp = &p_pic_dst->p[i_plane];
+        unsigned start, end;
+
+        vlc_slice_Lines( p_dstp->i_visible_lines, 1, index, count,
+                         &start, &end );
+        if( job->b_rgba )
+            ScalePlaneRGBA( job->p_filter, &job->p_pic->p[i_plane], p_dstp,
+                            start, end );
+        else
+            ScalePlane( job->p_filter, &job->p_pic->p[i_plane], p_dstp,
+                        start, end );
+    }
+}
+
+/****************************************************************************
+ * Filter: the whole thing
+ ****************************************************************************/
+static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_pic_dst )
+{
+    vlc_slices_t *slices = p_filter->p_sys;
+
+#warning Converter cannot (really) change output format.
+    video_format_ScaleCropAr( &p_filter->fmt_out.video, &p_filter->fmt_in.video );
+
+    struct scale_job job = {
+        .p_filter = p_filter,
+        .p_pic = p_pic,
+        .p_pic_dst = p_pic_dst,
+        .b_rgba = p_filter->fmt_in.video.i_chroma == VLC_CODEC_RGBA ||
+                  p_filter->fmt_in.video.i_chroma == VLC_CODEC_ARGB ||
+                  p_filter->fmt_in.video.i_chroma == VLC_CODEC_BGRA ||
+                  p_filter->fmt_in.video.i_chroma == VLC_CODEC_RGB32,
+    };
+    unsigned count = vlc_slices_Count( slices, p_pic_dst->p[0].i_visible_lines,
+                                       64 );
+
+    vlc_slices_Run( slices, count, ScaleSlice, &job );
+}
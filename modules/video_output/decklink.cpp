@@ -224,6 +224,7 @@ struct decklink_sys_t
         uint8_t afd, ar;
         int nosignal_delay;
         picture_t *pic_nosignal;
+        vlc_slices_t *slices; /* v210 packing threads */
     } video;
 };
 
@@ -323,6 +324,8 @@ static decklink_sys_t *HoldDLSys(vlc_object_t *obj, int i_cat)
             sys->users = 1;
             sys->b_videomodule = (i_cat == VIDEO_ES);
             sys->b_recycling = false;
+            sys->video.pic_nosignal = NULL;
+            sys->video.slices = NULL;
             sys->i_rate = var_InheritInteger(obj, AUDIO_CFG_PREFIX "audio-rate");
             if(sys->i_rate > 0)
                 sys->i_rate = -1;
@@ -358,6 +361,8 @@ static void ReleaseDLSys(vlc_object_t *obj, int i_cat)
         /* Clean video specific */
         if (sys->video.pic_nosignal)
             picture_Release(sys->video.pic_nosignal);
+        if (sys->video.slices)
+            vlc_slices_Delete(sys->video.slices);
 
         free(sys);
         var_Destroy(libvlc, "decklink-sys");
@@ -719,7 +724,7 @@ static void PrepareVideo(vout_display_t *vd, picture_t *picture, subpicture_t *,
         sdi::AFD afd(sys->video.afd, sys->video.ar);
         afd.FillBuffer(reinterpret_cast<uint8_t*>(buf), stride);
 
-        sdi::V210::Convert(picture, stride, frame_bytes);
+        sdi::V210::Convert(picture, stride, frame_bytes, sys->video.slices);
 
         result = pDLVideoFrame->SetAncillaryData(vanc);
         vanc->Release();
@@ -804,6 +809,8 @@ static int OpenVideo(vout_display_t *vd,
         sys->video.afd = var_InheritInteger(vd, VIDEO_CFG_PREFIX "afd");
         sys->video.ar = var_InheritInteger(vd, VIDEO_CFG_PREFIX "ar");
         sys->video.pic_nosignal = NULL;
+        if (sys->video.tenbits && sys->video.slices == NULL)
+            sys->video.slices = vlc_slices_New(0);
 
         if (OpenDecklink(vd, sys, fmtp) != VLC_SUCCESS)
         {
@@ -35,14 +35,23 @@
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 #include <drm_fourcc.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_vout_display.h>
 #include <vlc_picture.h>
+#include <vlc_subpicture.h>
 #include <vlc_vout_window.h>
 #include "vlc_drm.h"
 
+#ifdef HAVE_VAAPI
+# include <va/va_drmcommon.h>
+# include "../../hw/vaapi/vlc_vaapi.h"
+#endif
+
 #include <assert.h>
 
 /*****************************************************************************
@@ -60,6 +69,24 @@ typedef enum { drvSuccess, drvTryNext, drvFail } deviceRval;
  */
 #define   MAXHWBUF 3
 
+/*
+ * how many imported VA surfaces keep their frame buffer. This should cover
+ * the whole decoder pool so that surfaces are exported only once.
+ */
+#define   MAXVAFB 32
+
+/** Properties of a plane, as needed for atomic modesetting */
+struct drm_plane_props {
+    uint32_t        fb_id;
+    uint32_t        crtc_id;
+    uint32_t        src_x, src_y, src_w, src_h;
+    uint32_t        crtc_x, crtc_y, crtc_w, crtc_h;
+
+    uint64_t        type;
+    bool            has_zpos;
+    uint64_t        zpos;
+};
+
 typedef struct vout_display_sys_t {
     picture_t       *buffers[MAXHWBUF];
 
@@ -72,6 +99,34 @@ typedef struct vout_display_sys_t {
  * modeset information
  */
     uint32_t        plane_id;
+    bool            atomic;
+    struct drm_plane_props plane_props;
+    vlc_tick_t      period;
+
+/*
+ * subtitles overlay plane
+ */
+    uint32_t        spu_plane_id;
+    struct drm_plane_props spu_plane_props;
+    picture_t       *spu_buffers[2];
+    unsigned int    spu_front;
+    bool            spu_shown;
+
+#ifdef HAVE_VAAPI
+/*
+ * VA surfaces scanned out directly
+ */
+    bool            vaapi;
+    struct {
+        VASurfaceID surface;
+        uint32_t    fb_id;
+    } va_fbs[MAXVAFB];
+    unsigned int    va_fb_count;
+    unsigned int    va_fb_evict;
+    picture_t       *scanout; /* picture on screen */
+    picture_t       *next; /* picture to show on the next display */
+    uint32_t        next_fb_id;
+#endif
 } vout_display_sys_t;
 
 /** fourccmatching, matching drm to vlc fourccs and see if it was present
@@ -288,6 +343,312 @@ static vlc_fourcc_t ChromaNegotiation(vout_display_t *vd)
     return 0;
 }
 
+static int GetPlaneProps(int fd, uint32_t plane_id,
+                         struct drm_plane_props *restrict p)
+{
+    static const struct {
+        char name[8];
+        size_t offset;
+    } names[] = {
+        { "FB_ID",   offsetof(struct drm_plane_props, fb_id) },
+        { "CRTC_ID", offsetof(struct drm_plane_props, crtc_id) },
+        { "SRC_X",   offsetof(struct drm_plane_props, src_x) },
+        { "SRC_Y",   offsetof(struct drm_plane_props, src_y) },
+        { "SRC_W",   offsetof(struct drm_plane_props, src_w) },
+        { "SRC_H",   offsetof(struct drm_plane_props, src_h) },
+        { "CRTC_X",  offsetof(struct drm_plane_props, crtc_x) },
+        { "CRTC_Y",  offsetof(struct drm_plane_props, crtc_y) },
+        { "CRTC_W",  offsetof(struct drm_plane_props, crtc_w) },
+        { "CRTC_H",  offsetof(struct drm_plane_props, crtc_h) },
+    };
+
+    drmModeObjectProperties *props =
+        drmModeObjectGetProperties(fd, plane_id, DRM_MODE_OBJECT_PLANE);
+    if (props == NULL)
+        return -1;
+
+    memset(p, 0, sizeof (*p));
+    p->type = DRM_PLANE_TYPE_OVERLAY;
+
+    for (uint32_t i = 0; i < props->count_props; i++) {
+        drmModePropertyPtr pp = drmModeGetProperty(fd, props->props[i]);
+        if (pp == NULL)
+            continue;
+
+        for (size_t j = 0; j < ARRAY_SIZE(names); j++)
+            if (strcmp(pp->name, names[j].name) == 0)
+                *(uint32_t *)((char *)p + names[j].offset) = pp->prop_id;
+
+        if (strcmp(pp->name, "type") == 0)
+            p->type = props->prop_values[i];
+        if (strcmp(pp->name, "zpos") == 0) {
+            p->has_zpos = true;
+            p->zpos = props->prop_values[i];
+        }
+        drmModeFreeProperty(pp);
+    }
+    drmModeFreeObjectProperties(props);
+
+    for (size_t j = 0; j < ARRAY_SIZE(names); j++)
+        if (*(uint32_t *)((char *)p + names[j].offset) == 0)
+            return -1;
+    return 0;
+}
+
+/**
+ * Looks for an RGBA overlay plane above the video plane, for subtitles.
+ */
+static uint32_t FindSubpicturePlane(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+    vout_window_t *wnd = vd->cfg->window;
+    int drm_fd = wnd->display.drm_fd;
+    uint32_t plane_id = 0;
+
+    drmModeRes *resources = drmModeGetResources(drm_fd);
+    if (resources == NULL)
+        return 0;
+
+    int crtc_index = -1;
+    for (int i = 0; i < resources->count_crtcs; i++)
+        if (resources->crtcs[i] == wnd->handle.crtc)
+            crtc_index = i;
+    drmModeFreeResources(resources);
+    if (crtc_index < 0)
+        return 0;
+
+    struct drm_plane_props video;
+    if (GetPlaneProps(drm_fd, sys->plane_id, &video))
+        return 0;
+
+    drmModePlaneRes *plane_res = drmModeGetPlaneResources(drm_fd);
+    if (plane_res == NULL)
+        return 0;
+
+    for (uint32_t c = 0; c < plane_res->count_planes && plane_id == 0; c++) {
+        if (plane_res->planes[c] == sys->plane_id)
+            continue;
+
+        drmModePlane *plane = drmModeGetPlane(drm_fd, plane_res->planes[c]);
+        if (plane == NULL)
+            continue;
+
+        struct drm_plane_props props;
+        bool usable = (plane->possible_crtcs & (1 << crtc_index))
+                   && GetPlaneProps(drm_fd, plane->plane_id, &props) == 0
+                   && props.type == DRM_PLANE_TYPE_OVERLAY;
+
+        /* Without explicit ordering, only trust overlays above primary */
+        if (usable) {
+            if (props.has_zpos && video.has_zpos)
+                usable = props.zpos > video.zpos;
+            else
+                usable = video.type == DRM_PLANE_TYPE_PRIMARY;
+        }
+
+        for (uint32_t i = 0; usable && i < plane->count_formats; i++)
+            if (plane->formats[i] == DRM_FORMAT_ABGR8888) {
+                plane_id = plane->plane_id;
+                sys->spu_plane_props = props;
+                break;
+            }
+        drmModeFreePlane(plane);
+    }
+    drmModeFreePlaneResources(plane_res);
+    return plane_id;
+}
+
+/**
+ * Draws the subpicture into the back buffer of the subtitles plane.
+ *
+ * \return whether there is anything to show
+ */
+static bool PrepareSubpicture(vout_display_t *vd, const subpicture_t *subpic)
+{
+    vout_display_sys_t *sys = vd->sys;
+
+    if (subpic == NULL || subpic->p_region == NULL
+     || subpic->i_original_picture_width <= 0
+     || subpic->i_original_picture_height <= 0)
+        return false;
+
+    const unsigned width = subpic->i_original_picture_width;
+    const unsigned height = subpic->i_original_picture_height;
+    picture_t *dst = sys->spu_buffers[!sys->spu_front];
+
+    if (dst == NULL || dst->format.i_width != width
+     || dst->format.i_height != height) {
+        video_format_t fmt;
+
+        for (size_t i = 0; i < ARRAY_SIZE(sys->spu_buffers); i++)
+            if (sys->spu_buffers[i] != NULL && (!sys->spu_shown
+                                             || i != sys->spu_front)) {
+                picture_Release(sys->spu_buffers[i]);
+                sys->spu_buffers[i] = NULL;
+            }
+
+        video_format_Init(&fmt, VLC_CODEC_RGBA);
+        video_format_Setup(&fmt, VLC_CODEC_RGBA, width, height,
+                           width, height, 1, 1);
+        dst = vlc_drm_dumb_alloc_fb(vd->obj.logger,
+                                    vd->cfg->window->display.drm_fd, &fmt);
+        video_format_Clean(&fmt);
+        sys->spu_buffers[!sys->spu_front] = dst;
+        if (dst == NULL)
+            return false;
+    }
+
+    plane_t *p = &dst->p[0];
+    for (int y = 0; y < p->i_visible_lines; y++)
+        memset(p->p_pixels + y * p->i_pitch, 0, width * 4);
+
+    /* DRM planes blend pre-multiplied alpha by default */
+    for (const subpicture_region_t *r = subpic->p_region; r != NULL;
+         r = r->p_next) {
+        const plane_t *src = &r->p_picture->p[0];
+        const unsigned alpha = r->i_alpha * subpic->i_alpha;
+        int x0 = r->i_x, y0 = r->i_y;
+        int w = r->fmt.i_visible_width, h = r->fmt.i_visible_height;
+        const uint8_t *in_base = src->p_pixels
+                               + r->fmt.i_y_offset * src->i_pitch
+                               + r->fmt.i_x_offset * 4;
+
+        if (r->fmt.i_chroma != VLC_CODEC_RGBA)
+            continue;
+        if (x0 < 0) {
+            in_base -= x0 * 4;
+            w += x0;
+            x0 = 0;
+        }
+        if (y0 < 0) {
+            in_base -= y0 * src->i_pitch;
+            h += y0;
+            y0 = 0;
+        }
+        if (x0 + w > (int)width)
+            w = width - x0;
+        if (y0 + h > (int)height)
+            h = height - y0;
+
+        for (int y = 0; y < h; y++) {
+            const uint8_t *in = in_base + y * src->i_pitch;
+            uint8_t *out = p->p_pixels + (y0 + y) * p->i_pitch + x0 * 4;
+
+            for (int x = 0; x < w; x++, in += 4, out += 4) {
+                const unsigned a = in[3] * alpha / (255 * 255);
+
+                out[0] = in[0] * a / 255;
+                out[1] = in[1] * a / 255;
+                out[2] = in[2] * a / 255;
+                out[3] = a;
+            }
+        }
+    }
+    return true;
+}
+
+#ifdef HAVE_VAAPI
+static void CloseHandle(int fd, uint32_t handle)
+{
+    struct drm_gem_close cmd = { .handle = handle };
+
+    vlc_drm_ioctl(fd, DRM_IOCTL_GEM_CLOSE, &cmd);
+}
+
+/**
+ * Gets a frame buffer for a VA surface, importing it if needed.
+ */
+static uint32_t VaapiGetFb(vout_display_t *vd, picture_t *pic)
+{
+    vout_display_sys_t *sys = vd->sys;
+    int fd = vd->cfg->window->display.drm_fd;
+    VASurfaceID surface = vlc_vaapi_PicGetSurface(pic);
+
+    for (unsigned i = 0; i < sys->va_fb_count; i++)
+        if (sys->va_fbs[i].surface == surface)
+            return sys->va_fbs[i].fb_id;
+
+    VADRMPRIMESurfaceDescriptor desc;
+    if (vlc_vaapi_ExportSurfaceHandle(VLC_OBJECT(vd),
+                                      vlc_vaapi_PicGetDisplay(pic), surface,
+                                      VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME_2,
+                                      VA_EXPORT_SURFACE_READ_ONLY |
+                                      VA_EXPORT_SURFACE_COMPOSED_LAYERS,
+                                      &desc))
+        return 0;
+
+    uint32_t bo[4] = { 0 };
+    bool ok = desc.num_layers == 1;
+
+    for (uint32_t i = 0; i < desc.num_objects; i++) {
+        if (ok && drmPrimeFDToHandle(fd, desc.objects[i].fd, &bo[i])) {
+            msg_Err(vd, "cannot import DMA-BUF: %s", vlc_strerror_c(errno));
+            ok = false;
+        }
+        close(desc.objects[i].fd);
+    }
+
+    uint32_t fb_id = 0;
+
+    if (ok) {
+        uint32_t handles[4] = { 0 }, pitches[4] = { 0 }, offsets[4] = { 0 };
+        uint64_t modifiers[4] = { 0 };
+        uint32_t flags = 0;
+
+        for (uint32_t i = 0; i < desc.layers[0].num_planes; i++) {
+            uint32_t obj = desc.layers[0].object_index[i];
+
+            handles[i] = bo[obj];
+            pitches[i] = desc.layers[0].pitch[i];
+            offsets[i] = desc.layers[0].offset[i];
+            modifiers[i] = desc.objects[obj].drm_format_modifier;
+        }
+        if (modifiers[0] != DRM_FORMAT_MOD_INVALID)
+            flags |= DRM_MODE_FB_MODIFIERS;
+
+        if (drmModeAddFB2WithModifiers(fd, desc.width, desc.height,
+                                       desc.layers[0].drm_format, handles,
+                                       pitches, offsets,
+                                       flags ? modifiers : NULL,
+                                       &fb_id, flags)) {
+            msg_Err(vd, "cannot add VA surface frame buffer: %s",
+                    vlc_strerror_c(errno));
+            fb_id = 0;
+        }
+    }
+
+    /* The frame buffer keeps its own references to the buffer objects */
+    for (uint32_t i = 0; i < desc.num_objects; i++) {
+        bool dup = false;
+
+        for (uint32_t j = 0; j < i; j++)
+            dup |= bo[j] == bo[i];
+        if (bo[i] != 0 && !dup)
+            CloseHandle(fd, bo[i]);
+    }
+
+    if (fb_id == 0)
+        return 0;
+
+    unsigned slot = sys->va_fb_count;
+    if (slot == MAXVAFB) {
+        /* Evict a frame buffer that is not being shown */
+        do {
+            slot = sys->va_fb_evict++ % MAXVAFB;
+        } while (sys->va_fbs[slot].fb_id == sys->next_fb_id
+              || (sys->scanout != NULL
+               && sys->va_fbs[slot].surface
+                  == vlc_vaapi_PicGetSurface(sys->scanout)));
+        drmModeRmFB(fd, sys->va_fbs[slot].fb_id);
+    } else
+        sys->va_fb_count++;
+
+    sys->va_fbs[slot].surface = surface;
+    sys->va_fbs[slot].fb_id = fb_id;
+    return fb_id;
+}
+#endif
+
 static int Control(vout_display_t *vd, int query)
 {
     (void) vd;
@@ -307,10 +668,63 @@ static int Control(vout_display_t *vd, int query)
 static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic,
                     vlc_tick_t date)
 {
-    VLC_UNUSED(subpic); VLC_UNUSED(date);
+    VLC_UNUSED(date);
     vout_display_sys_t *sys = vd->sys;
 
-    picture_Copy(sys->buffers[sys->front_buf], pic);
+#ifdef HAVE_VAAPI
+    if (sys->vaapi) {
+        VADisplay dpy = vlc_vaapi_PicGetDisplay(pic);
+        VASurfaceID surface = vlc_vaapi_PicGetSurface(pic);
+
+        if (sys->next != NULL) {
+            picture_Release(sys->next);
+            sys->next = NULL;
+        }
+
+        /* Wait for the decoder to finish with the surface */
+        if (vaSyncSurface(dpy, surface) == VA_STATUS_SUCCESS) {
+            sys->next_fb_id = VaapiGetFb(vd, pic);
+            if (sys->next_fb_id != 0)
+                sys->next = picture_Hold(pic);
+        }
+    } else
+#endif
+        picture_Copy(sys->buffers[sys->front_buf], pic);
+
+    if (sys->spu_plane_id != 0) {
+        bool shown = PrepareSubpicture(vd, subpic);
+
+        if (shown || sys->spu_shown) {
+            /* Flip the subtitles buffer (or hide the plane) on display */
+            sys->spu_shown = shown;
+            if (shown)
+                sys->spu_front = !sys->spu_front;
+        }
+    }
+}
+
+static void AtomicAddPlane(drmModeAtomicReq *req,
+                           const struct drm_plane_props *props,
+                           uint32_t plane_id, uint32_t crtc_id,
+                           uint32_t fb_id, const vout_display_place_t *place,
+                           unsigned x, unsigned y, unsigned w, unsigned h)
+{
+    if (fb_id == 0) {
+        drmModeAtomicAddProperty(req, plane_id, props->fb_id, 0);
+        drmModeAtomicAddProperty(req, plane_id, props->crtc_id, 0);
+        return;
+    }
+
+    drmModeAtomicAddProperty(req, plane_id, props->fb_id, fb_id);
+    drmModeAtomicAddProperty(req, plane_id, props->crtc_id, crtc_id);
+    drmModeAtomicAddProperty(req, plane_id, props->src_x, x << 16);
+    drmModeAtomicAddProperty(req, plane_id, props->src_y, y << 16);
+    drmModeAtomicAddProperty(req, plane_id, props->src_w, w << 16);
+    drmModeAtomicAddProperty(req, plane_id, props->src_h, h << 16);
+    drmModeAtomicAddProperty(req, plane_id, props->crtc_x, place->x);
+    drmModeAtomicAddProperty(req, plane_id, props->crtc_y, place->y);
+    drmModeAtomicAddProperty(req, plane_id, props->crtc_w, place->width);
+    drmModeAtomicAddProperty(req, plane_id, props->crtc_h, place->height);
 }
 
 static void Display(vout_display_t *vd, picture_t *picture)
@@ -318,17 +732,65 @@ static void Display(vout_display_t *vd, picture_t *picture)
     VLC_UNUSED(picture);
     vout_display_sys_t *sys = vd->sys;
     vout_window_t *wnd = vd->cfg->window;
-    picture_t *pic = sys->buffers[sys->front_buf];
-    uint32_t fb_id = vlc_drm_dumb_get_fb_id(pic);
+    int fd = wnd->display.drm_fd;
+    uint32_t fb_id;
+
+#ifdef HAVE_VAAPI
+    if (sys->vaapi) {
+        if (sys->next == NULL)
+            return;
+        fb_id = sys->next_fb_id;
+    } else
+#endif
+        fb_id = vlc_drm_dumb_get_fb_id(sys->buffers[sys->front_buf]);
+
+    uint32_t spu_fb_id = 0;
+    unsigned spu_width = 0, spu_height = 0;
+    if (sys->spu_shown) {
+        picture_t *spu = sys->spu_buffers[sys->spu_front];
+
+        spu_fb_id = vlc_drm_dumb_get_fb_id(spu);
+        spu_width = spu->format.i_width;
+        spu_height = spu->format.i_height;
+    }
 
     vout_display_place_t place;
     vout_display_PlacePicture(&place, vd->fmt, vd->cfg);
 
-    int ret = drmModeSetPlane(wnd->display.drm_fd,
-            sys->plane_id, wnd->handle.crtc, fb_id, 0,
-            place.x, place.y, place.width, place.height,
-            vd->fmt->i_x_offset << 16, vd->fmt->i_y_offset << 16,
-            vd->fmt->i_visible_width << 16, vd->fmt->i_visible_height << 16);
+    int ret;
+
+    if (sys->atomic) {
+        drmModeAtomicReq *req = drmModeAtomicAlloc();
+        if (unlikely(req == NULL))
+            return;
+
+        AtomicAddPlane(req, &sys->plane_props, sys->plane_id,
+                       wnd->handle.crtc, fb_id, &place,
+                       vd->fmt->i_x_offset, vd->fmt->i_y_offset,
+                       vd->fmt->i_visible_width, vd->fmt->i_visible_height);
+        if (sys->spu_plane_id != 0)
+            AtomicAddPlane(req, &sys->spu_plane_props, sys->spu_plane_id,
+                           wnd->handle.crtc, spu_fb_id, &place,
+                           0, 0, spu_width, spu_height);
+
+        /* Blocking commit: returns once the new planes are on screen */
+        ret = drmModeAtomicCommit(fd, req, 0, NULL);
+        drmModeAtomicFree(req);
+        if (ret == 0)
+            vout_display_SendEventVsync(vd, vlc_tick_now(), sys->period);
+    } else {
+        ret = drmModeSetPlane(fd,
+                sys->plane_id, wnd->handle.crtc, fb_id, 0,
+                place.x, place.y, place.width, place.height,
+                vd->fmt->i_x_offset << 16, vd->fmt->i_y_offset << 16,
+                vd->fmt->i_visible_width << 16, vd->fmt->i_visible_height << 16);
+        if (ret == 0 && sys->spu_plane_id != 0)
+            drmModeSetPlane(fd, sys->spu_plane_id, wnd->handle.crtc,
+                            spu_fb_id, 0,
+                            place.x, place.y, place.width, place.height,
+                            0, 0, spu_width << 16, spu_height << 16);
+    }
+
     if (ret != drvSuccess)
     {
         msg_Err(vd, "Cannot do set plane for plane id %u, fb %"PRIu32,
@@ -337,6 +799,17 @@ static void Display(vout_display_t *vd, picture_t *picture)
         return;
     }
 
+#ifdef HAVE_VAAPI
+    if (sys->vaapi) {
+        /* The previous surface is not scanned out anymore */
+        if (sys->scanout != NULL)
+            picture_Release(sys->scanout);
+        sys->scanout = sys->next;
+        sys->next = NULL;
+        return;
+    }
+#endif
+
     sys->front_buf++;
     if (sys->front_buf == MAXHWBUF)
         sys->front_buf = 0;
@@ -348,9 +821,28 @@ static void Display(vout_display_t *vd, picture_t *picture)
 static void Close(vout_display_t *vd)
 {
     vout_display_sys_t *sys = vd->sys;
+    int fd = vd->cfg->window->display.drm_fd;
 
+#ifdef HAVE_VAAPI
+    if (sys->vaapi) {
+        /* Removing the frame buffers also disables the video plane */
+        for (unsigned i = 0; i < sys->va_fb_count; i++)
+            drmModeRmFB(fd, sys->va_fbs[i].fb_id);
+        if (sys->next != NULL)
+            picture_Release(sys->next);
+        if (sys->scanout != NULL)
+            picture_Release(sys->scanout);
+    } else
+#endif
     for (size_t i = 0; i < ARRAY_SIZE(sys->buffers); i++)
         picture_Release(sys->buffers[i]);
+
+    if (sys->spu_plane_id != 0)
+        drmModeSetPlane(fd, sys->spu_plane_id, vd->cfg->window->handle.crtc,
+                        0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    for (size_t i = 0; i < ARRAY_SIZE(sys->spu_buffers); i++)
+        if (sys->spu_buffers[i] != NULL)
+            picture_Release(sys->spu_buffers[i]);
 }
 
 static const struct vlc_display_operations ops = {
@@ -403,12 +895,38 @@ static int Open(vout_display_t *vd,
     if (!fourcc)
         return VLC_EGENERIC;
 
+#ifdef HAVE_VAAPI
+    /* Scan the VA surfaces out directly if a plane takes their format */
+    if (!sys->forced_drm_fourcc && context != NULL
+     && vlc_video_context_GetType(context) == VLC_VIDEO_CONTEXT_VAAPI
+     && vlc_vaapi_IsChromaOpaque(vd->source->i_chroma)
+     && vd->source->orientation == ORIENT_NORMAL) {
+        uint32_t va_drm_fourcc = DRM_FORMAT_NV12;
+#if defined DRM_FORMAT_P010
+        if (vd->source->i_chroma == VLC_CODEC_VAAPI_420_10BPP)
+            va_drm_fourcc = DRM_FORMAT_P010;
+#endif
+        for (size_t i = 0; i < ARRAY_SIZE(fourccmatching); i++)
+            if (fourccmatching[i].drm == va_drm_fourcc
+             && fourccmatching[i].present) {
+                sys->vaapi = true;
+                sys->drm_fourcc = va_drm_fourcc;
+                sys->plane_id = fourccmatching[i].plane_id;
+                fourcc = vd->source->i_chroma;
+                break;
+            }
+    }
+#endif
+
     msg_Dbg(vd, "Using VLC chroma '%.4s', DRM chroma '%.4s'",
             (char*)&fourcc, (char*)&sys->drm_fourcc);
 
     video_format_ApplyRotation(&fmt, vd->fmt);
     fmt.i_chroma = fourcc;
 
+#ifdef HAVE_VAAPI
+    if (!sys->vaapi)
+#endif
     for (size_t i = 0; i < ARRAY_SIZE(sys->buffers); i++) {
         sys->buffers[i] = vlc_drm_dumb_alloc_fb(vd->obj.logger, fd, &fmt);
         if (sys->buffers[i] == NULL) {
@@ -418,10 +936,29 @@ static int Open(vout_display_t *vd,
         }
     }
 
+    /* Update the video and subtitles planes at once where possible */
+    sys->atomic = drmSetClientCap(fd, DRM_CLIENT_CAP_ATOMIC, 1) == 0
+               && GetPlaneProps(fd, sys->plane_id, &sys->plane_props) == 0;
+
+    sys->spu_plane_id = FindSubpicturePlane(vd);
+    if (sys->spu_plane_id != 0) {
+        static const vlc_fourcc_t spu_chromas[] = { VLC_CODEC_RGBA, 0 };
+
+        msg_Dbg(vd, "using plane id %"PRIu32" for subtitles",
+                sys->spu_plane_id);
+        vd->info.subpicture_chromas = spu_chromas;
+    }
+
+    drmModeCrtc *crtc = drmModeGetCrtc(fd, vd->cfg->window->handle.crtc);
+    if (crtc != NULL) {
+        if (crtc->mode_valid && crtc->mode.clock > 0)
+            sys->period = VLC_TICK_FROM_US(UINT64_C(1000)
+                * crtc->mode.htotal * crtc->mode.vtotal / crtc->mode.clock);
+        drmModeFreeCrtc(crtc);
+    }
+
     *fmtp = fmt;
     vd->ops = &ops;
-
-    (void) context;
     return VLC_SUCCESS;
 }
 
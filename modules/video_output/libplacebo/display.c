@@ -21,6 +21,8 @@
  *****************************************************************************/
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
 #include <assert.h>
 
 #ifdef HAVE_CONFIG_H
@@ -28,6 +30,8 @@
 #endif
 
 #include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_modules.h>
 #include <vlc_plugin.h>
 #include <vlc_vout_display.h>
 #include <vlc_fs.h>
@@ -52,10 +56,16 @@
 #define dst_rect crop
 #endif
 
+// Sets of plane textures, so that the next picture can be uploaded (on the
+// transfer queue if available) while the previous one is still being read
+// by the renderer
+#define PLANE_TEX_SETS 2
+
 typedef struct vout_display_sys_t
 {
     vlc_placebo_t *pl;
-    const struct pl_tex *plane_tex[4];
+    const struct pl_tex *plane_tex[PLANE_TEX_SETS][4];
+    unsigned plane_tex_set;
     struct pl_renderer *renderer;
 
     // Pool of textures for the subpictures
@@ -98,6 +108,11 @@ static void Close(vout_display_t *);
 static void UpdateParams(vout_display_t *);
 static void UpdateColorspaceHint(vout_display_t *, const video_format_t *);
 
+#if PL_API_VER >= 159
+static void LoadShaderCache(vout_display_t *);
+static void SaveShaderCache(vout_display_t *);
+#endif
+
 static const struct vlc_display_operations ops = {
     .close = Close,
     .prepare = PictureRender,
@@ -141,6 +156,9 @@ static int Open(vout_display_t *vd,
     sys->renderer = pl_renderer_create(sys->pl->ctx, gpu);
     if (!sys->renderer)
         goto error;
+#if PL_API_VER >= 159
+    LoadShaderCache(vd);
+#endif
 
     vlc_placebo_ReleaseCurrent(sys->pl);
 
@@ -200,10 +218,14 @@ static void Close(vout_display_t *vd)
     const struct pl_gpu *gpu = sys->pl->gpu;
 
     if (vlc_placebo_MakeCurrent(sys->pl) == VLC_SUCCESS) {
-        for (int i = 0; i < 4; i++)
-            pl_tex_destroy(gpu, &sys->plane_tex[i]);
+        for (int j = 0; j < PLANE_TEX_SETS; j++)
+            for (int i = 0; i < 4; i++)
+                pl_tex_destroy(gpu, &sys->plane_tex[j][i]);
         for (int i = 0; i < sys->num_overlays; i++)
             pl_tex_destroy(gpu, &sys->overlay_tex[i]);
+#if PL_API_VER >= 159
+        SaveShaderCache(vd);
+#endif
         pl_renderer_destroy(&sys->renderer);
         vlc_placebo_ReleaseCurrent(sys->pl);
     }
@@ -224,6 +246,93 @@ static void Close(vout_display_t *vd)
     vlc_placebo_Release(sys->pl);
 }
 
+#if PL_API_VER >= 159
+// The compiled shaders are kept on disk across runs, as compiling them can
+// take a noticeable time before the first frame. One file is used per GPU
+// provider; libplacebo and the drivers ignore entries they cannot use.
+#define SHADER_CACHE_MAX_SIZE (64 << 20)
+
+static char *GetShaderCachePath(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+    char *dir = config_GetUserDir(VLC_CACHE_DIR);
+    if (dir == NULL)
+        return NULL;
+
+    char *path;
+    if (asprintf(&path, "%s" DIR_SEP "libplacebo-%s.cache", dir,
+                 module_get_object(sys->pl->module)) < 0)
+        path = NULL;
+    free(dir);
+    return path;
+}
+
+static void LoadShaderCache(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+    char *path = GetShaderCachePath(vd);
+    if (path == NULL)
+        return;
+
+    FILE *file = vlc_fopen(path, "rb");
+    free(path);
+    if (file == NULL)
+        return;
+
+    long size;
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0
+     && size <= SHADER_CACHE_MAX_SIZE && fseek(file, 0, SEEK_SET) == 0) {
+        uint8_t *data = malloc(size);
+        if (data != NULL && fread(data, size, 1, file) == 1) {
+            pl_renderer_load(sys->renderer, data);
+            msg_Dbg(vd, "loaded %ld bytes of cached shaders", size);
+        }
+        free(data);
+    }
+    fclose(file);
+}
+
+static void SaveShaderCache(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+    size_t size = pl_renderer_save(sys->renderer, NULL);
+    if (size == 0 || size > SHADER_CACHE_MAX_SIZE)
+        return;
+
+    uint8_t *data = malloc(size);
+    if (data == NULL)
+        return;
+    pl_renderer_save(sys->renderer, data);
+
+    char *dir = config_GetUserDir(VLC_CACHE_DIR);
+    char *path = GetShaderCachePath(vd);
+    char *tmp = NULL;
+    if (dir == NULL || path == NULL
+     || asprintf(&tmp, "%s.tmp%"PRIu32, path, (uint32_t)getpid()) < 0) {
+        tmp = NULL;
+        goto end;
+    }
+
+    vlc_mkdir(dir, 0700);
+
+    // Write to a temporary file, so that other instances never load a
+    // partial cache
+    FILE *file = vlc_fopen(tmp, "wb");
+    if (file == NULL)
+        goto end;
+
+    bool ok = fwrite(data, size, 1, file) == 1;
+    if (fclose(file) != 0 || !ok || vlc_rename(tmp, path) != 0)
+        vlc_unlink(tmp);
+
+end:
+    free(tmp);
+    free(path);
+    free(dir);
+    free(data);
+}
+#endif
+
 static void PictureRender(vout_display_t *vd, picture_t *pic,
                           subpicture_t *subpicture, mtime_t date)
 {
@@ -235,18 +344,6 @@ static void PictureRender(vout_display_t *vd, picture_t *pic,
     if (vlc_placebo_MakeCurrent(sys->pl) != VLC_SUCCESS)
         return;
 
-    struct pl_swapchain_frame frame;
-    if (!pl_swapchain_start_frame(sys->pl->swapchain, &frame)) {
-        vlc_placebo_ReleaseCurrent(sys->pl);
-        return; // Probably benign error, ignore it
-    }
-
-#if PL_API_VER >= 199
-    bool need_vflip = false;
-#else
-    bool need_vflip = frame.flipped;
-#endif
-
     struct pl_image img = {
         .num_planes = pic->i_planes,
         .color      = vlc_placebo_ColorSpace(vd->fmt),
@@ -270,12 +367,15 @@ static void PictureRender(vout_display_t *vd, picture_t *pic,
         assert(!"Failed processing the picture_t into pl_plane_data!?");
     }
 
+    const struct pl_tex **plane_tex = sys->plane_tex[sys->plane_tex_set];
+    sys->plane_tex_set = (sys->plane_tex_set + 1) % PLANE_TEX_SETS;
+
     for (int i = 0; i < pic->i_planes; i++) {
         struct pl_plane *plane = &img.planes[i];
-        if (!pl_upload_plane(gpu, plane, &sys->plane_tex[i], &data[i])) {
+        if (!pl_upload_plane(gpu, plane, &plane_tex[i], &data[i])) {
             msg_Err(vd, "Failed uploading image data!");
             failed = true;
-            goto done;
+            break;
         }
 
         // Matches only the chroma planes, never luma or alpha
@@ -284,6 +384,25 @@ static void PictureRender(vout_display_t *vd, picture_t *pic,
                                       &plane->shift_y);
     }
 
+    // Submit the uploads right away, so that they run while waiting for the
+    // next swapchain image and recording the rendering commands
+    pl_gpu_flush(gpu);
+
+    struct pl_swapchain_frame frame;
+    if (!pl_swapchain_start_frame(sys->pl->swapchain, &frame)) {
+        vlc_placebo_ReleaseCurrent(sys->pl);
+        return; // Probably benign error, ignore it
+    }
+
+#if PL_API_VER >= 199
+    bool need_vflip = false;
+#else
+    bool need_vflip = frame.flipped;
+#endif
+
+    if (failed)
+        goto done;
+
     struct pl_render_target target;
     pl_render_target_from_swapchain(&target, &frame);
 
@@ -118,6 +118,9 @@ vlc_gl_api_Init(struct vlc_gl_api *api, vlc_gl_t *gl)
     GET_PROC_ADDR(LinkProgram);
     GET_PROC_ADDR(UseProgram);
     GET_PROC_ADDR(DeleteProgram);
+    GET_PROC_ADDR_OPTIONAL(GetProgramBinary);
+    GET_PROC_ADDR_OPTIONAL(ProgramBinary);
+    GET_PROC_ADDR_OPTIONAL(ProgramParameteri);
 
     GET_PROC_ADDR(ActiveTexture);
 
@@ -168,6 +171,22 @@ vlc_gl_api_Init(struct vlc_gl_api *api, vlc_gl_t *gl)
     while (error != GL_NO_ERROR)
         error = api->vt.GetError();
 
+    /* OpenGL >= 4.1 or GL_ARB_get_program_binary, OpenGL ES >= 3.0: the
+     * functions may be resolved while not supported, and the driver may not
+     * support any binary format anyway. */
+    GLint binary_formats = 0;
+    if (api->vt.GetProgramBinary != NULL && api->vt.ProgramBinary != NULL)
+    {
+        api->vt.GetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binary_formats);
+        while (api->vt.GetError() != GL_NO_ERROR)
+            binary_formats = 0;
+    }
+    if (binary_formats <= 0)
+    {
+        api->vt.GetProgramBinary = NULL;
+        api->vt.ProgramBinary = NULL;
+    }
+
     struct vlc_gl_extension_vt extension_vt;
     vlc_gl_LoadExtensionFunctions(gl, &extension_vt);
 
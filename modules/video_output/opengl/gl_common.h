@@ -104,6 +104,16 @@
 # define GL_DYNAMIC_DRAW 0x88E8
 #endif
 
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+# define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+# define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+# define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
 #ifndef GL_READ_FRAMEBUFFER
 # define GL_READ_FRAMEBUFFER 0x8CA8
 #endif
@@ -172,6 +182,34 @@
 # define GL_NUM_EXTENSIONS 0x821D
 #endif
 
+#if !defined(GL_MAP_WRITE_BIT)
+# define GL_MAP_WRITE_BIT 0x0002
+#endif
+
+#if !defined(GL_MAP_PERSISTENT_BIT)
+# define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+
+#if !defined(GL_MAP_COHERENT_BIT)
+# define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+#if !defined(GL_SYNC_GPU_COMMANDS_COMPLETE)
+# define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+
+#if !defined(GL_SYNC_FLUSH_COMMANDS_BIT)
+# define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+
+#if !defined(GL_TIMEOUT_EXPIRED)
+# define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+
+#if !defined(GL_WAIT_FAILED)
+# define GL_WAIT_FAILED 0x911D
+#endif
+
 #ifndef APIENTRY
 # define APIENTRY
 #endif
@@ -294,6 +332,9 @@ typedef void (APIENTRY *PFNGLDELETESYNCPROC) (GLsync sync);
 typedef GLenum (APIENTRY *PFNGLCLIENTWAITSYNCPROC) (GLsync sync, GLbitfield flags, GLuint64 timeout);
 typedef void *(APIENTRY *PFNGLMAPBUFFERPROC)(GLenum, GLbitfield);
 typedef const GLubyte *(APIENTRY *PFNGLGETSTRINGIPROC) (GLenum name, GLint i);
+typedef void (APIENTRY *PFNGLGETPROGRAMBINARYPROC) (GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRY *PFNGLPROGRAMBINARYPROC) (GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRY *PFNGLPROGRAMPARAMETERIPROC) (GLuint program, GLenum pname, GLint value);
 #endif
 
 /**
@@ -367,6 +408,9 @@ typedef struct {
     PFNGLLINKPROGRAMPROC   LinkProgram;
     PFNGLUSEPROGRAMPROC    UseProgram;
     PFNGLDELETEPROGRAMPROC DeleteProgram;
+    PFNGLGETPROGRAMBINARYPROC  GetProgramBinary; /* can be NULL */
+    PFNGLPROGRAMBINARYPROC     ProgramBinary; /* can be NULL */
+    PFNGLPROGRAMPARAMETERIPROC ProgramParameteri; /* can be NULL */
 
     /* Texture commands */
     PFNGLACTIVETEXTUREPROC ActiveTexture;
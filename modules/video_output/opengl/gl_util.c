@@ -25,8 +25,19 @@
 
 #include "gl_util.h"
 
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <vlc_configuration.h>
 #include <vlc_filter.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
 #include <vlc_modules.h>
+#include <vlc_strings.h>
+
+/* Larger program binaries are not worth caching */
+#define PROGRAM_CACHE_MAX_SIZE (4 << 20)
 
 static void
 LogShaderErrors(vlc_object_t *obj, const opengl_vtable_t *vt, GLuint id)
@@ -89,6 +100,160 @@ CreateShader(vlc_object_t *obj, const opengl_vtable_t *vt, GLenum type,
     return shader;
 }
 
+static void
+HashString(vlc_hash_md5_t *md5, const char *str)
+{
+    if (str == NULL)
+        str = "";
+    /* include the terminating NUL to separate the strings */
+    vlc_hash_md5_Update(md5, str, strlen(str) + 1);
+}
+
+/**
+ * Returns the path of the cached binary of a program, unique for the shader
+ * sources and the driver which would compile them.
+ */
+static char *
+GetProgramCachePath(const opengl_vtable_t *vt,
+                    GLsizei vstring_count, const GLchar **vstrings,
+                    GLsizei fstring_count, const GLchar **fstrings)
+{
+    vlc_hash_md5_t md5;
+    vlc_hash_md5_Init(&md5);
+
+    HashString(&md5, (const char *)vt->GetString(GL_VENDOR));
+    HashString(&md5, (const char *)vt->GetString(GL_RENDERER));
+    HashString(&md5, (const char *)vt->GetString(GL_VERSION));
+
+    for (GLsizei i = 0; i < vstring_count; ++i)
+        vlc_hash_md5_Update(&md5, vstrings[i], strlen(vstrings[i]));
+    vlc_hash_md5_Update(&md5, "", 1);
+    for (GLsizei i = 0; i < fstring_count; ++i)
+        vlc_hash_md5_Update(&md5, fstrings[i], strlen(fstrings[i]));
+
+    char hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_FinishHex(&md5, hash);
+
+    char *dir = config_GetUserDir(VLC_CACHE_DIR);
+    if (dir == NULL)
+        return NULL;
+
+    char *path;
+    if (asprintf(&path, "%s" DIR_SEP "glshaders" DIR_SEP "%s", dir, hash) < 0)
+        path = NULL;
+    free(dir);
+    return path;
+}
+
+static GLuint
+LoadCachedProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
+                  const char *path)
+{
+    FILE *file = vlc_fopen(path, "rb");
+    if (file == NULL)
+        return 0;
+
+    GLuint program = 0;
+    uint32_t format;
+    void *binary = NULL;
+    long size;
+
+    if (fread(&format, sizeof (format), 1, file) != 1
+     || fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0
+     || size <= (long)sizeof (format) || size > PROGRAM_CACHE_MAX_SIZE
+     || fseek(file, sizeof (format), SEEK_SET) != 0)
+        goto end;
+
+    size -= sizeof (format);
+    binary = malloc(size);
+    if (binary == NULL || fread(binary, size, 1, file) != 1)
+        goto end;
+
+    program = vt->CreateProgram();
+    if (!program)
+        goto end;
+
+    vt->ProgramBinary(program, format, binary, size);
+
+    GLint linked;
+    vt->GetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        /* The driver rejects the binary, e.g. after an update: rebuild it */
+        msg_Dbg(obj, "discarding cached program %s", path);
+        vt->DeleteProgram(program);
+        program = 0;
+        while (vt->GetError() != GL_NO_ERROR);
+    }
+
+end:
+    free(binary);
+    fclose(file);
+    if (!program)
+        vlc_unlink(path);
+    return program;
+}
+
+static void
+SaveCachedProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
+                  GLuint program, const char *path)
+{
+    GLint size = 0;
+    vt->GetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0 || size > PROGRAM_CACHE_MAX_SIZE)
+        return;
+
+    void *binary = malloc(size);
+    if (binary == NULL)
+        return;
+
+    GLenum format;
+    GLsizei length = 0;
+    vt->GetProgramBinary(program, size, &length, &format, binary);
+    if (length <= 0)
+        goto end;
+
+    /* Create the cache directory (and its parent) if needed */
+    char *dir = strdup(path);
+    if (dir == NULL)
+        goto end;
+    char *sep = strrchr(dir, DIR_SEP_CHAR);
+    *sep = '\0';
+    sep = strrchr(dir, DIR_SEP_CHAR);
+    if (sep != NULL)
+    {
+        *sep = '\0';
+        vlc_mkdir(dir, 0700);
+        *sep = DIR_SEP_CHAR;
+    }
+    int ret = vlc_mkdir(dir, 0700);
+    free(dir);
+    if (ret != 0 && errno != EEXIST)
+        goto end;
+
+    /* Write to a temporary file first, so that other instances never read
+     * a partial binary */
+    char *tmp;
+    if (asprintf(&tmp, "%s.tmp%"PRIu32, path, (uint32_t)getpid()) < 0)
+        goto end;
+
+    FILE *file = vlc_fopen(tmp, "wb");
+    if (file != NULL)
+    {
+        uint32_t fmt = format;
+        bool ok = fwrite(&fmt, sizeof (fmt), 1, file) == 1
+               && fwrite(binary, length, 1, file) == 1;
+
+        if (fclose(file) == 0 && ok && vlc_rename(tmp, path) == 0)
+            msg_Dbg(obj, "cached program %s", path);
+        else
+            vlc_unlink(tmp);
+    }
+    free(tmp);
+
+end:
+    free(binary);
+}
 
 GLuint
 vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
@@ -96,11 +261,27 @@ vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
                     GLsizei fstring_count, const GLchar **fstrings)
 {
     GLuint program = 0;
+    char *cache_path = NULL;
+
+    if (vt->GetProgramBinary != NULL && vt->ProgramBinary != NULL)
+    {
+        cache_path = GetProgramCachePath(vt, vstring_count, vstrings,
+                                         fstring_count, fstrings);
+        if (cache_path != NULL)
+        {
+            program = LoadCachedProgram(obj, vt, cache_path);
+            if (program)
+            {
+                free(cache_path);
+                return program;
+            }
+        }
+    }
 
     GLuint vertex_shader = CreateShader(obj, vt, GL_VERTEX_SHADER,
                                         vstring_count, vstrings);
     if (!vertex_shader)
-        return 0;
+        goto finally_0;
 
     GLuint fragment_shader = CreateShader(obj, vt, GL_FRAGMENT_SHADER,
                                           fstring_count, fstrings);
@@ -114,6 +295,10 @@ vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
     vt->AttachShader(program, vertex_shader);
     vt->AttachShader(program, fragment_shader);
 
+    if (cache_path != NULL && vt->ProgramParameteri != NULL)
+        vt->ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                              GL_TRUE);
+
     vt->LinkProgram(program);
 
     LogProgramErrors(obj, vt, program);
@@ -126,11 +311,15 @@ vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
         vt->DeleteProgram(program);
         program = 0;
     }
+    else if (cache_path != NULL)
+        SaveCachedProgram(obj, vt, program, cache_path);
 
 finally_2:
     vt->DeleteShader(fragment_shader);
 finally_1:
     vt->DeleteShader(vertex_shader);
+finally_0:
+    free(cache_path);
 
     return program;
 }
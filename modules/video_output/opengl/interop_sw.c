@@ -32,6 +32,7 @@
 #include "gl_util.h"
 
 #define PBO_DISPLAY_COUNT 2 /* Double buffering */
+#define PERSISTENT_COUNT 3 /* Slots in flight: upload, render, display */
 typedef struct
 {
     PFNGLDELETEBUFFERSPROC DeleteBuffers;
@@ -49,6 +50,23 @@ struct priv
         size_t display_idx;
     } pbo;
 
+    /* Persistently mapped upload ring (GL_ARB_buffer_storage) */
+    struct {
+        GLuint buffers[PERSISTENT_COUNT];
+        uint8_t *maps[PERSISTENT_COUNT];
+        GLsync fences[PERSISTENT_COUNT];
+        size_t size;
+        size_t idx;
+        bool failed;
+
+        PFNGLBUFFERSTORAGEPROC  BufferStorage;
+        PFNGLMAPBUFFERRANGEPROC MapBufferRange;
+        PFNGLUNMAPBUFFERPROC    UnmapBuffer;
+        PFNGLFENCESYNCPROC      FenceSync;
+        PFNGLDELETESYNCPROC     DeleteSync;
+        PFNGLCLIENTWAITSYNCPROC ClientWaitSync;
+    } persistent;
+
 #define OPENGL_VTABLE_F(X) \
         X(PFNGLGETERRORPROC,        GetError) \
         X(PFNGLGETINTEGERVPROC,     GetIntegerv) \
@@ -214,6 +232,153 @@ tc_pbo_update(const struct vlc_gl_interop *interop, uint32_t textures[],
     return VLC_SUCCESS;
 }
 
+static int
+tc_common_update(const struct vlc_gl_interop *interop, uint32_t textures[],
+                 const int32_t tex_width[], const int32_t tex_height[],
+                 picture_t *pic, const size_t *plane_offset);
+
+static void
+persistent_wait(struct priv *priv, size_t idx)
+{
+    GLsync fence = priv->persistent.fences[idx];
+    if (fence == NULL)
+        return;
+
+    /* The slot is written again only once the GPU is done reading it. With
+     * three slots in flight, this normally returns immediately. */
+    GLenum ret;
+    do
+        ret = priv->persistent.ClientWaitSync(fence,
+                                              GL_SYNC_FLUSH_COMMANDS_BIT,
+                                              UINT64_C(100000000));
+    while (ret == GL_TIMEOUT_EXPIRED);
+
+    priv->persistent.DeleteSync(fence);
+    priv->persistent.fences[idx] = NULL;
+}
+
+static void
+persistent_release(struct priv *priv)
+{
+    if (priv->persistent.size == 0)
+        return;
+
+    for (size_t i = 0; i < PERSISTENT_COUNT; i++)
+    {
+        persistent_wait(priv, i);
+        if (priv->persistent.maps[i] != NULL)
+        {
+            priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER,
+                                priv->persistent.buffers[i]);
+            priv->persistent.UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            priv->persistent.maps[i] = NULL;
+        }
+    }
+    priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    priv->gl.DeleteBuffers(PERSISTENT_COUNT, priv->persistent.buffers);
+    priv->persistent.size = 0;
+}
+
+static int
+persistent_alloc(const struct vlc_gl_interop *interop, size_t size)
+{
+    struct priv *priv = interop->priv;
+    const GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    persistent_release(priv);
+
+    priv->gl.GetError();
+    priv->gl.GenBuffers(PERSISTENT_COUNT, priv->persistent.buffers);
+    priv->persistent.size = size;
+
+    for (size_t i = 0; i < PERSISTENT_COUNT; i++)
+    {
+        priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER,
+                            priv->persistent.buffers[i]);
+        priv->persistent.BufferStorage(GL_PIXEL_UNPACK_BUFFER, size, NULL,
+                                       flags);
+        priv->persistent.maps[i] =
+            priv->persistent.MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                            flags);
+
+        if (priv->persistent.maps[i] == NULL
+         || priv->gl.GetError() != GL_NO_ERROR)
+        {
+            msg_Err(interop->gl, "could not map persistent buffers");
+            persistent_release(priv);
+            return VLC_EGENERIC;
+        }
+    }
+
+    priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    priv->persistent.idx = 0;
+    return VLC_SUCCESS;
+}
+
+static int
+tc_persistent_update(const struct vlc_gl_interop *interop, uint32_t textures[],
+                     const int32_t tex_width[], const int32_t tex_height[],
+                     picture_t *pic, const size_t *plane_offset)
+{
+    struct priv *priv = interop->priv;
+    size_t offsets[PICTURE_PLANE_MAX];
+    size_t size = 0;
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        /* Keep every plane suitably aligned for any texel format */
+        offsets[i] = size;
+        size += vlc_align((size_t)pic->p[i].i_lines * pic->p[i].i_pitch, 64);
+    }
+
+    if (size > priv->persistent.size && !priv->persistent.failed
+     && persistent_alloc(interop, size) != VLC_SUCCESS)
+        priv->persistent.failed = true;
+
+    if (priv->persistent.failed)
+        return tc_common_update(interop, textures, tex_width, tex_height,
+                                pic, plane_offset);
+
+    const size_t idx = priv->persistent.idx;
+    priv->persistent.idx = (idx + 1) % PERSISTENT_COUNT;
+    persistent_wait(priv, idx);
+
+    uint8_t *map = priv->persistent.maps[idx];
+    priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, priv->persistent.buffers[idx]);
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        const uint8_t *pixels = pic->p[i].p_pixels;
+        if (plane_offset != NULL)
+            pixels += plane_offset[i];
+
+        memcpy(map + offsets[i], pixels,
+               (size_t)pic->p[i].i_lines * pic->p[i].i_pitch);
+
+        priv->gl.ActiveTexture(GL_TEXTURE0 + i);
+        priv->gl.BindTexture(interop->tex_target, textures[i]);
+
+        priv->gl.PixelStorei(GL_UNPACK_ROW_LENGTH, pic->p[i].i_pitch
+            * tex_width[i] / (pic->p[i].i_visible_pitch ? pic->p[i].i_visible_pitch : 1));
+
+        priv->gl.TexSubImage2D(interop->tex_target, 0, 0, 0, tex_width[i], tex_height[i],
+                               interop->texs[i].format, interop->texs[i].type,
+                               (const GLvoid *)(uintptr_t)offsets[i]);
+        priv->gl.PixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+
+    /* The mapping is coherent: the fence only tracks when the texture
+     * uploads have consumed the slot. */
+    priv->persistent.fences[idx] =
+        priv->persistent.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    /* turn off pbo */
+    priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    return VLC_SUCCESS;
+}
+
 static int
 tc_common_allocate_textures(const struct vlc_gl_interop *interop, uint32_t textures[],
                             const int32_t tex_width[], const int32_t tex_height[])
@@ -313,6 +478,7 @@ void
 opengl_interop_generic_deinit(struct vlc_gl_interop *interop)
 {
     struct priv *priv = interop->priv;
+    persistent_release(priv);
     for (size_t i = 0; i < PBO_DISPLAY_COUNT && priv->pbo.display_pics[i]; ++i)
         picture_Release(priv->pbo.display_pics[i]);
     free(priv->texture_temp_buf);
@@ -428,7 +594,49 @@ interop_init:
 
         const bool supports_pbo = has_pbo && priv->gl.BufferData
             && priv->gl.BufferSubData;
-        if (supports_pbo && pbo_pics_alloc(interop) == VLC_SUCCESS)
+
+        /* Persistent mapping: OpenGL 4.4, or the buffer storage extension
+         * (with sync objects from OpenGL 3.2 / OpenGL ES 3.0) */
+        const bool has_storage = has_pbo &&
+            ((interop->gl->api_type == VLC_OPENGL &&
+              strverscmp((const char *)ogl_version, "4.4") >= 0) ||
+             vlc_gl_HasExtension(&extension_vt, "GL_ARB_buffer_storage") ||
+             vlc_gl_HasExtension(&extension_vt, "GL_EXT_buffer_storage"));
+
+        if (has_storage)
+        {
+#define LOAD_PERSISTENT_SYMBOL(name) \
+    priv->persistent.name = vlc_gl_GetProcAddress(interop->gl, "gl" # name);
+
+            LOAD_PERSISTENT_SYMBOL(BufferStorage);
+            LOAD_PERSISTENT_SYMBOL(MapBufferRange);
+            LOAD_PERSISTENT_SYMBOL(UnmapBuffer);
+            LOAD_PERSISTENT_SYMBOL(FenceSync);
+            LOAD_PERSISTENT_SYMBOL(DeleteSync);
+            LOAD_PERSISTENT_SYMBOL(ClientWaitSync);
+            if (priv->persistent.BufferStorage == NULL)
+                /* GLES only exposes the extension entry point */
+                priv->persistent.BufferStorage =
+                    vlc_gl_GetProcAddress(interop->gl, "glBufferStorageEXT");
+#undef LOAD_PERSISTENT_SYMBOL
+        }
+
+        if (has_storage && priv->persistent.BufferStorage
+         && priv->persistent.MapBufferRange && priv->persistent.UnmapBuffer
+         && priv->persistent.FenceSync && priv->persistent.DeleteSync
+         && priv->persistent.ClientWaitSync)
+        {
+            /* The ring is sized on the first picture, whose pitches are
+             * not known yet. */
+            static const struct vlc_gl_interop_ops persistent_ops = {
+                .allocate_textures = tc_common_allocate_textures,
+                .update_textures = tc_persistent_update,
+                .close = opengl_interop_generic_deinit,
+            };
+            interop->ops = &persistent_ops;
+            msg_Dbg(interop->gl, "persistent PBO support enabled");
+        }
+        else if (supports_pbo && pbo_pics_alloc(interop) == VLC_SUCCESS)
         {
             static const struct vlc_gl_interop_ops pbo_ops = {
                 .allocate_textures = tc_common_allocate_textures,
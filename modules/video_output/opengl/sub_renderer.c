@@ -41,11 +41,23 @@
 #include "interop.h"
 #include "vout_helper.h"
 
+/* Texture sizes are rounded up, so that regions of slightly different sizes,
+ * such as successive subtitle lines, can share the same textures */
+#define SUB_TEXTURE_ALIGN 64
+/* Maximum number of unused textures kept for the next regions */
+#define SUB_TEXTURE_POOL 16
+
 typedef struct {
     GLuint   texture;
     GLsizei  width;
     GLsizei  height;
 
+    /* Source of the texture content, held to detect unchanged regions */
+    picture_t *picture;
+    size_t   pixels_offset;
+    GLsizei  visible_width;
+    GLsizei  visible_height;
+
     float    alpha;
 
     float    top;
@@ -68,6 +80,13 @@ struct vlc_gl_sub_renderer
     gl_region_t *regions;
     unsigned region_count;
 
+    struct {
+        GLuint  texture;
+        GLsizei width;
+        GLsizei height;
+    } pool[SUB_TEXTURE_POOL];
+    unsigned pool_count;
+
     GLuint program_id;
     struct {
         GLint vertex_pos;
@@ -133,6 +152,7 @@ vlc_gl_sub_renderer_New(vlc_gl_t *gl, const struct vlc_gl_api *api,
     sr->vt = vt;
     sr->region_count = 0;
     sr->regions = NULL;
+    sr->pool_count = 0;
 
     static const char *const VERTEX_SHADER_SRC =
 #if defined(USE_OPENGL_ES2)
@@ -206,12 +226,47 @@ vlc_gl_sub_renderer_Delete(struct vlc_gl_sub_renderer *sr)
     {
         if (sr->regions[i].texture)
             sr->vt->DeleteTextures(1, &sr->regions[i].texture);
+        if (sr->regions[i].picture)
+            picture_Release(sr->regions[i].picture);
     }
     free(sr->regions);
 
+    for (unsigned i = 0; i < sr->pool_count; ++i)
+        sr->vt->DeleteTextures(1, &sr->pool[i].texture);
+
     free(sr);
 }
 
+static GLuint
+PoolGet(struct vlc_gl_sub_renderer *sr, GLsizei width, GLsizei height)
+{
+    for (unsigned i = 0; i < sr->pool_count; i++)
+        if (sr->pool[i].width == width && sr->pool[i].height == height) {
+            GLuint texture = sr->pool[i].texture;
+            sr->pool[i] = sr->pool[--sr->pool_count];
+            return texture;
+        }
+    return 0;
+}
+
+static void
+PoolPut(struct vlc_gl_sub_renderer *sr, GLuint *texture, GLsizei width,
+        GLsizei height)
+{
+    if (sr->pool_count == SUB_TEXTURE_POOL) {
+        /* Evict the oldest texture */
+        vlc_gl_interop_DeleteTextures(sr->interop, &sr->pool[0].texture);
+        memmove(&sr->pool[0], &sr->pool[1],
+                (SUB_TEXTURE_POOL - 1) * sizeof (sr->pool[0]));
+        sr->pool_count--;
+    }
+    sr->pool[sr->pool_count].texture = *texture;
+    sr->pool[sr->pool_count].width = width;
+    sr->pool[sr->pool_count].height = height;
+    sr->pool_count++;
+    *texture = 0;
+}
+
 int
 vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpicture)
 {
@@ -239,23 +294,51 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpic
              r; r = r->p_next, i++) {
             gl_region_t *glr = &sr->regions[i];
 
-            glr->width  = r->fmt.i_visible_width;
-            glr->height = r->fmt.i_visible_height;
+            /* Only the visible area of the texture is uploaded and drawn */
             if (!sr->api->supports_npot) {
-                glr->width  = vlc_align_pot(glr->width);
-                glr->height = vlc_align_pot(glr->height);
-                glr->tex_width  = (float) r->fmt.i_visible_width  / glr->width;
-                glr->tex_height = (float) r->fmt.i_visible_height / glr->height;
+                glr->width  = vlc_align_pot(r->fmt.i_visible_width);
+                glr->height = vlc_align_pot(r->fmt.i_visible_height);
             } else {
-                glr->tex_width  = 1.0;
-                glr->tex_height = 1.0;
+                glr->width  = vlc_align(r->fmt.i_visible_width,
+                                        SUB_TEXTURE_ALIGN);
+                glr->height = vlc_align(r->fmt.i_visible_height,
+                                        SUB_TEXTURE_ALIGN);
             }
+            glr->tex_width  = (float) r->fmt.i_visible_width  / glr->width;
+            glr->tex_height = (float) r->fmt.i_visible_height / glr->height;
             glr->alpha  = (float)subpicture->i_alpha * r->i_alpha / 255 / 255;
             glr->left   =  2.0 * (r->i_x                          ) / subpicture->i_original_picture_width  - 1.0;
             glr->top    = -2.0 * (r->i_y                          ) / subpicture->i_original_picture_height + 1.0;
             glr->right  =  2.0 * (r->i_x + r->fmt.i_visible_width ) / subpicture->i_original_picture_width  - 1.0;
             glr->bottom = -2.0 * (r->i_y + r->fmt.i_visible_height) / subpicture->i_original_picture_height + 1.0;
 
+            const size_t pixels_offset =
+                r->fmt.i_y_offset * r->p_picture->p->i_pitch +
+                r->fmt.i_x_offset * r->p_picture->p->i_pixel_pitch;
+
+            /* The region pictures are read-only once rendered by the SPU: if
+               the previous call uploaded the same picture area, reuse its
+               texture as is. The picture is held, so that its address
+               cannot be recycled meanwhile. */
+            bool uploaded = false;
+            for (int j = 0; j < last_count; j++) {
+                if (last[j].texture &&
+                    last[j].picture        == r->p_picture &&
+                    last[j].pixels_offset  == pixels_offset &&
+                    last[j].visible_width  == (GLsizei) r->fmt.i_visible_width &&
+                    last[j].visible_height == (GLsizei) r->fmt.i_visible_height &&
+                    last[j].width  == glr->width &&
+                    last[j].height == glr->height) {
+                    glr->texture = last[j].texture;
+                    glr->picture = last[j].picture;
+                    memset(&last[j], 0, sizeof(last[j]));
+                    uploaded = true;
+                    break;
+                }
+            }
+            if (uploaded)
+                continue;
+
             glr->texture = 0;
             /* Try to recycle the textures allocated by the previous
                call to this function. */
@@ -264,14 +347,17 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpic
                     last[j].width  == glr->width &&
                     last[j].height == glr->height) {
                     glr->texture = last[j].texture;
+                    if (last[j].picture)
+                        picture_Release(last[j].picture);
                     memset(&last[j], 0, sizeof(last[j]));
                     break;
                 }
             }
 
-            const size_t pixels_offset =
-                r->fmt.i_y_offset * r->p_picture->p->i_pitch +
-                r->fmt.i_x_offset * r->p_picture->p->i_pixel_pitch;
+            /* Or a texture left unused by earlier calls. */
+            if (!glr->texture)
+                glr->texture = PoolGet(sr, glr->width, glr->height);
+
             if (!glr->texture)
             {
                 /* Could not recycle a previous texture, generate a new one. */
@@ -292,6 +378,11 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpic
                                                     r->p_picture, &pixels_offset);
             if (ret != VLC_SUCCESS)
                 break;
+
+            glr->picture        = picture_Hold(r->p_picture);
+            glr->pixels_offset  = pixels_offset;
+            glr->visible_width  = r->fmt.i_visible_width;
+            glr->visible_height = r->fmt.i_visible_height;
         }
     }
     else
@@ -300,9 +391,12 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpic
         sr->regions = NULL;
     }
 
+    /* Keep the textures of the vanished regions for the next ones */
     for (int i = 0; i < last_count; i++) {
         if (last[i].texture)
-            vlc_gl_interop_DeleteTextures(interop, &last[i].texture);
+            PoolPut(sr, &last[i].texture, last[i].width, last[i].height);
+        if (last[i].picture)
+            picture_Release(last[i].picture);
     }
     free(last);
 
@@ -89,6 +89,7 @@ typedef struct vout_display_sys_t {
     void (*unlock)(void *sys, void *id, void *const *plane);
     void (*display)(void *sys, void *id);
     void (*cleanup)(void *sys);
+    void (*frame)(void *sys, picture_t *pic);
 
     unsigned pitches[PICTURE_PLANE_MAX];
     unsigned lines[PICTURE_PLANE_MAX];
@@ -101,6 +102,8 @@ static void           Prepare(vout_display_t *, picture_t *, subpicture_t *, vlc
 static void           Display(vout_display_t *, picture_t *);
 static int            Control(vout_display_t *, int);
 
+static void           DisplayFrame(vout_display_t *, picture_t *);
+
 static const struct vlc_display_operations ops = {
     .close = Close,
     .prepare = Prepare,
@@ -108,6 +111,13 @@ static const struct vlc_display_operations ops = {
     .control = Control,
 };
 
+/* the pictures are passed to the application as they are, without copy */
+static const struct vlc_display_operations ops_frame = {
+    .close = Close,
+    .display = DisplayFrame,
+    .control = Control,
+};
+
 /*****************************************************************************
  * Open: allocates video thread
  *****************************************************************************
@@ -124,7 +134,8 @@ static int Open(vout_display_t *vd,
     vlc_format_cb setup = var_InheritAddress(vd, "vmem-setup");
 
     sys->lock = var_InheritAddress(vd, "vmem-lock");
-    if (sys->lock == NULL) {
+    sys->frame = var_InheritAddress(vd, "vmem-frame");
+    if (sys->lock == NULL && sys->frame == NULL) {
         msg_Err(vd, "missing lock callback");
         free(sys);
         return VLC_EGENERIC;
@@ -163,6 +174,13 @@ static int Open(vout_display_t *vd,
         fmt.i_width = widths[0];
         fmt.i_height = heights[0];
 
+    } else if (sys->frame != NULL) {
+        /* keep the decoder format, unless it can't be mapped in memory */
+        const vlc_chroma_description_t *desc =
+            vlc_fourcc_GetChromaDescription(fmt.i_chroma);
+        if (desc == NULL || desc->plane_count == 0)
+            fmt.i_chroma = VLC_CODEC_I420;
+        sys->cleanup = NULL;
     } else {
         char *chroma = var_InheritString(vd, "vmem-chroma");
         fmt.i_chroma = vlc_fourcc_GetCodecFromString(VIDEO_ES, chroma);
@@ -179,9 +197,13 @@ static int Open(vout_display_t *vd,
         }
         sys->cleanup = NULL;
     }
-    fmt.i_x_offset = fmt.i_y_offset = 0;
-    fmt.i_visible_width = fmt.i_width;
-    fmt.i_visible_height = fmt.i_height;
+    /* pass the decoded pictures without conversion if possible */
+    const bool keep_source = setup == NULL && sys->frame != NULL;
+    if (!keep_source) {
+        fmt.i_x_offset = fmt.i_y_offset = 0;
+        fmt.i_visible_width = fmt.i_width;
+        fmt.i_visible_height = fmt.i_height;
+    }
 
     if (!fmt.i_chroma) {
         msg_Err(vd, "vmem-chroma should be 4 characters long");
@@ -190,36 +212,39 @@ static int Open(vout_display_t *vd,
     }
 
     /* Define the bitmasks */
-    switch (fmt.i_chroma)
+    if (!keep_source)
     {
-    case VLC_CODEC_RGB15:
-        fmt.i_rmask = 0x001f;
-        fmt.i_gmask = 0x03e0;
-        fmt.i_bmask = 0x7c00;
-        break;
-    case VLC_CODEC_RGB16:
-        fmt.i_rmask = 0x001f;
-        fmt.i_gmask = 0x07e0;
-        fmt.i_bmask = 0xf800;
-        break;
-    case VLC_CODEC_RGB24:
-    case VLC_CODEC_RGB32:
-        fmt.i_rmask = 0xff0000;
-        fmt.i_gmask = 0x00ff00;
-        fmt.i_bmask = 0x0000ff;
-        break;
-    default:
-        fmt.i_rmask = 0;
-        fmt.i_gmask = 0;
-        fmt.i_bmask = 0;
-        break;
+        switch (fmt.i_chroma)
+        {
+        case VLC_CODEC_RGB15:
+            fmt.i_rmask = 0x001f;
+            fmt.i_gmask = 0x03e0;
+            fmt.i_bmask = 0x7c00;
+            break;
+        case VLC_CODEC_RGB16:
+            fmt.i_rmask = 0x001f;
+            fmt.i_gmask = 0x07e0;
+            fmt.i_bmask = 0xf800;
+            break;
+        case VLC_CODEC_RGB24:
+        case VLC_CODEC_RGB32:
+            fmt.i_rmask = 0xff0000;
+            fmt.i_gmask = 0x00ff00;
+            fmt.i_bmask = 0x0000ff;
+            break;
+        default:
+            fmt.i_rmask = 0;
+            fmt.i_gmask = 0;
+            fmt.i_bmask = 0;
+            break;
+        }
     }
 
     /* */
     *fmtp = fmt;
 
     vd->sys     = sys;
-    vd->ops     = &ops;
+    vd->ops     = sys->frame != NULL ? &ops_frame : &ops;
 
     (void) context;
     return VLC_SUCCESS;
@@ -271,6 +296,14 @@ static void Display(vout_display_t *vd, picture_t *pic)
         sys->display(sys->opaque, sys->pic_opaque);
 }
 
+static void DisplayFrame(vout_display_t *vd, picture_t *pic)
+{
+    vout_display_sys_t *sys = vd->sys;
+
+    /* released by the application */
+    sys->frame(sys->opaque, picture_Hold(pic));
+}
+
 static int Control(vout_display_t *vd, int query)
 {
     (void) vd;
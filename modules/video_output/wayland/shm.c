@@ -31,10 +31,12 @@
 
 #include <sys/types.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <wayland-client.h>
 #include "viewporter-client-protocol.h"
+#include "presentation-time-client-protocol.h"
 #include "registry.h"
 
 #include <vlc_common.h>
@@ -51,8 +53,11 @@ typedef struct vout_display_sys_t
     struct wl_shm *shm;
     struct wp_viewporter *viewporter;
     struct wp_viewport *viewport;
+    struct wp_presentation *presentation;
+    uint32_t presentation_clock;
 
     size_t active_buffers;
+    size_t active_feedbacks;
 } vout_display_sys_t;
 
 struct buffer_data
@@ -137,12 +142,75 @@ static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic,
     (void) subpic;
 }
 
+static void feedback_sync_output_cb(void *data,
+                                    struct wp_presentation_feedback *fb,
+                                    struct wl_output *output)
+{
+    (void) data; (void) fb; (void) output;
+}
+
+static void feedback_presented_cb(void *data,
+                                  struct wp_presentation_feedback *fb,
+                                  uint32_t tv_sec_hi, uint32_t tv_sec_lo,
+                                  uint32_t tv_nsec, uint32_t refresh,
+                                  uint32_t seq_hi, uint32_t seq_lo,
+                                  uint32_t flags)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+
+    /* The presentation clock must be the one of vlc_tick_now() */
+    if (sys->presentation_clock == CLOCK_MONOTONIC)
+    {
+        struct timespec ts = {
+            .tv_sec = ((uint64_t)tv_sec_hi << 32) | tv_sec_lo,
+            .tv_nsec = tv_nsec,
+        };
+
+        vout_display_SendEventVsync(vd, vlc_tick_from_timespec(&ts),
+                                    VLC_TICK_FROM_NS(refresh));
+    }
+
+    wp_presentation_feedback_destroy(fb);
+    sys->active_feedbacks--;
+    (void) seq_hi; (void) seq_lo; (void) flags;
+}
+
+static void feedback_discarded_cb(void *data,
+                                  struct wp_presentation_feedback *fb)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+
+    wp_presentation_feedback_destroy(fb);
+    sys->active_feedbacks--;
+}
+
+static const struct wp_presentation_feedback_listener feedback_cbs =
+{
+    feedback_sync_output_cb,
+    feedback_presented_cb,
+    feedback_discarded_cb,
+};
+
 static void Display(vout_display_t *vd, picture_t *pic)
 {
     vout_display_sys_t *sys = vd->sys;
     struct wl_display *display = sys->embed->display.wl;
     struct wl_surface *surface = sys->embed->handle.wl;
 
+    if (sys->presentation != NULL)
+    {
+        struct wp_presentation_feedback *fb =
+            wp_presentation_feedback(sys->presentation, surface);
+
+        if (fb != NULL)
+        {
+            wp_presentation_feedback_add_listener(fb, &feedback_cbs, vd);
+            sys->active_feedbacks++;
+        }
+    }
+
     wl_surface_commit(surface);
     wl_display_roundtrip_queue(display, sys->eventq);
 
@@ -230,6 +298,22 @@ static const struct wl_shm_listener shm_cbs =
     shm_format_cb,
 };
 
+static void presentation_clock_id_cb(void *data,
+                                     struct wp_presentation *presentation,
+                                     uint32_t clock)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+
+    sys->presentation_clock = clock;
+    (void) presentation;
+}
+
+static const struct wp_presentation_listener presentation_cbs =
+{
+    presentation_clock_id_cb,
+};
+
 static void Close(vout_display_t *vd)
 {
     vout_display_sys_t *sys = vd->sys;
@@ -240,7 +324,7 @@ static void Close(vout_display_t *vd)
     wl_surface_commit(surface);
 
     /* Wait until all picture buffers are released by the server */
-    while (sys->active_buffers > 0) {
+    while (sys->active_buffers > 0 || sys->active_feedbacks > 0) {
         msg_Dbg(vd, "%zu buffer(s) still active", sys->active_buffers);
         wl_display_roundtrip_queue(display, sys->eventq);
     }
@@ -250,6 +334,8 @@ static void Close(vout_display_t *vd)
         wp_viewport_destroy(sys->viewport);
     if (sys->viewporter != NULL)
         wp_viewporter_destroy(sys->viewporter);
+    if (sys->presentation != NULL)
+        wp_presentation_destroy(sys->presentation);
     wl_shm_destroy(sys->shm);
     wl_display_flush(display);
     wl_event_queue_destroy(sys->eventq);
@@ -278,7 +364,10 @@ static int Open(vout_display_t *vd,
     sys->embed = NULL;
     sys->eventq = NULL;
     sys->shm = NULL;
+    sys->presentation = NULL;
+    sys->presentation_clock = UINT32_MAX;
     sys->active_buffers = 0;
+    sys->active_feedbacks = 0;
 
     /* Get window */
     sys->embed = vd->cfg->window;
@@ -302,8 +391,13 @@ static int Open(vout_display_t *vd,
     sys->viewporter = (struct wp_viewporter *)
                       vlc_wl_interface_bind(registry, "wp_viewporter",
                                             &wp_viewporter_interface, NULL);
+    sys->presentation = (struct wp_presentation *)
+                        vlc_wl_interface_bind(registry, "wp_presentation",
+                                              &wp_presentation_interface, NULL);
 
     wl_shm_add_listener(sys->shm, &shm_cbs, vd);
+    if (sys->presentation != NULL)
+        wp_presentation_add_listener(sys->presentation, &presentation_cbs, vd);
     wl_display_roundtrip_queue(display, sys->eventq);
 
     struct wl_surface *surface = sys->embed->handle.wl;
@@ -344,6 +438,8 @@ static int Open(vout_display_t *vd,
     return VLC_SUCCESS;
 
 error:
+    if (sys->presentation != NULL)
+        wp_presentation_destroy(sys->presentation);
     if (sys->shm != NULL)
         wl_shm_destroy(sys->shm);
 
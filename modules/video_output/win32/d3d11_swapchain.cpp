@@ -177,6 +177,12 @@ void D3D11_LocalSwapchainSwap( void *opaque )
     DXGI_LocalSwapchainSwap( display->sys );
 }
 
+bool D3D11_LocalSwapchainGetVsync( void *opaque, vlc_tick_t *date, vlc_tick_t *period )
+{
+    d3d11_local_swapchain *display = static_cast<d3d11_local_swapchain *>(opaque);
+    return DXGI_LocalSwapchainGetVsync( display->sys, date, period );
+}
+
 void D3D11_LocalSwapchainSetMetadata( void *opaque, libvlc_video_metadata_type_t type, const void *metadata )
 {
     d3d11_local_swapchain *display = static_cast<d3d11_local_swapchain *>(opaque);
@@ -39,6 +39,7 @@ bool D3D11_LocalSwapchainStartEndRendering( void *opaque, bool enter );
 bool D3D11_LocalSwapchainSelectPlane( void *opaque, size_t plane, void *output );
 bool D3D11_LocalSwapchainWinstoreSize( void *opaque, uint32_t *, uint32_t * );
 void D3D11_LocalSwapchainSwap( void *opaque );
+bool D3D11_LocalSwapchainGetVsync( void *opaque, vlc_tick_t *date, vlc_tick_t *period );
 void D3D11_LocalSwapchainSetMetadata( void *opaque, libvlc_video_metadata_type_t, const void * );
 
 #endif /* VLC_D3D11_SWAPCHAIN_H */
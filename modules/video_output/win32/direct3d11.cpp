@@ -708,6 +708,13 @@ static void Display(vout_display_t *vd, picture_t *picture)
     d3d11_device_lock( sys->d3d_dev );
     sys->swapCb(sys->outside_opaque);
     d3d11_device_unlock( sys->d3d_dev );
+
+    if ( sys->swapCb == D3D11_LocalSwapchainSwap )
+    {
+        vlc_tick_t date, period;
+        if ( D3D11_LocalSwapchainGetVsync( sys->outside_opaque, &date, &period ) )
+            vout_display_SendEventVsync( vd, date, period );
+    }
 }
 
 static const d3d_format_t *GetDirectRenderingFormat(vout_display_t *vd, vlc_fourcc_t i_src_chroma)
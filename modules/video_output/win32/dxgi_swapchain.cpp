@@ -94,6 +94,10 @@ struct dxgi_swapchain
     DXGI_HDR_METADATA_HDR10 hdr10;
 
     bool                   logged_capabilities = false;
+
+    /* last frame statistics, to measure the refresh period */
+    UINT                    sync_refresh_count = 0;
+    LONGLONG                sync_qpc_time = 0;
 };
 
 DEFINE_GUID(GUID_SWAPCHAIN_WIDTH,  0xf1b59347, 0x1643, 0x411a, 0xad, 0x6b, 0xc7, 0x80, 0x17, 0x7a, 0x06, 0xb6);
@@ -375,6 +379,37 @@ void DXGI_LocalSwapchainSwap( dxgi_swapchain *display )
     }
 }
 
+bool DXGI_LocalSwapchainGetVsync( dxgi_swapchain *display, vlc_tick_t *date, vlc_tick_t *period )
+{
+    DXGI_FRAME_STATISTICS stats;
+    LARGE_INTEGER freq, now;
+
+    /* only available with flip model swap chains or in fullscreen */
+    if ( FAILED(display->dxgiswapChain->GetFrameStatistics( &stats )) )
+        return false;
+    if ( stats.SyncRefreshCount == display->sync_refresh_count )
+        return false;
+
+    QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &now );
+
+    /* the VLC clock may not be based on the performance counters */
+    *date = vlc_tick_now() - vlc_tick_from_frac( now.QuadPart - stats.SyncQPCTime.QuadPart,
+                                                freq.QuadPart );
+    if ( display->sync_refresh_count != 0 &&
+         stats.SyncRefreshCount > display->sync_refresh_count &&
+         stats.SyncQPCTime.QuadPart > display->sync_qpc_time )
+        *period = vlc_tick_from_frac( stats.SyncQPCTime.QuadPart - display->sync_qpc_time,
+                                      freq.QuadPart )
+                  / (stats.SyncRefreshCount - display->sync_refresh_count);
+    else
+        *period = 0;
+
+    display->sync_refresh_count = stats.SyncRefreshCount;
+    display->sync_qpc_time = stats.SyncQPCTime.QuadPart;
+    return true;
+}
+
 void DXGI_LocalSwapchainSetMetadata( dxgi_swapchain *display, libvlc_video_metadata_type_t type, const void *metadata )
 {
     assert(type == libvlc_video_metadata_frame_hdr10);
@@ -66,6 +66,7 @@ bool DXGI_UpdateSwapChain( struct dxgi_swapchain *, IDXGIAdapter *,
                            const d3d_format_t *, const libvlc_video_render_cfg_t * );
 
 void DXGI_LocalSwapchainSwap( struct dxgi_swapchain * );
+bool DXGI_LocalSwapchainGetVsync( struct dxgi_swapchain *, vlc_tick_t *date, vlc_tick_t *period );
 void DXGI_LocalSwapchainSetMetadata( struct dxgi_swapchain *, libvlc_video_metadata_type_t, const void * );
 
 #endif /* VLC_DXGI_SWAPCHAIN_H */
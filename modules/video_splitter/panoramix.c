@@ -248,6 +248,10 @@ typedef struct
     /* Filter configuration to use to create the output */
     panoramix_filter_t filter;
 
+    /* Neither black borders nor attenuation: the output is a view of the
+     * source */
+    bool b_view;
+
 } panoramix_output_t;
 
 typedef struct
@@ -666,6 +670,8 @@ static int Open( vlc_object_t *p_this )
 
             /* */
             video_format_Copy( &p_cfg->fmt, &p_splitter->fmt );
+            p_cfg->fmt.i_x_offset       = 0;
+            p_cfg->fmt.i_y_offset       = 0;
             p_cfg->fmt.i_visible_width  =
             p_cfg->fmt.i_width          = p_output->i_width;
             p_cfg->fmt.i_visible_height =
@@ -701,12 +707,7 @@ static void Close( vlc_object_t *p_this )
 static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t *p_src )
 {
     video_splitter_sys_t *p_sys = p_splitter->p_sys;
-
-    if( video_splitter_NewPicture( p_splitter, pp_dst ) )
-    {
-        picture_Release( p_src );
-        return VLC_EGENERIC;
-    }
+    int i_done = 0;
 
     for( int y = 0; y < p_sys->i_row; y++ )
     {
@@ -717,7 +718,28 @@ static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t
                 continue;
 
             /* */
-            picture_t *p_dst = pp_dst[p_output->i_output];
+            const video_format_t *p_fmt =
+                &p_splitter->p_output[p_output->i_output].fmt;
+            picture_t *p_dst;
+
+            if( p_output->b_view )
+                p_dst = picture_NewView( p_src, p_fmt,
+                                         p_output->i_src_x, p_output->i_src_y );
+            else
+                p_dst = picture_NewFromFormat( p_fmt );
+            if( p_dst == NULL )
+            {
+                for( int i = 0; i < i_done; i++ )
+                    picture_Release( pp_dst[i] );
+                msg_Warn( p_splitter, "can't get output pictures" );
+                picture_Release( p_src );
+                return VLC_EGENERIC;
+            }
+            pp_dst[p_output->i_output] = p_dst;
+            i_done++;
+
+            if( p_output->b_view )
+                continue;
 
             /* */
             picture_CopyProperties( p_dst, p_src );
@@ -896,6 +918,8 @@ static int Configuration( panoramix_output_t pp_output[ROW_MAX][COL_MAX],
 
             /* */
             p_output->filter = cfg;
+            p_output->b_view = !memcmp( &cfg, &(panoramix_filter_t){ 0 },
+                                        sizeof(cfg) );
 
             /* */
             p_output->i_width  = cfg.black.i_left + p_output->i_src_width  + cfg.black.i_right;
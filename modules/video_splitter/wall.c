@@ -97,6 +97,7 @@ typedef struct
     int           i_col;
     int           i_row;
     int           i_output;
+    bool          b_crop; /* opaque pictures, cropped by the displays */
     wall_output_t pp_output[COL_MAX][ROW_MAX]; /* [x][y] */
 } video_splitter_sys_t;
 
@@ -113,13 +114,17 @@ static int Open( vlc_object_t *p_this )
 
     const vlc_chroma_description_t *p_chroma =
         vlc_fourcc_GetChromaDescription( p_splitter->fmt.i_chroma );
-    if( p_chroma == NULL || p_chroma->plane_count == 0 )
+    if( p_chroma == NULL )
         return VLC_EGENERIC;
 
     p_splitter->p_sys = p_sys = malloc( sizeof(*p_sys) );
     if( !p_sys )
         return VLC_ENOMEM;
 
+    /* The outputs are views of the source pictures if possible, otherwise
+     * each output shows its own window of the whole pictures */
+    p_sys->b_crop = p_chroma->plane_count == 0;
+
     config_ChainParse( p_splitter, CFG_PREFIX, ppsz_filter_options,
                        p_splitter->p_cfg );
 
@@ -217,10 +222,20 @@ static int Open( vlc_object_t *p_this )
             video_splitter_output_t *p_cfg = &p_splitter->p_output[p_output->i_output];
 
             video_format_Copy( &p_cfg->fmt, &p_splitter->fmt );
-            p_cfg->fmt.i_visible_width  =
-            p_cfg->fmt.i_width          = p_output->i_width;
-            p_cfg->fmt.i_visible_height =
-            p_cfg->fmt.i_height         = p_output->i_height;
+            if( p_sys->b_crop )
+            {
+                p_cfg->fmt.i_x_offset += p_output->i_left;
+                p_cfg->fmt.i_y_offset += p_output->i_top;
+            }
+            else
+            {
+                p_cfg->fmt.i_x_offset = 0;
+                p_cfg->fmt.i_y_offset = 0;
+                p_cfg->fmt.i_width    = p_output->i_width;
+                p_cfg->fmt.i_height   = p_output->i_height;
+            }
+            p_cfg->fmt.i_visible_width  = p_output->i_width;
+            p_cfg->fmt.i_visible_height = p_output->i_height;
             p_cfg->fmt.i_sar_num        = p_splitter->fmt.i_sar_num;
             p_cfg->fmt.i_sar_den        = p_splitter->fmt.i_sar_den;
             p_cfg->psz_module = NULL;
@@ -249,13 +264,9 @@ static void Close( vlc_object_t *p_this )
 static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t *p_src )
 {
     video_splitter_sys_t *p_sys = p_splitter->p_sys;
+    int i_done = 0;
 
-    if( video_splitter_NewPicture( p_splitter, pp_dst ) )
-    {
-        picture_Release( p_src );
-        return VLC_EGENERIC;
-    }
-
+    /* No copies: the outputs reference the source picture */
     for( int y = 0; y < p_sys->i_row; y++ )
     {
         for( int x = 0; x < p_sys->i_col; x++ )
@@ -264,20 +275,26 @@ static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t
             if( !p_output->b_active )
                 continue;
 
-            picture_t *p_dst = pp_dst[p_output->i_output];
-
-            /* */
-            picture_t tmp = *p_src;
-            for( int i = 0; i < tmp.i_planes; i++ )
+            const video_format_t *p_fmt =
+                &p_splitter->p_output[p_output->i_output].fmt;
+            picture_t *p_dst;
+
+            if( p_sys->b_crop )
+                p_dst = picture_Clone( p_src );
+            else
+                p_dst = picture_NewView( p_src, p_fmt,
+                                         p_splitter->fmt.i_x_offset + p_output->i_left,
+                                         p_splitter->fmt.i_y_offset + p_output->i_top );
+            if( p_dst == NULL )
             {
-                plane_t *p0 = &tmp.p[0];
-                plane_t *p = &tmp.p[i];
-                const int i_y = p_output->i_top  * p->i_visible_pitch / p0->i_visible_pitch;
-                const int i_x = p_output->i_left * p->i_visible_lines / p0->i_visible_lines;
-
-                p->p_pixels += i_y * p->i_pitch + ( i_x - (i_x % p->i_pixel_pitch));
+                for( int i = 0; i < i_done; i++ )
+                    picture_Release( pp_dst[i] );
+                msg_Warn( p_splitter, "can't get output pictures" );
+                picture_Release( p_src );
+                return VLC_EGENERIC;
             }
-            picture_Copy( p_dst, &tmp );
+            pp_dst[p_output->i_output] = p_dst;
+            i_done++;
         }
     }
 
@@ -48,11 +48,24 @@ typedef struct
     module_t *module; /**< Output plugin (or NULL if inactive) */
     aout_filters_t *filters;
     aout_volume_t *volume;
+    struct aout_pull *pull; /**< Pull mode state (or NULL if inactive) */
     bool bitexact;
+    bool low_delay;
 
     atomic_bool drained;
     _Atomic vlc_tick_t drain_deadline;
 
+    struct
+    {
+        vlc_mutex_t lock;
+        vlc_timer_t timer;
+        bool enabled; /**< Keep the stream open after the end of a media */
+        bool eos; /**< Drained and not flushed since */
+        bool lingering; /**< Stream open without decoder (protected by lock) */
+        bool continued; /**< Stream continued from the previous media */
+        vlc_tick_t deadline; /**< End of the queued audio */
+    } gapless;
+
     struct
     {
         vlc_mutex_t lock;
@@ -172,6 +185,8 @@ void aout_DecDrain(audio_output_t *);
 /* Contrary to other aout_Dec*() functions, this function can be called from
  * any threads */
 bool aout_DecIsDrained(audio_output_t *);
+/* Timer callback closing the stream kept open after the end of a media */
+void aout_DecLingerExpired(void *);
 
 void aout_RequestRestart (audio_output_t *, unsigned);
 void aout_RequestRetiming(audio_output_t *aout, vlc_tick_t system_ts,
@@ -38,6 +38,92 @@
 #include "clock/clock.h"
 #include "libvlc.h"
 
+/* Time to keep the stream open once the audio of the last media is played */
+#define AOUT_LINGER_GRACE VLC_TICK_FROM_MS(500)
+
+/**
+ * Takes over the stream left open by the previous media, if any.
+ * \return true if the stream can be continued with the given format
+ */
+static bool aout_DecResume(audio_output_t *aout,
+                           const audio_sample_format_t *fmt, int profile)
+{
+    aout_owner_t *owner = aout_owner (aout);
+
+    if (!owner->gapless.enabled)
+        return false;
+
+    vlc_timer_disarm(owner->gapless.timer);
+    vlc_mutex_lock(&owner->gapless.lock);
+    bool lingering = owner->gapless.lingering;
+    owner->gapless.lingering = false;
+    vlc_mutex_unlock(&owner->gapless.lock);
+
+    if (!lingering)
+        return false;
+
+    int restart = atomic_load_explicit(&owner->restart, memory_order_relaxed);
+    if (profile == owner->input_profile
+     && AOUT_FMTS_IDENTICAL(fmt, &owner->input_format)
+     && fmt->i_channels == owner->input_format.i_channels
+     && (restart & ~AOUT_RESTART_FILTERS) == 0)
+    {
+        msg_Dbg (aout, "continuing audio output stream");
+        return true;
+    }
+
+    /* Let the previous media play out before restarting the output */
+    vlc_tick_wait(owner->gapless.deadline);
+    aout->flush(aout);
+    aout_OutputDelete (aout);
+    owner->mixer_format.i_format = 0;
+    return false;
+}
+
+/**
+ * Keeps the stream open after the end of a media, so that the next one can
+ * continue it without gap (see aout_DecResume()).
+ */
+static void aout_DecLinger(audio_output_t *aout)
+{
+    aout_owner_t *owner = aout_owner (aout);
+
+    /* The filters were drained and use the clock of the ending media */
+    if (owner->filters)
+    {
+        aout_FiltersDelete (aout, owner->filters);
+        owner->filters = NULL;
+    }
+    vlc_audio_meter_Flush(&owner->meter);
+    owner->sync.clock = NULL;
+    owner->gapless.eos = false;
+
+    vlc_mutex_lock(&owner->gapless.lock);
+    owner->gapless.lingering = true;
+    vlc_mutex_unlock(&owner->gapless.lock);
+
+    vlc_timer_schedule(owner->gapless.timer, true,
+                       owner->gapless.deadline + AOUT_LINGER_GRACE, 0);
+    msg_Dbg (aout, "keeping audio output stream for the next media");
+}
+
+void aout_DecLingerExpired(void *data)
+{
+    audio_output_t *aout = data;
+    aout_owner_t *owner = aout_owner (aout);
+
+    vlc_mutex_lock(&owner->gapless.lock);
+    if (owner->gapless.lingering)
+    {
+        msg_Dbg (aout, "closing audio output stream");
+        aout->flush(aout);
+        aout_OutputDelete (aout);
+        owner->mixer_format.i_format = 0;
+        owner->gapless.lingering = false;
+    }
+    vlc_mutex_unlock(&owner->gapless.lock);
+}
+
 /**
  * Creates an audio output
  */
@@ -80,16 +166,24 @@ int aout_DecNew(audio_output_t *p_aout, const audio_sample_format_t *p_format,
     if (!owner->bitexact)
         owner->volume = aout_volume_New (p_aout, p_replay_gain);
 
-    atomic_store_explicit(&owner->restart, 0, memory_order_relaxed);
-    owner->input_profile = profile;
-    owner->filter_format = owner->mixer_format = owner->input_format = *p_format;
+    const bool continued = aout_DecResume(p_aout, p_format, profile);
+    if (!continued)
+    {
+        atomic_store_explicit(&owner->restart, 0, memory_order_relaxed);
+        owner->input_profile = profile;
+        owner->filter_format = owner->mixer_format = owner->input_format =
+            *p_format;
+    }
 
     owner->sync.clock = clock;
 
     owner->filters = NULL;
-    owner->filters_cfg = AOUT_FILTERS_CFG_INIT;
-    if (aout_OutputNew (p_aout))
-        goto error;
+    if (!continued)
+    {
+        owner->filters_cfg = AOUT_FILTERS_CFG_INIT;
+        if (aout_OutputNew (p_aout))
+            goto error;
+    }
     aout_volume_SetFormat (owner->volume, owner->mixer_format.i_format);
 
     vlc_audio_meter_Reset(&owner->meter, &owner->mixer_format);
@@ -118,6 +212,8 @@ error:
     owner->sync.discontinuity = true;
     owner->original_pts = VLC_TICK_INVALID;
     owner->sync.delay = owner->sync.request_delay = 0;
+    owner->gapless.eos = false;
+    owner->gapless.continued = continued;
 
     atomic_init (&owner->buffers_lost, 0);
     atomic_init (&owner->buffers_played, 0);
@@ -134,10 +230,15 @@ void aout_DecDelete (audio_output_t *aout)
 
     if (owner->mixer_format.i_format)
     {
-        aout_DecFlush(aout);
-        if (owner->filters)
-            aout_FiltersDelete (aout, owner->filters);
-        aout_OutputDelete (aout);
+        if (owner->gapless.eos)
+            aout_DecLinger(aout);
+        else
+        {
+            aout_DecFlush(aout);
+            if (owner->filters)
+                aout_FiltersDelete (aout, owner->filters);
+            aout_OutputDelete (aout);
+        }
     }
     aout_volume_Delete (owner->volume);
     owner->volume = NULL;
@@ -282,7 +383,13 @@ static void aout_DecSynchronize(audio_output_t *aout, vlc_tick_t system_now,
     if (aout_TimeGet(aout, &delay) != 0)
         return; /* nothing can be done if timing is unknown */
 
-    if (owner->sync.discontinuity)
+    /* In low delay mode, do not wait for the clock jitter: if the audio drives
+     * the clock, it starts right away, otherwise aout_RequestRetiming() still
+     * inserts the silence needed to play in sync ("Early audio output").
+     * Nor for a stream continued from the previous media: it is playing
+     * already, the new media is queued right after it. */
+    if (owner->sync.discontinuity && !owner->low_delay
+     && !owner->gapless.continued)
     {
         /* Chicken-egg situation for most aout modules that can't be started
          * deferred (all except PulseAudio). These modules will start to play
@@ -493,6 +600,7 @@ int aout_DecPlay(audio_output_t *aout, block_t *block)
 
     /* Output */
     owner->sync.discontinuity = false;
+    owner->gapless.continued = owner->gapless.eos = false;
     aout->play(aout, block, play_date);
 
     atomic_fetch_add_explicit(&owner->buffers_played, 1, memory_order_relaxed);
@@ -578,6 +686,7 @@ void aout_DecFlush(audio_output_t *aout)
     atomic_store_explicit(&owner->drained, false, memory_order_relaxed);
     atomic_store_explicit(&owner->drain_deadline, VLC_TICK_INVALID,
                           memory_order_relaxed);
+    owner->gapless.continued = owner->gapless.eos = false;
 
     owner->sync.discontinuity = true;
     owner->original_pts = VLC_TICK_INVALID;
@@ -587,7 +696,7 @@ bool aout_DecIsDrained(audio_output_t *aout)
 {
     aout_owner_t *owner = aout_owner (aout);
 
-    if (aout->drain == NULL)
+    if (aout->drain == NULL || owner->gapless.enabled)
     {
         vlc_tick_t drain_deadline =
             atomic_load_explicit(&owner->drain_deadline, memory_order_relaxed);
@@ -612,7 +721,22 @@ void aout_DecDrain(audio_output_t *aout)
             aout->play(aout, block, vlc_tick_now());
     }
 
-    if (aout->drain)
+    if (owner->gapless.enabled)
+    {
+        /* Do not wait for the end of the stream: the next media can be
+         * started while the queued audio is playing, and continue it. */
+        const vlc_tick_t now = vlc_tick_now();
+        vlc_tick_t delay;
+
+        owner->gapless.deadline = now;
+        if (aout_TimeGet(aout, &delay) == 0)
+            owner->gapless.deadline += delay;
+        owner->gapless.eos = true;
+
+        atomic_store_explicit(&owner->drain_deadline, now,
+                              memory_order_relaxed);
+    }
+    else if (aout->drain)
     {
         assert(!atomic_load_explicit(&owner->drained, memory_order_relaxed));
 
@@ -282,7 +282,8 @@ static block_t *aout_FiltersPipelinePlay(filter_t *const *filters,
         filter_t *filter = filters[i];
 
         /* Please note that p_block->i_nb_samples & i_buffer
-         * shall be set by the filter plug-in. */
+         * shall be set by the filter plug-in. The returned block may be the
+         * input block processed in place (see aout_filter_GetBuffer()). */
         block = filter->ops->filter_audio (filter, block);
     }
     return block;
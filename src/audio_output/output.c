@@ -244,6 +244,7 @@ audio_output_t *aout_New (vlc_object_t *parent)
     vlc_mutex_init (&owner->lock);
     vlc_mutex_init (&owner->dev.lock);
     vlc_mutex_init (&owner->vp.lock);
+    vlc_mutex_init (&owner->gapless.lock);
     vlc_viewpoint_init (&owner->vp.value);
     vlc_list_init(&owner->dev.list);
     atomic_init (&owner->vp.update, false);
@@ -252,6 +253,9 @@ audio_output_t *aout_New (vlc_object_t *parent)
 
     atomic_init(&owner->drained, false);
     atomic_init(&owner->drain_deadline, VLC_TICK_INVALID);
+    owner->gapless.enabled = false;
+    owner->gapless.eos = owner->gapless.lingering = false;
+    owner->gapless.continued = false;
 
     /* Audio output module callbacks */
     var_Create (aout, "volume", VLC_VAR_FLOAT);
@@ -372,6 +376,12 @@ audio_output_t *aout_New (vlc_object_t *parent)
     var_Create (aout, "equalizer-preset", VLC_VAR_STRING | VLC_VAR_DOINHERIT);
 
     owner->bitexact = var_InheritBool (aout, "audio-bitexact");
+    owner->low_delay = var_InheritBool (aout, "low-delay");
+
+    if (var_InheritBool (aout, "audio-gapless"))
+        owner->gapless.enabled =
+            vlc_timer_create (&owner->gapless.timer, aout_DecLingerExpired,
+                              aout) == 0;
 
     return aout;
 }
@@ -391,6 +401,12 @@ void aout_Destroy (audio_output_t *aout)
 {
     aout_owner_t *owner = aout_owner (aout);
 
+    if (owner->gapless.enabled)
+    {   /* Close the stream of the last media if it is still open */
+        vlc_timer_destroy (owner->gapless.timer);
+        aout_DecLingerExpired (aout);
+    }
+
     vlc_mutex_lock(&owner->lock);
     module_unneed (aout, owner->module);
     /* Protect against late call from intf.c */
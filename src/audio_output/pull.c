@@ -0,0 +1,205 @@
+/*****************************************************************************
+ * pull.c : callback-driven audio output helpers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include "aout_internal.h"
+#include "ring.h"
+
+struct aout_pull
+{
+    aout_ring_t *ring;
+    unsigned rate;
+    size_t frame_size;
+    unsigned char silence; /**< byte value of a silent sample */
+    vlc_tick_t latency; /**< device latency estimate until the first render */
+
+    /* Written by the render callback */
+    _Atomic vlc_tick_t play_date; /**< play date of the oldest queued frame */
+    atomic_uint underruns;
+
+    atomic_bool paused;
+};
+
+static struct aout_pull *aout_pull(audio_output_t *aout)
+{
+    struct aout_pull *pull = aout_owner(aout)->pull;
+
+    assert(pull != NULL);
+    return pull;
+}
+
+static int PullTimeGet(audio_output_t *aout, vlc_tick_t *restrict delay)
+{
+    struct aout_pull *pull = aout_pull(aout);
+    vlc_tick_t now = vlc_tick_now();
+    vlc_tick_t date = atomic_load_explicit(&pull->play_date,
+                                           memory_order_relaxed);
+
+    if (date == VLC_TICK_INVALID)
+        date = now + pull->latency; /* device not rendering yet */
+    else if (date < now)
+        date = now; /* device stalled */
+
+    *delay = date - now + vlc_tick_from_samples(aout_ring_Used(pull->ring),
+                                                pull->rate);
+    return 0;
+}
+
+static void PullPlay(audio_output_t *aout, block_t *block, vlc_tick_t date)
+{
+    struct aout_pull *pull = aout_pull(aout);
+    const unsigned char *p = block->p_buffer;
+    size_t frames = block->i_buffer / pull->frame_size;
+    /* A running device frees the whole ring within its duration */
+    const vlc_tick_t deadline = vlc_tick_now()
+        + vlc_tick_from_samples(aout_ring_Capacity(pull->ring), pull->rate);
+
+    unsigned underruns = atomic_exchange_explicit(&pull->underruns, 0,
+                                                  memory_order_relaxed);
+    if (underruns > 0)
+        msg_Dbg(aout, "%u buffer underrun(s)", underruns);
+
+    for (;;)
+    {
+        size_t n = aout_ring_Write(pull->ring, p, frames);
+
+        p += n * pull->frame_size;
+        frames -= n;
+        if (frames == 0)
+            break;
+
+        if (atomic_load_explicit(&pull->paused, memory_order_relaxed)
+         || vlc_tick_now() >= deadline)
+        {
+            msg_Warn(aout, "%zu frames of audio dropped", frames);
+            break;
+        }
+
+        /* Wait for the device to consume about what is missing */
+        size_t wait = frames;
+        if (wait > aout_ring_Capacity(pull->ring) / 4)
+            wait = aout_ring_Capacity(pull->ring) / 4;
+        vlc_tick_sleep(vlc_tick_from_samples(wait, pull->rate) + 1);
+    }
+
+    block_Release(block);
+    (void) date;
+}
+
+static void PullPause(audio_output_t *aout, bool paused, vlc_tick_t date)
+{
+    struct aout_pull *pull = aout_pull(aout);
+
+    atomic_store_explicit(&pull->paused, paused, memory_order_relaxed);
+    (void) date;
+}
+
+static void PullFlush(audio_output_t *aout)
+{
+    aout_ring_Flush(aout_pull(aout)->ring);
+}
+
+int aout_PullStart(audio_output_t *aout, const audio_sample_format_t *fmt,
+                   vlc_tick_t buffer, vlc_tick_t latency)
+{
+    aout_owner_t *owner = aout_owner(aout);
+    audio_sample_format_t f = *fmt;
+
+    assert(owner->pull == NULL);
+    if (!AOUT_FMT_LINEAR(&f))
+        return VLC_EGENERIC;
+    aout_FormatPrepare(&f);
+    if (f.i_bytes_per_frame == 0 || f.i_rate == 0)
+        return VLC_EGENERIC;
+
+    struct aout_pull *pull = malloc(sizeof (*pull));
+    if (unlikely(pull == NULL))
+        return VLC_ENOMEM;
+
+    pull->ring = aout_ring_New(f.i_bytes_per_frame,
+                               samples_from_vlc_tick(buffer, f.i_rate));
+    if (unlikely(pull->ring == NULL))
+    {
+        free(pull);
+        return VLC_ENOMEM;
+    }
+
+    pull->rate = f.i_rate;
+    pull->frame_size = f.i_bytes_per_frame;
+    pull->silence = (f.i_format == VLC_CODEC_U8) ? 0x80 : 0;
+    pull->latency = latency;
+    atomic_init(&pull->play_date, VLC_TICK_INVALID);
+    atomic_init(&pull->underruns, 0);
+    atomic_init(&pull->paused, false);
+    owner->pull = pull;
+
+    aout->time_get = PullTimeGet;
+    aout->play = PullPlay;
+    aout->pause = PullPause;
+    aout->flush = PullFlush;
+    aout->drain = NULL;
+
+    msg_Dbg(aout, "pull mode with %zu frames of buffering",
+            aout_ring_Capacity(pull->ring));
+    return VLC_SUCCESS;
+}
+
+void aout_PullStop(audio_output_t *aout)
+{
+    aout_owner_t *owner = aout_owner(aout);
+    struct aout_pull *pull = owner->pull;
+
+    assert(pull != NULL);
+    aout_ring_Delete(pull->ring);
+    free(pull);
+    owner->pull = NULL;
+}
+
+void aout_PullRender(audio_output_t *aout, void *buf, size_t frames,
+                     vlc_tick_t latency)
+{
+    struct aout_pull *pull = aout_owner(aout)->pull;
+    size_t n = 0;
+
+    if (!atomic_load_explicit(&pull->paused, memory_order_relaxed))
+    {
+        n = aout_ring_Read(pull->ring, buf, frames);
+        if (n < frames)
+            atomic_fetch_add_explicit(&pull->underruns, 1,
+                                      memory_order_relaxed);
+    }
+
+    memset((unsigned char *)buf + n * pull->frame_size, pull->silence,
+           (frames - n) * pull->frame_size);
+
+    atomic_store_explicit(&pull->play_date, vlc_tick_now() + latency
+                          + vlc_tick_from_samples(frames, pull->rate),
+                          memory_order_relaxed);
+}
@@ -0,0 +1,170 @@
+/*****************************************************************************
+ * ring.c : lock-free audio sample ring
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include "ring.h"
+
+struct aout_ring
+{
+    size_t frame_size;
+    size_t mask; /**< capacity - 1 */
+    /* Indices are frame counters modulo SIZE_MAX + 1; each side owns one. */
+    alignas (64) atomic_size_t head; /**< written frames (producer) */
+    atomic_size_t flush_head; /**< head at the last flush */
+    atomic_bool flush; /**< flush pending */
+    alignas (64) atomic_size_t tail; /**< read frames (consumer) */
+    alignas (64) unsigned char data[];
+};
+
+aout_ring_t *aout_ring_New(size_t frame_size, size_t frames)
+{
+    size_t capacity = 1;
+
+    while (capacity < frames)
+    {
+        if (capacity > (SIZE_MAX >> 1))
+            return NULL;
+        capacity <<= 1;
+    }
+
+    size_t size;
+    if (mul_overflow(capacity, frame_size, &size)
+     || add_overflow(size, sizeof (aout_ring_t) + 63, &size))
+        return NULL;
+
+    aout_ring_t *ring = aligned_alloc(64, size & ~(size_t)63);
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    ring->frame_size = frame_size;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->flush_head, 0);
+    atomic_init(&ring->flush, false);
+    atomic_init(&ring->tail, 0);
+    return ring;
+}
+
+void aout_ring_Delete(aout_ring_t *ring)
+{
+    free(ring);
+}
+
+size_t aout_ring_Capacity(const aout_ring_t *ring)
+{
+    return ring->mask + 1;
+}
+
+size_t aout_ring_Write(aout_ring_t *ring, const void *buf, size_t frames)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    /* Frames discarded by a pending flush may still be being read: their
+     * room is only reused once the consumer has moved its tail past them. */
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t room = aout_ring_Capacity(ring) - (head - tail);
+
+    if (frames > room)
+        frames = room;
+
+    /* Copy in up to two parts, around the end of the buffer */
+    size_t offset = head & ring->mask;
+    size_t first = aout_ring_Capacity(ring) - offset;
+    if (first > frames)
+        first = frames;
+
+    memcpy(ring->data + offset * ring->frame_size, buf,
+           first * ring->frame_size);
+    memcpy(ring->data, (const unsigned char *)buf + first * ring->frame_size,
+           (frames - first) * ring->frame_size);
+
+    atomic_store_explicit(&ring->head, head + frames, memory_order_release);
+    return frames;
+}
+
+size_t aout_ring_Read(aout_ring_t *ring, void *buf, size_t frames)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    bool flush = atomic_exchange_explicit(&ring->flush, false,
+                                          memory_order_acquire);
+    /* Loaded after the flush, so as to include the frames it discards */
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (flush)
+    {
+        size_t pos = atomic_load_explicit(&ring->flush_head,
+                                          memory_order_relaxed);
+        /* A later flush may have been seen already: never move backward */
+        if (pos - tail <= head - tail)
+            tail = pos;
+    }
+
+    size_t used = head - tail;
+    if (frames > used)
+        frames = used;
+
+    size_t offset = tail & ring->mask;
+    size_t first = aout_ring_Capacity(ring) - offset;
+    if (first > frames)
+        first = frames;
+
+    memcpy(buf, ring->data + offset * ring->frame_size,
+           first * ring->frame_size);
+    memcpy((unsigned char *)buf + first * ring->frame_size, ring->data,
+           (frames - first) * ring->frame_size);
+
+    atomic_store_explicit(&ring->tail, tail + frames, memory_order_release);
+    return frames;
+}
+
+void aout_ring_Flush(aout_ring_t *ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    atomic_store_explicit(&ring->flush_head, head, memory_order_relaxed);
+    atomic_store_explicit(&ring->flush, true, memory_order_release);
+}
+
+size_t aout_ring_Used(aout_ring_t *ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (atomic_load_explicit(&ring->flush, memory_order_acquire))
+    {
+        size_t pos = atomic_load_explicit(&ring->flush_head,
+                                          memory_order_relaxed);
+        if (pos - tail <= head - tail)
+            tail = pos;
+    }
+
+    size_t used = head - tail;
+    assert(used <= aout_ring_Capacity(ring));
+    return used;
+}
@@ -0,0 +1,77 @@
+/*****************************************************************************
+ * ring.h : lock-free audio sample ring
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_AOUT_RING_H
+# define LIBVLC_AOUT_RING_H 1
+
+/**
+ * Single-producer single-consumer ring of audio frames.
+ *
+ * Write() and Flush() must be called from a single thread at a time (the
+ * producer), Read() from a single other thread (the consumer). Read() never
+ * blocks, locks nor allocates, so that it can run from a realtime callback.
+ */
+typedef struct aout_ring aout_ring_t;
+
+/**
+ * Creates a ring.
+ *
+ * \param frame_size size of a frame in bytes
+ * \param frames minimum capacity in frames (rounded up to a power of two)
+ * \return the ring, or NULL on error
+ */
+aout_ring_t *aout_ring_New(size_t frame_size, size_t frames);
+void aout_ring_Delete(aout_ring_t *);
+
+/** Returns the capacity of the ring in frames. */
+size_t aout_ring_Capacity(const aout_ring_t *);
+
+/**
+ * Queues frames (producer side).
+ *
+ * \return the number of frames actually queued, less than requested if the
+ * ring is full
+ */
+size_t aout_ring_Write(aout_ring_t *, const void *buf, size_t frames);
+
+/**
+ * Dequeues frames (consumer side).
+ *
+ * \return the number of frames actually dequeued, less than requested if the
+ * ring runs empty
+ */
+size_t aout_ring_Read(aout_ring_t *, void *buf, size_t frames);
+
+/**
+ * Discards all queued frames (producer side).
+ *
+ * The consumer drops the frames on its next Read(); frames written after
+ * the flush are kept.
+ */
+void aout_ring_Flush(aout_ring_t *);
+
+/**
+ * Counts queued frames (producer side).
+ *
+ * Pending flushes are accounted for.
+ */
+size_t aout_ring_Used(aout_ring_t *);
+
+#endif
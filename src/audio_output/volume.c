@@ -40,6 +40,7 @@ struct aout_volume
     audio_replay_gain_t replay_gain;
     _Atomic float gain_factor;
     float output_factor;
+    float last_amp; /**< last applied amplification (NAN if none) */
     module_t *module;
 };
 
@@ -59,6 +60,7 @@ aout_volume_t *aout_volume_New(vlc_object_t *parent,
         return NULL;
     vol->module = NULL;
     vol->output_factor = 1.f;
+    vol->last_amp = NAN;
 
     //audio_volume_t *obj = &vol->object;
 
@@ -96,6 +98,7 @@ int aout_volume_SetFormat(aout_volume_t *vol, vlc_fourcc_t format)
     }
 
     obj->format = format;
+    obj->amplify_ramp = NULL;
     vol->module = module_need(obj, "audio volume", NULL, false);
     if (vol->module == NULL)
         return -1;
@@ -137,7 +140,13 @@ int aout_volume_Amplify(aout_volume_t *vol, block_t *block)
 
     float amp = vol->output_factor * atomic_load(&vol->gain_factor);
 
-    vol->object.amplify(&vol->object, block, amp);
+    /* Ramp towards a new gain, rather than jumping to it */
+    if (vol->object.amplify_ramp != NULL && vol->last_amp != amp
+     && !isnan(vol->last_amp))
+        vol->object.amplify_ramp(&vol->object, block, vol->last_amp, amp);
+    else
+        vol->object.amplify(&vol->object, block, amp);
+    vol->last_amp = amp;
     return 0;
 }
 
@@ -33,6 +33,9 @@
 #include "input_clock.h"
 #include "clock_internal.h"
 #include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 /* TODO:
  * - clean up locking once clock code is stable
@@ -65,6 +68,15 @@
  *
  * It is a very important matter if you want to avoid underflow or overflow
  * in all the FIFOs, but it may be not enough.
+ *
+ * The average lags behind a drifting offset by half of its window, and
+ * a single very late clock reference shifts it. So two other methods can
+ * be selected:
+ *  - a least squares fit of the offset against the system date, over a
+ *    window of samples, refitted without the samples that stand too far
+ *    from the first fit (late packets),
+ *  - a second order phase-locked loop, with higher gains for the first
+ *    samples so that it locks quickly after a reset.
  */
 
 /* i_cr_average : Maximum number of samples used to compute the
@@ -98,6 +110,23 @@
 /* */
 #define INPUT_CLOCK_LATE_COUNT (3)
 
+/* Sampling period of the drift between the stream and the system clocks */
+#define INPUT_CLOCK_DRIFT_PERIOD VLC_TICK_FROM_MS(200)
+
+/* Maximum number of drift samples used by the regression */
+#define INPUT_CLOCK_REGRESSION_MAX (256)
+
+/* Drift samples standing further than this number of (robust) standard
+ * deviations from the fit are considered as outliers */
+#define INPUT_CLOCK_REGRESSION_OUTLIER (3.)
+
+/* Minimal gains of the phase-locked loop */
+#define INPUT_CLOCK_PLL_KP (0.05)
+#define INPUT_CLOCK_PLL_KI (INPUT_CLOCK_PLL_KP * INPUT_CLOCK_PLL_KP / 4.)
+
+/* Maximum drift between the clocks (1000 ppm), larger values are bogus */
+#define INPUT_CLOCK_MAX_SLOPE (0.001)
+
 /* */
 struct input_clock_t
 {
@@ -111,9 +140,35 @@ struct input_clock_t
     vlc_tick_t i_buffering_duration;
 
     /* Clock drift */
+    enum input_clock_recovery recovery;
     vlc_tick_t i_next_drift_update;
     average_t drift;
 
+    /* Regression of the drift: the samples are kept in order, the last
+     * ones in the window are fitted as offset + slope * x */
+    struct
+    {
+        double x[INPUT_CLOCK_REGRESSION_MAX]; /* system date - base */
+        double y[INPUT_CLOCK_REGRESSION_MAX];
+        vlc_tick_t base;
+        unsigned count;
+        unsigned window;
+        double offset;
+        double slope;
+    } regression;
+
+    /* Phase-locked loop on the drift */
+    struct
+    {
+        vlc_tick_t date; /* system date of the phase */
+        double phase;
+        double freq;
+        unsigned count;
+    } pll;
+
+    /* Deviation of the last reference from the recovered clock */
+    vlc_tick_t i_jitter;
+
     /* Late statistics */
     struct
     {
@@ -141,12 +196,17 @@ static vlc_tick_t ClockSystemToStream( input_clock_t *, vlc_tick_t i_system );
 
 static vlc_tick_t ClockGetTsOffset( input_clock_t * );
 
+static void DriftReset( input_clock_t * );
+static void DriftUpdate( input_clock_t *, vlc_tick_t i_system, double sample );
+static vlc_tick_t DriftGet( input_clock_t * );
+static void DriftShift( input_clock_t *, vlc_tick_t i_duration );
+
 static void UpdateListener( input_clock_t *cl )
 {
     if( cl->clock_listener )
     {
         const vlc_tick_t system_expected =
-            ClockStreamToSystem( cl, cl->last.stream + AvgGet( &cl->drift ) ) +
+            ClockStreamToSystem( cl, cl->last.stream + DriftGet( cl ) ) +
             cl->i_pts_delay + ClockGetTsOffset( cl );
 
         vlc_clock_Update( cl->clock_listener, system_expected, cl->last.stream, cl->rate );
@@ -156,7 +216,8 @@ static void UpdateListener( input_clock_t *cl )
 /*****************************************************************************
  * input_clock_New: create a new clock
  *****************************************************************************/
-input_clock_t *input_clock_New( float rate )
+input_clock_t *input_clock_New( float rate,
+                                enum input_clock_recovery recovery )
 {
     input_clock_t *cl = malloc( sizeof(*cl) );
     if( !cl )
@@ -171,8 +232,12 @@ input_clock_t *input_clock_New( float rate )
 
     cl->i_buffering_duration = 0;
 
+    cl->recovery = recovery;
     cl->i_next_drift_update = VLC_TICK_INVALID;
     AvgInit( &cl->drift, 10 );
+    cl->regression.window = 16;
+    DriftReset( cl );
+    cl->i_jitter = 0;
 
     cl->late.i_index = 0;
     for( int i = 0; i < INPUT_CLOCK_LATE_COUNT; i++ )
@@ -242,7 +307,7 @@ vlc_tick_t input_clock_Update( input_clock_t *cl, vlc_object_t *p_log,
     if( b_reset_reference )
     {
         cl->i_next_drift_update = VLC_TICK_INVALID;
-        AvgReset( &cl->drift );
+        DriftReset( cl );
 
         /* Feed synchro with a new reference point. */
         cl->b_has_reference = true;
@@ -257,9 +322,9 @@ vlc_tick_t input_clock_Update( input_clock_t *cl, vlc_object_t *p_log,
     {
         const vlc_tick_t i_converted = ClockSystemToStream( cl, i_ck_system );
 
-        AvgUpdate( &cl->drift, i_converted - i_ck_stream );
+        DriftUpdate( cl, i_ck_system, i_converted - i_ck_stream );
 
-        cl->i_next_drift_update = i_ck_system + VLC_TICK_FROM_MS(200); /* FIXME why that */
+        cl->i_next_drift_update = i_ck_system + INPUT_CLOCK_DRIFT_PERIOD; /* FIXME why that */
     }
 
     /* Update the extra buffering value */
@@ -285,8 +350,9 @@ vlc_tick_t input_clock_Update( input_clock_t *cl, vlc_object_t *p_log,
 
     /* It does not take the decoder latency into account but it is not really
      * the goal of the clock here */
-    const vlc_tick_t i_system_expected = ClockStreamToSystem( cl, i_ck_stream + AvgGet( &cl->drift ) );
+    const vlc_tick_t i_system_expected = ClockStreamToSystem( cl, i_ck_stream + DriftGet( cl ) );
     const vlc_tick_t i_late = __MAX(0, ( i_ck_system - cl->i_pts_delay ) - i_system_expected);
+    cl->i_jitter = i_ck_system - i_system_expected;
     if( i_late > 0 )
     {
         cl->late.pi_value[cl->late.i_index] = i_late;
@@ -321,6 +387,10 @@ void input_clock_ChangeRate( input_clock_t *cl, float rate )
         /* Move the reference point (as if we were playing at the new rate
          * from the start */
         cl->ref.system = cl->last.system - (vlc_tick_t) ((cl->last.system - cl->ref.system) / rate * cl->rate);
+
+        /* The past drift samples do not match the new reference */
+        if( cl->recovery != INPUT_CLOCK_RECOVERY_AVERAGE )
+            DriftReset( cl );
     }
     cl->rate = rate;
 
@@ -342,6 +412,7 @@ void input_clock_ChangePause( input_clock_t *cl, bool b_paused, vlc_tick_t i_dat
         {
             cl->ref.system += i_duration;
             cl->last.system += i_duration;
+            DriftShift( cl, i_duration );
 
             UpdateListener( cl );
         }
@@ -359,7 +430,7 @@ vlc_tick_t input_clock_GetWakeup( input_clock_t *cl )
 
     /* Synchronized, we can wait */
     if( cl->b_has_reference )
-        i_wakeup = ClockStreamToSystem( cl, cl->last.stream + AvgGet( &cl->drift ) - cl->i_buffering_duration );
+        i_wakeup = ClockStreamToSystem( cl, cl->last.stream + DriftGet( cl ) - cl->i_buffering_duration );
 
     return i_wakeup;
 }
@@ -408,6 +479,7 @@ void input_clock_ChangeSystemOrigin( input_clock_t *cl, bool b_absolute, vlc_tic
 
     cl->ref.system += i_offset;
     cl->last.system += i_offset;
+    DriftShift( cl, i_offset );
 
     UpdateListener( cl );
 }
@@ -455,6 +527,10 @@ void input_clock_SetJitter( input_clock_t *cl,
 
     if( cl->drift.range != i_cr_average )
         AvgRescale( &cl->drift, i_cr_average );
+
+    /* The regression rejects outliers, it can afford a larger window */
+    cl->regression.window = VLC_CLIP( 2 * i_cr_average, 16,
+                                      INPUT_CLOCK_REGRESSION_MAX );
 }
 
 vlc_tick_t input_clock_GetJitter( input_clock_t *cl )
@@ -475,6 +551,215 @@ vlc_tick_t input_clock_GetJitter( input_clock_t *cl )
     return i_pts_delay + i_late_median;
 }
 
+void input_clock_GetHealth( input_clock_t *cl, vlc_tick_t *pi_jitter,
+                            double *pf_drift )
+{
+    double drift = 0.;
+
+    switch( cl->recovery )
+    {
+        case INPUT_CLOCK_RECOVERY_AVERAGE:
+            /* The average offset has built up since the reference */
+            if( cl->b_has_reference && cl->last.system > cl->ref.system )
+                drift = AvgGet( &cl->drift )
+                      / (cl->last.system - cl->ref.system);
+            break;
+        case INPUT_CLOCK_RECOVERY_REGRESSION:
+            drift = cl->regression.slope;
+            break;
+        case INPUT_CLOCK_RECOVERY_PLL:
+            drift = cl->pll.freq;
+            break;
+    }
+
+    *pi_jitter = cl->i_jitter;
+    *pf_drift = drift * 1000000.;
+}
+
+vlc_tick_t input_clock_GetLatency( input_clock_t *cl, vlc_tick_t i_ts,
+                                   vlc_tick_t i_system )
+{
+    if( !cl->b_has_reference )
+        return VLC_TICK_INVALID;
+
+    /* Same conversion as the one forwarded to the clock listener */
+    return ClockStreamToSystem( cl, i_ts + DriftGet( cl ) ) +
+           cl->i_pts_delay + ClockGetTsOffset( cl ) - i_system;
+}
+
+/*****************************************************************************
+ * Drift estimation
+ *****************************************************************************/
+static void DriftReset( input_clock_t *cl )
+{
+    AvgReset( &cl->drift );
+
+    cl->regression.base = VLC_TICK_INVALID;
+    cl->regression.count = 0;
+    cl->regression.offset = 0.;
+    cl->regression.slope = 0.;
+
+    cl->pll.date = VLC_TICK_INVALID;
+    cl->pll.phase = 0.;
+    cl->pll.freq = 0.;
+    cl->pll.count = 0;
+}
+
+/* Weighted least squares fit of y = offset + slope * x */
+static void RegressionFit( const double *restrict x, const double *restrict y,
+                           const double *restrict w, unsigned n,
+                           double *restrict offset, double *restrict slope )
+{
+    double sw = 0., sx = 0., sy = 0.;
+
+    for( unsigned i = 0; i < n; i++ )
+    {
+        sw += w[i];
+        sx += w[i] * x[i];
+        sy += w[i] * y[i];
+    }
+
+    const double mx = sx / sw, my = sy / sw;
+    double sxx = 0., sxy = 0.;
+
+    for( unsigned i = 0; i < n; i++ )
+    {
+        const double dx = x[i] - mx;
+
+        sxx += w[i] * dx * dx;
+        sxy += w[i] * dx * (y[i] - my);
+    }
+
+    double b = sxx > 0. ? sxy / sxx : 0.;
+
+    b = VLC_CLIP( b, -INPUT_CLOCK_MAX_SLOPE, INPUT_CLOCK_MAX_SLOPE );
+    *slope = b;
+    *offset = my - b * mx;
+}
+
+static int DoubleCompare( const void *a, const void *b )
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void RegressionUpdate( input_clock_t *cl, vlc_tick_t i_system,
+                              double sample )
+{
+    if( cl->regression.count == INPUT_CLOCK_REGRESSION_MAX )
+    {   /* Drop the oldest sample */
+        cl->regression.count--;
+        memmove( cl->regression.x, cl->regression.x + 1,
+                 cl->regression.count * sizeof (double) );
+        memmove( cl->regression.y, cl->regression.y + 1,
+                 cl->regression.count * sizeof (double) );
+    }
+    if( cl->regression.base == VLC_TICK_INVALID )
+        cl->regression.base = i_system;
+
+    cl->regression.x[cl->regression.count] = i_system - cl->regression.base;
+    cl->regression.y[cl->regression.count] = sample;
+    cl->regression.count++;
+
+    const unsigned n = __MIN( cl->regression.count, cl->regression.window );
+    const double *x = cl->regression.x + cl->regression.count - n;
+    const double *y = cl->regression.y + cl->regression.count - n;
+    double w[INPUT_CLOCK_REGRESSION_MAX], r[INPUT_CLOCK_REGRESSION_MAX];
+    double offset, slope;
+
+    for( unsigned i = 0; i < n; i++ )
+        w[i] = 1.;
+    RegressionFit( x, y, w, n, &offset, &slope );
+
+    /* Reject the outliers, using the median absolute deviation as a robust
+     * estimation of the standard deviation */
+    for( unsigned i = 0; i < n; i++ )
+        r[i] = fabs( y[i] - (offset + slope * x[i]) );
+
+    double sorted[INPUT_CLOCK_REGRESSION_MAX];
+
+    memcpy( sorted, r, n * sizeof (double) );
+    qsort( sorted, n, sizeof (double), DoubleCompare );
+
+    const double threshold = __MAX( INPUT_CLOCK_REGRESSION_OUTLIER * 1.4826
+                                    * sorted[n / 2], VLC_TICK_FROM_MS(1) );
+
+    for( unsigned i = 0; i < n; i++ )
+        w[i] = r[i] <= threshold;
+    RegressionFit( x, y, w, n, &cl->regression.offset, &cl->regression.slope );
+}
+
+static void PLLUpdate( input_clock_t *cl, vlc_tick_t i_system, double sample )
+{
+    if( cl->pll.count++ == 0 )
+    {
+        cl->pll.date = i_system;
+        cl->pll.phase = sample;
+        cl->pll.freq = 0.;
+        return;
+    }
+
+    const double dt = i_system - cl->pll.date;
+    const double expected = cl->pll.phase + cl->pll.freq * dt;
+    double error = sample - expected;
+
+    /* Higher gains until enough samples have been seen */
+    const double kp = __MAX( 1. / cl->pll.count, INPUT_CLOCK_PLL_KP );
+    const double ki = __MAX( kp * kp / 4., INPUT_CLOCK_PLL_KI );
+
+    cl->pll.date = i_system;
+    cl->pll.phase = expected + kp * error;
+    if( dt > 0. )
+        cl->pll.freq = VLC_CLIP( cl->pll.freq + ki * error / dt,
+                                 -INPUT_CLOCK_MAX_SLOPE, INPUT_CLOCK_MAX_SLOPE );
+}
+
+static void DriftUpdate( input_clock_t *cl, vlc_tick_t i_system, double sample )
+{
+    switch( cl->recovery )
+    {
+        case INPUT_CLOCK_RECOVERY_AVERAGE:
+            AvgUpdate( &cl->drift, sample );
+            break;
+        case INPUT_CLOCK_RECOVERY_REGRESSION:
+            RegressionUpdate( cl, i_system, sample );
+            break;
+        case INPUT_CLOCK_RECOVERY_PLL:
+            PLLUpdate( cl, i_system, sample );
+            break;
+    }
+}
+
+/* Returns the drift at the date of the last reference */
+static vlc_tick_t DriftGet( input_clock_t *cl )
+{
+    switch( cl->recovery )
+    {
+        case INPUT_CLOCK_RECOVERY_REGRESSION:
+            if( cl->regression.count == 0 )
+                return 0;
+            return cl->regression.offset + cl->regression.slope
+                 * (cl->last.system - cl->regression.base);
+        case INPUT_CLOCK_RECOVERY_PLL:
+            if( cl->pll.count == 0 )
+                return 0;
+            return cl->pll.phase + cl->pll.freq
+                 * (cl->last.system - cl->pll.date);
+        default:
+            return AvgGet( &cl->drift );
+    }
+}
+
+/* Moves the system dates of the drift samples along with the reference */
+static void DriftShift( input_clock_t *cl, vlc_tick_t i_duration )
+{
+    if( cl->regression.base != VLC_TICK_INVALID )
+        cl->regression.base += i_duration;
+    if( cl->pll.date != VLC_TICK_INVALID )
+        cl->pll.date += i_duration;
+}
+
 /*****************************************************************************
  * ClockStreamToSystem: converts a movie clock to system date
  *****************************************************************************/
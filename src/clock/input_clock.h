@@ -35,12 +35,26 @@
  */
 typedef struct input_clock_t input_clock_t;
 
+/**
+ * Clock recovery methods, used to estimate the drift of the stream clock
+ * against the system clock when the input pace cannot be controlled
+ */
+enum input_clock_recovery
+{
+    /** Moving average of the offset between both clocks */
+    INPUT_CLOCK_RECOVERY_AVERAGE,
+    /** Linear regression of the offset, ignoring outliers */
+    INPUT_CLOCK_RECOVERY_REGRESSION,
+    /** Phase-locked loop on the offset */
+    INPUT_CLOCK_RECOVERY_PLL,
+};
+
 /**
  * This function creates a new input_clock_t.
  *
  * You must use input_clock_Delete to delete it once unused.
  */
-input_clock_t *input_clock_New( float rate );
+input_clock_t *input_clock_New( float rate, enum input_clock_recovery );
 
 /**
  * This function attach a clock listener to the input clock
@@ -131,4 +145,22 @@ void input_clock_SetJitter( input_clock_t *,
  */
 vlc_tick_t input_clock_GetJitter( input_clock_t * );
 
+/**
+ * This function returns the state of the clock recovery: how far the last
+ * clock reference arrived from the recovered clock, and the estimated drift of
+ * the system clock against the stream clock (in parts per million).
+ *
+ * They are only meaningful when the input pace cannot be controlled.
+ */
+void input_clock_GetHealth( input_clock_t *, vlc_tick_t *pi_jitter,
+                            double *pf_drift );
+
+/**
+ * This function returns how long after the given system date a stream
+ * timestamp is expected to be rendered, or VLC_TICK_INVALID without clock
+ * reference.
+ */
+vlc_tick_t input_clock_GetLatency( input_clock_t *, vlc_tick_t i_ts,
+                                   vlc_tick_t i_system );
+
 #endif
@@ -322,6 +322,15 @@ stream_t *stream_AccessNew(vlc_object_t *parent, input_thread_t *input,
         s->pf_control = AStreamControl;
         s->p_sys = access;
 
+        /* The persistent cache, if enabled, goes underneath the prefetch
+         * buffer so that the latter can hide the cache misses. */
+        if (var_InheritInteger(s, "disk-cache-size") > 0)
+        {
+            stream_t *cached = vlc_stream_FilterNew(s, "diskcache");
+            if (cached != NULL)
+                s = cached;
+        }
+
         s = stream_FilterChainNew(s, "prefetch,cache");
     }
     else
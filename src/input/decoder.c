@@ -44,6 +44,7 @@
 #include <vlc_decoder.h>
 #include <vlc_picture_pool.h>
 #include <vlc_tracer.h>
+#include <vlc_cpu.h>
 
 #include "audio_output/aout_internal.h"
 #include "stream_output/stream_output.h"
@@ -87,6 +88,16 @@ struct vlc_input_decoder_t
     decoder_t *p_packetizer;
     bool b_packetizer;
 
+    /* Share of the decoding threads budget */
+    bool     threads_joined;
+    unsigned threads;
+
+    /* Low delay mode */
+    bool low_delay;
+    bool wait_rap; /* dropping video frames until a random access point */
+    bool rap_recovering; /* the packetizer signalled a recovery point */
+    unsigned rap_dropped; /* frames dropped while waiting */
+
     /* Current format in use by the output */
     es_format_t    fmt;
     vlc_video_context *vctx;
@@ -98,6 +109,10 @@ struct vlc_input_decoder_t
 
     /* fifo */
     block_fifo_t *p_fifo;
+    struct vlc_buffer_usage *fifo_usage; /* of the instance */
+    size_t fifo_accounted; /* bytes last accounted in the usage */
+    size_t fifo_limit; /* for the instance, or 0 */
+    size_t fifo_process_limit; /* or 0 */
 
     /* Lock for communication with decoder thread */
     vlc_mutex_t lock;
@@ -107,6 +122,8 @@ struct vlc_input_decoder_t
 
     /* pool to use when the decoder doesn't use its own */
     struct picture_pool_t *out_pool;
+    /* pools of the previous output formats */
+    picture_pool_cache_t *pool_cache;
 
     /*
      * 3 threads can read/write these output variables, the DecoderThread, the
@@ -151,6 +168,12 @@ struct vlc_input_decoder_t
 
     bool error;
 
+    /* Hurry level, from the vout statistics */
+    atomic_uint hurry;
+    unsigned hurry_pictures; /* pictures of the current window */
+    unsigned hurry_late; /* late or lost pictures of the current window */
+    unsigned hurry_clean; /* consecutive windows without late pictures */
+
     /* Waiting */
     bool b_waiting;
     bool b_first;
@@ -185,6 +208,19 @@ struct vlc_input_decoder_t
 
 /* */
 #define DECODER_SPU_VOUT_WAIT_DURATION   VLC_TICK_FROM_MS(200)
+/* Maximum number of frames handed at once to pf_decode_batch */
+#define DECODER_BATCH_MAX 32
+/* Maximum number of frames queued in low delay mode before the FIFO is reset */
+#define DECODER_LOW_DELAY_FIFO_MAX 16
+/* Maximum number of frames dropped in low delay mode waiting for a random
+ * access point, for streams that may never have one (intra refresh) */
+#define DECODER_LOW_DELAY_RAP_MAX 60
+/* Number of displayed pictures between hurry level updates */
+#define DECODER_HURRY_WINDOW 32
+/* Number of windows without late pictures before lowering the hurry level */
+#define DECODER_HURRY_RECOVER 4
+/* Number of previous output formats whose picture pool is kept */
+#define DECODER_POOL_CACHE_SIZE 2
 #define BLOCK_FLAG_CORE_PRIVATE_RELOADED (1 << BLOCK_FLAG_CORE_PRIVATE_SHIFT)
 
 #define decoder_Notify(decoder_priv, event, ...) \
@@ -229,6 +265,123 @@ static int LoadDecoder( decoder_t *p_dec, bool b_packetizer,
     return 0;
 }
 
+/* Decoding threads shared by all the video decoders of the process */
+static struct
+{
+    vlc_mutex_t lock;
+    unsigned    used; /* threads granted to the running decoders */
+    unsigned    decoders; /* running video decoders */
+} decoder_threads = { VLC_STATIC_MUTEX, 0, 0 };
+
+static void DecoderThreadsJoin( vlc_input_decoder_t *p_owner )
+{
+    vlc_mutex_lock( &decoder_threads.lock );
+    decoder_threads.decoders++;
+    vlc_mutex_unlock( &decoder_threads.lock );
+    p_owner->threads_joined = true;
+}
+
+static void DecoderThreadsRelease( vlc_input_decoder_t *p_owner, bool leave )
+{
+    if( !p_owner->threads_joined )
+        return;
+
+    vlc_mutex_lock( &decoder_threads.lock );
+    assert( decoder_threads.decoders > 0 );
+    assert( decoder_threads.used >= p_owner->threads );
+    decoder_threads.used -= p_owner->threads;
+    if( leave )
+        decoder_threads.decoders--;
+    vlc_mutex_unlock( &decoder_threads.lock );
+    p_owner->threads_joined = !leave;
+    p_owner->threads = 0;
+}
+
+/* Memory queued to the decoders of the process */
+static struct vlc_buffer_usage decoder_fifos;
+
+static void DecoderFifoJoin( vlc_input_decoder_t *p_owner )
+{
+    libvlc_priv_t *priv = libvlc_priv( vlc_object_instance( &p_owner->dec ) );
+
+    p_owner->fifo_usage = &priv->decoder_fifos;
+    p_owner->fifo_accounted = 0;
+    p_owner->fifo_limit =
+        (size_t)var_InheritInteger( &p_owner->dec, "dec-memory-limit" ) << 20;
+    p_owner->fifo_process_limit =
+        (size_t)var_InheritInteger( &p_owner->dec,
+                                    "dec-memory-process-limit" ) << 20;
+    atomic_fetch_add_explicit( &p_owner->fifo_usage->count, 1,
+                               memory_order_relaxed );
+    atomic_fetch_add_explicit( &decoder_fifos.count, 1, memory_order_relaxed );
+}
+
+/* Updates the usage with the current size of the FIFO.
+ * Must be called with the FIFO locked whenever its size changes. */
+static void DecoderFifoAccount( vlc_input_decoder_t *p_owner, size_t bytes )
+{
+    if( bytes >= p_owner->fifo_accounted )
+    {
+        size_t delta = bytes - p_owner->fifo_accounted;
+
+        atomic_fetch_add_explicit( &p_owner->fifo_usage->bytes, delta,
+                                   memory_order_relaxed );
+        atomic_fetch_add_explicit( &decoder_fifos.bytes, delta,
+                                   memory_order_relaxed );
+    }
+    else
+    {
+        size_t delta = p_owner->fifo_accounted - bytes;
+
+        atomic_fetch_sub_explicit( &p_owner->fifo_usage->bytes, delta,
+                                   memory_order_relaxed );
+        atomic_fetch_sub_explicit( &decoder_fifos.bytes, delta,
+                                   memory_order_relaxed );
+    }
+    p_owner->fifo_accounted = bytes;
+}
+
+static void DecoderFifoLeave( vlc_input_decoder_t *p_owner )
+{
+    DecoderFifoAccount( p_owner, 0 );
+    atomic_fetch_sub_explicit( &p_owner->fifo_usage->count, 1,
+                               memory_order_relaxed );
+    atomic_fetch_sub_explicit( &decoder_fifos.count, 1, memory_order_relaxed );
+}
+
+static bool DecoderFifoOverUsage( const struct vlc_buffer_usage *usage,
+                                  size_t limit, size_t bytes )
+{
+    if( limit == 0
+     || atomic_load_explicit( &usage->bytes, memory_order_relaxed ) <= limit )
+        return false;
+
+    /* Only the decoders holding more than an even share give up their data,
+     * so that a single late decoder does not starve the others. */
+    unsigned count = atomic_load_explicit( &usage->count,
+                                           memory_order_relaxed );
+    return bytes > limit / __MAX( count, 1 );
+}
+
+/* Whether the FIFO must be reset to honour the memory limits */
+static bool DecoderFifoOverBudget( vlc_input_decoder_t *p_owner )
+{
+    size_t bytes = p_owner->fifo_accounted;
+
+    return DecoderFifoOverUsage( p_owner->fifo_usage, p_owner->fifo_limit,
+                                 bytes )
+        || DecoderFifoOverUsage( &decoder_fifos, p_owner->fifo_process_limit,
+                                 bytes );
+}
+
+size_t vlc_input_decoder_GetBufferUsage( libvlc_int_t *libvlc, bool process )
+{
+    const struct vlc_buffer_usage *usage =
+        process ? &decoder_fifos : &libvlc_priv( libvlc )->decoder_fifos;
+
+    return atomic_load_explicit( &usage->bytes, memory_order_relaxed );
+}
+
 static int DecoderThread_Reload( vlc_input_decoder_t *p_owner,
                                  const es_format_t *restrict p_fmt,
                                  enum reload reload )
@@ -244,6 +397,7 @@ static int DecoderThread_Reload( vlc_input_decoder_t *p_owner,
 
     /* Restart the decoder module */
     decoder_Clean( p_dec );
+    DecoderThreadsRelease( p_owner, false );
     p_owner->error = false;
 
     if( reload == RELOAD_DECODER_AOUT )
@@ -453,14 +607,20 @@ static int ModuleThread_UpdateVideoFormat( decoder_t *p_dec, vlc_video_context *
             dpb_size = 2;
             break;
         }
-        picture_pool_t *pool = picture_pool_NewFromFormat( &p_dec->fmt_out.video,
-                            dpb_size + p_dec->i_extra_picture_buffers + 1 );
+        const unsigned count = dpb_size + p_dec->i_extra_picture_buffers + 1;
+        picture_pool_t *pool = NULL;
+
+        /* Resolution switches often go back to a previous format */
+        if( p_owner->pool_cache != NULL )
+            pool = picture_pool_cache_Get( p_owner->pool_cache,
+                                           &p_dec->fmt_out.video, count );
+        if( pool == NULL )
+            pool = picture_pool_NewFromFormat( &p_dec->fmt_out.video, count );
 
         if( pool == NULL)
         {
-            msg_Err(p_dec, "Failed to create a pool of %d %4.4s pictures",
-                           dpb_size + p_dec->i_extra_picture_buffers + 1,
-                           (char*)&p_dec->fmt_out.video.i_chroma);
+            msg_Err(p_dec, "Failed to create a pool of %u %4.4s pictures",
+                           count, (char*)&p_dec->fmt_out.video.i_chroma);
             goto error;
         }
 
@@ -591,8 +751,13 @@ static int CreateVoutIfNeeded(vlc_input_decoder_t *p_owner)
     p_owner->out_pool = NULL;
     vlc_mutex_unlock( &p_owner->lock );
 
-     if ( pool != NULL )
-         picture_pool_Release( pool );
+    if ( pool != NULL )
+    {
+        if( p_owner->pool_cache != NULL )
+            picture_pool_cache_Put( p_owner->pool_cache, pool );
+        else
+            picture_pool_Release( pool );
+    }
 
     if( p_vout == NULL )
     {
@@ -767,6 +932,34 @@ static int InputThread_GetInputAttachments( decoder_t *p_dec,
     return VLC_SUCCESS;
 }
 
+static unsigned ModuleThread_GetThreadBudget( decoder_t *p_dec, unsigned max )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+    unsigned total = var_InheritInteger( p_dec, "dec-threads" );
+
+    if( total == 0 )
+        total = vlc_GetCPUCount();
+    if( !p_owner->threads_joined )
+        return __MIN( max, total );
+
+    /* Grant an even share of the budget, or what is left of it if earlier
+     * decoders took more, but always at least one thread */
+    vlc_mutex_lock( &decoder_threads.lock );
+    decoder_threads.used -= p_owner->threads;
+
+    unsigned share = total / decoder_threads.decoders;
+    unsigned left = total > decoder_threads.used
+                  ? total - decoder_threads.used : 0;
+    unsigned count = __MAX( 1, __MIN( max, __MIN( share, left ) ) );
+
+    decoder_threads.used += count;
+    p_owner->threads = count;
+    vlc_mutex_unlock( &decoder_threads.lock );
+
+    msg_Dbg( p_dec, "granted %u of %u decoding thread(s)", count, max );
+    return count;
+}
+
 static vlc_tick_t ModuleThread_GetDisplayDate( decoder_t *p_dec,
                                        vlc_tick_t system_now, vlc_tick_t i_ts )
 {
@@ -1107,19 +1300,69 @@ static int ModuleThread_PlayVideo( vlc_input_decoder_t *p_owner, picture_t *p_pi
     return VLC_SUCCESS;
 }
 
+static unsigned ModuleThread_GetHurryLevel( decoder_t *p_dec )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    return atomic_load_explicit( &p_owner->hurry, memory_order_relaxed );
+}
+
+static void ModuleThread_UpdateHurry( vlc_input_decoder_t *p_owner,
+                                      unsigned pictures, unsigned late )
+{
+    p_owner->hurry_pictures += pictures;
+    p_owner->hurry_late += late;
+    if( p_owner->hurry_pictures < DECODER_HURRY_WINDOW )
+        return;
+
+    unsigned level = atomic_load_explicit( &p_owner->hurry,
+                                           memory_order_relaxed );
+    unsigned prev = level;
+
+    /* Hurry more as soon as one picture in 8 is late, but only hurry less
+     * after a while, not to oscillate around the limit */
+    if( p_owner->hurry_late * 8 >= p_owner->hurry_pictures )
+    {
+        p_owner->hurry_clean = 0;
+        if( level < DECODER_HURRY_BIDIR )
+            level++;
+    }
+    else if( p_owner->hurry_late == 0
+          && ++p_owner->hurry_clean >= DECODER_HURRY_RECOVER )
+    {
+        p_owner->hurry_clean = 0;
+        if( level > DECODER_HURRY_NONE )
+            level--;
+    }
+
+    p_owner->hurry_pictures = 0;
+    p_owner->hurry_late = 0;
+
+    if( level != prev )
+    {
+        msg_Dbg( &p_owner->dec, "hurry level %u -> %u", prev, level );
+        atomic_store_explicit( &p_owner->hurry, level, memory_order_relaxed );
+    }
+}
+
 static void ModuleThread_UpdateStatVideo( vlc_input_decoder_t *p_owner,
                                           bool lost )
 {
     unsigned displayed = 0;
     unsigned vout_lost = 0;
     unsigned vout_late = 0;
+    struct input_stats_pacing pacing = { 0 };
     if( p_owner->p_vout != NULL )
     {
-        vout_GetResetStatistic( p_owner->p_vout, &displayed, &vout_lost, &vout_late );
+        vout_GetResetStatistic( p_owner->p_vout, &displayed, &vout_lost, &vout_late,
+                                &pacing );
+        ModuleThread_UpdateHurry( p_owner, displayed + vout_lost,
+                                  vout_lost + vout_late );
     }
     if (lost) vout_lost++;
 
-    decoder_Notify(p_owner, on_new_video_stats, 1, vout_lost, displayed, vout_late);
+    decoder_Notify(p_owner, on_new_video_stats, 1, vout_lost, displayed, vout_late,
+                   &pacing);
 }
 
 static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
@@ -1178,6 +1421,51 @@ static void ModuleThread_QueueThumbnail( decoder_t *p_dec, picture_t *p_pic )
 
 }
 
+static vlc_decoder_device * decoding_get_device( decoder_t *p_dec )
+{
+    VLC_UNUSED(p_dec);
+    // the pictures are handed to the owner, they must be in memory
+    return NULL;
+}
+
+static picture_t *decoding_buffer_new( decoder_t *p_dec )
+{
+    return picture_NewFromFormat( &p_dec->fmt_out.video );
+}
+
+static void ModuleThread_QueueDecodedVideo( decoder_t *p_dec, picture_t *p_pic )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    /* Nothing ever waits for the clock: the owner paces the decoder by
+     * consuming the pictures, and the input by the FIFO backpressure */
+    vlc_mutex_lock( &p_owner->lock );
+    DecoderWaitUnblock( p_owner );
+    vlc_mutex_unlock( &p_owner->lock );
+
+    decoder_Notify(p_owner, on_picture_decoded, p_pic);
+    picture_Release( p_pic );
+}
+
+static int ModuleThread_UpdateDecodedAudioFormat( decoder_t *p_dec )
+{
+    p_dec->fmt_out.audio.i_format = p_dec->fmt_out.i_codec;
+    aout_FormatPrepare( &p_dec->fmt_out.audio );
+    return 0;
+}
+
+static void ModuleThread_QueueDecodedAudio( decoder_t *p_dec, vlc_frame_t *p_block )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    vlc_mutex_lock( &p_owner->lock );
+    DecoderWaitUnblock( p_owner );
+    vlc_mutex_unlock( &p_owner->lock );
+
+    decoder_Notify(p_owner, on_audio_decoded, &p_dec->fmt_out.audio, p_block);
+    block_Release( p_block );
+}
+
 static int ModuleThread_PlayAudio( vlc_input_decoder_t *p_owner, vlc_frame_t *p_audio )
 {
     decoder_t *p_dec = &p_owner->dec;
@@ -1332,19 +1620,64 @@ static void ModuleThread_QueueSpu( decoder_t *p_dec, subpicture_t *p_spu )
     }
 }
 
+/* In low delay mode, video frames are dropped until a random access point
+ * rather than decoded into broken pictures that would delay the first good
+ * one. Frames without a type are kept since there is no telling.
+ *
+ * Streams using intra refresh have no intra frames. The packetizer flags the
+ * frames leading to a recovery point as preroll: those are decoded, and the
+ * wait ends with the first frame it no longer flags. The wait is bounded in
+ * any case. */
+static bool DecoderThread_WaitRap( vlc_input_decoder_t *p_owner,
+                                   const vlc_frame_t *frame )
+{
+    if( !p_owner->wait_rap )
+        return false;
+
+    if( frame->i_flags & BLOCK_FLAG_PREROLL )
+    {
+        p_owner->rap_recovering = true;
+        return false;
+    }
+
+    if( (frame->i_flags & BLOCK_FLAG_TYPE_I)
+     || !(frame->i_flags & BLOCK_FLAG_TYPE_MASK)
+     || p_owner->rap_recovering
+     || ++p_owner->rap_dropped > DECODER_LOW_DELAY_RAP_MAX )
+    {
+        if( p_owner->rap_dropped > DECODER_LOW_DELAY_RAP_MAX )
+            msg_Dbg( &p_owner->dec, "no random access point, resuming" );
+        p_owner->wait_rap = false;
+        p_owner->rap_recovering = false;
+        p_owner->rap_dropped = 0;
+        return false;
+    }
+    return true;
+}
+
 static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_t *frame );
 static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t *frame )
 {
     decoder_t *p_dec = &p_owner->dec;
     struct vlc_tracer *tracer = vlc_object_get_tracer( &p_dec->obj );
 
+    if( frame != NULL && DecoderThread_WaitRap( p_owner, frame ) )
+    {
+        block_Release( frame );
+        return;
+    }
+
     if ( tracer != NULL && frame != NULL )
     {
         vlc_tracer_TraceStreamDTS( tracer, "DEC", p_owner->psz_id, "IN",
                             frame->i_pts, frame->i_dts );
     }
 
+    if ( tracer != NULL )
+        vlc_tracer_TraceSpanBegin( tracer, "DEC", p_owner->psz_id );
     int ret = p_dec->pf_decode( p_dec, frame );
+    if ( tracer != NULL )
+        vlc_tracer_TraceSpanEnd( tracer, "DEC", p_owner->psz_id );
     switch( ret )
     {
         case VLCDEC_SUCCESS:
@@ -1369,6 +1702,43 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t
     }
 }
 
+static void DecoderThread_DecodeBatch( vlc_input_decoder_t *p_owner, vlc_frame_t *chain )
+{
+    decoder_t *p_dec = &p_owner->dec;
+    struct vlc_tracer *tracer = vlc_object_get_tracer( &p_dec->obj );
+
+    while( chain != NULL && DecoderThread_WaitRap( p_owner, chain ) )
+    {
+        vlc_frame_t *next = chain->p_next;
+
+        block_Release( chain );
+        chain = next;
+    }
+    if( chain == NULL )
+        return;
+
+    if ( tracer != NULL )
+    {
+        for( vlc_frame_t *frame = chain; frame != NULL; frame = frame->p_next )
+            vlc_tracer_TraceStreamDTS( tracer, "DEC", p_owner->psz_id, "IN",
+                                       frame->i_pts, frame->i_dts );
+        vlc_tracer_TraceSpanBegin( tracer, "DEC", p_owner->psz_id );
+    }
+    int ret = p_dec->pf_decode_batch( p_dec, chain );
+    if ( tracer != NULL )
+        vlc_tracer_TraceSpanEnd( tracer, "DEC", p_owner->psz_id );
+    switch( ret )
+    {
+        case VLCDEC_SUCCESS:
+            break;
+        case VLCDEC_ECRITICAL:
+            p_owner->error = true;
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+}
+
 /**
  * Decode a frame
  *
@@ -1402,6 +1772,10 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_
         if( frame->i_buffer <= 0 )
             goto error;
 
+        if( p_owner->low_delay && p_dec->fmt_in.i_cat == VIDEO_ES
+         && (frame->i_flags & BLOCK_FLAG_DISCONTINUITY) )
+            p_owner->wait_rap = true;
+
         vlc_mutex_lock( &p_owner->lock );
         DecoderUpdatePreroll( &p_owner->i_preroll_end, frame );
         vlc_mutex_unlock( &p_owner->lock );
@@ -1446,6 +1820,14 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_
             if( p_packetizer->pf_get_cc )
                 PacketizerGetCc( p_owner, p_packetizer );
 
+            if( p_dec->pf_decode_batch != NULL )
+            {
+                DecoderThread_DecodeBatch( p_owner, packetized_frame );
+                if( p_owner->error )
+                    return;
+                continue;
+            }
+
             while( packetized_frame )
             {
                 vlc_frame_t *p_next = packetized_frame->p_next;
@@ -1474,6 +1856,63 @@ error:
         block_Release( frame );
 }
 
+static bool DecoderThread_CanBatch( vlc_input_decoder_t *p_owner )
+{
+    /* Frames are batched only when they go straight from the FIFO to the
+     * decoder module: the packetizer and stream output paths stay per frame,
+     * and so does frame stepping while paused. */
+    if( p_owner->dec.pf_decode_batch == NULL
+     || p_owner->p_packetizer != NULL || p_owner->paused )
+        return false;
+#ifdef ENABLE_SOUT
+    if( p_owner->p_sout != NULL )
+        return false;
+#endif
+    return true;
+}
+
+/**
+ * Decode a chain of frames from the FIFO
+ *
+ * This does the same as calling DecoderThread_ProcessInput() for each frame,
+ * but hands them to the decoder module in a single call.
+ */
+static void DecoderThread_ProcessBatch( vlc_input_decoder_t *p_owner, vlc_frame_t *chain )
+{
+    if( p_owner->error
+     || atomic_load( &p_owner->reload ) != RELOAD_NO_REQUEST )
+    {   /* Leave errors and reloads to the single frame path */
+        while( chain != NULL )
+        {
+            vlc_frame_t *next = chain->p_next;
+
+            chain->p_next = NULL;
+            DecoderThread_ProcessInput( p_owner, chain );
+            chain = next;
+        }
+        return;
+    }
+
+    vlc_mutex_lock( &p_owner->lock );
+    for( vlc_frame_t **pp = &chain; *pp != NULL; )
+    {
+        vlc_frame_t *frame = *pp;
+
+        if( frame->i_buffer == 0 )
+        {
+            *pp = frame->p_next;
+            block_Release( frame );
+            continue;
+        }
+        DecoderUpdatePreroll( &p_owner->i_preroll_end, frame );
+        pp = &frame->p_next;
+    }
+    vlc_mutex_unlock( &p_owner->lock );
+
+    if( chain != NULL )
+        DecoderThread_DecodeBatch( p_owner, chain );
+}
+
 static void DecoderThread_Flush( vlc_input_decoder_t *p_owner )
 {
     decoder_t *p_dec = &p_owner->dec;
@@ -1520,6 +1959,12 @@ static void DecoderThread_Flush( vlc_input_decoder_t *p_owner )
          * vlc_input_decoder_Flush() */
         if( p_owner->out_pool != NULL )
             picture_pool_Cancel( p_owner->out_pool, false );
+
+        p_owner->wait_rap = p_owner->low_delay;
+
+        /* A thumbnailer seeking again expects a new thumbnail */
+        if( p_dec->cbs->video.buffer_new == thumbnailer_buffer_new )
+            p_owner->b_first = true;
     }
     else if( p_dec->fmt_in.i_cat == SPU_ES )
     {
@@ -1638,6 +2083,8 @@ static void *DecoderThread( void *p_data )
     vlc_tick_t delay = 0;
     bool paused = false;
 
+    vlc_CPU_PinThread( VLC_OBJECT(&p_owner->dec), "decoder" );
+
     /* The decoder's main loop */
     vlc_fifo_Lock( p_owner->p_fifo );
 
@@ -1732,10 +2179,28 @@ static void *DecoderThread( void *p_data )
             /* We have emptied the FIFO and there is a pending request to
              * drain. Pass frame = NULL to decoder just once. */
         }
+        else if( DecoderThread_CanBatch( p_owner ) )
+        {   /* Take the following frames as well, up to a limit so as to
+             * still notice flush and pause requests in time */
+            vlc_frame_t **pp_last = &frame->p_next;
 
+            for( unsigned i = 1; i < DECODER_BATCH_MAX; i++ )
+            {
+                vlc_frame_t *next = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
+                if( next == NULL )
+                    break;
+                *pp_last = next;
+                pp_last = &next->p_next;
+            }
+        }
+
+        DecoderFifoAccount( p_owner, vlc_fifo_GetBytes( p_owner->p_fifo ) );
         vlc_fifo_Unlock( p_owner->p_fifo );
 
-        DecoderThread_ProcessInput( p_owner, frame );
+        if( frame != NULL && frame->p_next != NULL )
+            DecoderThread_ProcessBatch( p_owner, frame );
+        else
+            DecoderThread_ProcessInput( p_owner, frame );
 
         if( frame == NULL && p_owner->dec.fmt_in.i_cat == AUDIO_ES )
         {   /* Draining: the decoder is drained and all decoded buffers are
@@ -1767,8 +2232,10 @@ static const struct decoder_owner_callbacks dec_video_cbs =
         .queue_cc = ModuleThread_QueueCc,
         .get_display_date = ModuleThread_GetDisplayDate,
         .get_display_rate = ModuleThread_GetDisplayRate,
+        .get_hurry_level = ModuleThread_GetHurryLevel,
     },
     .get_attachments = InputThread_GetInputAttachments,
+    .get_thread_budget = ModuleThread_GetThreadBudget,
 };
 static const struct decoder_owner_callbacks dec_thumbnailer_cbs =
 {
@@ -1778,6 +2245,25 @@ static const struct decoder_owner_callbacks dec_thumbnailer_cbs =
         .queue = ModuleThread_QueueThumbnail,
     },
     .get_attachments = InputThread_GetInputAttachments,
+    .get_thread_budget = ModuleThread_GetThreadBudget,
+};
+static const struct decoder_owner_callbacks dec_decoding_video_cbs =
+{
+    .video = {
+        .get_device = decoding_get_device,
+        .buffer_new = decoding_buffer_new,
+        .queue = ModuleThread_QueueDecodedVideo,
+    },
+    .get_attachments = InputThread_GetInputAttachments,
+    .get_thread_budget = ModuleThread_GetThreadBudget,
+};
+static const struct decoder_owner_callbacks dec_decoding_audio_cbs =
+{
+    .audio = {
+        .format_update = ModuleThread_UpdateDecodedAudioFormat,
+        .queue = ModuleThread_QueueDecodedAudio,
+    },
+    .get_attachments = InputThread_GetInputAttachments,
 };
 static const struct decoder_owner_callbacks dec_audio_cbs =
 {
@@ -1837,6 +2323,13 @@ CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
     p_owner->p_sout = p_sout;
     p_owner->p_sout_input = NULL;
     p_owner->p_packetizer = NULL;
+    p_owner->threads_joined = false;
+    p_owner->threads = 0;
+    p_owner->low_delay = var_InheritBool( p_dec, "low-delay" );
+    p_owner->pool_cache = NULL;
+    p_owner->wait_rap = p_owner->low_delay && fmt->i_cat == VIDEO_ES;
+    p_owner->rap_recovering = false;
+    p_owner->rap_dropped = 0;
 
     p_owner->b_fmt_description = false;
     p_owner->p_description = NULL;
@@ -1857,6 +2350,10 @@ CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
     p_owner->flushing = false;
     p_owner->b_draining = false;
     atomic_init( &p_owner->reload, RELOAD_NO_REQUEST );
+    atomic_init( &p_owner->hurry, DECODER_HURRY_NONE );
+    p_owner->hurry_pictures = 0;
+    p_owner->hurry_late = 0;
+    p_owner->hurry_clean = 0;
     p_owner->b_idle = false;
 
     p_owner->mouse_event = NULL;
@@ -1871,6 +2368,7 @@ CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
         vlc_object_delete(p_dec);
         return NULL;
     }
+    DecoderFifoJoin( p_owner );
 
     vlc_mutex_init( &p_owner->lock );
     vlc_mutex_init( &p_owner->mouse_lock );
@@ -1903,11 +2401,22 @@ CreateDecoder( vlc_object_t *p_parent, const es_format_t *fmt,
         case VIDEO_ES:
             if( input_type == INPUT_TYPE_THUMBNAILING )
                 p_dec->cbs = &dec_thumbnailer_cbs;
+            else if( input_type == INPUT_TYPE_DECODING )
+                p_dec->cbs = &dec_decoding_video_cbs;
             else
                 p_dec->cbs = &dec_video_cbs;
+            if( p_sout == NULL )
+            {
+                DecoderThreadsJoin( p_owner );
+                p_owner->pool_cache =
+                    picture_pool_cache_New( DECODER_POOL_CACHE_SIZE );
+            }
             break;
         case AUDIO_ES:
-            p_dec->cbs = &dec_audio_cbs;
+            if( input_type == INPUT_TYPE_DECODING )
+                p_dec->cbs = &dec_decoding_audio_cbs;
+            else
+                p_dec->cbs = &dec_audio_cbs;
             break;
         case SPU_ES:
             p_dec->cbs = &dec_spu_cbs;
@@ -1966,17 +2475,21 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner, enum es_format_category
              (char*)&p_dec->fmt_in.i_codec );
 
     decoder_Clean( p_dec );
+    DecoderThreadsRelease( p_owner, true );
     if ( p_owner->out_pool )
     {
         picture_pool_Release( p_owner->out_pool );
         p_owner->out_pool = NULL;
     }
+    if ( p_owner->pool_cache != NULL )
+        picture_pool_cache_Delete( p_owner->pool_cache );
 
     if (p_owner->vctx)
         vlc_video_context_Release( p_owner->vctx );
 
     /* Free all packets still in the decoder fifo. */
     block_FifoRelease( p_owner->p_fifo );
+    DecoderFifoLeave( p_owner );
 
     /* Cleanup */
 #ifdef ENABLE_SOUT
@@ -1993,7 +2506,6 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner, enum es_format_category
         case AUDIO_ES:
             if( p_owner->p_aout )
             {
-                /* TODO: REVISIT gap-less audio */
                 aout_DecDelete( p_owner->p_aout );
                 input_resource_PutAout( p_owner->p_resource, p_owner->p_aout );
             }
@@ -2251,17 +2763,38 @@ void vlc_input_decoder_Decode( vlc_input_decoder_t *p_owner, vlc_frame_t *frame,
             block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
             frame->i_flags |= BLOCK_FLAG_DISCONTINUITY;
         }
+        else if( DecoderFifoOverBudget( p_owner ) )
+        {
+            msg_Warn( &p_owner->dec, "decoder/packetizer fifo over the "
+                      "memory limit, resetting fifo!" );
+            block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+            frame->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+        }
+        /* In low delay mode, late data is better dropped than rendered even
+         * later: restart from the next frames (and random access point). */
+        else if( p_owner->low_delay && p_owner->p_sout == NULL
+              && !p_owner->b_waiting && !p_owner->paused
+              && vlc_fifo_GetCount( p_owner->p_fifo ) >= DECODER_LOW_DELAY_FIFO_MAX )
+        {
+            msg_Warn( &p_owner->dec, "decoder/packetizer fifo too long for "
+                      "low delay, resetting fifo!" );
+            block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+            frame->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+        }
     }
     else
-    if( !p_owner->b_waiting )
-    {   /* The FIFO is not consumed when waiting, so pacing would deadlock VLC.
-         * Locking is not necessary as b_waiting is only read, not written by
-         * the decoder thread. */
-        while( vlc_fifo_GetCount( p_owner->p_fifo ) >= 10 )
+    {   /* The FIFO is not consumed when waiting or paused, so pacing would
+         * deadlock VLC. Locking is not necessary as b_waiting is only read,
+         * not written by the decoder thread. The owner may change those states
+         * from another thread while this one is blocked, so check again after
+         * every wake-up. */
+        while( !p_owner->b_waiting && !p_owner->paused
+            && vlc_fifo_GetCount( p_owner->p_fifo ) >= 10 )
             vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
     }
 
     vlc_fifo_QueueUnlocked( p_owner->p_fifo, frame );
+    DecoderFifoAccount( p_owner, vlc_fifo_GetBytes( p_owner->p_fifo ) );
     vlc_fifo_Unlock( p_owner->p_fifo );
 }
 
@@ -2324,6 +2857,7 @@ void vlc_input_decoder_Flush( vlc_input_decoder_t *p_owner )
 
     /* Empty the fifo */
     block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+    DecoderFifoAccount( p_owner, 0 );
 
     /* Don't need to wait for the DecoderThread to flush. Indeed, if called a
      * second time, this function will clear the FIFO again before anything was
@@ -2338,6 +2872,7 @@ void vlc_input_decoder_Flush( vlc_input_decoder_t *p_owner )
         p_owner->frames_countdown++;
 
     vlc_fifo_Signal( p_owner->p_fifo );
+    vlc_cond_signal( &p_owner->wait_fifo );
 
     vlc_fifo_Unlock( p_owner->p_fifo );
 
@@ -2471,6 +3006,7 @@ void vlc_input_decoder_ChangePause( vlc_input_decoder_t *p_owner,
     p_owner->pause_date = i_date;
     p_owner->frames_countdown = 0;
     vlc_fifo_Signal( p_owner->p_fifo );
+    vlc_cond_signal( &p_owner->wait_fifo );
     vlc_fifo_Unlock( p_owner->p_fifo );
 }
 
@@ -2498,6 +3034,11 @@ void vlc_input_decoder_StartWait( vlc_input_decoder_t *p_owner )
     p_owner->b_waiting = true;
     vlc_cond_signal( &p_owner->wait_request );
     vlc_mutex_unlock( &p_owner->lock );
+
+    /* Unblock any paced input */
+    vlc_fifo_Lock( p_owner->p_fifo );
+    vlc_cond_signal( &p_owner->wait_fifo );
+    vlc_fifo_Unlock( p_owner->p_fifo );
 }
 
 void vlc_input_decoder_StopWait( vlc_input_decoder_t *p_owner )
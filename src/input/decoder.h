@@ -28,6 +28,8 @@
 #include <vlc_codec.h>
 #include <vlc_mouse.h>
 
+struct input_stats_pacing;
+
 struct vlc_input_decoder_callbacks {
     /* notifications */
     void (*on_vout_started)(vlc_input_decoder_t *decoder, vout_thread_t *vout,
@@ -37,9 +39,15 @@ struct vlc_input_decoder_callbacks {
                             void *userdata);
     void (*on_thumbnail_ready)(vlc_input_decoder_t *decoder, picture_t *pic,
                                void *userdata);
+    void (*on_picture_decoded)(vlc_input_decoder_t *decoder, picture_t *pic,
+                               void *userdata);
+    void (*on_audio_decoded)(vlc_input_decoder_t *decoder,
+                             const audio_format_t *fmt, block_t *block,
+                             void *userdata);
 
     void (*on_new_video_stats)(vlc_input_decoder_t *decoder, unsigned decoded,
                                unsigned lost, unsigned displayed, unsigned late,
+                               const struct input_stats_pacing *pacing,
                                void *userdata);
     void (*on_new_audio_stats)(vlc_input_decoder_t *decoder, unsigned decoded,
                                unsigned lost, unsigned played, void *userdata);
@@ -29,6 +29,7 @@
 #include <vlc_common.h>
 #include <vlc_codec.h>
 #include <vlc_atomic.h>
+#include <vlc_list.h>
 #include <vlc_meta.h>
 #include <vlc_modules.h>
 #include <vlc_picture.h>
@@ -43,6 +44,7 @@ void decoder_Init( decoder_t *p_dec, const es_format_t *restrict p_fmt )
     p_dec->pf_get_cc = NULL;
     p_dec->pf_packetize = NULL;
     p_dec->pf_flush = NULL;
+    p_dec->pf_decode_batch = NULL;
     p_dec->p_module = NULL;
 
     es_format_Copy( &p_dec->fmt_in, p_fmt );
@@ -159,10 +161,26 @@ picture_t *decoder_NewPicture( decoder_t *dec )
     return dec->cbs->video.buffer_new( dec );
 }
 
+/* Enough for a few decoders restarting at the same time */
+#define DEVICE_SURFACES_MAX 4
+
+struct vlc_decoder_device_surfaces
+{
+    struct vlc_list node;
+    void *surfaces;
+    void (*release)(void *);
+    size_t key_size;
+    unsigned char key[];
+};
+
 struct vlc_decoder_device_priv
 {
     struct vlc_decoder_device device;
     vlc_atomic_rc_t rc;
+
+    vlc_mutex_t lock;
+    struct vlc_list surfaces; /* most recent first */
+    size_t surfaces_count;
 };
 
 static int decoder_device_Open(void *func, bool forced, va_list ap)
@@ -197,6 +215,9 @@ vlc_decoder_device_Create(vlc_object_t *o, vout_window_t *window)
     }
     assert(priv->device.ops != NULL);
     vlc_atomic_rc_init(&priv->rc);
+    vlc_mutex_init(&priv->lock);
+    vlc_list_init(&priv->surfaces);
+    priv->surfaces_count = 0;
     return &priv->device;
 }
 
@@ -216,6 +237,15 @@ vlc_decoder_device_Release(vlc_decoder_device *device)
             container_of(device, struct vlc_decoder_device_priv, device);
     if (vlc_atomic_rc_dec(&priv->rc))
     {
+        struct vlc_decoder_device_surfaces *entry;
+
+        /* The surfaces depend on the device */
+        vlc_list_foreach(entry, &priv->surfaces, node)
+        {
+            entry->release(entry->surfaces);
+            free(entry);
+        }
+
         if (device->ops->close != NULL)
             device->ops->close(device);
         vlc_objres_clear(VLC_OBJECT(device));
@@ -223,6 +253,74 @@ vlc_decoder_device_Release(vlc_decoder_device *device)
     }
 }
 
+void
+vlc_decoder_device_PutSurfaces(vlc_decoder_device *device,
+                               const void *key, size_t key_size,
+                               void *surfaces, void (*release)(void *))
+{
+    struct vlc_decoder_device_priv *priv =
+            container_of(device, struct vlc_decoder_device_priv, device);
+    struct vlc_decoder_device_surfaces *entry =
+        malloc(sizeof (*entry) + key_size);
+
+    if (unlikely(entry == NULL))
+    {
+        release(surfaces);
+        return;
+    }
+
+    entry->surfaces = surfaces;
+    entry->release = release;
+    entry->key_size = key_size;
+    memcpy(entry->key, key, key_size);
+
+    struct vlc_decoder_device_surfaces *oldest = NULL;
+
+    vlc_mutex_lock(&priv->lock);
+    vlc_list_prepend(&entry->node, &priv->surfaces);
+    if (priv->surfaces_count < DEVICE_SURFACES_MAX)
+        priv->surfaces_count++;
+    else
+    {
+        oldest = vlc_list_last_entry_or_null(&priv->surfaces,
+                                             struct vlc_decoder_device_surfaces,
+                                             node);
+        vlc_list_remove(&oldest->node);
+    }
+    vlc_mutex_unlock(&priv->lock);
+
+    if (oldest != NULL)
+    {
+        oldest->release(oldest->surfaces);
+        free(oldest);
+    }
+}
+
+void *
+vlc_decoder_device_TakeSurfaces(vlc_decoder_device *device,
+                                const void *key, size_t key_size)
+{
+    struct vlc_decoder_device_priv *priv =
+            container_of(device, struct vlc_decoder_device_priv, device);
+    struct vlc_decoder_device_surfaces *entry;
+    void *surfaces = NULL;
+
+    vlc_mutex_lock(&priv->lock);
+    vlc_list_foreach(entry, &priv->surfaces, node)
+        if (entry->key_size == key_size
+         && memcmp(entry->key, key, key_size) == 0)
+        {
+            vlc_list_remove(&entry->node);
+            priv->surfaces_count--;
+            surfaces = entry->surfaces;
+            free(entry);
+            break;
+        }
+    vlc_mutex_unlock(&priv->lock);
+
+    return surfaces;
+}
+
 /* video context */
 
 struct vlc_video_context
@@ -276,10 +374,11 @@ void vlc_video_context_Release(vlc_video_context *vctx)
 {
     if ( vlc_atomic_rc_dec( &vctx->rc ) )
     {
-        if (vctx->device)
-            vlc_decoder_device_Release( vctx->device );
+        /* The private data may use the device until the end */
         if ( vctx->ops && vctx->ops->destroy )
             vctx->ops->destroy( vlc_video_context_GetPrivate(vctx, vctx->private_type) );
+        if (vctx->device)
+            vlc_decoder_device_Release( vctx->device );
         free(vctx);
     }
 }
@@ -69,6 +69,67 @@ static const char *demux_NameFromMimeType(const char *mime)
     return (type != NULL) ? type->name : "any";
 }
 
+static bool demux_IsTS(const uint8_t *peek, size_t size, size_t offset,
+                       size_t packet)
+{
+    for (unsigned i = 0; i < 3; i++, offset += packet)
+        if (offset >= size || peek[offset] != 0x47)
+            return false;
+    return true;
+}
+
+/**
+ * Guesses the demux from the first bytes of the stream.
+ *
+ * This only recognizes unambiguous signatures, so that the matching demux
+ * can be probed first rather than after all the demuxers of higher priority.
+ * The demux still probes the stream as usual.
+ */
+static const char *demux_NameFromContent(stream_t *s)
+{
+    static const struct
+    {
+        unsigned char offset;
+        unsigned char length;
+        char const magic[10];
+        char const name[6];
+    } sigs[] =
+    {
+        { 0, 4, "\x1A\x45\xDF\xA3",     "mkv"  },
+        { 0, 4, "OggS",                 "ogg"  },
+        { 0, 4, "fLaC",                 "flac" },
+        { 0, 4, "\x00\x00\x01\xBA",     "ps"   },
+        { 0, 8, "\x30\x26\xB2\x75\x8E\x66\xCF\x11", "asf" },
+        { 4, 4, "ftyp",                 "mp4"  },
+        { 4, 4, "styp",                 "mp4"  },
+        { 4, 4, "moov",                 "mp4"  },
+        { 4, 4, "moof",                 "mp4"  },
+        { 8, 4, "AVI ",                 "avi"  },
+        { 8, 4, "WAVE",                 "wav"  },
+        { 0, 3, "ID3",                  "es"   },
+    };
+    const uint8_t *peek;
+    ssize_t size = vlc_stream_Peek(s, &peek, 4 + 3 * 192);
+
+    if (size <= 0)
+        return NULL;
+
+    /* MPEG-TS, with plain or time-stamped (M2TS) packets */
+    if (demux_IsTS(peek, size, 0, 188) || demux_IsTS(peek, size, 4, 192))
+        return "ts";
+
+    for (size_t i = 0; i < ARRAY_SIZE(sigs); i++)
+        if ((size_t)size >= (size_t)sigs[i].offset + sigs[i].length
+         && memcmp(peek + sigs[i].offset, sigs[i].magic, sigs[i].length) == 0)
+        {
+            /* RIFF files are told apart by their form type */
+            if (sigs[i].offset == 8 && memcmp(peek, "RIFF", 4))
+                continue;
+            return sigs[i].name;
+        }
+    return NULL;
+}
+
 demux_t *demux_New( vlc_object_t *p_obj, const char *module, const char *url,
                     stream_t *s, es_out_t *out )
 {
@@ -79,6 +140,7 @@ demux_t *demux_New( vlc_object_t *p_obj, const char *module, const char *url,
 struct vlc_demux_private
 {
     module_t *module;
+    bool sniffed; /* the named module was only guessed from the content */
 };
 
 static void demux_DestroyDemux(demux_t *demux)
@@ -97,6 +159,7 @@ static int demux_Probe(void *func, bool forced, va_list ap)
 {
     int (*probe)(vlc_object_t *) = func;
     demux_t *demux = va_arg(ap, demux_t *);
+    struct vlc_demux_private *priv = vlc_stream_Private(demux);
 
     /* Restore input stream offset (in case previous probed demux failed to
      * to do so). */
@@ -106,7 +169,7 @@ static int demux_Probe(void *func, bool forced, va_list ap)
         return VLC_EGENERIC;
     }
 
-    demux->obj.force = forced;
+    demux->obj.force = forced && !priv->sniffed;
 
     int ret = probe(VLC_OBJECT(demux));
     if (ret)
@@ -114,6 +177,18 @@ static int demux_Probe(void *func, bool forced, va_list ap)
     return ret;
 }
 
+static bool demux_HasModule(const char *name)
+{
+    module_t **mods;
+    size_t count;
+    ssize_t total = vlc_module_match("demux", name, true, &mods, &count);
+
+    if (total < 0)
+        return true;
+    free(mods);
+    return total > 0;
+}
+
 demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
                             const char *module, const char *url,
                             stream_t *s, es_out_t *out, bool b_preparsing )
@@ -160,6 +235,7 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
     p_demux->pf_demux   = NULL;
     p_demux->pf_control = NULL;
     p_demux->p_sys      = NULL;
+    priv->sniffed       = false;
 
     char *modbuf = NULL;
     bool strict = true;
@@ -191,6 +267,20 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
         strict = false;
     }
 
+    if (!strict && (strcasecmp(module, "any") == 0
+                 || (modbuf != NULL && !demux_HasModule(modbuf))))
+    {
+        /* No demux by content type or extension: guess from the content */
+        const char *name = demux_NameFromContent(s);
+
+        if (name != NULL)
+        {
+            msg_Dbg(p_demux, "content looks like \"%s\"", name);
+            module = name;
+            priv->sniffed = true;
+        }
+    }
+
     priv->module = vlc_module_load(p_demux, "demux", module, strict,
                                    demux_Probe, p_demux);
     free(modbuf);
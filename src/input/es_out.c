@@ -129,6 +129,14 @@ struct es_out_id_t
     char        *psz_title;
     bool        b_terminated;
 
+    /* The decoders are written with both the es_out lock and send_lock
+     * held, so that EsOutSend() can feed them with send_lock only. A sender
+     * does not keep send_lock while the decoders may block (pacing): it is
+     * accounted in senders instead, and the decoders are not deleted until
+     * send_wait tells it is gone. */
+    vlc_mutex_t send_lock;
+    vlc_cond_t send_wait;
+    unsigned senders;
     vlc_input_decoder_t   *p_dec;
     vlc_input_decoder_t   *p_dec_record;
     vlc_clock_t *p_clock;
@@ -185,6 +193,7 @@ typedef struct
     es_out_pgrm_t *p_pgrm;  /* Master program */
 
     enum vlc_clock_master_source user_clock_source;
+    enum input_clock_recovery clock_recovery;
 
     /* all es */
     int         i_id;
@@ -310,6 +319,32 @@ default_val:
     return VLC_CLOCK_MASTER_AUTO;
 }
 
+static enum input_clock_recovery
+clock_recovery_Inherit(vlc_object_t *obj)
+{
+    static const struct
+    {
+        char key[sizeof("regression")];
+        enum input_clock_recovery val;
+    } clock_recovery_list[] =
+    {
+        { "average", INPUT_CLOCK_RECOVERY_AVERAGE },
+        { "pll", INPUT_CLOCK_RECOVERY_PLL },
+        { "regression", INPUT_CLOCK_RECOVERY_REGRESSION },
+    };
+    enum input_clock_recovery val = INPUT_CLOCK_RECOVERY_AVERAGE;
+
+    char *str = var_InheritString(obj, "clock-recovery");
+    if (str == NULL)
+        return val;
+
+    for (size_t i = 0; i < ARRAY_SIZE(clock_recovery_list); i++)
+        if (strcasecmp(str, clock_recovery_list[i].key) == 0)
+            val = clock_recovery_list[i].val;
+    free(str);
+    return val;
+}
+
 static inline int EsOutGetClosedCaptionsChannel( const es_format_t *p_fmt )
 {
     int i_channel;
@@ -391,9 +426,53 @@ decoder_on_thumbnail_ready(vlc_input_decoder_t *decoder, picture_t *pic, void *u
     input_SendEvent(p_sys->p_input, &event);
 }
 
+static void
+decoder_on_picture_decoded(vlc_input_decoder_t *decoder, picture_t *pic,
+                           void *userdata)
+{
+    (void) decoder;
+
+    es_out_id_t *id = userdata;
+    es_out_t *out = id->out;
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    if (!p_sys->p_input)
+        return;
+
+    struct vlc_input_event event = {
+        .type = INPUT_EVENT_PICTURE_DECODED,
+        .picture = pic,
+    };
+
+    input_SendEvent(p_sys->p_input, &event);
+}
+
+static void
+decoder_on_audio_decoded(vlc_input_decoder_t *decoder,
+                         const audio_format_t *fmt, block_t *block,
+                         void *userdata)
+{
+    (void) decoder;
+
+    es_out_id_t *id = userdata;
+    es_out_t *out = id->out;
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    if (!p_sys->p_input)
+        return;
+
+    struct vlc_input_event event = {
+        .type = INPUT_EVENT_AUDIO_DECODED,
+        .audio = { .fmt = fmt, .block = block },
+    };
+
+    input_SendEvent(p_sys->p_input, &event);
+}
+
 static void
 decoder_on_new_video_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsigned lost,
-                           unsigned displayed, unsigned late, void *userdata)
+                           unsigned displayed, unsigned late,
+                           const struct input_stats_pacing *pacing, void *userdata)
 {
     (void) decoder;
 
@@ -416,6 +495,7 @@ decoder_on_new_video_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsig
                               memory_order_relaxed);
     atomic_fetch_add_explicit(&stats->late_pictures, late,
                               memory_order_relaxed);
+    input_stats_AddPacing(stats, pacing);
 }
 
 static void
@@ -464,6 +544,8 @@ static const struct vlc_input_decoder_callbacks decoder_cbs = {
     .on_vout_started = decoder_on_vout_started,
     .on_vout_stopped = decoder_on_vout_stopped,
     .on_thumbnail_ready = decoder_on_thumbnail_ready,
+    .on_picture_decoded = decoder_on_picture_decoded,
+    .on_audio_decoded = decoder_on_audio_decoded,
     .on_new_video_stats = decoder_on_new_video_stats,
     .on_new_audio_stats = decoder_on_new_audio_stats,
     .get_attachments = decoder_get_attachments,
@@ -570,6 +652,7 @@ es_out_t *input_EsOutNew( input_thread_t *p_input, input_source_t *main_source,
     p_sys->i_group_id = var_GetInteger( p_input, "program" );
 
     p_sys->user_clock_source = clock_source_Inherit( VLC_OBJECT(p_input) );
+    p_sys->clock_recovery = clock_recovery_Inherit( VLC_OBJECT(p_input) );
 
     p_sys->i_pause_date = -1;
 
@@ -646,6 +729,31 @@ static void EsHold(es_out_id_t *es)
     vlc_atomic_rc_inc(&es->rc);
 }
 
+/**
+ * Replaces one of the decoders of an ES.
+ *
+ * Must be called with the es_out lock held.
+ * \return the previous decoder, if any, no longer used by any sender
+ */
+static vlc_input_decoder_t *EsSetDecoder(es_out_id_t *es,
+                                         vlc_input_decoder_t **slot,
+                                         vlc_input_decoder_t *dec)
+{
+    vlc_mutex_lock(&es->send_lock);
+    vlc_input_decoder_t *old = *slot;
+    *slot = dec;
+
+    if (old != NULL && es->senders > 0)
+    {   /* The previous decoder is going away: empty it so that a sender
+         * pacing on it returns, and wait for the sender to leave. */
+        vlc_input_decoder_Flush(old);
+        while (es->senders > 0)
+            vlc_cond_wait(&es->send_wait, &es->send_lock);
+    }
+    vlc_mutex_unlock(&es->send_lock);
+    return old;
+}
+
 static void EsOutDelete( es_out_t *out )
 {
     es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
@@ -851,15 +959,16 @@ static int EsOutSetRecord(  es_out_t *out, bool b_record )
             if( !p_es->p_dec )
                 continue;
 
-            p_es->p_dec_record =
+            vlc_input_decoder_t *dec_record =
                 vlc_input_decoder_New( VLC_OBJECT(p_input), &p_es->fmt,
                                        p_es->id.str_id, NULL,
                                        input_priv(p_input)->p_resource,
                                        p_sys->p_sout_record, INPUT_TYPE_NONE,
                                        &decoder_cbs, p_es );
 
-            if( p_es->p_dec_record && p_sys->b_buffering )
-                vlc_input_decoder_StartWait( p_es->p_dec_record );
+            if( dec_record && p_sys->b_buffering )
+                vlc_input_decoder_StartWait( dec_record );
+            EsSetDecoder( p_es, &p_es->p_dec_record, dec_record );
         }
     }
     else
@@ -869,8 +978,8 @@ static int EsOutSetRecord(  es_out_t *out, bool b_record )
             if( !p_es->p_dec_record )
                 continue;
 
-            vlc_input_decoder_Delete( p_es->p_dec_record );
-            p_es->p_dec_record = NULL;
+            vlc_input_decoder_Delete(
+                EsSetDecoder( p_es, &p_es->p_dec_record, NULL ) );
         }
 #ifdef ENABLE_SOUT
         sout_StreamChainDelete( p_sys->p_sout_record, NULL );
@@ -999,11 +1108,17 @@ static void EsOutDecodersStopBuffering( es_out_t *out, bool b_forced )
     if( p_sys->i_preroll_end >= 0 )
         i_preroll_duration = __MAX( p_sys->i_preroll_end - i_stream_start, 0 );
 
-    const vlc_tick_t i_buffering_duration = p_sys->i_pts_delay +
-                                         p_sys->i_pts_jitter +
-                                         p_sys->i_tracks_pts_delay +
-                                         i_preroll_duration +
-                                         p_sys->i_buffering_extra_stream - p_sys->i_buffering_extra_initial;
+    vlc_tick_t i_buffering_duration = p_sys->i_pts_delay +
+                                   p_sys->i_pts_jitter +
+                                   p_sys->i_tracks_pts_delay +
+                                   i_preroll_duration +
+                                   p_sys->i_buffering_extra_stream - p_sys->i_buffering_extra_initial;
+
+    /* In low delay mode, start decoding as soon as the clock has a reference:
+     * the data still waits for its date in the outputs, but the decoders get
+     * ready meanwhile. */
+    if( input_priv(p_sys->p_input)->b_low_delay )
+        i_buffering_duration = 0;
 
     if( i_stream_duration <= i_buffering_duration && !b_forced )
     {
@@ -1514,7 +1629,8 @@ static es_out_pgrm_t *EsOutProgramAdd( es_out_t *out, input_source_t *source, in
         return NULL;
     }
 
-    p_pgrm->p_input_clock = input_clock_New( p_sys->rate );
+    p_pgrm->p_input_clock = input_clock_New( p_sys->rate,
+                                             p_sys->clock_recovery );
     if( !p_pgrm->p_input_clock )
     {
         vlc_clock_main_Delete( p_pgrm->p_main_clock );
@@ -1842,8 +1958,9 @@ static void EsOutProgramEpg( es_out_t *out, input_source_t *source,
     epg = *p_epg;
     epg.psz_name = EsOutProgramGetProgramName( p_pgrm );
 
-    input_item_SetEpg( p_item, &epg, p_sys->p_pgrm && (p_epg->i_source_id == p_sys->p_pgrm->i_id) );
-    input_SendEventMetaEpg( p_sys->p_input );
+    if( input_item_SetEpg( p_item, &epg, p_sys->p_pgrm &&
+                           (p_epg->i_source_id == p_sys->p_pgrm->i_id) ) )
+        input_SendEventMetaEpg( p_sys->p_input );
 
     free( epg.psz_name );
 
@@ -1948,6 +2065,7 @@ static void EsOutMeta( es_out_t *p_out, const vlc_meta_t *p_meta, const vlc_meta
     if( p_meta )
         vlc_meta_Merge( p_item->p_meta, p_meta );
     vlc_mutex_unlock( &p_item->lock );
+    input_item_ReclaimMetaSnapshots( p_item );
 
     /* Check program meta to not override GROUP_META values */
     if( p_meta && (!p_program_meta || vlc_meta_Get( p_program_meta, vlc_meta_Title ) == NULL) &&
@@ -2217,6 +2335,9 @@ static es_out_id_t *EsOutAddLocked( es_out_t *out, input_source_t *source,
     es->psz_language = LanguageGetName( es->fmt.psz_language ); /* remember so we only need to do it once */
     es->psz_language_code = LanguageGetCode( es->fmt.psz_language );
     es->psz_title = EsGetTitle(es);
+    vlc_mutex_init(&es->send_lock);
+    vlc_cond_init(&es->send_wait);
+    es->senders = 0;
     es->p_dec = NULL;
     es->p_dec_record = NULL;
     es->p_clock = NULL;
@@ -2354,13 +2475,14 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
 
         if( !p_es->p_master && p_sys->p_sout_record )
         {
-            p_es->p_dec_record =
+            vlc_input_decoder_t *dec_record =
                 vlc_input_decoder_New( VLC_OBJECT(p_input), &p_es->fmt,
                                        p_es->id.str_id, NULL,
                                        priv->p_resource, p_sys->p_sout_record,
                                        INPUT_TYPE_NONE, &decoder_cbs, p_es );
-            if( p_es->p_dec_record && p_sys->b_buffering )
-                vlc_input_decoder_StartWait( p_es->p_dec_record );
+            if( dec_record && p_sys->b_buffering )
+                vlc_input_decoder_StartWait( dec_record );
+            EsSetDecoder( p_es, &p_es->p_dec_record, dec_record );
         }
 
         if( p_es->mouse_event_cb && p_es->fmt.i_cat == VIDEO_ES )
@@ -2372,7 +2494,7 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
         vlc_clock_Delete( p_es->p_clock );
         p_es->p_clock = NULL;
     }
-    p_es->p_dec = dec;
+    EsSetDecoder( p_es, &p_es->p_dec, dec );
 
     EsOutDecoderChangeDelay( out, p_es );
 }
@@ -2385,18 +2507,15 @@ static void EsOutDestroyDecoder( es_out_t *out, es_out_id_t *p_es )
 
     assert( p_es->p_pgrm );
 
-    vlc_input_decoder_Delete( p_es->p_dec );
-    p_es->p_dec = NULL;
+    vlc_input_decoder_Delete( EsSetDecoder( p_es, &p_es->p_dec, NULL ) );
     if( p_es->p_pgrm->p_master_es_clock == p_es->p_clock )
         p_es->p_pgrm->p_master_es_clock = NULL;
     vlc_clock_Delete( p_es->p_clock );
     p_es->p_clock = NULL;
 
     if( p_es->p_dec_record )
-    {
-        vlc_input_decoder_Delete( p_es->p_dec_record );
-        p_es->p_dec_record = NULL;
-    }
+        vlc_input_decoder_Delete(
+            EsSetDecoder( p_es, &p_es->p_dec_record, NULL ) );
 
     es_format_Clean( &p_es->fmt_out );
 }
@@ -2406,6 +2525,7 @@ static void EsOutSelectEs( es_out_t *out, es_out_id_t *es, bool b_force )
     es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
     input_thread_t *p_input = p_sys->p_input;
     bool b_thumbnailing = p_sys->input_type == INPUT_TYPE_THUMBNAILING;
+    bool b_decoding = p_sys->input_type == INPUT_TYPE_DECODING;
 
     if( EsIsSelected( es ) )
     {
@@ -2457,7 +2577,7 @@ static void EsOutSelectEs( es_out_t *out, es_out_id_t *es, bool b_force )
             }
             if( es->fmt.i_cat == SPU_ES )
             {
-                if( b_thumbnailing
+                if( b_thumbnailing || b_decoding
                  || !var_GetBool( p_input, b_sout ? "sout-spu" : "spu" ) )
                 {
                     msg_Dbg( p_input, "spu is disabled, not selecting ES 0x%x",
@@ -2968,6 +3088,22 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
         return VLC_SUCCESS;
     }
 
+    /* Account for the delay from the reception to the rendering */
+    if( stats != NULL && es->fmt.i_cat != SPU_ES && !p_sys->b_buffering
+     && !input_CanPaceControl( p_input ) )
+    {
+        vlc_tick_t i_date = p_block->i_pts != VLC_TICK_INVALID ?
+                            p_block->i_pts : p_block->i_dts;
+        if( i_date != VLC_TICK_INVALID )
+        {
+            vlc_tick_t i_latency =
+                input_clock_GetLatency( es->p_pgrm->p_input_clock, i_date,
+                                        vlc_tick_now() );
+            if( i_latency != VLC_TICK_INVALID )
+                input_stats_AddLatency( stats, i_latency );
+        }
+    }
+
 #ifdef ENABLE_SOUT
     /* Check for sout mode */
     if( input_priv(p_input)->p_sout )
@@ -2982,16 +3118,37 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
     }
 #endif
 
-    /* Decode */
-    if( es->p_dec_record )
+    /* Decode. Queuing may block until the decoder catches up (pacing), so
+     * no lock is held meanwhile: the sender is accounted in the ES instead.
+     * This still paces the demux thread, and thus all its ES. */
+    bool b_do_pace = input_priv(p_input)->b_out_pace_control;
+
+    vlc_mutex_lock( &es->send_lock );
+    vlc_mutex_unlock( &p_sys->lock );
+    vlc_input_decoder_t *dec = es->p_dec;
+    vlc_input_decoder_t *dec_record = es->p_dec_record;
+    es->senders++;
+    vlc_mutex_unlock( &es->send_lock );
+
+    if( dec_record != NULL )
     {
         block_t *p_dup = block_Duplicate( p_block );
         if( p_dup )
-            vlc_input_decoder_Decode( es->p_dec_record, p_dup,
-                                      input_priv(p_input)->b_out_pace_control );
+            vlc_input_decoder_Decode( dec_record, p_dup, b_do_pace );
+    }
+    vlc_input_decoder_Decode( dec, p_block, b_do_pace );
+
+    vlc_mutex_lock( &es->send_lock );
+    if( --es->senders == 0 )
+        vlc_cond_broadcast( &es->send_wait );
+    vlc_mutex_unlock( &es->send_lock );
+
+    vlc_mutex_lock( &p_sys->lock );
+    if( !es->p_dec )
+    {   /* Destroyed in the mean time */
+        vlc_mutex_unlock( &p_sys->lock );
+        return VLC_SUCCESS;
     }
-    vlc_input_decoder_Decode( es->p_dec, p_block,
-                              input_priv(p_input)->b_out_pace_control );
 
     struct vlc_input_decoder_status status;
     vlc_input_decoder_GetStatus( es->p_dec, &status );
@@ -3373,12 +3530,22 @@ static int EsOutVaControlLocked( es_out_t *out, input_source_t *source,
         /* TODO do not use vlc_tick_now() but proper stream acquisition date */
         const bool b_low_delay = priv->b_low_delay;
         bool b_extra_buffering_allowed = !b_low_delay && EsOutIsExtraBufferingAllowed( out );
+        const bool b_can_pace_control =
+            input_CanPaceControl(p_sys->p_input) || p_sys->b_buffering;
         vlc_tick_t i_late = input_clock_Update(
                             p_pgrm->p_input_clock, VLC_OBJECT(p_sys->p_input),
-                            input_CanPaceControl(p_sys->p_input) || p_sys->b_buffering,
-                            b_extra_buffering_allowed,
+                            b_can_pace_control, b_extra_buffering_allowed,
                             i_pcr, vlc_tick_now() );
 
+        if( priv->stats != NULL && !b_can_pace_control )
+        {
+            vlc_tick_t i_jitter;
+            double f_drift;
+
+            input_clock_GetHealth( p_pgrm->p_input_clock, &i_jitter, &f_drift );
+            input_stats_AddClock( priv->stats, i_jitter, f_drift );
+        }
+
         if( !p_sys->p_pgrm )
             return VLC_SUCCESS;
 
@@ -3978,6 +4145,9 @@ static int EsOutVaPrivControlLocked( es_out_t *out, int query, va_list args )
         }
         return ret;
     }
+    case ES_OUT_PRIV_TIMESHIFT_JUMP:
+        /* Not delayed */
+        return VLC_EGENERIC;
     default: vlc_assert_unreachable();
     }
 
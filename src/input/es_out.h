@@ -96,7 +96,10 @@ enum es_out_query_private_e
     ES_OUT_PRIV_SET_VBI_PAGE,                       /* arg1=unsigned res=can fail */
 
     /* Set VBI/Teletext menu transparent */
-    ES_OUT_PRIV_SET_VBI_TRANSPARENCY                /* arg1=bool res=can fail */
+    ES_OUT_PRIV_SET_VBI_TRANSPARENCY,               /* arg1=bool res=can fail */
+
+    /* Move within the timeshift buffer */
+    ES_OUT_PRIV_TIMESHIFT_JUMP,                     /* arg1=vlc_tick_t i_offset res=can fail */
 };
 
 static inline int es_out_vaPrivControl( es_out_t *out, int query, va_list args )
@@ -242,6 +245,11 @@ static inline int es_out_SetVbiTransparency( es_out_t *p_out, vlc_es_id_t *id,
                                enabled );
 }
 
+static inline int es_out_TimeshiftJump( es_out_t *p_out, vlc_tick_t i_offset )
+{
+    return es_out_PrivControl( p_out, ES_OUT_PRIV_TIMESHIFT_JUMP, i_offset );
+}
+
 es_out_t  *input_EsOutNew( input_thread_t *, input_source_t *main_source, float rate,
                            enum input_type input_type );
 es_out_t  *input_EsOutTimeshiftNew( input_thread_t *, es_out_t *, float i_rate );
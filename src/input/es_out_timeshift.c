@@ -36,6 +36,10 @@
 #endif
 #include <sys/stat.h>
 #include <unistd.h>
+#ifdef HAVE_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_fs.h>
@@ -92,10 +96,7 @@ typedef struct attribute_packed
 {
     ts_cmd_header_t header;
     es_out_id_t *p_es;
-    union{
-        block_t *p_block;
-        int     i_offset;  /* We do not use file > INT_MAX */
-    };
+    block_t *p_block;
 } ts_cmd_send_t;
 
 typedef struct attribute_packed
@@ -188,25 +189,60 @@ static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_send_t, header), "in
 static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_control_t, header), "invalid packing");
 static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_privcontrol_t, header), "invalid packing");
 
+/* Minimal interval between two random access points */
+#define TS_INDEX_INTERVAL VLC_TICK_FROM_SEC(1)
+#define TS_INDEX_KEYFRAME_INTERVAL VLC_TICK_FROM_MS(500)
+
+/* Block data as stored after a C_SEND command */
+typedef struct attribute_packed
+{
+    size_t     i_buffer;
+    uint32_t   i_flags;
+    unsigned   i_nb_samples;
+    vlc_tick_t i_pts;
+    vlc_tick_t i_dts;
+    vlc_tick_t i_length;
+} ts_block_t;
+
+/* Random access point */
+typedef struct
+{
+    vlc_tick_t i_date;  /* Date of the command */
+    size_t     i_offset;/* Offset of the command in the segment */
+} ts_index_t;
+
+typedef struct
+{
+    uint64_t   i_seq;
+    size_t     i_offset;
+} ts_pos_t;
+
+/* A storage segment is a temporary file holding a sequence of commands (and
+ * the data of the blocks they send). The file is mapped in memory when
+ * possible, so that commands are written and read with plain copies and
+ * the kernel writes them back sequentially. */
 typedef struct ts_storage_t ts_storage_t;
 struct ts_storage_t
 {
+    ts_storage_t *p_prev;
     ts_storage_t *p_next;
+    uint64_t i_seq;     /* Position of the segment in the stream */
 
     /* */
 #ifdef _WIN32
     char    *psz_file;  /* Filename */
 #endif
+    int     fd;
+    uint8_t *p_map;     /* Mapping of the file, or NULL */
     size_t  i_file_max; /* Max size in bytes */
-    int64_t i_file_size;/* Current size in bytes */
-    FILE    *p_filew;   /* FILE handle for data writing */
-    FILE    *p_filer;   /* FILE handle for data reading */
+    size_t  i_write;    /* End of the written commands */
+    size_t  i_read;     /* Next command to read */
+    size_t  i_done;     /* End of the commands already read once */
 
     /* */
-    uint8_t *p_cmd_r;
-    uint8_t *p_cmd_w;
-    uint8_t *p_cmd_buf;
-    size_t   i_cmd_buf;
+    ts_index_t *p_index;
+    size_t      i_index;
+    size_t      i_index_max;
 };
 
 typedef struct
@@ -216,6 +252,7 @@ typedef struct
     es_out_t       *p_tsout;
     es_out_t       *p_out;
     int64_t        i_tmp_size_max;
+    int64_t        i_history_max;
     const char     *psz_tmp_path;
 
     /* Lock for all following fields */
@@ -237,10 +274,21 @@ typedef struct
     vlc_tick_t     i_buffering_delay;
 
     /* */
+    ts_storage_t   *p_storage_first; /* Oldest segment */
     ts_storage_t   *p_storage_r;
     ts_storage_t   *p_storage_w;
+    uint64_t       i_storage_seq;
+
+    /* */
+    bool           b_index_keyframe; /* The stream flags its key frames */
+    vlc_tick_t     i_index_date;
+    ts_pos_t       floor;            /* Cannot go back before this point */
+    ts_storage_t   *p_skip;          /* Commands before this point are skipped */
+    size_t         i_skip;
+    bool           b_reset_pcr;
 
     vlc_tick_t     i_cmd_delay;
+    vlc_tick_t     i_read_date;      /* Date of the last command read */
 
 } ts_thread_t;
 
@@ -256,6 +304,7 @@ typedef struct
 
     /* Configuration */
     int64_t        i_tmp_size_max;    /* Maximal temporary file size in byte */
+    int64_t        i_history_max;     /* Size of the data kept after reading */
     char           *psz_tmp_path;     /* Path for temporary files */
 
     /* Lock for all following fields */
@@ -290,18 +339,22 @@ static bool         TsHasCmd( ts_thread_t * );
 static bool         TsIsUnused( ts_thread_t * );
 static int          TsChangePause( ts_thread_t *, bool b_source_paused, bool b_paused, vlc_tick_t i_date );
 static int          TsChangeRate( ts_thread_t *, float src_rate, float rate );
+static int          TsJump( ts_thread_t *, vlc_tick_t i_offset );
 
 static void         *TsRun( void * );
 
-static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_tmp_size_max );
+static ts_storage_t *TsStorageNew( const char *psz_path, size_t i_size );
 static void         TsStorageDelete( ts_storage_t * );
-static void         TsStoragePack( ts_storage_t *p_storage );
+static size_t       TsStorageSizeofRecord( const ts_cmd_t *p_cmd );
 static bool         TsStorageIsFull( ts_storage_t *, const ts_cmd_t *p_cmd );
 static bool         TsStorageIsEmpty( ts_storage_t * );
-static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd, bool b_flush );
-static void         TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush );
+static void         TsStorageIndex( ts_storage_t *, vlc_tick_t i_date );
+static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd );
+static int          TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush );
 
 static void CmdClean( ts_cmd_t * );
+static void CmdExecute( es_out_t *, ts_cmd_t * );
+static bool CmdIsReplayable( const ts_cmd_t * );
 
 static int  CmdInitAdd    ( ts_cmd_add_t *, input_source_t *, es_out_id_t *, const es_format_t *, bool b_copy );
 static void CmdInitSend   ( ts_cmd_send_t *, es_out_id_t *, block_t * );
@@ -361,6 +414,9 @@ es_out_t *input_EsOutTimeshiftNew( input_thread_t *p_input, es_out_t *p_next_out
     msg_Dbg( p_input, "using timeshift granularity of %d MiB",
              (int)p_sys->i_tmp_size_max/(1024*1024) );
 
+    const int64_t i_history_max = var_InheritInteger( p_input, "input-timeshift-history" );
+    p_sys->i_history_max = __MAX( i_history_max, 0 ) * 1024 * 1024;
+
     p_sys->psz_tmp_path = var_InheritString( p_input, "input-timeshift-path" );
 #if defined (_WIN32) && !defined(VLC_WINSTORE_APP)
     if( p_sys->psz_tmp_path == NULL )
@@ -827,6 +883,14 @@ static int PrivControlLocked( es_out_t *p_tsout, int i_query, va_list args )
     {
         return ControlLockedSetFrameNext( p_tsout );
     }
+    case ES_OUT_PRIV_TIMESHIFT_JUMP:
+    {
+        const vlc_tick_t i_offset = va_arg( args, vlc_tick_t );
+
+        if( !p_sys->b_delayed )
+            return VLC_EGENERIC;
+        return TsJump( p_sys->p_ts, i_offset );
+    }
     case ES_OUT_PRIV_GET_GROUP_FORCED:
         return es_out_vaPrivControl( p_sys->p_out, i_query, args );
     /* Invalid queries for this es_out level */
@@ -891,6 +955,7 @@ static int TsStart( es_out_t *p_out )
         return VLC_EGENERIC;
 
     p_ts->i_tmp_size_max = p_sys->i_tmp_size_max;
+    p_ts->i_history_max = p_sys->i_history_max;
     p_ts->psz_tmp_path = p_sys->psz_tmp_path;
     p_ts->p_input = p_sys->p_input;
     p_ts->p_out = p_sys->p_out;
@@ -906,8 +971,17 @@ static int TsStart( es_out_t *p_out )
     p_ts->i_rate_delay = 0;
     p_ts->i_buffering_delay = 0;
     p_ts->i_cmd_delay = 0;
+    p_ts->i_read_date = -1;
+    p_ts->p_storage_first = NULL;
     p_ts->p_storage_r = NULL;
     p_ts->p_storage_w = NULL;
+    p_ts->i_storage_seq = 0;
+    p_ts->b_index_keyframe = false;
+    p_ts->i_index_date = -1;
+    p_ts->floor = (ts_pos_t){ 0, 0 };
+    p_ts->p_skip = NULL;
+    p_ts->i_skip = 0;
+    p_ts->b_reset_pcr = false;
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts, VLC_THREAD_PRIORITY_INPUT ) )
@@ -952,9 +1026,13 @@ static void TsStop( ts_thread_t *p_ts )
 
         CmdClean( &cmd );
     }
-    assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
-    if( p_ts->p_storage_r )
-        TsStorageDelete( p_ts->p_storage_r );
+    while( p_ts->p_storage_first )
+    {
+        ts_storage_t *p_next = p_ts->p_storage_first->p_next;
+
+        TsStorageDelete( p_ts->p_storage_first );
+        p_ts->p_storage_first = p_next;
+    }
     vlc_mutex_unlock( &p_ts->lock );
 
     TsDestroy( p_ts );
@@ -965,7 +1043,9 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 
     if( !p_ts->p_storage_w || TsStorageIsFull( p_ts->p_storage_w, p_cmd ) )
     {
-        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
+        const size_t i_size = __MAX( (size_t)p_ts->i_tmp_size_max,
+                                     TsStorageSizeofRecord( p_cmd ) );
+        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, i_size );
 
         if( !p_storage )
         {
@@ -974,53 +1054,138 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
             /* TODO warn the user (but only once) */
             return;
         }
+        p_storage->i_seq = p_ts->i_storage_seq++;
 
         if( !p_ts->p_storage_w )
         {
+            p_ts->p_storage_first = p_storage;
             p_ts->p_storage_r = p_ts->p_storage_w = p_storage;
         }
         else
         {
-            TsStoragePack( p_ts->p_storage_w );
+            p_storage->p_prev = p_ts->p_storage_w;
             p_ts->p_storage_w->p_next = p_storage;
             p_ts->p_storage_w = p_storage;
         }
     }
 
+    /* Index random access points: key frames if the demuxer flags them,
+     * otherwise any block at regular intervals (the packetizers resync) */
+    if( p_cmd->header.i_type == C_SEND )
+    {
+        const bool b_keyframe = p_cmd->send.p_block->i_flags & BLOCK_FLAG_TYPE_I;
+        const vlc_tick_t i_date = p_cmd->header.i_date;
+
+        if( b_keyframe )
+            p_ts->b_index_keyframe = true;
+
+        if( p_ts->i_index_date < 0 ||
+            ( p_ts->b_index_keyframe ?
+              b_keyframe && i_date - p_ts->i_index_date >= TS_INDEX_KEYFRAME_INTERVAL :
+              i_date - p_ts->i_index_date >= TS_INDEX_INTERVAL ) )
+        {
+            TsStorageIndex( p_ts->p_storage_w, i_date );
+            p_ts->i_index_date = i_date;
+        }
+    }
+
     /* TODO return error and warn the user (but only once) */
-    TsStoragePushCmd( p_ts->p_storage_w, p_cmd, p_ts->p_storage_r == p_ts->p_storage_w );
+    TsStoragePushCmd( p_ts->p_storage_w, p_cmd );
 
     vlc_cond_signal( &p_ts->wait );
 
     vlc_mutex_unlock( &p_ts->lock );
 }
+static int TsPosCompare( const ts_storage_t *p_storage, size_t i_offset,
+                         ts_pos_t pos )
+{
+    if( p_storage->i_seq != pos.i_seq )
+        return p_storage->i_seq < pos.i_seq ? -1 : 1;
+    if( i_offset != pos.i_offset )
+        return i_offset < pos.i_offset ? -1 : 1;
+    return 0;
+}
+static void TsTrimLocked( ts_thread_t *p_ts )
+{
+    /* Release the segments that are too old to seek back to */
+    int64_t i_history = 0;
+    for( ts_storage_t *p = p_ts->p_storage_first; p != p_ts->p_storage_r; p = p->p_next )
+        i_history += p->i_write;
+
+    while( p_ts->p_storage_first != p_ts->p_storage_r )
+    {
+        ts_storage_t *p_first = p_ts->p_storage_first;
+
+        if( p_first->i_seq >= p_ts->floor.i_seq && i_history <= p_ts->i_history_max )
+            break;
+
+        i_history -= p_first->i_write;
+        p_ts->p_storage_first = p_first->p_next;
+        p_ts->p_storage_first->p_prev = NULL;
+        TsStorageDelete( p_first );
+    }
+}
 static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
 {
     vlc_mutex_assert( &p_ts->lock );
 
-    if( TsStorageIsEmpty( p_ts->p_storage_r ) )
-        return VLC_EGENERIC;
+    for( ;; )
+    {
+        /* The reader may have caught up with the writer at the end of a
+         * segment before the next one was created */
+        while( TsStorageIsEmpty( p_ts->p_storage_r ) )
+        {
+            ts_storage_t *p_next = p_ts->p_storage_r ? p_ts->p_storage_r->p_next : NULL;
+            if( !p_next )
+                return VLC_EGENERIC;
 
-    TsStoragePopCmd( p_ts->p_storage_r, p_cmd, b_flush );
+            p_ts->p_storage_r = p_next;
+            TsTrimLocked( p_ts );
+        }
 
-    while( TsStorageIsEmpty( p_ts->p_storage_r ) )
-    {
-        ts_storage_t *p_next = p_ts->p_storage_r->p_next;
-        if( !p_next )
-            break;
+        ts_storage_t *p_storage = p_ts->p_storage_r;
+
+        /* Commands read again after a jump backward have already been
+         * executed, only the ones without side effect are replayed */
+        const bool b_fresh = p_storage->i_read >= p_storage->i_done;
+
+        if( TsStoragePopCmd( p_storage, p_cmd, b_flush ) )
+        {
+            p_storage->i_done = __MAX( p_storage->i_done, p_storage->i_read );
+            continue;
+        }
+
+        if( b_fresh )
+        {
+            p_storage->i_done = p_storage->i_read;
 
-        TsStorageDelete( p_ts->p_storage_r );
-        p_ts->p_storage_r = p_next;
+            /* The ES is released, nothing before can be replayed */
+            if( p_cmd->header.i_type == C_DEL )
+                p_ts->floor = (ts_pos_t){ p_storage->i_seq, p_storage->i_read };
+        }
+
+        if( b_fresh || CmdIsReplayable( p_cmd ) )
+            return VLC_SUCCESS;
     }
+}
+static bool TsIsSkippingLocked( ts_thread_t *p_ts )
+{
+    if( !p_ts->p_skip )
+        return false;
 
-    return VLC_SUCCESS;
+    const ts_pos_t skip = { p_ts->p_skip->i_seq, p_ts->i_skip };
+    if( TsPosCompare( p_ts->p_storage_r, p_ts->p_storage_r->i_read, skip ) < 0 )
+        return true;
+
+    p_ts->p_skip = NULL;
+    return false;
 }
 static bool TsHasCmd( ts_thread_t *p_ts )
 {
     bool b_cmd;
 
     vlc_mutex_lock( &p_ts->lock );
-    b_cmd = !TsStorageIsEmpty( p_ts->p_storage_r );
+    b_cmd = !TsStorageIsEmpty( p_ts->p_storage_w );
     vlc_mutex_unlock( &p_ts->lock );
 
     return b_cmd;
@@ -1030,13 +1195,93 @@ static bool TsIsUnused( ts_thread_t *p_ts )
     bool b_unused;
 
     vlc_mutex_lock( &p_ts->lock );
+    /* Keep the history around if it can be used to jump back */
     b_unused = !p_ts->b_paused &&
                p_ts->rate == p_ts->rate_source &&
-               TsStorageIsEmpty( p_ts->p_storage_r );
+               p_ts->i_history_max == 0 &&
+               TsStorageIsEmpty( p_ts->p_storage_w );
     vlc_mutex_unlock( &p_ts->lock );
 
     return b_unused;
 }
+static int TsJump( ts_thread_t *p_ts, vlc_tick_t i_offset )
+{
+    vlc_mutex_lock( &p_ts->lock );
+
+    if( p_ts->i_read_date < 0 || !p_ts->p_storage_r )
+    {
+        vlc_mutex_unlock( &p_ts->lock );
+        return VLC_EGENERIC;
+    }
+
+    /* Find the last random access point before the requested date, or the
+     * first one available if it is out of the buffer */
+    const vlc_tick_t i_date = p_ts->i_read_date + i_offset;
+    ts_storage_t *p_best = NULL;
+    const ts_index_t *p_entry = NULL;
+
+    for( ts_storage_t *p = p_ts->p_storage_first; p != NULL; p = p->p_next )
+    {
+        for( size_t i = 0; i < p->i_index; i++ )
+        {
+            const ts_index_t *p_idx = &p->p_index[i];
+
+            if( TsPosCompare( p, p_idx->i_offset, p_ts->floor ) < 0 )
+                continue;
+            if( p_entry && p_idx->i_date > i_date )
+                goto found;
+            p_best = p;
+            p_entry = p_idx;
+        }
+    }
+found:
+    if( !p_entry )
+    {
+        vlc_mutex_unlock( &p_ts->lock );
+        return VLC_EGENERIC;
+    }
+
+    const ts_pos_t dst = { p_best->i_seq, p_entry->i_offset };
+    const int i_dir = TsPosCompare( p_ts->p_storage_r, p_ts->p_storage_r->i_read, dst );
+    if( i_dir == 0 || ( i_dir < 0 ) != ( i_offset > 0 ) )
+    {
+        /* Nothing to jump to in this direction: forward, this means that
+         * playback is already as close to live as it can be */
+        vlc_mutex_unlock( &p_ts->lock );
+        return i_offset > 0 ? VLC_SUCCESS : VLC_EGENERIC;
+    }
+
+    if( i_dir < 0 )
+    {
+        /* The commands up to there still have to be read */
+        p_ts->p_skip = p_best;
+        p_ts->i_skip = p_entry->i_offset;
+    }
+    else
+    {
+        for( ts_storage_t *p = p_best->p_next; p != p_ts->p_storage_r->p_next; p = p->p_next )
+            p->i_read = 0;
+        p_best->i_read = p_entry->i_offset;
+        p_ts->p_storage_r = p_best;
+        p_ts->p_skip = NULL;
+    }
+
+    const vlc_tick_t i_shift = p_entry->i_date - p_ts->i_read_date;
+    msg_Dbg( p_ts->p_input, "es out timeshift: jumping %s by %"PRId64" ms",
+             i_dir < 0 ? "forward" : "backward",
+             MS_FROM_VLC_TICK( i_dir < 0 ? i_shift : -i_shift ) );
+
+    /* Play the destination right away */
+    p_ts->i_cmd_delay += p_ts->i_rate_delay + p_ts->i_read_date - p_entry->i_date;
+    p_ts->i_rate_date = -1;
+    p_ts->i_rate_delay = 0;
+    p_ts->i_read_date = p_entry->i_date;
+    p_ts->b_reset_pcr = true;
+
+    vlc_cond_signal( &p_ts->wait );
+    vlc_mutex_unlock( &p_ts->lock );
+    return VLC_SUCCESS;
+}
 static int TsChangePause( ts_thread_t *p_ts, bool b_source_paused, bool b_paused, vlc_tick_t i_date )
 {
     vlc_mutex_lock( &p_ts->lock );
@@ -1098,16 +1343,41 @@ static void *TsRun( void *p_data )
         ts_cmd_t cmd;
         vlc_tick_t  i_deadline;
 
+        if( p_ts->b_reset_pcr )
+        {
+            /* Reset the decoders and clock after a jump */
+            p_ts->b_reset_pcr = false;
+            i_buffering_date = -1;
+            vlc_mutex_unlock( &p_ts->lock );
+            es_out_Control( p_ts->p_out, ES_OUT_RESET_PCR );
+            vlc_mutex_lock( &p_ts->lock );
+            continue;
+        }
+
         /* Pop a command to execute */
         bool b_buffering = es_out_GetBuffering( p_ts->p_out );
+        const bool b_skip = TsIsSkippingLocked( p_ts );
 
-        if( ( p_ts->b_paused && !b_buffering )
-         || TsPopCmdLocked( p_ts, &cmd, false ) )
+        if( ( p_ts->b_paused && !b_buffering && !b_skip )
+         || TsPopCmdLocked( p_ts, &cmd, b_skip ) )
         {
             vlc_cond_wait( &p_ts->wait, &p_ts->lock );
             continue;
         }
 
+        if( b_skip )
+        {
+            /* Jumping forward: only keep track of the ES state */
+            vlc_mutex_unlock( &p_ts->lock );
+            if( CmdIsReplayable( &cmd ) )
+                CmdClean( &cmd );
+            else
+                CmdExecute( p_ts->p_tsout, &cmd );
+            vlc_mutex_lock( &p_ts->lock );
+            continue;
+        }
+        p_ts->i_read_date = cmd.header.i_date;
+
         if( b_buffering && i_buffering_date < 0 )
         {
             i_buffering_date = cmd.header.i_date;
@@ -1164,30 +1434,7 @@ static void *TsRun( void *p_data )
         }
 
         /* Execute the command  */
-        switch( cmd.header.i_type )
-        {
-        case C_ADD:
-            CmdExecuteAdd( p_ts->p_tsout, &cmd.add );
-            CmdCleanAdd( &cmd.add );
-            break;
-        case C_SEND:
-            CmdExecuteSend( p_ts->p_tsout, &cmd.send );
-            CmdCleanSend( &cmd.send );
-            break;
-        case C_CONTROL:
-            CmdExecuteControl( p_ts->p_tsout, &cmd.control );
-            CmdCleanControl( &cmd.control );
-            break;
-        case C_PRIVCONTROL:
-            CmdExecutePrivControl( p_ts->p_tsout, &cmd.privcontrol );
-            break;
-        case C_DEL:
-            CmdExecuteDel( p_ts->p_tsout, &cmd.del );
-            break;
-        default:
-            vlc_assert_unreachable();
-            break;
-        }
+        CmdExecute( p_ts->p_tsout, &cmd );
         vlc_mutex_lock( &p_ts->lock );
     }
     vlc_mutex_unlock( &p_ts->lock );
@@ -1197,9 +1444,6 @@ static void *TsRun( void *p_data )
 /*****************************************************************************
  *
  *****************************************************************************/
-#define MAX_COMMAND_SIZE sizeof(ts_cmd_t)
-#define TS_STORAGE_COMMAND_PREALLOC 30000
-
 static const size_t TsStorageSizeofCommand[] =
 {
     [C_ADD] = sizeof(ts_cmd_add_t),
@@ -1209,7 +1453,7 @@ static const size_t TsStorageSizeofCommand[] =
     [C_PRIVCONTROL] = sizeof(ts_cmd_privcontrol_t)
 };
 
-static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_max )
+static ts_storage_t *TsStorageNew( const char *psz_tmp_path, size_t i_size )
 {
     ts_storage_t *p_storage = malloc( sizeof (*p_storage) );
     if( unlikely(p_storage == NULL) )
@@ -1223,67 +1467,65 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
         return NULL;
     }
 
-    p_storage->p_filew = fdopen( fd, "w+b" );
-    if( p_storage->p_filew == NULL )
-    {
-        vlc_close( fd );
-        vlc_unlink( psz_file );
-        goto error;
-    }
-
-    p_storage->p_filer = vlc_fopen( psz_file, "rb" );
-    if( p_storage->p_filer == NULL )
-    {
-        fclose( p_storage->p_filew );
-        vlc_unlink( psz_file );
-        goto error;
-    }
-
 #ifndef _WIN32
     vlc_unlink( psz_file );
     free( psz_file );
 #else
     p_storage->psz_file = psz_file;
 #endif
+    p_storage->p_prev = NULL;
     p_storage->p_next = NULL;
+    p_storage->i_seq = 0;
 
     /* */
-    p_storage->i_file_max = i_tmp_size_max;
-    p_storage->i_file_size = 0;
+    p_storage->fd = fd;
+    p_storage->p_map = NULL;
+    p_storage->i_file_max = i_size;
+    p_storage->i_write = 0;
+    p_storage->i_read = 0;
+    p_storage->i_done = 0;
 
     /* */
-    p_storage->p_cmd_buf = vlc_alloc( TS_STORAGE_COMMAND_PREALLOC, MAX_COMMAND_SIZE );
-    p_storage->i_cmd_buf = TS_STORAGE_COMMAND_PREALLOC * MAX_COMMAND_SIZE;
-    p_storage->p_cmd_w = p_storage->p_cmd_buf;
-    p_storage->p_cmd_r = p_storage->p_cmd_buf;
-    //fprintf( stderr, "\nSTORAGE name=%s size=%d KiB\n", p_storage->psz_file, p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) /1024 );
-
-    if( !p_storage->p_cmd_buf )
-    {
-        TsStorageDelete( p_storage );
-        return NULL;
+    p_storage->p_index = NULL;
+    p_storage->i_index = 0;
+    p_storage->i_index_max = 0;
+
+#if defined(HAVE_MMAP) && defined(HAVE_POSIX_FALLOCATE)
+    /* Allocate the whole segment beforehand: running out of space must not
+     * happen while writing into the mapping. Otherwise fall back to plain
+     * file I/O. */
+    if( posix_fallocate( fd, 0, i_size ) == 0 )
+    {
+        void *p_map = mmap( NULL, i_size, PROT_READ|PROT_WRITE, MAP_SHARED,
+                            fd, 0 );
+        if( p_map != MAP_FAILED )
+        {
+            posix_madvise( p_map, i_size, POSIX_MADV_SEQUENTIAL );
+            p_storage->p_map = p_map;
+        }
     }
+#endif
     return p_storage;
-error:
-    free( psz_file );
-    free( p_storage );
-    return NULL;
 }
 
 static void TsStorageDelete( ts_storage_t *p_storage )
 {
-    while( p_storage->p_cmd_r < p_storage->p_cmd_w )
+    /* Release the commands never read */
+    p_storage->i_read = p_storage->i_done;
+    while( p_storage->i_read < p_storage->i_write )
     {
         ts_cmd_t cmd;
 
-        TsStoragePopCmd( p_storage, &cmd, true );
-
-        CmdClean( &cmd );
+        if( TsStoragePopCmd( p_storage, &cmd, true ) == VLC_SUCCESS )
+            CmdClean( &cmd );
     }
-    free( p_storage->p_cmd_buf );
+    free( p_storage->p_index );
 
-    fclose( p_storage->p_filer );
-    fclose( p_storage->p_filew );
+#ifdef HAVE_MMAP
+    if( p_storage->p_map )
+        munmap( p_storage->p_map, p_storage->i_file_max );
+#endif
+    vlc_close( p_storage->fd );
 #ifdef _WIN32
     vlc_unlink( p_storage->psz_file );
     free( p_storage->psz_file );
@@ -1291,118 +1533,249 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     free( p_storage );
 }
 
-static void TsStoragePack( ts_storage_t *p_storage )
+static int TsStorageWrite( ts_storage_t *p_storage, const void *p_data, size_t i_data )
 {
-    /* Try to release a bit of memory */
-    if( (size_t)(p_storage->p_cmd_w - p_storage->p_cmd_buf) == p_storage->i_cmd_buf )
-        return;
-
-    size_t i_realloc = p_storage->p_cmd_w - p_storage->p_cmd_buf;
-    uint8_t *p_realloc = realloc( p_storage->p_cmd_buf, i_realloc );
-    if( p_realloc )
+    if( p_storage->p_map )
     {
-        p_storage->p_cmd_r = p_realloc + (p_storage->p_cmd_r - p_storage->p_cmd_buf);
-        p_storage->p_cmd_w = p_realloc + i_realloc;
-        p_storage->i_cmd_buf = i_realloc;
-        p_storage->p_cmd_buf = p_realloc;
+        memcpy( &p_storage->p_map[p_storage->i_write], p_data, i_data );
     }
+    else
+    {
+        if( lseek( p_storage->fd, p_storage->i_write, SEEK_SET ) == -1 )
+            return VLC_EGENERIC;
+
+        for( size_t i_done = 0; i_done < i_data; )
+        {
+            ssize_t i_ret = vlc_write( p_storage->fd, (const uint8_t *)p_data + i_done,
+                                       i_data - i_done );
+            if( i_ret < 0 )
+            {
+                if( errno == EINTR )
+                    continue;
+                return VLC_EGENERIC;
+            }
+            i_done += i_ret;
+        }
+    }
+    p_storage->i_write += i_data;
+    return VLC_SUCCESS;
 }
 
-static bool TsStorageIsFull( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
+static int TsStorageRead( ts_storage_t *p_storage, void *p_data, size_t i_data )
 {
-    if( p_cmd && p_cmd->header.i_type == C_SEND && p_storage->p_cmd_w )
+    assert( p_storage->i_read + i_data <= p_storage->i_write );
+
+    if( p_storage->p_map )
+    {
+        memcpy( p_data, &p_storage->p_map[p_storage->i_read], i_data );
+    }
+    else
     {
-        size_t i_size = sizeof(*p_cmd->send.p_block) + p_cmd->send.p_block->i_buffer;
+        if( lseek( p_storage->fd, p_storage->i_read, SEEK_SET ) == -1 )
+            return VLC_EGENERIC;
 
-        if( p_storage->i_file_size + i_size >= p_storage->i_file_max )
-            return true;
+        for( size_t i_done = 0; i_done < i_data; )
+        {
+            ssize_t i_ret = read( p_storage->fd, (uint8_t *)p_data + i_done,
+                                  i_data - i_done );
+            if( i_ret <= 0 )
+            {
+                if( i_ret < 0 && errno == EINTR )
+                    continue;
+                return VLC_EGENERIC;
+            }
+            i_done += i_ret;
+        }
     }
-    return (size_t)(p_storage->p_cmd_w - p_storage->p_cmd_buf) > p_storage->i_cmd_buf - MAX_COMMAND_SIZE;
+    p_storage->i_read += i_data;
+    return VLC_SUCCESS;
+}
+
+static size_t TsStorageSizeofRecord( const ts_cmd_t *p_cmd )
+{
+    size_t i_size = TsStorageSizeofCommand[p_cmd->header.i_type];
+
+    if( p_cmd->header.i_type == C_SEND )
+        i_size += sizeof(ts_block_t) + p_cmd->send.p_block->i_buffer;
+    return i_size;
+}
+
+static bool TsStorageIsFull( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
+{
+    return p_storage->i_write + TsStorageSizeofRecord( p_cmd ) > p_storage->i_file_max;
 }
 
 static bool TsStorageIsEmpty( ts_storage_t *p_storage )
 {
-    return !p_storage || p_storage->p_cmd_r >= p_storage->p_cmd_w;
+    return !p_storage || p_storage->i_read >= p_storage->i_write;
 }
 
-static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bool b_flush )
+static void TsStorageIndex( ts_storage_t *p_storage, vlc_tick_t i_date )
+{
+    if( p_storage->i_index >= p_storage->i_index_max )
+    {
+        const size_t i_max = __MAX( 2 * p_storage->i_index_max, 64 );
+        ts_index_t *p_index = realloc( p_storage->p_index,
+                                       i_max * sizeof(*p_index) );
+        if( unlikely(p_index == NULL) )
+            return;
+        p_storage->p_index = p_index;
+        p_storage->i_index_max = i_max;
+    }
+
+    p_storage->p_index[p_storage->i_index++] = (ts_index_t){
+        .i_date = i_date,
+        .i_offset = p_storage->i_write,
+    };
+}
+
+static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
 {
     assert( !TsStorageIsFull( p_storage, p_cmd ) );
+    const size_t i_write = p_storage->i_write;
     ts_cmd_t cmd;
     memcpy(&cmd, p_cmd, TsStorageSizeofCommand[p_cmd->header.i_type]);
 
+    block_t *p_block = NULL;
     if( cmd.header.i_type == C_SEND )
     {
-        block_t *p_block = cmd.send.p_block;
-
+        p_block = cmd.send.p_block;
         cmd.send.p_block = NULL;
-        cmd.send.i_offset = ftell( p_storage->p_filew );
+    }
 
-        if( fwrite( p_block, sizeof(*p_block), 1, p_storage->p_filew ) != 1 )
-        {
-            block_Release( p_block );
-            return;
-        }
-        p_storage->i_file_size += sizeof(*p_block);
-        if( p_block->i_buffer > 0 )
-        {
-            if( fwrite( p_block->p_buffer, p_block->i_buffer, 1, p_storage->p_filew ) != 1 )
-            {
-                block_Release( p_block );
-                return;
-            }
-        }
-        p_storage->i_file_size += p_block->i_buffer;
-        block_Release( p_block );
+    if( TsStorageWrite( p_storage, &cmd, TsStorageSizeofCommand[cmd.header.i_type] ) )
+        goto error;
 
-        if( b_flush )
-            fflush( p_storage->p_filew );
+    if( p_block )
+    {
+        const ts_block_t block = {
+            .i_buffer = p_block->i_buffer,
+            .i_flags = p_block->i_flags,
+            .i_nb_samples = p_block->i_nb_samples,
+            .i_pts = p_block->i_pts,
+            .i_dts = p_block->i_dts,
+            .i_length = p_block->i_length,
+        };
+
+        if( TsStorageWrite( p_storage, &block, sizeof(block) ) ||
+            TsStorageWrite( p_storage, p_block->p_buffer, p_block->i_buffer ) )
+            goto error;
+        block_Release( p_block );
     }
-    size_t i_cmdsize = TsStorageSizeofCommand[ cmd.header.i_type ];
-    memcpy( p_storage->p_cmd_w, &cmd, i_cmdsize );
-    p_storage->p_cmd_w += i_cmdsize;
+    return;
+
+error:
+    /* Drop the partially written command */
+    p_storage->i_write = i_write;
+    if( p_storage->i_index > 0 &&
+        p_storage->p_index[p_storage->i_index - 1].i_offset == i_write )
+        p_storage->i_index--;
+    if( p_block )
+        cmd.send.p_block = p_block;
+    CmdClean( &cmd );
 }
 
-static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush )
+static int TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush )
 {
     assert( !TsStorageIsEmpty( p_storage ) );
 
-    p_cmd->header.i_type = p_storage->p_cmd_r[0];
-    size_t i_cmdsize = TsStorageSizeofCommand[ p_cmd->header.i_type ];
-    memcpy(p_cmd, p_storage->p_cmd_r, i_cmdsize);
-    p_storage->p_cmd_r += i_cmdsize;
+    int8_t i_type;
+    if( p_storage->p_map )
+        i_type = p_storage->p_map[p_storage->i_read];
+    else if( TsStorageRead( p_storage, &i_type, 1 ) == VLC_SUCCESS )
+        p_storage->i_read--;
+    else
+        i_type = -1;
+
+    if( i_type < 0 || (size_t)i_type >= ARRAY_SIZE(TsStorageSizeofCommand) ||
+        TsStorageRead( p_storage, p_cmd, TsStorageSizeofCommand[i_type] ) )
+    {
+        /* I/O error, the rest of the segment is lost */
+        p_storage->i_read = p_storage->i_write;
+        return VLC_EGENERIC;
+    }
 
     if( p_cmd->header.i_type == C_SEND )
     {
-        block_t block;
+        ts_block_t block;
+        block_t *p_block = NULL;
 
-        if( !b_flush &&
-            !fseek( p_storage->p_filer, p_cmd->send.i_offset, SEEK_SET ) &&
-            fread( &block, sizeof(block), 1, p_storage->p_filer ) == 1 )
+        if( TsStorageRead( p_storage, &block, sizeof(block) ) == VLC_SUCCESS )
         {
-            block_t *p_block = block_Alloc( block.i_buffer );
-            if( p_block )
+            if( !b_flush )
+                p_block = block_Alloc( block.i_buffer );
+            if( p_block &&
+                TsStorageRead( p_storage, p_block->p_buffer, block.i_buffer ) == VLC_SUCCESS )
             {
                 p_block->i_dts      = block.i_dts;
                 p_block->i_pts      = block.i_pts;
                 p_block->i_flags    = block.i_flags;
                 p_block->i_length   = block.i_length;
                 p_block->i_nb_samples = block.i_nb_samples;
-                p_block->i_buffer = fread( p_block->p_buffer, 1, block.i_buffer, p_storage->p_filer );
             }
-            p_cmd->send.p_block = p_block;
-        }
-        else
-        {
-            //perror( "TsStoragePopCmd" );
-            p_cmd->send.p_block = block_Alloc( 1 );
+            else
+            {
+                if( p_block )
+                    block_Release( p_block );
+                p_block = NULL;
+                p_storage->i_read += block.i_buffer;
+            }
         }
+        p_cmd->send.p_block = p_block;
     }
+    return VLC_SUCCESS;
 }
 
 /*****************************************************************************
  *
  *****************************************************************************/
+static void CmdExecute( es_out_t *p_tsout, ts_cmd_t *p_cmd )
+{
+    switch( p_cmd->header.i_type )
+    {
+    case C_ADD:
+        CmdExecuteAdd( p_tsout, &p_cmd->add );
+        CmdCleanAdd( &p_cmd->add );
+        break;
+    case C_SEND:
+        CmdExecuteSend( p_tsout, &p_cmd->send );
+        CmdCleanSend( &p_cmd->send );
+        break;
+    case C_CONTROL:
+        CmdExecuteControl( p_tsout, &p_cmd->control );
+        CmdCleanControl( &p_cmd->control );
+        break;
+    case C_PRIVCONTROL:
+        CmdExecutePrivControl( p_tsout, &p_cmd->privcontrol );
+        break;
+    case C_DEL:
+        CmdExecuteDel( p_tsout, &p_cmd->del );
+        break;
+    default:
+        vlc_assert_unreachable();
+        break;
+    }
+}
+
+/* Whether a command can be executed again after a jump backward: it must not
+ * own or reference anything released by its first execution */
+static bool CmdIsReplayable( const ts_cmd_t *p_cmd )
+{
+    switch( p_cmd->header.i_type )
+    {
+    case C_SEND:
+        return true;
+    case C_CONTROL:
+        return p_cmd->control.in == NULL &&
+               ( p_cmd->control.i_query == ES_OUT_SET_PCR ||
+                 p_cmd->control.i_query == ES_OUT_SET_GROUP_PCR );
+    case C_PRIVCONTROL:
+        return p_cmd->privcontrol.i_query == ES_OUT_PRIV_SET_TIMES;
+    default:
+        return false;
+    }
+}
+
 static void CmdClean( ts_cmd_t *p_cmd )
 {
     switch( p_cmd->header.i_type )
@@ -55,6 +55,8 @@
 #include <vlc_stream_extractor.h>
 #include <vlc_renderer_discovery.h>
 #include <vlc_hash.h>
+#include <vlc_tracer.h>
+#include <vlc_cpu.h>
 
 /*****************************************************************************
  * Local prototypes
@@ -247,6 +249,9 @@ input_thread_t *input_Create( vlc_object_t *p_parent,
         case INPUT_TYPE_THUMBNAILING:
             type_str = "thumbnailing ";
             break;
+        case INPUT_TYPE_DECODING:
+            type_str = "decoding ";
+            break;
         default:
             type_str = "";
             break;
@@ -272,7 +277,8 @@ input_thread_t *input_Create( vlc_object_t *p_parent,
     priv->normal_time = VLC_TICK_0;
     TAB_INIT( priv->i_attachment, priv->attachment );
     priv->p_sout   = NULL;
-    priv->b_out_pace_control = priv->type == INPUT_TYPE_THUMBNAILING;
+    priv->b_out_pace_control = priv->type == INPUT_TYPE_THUMBNAILING
+                            || priv->type == INPUT_TYPE_DECODING;
     priv->p_renderer = p_renderer && priv->type != INPUT_TYPE_PREPARSING ?
                 vlc_renderer_item_hold( p_renderer ) : NULL;
 
@@ -296,7 +302,8 @@ input_thread_t *input_Create( vlc_object_t *p_parent,
     /* setup the preparse depth of the item
      * if we are preparsing, use the i_preparse_depth of the parent item */
     if( priv->type == INPUT_TYPE_PREPARSING
-     || priv->type == INPUT_TYPE_THUMBNAILING )
+     || priv->type == INPUT_TYPE_THUMBNAILING
+     || priv->type == INPUT_TYPE_DECODING )
     {
         p_input->obj.logger = NULL;
         p_input->obj.no_interact = true;
@@ -353,6 +360,12 @@ input_thread_t *input_Create( vlc_object_t *p_parent,
 
     priv->b_low_delay = var_InheritBool( p_input, "low-delay" );
     priv->i_jitter_max = VLC_TICK_FROM_MS(var_InheritInteger( p_input, "clock-jitter" ));
+    if( priv->b_low_delay )
+    {
+        const vlc_tick_t i_low_delay_caching =
+            VLC_TICK_FROM_MS(var_InheritInteger( p_input, "low-delay-caching" ));
+        priv->i_jitter_max = __MIN( priv->i_jitter_max, i_low_delay_caching );
+    }
 
     /* Remove 'Now playing' info as it is probably outdated */
     input_item_SetNowPlaying( p_item, NULL );
@@ -421,6 +434,7 @@ static void *Run( void *data )
     input_thread_t *p_input = &priv->input;
 
     vlc_interrupt_set(&priv->interrupt);
+    vlc_CPU_PinThread( VLC_OBJECT(p_input), "input" );
 
     if( !Init( p_input ) )
     {
@@ -499,7 +513,15 @@ static void MainLoopDemux( input_thread_t *p_input, bool *pb_changed )
     }
 
     if( i_ret == VLC_DEMUXER_SUCCESS )
+    {
+        struct vlc_tracer *tracer = vlc_object_get_tracer( &p_input->obj );
+
+        if( tracer != NULL )
+            vlc_tracer_TraceSpanBegin( tracer, "DEMUX", "demux" );
         i_ret = demux_Demux( p_demux );
+        if( tracer != NULL )
+            vlc_tracer_TraceSpanEnd( tracer, "DEMUX", "demux" );
+    }
 
     i_ret = i_ret > 0 ? VLC_DEMUXER_SUCCESS : ( i_ret < 0 ? VLC_DEMUXER_EGENERIC : VLC_DEMUXER_EOF);
 
@@ -1183,6 +1205,14 @@ static void UpdatePtsDelay( input_thread_t *p_input )
     if( i_pts_delay < 0 )
         i_pts_delay = 0;
 
+    /* In low delay mode, the caching requested by the access is capped */
+    if( p_sys->b_low_delay )
+    {
+        const vlc_tick_t i_low_delay_caching =
+            VLC_TICK_FROM_MS(var_InheritInteger( p_input, "low-delay-caching" ));
+        i_pts_delay = __MIN( i_pts_delay, i_low_delay_caching );
+    }
+
     /* Update cr_average depending on the caching */
     const int i_cr_average = var_GetInteger( p_input, "cr-average" ) * i_pts_delay / DEFAULT_PTS_DELAY;
 
@@ -1978,6 +2008,14 @@ static bool Control( input_thread_t *p_input,
                 break;
             }
 
+            /* Jump within the timeshift buffer if it is in use */
+            if( !absolute &&
+                !es_out_TimeshiftJump( priv->p_es_out, param.time.i_val ) )
+            {
+                b_force_update = true;
+                break;
+            }
+
             /* Reset the decoders states and clock sync (before calling the demuxer */
             es_out_Control( priv->p_es_out, ES_OUT_RESET_PCR );
 
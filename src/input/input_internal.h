@@ -34,6 +34,7 @@
 #include <libvlc.h>
 #include "input_interface.h"
 #include "misc/interrupt.h"
+#include "misc/pacing.h"
 
 struct input_stats;
 
@@ -58,6 +59,7 @@ enum input_type {
     INPUT_TYPE_NONE,
     INPUT_TYPE_PREPARSING,
     INPUT_TYPE_THUMBNAILING,
+    INPUT_TYPE_DECODING,
 };
 
 /**
@@ -149,6 +151,10 @@ typedef enum input_event_type_e
 
     /* Thumbnail generation */
     INPUT_EVENT_THUMBNAIL_READY,
+
+    /* Decoding without outputs */
+    INPUT_EVENT_PICTURE_DECODED,
+    INPUT_EVENT_AUDIO_DECODED,
 } input_event_type_e;
 
 #define VLC_INPUT_CAPABILITIES_SEEKABLE (1<<0)
@@ -264,6 +270,12 @@ struct vlc_input_event_vout
     vlc_es_id_t *id;
 };
 
+struct vlc_input_event_audio
+{
+    const audio_format_t *fmt;
+    block_t *block;
+};
+
 struct vlc_input_event
 {
     input_event_type_e type;
@@ -307,6 +319,10 @@ struct vlc_input_event
         float subs_fps;
         /* INPUT_EVENT_THUMBNAIL_READY */
         picture_t *thumbnail;
+        /* INPUT_EVENT_PICTURE_DECODED */
+        picture_t *picture;
+        /* INPUT_EVENT_AUDIO_DECODED */
+        struct vlc_input_event_audio audio;
     };
 };
 
@@ -693,6 +709,9 @@ int subtitles_Detect( input_thread_t *, char *, const char *, input_item_slave_t
 int subtitles_Filter( const char *);
 
 /* meta.c */
+/* Returns a counter changed by every update of the meta data */
+unsigned vlc_meta_GetVersion( const vlc_meta_t * );
+
 void vlc_audio_replay_gain_MergeFromMeta( audio_replay_gain_t *p_dst,
                                           const vlc_meta_t *p_meta );
 
@@ -721,11 +740,27 @@ struct input_stats {
     atomic_uintmax_t displayed_pictures;
     atomic_uintmax_t late_pictures;
     atomic_uintmax_t lost_pictures;
+
+    struct
+    {
+        vlc_mutex_t lock;
+        float drift;
+        vlc_tick_t latency;
+        uintmax_t jitter_histogram[INPUT_STATS_CLOCK_BUCKETS];
+        uintmax_t drift_histogram[INPUT_STATS_CLOCK_BUCKETS];
+    } clock;
+
+    atomic_uintmax_t pacing[INPUT_STATS_PACING_TYPES][INPUT_STATS_PACING_BUCKETS];
 };
 
 struct input_stats *input_stats_Create(void);
 void input_stats_Destroy(struct input_stats *);
 void input_rate_Add(input_rate_t *, uintmax_t);
+void input_stats_AddClock(struct input_stats *, vlc_tick_t jitter,
+                          double drift);
+void input_stats_AddLatency(struct input_stats *, vlc_tick_t latency);
+void input_stats_AddPacing(struct input_stats *,
+                           const struct input_stats_pacing *);
 void input_stats_Compute(struct input_stats *, input_stats_t*);
 
 #endif
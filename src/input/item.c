@@ -37,6 +37,7 @@
 #include "item.h"
 #include "info.h"
 #include "input_internal.h"
+#include "../misc/rcu.h"
 
 struct input_item_opaque
 {
@@ -84,6 +85,7 @@ void input_item_SetPreparsed( input_item_t *p_i, bool b_preparsed )
     }
 
     vlc_mutex_unlock( &p_i->lock );
+    input_item_ReclaimMetaSnapshots( p_i );
 
     if( b_send_event )
     {
@@ -107,6 +109,7 @@ void input_item_SetArtNotFound( input_item_t *p_i, bool b_not_found )
     vlc_meta_SetStatus(p_i->p_meta, status);
 
     vlc_mutex_unlock( &p_i->lock );
+    input_item_ReclaimMetaSnapshots( p_i );
 }
 
 void input_item_SetArtFetched( input_item_t *p_i, bool b_art_fetched )
@@ -123,6 +126,7 @@ void input_item_SetArtFetched( input_item_t *p_i, bool b_art_fetched )
     vlc_meta_SetStatus(p_i->p_meta, status);
 
     vlc_mutex_unlock( &p_i->lock );
+    input_item_ReclaimMetaSnapshots( p_i );
 }
 
 void input_item_SetMeta( input_item_t *p_i, vlc_meta_type_t meta_type, const char *psz_val )
@@ -130,6 +134,7 @@ void input_item_SetMeta( input_item_t *p_i, vlc_meta_type_t meta_type, const cha
     vlc_mutex_lock( &p_i->lock );
     vlc_meta_Set( p_i->p_meta, meta_type, psz_val );
     vlc_mutex_unlock( &p_i->lock );
+    input_item_ReclaimMetaSnapshots( p_i );
 
     /* Notify interested third parties */
     vlc_event_send( &p_i->event_manager, &(vlc_event_t) {
@@ -221,16 +226,138 @@ bool input_item_HasErrorWhenReading( input_item_t *p_item )
     return b_error;
 }
 
-bool input_item_MetaMatch( input_item_t *p_i,
-                           vlc_meta_type_t meta_type, const char *psz )
+struct input_item_meta_snapshot
+{
+    vlc_atomic_rc_t rc;
+    const vlc_meta_t *meta; /* source of the snapshot */
+    unsigned version; /* version of the source when taken */
+    struct input_item_meta_snapshot *next; /* next retired snapshot */
+    const char *values[VLC_META_TYPE_COUNT];
+    char strings[];
+};
+
+void input_item_meta_snapshot_Release( input_item_meta_snapshot_t *snap )
+{
+    if( vlc_atomic_rc_dec( &snap->rc ) )
+        free( snap );
+}
+
+const char *input_item_meta_snapshot_Get( const input_item_meta_snapshot_t *snap,
+                                          vlc_meta_type_t meta_type )
+{
+    return snap->values[meta_type];
+}
+
+static input_item_meta_snapshot_t *MetaSnapshotNew( const vlc_meta_t *meta )
 {
+    size_t size = 0;
+
+    for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+    {
+        const char *value = vlc_meta_Get( meta, i );
+        if( value != NULL )
+            size += strlen( value ) + 1;
+    }
+
+    input_item_meta_snapshot_t *snap = malloc( sizeof (*snap) + size );
+    if( unlikely(snap == NULL) )
+        return NULL;
+
+    vlc_atomic_rc_init( &snap->rc );
+    snap->meta = meta;
+    snap->version = vlc_meta_GetVersion( meta );
+
+    char *p = snap->strings;
+    for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+    {
+        const char *value = vlc_meta_Get( meta, i );
+        if( value != NULL )
+        {
+            size_t len = strlen( value ) + 1;
+            snap->values[i] = memcpy( p, value, len );
+            p += len;
+        }
+        else
+            snap->values[i] = NULL;
+    }
+    return snap;
+}
+
+input_item_meta_snapshot_t *input_item_HoldMetaSnapshot( input_item_t *p_i )
+{
+    input_item_owner_t *owner = item_owner(p_i);
+    input_item_meta_snapshot_t *snap;
+
+    /* Fast path: the last snapshot is still up to date */
+    vlc_rcu_read_lock();
+    snap = atomic_load_explicit( &owner->meta_snapshot, memory_order_acquire );
+    if( snap != NULL && snap->version == vlc_meta_GetVersion( snap->meta ) )
+        vlc_atomic_rc_inc( &snap->rc );
+    else
+        snap = NULL;
+    vlc_rcu_read_unlock();
+
+    if( snap != NULL )
+        return snap;
+
+    /* Take and publish a new snapshot */
+    input_item_meta_snapshot_t *old;
+
     vlc_mutex_lock( &p_i->lock );
+    assert( p_i->p_meta != NULL );
+    snap = MetaSnapshotNew( p_i->p_meta );
+    if( unlikely(snap == NULL) )
+    {
+        vlc_mutex_unlock( &p_i->lock );
+        return NULL;
+    }
+    vlc_atomic_rc_inc( &snap->rc ); /* for the caller */
+    old = atomic_exchange_explicit( &owner->meta_snapshot, snap,
+                                    memory_order_acq_rel );
+    if( old != NULL )
+    {   /* Fast path readers may still see it: leave it to the writers */
+        old->next = owner->meta_retired;
+        owner->meta_retired = old;
+    }
+    vlc_mutex_unlock( &p_i->lock );
+    return snap;
+}
 
-    const char *psz_meta = vlc_meta_Get( p_i->p_meta, meta_type );
-    bool b_ret = psz_meta && strcasestr( psz_meta, psz );
+void input_item_ReclaimMetaSnapshots( input_item_t *p_i )
+{
+    input_item_owner_t *owner = item_owner(p_i);
+    input_item_meta_snapshot_t *snap;
 
+    vlc_mutex_lock( &p_i->lock );
+    snap = owner->meta_retired;
+    owner->meta_retired = NULL;
     vlc_mutex_unlock( &p_i->lock );
 
+    if( snap == NULL )
+        return;
+
+    vlc_rcu_synchronize();
+
+    while( snap != NULL )
+    {
+        input_item_meta_snapshot_t *next = snap->next;
+
+        input_item_meta_snapshot_Release( snap );
+        snap = next;
+    }
+}
+
+bool input_item_MetaMatch( input_item_t *p_i,
+                           vlc_meta_type_t meta_type, const char *psz )
+{
+    input_item_meta_snapshot_t *snap = input_item_HoldMetaSnapshot( p_i );
+    if( unlikely(snap == NULL) )
+        return false;
+
+    const char *psz_meta = input_item_meta_snapshot_Get( snap, meta_type );
+    bool b_ret = psz_meta && strcasestr( psz_meta, psz );
+
+    input_item_meta_snapshot_Release( snap );
     return b_ret;
 }
 
@@ -244,10 +371,14 @@ const char *input_item_GetMetaLocked(input_item_t *item,
 
 char *input_item_GetMeta( input_item_t *p_i, vlc_meta_type_t meta_type )
 {
-    vlc_mutex_lock( &p_i->lock );
-    const char *value = input_item_GetMetaLocked( p_i, meta_type );
+    input_item_meta_snapshot_t *snap = input_item_HoldMetaSnapshot( p_i );
+    if( unlikely(snap == NULL) )
+        return NULL;
+
+    const char *value = input_item_meta_snapshot_Get( snap, meta_type );
     char *psz = value ? strdup( value ) : NULL;
-    vlc_mutex_unlock( &p_i->lock );
+
+    input_item_meta_snapshot_Release( snap );
     return psz;
 }
 
@@ -459,6 +590,19 @@ void input_item_Release( input_item_t *p_item )
     free( p_item->psz_name );
     free( p_item->psz_uri );
     free( p_item->p_stats );
+
+    /* No other references to the item: no readers to synchronise with */
+    input_item_meta_snapshot_t *snap =
+        atomic_load_explicit( &owner->meta_snapshot, memory_order_relaxed );
+    if( snap != NULL )
+        input_item_meta_snapshot_Release( snap );
+    for( snap = owner->meta_retired; snap != NULL; )
+    {
+        input_item_meta_snapshot_t *next = snap->next;
+
+        input_item_meta_snapshot_Release( snap );
+        snap = next;
+    }
     vlc_meta_Delete( p_item->p_meta );
 
     for( input_item_opaque_t *o = p_item->opaques, *next; o != NULL; o = next )
@@ -831,6 +975,52 @@ void input_item_MergeInfos( input_item_t *p_item, info_category_t *p_cat )
                     &(vlc_event_t) { .type = vlc_InputItemInfoChanged } );
 }
 
+static bool EpgStringEquals( const char *a, const char *b )
+{
+    return a == b || ( a && b && !strcmp( a, b ) );
+}
+
+static bool EpgEventEquals( const vlc_epg_event_t *a, const vlc_epg_event_t *b )
+{
+    if( a == b )
+        return true;
+    if( a->i_start != b->i_start || a->i_duration != b->i_duration
+     || a->i_id != b->i_id || a->i_rating != b->i_rating
+     || a->i_description_items != b->i_description_items
+     || !EpgStringEquals( a->psz_name, b->psz_name )
+     || !EpgStringEquals( a->psz_short_description, b->psz_short_description )
+     || !EpgStringEquals( a->psz_description, b->psz_description ) )
+        return false;
+
+    for( int i = 0; i < a->i_description_items; i++ )
+        if( !EpgStringEquals( a->description_items[i].psz_key,
+                              b->description_items[i].psz_key )
+         || !EpgStringEquals( a->description_items[i].psz_value,
+                              b->description_items[i].psz_value ) )
+            return false;
+    return true;
+}
+
+/* Tables are sent again by the demuxers as soon as any of their sections
+ * changed: tell the unchanged ones apart, not to notify them again */
+static bool EpgEquals( const vlc_epg_t *a, const vlc_epg_t *b )
+{
+    if( a->i_event != b->i_event || a->b_present != b->b_present
+     || !EpgStringEquals( a->psz_name, b->psz_name )
+     || ( a->p_current == NULL ) != ( b->p_current == NULL ) )
+        return false;
+
+    for( size_t i = 0; i < a->i_event; i++ )
+    {
+        if( ( a->p_current == a->pp_event[i] )
+         != ( b->p_current == b->pp_event[i] ) )
+            return false;
+        if( !EpgEventEquals( a->pp_event[i], b->pp_event[i] ) )
+            return false;
+    }
+    return true;
+}
+
 void input_item_SetEpgEvent( input_item_t *p_item, const vlc_epg_event_t *p_epg_evt )
 {
     bool b_changed = false;
@@ -844,6 +1034,9 @@ void input_item_SetEpgEvent( input_item_t *p_item, const vlc_epg_event_t *p_epg_
             /* Same event can exist in more than one table */
             if( p_epg->pp_event[j]->i_id == p_epg_evt->i_id )
             {
+                if( EpgEventEquals( p_epg->pp_event[j], p_epg_evt ) )
+                    break;
+
                 vlc_epg_event_t *p_dup = vlc_epg_event_Duplicate( p_epg_evt );
                 if( p_dup )
                 {
@@ -883,11 +1076,9 @@ static int InputItemAddInfo( input_item_t *p_i,
 }
 #endif
 
-void input_item_SetEpg( input_item_t *p_item, const vlc_epg_t *p_update, bool b_current_source )
+bool input_item_SetEpg( input_item_t *p_item, const vlc_epg_t *p_update, bool b_current_source )
 {
-    vlc_epg_t *p_epg = vlc_epg_Duplicate( p_update );
-    if( !p_epg )
-        return;
+    vlc_epg_t *p_epg;
 
     vlc_mutex_lock( &p_item->lock );
 
@@ -903,6 +1094,22 @@ void input_item_SetEpg( input_item_t *p_item, const vlc_epg_t *p_update, bool b_
         }
     }
 
+    if( pp_epg && EpgEquals( *pp_epg, p_update ) )
+    {
+        if( b_current_source && (*pp_epg)->b_present )
+            p_item->p_epg_table = *pp_epg;
+        vlc_mutex_unlock( &p_item->lock );
+        return false;
+    }
+
+    /* The events are shared with the update, not copied */
+    p_epg = vlc_epg_Duplicate( p_update );
+    if( !p_epg )
+    {
+        vlc_mutex_unlock( &p_item->lock );
+        return false;
+    }
+
     /* replace with new version */
     if( pp_epg )
     {
@@ -958,6 +1165,7 @@ signal:
 #endif
     vlc_event_send( &p_item->event_manager,
                     &(vlc_event_t){ .type = vlc_InputItemInfoChanged, } );
+    return true;
 }
 
 void input_item_ChangeEPGSource( input_item_t *p_item, int i_source_id )
@@ -1030,6 +1238,8 @@ input_item_NewExt( const char *psz_uri, const char *psz_name,
         return NULL;
 
     vlc_atomic_rc_init( &owner->rc );
+    atomic_init( &owner->meta_snapshot, NULL );
+    owner->meta_retired = NULL;
 
     input_item_t *p_input = &owner->item;
     vlc_event_manager_t * p_em = &p_input->event_manager;
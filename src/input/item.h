@@ -30,10 +30,23 @@ void input_item_SetErrorWhenReading( input_item_t *p_i, bool b_error );
 void input_item_UpdateTracksInfo( input_item_t *item, const es_format_t *fmt );
 bool input_item_ShouldPreparseSubItems( input_item_t *p_i );
 
+/**
+ * Frees the meta data snapshots retired by the readers.
+ *
+ * Meta data writers must call this after they updated item->p_meta, with the
+ * item lock released. This waits for the readers of the retired snapshots,
+ * so it must not be called from an RCU read-side critical section.
+ */
+void input_item_ReclaimMetaSnapshots( input_item_t *p_i );
+
 typedef struct input_item_owner
 {
     input_item_t item;
     vlc_atomic_rc_t rc;
+    /* Last meta data snapshot, RCU-protected */
+    struct input_item_meta_snapshot *_Atomic meta_snapshot;
+    /* Replaced snapshots pending reclamation, protected by item.lock */
+    struct input_item_meta_snapshot *meta_retired;
 } input_item_owner_t;
 
 # define item_owner(item) ((struct input_item_owner *)(item))
@@ -0,0 +1,110 @@
+/*****************************************************************************
+ * media_decoder.c: Decoding a media without playback
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_media_decoder.h>
+#include "input_internal.h"
+
+struct vlc_media_decoder_t
+{
+    struct vlc_object_t obj;
+    input_thread_t *input;
+
+    const struct vlc_media_decoder_cbs *cbs;
+    void *userdata;
+
+    atomic_bool ended;
+};
+
+static void
+on_decoding_input_event(input_thread_t *input,
+                        const struct vlc_input_event *event, void *userdata)
+{
+    VLC_UNUSED(input);
+    vlc_media_decoder_t *dec = userdata;
+
+    switch (event->type)
+    {
+        case INPUT_EVENT_PICTURE_DECODED:
+            dec->cbs->on_picture(event->picture, dec->userdata);
+            break;
+        case INPUT_EVENT_AUDIO_DECODED:
+            dec->cbs->on_audio(event->audio.fmt, event->audio.block,
+                               dec->userdata);
+            break;
+        case INPUT_EVENT_STATE:
+            if (event->state.value != END_S && event->state.value != ERROR_S)
+                break;
+            /* An error may be followed by the end of the stream */
+            if (!atomic_exchange(&dec->ended, true)
+             && dec->cbs->on_ended != NULL)
+                dec->cbs->on_ended(dec->userdata);
+            break;
+        default:
+            break;
+    }
+}
+
+vlc_media_decoder_t *
+vlc_media_decoder_New(vlc_object_t *parent, input_item_t *item,
+                      const struct vlc_media_decoder_cbs *cbs, void *userdata)
+{
+    vlc_media_decoder_t *dec =
+        vlc_custom_create(parent, sizeof (*dec), "media decoder");
+    if (unlikely(dec == NULL))
+        return NULL;
+
+    dec->cbs = cbs;
+    dec->userdata = userdata;
+    atomic_init(&dec->ended, false);
+
+    /* Inherited by the input to select the elementary streams */
+    var_Create(dec, "video", VLC_VAR_BOOL);
+    var_SetBool(dec, "video", cbs->on_picture != NULL);
+    var_Create(dec, "audio", VLC_VAR_BOOL);
+    var_SetBool(dec, "audio", cbs->on_audio != NULL);
+
+    dec->input = input_Create(dec, on_decoding_input_event, dec, item,
+                              INPUT_TYPE_DECODING, NULL, NULL);
+    if (dec->input == NULL)
+        goto error;
+
+    if (input_Start(dec->input) != VLC_SUCCESS)
+    {
+        input_Close(dec->input);
+        goto error;
+    }
+    return dec;
+
+error:
+    vlc_object_delete(dec);
+    return NULL;
+}
+
+void
+vlc_media_decoder_Delete(vlc_media_decoder_t *dec)
+{
+    input_Stop(dec->input);
+    input_Close(dec->input);
+    vlc_object_delete(dec);
+}
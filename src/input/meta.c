@@ -32,6 +32,7 @@
 #include <vlc_arrays.h>
 #include <vlc_modules.h>
 #include <vlc_charset.h>
+#include <vlc_atomic.h>
 
 #include "input_internal.h"
 #include "../preparser/art.h"
@@ -43,6 +44,9 @@ struct vlc_meta_t
     vlc_dictionary_t extra_tags;
 
     int i_status;
+
+    /* Changed with every table or extra entry update */
+    atomic_uint version;
 };
 
 /* FIXME bad name convention */
@@ -97,6 +101,7 @@ vlc_meta_t *vlc_meta_New( void )
     memset( m->ppsz_meta, 0, sizeof(m->ppsz_meta) );
     m->i_status = 0;
     vlc_dictionary_init( &m->extra_tags, 0 );
+    atomic_init( &m->version, 0 );
     return m;
 }
 
@@ -126,6 +131,7 @@ void vlc_meta_Set( vlc_meta_t *p_meta, vlc_meta_type_t meta_type, const char *ps
     free( p_meta->ppsz_meta[meta_type] );
     assert( psz_val == NULL || IsUTF8( psz_val ) );
     p_meta->ppsz_meta[meta_type] = psz_val ? strdup( psz_val ) : NULL;
+    atomic_fetch_add_explicit( &p_meta->version, 1, memory_order_release );
 }
 
 const char *vlc_meta_Get( const vlc_meta_t *p_meta, vlc_meta_type_t meta_type )
@@ -140,6 +146,7 @@ void vlc_meta_AddExtra( vlc_meta_t *m, const char *psz_name, const char *psz_val
         vlc_dictionary_remove_value_for_key( &m->extra_tags, psz_name,
                                             vlc_meta_FreeExtraKey, NULL );
     vlc_dictionary_insert( &m->extra_tags, psz_name, strdup(psz_value) );
+    atomic_fetch_add_explicit( &m->version, 1, memory_order_release );
 }
 
 const char * vlc_meta_GetExtra( const vlc_meta_t *m, const char *psz_name )
@@ -200,6 +207,12 @@ void vlc_meta_Merge( vlc_meta_t *dst, const vlc_meta_t *src )
         free( ppsz_all_keys[i] );
     }
     free( ppsz_all_keys );
+    atomic_fetch_add_explicit( &dst->version, 1, memory_order_release );
+}
+
+unsigned vlc_meta_GetVersion( const vlc_meta_t *m )
+{
+    return atomic_load_explicit( &m->version, memory_order_acquire );
 }
 
 
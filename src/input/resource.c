@@ -373,13 +373,20 @@ static void input_resource_PutVoutLocked(input_resource_t *p_resource,
         *vout_state = vout_rsc->started ? INPUT_RESOURCE_VOUT_STOPPED
                                         : INPUT_RESOURCE_VOUT_NOTCHANGED;
 
+    const bool saved = vout_rsc == resource_GetFirstVoutRsc(p_resource);
+
     if (vout_rsc->started)
     {
-        vout_StopDisplay(vout_rsc->vout);
+        /* Keep the display of the saved vout, so that the next input with a
+         * similar format starts displaying without reopening it */
+        if (saved)
+            vout_SuspendDisplay(vout_rsc->vout);
+        else
+            vout_StopDisplay(vout_rsc->vout);
         vout_rsc->started = false;
     }
 
-    if (vout_rsc == resource_GetFirstVoutRsc(p_resource))
+    if (saved)
     {
         assert(p_resource->vout_rsc_free == NULL || p_resource->vout_rsc_free == vout_rsc);
 
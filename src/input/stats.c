@@ -24,6 +24,7 @@
 # include "config.h"
 #endif
 
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -68,6 +69,18 @@ struct input_stats *input_stats_Create(void)
     atomic_init(&stats->displayed_pictures, 0);
     atomic_init(&stats->late_pictures, 0);
     atomic_init(&stats->lost_pictures, 0);
+
+    vlc_mutex_init(&stats->clock.lock);
+    stats->clock.drift = 0.f;
+    stats->clock.latency = VLC_TICK_INVALID;
+    for (unsigned i = 0; i < INPUT_STATS_CLOCK_BUCKETS; i++)
+    {
+        stats->clock.jitter_histogram[i] = 0;
+        stats->clock.drift_histogram[i] = 0;
+    }
+    for (unsigned i = 0; i < INPUT_STATS_PACING_TYPES; i++)
+        for (unsigned j = 0; j < INPUT_STATS_PACING_BUCKETS; j++)
+            atomic_init(&stats->pacing[i][j], 0);
     return stats;
 }
 
@@ -76,6 +89,62 @@ void input_stats_Destroy(struct input_stats *stats)
     free(stats);
 }
 
+/* Index of the first power of two bucket above the value */
+static unsigned stats_GetBucket(double value)
+{
+    unsigned i = 0;
+
+    while (i < INPUT_STATS_CLOCK_BUCKETS - 1 && value >= (double)(1u << i))
+        i++;
+    return i;
+}
+
+/**
+ * Accounts a clock reference of a live input
+ * \param jitter deviation of the reference from the recovered clock
+ * \param drift estimated clock drift (ppm)
+ */
+void input_stats_AddClock(struct input_stats *stats, vlc_tick_t jitter,
+                          double drift)
+{
+    unsigned jitter_bucket = stats_GetBucket(fabs(jitter / (double)VLC_TICK_FROM_MS(1)));
+    unsigned drift_bucket = stats_GetBucket(fabs(drift));
+
+    vlc_mutex_lock(&stats->clock.lock);
+    stats->clock.drift = drift;
+    stats->clock.jitter_histogram[jitter_bucket]++;
+    stats->clock.drift_histogram[drift_bucket]++;
+    vlc_mutex_unlock(&stats->clock.lock);
+}
+
+/**
+ * Accounts the expected delay from the reception of a live data block to its
+ * rendering (smoothed over the last blocks)
+ */
+void input_stats_AddLatency(struct input_stats *stats, vlc_tick_t latency)
+{
+    vlc_mutex_lock(&stats->clock.lock);
+    if (stats->clock.latency == VLC_TICK_INVALID)
+        stats->clock.latency = latency;
+    else
+        stats->clock.latency = (7 * stats->clock.latency + latency) / 8;
+    vlc_mutex_unlock(&stats->clock.lock);
+}
+
+/**
+ * Accounts the frame pacing histograms of a video output
+ */
+void input_stats_AddPacing(struct input_stats *stats,
+                           const struct input_stats_pacing *pacing)
+{
+    for (unsigned i = 0; i < INPUT_STATS_PACING_TYPES; i++)
+        for (unsigned j = 0; j < INPUT_STATS_PACING_BUCKETS; j++)
+            if (pacing->histogram[i][j] > 0)
+                atomic_fetch_add_explicit(&stats->pacing[i][j],
+                                          pacing->histogram[i][j],
+                                          memory_order_relaxed);
+}
+
 void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
 {
     /* Input */
@@ -111,6 +180,31 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
                                                     memory_order_relaxed);
     st->i_lost_pictures = atomic_load_explicit(&stats->lost_pictures,
                                                memory_order_relaxed);
+
+    /* Clock */
+    vlc_mutex_lock(&stats->clock.lock);
+    st->f_clock_drift = stats->clock.drift;
+    st->i_latency = stats->clock.latency != VLC_TICK_INVALID ?
+                    stats->clock.latency : 0;
+    for (unsigned i = 0; i < INPUT_STATS_CLOCK_BUCKETS; i++)
+    {
+        st->i_clock_jitter[i] = stats->clock.jitter_histogram[i];
+        st->i_clock_drift[i] = stats->clock.drift_histogram[i];
+    }
+    vlc_mutex_unlock(&stats->clock.lock);
+
+    /* Frame pacing */
+    for (unsigned i = 0; i < INPUT_STATS_PACING_BUCKETS; i++)
+    {
+        st->i_decode_late[i] = atomic_load_explicit(
+            &stats->pacing[INPUT_STATS_PACING_DECODE][i], memory_order_relaxed);
+        st->i_filter_time[i] = atomic_load_explicit(
+            &stats->pacing[INPUT_STATS_PACING_FILTER][i], memory_order_relaxed);
+        st->i_render_time[i] = atomic_load_explicit(
+            &stats->pacing[INPUT_STATS_PACING_RENDER][i], memory_order_relaxed);
+        st->i_display_late[i] = atomic_load_explicit(
+            &stats->pacing[INPUT_STATS_PACING_DISPLAY][i], memory_order_relaxed);
+    }
 }
 
 /** Update a counter element with new values
@@ -523,6 +523,13 @@ ssize_t vlc_stream_Peek(stream_t *s, const uint8_t **restrict bufp, size_t len)
         priv->block = NULL;
     }
 
+    if (peek == NULL && s->pf_block != NULL && len > 0 && !vlc_killed())
+    {   /* Peek into the next block rather than copying it */
+        bool eof = false;
+
+        peek = s->pf_block(s, &eof);
+    }
+
     if (peek == NULL)
     {
         peek = block_Alloc(len);
@@ -659,6 +666,18 @@ int vlc_stream_Seek(stream_t *s, uint64_t offset)
     {
         if (priv->offset == offset)
             return VLC_SUCCESS; /* Nothing to do! */
+
+        block_t *block = priv->block;
+        if (block != NULL && offset > priv->offset
+         && offset - priv->offset < block->i_buffer)
+        {   /* Seeking within the pending block */
+            size_t fwd = offset - priv->offset;
+
+            block->p_buffer += fwd;
+            block->i_buffer -= fwd;
+            priv->offset = offset;
+            return VLC_SUCCESS;
+        }
     }
 
     if (s->pf_seek == NULL)
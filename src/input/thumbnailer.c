@@ -59,7 +59,6 @@ struct vlc_thumbnailer_request_t
 {
     vlc_thumbnailer_t *thumbnailer;
 
-    struct seek_target seek_target;
     bool fast_seek;
     input_item_t *item;
     /**
@@ -72,28 +71,36 @@ struct vlc_thumbnailer_request_t
 
     vlc_mutex_t lock;
     vlc_cond_t cond_ended;
-    bool ended;
-    picture_t *pic;
+    bool ended; /**< the input is stopped or the task is interrupted */
+    picture_t *pic; /**< thumbnail of the current target */
 
     struct vlc_runnable runnable; /**< to be passed to the executor */
 
     struct vlc_list node; /**< node of vlc_thumbnailer_t.submitted_tasks */
+
+    /* The thumbnails of all the targets are taken from the same input, in
+     * order, one callback per target */
+    size_t target_count;
+    struct seek_target targets[];
 };
 
 static void RunnableRun(void *);
 
 static task_t *
 TaskNew(vlc_thumbnailer_t *thumbnailer, input_item_t *item,
-        struct seek_target seek_target, bool fast_seek,
+        const struct seek_target *targets, size_t target_count, bool fast_seek,
         vlc_thumbnailer_cb cb, void *userdata, vlc_tick_t timeout)
 {
-    task_t *task = malloc(sizeof(*task));
+    assert(target_count > 0);
+
+    task_t *task = malloc(sizeof(*task) + target_count * sizeof(*targets));
     if (!task)
         return NULL;
 
     task->thumbnailer = thumbnailer;
     task->item = item;
-    task->seek_target = seek_target;
+    task->target_count = target_count;
+    memcpy(task->targets, targets, target_count * sizeof(*targets));
     task->fast_seek = fast_seek;
     task->cb = cb;
     task->userdata = userdata;
@@ -106,6 +113,7 @@ TaskNew(vlc_thumbnailer_t *thumbnailer, input_item_t *item,
 
     task->runnable.run = RunnableRun;
     task->runnable.userdata = task;
+    task->runnable.priority = VLC_RUNNABLE_PRIORITY_NORMAL;
 
     input_item_Hold(item);
 
@@ -143,6 +151,13 @@ static void NotifyThumbnail(task_t *task, picture_t *pic)
         picture_Release(pic);
 }
 
+/* Report a failure for the targets not handled yet */
+static void NotifyFailures(task_t *task, size_t from)
+{
+    for (size_t i = from; i < task->target_count; ++i)
+        NotifyThumbnail(task, NULL);
+}
+
 static void
 on_thumbnailer_input_event( input_thread_t *input,
                             const struct vlc_input_event *event, void *userdata )
@@ -165,16 +180,75 @@ on_thumbnailer_input_event( input_thread_t *input,
         return;
     }
 
-    task->ended = true;
-
     if (event->type == INPUT_EVENT_THUMBNAIL_READY)
-        task->pic = picture_Hold(event->thumbnail);
+    {
+        /* The decoder outputs a single picture after each seek */
+        if (!task->pic)
+            task->pic = picture_Hold(event->thumbnail);
+    }
+    else
+        task->ended = true;
 
     vlc_mutex_unlock(&task->lock);
 
     vlc_cond_signal(&task->cond_ended);
 }
 
+static void
+Seek(input_thread_t *input, const struct seek_target *target, bool fast_seek)
+{
+    if (target->type == VLC_THUMBNAILER_SEEK_TIME)
+        input_SetTime(input, target->time, fast_seek);
+    else
+    {
+        assert(target->type == VLC_THUMBNAILER_SEEK_POS);
+        input_SetPosition(input, target->pos, fast_seek);
+    }
+}
+
+/*
+ * Configure the decoders of the thumbnailing input to output a single picture
+ * as fast as possible.
+ */
+static void
+SetupDecoders(input_thread_t *input, bool fast_seek)
+{
+    /* The picture is scaled and converted anyway, the loop filter is not
+     * worth it */
+    var_Create(input, "avcodec-skiploopfilter", VLC_VAR_INTEGER);
+    var_SetInteger(input, "avcodec-skiploopfilter", 4 /* all */);
+
+    /* A fast seek lands on a keyframe, the other frames are not needed */
+    if (fast_seek)
+    {
+        var_Create(input, "avcodec-skip-frame", VLC_VAR_INTEGER);
+        var_SetInteger(input, "avcodec-skip-frame", 3 /* non-key */);
+    }
+}
+
+static picture_t *
+WaitThumbnail(task_t *task, vlc_tick_t deadline)
+{
+    vlc_mutex_lock(&task->lock);
+    if (deadline == VLC_TICK_INVALID)
+    {
+        while (!task->ended && !task->pic)
+            vlc_cond_wait(&task->cond_ended, &task->lock);
+    }
+    else
+    {
+        bool timeout = false;
+        while (!task->ended && !task->pic && !timeout)
+            timeout =
+                vlc_cond_timedwait(&task->cond_ended, &task->lock, deadline);
+    }
+    picture_t* pic = task->pic;
+    task->pic = NULL;
+    vlc_mutex_unlock(&task->lock);
+
+    return pic;
+}
+
 static void
 RunnableRun(void *userdata)
 {
@@ -187,42 +261,51 @@ RunnableRun(void *userdata)
             input_Create( thumbnailer->parent, on_thumbnailer_input_event, task,
                           task->item, INPUT_TYPE_THUMBNAILING, NULL, NULL );
     if (!input)
-        goto end;
-
-    if (task->seek_target.type == VLC_THUMBNAILER_SEEK_TIME)
-        input_SetTime(input, task->seek_target.time, task->fast_seek);
-    else
     {
-        assert(task->seek_target.type == VLC_THUMBNAILER_SEEK_POS);
-        input_SetPosition(input, task->seek_target.pos, task->fast_seek);
+        NotifyFailures(task, 0);
+        goto end;
     }
 
+    SetupDecoders(input, task->fast_seek);
+    Seek(input, &task->targets[0], task->fast_seek);
+
     int ret = input_Start(input);
     if (ret != VLC_SUCCESS)
     {
         input_Close(input);
+        NotifyFailures(task, 0);
         goto end;
     }
 
-    vlc_mutex_lock(&task->lock);
-    if (task->timeout == VLC_TICK_INVALID)
+    size_t i;
+    for (i = 0; i < task->target_count; ++i)
     {
-        while (!task->ended)
-            vlc_cond_wait(&task->cond_ended, &task->lock);
-    }
-    else
-    {
-        vlc_tick_t deadline = now + task->timeout;
-        bool timeout = false;
-        while (!task->ended && !timeout)
-            timeout =
-                vlc_cond_timedwait(&task->cond_ended, &task->lock, deadline);
-    }
-    picture_t* pic = task->pic;
-    task->pic = NULL;
-    vlc_mutex_unlock(&task->lock);
+        if (i > 0)
+        {
+            vlc_mutex_lock(&task->lock);
+            bool ended = task->ended;
+            vlc_mutex_unlock(&task->lock);
+            if (ended)
+                break;
+
+            /* Reuse the same input, the demuxer and the decoders are already
+             * opened */
+            Seek(input, &task->targets[i], task->fast_seek);
+            now = vlc_tick_now();
+        }
 
-    NotifyThumbnail(task, pic);
+        vlc_tick_t deadline = task->timeout == VLC_TICK_INVALID
+                            ? VLC_TICK_INVALID : now + task->timeout;
+        picture_t *pic = WaitThumbnail(task, deadline);
+        NotifyThumbnail(task, pic);
+        if (!pic)
+        {
+            /* timeout, interruption or end of stream */
+            i++;
+            break;
+        }
+    }
+    NotifyFailures(task, i);
 
     input_Stop(input);
     input_Close(input);
@@ -243,13 +326,14 @@ Interrupt(task_t *task)
 }
 
 static task_t *
-RequestCommon(vlc_thumbnailer_t *thumbnailer, struct seek_target seek_target,
+RequestCommon(vlc_thumbnailer_t *thumbnailer,
+              const struct seek_target *targets, size_t target_count,
               enum vlc_thumbnailer_seek_speed speed, input_item_t *item,
               vlc_tick_t timeout, vlc_thumbnailer_cb cb, void *userdata)
 {
     bool fast_seek = speed == VLC_THUMBNAILER_SEEK_FAST;
-    task_t *task = TaskNew(thumbnailer, item, seek_target, fast_seek, cb,
-                           userdata, timeout);
+    task_t *task = TaskNew(thumbnailer, item, targets, target_count,
+                           fast_seek, cb, userdata, timeout);
     if (!task)
         return NULL;
 
@@ -275,8 +359,34 @@ vlc_thumbnailer_RequestByTime( vlc_thumbnailer_t *thumbnailer,
         .type = VLC_THUMBNAILER_SEEK_TIME,
         .time = time,
     };
-    return RequestCommon(thumbnailer, seek_target, speed, item, timeout, cb,
-                         userdata);
+    return RequestCommon(thumbnailer, &seek_target, 1, speed, item, timeout,
+                         cb, userdata);
+}
+
+task_t *
+vlc_thumbnailer_RequestByTimes( vlc_thumbnailer_t *thumbnailer,
+                                const vlc_tick_t *times, size_t count,
+                                enum vlc_thumbnailer_seek_speed speed,
+                                input_item_t *item, vlc_tick_t timeout,
+                                vlc_thumbnailer_cb cb, void* userdata )
+{
+    if (count == 0)
+        return NULL;
+
+    struct seek_target *targets = vlc_alloc(count, sizeof(*targets));
+    if (!targets)
+        return NULL;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        targets[i].type = VLC_THUMBNAILER_SEEK_TIME;
+        targets[i].time = times[i];
+    }
+
+    task_t *task = RequestCommon(thumbnailer, targets, count, speed, item,
+                                 timeout, cb, userdata);
+    free(targets);
+    return task;
 }
 
 task_t *
@@ -289,8 +399,8 @@ vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
         .type = VLC_THUMBNAILER_SEEK_POS,
         .pos = pos,
     };
-    return RequestCommon(thumbnailer, seek_target, speed, item, timeout, cb,
-                         userdata);
+    return RequestCommon(thumbnailer, &seek_target, 1, speed, item, timeout,
+                         cb, userdata);
 }
 
 void vlc_thumbnailer_Cancel( vlc_thumbnailer_t* thumbnailer, task_t* task )
@@ -332,7 +442,7 @@ CancelAllTasks(vlc_thumbnailer_t *thumbnailer)
                                             &task->runnable);
         if (canceled)
         {
-            NotifyThumbnail(task, NULL);
+            NotifyFailures(task, 0);
             vlc_list_remove(&task->node);
             TaskDelete(task);
         }
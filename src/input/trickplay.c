@@ -0,0 +1,436 @@
+/*****************************************************************************
+ * trickplay.c: Trickplay previews generation
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+
+#include <vlc_common.h>
+#include <vlc_trickplay.h>
+#include <vlc_thumbnailer.h>
+#include <vlc_executor.h>
+#include <vlc_input_item.h>
+#include <vlc_picture.h>
+#include <vlc_image.h>
+#include <vlc_block.h>
+#include <vlc_fs.h>
+
+/* Roku BIF archive: header, index of (number, offset), then JPEG files */
+static const uint8_t bif_magic[8] = {
+    0x89, 'B', 'I', 'F', '\r', '\n', 0x1a, '\n',
+};
+#define BIF_HEADER_SIZE 64
+
+struct generator
+{
+    vlc_object_t *obj;
+    const struct vlc_trickplay_cfg *cfg;
+    vlc_executor_t *executor;
+
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    size_t count; /**< number of thumbnails */
+    size_t received; /**< number of thumbnails reported by the thumbnailer */
+    size_t pending; /**< number of jobs not finished */
+
+    picture_t **tiles; /**< scaled thumbnails (sprite sheets) */
+    block_t **frames; /**< encoded thumbnails (BIF) */
+};
+
+/** Scale and encode a single thumbnail, in parallel with the decoding */
+struct job
+{
+    struct generator *gen;
+    size_t index;
+    picture_t *pic;
+
+    struct vlc_runnable runnable; /**< to be passed to the executor */
+};
+
+static picture_t *
+ScaleTile(vlc_object_t *obj, picture_t *pic, unsigned width, unsigned height)
+{
+    /* crop to the aspect ratio of the tile, so that all tiles have the same
+     * size without distortion */
+    video_format_t fmt_in = pic->format;
+    if (fmt_in.i_visible_width == 0 || fmt_in.i_visible_height == 0)
+    {
+        fmt_in.i_visible_width = fmt_in.i_width;
+        fmt_in.i_visible_height = fmt_in.i_height;
+    }
+    if (fmt_in.i_sar_num == 0 || fmt_in.i_sar_den == 0)
+        fmt_in.i_sar_num = fmt_in.i_sar_den = 1;
+
+    uint64_t src_w = (uint64_t) fmt_in.i_visible_width * fmt_in.i_sar_num;
+    uint64_t src_h = (uint64_t) fmt_in.i_visible_height * fmt_in.i_sar_den;
+    if (src_w * height > src_h * width)
+    {
+        unsigned w = src_h * width / height / fmt_in.i_sar_num;
+        fmt_in.i_x_offset += (fmt_in.i_visible_width - w) / 2;
+        fmt_in.i_visible_width = w;
+    }
+    else
+    {
+        unsigned h = src_w * height / width / fmt_in.i_sar_den;
+        fmt_in.i_y_offset += (fmt_in.i_visible_height - h) / 2;
+        fmt_in.i_visible_height = h;
+    }
+
+    video_format_t fmt_out;
+    video_format_Init(&fmt_out, VLC_CODEC_RGBA);
+    fmt_out.i_width = fmt_out.i_visible_width = width;
+    fmt_out.i_height = fmt_out.i_visible_height = height;
+    fmt_out.i_sar_num = fmt_out.i_sar_den = 1;
+
+    if (fmt_in.i_chroma == VLC_CODEC_RGBA && fmt_in.i_x_offset == 0
+     && fmt_in.i_y_offset == 0 && fmt_in.i_visible_width == width
+     && fmt_in.i_visible_height == height)
+        return picture_Hold(pic);
+
+    /* the image handlers are not thread-safe */
+    image_handler_t *handler = image_HandlerCreate(obj);
+    if (!handler)
+        return NULL;
+
+    picture_t *tile = image_Convert(handler, pic, &fmt_in, &fmt_out);
+    image_HandlerDelete(handler);
+    return tile;
+}
+
+static void
+JobRun(void *userdata)
+{
+    struct job *job = userdata;
+    struct generator *gen = job->gen;
+    const struct vlc_trickplay_cfg *cfg = gen->cfg;
+
+    picture_t *tile = ScaleTile(gen->obj, job->pic, cfg->width, cfg->height);
+    picture_Release(job->pic);
+
+    block_t *frame = NULL;
+    if (tile && cfg->format == VLC_TRICKPLAY_BIF)
+    {
+        video_format_t fmt;
+        if (picture_Export(gen->obj, &frame, &fmt, tile, VLC_CODEC_JPEG,
+                           -1, -1, false) != VLC_SUCCESS)
+            frame = NULL;
+        picture_Release(tile);
+        tile = NULL;
+    }
+
+    vlc_mutex_lock(&gen->lock);
+    if (cfg->format == VLC_TRICKPLAY_BIF)
+        gen->frames[job->index] = frame;
+    else
+        gen->tiles[job->index] = tile;
+    assert(gen->pending > 0);
+    gen->pending--;
+    vlc_cond_signal(&gen->cond);
+    vlc_mutex_unlock(&gen->lock);
+
+    free(job);
+}
+
+static void
+OnThumbnail(void *data, picture_t *pic)
+{
+    struct generator *gen = data;
+
+    vlc_mutex_lock(&gen->lock);
+    /* the thumbnails are reported in order */
+    size_t index = gen->received++;
+    assert(index < gen->count);
+
+    struct job *job = pic ? malloc(sizeof(*job)) : NULL;
+    if (job)
+    {
+        job->gen = gen;
+        job->index = index;
+        job->pic = picture_Hold(pic);
+        job->runnable.run = JobRun;
+        job->runnable.userdata = job;
+        job->runnable.priority = VLC_RUNNABLE_PRIORITY_NORMAL;
+
+        gen->pending++;
+        vlc_executor_Submit(gen->executor, &job->runnable);
+    }
+    vlc_cond_signal(&gen->cond);
+    vlc_mutex_unlock(&gen->lock);
+}
+
+static FILE *
+OpenFile(const char *prefix, const char *suffix)
+{
+    char *path;
+    if (asprintf(&path, "%s%s", prefix, suffix) == -1)
+        return NULL;
+
+    FILE *file = vlc_fopen(path, "wb");
+    free(path);
+    return file;
+}
+
+static int
+WriteBIF(struct generator *gen, const char *prefix)
+{
+    uint32_t frame_count = 0;
+    for (size_t i = 0; i < gen->count; ++i)
+        if (gen->frames[i])
+            frame_count++;
+    if (frame_count == 0)
+        return VLC_EGENERIC;
+
+    FILE *file = OpenFile(prefix, ".bif");
+    if (!file)
+        return VLC_EGENERIC;
+
+    uint8_t header[BIF_HEADER_SIZE] = { 0 };
+    memcpy(header, bif_magic, sizeof(bif_magic));
+    SetDWLE(&header[8], 0); /* version */
+    SetDWLE(&header[12], frame_count);
+    SetDWLE(&header[16], MS_FROM_VLC_TICK(gen->cfg->interval));
+
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1;
+
+    /* the index ends with an entry pointing to the end of the last frame */
+    uint32_t offset = BIF_HEADER_SIZE + (frame_count + 1) * 8;
+    for (size_t i = 0; ok && i < gen->count; ++i)
+    {
+        if (!gen->frames[i])
+            continue;
+
+        uint8_t entry[8];
+        SetDWLE(&entry[0], i);
+        SetDWLE(&entry[4], offset);
+        ok = fwrite(entry, sizeof(entry), 1, file) == 1;
+        offset += gen->frames[i]->i_buffer;
+    }
+
+    uint8_t last[8];
+    SetDWLE(&last[0], UINT32_MAX);
+    SetDWLE(&last[4], offset);
+    ok = ok && fwrite(last, sizeof(last), 1, file) == 1;
+
+    for (size_t i = 0; ok && i < gen->count; ++i)
+        if (gen->frames[i])
+            ok = fwrite(gen->frames[i]->p_buffer, gen->frames[i]->i_buffer,
+                        1, file) == 1;
+
+    if (fclose(file))
+        ok = false;
+    return ok ? VLC_SUCCESS : VLC_EGENERIC;
+}
+
+static void
+WriteVTTTime(FILE *file, vlc_tick_t time)
+{
+    unsigned ms = MS_FROM_VLC_TICK(time);
+    fprintf(file, "%02u:%02u:%02u.%03u", ms / 3600000, ms / 60000 % 60,
+            ms / 1000 % 60, ms % 1000);
+}
+
+static block_t *
+EncodeSheet(struct generator *gen, size_t first, size_t count)
+{
+    const struct vlc_trickplay_cfg *cfg = gen->cfg;
+
+    video_format_t fmt;
+    video_format_Init(&fmt, VLC_CODEC_RGBA);
+    fmt.i_width = fmt.i_visible_width = cfg->columns * cfg->width;
+    fmt.i_height = fmt.i_visible_height =
+        (count + cfg->columns - 1) / cfg->columns * cfg->height;
+    fmt.i_sar_num = fmt.i_sar_den = 1;
+
+    picture_t *sheet = picture_NewFromFormat(&fmt);
+    if (!sheet)
+        return NULL;
+
+    plane_t *dst = &sheet->p[0];
+    for (int y = 0; y < dst->i_lines; ++y)
+        memset(&dst->p_pixels[y * dst->i_pitch], 0, dst->i_visible_pitch);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        picture_t *tile = gen->tiles[first + i];
+        if (!tile)
+            continue;
+
+        const plane_t *src = &tile->p[0];
+        unsigned x = i % cfg->columns * cfg->width;
+        unsigned y = i / cfg->columns * cfg->height;
+        unsigned lines = __MIN((unsigned) src->i_visible_lines, cfg->height);
+        size_t size = __MIN((size_t) src->i_visible_pitch,
+                            (size_t) cfg->width * 4);
+        for (unsigned l = 0; l < lines; ++l)
+            memcpy(&dst->p_pixels[(y + l) * dst->i_pitch + x * 4],
+                   &src->p_pixels[l * src->i_pitch], size);
+    }
+
+    block_t *block;
+    video_format_t fmt_out;
+    if (picture_Export(gen->obj, &block, &fmt_out, sheet, cfg->codec,
+                       -1, -1, false) != VLC_SUCCESS)
+        block = NULL;
+    picture_Release(sheet);
+    return block;
+}
+
+static int
+WriteSprites(struct generator *gen, const char *prefix)
+{
+    const struct vlc_trickplay_cfg *cfg = gen->cfg;
+    const char *ext = cfg->codec == VLC_CODEC_WEBP ? "webp"
+                    : cfg->codec == VLC_CODEC_PNG ? "png" : "jpg";
+    /* the sheets are referenced relatively to the index */
+    const char *name = strrchr(prefix, DIR_SEP_CHAR);
+    name = name ? name + 1 : prefix;
+
+    FILE *vtt = OpenFile(prefix, ".vtt");
+    if (!vtt)
+        return VLC_EGENERIC;
+    fputs("WEBVTT\n", vtt);
+
+    bool ok = true;
+    size_t per_sheet = cfg->columns * cfg->rows;
+    for (size_t first = 0, n = 0; ok && first < gen->count;
+         first += per_sheet, ++n)
+    {
+        size_t count = __MIN(per_sheet, gen->count - first);
+        block_t *block = EncodeSheet(gen, first, count);
+        if (!block)
+        {
+            ok = false;
+            break;
+        }
+
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), "-%zu.%s", n, ext);
+        FILE *file = OpenFile(prefix, suffix);
+        ok = file && fwrite(block->p_buffer, block->i_buffer, 1, file) == 1;
+        if (file && fclose(file))
+            ok = false;
+        block_Release(block);
+
+        for (size_t i = 0; ok && i < count; ++i)
+        {
+            size_t index = first + i;
+            fputc('\n', vtt);
+            WriteVTTTime(vtt, index * cfg->interval);
+            fputs(" --> ", vtt);
+            WriteVTTTime(vtt, (index + 1) * cfg->interval);
+            fprintf(vtt, "\n%s%s#xywh=%u,%u,%u,%u\n", name, suffix,
+                    (unsigned) (i % cfg->columns) * cfg->width,
+                    (unsigned) (i / cfg->columns) * cfg->height,
+                    cfg->width, cfg->height);
+        }
+    }
+
+    if (fclose(vtt))
+        ok = false;
+    return ok ? VLC_SUCCESS : VLC_EGENERIC;
+}
+
+int
+vlc_trickplay_Generate(vlc_object_t *obj, input_item_t *item,
+                       const struct vlc_trickplay_cfg *cfg_,
+                       const char *prefix)
+{
+    struct vlc_trickplay_cfg cfg = *cfg_;
+    if (cfg.interval <= 0 || cfg.width == 0 || cfg.height == 0)
+        return VLC_EINVAL;
+    if (cfg.format == VLC_TRICKPLAY_SPRITES && (!cfg.columns || !cfg.rows))
+        return VLC_EINVAL;
+    if (cfg.codec == 0)
+        cfg.codec = VLC_CODEC_JPEG;
+
+    vlc_tick_t duration = input_item_GetDuration(item);
+    if (duration <= 0)
+    {
+        msg_Err(obj, "trickplay: unknown duration, preparse the item first");
+        return VLC_EGENERIC;
+    }
+
+    struct generator gen = {
+        .obj = obj,
+        .cfg = &cfg,
+        .count = (duration + cfg.interval - 1) / cfg.interval,
+    };
+
+    int ret = VLC_ENOMEM;
+    vlc_tick_t *times = vlc_alloc(gen.count, sizeof(*times));
+    gen.tiles = calloc(gen.count, sizeof(*gen.tiles));
+    gen.frames = calloc(gen.count, sizeof(*gen.frames));
+    if (!times || !gen.tiles || !gen.frames)
+        goto end;
+
+    for (size_t i = 0; i < gen.count; ++i)
+        times[i] = i * cfg.interval;
+
+    vlc_mutex_init(&gen.lock);
+    vlc_cond_init(&gen.cond);
+
+    gen.executor = vlc_executor_New(vlc_GetCPUCount());
+    if (!gen.executor)
+        goto end;
+
+    ret = VLC_EGENERIC;
+    vlc_thumbnailer_t *thumbnailer = vlc_thumbnailer_Create(obj);
+    if (!thumbnailer)
+    {
+        vlc_executor_Delete(gen.executor);
+        goto end;
+    }
+
+    /* a single input decodes the keyframes closest to the interval while
+     * the previous thumbnails are scaled by the executor */
+    vlc_thumbnailer_request_t *req =
+        vlc_thumbnailer_RequestByTimes(thumbnailer, times, gen.count,
+                                       VLC_THUMBNAILER_SEEK_FAST, item,
+                                       cfg.timeout, OnThumbnail, &gen);
+    if (req)
+    {
+        vlc_mutex_lock(&gen.lock);
+        while (gen.received < gen.count || gen.pending > 0)
+            vlc_cond_wait(&gen.cond, &gen.lock);
+        vlc_mutex_unlock(&gen.lock);
+    }
+    vlc_thumbnailer_Release(thumbnailer);
+    vlc_executor_Delete(gen.executor);
+
+    if (req)
+        ret = cfg.format == VLC_TRICKPLAY_BIF ? WriteBIF(&gen, prefix)
+                                              : WriteSprites(&gen, prefix);
+
+end:
+    if (gen.tiles)
+        for (size_t i = 0; i < gen.count; ++i)
+            if (gen.tiles[i])
+                picture_Release(gen.tiles[i]);
+    if (gen.frames)
+        for (size_t i = 0; i < gen.count; ++i)
+            if (gen.frames[i])
+                block_Release(gen.frames[i]);
+    free(gen.tiles);
+    free(gen.frames);
+    free(times);
+    return ret;
+}
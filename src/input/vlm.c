@@ -46,6 +46,7 @@
 #include "vlm_event.h"
 #include <vlc_sout.h>
 #include <vlc_url.h>
+#include <vlc_memstream.h>
 #include "../stream_output/stream_output.h"
 #include "../libvlc.h"
 #include "input_internal.h"
@@ -69,6 +70,8 @@ static void player_on_state_changed(vlc_player_t *player,
         if( p_media->instance[i]->player == player )
         {
             psz_instance_name = p_media->instance[i]->psz_name;
+            if( new_state != VLC_PLAYER_STATE_STOPPED )
+                p_media->instance[i]->p_source->b_opened = true;
             break;
         }
     }
@@ -143,6 +146,7 @@ vlm_t *vlm_New( libvlc_int_t *libvlc, const char *psz_vlmconf )
     p_vlm->i_id = 1;
     TAB_INIT( p_vlm->i_media, p_vlm->media );
     TAB_INIT( p_vlm->i_schedule, p_vlm->schedule );
+    TAB_INIT( p_vlm->i_source, p_vlm->source );
     var_Create( p_vlm, "intf-event", VLC_VAR_ADDRESS );
 
     if( vlc_clone( &p_vlm->thread, Manage, p_vlm, VLC_THREAD_PRIORITY_LOW ) )
@@ -204,6 +208,8 @@ void vlm_Delete( vlm_t *p_vlm )
 
     vlm_ControlInternal( p_vlm, VLM_CLEAR_SCHEDULES );
     TAB_CLEAN( p_vlm->i_schedule, p_vlm->schedule );
+    assert( p_vlm->i_source == 0 );
+    TAB_CLEAN( p_vlm->i_source, p_vlm->source );
     vlc_mutex_unlock( &p_vlm->lock );
 
     vlc_mutex_lock( &p_vlm->lock_manage );
@@ -259,8 +265,11 @@ static void* Manage( void* p_object )
             {
                 vlm_media_instance_sys_t *p_instance = p_media->instance[j];
 
+                /* The state of a new player only changes once its input
+                 * thread is running */
                 vlc_player_Lock(p_instance->player);
-                if (!vlc_player_IsStarted(p_instance->player))
+                if (p_instance->p_source->b_opened &&
+                    !vlc_player_IsStarted(p_instance->player))
                 {
                     vlc_player_Unlock(p_instance->player);
                     int i_new_input_index;
@@ -583,74 +592,302 @@ static vlm_media_instance_sys_t *vlm_ControlMediaInstanceGetByName( vlm_media_sy
     return NULL;
 }
 
-static vlm_media_instance_sys_t *vlm_MediaInstanceNew( vlm_media_sys_t *p_media, const char *psz_name )
+/* Broadcasts of the same input with the same options share a single player;
+ * its sout is a duplicate hub, and every instance adds its output to the
+ * list of the hub variable */
+#define VLM_SOURCE_HUB "vlm-outputs"
+
+static char *vlm_SourceKey( const vlm_media_t *p_cfg, const char *psz_uri )
 {
-    vlm_media_instance_sys_t *p_instance = calloc( 1, sizeof(vlm_media_instance_sys_t) );
-    if( !p_instance )
+    if( p_cfg->psz_output == NULL )
         return NULL;
 
-    p_instance->psz_name = NULL;
-    if( psz_name )
-        p_instance->psz_name = strdup( psz_name );
+    struct vlc_memstream key;
+    vlc_memstream_open( &key );
+    vlc_memstream_puts( &key, psz_uri );
+    for( int i = 0; i < p_cfg->i_option; i++ )
+    {
+        vlc_memstream_putc( &key, '\n' );
+        vlc_memstream_puts( &key, p_cfg->ppsz_option[i] );
+    }
+    if( vlc_memstream_close( &key ) )
+        return NULL;
+    return key.ptr;
+}
 
-    p_instance->p_item = input_item_New( NULL, NULL );
-    if (!p_instance->p_item)
-        goto error;
+static bool vlm_SourceHasOutput( vlm_source_sys_t *p_source,
+                                 const char *psz_output )
+{
+    vlc_value_t *p_vals;
+    size_t i_count;
+    bool b_found = false;
+
+    if( var_Change( p_source->p_parent, VLM_SOURCE_HUB, VLC_VAR_GETCHOICES,
+                    &i_count, &p_vals, (char ***)NULL ) )
+        return false;
+    for( size_t i = 0; i < i_count; i++ )
+    {
+        if( !strcmp( p_vals[i].psz_string, psz_output ) )
+            b_found = true;
+        free( p_vals[i].psz_string );
+    }
+    free( p_vals );
+    return b_found;
+}
 
-    p_instance->i_index = 0;
-    p_instance->p_parent = vlc_object_create( p_media, sizeof (vlc_object_t) );
-    if (!p_instance->p_parent)
+static vlm_source_sys_t *vlm_SourceFind( vlm_t *p_vlm, const char *psz_key,
+                                         const char *psz_output )
+{
+    for( int i = 0; i < p_vlm->i_source; i++ )
+    {
+        vlm_source_sys_t *p_source = p_vlm->source[i];
+
+        if( p_source->psz_key == NULL || strcmp( p_source->psz_key, psz_key ) )
+            continue;
+
+        /* Do not join an input that is ending, nor feed an output twice */
+        vlc_player_Lock( p_source->player );
+        bool b_started = !p_source->b_opened ||
+                         vlc_player_IsStarted( p_source->player );
+        vlc_player_Unlock( p_source->player );
+        if( b_started && !vlm_SourceHasOutput( p_source, psz_output ) )
+            return p_source;
+    }
+    return NULL;
+}
+
+static void vlm_SourceDelete( vlm_t *p_vlm, vlm_source_sys_t *p_source )
+{
+    if( p_source->player )
+        vlc_player_Delete( p_source->player );
+    if( p_source->p_parent )
+        vlc_object_delete( p_source->p_parent );
+    if( p_source->p_item )
+        input_item_Release( p_source->p_item );
+
+    TAB_REMOVE( p_vlm->i_source, p_vlm->source, p_source );
+    free( p_source->psz_key );
+    free( p_source );
+}
+
+static vlm_source_sys_t *vlm_SourceNew( vlm_t *p_vlm, const vlm_media_t *p_cfg,
+                                        const char *psz_uri, char *psz_key )
+{
+    vlm_source_sys_t *p_source = calloc( 1, sizeof(vlm_source_sys_t) );
+    if( !p_source )
+    {
+        free( psz_key );
+        return NULL;
+    }
+    p_source->psz_key = psz_key;
+    TAB_APPEND( p_vlm->i_source, p_vlm->source, p_source );
+
+    p_source->p_item = input_item_New( NULL, NULL );
+    if( !p_source->p_item )
         goto error;
+    input_item_SetURI( p_source->p_item, psz_uri );
 
-    p_instance->player = vlc_player_New(p_instance->p_parent,
-                                        VLC_PLAYER_LOCK_NORMAL, NULL, NULL);
-    if (!p_instance->player)
+    p_source->p_parent = vlc_object_create( p_vlm, sizeof (vlc_object_t) );
+    if( !p_source->p_parent )
         goto error;
 
-    static struct vlc_player_cbs cbs = {
-        .on_state_changed = player_on_state_changed,
-    };
-    vlc_player_Lock(p_instance->player);
-    p_instance->listener =
-        vlc_player_AddListener(p_instance->player, &cbs, p_media);
-    vlc_player_Unlock(p_instance->player);
+    const char *psz_output = p_cfg->psz_output;
+    if( psz_key != NULL )
+    {
+        var_Create( p_source->p_parent, VLM_SOURCE_HUB, VLC_VAR_STRING );
+        psz_output = "#duplicate{hub=" VLM_SOURCE_HUB "}";
+    }
+    if( psz_output != NULL )
+    {
+        char *psz_buffer;
+        if( asprintf( &psz_buffer, "sout=%s", psz_output ) != -1 )
+        {
+            input_item_AddOption( p_source->p_item, psz_buffer, VLC_INPUT_OPTION_TRUSTED );
+            free( psz_buffer );
+        }
+    }
 
-    if (!p_instance->listener)
+    for( int i = 0; i < p_cfg->i_option; i++ )
+        input_item_AddOption( p_source->p_item, p_cfg->ppsz_option[i], VLC_INPUT_OPTION_TRUSTED );
+
+    p_source->player = vlc_player_New(p_source->p_parent,
+                                      VLC_PLAYER_LOCK_NORMAL, NULL, NULL);
+    if (!p_source->player)
         goto error;
-    return p_instance;
+    return p_source;
 
 error:
-    if (p_instance->player)
-        vlc_player_Delete(p_instance->player);
-    if (p_instance->p_parent)
-        vlc_object_delete(p_instance->p_parent);
-    if (p_instance->p_item)
-        input_item_Release(p_instance->p_item);
-    free(p_instance->psz_name);
-    free(p_instance);
+    vlm_SourceDelete( p_vlm, p_source );
     return NULL;
 }
-static void vlm_MediaInstanceDelete( vlm_t *p_vlm, int64_t id, vlm_media_instance_sys_t *p_instance, vlm_media_sys_t *p_media )
+
+static bool vlm_MediaInstanceDetach( vlm_t *p_vlm,
+                                     vlm_media_instance_sys_t *p_instance )
 {
-    vlc_player_t *player = p_instance->player;
+    vlm_source_sys_t *p_source = p_instance->p_source;
+    vlc_player_t *player = p_source->player;
 
     vlc_player_Lock(player);
     vlc_player_RemoveListener(player, p_instance->listener);
-    vlc_player_Stop(player);
     bool had_media = vlc_player_GetCurrentMedia(player);
+    if( p_source->i_users == 1 )
+        vlc_player_Stop(player);
     vlc_player_Unlock(player);
-    vlc_player_Delete(player);
 
-    if (had_media)
-        vlm_SendEventMediaInstanceStopped( p_vlm, id, p_media->cfg.psz_name );
-    vlc_object_delete(p_instance->p_parent);
+    /* The other instances keep on playing the source */
+    if( p_instance->psz_output != NULL )
+        var_Change( p_source->p_parent, VLM_SOURCE_HUB, VLC_VAR_DELCHOICE,
+                    (vlc_value_t){ .psz_string = p_instance->psz_output } );
+    if( --p_source->i_users == 0 )
+        vlm_SourceDelete( p_vlm, p_source );
+
+    free( p_instance->psz_output );
+    p_instance->psz_output = NULL;
+    p_instance->p_source = NULL;
+    p_instance->player = NULL;
+    p_instance->listener = NULL;
+    return had_media;
+}
+
+static int vlm_MediaInstanceAttach( vlm_t *p_vlm, vlm_media_sys_t *p_media,
+                                    vlm_media_instance_sys_t *p_instance,
+                                    int i_input_index )
+{
+    const char *psz_input = p_media->cfg.ppsz_input[i_input_index];
+    char *psz_uri;
+
+    if( strstr( psz_input, "://" ) == NULL )
+        psz_uri = vlc_path2uri( psz_input, NULL );
+    else
+        psz_uri = strdup( psz_input );
+    if( psz_uri == NULL )
+        return VLC_ENOMEM;
+
+    /* The chains of the duplicate module are given without the leading '#' */
+    char *psz_key = vlm_SourceKey( &p_media->cfg, psz_uri );
+    char *psz_output = NULL;
+    if( psz_key != NULL )
+    {
+        const char *psz_chain = p_media->cfg.psz_output;
+        psz_output = strdup( psz_chain + (*psz_chain == '#') );
+        if( psz_output == NULL )
+        {
+            free( psz_key );
+            free( psz_uri );
+            return VLC_ENOMEM;
+        }
+    }
 
+    vlm_source_sys_t *p_source = NULL;
+    bool b_new = false;
+    if( psz_key != NULL )
+        p_source = vlm_SourceFind( p_vlm, psz_key, psz_output );
+    if( p_source != NULL )
+    {
+        msg_Dbg( p_vlm, "instance `%s' of `%s' shares the input `%s'",
+                 p_instance->psz_name ? p_instance->psz_name : "default",
+                 p_media->cfg.psz_name, psz_uri );
+        free( psz_key );
+    }
+    else
+    {
+        p_source = vlm_SourceNew( p_vlm, &p_media->cfg, psz_uri, psz_key );
+        b_new = true;
+    }
+    free( psz_uri );
+    if( p_source == NULL )
+    {
+        free( psz_output );
+        return VLC_ENOMEM;
+    }
+
+    static const struct vlc_player_cbs cbs = {
+        .on_state_changed = player_on_state_changed,
+    };
+    vlc_player_t *player = p_source->player;
+    vlc_player_Lock(player);
+    p_instance->listener = vlc_player_AddListener(player, &cbs, p_media);
+    vlc_player_Unlock(player);
+
+    if (!p_instance->listener)
+    {
+        if( b_new )
+            vlm_SourceDelete( p_vlm, p_source );
+        free( psz_output );
+        return VLC_ENOMEM;
+    }
+
+    if( psz_output != NULL )
+        var_Change( p_source->p_parent, VLM_SOURCE_HUB, VLC_VAR_ADDCHOICE,
+                    (vlc_value_t){ .psz_string = psz_output }, (const char *)NULL );
+
+    p_source->i_users++;
+    p_instance->p_source = p_source;
+    p_instance->psz_output = psz_output;
+    p_instance->player = player;
+    p_instance->i_index = i_input_index;
+
+    if( b_new )
+    {
+        vlc_player_Lock(player);
+        int i_ret = vlc_player_SetCurrentMedia(player, p_source->p_item);
+        if( i_ret == VLC_SUCCESS )
+            i_ret = vlc_player_Start(player);
+        vlc_player_Unlock(player);
+
+        if( i_ret != VLC_SUCCESS )
+        {
+            vlm_MediaInstanceDetach( p_vlm, p_instance );
+            return i_ret;
+        }
+    }
+    return VLC_SUCCESS;
+}
+
+static bool vlm_MediaInstanceIsShared( const vlm_media_instance_sys_t *p_instance )
+{
+    return p_instance->p_source->i_users > 1;
+}
+
+static vlm_media_instance_sys_t *vlm_MediaInstanceNew( vlm_media_sys_t *p_media, const char *psz_name )
+{
+    vlm_media_instance_sys_t *p_instance = calloc( 1, sizeof(vlm_media_instance_sys_t) );
+    if( !p_instance )
+        return NULL;
+
+    p_instance->psz_name = NULL;
+    if( psz_name )
+    {
+        p_instance->psz_name = strdup( psz_name );
+        if( !p_instance->psz_name )
+        {
+            free( p_instance );
+            return NULL;
+        }
+    }
+
+    p_instance->i_index = 0;
+    TAB_APPEND( p_media->i_instance, p_media->instance, p_instance );
+    return p_instance;
+}
+
+static void vlm_MediaInstanceFree( vlm_media_instance_sys_t *p_instance, vlm_media_sys_t *p_media )
+{
     TAB_REMOVE( p_media->i_instance, p_media->instance, p_instance );
-    input_item_Release( p_instance->p_item );
     free( p_instance->psz_name );
     free( p_instance );
 }
 
+static void vlm_MediaInstanceDelete( vlm_t *p_vlm, int64_t id, vlm_media_instance_sys_t *p_instance, vlm_media_sys_t *p_media )
+{
+    bool had_media = vlm_MediaInstanceDetach( p_vlm, p_instance );
+
+    if (had_media)
+        vlm_SendEventMediaInstanceStopped( p_vlm, id, p_media->cfg.psz_name );
+
+    vlm_MediaInstanceFree( p_instance, p_media );
+}
+
 
 static int vlm_ControlMediaInstanceStart( vlm_t *p_vlm, int64_t id, const char *psz_id, int i_input_index )
 {
@@ -666,60 +903,34 @@ static int vlm_ControlMediaInstanceStart( vlm_t *p_vlm, int64_t id, const char *
     p_instance = vlm_ControlMediaInstanceGetByName( p_media, psz_id );
     if( !p_instance )
     {
-        vlm_media_t *p_cfg = &p_media->cfg;
-
         p_instance = vlm_MediaInstanceNew( p_media, psz_id );
         if( !p_instance )
             return VLC_ENOMEM;
-
-        if( p_cfg->psz_output != NULL )
-        {
-            char *psz_buffer;
-            if( asprintf( &psz_buffer, "sout=%s", p_cfg->psz_output ) != -1 )
-            {
-                input_item_AddOption( p_instance->p_item, psz_buffer, VLC_INPUT_OPTION_TRUSTED );
-                free( psz_buffer );
-            }
-        }
-
-        for( int i = 0; i < p_cfg->i_option; i++ )
-            input_item_AddOption( p_instance->p_item, p_cfg->ppsz_option[i], VLC_INPUT_OPTION_TRUSTED );
-        TAB_APPEND( p_media->i_instance, p_media->instance, p_instance );
     }
-
-    /* Stop old instance */
-    vlc_player_t *player = p_instance->player;
-    vlc_player_Lock(player);
-    if (vlc_player_GetCurrentMedia(player))
+    else
     {
+        /* Stop old instance */
         if( p_instance->i_index == i_input_index )
         {
+            vlc_player_t *player = p_instance->player;
+            vlc_player_Lock(player);
             if (vlc_player_IsPaused(player))
                 vlc_player_Resume(player);
+            vlc_player_Unlock(player);
             return VLC_SUCCESS;
         }
 
-        vlc_player_Stop(player);
-        vlc_player_Unlock(player);
-        vlm_SendEventMediaInstanceStopped( p_vlm, id, p_media->cfg.psz_name );
-        vlc_player_Lock(player);
+        if( vlm_MediaInstanceDetach( p_vlm, p_instance ) )
+            vlm_SendEventMediaInstanceStopped( p_vlm, id, p_media->cfg.psz_name );
     }
 
     /* Start new one */
-    p_instance->i_index = i_input_index;
-    if( strstr( p_media->cfg.ppsz_input[p_instance->i_index], "://" ) == NULL )
+    int i_ret = vlm_MediaInstanceAttach( p_vlm, p_media, p_instance, i_input_index );
+    if( i_ret != VLC_SUCCESS )
     {
-        char *psz_uri = vlc_path2uri(
-                          p_media->cfg.ppsz_input[p_instance->i_index], NULL );
-        input_item_SetURI( p_instance->p_item, psz_uri ) ;
-        free( psz_uri );
+        vlm_MediaInstanceFree( p_instance, p_media );
+        return i_ret;
     }
-    else
-        input_item_SetURI( p_instance->p_item, p_media->cfg.ppsz_input[p_instance->i_index] ) ;
-
-    vlc_player_SetCurrentMedia(player, p_instance->p_item);
-    vlc_player_Start(player);
-    vlc_player_Unlock(player);
 
     vlm_SendEventMediaInstanceStarted( p_vlm, id, p_media->cfg.psz_name );
 
@@ -753,6 +964,13 @@ static int vlm_ControlMediaInstancePause( vlm_t *p_vlm, int64_t id, const char *
     if( !p_instance )
         return VLC_EGENERIC;
 
+    /* Pausing a shared input would pause the other instances */
+    if( vlm_MediaInstanceIsShared( p_instance ) )
+    {
+        msg_Warn( p_vlm, "cannot pause an instance sharing its input" );
+        return VLC_EGENERIC;
+    }
+
     vlc_player_Lock(p_instance->player);
     vlc_player_TogglePause(p_instance->player);
     vlc_player_Unlock(p_instance->player);
@@ -791,6 +1009,12 @@ static int vlm_ControlMediaInstanceSetTimePosition( vlm_t *p_vlm, int64_t id, co
     if( !p_instance )
         return VLC_EGENERIC;
 
+    if( vlm_MediaInstanceIsShared( p_instance ) )
+    {
+        msg_Warn( p_vlm, "cannot seek an instance sharing its input" );
+        return VLC_EGENERIC;
+    }
+
     vlc_player_Lock(p_instance->player);
     if( i_time >= 0 )
         vlc_player_SetTime(p_instance->player, VLC_TICK_FROM_US(i_time));
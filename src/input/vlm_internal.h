@@ -28,6 +28,22 @@
 #include "input_interface.h"
 
 /* Private */
+
+/* Input played by one or more broadcast instances */
+typedef struct
+{
+    /* MRL and options of the input, NULL if it cannot be shared */
+    char *psz_key;
+    /* number of instances attached */
+    unsigned i_users;
+    /* the player left the stopped state, protected by the player lock */
+    bool b_opened;
+
+    vlc_object_t *p_parent;
+    input_item_t      *p_item;
+    vlc_player_t *player;
+} vlm_source_sys_t;
+
 typedef struct
 {
     /* instance name */
@@ -36,8 +52,9 @@ typedef struct
     /* "playlist" index */
     int i_index;
 
-    vlc_object_t *p_parent;
-    input_item_t      *p_item;
+    vlm_source_sys_t *p_source;
+    /* output chain fed by a shared source, NULL if not shared */
+    char *psz_output;
     vlc_player_t *player;
     vlc_player_listener_id *listener;
 
@@ -97,6 +114,10 @@ struct vlm_t
     /* Schedule list */
     int            i_schedule;
     vlm_schedule_sys_t **schedule;
+
+    /* Inputs of the running instances */
+    int                i_source;
+    vlm_source_sys_t   **source;
 };
 
 int vlm_ControlInternal( vlm_t *p_vlm, int i_query, ... );
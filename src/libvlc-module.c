@@ -89,6 +89,16 @@ static const char *const ppsz_snap_formats[] =
     "This is the verbosity level (0=only errors and " \
     "standard messages, 1=warnings, 2=debug).")
 
+#define LOG_ASYNC_TEXT N_("Asynchronous logging")
+#define LOG_ASYNC_LONGTEXT N_( \
+    "Write log messages from a background thread, so that slow log " \
+    "outputs do not delay playback. Messages may be lost under heavy load.")
+
+#define LOG_RATE_TEXT N_("Log rate limit")
+#define LOG_RATE_LONGTEXT N_( \
+    "Maximum number of non-error log messages per second and per object " \
+    "with asynchronous logging (0 = unlimited).")
+
 #define OPEN_TEXT N_("Default stream")
 #define OPEN_LONGTEXT N_( \
     "This stream will always be opened at VLC startup." )
@@ -241,6 +251,12 @@ static const char *const ppsz_mix_mode_texts[] = {
     "This allows playing audio at lower or higher speed without " \
     "affecting the audio pitch" )
 
+#define AUDIO_GAPLESS_TEXT N_("Gapless playback")
+#define AUDIO_GAPLESS_LONGTEXT N_( \
+    "Keep the audio output stream open at the end of a media, and continue " \
+    "it with the next media if it has the same audio format, instead of " \
+    "draining and restarting the output.")
+
 
 static const char *const ppsz_replay_gain_mode[] = {
     "none", "track", "album" };
@@ -364,13 +380,13 @@ static const char * const  ppsz_deinterlace_text[] = {
     "Deinterlace method to use for video processing.")
 static const char * const ppsz_deinterlace_mode[] = {
     "auto", "discard", "blend", "mean", "bob",
-    "linear", "x", "yadif", "yadif2x", "phosphor",
-    "ivtc"
+    "linear", "x", "yadif", "yadif2x", "bwdif",
+    "bwdif2x", "phosphor", "ivtc"
 };
 static const char * const ppsz_deinterlace_mode_text[] = {
     N_("Auto"), N_("Discard"), N_("Blend"), N_("Mean"), N_("Bob"),
-    N_("Linear"), "X", "Yadif", "Yadif (2x)", N_("Phosphor"),
-    N_("Film NTSC (IVTC)")
+    N_("Linear"), "X", "Yadif", "Yadif (2x)", "BWDif",
+    "BWDif (2x)", N_("Phosphor"), N_("Film NTSC (IVTC)")
 };
 
 #define DEINTERLACE_FILTER_TEXT N_("Deinterlace filter")
@@ -487,6 +503,13 @@ static const char *const screensaver_texts[] = {
     "This drops frames that are late (arrive to the video output after " \
     "their intended display date)." )
 
+#define VIDEO_FILTER_THREAD_TEXT N_("Filter video in advance")
+#define VIDEO_FILTER_THREAD_LONGTEXT N_( \
+    "This runs the deinterlacing and post-processing filters on a separate " \
+    "thread, one picture ahead of the display. This reduces the time " \
+    "needed to output each picture, at the cost of one more picture of " \
+    "memory.")
+
 #define QUIET_SYNCHRO_TEXT N_("Quiet synchro")
 #define QUIET_SYNCHRO_LONGTEXT N_( \
     "This avoids flooding the message log with debug output from the " \
@@ -563,6 +586,23 @@ static const char *const ppsz_clock_master_descriptions[] = {
     N_("Monotonic")
 };
 
+#define CLOCK_RECOVERY_TEXT N_("Clock recovery")
+#define CLOCK_RECOVERY_LONGTEXT N_( "Select how the drift between the " \
+    "stream clock and the system clock is estimated on live inputs:\n" \
+    "average: moving average of the clock offset.\n" \
+    "regression: linear regression of the clock offset, ignoring late " \
+    "clock references. It locks faster and follows the drift without lag.\n" \
+    "pll: phase-locked loop on the clock offset.")
+
+static const char *const ppsz_clock_recovery_values[] = {
+    "average", "regression", "pll",
+};
+static const char *const ppsz_clock_recovery_descriptions[] = {
+    N_("Average"),
+    N_("Robust linear regression"),
+    N_("Phase-locked loop"),
+};
+
 static const int pi_clock_values[] = { -1, 0, 1 };
 static const char *const ppsz_clock_descriptions[] =
 { N_("Default"), N_("Disable"), N_("Enable") };
@@ -665,9 +705,17 @@ static const char *const ppsz_prefres[] = {
 
 #define INPUT_LOWDELAY_TEXT N_("Low delay mode")
 #define INPUT_LOWDELAY_LONGTEXT N_(\
-    "Try to minimize delay along decoding chain."\
+    "Try to minimize delay along decoding chain: the caching and the clock " \
+    "jitter compensation are capped, decoding starts without waiting for " \
+    "the whole caching, late data and pictures are dropped, and the audio " \
+    "output starts without delay when it drives the clock. " \
     "Might break with non compliant streams.")
 
+#define INPUT_LOWDELAY_CACHING_TEXT N_("Low delay caching (ms)")
+#define INPUT_LOWDELAY_CACHING_LONGTEXT N_(\
+    "Maximum caching value and clock jitter compensation in low delay " \
+    "mode, in milliseconds.")
+
 #define INPUT_REPEAT_TEXT N_("Input repetitions")
 #define INPUT_REPEAT_LONGTEXT N_( \
     "Number of time the same input will be repeated")
@@ -748,6 +796,11 @@ static const char* const ppsz_restore_playback_desc[] = {
     "This is the maximum size in bytes of the temporary files " \
     "that will be used to store the timeshifted streams." )
 
+#define INPUT_TIMESHIFT_HISTORY_TEXT N_("Timeshift history (MiB)")
+#define INPUT_TIMESHIFT_HISTORY_LONGTEXT N_( \
+    "Amount of timeshifted data kept on disk after it has been played, " \
+    "so that playback can jump back into it (0 to disable)." )
+
 #define INPUT_TITLE_FORMAT_TEXT N_( "Change title according to current media" )
 #define INPUT_TITLE_FORMAT_LONGTEXT N_( "This option allows you to set the title according to what's being played<br>"  \
     "$a: Artist<br>$b: Album<br>$c: Copyright<br>$t: Title<br>$g: Genre<br>"  \
@@ -991,6 +1044,24 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define DEC_DEV_TEXT N_("Preferred decoder hardware device")
 #define DEC_DEV_LONGTEXT N_("This allows hardware decoding when available.")
 
+#define DEC_THREADS_TEXT N_("Decoding threads budget")
+#define DEC_THREADS_LONGTEXT N_( \
+    "Total number of threads that all video decoders running at the same " \
+    "time may use together. Each decoder gets a share of it when it starts " \
+    "(0 for the number of CPUs)." )
+
+#define DEC_MEMORY_TEXT N_("Decoding buffers memory limit (MiB)")
+#define DEC_MEMORY_LONGTEXT N_( \
+    "Total amount of memory that the data waiting to be decoded may use. " \
+    "When it is exceeded, the decoders holding more than their share drop " \
+    "their waiting data (0 for no limit)." )
+
+#define DEC_MEMORY_PROCESS_TEXT \
+    N_("Decoding buffers memory limit for the process (MiB)")
+#define DEC_MEMORY_PROCESS_LONGTEXT N_( \
+    "Same as the decoding buffers memory limit, but shared with all the " \
+    "LibVLC instances of the process (0 for no limit)." )
+
 /*****************************************************************************
  * Sout
  ****************************************************************************/
@@ -1063,6 +1134,12 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define STREAM_FILTER_LONGTEXT N_( \
     "Stream filters are used to modify the stream that is being read." )
 
+#define DISK_CACHE_SIZE_TEXT N_("Disk cache size (MiB)")
+#define DISK_CACHE_SIZE_LONGTEXT N_( \
+    "Maximum size of the persistent cache of remote media. " \
+    "The least recently used media are evicted first. " \
+    "Zero disables the cache.")
+
 #define DEMUX_FILTER_TEXT N_("Demux filter module")
 #define DEMUX_FILTER_LONGTEXT N_( \
     "Demux filters are used to modify/control the stream that is being read." )
@@ -1114,6 +1191,15 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define ONEINSTANCEWHENSTARTEDFROMFILE_TEXT N_( \
     "Use only one instance when started from file manager")
 
+#define AFFINITY_LONGTEXT N_( \
+    "Restrict these threads to a comma-separated list of processors or " \
+    "processor ranges (e.g. \"0-3,8\"), and/or of NUMA nodes " \
+    "(e.g. \"node:1\"). Leave empty to let the operating system decide.")
+#define INPUT_AFFINITY_TEXT N_("Input threads processor affinity")
+#define DECODER_AFFINITY_TEXT N_("Decoder threads processor affinity")
+#define VOUT_AFFINITY_TEXT N_("Video output threads processor affinity")
+#define SOUT_AFFINITY_TEXT N_("Stream output threads processor affinity")
+
 #define HPRIORITY_TEXT N_("Increase the priority of the process")
 #define HPRIORITY_LONGTEXT N_( \
     "Increasing the priority of the process will very likely improve your " \
@@ -1174,6 +1260,16 @@ static const char *const clock_sources_text[] = {
 #define PREPARSE_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to preparse items" )
 
+#define PREPARSE_HOST_THREADS_TEXT N_( "Preparsing threads per host" )
+#define PREPARSE_HOST_THREADS_LONGTEXT N_( \
+    "Maximum number of items of the same remote host preparsed at the same " \
+    "time (0 for no limit)" )
+
+#define PREPARSE_CACHE_SIZE_TEXT N_( "Preparsing cache size" )
+#define PREPARSE_CACHE_SIZE_LONGTEXT N_( \
+    "Number of preparsed local files whose results are kept in memory, to " \
+    "be reused as long as the files are not modified (0 to disable)" )
+
 #define FETCH_ART_THREADS_TEXT N_( "Fetch-art threads" )
 #define FETCH_ART_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to fetch art" )
@@ -1588,6 +1684,8 @@ vlc_module_begin ()
 
     add_bool( "audio-time-stretch", true,
               AUDIO_TIME_STRETCH_TEXT, AUDIO_TIME_STRETCH_LONGTEXT )
+    add_bool( "audio-gapless", false,
+              AUDIO_GAPLESS_TEXT, AUDIO_GAPLESS_LONGTEXT )
 
     set_subcategory( SUBCAT_AUDIO_AOUT )
     add_module("aout", "audio output", "any", AOUT_TEXT, AOUT_LONGTEXT)
@@ -1624,6 +1722,8 @@ vlc_module_begin ()
         change_private ()
     add_bool( "drop-late-frames", true, DROP_LATE_FRAMES_TEXT,
               DROP_LATE_FRAMES_LONGTEXT )
+    add_bool( "video-filter-thread", false, VIDEO_FILTER_THREAD_TEXT,
+              VIDEO_FILTER_THREAD_LONGTEXT )
     /* Used in vout_synchro */
     add_bool( "skip-frames", true, SKIP_FRAMES_TEXT,
               SKIP_FRAMES_LONGTEXT )
@@ -1822,6 +1922,10 @@ vlc_module_begin ()
     add_bool( "low-delay", false, INPUT_LOWDELAY_TEXT,
               INPUT_LOWDELAY_LONGTEXT )
         change_safe ()
+    add_integer( "low-delay-caching", 100, INPUT_LOWDELAY_CACHING_TEXT,
+                 INPUT_LOWDELAY_CACHING_LONGTEXT )
+        change_integer_range( 0, 60000 )
+        change_safe ()
 
     set_section( N_( "Playback control" ) , NULL)
     add_integer( "input-repeat", 0,
@@ -1961,6 +2065,9 @@ vlc_module_begin ()
     add_string( "clock-master", "auto",
                  CLOCK_MASTER_TEXT, CLOCK_MASTER_LONGTEXT )
         change_string_list( ppsz_clock_master_values, ppsz_clock_master_descriptions )
+    add_string( "clock-recovery", "average",
+                 CLOCK_RECOVERY_TEXT, CLOCK_RECOVERY_LONGTEXT )
+        change_string_list( ppsz_clock_recovery_values, ppsz_clock_recovery_descriptions )
 
     add_directory("input-record-path", NULL,
                   INPUT_RECORD_PATH_TEXT, INPUT_RECORD_PATH_LONGTEXT)
@@ -1971,6 +2078,8 @@ vlc_module_begin ()
                   INPUT_TIMESHIFT_PATH_TEXT, INPUT_TIMESHIFT_PATH_LONGTEXT)
     add_integer( "input-timeshift-granularity", -1, INPUT_TIMESHIFT_GRANULARITY_TEXT,
                  INPUT_TIMESHIFT_GRANULARITY_LONGTEXT )
+    add_integer( "input-timeshift-history", 0, INPUT_TIMESHIFT_HISTORY_TEXT,
+                 INPUT_TIMESHIFT_HISTORY_LONGTEXT )
 
     add_string( "input-title-format", "$Z", INPUT_TITLE_FORMAT_TEXT, INPUT_TITLE_FORMAT_LONGTEXT );
 
@@ -1992,12 +2101,22 @@ vlc_module_begin ()
     add_bool( "hw-dec", true, HW_DEC_TEXT, HW_DEC_LONGTEXT )
     add_obsolete_string( "encoder" ) /* since 4.0.0 */
     add_module("dec-dev", "decoder device", "any", DEC_DEV_TEXT, DEC_DEV_LONGTEXT)
+    add_integer( "dec-threads", 0, DEC_THREADS_TEXT, DEC_THREADS_LONGTEXT )
+        change_integer_range( 0, 256 )
+    add_integer( "dec-memory-limit", 0, DEC_MEMORY_TEXT, DEC_MEMORY_LONGTEXT )
+        change_integer_range( 0, 1 << 20 )
+    add_integer( "dec-memory-process-limit", 0, DEC_MEMORY_PROCESS_TEXT,
+                 DEC_MEMORY_PROCESS_LONGTEXT )
+        change_integer_range( 0, 1 << 20 )
 
     //set_subcategory( SUBCAT_INPUT_SCODEC )
     set_subcategory( SUBCAT_INPUT_STREAM_FILTER )
 
     add_module_list("stream-filter", "stream_filter", NULL,
                     STREAM_FILTER_TEXT, STREAM_FILTER_LONGTEXT)
+    add_integer( "disk-cache-size", 0,
+                 DISK_CACHE_SIZE_TEXT, DISK_CACHE_SIZE_LONGTEXT )
+        change_integer_range( 0, 1 << 24 )
 
 /* Stream output options */
     set_subcategory( SUBCAT_SOUT_GENERAL )
@@ -2074,6 +2193,15 @@ vlc_module_begin ()
               HPRIORITY_LONGTEXT )
 #endif
 
+    add_string( "input-affinity", NULL, INPUT_AFFINITY_TEXT,
+                AFFINITY_LONGTEXT )
+    add_string( "decoder-affinity", NULL, DECODER_AFFINITY_TEXT,
+                AFFINITY_LONGTEXT )
+    add_string( "vout-affinity", NULL, VOUT_AFFINITY_TEXT,
+                AFFINITY_LONGTEXT )
+    add_string( "sout-affinity", NULL, SOUT_AFFINITY_TEXT,
+                AFFINITY_LONGTEXT )
+
 #ifdef _WIN32
     add_string( "clock-source", NULL, CLOCK_SOURCE_TEXT, NULL )
         change_string_list( clock_sources, clock_sources_text )
@@ -2128,6 +2256,14 @@ vlc_module_begin ()
     add_integer( "preparse-threads", 1, PREPARSE_THREADS_TEXT,
                  PREPARSE_THREADS_LONGTEXT )
 
+    add_integer( "preparse-host-threads", 2, PREPARSE_HOST_THREADS_TEXT,
+                 PREPARSE_HOST_THREADS_LONGTEXT )
+        change_integer_range( 0, INT_MAX )
+
+    add_integer( "preparse-cache-size", 4096, PREPARSE_CACHE_SIZE_TEXT,
+                 PREPARSE_CACHE_SIZE_LONGTEXT )
+        change_integer_range( 0, INT_MAX )
+
     add_integer( "fetch-art-threads", 1, FETCH_ART_THREADS_TEXT,
                  FETCH_ART_THREADS_LONGTEXT )
 
@@ -2179,6 +2315,9 @@ vlc_module_begin ()
     add_integer( "verbose", 0, VERBOSE_TEXT, VERBOSE_LONGTEXT )
         change_short('v')
         change_volatile ()
+    add_bool( "log-async", false, LOG_ASYNC_TEXT, LOG_ASYNC_LONGTEXT )
+    add_integer_with_range( "log-rate-limit", 0, 0, 100000,
+                            LOG_RATE_TEXT, LOG_RATE_LONGTEXT )
 #if !defined(_WIN32) && !defined(__OS2__)
     add_obsolete_bool( "daemon" ) /* since 4.0.0 */
         change_short('d')
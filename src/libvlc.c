@@ -63,6 +63,7 @@
 #include <vlc_modules.h>
 #include <vlc_media_library.h>
 #include <vlc_thumbnailer.h>
+#include <vlc_tracer.h>
 
 #include "libvlc.h"
 
@@ -75,6 +76,40 @@
  *****************************************************************************/
 static void GetFilenames  ( libvlc_int_t *, unsigned, const char *const [] );
 
+/* Startup stages, traced once the tracer is ready */
+enum
+{
+    STARTUP_PLUGINS,
+    STARTUP_CONFIG,
+    STARTUP_CORE,
+    STARTUP_INTERFACES,
+    STARTUP_COUNT
+};
+
+static const char startup_stage_names[STARTUP_COUNT][11] =
+{
+    "plugins", "config", "core", "interfaces",
+};
+
+static void TraceStartup( libvlc_int_t *p_libvlc,
+                          const vlc_tick_t dates[STARTUP_COUNT + 1] )
+{
+    struct vlc_tracer *tracer = vlc_object_get_tracer( VLC_OBJECT(p_libvlc) );
+
+    for( unsigned i = 0; i < STARTUP_COUNT; i++ )
+    {
+        vlc_tick_t duration = dates[i + 1] - dates[i];
+
+        if( tracer != NULL )
+            vlc_tracer_Trace( tracer, VLC_TRACE("type", "STARTUP"),
+                              VLC_TRACE("id", startup_stage_names[i]),
+                              VLC_TRACE("duration", NS_FROM_VLC_TICK(duration)),
+                              VLC_TRACE_END );
+        msg_Dbg( p_libvlc, "startup: %s took %"PRId64" us",
+                 startup_stage_names[i], US_FROM_VLC_TICK(duration) );
+    }
+}
+
 /**
  * Allocate a blank libvlc instance, also setting the exit handler.
  * Vlc's threading system must have been initialized first
@@ -95,6 +130,11 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv->main_playlist = NULL;
     priv->p_vlm = NULL;
     priv->media_source_provider = NULL;
+    priv->parser = NULL;
+    priv->p_thumbnailer = NULL;
+    priv->tls_cache = vlc_tls_CacheCreate();
+    atomic_init(&priv->decoder_fifos.bytes, 0);
+    atomic_init(&priv->decoder_fifos.count, 0);
 
     vlc_ExitInit( &priv->exit );
 
@@ -132,6 +172,9 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     libvlc_priv_t *priv = libvlc_priv (p_libvlc);
     char        *psz_val;
     int          i_ret = VLC_EGENERIC;
+    vlc_tick_t   startup[STARTUP_COUNT + 1];
+
+    startup[STARTUP_PLUGINS] = vlc_tick_now();
 
     if (unlikely(vlc_LogPreinit(p_libvlc)))
         return VLC_ENOMEM;
@@ -160,6 +203,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
      * saved settings handling can function properly.
      */
     module_LoadPlugins (p_libvlc);
+    startup[STARTUP_CONFIG] = vlc_tick_now();
 
     /*
      * Fully process command line settings.
@@ -182,6 +226,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
 
     vlc_LogInit(p_libvlc);
     vlc_tracer_Init(p_libvlc);
+    startup[STARTUP_CORE] = vlc_tick_now();
 
     /*
      * Support for gettext
@@ -218,23 +263,12 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
             msg_Warn( p_libvlc, "Media library initialization failed" );
     }
 
-    priv->p_thumbnailer = vlc_thumbnailer_Create( VLC_OBJECT( p_libvlc ) );
-    if ( priv->p_thumbnailer == NULL )
-        msg_Warn( p_libvlc, "Failed to instantiate thumbnailer" );
-
     /*
      * Initialize hotkey handling
      */
     if( libvlc_InternalActionsInit( p_libvlc ) != VLC_SUCCESS )
         goto error;
 
-    /*
-     * Meta data handling
-     */
-    priv->parser = input_preparser_New(VLC_OBJECT(p_libvlc));
-    if( !priv->parser )
-        goto error;
-
     priv->media_source_provider = vlc_media_source_provider_New( VLC_OBJECT( p_libvlc ) );
     if( !priv->media_source_provider )
         goto error;
@@ -282,6 +316,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     /*
      * Load background interfaces
      */
+    startup[STARTUP_INTERFACES] = vlc_tick_now();
     libvlc_AddInterfaces(p_libvlc, "extraintf");
     libvlc_AddInterfaces(p_libvlc, "control");
 
@@ -328,6 +363,8 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     /* Create a variable for showing the main interface */
     var_Create(p_libvlc, "intf-show", VLC_VAR_VOID);
 
+    startup[STARTUP_COUNT] = vlc_tick_now();
+    TraceStartup( p_libvlc, startup );
     return VLC_SUCCESS;
 
 error:
@@ -412,6 +449,7 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
  */
 void libvlc_InternalDestroy( libvlc_int_t *p_libvlc )
 {
+    vlc_tls_CacheDestroy(libvlc_priv(p_libvlc)->tls_cache);
     vlc_object_delete(p_libvlc);
 }
 
@@ -454,18 +492,35 @@ static void GetFilenames( libvlc_int_t *p_vlc, unsigned n,
     }
 }
 
+/**
+ * Gets the meta data handler, created on first use since many applications
+ * never need it.
+ */
+static input_preparser_t *GetPreparser(libvlc_int_t *libvlc)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    input_preparser_t *parser;
+
+    vlc_mutex_lock(&priv->lock);
+    if (priv->parser == NULL)
+        priv->parser = input_preparser_New(VLC_OBJECT(libvlc));
+    parser = priv->parser;
+    vlc_mutex_unlock(&priv->lock);
+    return parser;
+}
+
 int vlc_MetadataRequest(libvlc_int_t *libvlc, input_item_t *item,
                         input_item_meta_request_option_t i_options,
                         const input_preparser_callbacks_t *cbs,
                         void *cbs_userdata,
                         int timeout, void *id)
 {
-    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    input_preparser_t *parser = GetPreparser(libvlc);
 
-    if (unlikely(priv->parser == NULL))
+    if (unlikely(parser == NULL))
         return VLC_ENOMEM;
 
-    return input_preparser_Push( priv->parser, item, i_options, cbs,
+    return input_preparser_Push( parser, item, i_options, cbs,
                                  cbs_userdata, timeout, id );
 }
 
@@ -480,12 +535,8 @@ int libvlc_MetadataRequest(libvlc_int_t *libvlc, input_item_t *item,
                            void *cbs_userdata,
                            int timeout, void *id)
 {
-    libvlc_priv_t *priv = libvlc_priv(libvlc);
     assert(i_options & META_REQUEST_OPTION_SCOPE_ANY);
 
-    if (unlikely(priv->parser == NULL))
-        return VLC_ENOMEM;
-
     vlc_mutex_lock( &item->lock );
     if( item->i_preparse_depth == 0 )
         item->i_preparse_depth = 1;
@@ -503,13 +554,13 @@ int libvlc_ArtRequest(libvlc_int_t *libvlc, input_item_t *item,
                       const input_fetcher_callbacks_t *cbs,
                       void *cbs_userdata)
 {
-    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    input_preparser_t *parser = GetPreparser(libvlc);
     assert(i_options & META_REQUEST_OPTION_FETCH_ANY);
 
-    if (unlikely(priv->parser == NULL))
+    if (unlikely(parser == NULL))
         return VLC_ENOMEM;
 
-    input_preparser_fetcher_Push(priv->parser, item, i_options,
+    input_preparser_fetcher_Push(parser, item, i_options,
                                  cbs, cbs_userdata);
     return VLC_SUCCESS;
 }
@@ -523,9 +574,14 @@ int libvlc_ArtRequest(libvlc_int_t *libvlc, input_item_t *item,
 void libvlc_MetadataCancel(libvlc_int_t *libvlc, void *id)
 {
     libvlc_priv_t *priv = libvlc_priv(libvlc);
+    input_preparser_t *parser;
 
-    if (unlikely(priv->parser == NULL))
-        return;
+    vlc_mutex_lock(&priv->lock);
+    parser = priv->parser;
+    vlc_mutex_unlock(&priv->lock);
+
+    if (parser == NULL)
+        return; /* nothing was ever requested */
 
-    input_preparser_Cancel(priv->parser, id);
+    input_preparser_Cancel(parser, id);
 }
@@ -40,6 +40,53 @@ void system_End(void);
 #endif
 void vlc_CPU_dump(vlc_object_t *);
 
+/*
+ * Processor sets
+ */
+#define VLC_CPU_MAX 1024
+
+typedef struct
+{
+    unsigned long bits[VLC_CPU_MAX / (8 * sizeof (unsigned long))];
+} vlc_cpu_mask_t;
+
+static inline void vlc_cpu_mask_Set(vlc_cpu_mask_t *mask, unsigned cpu)
+{
+    const unsigned width = 8 * sizeof (mask->bits[0]);
+
+    mask->bits[cpu / width] |= 1UL << (cpu % width);
+}
+
+static inline bool vlc_cpu_mask_Test(const vlc_cpu_mask_t *mask, unsigned cpu)
+{
+    const unsigned width = 8 * sizeof (mask->bits[0]);
+
+    return cpu < VLC_CPU_MAX
+        && (mask->bits[cpu / width] >> (cpu % width)) & 1;
+}
+
+/**
+ * Parses a list of processor indices and ranges, e.g. "0-3,8".
+ *
+ * The list is added to the mask.
+ * \return 0 on success, -1 on syntax error
+ */
+int vlc_CPU_ParseList(const char *list, vlc_cpu_mask_t *mask);
+
+/**
+ * Gets the set of processors of a NUMA node.
+ *
+ * The processors are added to the mask.
+ * \return 0 on success, -1 if the node does not exist
+ */
+int vlc_CPU_GetNodeCPUs(unsigned node, vlc_cpu_mask_t *mask);
+
+/**
+ * Sets the processor affinity of the calling thread.
+ * \return 0 on success, an error number on failure
+ */
+int vlc_CPU_SetAffinity(const vlc_cpu_mask_t *mask);
+
 /*
  * Threads subsystem
  */
@@ -67,6 +114,28 @@ typedef struct vlc_tracer vlc_tracer_t;
 void vlc_tracer_Init(libvlc_int_t *);
 void vlc_tracer_Destroy(libvlc_int_t *);
 
+/*
+ * Name resolution
+ */
+struct addrinfo;
+
+/**
+ * Resolves a host name, like getaddrinfo(), but can be interrupted.
+ *
+ * This is the uncached back-end of vlc_getaddrinfo_i11e(). The result must
+ * be freed with freeaddrinfo().
+ */
+int vlc_resolve_i11e(const char *name, unsigned port,
+                     const struct addrinfo *hints, struct addrinfo **res);
+
+/*
+ * TLS session resumption data cache
+ */
+struct vlc_tls_cache;
+
+struct vlc_tls_cache *vlc_tls_CacheCreate(void);
+void vlc_tls_CacheDestroy(struct vlc_tls_cache *);
+
 /*
  * LibVLC exit event handling
  */
@@ -177,23 +246,32 @@ typedef struct vlc_playlist vlc_playlist_t;
 typedef struct vlc_media_source_provider_t vlc_media_source_provider_t;
 typedef struct intf_thread_t intf_thread_t;
 
+/** Memory queued in a set of buffers */
+struct vlc_buffer_usage
+{
+    atomic_size_t bytes;
+    atomic_uint   count; ///< number of buffers
+};
+
 typedef struct libvlc_priv_t
 {
     libvlc_int_t       public_data;
 
     /* Singleton objects */
-    vlc_mutex_t lock; ///< protect playlist and interfaces
+    vlc_mutex_t lock; ///< protect playlist, interfaces and lazy singletons
     vlm_t             *p_vlm;  ///< the VLM singleton (or NULL)
     vlc_dialog_provider *p_dialog_provider; ///< dialog provider
     vlc_keystore      *p_memory_keystore; ///< memory keystore
     intf_thread_t *interfaces;  ///< Linked-list of interfaces
     vlc_playlist_t *main_playlist;
-    struct input_preparser_t *parser; ///< Input item meta data handler
+    struct input_preparser_t *parser; ///< Lazily instantiated meta data handler
     vlc_media_source_provider_t *media_source_provider;
     vlc_actions_t *actions; ///< Hotkeys handler
     struct vlc_medialibrary_t *p_media_library; ///< Media library instance
     struct vlc_thumbnailer_t *p_thumbnailer; ///< Lazily instantiated media thumbnailer
     struct vlc_tracer *tracer; ///< Tracer callbacks
+    struct vlc_tls_cache *tls_cache; ///< TLS session resumption data
+    struct vlc_buffer_usage decoder_fifos; ///< Memory queued for the decoders
 
     /* Exit callback */
     vlc_exit_t       exit;
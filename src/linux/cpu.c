@@ -22,7 +22,10 @@
 # include "config.h"
 #endif
 
+#include <errno.h>
+#include <sched.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #ifdef HAVE_SYS_AUXV_H
 # include <sys/auxv.h>
@@ -32,6 +35,7 @@
 #endif
 #include <vlc_common.h>
 #include <vlc_cpu.h>
+#include "libvlc.h"
 
 #if defined (__aarch64__)
 unsigned vlc_CPU_raw(void)
@@ -111,6 +115,7 @@ unsigned vlc_CPU_raw(void)
     {
         char *p, *cap;
         uint_fast32_t core_caps = 0;
+        bool avx512f = false, avx512bw = false;
 
         if (strncmp(line, "flags", 5))
             continue;
@@ -134,8 +139,15 @@ unsigned vlc_CPU_raw(void)
                 core_caps |= VLC_CPU_AVX;
             if (!strcmp (cap, "avx2"))
                 core_caps |= VLC_CPU_AVX2;
+            if (!strcmp (cap, "avx512f"))
+                avx512f = true;
+            if (!strcmp (cap, "avx512bw"))
+                avx512bw = true;
         }
 
+        if (avx512f && avx512bw)
+            core_caps |= VLC_CPU_AVX512;
+
         /* Take the intersection of capabilities of each processor */
         all_caps &= core_caps;
     }
@@ -148,3 +160,110 @@ unsigned vlc_CPU_raw(void)
     return all_caps;
 }
 #endif
+
+static int ReadCPUList(const char *path, vlc_cpu_mask_t *mask)
+{
+    FILE *stream = fopen(path, "rte");
+    if (stream == NULL)
+        return -1;
+
+    char *line = NULL;
+    size_t linelen = 0;
+    int ret = -1;
+
+    if (getline(&line, &linelen, stream) != -1)
+        ret = vlc_CPU_ParseList(line, mask);
+    fclose(stream);
+    free(line);
+    return ret;
+}
+
+static unsigned CountCPUs(const vlc_cpu_mask_t *mask)
+{
+    unsigned count = 0;
+
+    for (unsigned cpu = 0; cpu < VLC_CPU_MAX; cpu++)
+        count += vlc_cpu_mask_Test(mask, cpu);
+    return count;
+}
+
+void vlc_CPU_GetTopology(struct vlc_cpu_topology *topo)
+{
+    vlc_cpu_mask_t online;
+
+    memset(&online, 0, sizeof (online));
+    if (ReadCPUList("/sys/devices/system/cpu/online", &online))
+    {
+        topo->cpus = vlc_GetCPUCount();
+        topo->cores = topo->cpus;
+        topo->nodes = 1;
+        return;
+    }
+
+    topo->cpus = CountCPUs(&online);
+    topo->cores = 0;
+
+    /* Count each core once, through its first SMT sibling */
+    for (unsigned cpu = 0; cpu < VLC_CPU_MAX; cpu++)
+    {
+        if (!vlc_cpu_mask_Test(&online, cpu))
+            continue;
+
+        char path[64];
+        vlc_cpu_mask_t siblings;
+        unsigned first = cpu;
+
+        snprintf(path, sizeof (path),
+                 "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list",
+                 cpu);
+        memset(&siblings, 0, sizeof (siblings));
+        if (ReadCPUList(path, &siblings) == 0)
+        {
+            first = 0;
+            while (first < cpu && !vlc_cpu_mask_Test(&siblings, first))
+                first++;
+        }
+        topo->cores += (first == cpu);
+    }
+
+    vlc_cpu_mask_t nodes;
+
+    memset(&nodes, 0, sizeof (nodes));
+    if (ReadCPUList("/sys/devices/system/node/online", &nodes) == 0)
+        topo->nodes = CountCPUs(&nodes);
+    else
+        topo->nodes = 1;
+}
+
+int vlc_CPU_GetNodeCPUs(unsigned node, vlc_cpu_mask_t *mask)
+{
+    char path[48];
+
+    snprintf(path, sizeof (path), "/sys/devices/system/node/node%u/cpulist",
+             node);
+    if (ReadCPUList(path, mask) == 0)
+        return 0;
+
+    /* Kernels without NUMA support have no node directory */
+    if (node > 0 || ReadCPUList("/sys/devices/system/cpu/online", mask))
+        return -1;
+    return 0;
+}
+
+int vlc_CPU_SetAffinity(const vlc_cpu_mask_t *mask)
+{
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    for (unsigned cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        if (vlc_cpu_mask_Test(mask, cpu))
+            CPU_SET(cpu, &set);
+
+    if (CPU_COUNT(&set) == 0)
+        return EINVAL;
+
+    /* On Linux, this only affects the calling thread */
+    if (sched_setaffinity(0, sizeof (set), &set))
+        return errno;
+    return 0;
+}
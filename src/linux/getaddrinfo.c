@@ -30,15 +30,15 @@
 #include <vlc_common.h>
 #include <vlc_interrupt.h>
 #include <vlc_network.h>
+#include "libvlc.h"
 
 static void vlc_getaddrinfo_notify(union sigval val)
 {
     vlc_sem_post(val.sival_ptr);
 }
 
-int vlc_getaddrinfo_i11e(const char *name, unsigned port,
-                         const struct addrinfo *hints,
-                         struct addrinfo **res)
+int vlc_resolve_i11e(const char *name, unsigned port,
+                     const struct addrinfo *hints, struct addrinfo **res)
 {
     struct gaicb req =
     {
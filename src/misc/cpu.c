@@ -38,14 +38,15 @@
 #include "libvlc.h"
 
 #include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
 
 #include <sys/types.h>
 #ifndef _WIN32
 #include <unistd.h>
 #include <sys/wait.h>
 #include <signal.h>
-#else
-#include <errno.h>
 #endif
 
 #ifdef __APPLE__
@@ -114,6 +115,11 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
          : "=a" (i_eax), "=b" (i_ebx), "=c" (i_ecx), "=d" (i_edx) \
          : "a" (reg) \
          : "cc");
+# define cpuid_count(reg, sub) \
+    asm ("cpuid" \
+         : "=a" (i_eax), "=b" (i_ebx), "=c" (i_ecx), "=d" (i_edx) \
+         : "a" (reg), "c" (sub) \
+         : "cc");
 
      /* Check if the OS really supports the requested instructions */
 # if defined (__i386__) && !defined (__i586__) \
@@ -161,6 +167,33 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
             i_capabilities |= VLC_CPU_SSE4_1;
     }
 
+    /* AVX requires the OS to save the YMM state (XCR0 bits 1 and 2), and
+     * AVX-512 also the opmask and ZMM states (XCR0 bits 5 to 7). */
+    if ((i_ecx & 0x18000000) == 0x18000000) /* OSXSAVE and AVX */
+    {
+        unsigned int xcr0, xcr0_hi;
+
+        asm ("xgetbv" : "=a" (xcr0), "=d" (xcr0_hi) : "c" (0));
+
+        if ((xcr0 & 0x06) == 0x06)
+        {
+            i_capabilities |= VLC_CPU_AVX;
+
+            cpuid( 0x00000000 );
+            if( i_eax >= 7 )
+            {
+                cpuid_count( 0x00000007, 0 );
+
+                if (i_ebx & 0x00000020)
+                    i_capabilities |= VLC_CPU_AVX2;
+                /* AVX-512 F and BW */
+                if ((i_ebx & 0x40010000) == 0x40010000
+                 && (xcr0 & 0xE6) == 0xE6)
+                    i_capabilities |= VLC_CPU_AVX512;
+            }
+        }
+    }
+
     /* test for additional capabilities */
     cpuid( 0x80000000 );
 
@@ -221,6 +254,8 @@ void vlc_CPU_dump (vlc_object_t *obj)
         vlc_memstream_puts(&stream, "AVX ");
     if (vlc_CPU_AVX2())
         vlc_memstream_puts(&stream, "AVX2 ");
+    if (vlc_CPU_AVX512())
+        vlc_memstream_puts(&stream, "AVX512 ");
 
 #elif defined (__powerpc__) || defined (__ppc__) || defined (__ppc64__)
     if (vlc_CPU_ALTIVEC())
@@ -245,6 +280,150 @@ void vlc_CPU_dump (vlc_object_t *obj)
         msg_Dbg (obj, "CPU has capabilities %s", stream.ptr);
         free(stream.ptr);
     }
+
+    struct vlc_cpu_topology topo;
+
+    vlc_CPU_GetTopology(&topo);
+    msg_Dbg(obj, "CPU topology: %u processor(s), %u core(s), %u node(s)",
+            topo.cpus, topo.cores, topo.nodes);
+}
+
+VLC_WEAK void vlc_CPU_GetTopology(struct vlc_cpu_topology *topo)
+{
+    topo->cpus = vlc_GetCPUCount();
+    topo->cores = topo->cpus;
+    topo->nodes = 1;
+}
+
+VLC_WEAK int vlc_CPU_GetNodeCPUs(unsigned node, vlc_cpu_mask_t *mask)
+{
+    if (node > 0)
+        return -1;
+
+    for (unsigned cpu = 0, count = vlc_GetCPUCount();
+         cpu < count && cpu < VLC_CPU_MAX; cpu++)
+        vlc_cpu_mask_Set(mask, cpu);
+    return 0;
+}
+
+int vlc_CPU_GetNode(unsigned cpu)
+{
+    struct vlc_cpu_topology topo;
+
+    vlc_CPU_GetTopology(&topo);
+    for (unsigned node = 0; node < topo.nodes; node++)
+    {
+        vlc_cpu_mask_t mask;
+
+        memset(&mask, 0, sizeof (mask));
+        if (vlc_CPU_GetNodeCPUs(node, &mask) == 0
+         && vlc_cpu_mask_Test(&mask, cpu))
+            return node;
+    }
+    return -1;
+}
+
+VLC_WEAK int vlc_CPU_SetAffinity(const vlc_cpu_mask_t *mask)
+{
+    (void) mask;
+    return ENOTSUP;
+}
+
+int vlc_CPU_ParseList(const char *list, vlc_cpu_mask_t *mask)
+{
+    const char *p = list;
+
+    while (*p != '\0' && *p != '\n')
+    {
+        char *end;
+        unsigned long first = strtoul(p, &end, 10), last = first;
+
+        if (end == p)
+            return -1;
+        if (*end == '-')
+        {
+            p = end + 1;
+            last = strtoul(p, &end, 10);
+            if (end == p || last < first)
+                return -1;
+        }
+        if (last >= VLC_CPU_MAX)
+            return -1;
+
+        for (unsigned long cpu = first; cpu <= last; cpu++)
+            vlc_cpu_mask_Set(mask, cpu);
+
+        p = end;
+        if (*p == ',')
+            p++;
+        else if (*p != '\0' && *p != '\n')
+            return -1;
+    }
+    return 0;
+}
+
+static int vlc_CPU_ParsePolicy(const char *policy, vlc_cpu_mask_t *mask)
+{
+    char *dup = strdup(policy);
+    if (unlikely(dup == NULL))
+        return -1;
+
+    int ret = 0;
+
+    for (char *saveptr, *tok = strtok_r(dup, ",", &saveptr);
+         tok != NULL && ret == 0;
+         tok = strtok_r(NULL, ",", &saveptr))
+    {
+        if (strncmp(tok, "node:", 5) == 0)
+        {
+            char *end;
+            unsigned long node = strtoul(tok + 5, &end, 10);
+
+            if (end == tok + 5 || *end != '\0' || node > UINT_MAX
+             || vlc_CPU_GetNodeCPUs(node, mask))
+                ret = -1;
+        }
+        else
+            ret = vlc_CPU_ParseList(tok, mask);
+    }
+
+    free(dup);
+    return ret;
+}
+
+int vlc_CPU_PinThread(vlc_object_t *obj, const char *thread_class)
+{
+    char name[32];
+
+    snprintf(name, sizeof (name), "%s-affinity", thread_class);
+
+    char *policy = var_InheritString(obj, name);
+    if (policy == NULL)
+        return 0;
+
+    vlc_cpu_mask_t mask;
+    int ret;
+
+    memset(&mask, 0, sizeof (mask));
+    if (vlc_CPU_ParsePolicy(policy, &mask))
+    {
+        msg_Err(obj, "invalid %s thread affinity \"%s\"", thread_class,
+                policy);
+        ret = -1;
+    }
+    else
+    {
+        int val = vlc_CPU_SetAffinity(&mask);
+
+        if (val == 0)
+            msg_Dbg(obj, "%s thread pinned to \"%s\"", thread_class, policy);
+        else
+            msg_Warn(obj, "cannot set %s thread affinity: %s", thread_class,
+                     vlc_strerror_c(val));
+        ret = (val == 0) ? 0 : -1;
+    }
+    free(policy);
+    return ret;
 }
 
 void vlc_CPU_functions_init(const char *capability, void *restrict funcs)
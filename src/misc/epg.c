@@ -29,8 +29,30 @@
 #endif
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_epg.h>
 
+/* Events are shared by the duplicated tables, instead of being copied for
+ * every table update going from the demuxer to the input item */
+struct vlc_epg_event_priv
+{
+    vlc_epg_event_t event;
+    vlc_atomic_rc_t rc;
+};
+
+static struct vlc_epg_event_priv *vlc_epg_event_priv(const vlc_epg_event_t *p_event)
+{
+    return container_of(p_event, struct vlc_epg_event_priv, event);
+}
+
+static vlc_epg_event_t *vlc_epg_event_Hold(const vlc_epg_event_t *p_event)
+{
+    struct vlc_epg_event_priv *priv = vlc_epg_event_priv(p_event);
+
+    vlc_atomic_rc_inc(&priv->rc);
+    return &priv->event;
+}
+
 static void vlc_epg_event_Clean(vlc_epg_event_t *p_event)
 {
     for(int i=0; i<p_event->i_description_items; i++)
@@ -46,8 +68,12 @@ static void vlc_epg_event_Clean(vlc_epg_event_t *p_event)
 
 void vlc_epg_event_Delete(vlc_epg_event_t *p_event)
 {
+    struct vlc_epg_event_priv *priv = vlc_epg_event_priv(p_event);
+
+    if(!vlc_atomic_rc_dec(&priv->rc))
+        return;
     vlc_epg_event_Clean(p_event);
-    free(p_event);
+    free(priv);
 }
 
 static void vlc_epg_event_Init(vlc_epg_event_t *p_event, uint16_t i_id,
@@ -64,11 +90,13 @@ static void vlc_epg_event_Init(vlc_epg_event_t *p_event, uint16_t i_id,
 vlc_epg_event_t * vlc_epg_event_New(uint16_t i_id,
                                     int64_t i_start, uint32_t i_duration)
 {
-    vlc_epg_event_t *p_event = (vlc_epg_event_t *) malloc(sizeof(*p_event));
-    if(p_event)
-        vlc_epg_event_Init(p_event, i_id, i_start, i_duration);
+    struct vlc_epg_event_priv *priv = malloc(sizeof(*priv));
+    if(!priv)
+        return NULL;
 
-    return p_event;
+    vlc_epg_event_Init(&priv->event, i_id, i_start, i_duration);
+    vlc_atomic_rc_init(&priv->rc);
+    return &priv->event;
 }
 
 vlc_epg_event_t * vlc_epg_event_Duplicate( const vlc_epg_event_t *p_src )
@@ -225,16 +253,13 @@ vlc_epg_t * vlc_epg_Duplicate( const vlc_epg_t *p_src )
     {
         p_epg->psz_name = ( p_src->psz_name ) ? strdup( p_src->psz_name ) : NULL;
         p_epg->b_present = p_src->b_present;
+        p_epg->pp_event = vlc_alloc( p_src->i_event, sizeof(*p_epg->pp_event) );
+        if( p_src->i_event > 0 && unlikely(p_epg->pp_event == NULL) )
+            return p_epg;
         for( size_t i=0; i<p_src->i_event; i++ )
-        {
-            vlc_epg_event_t *p_dup = vlc_epg_event_Duplicate( p_src->pp_event[i] );
-            if( p_dup )
-            {
-                if( p_src->p_current == p_src->pp_event[i] )
-                    p_epg->p_current = p_dup;
-                TAB_APPEND( p_epg->i_event, p_epg->pp_event, p_dup );
-            }
-        }
+            p_epg->pp_event[i] = vlc_epg_event_Hold( p_src->pp_event[i] );
+        p_epg->i_event = p_src->i_event;
+        p_epg->p_current = p_src->p_current;
     }
     return p_epg;
 }
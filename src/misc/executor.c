@@ -48,6 +48,9 @@ struct vlc_executor_thread {
     struct vlc_runnable *current_task;
 };
 
+#define EXECUTOR_PRIORITIES \
+    (VLC_RUNNABLE_PRIORITY_HIGH - VLC_RUNNABLE_PRIORITY_LOW + 1)
+
 /**
  * The executor (also vlc_executor_t, exposed as opaque type in the public
  * header).
@@ -70,8 +73,8 @@ struct vlc_executor {
     /** Wait for the executor to be idle (i.e. unfinished == 0) */
     vlc_cond_t idle_wait;
 
-    /** Queue of vlc_runnable */
-    struct vlc_list queue;
+    /** Queues of vlc_runnable, by decreasing priority */
+    struct vlc_list queues[EXECUTOR_PRIORITIES];
 
     /** Wait for the queue to be non-empty */
     vlc_cond_t queue_wait;
@@ -85,25 +88,46 @@ QueuePush(vlc_executor_t *executor, struct vlc_runnable *runnable)
 {
     vlc_mutex_assert(&executor->lock);
 
-    vlc_list_append(&runnable->node, &executor->queue);
+    int priority = runnable->priority;
+    if (priority > VLC_RUNNABLE_PRIORITY_HIGH)
+        priority = VLC_RUNNABLE_PRIORITY_HIGH;
+    else if (priority < VLC_RUNNABLE_PRIORITY_LOW)
+        priority = VLC_RUNNABLE_PRIORITY_LOW;
+
+    struct vlc_list *queue =
+        &executor->queues[VLC_RUNNABLE_PRIORITY_HIGH - priority];
+
+    vlc_list_append(&runnable->node, queue);
     vlc_cond_signal(&executor->queue_wait);
 }
 
+static bool
+QueueIsEmpty(vlc_executor_t *executor)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(executor->queues); ++i)
+        if (!vlc_list_is_empty(&executor->queues[i]))
+            return false;
+    return true;
+}
+
 static struct vlc_runnable *
 QueueTake(vlc_executor_t *executor)
 {
     vlc_mutex_assert(&executor->lock);
 
-    while (!executor->closing && vlc_list_is_empty(&executor->queue))
+    while (!executor->closing && QueueIsEmpty(executor))
         vlc_cond_wait(&executor->queue_wait, &executor->lock);
 
     if (executor->closing)
         return NULL;
 
-    struct vlc_runnable *runnable =
-        vlc_list_first_entry_or_null(&executor->queue, struct vlc_runnable,
-                                     node);
-    assert(runnable);
+    struct vlc_runnable *runnable = NULL;
+    for (size_t i = 0; runnable == NULL; ++i)
+    {
+        assert(i < ARRAY_SIZE(executor->queues));
+        runnable = vlc_list_first_entry_or_null(&executor->queues[i],
+                                                struct vlc_runnable, node);
+    }
     vlc_list_remove(&runnable->node);
 
     /* Set links to NULL to know that it has been taken by a thread in
@@ -184,7 +208,8 @@ vlc_executor_New(unsigned max_threads)
     executor->unfinished = 0;
 
     vlc_list_init(&executor->threads);
-    vlc_list_init(&executor->queue);
+    for (size_t i = 0; i < ARRAY_SIZE(executor->queues); ++i)
+        vlc_list_init(&executor->queues[i]);
 
     vlc_cond_init(&executor->idle_wait);
     vlc_cond_init(&executor->queue_wait);
@@ -260,7 +285,7 @@ vlc_executor_Delete(vlc_executor_t *executor)
     executor->closing = true;
 
     /* All the tasks must be canceled on delete */
-    assert(vlc_list_is_empty(&executor->queue));
+    assert(QueueIsEmpty(executor));
 
     vlc_mutex_unlock(&executor->lock);
 
@@ -279,7 +304,7 @@ vlc_executor_Delete(vlc_executor_t *executor)
     }
 
     /* The queue must still be empty (no runnable submitted a new runnable) */
-    assert(vlc_list_is_empty(&executor->queue));
+    assert(QueueIsEmpty(executor));
 
     /* There are no tasks anymore */
     assert(!executor->unfinished);
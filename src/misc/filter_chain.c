@@ -27,6 +27,7 @@
 
 #include <vlc_filter.h>
 #include <vlc_modules.h>
+#include <vlc_picture_pool.h>
 #include <vlc_mouse.h>
 #include <vlc_spu.h>
 #include <libvlc.h>
@@ -40,8 +41,16 @@ typedef struct chained_filter_t
     struct chained_filter_t *prev, *next;
     vlc_mouse_t mouse;
     vlc_picture_chain_t pending;
+    picture_pool_t *pool; /**< Intermediate output pictures (or NULL) */
+    video_format_t pool_fmt; /**< Format of the pool pictures */
 } chained_filter_t;
 
+/* Number of recycled intermediate pictures per filter. Filters holding more
+ * pictures (e.g. deinterlacers) get extra ones allocated on the fly. */
+#define CHAIN_POOL_SIZE 3
+/* Number of pools kept across chain resets */
+#define CHAIN_POOL_CACHE_SIZE 4
+
 /* */
 struct filter_chain_t
 {
@@ -56,6 +65,7 @@ struct filter_chain_t
     bool b_allow_fmt_out_change; /**< Each filter can change the output */
     const char *filter_cap; /**< Filter modules capability */
     const char *conv_cap; /**< Converter modules capability */
+    picture_pool_cache_t *pool_cache; /**< Recycled intermediate pools */
 };
 
 /**
@@ -83,6 +93,7 @@ static filter_chain_t *filter_chain_NewInner( vlc_object_t *obj,
     chain->b_allow_fmt_out_change = fmt_out_change;
     chain->filter_cap = cap;
     chain->conv_cap = conv_cap;
+    chain->pool_cache = NULL;
     return chain;
 }
 
@@ -95,6 +106,61 @@ filter_chain_t *filter_chain_NewSPU( vlc_object_t *obj, const char *cap )
     return filter_chain_NewInner( obj, cap, NULL, false, SPU_ES );
 }
 
+static bool FormatMatchesPool( const video_format_t *a,
+                               const video_format_t *b )
+{
+    return video_format_IsSimilar( a, b )
+        && a->primaries == b->primaries
+        && a->transfer == b->transfer
+        && a->space == b->space
+        && a->color_range == b->color_range
+        && a->chroma_location == b->chroma_location;
+}
+
+static void FilterPutPool( filter_chain_t *chain, chained_filter_t *chained )
+{
+    if( chained->pool == NULL )
+        return;
+
+    if( chain->pool_cache != NULL )
+        picture_pool_cache_Put( chain->pool_cache, chained->pool );
+    else
+        picture_pool_Release( chained->pool );
+    chained->pool = NULL;
+    video_format_Clean( &chained->pool_fmt );
+}
+
+/**
+ * Gets an intermediate picture from the filter pool.
+ *
+ * Pictures passed between the filters of the chain are recycled rather than
+ * allocated and freed for every frame. The pools outlive the filters, so that
+ * rebuilding the chain with the same formats allocates nothing.
+ */
+static picture_t *FilterGetPoolPicture( filter_chain_t *chain,
+                                        chained_filter_t *chained )
+{
+    const video_format_t *fmt = &chained->filter.fmt_out.video;
+
+    if( chained->pool != NULL && !FormatMatchesPool( &chained->pool_fmt, fmt ) )
+        FilterPutPool( chain, chained );
+
+    if( chained->pool == NULL )
+    {
+        if( chain->pool_cache == NULL )
+            chain->pool_cache = picture_pool_cache_New( CHAIN_POOL_CACHE_SIZE );
+        if( chain->pool_cache != NULL )
+            chained->pool = picture_pool_cache_Get( chain->pool_cache, fmt,
+                                                    CHAIN_POOL_SIZE );
+        if( chained->pool == NULL )
+            chained->pool = picture_pool_NewFromFormat( fmt, CHAIN_POOL_SIZE );
+        if( chained->pool == NULL )
+            return NULL;
+        video_format_Copy( &chained->pool_fmt, fmt );
+    }
+    return picture_pool_Get( chained->pool );
+}
+
 /** Chained filter picture allocator function */
 static picture_t *filter_chain_VideoBufferNew( filter_t *filter )
 {
@@ -102,6 +168,14 @@ static picture_t *filter_chain_VideoBufferNew( filter_t *filter )
     chained_filter_t *chained = container_of(filter, chained_filter_t, filter);
     if( chained->next != NULL )
     {
+        filter_chain_t *chain = filter->owner.sys;
+
+        /* GPU filters allocate their own pictures from the video context */
+        pic = filter->vctx_out == NULL ? FilterGetPoolPicture( chain, chained )
+                                       : NULL;
+        if( pic != NULL )
+            return pic;
+
         // HACK as intermediate filters may not have the same video format as
         // the last one handled by the owner
         filter_owner_t saved_owner = filter->owner;
@@ -180,6 +254,8 @@ void filter_chain_Delete( filter_chain_t *p_chain )
         vlc_video_context_Release( p_chain->vctx_in );
     es_format_Clean( &p_chain->fmt_out );
 
+    if( p_chain->pool_cache != NULL )
+        picture_pool_cache_Delete( p_chain->pool_cache );
     free( p_chain );
 }
 /**
@@ -275,6 +351,7 @@ static filter_t *filter_chain_AppendInner( filter_chain_t *chain,
 
     vlc_mouse_Init( &chained->mouse );
     vlc_picture_chain_Init( &chained->pending );
+    chained->pool = NULL;
 
     msg_Dbg( chain->obj, "Filter '%s' (%p) appended to chain",
              (name != NULL) ? name : module_GetShortName(filter->p_module),
@@ -333,6 +410,7 @@ void filter_chain_DeleteFilter( filter_chain_t *chain, filter_t *filter )
 
     msg_Dbg( chain->obj, "Filter %p removed from chain", (void *)filter );
     FilterDeletePictures( &chained->pending );
+    FilterPutPool( chain, chained );
 
     es_format_Clean( &filter->fmt_out );
     es_format_Clean( &filter->fmt_in );
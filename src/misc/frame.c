@@ -111,6 +111,231 @@ static const struct vlc_frame_callbacks vlc_frame_generic_cbs =
 /** Initial reserved header and footer size. */
 #define VLC_FRAME_PADDING      32
 
+/*** Pooled allocations ***/
+
+/* Frames up to 64 KiB (including overhead) are recycled, in power-of-two
+ * sized classes from 512 bytes. Each thread keeps a few frames per class,
+ * and overflows to (or refills from) a shared depot. Since frames are often
+ * allocated by one thread (demux) and released by another one (decoder), the
+ * depot is what actually moves memory between threads. */
+#define VLC_FRAME_POOL_MIN_SHIFT  9
+#define VLC_FRAME_POOL_CLASSES    8
+#define VLC_FRAME_POOL_TLS_MAX    16
+/** Maximum byte size of the depot, per class */
+#define VLC_FRAME_POOL_DEPOT_SIZE (2 << 20)
+
+#if defined (__SANITIZE_ADDRESS__)
+/* Let the address sanitizer track every allocation. */
+# define VLC_FRAME_POOL_DISABLED 1
+#endif
+
+struct vlc_frame_pool_depot
+{
+    vlc_mutex_t lock;
+    vlc_frame_t *head;
+    size_t count;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t drops;
+};
+
+struct vlc_frame_pool_cache
+{
+    struct
+    {
+        vlc_frame_t *head;
+        unsigned count;
+        unsigned hits;
+    } classes[VLC_FRAME_POOL_CLASSES];
+};
+
+static struct vlc_frame_pool_depot vlc_frame_pool_depots[VLC_FRAME_POOL_CLASSES] =
+{
+#define DEPOT { VLC_STATIC_MUTEX, NULL, 0, 0, 0, 0 }
+    DEPOT, DEPOT, DEPOT, DEPOT, DEPOT, DEPOT, DEPOT, DEPOT,
+#undef DEPOT
+};
+
+static vlc_once_t vlc_frame_pool_once = VLC_STATIC_ONCE;
+static vlc_threadvar_t vlc_frame_pool_key;
+static bool vlc_frame_pool_tls;
+
+static size_t vlc_frame_pool_ClassSize(unsigned c)
+{
+    return (size_t)1 << (VLC_FRAME_POOL_MIN_SHIFT + c);
+}
+
+static size_t vlc_frame_pool_DepotMax(unsigned c)
+{
+    return VLC_FRAME_POOL_DEPOT_SIZE >> (VLC_FRAME_POOL_MIN_SHIFT + c);
+}
+
+/** Returns the size class for a given allocation size, or -1 if too big. */
+static int vlc_frame_pool_Class(size_t alloc)
+{
+#ifndef VLC_FRAME_POOL_DISABLED
+    for (unsigned c = 0; c < VLC_FRAME_POOL_CLASSES; c++)
+        if (alloc <= vlc_frame_pool_ClassSize(c))
+            return c;
+#else
+    VLC_UNUSED(alloc);
+#endif
+    return -1;
+}
+
+/** Pushes frames to the depot, frees those that do not fit. */
+static void vlc_frame_pool_Put(unsigned c, vlc_frame_t *list, unsigned hits)
+{
+    struct vlc_frame_pool_depot *depot = &vlc_frame_pool_depots[c];
+    const size_t max = vlc_frame_pool_DepotMax(c);
+    vlc_frame_t *drop = NULL;
+
+    vlc_mutex_lock(&depot->lock);
+    depot->hits += hits;
+
+    while (list != NULL) {
+        vlc_frame_t *next = list->p_next;
+
+        if (depot->count < max) {
+            list->p_next = depot->head;
+            depot->head = list;
+            depot->count++;
+        } else {
+            list->p_next = drop;
+            drop = list;
+            depot->drops++;
+        }
+        list = next;
+    }
+    vlc_mutex_unlock(&depot->lock);
+
+    while (drop != NULL) {
+        vlc_frame_t *next = drop->p_next;
+
+        free(drop);
+        drop = next;
+    }
+}
+
+static void vlc_frame_pool_CacheDestroy(void *data)
+{
+    struct vlc_frame_pool_cache *cache = data;
+
+    for (unsigned c = 0; c < VLC_FRAME_POOL_CLASSES; c++)
+        vlc_frame_pool_Put(c, cache->classes[c].head, cache->classes[c].hits);
+    free(cache);
+}
+
+static void vlc_frame_pool_Init(void *data)
+{
+    VLC_UNUSED(data);
+    vlc_frame_pool_tls = vlc_threadvar_create(&vlc_frame_pool_key,
+                                              vlc_frame_pool_CacheDestroy) == 0;
+}
+
+static struct vlc_frame_pool_cache *vlc_frame_pool_GetCache(void)
+{
+    vlc_once(&vlc_frame_pool_once, vlc_frame_pool_Init, NULL);
+
+    if (unlikely(!vlc_frame_pool_tls))
+        return NULL;
+
+    struct vlc_frame_pool_cache *cache = vlc_threadvar_get(vlc_frame_pool_key);
+
+    if (unlikely(cache == NULL)) {
+        cache = calloc(1, sizeof (*cache));
+        if (unlikely(cache == NULL))
+            return NULL;
+        if (vlc_threadvar_set(vlc_frame_pool_key, cache)) {
+            free(cache);
+            return NULL;
+        }
+    }
+    return cache;
+}
+
+static vlc_frame_t *vlc_frame_pool_Get(unsigned c)
+{
+    struct vlc_frame_pool_cache *cache = vlc_frame_pool_GetCache();
+    struct vlc_frame_pool_depot *depot = &vlc_frame_pool_depots[c];
+    vlc_frame_t *f;
+
+    if (likely(cache != NULL) && cache->classes[c].head != NULL) {
+        f = cache->classes[c].head;
+        cache->classes[c].head = f->p_next;
+        cache->classes[c].count--;
+        if (++cache->classes[c].hits >= 256) {
+            /* Account for hits once in a while */
+            vlc_mutex_lock(&depot->lock);
+            depot->hits += cache->classes[c].hits;
+            vlc_mutex_unlock(&depot->lock);
+            cache->classes[c].hits = 0;
+        }
+        return f;
+    }
+
+    vlc_mutex_lock(&depot->lock);
+    f = depot->head;
+    if (f != NULL) {
+        depot->head = f->p_next;
+        depot->count--;
+        depot->hits++;
+    } else
+        depot->misses++;
+    vlc_mutex_unlock(&depot->lock);
+
+    if (f == NULL)
+        f = malloc(vlc_frame_pool_ClassSize(c));
+    return f;
+}
+
+static void vlc_frame_pool_Release(vlc_frame_t *frame)
+{
+    const size_t alloc = sizeof (*frame) + frame->i_size;
+    unsigned c = 0;
+
+    assert (frame->p_start == (unsigned char *)(frame + 1));
+    while (vlc_frame_pool_ClassSize(c) < alloc)
+        c++;
+    assert (c < VLC_FRAME_POOL_CLASSES);
+    assert (vlc_frame_pool_ClassSize(c) == alloc);
+
+    struct vlc_frame_pool_cache *cache = vlc_frame_pool_GetCache();
+
+    if (likely(cache != NULL)
+     && cache->classes[c].count < VLC_FRAME_POOL_TLS_MAX) {
+        frame->p_next = cache->classes[c].head;
+        cache->classes[c].head = frame;
+        cache->classes[c].count++;
+        return;
+    }
+
+    frame->p_next = NULL;
+    vlc_frame_pool_Put(c, frame, 0);
+}
+
+static const struct vlc_frame_callbacks vlc_frame_pool_cbs =
+{
+    vlc_frame_pool_Release,
+};
+
+size_t vlc_frame_pool_GetStats(struct vlc_frame_pool_stats *stats,
+                               size_t count)
+{
+    for (size_t c = 0; c < count && c < VLC_FRAME_POOL_CLASSES; c++) {
+        struct vlc_frame_pool_depot *depot = &vlc_frame_pool_depots[c];
+
+        vlc_mutex_lock(&depot->lock);
+        stats[c].size = vlc_frame_pool_ClassSize(c);
+        stats[c].hits = depot->hits;
+        stats[c].misses = depot->misses;
+        stats[c].drops = depot->drops;
+        stats[c].cached = depot->count;
+        vlc_mutex_unlock(&depot->lock);
+    }
+    return VLC_FRAME_POOL_CLASSES;
+}
+
 vlc_frame_t *vlc_frame_Alloc (size_t size)
 {
     if (unlikely(size >> 28))
@@ -120,16 +345,27 @@ vlc_frame_t *vlc_frame_Alloc (size_t size)
     }
 
     /* 2 * VLC_FRAME_PADDING: pre + post padding */
-    const size_t alloc = sizeof (vlc_frame_t) + VLC_FRAME_ALIGN + (2 * VLC_FRAME_PADDING)
-                       + size;
+    size_t alloc = sizeof (vlc_frame_t) + VLC_FRAME_ALIGN + (2 * VLC_FRAME_PADDING)
+                 + size;
     if (unlikely(alloc <= size))
         return NULL;
 
-    vlc_frame_t *f = malloc (alloc);
+    const struct vlc_frame_callbacks *cbs = &vlc_frame_generic_cbs;
+    int c = vlc_frame_pool_Class(alloc);
+    vlc_frame_t *f;
+
+    if (c >= 0)
+    {   /* The whole class size is usable, e.g. by vlc_frame_TryRealloc() */
+        alloc = vlc_frame_pool_ClassSize(c);
+        cbs = &vlc_frame_pool_cbs;
+        f = vlc_frame_pool_Get(c);
+    }
+    else
+        f = malloc (alloc);
     if (unlikely(f == NULL))
         return NULL;
 
-    vlc_frame_Init(f, &vlc_frame_generic_cbs, f + 1, alloc - sizeof (*f));
+    vlc_frame_Init(f, cbs, f + 1, alloc - sizeof (*f));
     static_assert ((VLC_FRAME_PADDING % VLC_FRAME_ALIGN) == 0,
                    "VLC_FRAME_PADDING must be a multiple of VLC_FRAME_ALIGN");
     f->p_buffer += VLC_FRAME_PADDING + VLC_FRAME_ALIGN - 1;
@@ -149,6 +385,111 @@ void vlc_frame_Release(vlc_frame_t *frame)
     frame->cbs->free(frame);
 }
 
+/* A shared frame is a reference to the payload of another frame, the origin,
+ * which is released with the last reference. Each reference has its own
+ * header, so only the payload is read-only. */
+struct vlc_frame_payload
+{
+    vlc_atomic_rc_t rc;
+    vlc_frame_t *origin;
+};
+
+typedef struct
+{
+    vlc_frame_t self;
+    struct vlc_frame_payload *payload;
+} vlc_frame_ref_t;
+
+static void vlc_frame_ref_Release(vlc_frame_t *frame)
+{
+    vlc_frame_ref_t *ref = container_of(frame, vlc_frame_ref_t, self);
+    struct vlc_frame_payload *payload = ref->payload;
+
+    if (vlc_atomic_rc_dec(&payload->rc))
+    {
+        vlc_frame_Release(payload->origin);
+        free(payload);
+    }
+    free(ref);
+}
+
+static const struct vlc_frame_callbacks vlc_frame_ref_cbs =
+{
+    vlc_frame_ref_Release,
+};
+
+static vlc_frame_t *vlc_frame_ref_New(struct vlc_frame_payload *payload,
+                                      const vlc_frame_t *src)
+{
+    vlc_frame_ref_t *ref = malloc(sizeof (*ref));
+    if (unlikely(ref == NULL))
+        return NULL;
+
+    /* Leave no spare room, so that vlc_frame_TryRealloc() copies on growth */
+    vlc_frame_t *frame = vlc_frame_Init(&ref->self, &vlc_frame_ref_cbs,
+                                        src->p_buffer, src->i_buffer);
+    vlc_frame_CopyProperties(frame, src);
+    ref->payload = payload;
+    return frame;
+}
+
+bool vlc_frame_IsShared(const vlc_frame_t *frame)
+{
+    if (frame->cbs != &vlc_frame_ref_cbs)
+        return false;
+
+    const vlc_frame_ref_t *ref = container_of(frame, vlc_frame_ref_t, self);
+    return vlc_atomic_rc_get(&ref->payload->rc) > 1;
+}
+
+vlc_frame_t *vlc_frame_Shared(vlc_frame_t *frame)
+{
+    if (frame->cbs == &vlc_frame_ref_cbs)
+        return frame;
+
+    struct vlc_frame_payload *payload = malloc(sizeof (*payload));
+    if (unlikely(payload == NULL))
+        return frame;
+
+    vlc_frame_t *shared = vlc_frame_ref_New(payload, frame);
+    if (unlikely(shared == NULL))
+    {
+        free(payload);
+        return frame;
+    }
+
+    vlc_atomic_rc_init(&payload->rc);
+    payload->origin = frame;
+    shared->p_next = frame->p_next;
+    frame->p_next = NULL;
+    return shared;
+}
+
+vlc_frame_t *vlc_frame_Clone(const vlc_frame_t *frame)
+{
+    if (frame->cbs != &vlc_frame_ref_cbs)
+        return vlc_frame_Duplicate(frame);
+
+    const vlc_frame_ref_t *ref = container_of(frame, vlc_frame_ref_t, self);
+    vlc_frame_t *clone = vlc_frame_ref_New(ref->payload, frame);
+
+    if (likely(clone != NULL))
+        vlc_atomic_rc_inc(&ref->payload->rc);
+    return clone;
+}
+
+vlc_frame_t *vlc_frame_MakeWritable(vlc_frame_t *frame)
+{
+    if (!vlc_frame_IsShared(frame))
+        return frame;
+
+    vlc_frame_t *dup = vlc_frame_Duplicate(frame);
+    if (likely(dup != NULL))
+        dup->p_next = frame->p_next;
+    vlc_frame_Release(frame);
+    return dup;
+}
+
 static vlc_frame_t *vlc_frame_ReallocDup( vlc_frame_t *frame, ssize_t i_prebody, size_t requested )
 {
     vlc_frame_t *p_rea = vlc_frame_Alloc( requested );
@@ -199,6 +540,11 @@ vlc_frame_t *vlc_frame_TryRealloc (vlc_frame_t *frame, ssize_t i_prebody, size_t
 
     size_t requested = i_prebody + i_body;
 
+    /* The payload of a shared frame cannot be exposed for writing */
+    if( (i_prebody > 0 || i_body > frame->i_buffer)
+     && vlc_frame_IsShared( frame ) )
+        return vlc_frame_ReallocDup( frame, i_prebody, requested );
+
     if( frame->i_buffer == 0 )
     {   /* Corner case: nothing to preserve */
         if( requested <= frame->i_size )
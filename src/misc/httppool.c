@@ -0,0 +1,176 @@
+/*****************************************************************************
+ * httppool.c: pool of idle HTTP connections
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_list.h>
+#include <vlc_tls.h>
+#include <vlc_http.h>
+
+/* Most servers close idle connections after 5 to 75 seconds. A closed
+ * connection is only detected on reuse, and then replaced. */
+#define POOL_MAX 8
+#define POOL_IDLE_TIMEOUT VLC_TICK_FROM_SEC(15)
+
+struct vlc_http_pool_entry
+{
+    struct vlc_list node;
+    void *conn;
+    void (*release)(void *);
+    vlc_tick_t expiry;
+    char key[];
+};
+
+struct vlc_http_pool
+{
+    vlc_object_t *obj;
+    vlc_mutex_t lock;
+    struct vlc_list idle; /**< Most recently used first */
+    unsigned count;
+    struct vlc_tls_client *creds;
+};
+
+vlc_http_pool_t *vlc_http_pool_new(vlc_object_t *obj)
+{
+    vlc_http_pool_t *pool = malloc(sizeof (*pool));
+    if (unlikely(pool == NULL))
+        return NULL;
+
+    pool->obj = obj;
+    vlc_mutex_init(&pool->lock);
+    vlc_list_init(&pool->idle);
+    pool->count = 0;
+    pool->creds = NULL;
+    return pool;
+}
+
+static void vlc_http_pool_release(struct vlc_list *list)
+{
+    struct vlc_http_pool_entry *entry;
+
+    vlc_list_foreach(entry, list, node)
+    {
+        entry->release(entry->conn);
+        free(entry);
+    }
+}
+
+void vlc_http_pool_destroy(vlc_http_pool_t *pool)
+{
+    if (pool == NULL)
+        return;
+
+    vlc_http_pool_release(&pool->idle);
+    /* Sessions must be closed before their credentials */
+    if (pool->creds != NULL)
+        vlc_tls_ClientDelete(pool->creds);
+    free(pool);
+}
+
+/* Moves the expired connections, and the oldest ones beyond max, to a list
+ * to be released without holding the lock. */
+static void vlc_http_pool_expire(vlc_http_pool_t *pool, struct vlc_list *list,
+                                 unsigned max)
+{
+    struct vlc_http_pool_entry *entry;
+    vlc_tick_t now = vlc_tick_now();
+    unsigned n = 0;
+
+    vlc_list_foreach(entry, &pool->idle, node)
+        if (++n > max || entry->expiry <= now)
+        {
+            vlc_list_remove(&entry->node);
+            vlc_list_append(&entry->node, list);
+            pool->count--;
+        }
+}
+
+void vlc_http_pool_put(vlc_http_pool_t *pool, const char *key, void *conn,
+                       void (*release)(void *))
+{
+    size_t len = strlen(key) + 1;
+    struct vlc_http_pool_entry *entry = malloc(sizeof (*entry) + len);
+    if (unlikely(entry == NULL))
+    {
+        release(conn);
+        return;
+    }
+
+    entry->conn = conn;
+    entry->release = release;
+    entry->expiry = vlc_tick_now() + POOL_IDLE_TIMEOUT;
+    memcpy(entry->key, key, len);
+
+    struct vlc_list stale;
+
+    vlc_list_init(&stale);
+    vlc_mutex_lock(&pool->lock);
+    vlc_http_pool_expire(pool, &stale, POOL_MAX - 1);
+    vlc_list_prepend(&entry->node, &pool->idle);
+    pool->count++;
+    vlc_mutex_unlock(&pool->lock);
+
+    vlc_http_pool_release(&stale);
+}
+
+void *vlc_http_pool_get(vlc_http_pool_t *pool, const char *key)
+{
+    struct vlc_http_pool_entry *entry, *found = NULL;
+    struct vlc_list stale;
+
+    vlc_list_init(&stale);
+    vlc_mutex_lock(&pool->lock);
+    vlc_http_pool_expire(pool, &stale, POOL_MAX);
+
+    vlc_list_foreach(entry, &pool->idle, node)
+        if (strcmp(entry->key, key) == 0)
+        {
+            vlc_list_remove(&entry->node);
+            pool->count--;
+            found = entry;
+            break;
+        }
+    vlc_mutex_unlock(&pool->lock);
+
+    vlc_http_pool_release(&stale);
+
+    if (found == NULL)
+        return NULL;
+
+    void *conn = found->conn;
+    free(found);
+    return conn;
+}
+
+struct vlc_tls_client *vlc_http_pool_get_tls(vlc_http_pool_t *pool)
+{
+    vlc_mutex_lock(&pool->lock);
+    if (pool->creds == NULL)
+        pool->creds = vlc_tls_ClientCreate(pool->obj);
+    vlc_mutex_unlock(&pool->lock);
+    return pool->creds;
+}
@@ -176,6 +176,10 @@ static picture_t *ImageRead( image_handler_t *p_image, block_t *p_block,
         }
     }
 
+    /* Let the decoder reduce the size on its own if it can */
+    var_SetInteger( p_image->p_dec, "image-width", p_fmt_out->i_width );
+    var_SetInteger( p_image->p_dec, "image-height", p_fmt_out->i_height );
+
     p_block->i_pts = p_block->i_dts = vlc_tick_now();
     int ret = p_image->p_dec->pf_decode( p_image->p_dec, p_block );
     if( ret == VLCDEC_SUCCESS )
@@ -689,6 +693,10 @@ static decoder_t *CreateDecoder( image_handler_t *p_image, const es_format_t *fm
     };
     p_dec->cbs = &dec_cbs;
 
+    /* Size wanted by the caller, the decoder may output anything larger */
+    var_Create( p_dec, "image-width", VLC_VAR_INTEGER );
+    var_Create( p_dec, "image-height", VLC_VAR_INTEGER );
+
     /* Find a suitable decoder module */
     p_dec->p_module = module_need_var( p_dec, "video decoder", "codec" );
     if( !p_dec->p_module )
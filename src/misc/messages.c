@@ -40,6 +40,7 @@
 #include <vlc_interface.h>
 #include <vlc_charset.h>
 #include <vlc_modules.h>
+#include <vlc_queue.h>
 #include "rcu.h"
 #include "../libvlc.h"
 
@@ -435,6 +436,217 @@ static struct vlc_logger *vlc_LogModuleCreate(vlc_object_t *parent)
     return &module->frontend;
 }
 
+/**
+ * Asynchronous message log.
+ *
+ * A message log that formats messages in the calling thread, and hands them
+ * over to a background thread through a lock-free ring, so that slow sinks
+ * do not stall the emitting threads. Messages are dropped, rather than
+ * waited for, if the ring is full. Non-error messages can also be rate
+ * limited per object with a token bucket.
+ */
+#define LOG_ASYNC_SIZE 4096
+#define LOG_ASYNC_BUCKETS 64
+#define LOG_ASYNC_STACK 256
+
+typedef struct vlc_log_async_msg
+{
+    int type;
+    vlc_tick_t date;
+    vlc_log_t meta;
+    char text[]; /* message, then module name, then optional header */
+} vlc_log_async_msg_t;
+
+struct vlc_log_bucket
+{
+    uintptr_t object_id;
+    vlc_tick_t date; /**< Date of the last refill */
+    vlc_tick_t tokens; /**< Available tokens, VLC_TICK_FROM_SEC(1) each */
+    unsigned suppressed;
+};
+
+struct vlc_logger_async {
+    struct vlc_logger logger;
+    struct vlc_logger *sink;
+    vlc_ring_t *ring;
+    vlc_thread_t thread;
+    atomic_uint dropped;
+    unsigned rate; /**< Messages per second per object, or 0 */
+    struct vlc_log_bucket buckets[LOG_ASYNC_BUCKETS];
+};
+
+static void vlc_vaLogAsync(void *d, int type, const vlc_log_t *item,
+                           const char *format, va_list ap)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, logger);
+    char buf[LOG_ASYNC_STACK];
+    va_list aq;
+
+    va_copy(aq, ap);
+    int len = vsnprintf(buf, sizeof (buf), format, aq);
+    va_end(aq);
+    if (unlikely(len < 0))
+        return;
+
+    size_t modlen = strlen(item->psz_module) + 1;
+    size_t hdrlen = (item->psz_header != NULL)
+                    ? strlen(item->psz_header) + 1 : 0;
+    vlc_log_async_msg_t *msg = malloc(sizeof (*msg) + len + 1 + modlen
+                                      + hdrlen);
+    if (unlikely(msg == NULL))
+        goto drop;
+
+    if ((size_t)len < sizeof (buf))
+        memcpy(msg->text, buf, len + 1);
+    else
+        vsnprintf(msg->text, len + 1, format, ap);
+
+    msg->type = type;
+    msg->date = vlc_tick_now();
+    msg->meta = *item;
+    /* NOTE: Object types, file and function names are static constants. */
+    msg->meta.psz_module = memcpy(msg->text + len + 1, item->psz_module,
+                                  modlen);
+    if (hdrlen > 0)
+        msg->meta.psz_header = memcpy(msg->text + len + 1 + modlen,
+                                      item->psz_header, hdrlen);
+
+    if (likely(vlc_ring_TryEnqueue(async->ring, msg)))
+        return;
+    free(msg);
+drop:
+    atomic_fetch_add_explicit(&async->dropped, 1, memory_order_relaxed);
+}
+
+static bool vlc_LogAsyncAllow(struct vlc_logger_async *async,
+                              const vlc_log_async_msg_t *msg)
+{
+    if (async->rate == 0 || msg->type == VLC_MSG_ERR)
+        return true;
+
+    const uintptr_t id = msg->meta.i_object_id;
+    struct vlc_log_bucket *bucket =
+        &async->buckets[(id / sizeof (void *)) % LOG_ASYNC_BUCKETS];
+    const vlc_tick_t burst = async->rate * VLC_TICK_FROM_SEC(1);
+
+    if (bucket->object_id != id)
+    {   /* Evict the previous object from this slot */
+        bucket->object_id = id;
+        bucket->date = msg->date;
+        bucket->tokens = burst;
+        bucket->suppressed = 0;
+    }
+
+    /* Refill one token per 1/rate second, up to one second worth of tokens */
+    bucket->tokens += (msg->date - bucket->date) * async->rate;
+    if (bucket->tokens > burst)
+        bucket->tokens = burst;
+    bucket->date = msg->date;
+
+    if (bucket->tokens < VLC_TICK_FROM_SEC(1))
+    {
+        bucket->suppressed++;
+        return false;
+    }
+    bucket->tokens -= VLC_TICK_FROM_SEC(1);
+
+    if (bucket->suppressed > 0)
+    {
+        vlc_LogCallback(async->sink, VLC_MSG_WARN, &msg->meta,
+                        "%u messages suppressed", bucket->suppressed);
+        bucket->suppressed = 0;
+    }
+    return true;
+}
+
+static void *vlc_LogAsyncThread(void *data)
+{
+    struct vlc_logger_async *async = data;
+    vlc_log_async_msg_t *msg;
+
+    while ((msg = vlc_ring_Dequeue(async->ring)) != NULL)
+    {
+        /* Drain everything pending before checking for drops */
+        do
+        {
+            if (vlc_LogAsyncAllow(async, msg))
+                vlc_LogCallback(async->sink, msg->type, &msg->meta, "%s",
+                                msg->text);
+            free(msg);
+        }
+        while ((msg = vlc_ring_TryDequeue(async->ring)) != NULL);
+
+        unsigned dropped = atomic_exchange_explicit(&async->dropped, 0,
+                                                    memory_order_relaxed);
+        if (dropped > 0)
+        {
+            vlc_log_t meta = {
+                .i_object_id = (uintptr_t)(void *)async,
+                .psz_object_type = "logger",
+                .psz_module = "core",
+                .tid = vlc_thread_id(),
+            };
+
+            vlc_LogCallback(async->sink, VLC_MSG_WARN, &meta,
+                            "%u messages dropped", dropped);
+        }
+    }
+    return NULL;
+}
+
+static void vlc_LogAsyncClose(void *d)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, logger);
+
+    /* The thread drains the remaining messages before it exits. */
+    vlc_ring_Kill(async->ring);
+    vlc_join(async->thread, NULL);
+    vlc_ring_Delete(async->ring);
+
+    async->sink->ops->destroy(async->sink);
+    free(async);
+}
+
+static const struct vlc_logger_operations async_ops = {
+    vlc_vaLogAsync,
+    vlc_LogAsyncClose,
+};
+
+static struct vlc_logger *vlc_LogAsyncCreate(struct vlc_logger *sink,
+                                             unsigned rate)
+{
+    struct vlc_logger_async *async = malloc(sizeof (*async));
+    if (unlikely(async == NULL))
+        return NULL;
+
+    async->logger.ops = &async_ops;
+    async->sink = sink;
+    async->ring = vlc_ring_New(LOG_ASYNC_SIZE, VLC_RING_MULTI_PRODUCER);
+    atomic_init(&async->dropped, 0);
+    async->rate = rate;
+    for (size_t i = 0; i < ARRAY_SIZE(async->buckets); i++)
+        async->buckets[i].object_id = 0;
+
+    if (unlikely(async->ring == NULL))
+    {
+        free(async);
+        return NULL;
+    }
+
+    if (vlc_clone(&async->thread, vlc_LogAsyncThread, async,
+                  VLC_THREAD_PRIORITY_LOW))
+    {
+        vlc_ring_Delete(async->ring);
+        free(async);
+        return NULL;
+    }
+    return &async->logger;
+}
+
 /**
  * Initializes the messages logging subsystem and drain the early messages to
  * the configured log.
@@ -444,6 +656,15 @@ void vlc_LogInit(libvlc_int_t *vlc)
     struct vlc_logger *logger = vlc_LogModuleCreate(VLC_OBJECT(vlc));
     if (logger == NULL)
         logger = &discard_log;
+    else if (var_InheritBool(vlc, "log-async"))
+    {
+        int64_t rate = var_InheritInteger(vlc, "log-rate-limit");
+        struct vlc_logger *async =
+            vlc_LogAsyncCreate(logger, (rate > 0) ? rate : 0);
+
+        if (likely(async != NULL))
+            logger = async;
+    }
 
     vlc_LogSwitch(vlc->obj.logger, logger);
 }
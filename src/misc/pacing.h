@@ -0,0 +1,43 @@
+/*****************************************************************************
+ * pacing.h: video frame pacing statistics
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_PACING_H
+# define LIBVLC_PACING_H 1
+
+# include <vlc_input_item.h>
+
+/* Shared by the video output, which measures them, and the input statistics,
+ * which accumulate them. */
+enum input_stats_pacing_type
+{
+    INPUT_STATS_PACING_DECODE,
+    INPUT_STATS_PACING_FILTER,
+    INPUT_STATS_PACING_RENDER,
+    INPUT_STATS_PACING_DISPLAY,
+#define INPUT_STATS_PACING_TYPES (INPUT_STATS_PACING_DISPLAY + 1)
+};
+
+/** Video frame pacing histograms, see input_stats_t */
+struct input_stats_pacing
+{
+    unsigned histogram[INPUT_STATS_PACING_TYPES][INPUT_STATS_PACING_BUCKETS];
+};
+
+#endif
@@ -472,6 +472,47 @@ picture_t *picture_Clone(picture_t *picture)
     return clone;
 }
 
+picture_t *picture_NewView(picture_t *picture, const video_format_t *fmt,
+                           unsigned x, unsigned y)
+{
+    /* Opaque surfaces cannot be offset */
+    if (picture->context != NULL)
+        return NULL;
+
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(picture->format.i_chroma);
+    if (dsc == NULL || dsc->plane_count == 0
+     || fmt->i_chroma != picture->format.i_chroma
+     || x + fmt->i_width > picture->format.i_width
+     || y + fmt->i_height > picture->format.i_height)
+        return NULL;
+
+    picture_resource_t res = {
+        .pf_destroy = picture_DestroyClone,
+    };
+
+    for (int i = 0; i < picture->i_planes; i++) {
+        const plane_t *p = &picture->p[i];
+        const unsigned px = x * dsc->p[i].w.num / dsc->p[i].w.den;
+        const unsigned py = y * dsc->p[i].h.num / dsc->p[i].h.den;
+
+        if (py >= (unsigned)p->i_lines)
+            return NULL;
+        res.p[i].p_pixels = p->p_pixels + py * p->i_pitch
+                          + px * p->i_pixel_pitch;
+        res.p[i].i_lines = p->i_lines - py;
+        res.p[i].i_pitch = p->i_pitch;
+    }
+
+    picture_t *view = picture_NewFromResource(fmt, &res);
+    if (likely(view != NULL)) {
+        ((picture_priv_t *)view)->gc.opaque = picture;
+        picture_Hold(picture);
+        picture_CopyProperties(view, picture);
+    }
+    return view;
+}
+
 int
 picture_AttachAncillary(picture_t *pic, struct vlc_ancillary *ancillary)
 {
@@ -510,13 +551,13 @@ picture_GetAncillary(const picture_t *pic, vlc_ancillary_id id)
 /*****************************************************************************
  *
  *****************************************************************************/
-int picture_Export( vlc_object_t *p_obj,
-                    block_t **pp_image,
-                    video_format_t *p_fmt,
-                    picture_t *p_picture,
-                    vlc_fourcc_t i_format,
-                    int i_override_width, int i_override_height,
-                    bool b_crop )
+int picture_ExportWithHandler( image_handler_t *p_image,
+                               block_t **pp_image,
+                               video_format_t *p_fmt,
+                               picture_t *p_picture,
+                               vlc_fourcc_t i_format,
+                               int i_override_width, int i_override_height,
+                               bool b_crop )
 {
     /* */
     video_format_t fmt_in = p_picture->format;
@@ -601,14 +642,7 @@ int picture_Export( vlc_object_t *p_obj,
                          * fmt_in.i_sar_num / fmt_in.i_height / fmt_in.i_sar_den;
     }
 
-    image_handler_t *p_image = image_HandlerCreate( p_obj );
-    if( !p_image )
-        return VLC_ENOMEM;
-
     block_t *p_block = image_Write( p_image, p_picture, &fmt_in, &fmt_out );
-
-    image_HandlerDelete( p_image );
-
     if( !p_block )
         return VLC_EGENERIC;
 
@@ -621,3 +655,22 @@ int picture_Export( vlc_object_t *p_obj,
 
     return VLC_SUCCESS;
 }
+
+int picture_Export( vlc_object_t *p_obj,
+                    block_t **pp_image,
+                    video_format_t *p_fmt,
+                    picture_t *p_picture,
+                    vlc_fourcc_t i_format,
+                    int i_override_width, int i_override_height,
+                    bool b_crop )
+{
+    image_handler_t *p_image = image_HandlerCreate( p_obj );
+    if( !p_image )
+        return VLC_ENOMEM;
+
+    int i_ret = picture_ExportWithHandler( p_image, pp_image, p_fmt, p_picture,
+                                           i_format, i_override_width,
+                                           i_override_height, b_crop );
+    image_HandlerDelete( p_image );
+    return i_ret;
+}
@@ -39,12 +39,16 @@
 
 static_assert ((POOL_MAX & (POOL_MAX - 1)) == 0, "Not a power of two");
 
+/* The available pictures bitmap is handled atomically, so that getting or
+ * returning a picture does not take any lock. The lock and the condition
+ * variable are only used to wait for a free picture. */
 struct picture_pool_t {
     vlc_mutex_t lock;
     vlc_cond_t  wait;
 
-    bool               canceled;
-    unsigned long long available;
+    atomic_bool        canceled;
+    atomic_ullong      available;
+    atomic_uint        waiters;
     vlc_atomic_rc_t    refs;
     unsigned short     picture_count;
     picture_t  *picture[];
@@ -75,11 +79,19 @@ static void picture_pool_ReleaseClone(picture_t *clone)
 
     picture_Release(picture);
 
-    vlc_mutex_lock(&pool->lock);
-    assert(!(pool->available & (1ULL << offset)));
-    pool->available |= 1ULL << offset;
-    vlc_cond_signal(&pool->wait);
-    vlc_mutex_unlock(&pool->lock);
+    unsigned long long prev = atomic_fetch_or(&pool->available,
+                                              1ULL << offset);
+    assert(!(prev & (1ULL << offset)));
+    (void) prev;
+
+    /* A waiter registers itself before checking the available pictures, so
+     * it either sees this one or gets signaled. */
+    if (atomic_load(&pool->waiters) > 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
+    }
 
     picture_pool_Destroy(pool);
 }
@@ -115,13 +127,14 @@ picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
     if (count == POOL_MAX)
-        pool->available = ~0ULL;
+        atomic_init(&pool->available, ~0ULL);
     else
-        pool->available = (1ULL << count) - 1;
+        atomic_init(&pool->available, (1ULL << count) - 1);
+    atomic_init(&pool->waiters, 0);
     vlc_atomic_rc_init(&pool->refs);
     pool->picture_count = count;
     memcpy(pool->picture, tab, count * sizeof (picture_t *));
-    pool->canceled = false;
+    atomic_init(&pool->canceled, false);
     return pool;
 }
 
@@ -178,51 +191,64 @@ error:
     return NULL;
 }
 
-picture_t *picture_pool_Get(picture_pool_t *pool)
+/**
+ * Takes the ownership of a free picture slot
+ * \return the slot offset, or -1 if none is available
+ */
+static int picture_pool_Take(picture_pool_t *pool)
 {
-    unsigned long long available;
-
-    vlc_mutex_lock(&pool->lock);
-    assert(vlc_atomic_rc_get(&pool->refs) > 0);
-    available = pool->available;
+    unsigned long long available = atomic_load(&pool->available);
 
     while (available != 0)
     {
         int i = ctz(available);
 
-        if (unlikely(pool->canceled))
-            break;
+        if (atomic_compare_exchange_weak(&pool->available, &available,
+                                         available & ~(1ULL << i)))
+            return i;
+    }
+    return -1;
+}
 
-        pool->available &= ~(1ULL << i);
-        vlc_mutex_unlock(&pool->lock);
-        available &= ~(1ULL << i);
+picture_t *picture_pool_Get(picture_pool_t *pool)
+{
+    assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-        return picture_pool_ClonePicture(pool, i);
-    }
+    if (unlikely(atomic_load(&pool->canceled)))
+        return NULL;
 
-    vlc_mutex_unlock(&pool->lock);
-    return NULL;
+    int i = picture_pool_Take(pool);
+    if (i < 0)
+        return NULL;
+
+    return picture_pool_ClonePicture(pool, i);
 }
 
 picture_t *picture_pool_Wait(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    while (pool->available == 0)
+    int i;
+
+    if (likely(!atomic_load(&pool->canceled))
+     && (i = picture_pool_Take(pool)) >= 0)
+        return picture_pool_ClonePicture(pool, i);
+
+    vlc_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->waiters, 1);
+
+    while ((i = picture_pool_Take(pool)) < 0)
     {
-        if (pool->canceled)
-        {
-            vlc_mutex_unlock(&pool->lock);
-            return NULL;
-        }
+        if (atomic_load(&pool->canceled))
+            break;
         vlc_cond_wait(&pool->wait, &pool->lock);
     }
 
-    int i = ctz(pool->available);
-    pool->available &= ~(1ULL << i);
+    atomic_fetch_sub(&pool->waiters, 1);
     vlc_mutex_unlock(&pool->lock);
 
+    if (i < 0)
+        return NULL;
     return picture_pool_ClonePicture(pool, i);
 }
 
@@ -231,7 +257,7 @@ void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
     vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    pool->canceled = canceled;
+    atomic_store(&pool->canceled, canceled);
     if (canceled)
         vlc_cond_broadcast(&pool->wait);
     vlc_mutex_unlock(&pool->lock);
@@ -241,3 +267,78 @@ unsigned picture_pool_GetSize(const picture_pool_t *pool)
 {
     return pool->picture_count;
 }
+
+struct picture_pool_cache_t {
+    unsigned count;
+    unsigned size;
+    picture_pool_t *pools[]; /* most recently used first */
+};
+
+picture_pool_cache_t *picture_pool_cache_New(unsigned size)
+{
+    picture_pool_cache_t *cache =
+        malloc(sizeof (*cache) + size * sizeof (cache->pools[0]));
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    cache->count = 0;
+    cache->size = size;
+    return cache;
+}
+
+void picture_pool_cache_Delete(picture_pool_cache_t *cache)
+{
+    for (unsigned i = 0; i < cache->count; i++)
+        picture_pool_Release(cache->pools[i]);
+    free(cache);
+}
+
+static bool picture_pool_MatchFormat(const picture_pool_t *pool,
+                                     const video_format_t *fmt)
+{
+    const video_format_t *pfmt = &pool->picture[0]->format;
+
+    return video_format_IsSimilar(pfmt, fmt)
+        && pfmt->primaries == fmt->primaries
+        && pfmt->transfer == fmt->transfer
+        && pfmt->space == fmt->space
+        && pfmt->color_range == fmt->color_range
+        && pfmt->chroma_location == fmt->chroma_location;
+}
+
+picture_pool_t *picture_pool_cache_Get(picture_pool_cache_t *cache,
+                                       const video_format_t *fmt,
+                                       unsigned count)
+{
+    for (unsigned i = 0; i < cache->count; i++)
+    {
+        picture_pool_t *pool = cache->pools[i];
+
+        if (pool->picture_count != count || !picture_pool_MatchFormat(pool, fmt))
+            continue;
+
+        cache->count--;
+        memmove(&cache->pools[i], &cache->pools[i + 1],
+                (cache->count - i) * sizeof (cache->pools[0]));
+        picture_pool_Cancel(pool, false);
+        return pool;
+    }
+    return NULL;
+}
+
+void picture_pool_cache_Put(picture_pool_cache_t *cache, picture_pool_t *pool)
+{
+    if (cache->size == 0 || pool->picture_count == 0)
+    {
+        picture_pool_Release(pool);
+        return;
+    }
+
+    if (cache->count == cache->size)
+        picture_pool_Release(cache->pools[--cache->count]);
+
+    memmove(&cache->pools[1], &cache->pools[0],
+            cache->count * sizeof (cache->pools[0]));
+    cache->pools[0] = pool;
+    cache->count++;
+}
@@ -23,11 +23,13 @@
 #endif
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdlib.h>
 
 #include <vlc_common.h>
 #include <vlc_queue.h>
+#include <vlc_atomic.h>
 
 /* Opaque struct type.
  *
@@ -158,3 +160,229 @@ void *vlc_queue_DequeueAll(vlc_queue_t *q)
 
     return entry;
 }
+
+/*** Bounded lock-free queues ***/
+
+struct vlc_ring_slot
+{
+    atomic_size_t seq;
+    void *entry;
+};
+
+struct vlc_ring_waitq
+{
+    atomic_uint seq;
+    atomic_bool waiting;
+};
+
+#define VLC_RING_PAD(type) (64 - sizeof (type))
+
+struct vlc_ring
+{
+    /* Written by the producer(s) */
+    atomic_size_t tail;
+    unsigned char tail_pad[VLC_RING_PAD(atomic_size_t)];
+    /* Written by the consumer */
+    atomic_size_t head;
+    unsigned char head_pad[VLC_RING_PAD(atomic_size_t)];
+
+    struct vlc_ring_waitq readable;
+    struct vlc_ring_waitq writable;
+    atomic_bool dead;
+
+    bool multi_producer;
+    size_t mask;
+    struct vlc_ring_slot slots[];
+};
+
+static void vlc_ring_WaitInit(struct vlc_ring_waitq *wq)
+{
+    atomic_init(&wq->seq, 0);
+    atomic_init(&wq->waiting, false);
+}
+
+vlc_ring_t *vlc_ring_New(size_t capacity, unsigned flags)
+{
+    size_t size = 1;
+
+    while (size < capacity) {
+        if (unlikely(size > SIZE_MAX / 2))
+            return NULL;
+        size *= 2;
+    }
+
+    if (unlikely(size > (SIZE_MAX - sizeof (vlc_ring_t))
+                        / sizeof (struct vlc_ring_slot)))
+        return NULL;
+
+    vlc_ring_t *ring = malloc(sizeof (*ring) + size * sizeof (ring->slots[0]));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    vlc_ring_WaitInit(&ring->readable);
+    vlc_ring_WaitInit(&ring->writable);
+    atomic_init(&ring->dead, false);
+    ring->multi_producer = (flags & VLC_RING_MULTI_PRODUCER) != 0;
+    ring->mask = size - 1;
+
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&ring->slots[i].seq, i);
+        ring->slots[i].entry = NULL;
+    }
+
+    return ring;
+}
+
+void vlc_ring_Delete(vlc_ring_t *ring)
+{
+    free(ring);
+}
+
+static void vlc_ring_Wake(struct vlc_ring_waitq *wq)
+{
+    /* Pairs with the fence in vlc_ring_Wait(): either the waiter sees the new
+     * ring state, or this sees the waiting flag. */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    /* Fast path: nobody to wake up, no system calls. */
+    if (!atomic_load_explicit(&wq->waiting, memory_order_relaxed)
+     || !atomic_exchange_explicit(&wq->waiting, false, memory_order_relaxed))
+        return;
+
+    /* Waiters must set the flag again before they go back to sleep, so that
+     * the other side issues at most one wake-up per wait. */
+    atomic_fetch_add_explicit(&wq->seq, 1, memory_order_relaxed);
+    vlc_atomic_notify_all(&wq->seq);
+}
+
+/**
+ * Waits until the other side of the ring makes progress.
+ *
+ * @param ready callback checking for the resource (and taking it if found)
+ * @return true if ready() succeeded, false if the ring was ended
+ */
+static bool vlc_ring_Wait(vlc_ring_t *ring, struct vlc_ring_waitq *wq,
+                          bool (*ready)(vlc_ring_t *, void **), void **datap)
+{
+    for (;;) {
+        unsigned seq = atomic_load_explicit(&wq->seq, memory_order_relaxed);
+
+        atomic_store_explicit(&wq->waiting, true, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        if (ready(ring, datap))
+            return true;
+        if (atomic_load_explicit(&ring->dead, memory_order_relaxed))
+            return false;
+
+        vlc_testcancel();
+        vlc_atomic_wait(&wq->seq, seq);
+    }
+}
+
+bool vlc_ring_TryEnqueue(vlc_ring_t *ring, void *entry)
+{
+    struct vlc_ring_slot *slot;
+    size_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    assert(entry != NULL);
+
+    for (;;) {
+        slot = &ring->slots[pos & ring->mask];
+
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        ptrdiff_t diff = (ptrdiff_t)(seq - pos);
+
+        if (diff < 0)
+            return false; /* full: the consumer did not release the slot */
+
+        if (diff > 0) {
+            /* Another producer took this slot already */
+            assert(ring->multi_producer);
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+            continue;
+        }
+
+        if (!ring->multi_producer) {
+            atomic_store_explicit(&ring->tail, pos + 1, memory_order_relaxed);
+            break;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + 1,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+            break;
+    }
+
+    slot->entry = entry;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    vlc_ring_Wake(&ring->readable);
+    return true;
+}
+
+void *vlc_ring_TryDequeue(vlc_ring_t *ring)
+{
+    size_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    struct vlc_ring_slot *slot = &ring->slots[pos & ring->mask];
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+    if (seq != pos + 1)
+        return NULL; /* empty, or the producer has not finished writing */
+
+    void *entry = slot->entry;
+
+    atomic_store_explicit(&ring->head, pos + 1, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, pos + ring->mask + 1,
+                          memory_order_release);
+    vlc_ring_Wake(&ring->writable);
+    return entry;
+}
+
+static bool vlc_ring_EnqueueReady(vlc_ring_t *ring, void **entryp)
+{
+    return vlc_ring_TryEnqueue(ring, *entryp);
+}
+
+int vlc_ring_Enqueue(vlc_ring_t *ring, void *entry)
+{
+    if (likely(vlc_ring_TryEnqueue(ring, entry)))
+        return 0;
+
+    return vlc_ring_Wait(ring, &ring->writable, vlc_ring_EnqueueReady,
+                         &entry) ? 0 : -1;
+}
+
+static bool vlc_ring_DequeueReady(vlc_ring_t *ring, void **entryp)
+{
+    *entryp = vlc_ring_TryDequeue(ring);
+    return *entryp != NULL;
+}
+
+void *vlc_ring_Dequeue(vlc_ring_t *ring)
+{
+    void *entry = vlc_ring_TryDequeue(ring);
+
+    if (entry == NULL
+     && !vlc_ring_Wait(ring, &ring->readable, vlc_ring_DequeueReady, &entry))
+        entry = NULL;
+    return entry;
+}
+
+void vlc_ring_Kill(vlc_ring_t *ring)
+{
+    atomic_store_explicit(&ring->dead, true, memory_order_relaxed);
+    atomic_store_explicit(&ring->readable.waiting, true, memory_order_relaxed);
+    atomic_store_explicit(&ring->writable.waiting, true, memory_order_relaxed);
+    vlc_ring_Wake(&ring->readable);
+    vlc_ring_Wake(&ring->writable);
+}
+
+size_t vlc_ring_GetCount(const vlc_ring_t *ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    return (tail - head <= ring->mask + 1) ? tail - head : 0;
+}
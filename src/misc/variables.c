@@ -27,9 +27,6 @@
 # include "config.h"
 #endif
 
-#ifdef HAVE_SEARCH_H
-# include <search.h>
-#endif
 #include <assert.h>
 #include <float.h>
 #include <math.h>
@@ -67,7 +64,8 @@ typedef struct variable_ops_t
  */
 struct variable_t
 {
-    char *       psz_name; /**< The variable unique name (must be first) */
+    char *       psz_name; /**< The variable unique name */
+    uint32_t     hash;     /**< Hash of the name */
 
     /** The variable's exported value */
     vlc_value_t  val;
@@ -138,23 +136,111 @@ int_ops    = { CmpInt,     DupDummy,  FreeDummy,  },
 string_ops = { CmpString,  DupString, FreeString, },
 coords_ops = { NULL,       DupDummy,  FreeDummy,  };
 
-static int varcmp( const void *a, const void *b )
+static uint32_t varhash( const char *psz_name )
 {
-    const variable_t *va = a, *vb = b;
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
 
-    /* psz_name must be first */
-    assert( va == (const void *)&va->psz_name );
-    return strcmp( va->psz_name, vb->psz_name );
+    while( *psz_name != '\0' )
+    {
+        hash ^= (unsigned char)*(psz_name++);
+        hash *= 16777619u;
+    }
+    return hash;
 }
 
-static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
+/**
+ * Finds the slot of a variable, or the empty slot where it would be inserted.
+ * The variable lock must be held, and the table must exist.
+ */
+static variable_t **LookupSlot( vlc_object_internals_t *priv,
+                                const char *psz_name, uint32_t hash )
+{
+    const size_t mask = priv->var_mask;
+
+    /* The load factor is kept below one, so there is always an empty slot */
+    for( size_t i = hash & mask;; i = (i + 1) & mask )
+    {
+        variable_t *var = priv->var_table[i];
+
+        if( var == NULL
+         || (var->hash == hash && strcmp( var->psz_name, psz_name ) == 0) )
+            return &priv->var_table[i];
+    }
+}
+
+static variable_t *LookupHash( vlc_object_t *obj, const char *psz_name,
+                               uint32_t hash )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
-    void **pp_var;
 
     vlc_mutex_lock(&priv->var_lock);
-    pp_var = tfind( &psz_name, &priv->var_root, varcmp );
-    return (pp_var != NULL) ? *pp_var : NULL;
+    if( priv->var_table == NULL )
+        return NULL;
+    return *LookupSlot( priv, psz_name, hash );
+}
+
+static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
+{
+    return LookupHash( obj, psz_name, varhash( psz_name ) );
+}
+
+/**
+ * Grows the table if needed to insert one more variable.
+ */
+static int Reserve( vlc_object_internals_t *priv )
+{
+    size_t size = (priv->var_table != NULL) ? priv->var_mask + 1 : 0;
+
+    if( (priv->var_count + 1) * 4 <= size * 3 )
+        return VLC_SUCCESS;
+
+    size_t newsize = (size > 0) ? size * 2 : 16;
+    variable_t **table = calloc( newsize, sizeof (*table) );
+    if( unlikely(table == NULL) )
+        return VLC_ENOMEM;
+
+    for( size_t i = 0; i < size; i++ )
+    {
+        variable_t *var = priv->var_table[i];
+        if( var == NULL )
+            continue;
+
+        size_t j = var->hash & (newsize - 1);
+        while( table[j] != NULL )
+            j = (j + 1) & (newsize - 1);
+        table[j] = var;
+    }
+
+    free( priv->var_table );
+    priv->var_table = table;
+    priv->var_mask = newsize - 1;
+    return VLC_SUCCESS;
+}
+
+/**
+ * Removes a variable from the table, shifting back the following variables
+ * of the same cluster so that no tombstones are needed.
+ */
+static void Remove( vlc_object_internals_t *priv, variable_t **slot )
+{
+    const size_t mask = priv->var_mask;
+    size_t i = slot - priv->var_table;
+
+    for( size_t j = (i + 1) & mask; priv->var_table[j] != NULL;
+         j = (j + 1) & mask )
+    {
+        size_t home = priv->var_table[j]->hash & mask;
+
+        /* Move back if the hole lies between the home slot and this one */
+        if( ((j - home) & mask) >= ((j - i) & mask) )
+        {
+            priv->var_table[i] = priv->var_table[j];
+            i = j;
+        }
+    }
+    priv->var_table[i] = NULL;
+    priv->var_count--;
 }
 
 static void Destroy( variable_t *p_var )
@@ -295,6 +381,7 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         return VLC_ENOMEM;
 
     p_var->psz_name = strdup( psz_name );
+    p_var->hash = varhash( psz_name );
     p_var->psz_text = NULL;
 
     p_var->i_type = i_type & ~VLC_VAR_DOINHERIT;
@@ -354,23 +441,30 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         var_Inherit(p_this, psz_name, i_type, &p_var->val);
 
     vlc_object_internals_t *p_priv = vlc_internals( p_this );
-    void **pp_var;
+    variable_t **pp_var = NULL;
     variable_t *p_oldvar;
     int ret = VLC_SUCCESS;
 
     vlc_mutex_lock( &p_priv->var_lock );
 
-    pp_var = tsearch( p_var, &p_priv->var_root, varcmp );
-    if( unlikely(pp_var == NULL) )
-        ret = VLC_ENOMEM;
-    else if( (p_oldvar = *pp_var) == p_var ) /* Variable create */
-        p_var = NULL; /* Variable created */
-    else /* Variable already exists */
-    {
+    if( p_priv->var_table != NULL )
+        pp_var = LookupSlot( p_priv, psz_name, p_var->hash );
+
+    if( pp_var != NULL && (p_oldvar = *pp_var) != NULL )
+    {   /* Variable already exists */
         assert (((i_type ^ p_oldvar->i_type) & VLC_VAR_CLASS) == 0);
         p_oldvar->i_usage++;
         p_oldvar->i_type |= i_type & VLC_VAR_ISCOMMAND;
     }
+    else if( unlikely(Reserve( p_priv ) != VLC_SUCCESS) )
+        ret = VLC_ENOMEM;
+    else /* Variable create */
+    {
+        /* The table may have been reallocated: look the slot up again */
+        *LookupSlot( p_priv, psz_name, p_var->hash ) = p_var;
+        p_priv->var_count++;
+        p_var = NULL; /* Variable created */
+    }
     vlc_mutex_unlock( &p_priv->var_lock );
 
     /* If we did not need to create a new variable, free everything... */
@@ -394,7 +488,7 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
     else if( --p_var->i_usage == 0 )
     {
         assert(!p_var->b_incallback);
-        tdelete( p_var, &p_priv->var_root, varcmp );
+        Remove( p_priv, LookupSlot( p_priv, psz_name, p_var->hash ) );
     }
     else
     {
@@ -407,17 +501,20 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
         Destroy( p_var );
 }
 
-static void CleanupVar( void *var )
-{
-    Destroy( var );
-}
-
 void var_DestroyAll( vlc_object_t *obj )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
 
-    tdestroy( priv->var_root, CleanupVar );
-    priv->var_root = NULL;
+    if( priv->var_table != NULL )
+    {
+        for( size_t i = 0; i <= priv->var_mask; i++ )
+            if( priv->var_table[i] != NULL )
+                Destroy( priv->var_table[i] );
+        free( priv->var_table );
+    }
+    priv->var_table = NULL;
+    priv->var_mask = 0;
+    priv->var_count = 0;
 }
 
 int (var_Change)(vlc_object_t *p_this, const char *psz_name, int i_action, ...)
@@ -723,8 +820,8 @@ int (var_Set)(vlc_object_t *p_this, const char *psz_name, vlc_value_t val)
     return var_SetChecked( p_this, psz_name, 0, val );
 }
 
-int (var_GetChecked)(vlc_object_t *p_this, const char *psz_name,
-                     int expected_type, vlc_value_t *p_val)
+static int GetChecked(vlc_object_t *p_this, const char *psz_name,
+                      uint32_t hash, int expected_type, vlc_value_t *p_val)
 {
     assert( p_this );
 
@@ -732,7 +829,7 @@ int (var_GetChecked)(vlc_object_t *p_this, const char *psz_name,
     variable_t *p_var;
     int err = VLC_SUCCESS;
 
-    p_var = Lookup( p_this, psz_name );
+    p_var = LookupHash( p_this, psz_name, hash );
     if( p_var != NULL )
     {
         assert( expected_type == 0 ||
@@ -752,6 +849,13 @@ int (var_GetChecked)(vlc_object_t *p_this, const char *psz_name,
     return err;
 }
 
+int (var_GetChecked)(vlc_object_t *p_this, const char *psz_name,
+                     int expected_type, vlc_value_t *p_val)
+{
+    return GetChecked( p_this, psz_name, varhash( psz_name ), expected_type,
+                       p_val );
+}
+
 int (var_Get)(vlc_object_t *p_this, const char *psz_name, vlc_value_t *p_val)
 {
     return var_GetChecked( p_this, psz_name, 0, p_val );
@@ -1039,10 +1143,13 @@ int (var_LocationParse)(vlc_object_t *obj, const char *mrl, const char *pref)
 int var_Inherit( vlc_object_t *p_this, const char *psz_name, int i_type,
                  vlc_value_t *p_val )
 {
+    /* Hash the name only once for all the ancestors */
+    const uint32_t hash = varhash( psz_name );
+
     i_type &= VLC_VAR_CLASS;
     for (vlc_object_t *obj = p_this; obj != NULL; obj = vlc_object_parent(obj))
     {
-        if( var_GetChecked( obj, psz_name, i_type, p_val ) == VLC_SUCCESS )
+        if( GetChecked( obj, psz_name, hash, i_type, p_val ) == VLC_SUCCESS )
             return VLC_SUCCESS;
     }
 
@@ -1137,21 +1244,6 @@ error:
     return VLC_EGENERIC;
 }
 
-static thread_local void *twalk_ctx;
-
-static void TwalkGetNames(const void *data, const VISIT which, const int depth)
-{
-    if (which != postorder && which != leaf)
-        return;
-    (void) depth;
-
-    const variable_t *var = *(const variable_t **)data;
-    DECL_ARRAY(char *) *names = twalk_ctx;
-    char *dup = strdup(var->psz_name);
-    if (dup != NULL)
-        ARRAY_APPEND(*names, dup);
-}
-
 char **var_GetAllNames(vlc_object_t *obj)
 {
     vlc_object_internals_t *priv = vlc_internals(obj);
@@ -1159,9 +1251,17 @@ char **var_GetAllNames(vlc_object_t *obj)
     DECL_ARRAY(char *) names;
     ARRAY_INIT(names);
 
-    twalk_ctx = &names;
     vlc_mutex_lock(&priv->var_lock);
-    twalk(priv->var_root, TwalkGetNames);
+    for (size_t i = 0; priv->var_table != NULL && i <= priv->var_mask; i++)
+    {
+        const variable_t *var = priv->var_table[i];
+        if (var == NULL)
+            continue;
+
+        char *dup = strdup(var->psz_name);
+        if (dup != NULL)
+            ARRAY_APPEND(names, dup);
+    }
     vlc_mutex_unlock(&priv->var_lock);
 
     if (names.i_size == 0)
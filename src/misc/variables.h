@@ -37,8 +37,10 @@ struct vlc_object_internals
     vlc_object_t *parent; /**< Parent object (or NULL) */
     const char *typename; /**< Object type human-readable name */
 
-    /* Object variables */
-    void           *var_root;
+    /* Object variables (open-addressing hash table) */
+    struct variable_t **var_table;
+    size_t          var_mask; /**< Table size minus one */
+    size_t          var_count;
     vlc_mutex_t     var_lock;
 
     /* Object resources */
@@ -107,6 +107,14 @@ encoder_t *sout_EncoderCreate( vlc_object_t *p_this, size_t owner_size )
     return NULL;
 }
 
+#undef sout_GetStats
+ssize_t sout_GetStats(vlc_object_t *obj, sout_stats_t **pp_stats)
+{
+    VLC_UNUSED (obj);
+    *pp_stats = NULL;
+    return 0;
+}
+
 noreturn sout_input_t *sout_MuxAddStream(sout_mux_t *mux,
                                          const es_format_t *fmt)
 {
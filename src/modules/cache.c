@@ -35,6 +35,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <assert.h>
 
 #include <vlc_common.h>
@@ -208,9 +209,8 @@ static int vlc_cache_load_config(struct vlc_param *param, block_t *file)
         for (unsigned i = 0; i < cfg->list_count; i++)
         {
             LOAD_STRING (cfg->list.psz[i]);
-            if (cfg->list.psz[i] == NULL /* NULL -> empty string */
-             && (cfg->list.psz[i] = calloc (1, 1)) == NULL)
-                goto error;
+            if (cfg->list.psz[i] == NULL) /* NULL -> empty string */
+                cfg->list.psz[i] = "";
         }
     }
     else
@@ -234,13 +234,16 @@ static int vlc_cache_load_config(struct vlc_param *param, block_t *file)
         LOAD_ARRAY(cfg->list.i, cfg->list_count);
     }
 
-    cfg->list_text = xmalloc (cfg->list_count * sizeof (char *));
+    /* Most parameters have no choices: do not allocate anything then. */
+    if (cfg->list_count)
+        cfg->list_text = xmalloc (cfg->list_count * sizeof (char *));
+    else
+        cfg->list_text = NULL;
     for (unsigned i = 0; i < cfg->list_count; i++)
     {
         LOAD_STRING (cfg->list_text[i]);
-        if (cfg->list_text[i] == NULL /* NULL -> empty string */
-         && (cfg->list_text[i] = calloc (1, 1)) == NULL)
-            goto error;
+        if (cfg->list_text[i] == NULL) /* NULL -> empty string */
+            cfg->list_text[i] = "";
     }
 
     return 0;
@@ -384,7 +387,18 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
 
     msg_Dbg( p_this, "loading plugins cache file %s", psz_filename );
 
-    block_t *file = block_FilePath(psz_filename, false);
+    block_t *file = NULL;
+    int fd = vlc_open(psz_filename, O_RDONLY);
+    if (fd != -1)
+    {
+#ifdef HAVE_POSIX_FADVISE
+        /* The whole file is read sequentially: prefetch it in one go rather
+         * than faulting the mapping in page by page. */
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+        file = block_File(fd, false);
+        vlc_close(fd);
+    }
     if (file == NULL)
         msg_Warn(p_this, "cannot read %s: %s", psz_filename,
                  vlc_strerror_c(errno));
@@ -102,12 +102,55 @@ static bool module_match_name(const module_t *m, const char *name, size_t len)
      return false;
 }
 
+/**
+ * Lists the modules with strictly positive score, by decreasing score.
+ */
+static ssize_t vlc_module_match_any(module_t *const *tab, size_t total,
+                                    module_t ***restrict modules)
+{
+    /* The capability table of the bank is already sorted by score. Just find
+     * the first non-positive score. */
+    size_t low = 0, high = total;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+
+        if (module_get_score(tab[mid]) > 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    module_t **sorted = malloc(low * sizeof (*sorted));
+
+    if (low > 0) {
+        if (unlikely(sorted == NULL)) {
+            *modules = NULL;
+            return -1;
+        }
+        memcpy(sorted, tab, low * sizeof (*sorted));
+    }
+
+    *modules = sorted;
+    return low;
+}
+
 ssize_t vlc_module_match(const char *capability, const char *names,
                          bool strict, module_t ***restrict modules,
                          size_t *restrict strict_matches)
 {
     module_t *const *tab;
     size_t total = module_list_cap(&tab, capability);
+
+    /* Fast path: no module names to look for, so no per-candidate matching.
+     * This is by far the most common case. */
+    if ((names == NULL && !strict)
+     || (names != NULL && strcasecmp(names, "any") == 0)) {
+        if (strict_matches != NULL)
+            *strict_matches = 0;
+        return vlc_module_match_any(tab, total, modules);
+    }
+
     module_t **unsorted = malloc(total * sizeof (*unsorted));
     module_t **sorted = malloc(total * sizeof (*sorted));
     size_t matches = 0;
@@ -308,24 +351,21 @@ void module_unneed(vlc_object_t *obj, module_t *module)
 
 module_t *module_find (const char *name)
 {
-    size_t count;
-    module_t **list = module_list_get (&count);
-
     assert (name != NULL);
 
-    for (size_t i = 0; i < count; i++)
+    /* Walk the bank directly rather than through module_list_get(), so that
+     * looking a module up does not allocate a copy of the whole list. */
+    for (vlc_plugin_t *lib = vlc_plugins; lib != NULL; lib = lib->next)
     {
-        module_t *module = list[i];
-
-        if (unlikely(module->i_shortcuts == 0))
-            continue;
-        if (!strcmp (module->pp_shortcuts[0], name))
+        for (module_t *module = lib->module; module != NULL;
+             module = module->next)
         {
-            module_list_free (list);
-            return module;
+            if (unlikely(module->i_shortcuts == 0))
+                continue;
+            if (!strcmp (module->pp_shortcuts[0], name))
+                return module;
         }
     }
-    module_list_free (list);
     return NULL;
 }
 
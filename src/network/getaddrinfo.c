@@ -35,6 +35,8 @@
 
 #include <sys/types.h>
 #include <vlc_network.h>
+#include <vlc_list.h>
+#include "libvlc.h"
 
 int vlc_getnameinfo( const struct sockaddr *sa, int salen,
                      char *host, int hostlen, int *portnum, int flags )
@@ -121,10 +123,206 @@ int vlc_getaddrinfo (const char *node, unsigned port,
 
 #if defined (_WIN32) || defined (__OS2__) \
  || defined (__ANDROID__) || defined (__APPLE__)
-#warning vlc_getaddrinfo_i11e() not implemented!
-int vlc_getaddrinfo_i11e(const char *node, unsigned port,
-                         const struct addrinfo *hints, struct addrinfo **res)
+#warning vlc_resolve_i11e() not implemented!
+int vlc_resolve_i11e(const char *node, unsigned port,
+                     const struct addrinfo *hints, struct addrinfo **res)
 {
     return vlc_getaddrinfo(node, port, hints, res);
 }
 #endif
+
+/*
+ * getaddrinfo() does not expose the DNS records TTL. Cached results are thus
+ * kept for a short fixed time, much like the host caches of web browsers.
+ * Only authoritative failures are cached, for even less time.
+ */
+#define GAI_CACHE_MAX 64
+#define GAI_CACHE_TTL VLC_TICK_FROM_SEC(60)
+#define GAI_CACHE_NEGATIVE_TTL VLC_TICK_FROM_SEC(5)
+
+struct vlc_gai_entry
+{
+    struct vlc_list node;
+    unsigned port;
+    int family;
+    int socktype;
+    int protocol;
+    int flags;
+    int error;
+    struct addrinfo *res;
+    vlc_tick_t expiry;
+    char name[];
+};
+
+static vlc_mutex_t gai_lock = VLC_STATIC_MUTEX;
+static struct vlc_list gai_cache = VLC_LIST_INITIALIZER(&gai_cache);
+static unsigned gai_count = 0;
+
+void vlc_freeaddrinfo(struct addrinfo *res)
+{
+    while (res != NULL)
+    {
+        struct addrinfo *next = res->ai_next;
+
+        free(res);
+        res = next;
+    }
+}
+
+/* Duplicates a list of addresses, each in a single allocation */
+static int vlc_gai_copy(const struct addrinfo *src, struct addrinfo **dst)
+{
+    struct addrinfo **pp = dst;
+
+    for (; src != NULL; src = src->ai_next)
+    {
+        size_t namelen = (src->ai_canonname != NULL)
+                         ? strlen(src->ai_canonname) + 1 : 0;
+        struct addrinfo *ai = malloc(sizeof (*ai) + src->ai_addrlen
+                                     + namelen);
+        if (unlikely(ai == NULL))
+        {
+            *pp = NULL;
+            vlc_freeaddrinfo(*dst);
+            return EAI_MEMORY;
+        }
+
+        *ai = *src;
+        ai->ai_addr = (struct sockaddr *)(ai + 1);
+        memcpy(ai->ai_addr, src->ai_addr, src->ai_addrlen);
+        if (namelen > 0)
+        {
+            ai->ai_canonname = (char *)ai->ai_addr + src->ai_addrlen;
+            memcpy(ai->ai_canonname, src->ai_canonname, namelen);
+        }
+        *pp = ai;
+        pp = &ai->ai_next;
+    }
+    *pp = NULL;
+    return 0;
+}
+
+static void vlc_gai_remove(struct vlc_gai_entry *entry)
+{
+    vlc_list_remove(&entry->node);
+    gai_count--;
+    vlc_freeaddrinfo(entry->res);
+    free(entry);
+}
+
+static bool vlc_gai_match(const struct vlc_gai_entry *entry, const char *name,
+                          unsigned port, const struct addrinfo *hints)
+{
+    return entry->port == port && entry->family == hints->ai_family
+        && entry->socktype == hints->ai_socktype
+        && entry->protocol == hints->ai_protocol
+        && entry->flags == hints->ai_flags && strcmp(entry->name, name) == 0;
+}
+
+/* Looks a result up; returns false if none is cached */
+static bool vlc_gai_lookup(const char *name, unsigned port,
+                           const struct addrinfo *hints, struct addrinfo **res,
+                           int *restrict val)
+{
+    struct vlc_gai_entry *entry;
+    vlc_tick_t now = vlc_tick_now();
+    bool found = false;
+
+    vlc_mutex_lock(&gai_lock);
+    vlc_list_foreach(entry, &gai_cache, node)
+    {
+        if (entry->expiry <= now)
+        {
+            vlc_gai_remove(entry);
+            continue;
+        }
+
+        if (vlc_gai_match(entry, name, port, hints))
+        {
+            *val = entry->error;
+            if (*val == 0)
+                *val = vlc_gai_copy(entry->res, res);
+            found = true;
+
+            /* Move to the front */
+            vlc_list_remove(&entry->node);
+            vlc_list_prepend(&entry->node, &gai_cache);
+            break;
+        }
+    }
+    vlc_mutex_unlock(&gai_lock);
+    return found;
+}
+
+static void vlc_gai_store(const char *name, unsigned port,
+                          const struct addrinfo *hints, int error,
+                          const struct addrinfo *res)
+{
+    size_t namelen = strlen(name) + 1;
+    struct vlc_gai_entry *entry = malloc(sizeof (*entry) + namelen);
+    if (unlikely(entry == NULL))
+        return;
+
+    entry->port = port;
+    entry->family = hints->ai_family;
+    entry->socktype = hints->ai_socktype;
+    entry->protocol = hints->ai_protocol;
+    entry->flags = hints->ai_flags;
+    entry->error = error;
+    entry->res = NULL;
+    entry->expiry = vlc_tick_now()
+                    + (error ? GAI_CACHE_NEGATIVE_TTL : GAI_CACHE_TTL);
+    memcpy(entry->name, name, namelen);
+
+    if (error == 0 && vlc_gai_copy(res, &entry->res))
+    {
+        free(entry);
+        return;
+    }
+
+    struct vlc_gai_entry *old;
+
+    vlc_mutex_lock(&gai_lock);
+    vlc_list_foreach(old, &gai_cache, node)
+        if (vlc_gai_match(old, name, port, hints))
+            vlc_gai_remove(old); /* concurrent lookup */
+
+    if (gai_count >= GAI_CACHE_MAX)
+    {
+        old = vlc_list_last_entry_or_null(&gai_cache, struct vlc_gai_entry,
+                                          node);
+        vlc_gai_remove(old);
+    }
+
+    vlc_list_prepend(&entry->node, &gai_cache);
+    gai_count++;
+    vlc_mutex_unlock(&gai_lock);
+}
+
+int vlc_getaddrinfo_i11e(const char *name, unsigned port,
+                         const struct addrinfo *hints, struct addrinfo **res)
+{
+    /* Numeric and passive look-ups are quick and need no caching */
+    bool cacheable = name != NULL && name[0] != '\0' && hints != NULL
+                  && !(hints->ai_flags & (AI_NUMERICHOST | AI_PASSIVE));
+    int val;
+
+    if (cacheable && vlc_gai_lookup(name, port, hints, res, &val))
+        return val;
+
+    struct addrinfo *sysres;
+
+    val = vlc_resolve_i11e(name, port, hints, &sysres);
+    if (val == 0)
+    {
+        val = vlc_gai_copy(sysres, res);
+        if (cacheable && val == 0)
+            vlc_gai_store(name, port, hints, 0, sysres);
+        freeaddrinfo(sysres);
+    }
+    else
+    if (cacheable && val == EAI_NONAME)
+        vlc_gai_store(name, port, hints, val, NULL);
+
+    return val;
+}
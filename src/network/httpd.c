@@ -34,6 +34,7 @@
 #include <assert.h>
 
 #include <vlc_list.h>
+#include <vlc_interrupt.h>
 #include <vlc_network.h>
 #include <vlc_tls.h>
 #include <vlc_strings.h>
@@ -68,10 +69,35 @@
 #define HTTPD_CL_BUFSIZE 10000
 #endif
 
+/* Stream data is shared by all clients in segments of this size */
+#define HTTPD_SEGMENT_SIZE __MAX(65536, HTTPD_CL_BUFSIZE)
+
+/* Maximum number of threads serving the clients of a host */
+#define HTTPD_WORKERS_MAX 4
+
 static void httpd_ClientDestroy(httpd_client_t *cl);
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data);
+static int httpd_AppendData(httpd_stream_t *stream, const uint8_t *p_data,
+                            size_t i_data);
+
+/* each client is served by one of the threads of its host */
+struct httpd_worker
+{
+    httpd_host_t *host;
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+
+    size_t client_count;
+    struct vlc_list clients;
+
+    /* poll set, reused across iterations */
+    struct pollfd *ufd;
+    size_t ufd_size;
+
+    /* raised when streams have new data for the waiting clients */
+    vlc_interrupt_t *wakeup;
+    atomic_bool woken;
+};
 
-/* each host run in his own thread */
 struct httpd_host_t
 {
     struct vlc_object_t obj;
@@ -85,7 +111,12 @@ struct httpd_host_t
     unsigned     nfd;
     unsigned     port;
 
-    vlc_thread_t thread;
+    /* the first worker also accepts the connections */
+    struct httpd_worker *workers;
+    unsigned     worker_count;
+    unsigned     worker_next;
+
+    /* protects the URLs, and serializes their callbacks for new requests */
     vlc_mutex_t lock;
 
     /* all registered url (becarefull that 2 httpd_url_t could point at the same url)
@@ -94,14 +125,23 @@ struct httpd_host_t
      * */
     struct vlc_list urls;
 
-    size_t client_count;
-    struct vlc_list clients;
     unsigned timeout_sec;
 
     /* TLS data */
     vlc_tls_server_t *p_tls;
 };
 
+/* Segment of stream data, shared by the clients until they have sent it */
+typedef struct httpd_segment
+{
+    atomic_uint refs;
+    struct httpd_segment *next; /* protected by the stream lock */
+    int64_t pos;                /* stream position of data[0] */
+    size_t  len;                /* protected by the stream lock */
+    size_t  size;
+    uint8_t data[];
+} httpd_segment_t;
+
 
 struct httpd_url_t
 {
@@ -153,6 +193,21 @@ struct httpd_client_t
     int     i_buffer_size;
     int     i_buffer;
     uint8_t *p_buffer;
+    /* stream segment that p_buffer points into, if any */
+    httpd_segment_t *segment;
+
+    /* stream data to send as the answer body, instead of p_body */
+    httpd_segment_t *body_segment;
+    size_t           body_offset;
+
+    /* deadline of a deferred answer, VLC_TICK_INVALID if none */
+    vlc_tick_t defer_deadline;
+    bool       b_deferred;
+
+    /* data read ahead from the socket, but not parsed yet */
+    uint8_t recv_buf[4096];
+    size_t  recv_pos;
+    size_t  recv_len;
 
     /*
      * If waiting for a keyframe, this is the position (in bytes) of the
@@ -196,9 +251,9 @@ static const char *httpd_ReasonFromCode(unsigned i_code)
           { 202, "Accepted" },
           { 203, "Non-authoritative information" },
           { 204, "No content" },
-          { 205, "Reset content" },
-          { 206, "Partial content" },
-          { 250, "Low on storage space" },
+          { 205, "Reset content" },*/
+        { 206, "Partial content" },
+        /*{ 250, "Low on storage space" },
           { 300, "Multiple choices" },*/
         { 301, "Moved permanently" },
         /*{ 302, "Moved temporarily" },
@@ -221,9 +276,9 @@ static const char *httpd_ReasonFromCode(unsigned i_code)
           { 412, "Precondition failed" },
           { 413, "Request entity too large" },
           { 414, "Request-URI too large" },
-          { 415, "Unsupported media Type" },
-          { 416, "Requested range not satisfiable" },
-          { 417, "Expectation failed" },
+          { 415, "Unsupported media Type" },*/
+        { 416, "Requested range not satisfiable" },
+        /*{ 417, "Expectation failed" },
           { 451, "Parameter not understood" },
           { 452, "Conference not found" },
           { 453, "Not enough bandwidth" },*/
@@ -292,6 +347,17 @@ static size_t httpd_HtmlError (char **body, int code, const char *url)
     return (size_t)res;
 }
 
+/* Whether the connection is to be closed after answering the query */
+static bool httpd_QueryCloses(const httpd_message_t *query)
+{
+    /* HTTP/1.0 connections are never kept alive (see HTTPD_CLIENT_SEND_DONE) */
+    if (query->i_proto == HTTPD_PROTO_HTTP && query->i_version == 0)
+        return true;
+
+    const char *conn = httpd_MsgGet(query, "Connection");
+    return conn != NULL && strcasestr(conn, "close") != NULL;
+}
+
 
 /*****************************************************************************
  * High Level Functions: httpd_file_t
@@ -304,6 +370,53 @@ struct httpd_file_t
     char mime[1];
 };
 
+/* Cuts the answer body down to a single byte range (RFC 7233) */
+static void httpd_FileRange(httpd_message_t *answer, const char *range)
+{
+    unsigned long long first, last;
+    const unsigned long long total = answer->i_body;
+    char c;
+
+    /* Multiple ranges are not supported: send the whole body instead */
+    if (range == NULL || strncasecmp(range, "bytes=", 6)
+     || strchr(range, ',') != NULL)
+        return;
+
+    range += 6;
+    if (sscanf(range, " -%llu%c", &last, &c) == 1) {
+        /* suffix range: the last bytes */
+        if (last == 0)
+            goto unsatisfiable;
+        first = (last < total) ? total - last : 0;
+        last = total - 1;
+    } else if (sscanf(range, " %llu-%llu%c", &first, &last, &c) == 2) {
+        if (last < first)
+            return; /* syntactically invalid: ignored */
+        if (last >= total)
+            last = total - 1;
+    } else if (sscanf(range, " %llu-%c", &first, &c) == 1)
+        last = total - 1;
+    else
+        return;
+
+    if (first >= total)
+        goto unsatisfiable;
+
+    memmove(answer->p_body, answer->p_body + first, last - first + 1);
+    answer->i_body = last - first + 1;
+    answer->i_status = 206;
+    httpd_MsgAdd(answer, "Content-Range", "bytes %llu-%llu/%llu",
+                 first, last, total);
+    return;
+
+unsatisfiable:
+    free(answer->p_body);
+    answer->p_body = NULL;
+    answer->i_body = 0;
+    answer->i_status = 416;
+    httpd_MsgAdd(answer, "Content-Range", "bytes */%llu", total);
+}
+
 static int
 httpd_FileCallBack(httpd_callback_sys_t *p_sys, httpd_client_t *cl,
                     httpd_message_t *answer, const httpd_message_t *query)
@@ -344,9 +457,12 @@ httpd_FileCallBack(httpd_callback_sys_t *p_sys, httpd_client_t *cl,
 
     if (query->i_type == HTTPD_MSG_HEAD)
         free(p_body);
+    else if (query->i_type == HTTPD_MSG_GET)
+        httpd_FileRange(answer, httpd_MsgGet(query, "Range"));
+    httpd_MsgAdd(answer, "Accept-Ranges", "bytes");
 
     /* We respect client request */
-    if (httpd_MsgGet(&cl->query, "Connection") != NULL)
+    if (httpd_QueryCloses(&cl->query))
         httpd_MsgAdd(answer, "Connection", "close");
 
     httpd_MsgAdd(answer, "Content-Length", "%d", answer->i_body);
@@ -550,7 +666,7 @@ static int httpd_RedirectCallBack(httpd_callback_sys_t *p_sys,
 
     httpd_MsgAdd(answer, "Content-Length", "%d", answer->i_body);
 
-    if (httpd_MsgGet(&cl->query, "Connection") != NULL)
+    if (httpd_QueryCloses(&cl->query))
         httpd_MsgAdd(answer, "Connection", "close");
 
     return VLC_SUCCESS;
@@ -612,9 +728,10 @@ struct httpd_stream_t
     bool        b_has_keyframes;
     int64_t     i_last_keyframe_seen_pos;
 
-    /* circular buffer */
-    int         i_buffer_size;      /* buffer size, can't be reallocated smaller */
-    uint8_t     *p_buffer;          /* buffer */
+    /* segments shared by all clients, oldest first */
+    httpd_segment_t *first;
+    httpd_segment_t *last;
+    int64_t     i_buffer_size;      /* how much data to keep */
     int64_t     i_buffer_pos;       /* absolute position from beginning */
     int64_t     i_buffer_last_pos;  /* a new connection will start with that */
 
@@ -633,47 +750,56 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
         return VLC_SUCCESS;
 
     if (answer->i_body_offset > 0) {
-        int     i_pos;
+        vlc_mutex_lock(&stream->lock);
 
         if (answer->i_body_offset >= stream->i_buffer_pos)
-            return VLC_EGENERIC;    /* wait, no data available */
+            goto wait;  /* no data available */
 
         if (cl->i_keyframe_wait_to_pass >= 0) {
             if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass)
                 /* still waiting for the next keyframe */
-                return VLC_EGENERIC;
+                goto wait;
 
             /* seek to the new keyframe */
             answer->i_body_offset = stream->i_last_keyframe_seen_pos;
             cl->i_keyframe_wait_to_pass = -1;
         }
 
-        if (answer->i_body_offset + stream->i_buffer_size < stream->i_buffer_pos)
+        if (answer->i_body_offset < stream->first->pos)
             answer->i_body_offset = stream->i_buffer_last_pos; /* this client isn't fast enough */
+        if (answer->i_body_offset < stream->first->pos)
+            answer->i_body_offset = stream->first->pos;
+        if (answer->i_body_offset >= stream->i_buffer_pos)
+            goto wait;
 
-        i_pos   = answer->i_body_offset % stream->i_buffer_size;
-        int64_t i_write = stream->i_buffer_pos - answer->i_body_offset;
+        httpd_segment_t *seg = stream->first;
+        while (seg->pos + (int64_t)seg->len <= answer->i_body_offset)
+            seg = seg->next;
 
-        if (i_write > HTTPD_CL_BUFSIZE)
-            i_write = HTTPD_CL_BUFSIZE;
-        else if (i_write <= 0)
-            return VLC_EGENERIC;    /* wait, no data available */
+        /* Send the segment data in place: no copy per client */
+        size_t offset = answer->i_body_offset - seg->pos;
+        size_t i_write = seg->len - offset;
 
-        /* Don't go past the end of the circular buffer */
-        i_write = __MIN(i_write, stream->i_buffer_size - i_pos);
+        atomic_fetch_add_explicit(&seg->refs, 1, memory_order_relaxed);
+        vlc_mutex_unlock(&stream->lock);
 
         /* using HTTPD_MSG_ANSWER -> data available */
         answer->i_proto  = HTTPD_PROTO_HTTP;
         answer->i_version= 0;
         answer->i_type   = HTTPD_MSG_ANSWER;
 
+        assert(cl->body_segment == NULL);
+        cl->body_segment = seg;
+        cl->body_offset = offset;
         answer->i_body = i_write;
-        answer->p_body = xmalloc(i_write);
-        memcpy(answer->p_body, &stream->p_buffer[i_pos], i_write);
+        answer->p_body = NULL;
 
         answer->i_body_offset += i_write;
 
         return VLC_SUCCESS;
+wait:
+        vlc_mutex_unlock(&stream->lock);
+        return VLC_EGENERIC;
     } else {
         answer->i_proto  = HTTPD_PROTO_HTTP;
         answer->i_version= 0;
@@ -757,7 +883,6 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
         return NULL;
 
     stream->psz_mime = NULL;
-    stream->p_buffer = NULL;
 
     stream->url = httpd_UrlNew(host, psz_url, psz_user, psz_password);
     if (!stream->url)
@@ -773,12 +898,10 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
 
     stream->i_header = 0;
     stream->p_header = NULL;
+    stream->first = NULL;
+    stream->last = NULL;
     stream->i_buffer_size = 5000000;    /* 5 Mo per stream */
 
-    stream->p_buffer = malloc(stream->i_buffer_size);
-    if (stream->p_buffer == NULL)
-        goto error;
-
     /* We set to 1 to make life simpler
      * (this way i_body_offset can never be 0) */
     stream->i_buffer_pos = 1;
@@ -824,22 +947,66 @@ int httpd_StreamHeader(httpd_stream_t *stream, uint8_t *p_data, int i_data)
     return VLC_SUCCESS;
 }
 
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data)
+static void httpd_SegmentRelease(httpd_segment_t *seg)
 {
-    int i_pos = stream->i_buffer_pos % stream->i_buffer_size;
-    int i_count = i_data;
-    while (i_count > 0) {
-        int i_copy = __MIN(i_count, stream->i_buffer_size - i_pos);
+    if (atomic_fetch_sub_explicit(&seg->refs, 1, memory_order_acq_rel) == 1)
+        free(seg);
+}
 
-        /* Ok, we can't go past the end of our buffer */
-        memcpy(&stream->p_buffer[i_pos], p_data, i_copy);
+static int httpd_AppendData(httpd_stream_t *stream, const uint8_t *p_data,
+                            size_t i_data)
+{
+    while (i_data > 0) {
+        httpd_segment_t *seg = stream->last;
+
+        if (seg == NULL || seg->len == seg->size) {
+            seg = malloc(sizeof (*seg) + HTTPD_SEGMENT_SIZE);
+            if (unlikely(seg == NULL))
+                return VLC_ENOMEM;
+
+            atomic_init(&seg->refs, 1);
+            seg->next = NULL;
+            seg->pos = stream->i_buffer_pos;
+            seg->len = 0;
+            seg->size = HTTPD_SEGMENT_SIZE;
+
+            if (stream->last != NULL)
+                stream->last->next = seg;
+            else
+                stream->first = seg;
+            stream->last = seg;
+        }
 
-        i_pos = (i_pos + i_copy) % stream->i_buffer_size;
-        i_count -= i_copy;
-        p_data  += i_copy;
+        /* Clients only read below len, so the rest can be appended to */
+        size_t i_copy = __MIN(i_data, seg->size - seg->len);
+
+        memcpy(seg->data + seg->len, p_data, i_copy);
+        seg->len += i_copy;
+        stream->i_buffer_pos += i_copy;
+        p_data += i_copy;
+        i_data -= i_copy;
     }
 
-    stream->i_buffer_pos += i_data;
+    /* Forget the oldest data; slow clients may still hold its segments */
+    while (stream->first != stream->last
+        && stream->i_buffer_pos - stream->first->pos > stream->i_buffer_size) {
+        httpd_segment_t *seg = stream->first;
+
+        stream->first = seg->next;
+        httpd_SegmentRelease(seg);
+    }
+    return VLC_SUCCESS;
+}
+
+void httpd_HostWakeUp(httpd_host_t *host)
+{
+    for (unsigned i = 0; i < host->worker_count; i++) {
+        struct httpd_worker *worker = &host->workers[i];
+
+        if (!atomic_exchange_explicit(&worker->woken, true,
+                                      memory_order_acq_rel))
+            vlc_interrupt_raise(worker->wakeup);
+    }
 }
 
 int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
@@ -857,15 +1024,24 @@ int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
         stream->i_last_keyframe_seen_pos = stream->i_buffer_pos;
     }
 
-    httpd_AppendData(stream, p_block->p_buffer, p_block->i_buffer);
+    int val = httpd_AppendData(stream, p_block->p_buffer, p_block->i_buffer);
 
     vlc_mutex_unlock(&stream->lock);
-    return VLC_SUCCESS;
+
+    /* Waiting clients are not polled: tell them there is new data */
+    httpd_HostWakeUp(stream->url->host);
+    return val;
 }
 
 void httpd_StreamDelete(httpd_stream_t *stream)
 {
     httpd_UrlDelete(stream->url);
+    while (stream->first != NULL) {
+        httpd_segment_t *seg = stream->first;
+
+        stream->first = seg->next;
+        httpd_SegmentRelease(seg);
+    }
     for (size_t i = 0; i < stream->i_http_headers; i++) {
         free(stream->p_http_headers[i].name);
         free(stream->p_http_headers[i].value);
@@ -873,7 +1049,6 @@ void httpd_StreamDelete(httpd_stream_t *stream)
     free(stream->p_http_headers);
     free(stream->psz_mime);
     free(stream->p_header);
-    free(stream->p_buffer);
     free(stream);
 }
 
@@ -976,18 +1151,50 @@ static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
 
     host->port     = port;
     vlc_list_init(&host->urls);
-    host->client_count = 0;
-    vlc_list_init(&host->clients);
     host->timeout_sec = timeout_sec;
     host->p_tls    = p_tls;
 
-    /* create the thread */
-    if (vlc_clone(&host->thread, httpd_HostThread, host,
-                   VLC_THREAD_PRIORITY_LOW)) {
-        msg_Err(p_this, "cannot spawn http host thread");
+    unsigned count = vlc_GetCPUCount();
+    count = VLC_CLIP(count, 1, HTTPD_WORKERS_MAX);
+
+    host->workers = calloc(count, sizeof (*host->workers));
+    if (unlikely(host->workers == NULL))
         goto error;
+    host->worker_next = 0;
+
+    for (host->worker_count = 0; host->worker_count < count;
+         host->worker_count++) {
+        struct httpd_worker *worker = &host->workers[host->worker_count];
+
+        worker->wakeup = vlc_interrupt_create();
+        if (unlikely(worker->wakeup == NULL))
+            break;
+
+        worker->host = host;
+        vlc_mutex_init(&worker->lock);
+        worker->client_count = 0;
+        vlc_list_init(&worker->clients);
+        worker->ufd = NULL;
+        worker->ufd_size = 0;
+        atomic_init(&worker->woken, false);
     }
 
+    /* create the threads */
+    for (unsigned i = 0; i < host->worker_count; i++)
+        if (vlc_clone(&host->workers[i].thread, httpd_HostThread,
+                      &host->workers[i], VLC_THREAD_PRIORITY_LOW)) {
+            msg_Err(p_this, "cannot spawn http host thread");
+            atomic_store_explicit(&host->ref, 0, memory_order_relaxed);
+            while (i > 0) {
+                vlc_cancel(host->workers[--i].thread);
+                vlc_join(host->workers[i].thread, NULL);
+            }
+            goto error;
+        }
+
+    if (host->worker_count == 0)
+        goto error;
+
     /* now add it to httpd */
     vlc_list_append(&host->node, &httpd.hosts);
     vlc_mutex_unlock(&httpd.mutex);
@@ -998,6 +1205,16 @@ error:
     vlc_mutex_unlock(&httpd.mutex);
 
     if (host) {
+        if (host->workers != NULL)
+            for (unsigned i = 0; i < host->worker_count; i++) {
+                httpd_client_t *cl;
+
+                vlc_list_foreach(cl, &host->workers[i].clients, node)
+                    httpd_ClientDestroy(cl);
+                vlc_interrupt_destroy(host->workers[i].wakeup);
+                free(host->workers[i].ufd);
+            }
+        free(host->workers);
         net_ListenClose(host->fds);
         vlc_object_delete(host);
     }
@@ -1021,15 +1238,24 @@ void httpd_HostDelete(httpd_host_t *host)
     }
 
     vlc_list_remove(&host->node);
-    vlc_cancel(host->thread);
-    vlc_join(host->thread, NULL);
+    for (unsigned i = 0; i < host->worker_count; i++)
+        vlc_cancel(host->workers[i].thread);
 
-    msg_Dbg(host, "HTTP host removed");
+    for (unsigned i = 0; i < host->worker_count; i++) {
+        struct httpd_worker *worker = &host->workers[i];
+
+        vlc_join(worker->thread, NULL);
 
-    vlc_list_foreach(client, &host->clients, node) {
-        msg_Warn(host, "client still connected");
-        httpd_ClientDestroy(client);
+        vlc_list_foreach(client, &worker->clients, node) {
+            msg_Warn(host, "client still connected");
+            httpd_ClientDestroy(client);
+        }
+        vlc_interrupt_destroy(worker->wakeup);
+        free(worker->ufd);
     }
+    free(host->workers);
+
+    msg_Dbg(host, "HTTP host removed");
 
     assert(vlc_list_is_empty(&host->urls));
     vlc_tls_ServerDelete(host->p_tls);
@@ -1116,6 +1342,9 @@ void httpd_UrlDelete(httpd_url_t *url)
     httpd_host_t *host = url->host;
     httpd_client_t *client;
 
+    /* No callbacks must be in progress for this url */
+    for (unsigned i = 0; i < host->worker_count; i++)
+        vlc_mutex_lock(&host->workers[i].lock);
     vlc_mutex_lock(&host->lock);
     vlc_list_remove(&url->node);
 
@@ -1123,17 +1352,23 @@ void httpd_UrlDelete(httpd_url_t *url)
     free(url->psz_user);
     free(url->psz_password);
 
-    vlc_list_foreach(client, &host->clients, node) {
-        if (client->url != url)
-            continue;
+    for (unsigned i = 0; i < host->worker_count; i++) {
+        struct httpd_worker *worker = &host->workers[i];
+
+        vlc_list_foreach(client, &worker->clients, node) {
+            if (client->url != url)
+                continue;
 
-        /* TODO complete it */
-        msg_Warn(host, "force closing connections");
-        host->client_count--;
-        httpd_ClientDestroy(client);
+            /* TODO complete it */
+            msg_Warn(host, "force closing connections");
+            worker->client_count--;
+            httpd_ClientDestroy(client);
+        }
     }
     free(url);
     vlc_mutex_unlock(&host->lock);
+    for (unsigned i = 0; i < host->worker_count; i++)
+        vlc_mutex_unlock(&host->workers[i].lock);
 }
 
 static void httpd_MsgInit(httpd_message_t *msg)
@@ -1205,6 +1440,19 @@ void httpd_MsgAdd(httpd_message_t *msg, const char *name, const char *psz_value,
     msg->i_headers++;
 }
 
+bool httpd_ClientDefer(httpd_client_t *cl, vlc_tick_t timeout)
+{
+    vlc_tick_t now = vlc_tick_now();
+
+    if (cl->defer_deadline == VLC_TICK_INVALID)
+        cl->defer_deadline = now + timeout;
+    else if (cl->defer_deadline <= now)
+        return false;
+
+    cl->b_deferred = true;
+    return true;
+}
+
 char* httpd_ClientIP(const httpd_client_t *cl, char *ip, int *port)
 {
     return net_GetPeerAddress(vlc_tls_GetFD(cl->sock), ip, port) ? NULL : ip;
@@ -1215,6 +1463,35 @@ char* httpd_ServerIP(const httpd_client_t *cl, char *ip, int *port)
     return net_GetSockAddress(vlc_tls_GetFD(cl->sock), ip, port) ? NULL : ip;
 }
 
+/* Releases the data being sent or received */
+static void httpd_ClientFreeBuffer(httpd_client_t *cl)
+{
+    if (cl->segment != NULL) {
+        httpd_SegmentRelease(cl->segment);
+        cl->segment = NULL;
+    } else
+        free(cl->p_buffer);
+    cl->p_buffer = NULL;
+}
+
+/* Makes the answer body the data to send */
+static void httpd_ClientTakeBody(httpd_client_t *cl)
+{
+    httpd_ClientFreeBuffer(cl);
+
+    if (cl->body_segment != NULL) {
+        cl->segment = cl->body_segment;
+        cl->p_buffer = cl->segment->data + cl->body_offset;
+        cl->body_segment = NULL;
+    } else
+        cl->p_buffer = cl->answer.p_body;
+
+    cl->i_buffer_size = cl->answer.i_body;
+    cl->i_buffer = 0;
+    cl->answer.p_body = NULL;
+    cl->answer.i_body = 0;
+}
+
 static void httpd_ClientDestroy(httpd_client_t *cl)
 {
     vlc_list_remove(&cl->node);
@@ -1222,7 +1499,9 @@ static void httpd_ClientDestroy(httpd_client_t *cl)
     httpd_MsgClean(&cl->answer);
     httpd_MsgClean(&cl->query);
 
-    free(cl->p_buffer);
+    if (cl->body_segment != NULL)
+        httpd_SegmentRelease(cl->body_segment);
+    httpd_ClientFreeBuffer(cl);
     free(cl);
 }
 
@@ -1238,6 +1517,11 @@ static httpd_client_t *httpd_ClientNew(vlc_tls_t *sock)
     cl->i_buffer_size = HTTPD_CL_BUFSIZE;
     cl->i_buffer = 0;
     cl->p_buffer = xmalloc(cl->i_buffer_size);
+    cl->segment = NULL;
+    cl->body_segment = NULL;
+    cl->recv_pos = cl->recv_len = 0;
+    cl->defer_deadline = VLC_TICK_INVALID;
+    cl->b_deferred = false;
     cl->i_keyframe_wait_to_pass = -1;
     cl->b_stream_mode = false;
 
@@ -1250,8 +1534,29 @@ static
 ssize_t httpd_NetRecv (httpd_client_t *cl, uint8_t *p, size_t i_len)
 {
     vlc_tls_t *sock = cl->sock;
-    struct iovec iov = { .iov_base = p, .iov_len = i_len };
-    return sock->ops->readv(sock, &iov, 1);
+
+    if (cl->recv_pos == cl->recv_len) {
+        /* Headers are parsed byte per byte: read ahead into the client
+         * buffer rather than doing one system call per byte. */
+        struct iovec iov[2] = {
+            { .iov_base = p, .iov_len = i_len },
+            { .iov_base = cl->recv_buf, .iov_len = sizeof (cl->recv_buf) },
+        };
+        ssize_t val = sock->ops->readv(sock, iov, 2);
+
+        if (val <= (ssize_t)i_len)
+            return val;
+
+        cl->recv_pos = 0;
+        cl->recv_len = val - i_len;
+        return i_len;
+    }
+
+    size_t copy = __MIN(i_len, cl->recv_len - cl->recv_pos);
+
+    memcpy(p, cl->recv_buf + cl->recv_pos, copy);
+    cl->recv_pos += copy;
+    return copy;
 }
 
 static
@@ -1537,8 +1842,10 @@ static int httpd_ClientRecv(httpd_client_t *cl)
                     i_len = 0; /* drop */
                 }
                 break;
-            } else
-                cl->i_state = HTTPD_CLIENT_RECEIVE_DONE;
+            }
+            /* leave any pipelined request for later */
+            cl->i_state = HTTPD_CLIENT_RECEIVE_DONE;
+            break;
         }
     }
 
@@ -1585,9 +1892,9 @@ static int httpd_ClientSend(httpd_client_t *cl)
             i_size += strlen(cl->answer.p_headers[i].name) + 2 +
                       strlen(cl->answer.p_headers[i].value) + 2;
 
-        if (cl->i_buffer_size < i_size) {
+        if (cl->i_buffer_size < i_size || cl->segment != NULL) {
             cl->i_buffer_size = i_size;
-            free(cl->p_buffer);
+            httpd_ClientFreeBuffer(cl);
             cl->p_buffer = xmalloc(i_size);
         }
         p = (char *)cl->p_buffer;
@@ -1638,13 +1945,7 @@ static int httpd_ClientSend(httpd_client_t *cl)
 
         if (cl->answer.i_body > 0) {
             /* send the body data */
-            free(cl->p_buffer);
-            cl->p_buffer = cl->answer.p_body;
-            cl->i_buffer_size = cl->answer.i_body;
-            cl->i_buffer = 0;
-
-            cl->answer.i_body = 0;
-            cl->answer.p_body = NULL;
+            httpd_ClientTakeBody(cl);
         } else /* send finished */
             cl->i_state = HTTPD_CLIENT_SEND_DONE;
     }
@@ -1702,25 +2003,96 @@ auth_failed:
     return false;
 }
 
-static void httpdLoop(httpd_host_t *host)
+static void httpdAccept(httpd_host_t *host, int fd)
+{
+    fd = vlc_accept (fd, NULL, NULL, true);
+    if (fd == -1)
+        return;
+    setsockopt (fd, SOL_SOCKET, SO_REUSEADDR,
+            &(int){ 1 }, sizeof(int));
+
+    vlc_tls_t *sk = vlc_tls_SocketOpen(fd);
+    if (unlikely(sk == NULL))
+    {
+        vlc_close(fd);
+        return;
+    }
+
+    if (host->p_tls != NULL)
+    {
+        const char *alpn[] = { "http/1.1", NULL };
+        vlc_tls_t *tls;
+
+        tls = vlc_tls_ServerSessionCreate(host->p_tls, sk, alpn);
+        if (tls == NULL)
+        {
+            vlc_tls_SessionDelete(sk);
+            return;
+        }
+        sk = tls;
+    }
+
+    httpd_client_t *cl = httpd_ClientNew(sk);
+
+    if (unlikely(cl == NULL))
+    {
+        vlc_tls_Close(sk);
+        return;
+    }
+
+    if (host->p_tls != NULL)
+        cl->i_state = HTTPD_CLIENT_TLS_HS_OUT;
+
+    /* Spread the clients over the workers */
+    struct httpd_worker *worker = &host->workers[host->worker_next];
+
+    host->worker_next = (host->worker_next + 1) % host->worker_count;
+
+    vlc_mutex_lock(&worker->lock);
+    cl->i_timeout_date = vlc_tick_now() + VLC_TICK_FROM_SEC(host->timeout_sec);
+    worker->client_count++;
+    vlc_list_append(&cl->node, &worker->clients);
+    vlc_mutex_unlock(&worker->lock);
+
+    if (worker != &host->workers[0])
+        vlc_interrupt_raise(worker->wakeup);
+}
+
+static void httpdLoop(struct httpd_worker *worker)
 {
-    struct pollfd ufd[host->nfd + host->client_count];
+    httpd_host_t *host = worker->host;
+    /* only the first worker listens */
+    unsigned nlisten = (worker == &host->workers[0]) ? host->nfd : 0;
+
+    vlc_mutex_lock(&worker->lock);
+
+    if (worker->ufd_size < nlisten + worker->client_count) {
+        worker->ufd_size = nlisten + worker->client_count;
+        worker->ufd = xrealloc(worker->ufd,
+                               worker->ufd_size * sizeof (*worker->ufd));
+    }
+
+    struct pollfd *ufd = worker->ufd;
     unsigned nfd;
-    for (nfd = 0; nfd < host->nfd; nfd++) {
+    for (nfd = 0; nfd < nlisten; nfd++) {
         ufd[nfd].fd = host->fds[nfd];
         ufd[nfd].events = POLLIN;
         ufd[nfd].revents = 0;
     }
 
-    vlc_mutex_lock(&host->lock);
+    /* new stream data from now on will wake this worker up again */
+    atomic_store_explicit(&worker->woken, false, memory_order_release);
+
     /* add all socket that should be read/write and close dead connection */
     vlc_tick_t now = vlc_tick_now();
     int delay = -1;
     httpd_client_t *cl;
 
     int canc = vlc_savecancel();
-    vlc_list_foreach(cl, &host->clients, node) {
+    vlc_list_foreach(cl, &worker->clients, node) {
         int val = -1;
+        const bool waited = cl->i_state == HTTPD_CLIENT_WAITING
+                         || cl->b_deferred;
 
         switch (cl->i_state) {
             case HTTPD_CLIENT_RECEIVING:
@@ -1737,7 +2109,7 @@ static void httpdLoop(httpd_host_t *host)
 
         if (cl->i_state == HTTPD_CLIENT_DEAD
          || (host->timeout_sec > 0 && cl->i_timeout_date < now)) {
-            host->client_count--;
+            worker->client_count--;
             httpd_ClientDestroy(cl);
             continue;
         }
@@ -1748,7 +2120,7 @@ static void httpdLoop(httpd_host_t *host)
         }
 
         struct pollfd *pufd = ufd + nfd;
-        assert (pufd < ufd + ARRAY_SIZE (ufd));
+        assert (pufd < ufd + worker->ufd_size);
 
         pufd->events = pufd->revents = 0;
 
@@ -1813,7 +2185,7 @@ static void httpdLoop(httpd_host_t *host)
                             break;
                         }
 
-                        if (httpd_MsgGet(&cl->query, "Connection") != NULL)
+                        if (httpd_QueryCloses(&cl->query))
                             httpd_MsgAdd(answer, "Connection", "close");
 
                         cl->i_buffer = -1;  /* Force the creation of the answer in
@@ -1849,6 +2221,8 @@ static void httpdLoop(httpd_host_t *host)
                         bool b_auth_failed = false;
 
                         /* Search the url and trigger callbacks */
+                        cl->b_deferred = false;
+                        vlc_mutex_lock(&host->lock);
                         vlc_list_foreach(url, &host->urls, node) {
                             if (strcmp(url->psz_url, query->psz_url))
                                 continue;
@@ -1866,6 +2240,12 @@ static void httpdLoop(httpd_host_t *host)
                             if (url->catch[i_msg].cb(url->catch[i_msg].p_sys, cl, answer, query))
                                 continue;
 
+                            if (cl->b_deferred) {
+                                /* answer later, from the same callback */
+                                answer = NULL;
+                                break;
+                            }
+
                             if (answer->i_proto == HTTPD_PROTO_NONE)
                                 cl->i_buffer = cl->i_buffer_size; /* Raw answer from a CGI */
                             else
@@ -1876,6 +2256,17 @@ static void httpdLoop(httpd_host_t *host)
                             if (!cl->url)
                                 cl->url = url;
                         }
+                        vlc_mutex_unlock(&host->lock);
+
+                        if (cl->b_deferred) {
+                            int ms = 1 + MS_FROM_VLC_TICK(__MAX(cl->defer_deadline - now, 0));
+
+                            httpd_MsgClean(&cl->answer);
+                            if (delay < 0 || ms < delay)
+                                delay = ms;
+                            break;
+                        }
+                        cl->defer_deadline = VLC_TICK_INVALID;
 
                         if (answer) {
                             answer->i_proto  = query->i_proto;
@@ -1897,7 +2288,7 @@ static void httpdLoop(httpd_host_t *host)
                             cl->i_buffer = -1;  /* Force the creation of the answer in httpd_ClientSend */
                             httpd_MsgAdd(answer, "Content-Length", "%d", answer->i_body);
                             httpd_MsgAdd(answer, "Content-Type", "%s", "text/html");
-                            if (httpd_MsgGet(&cl->query, "Connection") != NULL)
+                            if (httpd_QueryCloses(&cl->query))
                                 httpd_MsgAdd(answer, "Connection", "close");
                         }
 
@@ -1930,7 +2321,7 @@ static void httpdLoop(httpd_host_t *host)
 
                         cl->i_buffer = 0;
                         cl->i_buffer_size = 1000;
-                        free(cl->p_buffer);
+                        httpd_ClientFreeBuffer(cl);
                         // Allocate an extra byte for the null terminating byte
                         cl->p_buffer = xmalloc(cl->i_buffer_size + 1);
                         cl->i_state = HTTPD_CLIENT_RECEIVING;
@@ -1942,8 +2333,7 @@ static void httpdLoop(httpd_host_t *host)
                     httpd_MsgClean(&cl->answer);
 
                     cl->answer.i_body_offset = i_offset;
-                    free(cl->p_buffer);
-                    cl->p_buffer = NULL;
+                    httpd_ClientFreeBuffer(cl);
                     cl->i_buffer = 0;
                     cl->i_buffer_size = 0;
 
@@ -1962,11 +2352,7 @@ static void httpdLoop(httpd_host_t *host)
                         &cl->answer, &cl->query);
                 if (cl->answer.i_type != HTTPD_MSG_NONE) {
                     /* we have new data, so re-enter send mode */
-                    cl->i_buffer      = 0;
-                    cl->p_buffer      = cl->answer.p_body;
-                    cl->i_buffer_size = cl->answer.i_body;
-                    cl->answer.p_body = NULL;
-                    cl->answer.i_body = 0;
+                    httpd_ClientTakeBody(cl);
                     cl->i_state = HTTPD_CLIENT_SENDING;
                 }
             }
@@ -1976,89 +2362,46 @@ static void httpdLoop(httpd_host_t *host)
 
         if (pufd->events != 0)
             nfd++;
-        /* we will wait 20ms (not too big) if HTTPD_CLIENT_WAITING */
-        else if (delay != 0)
-            delay = 20;
+        /* clients still waiting for stream data are woken up by
+         * httpd_StreamSend(), deferred answers by httpd_HostWakeUp();
+         * any other state change is handled at once */
+        else if (!waited || (cl->i_state != HTTPD_CLIENT_WAITING
+                          && !cl->b_deferred))
+            delay = 0;
     }
-    vlc_mutex_unlock(&host->lock);
+    vlc_mutex_unlock(&worker->lock);
     vlc_restorecancel(canc);
 
-    while (poll(ufd, nfd, delay) < 0)
-    {
+    vlc_interrupt_t *oldctx = vlc_interrupt_set(worker->wakeup);
+    int val = vlc_poll_i11e(ufd, nfd, delay);
+    vlc_interrupt_set(oldctx);
+
+    if (val < 0) {
         if (errno != EINTR)
             msg_Err(host, "polling error: %s", vlc_strerror_c(errno));
+        return;
     }
 
     canc = vlc_savecancel();
-    vlc_mutex_lock(&host->lock);
-
-    /* Handle client sockets */
-    now = vlc_tick_now();
-    nfd = host->nfd;
 
     /* Handle server sockets (accept new connections) */
-    for (nfd = 0; nfd < host->nfd; nfd++) {
-        int fd = ufd[nfd].fd;
-
-        assert (fd == host->fds[nfd]);
+    for (nfd = 0; nfd < nlisten; nfd++) {
+        assert (ufd[nfd].fd == host->fds[nfd]);
 
-        if (ufd[nfd].revents == 0)
-            continue;
-
-        /* */
-        fd = vlc_accept (fd, NULL, NULL, true);
-        if (fd == -1)
-            continue;
-        setsockopt (fd, SOL_SOCKET, SO_REUSEADDR,
-                &(int){ 1 }, sizeof(int));
-
-        vlc_tls_t *sk = vlc_tls_SocketOpen(fd);
-        if (unlikely(sk == NULL))
-        {
-            vlc_close(fd);
-            continue;
-        }
-
-        if (host->p_tls != NULL)
-        {
-            const char *alpn[] = { "http/1.1", NULL };
-            vlc_tls_t *tls;
-
-            tls = vlc_tls_ServerSessionCreate(host->p_tls, sk, alpn);
-            if (tls == NULL)
-            {
-                vlc_tls_SessionDelete(sk);
-                continue;
-            }
-            sk = tls;
-        }
-
-        cl = httpd_ClientNew(sk);
-
-        if (unlikely(cl == NULL))
-        {
-            vlc_tls_Close(sk);
-            continue;
-        }
-
-        if (host->p_tls != NULL)
-            cl->i_state = HTTPD_CLIENT_TLS_HS_OUT;
-
-        cl->i_timeout_date = now + VLC_TICK_FROM_SEC(host->timeout_sec);
-        host->client_count++;
-        vlc_list_append(&cl->node, &host->clients);
+        if (ufd[nfd].revents != 0)
+            httpdAccept(host, ufd[nfd].fd);
     }
 
-    vlc_mutex_unlock(&host->lock);
     vlc_restorecancel(canc);
 }
 
 static void* httpd_HostThread(void *data)
 {
-    httpd_host_t *host = data;
+    struct httpd_worker *worker = data;
+    httpd_host_t *host = worker->host;
 
     while (atomic_load_explicit(&host->ref, memory_order_relaxed) > 0)
-        httpdLoop(host);
+        httpdLoop(worker);
     return NULL;
 }
 
@@ -116,6 +116,58 @@ int net_Socket (vlc_object_t *p_this, int family, int socktype,
     return fd;
 }
 
+/* RFC 8305 "Connection Attempt Delay" */
+#define NET_CONNECT_DELAY VLC_TICK_FROM_MS(250)
+
+/**
+ * Sorts the addresses so that address families alternate, keeping the order
+ * of preference from getaddrinfo() within each family (RFC 8305 §4).
+ */
+static void net_SortAddresses(const struct addrinfo **tab,
+                              const struct addrinfo *res, size_t count)
+{
+    const int first = res->ai_family;
+    const struct addrinfo *a = res, *b = res;
+    size_t i = 0;
+
+    while (i < count)
+    {
+        while (a != NULL && a->ai_family != first)
+            a = a->ai_next;
+        if (a != NULL)
+        {
+            tab[i++] = a;
+            a = a->ai_next;
+        }
+
+        while (b != NULL && b->ai_family == first)
+            b = b->ai_next;
+        if (b != NULL)
+        {
+            tab[i++] = b;
+            b = b->ai_next;
+        }
+    }
+}
+
+/**
+ * Checks the outcome of a pending connection.
+ */
+static int net_ConnectResult(vlc_object_t *obj, int fd)
+{
+    int val;
+
+    /* There is NO WAY around checking SO_ERROR.
+     * Don't ifdef it out!!! */
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &val,
+                   &(socklen_t){ sizeof (val) }) || val)
+    {
+        msg_Err(obj, "connection failed: %s", vlc_strerror_c(val));
+        return -1;
+    }
+    return 0;
+}
+
 int (net_Connect)(vlc_object_t *obj, const char *host, int serv,
                   int type, int proto)
 {
@@ -136,78 +188,115 @@ int (net_Connect)(vlc_object_t *obj, const char *host, int serv,
 
     vlc_tick_t timeout = VLC_TICK_FROM_MS(var_InheritInteger(obj,
                                                              "ipv4-timeout"));
+    size_t count = 0;
 
-    for (struct addrinfo *ptr = res; ptr != NULL; ptr = ptr->ai_next)
+    for (const struct addrinfo *ptr = res; ptr != NULL; ptr = ptr->ai_next)
+        count++;
+
+    /* Happy Eyeballs: rather than waiting for each address to time out in
+     * turn, a new connection attempt starts if the previous ones are not
+     * established after a short delay. The first established one wins. */
+    const struct addrinfo *tab[count];
+    struct pollfd ufd[count];
+    vlc_tick_t deadlines[count];
+    size_t started = 0, pending = 0;
+    vlc_tick_t next = VLC_TICK_0;
+
+    net_SortAddresses(tab, res, count);
+
+    while (ret == -1 && (started < count || pending > 0) && !vlc_killed())
     {
-        int fd = net_Socket(obj, ptr->ai_family,
-                            ptr->ai_socktype, ptr->ai_protocol);
-        if (fd == -1)
-        {
-            msg_Dbg(obj, "socket error: %s", vlc_strerror_c(net_errno));
-            continue;
-        }
+        vlc_tick_t now = vlc_tick_now();
 
-        if (connect(fd, ptr->ai_addr, ptr->ai_addrlen))
+        if (started < count && (pending == 0 || now >= next))
         {
+            const struct addrinfo *ptr = tab[started++];
+            int fd = net_Socket(obj, ptr->ai_family,
+                                ptr->ai_socktype, ptr->ai_protocol);
+            if (fd == -1)
+            {
+                msg_Dbg(obj, "socket error: %s", vlc_strerror_c(net_errno));
+                continue;
+            }
+
+            if (connect(fd, ptr->ai_addr, ptr->ai_addrlen) == 0)
+            {
+                ret = fd;
+                break;
+            }
+
             if (net_errno != EINPROGRESS && errno != EINTR)
             {
                 msg_Err(obj, "connection failed: %s",
                         vlc_strerror_c(net_errno));
-                goto next_ai;
+                net_Close(fd);
+                continue;
             }
 
-            struct pollfd ufd;
-            vlc_tick_t deadline = VLC_TICK_INVALID;
+            ufd[pending].fd = fd;
+            ufd[pending].events = POLLOUT;
+            deadlines[pending] = now + timeout;
+            pending++;
+            next = now + NET_CONNECT_DELAY;
+            continue;
+        }
+
+        vlc_tick_t deadline = (started < count) ? next : VLC_TICK_MAX;
 
-            ufd.fd = fd;
-            ufd.events = POLLOUT;
-            deadline = vlc_tick_now() + timeout;
+        for (size_t i = 0; i < pending; i++)
+            if (deadlines[i] < deadline)
+                deadline = deadlines[i];
+        if (now > deadline)
+            now = deadline;
 
-            do
-            {
-                vlc_tick_t now = vlc_tick_now();
+        val = vlc_poll_i11e(ufd, pending, MS_FROM_VLC_TICK(deadline - now));
+        if (val == -1)
+        {
+            if (errno == EINTR)
+                continue;
 
-                if (vlc_killed())
-                    goto next_ai;
+            msg_Err(obj, "polling error: %s", vlc_strerror_c(net_errno));
+            break;
+        }
 
-                if (now > deadline)
-                    now = deadline;
+        now = vlc_tick_now();
 
-                val = vlc_poll_i11e(&ufd, 1, MS_FROM_VLC_TICK(deadline - now));
-            }
-            while (val == -1 && errno == EINTR);
+        for (size_t i = pending; i-- > 0;)
+        {
+            int fd = ufd[i].fd;
 
-            switch (val)
+            if (ufd[i].revents)
             {
-                 case -1: /* error */
-                     msg_Err(obj, "polling error: %s",
-                             vlc_strerror_c(net_errno));
-                     goto next_ai;
-
-                 case 0: /* timeout */
-                     msg_Warn(obj, "connection timed out");
-                     goto next_ai;
+                if (ret == -1 && net_ConnectResult(obj, fd) == 0)
+                {
+                    ret = fd;
+                    fd = -1;
+                }
             }
+            else if (deadlines[i] <= now)
+                msg_Warn(obj, "connection timed out");
+            else
+                continue;
 
-            /* There is NO WAY around checking SO_ERROR.
-             * Don't ifdef it out!!! */
-            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &val,
-                           &(socklen_t){ sizeof (val) }) || val)
-            {
-                msg_Err(obj, "connection failed: %s", vlc_strerror_c(val));
-                goto next_ai;
+            if (fd != -1)
+            {   /* Failed attempt: try the next address right away */
+                net_Close(fd);
+                next = now;
             }
+            pending--;
+            ufd[i] = ufd[pending];
+            deadlines[i] = deadlines[pending];
         }
+    }
 
-        msg_Dbg(obj, "connection succeeded (socket = %d)", fd);
-        ret = fd; /* success! */
-        break;
+    /* Abort the slower attempts */
+    for (size_t i = 0; i < pending; i++)
+        net_Close(ufd[i].fd);
 
-next_ai: /* failure */
-        net_Close(fd);
-    }
+    if (ret != -1)
+        msg_Dbg(obj, "connection succeeded (socket = %d)", ret);
 
-    freeaddrinfo(res);
+    vlc_freeaddrinfo(res);
     return ret;
 }
 
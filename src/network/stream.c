@@ -431,39 +431,18 @@ vlc_tls_t *vlc_tls_SocketOpenAddrInfo(const struct addrinfo *restrict info,
 vlc_tls_t *vlc_tls_SocketOpenTCP(vlc_object_t *obj, const char *name,
                                  unsigned port)
 {
-    struct addrinfo hints =
-    {
-        .ai_socktype = SOCK_STREAM,
-        .ai_protocol = IPPROTO_TCP,
-    }, *res;
-
     assert(name != NULL);
-    msg_Dbg(obj, "resolving %s ...", name);
-
-    int val = vlc_getaddrinfo_i11e(name, port, &hints, &res);
-    if (val != 0)
-    {   /* TODO: C locale for gai_strerror() */
-        msg_Err(obj, "cannot resolve %s port %u: %s", name, port,
-                gai_strerror(val));
-        return NULL;
-    }
-
     msg_Dbg(obj, "connecting to %s port %u ...", name, port);
 
-    /* TODO: implement RFC8305 */
-    for (const struct addrinfo *p = res; p != NULL; p = p->ai_next)
-    {
-        vlc_tls_t *tls = vlc_tls_SocketOpenAddrInfo(p, false);
-        if (tls == NULL)
-        {
-            msg_Err(obj, "connection error: %s", vlc_strerror_c(errno));
-            continue;
-        }
+    /* Races the addresses of the host (RFC 8305) */
+    int fd = net_Connect(obj, name, port, SOCK_STREAM, IPPROTO_TCP);
+    if (fd == -1)
+        return NULL;
 
-        freeaddrinfo(res);
-        return tls;
-    }
+    setsockopt(fd, SOL_TCP, TCP_NODELAY, &(int){ 1 }, sizeof (int));
 
-    freeaddrinfo(res);
-    return NULL;
+    vlc_tls_t *sock = vlc_tls_SocketOpen(fd);
+    if (unlikely(sock == NULL))
+        net_Close(fd);
+    return sock;
 }
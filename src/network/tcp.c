@@ -179,7 +179,7 @@ static int SocksHandshakeTCP( vlc_object_t *p_obj,
         SetWBE( &buffer[2], i_port );   /* Port */
         memcpy(&buffer[4], ((unsigned char *)res->ai_addr) /* Address */
                            + offsetof (struct sockaddr_in, sin_addr), 4);
-        freeaddrinfo (res);
+        vlc_freeaddrinfo (res);
 
         buffer[8] = 0;                  /* Empty user id */
 
@@ -43,6 +43,7 @@
 #include <vlc_tls.h>
 #include <vlc_modules.h>
 #include <vlc_interrupt.h>
+#include <vlc_list.h>
 
 /*** TLS credentials ***/
 
@@ -130,6 +131,168 @@ void vlc_tls_ClientDelete(vlc_tls_client_t *crd)
 }
 
 
+/*** TLS session cache ***/
+
+#define TLS_CACHE_MAX 32
+#define TLS_CACHE_LIFETIME VLC_TICK_FROM_SEC(3600)
+
+struct vlc_tls_cache_entry
+{
+    struct vlc_list node;
+    const void *ops; /**< Plugin that created the data */
+    char *host;
+    char *service;
+    vlc_tick_t expiry;
+    bool once;
+    size_t length;
+    unsigned char data[];
+};
+
+struct vlc_tls_cache
+{
+    vlc_mutex_t lock;
+    struct vlc_list entries; /**< Most recent first */
+    unsigned count;
+};
+
+struct vlc_tls_cache *vlc_tls_CacheCreate(void)
+{
+    struct vlc_tls_cache *cache = malloc(sizeof (*cache));
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    vlc_mutex_init(&cache->lock);
+    vlc_list_init(&cache->entries);
+    cache->count = 0;
+    return cache;
+}
+
+static void vlc_tls_CacheRemove(struct vlc_tls_cache *cache,
+                                struct vlc_tls_cache_entry *entry)
+{
+    vlc_list_remove(&entry->node);
+    cache->count--;
+    free(entry->service);
+    free(entry->host);
+    free(entry);
+}
+
+void vlc_tls_CacheDestroy(struct vlc_tls_cache *cache)
+{
+    struct vlc_tls_cache_entry *entry;
+
+    if (cache == NULL)
+        return;
+
+    vlc_list_foreach(entry, &cache->entries, node)
+        vlc_tls_CacheRemove(cache, entry);
+    assert(cache->count == 0);
+    free(cache);
+}
+
+static bool vlc_tls_CacheMatch(const struct vlc_tls_cache_entry *entry,
+                               const vlc_tls_client_t *crd, const char *host,
+                               const char *service)
+{
+    if (entry->ops != crd->ops || strcmp(entry->host, host) != 0)
+        return false;
+    if (entry->service == NULL || service == NULL)
+        return entry->service == service;
+    return strcmp(entry->service, service) == 0;
+}
+
+void vlc_tls_SessionSave(vlc_tls_client_t *crd, const char *host,
+                         const char *service, const void *data,
+                         size_t length, bool once)
+{
+    struct vlc_tls_cache *cache =
+        libvlc_priv(vlc_object_instance(crd))->tls_cache;
+
+    if (cache == NULL || host == NULL || length == 0)
+        return;
+
+    struct vlc_tls_cache_entry *entry = malloc(sizeof (*entry) + length);
+    if (unlikely(entry == NULL))
+        return;
+
+    entry->ops = crd->ops;
+    entry->host = strdup(host);
+    entry->service = (service != NULL) ? strdup(service) : NULL;
+    if (unlikely(entry->host == NULL
+              || (service != NULL && entry->service == NULL)))
+    {
+        free(entry->service);
+        free(entry->host);
+        free(entry);
+        return;
+    }
+    entry->expiry = vlc_tick_now() + TLS_CACHE_LIFETIME;
+    entry->once = once;
+    entry->length = length;
+    memcpy(entry->data, data, length);
+
+    struct vlc_tls_cache_entry *old;
+
+    vlc_mutex_lock(&cache->lock);
+    if (!once) /* Reusable data supersedes any other for the same server */
+        vlc_list_foreach(old, &cache->entries, node)
+            if (vlc_tls_CacheMatch(old, crd, host, service))
+                vlc_tls_CacheRemove(cache, old);
+
+    if (cache->count >= TLS_CACHE_MAX)
+    {
+        old = vlc_list_last_entry_or_null(&cache->entries,
+                                          struct vlc_tls_cache_entry, node);
+        vlc_tls_CacheRemove(cache, old);
+    }
+
+    vlc_list_prepend(&entry->node, &cache->entries);
+    cache->count++;
+    vlc_mutex_unlock(&cache->lock);
+}
+
+void *vlc_tls_SessionLoad(vlc_tls_client_t *crd, const char *host,
+                          const char *service, size_t *restrict length)
+{
+    struct vlc_tls_cache *cache =
+        libvlc_priv(vlc_object_instance(crd))->tls_cache;
+    struct vlc_tls_cache_entry *entry;
+    void *data = NULL;
+
+    if (cache == NULL || host == NULL)
+        return NULL;
+
+    vlc_tick_t now = vlc_tick_now();
+
+    vlc_mutex_lock(&cache->lock);
+    vlc_list_foreach(entry, &cache->entries, node)
+    {
+        if (entry->expiry <= now)
+        {
+            vlc_tls_CacheRemove(cache, entry);
+            continue;
+        }
+
+        if (!vlc_tls_CacheMatch(entry, crd, host, service))
+            continue;
+
+        data = malloc(entry->length);
+        if (likely(data != NULL))
+        {
+            memcpy(data, entry->data, entry->length);
+            *length = entry->length;
+        }
+
+        /* Single-use tickets must not be offered twice */
+        if (entry->once)
+            vlc_tls_CacheRemove(cache, entry);
+        break;
+    }
+    vlc_mutex_unlock(&cache->lock);
+    return data;
+}
+
+
 /*** TLS  session ***/
 
 void vlc_tls_SessionDelete (vlc_tls_t *session)
@@ -247,7 +410,7 @@ vlc_tls_t *vlc_tls_SocketOpenTLS(vlc_tls_client_t *creds, const char *name,
                                                      alpn, alp);
         if (tls != NULL)
         {   /* Success! */
-            freeaddrinfo(res);
+            vlc_freeaddrinfo(res);
             return tls;
         }
 
@@ -256,6 +419,6 @@ vlc_tls_t *vlc_tls_SocketOpenTLS(vlc_tls_client_t *creds, const char *name,
     }
 
     /* Failure! */
-    freeaddrinfo(res);
+    vlc_freeaddrinfo(res);
     return NULL;
 }
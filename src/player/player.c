@@ -1916,6 +1916,13 @@ vlc_player_Delete(vlc_player_t *player)
         vlc_http_cookies_destroy(cookies);
     }
 
+    vlc_http_pool_t *pool = var_GetAddress(player, "http-pool");
+    if (pool != NULL)
+    {
+        var_Destroy(player, "http-pool");
+        vlc_http_pool_destroy(pool);
+    }
+
     assert(!vlc_mutex_held(&player->lock));
 
     vlc_object_delete(player);
@@ -2001,6 +2008,15 @@ vlc_player_New(vlc_object_t *parent, enum vlc_player_lock_type lock_type,
         VAR_CREATE("http-cookies", VLC_VAR_ADDRESS);
         var_SetChecked(player, "http-cookies", VLC_VAR_ADDRESS, cookies);
     }
+
+    /* Initialize the shared pool of idle HTTP connections */
+    vlc_value_t pool;
+    pool.p_address = vlc_http_pool_new(VLC_OBJECT(player));
+    if (likely(pool.p_address != NULL))
+    {
+        VAR_CREATE("http-pool", VLC_VAR_ADDRESS);
+        var_SetChecked(player, "http-pool", VLC_VAR_ADDRESS, pool);
+    }
 #undef VAR_CREATE
 
     player->resource = input_resource_New(VLC_OBJECT(player));
@@ -2031,6 +2047,7 @@ error:
     var_DelCallback(player, "corks", vlc_player_CorkCallback, player);
     if (player->resource)
         input_resource_Release(player->resource);
+    vlc_http_pool_destroy(var_GetAddress(player, "http-pool"));
 
     vlc_object_delete(player);
     return NULL;
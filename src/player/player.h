@@ -189,6 +189,8 @@ struct vlc_player_timer_source
     struct vlc_list listeners; /* list of struct vlc_player_timer_id */
     vlc_es_id_t *es; /* weak reference */
     struct vlc_player_timer_point point;
+    /* First date at which a listener is due, VLC_TICK_INVALID if unknown */
+    vlc_tick_t next_update_date;
     union
     {
         struct {
@@ -210,6 +212,17 @@ enum vlc_player_timer_state
     VLC_PLAYER_TIMER_STATE_DISCONTINUITY,
 };
 
+/* Copy of a timer point that can be read without locking (seqlock) */
+struct vlc_player_timer_snapshot
+{
+    atomic_uint seq; /* odd while being written */
+    _Atomic vlc_tick_t ts;
+    _Atomic vlc_tick_t length;
+    _Atomic vlc_tick_t system_date;
+    _Atomic uint64_t rate; /* representation of the double */
+    _Atomic uint32_t position; /* representation of the float */
+};
+
 struct vlc_player_timer
 {
     vlc_mutex_t lock;
@@ -225,6 +238,9 @@ struct vlc_player_timer
     struct vlc_player_timer_source sources[VLC_PLAYER_TIMER_TYPE_COUNT];
 #define best_source sources[VLC_PLAYER_TIMER_TYPE_BEST]
 #define smpte_source sources[VLC_PLAYER_TIMER_TYPE_SMPTE]
+
+    /* Point of the best source, written with the lock held */
+    struct vlc_player_timer_snapshot best_snapshot;
 };
 
 struct vlc_player_t
@@ -23,9 +23,67 @@
 #endif
 
 #include <limits.h>
+#include <string.h>
 
 #include "player.h"
 
+static void
+vlc_player_timer_snapshot_Store(struct vlc_player_timer_snapshot *snap,
+                                const struct vlc_player_timer_point *point)
+{
+    /* Only one writer, protected by the timer lock */
+    unsigned seq = atomic_load_explicit(&snap->seq, memory_order_relaxed);
+    uint64_t rate;
+    uint32_t position;
+
+    static_assert(sizeof (rate) == sizeof (point->rate), "Wrong double size");
+    static_assert(sizeof (position) == sizeof (point->position),
+                  "Wrong float size");
+    memcpy(&rate, &point->rate, sizeof (rate));
+    memcpy(&position, &point->position, sizeof (position));
+
+    atomic_store_explicit(&snap->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&snap->ts, point->ts, memory_order_relaxed);
+    atomic_store_explicit(&snap->length, point->length, memory_order_relaxed);
+    atomic_store_explicit(&snap->system_date, point->system_date,
+                          memory_order_relaxed);
+    atomic_store_explicit(&snap->rate, rate, memory_order_relaxed);
+    atomic_store_explicit(&snap->position, position, memory_order_relaxed);
+
+    atomic_store_explicit(&snap->seq, seq + 2, memory_order_release);
+}
+
+static void
+vlc_player_timer_snapshot_Load(struct vlc_player_timer_snapshot *snap,
+                               struct vlc_player_timer_point *point)
+{
+    unsigned seq;
+    uint64_t rate;
+    uint32_t position;
+
+    do
+    {
+        seq = atomic_load_explicit(&snap->seq, memory_order_acquire);
+
+        point->ts = atomic_load_explicit(&snap->ts, memory_order_relaxed);
+        point->length = atomic_load_explicit(&snap->length,
+                                             memory_order_relaxed);
+        point->system_date = atomic_load_explicit(&snap->system_date,
+                                                  memory_order_relaxed);
+        rate = atomic_load_explicit(&snap->rate, memory_order_relaxed);
+        position = atomic_load_explicit(&snap->position, memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+    }
+    while ((seq & 1)
+        || seq != atomic_load_explicit(&snap->seq, memory_order_relaxed));
+
+    memcpy(&point->rate, &rate, sizeof (rate));
+    memcpy(&point->position, &position, sizeof (position));
+}
+
 void
 vlc_player_ResetTimer(vlc_player_t *player)
 {
@@ -50,6 +108,14 @@ vlc_player_SendTimerSourceUpdates(vlc_player_t *player,
     (void) player;
     vlc_player_timer_id *timer;
 
+    /* Nothing to do until the first listener is due */
+    if (!force_update && point->system_date != VLC_TICK_MAX
+     && source->next_update_date != VLC_TICK_INVALID
+     && point->system_date < source->next_update_date)
+        return;
+
+    vlc_tick_t next_update_date = VLC_TICK_MAX;
+
     vlc_list_foreach(timer, &source->listeners, node)
     {
         /* Respect refresh delay of the timer */
@@ -62,7 +128,15 @@ vlc_player_SendTimerSourceUpdates(vlc_player_t *player,
             timer->last_update_date = point->system_date == VLC_TICK_MAX ?
                                       VLC_TICK_INVALID : point->system_date;
         }
+
+        if (timer->period == VLC_TICK_INVALID
+         || timer->last_update_date == VLC_TICK_INVALID)
+            next_update_date = VLC_TICK_INVALID;
+        else if (next_update_date != VLC_TICK_INVALID
+              && timer->last_update_date + timer->period < next_update_date)
+            next_update_date = timer->last_update_date + timer->period;
     }
+    source->next_update_date = next_update_date;
 }
 
 static void
@@ -198,6 +272,8 @@ vlc_player_UpdateTimerState(vlc_player_t *player, vlc_es_id_t *es_source,
                     notify = bestsource->es == es_source;
                 source->point.system_date = VLC_TICK_INVALID;
             }
+            vlc_player_timer_snapshot_Store(&player->timer.best_snapshot,
+                                            &bestsource->point);
             break;
 
         case VLC_PLAYER_TIMER_STATE_PAUSED:
@@ -224,6 +300,7 @@ vlc_player_UpdateTimerState(vlc_player_t *player, vlc_es_id_t *es_source,
         timer->last_update_date = VLC_TICK_INVALID;
         timer->cbs->on_discontinuity(system_date, timer->data);
     }
+    bestsource->next_update_date = VLC_TICK_INVALID;
 
     vlc_mutex_unlock(&player->timer.lock);
 }
@@ -339,6 +416,8 @@ vlc_player_UpdateTimer(vlc_player_t *player, vlc_es_id_t *es_source,
         {
             vlc_player_UpdateTimerSource(player, source, point->rate, point->ts,
                                          system_date);
+            vlc_player_timer_snapshot_Store(&player->timer.best_snapshot,
+                                            &source->point);
 
             if (!vlc_list_is_empty(&source->listeners))
                 vlc_player_SendTimerSourceUpdates(player, source, force_update,
@@ -401,18 +480,14 @@ int
 vlc_player_GetTimerPoint(vlc_player_t *player, vlc_tick_t system_now,
                          vlc_tick_t *out_ts, float *out_pos)
 {
-    vlc_mutex_lock(&player->timer.lock);
-    if (player->timer.best_source.point.system_date == VLC_TICK_INVALID)
-    {
-        vlc_mutex_unlock(&player->timer.lock);
-        return VLC_EGENERIC;
-    }
-    int ret =
-        vlc_player_timer_point_Interpolate(&player->timer.best_source.point,
-                                           system_now, out_ts, out_pos);
+    /* Polled by the interfaces: do not contend with the timer updates */
+    struct vlc_player_timer_point point;
 
-    vlc_mutex_unlock(&player->timer.lock);
-    return ret;
+    vlc_player_timer_snapshot_Load(&player->timer.best_snapshot, &point);
+    if (point.system_date == VLC_TICK_INVALID)
+        return VLC_EGENERIC;
+    return vlc_player_timer_point_Interpolate(&point, system_now,
+                                              out_ts, out_pos);
 }
 
 vlc_player_timer_id *
@@ -432,6 +507,7 @@ vlc_player_AddTimer(vlc_player_t *player, vlc_tick_t min_period,
 
     vlc_mutex_lock(&player->timer.lock);
     vlc_list_append(&timer->node, &player->timer.best_source.listeners);
+    player->timer.best_source.next_update_date = VLC_TICK_INVALID;
     vlc_mutex_unlock(&player->timer.lock);
 
     return timer;
@@ -538,8 +614,15 @@ vlc_player_InitTimer(vlc_player_t *player)
     {
         vlc_list_init(&player->timer.sources[i].listeners);
         player->timer.sources[i].point.system_date = VLC_TICK_INVALID;
+        player->timer.sources[i].next_update_date = VLC_TICK_INVALID;
         player->timer.sources[i].es = NULL;
     }
+    atomic_init(&player->timer.best_snapshot.seq, 0);
+    atomic_init(&player->timer.best_snapshot.ts, VLC_TICK_INVALID);
+    atomic_init(&player->timer.best_snapshot.length, VLC_TICK_INVALID);
+    atomic_init(&player->timer.best_snapshot.system_date, VLC_TICK_INVALID);
+    atomic_init(&player->timer.best_snapshot.rate, 0);
+    atomic_init(&player->timer.best_snapshot.position, 0);
     vlc_player_ResetTimer(player);
 }
 
@@ -33,10 +33,7 @@
 void
 vlc_playlist_ClearItems(vlc_playlist_t *playlist)
 {
-    vlc_playlist_item_t *item;
-    vlc_vector_foreach(item, &playlist->items)
-        vlc_playlist_item_Release(item);
-    vlc_vector_clear(&playlist->items);
+    playlist_items_Clear(&playlist->items);
 }
 
 static void
@@ -52,17 +49,18 @@ vlc_playlist_ItemsReset(vlc_playlist_t *playlist)
     playlist->has_prev = vlc_playlist_ComputeHasPrev(playlist);
     playlist->has_next = vlc_playlist_ComputeHasNext(playlist);
 
-    vlc_playlist_Notify(playlist, on_items_reset, playlist->items.data,
-                   playlist->items.size);
+    /* the playlist is always empty after a reset */
+    assert(playlist_items_Count(&playlist->items) == 0);
+    vlc_playlist_Notify(playlist, on_items_reset, NULL, 0);
     vlc_playlist_state_NotifyChanges(playlist, &state);
 }
 
 static void
-vlc_playlist_ItemsInserted(vlc_playlist_t *playlist, size_t index, size_t count)
+vlc_playlist_ItemsInserted(vlc_playlist_t *playlist, size_t index,
+                           vlc_playlist_item_t *items[], size_t count)
 {
     if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
-        randomizer_Add(&playlist->randomizer,
-                       &playlist->items.data[index], count);
+        randomizer_Add(&playlist->randomizer, items, count);
 
     struct vlc_playlist_state state;
     vlc_playlist_state_Save(playlist, &state);
@@ -72,15 +70,11 @@ vlc_playlist_ItemsInserted(vlc_playlist_t *playlist, size_t index, size_t count)
     playlist->has_prev = vlc_playlist_ComputeHasPrev(playlist);
     playlist->has_next = vlc_playlist_ComputeHasNext(playlist);
 
-    vlc_playlist_item_t **items = &playlist->items.data[index];
     vlc_playlist_Notify(playlist, on_items_added, index, items, count);
     vlc_playlist_state_NotifyChanges(playlist, &state);
 
-    for (size_t i = index; i < index + count; ++i)
-    {
-        vlc_playlist_item_t *item = playlist->items.data[i];
-        vlc_playlist_AutoPreparse(playlist, item->media);
-    }
+    for (size_t i = 0; i < count; ++i)
+        vlc_playlist_AutoPreparse(playlist, items[i]->media);
 }
 
 static void
@@ -124,9 +118,25 @@ vlc_playlist_ItemsMoved(vlc_playlist_t *playlist, size_t index, size_t count,
 static void
 vlc_playlist_ItemsRemoving(vlc_playlist_t *playlist, size_t index, size_t count)
 {
-    if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
-        randomizer_Remove(&playlist->randomizer,
-                          &playlist->items.data[index], count);
+    if (playlist->order != VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
+        return;
+
+    /* remove them at once, the randomizer handles a batch in a single pass */
+    vlc_playlist_item_t **items = vlc_alloc(count, sizeof(*items));
+    if (items)
+    {
+        for (size_t i = 0; i < count; ++i)
+            items[i] = playlist_items_Get(&playlist->items, index + i);
+        randomizer_Remove(&playlist->randomizer, items, count);
+        free(items);
+    }
+    else
+        for (size_t i = index; i < index + count; ++i)
+        {
+            vlc_playlist_item_t *item = playlist_items_Get(&playlist->items,
+                                                           i);
+            randomizer_Remove(&playlist->randomizer, &item, 1);
+        }
 }
 
 /* return whether the current media has changed */
@@ -141,7 +151,7 @@ vlc_playlist_ItemsRemoved(vlc_playlist_t *playlist, size_t index, size_t count)
         size_t current = (size_t) playlist->current;
         if (current >= index && current < index + count) {
             /* current item has been removed */
-            if (index + count < playlist->items.size) {
+            if (index + count < playlist_items_Count(&playlist->items)) {
                 /* select the first item after the removed block */
                 playlist->current = index;
             } else {
@@ -163,7 +173,8 @@ vlc_playlist_ItemsRemoved(vlc_playlist_t *playlist, size_t index, size_t count)
 }
 
 static void
-vlc_playlist_ItemReplaced(vlc_playlist_t *playlist, size_t index)
+vlc_playlist_ItemReplaced(vlc_playlist_t *playlist, size_t index,
+                          vlc_playlist_item_t *item)
 {
     struct vlc_playlist_state state;
     vlc_playlist_state_Save(playlist, &state);
@@ -171,25 +182,24 @@ vlc_playlist_ItemReplaced(vlc_playlist_t *playlist, size_t index)
     playlist->has_prev = vlc_playlist_ComputeHasPrev(playlist);
     playlist->has_next = vlc_playlist_ComputeHasNext(playlist);
 
-    vlc_playlist_Notify(playlist, on_items_updated, index,
-                        &playlist->items.data[index], 1);
+    vlc_playlist_Notify(playlist, on_items_updated, index, &item, 1);
     vlc_playlist_state_NotifyChanges(playlist, &state);
 
-    vlc_playlist_AutoPreparse(playlist, playlist->items.data[index]->media);
+    vlc_playlist_AutoPreparse(playlist, item->media);
 }
 
 size_t
 vlc_playlist_Count(vlc_playlist_t *playlist)
 {
     vlc_playlist_AssertLocked(playlist);
-    return playlist->items.size;
+    return playlist_items_Count(&playlist->items);
 }
 
 vlc_playlist_item_t *
 vlc_playlist_Get(vlc_playlist_t *playlist, size_t index)
 {
     vlc_playlist_AssertLocked(playlist);
-    return playlist->items.data[index];
+    return playlist_items_Get(&playlist->items, index);
 }
 
 ssize_t
@@ -197,9 +207,7 @@ vlc_playlist_IndexOf(vlc_playlist_t *playlist, const vlc_playlist_item_t *item)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    ssize_t index;
-    vlc_vector_index_of(&playlist->items, item, &index);
-    return index;
+    return playlist_items_IndexOf(&playlist->items, item);
 }
 
 ssize_t
@@ -207,11 +215,7 @@ vlc_playlist_IndexOfMedia(vlc_playlist_t *playlist, const input_item_t *media)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->media == media)
-            return i;
-    return -1;
+    return playlist_items_IndexOfMedia(&playlist->items, media);
 }
 
 ssize_t
@@ -219,11 +223,7 @@ vlc_playlist_IndexOfId(vlc_playlist_t *playlist, uint64_t id)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->id == id)
-            return i;
-    return -1;
+    return playlist_items_IndexOfId(&playlist->items, id);
 }
 
 void
@@ -261,30 +261,47 @@ vlc_playlist_MediaToItems(vlc_playlist_t *playlist, input_item_t *const media[],
     return VLC_SUCCESS;
 }
 
+static int
+vlc_playlist_InsertItems(vlc_playlist_t *playlist, size_t index,
+                         input_item_t *const media[], size_t count)
+{
+    if (count == 0)
+        return VLC_SUCCESS;
+
+    vlc_playlist_item_t **items = vlc_alloc(count, sizeof (*items));
+    if (unlikely(items == NULL))
+        return VLC_ENOMEM;
+
+    int ret = vlc_playlist_MediaToItems(playlist, media, count, items);
+    if (ret != VLC_SUCCESS)
+        goto end;
+
+    if (!playlist_items_Insert(&playlist->items, index, items, count))
+    {
+        for (size_t i = 0; i < count; ++i)
+            vlc_playlist_item_Release(items[i]);
+        ret = VLC_ENOMEM;
+        goto end;
+    }
+
+    vlc_playlist_ItemsInserted(playlist, index, items, count);
+end:
+    free(items);
+    return ret;
+}
+
 int
 vlc_playlist_Insert(vlc_playlist_t *playlist, size_t index,
                     input_item_t *const media[], size_t count)
 {
     vlc_playlist_AssertLocked(playlist);
-    assert(index <= playlist->items.size);
+    assert(index <= playlist_items_Count(&playlist->items));
 
-    /* make space in the vector */
-    if (!vlc_vector_insert_hole(&playlist->items, index, count))
-        return VLC_ENOMEM;
-
-    /* create playlist items in place */
-    int ret = vlc_playlist_MediaToItems(playlist, media, count,
-                                        &playlist->items.data[index]);
+    int ret = vlc_playlist_InsertItems(playlist, index, media, count);
     if (ret != VLC_SUCCESS)
-    {
-        /* we were optimistic, it failed, restore the vector state */
-        vlc_vector_remove_slice(&playlist->items, index, count);
         return ret;
-    }
 
-    vlc_playlist_ItemsInserted(playlist, index, count);
     vlc_player_InvalidateNextMedia(playlist->player);
-
     return VLC_SUCCESS;
 }
 
@@ -293,10 +310,10 @@ vlc_playlist_Move(vlc_playlist_t *playlist, size_t index, size_t count,
                   size_t target)
 {
     vlc_playlist_AssertLocked(playlist);
-    assert(index + count <= playlist->items.size);
-    assert(target + count <= playlist->items.size);
+    assert(index + count <= playlist_items_Count(&playlist->items));
+    assert(target + count <= playlist_items_Count(&playlist->items));
 
-    vlc_vector_move_slice(&playlist->items, index, count, target);
+    playlist_items_Move(&playlist->items, index, count, target);
 
     vlc_playlist_ItemsMoved(playlist, index, count, target);
     vlc_player_InvalidateNextMedia(playlist->player);
@@ -306,14 +323,11 @@ void
 vlc_playlist_Remove(vlc_playlist_t *playlist, size_t index, size_t count)
 {
     vlc_playlist_AssertLocked(playlist);
-    assert(index < playlist->items.size);
+    assert(index < playlist_items_Count(&playlist->items));
 
     vlc_playlist_ItemsRemoving(playlist, index, count);
 
-    for (size_t i = 0; i < count; ++i)
-        vlc_playlist_item_Release(playlist->items.data[index + i]);
-
-    vlc_vector_remove_slice(&playlist->items, index, count);
+    playlist_items_Remove(&playlist->items, index, count);
 
     bool current_media_changed = vlc_playlist_ItemsRemoved(playlist, index,
                                                            count);
@@ -328,8 +342,9 @@ vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
                      input_item_t *media)
 {
     vlc_playlist_AssertLocked(playlist);
-    assert(index < playlist->items.size);
+    assert(index < playlist_items_Count(&playlist->items));
 
+    vlc_playlist_item_t *old = playlist_items_Get(&playlist->items, index);
     uint64_t id = playlist->idgen++;
     vlc_playlist_item_t *item = vlc_playlist_item_New(media, id);
     if (!item)
@@ -337,15 +352,13 @@ vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
 
     if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
     {
-        randomizer_Remove(&playlist->randomizer,
-                          &playlist->items.data[index], 1);
+        randomizer_Remove(&playlist->randomizer, &old, 1);
         randomizer_Add(&playlist->randomizer, &item, 1);
     }
 
-    vlc_playlist_item_Release(playlist->items.data[index]);
-    playlist->items.data[index] = item;
+    playlist_items_Set(&playlist->items, index, item);
 
-    vlc_playlist_ItemReplaced(playlist, index);
+    vlc_playlist_ItemReplaced(playlist, index, item);
     return VLC_SUCCESS;
 }
 
@@ -354,7 +367,7 @@ vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
                     input_item_t *const media[], size_t count)
 {
     vlc_playlist_AssertLocked(playlist);
-    assert(index < playlist->items.size);
+    assert(index < playlist_items_Count(&playlist->items));
 
     if (count == 0)
         vlc_playlist_RemoveOne(playlist, index);
@@ -364,23 +377,10 @@ vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
         if (ret != VLC_SUCCESS)
             return ret;
 
-        if (count > 1)
-        {
-            /* make space in the vector */
-            if (!vlc_vector_insert_hole(&playlist->items, index + 1, count - 1))
-                return VLC_ENOMEM;
-
-            /* create playlist items in place */
-            ret = vlc_playlist_MediaToItems(playlist, &media[1], count - 1,
-                                            &playlist->items.data[index + 1]);
-            if (ret != VLC_SUCCESS)
-            {
-                /* we were optimistic, it failed, restore the vector state */
-                vlc_vector_remove_slice(&playlist->items, index + 1, count - 1);
-                return ret;
-            }
-            vlc_playlist_ItemsInserted(playlist, index + 1, count - 1);
-        }
+        ret = vlc_playlist_InsertItems(playlist, index + 1, &media[1],
+                                       count - 1);
+        if (ret != VLC_SUCCESS)
+            return ret;
 
         if ((ssize_t) index == playlist->current)
             vlc_playlist_SetCurrentMedia(playlist, playlist->current);
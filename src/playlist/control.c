@@ -36,8 +36,11 @@ vlc_playlist_PlaybackOrderChanged(vlc_playlist_t *playlist)
     {
         /* randomizer is expected to be empty at this point */
         assert(randomizer_Count(&playlist->randomizer) == 0);
-        randomizer_Add(&playlist->randomizer, playlist->items.data,
-                       playlist->items.size);
+        for (size_t i = 0; i < playlist->items.chunk_count; ++i)
+        {
+            struct playlist_chunk *chunk = playlist->items.chunks[i];
+            randomizer_Add(&playlist->randomizer, chunk->items, chunk->count);
+        }
 
         bool loop = playlist->repeat == VLC_PLAYLIST_PLAYBACK_REPEAT_ALL;
         randomizer_SetLoop(&playlist->randomizer, loop);
@@ -154,7 +157,7 @@ vlc_playlist_SetCurrentMedia(vlc_playlist_t *playlist, ssize_t index)
     vlc_playlist_AssertLocked(playlist);
 
     input_item_t *media = index != -1
-                        ? playlist->items.data[index]->media
+                        ? vlc_playlist_Get(playlist, index)->media
                         : NULL;
     return vlc_player_SetCurrentMedia(playlist->player, media);
 }
@@ -166,7 +169,7 @@ vlc_playlist_NormalOrderHasPrev(vlc_playlist_t *playlist)
         return false;
 
     if (playlist->repeat == VLC_PLAYLIST_PLAYBACK_REPEAT_ALL)
-        return playlist->items.size > 0;
+        return vlc_playlist_Count(playlist) > 0;
 
     return playlist->current > 0;
 }
@@ -181,7 +184,7 @@ vlc_playlist_NormalOrderGetPrevIndex(vlc_playlist_t *playlist)
             return playlist->current - 1;
         case VLC_PLAYLIST_PLAYBACK_REPEAT_ALL:
             if (playlist->current == 0)
-                return playlist->items.size - 1;
+                return vlc_playlist_Count(playlist) - 1;
             return playlist->current - 1;
         default:
             vlc_assert_unreachable();
@@ -192,26 +195,27 @@ static inline bool
 vlc_playlist_NormalOrderHasNext(vlc_playlist_t *playlist)
 {
     if (playlist->repeat == VLC_PLAYLIST_PLAYBACK_REPEAT_ALL)
-        return playlist->items.size > 0;
+        return vlc_playlist_Count(playlist) > 0;
 
-    /* also works if current == -1 or playlist->items.size == 0 */
-    return playlist->current < (ssize_t) playlist->items.size - 1;
+    /* also works if current == -1 or the playlist is empty */
+    return playlist->current < (ssize_t) vlc_playlist_Count(playlist) - 1;
 }
 
 static inline size_t
 vlc_playlist_NormalOrderGetNextIndex(vlc_playlist_t *playlist)
 {
+    size_t count = vlc_playlist_Count(playlist);
     switch (playlist->repeat)
     {
         case VLC_PLAYLIST_PLAYBACK_REPEAT_NONE:
         case VLC_PLAYLIST_PLAYBACK_REPEAT_CURRENT:
-            if (playlist->current >= (ssize_t) playlist->items.size - 1)
+            if (playlist->current >= (ssize_t) count - 1)
                 return -1;
             return playlist->current + 1;
         case VLC_PLAYLIST_PLAYBACK_REPEAT_ALL:
-                if (playlist->items.size == 0)
+                if (count == 0)
                     return -1;
-            return (playlist->current + 1) % playlist->items.size;
+            return (playlist->current + 1) % count;
         default:
             vlc_assert_unreachable();
     }
@@ -237,7 +241,7 @@ static inline bool
 vlc_playlist_RandomOrderHasNext(vlc_playlist_t *playlist)
 {
     if (playlist->repeat == VLC_PLAYLIST_PLAYBACK_REPEAT_ALL)
-        return playlist->items.size > 0;
+        return vlc_playlist_Count(playlist) > 0;
     return randomizer_HasNext(&playlist->randomizer);
 }
 
@@ -364,7 +368,7 @@ vlc_playlist_Prev(vlc_playlist_t *playlist)
     {
         /* mark the item as selected in the randomizer */
         vlc_playlist_item_t *selected = randomizer_Prev(&playlist->randomizer);
-        assert(selected == playlist->items.data[index]);
+        assert(selected == vlc_playlist_Get(playlist, index));
         VLC_UNUSED(selected);
     }
 
@@ -392,7 +396,7 @@ vlc_playlist_Next(vlc_playlist_t *playlist)
     {
         /* mark the item as selected in the randomizer */
         vlc_playlist_item_t *selected = randomizer_Next(&playlist->randomizer);
-        assert(selected == playlist->items.data[index]);
+        assert(selected == vlc_playlist_Get(playlist, index));
         VLC_UNUSED(selected);
     }
 
@@ -405,7 +409,7 @@ int
 vlc_playlist_GoTo(vlc_playlist_t *playlist, ssize_t index)
 {
     vlc_playlist_AssertLocked(playlist);
-    assert(index == -1 || (size_t) index < playlist->items.size);
+    assert(index == -1 || (size_t) index < vlc_playlist_Count(playlist));
 
     int ret = vlc_playlist_SetCurrentMedia(playlist, index);
     if (ret != VLC_SUCCESS)
@@ -413,7 +417,7 @@ vlc_playlist_GoTo(vlc_playlist_t *playlist, ssize_t index)
 
     if (index != -1 && playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
     {
-        vlc_playlist_item_t *item = playlist->items.data[index];
+        vlc_playlist_item_t *item = vlc_playlist_Get(playlist, index);
         randomizer_Select(&playlist->randomizer, item);
     }
 
@@ -442,7 +446,7 @@ vlc_playlist_GetNextMedia(vlc_playlist_t *playlist)
     if (index == -1)
         return NULL;
 
-    input_item_t *media = playlist->items.data[index]->media;
+    input_item_t *media = vlc_playlist_Get(playlist, index)->media;
     input_item_Hold(media);
     return media;
 }
@@ -37,6 +37,7 @@ vlc_playlist_item_New(input_item_t *media, uint64_t id)
     vlc_atomic_rc_init(&item->rc);
     item->id = id;
     item->media = media;
+    item->chunk = NULL;
     input_item_Hold(media);
     return item;
 }
@@ -31,6 +31,7 @@ struct vlc_playlist_item
     input_item_t *media;
     uint64_t id;
     vlc_atomic_rc_t rc;
+    struct playlist_chunk *chunk; /**< chunk of the storage holding it */
 };
 
 /* _New() is private, it is called when inserting new media in the playlist */
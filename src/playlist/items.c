@@ -0,0 +1,601 @@
+/*****************************************************************************
+ * playlist/items.c
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_playlist.h>
+
+#include "items.h"
+#include "item.h"
+
+/* New chunks are not filled completely, to leave room for insertions */
+#define PLAYLIST_CHUNK_FILL (PLAYLIST_CHUNK_MAX * 3 / 4)
+/* Chunks smaller than this are merged with a neighbour if possible */
+#define PLAYLIST_CHUNK_MIN (PLAYLIST_CHUNK_MAX / 4)
+
+void
+playlist_items_Init(struct playlist_items *list)
+{
+    list->chunks = NULL;
+    list->tree = NULL;
+    list->chunk_count = 0;
+    list->chunk_alloc = 0;
+    list->size = 0;
+    list->cache_valid = false;
+}
+
+/* Release an item removed from the storage */
+static void
+playlist_items_Drop(vlc_playlist_item_t *item)
+{
+    /* the item may outlive its removal */
+    item->chunk = NULL;
+    vlc_playlist_item_Release(item);
+}
+
+void
+playlist_items_Clear(struct playlist_items *list)
+{
+    for (size_t i = 0; i < list->chunk_count; ++i)
+    {
+        struct playlist_chunk *chunk = list->chunks[i];
+        for (size_t j = 0; j < chunk->count; ++j)
+            playlist_items_Drop(chunk->items[j]);
+        free(chunk);
+    }
+    list->chunk_count = 0;
+    list->size = 0;
+    list->cache_valid = false;
+}
+
+void
+playlist_items_Destroy(struct playlist_items *list)
+{
+    playlist_items_Clear(list);
+    free(list->chunks);
+    free(list->tree);
+}
+
+static void
+playlist_items_TreeAdd(struct playlist_items *list, size_t chunk,
+                       ssize_t delta)
+{
+    for (size_t i = chunk + 1; i <= list->chunk_count; i += i & -i)
+        list->tree[i] += delta;
+}
+
+/* Number of items before a chunk */
+static size_t
+playlist_items_TreePrefix(const struct playlist_items *list, size_t chunk)
+{
+    size_t sum = 0;
+    for (size_t i = chunk; i > 0; i -= i & -i)
+        sum += list->tree[i];
+    return sum;
+}
+
+/* Rebuild the tree and the chunk indices after the chunk array changed */
+static void
+playlist_items_Reindex(struct playlist_items *list)
+{
+    size_t n = list->chunk_count;
+
+    for (size_t i = 1; i <= n; ++i)
+    {
+        list->chunks[i - 1]->index = i - 1;
+        list->tree[i] = list->chunks[i - 1]->count;
+    }
+    for (size_t i = 1; i <= n; ++i)
+    {
+        size_t j = i + (i & -i);
+        if (j <= n)
+            list->tree[j] += list->tree[i];
+    }
+    list->cache_valid = false;
+}
+
+/* Find the chunk containing an item, and the index of its first item */
+static size_t
+playlist_items_Locate(struct playlist_items *list, size_t index, size_t *base)
+{
+    assert(index < list->size);
+
+    if (list->cache_valid)
+    {
+        const struct playlist_chunk *chunk = list->chunks[list->cache_chunk];
+        if (index >= list->cache_base
+         && index < list->cache_base + chunk->count)
+        {
+            *base = list->cache_base;
+            return list->cache_chunk;
+        }
+
+        /* sequential iterations move to the next chunk */
+        size_t next = list->cache_chunk + 1;
+        size_t next_base = list->cache_base + chunk->count;
+        if (next < list->chunk_count && index >= next_base
+         && index < next_base + list->chunks[next]->count)
+        {
+            list->cache_chunk = next;
+            list->cache_base = next_base;
+            *base = next_base;
+            return next;
+        }
+    }
+
+    size_t step = 1;
+    while (step * 2 <= list->chunk_count)
+        step *= 2;
+
+    size_t pos = 0, rem = index;
+    for (; step > 0; step /= 2)
+        if (pos + step <= list->chunk_count && list->tree[pos + step] <= rem)
+        {
+            pos += step;
+            rem -= list->tree[pos];
+        }
+
+    assert(pos < list->chunk_count);
+    list->cache_chunk = pos;
+    list->cache_base = index - rem;
+    list->cache_valid = true;
+    *base = index - rem;
+    return pos;
+}
+
+vlc_playlist_item_t *
+playlist_items_Get(struct playlist_items *list, size_t index)
+{
+    size_t base;
+    size_t chunk = playlist_items_Locate(list, index, &base);
+    return list->chunks[chunk]->items[index - base];
+}
+
+void
+playlist_items_Set(struct playlist_items *list, size_t index,
+                   vlc_playlist_item_t *item)
+{
+    size_t base;
+    struct playlist_chunk *chunk =
+        list->chunks[playlist_items_Locate(list, index, &base)];
+
+    playlist_items_Drop(chunk->items[index - base]);
+    chunk->items[index - base] = item;
+    item->chunk = chunk;
+}
+
+void
+playlist_items_Copy(struct playlist_items *list, size_t index, size_t count,
+                    vlc_playlist_item_t *dest[])
+{
+    if (count == 0)
+        return;
+
+    assert(index + count <= list->size);
+
+    size_t base;
+    size_t c = playlist_items_Locate(list, index, &base);
+    size_t offset = index - base;
+
+    while (count > 0)
+    {
+        const struct playlist_chunk *chunk = list->chunks[c++];
+        size_t n = chunk->count - offset;
+        if (n > count)
+            n = count;
+
+        memcpy(dest, &chunk->items[offset], n * sizeof (*dest));
+        dest += n;
+        count -= n;
+        offset = 0;
+    }
+}
+
+vlc_playlist_item_t **
+playlist_items_Flatten(struct playlist_items *list)
+{
+    vlc_playlist_item_t **array = vlc_alloc(list->size ? list->size : 1,
+                                            sizeof (*array));
+    if (likely(array != NULL))
+        playlist_items_Copy(list, 0, list->size, array);
+    return array;
+}
+
+void
+playlist_items_Assign(struct playlist_items *list,
+                      vlc_playlist_item_t *const items[])
+{
+    for (size_t i = 0; i < list->chunk_count; ++i)
+    {
+        struct playlist_chunk *chunk = list->chunks[i];
+
+        memcpy(chunk->items, items, chunk->count * sizeof (*items));
+        for (size_t j = 0; j < chunk->count; ++j)
+            chunk->items[j]->chunk = chunk;
+        items += chunk->count;
+    }
+}
+
+static bool
+playlist_items_Reserve(struct playlist_items *list, size_t count)
+{
+    if (count <= list->chunk_alloc)
+        return true;
+
+    size_t alloc = list->chunk_alloc ? list->chunk_alloc : 4;
+    while (alloc < count)
+        alloc *= 2;
+
+    struct playlist_chunk **chunks = vlc_reallocarray(list->chunks, alloc,
+                                                      sizeof (*chunks));
+    if (unlikely(chunks == NULL))
+        return false;
+    list->chunks = chunks;
+
+    /* the tree is rebuilt whenever the chunk array changes */
+    size_t *tree = vlc_reallocarray(list->tree, alloc + 1, sizeof (*tree));
+    if (unlikely(tree == NULL))
+        return false;
+    list->tree = tree;
+
+    list->chunk_alloc = alloc;
+    return true;
+}
+
+bool
+playlist_items_Insert(struct playlist_items *list, size_t index,
+                      vlc_playlist_item_t *items[], size_t count)
+{
+    assert(index <= list->size);
+
+    if (count == 0)
+        return true;
+
+    size_t c = 0, offset = 0;
+    struct playlist_chunk *chunk = NULL;
+
+    if (list->chunk_count > 0)
+    {
+        if (index == list->size)
+        {
+            c = list->chunk_count - 1;
+            chunk = list->chunks[c];
+            offset = chunk->count;
+        }
+        else
+        {
+            size_t base;
+            c = playlist_items_Locate(list, index, &base);
+            chunk = list->chunks[c];
+            offset = index - base;
+        }
+
+        if (chunk->count + count <= PLAYLIST_CHUNK_MAX)
+        {
+            /* fast path: insert within the chunk */
+            memmove(&chunk->items[offset + count], &chunk->items[offset],
+                    (chunk->count - offset) * sizeof (*items));
+            memcpy(&chunk->items[offset], items, count * sizeof (*items));
+            for (size_t i = 0; i < count; ++i)
+                items[i]->chunk = chunk;
+            chunk->count += count;
+            list->size += count;
+            playlist_items_TreeAdd(list, c, count);
+            if (list->cache_chunk > c)
+                list->cache_valid = false;
+            return true;
+        }
+    }
+
+    /* Split the chunk at the insertion point: its head stays in place, the
+     * new items and its tail are spread over new chunks */
+    vlc_playlist_item_t *tail[PLAYLIST_CHUNK_MAX];
+    size_t tail_count = 0;
+    bool reuse = false;
+
+    if (chunk != NULL)
+    {
+        tail_count = chunk->count - offset;
+        memcpy(tail, &chunk->items[offset], tail_count * sizeof (*tail));
+        /* an empty head is reused as the first new chunk */
+        reuse = offset == 0;
+    }
+
+    size_t total = count + tail_count;
+    size_t fresh_count = (total + PLAYLIST_CHUNK_FILL - 1)
+                       / PLAYLIST_CHUNK_FILL;
+    size_t alloc_count = fresh_count - reuse;
+
+    if (!playlist_items_Reserve(list, list->chunk_count + alloc_count))
+        return false;
+
+    struct playlist_chunk **fresh = vlc_alloc(fresh_count, sizeof (*fresh));
+    if (unlikely(fresh == NULL))
+        return false;
+
+    size_t i = 0;
+    if (reuse)
+        fresh[i++] = chunk;
+    for (; i < fresh_count; ++i)
+    {
+        fresh[i] = malloc(sizeof (**fresh));
+        if (unlikely(fresh[i] == NULL))
+        {
+            while (i > (size_t) reuse)
+                free(fresh[--i]);
+            free(fresh);
+            return false;
+        }
+    }
+
+    /* nothing can fail anymore */
+    size_t pos; /* position of the first new chunk */
+    if (chunk == NULL)
+        pos = 0;
+    else
+    {
+        chunk->count = offset;
+        pos = reuse ? c : c + 1;
+    }
+
+    size_t done = 0;
+    for (i = 0; i < fresh_count; ++i)
+    {
+        struct playlist_chunk *dst = fresh[i];
+        /* distribute evenly */
+        size_t n = (total - done) / (fresh_count - i);
+
+        for (size_t j = 0; j < n; ++j, ++done)
+        {
+            vlc_playlist_item_t *item = done < count ? items[done]
+                                                     : tail[done - count];
+            dst->items[j] = item;
+            item->chunk = dst;
+        }
+        dst->count = n;
+    }
+
+    size_t moved = list->chunk_count - (reuse ? pos + 1 : pos);
+    memmove(&list->chunks[pos + fresh_count],
+            &list->chunks[pos + reuse], moved * sizeof (*list->chunks));
+    memcpy(&list->chunks[pos], fresh, fresh_count * sizeof (*fresh));
+    free(fresh);
+
+    list->chunk_count += alloc_count;
+    list->size += count;
+    playlist_items_Reindex(list);
+    return true;
+}
+
+/* Merge a chunk into the previous one, return whether it was merged */
+static bool
+playlist_items_Merge(struct playlist_items *list, size_t c)
+{
+    assert(c > 0 && c < list->chunk_count);
+    struct playlist_chunk *prev = list->chunks[c - 1];
+    struct playlist_chunk *chunk = list->chunks[c];
+
+    if (prev->count + chunk->count > PLAYLIST_CHUNK_MAX
+     || (prev->count >= PLAYLIST_CHUNK_MIN
+      && chunk->count >= PLAYLIST_CHUNK_MIN))
+        return false;
+
+    for (size_t i = 0; i < chunk->count; ++i)
+    {
+        vlc_playlist_item_t *item = chunk->items[i];
+        prev->items[prev->count++] = item;
+        item->chunk = prev;
+    }
+    chunk->count = 0;
+    return true;
+}
+
+void
+playlist_items_Remove(struct playlist_items *list, size_t index, size_t count)
+{
+    assert(index + count <= list->size);
+
+    if (count == 0)
+        return;
+
+    size_t base;
+    size_t first = playlist_items_Locate(list, index, &base);
+    size_t offset = index - base;
+    size_t c = first;
+
+    list->size -= count;
+
+    while (count > 0)
+    {
+        struct playlist_chunk *chunk = list->chunks[c];
+        size_t n = chunk->count - offset;
+        if (n > count)
+            n = count;
+
+        for (size_t i = 0; i < n; ++i)
+            playlist_items_Drop(chunk->items[offset + i]);
+        memmove(&chunk->items[offset], &chunk->items[offset + n],
+                (chunk->count - offset - n) * sizeof (*chunk->items));
+        chunk->count -= n;
+
+        if (c == first && count == n && chunk->count >= PLAYLIST_CHUNK_MIN)
+        {
+            /* fast path: only one chunk changed */
+            playlist_items_TreeAdd(list, c, -(ssize_t) n);
+            if (list->cache_chunk > c)
+                list->cache_valid = false;
+            return;
+        }
+
+        count -= n;
+        offset = 0;
+        c++;
+    }
+
+    /* merge the small chunks around the removed range with their
+     * neighbours */
+    size_t last = c; /* first chunk after the range */
+    if (last < list->chunk_count)
+        playlist_items_Merge(list, last);
+    if (first > 0)
+        playlist_items_Merge(list, first);
+
+    /* drop the empty chunks */
+    size_t kept = 0;
+    for (size_t i = 0; i < list->chunk_count; ++i)
+    {
+        struct playlist_chunk *chunk = list->chunks[i];
+        if (chunk->count == 0)
+            free(chunk);
+        else
+            list->chunks[kept++] = chunk;
+    }
+    list->chunk_count = kept;
+    playlist_items_Reindex(list);
+}
+
+/* Reverse the items in [begin, end) */
+static void
+playlist_items_Reverse(struct playlist_items *list, size_t begin, size_t end)
+{
+    if (end - begin < 2)
+        return;
+
+    size_t base;
+    size_t lc = playlist_items_Locate(list, begin, &base);
+    size_t li = begin - base;
+    size_t rc = playlist_items_Locate(list, end - 1, &base);
+    size_t ri = end - 1 - base;
+
+    for (size_t n = (end - begin) / 2; n > 0; --n)
+    {
+        struct playlist_chunk *left = list->chunks[lc];
+        struct playlist_chunk *right = list->chunks[rc];
+        vlc_playlist_item_t *a = left->items[li];
+        vlc_playlist_item_t *b = right->items[ri];
+
+        left->items[li] = b;
+        b->chunk = left;
+        right->items[ri] = a;
+        a->chunk = right;
+
+        if (++li == left->count)
+        {
+            lc++;
+            li = 0;
+        }
+        if (ri-- == 0)
+        {
+            /* chunks are never empty */
+            rc--;
+            ri = list->chunks[rc]->count - 1;
+        }
+    }
+}
+
+void
+playlist_items_Move(struct playlist_items *list, size_t index, size_t count,
+                    size_t target)
+{
+    assert(index + count <= list->size);
+    assert(target + count <= list->size);
+
+    if (count == 0 || index == target)
+        return;
+
+    /* a move is a rotation of the range covering the source and the
+     * destination, which is done in place by three reversals */
+    size_t begin, middle, end;
+    if (index < target)
+    {
+        begin = index;
+        middle = index + count;
+        end = target + count;
+    }
+    else
+    {
+        begin = target;
+        middle = index;
+        end = index + count;
+    }
+
+    playlist_items_Reverse(list, begin, middle);
+    playlist_items_Reverse(list, middle, end);
+    playlist_items_Reverse(list, begin, end);
+}
+
+ssize_t
+playlist_items_IndexOf(struct playlist_items *list,
+                       const vlc_playlist_item_t *item)
+{
+    const struct playlist_chunk *chunk = item->chunk;
+
+    if (chunk == NULL || chunk->index >= list->chunk_count
+     || list->chunks[chunk->index] != chunk)
+        return -1;
+
+    for (size_t i = 0; i < chunk->count; ++i)
+        if (chunk->items[i] == item)
+            return playlist_items_TreePrefix(list, chunk->index) + i;
+
+    vlc_assert_unreachable();
+}
+
+ssize_t
+playlist_items_IndexOfMedia(struct playlist_items *list,
+                            const input_item_t *media)
+{
+    size_t index = 0;
+
+    for (size_t c = 0; c < list->chunk_count; ++c)
+    {
+        const struct playlist_chunk *chunk = list->chunks[c];
+
+        for (size_t i = 0; i < chunk->count; ++i)
+            if (chunk->items[i]->media == media)
+                return index + i;
+        index += chunk->count;
+    }
+    return -1;
+}
+
+ssize_t
+playlist_items_IndexOfId(struct playlist_items *list, uint64_t id)
+{
+    size_t index = 0;
+
+    for (size_t c = 0; c < list->chunk_count; ++c)
+    {
+        const struct playlist_chunk *chunk = list->chunks[c];
+
+        for (size_t i = 0; i < chunk->count; ++i)
+            if (chunk->items[i]->id == id)
+                return index + i;
+        index += chunk->count;
+    }
+    return -1;
+}
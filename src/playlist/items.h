@@ -0,0 +1,144 @@
+/*****************************************************************************
+ * playlist/items.h
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_PLAYLIST_ITEMS_H
+#define VLC_PLAYLIST_ITEMS_H
+
+#include <vlc_common.h>
+
+typedef struct vlc_playlist_item vlc_playlist_item_t;
+
+/**
+ * \defgroup playlist_items Playlist items storage
+ * \ingroup playlist
+ *
+ * Sequence of playlist items, split into chunks of bounded size.
+ *
+ * A Fenwick tree over the chunk sizes locates a position in O(log n), so
+ * that inserting or removing items anywhere only moves the items of the
+ * chunks involved. Each item refers to its chunk, so that its position can
+ * also be retrieved in O(log n).
+ *
+ * The storage owns one reference on each of its items.
+ * @{
+ */
+
+#define PLAYLIST_CHUNK_MAX 512
+
+struct playlist_chunk
+{
+    size_t index; /**< position of the chunk in the chunk array */
+    size_t count;
+    vlc_playlist_item_t *items[PLAYLIST_CHUNK_MAX];
+};
+
+struct playlist_items
+{
+    struct playlist_chunk **chunks;
+    size_t *tree; /**< Fenwick tree of the chunk counts, 1-based */
+    size_t chunk_count;
+    size_t chunk_alloc;
+    size_t size;
+
+    /* last located chunk, to iterate in O(1) */
+    size_t cache_chunk;
+    size_t cache_base;
+    bool cache_valid;
+};
+
+void
+playlist_items_Init(struct playlist_items *list);
+
+/** Free the storage, releasing the items */
+void
+playlist_items_Destroy(struct playlist_items *list);
+
+/** Remove and release all the items */
+void
+playlist_items_Clear(struct playlist_items *list);
+
+static inline size_t
+playlist_items_Count(const struct playlist_items *list)
+{
+    return list->size;
+}
+
+vlc_playlist_item_t *
+playlist_items_Get(struct playlist_items *list, size_t index);
+
+/** Replace (and release) an item */
+void
+playlist_items_Set(struct playlist_items *list, size_t index,
+                   vlc_playlist_item_t *item);
+
+/** Copy count items from index to an array */
+void
+playlist_items_Copy(struct playlist_items *list, size_t index, size_t count,
+                    vlc_playlist_item_t *dest[]);
+
+/** Copy all the items to a new array (to be freed with free()) */
+vlc_playlist_item_t **
+playlist_items_Flatten(struct playlist_items *list);
+
+/** Replace all the items by a permutation of them, in array order */
+void
+playlist_items_Assign(struct playlist_items *list,
+                      vlc_playlist_item_t *const items[]);
+
+/** Insert items, taking ownership of them on success */
+bool
+playlist_items_Insert(struct playlist_items *list, size_t index,
+                      vlc_playlist_item_t *items[], size_t count);
+
+/** Remove and release items */
+void
+playlist_items_Remove(struct playlist_items *list, size_t index, size_t count);
+
+/** Move a slice so that it starts at target once moved (cannot fail) */
+void
+playlist_items_Move(struct playlist_items *list, size_t index, size_t count,
+                    size_t target);
+
+ssize_t
+playlist_items_IndexOf(struct playlist_items *list,
+                       const vlc_playlist_item_t *item);
+
+ssize_t
+playlist_items_IndexOfMedia(struct playlist_items *list,
+                            const input_item_t *media);
+
+ssize_t
+playlist_items_IndexOfId(struct playlist_items *list, uint64_t id);
+
+/**
+ * Iterate over all the items, in order.
+ *
+ * The storage must not be modified during the iteration.
+ */
+#define playlist_items_foreach(item, list) \
+    for (size_t pl_chunk_ = 0; pl_chunk_ < (list)->chunk_count; ++pl_chunk_) \
+        for (size_t pl_idx_ = 0; \
+             pl_idx_ < (list)->chunks[pl_chunk_]->count && \
+             ((item) = (list)->chunks[pl_chunk_]->items[pl_idx_], true); \
+             ++pl_idx_)
+
+/** @} */
+
+#endif
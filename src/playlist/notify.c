@@ -29,10 +29,11 @@
 
 static void
 vlc_playlist_NotifyCurrentState(vlc_playlist_t *playlist,
-                                vlc_playlist_listener_id *listener)
+                                vlc_playlist_listener_id *listener,
+                                vlc_playlist_item_t *const items[])
 {
     vlc_playlist_NotifyListener(playlist, listener, on_items_reset,
-                                playlist->items.data, playlist->items.size);
+                                items, playlist_items_Count(&playlist->items));
     vlc_playlist_NotifyListener(playlist, listener, on_playback_repeat_changed,
                                 playlist->repeat);
     vlc_playlist_NotifyListener(playlist, listener, on_playback_order_changed,
@@ -52,16 +53,31 @@ vlc_playlist_AddListener(vlc_playlist_t *playlist,
 {
     vlc_playlist_AssertLocked(playlist);
 
+    vlc_playlist_item_t **items = NULL;
+    if (notify_current_state)
+    {
+        /* the listener expects the items as an array */
+        items = playlist_items_Flatten(&playlist->items);
+        if (unlikely(!items))
+            return NULL;
+    }
+
     vlc_playlist_listener_id *listener = malloc(sizeof(*listener));
     if (unlikely(!listener))
+    {
+        free(items);
         return NULL;
+    }
 
     listener->cbs = cbs;
     listener->userdata = userdata;
     vlc_list_append(&listener->node, &playlist->listeners);
 
     if (notify_current_state)
-        vlc_playlist_NotifyCurrentState(playlist, listener);
+    {
+        vlc_playlist_NotifyCurrentState(playlist, listener, items);
+        free(items);
+    }
 
     return listener;
 }
@@ -109,6 +125,133 @@ vlc_playlist_HasItemUpdatedListeners(vlc_playlist_t *playlist)
     return false;
 }
 
+static int
+vlc_playlist_CompareMedia(const void *a, const void *b)
+{
+    uintptr_t x = (uintptr_t) *(input_item_t *const *) a;
+    uintptr_t y = (uintptr_t) *(input_item_t *const *) b;
+    return (x > y) - (x < y);
+}
+
+void
+vlc_playlist_FlushUpdates(vlc_playlist_t *playlist)
+{
+    vlc_playlist_AssertLocked(playlist);
+
+    playlist_media_vector_t *pending = &playlist->updates.media;
+    if (pending->size == 0)
+        return;
+
+    /* take ownership of the pending media, the listeners may report new
+     * updates */
+    input_item_t **media = pending->data;
+    size_t count = pending->size;
+    vlc_vector_init(pending);
+
+    if (vlc_playlist_HasItemUpdatedListeners(playlist))
+    {
+        qsort(media, count, sizeof (*media), vlc_playlist_CompareMedia);
+
+        /* remove the duplicates */
+        size_t unique = 1;
+        for (size_t i = 1; i < count; ++i)
+            if (media[i] != media[unique - 1])
+                media[unique++] = media[i];
+            else
+                input_item_Release(media[i]);
+        count = unique;
+
+        vlc_playlist_item_t *current = playlist->current != -1
+            ? playlist_items_Get(&playlist->items, playlist->current)
+            : NULL;
+        if (count == 1 && current != NULL && current->media == media[0])
+        {
+            /* the player typically sends events for the current item, so we
+             * can often avoid to search */
+            vlc_playlist_Notify(playlist, on_items_updated, playlist->current,
+                                &current, 1);
+            goto end;
+        }
+
+        /* a single pass over the playlist resolves all the indices, instead
+         * of one linear search per media */
+        playlist_item_vector_t found = VLC_VECTOR_INITIALIZER;
+        struct VLC_VECTOR(size_t) indices = VLC_VECTOR_INITIALIZER;
+        vlc_playlist_item_t *item;
+        size_t index = 0;
+        bool ok = true;
+
+        playlist_items_foreach(item, &playlist->items)
+        {
+            if (ok && bsearch(&item->media, media, count, sizeof (*media),
+                              vlc_playlist_CompareMedia) != NULL)
+                ok = vlc_vector_push(&found, item)
+                  && vlc_vector_push(&indices, index);
+            index++;
+        }
+
+        /* notify consecutive items at once */
+        size_t n = indices.size; /* found may have one more on error */
+        size_t first = 0;
+        for (size_t i = 1; i <= n; ++i)
+            if (i == n || indices.data[i] != indices.data[i - 1] + 1)
+            {
+                vlc_playlist_Notify(playlist, on_items_updated,
+                                    indices.data[first], &found.data[first],
+                                    i - first);
+                first = i;
+            }
+
+        vlc_vector_destroy(&found);
+        vlc_vector_destroy(&indices);
+    }
+
+end:
+    for (size_t i = 0; i < count; ++i)
+        input_item_Release(media[i]);
+    free(media);
+}
+
+#ifndef TEST_PLAYLIST
+static void
+vlc_playlist_OnUpdateTimer(void *data)
+{
+    vlc_playlist_t *playlist = data;
+
+    vlc_playlist_Lock(playlist);
+    playlist->updates.scheduled = false;
+    vlc_playlist_FlushUpdates(playlist);
+    vlc_playlist_Unlock(playlist);
+}
+#endif
+
+void
+vlc_playlist_UpdatesInit(vlc_playlist_t *playlist)
+{
+    vlc_vector_init(&playlist->updates.media);
+    playlist->updates.scheduled = false;
+#ifdef TEST_PLAYLIST
+    /* report the updates synchronously in tests */
+    playlist->updates.has_timer = false;
+#else
+    playlist->updates.has_timer =
+        vlc_timer_create(&playlist->updates.timer, vlc_playlist_OnUpdateTimer,
+                         playlist) == 0;
+#endif
+}
+
+void
+vlc_playlist_UpdatesDestroy(vlc_playlist_t *playlist)
+{
+    if (playlist->updates.has_timer)
+        vlc_timer_destroy(playlist->updates.timer);
+
+    input_item_t *media;
+    vlc_vector_foreach(media, &playlist->updates.media)
+        input_item_Release(media);
+    vlc_vector_destroy(&playlist->updates.media);
+}
+
 void
 vlc_playlist_NotifyMediaUpdated(vlc_playlist_t *playlist, input_item_t *media)
 {
@@ -117,19 +260,18 @@ vlc_playlist_NotifyMediaUpdated(vlc_playlist_t *playlist, input_item_t *media)
         /* no need to find the index if there are no listeners */
         return;
 
-    ssize_t index;
-    if (playlist->current != -1 &&
-            playlist->items.data[playlist->current]->media == media)
-        /* the player typically sends events for the current item, so we can
-         * often avoid to search */
-        index = playlist->current;
-    else
+    /* updates are frequent (metadata changes, preparsing of many items), so
+     * they are coalesced and reported at most every PLAYLIST_UPDATE_DELAY */
+    if (!vlc_vector_push(&playlist->updates.media, media))
+        return;
+    input_item_Hold(media);
+
+    if (!playlist->updates.has_timer)
+        vlc_playlist_FlushUpdates(playlist);
+    else if (!playlist->updates.scheduled)
     {
-        /* linear search */
-        index = vlc_playlist_IndexOfMedia(playlist, media);
-        if (index == -1)
-            return;
+        vlc_timer_schedule(playlist->updates.timer, false,
+                           PLAYLIST_UPDATE_DELAY, VLC_TIMER_FIRE_ONCE);
+        playlist->updates.scheduled = true;
     }
-    vlc_playlist_Notify(playlist, on_items_updated, index,
-                        &playlist->items.data[index], 1);
 }
@@ -64,6 +64,20 @@ void
 vlc_playlist_state_NotifyChanges(vlc_playlist_t *playlist,
                                  struct vlc_playlist_state *saved_state);
 
+/* delay between the reports of the items updates */
+#define PLAYLIST_UPDATE_DELAY VLC_TICK_FROM_MS(100)
+
+void
+vlc_playlist_UpdatesInit(vlc_playlist_t *playlist);
+
+void
+vlc_playlist_UpdatesDestroy(vlc_playlist_t *playlist);
+
+/** Report the pending updates immediately */
+void
+vlc_playlist_FlushUpdates(vlc_playlist_t *playlist);
+
+/** Report (later) that the items of a media have been updated */
 void
 vlc_playlist_NotifyMediaUpdated(vlc_playlist_t *playlist, input_item_t *media);
 
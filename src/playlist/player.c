@@ -42,7 +42,7 @@ player_on_current_media_changed(vlc_player_t *player, input_item_t *new_media,
     vlc_playlist_AssertLocked(playlist);
 
     input_item_t *media = playlist->current != -1
-                        ? playlist->items.data[playlist->current]->media
+                        ? vlc_playlist_Get(playlist, playlist->current)->media
                         : NULL;
     if (new_media == media)
         /* nothing to do */
@@ -54,7 +54,7 @@ player_on_current_media_changed(vlc_player_t *player, input_item_t *new_media,
         index = vlc_playlist_IndexOfMedia(playlist, new_media);
         if (index != -1)
         {
-            vlc_playlist_item_t *item = playlist->items.data[index];
+            vlc_playlist_item_t *item = vlc_playlist_Get(playlist, index);
             if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
                 randomizer_Select(&playlist->randomizer, item);
         }
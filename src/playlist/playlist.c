@@ -28,6 +28,7 @@
 
 #include "content.h"
 #include "item.h"
+#include "notify.h"
 #include "player.h"
 
 vlc_playlist_t *
@@ -44,7 +45,7 @@ vlc_playlist_New(vlc_object_t *parent)
         return NULL;
     }
 
-    vlc_vector_init(&playlist->items);
+    playlist_items_Init(&playlist->items);
     randomizer_Init(&playlist->randomizer);
     playlist->current = -1;
     playlist->has_prev = false;
@@ -53,6 +54,7 @@ vlc_playlist_New(vlc_object_t *parent)
     playlist->repeat = VLC_PLAYLIST_PLAYBACK_REPEAT_NONE;
     playlist->order = VLC_PLAYLIST_PLAYBACK_ORDER_NORMAL;
     playlist->idgen = 0;
+    vlc_playlist_UpdatesInit(playlist);
 #ifdef TEST_PLAYLIST
     playlist->libvlc = NULL;
     playlist->auto_preparse = false;
@@ -70,9 +72,11 @@ vlc_playlist_Delete(vlc_playlist_t *playlist)
 {
     assert(vlc_list_is_empty(&playlist->listeners));
 
+    vlc_playlist_UpdatesDestroy(playlist);
     vlc_playlist_PlayerDestroy(playlist);
     randomizer_Destroy(&playlist->randomizer);
     vlc_playlist_ClearItems(playlist);
+    playlist_items_Destroy(&playlist->items);
     free(playlist);
 }
 
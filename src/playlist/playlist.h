@@ -25,6 +25,7 @@
 #include <vlc_playlist.h>
 #include <vlc_vector.h>
 #include "../player/player.h"
+#include "items.h"
 #include "randomizer.h"
 
 typedef struct input_item_t input_item_t;
@@ -44,6 +45,7 @@ typedef struct input_item_t input_item_t;
 #endif /* TEST_PLAYLIST */
 
 typedef struct VLC_VECTOR(vlc_playlist_item_t *) playlist_item_vector_t;
+typedef struct VLC_VECTOR(input_item_t *) playlist_media_vector_t;
 
 struct vlc_playlist
 {
@@ -52,7 +54,7 @@ struct vlc_playlist
     bool auto_preparse;
     /* all remaining fields are protected by the lock of the player */
     struct vlc_player_listener_id *player_listener;
-    playlist_item_vector_t items;
+    struct playlist_items items;
     struct randomizer randomizer;
     ssize_t current;
     bool has_prev;
@@ -61,6 +63,12 @@ struct vlc_playlist
     enum vlc_playlist_playback_repeat repeat;
     enum vlc_playlist_playback_order order;
     uint64_t idgen;
+    struct {
+        playlist_media_vector_t media; /**< updated media not reported yet */
+        vlc_timer_t timer;
+        bool has_timer;
+        bool scheduled;
+    } updates;
 };
 
 /* Also disable vlc_assert_locked in tests since the symbol is not exported */
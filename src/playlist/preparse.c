@@ -99,10 +99,7 @@ on_preparse_ended(input_item_t *media,
         return;
 
     vlc_playlist_Lock(playlist);
-    ssize_t index = vlc_playlist_IndexOfMedia(playlist, media);
-    if (index != -1)
-        vlc_playlist_Notify(playlist, on_items_updated, index,
-                            &playlist->items.data[index], 1);
+    vlc_playlist_NotifyMediaUpdated(playlist, media);
     vlc_playlist_Unlock(playlist);
 }
 
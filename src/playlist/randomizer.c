@@ -524,12 +524,70 @@ randomizer_RemoveOne(struct randomizer *r, const vlc_playlist_item_t *item)
     randomizer_RemoveAt(r, index);
 }
 
+static int
+cmp_item_ptr(const void *lhs, const void *rhs)
+{
+    uintptr_t a = (uintptr_t) *(vlc_playlist_item_t *const *) lhs;
+    uintptr_t b = (uintptr_t) *(vlc_playlist_item_t *const *) rhs;
+    return a < b ? -1 : a > b;
+}
+
+/* Remove several items in a single pass, instead of searching and shifting
+ * the vector once per item. */
+static void
+randomizer_RemoveSorted(struct randomizer *r,
+                        vlc_playlist_item_t *const sorted[], size_t count)
+{
+    /*
+     * A stable compaction gives the same result as removing the items one by
+     * one: the determined range and the history range stay ordered (the
+     * order of the middle part is irrelevant), and each index moves back by
+     * the number of items removed before it.
+     */
+    size_t head = r->head;
+    size_t next = r->next;
+    size_t history = r->history;
+    size_t kept = 0;
+
+    for (size_t i = 0; i < r->items.size; ++i)
+    {
+        vlc_playlist_item_t *item = r->items.data[i];
+        if (bsearch(&item, sorted, count, sizeof(*sorted), cmp_item_ptr))
+        {
+            if (i < r->head)
+                head--;
+            if (i < r->next)
+                next--;
+            if (i < r->history)
+                history--;
+        }
+        else
+            r->items.data[kept++] = item;
+    }
+
+    assert(r->items.size - kept == count); /* items must exist */
+    r->items.size = kept;
+    r->head = head;
+    r->next = next;
+    r->history = history;
+}
+
 void
 randomizer_Remove(struct randomizer *r, vlc_playlist_item_t *const items[],
                   size_t count)
 {
-    for (size_t i = 0; i < count; ++i)
-        randomizer_RemoveOne(r, items[i]);
+    vlc_playlist_item_t **sorted =
+        count > 1 ? vlc_alloc(count, sizeof(*sorted)) : NULL;
+    if (sorted)
+    {
+        memcpy(sorted, items, count * sizeof(*sorted));
+        qsort(sorted, count, sizeof(*sorted), cmp_item_ptr);
+        randomizer_RemoveSorted(r, sorted, count);
+        free(sorted);
+    }
+    else
+        for (size_t i = 0; i < count; ++i)
+            randomizer_RemoveOne(r, items[i]);
 
     vlc_vector_autoshrink(&r->items);
 }
@@ -1190,6 +1248,81 @@ test_loop_respect_not_same_before_impossible(void)
     #undef SIZE
 }
 
+static void
+test_remove_many_keeps_order(void)
+{
+    struct randomizer randomizer;
+    randomizer_Init(&randomizer);
+    randomizer_SetLoop(&randomizer, true);
+
+    #define SIZE 1000
+    vlc_playlist_item_t *items[SIZE];
+    ArrayInit(items, SIZE);
+
+    bool ok = randomizer_Add(&randomizer, items, SIZE);
+    assert(ok);
+
+    /* complete a first cycle, then start the second one */
+    for (int i = 0; i < SIZE + 300; ++i)
+    {
+        vlc_playlist_item_t *item = randomizer_Next(&randomizer);
+        assert(item);
+    }
+
+    /* go back into the history of the first cycle */
+    for (int i = 0; i < 400; ++i)
+    {
+        assert(randomizer_HasPrev(&randomizer));
+        randomizer_Prev(&randomizer);
+    }
+
+    /* remember the expected order with the items removed one by one */
+    struct randomizer expected;
+    randomizer_Init(&expected);
+    randomizer_SetLoop(&expected, true);
+    ok = randomizer_Add(&expected, randomizer.items.data, randomizer.items.size);
+    assert(ok);
+    expected.head = randomizer.head;
+    expected.next = randomizer.next;
+    expected.history = randomizer.history;
+
+    /* remove one item out of three, in every range */
+    vlc_playlist_item_t *to_remove[SIZE / 3 + 1];
+    size_t remove_count = 0;
+    for (int i = 0; i < SIZE; i += 3)
+        to_remove[remove_count++] = items[i];
+
+    randomizer_Remove(&randomizer, to_remove, remove_count);
+    for (size_t i = 0; i < remove_count; ++i)
+        randomizer_Remove(&expected, &to_remove[i], 1);
+
+    assert(randomizer.items.size == SIZE - remove_count);
+    assert(randomizer.head == expected.head);
+    assert(randomizer.next == expected.next);
+    assert(randomizer.history == expected.history);
+
+    /* the determined and history ranges must be identical */
+    for (size_t i = 0; i < randomizer.head; ++i)
+        assert(randomizer.items.data[i] == expected.items.data[i]);
+    for (size_t i = randomizer.history; i < randomizer.items.size; ++i)
+        assert(randomizer.items.data[i] == expected.items.data[i]);
+
+    /* so is the navigation back in the history */
+    while (randomizer_HasPrev(&randomizer))
+    {
+        assert(randomizer_HasPrev(&expected));
+        vlc_playlist_item_t *item = randomizer_Prev(&randomizer);
+        assert(item->index % 3 != 0); /* never a removed item */
+        assert(item == randomizer_Prev(&expected));
+    }
+    assert(!randomizer_HasPrev(&expected));
+
+    randomizer_Destroy(&expected);
+    ArrayDestroy(items, SIZE);
+    randomizer_Destroy(&randomizer);
+    #undef SIZE
+}
+
 static void
 test_has_prev_next_empty(void)
 {
@@ -1224,6 +1357,7 @@ int main(void)
     test_prev_across_reshuffle_loops();
     test_loop_respect_not_same_before();
     test_loop_respect_not_same_before_impossible();
+    test_remove_many_keeps_order();
     test_has_prev_next_empty();
 }
 
@@ -33,30 +33,38 @@ void
 vlc_playlist_Shuffle(vlc_playlist_t *playlist)
 {
     vlc_playlist_AssertLocked(playlist);
-    if (playlist->items.size < 2)
+    if (vlc_playlist_Count(playlist) < 2)
         /* we use size_t (unsigned), so the following loop would be incorrect */
         return;
 
     vlc_playlist_item_t *current = playlist->current != -1
-                                 ? playlist->items.data[playlist->current]
+                                 ? vlc_playlist_Get(playlist, playlist->current)
                                  : NULL;
 
+    /* shuffle a flat copy, random accesses in the chunks would be slower */
+    size_t count = vlc_playlist_Count(playlist);
+    vlc_playlist_item_t **items = playlist_items_Flatten(&playlist->items);
+    if (unlikely(!items))
+        return;
+
     /* initialize separately instead of using vlc_lrand48() to avoid locking the
      * mutex once for each item */
     unsigned short xsubi[3];
     vlc_rand_bytes(xsubi, sizeof(xsubi));
 
     /* Fisher-Yates shuffle */
-    for (size_t i = playlist->items.size - 1; i != 0; --i)
+    for (size_t i = count - 1; i != 0; --i)
     {
         size_t selected = (size_t) (nrand48(xsubi) % (i + 1));
 
         /* swap items i and selected */
-        vlc_playlist_item_t *tmp = playlist->items.data[i];
-        playlist->items.data[i] = playlist->items.data[selected];
-        playlist->items.data[selected] = tmp;
+        vlc_playlist_item_t *tmp = items[i];
+        items[i] = items[selected];
+        items[selected] = tmp;
     }
 
+    playlist_items_Assign(&playlist->items, items);
+
     struct vlc_playlist_state state;
     if (current)
     {
@@ -67,8 +75,9 @@ vlc_playlist_Shuffle(vlc_playlist_t *playlist)
         playlist->has_next = vlc_playlist_ComputeHasNext(playlist);
     }
 
-    vlc_playlist_Notify(playlist, on_items_reset, playlist->items.data,
-                        playlist->items.size);
+    vlc_playlist_Notify(playlist, on_items_reset, items, count);
     if (current)
         vlc_playlist_state_NotifyChanges(playlist, &state);
+
+    free(items);
 }
@@ -31,16 +31,26 @@
 #include "notify.h"
 #include "playlist.h"
 
+/* sort the playlist with several threads from this size */
+#define SORT_PARALLEL_MIN 16384
+#define SORT_SLICES_MAX 16
+
 /**
  * Struct containing a copy of (parsed) media metadata, used for sorting
  * without locking all the items.
+ *
+ * The strings compared by collation are stored with their collation key, and
+ * the strings compared case-insensitively are stored folded, so that the
+ * comparisons are simple strcmp() calls.
  */
 struct vlc_playlist_item_meta {
     vlc_playlist_item_t *item;
     const char *title_or_name;
+    const char *title_or_name_key;
     vlc_tick_t duration;
     const char *artist;
     const char *album;
+    const char *album_key;
     const char *album_artist;
     const char *genre;
     const char *url;
@@ -68,6 +78,50 @@ vlc_playlist_item_meta_CopyString(const char **to, const char *from)
     return VLC_SUCCESS;
 }
 
+static int
+vlc_playlist_item_meta_CopyFoldedString(const char **to, const char *from)
+{
+    if (from)
+    {
+        char *str = strdup(from);
+        if (unlikely(!str))
+            return VLC_ENOMEM;
+        /* same as strcasecmp() for ASCII and UTF-8 */
+        for (char *c = str; *c; ++c)
+            if (*c >= 'A' && *c <= 'Z')
+                *c += 'a' - 'A';
+        *to = str;
+    }
+    else
+        *to = NULL;
+    return VLC_SUCCESS;
+}
+
+/* Copy a string followed by its collation key, in the same allocation */
+static int
+vlc_playlist_item_meta_CopyCollatedString(const char **to, const char **key,
+                                          const char *from)
+{
+    if (from)
+    {
+        size_t len = strlen(from) + 1;
+        size_t key_len = strxfrm(NULL, from, 0) + 1;
+        char *str = malloc(len + key_len);
+        if (unlikely(!str))
+            return VLC_ENOMEM;
+        memcpy(str, from, len);
+        strxfrm(str + len, from, key_len);
+        *to = str;
+        *key = str + len;
+    }
+    else
+    {
+        *to = NULL;
+        *key = NULL;
+    }
+    return VLC_SUCCESS;
+}
+
 static int
 vlc_playlist_item_meta_InitField(struct vlc_playlist_item_meta *meta,
                                  enum vlc_playlist_sort_key key)
@@ -80,8 +134,8 @@ vlc_playlist_item_meta_InitField(struct vlc_playlist_item_meta *meta,
             const char *value = input_item_GetMetaLocked(media, vlc_meta_Title);
             if (EMPTY_STR(value))
                 value = media->psz_name;
-            return vlc_playlist_item_meta_CopyString(&meta->title_or_name,
-                                                     value);
+            return vlc_playlist_item_meta_CopyCollatedString(
+                    &meta->title_or_name, &meta->title_or_name_key, value);
         }
         case VLC_PLAYLIST_SORT_KEY_DURATION:
         {
@@ -96,24 +150,28 @@ vlc_playlist_item_meta_InitField(struct vlc_playlist_item_meta *meta,
         {
             const char *value = input_item_GetMetaLocked(media,
                                                          vlc_meta_Artist);
-            return vlc_playlist_item_meta_CopyString(&meta->artist, value);
+            return vlc_playlist_item_meta_CopyFoldedString(&meta->artist,
+                                                           value);
         }
         case VLC_PLAYLIST_SORT_KEY_ALBUM:
         {
             const char *value = input_item_GetMetaLocked(media, vlc_meta_Album);
-            return vlc_playlist_item_meta_CopyString(&meta->album, value);
+            return vlc_playlist_item_meta_CopyCollatedString(&meta->album,
+                                                             &meta->album_key,
+                                                             value);
         }
         case VLC_PLAYLIST_SORT_KEY_ALBUM_ARTIST:
         {
             const char *value = input_item_GetMetaLocked(media,
                                                          vlc_meta_AlbumArtist);
-            return vlc_playlist_item_meta_CopyString(&meta->album_artist,
-                                                     value);
+            return vlc_playlist_item_meta_CopyFoldedString(&meta->album_artist,
+                                                           value);
         }
         case VLC_PLAYLIST_SORT_KEY_GENRE:
         {
             const char *value = input_item_GetMetaLocked(media, vlc_meta_Genre);
-            return vlc_playlist_item_meta_CopyString(&meta->genre, value);
+            return vlc_playlist_item_meta_CopyFoldedString(&meta->genre,
+                                                           value);
         }
         case VLC_PLAYLIST_SORT_KEY_DATE:
         {
@@ -188,16 +246,12 @@ vlc_playlist_item_meta_InitFields(struct vlc_playlist_item_meta *meta,
     return VLC_SUCCESS;
 }
 
-static struct vlc_playlist_item_meta *
-vlc_playlist_item_meta_New(vlc_playlist_item_t *item,
-                           const struct vlc_playlist_sort_criterion criteria[],
-                           size_t count)
+static int
+vlc_playlist_item_meta_Init(struct vlc_playlist_item_meta *meta,
+                            vlc_playlist_item_t *item,
+                            const struct vlc_playlist_sort_criterion criteria[],
+                            size_t count)
 {
-    /* assume that NULL representation is all-zeros */
-    struct vlc_playlist_item_meta *meta = calloc(1, sizeof(*meta));
-    if (unlikely(!meta))
-        return NULL;
-
     meta->item = item;
 
     vlc_mutex_lock(&item->media->lock);
@@ -205,36 +259,53 @@ vlc_playlist_item_meta_New(vlc_playlist_item_t *item,
     vlc_mutex_unlock(&item->media->lock);
 
     if (unlikely(ret != VLC_SUCCESS))
-    {
-        free(meta);
-        return NULL;
-    }
-
-    return meta;
-}
+        /* the fields have been destroyed, reset them to be destroyed again */
+        memset(meta, 0, sizeof(*meta));
 
-static void
-vlc_playlist_item_meta_Delete(struct vlc_playlist_item_meta *meta)
-{
-    vlc_playlist_item_meta_DestroyFields(meta);
-    free(meta);
+    return ret;
 }
 
 static inline int
 CompareStrings(const char *a, const char *b)
 {
     if (a && b)
-        return strcasecmp(a, b);
+        /* already folded */
+        return strcmp(a, b);
     if (!a && !b)
         return 0;
     return a ? 1 : -1;
 }
 
+/* Same as vlc_filenamecmp(), using the collation keys instead of strcoll() */
+static int
+CompareFilenameKeys(const char *a, const char *key_a,
+                    const char *b, const char *key_b)
+{
+    size_t i;
+    char ca, cb;
+
+    for (i = 0; (ca = a[i]) == (cb = b[i]); i++)
+        if (ca == '\0')
+            return 0;
+
+    if ((unsigned)(ca - '0') > 9 || (unsigned)(cb - '0') > 9)
+        return strcmp(key_a, key_b);
+
+    unsigned long long ua = strtoull(a + i, NULL, 10);
+    unsigned long long ub = strtoull(b + i, NULL, 10);
+
+    if (ua == ub)
+        return strcmp(key_a, key_b);
+
+    return (ua > ub) ? +1 : -1;
+}
+
 static inline int
-CompareFilenameStrings(const char *a, const char *b)
+CompareFilenameStrings(const char *a, const char *key_a,
+                       const char *b, const char *key_b)
 {
     if (a && b)
-        return vlc_filenamecmp(a, b);
+        return CompareFilenameKeys(a, key_a, b, key_b);
     if (!a && !b)
         return 0;
     return a ? 1 : -1;
@@ -280,13 +351,17 @@ CompareMetaByKey(const struct vlc_playlist_item_meta *a,
     switch (key)
     {
         case VLC_PLAYLIST_SORT_KEY_TITLE:
-            return CompareFilenameStrings(a->title_or_name, b->title_or_name);
+            return CompareFilenameStrings(a->title_or_name,
+                                          a->title_or_name_key,
+                                          b->title_or_name,
+                                          b->title_or_name_key);
         case VLC_PLAYLIST_SORT_KEY_DURATION:
             return CompareIntegers(a->duration, b->duration);
         case VLC_PLAYLIST_SORT_KEY_ARTIST:
             return CompareStrings(a->artist, b->artist);
         case VLC_PLAYLIST_SORT_KEY_ALBUM:
-            return CompareFilenameStrings(a->album, b->album);
+            return CompareFilenameStrings(a->album, a->album_key,
+                                          b->album, b->album_key);
         case VLC_PLAYLIST_SORT_KEY_ALBUM_ARTIST:
             return CompareStrings(a->album_artist, b->album_artist);
         case VLC_PLAYLIST_SORT_KEY_GENRE:
@@ -342,41 +417,89 @@ compare_meta(const void *lhs, const void *rhs, void *userdata)
     return 0;
 }
 
-static void
-vlc_playlist_DeleteMetaArray(struct vlc_playlist_item_meta *array[],
-                             size_t count)
+/* one part of the playlist, prepared and sorted by one thread */
+struct sort_slice
 {
-    for (size_t i = 0; i < count; ++i)
-        vlc_playlist_item_meta_Delete(array[i]);
-    free(array);
-}
+    const struct sort_request *req;
+    vlc_playlist_item_t **items;
+    struct vlc_playlist_item_meta *metas;
+    struct vlc_playlist_item_meta **array;
+    size_t count;
+    int ret;
+    vlc_thread_t thread;
+    bool joinable;
+};
 
-static struct vlc_playlist_item_meta **
-vlc_playlist_NewMetaArray(vlc_playlist_t *playlist,
-        const struct vlc_playlist_sort_criterion criteria[], size_t count)
+static void *
+vlc_playlist_SortSlice(void *data)
 {
-    struct vlc_playlist_item_meta **array =
-            vlc_alloc(playlist->items.size, sizeof(*array));
+    struct sort_slice *slice = data;
+    const struct sort_request *req = slice->req;
 
-    if (unlikely(!array))
-        return NULL;
-
-    size_t i;
-    for (i = 0; i < playlist->items.size; ++i)
+    for (size_t i = 0; i < slice->count; ++i)
     {
-        array[i] = vlc_playlist_item_meta_New(playlist->items.data[i],
-                                              criteria, count);
-        if (unlikely(!array[i]))
-            break;
+        int ret = vlc_playlist_item_meta_Init(&slice->metas[i],
+                                              slice->items[i], req->criteria,
+                                              req->count);
+        if (unlikely(ret != VLC_SUCCESS))
+        {
+            slice->ret = ret;
+            return NULL;
+        }
+        slice->array[i] = &slice->metas[i];
     }
 
-    if (i < playlist->items.size)
+    vlc_qsort(slice->array, slice->count, sizeof(*slice->array), compare_meta,
+              (void *) req);
+    slice->ret = VLC_SUCCESS;
+    return NULL;
+}
+
+static void
+vlc_playlist_MergeSlices(struct vlc_playlist_item_meta **dst,
+                         struct vlc_playlist_item_meta *const a[], size_t na,
+                         struct vlc_playlist_item_meta *const b[], size_t nb,
+                         const struct sort_request *req)
+{
+    size_t i = 0, j = 0;
+    while (i < na && j < nb)
+        /* take from the left on equality, like a stable merge */
+        *dst++ = compare_meta(&b[j], &a[i], (void *) req) < 0 ? b[j++]
+                                                              : a[i++];
+    while (i < na)
+        *dst++ = a[i++];
+    while (j < nb)
+        *dst++ = b[j++];
+}
+
+/* Merge the sorted slices pairwise, return the array holding the result */
+static struct vlc_playlist_item_meta **
+vlc_playlist_MergeAll(struct vlc_playlist_item_meta **array,
+                      struct vlc_playlist_item_meta **tmp,
+                      size_t bounds[], size_t slice_count,
+                      const struct sort_request *req)
+{
+    while (slice_count > 1)
     {
-        /* allocation failure */
-        vlc_playlist_DeleteMetaArray(array, i);
-        return NULL;
-    }
+        size_t merged = 0;
+        for (size_t i = 0; i < slice_count; i += 2)
+        {
+            size_t begin = bounds[i];
+            size_t middle = bounds[i + 1];
+            size_t end = i + 2 <= slice_count ? bounds[i + 2] : middle;
+
+            vlc_playlist_MergeSlices(&tmp[begin], &array[begin],
+                                     middle - begin, &array[middle],
+                                     end - middle, req);
+            bounds[merged++] = begin;
+        }
+        bounds[merged] = bounds[slice_count];
+        slice_count = merged;
 
+        struct vlc_playlist_item_meta **swap = array;
+        array = tmp;
+        tmp = swap;
+    }
     return array;
 }
 
@@ -389,23 +512,84 @@ vlc_playlist_Sort(vlc_playlist_t *playlist,
     vlc_playlist_AssertLocked(playlist);
 
     vlc_playlist_item_t *current = playlist->current != -1
-                                 ? playlist->items.data[playlist->current]
+                                 ? vlc_playlist_Get(playlist, playlist->current)
                                  : NULL;
 
-    struct vlc_playlist_item_meta **array =
-        vlc_playlist_NewMetaArray(playlist, criteria, count);
-    if (unlikely(!array))
-        return VLC_ENOMEM;
+    size_t size = vlc_playlist_Count(playlist);
+    if (size == 0)
+    {
+        vlc_playlist_Notify(playlist, on_items_reset, NULL, 0);
+        return VLC_SUCCESS;
+    }
+
+    size_t slice_count = 1;
+    if (size >= SORT_PARALLEL_MIN)
+    {
+        slice_count = vlc_GetCPUCount();
+        if (slice_count > SORT_SLICES_MAX)
+            slice_count = SORT_SLICES_MAX;
+        if (slice_count > size / (SORT_PARALLEL_MIN / 4))
+            slice_count = size / (SORT_PARALLEL_MIN / 4);
+    }
+
+    int ret = VLC_ENOMEM;
+    vlc_playlist_item_t **items = playlist_items_Flatten(&playlist->items);
+    /* assume that NULL representation is all-zeros */
+    struct vlc_playlist_item_meta *metas = calloc(size, sizeof(*metas));
+    struct vlc_playlist_item_meta **array = vlc_alloc(size, sizeof(*array));
+    struct vlc_playlist_item_meta **tmp = slice_count > 1
+                                        ? vlc_alloc(size, sizeof(*tmp))
+                                        : NULL;
+    struct sort_slice *slices = vlc_alloc(slice_count, sizeof(*slices));
+    size_t *bounds = vlc_alloc(slice_count + 1, sizeof(*bounds));
+    if (unlikely(!items || !metas || !array || !slices || !bounds
+              || (slice_count > 1 && !tmp)))
+        goto end;
 
     struct sort_request req = { criteria, count };
 
-    vlc_qsort(array, playlist->items.size, sizeof(*array), compare_meta, &req);
+    for (size_t i = 0; i < slice_count; ++i)
+    {
+        struct sort_slice *slice = &slices[i];
+        size_t begin = size * i / slice_count;
+        size_t end = size * (i + 1) / slice_count;
+
+        bounds[i] = begin;
+        slice->req = &req;
+        slice->items = &items[begin];
+        slice->metas = &metas[begin];
+        slice->array = &array[begin];
+        slice->count = end - begin;
+        slice->ret = VLC_ENOMEM;
+        /* the last slice is sorted by this thread */
+        slice->joinable = i < slice_count - 1
+                       && vlc_clone(&slice->thread, vlc_playlist_SortSlice,
+                                    slice, VLC_THREAD_PRIORITY_LOW) == 0;
+        if (!slice->joinable && i < slice_count - 1)
+            vlc_playlist_SortSlice(slice);
+    }
+    bounds[slice_count] = size;
+    vlc_playlist_SortSlice(&slices[slice_count - 1]);
 
-    /* apply the sorting result to the playlist */
-    for (size_t i = 0; i < playlist->items.size; ++i)
-        playlist->items.data[i] = array[i]->item;
+    ret = VLC_SUCCESS;
+    for (size_t i = 0; i < slice_count; ++i)
+    {
+        struct sort_slice *slice = &slices[i];
+        if (slice->joinable)
+            vlc_join(slice->thread, NULL);
+        if (slice->ret != VLC_SUCCESS)
+            ret = slice->ret;
+    }
+    if (unlikely(ret != VLC_SUCCESS))
+        goto end;
+
+    struct vlc_playlist_item_meta **sorted =
+        vlc_playlist_MergeAll(array, tmp, bounds, slice_count, &req);
 
-    vlc_playlist_DeleteMetaArray(array, playlist->items.size);
+    /* apply the sorting result to the playlist */
+    for (size_t i = 0; i < size; ++i)
+        items[i] = sorted[i]->item;
+    playlist_items_Assign(&playlist->items, items);
 
     struct vlc_playlist_state state;
     if (current)
@@ -417,10 +601,19 @@ vlc_playlist_Sort(vlc_playlist_t *playlist,
         playlist->has_next = vlc_playlist_ComputeHasNext(playlist);
     }
 
-    vlc_playlist_Notify(playlist, on_items_reset, playlist->items.data,
-                        playlist->items.size);
+    vlc_playlist_Notify(playlist, on_items_reset, items, size);
     if (current)
         vlc_playlist_state_NotifyChanges(playlist, &state);
 
-    return VLC_SUCCESS;
+end:
+    if (metas)
+        for (size_t i = 0; i < size; ++i)
+            vlc_playlist_item_meta_DestroyFields(&metas[i]);
+    free(bounds);
+    free(slices);
+    free(tmp);
+    free(array);
+    free(metas);
+    free(items);
+    return ret;
 }
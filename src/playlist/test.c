@@ -29,6 +29,8 @@
 #include "playlist.h"
 #include "preparse.h"
 
+#include <vlc_strings.h>
+
 /* the playlist lock is the one of the player */
 # define vlc_playlist_Lock(p) VLC_UNUSED(p);
 # define vlc_playlist_Unlock(p) VLC_UNUSED(p);
@@ -269,7 +271,7 @@ test_expand_item(void)
     assert(ret == VLC_SUCCESS);
 
     /* create a subtree for item 8 with 4 children */
-    input_item_t *item_to_expand = playlist->items.data[8]->media;
+    input_item_t *item_to_expand = vlc_playlist_Get(playlist, 8)->media;
     input_item_node_t *root = input_item_node_Create(item_to_expand);
     for (int i = 0; i < 4; ++i)
     {
@@ -2349,6 +2351,161 @@ test_sort(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+CheckItems(vlc_playlist_t *playlist, input_item_t *const ref[], size_t count)
+{
+    assert(vlc_playlist_Count(playlist) == count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        vlc_playlist_item_t *item = vlc_playlist_Get(playlist, i);
+        assert(item->media == ref[i]);
+        assert(vlc_playlist_IndexOf(playlist, item) == (ssize_t) i);
+    }
+}
+
+static void
+test_many_items(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    /* enough items to use many chunks */
+    enum { COUNT = 5000 };
+    input_item_t **media = malloc(COUNT * sizeof(*media));
+    input_item_t **ref = malloc(COUNT * sizeof(*ref));
+    assert(media && ref);
+    CreateDummyMediaArray(media, COUNT);
+
+    unsigned seed = 42;
+#define RAND(n) ((seed = seed * 1103515245 + 12345) / 65536 % (n))
+
+    size_t count = 0;
+    size_t next = 0;
+    for (int round = 0; round < 200; ++round)
+    {
+        /* insert a batch at a random position */
+        size_t n = RAND(COUNT / 10) + 1;
+        if (n > COUNT - next)
+            n = COUNT - next;
+        if (n > 0)
+        {
+            size_t index = RAND(count + 1);
+            int ret = vlc_playlist_Insert(playlist, index, &media[next], n);
+            assert(ret == VLC_SUCCESS);
+            memmove(&ref[index + n], &ref[index],
+                    (count - index) * sizeof(*ref));
+            memcpy(&ref[index], &media[next], n * sizeof(*ref));
+            count += n;
+            next += n;
+        }
+
+        /* move a slice */
+        if (count > 1)
+        {
+            n = RAND(count) + 1;
+            size_t index = RAND(count - n + 1);
+            size_t target = RAND(count - n + 1);
+            vlc_playlist_Move(playlist, index, n, target);
+
+            input_item_t **slice = malloc(n * sizeof(*slice));
+            assert(slice);
+            memcpy(slice, &ref[index], n * sizeof(*ref));
+            memmove(&ref[index], &ref[index + n],
+                    (count - index - n) * sizeof(*ref));
+            memmove(&ref[target + n], &ref[target],
+                    (count - n - target) * sizeof(*ref));
+            memcpy(&ref[target], slice, n * sizeof(*ref));
+            free(slice);
+        }
+
+        /* remove a batch (the media are not reused) */
+        if (count > 0)
+        {
+            n = RAND(count / 2 + 1) + 1;
+            if (n > count)
+                n = count;
+            size_t index = RAND(count - n + 1);
+            vlc_playlist_Remove(playlist, index, n);
+            memmove(&ref[index], &ref[index + n],
+                    (count - index - n) * sizeof(*ref));
+            count -= n;
+        }
+
+        CheckItems(playlist, ref, count);
+    }
+#undef RAND
+
+    vlc_playlist_Clear(playlist);
+    assert(vlc_playlist_Count(playlist) == 0);
+
+    DestroyMediaArray(media, COUNT);
+    free(media);
+    free(ref);
+    vlc_playlist_Delete(playlist);
+}
+
+static void
+test_sort_many_items(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    /* enough items to sort in parallel */
+    enum { COUNT = 40000 };
+    input_item_t **media = malloc(COUNT * sizeof(*media));
+    assert(media);
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        media[i] = CreateDummyMedia((i * 7919) % COUNT);
+        assert(media[i]);
+        media[i]->i_duration = i % 100;
+    }
+
+    int ret = vlc_playlist_Append(playlist, media, COUNT);
+    assert(ret == VLC_SUCCESS);
+
+    playlist->current = 1234;
+
+    struct vlc_playlist_sort_criterion criteria[] = {
+        { VLC_PLAYLIST_SORT_KEY_DURATION, VLC_PLAYLIST_SORT_ORDER_DESCENDING },
+        { VLC_PLAYLIST_SORT_KEY_TITLE, VLC_PLAYLIST_SORT_ORDER_ASCENDING },
+    };
+    ret = vlc_playlist_Sort(playlist, criteria, 2);
+    assert(ret == VLC_SUCCESS);
+
+    assert(vlc_playlist_Count(playlist) == COUNT);
+    assert(vlc_playlist_Get(playlist, playlist->current)->media == media[1234]);
+
+    for (size_t i = 1; i < COUNT; ++i)
+    {
+        input_item_t *prev = vlc_playlist_Get(playlist, i - 1)->media;
+        input_item_t *cur = vlc_playlist_Get(playlist, i)->media;
+        assert(prev->i_duration >= cur->i_duration);
+        if (prev->i_duration == cur->i_duration)
+            assert(vlc_filenamecmp(prev->psz_name, cur->psz_name) <= 0);
+    }
+
+    /* every media is still there exactly once (the names are unique) */
+    bool *seen = calloc(COUNT, sizeof(*seen));
+    assert(seen);
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        vlc_playlist_item_t *item = vlc_playlist_Get(playlist, i);
+        assert(vlc_playlist_IndexOf(playlist, item) == (ssize_t) i);
+
+        int num;
+        ret = sscanf(item->media->psz_name, "item-%d", &num);
+        assert(ret == 1 && num >= 0 && num < COUNT);
+        assert(!seen[num]);
+        seen[num] = true;
+    }
+    free(seen);
+
+    DestroyMediaArray(media, COUNT);
+    free(media);
+    vlc_playlist_Delete(playlist);
+}
+
 #undef EXPECT_AT
 
 int main(void)
@@ -2384,6 +2541,8 @@ int main(void)
     test_random();
     test_shuffle();
     test_sort();
+    test_many_items();
+    test_sort_many_items();
     return 0;
 }
 
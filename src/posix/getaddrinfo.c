@@ -29,6 +29,7 @@
 #include <vlc_common.h>
 #include <vlc_interrupt.h>
 #include <vlc_network.h>
+#include "libvlc.h"
 
 struct vlc_gai_req
 {
@@ -50,9 +51,8 @@ static void *vlc_gai_thread(void *data)
     return NULL;
 }
 
-int vlc_getaddrinfo_i11e(const char *name, unsigned port,
-                         const struct addrinfo *hints,
-                         struct addrinfo **res)
+int vlc_resolve_i11e(const char *name, unsigned port,
+                     const struct addrinfo *hints, struct addrinfo **res)
 {
     struct vlc_gai_req req =
     {
@@ -0,0 +1,234 @@
+/*****************************************************************************
+ * cache.c: preparsing results cache
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_arrays.h>
+#include <vlc_list.h>
+#include <vlc_es.h>
+
+#include "cache.h"
+#include "input/item.h"
+
+struct entry
+{
+    char *path;
+    time_t mtime;
+    off_t size;
+
+    vlc_tick_t duration;
+    vlc_meta_t *meta;
+    int i_es;
+    es_format_t *es;
+
+    struct vlc_list node; /**< node of input_preparser_cache_t.lru */
+};
+
+struct input_preparser_cache_t
+{
+    vlc_mutex_t lock;
+    vlc_dictionary_t entries; /**< entries by path */
+    struct vlc_list lru; /**< entries, the most recently used first */
+    size_t count;
+    size_t max_entries;
+};
+
+static void EntryDelete( struct entry *entry )
+{
+    for( int i = 0; i < entry->i_es; i++ )
+        es_format_Clean( &entry->es[i] );
+    free( entry->es );
+    if( entry->meta )
+        vlc_meta_Delete( entry->meta );
+    free( entry->path );
+    free( entry );
+}
+
+static void EntryFree( void *entry, void *obj )
+{
+    VLC_UNUSED(obj);
+    EntryDelete( entry );
+}
+
+input_preparser_cache_t *input_preparser_cache_New( size_t max_entries )
+{
+    input_preparser_cache_t *cache = malloc( sizeof( *cache ) );
+    if( unlikely(cache == NULL) )
+        return NULL;
+
+    vlc_mutex_init( &cache->lock );
+    vlc_dictionary_init( &cache->entries, 0 );
+    vlc_list_init( &cache->lru );
+    cache->count = 0;
+    cache->max_entries = max_entries;
+    return cache;
+}
+
+void input_preparser_cache_Delete( input_preparser_cache_t *cache )
+{
+    vlc_dictionary_clear( &cache->entries, EntryFree, NULL );
+    free( cache );
+}
+
+static bool EntryMatches( const struct entry *entry, const struct stat *st )
+{
+    return entry->mtime == st->st_mtime && entry->size == st->st_size;
+}
+
+bool input_preparser_cache_Load( input_preparser_cache_t *cache,
+                                 input_item_t *item, const char *path,
+                                 const struct stat *st )
+{
+    vlc_mutex_lock( &cache->lock );
+
+    struct entry *entry = vlc_dictionary_value_for_key( &cache->entries,
+                                                        path );
+    if( entry == NULL )
+        goto miss;
+
+    if( !EntryMatches( entry, st ) )
+    {
+        /* the file changed, the entry is stale */
+        vlc_list_remove( &entry->node );
+        vlc_dictionary_remove_value_for_key( &cache->entries, path,
+                                             EntryFree, NULL );
+        cache->count--;
+        goto miss;
+    }
+
+    vlc_mutex_lock( &item->lock );
+    if( item->p_meta == NULL )
+        item->p_meta = vlc_meta_New();
+    if( unlikely(item->p_meta == NULL) )
+    {
+        vlc_mutex_unlock( &item->lock );
+        goto miss;
+    }
+    if( entry->meta != NULL )
+        vlc_meta_Merge( item->p_meta, entry->meta );
+    vlc_mutex_unlock( &item->lock );
+    input_item_ReclaimMetaSnapshots( item );
+
+    for( int i = 0; i < entry->i_es; i++ )
+        input_item_UpdateTracksInfo( item, &entry->es[i] );
+
+    vlc_tick_t duration = entry->duration;
+
+    /* move the entry at the head of the LRU list */
+    vlc_list_remove( &entry->node );
+    vlc_list_prepend( &entry->node, &cache->lru );
+    vlc_mutex_unlock( &cache->lock );
+
+    /* notify outside of the cache lock */
+    input_item_SetDuration( item, duration );
+    vlc_event_send( &item->event_manager, &(vlc_event_t) {
+        .type = vlc_InputItemMetaChanged,
+        .u.input_item_meta_changed.meta_type = vlc_meta_Title } );
+    return true;
+
+miss:
+    vlc_mutex_unlock( &cache->lock );
+    return false;
+}
+
+static struct entry *EntryNew( input_item_t *item, const char *path,
+                               const struct stat *st )
+{
+    struct entry *entry = calloc( 1, sizeof( *entry ) );
+    if( unlikely(entry == NULL) )
+        return NULL;
+
+    entry->path = strdup( path );
+    entry->meta = vlc_meta_New();
+    if( unlikely(entry->path == NULL || entry->meta == NULL) )
+        goto error;
+    entry->mtime = st->st_mtime;
+    entry->size = st->st_size;
+
+    vlc_mutex_lock( &item->lock );
+    entry->duration = item->i_duration;
+    if( item->p_meta != NULL )
+        vlc_meta_Merge( entry->meta, item->p_meta );
+
+    if( item->i_es > 0 )
+    {
+        entry->es = vlc_alloc( item->i_es, sizeof( *entry->es ) );
+        if( unlikely(entry->es == NULL) )
+        {
+            vlc_mutex_unlock( &item->lock );
+            goto error;
+        }
+        for( ; entry->i_es < item->i_es; entry->i_es++ )
+            es_format_Copy( &entry->es[entry->i_es], item->es[entry->i_es] );
+    }
+    vlc_mutex_unlock( &item->lock );
+
+    /* attachments are not cached, so the art they provide is lost */
+    const char *art = vlc_meta_Get( entry->meta, vlc_meta_ArtworkURL );
+    if( art != NULL && !strncmp( art, "attachment://", 13 ) )
+        vlc_meta_Set( entry->meta, vlc_meta_ArtworkURL, NULL );
+    return entry;
+
+error:
+    EntryDelete( entry );
+    return NULL;
+}
+
+void input_preparser_cache_Save( input_preparser_cache_t *cache,
+                                 input_item_t *item, const char *path,
+                                 const struct stat *st )
+{
+    if( cache->max_entries == 0 )
+        return;
+
+    struct entry *entry = EntryNew( item, path, st );
+    if( entry == NULL )
+        return;
+
+    vlc_mutex_lock( &cache->lock );
+
+    struct entry *old = vlc_dictionary_value_for_key( &cache->entries, path );
+    if( old != NULL )
+    {
+        vlc_list_remove( &old->node );
+        vlc_dictionary_remove_value_for_key( &cache->entries, path,
+                                             EntryFree, NULL );
+        cache->count--;
+    }
+    else if( cache->count >= cache->max_entries )
+    {
+        struct entry *last = vlc_list_last_entry_or_null( &cache->lru,
+                                                          struct entry, node );
+        assert( last != NULL );
+        vlc_list_remove( &last->node );
+        vlc_dictionary_remove_value_for_key( &cache->entries, last->path,
+                                             EntryFree, NULL );
+        cache->count--;
+    }
+
+    vlc_dictionary_insert( &cache->entries, path, entry );
+    vlc_list_prepend( &entry->node, &cache->lru );
+    cache->count++;
+
+    vlc_mutex_unlock( &cache->lock );
+}
@@ -0,0 +1,53 @@
+/*****************************************************************************
+ * cache.h: preparsing results cache
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _INPUT_PREPARSER_CACHE_H
+#define _INPUT_PREPARSER_CACHE_H 1
+
+#include <sys/stat.h>
+#include <vlc_input_item.h>
+
+/**
+ * Cache of the preparsing results of local files.
+ *
+ * The results are indexed by the file path, and are only valid as long as
+ * the modification time and the size of the file are unchanged. The least
+ * recently used results are evicted first.
+ */
+typedef struct input_preparser_cache_t input_preparser_cache_t;
+
+input_preparser_cache_t *input_preparser_cache_New( size_t max_entries );
+void input_preparser_cache_Delete( input_preparser_cache_t * );
+
+/**
+ * Copy the cached results of a file to an item.
+ *
+ * @return true if the results were found and applied
+ */
+bool input_preparser_cache_Load( input_preparser_cache_t *, input_item_t *,
+                                 const char *path, const struct stat * );
+
+/**
+ * Store the results of a preparsed item.
+ */
+void input_preparser_cache_Save( input_preparser_cache_t *, input_item_t *,
+                                 const char *path, const struct stat * );
+
+#endif
@@ -100,6 +100,9 @@ TaskNew(input_fetcher_t *fetcher, vlc_executor_t *executor, input_item_t *item,
     }
 
     task->runnable.userdata = task;
+    task->runnable.priority = options & META_REQUEST_OPTION_DO_INTERACT
+                            ? VLC_RUNNABLE_PRIORITY_HIGH
+                            : VLC_RUNNABLE_PRIORITY_NORMAL;
 
     return task;
 }
@@ -22,14 +22,23 @@
 # include "config.h"
 #endif
 
+#include <sys/stat.h>
+
 #include <vlc_common.h>
 #include <vlc_atomic.h>
+#include <vlc_demux.h>
 #include <vlc_executor.h>
+#include <vlc_fs.h>
+#include <vlc_input.h>
+#include <vlc_modules.h>
+#include <vlc_url.h>
 
 #include "input/input_interface.h"
 #include "input/input_internal.h"
+#include "input/item.h"
 #include "preparser.h"
 #include "fetcher.h"
+#include "cache.h"
 
 struct input_preparser_t
 {
@@ -39,8 +48,28 @@ struct input_preparser_t
     vlc_tick_t default_timeout;
     atomic_bool deactivated;
 
+    input_preparser_cache_t *cache;
+    unsigned host_threads; /**< max tasks per remote host, 0 for no limit */
+
     vlc_mutex_t lock;
     struct vlc_list submitted_tasks; /**< list of struct task */
+    struct vlc_list origins; /**< list of struct origin */
+
+    struct vlc_list batch; /**< tag-only tasks, list of struct task */
+    bool batch_running;
+    struct vlc_runnable batch_runnable;
+};
+
+/**
+ * Remote host, its tasks are limited to avoid flooding a single server with
+ * requests while the preparser threads are available.
+ */
+struct origin
+{
+    char *key; /**< "scheme://host:port" */
+    unsigned active; /**< number of tasks submitted to the executor */
+    struct vlc_list pending; /**< waiting tasks, list of struct task */
+    struct vlc_list node; /**< node of input_preparser_t.origins */
 };
 
 struct task
@@ -60,9 +89,16 @@ struct task
     atomic_int preparse_status;
     atomic_bool interrupted;
 
+    struct origin *origin; /**< NULL for local items */
+    bool waiting; /**< in the wait list, not submitted yet */
+    bool batched; /**< run by the batch runnable */
+    bool has_subtree;
+
     struct vlc_runnable runnable; /**< to be passed to the executor */
 
     struct vlc_list node; /**< node of input_preparser_t.submitted_tasks */
+    struct vlc_list wait_node; /**< node of origin.pending or
+                                    input_preparser_t.batch */
 };
 
 static void RunnableRun(void *);
@@ -95,8 +131,17 @@ TaskNew(input_preparser_t *preparser, input_item_t *item,
     atomic_init(&task->preparse_status, ITEM_PREPARSE_SKIPPED);
     atomic_init(&task->interrupted, false);
 
+    task->origin = NULL;
+    task->waiting = false;
+    task->batched = false;
+    task->has_subtree = false;
+
     task->runnable.run = RunnableRun;
     task->runnable.userdata = task;
+    /* Do not keep the user waiting behind background requests */
+    task->runnable.priority = options & META_REQUEST_OPTION_DO_INTERACT
+                            ? VLC_RUNNABLE_PRIORITY_HIGH
+                            : VLC_RUNNABLE_PRIORITY_NORMAL;
 
     return task;
 }
@@ -108,11 +153,129 @@ TaskDelete(struct task *task)
     free(task);
 }
 
+static char *
+OriginKey(input_item_t *item)
+{
+    char *uri = input_item_GetURI(item);
+    if (!uri)
+        return NULL;
+
+    vlc_url_t url;
+    char *key = NULL;
+    if (vlc_UrlParse(&url, uri) == 0 && url.psz_protocol && url.psz_host)
+    {
+        if (asprintf(&key, "%s://%s:%u", url.psz_protocol, url.psz_host,
+                     url.i_port) == -1)
+            key = NULL;
+    }
+    vlc_UrlClean(&url);
+    free(uri);
+    return key;
+}
+
+static struct origin *
+PreparserGetOrigin(input_preparser_t *preparser, char *key)
+{
+    vlc_mutex_assert(&preparser->lock);
+
+    struct origin *origin;
+    vlc_list_foreach(origin, &preparser->origins, node)
+        if (!strcmp(origin->key, key))
+        {
+            free(key);
+            return origin;
+        }
+
+    origin = malloc(sizeof(*origin));
+    if (!origin)
+    {
+        free(key);
+        return NULL;
+    }
+
+    origin->key = key;
+    origin->active = 0;
+    vlc_list_init(&origin->pending);
+    vlc_list_append(&origin->node, &preparser->origins);
+    return origin;
+}
+
+/* Release the slot of a task in its origin, and submit the next waiting task
+ * of the same origin */
 static void
-PreparserAddTask(input_preparser_t *preparser, struct task *task)
+PreparserReleaseOrigin(input_preparser_t *preparser, struct task *task)
+{
+    vlc_mutex_assert(&preparser->lock);
+
+    struct origin *origin = task->origin;
+    if (!origin)
+        return;
+
+    if (task->waiting)
+    {
+        vlc_list_remove(&task->wait_node);
+        task->waiting = false;
+    }
+    else
+    {
+        assert(origin->active > 0);
+        struct task *next =
+            vlc_list_first_entry_or_null(&origin->pending, struct task,
+                                         wait_node);
+        if (next)
+        {
+            vlc_list_remove(&next->wait_node);
+            next->waiting = false;
+            vlc_executor_Submit(preparser->executor, &next->runnable);
+        }
+        else
+            origin->active--;
+    }
+
+    task->origin = NULL;
+    if (!origin->active && vlc_list_is_empty(&origin->pending))
+    {
+        vlc_list_remove(&origin->node);
+        free(origin->key);
+        free(origin);
+    }
+}
+
+static void
+PreparserAddTask(input_preparser_t *preparser, struct task *task,
+                 char *origin_key, bool batch)
 {
     vlc_mutex_lock(&preparser->lock);
     vlc_list_append(&task->node, &preparser->submitted_tasks);
+
+    if (batch)
+    {
+        task->waiting = task->batched = true;
+        vlc_list_append(&task->wait_node, &preparser->batch);
+        if (!preparser->batch_running)
+        {
+            preparser->batch_running = true;
+            vlc_executor_Submit(preparser->executor,
+                                &preparser->batch_runnable);
+        }
+        vlc_mutex_unlock(&preparser->lock);
+        return;
+    }
+
+    if (origin_key)
+        task->origin = PreparserGetOrigin(preparser, origin_key);
+
+    if (task->origin && task->origin->active >= preparser->host_threads)
+    {
+        task->waiting = true;
+        vlc_list_append(&task->wait_node, &task->origin->pending);
+    }
+    else
+    {
+        if (task->origin)
+            task->origin->active++;
+        vlc_executor_Submit(preparser->executor, &task->runnable);
+    }
     vlc_mutex_unlock(&preparser->lock);
 }
 
@@ -121,6 +284,7 @@ PreparserRemoveTask(input_preparser_t *preparser, struct task *task)
 {
     vlc_mutex_lock(&preparser->lock);
     vlc_list_remove(&task->node);
+    PreparserReleaseOrigin(preparser, task);
     vlc_mutex_unlock(&preparser->lock);
 }
 
@@ -161,6 +325,8 @@ OnParserSubtreeAdded(input_item_t *item, input_item_node_t *subtree,
     VLC_UNUSED(item);
     struct task *task = task_;
 
+    task->has_subtree = true;
+
     if (task->cbs && task->cbs->on_subtree_added)
         task->cbs->on_subtree_added(task->item, subtree, task->userdata);
 }
@@ -230,6 +396,125 @@ Fetch(struct task *task)
     vlc_sem_wait(&task->fetch_ended);
 }
 
+static bool
+HasTagExtension(const char *path)
+{
+    /* formats with tags readable without demuxing the file */
+    static const char *const exts[] = {
+        "flac", "m4a", "m4b", "mp3", "mp4", "oga", "ogg", "opus",
+    };
+
+    const char *ext = strrchr(path, '.');
+    if (!ext || strchr(ext, '/'))
+        return false;
+    ext++;
+
+    for (size_t i = 0; i < ARRAY_SIZE(exts); i++)
+        if (!strcasecmp(ext, exts[i]))
+            return true;
+    return false;
+}
+
+/* Return the path of a local file, NULL otherwise */
+static char *
+LocalPath(input_item_t *item)
+{
+    char *uri = input_item_GetURI(item);
+    if (!uri)
+        return NULL;
+
+    char *path = strncmp(uri, "file://", 7) ? NULL : vlc_uri2path(uri);
+    free(uri);
+    return path;
+}
+
+/**
+ * Read the tags with a "meta reader" module (ID3, Vorbis comments, MP4
+ * metadata), without opening a demuxer.
+ */
+static int
+ReadMeta(struct task *task)
+{
+    vlc_object_t *obj = task->preparser->owner;
+    demux_meta_t *demux_meta =
+        vlc_custom_create(obj, sizeof(*demux_meta), "demux meta");
+    if (unlikely(!demux_meta))
+        return VLC_ENOMEM;
+    demux_meta->p_item = task->item;
+
+    module_t *module = module_need(demux_meta, "meta reader", NULL, false);
+    if (!module)
+    {
+        vlc_object_delete(demux_meta);
+        return VLC_EGENERIC;
+    }
+
+    vlc_meta_t *meta = demux_meta->p_meta;
+    if (meta)
+    {
+        /* the attachments are not kept, nor the art they provide */
+        const char *art = vlc_meta_Get(meta, vlc_meta_ArtworkURL);
+        if (art && !strncmp(art, "attachment://", 13))
+            vlc_meta_Set(meta, vlc_meta_ArtworkURL, NULL);
+
+        input_item_t *item = task->item;
+        vlc_mutex_lock(&item->lock);
+        if (!item->p_meta)
+            item->p_meta = vlc_meta_New();
+        if (item->p_meta)
+            vlc_meta_Merge(item->p_meta, meta);
+        vlc_mutex_unlock(&item->lock);
+        input_item_ReclaimMetaSnapshots(item);
+        vlc_meta_Delete(meta);
+    }
+
+    for (int i = 0; i < demux_meta->i_attachments; i++)
+        vlc_input_attachment_Release(demux_meta->attachments[i]);
+    free(demux_meta->attachments);
+
+    module_unneed(demux_meta, module);
+    vlc_object_delete(demux_meta);
+
+    if (!meta)
+        return VLC_EGENERIC;
+
+    vlc_event_send(&task->item->event_manager, &(vlc_event_t) {
+        .type = vlc_InputItemMetaChanged,
+        .u.input_item_meta_changed.meta_type = vlc_meta_Title });
+    return VLC_SUCCESS;
+}
+
+static void
+Preparse(struct task *task, vlc_tick_t deadline)
+{
+    input_preparser_cache_t *cache = task->preparser->cache;
+    char *path = LocalPath(task->item);
+    struct stat st;
+    bool cacheable = cache && path && vlc_stat(path, &st) == 0
+                  && S_ISREG(st.st_mode);
+
+    if (cacheable && input_preparser_cache_Load(cache, task->item, path, &st))
+        atomic_store_explicit(&task->preparse_status, ITEM_PREPARSE_DONE,
+                              memory_order_relaxed);
+    else if (task->options & META_REQUEST_OPTION_META_ONLY && path
+          && HasTagExtension(path) && ReadMeta(task) == VLC_SUCCESS)
+        /* the duration and the tracks are unknown, the results are not
+         * cached */
+        atomic_store_explicit(&task->preparse_status, ITEM_PREPARSE_DONE,
+                              memory_order_relaxed);
+    else
+    {
+        Parse(task, deadline);
+
+        if (cacheable && !task->has_subtree
+         && atomic_load_explicit(&task->preparse_status,
+                                 memory_order_relaxed) == ITEM_PREPARSE_DONE)
+            input_preparser_cache_Save(cache, task->item, path, &st);
+    }
+
+    free(path);
+}
+
 static void
 RunnableRun(void *userdata)
 {
@@ -241,7 +526,7 @@ RunnableRun(void *userdata)
     if (atomic_load(&task->interrupted))
         goto end;
 
-    Parse(task, deadline);
+    Preparse(task, deadline);
 
     if (atomic_load(&task->interrupted))
         goto end;
@@ -260,6 +545,34 @@ end:
     TaskDelete(task);
 }
 
+/* Run the tag-only tasks one after the other, the meta reader modules are
+ * not thread-safe anyway */
+static void
+BatchRun(void *userdata)
+{
+    input_preparser_t *preparser = userdata;
+
+    vlc_mutex_lock(&preparser->lock);
+    for (;;)
+    {
+        struct task *task =
+            vlc_list_first_entry_or_null(&preparser->batch, struct task,
+                                         wait_node);
+        if (!task)
+            break;
+
+        vlc_list_remove(&task->wait_node);
+        task->waiting = false;
+        vlc_mutex_unlock(&preparser->lock);
+
+        RunnableRun(task);
+
+        vlc_mutex_lock(&preparser->lock);
+    }
+    preparser->batch_running = false;
+    vlc_mutex_unlock(&preparser->lock);
+}
+
 static void
 Interrupt(struct task *task)
 {
@@ -303,6 +616,20 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     if( unlikely( !preparser->fetcher ) )
         msg_Warn( parent, "unable to create art fetcher" );
 
+    int64_t host_threads = var_InheritInteger( parent, "preparse-host-threads" );
+    preparser->host_threads = host_threads > 0 ? host_threads : 0;
+    vlc_list_init( &preparser->origins );
+
+    int64_t cache_size = var_InheritInteger( parent, "preparse-cache-size" );
+    preparser->cache = cache_size > 0
+                     ? input_preparser_cache_New( cache_size ) : NULL;
+
+    vlc_list_init( &preparser->batch );
+    preparser->batch_running = false;
+    preparser->batch_runnable.run = BatchRun;
+    preparser->batch_runnable.userdata = preparser;
+    preparser->batch_runnable.priority = VLC_RUNNABLE_PRIORITY_NORMAL;
+
     return preparser;
 }
 
@@ -343,9 +670,24 @@ int input_preparser_Push( input_preparser_t *preparser,
     if( !task )
         return VLC_ENOMEM;
 
-    PreparserAddTask(preparser, task);
+    /* tag-only requests of local files are batched, requests to remote hosts
+     * are limited per host */
+    bool batch = false;
+    char *origin_key = NULL;
+    if( !b_net )
+    {
+        if( i_options & META_REQUEST_OPTION_META_ONLY
+         && !( i_options & META_REQUEST_OPTION_DO_INTERACT ) )
+        {
+            char *path = LocalPath( item );
+            batch = path && HasTagExtension( path );
+            free( path );
+        }
+    }
+    else if( preparser->host_threads > 0 )
+        origin_key = OriginKey( item );
 
-    vlc_executor_Submit(preparser->executor, &task->runnable);
+    PreparserAddTask(preparser, task, origin_key, batch);
     return VLC_SUCCESS;
 }
 
@@ -367,12 +709,24 @@ void input_preparser_Cancel( input_preparser_t *preparser, void *id )
     {
         if (!id || task->id == id)
         {
-            bool canceled =
-                vlc_executor_Cancel(preparser->executor, &task->runnable);
+            bool canceled;
+            if (task->waiting)
+            {
+                if (task->batched)
+                    vlc_list_remove(&task->wait_node);
+                canceled = true;
+            }
+            else if (!task->batched)
+                canceled =
+                    vlc_executor_Cancel(preparser->executor, &task->runnable);
+            else
+                canceled = false;
+
             if (canceled)
             {
                 NotifyPreparseEnded(task);
                 vlc_list_remove(&task->node);
+                PreparserReleaseOrigin(preparser, task);
                 TaskDelete(task);
             }
             else
@@ -400,5 +754,9 @@ void input_preparser_Delete( input_preparser_t *preparser )
     if( preparser->fetcher )
         input_fetcher_Delete( preparser->fetcher );
 
+    assert( vlc_list_is_empty( &preparser->origins ) );
+    if( preparser->cache )
+        input_preparser_cache_Delete( preparser->cache );
+
     free( preparser );
 }
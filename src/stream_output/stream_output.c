@@ -31,6 +31,7 @@
 #endif
 
 #include <assert.h>
+#include <stdatomic.h>
 
 #include <vlc_common.h>
 
@@ -46,6 +47,7 @@
 #include <vlc_block.h>
 #include <vlc_codec.h>
 #include <vlc_modules.h>
+#include <vlc_list.h>
 
 #include "input/input_interface.h"
 
@@ -204,6 +206,217 @@ int sout_InputSendBuffer( sout_stream_t *p_sout,
     return sout_StreamIdSend( p_sout, p_input->id, p_buffer );
 }
 
+/*****************************************************************************
+ * Statistics
+ *****************************************************************************/
+
+struct sout_stats_entry
+{
+    struct vlc_list node;
+    vlc_object_t *obj;
+    const char *name;
+    unsigned id;
+    unsigned owner;
+    unsigned next;
+    int type;
+
+    atomic_uint_fast64_t blocks;
+    atomic_uint_fast64_t bytes;
+    atomic_uint_fast64_t late;
+    atomic_uint_fast64_t dropped;
+    atomic_uint_fast64_t latency;
+    atomic_uint_fast64_t latency_max;
+    atomic_uint in_flight;
+    atomic_uint queued;
+    atomic_size_t queued_bytes;
+
+    /* Rate sampling, protected by the list lock */
+    uint64_t sample_bytes;
+    vlc_tick_t sample_date;
+    uint64_t rate;
+};
+
+static vlc_mutex_t sout_stats_lock = VLC_STATIC_MUTEX;
+static struct vlc_list sout_stats_list = VLC_LIST_INITIALIZER(&sout_stats_list);
+static unsigned sout_stats_last_id;
+
+/* Time spent within the nested elements of the current one */
+static thread_local vlc_tick_t sout_stats_nested;
+
+static void sout_StatsRegister(struct sout_stats_entry *e, vlc_object_t *obj,
+                               int type, const char *name, unsigned next)
+{
+    e->obj = obj;
+    e->name = name;
+    e->type = type;
+    e->owner = 0;
+    e->next = next;
+    atomic_init(&e->blocks, 0);
+    atomic_init(&e->bytes, 0);
+    atomic_init(&e->late, 0);
+    atomic_init(&e->dropped, 0);
+    atomic_init(&e->latency, 0);
+    atomic_init(&e->latency_max, 0);
+    atomic_init(&e->in_flight, 0);
+    atomic_init(&e->queued, 0);
+    atomic_init(&e->queued_bytes, 0);
+    e->sample_bytes = 0;
+    e->sample_date = vlc_tick_now();
+    e->rate = 0;
+
+    vlc_mutex_lock(&sout_stats_lock);
+    e->id = ++sout_stats_last_id;
+
+    for (vlc_object_t *parent = vlc_object_parent(obj);
+         parent != NULL && e->owner == 0;
+         parent = vlc_object_parent(parent))
+    {
+        const struct sout_stats_entry *o;
+
+        vlc_list_foreach(o, &sout_stats_list, node)
+            if (o->obj == parent)
+            {
+                e->owner = o->id;
+                break;
+            }
+    }
+    vlc_list_append(&e->node, &sout_stats_list);
+    vlc_mutex_unlock(&sout_stats_lock);
+}
+
+static void sout_StatsUnregister(struct sout_stats_entry *e)
+{
+    vlc_mutex_lock(&sout_stats_lock);
+    vlc_list_remove(&e->node);
+    vlc_mutex_unlock(&sout_stats_lock);
+}
+
+struct sout_stats_probe
+{
+    vlc_tick_t start;
+    vlc_tick_t nested;
+    vlc_tick_t length;
+};
+
+static void sout_StatsEnter(struct sout_stats_entry *e,
+                            struct sout_stats_probe *probe, block_t *block)
+{
+    int count;
+    size_t size;
+
+    block_ChainProperties(block, &count, &size, &probe->length);
+    atomic_fetch_add_explicit(&e->blocks, count, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->bytes, size, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->in_flight, 1, memory_order_relaxed);
+
+    probe->nested = sout_stats_nested;
+    sout_stats_nested = 0;
+    probe->start = vlc_tick_now();
+}
+
+static void sout_StatsLeave(struct sout_stats_entry *e,
+                            const struct sout_stats_probe *probe, bool ok)
+{
+    vlc_tick_t elapsed = vlc_tick_now() - probe->start;
+    vlc_tick_t self = elapsed - sout_stats_nested;
+
+    sout_stats_nested = probe->nested + elapsed;
+    if (self < 0)
+        self = 0;
+
+    atomic_fetch_sub_explicit(&e->in_flight, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->latency, self, memory_order_relaxed);
+
+    uint_fast64_t max = atomic_load_explicit(&e->latency_max,
+                                             memory_order_relaxed);
+    while ((uint_fast64_t)self > max
+        && !atomic_compare_exchange_weak_explicit(&e->latency_max, &max, self,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed));
+
+    if (probe->length > 0 && self > probe->length)
+        atomic_fetch_add_explicit(&e->late, 1, memory_order_relaxed);
+    if (!ok)
+        atomic_fetch_add_explicit(&e->dropped, 1, memory_order_relaxed);
+}
+
+#undef sout_GetStats
+ssize_t sout_GetStats(vlc_object_t *obj, sout_stats_t **pp_stats)
+{
+    libvlc_int_t *libvlc = vlc_object_instance(obj);
+    struct sout_stats_entry *e;
+    sout_stats_t *tab = NULL;
+    size_t count = 0, size = 0;
+    vlc_tick_t now = vlc_tick_now();
+
+    vlc_mutex_lock(&sout_stats_lock);
+    vlc_list_foreach(e, &sout_stats_list, node)
+    {
+        if (vlc_object_instance(e->obj) != libvlc)
+            continue;
+
+        if (count == size)
+        {
+            size_t newsize = size ? 2 * size : 16;
+            sout_stats_t *newtab = realloc(tab, newsize * sizeof (*tab));
+            if (unlikely(newtab == NULL))
+            {
+                vlc_mutex_unlock(&sout_stats_lock);
+                free(tab);
+                return -1;
+            }
+            tab = newtab;
+            size = newsize;
+        }
+
+        sout_stats_t *st = &tab[count++];
+
+        st->i_id = e->id;
+        st->i_owner = e->owner;
+        st->i_next = e->next;
+        st->i_type = e->type;
+        strlcpy(st->psz_name, e->name != NULL ? e->name : "",
+                sizeof (st->psz_name));
+        st->i_blocks = atomic_load_explicit(&e->blocks, memory_order_relaxed);
+        st->i_bytes = atomic_load_explicit(&e->bytes, memory_order_relaxed);
+        st->i_late = atomic_load_explicit(&e->late, memory_order_relaxed);
+        st->i_dropped = atomic_load_explicit(&e->dropped,
+                                             memory_order_relaxed);
+        st->i_in_flight = atomic_load_explicit(&e->in_flight,
+                                               memory_order_relaxed);
+        st->i_queued = atomic_load_explicit(&e->queued, memory_order_relaxed);
+        st->i_queued_bytes = atomic_load_explicit(&e->queued_bytes,
+                                                  memory_order_relaxed);
+        st->i_latency = atomic_load_explicit(&e->latency,
+                                             memory_order_relaxed);
+        st->i_latency_max = atomic_load_explicit(&e->latency_max,
+                                                 memory_order_relaxed);
+
+        /* Sample the rate at most once per second */
+        if (now - e->sample_date >= VLC_TICK_FROM_SEC(1))
+        {
+            e->rate = (st->i_bytes - e->sample_bytes) * CLOCK_FREQ
+                      / (now - e->sample_date);
+            e->sample_bytes = st->i_bytes;
+            e->sample_date = now;
+        }
+        st->i_rate = e->rate;
+    }
+    vlc_mutex_unlock(&sout_stats_lock);
+
+    *pp_stats = tab;
+    return count;
+}
+
+struct sout_access_out_private
+{
+    sout_access_out_t access;
+    struct sout_stats_entry stats;
+};
+
+#define sout_access_priv(a) \
+        container_of(a, struct sout_access_out_private, access)
+
 #undef sout_AccessOutNew
 /*****************************************************************************
  * sout_AccessOutNew: allocate a new access out
@@ -211,12 +424,14 @@ int sout_InputSendBuffer( sout_stream_t *p_sout,
 sout_access_out_t *sout_AccessOutNew( vlc_object_t *p_sout,
                                       const char *psz_access, const char *psz_name )
 {
+    struct sout_access_out_private *priv;
     sout_access_out_t *p_access;
     char              *psz_next;
 
-    p_access = vlc_custom_create( p_sout, sizeof( *p_access ), "access out" );
-    if( !p_access )
+    priv = vlc_custom_create( p_sout, sizeof( *priv ), "access out" );
+    if( !priv )
         return NULL;
+    p_access = &priv->access;
 
     psz_next = config_ChainCreate( &p_access->psz_access, &p_access->p_cfg,
                                    psz_access );
@@ -231,11 +446,15 @@ sout_access_out_t *sout_AccessOutNew( vlc_object_t *p_sout,
     p_access->pf_control = NULL;
     p_access->p_module   = NULL;
 
+    sout_StatsRegister( &priv->stats, VLC_OBJECT(p_access), SOUT_STATS_ACCESS,
+                        p_access->psz_access, 0 );
+
     p_access->p_module   =
         module_need( p_access, "sout access", p_access->psz_access, true );
 
     if( !p_access->p_module )
     {
+        sout_StatsUnregister( &priv->stats );
         free( p_access->psz_path );
 error:
         free( p_access->psz_access );
@@ -254,6 +473,7 @@ void sout_AccessOutDelete( sout_access_out_t *p_access )
     {
         module_unneed( p_access, p_access->p_module );
     }
+    sout_StatsUnregister( &sout_access_priv(p_access)->stats );
     free( p_access->psz_access );
 
     config_ChainDestroy( p_access->p_cfg );
@@ -287,7 +507,14 @@ ssize_t sout_AccessOutRead( sout_access_out_t *p_access, block_t *p_buffer )
  *****************************************************************************/
 ssize_t sout_AccessOutWrite( sout_access_out_t *p_access, block_t *p_buffer )
 {
-    return p_access->pf_write( p_access, p_buffer );
+    struct sout_stats_entry *stats = &sout_access_priv(p_access)->stats;
+    struct sout_stats_probe probe;
+    ssize_t val;
+
+    sout_StatsEnter( stats, &probe, p_buffer );
+    val = p_access->pf_write( p_access, p_buffer );
+    sout_StatsLeave( stats, &probe, val >= 0 );
+    return val;
 }
 
 /**
@@ -307,17 +534,27 @@ int sout_AccessOutControl (sout_access_out_t *access, int query, ...)
     return ret;
 }
 
+struct sout_mux_private
+{
+    sout_mux_t mux;
+    struct sout_stats_entry stats;
+};
+
+#define sout_mux_priv(m) container_of(m, struct sout_mux_private, mux)
+
 /*****************************************************************************
  * sout_MuxNew: create a new mux
  *****************************************************************************/
 sout_mux_t *sout_MuxNew( sout_access_out_t *p_access, const char *psz_mux )
 {
+    struct sout_mux_private *priv;
     sout_mux_t *p_mux;
     char       *psz_next;
 
-    p_mux = vlc_custom_create( p_access, sizeof( *p_mux ), "mux" );
-    if( p_mux == NULL )
+    priv = vlc_custom_create( p_access, sizeof( *priv ), "mux" );
+    if( priv == NULL )
         return NULL;
+    p_mux = &priv->mux;
 
     psz_next = config_ChainCreate( &p_mux->psz_mux, &p_mux->p_cfg, psz_mux );
     free( psz_next );
@@ -337,11 +574,15 @@ sout_mux_t *sout_MuxNew( sout_access_out_t *p_access, const char *psz_mux )
     p_mux->b_waiting_stream = true;
     p_mux->i_add_stream_start = VLC_TICK_INVALID;
 
+    sout_StatsRegister( &priv->stats, VLC_OBJECT(p_mux), SOUT_STATS_MUX,
+                        p_mux->psz_mux, 0 );
+
     p_mux->p_module =
         module_need( p_mux, "sout mux", p_mux->psz_mux, true );
 
     if( p_mux->p_module == NULL )
     {
+        sout_StatsUnregister( &priv->stats );
         FREENULL( p_mux->psz_mux );
 
         vlc_object_delete(p_mux);
@@ -379,6 +620,7 @@ void sout_MuxDelete( sout_mux_t *p_mux )
     {
         module_unneed( p_mux, p_mux->p_module );
     }
+    sout_StatsUnregister( &sout_mux_priv(p_mux)->stats );
     free( p_mux->psz_mux );
 
     config_ChainDestroy( p_mux->p_cfg );
@@ -428,6 +670,28 @@ sout_input_t *sout_MuxAddStream( sout_mux_t *p_mux, const es_format_t *p_fmt )
     return p_input;
 }
 
+/* Updates the amount of data waiting in the input FIFOs of a muxer */
+static void sout_MuxUpdateQueue( sout_mux_t *p_mux )
+{
+    struct sout_stats_entry *stats = &sout_mux_priv(p_mux)->stats;
+    unsigned i_queued = 0;
+    size_t i_bytes = 0;
+
+    for( int i = 0; i < p_mux->i_nb_inputs; i++ )
+    {
+        block_fifo_t *p_fifo = p_mux->pp_inputs[i]->p_fifo;
+
+        vlc_fifo_Lock( p_fifo );
+        i_queued += vlc_fifo_GetCount( p_fifo );
+        i_bytes += vlc_fifo_GetBytes( p_fifo );
+        vlc_fifo_Unlock( p_fifo );
+    }
+
+    atomic_store_explicit( &stats->queued, i_queued, memory_order_relaxed );
+    atomic_store_explicit( &stats->queued_bytes, i_bytes,
+                           memory_order_relaxed );
+}
+
 /*****************************************************************************
  * sout_MuxDeleteStream:
  *****************************************************************************/
@@ -460,14 +724,12 @@ void sout_MuxDeleteStream( sout_mux_t *p_mux, sout_input_t *p_input )
         block_FifoRelease( p_input->p_fifo );
         es_format_Clean( &p_input->fmt );
         free( p_input );
+        sout_MuxUpdateQueue( p_mux );
     }
 }
 
-/*****************************************************************************
- * sout_MuxSendBuffer:
- *****************************************************************************/
-int sout_MuxSendBuffer( sout_mux_t *p_mux, sout_input_t *p_input,
-                         block_t *p_buffer )
+static int sout_MuxQueueBuffer( sout_mux_t *p_mux, sout_input_t *p_input,
+                                block_t *p_buffer )
 {
     vlc_tick_t i_dts = p_buffer->i_dts;
     block_FifoPut( p_input->p_fifo, p_buffer );
@@ -490,10 +752,27 @@ int sout_MuxSendBuffer( sout_mux_t *p_mux, sout_input_t *p_input,
     return p_mux->pf_mux( p_mux );
 }
 
+/*****************************************************************************
+ * sout_MuxSendBuffer:
+ *****************************************************************************/
+int sout_MuxSendBuffer( sout_mux_t *p_mux, sout_input_t *p_input,
+                         block_t *p_buffer )
+{
+    struct sout_stats_entry *stats = &sout_mux_priv(p_mux)->stats;
+    struct sout_stats_probe probe;
+    int val;
+
+    sout_StatsEnter( stats, &probe, p_buffer );
+    val = sout_MuxQueueBuffer( p_mux, p_input, p_buffer );
+    sout_StatsLeave( stats, &probe, val == VLC_SUCCESS );
+    sout_MuxUpdateQueue( p_mux );
+    return val;
+}
+
 void sout_MuxFlush( sout_mux_t *p_mux, sout_input_t *p_input )
 {
-    VLC_UNUSED(p_mux);
     block_FifoEmpty( p_input->p_fifo );
+    sout_MuxUpdateQueue( p_mux );
 }
 
 /*****************************************************************************
@@ -676,6 +955,7 @@ struct sout_stream_private {
     sout_stream_t stream;
     vlc_mutex_t lock;
     module_t *module;
+    struct sout_stats_entry stats;
 };
 
 #define sout_stream_priv(s) \
@@ -710,11 +990,15 @@ void sout_StreamIdDel(sout_stream_t *s, void *id)
 
 int sout_StreamIdSend(sout_stream_t *s, void *id, block_t *b)
 {
+    struct sout_stats_entry *stats = &sout_stream_priv(s)->stats;
+    struct sout_stats_probe probe;
     int val;
 
+    sout_StatsEnter(stats, &probe, b);
     sout_StreamLock(s);
     val = s->ops->send(s, id, b);
     sout_StreamUnlock(s);
+    sout_StatsLeave(stats, &probe, val == VLC_SUCCESS);
     return val;
 }
 
@@ -751,6 +1035,7 @@ static void sout_StreamDelete( sout_stream_t *p_stream )
     if (priv->module != NULL)
         module_unneed(p_stream, priv->module);
 
+    sout_StatsUnregister(&priv->stats);
     FREENULL( p_stream->psz_name );
 
     config_ChainDestroy( p_stream->p_cfg );
@@ -804,6 +1089,10 @@ static sout_stream_t *sout_StreamNew( vlc_object_t *parent, char *psz_name,
 
     msg_Dbg( p_stream, "stream=`%s'", p_stream->psz_name );
 
+    sout_StatsRegister(&priv->stats, VLC_OBJECT(p_stream), SOUT_STATS_STREAM,
+                       p_stream->psz_name,
+                       p_next ? sout_stream_priv(p_next)->stats.id : 0);
+
     priv->module = module_need(p_stream, cap, p_stream->psz_name, true);
 
     if (priv->module == NULL)
@@ -0,0 +1,157 @@
+/*****************************************************************************
+ * aout_ring.c: Test for the audio output ring
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include "../audio_output/ring.h"
+
+#define CHANNELS 2
+#define TOTAL_FRAMES 200000
+
+typedef struct { uint32_t ch[CHANNELS]; } frame_t;
+
+static void fill(frame_t *f, size_t n, uint32_t first)
+{
+    for (size_t i = 0; i < n; i++)
+        for (unsigned c = 0; c < CHANNELS; c++)
+            f[i].ch[c] = (first + i) * CHANNELS + c;
+}
+
+static void check(const frame_t *f, size_t n, uint32_t first)
+{
+    for (size_t i = 0; i < n; i++)
+        for (unsigned c = 0; c < CHANNELS; c++)
+            assert(f[i].ch[c] == (first + i) * CHANNELS + c);
+}
+
+static void test_basic(void)
+{
+    frame_t in[100], out[100];
+    aout_ring_t *ring = aout_ring_New(sizeof (frame_t), 60);
+
+    assert(ring != NULL);
+    assert(aout_ring_Capacity(ring) == 64);
+    assert(aout_ring_Used(ring) == 0);
+    assert(aout_ring_Read(ring, out, 10) == 0);
+
+    /* Fill up, then wrap around the end of the buffer */
+    fill(in, 100, 0);
+    assert(aout_ring_Write(ring, in, 100) == 64);
+    assert(aout_ring_Used(ring) == 64);
+    assert(aout_ring_Read(ring, out, 50) == 50);
+    check(out, 50, 0);
+    assert(aout_ring_Write(ring, in + 64, 36) == 36);
+    assert(aout_ring_Used(ring) == 50);
+    assert(aout_ring_Read(ring, out, 100) == 50);
+    check(out, 50, 50);
+
+    /* A flush discards what was queued before, not after */
+    assert(aout_ring_Write(ring, in, 30) == 30);
+    aout_ring_Flush(ring);
+    assert(aout_ring_Used(ring) == 0);
+    assert(aout_ring_Write(ring, in + 30, 20) == 20);
+    assert(aout_ring_Used(ring) == 20);
+    aout_ring_Flush(ring);
+    assert(aout_ring_Write(ring, in + 50, 10) == 10);
+    assert(aout_ring_Read(ring, out, 100) == 10);
+    check(out, 10, 50);
+    assert(aout_ring_Used(ring) == 0);
+
+    /* A stale flush position never moves backward */
+    assert(aout_ring_Write(ring, in, 5) == 5);
+    aout_ring_Flush(ring);
+    assert(aout_ring_Write(ring, in + 5, 5) == 5);
+    assert(aout_ring_Read(ring, out, 2) == 2);
+    check(out, 2, 5);
+    assert(aout_ring_Read(ring, out, 10) == 3);
+    check(out, 3, 7);
+
+    /* Flushed frames are not overwritten before the consumer skips them */
+    assert(aout_ring_Write(ring, in, 64) == 64);
+    aout_ring_Flush(ring);
+    assert(aout_ring_Used(ring) == 0);
+    assert(aout_ring_Write(ring, in, 10) == 0);
+    assert(aout_ring_Read(ring, out, 10) == 0);
+    assert(aout_ring_Write(ring, in + 64, 10) == 10);
+    assert(aout_ring_Read(ring, out, 100) == 10);
+    check(out, 10, 64);
+
+    aout_ring_Delete(ring);
+}
+
+static void *consumer(void *data)
+{
+    aout_ring_t *ring = data;
+    frame_t buf[97];
+    uint32_t next = 0;
+
+    while (next < TOTAL_FRAMES)
+    {
+        size_t n = aout_ring_Read(ring, buf, 1 + next % ARRAY_SIZE(buf));
+        check(buf, n, next);
+        next += n;
+        if (n == 0)
+            sched_yield();
+    }
+    return NULL;
+}
+
+static void test_threads(void)
+{
+    aout_ring_t *ring = aout_ring_New(sizeof (frame_t), 256);
+    frame_t buf[113];
+    vlc_thread_t th;
+
+    assert(ring != NULL);
+    assert(vlc_clone(&th, consumer, ring, VLC_THREAD_PRIORITY_LOW) == 0);
+
+    for (uint32_t next = 0; next < TOTAL_FRAMES;)
+    {
+        size_t n = 1 + next % ARRAY_SIZE(buf);
+        if (n > TOTAL_FRAMES - next)
+            n = TOTAL_FRAMES - next;
+
+        fill(buf, n, next);
+        n = aout_ring_Write(ring, buf, n);
+        next += n;
+        if (n == 0)
+            sched_yield();
+    }
+
+    vlc_join(th, NULL);
+    assert(aout_ring_Used(ring) == 0);
+    aout_ring_Delete(ring);
+}
+
+int main(void)
+{
+    test_basic();
+    test_threads();
+    return 0;
+}
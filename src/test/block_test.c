@@ -86,11 +86,100 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_Pool (void)
+{
+    struct vlc_frame_pool_stats before[16], after[16];
+    size_t classes = vlc_frame_pool_GetStats (before, ARRAY_SIZE(before));
+
+    assert (classes > 0 && classes <= ARRAY_SIZE(before));
+
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        block_t *block = block_Alloc (188);
+        assert (block != NULL);
+        assert (block->i_buffer == 188);
+        memset (block->p_buffer, 0x47, block->i_buffer);
+
+        /* The spare space of the size class can be used */
+        block = block_Realloc (block, 32, block->i_buffer + 32);
+        assert (block != NULL);
+        assert (block->p_buffer[32] == 0x47);
+        block_Release (block);
+    }
+
+    /* Bigger frames bypass the pool */
+    block_t *block = block_Alloc (1 << 20);
+    assert (block != NULL);
+    block_Release (block);
+
+    vlc_frame_pool_GetStats (after, ARRAY_SIZE(after));
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < classes; i++)
+    {
+        assert (after[i].size == before[i].size);
+        assert (after[i].misses >= before[i].misses);
+        total += (after[i].hits + after[i].misses)
+               - (before[i].hits + before[i].misses);
+    }
+    /* Not every cache hit may have been accounted yet */
+    assert (total > 0 && total <= 1000);
+}
+
+static void test_block_Shared (void)
+{
+    block_t *block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block->i_pts = 42;
+
+    block = block_Shared (block);
+    assert (!block_IsShared (block));
+    assert (block_Shared (block) == block);
+
+    block_t *clone = block_Clone (block);
+    assert (clone != NULL);
+    assert (clone->p_buffer == block->p_buffer);
+    assert (clone->i_pts == 42);
+    assert (block_IsShared (block) && block_IsShared (clone));
+
+    /* Headers are separate */
+    clone->p_buffer += 5;
+    clone->i_buffer -= 5;
+    clone->i_pts = 0;
+    assert (block->i_pts == 42);
+    assert (block->i_buffer == sizeof (text));
+
+    /* Growing copies the payload */
+    block_t *grown = block_Realloc (clone, 2, clone->i_buffer);
+    assert (grown != NULL);
+    assert (grown->p_buffer + 2 != block->p_buffer + 5);
+    assert (!memcmp (grown->p_buffer + 2, text + 5, sizeof (text) - 5));
+    assert (!block_IsShared (block));
+    block_Release (grown);
+
+    clone = block_Clone (block);
+    assert (clone != NULL);
+    clone = block_MakeWritable (clone);
+    assert (clone != NULL);
+    assert (clone->p_buffer != block->p_buffer);
+    assert (!memcmp (clone->p_buffer, text, sizeof (text)));
+    block_Release (clone);
+
+    /* The last reference is writable in place */
+    uint8_t *payload = block->p_buffer;
+    block = block_MakeWritable (block);
+    assert (block != NULL && block->p_buffer == payload);
+    block_Release (block);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_Pool ();
+    test_block_Shared ();
     return 0;
 }
 
@@ -105,6 +105,7 @@ static void test_multiple_runnables(void)
         struct vlc_runnable *runnable = &runnables[i];
         runnable->run = RunIncrement;
         runnable->userdata = &shared_data;
+        runnable->priority = VLC_RUNNABLE_PRIORITY_NORMAL;
         vlc_executor_Submit(executor, runnable);
     }
 
@@ -170,6 +171,7 @@ static void test_cancel(void)
         struct vlc_runnable *runnable = &runnables[i];
         runnable->run = RunIncrement;
         runnable->userdata = &shared_data;
+        runnable->priority = VLC_RUNNABLE_PRIORITY_NORMAL;
         vlc_executor_Submit(executor, runnable);
     }
 
@@ -220,6 +222,7 @@ SpawnDoublerTask(vlc_executor_t *executor, int *array, size_t count)
     task->count = count;
     task->runnable.run = DoublerRun;
     task->runnable.userdata = task;
+    task->runnable.priority = VLC_RUNNABLE_PRIORITY_NORMAL;
 
     vlc_executor_Submit(executor, &task->runnable);
 
@@ -271,6 +274,78 @@ static void test_task_chain(void)
         assert(array[i] == 2 * i);
 }
 
+struct order_task
+{
+    struct data *data;
+    int *order;
+    int id;
+    struct vlc_runnable runnable;
+};
+
+static void RunOrder(void *userdata)
+{
+    struct order_task *task = userdata;
+    struct data *data = task->data;
+
+    vlc_mutex_lock(&data->lock);
+    task->order[data->ended++] = task->id;
+    vlc_mutex_unlock(&data->lock);
+
+    vlc_cond_signal(&data->cond);
+}
+
+static void test_priority(void)
+{
+    vlc_executor_t *executor = vlc_executor_New(1);
+    assert(executor);
+
+    struct data data;
+    InitData(&data);
+    data.delay = VLC_TICK_FROM_MS(100);
+
+    /* Keep the only thread busy while the other tasks are queued */
+    struct vlc_runnable blocker = {
+        .run = RunIncrement,
+        .userdata = &data,
+    };
+    vlc_executor_Submit(executor, &blocker);
+
+    vlc_mutex_lock(&data.lock);
+    while (data.started == 0)
+        vlc_cond_wait(&data.cond, &data.lock);
+    vlc_mutex_unlock(&data.lock);
+
+    static const enum vlc_runnable_priority priorities[] = {
+        VLC_RUNNABLE_PRIORITY_LOW, VLC_RUNNABLE_PRIORITY_NORMAL,
+        VLC_RUNNABLE_PRIORITY_HIGH, VLC_RUNNABLE_PRIORITY_LOW,
+        VLC_RUNNABLE_PRIORITY_HIGH, VLC_RUNNABLE_PRIORITY_NORMAL,
+    };
+    /* Expected order: by priority, then by submission */
+    static const int expected[] = { 2, 4, 1, 5, 0, 3 };
+    struct order_task tasks[ARRAY_SIZE(priorities)];
+    int order[ARRAY_SIZE(priorities) + 1];
+
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); ++i)
+    {
+        struct order_task *task = &tasks[i];
+        task->data = &data;
+        task->order = order; /* order[0] is left for the blocker */
+        task->id = i;
+        task->runnable.run = RunOrder;
+        task->runnable.userdata = task;
+        task->runnable.priority = priorities[i];
+        vlc_executor_Submit(executor, &task->runnable);
+    }
+
+    vlc_executor_WaitIdle(executor);
+
+    assert(data.ended == ARRAY_SIZE(tasks) + 1);
+    for (size_t i = 0; i < ARRAY_SIZE(expected); ++i)
+        assert(order[i + 1] == expected[i]);
+
+    vlc_executor_Delete(executor);
+}
+
 int main(void)
 {
     test_single_runnable();
@@ -278,5 +353,6 @@ int main(void)
     test_blocking_delete();
     test_cancel();
     test_task_chain();
+    test_priority();
     return 0;
 }
@@ -0,0 +1,160 @@
+/*****************************************************************************
+ * input_item.c: Test for the input item meta data snapshots
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_input_item.h>
+
+#define ITERATIONS 10000
+
+static const char *get(const input_item_meta_snapshot_t *snap,
+                       vlc_meta_type_t type)
+{
+    return input_item_meta_snapshot_Get(snap, type);
+}
+
+static void test_snapshot(void)
+{
+    input_item_t *item = input_item_New("file:///dev/null", "test");
+    assert(item != NULL);
+
+    input_item_meta_snapshot_t *snap = input_item_HoldMetaSnapshot(item);
+    assert(snap != NULL);
+    assert(get(snap, vlc_meta_Title) == NULL);
+    assert(get(snap, vlc_meta_Artist) == NULL);
+
+    /* Unchanged meta data: the snapshot is shared */
+    input_item_meta_snapshot_t *same = input_item_HoldMetaSnapshot(item);
+    assert(same == snap);
+    input_item_meta_snapshot_Release(same);
+
+    input_item_SetMeta(item, vlc_meta_Title, "Title");
+    input_item_SetMeta(item, vlc_meta_Artist, "Artist");
+
+    /* A held snapshot does not see later changes */
+    assert(get(snap, vlc_meta_Title) == NULL);
+    assert(get(snap, vlc_meta_Artist) == NULL);
+
+    input_item_meta_snapshot_t *snap2 = input_item_HoldMetaSnapshot(item);
+    assert(snap2 != NULL && snap2 != snap);
+    assert(strcmp(get(snap2, vlc_meta_Title), "Title") == 0);
+    assert(strcmp(get(snap2, vlc_meta_Artist), "Artist") == 0);
+    assert(get(snap2, vlc_meta_Album) == NULL);
+    input_item_meta_snapshot_Release(snap);
+
+    /* Retire snap2 from the item, then reclaim it from a writer */
+    input_item_SetMeta(item, vlc_meta_Title, NULL);
+    snap = input_item_HoldMetaSnapshot(item);
+    assert(snap != NULL && snap != snap2);
+    assert(get(snap, vlc_meta_Title) == NULL);
+    input_item_SetMeta(item, vlc_meta_Album, "Album");
+
+    /* Still owned by the caller */
+    assert(strcmp(get(snap2, vlc_meta_Title), "Title") == 0);
+    input_item_meta_snapshot_Release(snap2);
+    input_item_meta_snapshot_Release(snap);
+
+    char *str = input_item_GetMeta(item, vlc_meta_Album);
+    assert(str != NULL && strcmp(str, "Album") == 0);
+    free(str);
+    assert(input_item_MetaMatch(item, vlc_meta_Artist, "tis"));
+    assert(!input_item_MetaMatch(item, vlc_meta_Title, "Title"));
+
+    /* Retired snapshots left over are freed with the item */
+    input_item_SetMeta(item, vlc_meta_Album, NULL);
+    input_item_meta_snapshot_Release(input_item_HoldMetaSnapshot(item));
+    input_item_SetMeta(item, vlc_meta_Album, "Album");
+    input_item_meta_snapshot_Release(input_item_HoldMetaSnapshot(item));
+    input_item_Release(item);
+}
+
+struct reader
+{
+    input_item_t *item;
+    atomic_bool stop;
+};
+
+static void *read_thread(void *data)
+{
+    struct reader *r = data;
+
+    while (!atomic_load(&r->stop))
+    {
+        input_item_meta_snapshot_t *snap = input_item_HoldMetaSnapshot(r->item);
+        assert(snap != NULL);
+
+        const char *title = get(snap, vlc_meta_Title);
+        assert(title != NULL && strncmp(title, "Title ", 6) == 0);
+        input_item_meta_snapshot_Release(snap);
+    }
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    struct reader r;
+    vlc_thread_t th[2];
+
+    r.item = input_item_New("file:///dev/null", "test");
+    assert(r.item != NULL);
+    input_item_SetMeta(r.item, vlc_meta_Title, "Title 0");
+    atomic_init(&r.stop, false);
+
+    for (size_t i = 0; i < ARRAY_SIZE(th); i++)
+        if (vlc_clone(&th[i], read_thread, &r, VLC_THREAD_PRIORITY_LOW))
+            abort();
+
+    for (unsigned i = 1; i <= ITERATIONS; i++)
+    {
+        char title[16];
+
+        snprintf(title, sizeof (title), "Title %u", i);
+        input_item_SetMeta(r.item, vlc_meta_Title, title);
+    }
+
+    atomic_store(&r.stop, true);
+    for (size_t i = 0; i < ARRAY_SIZE(th); i++)
+        vlc_join(th[i], NULL);
+
+    char *str = input_item_GetMeta(r.item, vlc_meta_Title);
+    char title[16];
+
+    snprintf(title, sizeof (title), "Title %u", ITERATIONS);
+    assert(str != NULL && strcmp(str, title) == 0);
+    free(str);
+    input_item_Release(r.item);
+}
+
+int main(void)
+{
+    test_snapshot();
+    test_concurrent();
+    return 0;
+}
@@ -108,6 +108,95 @@ static void test(bool zombie)
             picture_Release(pics[i]);
 }
 
+static void test_cache(void)
+{
+    video_format_t fmt2;
+    picture_pool_t *pools[3];
+
+    video_format_Setup(&fmt2, VLC_CODEC_I420, 640, 480, 640, 480, 1, 1);
+
+    picture_pool_cache_t *cache = picture_pool_cache_New(2);
+    assert(cache != NULL);
+    assert(picture_pool_cache_Get(cache, &fmt, PICTURES) == NULL);
+
+    pools[0] = picture_pool_NewFromFormat(&fmt, PICTURES);
+    assert(pools[0] != NULL);
+    picture_t *pic = picture_pool_Get(pools[0]);
+    assert(pic != NULL);
+    picture_pool_cache_Put(cache, pools[0]);
+
+    /* Only the same format and size match */
+    assert(picture_pool_cache_Get(cache, &fmt2, PICTURES) == NULL);
+    assert(picture_pool_cache_Get(cache, &fmt, PICTURES / 2) == NULL);
+
+    pool = picture_pool_cache_Get(cache, &fmt, PICTURES);
+    assert(pool == pools[0]);
+    assert(picture_pool_cache_Get(cache, &fmt, PICTURES) == NULL);
+
+    /* The pool is usable again, including the late picture */
+    picture_t *pics[PICTURES];
+
+    picture_Release(pic);
+    for (unsigned i = 0; i < PICTURES; i++) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+    for (unsigned i = 0; i < PICTURES; i++)
+        picture_Release(pics[i]);
+    picture_pool_cache_Put(cache, pool);
+
+    /* The least recently used pool is evicted */
+    pools[1] = picture_pool_NewFromFormat(&fmt2, PICTURES);
+    assert(pools[1] != NULL);
+    picture_pool_cache_Put(cache, pools[1]);
+    pools[2] = picture_pool_NewFromFormat(&fmt2, PICTURES / 2);
+    assert(pools[2] != NULL);
+    picture_pool_cache_Put(cache, pools[2]);
+
+    assert(picture_pool_cache_Get(cache, &fmt, PICTURES) == NULL);
+    assert(picture_pool_cache_Get(cache, &fmt2, PICTURES) == pools[1]);
+    picture_pool_Release(pools[1]);
+
+    picture_pool_cache_Delete(cache);
+}
+
+static void *test_wait_thread(void *data)
+{
+    picture_pool_t *p = data;
+
+    for (unsigned i = 0; i < 1000; i++) {
+        picture_t *pic = picture_pool_Wait(p);
+        assert(pic != NULL);
+        picture_Release(pic);
+    }
+    return NULL;
+}
+
+static void test_wait(void)
+{
+    vlc_thread_t th[4];
+
+    pool = picture_pool_NewFromFormat(&fmt, 2);
+    assert(pool != NULL);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(th); i++) {
+        int ret = vlc_clone(&th[i], test_wait_thread, pool,
+                            VLC_THREAD_PRIORITY_LOW);
+        assert(ret == 0);
+    }
+    for (unsigned i = 0; i < ARRAY_SIZE(th); i++)
+        vlc_join(th[i], NULL);
+
+    picture_t *pics[2] = { picture_pool_Get(pool), picture_pool_Get(pool) };
+    assert(pics[0] != NULL && pics[1] != NULL);
+    assert(picture_pool_Get(pool) == NULL);
+    picture_Release(pics[0]);
+    picture_Release(pics[1]);
+
+    picture_pool_Release(pool);
+}
+
 int main(void)
 {
     video_format_Setup(&fmt, VLC_CODEC_I420, 320, 200, 320, 200, 1, 1);
@@ -123,6 +212,8 @@ int main(void)
 
     test(false);
     test(true);
+    test_cache();
+    test_wait();
 
     return 0;
 }
@@ -0,0 +1,196 @@
+/*****************************************************************************
+ * src/test/queue.c: thread-safe queues test and micro-benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_queue.h>
+#include <vlc_tick.h>
+
+#define ENTRIES 200000
+#define PRODUCERS 4
+
+struct entry
+{
+    struct entry *next;
+    uintptr_t value;
+};
+
+static struct entry entries[ENTRIES];
+
+static void test_ring_basic(void)
+{
+    vlc_ring_t *ring = vlc_ring_New(3, 0);
+    assert(ring != NULL);
+
+    assert(vlc_ring_TryDequeue(ring) == NULL);
+    assert(vlc_ring_GetCount(ring) == 0);
+
+    /* Capacity is rounded up to 4 */
+    for (unsigned i = 0; i < 4; i++)
+        assert(vlc_ring_TryEnqueue(ring, &entries[i]));
+    assert(!vlc_ring_TryEnqueue(ring, &entries[4]));
+    assert(vlc_ring_GetCount(ring) == 4);
+
+    for (unsigned i = 0; i < 4; i++)
+        assert(vlc_ring_TryDequeue(ring) == &entries[i]);
+    assert(vlc_ring_TryDequeue(ring) == NULL);
+
+    /* Entries queued before the end are still delivered */
+    assert(vlc_ring_Enqueue(ring, &entries[5]) == 0);
+    vlc_ring_Kill(ring);
+    assert(vlc_ring_Dequeue(ring) == &entries[5]);
+    assert(vlc_ring_Dequeue(ring) == NULL);
+
+    for (unsigned i = 0; i < 4; i++)
+        assert(vlc_ring_TryEnqueue(ring, &entries[i]));
+    assert(vlc_ring_Enqueue(ring, &entries[4]) == -1);
+    for (unsigned i = 0; i < 4; i++)
+        assert(vlc_ring_TryDequeue(ring) == &entries[i]);
+
+    vlc_ring_Delete(ring);
+}
+
+struct producer
+{
+    void *queue;
+    unsigned first;
+    unsigned count;
+};
+
+static void *RingProducer(void *data)
+{
+    struct producer *p = data;
+
+    for (unsigned i = 0; i < p->count; i++)
+        assert(vlc_ring_Enqueue(p->queue, &entries[p->first + i]) == 0);
+    return NULL;
+}
+
+static vlc_tick_t test_ring(unsigned producers)
+{
+    vlc_ring_t *ring = vlc_ring_New(256, (producers > 1)
+                                         ? VLC_RING_MULTI_PRODUCER : 0);
+    assert(ring != NULL);
+
+    struct producer p[PRODUCERS];
+    vlc_thread_t th[PRODUCERS];
+    uintptr_t last[PRODUCERS];
+    const unsigned count = ENTRIES / producers;
+    vlc_tick_t start = vlc_tick_now();
+
+    for (unsigned i = 0; i < producers; i++) {
+        p[i].queue = ring;
+        p[i].first = i * count;
+        p[i].count = count;
+        last[i] = 0;
+        assert(vlc_clone(&th[i], RingProducer, &p[i],
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+    }
+
+    /* Per-producer ordering must be preserved */
+    for (unsigned i = 0; i < count * producers; i++) {
+        struct entry *e = vlc_ring_Dequeue(ring);
+        unsigned n = e->value / count;
+
+        assert(n < producers);
+        assert(e->value % count == 0 || e->value > last[n]);
+        last[n] = e->value;
+    }
+
+    for (unsigned i = 0; i < producers; i++)
+        vlc_join(th[i], NULL);
+
+    vlc_tick_t duration = vlc_tick_now() - start;
+
+    assert(vlc_ring_TryDequeue(ring) == NULL);
+    vlc_ring_Delete(ring);
+    return duration;
+}
+
+static void *QueueProducer(void *data)
+{
+    struct producer *p = data;
+    vlc_queue_t *q = p->queue;
+
+    for (unsigned i = 0; i < p->count; i++)
+        vlc_queue_Enqueue(q, &entries[p->first + i]);
+    return NULL;
+}
+
+static vlc_tick_t test_queue(unsigned producers)
+{
+    vlc_queue_t q;
+    struct producer p[PRODUCERS];
+    vlc_thread_t th[PRODUCERS];
+    const unsigned count = ENTRIES / producers;
+
+    vlc_queue_Init(&q, offsetof (struct entry, next));
+
+    vlc_tick_t start = vlc_tick_now();
+
+    for (unsigned i = 0; i < producers; i++) {
+        p[i].queue = &q;
+        p[i].first = i * count;
+        p[i].count = count;
+        assert(vlc_clone(&th[i], QueueProducer, &p[i],
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+    }
+
+    for (unsigned i = 0; i < count * producers; i++)
+        assert(vlc_queue_Dequeue(&q) != NULL);
+
+    for (unsigned i = 0; i < producers; i++)
+        vlc_join(th[i], NULL);
+
+    return vlc_tick_now() - start;
+}
+
+static void bench(const char *name, vlc_tick_t queue, vlc_tick_t ring)
+{
+    printf("%s: vlc_queue_t %"PRId64" ns/entry, vlc_ring_t %"PRId64
+           " ns/entry\n", name, NS_FROM_VLC_TICK(queue) / ENTRIES,
+           NS_FROM_VLC_TICK(ring) / ENTRIES);
+}
+
+int main(void)
+{
+    for (unsigned i = 0; i < ENTRIES; i++)
+        entries[i].value = i;
+
+    test_ring_basic();
+
+    vlc_tick_t queue = test_queue(1);
+    vlc_tick_t ring = test_ring(1);
+    bench("single producer", queue, ring);
+
+    queue = test_queue(PRODUCERS);
+    ring = test_ring(PRODUCERS);
+    bench("multiple producers", queue, ring);
+    return 0;
+}
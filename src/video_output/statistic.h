@@ -23,6 +23,9 @@
 #ifndef LIBVLC_VOUT_STATISTIC_H
 # define LIBVLC_VOUT_STATISTIC_H
 # include <stdatomic.h>
+# include <vlc_common.h>
+# include <vlc_tick.h>
+# include "../misc/pacing.h"
 
 /* NOTE: Both statistics are atomic on their own, so one might be older than
  * the other one. Currently, only one of them is updated at a time, so this
@@ -31,6 +34,7 @@ typedef struct {
     atomic_uint displayed;
     atomic_uint lost;
     atomic_uint late;
+    atomic_uint pacing[INPUT_STATS_PACING_TYPES][INPUT_STATS_PACING_BUCKETS];
 } vout_statistic_t;
 
 static inline void vout_statistic_Init(vout_statistic_t *stat)
@@ -38,6 +42,9 @@ static inline void vout_statistic_Init(vout_statistic_t *stat)
     atomic_init(&stat->displayed, 0);
     atomic_init(&stat->lost, 0);
     atomic_init(&stat->late, 0);
+    for (unsigned i = 0; i < INPUT_STATS_PACING_TYPES; i++)
+        for (unsigned j = 0; j < INPUT_STATS_PACING_BUCKETS; j++)
+            atomic_init(&stat->pacing[i][j], 0);
 }
 
 static inline void vout_statistic_Clean(vout_statistic_t *stat)
@@ -48,12 +55,19 @@ static inline void vout_statistic_Clean(vout_statistic_t *stat)
 static inline void vout_statistic_GetReset(vout_statistic_t *stat,
                                            unsigned *restrict displayed,
                                            unsigned *restrict lost,
-                                           unsigned *restrict late)
+                                           unsigned *restrict late,
+                                           struct input_stats_pacing *pacing)
 {
     *displayed = atomic_exchange_explicit(&stat->displayed, 0,
                                           memory_order_relaxed);
     *lost = atomic_exchange_explicit(&stat->lost, 0, memory_order_relaxed);
     *late = atomic_exchange_explicit(&stat->late, 0, memory_order_relaxed);
+
+    for (unsigned i = 0; i < INPUT_STATS_PACING_TYPES; i++)
+        for (unsigned j = 0; j < INPUT_STATS_PACING_BUCKETS; j++)
+            pacing->histogram[i][j] =
+                atomic_exchange_explicit(&stat->pacing[i][j], 0,
+                                         memory_order_relaxed);
 }
 
 static inline void vout_statistic_AddDisplayed(vout_statistic_t *stat,
@@ -73,4 +87,17 @@ static inline void vout_statistic_AddLate(vout_statistic_t *stat, int late)
     atomic_fetch_add_explicit(&stat->late, late, memory_order_relaxed);
 }
 
+/* Accounts a picture delay into the first power of two (ms) bucket above it */
+static inline void vout_statistic_AddPacing(vout_statistic_t *stat,
+                                            enum input_stats_pacing_type type,
+                                            vlc_tick_t delay)
+{
+    unsigned i = 0;
+
+    while (i < INPUT_STATS_PACING_BUCKETS - 1
+        && delay >= VLC_TICK_FROM_MS(INT64_C(1) << i))
+        i++;
+    atomic_fetch_add_explicit(&stat->pacing[type][i], 1, memory_order_relaxed);
+}
+
 #endif
@@ -49,6 +49,8 @@
 #include <vlc_plugin.h>
 #include <vlc_codec.h>
 #include <vlc_atomic.h>
+#include <vlc_tracer.h>
+#include <vlc_cpu.h>
 
 #include <libvlc.h>
 #include "vout_private.h"
@@ -100,11 +102,12 @@ typedef struct vout_thread_sys_t
     vout_control_t  control;
     atomic_bool     control_is_terminated; // shutdown the vout thread
     vlc_thread_t    thread;
+    bool            display_suspended; // display kept without thread
 
     struct {
         vlc_tick_t  date;
         vlc_tick_t  timestamp;
-        bool        is_interlaced;
+        atomic_bool is_interlaced;
         picture_t   *decoded; // decoded picture before passed through chain_static
         picture_t   *current;
     } displayed;
@@ -128,6 +131,7 @@ typedef struct vout_thread_sys_t
 
     /* */
     bool            is_late_dropped;
+    bool            low_delay;
 
     /* */
     vlc_mouse_t     mouse;
@@ -159,11 +163,36 @@ typedef struct vout_thread_sys_t
     } filter;
 
     picture_fifo_t  *decoder_fifo;
+
+    /* Static filters run in advance by the prepare thread */
+    struct {
+        bool            running;
+        vlc_thread_t    thread;
+        vlc_mutex_t     lock;
+        vlc_cond_t      wait;
+        vlc_cond_t      wait_idle;
+        bool            terminate;
+        bool            paused;
+        bool            busy;    /* the thread owns the static filters */
+        unsigned        holds;
+        picture_t       *pending; /* decoded picture changing the filters */
+        vlc_picture_chain_t queue; /* filtered pictures, oldest first */
+        unsigned        count;
+    } prepare;
+
     struct {
         vout_chrono_t static_filter;
         vout_chrono_t render;         /**< picture render time estimator */
     } chrono;
 
+    /* Presentation feedback from the display */
+    struct {
+        vlc_mutex_t     lock;
+        vlc_tick_t      date;    /* last reported presentation */
+        vlc_tick_t      period;  /* refresh period, or 0 if unknown */
+        double          phase;   /* rounding offset, in refresh periods */
+    } vsync;
+
     vlc_atomic_rc_t rc;
 
 } vout_thread_sys_t;
@@ -185,6 +214,19 @@ typedef struct vout_thread_sys_t
 /* Better be in advance when awakening than late... */
 #define VOUT_MWAIT_TOLERANCE VLC_TICK_FROM_MS(4)
 
+/* Presentation feedback older than this is not trusted anymore */
+#define VOUT_VSYNC_TIMEOUT VLC_TICK_FROM_SEC(1)
+
+/* Pictures due closer than this (in refresh periods) to the middle of two
+ * refreshes make the rounding phase drift away from them. */
+#define VOUT_VSYNC_MARGIN 0.25
+#define VOUT_VSYNC_PHASE_STEP 0.02
+
+/* Maximum number of pictures filtered in advance by the prepare thread.
+ * They are allocated from the private pool, which is only a few pictures
+ * deep. */
+#define VOUT_PREPARE_QUEUE_MAX 1
+
 /* */
 static bool VoutCheckFormat(const video_format_t *src)
 {
@@ -231,11 +273,12 @@ static void vout_UpdateWindowSizeLocked(vout_thread_sys_t *vout)
 
 /* */
 void vout_GetResetStatistic(vout_thread_t *vout, unsigned *restrict displayed,
-                            unsigned *restrict lost, unsigned *restrict late)
+                            unsigned *restrict lost, unsigned *restrict late,
+                            struct input_stats_pacing *pacing)
 {
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
     assert(!sys->dummy);
-    vout_statistic_GetReset( &sys->statistic, displayed, lost, late );
+    vout_statistic_GetReset( &sys->statistic, displayed, lost, late, pacing );
 }
 
 bool vout_IsEmpty(vout_thread_t *vout)
@@ -245,7 +288,15 @@ bool vout_IsEmpty(vout_thread_t *vout)
     if (!sys->decoder_fifo)
         return true;
 
-    return picture_fifo_IsEmpty(sys->decoder_fifo);
+    if (!picture_fifo_IsEmpty(sys->decoder_fifo))
+        return false;
+    if (!sys->prepare.running)
+        return true;
+
+    vlc_mutex_lock(&sys->prepare.lock);
+    bool empty = sys->prepare.count == 0 && !sys->prepare.busy;
+    vlc_mutex_unlock(&sys->prepare.lock);
+    return empty;
 }
 
 void vout_DisplayTitle(vout_thread_t *vout, const char *title)
@@ -376,6 +427,12 @@ void vout_PutPicture(vout_thread_t *vout, picture_t *picture)
     assert(!sys->dummy);
     assert( !picture_HasChainedPics( picture ) );
     picture_fifo_Push(sys->decoder_fifo, picture);
+    if (sys->prepare.running)
+    {
+        vlc_mutex_lock(&sys->prepare.lock);
+        vlc_cond_signal(&sys->prepare.wait);
+        vlc_mutex_unlock(&sys->prepare.lock);
+    }
     vout_control_Wake(&sys->control);
 }
 
@@ -714,7 +771,9 @@ static picture_t *VoutVideoFilterStaticNewPicture(filter_t *filter)
 {
     vout_thread_sys_t *sys = filter->owner.sys;
 
-    vlc_mutex_assert(&sys->filter.lock);
+    /* The prepare thread runs the static filters without the filter lock:
+     * the interactive chain cannot change meanwhile. */
+    assert(vlc_mutex_held(&sys->filter.lock) || sys->prepare.busy);
     if (filter_chain_IsEmpty(sys->filter.chain_interactive))
         // we may be using the last filter of both chains, so we get the picture
         // from the display module pool, just like for the last interactive filter.
@@ -723,6 +782,47 @@ static picture_t *VoutVideoFilterStaticNewPicture(filter_t *filter)
     return picture_NewFromFormat(&filter->fmt_out.video);
 }
 
+/* Holds the prepare thread off the static filters and the prepared pictures,
+ * waiting for the picture it may be filtering. */
+static void PrepareHold(vout_thread_sys_t *sys)
+{
+    if (!sys->prepare.running)
+        return;
+
+    vlc_mutex_lock(&sys->prepare.lock);
+    sys->prepare.holds++;
+    while (sys->prepare.busy)
+        vlc_cond_wait(&sys->prepare.wait_idle, &sys->prepare.lock);
+    vlc_mutex_unlock(&sys->prepare.lock);
+}
+
+static void PrepareRelease(vout_thread_sys_t *sys)
+{
+    if (!sys->prepare.running)
+        return;
+
+    vlc_mutex_lock(&sys->prepare.lock);
+    assert(sys->prepare.holds > 0);
+    if (--sys->prepare.holds == 0)
+        vlc_cond_signal(&sys->prepare.wait);
+    vlc_mutex_unlock(&sys->prepare.lock);
+}
+
+static void PrepareFlush(vout_thread_sys_t *sys)
+{
+    vlc_picture_chain_t flush;
+
+    vlc_mutex_lock(&sys->prepare.lock);
+    vlc_picture_chain_GetAndClear(&sys->prepare.queue, &flush);
+    sys->prepare.count = 0;
+    vlc_cond_signal(&sys->prepare.wait);
+    vlc_mutex_unlock(&sys->prepare.lock);
+
+    picture_t *picture;
+    while ((picture = vlc_picture_chain_PopFront(&flush)) != NULL)
+        picture_Release(picture);
+}
+
 static void FilterFlush(vout_thread_sys_t *sys, bool is_locked)
 {
     if (sys->displayed.current)
@@ -731,6 +831,8 @@ static void FilterFlush(vout_thread_sys_t *sys, bool is_locked)
         sys->displayed.current = NULL;
     }
 
+    PrepareFlush(sys);
+
     if (!is_locked)
         vlc_mutex_lock(&sys->filter.lock);
     filter_chain_VideoFlush(sys->filter.chain_static);
@@ -867,7 +969,14 @@ static bool IsPictureLate(vout_thread_sys_t *vout, picture_t *decoded,
     }
     else
         late_threshold = VOUT_DISPLAY_LATE_THRESHOLD;
+    /* In low delay mode, do not show a picture later than the threshold even
+     * if the frame duration is longer: the next one will be on time. */
+    if (sys->low_delay)
+        late_threshold = __MIN(late_threshold, VOUT_DISPLAY_LATE_THRESHOLD);
     if (late > late_threshold) {
+        struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(&vout->obj));
+        if (tracer != NULL)
+            vlc_tracer_TraceLate(tracer, "DROP", "vout", decoded->date, late);
         msg_Warn(&vout->obj, "picture is too late to be displayed (missing %"PRId64" ms)", MS_FROM_VLC_TICK(late));
         return true;
     }
@@ -877,12 +986,14 @@ static bool IsPictureLate(vout_thread_sys_t *vout, picture_t *decoded,
 /* */
 VLC_USED
 static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
-                                 bool frame_by_frame)
+                                 bool frame_by_frame, bool async)
 {
     vout_thread_sys_t *sys = vout;
-    bool is_late_dropped = sys->is_late_dropped && !frame_by_frame;
+    /* Late pictures from the prepare thread are dropped once dequeued */
+    bool is_late_dropped = sys->is_late_dropped && !frame_by_frame && !async;
 
-    vlc_mutex_lock(&sys->filter.lock);
+    if (!async)
+        vlc_mutex_lock(&sys->filter.lock);
 
     picture_t *picture = filter_chain_VideoFilter(sys->filter.chain_static, NULL);
     assert(!reuse_decoded || !picture);
@@ -892,17 +1003,27 @@ static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
         if (unlikely(reuse_decoded && sys->displayed.decoded)) {
             decoded = picture_Hold(sys->displayed.decoded);
         } else {
-            decoded = picture_fifo_Pop(sys->decoder_fifo);
+            bool dequeued = sys->prepare.pending == NULL;
+            if (!dequeued) {
+                decoded = sys->prepare.pending;
+                sys->prepare.pending = NULL;
+            } else
+                decoded = picture_fifo_Pop(sys->decoder_fifo);
 
             if (decoded) {
-                if (is_late_dropped && !decoded->b_force)
+                if (!frame_by_frame && !decoded->b_force)
                 {
                     const vlc_tick_t system_now = vlc_tick_now();
                     const vlc_tick_t system_pts =
                         vlc_clock_ConvertToSystem(sys->clock, system_now,
                                                   decoded->date, sys->rate);
 
-                    if (system_pts != VLC_TICK_MAX &&
+                    if (dequeued && system_pts != VLC_TICK_MAX)
+                        vout_statistic_AddPacing(&sys->statistic,
+                                                 INPUT_STATS_PACING_DECODE,
+                                                 system_now - system_pts);
+
+                    if (is_late_dropped && system_pts != VLC_TICK_MAX &&
                         IsPictureLate(vout, decoded, system_now, system_pts))
                     {
                         picture_Release(decoded);
@@ -913,6 +1034,12 @@ static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
                 vlc_video_context *pic_vctx = picture_GetVideoContext(decoded);
                 if (!VideoFormatIsCropArEqual(&decoded->format, &sys->filter.src_fmt))
                 {
+                    if (async)
+                    {
+                        // the filters are only changed by the vout thread
+                        sys->prepare.pending = decoded;
+                        break;
+                    }
                     // we received an aspect ratio change
                     // Update the filters with the filter source format with the new aspect ratio
                     video_format_Clean(&sys->filter.src_fmt);
@@ -934,16 +1061,114 @@ static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
             picture_Release(sys->displayed.decoded);
 
         sys->displayed.decoded       = picture_Hold(decoded);
-        sys->displayed.timestamp     = decoded->date;
-        sys->displayed.is_interlaced = !decoded->b_progressive;
+        if (!async) /* set when dequeued otherwise */
+            sys->displayed.timestamp = decoded->date;
+        atomic_store(&sys->displayed.is_interlaced, !decoded->b_progressive);
 
+        struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(&sys->obj));
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanBegin(tracer, "FILTER", "vout");
         vout_chrono_Start(&sys->chrono.static_filter);
         picture = filter_chain_VideoFilter(sys->filter.chain_static, sys->displayed.decoded);
-        vout_chrono_Stop(&sys->chrono.static_filter);
+        vout_statistic_AddPacing(&sys->statistic, INPUT_STATS_PACING_FILTER,
+                                 vout_chrono_Stop(&sys->chrono.static_filter));
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanEnd(tracer, "FILTER", "vout");
     }
 
-    vlc_mutex_unlock(&sys->filter.lock);
+    if (!async)
+        vlc_mutex_unlock(&sys->filter.lock);
+
+    return picture;
+}
+
+static void *PrepareThread(void *object)
+{
+    vout_thread_sys_t *sys = object;
 
+    vlc_mutex_lock(&sys->prepare.lock);
+    for (;;)
+    {
+        while (!sys->prepare.terminate
+            && (sys->prepare.holds > 0 || sys->prepare.paused
+             || sys->prepare.pending != NULL
+             || sys->prepare.count >= VOUT_PREPARE_QUEUE_MAX
+             || picture_fifo_IsEmpty(sys->decoder_fifo)))
+            vlc_cond_wait(&sys->prepare.wait, &sys->prepare.lock);
+
+        if (sys->prepare.terminate)
+            break;
+
+        sys->prepare.busy = true;
+        vlc_mutex_unlock(&sys->prepare.lock);
+
+        picture_t *picture = PreparePicture(sys, false, false, true);
+
+        vlc_mutex_lock(&sys->prepare.lock);
+        sys->prepare.busy = false;
+        vlc_cond_broadcast(&sys->prepare.wait_idle);
+
+        if (picture != NULL)
+        {
+            vlc_picture_chain_Append(&sys->prepare.queue, picture);
+            sys->prepare.count++;
+        }
+        if (picture != NULL || sys->prepare.pending != NULL)
+            vout_control_Wake(&sys->control);
+    }
+    vlc_mutex_unlock(&sys->prepare.lock);
+    return NULL;
+}
+
+/* Dequeues the next picture filtered by the prepare thread, if any.
+ * The prepare thread must be held. */
+static picture_t *PreparedPop(vout_thread_sys_t *sys, bool frame_by_frame)
+{
+    const bool is_late_dropped = sys->is_late_dropped && !frame_by_frame;
+    picture_t *picture;
+
+    for (;;)
+    {
+        vlc_mutex_lock(&sys->prepare.lock);
+        picture = vlc_picture_chain_PopFront(&sys->prepare.queue);
+        if (picture != NULL)
+        {
+            sys->prepare.count--;
+            vlc_cond_signal(&sys->prepare.wait);
+        }
+        vlc_mutex_unlock(&sys->prepare.lock);
+
+        if (picture == NULL || !is_late_dropped || picture->b_force)
+            break;
+
+        const vlc_tick_t system_now = vlc_tick_now();
+        const vlc_tick_t system_pts =
+            vlc_clock_ConvertToSystem(sys->clock, system_now, picture->date,
+                                      sys->rate);
+        if (system_pts == VLC_TICK_MAX
+         || !IsPictureLate(sys, picture, system_now, system_pts))
+            break;
+
+        picture_Release(picture);
+        vout_statistic_AddLost(&sys->statistic, 1);
+    }
+
+    if (picture != NULL)
+        sys->displayed.timestamp = picture->date;
+    return picture;
+}
+
+static picture_t *PrepareNextPicture(vout_thread_sys_t *sys, bool reuse_decoded,
+                                     bool frame_by_frame)
+{
+    if (!sys->prepare.running)
+        return PreparePicture(sys, reuse_decoded, frame_by_frame, false);
+
+    PrepareHold(sys);
+    picture_t *picture = PreparedPop(sys, frame_by_frame);
+    if (picture == NULL)
+        picture = PreparePicture(sys, reuse_decoded, frame_by_frame, false);
+    PrepareRelease(sys);
     return picture;
 }
 
@@ -1194,13 +1419,74 @@ static int PrerenderPicture(vout_thread_sys_t *sys, picture_t *filtered,
     return VLC_SUCCESS;
 }
 
+void vout_ReportVsync(vout_thread_t *vout, vlc_tick_t date, vlc_tick_t period)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+
+    vlc_mutex_lock(&sys->vsync.lock);
+    sys->vsync.date = date;
+    sys->vsync.period = period;
+    vlc_mutex_unlock(&sys->vsync.lock);
+}
+
+/**
+ * Moves a display date onto a refresh of the display.
+ *
+ * The picture is shown at the nearest refresh anyway, so the video output
+ * may as well aim exactly for that one. The picture is handed over to the
+ * display half a refresh period before (returned in lead), so that it is
+ * neither missed nor shown one refresh too early.
+ *
+ * The rounding threshold moves away from pictures falling halfway between
+ * two refreshes, so that the jitter does not pick either refresh at random:
+ * e.g. 24 fps on a 60 Hz display settles on a regular 3:2 cadence.
+ */
+static vlc_tick_t VsyncAlign(vout_thread_sys_t *sys, vlc_tick_t system_pts,
+                             vlc_tick_t *restrict lead)
+{
+    *lead = 0;
+    vlc_mutex_lock(&sys->vsync.lock);
+
+    const vlc_tick_t date = sys->vsync.date;
+    const vlc_tick_t period = sys->vsync.period;
+
+    if (date == VLC_TICK_INVALID || period <= 0
+     || system_pts - date > VOUT_VSYNC_TIMEOUT)
+    {
+        vlc_mutex_unlock(&sys->vsync.lock);
+        return system_pts;
+    }
+
+    double pos = (double)(system_pts - date) / period + sys->vsync.phase;
+    double vsync = floor(pos + .5);
+    double error = pos - vsync;
+
+    if (error > VOUT_VSYNC_MARGIN)
+        sys->vsync.phase -= VOUT_VSYNC_PHASE_STEP;
+    else if (error < -VOUT_VSYNC_MARGIN)
+        sys->vsync.phase += VOUT_VSYNC_PHASE_STEP;
+    if (sys->vsync.phase > .5)
+        sys->vsync.phase -= 1.;
+    else if (sys->vsync.phase < -.5)
+        sys->vsync.phase += 1.;
+    vlc_mutex_unlock(&sys->vsync.lock);
+
+    *lead = period / 2;
+    return date + (vlc_tick_t)vsync * period;
+}
+
 static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
 {
     vout_display_t *vd = sys->display;
+    struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(&sys->obj));
 
     vout_chrono_Start(&sys->chrono.render);
 
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanBegin(tracer, "FILTER", "vout");
     picture_t *filtered = FilterPictureInteractive(sys);
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanEnd(tracer, "FILTER", "vout");
     if (!filtered)
         return VLC_EGENERIC;
 
@@ -1228,14 +1514,29 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
         render_now = true;
     }
 
+    vlc_tick_t vsync_offset = 0, vsync_lead = 0;
+    if (!render_now)
+    {
+        vsync_offset = VsyncAlign(sys, system_pts, &vsync_lead) - system_pts;
+        system_pts += vsync_offset;
+    }
+
     const unsigned frame_rate = todisplay->format.i_frame_rate;
     const unsigned frame_rate_base = todisplay->format.i_frame_rate_base;
 
     if (vd->ops->prepare != NULL)
+    {
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanBegin(tracer, "PREPARE", "vout");
         vd->ops->prepare(vd, todisplay, subpic, system_pts);
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanEnd(tracer, "PREPARE", "vout");
+    }
 
-    vout_chrono_Stop(&sys->chrono.render);
+    vout_statistic_AddPacing(&sys->statistic, INPUT_STATS_PACING_RENDER,
+                             vout_chrono_Stop(&sys->chrono.render));
 
+    const vlc_tick_t system_target = system_pts;
     system_now = vlc_tick_now();
     if (!render_now)
     {
@@ -1243,6 +1544,8 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
         if (unlikely(late > 0))
         {
             msg_Dbg(vd, "picture displayed late (missing %"PRId64" ms)", MS_FROM_VLC_TICK(late));
+            if (tracer != NULL)
+                vlc_tracer_TraceLate(tracer, "LATE", "vout", pts, late);
             vout_statistic_AddLate(&sys->statistic, 1);
 
             /* vd->prepare took too much time. Tell the clock that the pts was
@@ -1266,12 +1569,13 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
                 else
                 {
                     deadline = vlc_clock_ConvertToSystemLocked(sys->clock,
-                                                vlc_tick_now(), pts, sys->rate);
+                                                vlc_tick_now(), pts, sys->rate)
+                             + vsync_offset - vsync_lead;
                     if (deadline > max_deadline)
                         deadline = max_deadline;
                 }
 
-                system_pts = deadline;
+                system_pts = deadline + vsync_lead;
                 timed_out = vlc_clock_Wait(sys->clock, deadline);
             }
 
@@ -1289,9 +1593,17 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
                           frame_rate, frame_rate_base);
 
     /* Display the direct buffer returned by vout_RenderPicture */
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanBegin(tracer, "DISPLAY", "vout");
     vout_display_Display(vd, todisplay);
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanEnd(tracer, "DISPLAY", "vout");
     vlc_mutex_unlock(&sys->display_lock);
 
+    if (!render_now)
+        vout_statistic_AddPacing(&sys->statistic, INPUT_STATS_PACING_DISPLAY,
+                                 vlc_tick_now() - system_target);
+
     picture_Release(todisplay);
 
     if (subpic)
@@ -1309,7 +1621,9 @@ static void UpdateDeinterlaceFilter(vout_thread_sys_t *sys)
         sys->private.interlacing.has_deint != sys->filter.new_interlaced)
     {
         sys->private.interlacing.has_deint = sys->filter.new_interlaced;
+        PrepareHold(sys);
         ChangeFilters(sys);
+        PrepareRelease(sys);
     }
     vlc_mutex_unlock(&sys->filter.lock);
 }
@@ -1318,7 +1632,7 @@ static int DisplayNextFrame(vout_thread_sys_t *sys)
 {
     UpdateDeinterlaceFilter(sys);
 
-    picture_t *next = PreparePicture(sys, !sys->displayed.current, true);
+    picture_t *next = PrepareNextPicture(sys, !sys->displayed.current, true);
 
     if (next)
     {
@@ -1363,7 +1677,7 @@ static vlc_tick_t DisplayPicture(vout_thread_sys_t *vout)
     picture_t *next = NULL;
     if (first)
     {
-        next = PreparePicture(vout, true, false);
+        next = PrepareNextPicture(vout, true, false);
         if (!next)
             return vlc_tick_now() + VOUT_REDISPLAY_DELAY; /* Unknown deadline */
     }
@@ -1378,7 +1692,7 @@ static vlc_tick_t DisplayPicture(vout_thread_sys_t *vout)
             if (system_prepare_current <= system_now)
             {
                 // the current frame will be late, look for the next not late one
-                next = PreparePicture(vout, false, false);
+                next = PrepareNextPicture(vout, false, false);
             }
         }
     }
@@ -1435,13 +1749,24 @@ void vout_ChangePause(vout_thread_t *vout, bool is_paused, vlc_tick_t date)
     assert(!sys->pause.is_on || !is_paused);
 
     if (sys->pause.is_on)
+    {
+        PrepareHold(sys);
         FilterFlush(sys, false);
+        PrepareRelease(sys);
+    }
     else {
         sys->step.timestamp = VLC_TICK_INVALID;
         sys->step.last      = VLC_TICK_INVALID;
     }
     sys->pause.is_on = is_paused;
     sys->pause.date  = date;
+    if (sys->prepare.running)
+    {
+        vlc_mutex_lock(&sys->prepare.lock);
+        sys->prepare.paused = is_paused;
+        vlc_cond_signal(&sys->prepare.wait);
+        vlc_mutex_unlock(&sys->prepare.lock);
+    }
     vout_control_Release(&sys->control);
 
     vlc_mutex_lock(&sys->window_lock);
@@ -1457,6 +1782,7 @@ static void vout_FlushUnlocked(vout_thread_sys_t *vout, bool below,
     sys->step.timestamp = VLC_TICK_INVALID;
     sys->step.last      = VLC_TICK_INVALID;
 
+    PrepareHold(vout);
     FilterFlush(vout, false); /* FIXME too much */
 
     picture_t *last = sys->displayed.decoded;
@@ -1472,7 +1798,18 @@ static void vout_FlushUnlocked(vout_thread_sys_t *vout, bool below,
         }
     }
 
+    picture_t *pending = sys->prepare.pending;
+    if (pending != NULL) {
+        if ((date == VLC_TICK_INVALID) ||
+            ( below && pending->date <= date) ||
+            (!below && pending->date >= date)) {
+            picture_Release(pending);
+            sys->prepare.pending = NULL;
+        }
+    }
+
     picture_fifo_Flush(sys->decoder_fifo, date, below);
+    PrepareRelease(vout);
 
     vlc_mutex_lock(&sys->display_lock);
     if (sys->display != NULL)
@@ -1537,7 +1874,9 @@ void vout_ChangeRate(vout_thread_t *vout, float rate)
     assert(!sys->dummy);
 
     vout_control_Hold(&sys->control);
+    PrepareHold(sys);
     sys->rate = rate;
+    PrepareRelease(sys);
     vout_control_Release(&sys->control);
 }
 
@@ -1568,6 +1907,7 @@ static void ProcessMouseState(vout_thread_sys_t *p_vout,
 
     /* pass mouse coordinates in the filter chains. */
     m = win_mouse;
+    PrepareHold(sys);
     vlc_mutex_lock(&sys->filter.lock);
     if (sys->filter.chain_static && sys->filter.chain_interactive) {
         if (!filter_chain_MouseFilter(sys->filter.chain_interactive,
@@ -1578,6 +1918,7 @@ static void ProcessMouseState(vout_thread_sys_t *p_vout,
             m = &tmp2;
     }
     vlc_mutex_unlock(&sys->filter.lock);
+    PrepareRelease(sys);
 
     if (vlc_mouse_HasMoved(&sys->mouse, m))
         var_SetCoords(vout, "mouse-moved", m->i_x, m->i_y);
@@ -1651,6 +1992,12 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
     dcfg.display.width = sys->window_width;
     dcfg.display.height = sys->window_height;
 
+    vlc_mutex_lock(&sys->vsync.lock);
+    sys->vsync.date = VLC_TICK_INVALID;
+    sys->vsync.period = 0;
+    sys->vsync.phase = 0.;
+    vlc_mutex_unlock(&sys->vsync.lock);
+
     sys->display = vout_OpenWrapper(&vout->obj, &sys->private, sys->splitter_name, &dcfg,
                                     &sys->original, vctx);
     if (sys->display == NULL) {
@@ -1670,7 +2017,7 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
     sys->displayed.decoded       = NULL;
     sys->displayed.date          = VLC_TICK_INVALID;
     sys->displayed.timestamp     = VLC_TICK_INVALID;
-    sys->displayed.is_interlaced = false;
+    atomic_init(&sys->displayed.is_interlaced, false);
 
     sys->step.last               = VLC_TICK_INVALID;
     sys->step.timestamp          = VLC_TICK_INVALID;
@@ -1681,6 +2028,10 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
     sys->spu_blend_chroma        = 0;
     sys->spu_blend               = NULL;
 
+    sys->prepare.pending = NULL;
+    vlc_picture_chain_Init(&sys->prepare.queue);
+    sys->prepare.count   = 0;
+
     video_format_Print(VLC_OBJECT(&vout->obj), "original format", &sys->original);
     return VLC_SUCCESS;
 error:
@@ -1717,6 +2068,8 @@ static void *Thread(void *object)
     vout_thread_sys_t *vout = object;
     vout_thread_sys_t *sys = vout;
 
+    vlc_CPU_PinThread(VLC_OBJECT(&sys->obj), "vout");
+
     vlc_tick_t deadline = VLC_TICK_INVALID;
 
     for (;;) {
@@ -1739,19 +2092,54 @@ static void *Thread(void *object)
         if (atomic_load(&sys->control_is_terminated))
             break;
 
-        const bool picture_interlaced = sys->displayed.is_interlaced;
+        const bool picture_interlaced =
+            atomic_load(&sys->displayed.is_interlaced);
 
         vout_SetInterlacingState(&vout->obj, &sys->private, picture_interlaced);
     }
     return NULL;
 }
 
+static void vout_StartPrepare(vout_thread_sys_t *sys)
+{
+    assert(!sys->prepare.running);
+    if (!var_InheritBool(&sys->obj, "video-filter-thread"))
+        return;
+
+    sys->prepare.terminate = false;
+    sys->prepare.paused = false;
+    sys->prepare.busy = false;
+    sys->prepare.holds = 0;
+    sys->prepare.running = true;
+    if (vlc_clone(&sys->prepare.thread, PrepareThread, sys,
+                  VLC_THREAD_PRIORITY_VIDEO))
+    {
+        msg_Warn(&sys->obj, "cannot filter pictures in advance");
+        sys->prepare.running = false;
+    }
+}
+
+static void vout_StopPrepare(vout_thread_sys_t *sys)
+{
+    if (!sys->prepare.running)
+        return;
+
+    vlc_mutex_lock(&sys->prepare.lock);
+    sys->prepare.terminate = true;
+    vlc_cond_signal(&sys->prepare.wait);
+    vlc_mutex_unlock(&sys->prepare.lock);
+    vlc_join(sys->prepare.thread, NULL);
+    sys->prepare.running = false;
+}
+
 static void vout_ReleaseDisplay(vout_thread_sys_t *vout)
 {
     vout_thread_sys_t *sys = vout;
 
     assert(sys->display != NULL);
 
+    vout_StopPrepare(sys);
+
     if (sys->spu_blend != NULL)
         filter_DeleteBlend(sys->spu_blend);
 
@@ -1794,18 +2182,52 @@ static void vout_ReleaseDisplay(vout_thread_sys_t *vout)
     sys->clock = NULL;
 }
 
-void vout_StopDisplay(vout_thread_t *vout)
+static void vout_StopThread(vout_thread_sys_t *sys)
 {
-    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
-
     atomic_store(&sys->control_is_terminated, true);
     // wake up so it goes back to the loop that will detect the terminated state
     vout_control_Wake(&sys->control);
     vlc_join(sys->thread, NULL);
+}
+
+void vout_StopDisplay(vout_thread_t *vout)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+
+    if (sys->display_suspended)
+        sys->display_suspended = false;
+    else
+        vout_StopThread(sys);
 
     vout_ReleaseDisplay(sys);
 }
 
+void vout_SuspendDisplay(vout_thread_t *vout)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+
+    assert(sys->display != NULL && !sys->display_suspended);
+    vout_StopThread(sys);
+    vout_StopPrepare(sys);
+
+    /* Drop everything tied to the previous source, the last picture stays
+     * on the display */
+    vout_FlushUnlocked(sys, true, VLC_TICK_MAX);
+    sys->pause.is_on = false;
+    sys->pause.date = VLC_TICK_INVALID;
+
+    if (sys->mouse_event)
+    {
+        sys->mouse_event(NULL, sys->mouse_opaque);
+        sys->mouse_event = NULL;
+    }
+
+    if (sys->spu)
+        spu_Detach(sys->spu);
+    sys->clock = NULL;
+    sys->display_suspended = true;
+}
+
 static void vout_DisableWindow(vout_thread_sys_t *sys)
 {
     vlc_mutex_lock(&sys->window_lock);
@@ -1816,6 +2238,37 @@ static void vout_DisableWindow(vout_thread_sys_t *sys)
     vlc_mutex_unlock(&sys->window_lock);
 }
 
+static int vout_ResumeDisplay(vout_thread_sys_t *sys,
+                              const vout_configuration_t *cfg,
+                              input_thread_t *input)
+{
+    assert(sys->display_suspended);
+
+    sys->mouse_event = cfg->mouse_event;
+    sys->mouse_opaque = cfg->mouse_opaque;
+    vlc_mouse_Init(&sys->mouse);
+
+    sys->delay = 0;
+    sys->rate = 1.f;
+    sys->clock = cfg->clock;
+
+    atomic_store(&sys->control_is_terminated, false);
+    vout_StartPrepare(sys);
+    if (vlc_clone(&sys->thread, Thread, sys, VLC_THREAD_PRIORITY_OUTPUT)) {
+        sys->display_suspended = false;
+        vout_ReleaseDisplay(sys);
+        vout_DisableWindow(sys);
+        return -1;
+    }
+    sys->display_suspended = false;
+
+    msg_Dbg(cfg->vout, "resuming the display for a new source");
+    if (input != NULL && sys->spu)
+        spu_Attach(sys->spu, input);
+    vout_IntfReinit(cfg->vout);
+    return 0;
+}
+
 void vout_Stop(vout_thread_t *vout)
 {
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
@@ -1955,6 +2408,7 @@ vout_thread_t *vout_Create(vlc_object_t *object)
 
     vout_control_Init(&sys->control);
     atomic_init(&sys->control_is_terminated, false);
+    sys->display_suspended = false;
 
     sys->title.show     = var_InheritBool(vout, "video-title-show");
     sys->title.timeout  = var_InheritInteger(vout, "video-title-timeout");
@@ -1962,14 +2416,26 @@ vout_thread_t *vout_Create(vlc_object_t *object)
 
     vout_InitInterlacingSupport(vout, &sys->private);
 
-    sys->is_late_dropped = var_InheritBool(vout, "drop-late-frames");
+    sys->low_delay = var_InheritBool(vout, "low-delay");
+    sys->is_late_dropped = sys->low_delay ||
+                           var_InheritBool(vout, "drop-late-frames");
 
     vlc_mutex_init(&sys->filter.lock);
 
+    sys->prepare.running = false;
+    vlc_mutex_init(&sys->prepare.lock);
+    vlc_cond_init(&sys->prepare.wait);
+    vlc_cond_init(&sys->prepare.wait_idle);
+
     /* Display */
     sys->display = NULL;
     vlc_mutex_init(&sys->display_lock);
 
+    vlc_mutex_init(&sys->vsync.lock);
+    sys->vsync.date = VLC_TICK_INVALID;
+    sys->vsync.period = 0;
+    sys->vsync.phase = 0.;
+
     /* Window */
     sys->window_width = sys->window_height = 0;
     sys->display_cfg.window = vout_display_window_New(vout);
@@ -2078,9 +2544,16 @@ int vout_Request(const vout_configuration_t *cfg, vlc_video_context *vctx, input
     video_format_t original;
     VoutFixFormat(&original, cfg->fmt);
 
-    if (vout_ChangeSource(cfg->vout, &original) == 0)
+    /* A suspended display can only be reused by software decoders, since the
+     * video context of the previous source is gone */
+    const bool resumable = !sys->display_suspended
+                        || (vctx == NULL && sys->filter.src_vctx == NULL);
+
+    if (resumable && vout_ChangeSource(cfg->vout, &original) == 0)
     {
         video_format_Clean(&original);
+        if (sys->display_suspended)
+            return vout_ResumeDisplay(vout, cfg, input);
         return 0;
     }
 
@@ -2116,6 +2589,7 @@ int vout_Request(const vout_configuration_t *cfg, vlc_video_context *vctx, input
         return -1;
     }
     atomic_store(&sys->control_is_terminated, false);
+    vout_StartPrepare(vout);
     if (vlc_clone(&sys->thread, Thread, vout, VLC_THREAD_PRIORITY_OUTPUT)) {
         vout_ReleaseDisplay(vout);
         vout_DisableWindow(vout);
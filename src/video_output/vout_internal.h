@@ -28,6 +28,7 @@
 
 typedef struct input_thread_t input_thread_t;
 typedef struct vlc_clock_t vlc_clock_t;
+struct input_stats_pacing;
 
 /* It should be high enough to absorbe jitter due to difficult picture(s)
  * to decode but not too high as memory is not that cheap.
@@ -92,6 +93,16 @@ void vout_Stop(vout_thread_t *);
  */
 void vout_StopDisplay(vout_thread_t *);
 
+/**
+ * Stop the video output thread and detach the vout from its source, but keep
+ * the display plugin running (showing the last picture).
+ *
+ * The next vout_Request() with a similar software format resumes the display
+ * for the new source instead of opening a new one. Otherwise, the display is
+ * stopped as usual.
+ */
+void vout_SuspendDisplay(vout_thread_t *);
+
 /**
  * Set the new source format for a started vout
  *
@@ -220,7 +231,8 @@ void vout_MouseState(vout_thread_t *, const vlc_mouse_t *);
  * This function will return and reset internal statistics.
  */
 void vout_GetResetStatistic( vout_thread_t *p_vout, unsigned *pi_displayed,
-                             unsigned *pi_lost, unsigned *pi_late );
+                             unsigned *pi_lost, unsigned *pi_late,
+                             struct input_stats_pacing *pacing );
 
 /**
  * This function will force to display the next picture while paused
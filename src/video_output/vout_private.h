@@ -48,6 +48,8 @@ vout_display_t *vout_OpenWrapper(vout_thread_t *, vout_thread_private_t *, const
                      const vout_display_cfg_t *, const video_format_t *, vlc_video_context *);
 void vout_CloseWrapper(vout_thread_t *, vout_thread_private_t *, vout_display_t *vd);
 
+void vout_ReportVsync(vout_thread_t *, vlc_tick_t date, vlc_tick_t period);
+
 void vout_InitInterlacingSupport(vout_thread_t *, vout_thread_private_t *);
 void vout_ReinitInterlacingSupport(vout_thread_t *, vout_thread_private_t *);
 void vout_SetInterlacingState(vout_thread_t *, vout_thread_private_t *, bool is_interlaced);
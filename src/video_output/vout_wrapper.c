@@ -49,6 +49,11 @@ static void VoutViewpointMoved(void *sys, const vlc_viewpoint_t *vp)
     var_SetAddress(vout, "viewpoint-moved", (void*)vp);
 }
 
+static void VoutVsync(void *sys, vlc_tick_t date, vlc_tick_t period)
+{
+    vout_ReportVsync(sys, date, period);
+}
+
 /* Minimum number of display picture */
 #define DISPLAY_PICTURE_COUNT (1)
 
@@ -61,7 +66,8 @@ vout_display_t *vout_OpenWrapper(vout_thread_t *vout, vout_thread_private_t *sys
 {
     vout_display_t *vd;
     vout_display_owner_t owner = {
-        .viewpoint_moved = VoutViewpointMoved, .sys = vout,
+        .viewpoint_moved = VoutViewpointMoved, .vsync = VoutVsync,
+        .sys = vout,
     };
     const char *modlist;
     char *modlistbuf = NULL;
@@ -206,6 +206,9 @@ static void test_media_player_play_stop(const char** argv, int argc)
 
     play_and_wait(mi);
 
+    libvlc_frame_pacing_t pacing;
+    assert (libvlc_media_player_get_frame_pacing (mi, &pacing) == 0);
+
     libvlc_media_player_stop_async (mi);
     libvlc_media_player_release (mi);
     libvlc_release (vlc);
@@ -50,7 +50,6 @@ static void Parse(vlc_object_t *obj, void *priv, block_t *data, stime_t t)
     block_ChainRelease(pes.gather.p_data);\
     memset(&pes, 0, sizeof(pes));\
     pes.transport = TS_TRANSPORT_PES;\
-    pes.gather.pp_last = &pes.gather.p_data;\
     } while(0)
 
 #define ASSERT(a) do {\
@@ -88,7 +87,6 @@ int main()
     ts_stream_t pes;
     memset(&pes, 0, sizeof(pes));
     pes.transport = TS_TRANSPORT_PES;
-    pes.gather.pp_last = &pes.gather.p_data;
 
     /* General case, aligned payloads */
     /* payload == 0 */
@@ -0,0 +1,188 @@
+/*****************************************************************************
+ * volume.c: audio volume modules test and benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+#include <vlc_aout.h>
+#include <vlc_aout_volume.h>
+
+#include <assert.h>
+#include <math.h>
+
+#define SAMPLES 4099 /* not a multiple of any vector size */
+#define BENCH_RUNS 500
+
+static const vlc_fourcc_t formats[] = {
+    VLC_CODEC_FL32, VLC_CODEC_FL64, VLC_CODEC_S32N, VLC_CODEC_S16N,
+    VLC_CODEC_U8,
+};
+
+static double get_sample(vlc_fourcc_t format, const void *buf, size_t i)
+{
+    switch (format) {
+        case VLC_CODEC_FL32: return ((const float *)buf)[i];
+        case VLC_CODEC_FL64: return ((const double *)buf)[i];
+        case VLC_CODEC_S32N: return ((const int32_t *)buf)[i] / 0x1.p31;
+        case VLC_CODEC_S16N: return ((const int16_t *)buf)[i] / 0x1.p15;
+        case VLC_CODEC_U8: return (((const uint8_t *)buf)[i] - 128) / 0x1.p7;
+    }
+    vlc_assert_unreachable();
+}
+
+static void fill(vlc_fourcc_t format, block_t *block)
+{
+    size_t n = block->i_buffer * 8 / aout_BitsPerSample(format);
+
+    for (size_t i = 0; i < n; i++) {
+        /* Mostly below half scale, with a few peaks to check clipping */
+        double v = sin(i * 0.05) * ((i % 97) ? .45 : .99);
+
+        switch (format) {
+            case VLC_CODEC_FL32: ((float *)block->p_buffer)[i] = v; break;
+            case VLC_CODEC_FL64: ((double *)block->p_buffer)[i] = v; break;
+            case VLC_CODEC_S32N:
+                ((int32_t *)block->p_buffer)[i] = lrint(v * 0x1.p31);
+                break;
+            case VLC_CODEC_S16N:
+                ((int16_t *)block->p_buffer)[i] = lrint(v * 0x1.p15);
+                break;
+            case VLC_CODEC_U8:
+                ((uint8_t *)block->p_buffer)[i] = 128 + lrint(v * 0x1.p7);
+                break;
+        }
+    }
+}
+
+/* Checks a buffer against the expected gain of each sample */
+static void check(vlc_fourcc_t format, const block_t *in, const block_t *out,
+                  float from, float to, bool ramp)
+{
+    size_t n = in->i_buffer * 8 / aout_BitsPerSample(format);
+    /* One quantization step of the format (Q8 gain for integers) */
+    double tolerance = (format == VLC_CODEC_FL32) ? 1e-6 :
+                       (format == VLC_CODEC_FL64) ? 1e-12 :
+                       (format == VLC_CODEC_U8) ? 2. / 0x1.p7 : 1. / 0x1.p8;
+
+    for (size_t i = 0; i < n; i++) {
+        double gain = ramp ? from + ((double)to - from) * (i + 1) / n : to;
+        double expected = get_sample(format, in->p_buffer, i) * gain;
+
+        if (format != VLC_CODEC_FL32 && format != VLC_CODEC_FL64)
+            expected = fmin(fmax(expected, -1.), 1.);
+
+        double delta = fabs(get_sample(format, out->p_buffer, i) - expected);
+        if (delta > tolerance) {
+            fprintf(stderr, "%4.4s sample %zu: got %f, expected %f\n",
+                    (const char *)&format, i,
+                    get_sample(format, out->p_buffer, i), expected);
+            assert(!"wrong sample");
+        }
+    }
+}
+
+static void test_module(vlc_object_t *parent, const char *name,
+                        vlc_fourcc_t format)
+{
+    audio_volume_t *obj = vlc_object_create(parent, sizeof (*obj));
+    assert(obj != NULL);
+    obj->format = format;
+    obj->amplify_ramp = NULL;
+
+    module_t *module = module_need(obj, "audio volume", name, true);
+    if (module == NULL) {
+        vlc_object_delete(obj);
+        return;
+    }
+
+    size_t size = SAMPLES * aout_BitsPerSample(format) / 8;
+    block_t *in = block_Alloc(size), *out = block_Alloc(size);
+    assert(in != NULL && out != NULL);
+    fill(format, in);
+
+    static const float gains[] = { 0.f, .25f, .7f, 1.f, 1.5f, 2.f };
+    for (size_t i = 0; i < ARRAY_SIZE(gains); i++) {
+        memcpy(out->p_buffer, in->p_buffer, size);
+        obj->amplify(obj, out, gains[i]);
+        check(format, in, out, gains[i], gains[i], false);
+
+        if (obj->amplify_ramp == NULL)
+            continue;
+
+        float from = gains[(i + 1) % ARRAY_SIZE(gains)];
+        memcpy(out->p_buffer, in->p_buffer, size);
+        obj->amplify_ramp(obj, out, from, gains[i]);
+        check(format, in, out, from, gains[i], true);
+    }
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < BENCH_RUNS; i++)
+        obj->amplify(obj, out, (i & 1) ? .5f : 2.f);
+    vlc_tick_t mid = vlc_tick_now();
+    if (obj->amplify_ramp != NULL)
+        for (unsigned i = 0; i < BENCH_RUNS; i++)
+            obj->amplify_ramp(obj, out, (i & 1) ? 2.f : .5f,
+                              (i & 1) ? .5f : 2.f);
+    vlc_tick_t end = vlc_tick_now();
+
+    printf("%-16s %4.4s: %6.3f ns/sample", name, (const char *)&format,
+           (double)NS_FROM_VLC_TICK(mid - start) / (BENCH_RUNS * SAMPLES));
+    if (obj->amplify_ramp != NULL)
+        printf(", ramp %6.3f ns/sample",
+               (double)NS_FROM_VLC_TICK(end - mid) / (BENCH_RUNS * SAMPLES));
+    putchar('\n');
+
+    block_Release(out);
+    block_Release(in);
+    module_unneed(obj, module);
+    vlc_object_delete(obj);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *parent = VLC_OBJECT(vlc->p_libvlc_int);
+
+    size_t count;
+    module_t **list = module_list_get(&count);
+    assert(list != NULL);
+
+    for (size_t i = 0; i < count; i++) {
+        if (!module_provides(list[i], "audio volume"))
+            continue;
+        for (size_t j = 0; j < ARRAY_SIZE(formats); j++)
+            test_module(parent, module_get_object(list[i]), formats[j]);
+    }
+
+    module_list_free(list);
+    libvlc_release(vlc);
+    return 0;
+}
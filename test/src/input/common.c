@@ -41,6 +41,7 @@ void vlc_run_args_init(struct vlc_run_args *args)
 
     args->name = getenv("VLC_TARGET");
     args->test_demux_controls = getenv_atoi("VLC_DEMUX_CONTROLS");
+    args->tracer = getenv("VLC_TRACER");
 }
 
 libvlc_instance_t *libvlc_create(const struct vlc_run_args *args)
@@ -54,18 +55,24 @@ libvlc_instance_t *libvlc_create(const struct vlc_run_args *args)
 
     /* Override argc/argv with "--verbose lvl" or "--quiet" depending on the V
      * environment variable */
-    const char *argv[2];
+    const char *argv[4];
     char verbose[2];
-    int argc = args->verbose == 0 ? 1 : 2;
+    int argc = 0;
 
     if (args->verbose > 0)
     {
-        argv[0] = "--verbose";
+        argv[argc++] = "--verbose";
         sprintf(verbose, "%u", args->verbose);
-        argv[1] = verbose;
+        argv[argc++] = verbose;
     }
     else
-        argv[0] = "--quiet";
+        argv[argc++] = "--quiet";
+
+    if (args->tracer != NULL)
+    {
+        argv[argc++] = "--tracer";
+        argv[argc++] = args->tracer;
+    }
 
     libvlc_instance_t *vlc = libvlc_new(argc, argv);
     if (vlc == NULL)
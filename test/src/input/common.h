@@ -37,6 +37,9 @@ struct vlc_run_args
 
     /* true to test demux controls */
     bool test_demux_controls;
+
+    /* tracer module name, NULL for none */
+    const char *tracer;
 };
 
 void vlc_run_args_init(struct vlc_run_args *args);
@@ -32,6 +32,7 @@
 #include <vlc_meta.h>
 #include <vlc_block.h>
 #include <vlc_url.h>
+#include <vlc_tracer.h>
 
 #include <vlc/libvlc.h>
 #include "../../lib/libvlc_internal.h"
@@ -196,6 +197,30 @@ decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
     return decoder;
 }
 
+static block_t *packetize(decoder_t *packetizer, block_t **pp_block)
+{
+    struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(packetizer));
+
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanBegin(tracer, "PACKETIZER", "packetizer");
+    block_t *block = packetizer->pf_packetize(packetizer, pp_block);
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanEnd(tracer, "PACKETIZER", "packetizer");
+    return block;
+}
+
+static int decode(decoder_t *decoder, block_t *block)
+{
+    struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(decoder));
+
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanBegin(tracer, "DEC", "decoder");
+    int ret = decoder->pf_decode(decoder, block);
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanEnd(tracer, "DEC", "decoder");
+    return ret;
+}
+
 int test_decoder_process(decoder_t *decoder, block_t *p_block)
 {
     struct decoder_owner *owner = dec_get_owner(decoder);
@@ -211,8 +236,7 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
 
     block_t **pp_block = p_block ? &p_block : NULL;
     block_t *p_packetized_block;
-    while ((p_packetized_block =
-                packetizer->pf_packetize(packetizer, pp_block)))
+    while ((p_packetized_block = packetize(packetizer, pp_block)))
     {
 
         if (!es_format_IsSimilar(&decoder->fmt_in, &packetizer->fmt_out))
@@ -245,7 +269,7 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
             block_t *p_next = p_packetized_block->p_next;
             p_packetized_block->p_next = NULL;
 
-            int ret = decoder->pf_decode(decoder, p_packetized_block);
+            int ret = decode(decoder, p_packetized_block);
 
             if (ret == VLCDEC_ECRITICAL)
             {
@@ -257,6 +281,6 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
         }
     }
     if (p_block == NULL) /* Drain */
-        decoder->pf_decode(decoder, NULL);
+        decode(decoder, NULL);
     return VLC_SUCCESS;
 }
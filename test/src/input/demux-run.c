@@ -42,6 +42,7 @@
 #include <vlc_meta.h>
 #include <vlc_es_out.h>
 #include <vlc_url.h>
+#include <vlc_tracer.h>
 #include "../lib/libvlc_internal.h"
 
 #include <vlc/vlc.h>
@@ -290,7 +291,8 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
     if (s == NULL)
         return -1;
 
-    es_out_t *out = test_es_out_create(VLC_OBJECT(s));
+    /* The decoders are drained after demux_Delete() destroyed the stream */
+    es_out_t *out = test_es_out_create(VLC_OBJECT(vlc_object_instance(s)));
     if (out == NULL)
         return -1;
 
@@ -303,11 +305,20 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
         return -1;
     }
 
+    struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(demux));
     uintmax_t i = 0;
     int val;
 
-    while ((val = demux_Demux(demux)) == VLC_DEMUXER_SUCCESS)
+    for (;;)
     {
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanBegin(tracer, "DEMUX", name);
+        val = demux_Demux(demux);
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanEnd(tracer, "DEMUX", name);
+        if (val != VLC_DEMUXER_SUCCESS)
+            break;
+
         if (args->test_demux_controls)
         {
             if (demux_test_and_clear_flags(demux, INPUT_UPDATE_TITLE_LIST))
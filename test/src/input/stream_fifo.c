@@ -241,6 +241,43 @@ int main(void)
     vlc_stream_Delete(reader);
     block_Release(block);
 
+    /* Blocks are handed over without copying, including when peeking */
+    writer = vlc_stream_fifo_New(parent, &reader);
+    assert(writer != NULL);
+    block = block_Alloc(10);
+    assert(block != NULL);
+    memcpy(block->p_buffer, "1st block\n", 10);
+    const uint8_t *data = block->p_buffer;
+    val = vlc_stream_fifo_Queue(writer, block);
+    assert(val == 0);
+    val = vlc_stream_fifo_Write(writer, "2nd block\n", 10);
+    assert(val == 10);
+    vlc_stream_fifo_Close(writer);
+
+    val = vlc_stream_Peek(reader, &peek, 4);
+    assert(val == 4);
+    assert(peek == data);
+    assert(vlc_stream_Tell(reader) == 0);
+
+    block = vlc_stream_ReadBlock(reader);
+    assert(block != NULL);
+    assert(block->p_buffer == data);
+    assert(block->i_buffer == 10);
+    assert(vlc_stream_Tell(reader) == 10);
+    block_Release(block);
+
+    /* ...and seeking within the pending block too */
+    val = vlc_stream_Read(reader, buf, 2);
+    assert(val == 2);
+    assert(memcmp(buf, "2n", 2) == 0);
+    val = vlc_stream_Seek(reader, 15);
+    assert(val == VLC_SUCCESS);
+    assert(vlc_stream_Tell(reader) == 15);
+    val = vlc_stream_Read(reader, buf, sizeof (buf));
+    assert(val == 5);
+    assert(memcmp(buf, "lock\n", 5) == 0);
+    vlc_stream_Delete(reader);
+
     libvlc_release(vlc);
 
     return 0;
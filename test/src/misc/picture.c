@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * picture.c: test for picture views
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+
+#include <assert.h>
+
+static void test_view(vlc_fourcc_t chroma, unsigned x, unsigned y)
+{
+    video_format_t fmt;
+
+    video_format_Init(&fmt, chroma);
+    video_format_Setup(&fmt, chroma, 64, 48, 64, 48, 1, 1);
+
+    picture_t *pic = picture_NewFromFormat(&fmt);
+    assert(pic != NULL);
+    for (int i = 0; i < pic->i_planes; i++)
+        for (int l = 0; l < pic->p[i].i_lines; l++)
+            for (int b = 0; b < pic->p[i].i_pitch; b++)
+                pic->p[i].p_pixels[l * pic->p[i].i_pitch + b] = l ^ b ^ i;
+    pic->date = VLC_TICK_FROM_MS(40);
+
+    video_format_t view_fmt;
+    video_format_Init(&view_fmt, chroma);
+    video_format_Setup(&view_fmt, chroma, 16, 8, 16, 8, 1, 1);
+
+    picture_t *view = picture_NewView(pic, &view_fmt, x, y);
+    assert(view != NULL);
+    assert(view->date == pic->date);
+    assert(view->i_planes == pic->i_planes);
+    assert(view->format.i_width == 16 && view->format.i_height == 8);
+
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(chroma);
+    for (int i = 0; i < view->i_planes; i++) {
+        const plane_t *vp = &view->p[i], *pp = &pic->p[i];
+        const unsigned px = x * dsc->p[i].w.num / dsc->p[i].w.den;
+        const unsigned py = y * dsc->p[i].h.num / dsc->p[i].h.den;
+
+        assert(vp->i_pitch == pp->i_pitch);
+        assert(vp->p_pixels == pp->p_pixels + py * pp->i_pitch
+                               + px * pp->i_pixel_pitch);
+        assert(vp->i_visible_pitch <= vp->i_pitch);
+        assert(vp->i_visible_lines <= vp->i_lines);
+    }
+
+    /* The view keeps the pixels alive */
+    picture_Release(pic);
+    for (int i = 0; i < view->i_planes; i++)
+        for (int l = 0; l < view->p[i].i_visible_lines; l++)
+            (void) *(volatile uint8_t *)
+                &view->p[i].p_pixels[l * view->p[i].i_pitch];
+    picture_Release(view);
+}
+
+int main(void)
+{
+    test_view(VLC_CODEC_I420, 0, 0);
+    test_view(VLC_CODEC_I420, 32, 16);
+    test_view(VLC_CODEC_I444, 48, 40);
+    test_view(VLC_CODEC_YUYV, 2, 6);
+    test_view(VLC_CODEC_RGBA, 13, 7);
+
+    /* Out of bounds */
+    video_format_t fmt;
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, 32, 32, 32, 32, 1, 1);
+    picture_t *pic = picture_NewFromFormat(&fmt);
+    assert(pic != NULL);
+    assert(picture_NewView(pic, &fmt, 2, 0) == NULL);
+    picture_Release(pic);
+    return 0;
+}
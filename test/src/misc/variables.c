@@ -444,6 +444,49 @@ static void test_creation_and_type( libvlc_int_t *p_libvlc )
     assert( var_Get( p_libvlc, "bla", &val ) == VLC_ENOENT );
 }
 
+#define BENCH_VARS 128
+#define BENCH_LOOKUPS 200000
+
+static void test_lookup_bench( libvlc_int_t *p_libvlc )
+{
+    char names[BENCH_VARS][16];
+
+    /* Populate the object like a busy core object */
+    for( unsigned i = 0; i < BENCH_VARS; i++ )
+    {
+        snprintf( names[i], sizeof (names[i]), "bench-%u", i );
+        var_Create( p_libvlc, names[i], VLC_VAR_INTEGER );
+        var_SetInteger( p_libvlc, names[i], i );
+    }
+
+    vlc_object_t *child = vlc_object_create( p_libvlc, sizeof (*child) );
+    assert( child != NULL );
+    vlc_object_t *grandchild = vlc_object_create( child, sizeof (*child) );
+    assert( grandchild != NULL );
+
+    vlc_tick_t start = vlc_tick_now();
+    for( unsigned i = 0; i < BENCH_LOOKUPS; i++ )
+        assert( var_GetInteger( p_libvlc, names[i % BENCH_VARS] )
+                == i % BENCH_VARS );
+    vlc_tick_t get = vlc_tick_now() - start;
+
+    start = vlc_tick_now();
+    for( unsigned i = 0; i < BENCH_LOOKUPS; i++ )
+        assert( var_InheritInteger( grandchild, names[i % BENCH_VARS] )
+                == i % BENCH_VARS );
+    vlc_tick_t inherit = vlc_tick_now() - start;
+
+    test_log( "var_GetInteger: %"PRId64" ns, var_InheritInteger: %"PRId64
+              " ns\n", NS_FROM_VLC_TICK(get) / BENCH_LOOKUPS,
+              NS_FROM_VLC_TICK(inherit) / BENCH_LOOKUPS );
+
+    vlc_object_delete( grandchild );
+    vlc_object_delete( child );
+
+    for( unsigned i = 0; i < BENCH_VARS; i++ )
+        var_Destroy( p_libvlc, names[i] );
+}
+
 static void test_variables( libvlc_instance_t *p_vlc )
 {
     libvlc_int_t *p_libvlc = p_vlc->p_libvlc_int;
@@ -481,6 +524,9 @@ static void test_variables( libvlc_instance_t *p_vlc )
 
     test_log( "Testing type at creation\n" );
     test_creation_and_type( p_libvlc );
+
+    test_log( "Benchmarking lookups\n" );
+    test_lookup_bench( p_libvlc );
 }
 
 
@@ -0,0 +1,620 @@
+/**
+ * @file vlc-bench.c
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Runs media files through the demuxer, packetizers and decoders as fast as
+ * possible (without any clock), and prints per-file and per-stage timings as
+ * a JSON array.
+ *
+ * The stages are measured through the spans that the test pipeline emits
+ * with the tracer interface. A built-in tracer module collects them.
+ *
+ * Given a corpus of reference files (or directories), the CPU time, the self
+ * time of each stage and the heap frame allocations can be stored as a
+ * baseline, then compared against it on later runs: the program fails if a
+ * metric grows by more than the threshold.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/* Define a builtin module for the tracer */
+#define MODULE_NAME vlc_bench
+#define MODULE_STRING "vlc_bench"
+#undef __PLUGIN__
+
+const char vlc_module_name[] = MODULE_STRING;
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_frame.h>
+#include <vlc_tracer.h>
+#include "src/input/demux-run.h"
+
+#define BENCH_MAX_STAGES 8
+#define BENCH_MAX_DEPTH 16
+
+struct bench_stage
+{
+    char name[16];
+    size_t count;
+    vlc_tick_t total; /**< Inclusive duration */
+    vlc_tick_t self; /**< Duration excluding nested spans */
+    vlc_tick_t *samples;
+    size_t samples_size;
+};
+
+struct bench_span
+{
+    struct bench_stage *stage;
+    vlc_tick_t start;
+    vlc_tick_t children;
+};
+
+static struct bench_stage stages[BENCH_MAX_STAGES];
+static size_t stage_count;
+static vlc_mutex_t stages_lock = VLC_STATIC_MUTEX;
+
+static thread_local struct bench_span stack[BENCH_MAX_DEPTH];
+static thread_local unsigned depth;
+
+static struct bench_stage *GetStage(const char *name)
+{
+    for (size_t i = 0; i < stage_count; i++)
+        if (strcmp(stages[i].name, name) == 0)
+            return &stages[i];
+
+    if (stage_count >= BENCH_MAX_STAGES)
+        return NULL;
+
+    struct bench_stage *stage = &stages[stage_count++];
+
+    snprintf(stage->name, sizeof (stage->name), "%s", name);
+    return stage;
+}
+
+static void AddSample(struct bench_stage *stage, vlc_tick_t duration,
+                      vlc_tick_t self)
+{
+    if (stage->count >= stage->samples_size)
+    {
+        size_t size = stage->samples_size ? stage->samples_size * 2 : 4096;
+        vlc_tick_t *samples = realloc(stage->samples,
+                                      size * sizeof (*samples));
+        if (unlikely(samples == NULL))
+            return;
+        stage->samples = samples;
+        stage->samples_size = size;
+    }
+
+    stage->samples[stage->count++] = duration;
+    stage->total += duration;
+    stage->self += self;
+}
+
+static void Trace(void *opaque, va_list entries)
+{
+    vlc_tick_t now = vlc_tick_now();
+    const char *type = NULL, *span = NULL;
+    struct vlc_tracer_entry entry;
+
+    (void) opaque;
+
+    while ((entry = va_arg(entries, struct vlc_tracer_entry)).key != NULL)
+    {
+        if (entry.type != VLC_TRACER_STRING)
+            continue;
+        if (strcmp(entry.key, "type") == 0)
+            type = entry.value.string;
+        else if (strcmp(entry.key, "span") == 0)
+            span = entry.value.string;
+    }
+
+    if (type == NULL || span == NULL)
+        return;
+
+    if (strcmp(span, "begin") == 0)
+    {
+        if (depth >= BENCH_MAX_DEPTH)
+            abort();
+
+        struct bench_span *s = &stack[depth++];
+
+        vlc_mutex_lock(&stages_lock);
+        s->stage = GetStage(type);
+        vlc_mutex_unlock(&stages_lock);
+        s->children = 0;
+        s->start = vlc_tick_now();
+    }
+    else if (strcmp(span, "end") == 0 && depth > 0)
+    {
+        struct bench_span *s = &stack[--depth];
+        vlc_tick_t duration = now - s->start;
+
+        if (depth > 0)
+            stack[depth - 1].children += duration;
+        if (s->stage == NULL)
+            return;
+
+        vlc_mutex_lock(&stages_lock);
+        AddSample(s->stage, duration, duration - s->children);
+        vlc_mutex_unlock(&stages_lock);
+    }
+}
+
+static const struct vlc_tracer_operations bench_ops =
+{
+    Trace,
+    NULL,
+};
+
+static const struct vlc_tracer_operations *Open(vlc_object_t *obj,
+                                               void **restrict sysp)
+{
+    (void) obj;
+    *sysp = NULL;
+    return &bench_ops;
+}
+
+vlc_module_begin()
+    set_callback(Open)
+    set_capability("tracer", 0)
+vlc_module_end()
+
+/* Helper typedef for vlc_static_modules */
+typedef int (*vlc_plugin_cb)(vlc_set_cb, void*);
+
+VLC_EXPORT const vlc_plugin_cb vlc_static_modules[];
+const vlc_plugin_cb vlc_static_modules[] = {
+    VLC_SYMBOL(vlc_entry),
+    NULL
+};
+
+/* Metrics compared against the baseline */
+#define BENCH_MAX_METRICS (3 + BENCH_MAX_STAGES)
+
+struct bench_metric
+{
+    char key[32];
+    int64_t value;
+};
+
+struct bench_result
+{
+    const char *file;
+    bool success;
+    struct bench_metric metrics[BENCH_MAX_METRICS];
+    size_t count;
+};
+
+struct bench_baseline
+{
+    char *file;
+    struct bench_metric metric;
+};
+
+static void AddMetric(struct bench_result *res, const char *key,
+                      int64_t value)
+{
+    if (res->count >= BENCH_MAX_METRICS)
+        return;
+
+    struct bench_metric *m = &res->metrics[res->count++];
+
+    snprintf(m->key, sizeof (m->key), "%s", key);
+    m->value = value;
+}
+
+static int cmptick(const void *a, const void *b)
+{
+    const vlc_tick_t *ta = a, *tb = b;
+
+    return (*ta > *tb) - (*ta < *tb);
+}
+
+static void PrintString(const char *str)
+{
+    putchar('"');
+    for (; *str != '\0'; str++)
+    {
+        unsigned char c = *str;
+
+        if (c == '"' || c == '\\')
+            printf("\\%c", c);
+        else if (c < 0x20)
+            printf("\\u%04x", c);
+        else
+            putchar(c);
+    }
+    putchar('"');
+}
+
+/* Prints and resets the stages of the last run */
+static void PrintStages(struct bench_result *res)
+{
+    const char *sep = "";
+
+    printf("    \"stages\": {");
+    for (size_t i = 0; i < stage_count; i++)
+    {
+        struct bench_stage *stage = &stages[i];
+        size_t n = stage->count;
+
+        if (n == 0)
+            continue;
+
+        qsort(stage->samples, n, sizeof (*stage->samples), cmptick);
+
+        int64_t self = NS_FROM_VLC_TICK(stage->self) / (int64_t)n;
+        char key[32];
+
+        printf("%s\n      ", sep);
+        PrintString(stage->name);
+        printf(": { \"count\": %zu, \"ns_per_frame\": %"PRId64
+               ", \"self_ns_per_frame\": %"PRId64", \"p50_ns\": %"PRId64
+               ", \"p99_ns\": %"PRId64" }",
+               n, NS_FROM_VLC_TICK(stage->total) / (int64_t)n, self,
+               NS_FROM_VLC_TICK(stage->samples[n / 2]),
+               NS_FROM_VLC_TICK(stage->samples[(n * 99) / 100]));
+        sep = ",";
+
+        snprintf(key, sizeof (key), "%.15s.self", stage->name);
+        AddMetric(res, key, self);
+
+        free(stage->samples);
+        stage->samples = NULL;
+        stage->samples_size = 0;
+        stage->count = 0;
+        stage->total = 0;
+        stage->self = 0;
+    }
+    printf("\n    },\n");
+}
+
+static void GetFrameStats(uint64_t *restrict hits, uint64_t *restrict misses)
+{
+    struct vlc_frame_pool_stats pool[16];
+    size_t count = vlc_frame_pool_GetStats(pool, ARRAY_SIZE(pool));
+
+    *hits = *misses = 0;
+    if (count > ARRAY_SIZE(pool))
+        count = ARRAY_SIZE(pool);
+    for (size_t i = 0; i < count; i++)
+    {
+        *hits += pool[i].hits;
+        *misses += pool[i].misses;
+    }
+}
+
+static vlc_tick_t GetCPUTime(void)
+{
+#ifdef CLOCK_PROCESS_CPUTIME_ID
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) == 0)
+        return vlc_tick_from_timespec(&ts);
+#endif
+    return VLC_TICK_INVALID;
+}
+
+static void RunFile(const struct vlc_run_args *args, struct bench_result *res)
+{
+    uint64_t hits, misses, end_hits, end_misses;
+
+    res->count = 0;
+    GetFrameStats(&hits, &misses);
+
+    vlc_tick_t cpu = GetCPUTime();
+    vlc_tick_t start = vlc_tick_now();
+    int ret = vlc_demux_process_path(args, res->file);
+    vlc_tick_t wall = vlc_tick_now() - start;
+
+    if (cpu != VLC_TICK_INVALID)
+        cpu = GetCPUTime() - cpu;
+    GetFrameStats(&end_hits, &end_misses);
+    res->success = ret == 0;
+
+    printf("  {\n    \"file\": ");
+    PrintString(res->file);
+    printf(",\n    \"success\": %s,\n    \"wall_ns\": %"PRId64",\n",
+           res->success ? "true" : "false", NS_FROM_VLC_TICK(wall));
+    if (cpu != VLC_TICK_INVALID)
+    {
+        printf("    \"cpu_ns\": %"PRId64",\n", NS_FROM_VLC_TICK(cpu));
+        AddMetric(res, "cpu_ns", NS_FROM_VLC_TICK(cpu));
+    }
+    else
+        AddMetric(res, "wall_ns", NS_FROM_VLC_TICK(wall));
+    PrintStages(res);
+    printf("    \"frame_allocations\": { \"pooled\": %"PRIu64
+           ", \"heap\": %"PRIu64" }\n  }", end_hits - hits,
+           end_misses - misses);
+    AddMetric(res, "heap_allocations", end_misses - misses);
+}
+
+/* Baseline files contain one "file<TAB>metric<TAB>value" line per metric */
+static int LoadBaseline(const char *path, struct bench_baseline **tabp,
+                        size_t *countp)
+{
+    FILE *stream = fopen(path, "rt");
+    if (stream == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    struct bench_baseline *tab = NULL;
+    size_t count = 0;
+    char *line = NULL;
+    size_t linesize = 0;
+    ssize_t len;
+
+    while ((len = getline(&line, &linesize, stream)) != -1)
+    {
+        char *key = strchr(line, '\t');
+        char *value = (key != NULL) ? strchr(key + 1, '\t') : NULL;
+
+        if (value == NULL)
+            continue;
+        *(key++) = '\0';
+        *(value++) = '\0';
+
+        struct bench_baseline *n = realloc(tab, (count + 1) * sizeof (*tab));
+        if (unlikely(n == NULL))
+            break;
+        tab = n;
+
+        tab[count].file = strdup(line);
+        if (unlikely(tab[count].file == NULL))
+            break;
+        snprintf(tab[count].metric.key, sizeof (tab[count].metric.key), "%s",
+                 key);
+        tab[count].metric.value = strtoll(value, NULL, 10);
+        count++;
+    }
+
+    free(line);
+    fclose(stream);
+    *tabp = tab;
+    *countp = count;
+    return 0;
+}
+
+static unsigned Compare(const struct bench_result *res,
+                        const struct bench_baseline *base, size_t count,
+                        unsigned threshold)
+{
+    unsigned regressions = 0;
+
+    for (size_t i = 0; i < res->count; i++)
+    {
+        const struct bench_metric *m = &res->metrics[i];
+
+        for (size_t j = 0; j < count; j++)
+        {
+            const struct bench_metric *ref = &base[j].metric;
+
+            if (strcmp(base[j].file, res->file) || strcmp(ref->key, m->key))
+                continue;
+
+            /* Small values are mostly noise: allow one unit of slack */
+            if (m->value > ref->value + 1
+             && (m->value - ref->value) * 100 > ref->value * (int64_t)threshold)
+            {
+                fprintf(stderr, "%s: %s regressed from %"PRId64" to %"PRId64
+                        " (+%"PRId64"%%)\n", res->file, m->key, ref->value,
+                        m->value, ref->value ? (m->value - ref->value) * 100
+                                               / ref->value : 100);
+                regressions++;
+            }
+            break;
+        }
+    }
+    return regressions;
+}
+
+static int SaveBaseline(const char *path, const struct bench_result *results,
+                        size_t count)
+{
+    FILE *stream = fopen(path, "wt");
+    if (stream == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const struct bench_result *res = &results[i];
+
+        if (!res->success)
+            continue;
+        for (size_t j = 0; j < res->count; j++)
+            fprintf(stream, "%s\t%s\t%"PRId64"\n", res->file,
+                    res->metrics[j].key, res->metrics[j].value);
+    }
+    return fclose(stream) ? -1 : 0;
+}
+
+static int cmpstr(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/* Adds a file, or the files of a directory and its subdirectories */
+static void AddPath(char ***files, size_t *count, const char *path)
+{
+    struct stat st;
+
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode))
+    {
+        DIR *dir = opendir(path);
+        if (dir == NULL)
+            return;
+
+        char **names = NULL;
+        size_t n = 0;
+        struct dirent *ent;
+
+        while ((ent = readdir(dir)) != NULL)
+        {
+            if (ent->d_name[0] == '.')
+                continue;
+
+            char **tab = realloc(names, (n + 1) * sizeof (*names));
+            if (unlikely(tab == NULL))
+                break;
+            names = tab;
+            if (asprintf(&names[n], "%s/%s", path, ent->d_name) == -1)
+                break;
+            n++;
+        }
+        closedir(dir);
+
+        /* Same order on every run */
+        if (n > 0)
+            qsort(names, n, sizeof (*names), cmpstr);
+        for (size_t i = 0; i < n; i++)
+        {
+            AddPath(files, count, names[i]);
+            free(names[i]);
+        }
+        free(names);
+        return;
+    }
+
+    char **tab = realloc(*files, (*count + 1) * sizeof (**files));
+    if (unlikely(tab == NULL))
+        return;
+    *files = tab;
+    tab[*count] = strdup(path);
+    if (likely(tab[*count] != NULL))
+        (*count)++;
+}
+
+static void Usage(const char *argv0)
+{
+    fprintf(stderr, "Usage: [VLC_TARGET=demux] %s [-b baseline] "
+            "[-t percent] [-u baseline] <file|directory>...\n"
+            "  -b  compare against a baseline, fail on regressions\n"
+            "  -t  regression threshold in percent (default 10)\n"
+            "  -u  write the results as the new baseline\n", argv0);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *baseline = NULL, *update = NULL;
+    unsigned threshold = 10;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:t:u:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b':
+                baseline = optarg;
+                break;
+            case 't':
+                threshold = strtoul(optarg, NULL, 10);
+                break;
+            case 'u':
+                update = optarg;
+                break;
+            default:
+                Usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    struct bench_baseline *base = NULL;
+    size_t base_count = 0;
+
+    if (baseline != NULL && LoadBaseline(baseline, &base, &base_count))
+        return 1;
+
+    char **files = NULL;
+    size_t count = 0;
+
+    for (int i = optind; i < argc; i++)
+        AddPath(&files, &count, argv[i]);
+
+    struct bench_result *results = calloc(count, sizeof (*results));
+    if (count == 0 || results == NULL)
+    {
+        fprintf(stderr, "Error: no input files\n");
+        return 1;
+    }
+
+    struct vlc_run_args args;
+    vlc_run_args_init(&args);
+    args.tracer = MODULE_STRING;
+
+    unsigned failures = 0, regressions = 0;
+
+    printf("[\n");
+    for (size_t i = 0; i < count; i++)
+    {
+        struct bench_result *res = &results[i];
+
+        res->file = files[i];
+        RunFile(&args, res);
+        printf("%s\n", (i + 1 < count) ? "," : "");
+
+        if (!res->success)
+            failures++;
+        else
+            regressions += Compare(res, base, base_count, threshold);
+    }
+    printf("]\n");
+
+    if (failures > 0 || regressions > 0)
+        fprintf(stderr, "%u failure(s), %u regression(s)\n", failures,
+                regressions);
+
+    int ret = (failures > 0 || regressions > 0) ? 1 : 0;
+
+    if (update != NULL && SaveBaseline(update, results, count))
+        ret = 1;
+
+    for (size_t i = 0; i < base_count; i++)
+        free(base[i].file);
+    free(base);
+    for (size_t i = 0; i < count; i++)
+        free(files[i]);
+    free(files);
+    free(results);
+    return ret;
+}